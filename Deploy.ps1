@@ -73,6 +73,24 @@ Write-Host "SSH connection successful."
 Write-Host "`nCreating remote directory..."
 ssh -i $sshKeyPath "$sshUser@$sshHost" "mkdir -p $remoteDir"
 
+# Replace a remote directory with a recursive copy of the local one, so
+# modules added under it ship without being listed here
+function Copy-RemoteDir($dir) {
+    $localDir = Join-Path $source $dir
+    if (-not (Test-Path $localDir)) {
+        Write-Warning "Directory not found: $localDir"
+        return
+    }
+    $remoteParent = "$remoteDir/" + (Split-Path $dir -Parent).Replace('\', '/')
+    Write-Host "  Copying $dir/..."
+    ssh -i $sshKeyPath "$sshUser@$sshHost" "rm -rf $remoteDir/$dir; mkdir -p $remoteParent"
+    scp -r -i $sshKeyPath -o StrictHostKeyChecking=no "$localDir" "${sshUser}@${sshHost}:${remoteParent}/"
+    if ($LASTEXITCODE -ne 0) {
+        Write-Error "Failed to copy $dir/"
+        exit 1
+    }
+}
+
 # Copy files via SCP
 Write-Host "`nCopying server files..."
 $filesToCopy = @(
@@ -97,18 +115,22 @@ foreach ($file in $filesToCopy) {
     }
 }
 
+$dirsToCopy = @(
+    'lib',
+    'tools'
+)
+
+foreach ($dir in $dirsToCopy) {
+    Copy-RemoteDir $dir
+}
+
 # Copy frontend directory
 Write-Host "`nCopying frontend files..."
-ssh -i $sshKeyPath "$sshUser@$sshHost" "mkdir -p $remoteDir/frontend/src"
+ssh -i $sshKeyPath "$sshUser@$sshHost" "mkdir -p $remoteDir/frontend"
 $frontendFiles = @(
     'frontend/package.json',
     'frontend/vite.config.js',
-    'frontend/index.html',
-    'frontend/src/main.jsx',
-    'frontend/src/App.jsx',
-    'frontend/src/App.css',
-    'frontend/src/Admin.jsx',
-    'frontend/src/Admin.css'
+    'frontend/index.html'
 )
 
 foreach ($file in $frontendFiles) {
@@ -123,6 +145,16 @@ foreach ($file in $frontendFiles) {
     }
 }
 
+$frontendDirs = @(
+    'frontend/src',
+    'frontend/scripts',
+    'frontend/public'
+)
+
+foreach ($dir in $frontendDirs) {
+    Copy-RemoteDir $dir
+}
+
 # Deploy firmware binary (PlatformIO builds to .pio/build/nodemcuv2/firmware.bin)
 $firmwareBin = Join-Path $PSScriptRoot '.pio\build\nodemcuv2\firmware.bin'
 Write-Host "`n============================================="
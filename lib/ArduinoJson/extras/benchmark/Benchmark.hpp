@@ -0,0 +1,332 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#pragma once
+
+#include <ArduinoJson.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "Allocators.hpp"
+
+#ifdef ARDUINO
+#  include <Arduino.h>
+#else
+#  include <chrono>
+#endif
+
+// Throughput, allocations and memory for documents shaped like the
+// seismometer's traffic, in JSON and MessagePack. Shared by the host runner
+// (main.cpp, ctest) and the ESP8266 one (test/bench_arduinojson).
+namespace benchmark {
+
+inline unsigned long now() {
+#ifdef ARDUINO
+  return micros();
+#else
+  using namespace std::chrono;
+  return static_cast<unsigned long>(
+      duration_cast<microseconds>(steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+struct Result {
+  const char* fixture;
+  size_t samples;          // waveform length, 0 for the other fixtures
+  const char* operation;   // e.g. "deserializeMsgPack"
+  size_t bytes;            // serialized size
+  unsigned long iterations;
+  unsigned long elapsedUs;
+  size_t allocations;      // allocate() + reallocate() in one run
+  size_t peakBytes;        // allocator high-water mark, document included
+  size_t documentBytes;    // pools and strings the document holds after it
+  size_t writes;           // destination write() calls in one run, if counted
+
+  double opsPerSecond() const {
+    return elapsedUs ? double(iterations) * 1e6 / double(elapsedUs) : 0;
+  }
+
+  double megabytesPerSecond() const {
+    return opsPerSecond() * double(bytes) / 1e6;
+  }
+};
+
+typedef void (*Reporter)(const Result&);
+typedef void (*Fixture)(JsonDocument&, size_t samples);
+
+// Deterministic noise in [-0.05, 0.05) g
+inline float noise(uint32_t& seed) {
+  seed = seed * 1664525u + 1013904223u;
+  return float(int32_t(seed >> 16) - 32768) / 655360.0f;
+}
+
+// GET /api/init reply
+inline void initConfig(JsonDocument& doc, size_t) {
+  doc["heartbeat_interval"] = 60000;
+  doc["push_heartbeat_interval"] = 300000;
+  doc["config_gen"] = 12;
+  JsonObject sensitivity = doc["sensitivity"].to<JsonObject>();
+  sensitivity["minor"] = 0.035;
+  sensitivity["moderate"] = 0.1;
+  sensitivity["severe"] = 0.5;
+  doc["recalibrate"] = false;
+  doc["server_time_ms"] = 1760450000000.0;
+  doc["ntp_server"] = "pool.ntp.org";
+  doc["sample_rate_hz"] = 100;
+  doc["dlpf"] = 1;
+  doc["pre_ms"] = 3000;
+  doc["post_ms"] = 3000;
+  doc["max_post_ms"] = 12000;
+  doc["trigger_mode"] = "both";
+  doc["sta_ms"] = 500;
+  doc["lta_ms"] = 30000;
+  doc["sta_lta_on"] = 4.0;
+  doc["sta_lta_off"] = 1.5;
+  doc["hp_hz"] = 0.1;
+  doc["lp_hz"] = 0;
+  doc["bias_track_s"] = 300;
+  doc["spectrum"] = true;
+  JsonArray formats = doc["upload_formats"].to<JsonArray>();
+  formats.add("msgpack");
+  formats.add("binary-delta");
+  formats.add("binary");
+  formats.add("json");
+  doc["stream_mode"] = "off";
+  doc["firmware_version"] = "1.1.0";
+  doc["firmware_url"] = "http://192.168.86.48:3000/firmware/1.1.0.bin";
+}
+
+// Upload metadata, as in WaveformMsgPackStream
+inline void eventHeader(JsonDocument& doc, size_t) {
+  doc["id"] = "AA:BB:CC:DD:EE:FF";
+  doc["level"] = "moderate";
+  doc["trigger"] = "sta_lta";
+  doc["deltaG"] = 0.1234;
+  doc["event_offset_ms"] = 3012;
+  doc["sample_rate_hz"] = 100;
+  doc["t0_ms"] = -3000;
+  JsonArray bias = doc["bias"].to<JsonArray>();
+  bias.add(-112.5);
+  bias.add(48.25);
+  bias.add(16402.75);
+  doc["scale"] = 16384;
+}
+
+// Config-style numbers: small integers and short decimals, nothing else
+inline void numbers(JsonDocument& doc, size_t) {
+  JsonArray array = doc.to<JsonArray>();
+  uint32_t seed = 1;
+  for (int i = 0; i < 100; i++) {
+    array.add(int32_t(seed % 100000));
+    array.add(double(int32_t(seed % 20000) - 10000) / 1000);  // -10.000..9.999
+    noise(seed);
+  }
+}
+
+// JSON upload: the header, then [rel_ms, ax, ay, az] per sample
+inline void waveform(JsonDocument& doc, size_t samples) {
+  eventHeader(doc, 0);
+  JsonArray rows = doc["waveform"].to<JsonArray>();
+  uint32_t seed = 1;
+  for (size_t i = 0; i < samples; i++) {
+    JsonArray row = rows.add<JsonArray>();
+    row.add(int32_t(i * 10) - 3000);
+    row.add(noise(seed));
+    row.add(noise(seed));
+    row.add(1.0f + noise(seed));
+  }
+}
+
+struct JsonFormat {
+  static const char* serializeName() {
+    return "serializeJson";
+  }
+  static const char* deserializeName() {
+    return "deserializeJson";
+  }
+  static size_t measure(const JsonDocument& doc) {
+    return measureJson(doc);
+  }
+  static size_t serialize(const JsonDocument& doc, char* buffer, size_t n) {
+    return serializeJson(doc, buffer, n);
+  }
+  static DeserializationError deserialize(JsonDocument& doc,
+                                          const char* buffer, size_t n) {
+    return deserializeJson(doc, buffer, n);
+  }
+};
+
+struct MsgPackFormat {
+  static const char* serializeName() {
+    return "serializeMsgPack";
+  }
+  static const char* deserializeName() {
+    return "deserializeMsgPack";
+  }
+  static size_t measure(const JsonDocument& doc) {
+    return measureMsgPack(doc);
+  }
+  static size_t serialize(const JsonDocument& doc, char* buffer, size_t n) {
+    return serializeMsgPack(doc, buffer, n);
+  }
+  static DeserializationError deserialize(JsonDocument& doc,
+                                          const char* buffer, size_t n) {
+    return deserializeMsgPack(doc, buffer, n);
+  }
+};
+
+// Stands in for a WiFiClient: counts the write() calls that reach it, each
+// one lwIP call and, with Nagle off as on the firmware's sockets, one TCP
+// segment. A Print on the device, so serializeJson() takes the same path
+// as to a socket.
+class WriteCounter
+#ifdef ARDUINO
+    : public Print
+#endif
+{
+ public:
+  size_t write(uint8_t) {
+    writes++;
+    return 1;
+  }
+
+  size_t write(const uint8_t*, size_t n) {
+    writes++;
+    return n;
+  }
+
+  size_t writes = 0;
+};
+
+inline size_t documentBytes(JsonDocument& doc) {
+  return ArduinoJson::detail::VariantAttorney::getResourceManager(doc)->size();
+}
+
+// Repeats f until minUs have passed
+template <typename TFunction>
+void repeat(Result& result, unsigned long minUs, TFunction f) {
+  unsigned long start = now();
+  do {
+    f();
+    result.iterations++;
+    result.elapsedUs = now() - start;
+#ifdef ARDUINO
+    yield();  // keep the soft watchdog fed
+#endif
+  } while (result.elapsedUs < minUs);
+}
+
+// Serializes then parses back the fixture. Returns false if any step fails,
+// e.g. out of memory on the device.
+template <typename TFormat>
+bool run(const char* name, Fixture fixture, size_t samples,
+         unsigned long minUs, Reporter report) {
+  char* buffer = nullptr;
+  size_t size = 0;
+  bool ok = true;
+
+  {
+    SpyingAllocator spy;
+    JsonDocument doc(&spy);
+    fixture(doc, samples);
+    if (doc.overflowed())
+      return false;
+    size = TFormat::measure(doc);
+    buffer = static_cast<char*>(malloc(size + 1));
+    if (!buffer)
+      return false;
+
+    Result result = {name, samples, TFormat::serializeName(), size, 0, 0, 0, 0,
+                     documentBytes(doc), 0};
+    size_t allocations = spy.allocationCount();
+    repeat(result, minUs,
+           [&]() { ok &= TFormat::serialize(doc, buffer, size + 1) == size; });
+    result.allocations = spy.allocationCount() - allocations;
+    result.peakBytes = spy.peakAllocatedBytes();
+    if (ok)
+      report(result);
+  }
+
+  if (ok) {
+    Result result = {name, samples, TFormat::deserializeName(), size, 0, 0,
+                     0, 0, 0, 0};
+    {
+      // One instrumented run for the memory figures, then the timed ones
+      SpyingAllocator spy;
+      JsonDocument doc(&spy);
+      ok = !TFormat::deserialize(doc, buffer, size);
+      result.allocations = spy.allocationCount();
+      result.peakBytes = spy.peakAllocatedBytes();
+      result.documentBytes = documentBytes(doc);
+    }
+    if (ok) {
+      repeat(result, minUs, [&]() {
+        JsonDocument doc;
+        ok &= !TFormat::deserialize(doc, buffer, size);
+      });
+    }
+    if (ok)
+      report(result);
+  }
+
+  free(buffer);
+  return ok;
+}
+
+// serializeJson() straight to a socket-like destination, then through a
+// BufferedWriter: writes (segments) per document, and the time it takes
+inline bool runWrites(const char* name, Fixture fixture, size_t samples,
+                      unsigned long minUs, Reporter report) {
+  JsonDocument doc;
+  fixture(doc, samples);
+  if (doc.overflowed())
+    return false;
+  size_t size = measureJson(doc);
+  bool ok = true;
+
+  Result direct = {name, samples, "json to socket", size, 0, 0, 0, 0, 0, 0};
+  repeat(direct, minUs, [&]() {
+    WriteCounter socket;
+    ok &= serializeJson(doc, socket) == size;
+    direct.writes = socket.writes;
+  });
+  if (ok)
+    report(direct);
+
+  Result buffered = {name, samples, "json buffered", size, 0, 0, 0, 0, 0, 0};
+  repeat(buffered, minUs, [&]() {
+    WriteCounter socket;
+    {
+      BufferedWriter<WriteCounter> out(socket);
+      ok &= serializeJson(doc, out) == size;
+    }
+    buffered.writes = socket.writes;
+  });
+  if (ok)
+    report(buffered);
+  return ok;
+}
+
+inline bool run(const char* name, Fixture fixture, size_t samples,
+                unsigned long minUs, Reporter report) {
+  bool json = run<JsonFormat>(name, fixture, samples, minUs, report);
+  bool msgPack = run<MsgPackFormat>(name, fixture, samples, minUs, report);
+  bool writes = runWrites(name, fixture, samples, minUs, report);
+  return json && msgPack && writes;
+}
+
+// Every fixture, with the given waveform lengths
+inline bool runAll(const size_t* waveformSizes, size_t count,
+                   unsigned long minUs, Reporter report) {
+  bool ok = run("init", initConfig, 0, minUs, report);
+  ok &= run("event", eventHeader, 0, minUs, report);
+  ok &= run("numbers", numbers, 0, minUs, report);
+  for (size_t i = 0; i < count; i++)
+    ok &= run("waveform", waveform, waveformSizes[i], minUs, report);
+  return ok;
+}
+
+}  // namespace benchmark
@@ -0,0 +1,28 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Benchmark.hpp"
+
+// Usage: ArduinoJsonBenchmark [--quick]
+// --quick runs each case once or twice, as a smoke test for ctest
+
+static void print(const benchmark::Result& r) {
+  printf("%-9s %5u  %-18s %8u B %11.1f op/s %8.2f MB/s %6u allocs %8u peak %8u doc",
+         r.fixture, unsigned(r.samples), r.operation, unsigned(r.bytes),
+         r.opsPerSecond(), r.megabytesPerSecond(), unsigned(r.allocations),
+         unsigned(r.peakBytes), unsigned(r.documentBytes));
+  if (r.writes)
+    printf(" %6u writes", unsigned(r.writes));
+  printf("\n");
+}
+
+int main(int argc, const char* argv[]) {
+  bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+  const size_t waveformSizes[] = {120, 1200, 6000};
+  bool ok = benchmark::runAll(waveformSizes, 3, quick ? 1 : 500000, print);
+  return ok ? 0 : 1;
+}
@@ -133,12 +133,23 @@ class SpyingAllocator : public ArduinoJson::Allocator {
     return allocatedBytes_;
   }
 
+  // High-water mark of allocatedBytes()
+  size_t peakAllocatedBytes() const {
+    return peakAllocatedBytes_;
+  }
+
+  // Successful allocate() and reallocate() calls
+  size_t allocationCount() const {
+    return allocationCount_;
+  }
+
   void* allocate(size_t n) override {
     auto block = reinterpret_cast<AllocatedBlock*>(
         upstream_->allocate(sizeof(AllocatedBlock) + n - 1));
     if (block) {
       log_.append(Allocate(n));
       allocatedBytes_ += n;
+      updateCounters();
       block->size = n;
       return block->payload;
     } else {
@@ -163,6 +174,7 @@ class SpyingAllocator : public ArduinoJson::Allocator {
       log_.append(Reallocate(oldSize, n));
       block->size = n;
       allocatedBytes_ += n - oldSize;
+      updateCounters();
       return block->payload;
     } else {
       log_.append(ReallocateFail(oldSize, n));
@@ -179,6 +191,12 @@ class SpyingAllocator : public ArduinoJson::Allocator {
   }
 
  private:
+  void updateCounters() {
+    allocationCount_++;
+    if (allocatedBytes_ > peakAllocatedBytes_)
+      peakAllocatedBytes_ = allocatedBytes_;
+  }
+
   struct AllocatedBlock {
     size_t size;
     char payload[1];
@@ -197,6 +215,8 @@ class SpyingAllocator : public ArduinoJson::Allocator {
   AllocatorLog log_;
   Allocator* upstream_;
   size_t allocatedBytes_ = 0;
+  size_t peakAllocatedBytes_ = 0;
+  size_t allocationCount_ = 0;
 };
 
 class KillswitchAllocator : public ArduinoJson::Allocator {
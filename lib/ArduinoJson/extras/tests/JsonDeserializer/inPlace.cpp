@@ -0,0 +1,125 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#define ARDUINOJSON_DECODE_UNICODE 1
+#include <ArduinoJson.h>
+#include <catch.hpp>
+
+#include "Allocators.hpp"
+
+using ArduinoJson::detail::sizeofObject;
+
+TEST_CASE("deserializeJsonInPlace()") {
+  SpyingAllocator spy;
+  JsonDocument doc(&spy);
+
+  SECTION("string values point into the input") {
+    char input[] = "[\"hello\",\"world\"]";
+
+    DeserializationError err = deserializeJsonInPlace(doc, input);
+
+    REQUIRE(err == DeserializationError::Ok);
+    CHECK(doc[0].as<const char*>() == input + 2);
+    CHECK(doc[1].as<const char*>() == input + 10);
+    CHECK(doc[0] == "hello");
+    CHECK(doc[1] == "world");
+    CHECK(spy.log() == AllocatorLog{
+                           Allocate(sizeofPool()),
+                           Reallocate(sizeofPool(), sizeofPool(2)),
+                       });
+  }
+
+  SECTION("keys are copied") {
+    char input[] = "{\"level\":\"minor\"}";
+
+    DeserializationError err = deserializeJsonInPlace(doc, input);
+
+    REQUIRE(err == DeserializationError::Ok);
+    CHECK(doc["level"].as<const char*>() == input + 10);
+    CHECK(spy.log() == AllocatorLog{
+                           Allocate(sizeofStringBuffer()),
+                           Allocate(sizeofPool()),
+                           Reallocate(sizeofStringBuffer(), sizeofString("level")),
+                           Reallocate(sizeofPool(), sizeofObject(1)),
+                       });
+  }
+
+  SECTION("escape sequences are decoded") {
+    char input[] = "[\"1\\\"2\\n3\",'\\u00e4\\ud83d\\udda4']";
+
+    DeserializationError err = deserializeJsonInPlace(doc, input);
+
+    REQUIRE(err == DeserializationError::Ok);
+    CHECK(doc[0] == "1\"2\n3");
+    CHECK(doc[1] == "\xc3\xa4\xf0\x9f\x96\xa4");
+  }
+
+  SECTION("empty string") {
+    char input[] = "\"\"";
+
+    DeserializationError err = deserializeJsonInPlace(doc, input);
+
+    REQUIRE(err == DeserializationError::Ok);
+    CHECK(doc.is<const char*>());
+    CHECK(doc.as<std::string>() == "");
+  }
+
+  SECTION("other values") {
+    char input[] = "{\"a\":[1,2.5,true,null]}";
+
+    DeserializationError err = deserializeJsonInPlace(doc, input);
+
+    REQUIRE(err == DeserializationError::Ok);
+    CHECK(doc.as<std::string>() == "{\"a\":[1,2.5,true,null]}");
+  }
+
+  SECTION("size") {
+    char input[] = "\"hello\"trailing";
+
+    DeserializationError err = deserializeJsonInPlace(doc, input, 7);
+
+    REQUIRE(err == DeserializationError::Ok);
+    CHECK(doc == "hello");
+  }
+
+  SECTION("incomplete input") {
+    char input[] = "[\"hello";
+
+    DeserializationError err = deserializeJsonInPlace(doc, input);
+
+    CHECK(err == DeserializationError::IncompleteInput);
+  }
+
+  SECTION("null input") {
+    DeserializationError err =
+        deserializeJsonInPlace(doc, static_cast<char*>(0));
+
+    CHECK(err == DeserializationError::EmptyInput);
+  }
+
+  SECTION("filter") {
+    char input[] = "{\"ntp_server\":\"pool.ntp.org\",\"notes\":\"skip me\"}";
+    JsonDocument filter;
+    filter["ntp_server"] = true;
+
+    DeserializationError err = deserializeJsonInPlace(
+        doc, input, DeserializationOption::Filter(filter));
+
+    REQUIRE(err == DeserializationError::Ok);
+    CHECK(doc.as<std::string>() == "{\"ntp_server\":\"pool.ntp.org\"}");
+    CHECK(doc["ntp_server"].as<const char*>() == input + 15);
+  }
+
+  SECTION("filter and nesting limit") {
+    char input[] = "{\"a\":{\"b\":\"c\"}}";
+    JsonDocument filter;
+    filter["a"] = true;
+
+    DeserializationError err =
+        deserializeJsonInPlace(doc, input, DeserializationOption::Filter(filter),
+                               DeserializationOption::NestingLimit(1));
+
+    CHECK(err == DeserializationError::TooDeep);
+  }
+}
@@ -8,6 +8,7 @@
 
 #include <ArduinoJson.h>
 #include <limits.h>
+#include <cmath>
 #include <catch.hpp>
 
 namespace my {
@@ -131,3 +132,46 @@ TEST_CASE("deserialize an integer") {
     }
   }
 }
+
+TEST_CASE("deserialize a short number") {
+  // These skip parseNumber(); the result must be the same
+  using ArduinoJson::detail::parseNumber;
+  JsonDocument doc;
+
+  SECTION("Integers up to 9 digits") {
+    const char* inputs[] = {"0", "-0", "7", "-42", "100000", "999999999",
+                            "-999999999", "1234567890", "-2147483648"};
+    for (auto input : inputs) {
+      CAPTURE(input);
+      REQUIRE(deserializeJson(doc, input) == DeserializationError::Ok);
+      REQUIRE(doc.is<long>());
+      REQUIRE(doc.as<long>() == parseNumber<long>(input));
+    }
+  }
+
+  SECTION("Decimals up to 6 digits") {
+    const char* inputs[] = {"0.5",   "-0.5",   "0.035",   "1.25",
+                            "9.999", "-10.0",  "12345.6", "0.00001",
+                            "3.1416", "-0.000", "1234.5678"};
+    for (auto input : inputs) {
+      CAPTURE(input);
+      REQUIRE(deserializeJson(doc, input) == DeserializationError::Ok);
+      REQUIRE(doc.is<float>());
+      REQUIRE(doc.as<float>() == parseNumber<float>(input));
+    }
+  }
+
+  SECTION("Negative zero keeps its sign") {
+    deserializeJson(doc, "-0.0");
+    REQUIRE(std::signbit(doc.as<float>()));
+  }
+
+  SECTION("Not a number") {
+    REQUIRE(deserializeJson(doc, "1.") == DeserializationError::Ok);
+    REQUIRE(doc.as<float>() == 1.0f);
+    REQUIRE(deserializeJson(doc, "-") == DeserializationError::InvalidInput);
+    REQUIRE(deserializeJson(doc, "1-2") == DeserializationError::InvalidInput);
+    REQUIRE(deserializeJson(doc, "1.2.3") ==
+            DeserializationError::InvalidInput);
+  }
+}
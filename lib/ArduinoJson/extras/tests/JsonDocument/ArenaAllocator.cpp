@@ -0,0 +1,90 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#include <ArduinoJson.h>
+#include <catch.hpp>
+
+#include <string>
+
+TEST_CASE("ArenaAllocator") {
+  StaticArenaAllocator<256> arena;
+
+  SECTION("allocate() bumps until full") {
+    REQUIRE(arena.capacity() == 256);
+    void* a = arena.allocate(10);
+    void* b = arena.allocate(10);
+    REQUIRE(a != nullptr);
+    REQUIRE(b > a);
+    REQUIRE(arena.used() > 20);
+    REQUIRE(arena.allocate(256) == nullptr);
+  }
+
+  SECTION("reset() frees everything") {
+    void* a = arena.allocate(100);
+    arena.allocate(100);
+    arena.reset();
+    REQUIRE(arena.used() == 0);
+    REQUIRE(arena.allocate(100) == a);
+  }
+
+  SECTION("deallocate() gives back the last block only") {
+    void* a = arena.allocate(10);
+    void* b = arena.allocate(10);
+    size_t used = arena.used();
+
+    arena.deallocate(a);
+    REQUIRE(arena.used() == used);
+
+    arena.deallocate(b);
+    REQUIRE(arena.used() < used);
+    REQUIRE(arena.allocate(10) == b);
+  }
+
+  SECTION("reallocate() grows the last block in place") {
+    void* a = arena.allocate(10);
+    REQUIRE(arena.reallocate(a, 100) == a);
+    REQUIRE(arena.reallocate(a, 1000) == nullptr);
+  }
+
+  SECTION("reallocate() copies an older block") {
+    char* a = static_cast<char*>(arena.allocate(4));
+    memcpy(a, "abc", 4);
+    arena.allocate(4);
+    char* b = static_cast<char*>(arena.reallocate(a, 20));
+    REQUIRE(b != a);
+    REQUIRE(std::string(b) == "abc");
+    REQUIRE(arena.reallocate(b, 4) == b);
+  }
+
+  SECTION("reallocate(nullptr) allocates") {
+    REQUIRE(arena.reallocate(nullptr, 10) != nullptr);
+  }
+}
+
+TEST_CASE("JsonDocument with an ArenaAllocator") {
+  StaticArenaAllocator<16384> arena;
+
+  SECTION("Reuses the arena after reset()") {
+    for (int i = 0; i < 3; i++) {
+      {
+        JsonDocument doc(&arena);
+        auto err = deserializeJson(doc, "{\"id\":\"SEISMO_1\",\"g\":[1,2,3]}");
+        REQUIRE(err == DeserializationError::Ok);
+        REQUIRE(doc["id"] == "SEISMO_1");
+        REQUIRE(doc["g"][2] == 3);
+        REQUIRE(arena.used() > 0);
+      }
+      arena.reset();
+      REQUIRE(arena.used() == 0);
+    }
+  }
+
+  SECTION("Overflows when the arena is full") {
+    StaticArenaAllocator<1024> tiny;
+    JsonDocument doc(&tiny);
+    for (int i = 0; i < 1000; i++)
+      doc.add(i);
+    REQUIRE(doc.overflowed());
+  }
+}
@@ -0,0 +1,92 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#include <ArduinoJson.h>
+#include <catch.hpp>
+
+#include <string>
+#include <vector>
+
+// Records each write() it gets, and takes at most `limit` bytes in all
+class RecordingWriter {
+ public:
+  explicit RecordingWriter(size_t limit = size_t(-1)) : limit_(limit) {}
+
+  size_t write(uint8_t c) {
+    return write(&c, 1);
+  }
+
+  size_t write(const uint8_t* s, size_t n) {
+    size_t taken = n < limit_ - str.size() ? n : limit_ - str.size();
+    str.append(reinterpret_cast<const char*>(s), taken);
+    writes.push_back(n);
+    return taken;
+  }
+
+  std::string str;
+  std::vector<size_t> writes;
+
+ private:
+  size_t limit_;
+};
+
+TEST_CASE("BufferedWriter") {
+  JsonDocument doc;
+  for (int i = 0; i < 100; i++)
+    doc.add(i * 7);
+  std::string expected;
+  serializeJson(doc, expected);
+  REQUIRE(expected.size() > 256);
+
+  SECTION("writes whole buffers, the rest on flush()") {
+    RecordingWriter dest;
+    BufferedWriter<RecordingWriter, 64> out(dest);
+    size_t n = serializeJson(doc, out);
+    REQUIRE(n == expected.size());
+    REQUIRE(dest.writes.size() == expected.size() / 64);
+    for (size_t w : dest.writes)
+      REQUIRE(w == 64);
+
+    REQUIRE(out.flush());
+    REQUIRE(dest.str == expected);
+    REQUIRE(out.destinationWrites() ==
+            expected.size() / 64 + (expected.size() % 64 ? 1 : 0));
+  }
+
+  SECTION("flushes on destruction") {
+    RecordingWriter dest;
+    {
+      BufferedWriter<RecordingWriter> out(dest);
+      serializeJson(doc, out);
+      REQUIRE(dest.writes.empty());
+    }
+    REQUIRE(dest.str == expected);
+    REQUIRE(dest.writes.size() == 1);
+  }
+
+  SECTION("joins a short run to the buffer, passes a long one through") {
+    RecordingWriter dest;
+    BufferedWriter<RecordingWriter, 8> out(dest);
+    out.write(reinterpret_cast<const uint8_t*>("abc"), 3);
+    out.write(reinterpret_cast<const uint8_t*>("defgh"), 5);
+    REQUIRE(dest.writes == std::vector<size_t>{8});
+    out.write(reinterpret_cast<const uint8_t*>("0123456789"), 10);
+    REQUIRE(dest.writes == std::vector<size_t>({8, 10}));
+    out.write('!');
+    out.flush();
+    REQUIRE(dest.str == "abcdefgh0123456789!");
+    out.flush();
+    REQUIRE(dest.writes.size() == 3);
+  }
+
+  SECTION("stops once the destination falls short") {
+    RecordingWriter dest(100);
+    BufferedWriter<RecordingWriter, 64> out(dest);
+    size_t n = serializeJson(doc, out);
+    REQUIRE(n == 128);  // the second buffer was cut short
+    REQUIRE_FALSE(out.flush());
+    REQUIRE(dest.str == expected.substr(0, 100));
+    REQUIRE(out.write('x') == 0);
+  }
+}
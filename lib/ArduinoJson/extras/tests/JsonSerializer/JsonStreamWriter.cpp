@@ -0,0 +1,138 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#include <ArduinoJson.h>
+#include <catch.hpp>
+
+#include <sstream>
+
+#include "Literals.hpp"
+
+TEST_CASE("JsonStreamWriter") {
+  std::string output;
+  JsonStreamWriter<std::string> json(output);
+
+  SECTION("Empty object") {
+    json.beginObject().endObject();
+    REQUIRE(output == "{}");
+    REQUIRE(json.bytesWritten() == 2);
+  }
+
+  SECTION("Object members") {
+    json.beginObject()
+        .key("id")
+        .value("SEISMO_1")
+        .key("rate")
+        .value(100)
+        .key("ok")
+        .value(true)
+        .key("none")
+        .value(nullptr)
+        .endObject();
+    REQUIRE(output ==
+            "{\"id\":\"SEISMO_1\",\"rate\":100,\"ok\":true,\"none\":null}");
+  }
+
+  SECTION("Nested containers") {
+    json.beginObject()
+        .key("a")
+        .beginArray()
+        .beginObject()
+        .endObject()
+        .beginArray()
+        .endArray()
+        .value(1)
+        .endArray()
+        .key("b")
+        .beginObject()
+        .key("c")
+        .value(2)
+        .endObject()
+        .endObject();
+    REQUIRE(output == "{\"a\":[{},[],1],\"b\":{\"c\":2}}");
+  }
+
+  SECTION("Escapes strings") {
+    json.beginObject().key("k\"ey").value("a\nb").endObject();
+    REQUIRE(output == "{\"k\\\"ey\":\"a\\nb\"}");
+  }
+
+  SECTION("std::string and null pointer") {
+    const char* nothing = nullptr;
+    json.beginArray().value("s"_s).value(nothing).endArray();
+    REQUIRE(output == "[\"s\",null]");
+  }
+
+  SECTION("Floats") {
+    json.beginArray().value(0.5f).value(3.14159, 2).value(-1e20).endArray();
+    REQUIRE(output == "[0.5,3.14,-1e20]");
+  }
+
+  SECTION("ScaledInt16") {
+    json.beginArray()
+        .value(ScaledInt16(-8192, 16384))
+        .value(ScaledInt16(1, 0))
+        .endArray();
+    REQUIRE(output == "[-0.5,null]");
+  }
+
+  SECTION("serialized()") {
+    json.beginArray().value(serialized("{\"x\":1}")).value(2).endArray();
+    REQUIRE(output == "[{\"x\":1},2]");
+  }
+
+  SECTION("values()") {
+    int16_t samples[] = {1, -2, 3};
+    json.beginArray().values(samples, 3).endArray();
+    REQUIRE(output == "[1,-2,3]");
+  }
+
+  SECTION("JsonDocument") {
+    JsonDocument doc;
+    doc["x"] = 1;
+    json.beginObject().key("doc").value(doc).key("y").value(2).endObject();
+    REQUIRE(output == "{\"doc\":{\"x\":1},\"y\":2}");
+    REQUIRE(json.bytesWritten() == output.size());
+  }
+
+  SECTION("std::ostream") {
+    std::ostringstream os;
+    JsonStreamWriter<std::ostream> stream(os);
+    stream.beginArray().value(1).value("two").endArray();
+    REQUIRE(os.str() == "[1,\"two\"]");
+  }
+}
+
+template <typename TWriter>
+static void writeSample(TWriter& json) {
+  JsonDocument doc;
+  doc["z"] = "zz";
+  int16_t samples[] = {100, -200};
+  json.beginObject()
+      .key("id")
+      .value("abc")
+      .key("samples")
+      .beginArray()
+      .values(samples, 2)
+      .endArray()
+      .key("g")
+      .value(ScaledInt16(16384, 16384))
+      .key("doc")
+      .value(doc)
+      .endObject();
+}
+
+TEST_CASE("JsonStreamWriter<> counts") {
+  JsonStreamWriter<> counter;
+  writeSample(counter);
+
+  std::string output;
+  JsonStreamWriter<std::string> json(output);
+  writeSample(json);
+
+  REQUIRE(output ==
+          "{\"id\":\"abc\",\"samples\":[100,-200],\"g\":1,\"doc\":{\"z\":"
+          "\"zz\"}}");
+  REQUIRE(counter.bytesWritten() == output.size());
+}
@@ -0,0 +1,80 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#include <ArduinoJson.h>
+#include <catch.hpp>
+
+#include "Allocators.hpp"
+
+TEST_CASE("serializeJson(LinkedArray)") {
+  SpyingAllocator spy;
+  JsonDocument doc(&spy);
+  std::string result;
+
+  SECTION("int16_t") {
+    const int16_t samples[] = {0, -32768, 32767, 42};
+    doc["samples"] = LinkedArray(samples, 4);
+
+    serializeJson(doc, result);
+    REQUIRE(result == "{\"samples\":[0,-32768,32767,42]}");
+    REQUIRE(measureJson(doc) == result.size());
+  }
+
+  SECTION("float") {
+    const float g[] = {1.5f, -0.25f};
+    doc.add(LinkedArray(g, 2));
+
+    serializeJson(doc, result);
+    REQUIRE(result == "[[1.5,-0.25]]");
+  }
+
+  SECTION("empty") {
+    const int16_t none[1] = {0};
+    doc["x"] = LinkedArray(none, 0);
+
+    serializeJson(doc, result);
+    REQUIRE(result == "{\"x\":[]}");
+  }
+
+  SECTION("reads the buffer when serializing") {
+    int16_t samples[] = {1, 2};
+    doc.set(LinkedArray(samples, 2));
+    samples[1] = 3;
+
+    serializeJson(doc, result);
+    REQUIRE(result == "[1,3]");
+  }
+
+  SECTION("two slots whatever the length") {
+    static int16_t samples[2000];
+    doc["samples"] = LinkedArray(samples, 2000);
+
+    REQUIRE(spy.log() == AllocatorLog{
+                             Allocate(sizeofPool()),
+                         });
+  }
+
+  SECTION("too long") {
+    static int16_t samples[0x10000];
+    REQUIRE(doc["samples"].set(LinkedArray(samples, 0x10000)) == false);
+    REQUIRE(doc["samples"].isNull());
+  }
+
+  SECTION("is not an array") {
+    const int16_t samples[] = {1};
+    doc.set(LinkedArray(samples, 1));
+
+    REQUIRE(doc.is<JsonArray>() == false);
+    REQUIRE(doc.size() == 0);
+  }
+
+  SECTION("copied as a link") {
+    const int16_t samples[] = {4, 5};
+    doc["a"] = LinkedArray(samples, 2);
+    JsonDocument copy(doc);
+
+    serializeJson(copy, result);
+    REQUIRE(result == "{\"a\":[4,5]}");
+  }
+}
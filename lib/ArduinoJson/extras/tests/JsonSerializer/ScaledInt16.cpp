@@ -0,0 +1,33 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#include <ArduinoJson.h>
+#include <catch.hpp>
+
+TEST_CASE("serializeJson(ScaledInt16)") {
+  JsonDocument doc;
+  std::string result;
+
+  SECTION("Writes value / unit") {
+    JsonArray arr = doc.to<JsonArray>();
+    arr.add(ScaledInt16(16384, 16384));
+    arr.add(ScaledInt16(-8192, 16384));
+    arr.add(ScaledInt16(1, 16384));
+    arr.add(ScaledInt16(12345, 16384, 2));
+    serializeJson(doc, result);
+    REQUIRE(result == "[1,-0.5,0.0001,0.75]");
+  }
+
+  SECTION("As an object member") {
+    doc["ax"] = ScaledInt16(-163, 16384);
+    serializeJson(doc, result);
+    REQUIRE(result == "{\"ax\":-0.0099}");
+  }
+
+  SECTION("Zero unit is null") {
+    doc["ax"] = ScaledInt16(100, 0);
+    serializeJson(doc, result);
+    REQUIRE(result == "{\"ax\":null}");
+  }
+}
@@ -0,0 +1,40 @@
+#define ARDUINOJSON_COMPACT_PROFILE 1
+#include <ArduinoJson.h>
+
+#include <catch.hpp>
+
+#include <string>
+
+TEST_CASE("ARDUINOJSON_COMPACT_PROFILE == 1") {
+  JsonDocument doc;
+
+  SECTION("Picks float, 32-bit integers and one-byte slot ids") {
+    REQUIRE(ARDUINOJSON_USE_DOUBLE == 0);
+    REQUIRE(ARDUINOJSON_USE_LONG_LONG == 0);
+    REQUIRE(ARDUINOJSON_SLOT_ID_SIZE == 1);
+    REQUIRE(ARDUINOJSON_USE_EXTENSIONS == 0);
+  }
+
+  SECTION("A variant is at most two pointers") {
+    using namespace ArduinoJson::detail;
+    REQUIRE(sizeof(VariantData) <= 2 * sizeof(void*));
+  }
+
+  SECTION("smoke test") {
+    doc["g"] = 0.5;
+    doc["n"] = 123456789;
+
+    std::string json;
+    serializeJson(doc, json);
+
+    REQUIRE(json == "{\"g\":0.5,\"n\":123456789}");
+  }
+
+  SECTION("Holds at most 255 values") {
+    for (int i = 0; i < 300; i++)
+      doc.add(i);
+
+    REQUIRE(doc.overflowed());
+    REQUIRE(doc.size() <= 255);
+  }
+}
@@ -0,0 +1,17 @@
+#define ARDUINOJSON_FIXED_DECIMAL_PLACES 4
+#include <ArduinoJson.h>
+
+#include <catch.hpp>
+
+TEST_CASE("ARDUINOJSON_FIXED_DECIMAL_PLACES == 4") {
+  JsonDocument doc;
+  JsonObject root = doc.to<JsonObject>();
+
+  root["pi"] = 3.14159265;
+  root["g"] = -0.98;
+
+  std::string json;
+  serializeJson(doc, json);
+
+  REQUIRE(json == "{\"pi\":3.1416,\"g\":-0.98}");
+}
@@ -0,0 +1,39 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#include <ArduinoJson.h>
+#include <catch.hpp>
+
+#include "Literals.hpp"
+
+TEST_CASE("serializeMsgPack(LinkedArray)") {
+  JsonDocument doc;
+  std::string result;
+
+  SECTION("int16_t") {
+    const int16_t samples[] = {1, -1, 300, -32768};
+    doc.set(LinkedArray(samples, 4));
+
+    serializeMsgPack(doc, result);
+    REQUIRE(result == "\x94\x01\xFF\xCD\x01\x2C\xD1\x80\x00"_s);
+    REQUIRE(measureMsgPack(doc) == result.size());
+  }
+
+  SECTION("float") {
+    const float g[] = {2.0f, 1.5f};
+    doc.set(LinkedArray(g, 2));
+
+    serializeMsgPack(doc, result);
+    REQUIRE(result == "\x92\x02\xCA\x3F\xC0\x00\x00"_s);
+  }
+
+  SECTION("array 16") {
+    static int16_t samples[16];
+    doc.set(LinkedArray(samples, 16));
+
+    serializeMsgPack(doc, result);
+    REQUIRE(result.size() == 3 + 16);
+    REQUIRE(result.substr(0, 3) == "\xDC\x00\x10"_s);
+  }
+}
@@ -0,0 +1,117 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#include <ArduinoJson.h>
+#include <catch.hpp>
+
+#include "Literals.hpp"
+
+TEST_CASE("serializeMsgPack(MsgPackTypedArray)") {
+  JsonDocument doc;
+  std::string result;
+
+  SECTION("int16_t as ext 8") {
+    const int16_t samples[] = {1, -2};
+    doc.set(MsgPackTypedArray(samples, 2));
+
+    serializeMsgPack(doc, result);
+    REQUIRE(result == "\xC7\x05\x54\x00\x01\x00\xFE\xFF"_s);
+    REQUIRE(measureMsgPack(doc) == result.size());
+  }
+
+  SECTION("float") {
+    const float g[] = {1.5f};
+    doc.set(MsgPackTypedArray(g, 1));
+
+    serializeMsgPack(doc, result);
+    REQUIRE(result == "\xC7\x05\x54\x01\x00\x00\xC0\x3F"_s);
+  }
+
+  SECTION("empty") {
+    const int16_t none[1] = {0};
+    doc.set(MsgPackTypedArray(none, 0));
+
+    serializeMsgPack(doc, result);
+    REQUIRE(result == "\xD4\x54\x00"_s);
+  }
+
+  SECTION("ext 16") {
+    static int16_t samples[200];
+    doc.set(MsgPackTypedArray(samples, 200));
+
+    serializeMsgPack(doc, result);
+    REQUIRE(result.size() == 4 + 1 + 400);
+    REQUIRE(result.substr(0, 5) == "\xC8\x01\x91\x54\x00"_s);
+  }
+
+  SECTION("JSON is a plain array") {
+    const int16_t samples[] = {3, 4};
+    doc["s"] = MsgPackTypedArray(samples, 2);
+
+    serializeJson(doc, result);
+    REQUIRE(result == "{\"s\":[3,4]}");
+  }
+}
+
+TEST_CASE("copyTypedArray()") {
+  JsonDocument doc;
+
+  SECTION("round trip") {
+    const int16_t samples[] = {10, -20, 30};
+    JsonDocument src;
+    src["samples"] = MsgPackTypedArray(samples, 3);
+    std::string msgpack;
+    serializeMsgPack(src, msgpack);
+    deserializeMsgPack(doc, msgpack);
+
+    int16_t out[4] = {0, 0, 0, 99};
+    REQUIRE(copyTypedArray(doc["samples"], out) == 3);
+    REQUIRE(out[0] == 10);
+    REQUIRE(out[1] == -20);
+    REQUIRE(out[2] == 30);
+    REQUIRE(out[3] == 99);
+  }
+
+  SECTION("big-endian payload") {
+    deserializeMsgPack(doc, "\xC7\x05\x54\x80\x00\x01\xFF\xFE"_s);
+
+    int16_t out[2];
+    REQUIRE(copyTypedArray(doc.as<JsonVariantConst>(), out) == 2);
+    REQUIRE(out[0] == 1);
+    REQUIRE(out[1] == -2);
+  }
+
+  SECTION("truncates to the destination") {
+    deserializeMsgPack(doc, "\xC7\x05\x54\x00\x01\x00\x02\x00"_s);
+
+    int16_t out[1];
+    REQUIRE(copyTypedArray(doc.as<JsonVariantConst>(), out) == 1);
+    REQUIRE(out[0] == 1);
+  }
+
+  SECTION("other element type") {
+    deserializeMsgPack(doc, "\xC7\x05\x54\x01\x00\x00\xC0\x3F"_s);
+
+    int16_t ints[2];
+    REQUIRE(copyTypedArray(doc.as<JsonVariantConst>(), ints) == 0);
+    float floats[2];
+    REQUIRE(copyTypedArray(doc.as<JsonVariantConst>(), floats) == 1);
+    REQUIRE(floats[0] == 1.5f);
+  }
+
+  SECTION("other extension type") {
+    deserializeMsgPack(doc, "\xC7\x03\x01\x00\x01\x00"_s);
+
+    int16_t out[2];
+    REQUIRE(copyTypedArray(doc.as<JsonVariantConst>(), out) == 0);
+  }
+
+  SECTION("plain array") {
+    deserializeJson(doc, "[5,6]");
+
+    int16_t out[2];
+    REQUIRE(copyTypedArray(doc.as<JsonVariantConst>(), out) == 2);
+    REQUIRE(out[1] == 6);
+  }
+}
@@ -0,0 +1,46 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#include <ArduinoJson/Memory/ResourceManager.hpp>
+#include <ArduinoJson/Memory/ResourceManagerImpl.hpp>
+#include <catch.hpp>
+
+#include "Allocators.hpp"
+
+using namespace ArduinoJson::detail;
+
+TEST_CASE("Slot footprint") {
+  SECTION("A variant is its content, type and next id, padded") {
+    size_t align = alignof(VariantData);
+    size_t raw = sizeof(VariantContent) + sizeof(VariantType) + sizeof(SlotId);
+    REQUIRE(sizeof(VariantData) == (raw + align - 1) / align * align);
+  }
+
+  SECTION("The content is one pointer or one 32-bit value") {
+    REQUIRE(sizeof(VariantContent) == (sizeof(void*) > 4 ? sizeof(void*) : 4));
+  }
+
+  SECTION("A pool is its slots and nothing else") {
+    REQUIRE(sizeofPool() == ARDUINOJSON_POOL_CAPACITY * sizeof(VariantData));
+  }
+
+  SECTION("Each value costs one slot") {
+    ResourceManager resources;
+    resources.allocVariant();
+    resources.allocVariant();
+    REQUIRE(resources.size() == 2 * sizeof(VariantData));
+  }
+
+#if ARDUINOJSON_USE_EXTENSIONS
+  SECTION("A 64-bit value takes a second slot, no larger than a variant") {
+    REQUIRE(sizeof(VariantExtension) <= sizeof(VariantData));
+  }
+#endif
+
+#if ARDUINOJSON_SIZEOF_POINTER == 4
+  SECTION("8 bytes per slot on 32-bit MCUs") {
+    REQUIRE(sizeof(VariantData) == 8);
+  }
+#endif
+}
@@ -0,0 +1,57 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#include <catch.hpp>
+#include <limits>
+#include <string>
+
+#define ARDUINOJSON_FIXED_DECIMAL_PLACES 4
+#define ARDUINOJSON_ENABLE_INFINITY 1
+#include <ArduinoJson/Json/TextFormatter.hpp>
+#include <ArduinoJson/Serialization/Writer.hpp>
+
+using namespace ArduinoJson::detail;
+
+template <typename TFloat>
+static void checkFixed(TFloat input, const std::string& expected) {
+  std::string output;
+  Writer<std::string> sb(output);
+  TextFormatter<Writer<std::string>> writer(sb);
+  writer.writeFloat(input);
+  REQUIRE(writer.bytesWritten() == output.size());
+  CHECK(expected == output);
+}
+
+TEST_CASE("ARDUINOJSON_FIXED_DECIMAL_PLACES == 4") {
+  SECTION("Rounds to four places") {
+    checkFixed<double>(3.14159265359, "3.1416");
+    checkFixed<float>(3.14159265359f, "3.1416");
+    checkFixed<double>(-0.12345, "-0.1235");
+    checkFixed<double>(0.99996, "1");
+  }
+
+  SECTION("Trims trailing zeros") {
+    checkFixed<double>(0.5, "0.5");
+    checkFixed<double>(42.0, "42");
+    checkFixed<float>(0.1f, "0.1");
+  }
+
+  SECTION("Small values") {
+    checkFixed<double>(0.00004, "0");
+    checkFixed<double>(-0.00004, "0");
+    checkFixed<double>(0.00005, "0.0001");
+  }
+
+  SECTION("Large values") {
+    checkFixed<double>(9999999.0, "9999999");
+    checkFixed<double>(123456.789, "123456.789");
+    checkFixed<double>(1e7, "1e7");
+    checkFixed<double>(-1e9, "-1e9");
+  }
+
+  SECTION("Infinity") {
+    checkFixed<double>(std::numeric_limits<double>::infinity(), "Infinity");
+    checkFixed<double>(-std::numeric_limits<double>::infinity(), "-Infinity");
+  }
+}
@@ -0,0 +1,60 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#include <catch.hpp>
+#include <string>
+
+#include <ArduinoJson/Json/TextFormatter.hpp>
+#include <ArduinoJson/Serialization/Writer.hpp>
+
+using namespace ArduinoJson::detail;
+
+static std::string writeFixed(int32_t value, uint32_t unit, int8_t places) {
+  std::string output;
+  Writer<std::string> sb(output);
+  TextFormatter<Writer<std::string>> writer(sb);
+  writer.writeFixed(value, unit, places);
+  REQUIRE(writer.bytesWritten() == output.size());
+  return output;
+}
+
+TEST_CASE("TextFormatter::writeFixed()") {
+  SECTION("Accelerometer LSB as g") {
+    CHECK(writeFixed(16384, 16384, 4) == "1");
+    CHECK(writeFixed(8192, 16384, 4) == "0.5");
+    CHECK(writeFixed(-8192, 16384, 4) == "-0.5");
+    CHECK(writeFixed(1, 16384, 4) == "0.0001");  // 0.000061
+    CHECK(writeFixed(-32768, 16384, 4) == "-2");
+    CHECK(writeFixed(32767, 16384, 4) == "1.9999");
+  }
+
+  SECTION("Rounds half up") {
+    CHECK(writeFixed(125, 1000, 2) == "0.13");
+    CHECK(writeFixed(-125, 1000, 2) == "-0.13");
+    CHECK(writeFixed(124, 1000, 2) == "0.12");
+  }
+
+  SECTION("Carries into the integral part") {
+    CHECK(writeFixed(19999, 10000, 3) == "2");
+    CHECK(writeFixed(-19999, 10000, 3) == "-2");
+  }
+
+  SECTION("Never writes -0") {
+    CHECK(writeFixed(0, 16384, 4) == "0");
+    CHECK(writeFixed(-1, 65536, 4) == "0");
+  }
+
+  SECTION("No decimal places") {
+    CHECK(writeFixed(25, 10, 0) == "3");
+    CHECK(writeFixed(-24, 10, 0) == "-2");
+  }
+
+  SECTION("Extremes") {
+    CHECK(writeFixed(INT32_MIN, 1, 0) == "-2147483648");
+    CHECK(writeFixed(INT32_MAX, 1, 9) == "2147483647");
+    CHECK(writeFixed(1, 3, 9) == "0.333333333");
+    CHECK(writeFixed(INT32_MAX, 0xFFFFFFFF, 9) == "0.5");
+    CHECK(writeFixed(-3, 0xFFFFFFFF, 9) == "-0.000000001");
+  }
+}
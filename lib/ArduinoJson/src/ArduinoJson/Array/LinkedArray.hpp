@@ -0,0 +1,80 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#pragma once
+
+#include <ArduinoJson/Namespace.hpp>
+
+#include <stddef.h>  // size_t
+#include <stdint.h>
+
+#if ARDUINOJSON_USE_EXTENSIONS
+
+ARDUINOJSON_BEGIN_PUBLIC_NAMESPACE
+
+// Numbers in a caller-owned buffer, serialized in place as an array (JSON
+// and MessagePack). The document only links to the buffer, in one variant
+// and one extension slot whatever its length, so the buffer must outlive
+// the document, as for a linked string. It reads back as neither a
+// JsonArray nor a number: it is for output. Up to 65535 elements.
+class LinkedArray {
+ public:
+  enum class Type : uint8_t { Int16, Float };
+
+  LinkedArray(const int16_t* data, size_t size)
+      : data_(data), size_(size), type_(Type::Int16) {}
+
+  LinkedArray(const float* data, size_t size)
+      : data_(data), size_(size), type_(Type::Float) {}
+
+  const void* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  Type type() const {
+    return type_;
+  }
+
+ private:
+  const void* data_;
+  size_t size_;
+  Type type_;
+};
+
+// A LinkedArray that serializeMsgPack() writes as one typed-array extension
+// (ext type ARDUINOJSON_MSGPACK_TYPED_ARRAY_TYPE) instead of element by
+// element: the payload is one descriptor byte, then the buffer as is. The
+// descriptor holds the element type (MsgPackTypedArray::Int16 or ::Float, low
+// nibble) and MsgPackTypedArray::BigEndian if the bytes are big-endian.
+// serializeJson() still writes a plain array. copyTypedArray() reads one
+// back (MsgPack/MsgPackTypedArray.hpp).
+class MsgPackTypedArray : public LinkedArray {
+ public:
+  static const uint8_t Int16 = 0x00;
+  static const uint8_t Float = 0x01;
+  static const uint8_t BigEndian = 0x80;
+
+  MsgPackTypedArray(const int16_t* data, size_t size)
+      : LinkedArray(data, size) {}
+
+  MsgPackTypedArray(const float* data, size_t size)
+      : LinkedArray(data, size) {}
+
+  size_t elementSize() const {
+    return type() == Type::Float ? 4 : 2;
+  }
+
+  uint8_t descriptor() const {
+    return uint8_t((type() == Type::Float ? Float : Int16) |
+                   (ARDUINOJSON_LITTLE_ENDIAN ? 0 : BigEndian));
+  }
+};
+
+ARDUINOJSON_END_PUBLIC_NAMESPACE
+
+#endif
@@ -67,10 +67,19 @@
 #  endif
 #endif
 
+// Compact embedded profile: float and 32-bit integers, and one-byte slot ids,
+// whatever the pointer size. Numbers never need an extension slot (so
+// LinkedArray and MsgPackTypedArray are unavailable), pools shrink to 16
+// slots, and a document holds at most 255 values.
+#ifndef ARDUINOJSON_COMPACT_PROFILE
+#  define ARDUINOJSON_COMPACT_PROFILE 0
+#endif
+
 // Store floating-point values with float (0) or double (1)
 // https://arduinojson.org/v7/config/use_double/
 #ifndef ARDUINOJSON_USE_DOUBLE
-#  if ARDUINOJSON_SIZEOF_POINTER >= 4  // 32 & 64 bits systems
+#  if ARDUINOJSON_SIZEOF_POINTER >= 4 && \
+      !ARDUINOJSON_COMPACT_PROFILE  // 32 & 64 bits systems
 #    define ARDUINOJSON_USE_DOUBLE 1
 #  else
 #    define ARDUINOJSON_USE_DOUBLE 0
@@ -80,7 +89,8 @@
 // Store integral values with long (0) or long long (1)
 // https://arduinojson.org/v7/config/use_long_long/
 #ifndef ARDUINOJSON_USE_LONG_LONG
-#  if ARDUINOJSON_SIZEOF_POINTER >= 4  // 32 & 64 bits systems
+#  if ARDUINOJSON_SIZEOF_POINTER >= 4 && \
+      !ARDUINOJSON_COMPACT_PROFILE  // 32 & 64 bits systems
 #    define ARDUINOJSON_USE_LONG_LONG 1
 #  else
 #    define ARDUINOJSON_USE_LONG_LONG 0
@@ -96,8 +106,8 @@
 // Number of bytes to store a slot id
 // https://arduinojson.org/v7/config/slot_id_size/
 #ifndef ARDUINOJSON_SLOT_ID_SIZE
-#  if ARDUINOJSON_SIZEOF_POINTER <= 2
-//   8-bit and 16-bit archs => up to 255 slots
+#  if ARDUINOJSON_SIZEOF_POINTER <= 2 || ARDUINOJSON_COMPACT_PROFILE
+//   8-bit and 16-bit archs, or compact profile => up to 255 slots
 #    define ARDUINOJSON_SLOT_ID_SIZE 1
 #  elif ARDUINOJSON_SIZEOF_POINTER == 4
 //   32-bit arch => up to 65535 slots
@@ -232,12 +242,25 @@
 #  define ARDUINOJSON_POSITIVE_EXPONENTIATION_THRESHOLD 1e7
 #endif
 
+// Write floating-point values with at most this many decimal places (1-9),
+// rounded from one scaled integer instead of decomposed with float math;
+// 0 keeps the default. Values beyond the positive exponentiation threshold
+// are written as usual.
+#ifndef ARDUINOJSON_FIXED_DECIMAL_PLACES
+#  define ARDUINOJSON_FIXED_DECIMAL_PLACES 0
+#endif
+
 // Control the exponentiation threshold for small numbers
 // https://arduinojson.org/v7/config/negative_exponentiation_threshold/
 #ifndef ARDUINOJSON_NEGATIVE_EXPONENTIATION_THRESHOLD
 #  define ARDUINOJSON_NEGATIVE_EXPONENTIATION_THRESHOLD 1e-5
 #endif
 
+// MessagePack extension type of a MsgPackTypedArray
+#ifndef ARDUINOJSON_MSGPACK_TYPED_ARRAY_TYPE
+#  define ARDUINOJSON_MSGPACK_TYPED_ARRAY_TYPE 0x54
+#endif
+
 #ifndef ARDUINOJSON_LITTLE_ENDIAN
 #  if defined(_MSC_VER) ||                           \
       (defined(__BYTE_ORDER__) &&                    \
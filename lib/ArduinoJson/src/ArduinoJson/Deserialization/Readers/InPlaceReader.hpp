@@ -0,0 +1,47 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#pragma once
+
+#include <ArduinoJson/Polyfills/type_traits.hpp>
+
+ARDUINOJSON_BEGIN_PRIVATE_NAMESPACE
+
+// Reads a mutable buffer that the deserializer may decode strings over, see
+// deserializeJsonInPlace()
+class InPlaceReader {
+ public:
+  InPlaceReader(char* begin, char* end) : ptr_(begin), end_(end) {}
+
+  int read() {
+    if (ptr_ < end_)
+      return static_cast<unsigned char>(*ptr_++);
+    else
+      return -1;
+  }
+
+  size_t readBytes(char* buffer, size_t length) {
+    size_t i = 0;
+    while (i < length && ptr_ < end_)
+      buffer[i++] = *ptr_++;
+    return i;
+  }
+
+  // The next byte read() returns
+  char* position() const {
+    return ptr_;
+  }
+
+ private:
+  char* ptr_;
+  char* end_;
+};
+
+template <typename TReader>
+struct IsInPlaceReader : false_type {};
+
+template <>
+struct IsInPlaceReader<InPlaceReader> : true_type {};
+
+ARDUINOJSON_END_PRIVATE_NAMESPACE
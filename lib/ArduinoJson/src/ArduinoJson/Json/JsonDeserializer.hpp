@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <ArduinoJson/Deserialization/Readers/InPlaceReader.hpp>
 #include <ArduinoJson/Deserialization/deserialize.hpp>
 #include <ArduinoJson/Json/EscapeSequence.hpp>
 #include <ArduinoJson/Json/Latch.hpp>
@@ -373,18 +374,23 @@ class JsonDeserializer {
   DeserializationError::Code parseKey() {
     stringBuilder_.startString();
     if (isQuote(current())) {
-      return parseQuotedString();
+      return parseQuotedString(stringBuilder_);
     } else {
       return parseNonQuotedString();
     }
   }
 
   DeserializationError::Code parseStringValue(VariantData& variant) {
+    return parseStringValue(variant, IsInPlaceReader<TReader>());
+  }
+
+  DeserializationError::Code parseStringValue(VariantData& variant,
+                                              false_type) {
     DeserializationError::Code err;
 
     stringBuilder_.startString();
 
-    err = parseQuotedString();
+    err = parseQuotedString(stringBuilder_);
     if (err)
       return err;
 
@@ -393,7 +399,48 @@ class JsonDeserializer {
     return DeserializationError::Ok;
   }
 
-  DeserializationError::Code parseQuotedString() {
+  // Decodes the string over itself, just after its opening quote, and links
+  // the variant to it. Unescaping only shrinks the text, so the writes never
+  // overtake the reads, and the terminator lands on the closing quote at the
+  // latest.
+  DeserializationError::Code parseStringValue(VariantData& variant,
+                                              true_type) {
+    current();  // the opening quote, so the reader is just past it
+    InPlaceStringWriter writer(latch_.reader().position());
+
+    auto err = parseQuotedString(writer);
+    if (err)
+      return err;
+
+    variant.setLinkedString(writer.terminate());
+
+    return DeserializationError::Ok;
+  }
+
+  class InPlaceStringWriter {
+   public:
+    explicit InPlaceStringWriter(char* begin) : begin_(begin), end_(begin) {}
+
+    void append(char c) {
+      *end_++ = c;
+    }
+
+    bool isValid() const {
+      return true;
+    }
+
+    const char* terminate() {
+      *end_ = 0;
+      return begin_;
+    }
+
+   private:
+    char* begin_;
+    char* end_;
+  };
+
+  template <typename TStringWriter>
+  DeserializationError::Code parseQuotedString(TStringWriter& writer) {
 #if ARDUINOJSON_DECODE_UNICODE
     Utf16::Codepoint codepoint;
     DeserializationError::Code err;
@@ -424,9 +471,9 @@ class JsonDeserializer {
           if (err)
             return err;
           if (codepoint.append(codeunit))
-            Utf8::encodeCodepoint(codepoint.value(), stringBuilder_);
+            Utf8::encodeCodepoint(codepoint.value(), writer);
 #else
-          stringBuilder_.append('\\');
+          writer.append('\\');
 #endif
           continue;
         }
@@ -438,10 +485,10 @@ class JsonDeserializer {
         move();
       }
 
-      stringBuilder_.append(c);
+      writer.append(c);
     }
 
-    if (!stringBuilder_.isValid())
+    if (!writer.isValid())
       return DeserializationError::NoMemory;
 
     return DeserializationError::Ok;
@@ -507,14 +554,52 @@ class JsonDeserializer {
   DeserializationError::Code parseNumericValue(VariantData& result) {
     uint8_t n = 0;
 
+    // Fast path for what config replies are made of: -?digits(.digits)? with
+    // few digits, accumulated in 32 bits while the characters are copied.
+    // Anything else (exponent, long numbers, NaN...) goes to parseNumber().
+    uint32_t mantissa = 0;
+    uint8_t digits = 0;
+    int8_t decimals = -1;  // no decimal point yet
+    bool negative = false;
+    bool simple = true;
+
     char c = current();
     while (canBeInNumber(c) && n < 63) {
+      if (isdigit(c) && digits < 9) {
+        mantissa = mantissa * 10 + uint8_t(c - '0');
+        digits++;
+        if (decimals >= 0)
+          decimals++;
+      } else if (c == '.' && decimals < 0 && digits > 0) {
+        decimals = 0;
+      } else if (c == '-' && n == 0) {
+        negative = true;
+      } else {
+        simple = false;
+      }
       move();
       buffer_[n++] = c;
       c = current();
     }
     buffer_[n] = 0;
 
+    if (simple && digits > 0 && decimals < 0) {
+      // At most 9 digits, so it fits in any JsonInteger
+      bool ok = negative
+                    ? result.setInteger(-JsonInteger(mantissa), resources_)
+                    : result.setInteger(JsonUInt(mantissa), resources_);
+      return ok ? DeserializationError::Ok : DeserializationError::NoMemory;
+    }
+
+    // Up to 6 digits is what parseNumber() turns into a float too, with the
+    // same make_float() call, so the result is identical
+    if (simple && decimals > 0 && digits <= 6) {
+      float value = make_float(float(mantissa), int8_t(-decimals));
+      return result.setFloat(negative ? -value : value, resources_)
+                 ? DeserializationError::Ok
+                 : DeserializationError::NoMemory;
+    }
+
     auto number = parseNumber(buffer_);
     switch (number.type()) {
       case NumberType::UnsignedInteger:
@@ -705,6 +790,39 @@ inline DeserializationError deserializeJson(TDestination&& dst,
                                        detail::forward<Args>(args)...);
 }
 
+// Parses a mutable JSON buffer, filters, and puts the result in a
+// JsonDocument. String values are decoded in place and the document links to them, so only
+// keys are copied; the buffer is modified and must outlive the document. A
+// value containing \u0000 ends there.
+template <typename TDestination, typename... Args,
+          detail::enable_if_t<
+              detail::is_deserialize_destination<TDestination>::value &&
+                  !detail::is_integral<
+                      typename detail::first_or_void<Args...>::type>::value,
+              int> = 0>
+inline DeserializationError deserializeJsonInPlace(TDestination&& dst,
+                                                   char* input,
+                                                   Args... args) {
+  using namespace detail;
+  return doDeserialize<JsonDeserializer>(
+      dst, InPlaceReader(input, input ? input + strlen(input) : input),
+      makeDeserializationOptions(args...));
+}
+
+template <typename TDestination, typename Size, typename... Args,
+          detail::enable_if_t<
+              detail::is_deserialize_destination<TDestination>::value &&
+                  detail::is_integral<Size>::value,
+              int> = 0>
+inline DeserializationError deserializeJsonInPlace(TDestination&& dst,
+                                                   char* input, Size inputSize,
+                                                   Args... args) {
+  using namespace detail;
+  return doDeserialize<JsonDeserializer>(
+      dst, InPlaceReader(input, input ? input + size_t(inputSize) : input),
+      makeDeserializationOptions(args...));
+}
+
 // Parses a JSON input, filters, and puts the result in a JsonDocument.
 // https://arduinojson.org/v7/api/json/deserializejson/
 template <typename TDestination, typename TChar, typename... Args,
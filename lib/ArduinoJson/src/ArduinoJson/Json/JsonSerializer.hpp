@@ -62,6 +62,22 @@ class JsonSerializer : public VariantDataVisitor<size_t> {
     return bytesWritten();
   }
 
+#if ARDUINOJSON_USE_EXTENSIONS
+  size_t visit(const LinkedArray& array) {
+    write('[');
+    for (size_t i = 0; i < array.size(); i++) {
+      if (i)
+        write(',');
+      if (array.type() == LinkedArray::Type::Float)
+        formatter_.writeFloat(static_cast<const float*>(array.data())[i]);
+      else
+        formatter_.writeInteger(static_cast<const int16_t*>(array.data())[i]);
+    }
+    write(']');
+    return bytesWritten();
+  }
+#endif
+
   template <typename T>
   enable_if_t<is_floating_point<T>::value, size_t> visit(T value) {
     formatter_.writeFloat(value);
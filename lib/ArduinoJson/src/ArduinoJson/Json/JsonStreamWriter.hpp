@@ -0,0 +1,213 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#pragma once
+
+#include <ArduinoJson/Json/JsonSerializer.hpp>
+#include <ArduinoJson/Json/TextFormatter.hpp>
+#include <ArduinoJson/Misc/ScaledInt16.hpp>
+#include <ArduinoJson/Misc/SerializedValue.hpp>
+#include <ArduinoJson/Serialization/Writer.hpp>
+#include <ArduinoJson/Serialization/Writers/DummyWriter.hpp>
+#include <ArduinoJson/Strings/IsString.hpp>
+#include <ArduinoJson/Strings/StringAdapters.hpp>
+
+ARDUINOJSON_BEGIN_PUBLIC_NAMESPACE
+
+// Writes minified JSON as it is called, straight to the destination (a
+// Print, std::string, std::ostream...), without a JsonDocument: memory use
+// is one separator flag whatever the output size. Commas and colons are
+// inserted; matching begin/end calls and a key before each member's value
+// are up to the caller.
+//
+//   JsonStreamWriter<Print> json(client);
+//   json.beginObject().key("id").value(id).key("samples").beginArray();
+//   for (...) json.value(sample);
+//   json.endArray().endObject();
+//
+// Without a destination, JsonStreamWriter<> only counts: run the same
+// calls through it first to get Content-Length, then bytesWritten().
+template <typename TDestination = detail::DummyWriter>
+class JsonStreamWriter {
+  using writer_type = detail::Writer<TDestination>;
+
+ public:
+  explicit JsonStreamWriter(TDestination& destination)
+      : formatter_(writer_type(destination)) {}
+
+  JsonStreamWriter() : JsonStreamWriter(sink()) {}
+
+  JsonStreamWriter& beginObject() {
+    separate();
+    formatter_.writeRaw('{');
+    comma_ = false;
+    return *this;
+  }
+
+  JsonStreamWriter& endObject() {
+    formatter_.writeRaw('}');
+    comma_ = true;
+    return *this;
+  }
+
+  JsonStreamWriter& beginArray() {
+    separate();
+    formatter_.writeRaw('[');
+    comma_ = false;
+    return *this;
+  }
+
+  JsonStreamWriter& endArray() {
+    formatter_.writeRaw(']');
+    comma_ = true;
+    return *this;
+  }
+
+  // Member name; the next call writes its value
+  template <typename TString>
+  detail::enable_if_t<detail::IsString<TString>::value, JsonStreamWriter&> key(
+      const TString& name) {
+    separate();
+    writeString(detail::adaptString(name));
+    formatter_.writeRaw(':');
+    comma_ = false;
+    return *this;
+  }
+
+  template <typename TString>
+  detail::enable_if_t<detail::IsString<TString>::value, JsonStreamWriter&>
+  value(const TString& s) {
+    separate();
+    auto adapted = detail::adaptString(s);
+    if (adapted.isNull())
+      formatter_.writeRaw("null");
+    else
+      writeString(adapted);
+    return *this;
+  }
+
+  template <typename T>
+  detail::enable_if_t<detail::is_integral<T>::value &&
+                          !detail::is_same<T, bool>::value,
+                      JsonStreamWriter&>
+  value(T n) {
+    separate();
+    formatter_.writeInteger(n);
+    return *this;
+  }
+
+  template <typename T>
+  detail::enable_if_t<detail::is_floating_point<T>::value, JsonStreamWriter&>
+  value(T x) {
+    separate();
+    formatter_.writeFloat(x);
+    return *this;
+  }
+
+  // At most decimalPlaces decimals, e.g. 4 for g
+  template <typename T>
+  detail::enable_if_t<detail::is_floating_point<T>::value, JsonStreamWriter&>
+  value(T x, int8_t decimalPlaces) {
+    separate();
+    formatter_.writeFloat(JsonFloat(x), decimalPlaces);
+    return *this;
+  }
+
+  JsonStreamWriter& value(bool b) {
+    separate();
+    formatter_.writeBoolean(b);
+    return *this;
+  }
+
+  JsonStreamWriter& value(decltype(nullptr)) {
+    separate();
+    formatter_.writeRaw("null");
+    return *this;
+  }
+
+  // value / unit with integer math only, null if unit is 0
+  JsonStreamWriter& value(ScaledInt16 x) {
+    separate();
+    if (!x.unit()) {
+      formatter_.writeRaw("null");
+      return *this;
+    }
+    formatter_.writeFixed(x.value(), x.unit(),
+                          static_cast<int8_t>(x.decimalPlaces() > 9
+                                                  ? 9
+                                                  : x.decimalPlaces()));
+    return *this;
+  }
+
+  // Pregenerated JSON, written as is
+  template <typename T>
+  JsonStreamWriter& value(SerializedValue<T> json) {
+    separate();
+    formatter_.writeRaw(json.data(), json.size());
+    return *this;
+  }
+
+  // A JsonDocument or part of one
+  JsonStreamWriter& value(JsonVariantConst variant) {
+    separate();
+    detail::doSerialize<detail::JsonSerializer>(variant,
+                                                FormatterWriter{&formatter_});
+    return *this;
+  }
+
+  // Each element as a value, for arrays of numbers
+  template <typename T>
+  JsonStreamWriter& values(const T* items, size_t n) {
+    for (size_t i = 0; i < n; i++)
+      value(items[i]);
+    return *this;
+  }
+
+  size_t bytesWritten() const {
+    return formatter_.bytesWritten();
+  }
+
+ private:
+  using formatter_type = detail::TextFormatter<writer_type>;
+
+  // Sends a nested serializer's output through formatter_, so that it shares
+  // the destination writer and its count
+  struct FormatterWriter {
+    formatter_type* formatter;
+
+    size_t write(uint8_t c) {
+      formatter->writeRaw(static_cast<char>(c));
+      return 1;
+    }
+
+    size_t write(const uint8_t* s, size_t n) {
+      formatter->writeRaw(reinterpret_cast<const char*>(s), n);
+      return n;
+    }
+  };
+
+  static TDestination& sink() {
+    static TDestination instance;
+    return instance;
+  }
+
+  void separate() {
+    if (comma_)
+      formatter_.writeRaw(',');
+    comma_ = true;
+  }
+
+  template <typename TAdaptedString>
+  void writeString(const TAdaptedString& s) {
+    formatter_.writeRaw('"');
+    for (size_t i = 0; i < s.size(); i++)
+      formatter_.writeChar(s[i]);
+    formatter_.writeRaw('"');
+  }
+
+  formatter_type formatter_;
+  bool comma_ = false;
+};
+
+ARDUINOJSON_END_PUBLIC_NAMESPACE
@@ -25,6 +25,10 @@ class Latch {
     return current_;
   }
 
+  const TReader& reader() const {
+    return reader_;
+  }
+
   FORCE_INLINE char current() {
     if (!loaded_) {
       load();
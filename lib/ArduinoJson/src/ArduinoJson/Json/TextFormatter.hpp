@@ -73,6 +73,25 @@ class TextFormatter {
     if (isnan(value))
       return writeRaw(ARDUINOJSON_ENABLE_NAN ? "NaN" : "null");
 
+#if ARDUINOJSON_FIXED_DECIMAL_PLACES
+    // false for infinities
+    if (value > -ARDUINOJSON_POSITIVE_EXPONENTIATION_THRESHOLD &&
+        value < ARDUINOJSON_POSITIVE_EXPONENTIATION_THRESHOLD) {
+      const uint32_t factor = powerOfTen(ARDUINOJSON_FIXED_DECIMAL_PLACES);
+      bool negative = value < 0;
+      if (negative)
+        value = -value;
+      auto scaled = uint64_t(value * JsonFloat(factor) + JsonFloat(0.5));
+      if (scaled <= 0xFFFFFFFF)  // 32-bit division is much cheaper
+        return writeFixedParts(negative, uint32_t(scaled) / factor,
+                               uint32_t(scaled) % factor,
+                               ARDUINOJSON_FIXED_DECIMAL_PLACES);
+      return writeFixedParts(negative, scaled / factor,
+                             uint32_t(scaled % factor),
+                             ARDUINOJSON_FIXED_DECIMAL_PLACES);
+    }
+#endif
+
 #if ARDUINOJSON_ENABLE_INFINITY
     if (value < 0.0) {
       writeRaw('-');
@@ -103,6 +122,30 @@ class TextFormatter {
     }
   }
 
+  // Writes value / unit rounded to decimalPlaces (0-9), trailing zeros
+  // trimmed, with integer math only.
+  void writeFixed(int32_t value, uint32_t unit, int8_t decimalPlaces) {
+    ARDUINOJSON_ASSERT(unit > 0);
+    ARDUINOJSON_ASSERT(decimalPlaces >= 0 && decimalPlaces <= 9);
+    bool negative = value < 0;
+    uint32_t magnitude =
+        negative ? uint32_t(~uint32_t(value) + 1) : uint32_t(value);
+    uint32_t factor = powerOfTen(decimalPlaces);
+    uint32_t integral = magnitude / unit;
+    uint32_t remainder = magnitude % unit;
+    // round half up: (remainder * factor + unit / 2) / unit
+    uint32_t decimal =
+        remainder < 0x3FFFFFFF / factor && unit < 0x40000000
+            ? (remainder * factor * 2 + unit) / (unit * 2)
+            : uint32_t((uint64_t(remainder) * factor * 2 + unit) /
+                       (uint64_t(unit) * 2));
+    if (decimal == factor) {
+      integral++;
+      decimal = 0;
+    }
+    writeFixedParts(negative, integral, decimal, decimalPlaces);
+  }
+
   template <typename T>
   enable_if_t<is_signed<T>::value> writeInteger(T value) {
     using unsigned_type = make_unsigned_t<T>;
@@ -149,6 +192,27 @@ class TextFormatter {
     writeRaw(begin, end);
   }
 
+  template <typename T>
+  void writeFixedParts(bool negative, T integral, uint32_t decimal,
+                       int8_t decimalPlaces) {
+    while (decimalPlaces > 0 && decimal % 10 == 0) {
+      decimal /= 10;
+      decimalPlaces--;
+    }
+    if (negative && (integral || decimalPlaces))  // no "-0"
+      writeRaw('-');
+    writeInteger(integral);
+    if (decimalPlaces)
+      writeDecimals(decimal, decimalPlaces);
+  }
+
+  static uint32_t powerOfTen(int8_t exponent) {
+    uint32_t result = 1;
+    while (exponent-- > 0)
+      result *= 10;
+    return result;
+  }
+
   void writeRaw(const char* s) {
     writer_.write(reinterpret_cast<const uint8_t*>(s), strlen(s));
   }
@@ -0,0 +1,129 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#pragma once
+
+#include <ArduinoJson/Memory/Alignment.hpp>
+#include <ArduinoJson/Memory/Allocator.hpp>
+
+#include <stdint.h>
+#include <string.h>  // memcpy
+
+ARDUINOJSON_BEGIN_PUBLIC_NAMESPACE
+
+// Bump allocator over a fixed buffer: allocate() and reset() are O(1) and the
+// heap is never touched, so documents built over and over don't fragment it.
+// deallocate() only gives back the most recent block (and reallocate() only
+// grows that one in place); anything else is reclaimed by reset().
+//
+//   static StaticArenaAllocator<2048> arena;
+//   {
+//     JsonDocument doc(&arena);
+//     ...
+//   }              // or doc.clear()
+//   arena.reset();  // every byte is free again
+//
+// reset() must only be called when no document still uses the arena.
+class ArenaAllocator : public Allocator {
+ public:
+  ArenaAllocator(void* buffer, size_t capacity)
+      : buffer_(detail::addPadding(static_cast<uint8_t*>(buffer))) {
+    size_t skipped = size_t(buffer_ - static_cast<uint8_t*>(buffer));
+    capacity_ = capacity > skipped ? capacity - skipped : 0;
+  }
+
+  virtual ~ArenaAllocator() {}
+
+  void* allocate(size_t size) override {
+    size_t total = blockSize(size);
+    if (size > capacity_ || total > capacity_ - used_)
+      return nullptr;
+    uint8_t* block = buffer_ + used_;
+    sizeOf(block) = size;
+    last_ = block;
+    used_ += total;
+    return block + headerSize;
+  }
+
+  void deallocate(void* ptr) override {
+    if (!ptr || blockOf(ptr) != last_)
+      return;
+    used_ = size_t(last_ - buffer_);
+    last_ = nullptr;
+  }
+
+  void* reallocate(void* ptr, size_t new_size) override {
+    if (!ptr)
+      return allocate(new_size);
+    uint8_t* block = blockOf(ptr);
+    size_t oldSize = sizeOf(block);
+    if (block == last_) {
+      size_t offset = size_t(block - buffer_);
+      size_t total = blockSize(new_size);
+      if (new_size > capacity_ || total > capacity_ - offset)
+        return nullptr;
+      sizeOf(block) = new_size;
+      used_ = offset + total;
+      return ptr;
+    }
+    if (new_size <= oldSize) {
+      sizeOf(block) = new_size;
+      return ptr;
+    }
+    void* copy = allocate(new_size);
+    if (copy)
+      memcpy(copy, ptr, oldSize);
+    return copy;
+  }
+
+  // Frees every block at once
+  void reset() {
+    used_ = 0;
+    last_ = nullptr;
+  }
+
+  // Bytes in use, block headers included
+  size_t used() const {
+    return used_;
+  }
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+ private:
+  static const size_t headerSize = detail::AddPadding<sizeof(size_t)>::value;
+
+  static size_t blockSize(size_t size) {
+    return headerSize + detail::addPadding(size);
+  }
+
+  static size_t& sizeOf(uint8_t* block) {
+    return *reinterpret_cast<size_t*>(block);
+  }
+
+  static uint8_t* blockOf(void* ptr) {
+    return static_cast<uint8_t*>(ptr) - headerSize;
+  }
+
+  uint8_t* buffer_;
+  size_t capacity_;
+  size_t used_ = 0;
+  uint8_t* last_ = nullptr;  // most recent block, if not freed since
+};
+
+// An ArenaAllocator with its own buffer of N bytes, e.g. as a static
+template <size_t N>
+class StaticArenaAllocator : public ArenaAllocator {
+ public:
+  StaticArenaAllocator() : ArenaAllocator(storage_, sizeof(storage_)) {}
+
+  StaticArenaAllocator(const StaticArenaAllocator&) = delete;
+  StaticArenaAllocator& operator=(const StaticArenaAllocator&) = delete;
+
+ private:
+  void* storage_[(N + sizeof(void*) - 1) / sizeof(void*)];  // pointer-aligned
+};
+
+ARDUINOJSON_END_PUBLIC_NAMESPACE
@@ -0,0 +1,60 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#pragma once
+
+#include <ArduinoJson/Json/TextFormatter.hpp>
+#include <ArduinoJson/Serialization/Writers/StaticStringWriter.hpp>
+#include <ArduinoJson/Variant/Converter.hpp>
+
+ARDUINOJSON_BEGIN_PUBLIC_NAMESPACE
+
+// A raw integer reading to be written as value / unit, e.g. accelerometer
+// LSB as g. The decimal text is formatted with integer math only and stored
+// like serialized(), so it suits JSON output, not MessagePack.
+class ScaledInt16 {
+ public:
+  ScaledInt16(int16_t value, uint16_t unit, uint8_t decimalPlaces = 4)
+      : value_(value), unit_(unit), decimalPlaces_(decimalPlaces) {}
+
+  int16_t value() const {
+    return value_;
+  }
+
+  uint16_t unit() const {
+    return unit_;
+  }
+
+  uint8_t decimalPlaces() const {
+    return decimalPlaces_;
+  }
+
+ private:
+  int16_t value_;
+  uint16_t unit_;
+  uint8_t decimalPlaces_;
+};
+
+template <>
+struct Converter<ScaledInt16> : private detail::VariantAttorney {
+  static void toJson(ScaledInt16 src, JsonVariant dst) {
+    auto data = getData(dst);
+    if (!data)
+      return;
+    auto resources = getResourceManager(dst);
+    data->clear(resources);
+    if (!src.unit())
+      return;
+    char buffer[24];  // "-32768" and up to 9 decimals
+    detail::StaticStringWriter writer(buffer, sizeof(buffer));
+    detail::TextFormatter<detail::StaticStringWriter> formatter(writer);
+    formatter.writeFixed(
+        src.value(), src.unit(),
+        static_cast<int8_t>(src.decimalPlaces() > 9 ? 9 : src.decimalPlaces()));
+    data->setRawString(serialized(buffer, formatter.bytesWritten()),
+                       resources);
+  }
+};
+
+ARDUINOJSON_END_PUBLIC_NAMESPACE
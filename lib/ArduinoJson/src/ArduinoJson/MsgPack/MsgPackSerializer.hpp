@@ -48,16 +48,7 @@ class MsgPackSerializer : public VariantDataVisitor<size_t> {
   }
 
   size_t visit(const ArrayData& array) {
-    size_t n = array.size(resources_);
-    if (n < 0x10) {
-      writeByte(uint8_t(0x90 + n));
-    } else if (n < 0x10000) {
-      writeByte(0xDC);
-      writeInteger(uint16_t(n));
-    } else {
-      writeByte(0xDD);
-      writeInteger(uint32_t(n));
-    }
+    writeArrayHeader(array.size(resources_));
 
     auto slotId = array.head();
     while (slotId != NULL_SLOT) {
@@ -69,6 +60,40 @@ class MsgPackSerializer : public VariantDataVisitor<size_t> {
     return bytesWritten();
   }
 
+#if ARDUINOJSON_USE_EXTENSIONS
+  size_t visit(const LinkedArray& array) {
+    writeArrayHeader(array.size());
+    for (size_t i = 0; i < array.size(); i++) {
+      if (array.type() == LinkedArray::Type::Float)
+        visit(static_cast<const float*>(array.data())[i]);
+      else
+        visit(JsonInteger(static_cast<const int16_t*>(array.data())[i]));
+    }
+    return bytesWritten();
+  }
+
+  size_t visit(const MsgPackTypedArray& array) {
+    size_t n = array.size() * array.elementSize();
+    size_t payloadSize = n + 1;  // and the descriptor
+    if (payloadSize == 1) {
+      writeByte(0xD4);  // fixext 1
+    } else if (payloadSize < 0x100) {
+      writeByte(0xC7);  // ext 8
+      writeByte(uint8_t(payloadSize));
+    } else if (payloadSize < 0x10000) {
+      writeByte(0xC8);  // ext 16
+      writeInteger(uint16_t(payloadSize));
+    } else {
+      writeByte(0xC9);  // ext 32
+      writeInteger(uint32_t(payloadSize));
+    }
+    writeByte(uint8_t(ARDUINOJSON_MSGPACK_TYPED_ARRAY_TYPE));
+    writeByte(array.descriptor());
+    writeBytes(reinterpret_cast<const uint8_t*>(array.data()), n);
+    return bytesWritten();
+  }
+#endif
+
   size_t visit(const ObjectData& object) {
     size_t n = object.size(resources_);
     if (n < 0x10) {
@@ -194,6 +219,18 @@ class MsgPackSerializer : public VariantDataVisitor<size_t> {
     return writer_.count();
   }
 
+  void writeArrayHeader(size_t n) {
+    if (n < 0x10) {
+      writeByte(uint8_t(0x90 + n));
+    } else if (n < 0x10000) {
+      writeByte(0xDC);
+      writeInteger(uint16_t(n));
+    } else {
+      writeByte(0xDD);
+      writeInteger(uint32_t(n));
+    }
+  }
+
   void writeByte(uint8_t c) {
     writer_.write(c);
   }
@@ -0,0 +1,105 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#pragma once
+
+#include <ArduinoJson/Array/LinkedArray.hpp>
+#include <ArduinoJson/Array/Utilities.hpp>
+#include <ArduinoJson/Variant/Converter.hpp>
+
+#if ARDUINOJSON_USE_EXTENSIONS
+
+#  include <string.h>  // memcpy
+
+ARDUINOJSON_BEGIN_PUBLIC_NAMESPACE
+
+template <>
+struct Converter<MsgPackTypedArray> : private detail::VariantAttorney {
+  static bool toJson(MsgPackTypedArray src, JsonVariant dst) {
+    auto data = getData(dst);
+    if (!data)
+      return false;
+    auto resources = getResourceManager(dst);
+    data->clear(resources);
+    return data->setLinkedArray(src, resources, true);
+  }
+};
+
+namespace detail {
+template <typename T>
+inline size_t copyTypedArray(JsonVariantConst src, T* dst, size_t len,
+                             uint8_t elementType) {
+  auto data = VariantAttorney::getData(src);
+  if (!data)
+    return 0;
+
+  // A plain array, as deserializeJson() gives
+  if (data->isArray())
+    return copyArray(src.as<JsonArrayConst>(), dst, len);
+
+  // The extension as deserializeMsgPack() stores it, header included
+  auto raw = data->asRawString();
+  auto p = reinterpret_cast<const uint8_t*>(raw.c_str());
+  size_t headerSize, payloadSize = 0;
+  if (raw.size() >= 3 && p[0] == 0xc7) {  // ext 8
+    headerSize = 3;
+    payloadSize = p[1];
+  } else if (raw.size() >= 4 && p[0] == 0xc8) {  // ext 16
+    headerSize = 4;
+    payloadSize = size_t(p[1]) << 8 | p[2];
+  } else if (raw.size() >= 6 && p[0] == 0xc9) {  // ext 32
+    headerSize = 6;
+    for (uint8_t i = 1; i <= 4; i++)
+      payloadSize = payloadSize << 8 | p[i];
+  } else if (raw.size() == 3 && p[0] == 0xd4) {  // fixext 1: empty array
+    headerSize = 2;
+    payloadSize = 1;
+  } else {
+    return 0;
+  }
+  if (raw.size() != headerSize + payloadSize || payloadSize < 1 ||
+      p[headerSize - 1] != ARDUINOJSON_MSGPACK_TYPED_ARRAY_TYPE)
+    return 0;
+
+  uint8_t descriptor = p[headerSize];
+  if ((descriptor & 0x0F) != elementType)
+    return 0;
+  size_t n = (payloadSize - 1) / sizeof(T);
+  if (n > len)
+    n = len;
+  memcpy(dst, p + headerSize + 1, n * sizeof(T));
+  bool bigEndian = (descriptor & MsgPackTypedArray::BigEndian) != 0;
+  if (bigEndian == bool(ARDUINOJSON_LITTLE_ENDIAN)) {
+    for (size_t i = 0; i < n; i++) {
+      auto b = reinterpret_cast<uint8_t*>(dst + i);
+      for (size_t j = 0; j < sizeof(T) / 2; j++) {
+        uint8_t t = b[j];
+        b[j] = b[sizeof(T) - 1 - j];
+        b[sizeof(T) - 1 - j] = t;
+      }
+    }
+  }
+  return n;
+}
+}  // namespace detail
+
+// Copies a typed-array extension (see MsgPackTypedArray), or a plain array,
+// into dst in a single pass. Returns the number of elements copied, 0 if src
+// holds neither or a typed array of another element type.
+inline size_t copyTypedArray(JsonVariantConst src, int16_t* dst, size_t len) {
+  return detail::copyTypedArray(src, dst, len, MsgPackTypedArray::Int16);
+}
+
+inline size_t copyTypedArray(JsonVariantConst src, float* dst, size_t len) {
+  return detail::copyTypedArray(src, dst, len, MsgPackTypedArray::Float);
+}
+
+template <typename T, size_t N>
+inline size_t copyTypedArray(JsonVariantConst src, T (&dst)[N]) {
+  return copyTypedArray(src, dst, N);
+}
+
+ARDUINOJSON_END_PUBLIC_NAMESPACE
+
+#endif
@@ -10,7 +10,7 @@
 
 #ifndef ARDUINOJSON_VERSION_NAMESPACE
 
-#  define ARDUINOJSON_VERSION_NAMESPACE                               \
+#  define ARDUINOJSON_VERSION_NAMESPACE_                              \
     ARDUINOJSON_CONCAT5(                                              \
         ARDUINOJSON_VERSION_MACRO,                                    \
         ARDUINOJSON_BIN2ALPHA(ARDUINOJSON_ENABLE_PROGMEM,             \
@@ -21,6 +21,14 @@
             ARDUINOJSON_ENABLE_COMMENTS, ARDUINOJSON_DECODE_UNICODE), \
         ARDUINOJSON_SLOT_ID_SIZE, ARDUINOJSON_STRING_LENGTH_SIZE)
 
+#  if ARDUINOJSON_FIXED_DECIMAL_PLACES
+#    define ARDUINOJSON_VERSION_NAMESPACE                           \
+      ARDUINOJSON_CONCAT3(ARDUINOJSON_VERSION_NAMESPACE_, F, \
+                          ARDUINOJSON_FIXED_DECIMAL_PLACES)
+#  else
+#    define ARDUINOJSON_VERSION_NAMESPACE ARDUINOJSON_VERSION_NAMESPACE_
+#  endif
+
 #endif
 
 #define ARDUINOJSON_BEGIN_PUBLIC_NAMESPACE \
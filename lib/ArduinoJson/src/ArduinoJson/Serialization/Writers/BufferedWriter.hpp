@@ -0,0 +1,99 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2025, Benoit BLANCHON
+// MIT License
+
+#pragma once
+
+#include <ArduinoJson/Serialization/Writer.hpp>
+
+#include <string.h>  // memcpy
+
+#ifndef ARDUINOJSON_BUFFERED_WRITER_SIZE
+// One TCP segment on lwIP's default MSS
+#  define ARDUINOJSON_BUFFERED_WRITER_SIZE 536
+#endif
+
+ARDUINOJSON_BEGIN_PUBLIC_NAMESPACE
+
+// Collects the serializer's small writes (often one character each) into a
+// buffer of N bytes and hands the destination whole buffers, so a
+// WiFiClient sees a few lwIP calls, a segment each, rather than one per
+// token. The buffer is flushed when full, by flush(), and on destruction.
+//
+//   BufferedWriter<WiFiClient> out(client);
+//   serializeJson(doc, out);
+//   out.flush();  // before waiting for the response
+//
+// Once the destination takes less than it was given, the writer stops
+// accepting bytes, so serializeJson() returns less than measureJson().
+template <typename TDestination, size_t N = ARDUINOJSON_BUFFERED_WRITER_SIZE>
+class BufferedWriter {
+  static_assert(N > 0, "the buffer needs room");
+
+ public:
+  explicit BufferedWriter(TDestination& destination) : writer_(destination) {}
+
+  BufferedWriter(const BufferedWriter&) = delete;
+  BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+  ~BufferedWriter() {
+    flush();
+  }
+
+  size_t write(uint8_t c) {
+    if (failed_)
+      return 0;
+    buffer_[size_++] = c;
+    if (size_ == N)
+      flush();
+    return 1;
+  }
+
+  size_t write(const uint8_t* s, size_t n) {
+    size_t written = 0;
+    while (written < n && !failed_) {
+      size_t chunk = n - written;
+      if (size_ == 0 && chunk >= N) {
+        // Nothing to join it with: straight through
+        size_t taken = writer_.write(s + written, chunk);
+        writes_++;
+        written += taken;
+        failed_ = taken < chunk;
+        break;
+      }
+      if (chunk > N - size_)
+        chunk = N - size_;
+      memcpy(buffer_ + size_, s + written, chunk);
+      size_ += chunk;
+      written += chunk;
+      if (size_ == N)
+        flush();
+    }
+    return written;
+  }
+
+  // Hands the destination what is buffered; false if it took less, and
+  // from then on
+  bool flush() {
+    if (size_ > 0 && !failed_) {
+      failed_ = writer_.write(buffer_, size_) < size_;
+      writes_++;
+    }
+    size_ = 0;
+    return !failed_;
+  }
+
+  // Writes the destination has had so far
+  size_t destinationWrites() const {
+    return writes_;
+  }
+
+ private:
+  detail::Writer<TDestination> writer_;
+  uint8_t buffer_[N];
+  size_t size_ = 0;
+  size_t writes_ = 0;
+  bool failed_ = false;
+};
+
+ARDUINOJSON_END_PUBLIC_NAMESPACE
@@ -207,6 +207,20 @@ struct Converter<SerializedValue<T>> : private detail::VariantAttorney {
   }
 };
 
+#if ARDUINOJSON_USE_EXTENSIONS
+template <>
+struct Converter<LinkedArray> : private detail::VariantAttorney {
+  static bool toJson(LinkedArray src, JsonVariant dst) {
+    auto data = getData(dst);
+    if (!data)
+      return false;
+    auto resources = getResourceManager(dst);
+    data->clear(resources);
+    return data->setLinkedArray(src, resources);
+  }
+};
+#endif
+
 template <>
 struct Converter<detail::nullptr_t> : private detail::VariantAttorney {
   static void toJson(detail::nullptr_t, JsonVariant dst) {
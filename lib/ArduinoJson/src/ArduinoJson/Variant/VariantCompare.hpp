@@ -179,6 +179,12 @@ struct VariantComparer : ComparerBase {
     return reverseResult(comparer);
   }
 
+#if ARDUINOJSON_USE_EXTENSIONS
+  CompareResult visit(const LinkedArray&) {
+    return COMPARE_RESULT_DIFFER;  // linked for output, not compared
+  }
+#endif
+
  private:
   template <typename TComparer>
   CompareResult reverseResult(TComparer& comparer) {
@@ -7,6 +7,7 @@
 #include <stddef.h>  // size_t
 
 #include <ArduinoJson/Array/ArrayData.hpp>
+#include <ArduinoJson/Array/LinkedArray.hpp>
 #include <ArduinoJson/Numbers/JsonFloat.hpp>
 #include <ArduinoJson/Numbers/JsonInteger.hpp>
 #include <ArduinoJson/Object/ObjectData.hpp>
@@ -38,6 +39,9 @@ enum class VariantType : uint8_t {
 #endif
 #if ARDUINOJSON_USE_DOUBLE
   Double = 0x1E,  // 0001 1110
+#endif
+#if ARDUINOJSON_USE_EXTENSIONS
+  LinkedArray = 0x90,  // 1001 0000
 #endif
   Object = 0x20,
   Array = 0x40,
@@ -68,6 +72,14 @@ union VariantContent {
 };
 
 #if ARDUINOJSON_USE_EXTENSIONS
+// A LinkedArray, packed to fit a slot
+struct LinkedArrayData {
+  const void* data;
+  uint16_t size;
+  LinkedArray::Type type;
+  bool msgPackExtension;  // a MsgPackTypedArray
+};
+
 union VariantExtension {
 #  if ARDUINOJSON_USE_LONG_LONG
   uint64_t asUint64;
@@ -76,6 +88,7 @@ union VariantExtension {
 #  if ARDUINOJSON_USE_DOUBLE
   double asDouble;
 #  endif
+  LinkedArrayData asLinkedArray;
 };
 #endif
 
@@ -104,6 +104,24 @@ class VariantData {
       case VariantType::Boolean:
         return visit.visit(content_.asBoolean != 0);
 
+#if ARDUINOJSON_USE_EXTENSIONS
+      case VariantType::LinkedArray: {
+        auto& array = extension->asLinkedArray;
+        if (array.msgPackExtension)
+          return array.type == LinkedArray::Type::Float
+                     ? visit.visit(MsgPackTypedArray(
+                           static_cast<const float*>(array.data), array.size))
+                     : visit.visit(MsgPackTypedArray(
+                           static_cast<const int16_t*>(array.data),
+                           array.size));
+        if (array.type == LinkedArray::Type::Float)
+          return visit.visit(LinkedArray(
+              static_cast<const float*>(array.data), array.size));
+        return visit.visit(LinkedArray(
+            static_cast<const int16_t*>(array.data), array.size));
+      }
+#endif
+
       default:
         return visit.visit(nullptr);
     }
@@ -507,6 +525,11 @@ class VariantData {
     var->setRawString(value, resources);
   }
 
+#if ARDUINOJSON_USE_EXTENSIONS
+  bool setLinkedArray(LinkedArray value, ResourceManager* resources,
+                      bool msgPackExtension = false);
+#endif
+
   template <typename TAdaptedString>
   bool setString(TAdaptedString value, ResourceManager* resources);
 
@@ -606,4 +629,9 @@ class VariantData {
   }
 };
 
+#if ARDUINOJSON_USE_EXTENSIONS
+static_assert(sizeof(VariantExtension) <= sizeof(VariantData),
+              "a LinkedArray must not make the slots bigger");
+#endif
+
 ARDUINOJSON_END_PRIVATE_NAMESPACE
@@ -62,6 +62,24 @@ inline void VariantData::clear(ResourceManager* resources) {
 }
 
 #if ARDUINOJSON_USE_EXTENSIONS
+inline bool VariantData::setLinkedArray(LinkedArray value,
+                                        ResourceManager* resources,
+                                        bool msgPackExtension) {
+  ARDUINOJSON_ASSERT(type_ == VariantType::Null);  // must call clear() first
+  if (!value.data() || value.size() > 0xFFFF)
+    return false;
+  auto extension = resources->allocExtension();
+  if (!extension)
+    return false;
+  type_ = VariantType::LinkedArray;
+  content_.asSlotId = extension.id();
+  extension->asLinkedArray.data = value.data();
+  extension->asLinkedArray.size = uint16_t(value.size());
+  extension->asLinkedArray.type = value.type();
+  extension->asLinkedArray.msgPackExtension = msgPackExtension;
+  return true;
+}
+
 inline const VariantExtension* VariantData::getExtension(
     const ResourceManager* resources) const {
   return type_ & VariantTypeBits::ExtensionBit
@@ -88,6 +88,12 @@ THE SOFTWARE.
     // Originally offered to the i2cdevlib project at http://arduino.cc/forum/index.php/topic,68210.30.html
     TwoWire Wire;
 
+#elif I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO
+
+    #ifndef ESP8266
+        #error I2CDEV_ESP8266_GPIO drives the ESP8266 GPIO registers; use I2CDEV_ARDUINO_WIRE elsewhere
+    #endif
+
 #endif
 
 /** Default constructor.
@@ -218,7 +224,9 @@ int8_t I2Cdev::readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8
     #endif
 
     uint8_t count = 0;
+    uint8_t busStatus = 0;
     uint32_t t1 = millis();
+    uint32_t us0 = micros();
 
     #if (I2CDEV_IMPLEMENTATION == I2CDEV_ARDUINO_WIRE || I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_SBWIRE || I2CDEV_IMPLEMENTATION == I2CDEV_TEENSY_3X_WIRE)
         TwoWire *useWire = &Wire;
@@ -273,8 +281,8 @@ int8_t I2Cdev::readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8
             for (int k = 0; k < length; k += min((int)length, I2CDEVLIB_WIRE_BUFFER_LENGTH)) {
                 useWire->beginTransmission(devAddr);
                 useWire->write(regAddr);
-                useWire->endTransmission();
-                useWire->requestFrom((uint8_t)devAddr, (uint8_t)min((int)length - k, I2CDEVLIB_WIRE_BUFFER_LENGTH));
+                busStatus = useWire->endTransmission();
+                if (useWire->requestFrom((uint8_t)devAddr, (uint8_t)min((int)length - k, I2CDEVLIB_WIRE_BUFFER_LENGTH)) == 0 && !busStatus) busStatus = 2;
                 for (; useWire->available() && (timeout == 0 || millis() - t1 < timeout); count++) {
                     data[count] = useWire->read();
                     #ifdef I2CDEV_SERIAL_DEBUG
@@ -294,12 +302,24 @@ int8_t I2Cdev::readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8
             count = length; // success
         } else {
             count = -1; // error
+            busStatus = 4;
         }
 
+    #elif (I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO)
+
+        // One transaction with a repeated start, straight into data
+        (void)wireObj;
+        busStatus = Esp8266Wire::readBuf(devAddr, regAddr, data, length);
+        count = busStatus == 0 ? length : -1;
+
     #endif
 
     // check for timeout
-    if (timeout > 0 && millis() - t1 >= timeout && count < length) count = -1; // timeout
+    if (timeout > 0 && millis() - t1 >= timeout && count < length) {
+        count = -1; // timeout
+        busStatus = 5;
+    }
+    recordTransfer(devAddr, us0, (int8_t)count < 0 ? 0 : count, busStatus);
 
     #ifdef I2CDEV_SERIAL_DEBUG
         Serial.print(". Done (");
@@ -310,6 +330,150 @@ int8_t I2Cdev::readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8
     return count;
 }
 
+/** Read a long block of bytes from an 8-bit device register.
+ * Same as readBytes(), but with a 16-bit length (and count) so a whole FIFO
+ * (1024 bytes on the MPU6050) can be drained in one call. The block is read in
+ * I2CDEVLIB_WIRE_BUFFER_LENGTH chunks, each re-addressing regAddr, which
+ * suits FIFO-style registers that don't auto-increment.
+ * @param devAddr I2C slave device address
+ * @param regAddr Register regAddr to read from
+ * @param length Number of bytes to read
+ * @param data Buffer to store read data in
+ * @param timeout Optional read timeout in milliseconds per chunk (0 to disable, leave off to use default class value in I2Cdev::readTimeout)
+ * @return Number of bytes read (-1 indicates failure)
+ */
+int16_t I2Cdev::readBytesLong(uint8_t devAddr, uint8_t regAddr, uint16_t length, uint8_t *data, uint16_t timeout, void *wireObj) {
+#if I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO
+    // No buffer to fit, so the whole block is one transaction, and every
+    // byte costs the same nine clocks
+    (void)timeout; (void)wireObj;
+    uint32_t us0 = micros();
+    uint8_t busStatus = Esp8266Wire::readBuf(devAddr, regAddr, data, length);
+    recordTransfer(devAddr, us0, busStatus == 0 ? length : 0, busStatus);
+    return busStatus == 0 ? (int16_t)length : -1;
+#else
+    // Chunks stay below 128 so readBytes()' int8_t count can't wrap
+    const uint8_t chunk = (uint8_t)min(I2CDEVLIB_WIRE_BUFFER_LENGTH, 127);
+    uint16_t count = 0;
+    while (count < length) {
+        uint8_t n = (uint8_t)min((int)(length - count), (int)chunk);
+        int8_t got = readBytes(devAddr, regAddr, n, data + count, timeout, wireObj);
+        if (got < 0) return -1;
+        count += got;
+        if (got < n) break;   // device returned short; report what we have
+    }
+    return count;
+#endif
+}
+
+/** Start a split-phase read from an 8-bit device register.
+ * readBytes() holds the caller until every byte is in or the timeout expires.
+ * Here the transfer is cut into one bus transaction per readBytesPoll() call,
+ * so the caller can service other work (e.g. the WiFi stack) between chunks.
+ * On the Arduino Wire path this call does the register address phase;
+ * other implementations start on the first poll. Like readBytesLong(), each
+ * chunk re-addresses regAddr.
+ * @param req Request state, owned by the caller until the read completes
+ * @param devAddr I2C slave device address
+ * @param regAddr Register regAddr to read from
+ * @param length Number of bytes to read
+ * @param data Buffer to store read data in (must stay valid until done)
+ * @param timeout Optional timeout in milliseconds for the whole read (0 to disable, leave off to use default class value in I2Cdev::readTimeout)
+ * @return False if the device didn't acknowledge the address phase
+ */
+bool I2Cdev::readBytesBegin(I2CdevRequest *req, uint8_t devAddr, uint8_t regAddr, uint16_t length, uint8_t *data, uint16_t timeout, void *wireObj) {
+    req->devAddr = devAddr;
+    req->regAddr = regAddr;
+    req->length = length;
+    req->count = 0;
+    req->data = data;
+    req->timeout = timeout;
+    req->t1 = millis();
+    req->wireObj = wireObj;
+    req->status = length ? I2CDEV_REQUEST_PENDING : I2CDEV_REQUEST_DONE;
+    uint32_t us0 = micros();
+
+#if (I2CDEV_IMPLEMENTATION == I2CDEV_ARDUINO_WIRE || I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_SBWIRE || I2CDEV_IMPLEMENTATION == I2CDEV_TEENSY_3X_WIRE) && (ARDUINO > 100)
+    if (req->status == I2CDEV_REQUEST_PENDING) {
+        TwoWire *useWire = &Wire;
+        if (wireObj) useWire = (TwoWire *)wireObj;
+        useWire->beginTransmission(devAddr);
+        useWire->write(regAddr);
+        uint8_t busStatus = useWire->endTransmission();
+        if (busStatus != 0) req->status = I2CDEV_REQUEST_FAILED;
+        // Address phase only; the transaction is counted by the first poll
+        recordTransfer(devAddr, us0, 0, busStatus, busStatus != 0);
+    }
+#else
+    (void)us0;
+#endif
+    return req->status != I2CDEV_REQUEST_FAILED;
+}
+
+/** Advance a read started with readBytesBegin() by one bus transaction.
+ * A device returning fewer bytes than asked ends the read early, as with
+ * readBytesLong(); readBytesResult() then reports the short count.
+ * @param req Request state from readBytesBegin()
+ * @return I2CDEV_REQUEST_PENDING (call again), I2CDEV_REQUEST_DONE, or I2CDEV_REQUEST_FAILED (-1) on a bus error or timeout
+ */
+int8_t I2Cdev::readBytesPoll(I2CdevRequest *req) {
+    if (req->status != I2CDEV_REQUEST_PENDING) return req->status;
+    uint32_t us0 = micros();
+    if (req->timeout > 0 && millis() - req->t1 >= req->timeout) {
+        req->status = I2CDEV_REQUEST_FAILED;
+        recordTransfer(req->devAddr, us0, 0, 5);
+        return req->status;
+    }
+
+    // Same chunk bound as readBytesLong(), for the same reason
+    const uint8_t chunk = (uint8_t)min(I2CDEVLIB_WIRE_BUFFER_LENGTH, 127);
+    uint8_t n = (uint8_t)min((int)(req->length - req->count), (int)chunk);
+    uint8_t got = 0;
+
+#if (I2CDEV_IMPLEMENTATION == I2CDEV_ARDUINO_WIRE || I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_SBWIRE || I2CDEV_IMPLEMENTATION == I2CDEV_TEENSY_3X_WIRE) && (ARDUINO > 100)
+    TwoWire *useWire = &Wire;
+    if (req->wireObj) useWire = (TwoWire *)req->wireObj;
+    uint8_t busStatus = 0;
+    if (useWire->requestFrom(req->devAddr, n) == 0) busStatus = 2;
+    for (; useWire->available() && got < n; got++) {
+        req->data[req->count + got] = useWire->read();
+    }
+    req->count += got;
+    if (got < n || req->count >= req->length) {
+        req->status = I2CDEV_REQUEST_DONE;
+    } else {
+        // Address the next chunk now, so the following poll is a pure read
+        useWire->beginTransmission(req->devAddr);
+        useWire->write(req->regAddr);
+        if (!busStatus) busStatus = useWire->endTransmission();
+        if (busStatus != 0) req->status = I2CDEV_REQUEST_FAILED;
+    }
+    recordTransfer(req->devAddr, us0, got, busStatus);
+#else
+    // No split-phase access to the bus here; one blocking chunk per poll
+    int8_t r = readBytes(req->devAddr, req->regAddr, n, req->data + req->count, req->timeout, req->wireObj);
+    if (r < 0) {
+        req->status = I2CDEV_REQUEST_FAILED;
+        return req->status;
+    }
+    got = (uint8_t)r;
+    req->count += got;
+    if (got < n || req->count >= req->length) req->status = I2CDEV_REQUEST_DONE;
+#endif
+
+    return req->status;
+}
+
+/** Outcome of a read started with readBytesBegin().
+ * @param req Request state from readBytesBegin()
+ * @return Number of bytes read (-1 indicates failure), or 0 while still pending
+ */
+int16_t I2Cdev::readBytesResult(const I2CdevRequest *req) {
+    if (req->status == I2CDEV_REQUEST_FAILED) return -1;
+    if (req->status == I2CDEV_REQUEST_PENDING) return 0;
+    return req->count;
+}
+
 /** Read multiple words from a 16-bit device register.
  * @param devAddr I2C slave device address
  * @param regAddr First register regAddr to read from
@@ -330,7 +494,9 @@ int8_t I2Cdev::readWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint1
     #endif
 
     uint8_t count = 0;
+    uint8_t busStatus = 0;
     uint32_t t1 = millis();
+    uint32_t us0 = micros();
 
 #if I2CDEV_IMPLEMENTATION == I2CDEV_ARDUINO_WIRE || I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_SBWIRE || I2CDEV_IMPLEMENTATION == I2CDEV_TEENSY_3X_WIRE
         TwoWire *useWire = &Wire;
@@ -405,8 +571,8 @@ int8_t I2Cdev::readWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint1
             for (uint8_t k = 0; k < length * 2; k += min(length * 2, I2CDEVLIB_WIRE_BUFFER_LENGTH)) {
                 useWire->beginTransmission(devAddr);
                 useWire->write(regAddr);
-                useWire->endTransmission();
-                useWire->requestFrom(devAddr, (uint8_t)(length * 2)); // length=words, this wants bytes
+                busStatus = useWire->endTransmission();
+                if (useWire->requestFrom(devAddr, (uint8_t)(length * 2)) == 0 && !busStatus) busStatus = 2; // length=words, this wants bytes
         
                 bool msb = true; // starts with MSB, then LSB
                 for (; useWire->available() && count < length && (timeout == 0 || millis() - t1 < timeout);) {
@@ -440,11 +606,30 @@ int8_t I2Cdev::readWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint1
             }
         } else {
             count = -1; // error
+            busStatus = 4;
+        }
+
+    #elif (I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO)
+
+        (void)wireObj;
+        uint8_t intermediate[(uint8_t)length*2];
+        busStatus = Esp8266Wire::readBuf(devAddr, regAddr, intermediate, (uint16_t)length * 2);
+        if (busStatus == 0) {
+            count = length;
+            for (uint8_t i = 0; i < length; i++) {
+                data[i] = (intermediate[2*i] << 8) | intermediate[2*i + 1];
+            }
+        } else {
+            count = -1;
         }
 
     #endif
 
-    if (timeout > 0 && millis() - t1 >= timeout && count < length) count = -1; // timeout
+    if (timeout > 0 && millis() - t1 >= timeout && count < length) {
+        count = -1; // timeout
+        busStatus = 5;
+    }
+    recordTransfer(devAddr, us0, (int8_t)count < 0 ? 0 : count * 2, busStatus);
 
     #ifdef I2CDEV_SERIAL_DEBUG
         Serial.print(". Done (");
@@ -579,6 +764,7 @@ bool I2Cdev::writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_
         Serial.print("...");
     #endif
     uint8_t status = 0;
+    uint32_t us0 = micros();
 
 #if I2CDEV_IMPLEMENTATION == I2CDEV_ARDUINO_WIRE || I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_SBWIRE || I2CDEV_IMPLEMENTATION == I2CDEV_TEENSY_3X_WIRE
     TwoWire *useWire = &Wire;
@@ -596,6 +782,10 @@ bool I2Cdev::writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_
     #elif (I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_FASTWIRE)
         Fastwire::beginTransmission(devAddr);
         Fastwire::write(regAddr);
+    #elif (I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO)
+        (void)wireObj;
+        Esp8266Wire::beginTransmission(devAddr);
+        Esp8266Wire::write(regAddr);
     #endif
     for (uint8_t i = 0; i < length; i++) {
         #ifdef I2CDEV_SERIAL_DEBUG
@@ -610,6 +800,8 @@ bool I2Cdev::writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_
             useWire->write((uint8_t) data[i]);
         #elif (I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_FASTWIRE)
             Fastwire::write((uint8_t) data[i]);
+        #elif (I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO)
+            Esp8266Wire::write((uint8_t) data[i]);
         #endif
     }
     #if ((I2CDEV_IMPLEMENTATION == I2CDEV_ARDUINO_WIRE && ARDUINO < 100) || I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_NBWIRE)
@@ -621,10 +813,13 @@ bool I2Cdev::writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_
     #elif (I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_FASTWIRE)
         Fastwire::stop();
         //status = Fastwire::endTransmission();
+    #elif (I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO)
+        status = Esp8266Wire::stop();
     #endif
     #ifdef I2CDEV_SERIAL_DEBUG
         Serial.println(". Done.");
     #endif
+    recordTransfer(devAddr, us0, status == 0 ? length : 0, status);
     return status == 0;
 }
 
@@ -646,6 +841,7 @@ bool I2Cdev::writeWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16
         Serial.print("...");
     #endif
     uint8_t status = 0;
+    uint32_t us0 = micros();
 
 #if I2CDEV_IMPLEMENTATION == I2CDEV_ARDUINO_WIRE || I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_SBWIRE || I2CDEV_IMPLEMENTATION == I2CDEV_TEENSY_3X_WIRE
     TwoWire *useWire = &Wire;
@@ -663,6 +859,10 @@ bool I2Cdev::writeWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16
     #elif (I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_FASTWIRE)
         Fastwire::beginTransmission(devAddr);
         Fastwire::write(regAddr);
+    #elif (I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO)
+        (void)wireObj;
+        Esp8266Wire::beginTransmission(devAddr);
+        Esp8266Wire::write(regAddr);
     #endif
     for (uint8_t i = 0; i < length; i++) { 
         #ifdef I2CDEV_SERIAL_DEBUG
@@ -681,6 +881,9 @@ bool I2Cdev::writeWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16
             Fastwire::write((uint8_t)(data[i] >> 8));       // send MSB
             status = Fastwire::write((uint8_t)data[i]);   // send LSB
             if (status != 0) break;
+        #elif (I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO)
+            Esp8266Wire::write((uint8_t)(data[i] >> 8));    // send MSB
+            Esp8266Wire::write((uint8_t)data[i]);         // send LSB
         #endif
     }
     #if ((I2CDEV_IMPLEMENTATION == I2CDEV_ARDUINO_WIRE && ARDUINO < 100) || I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_NBWIRE)
@@ -692,10 +895,13 @@ bool I2Cdev::writeWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16
     #elif (I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_FASTWIRE)
         Fastwire::stop();
         //status = Fastwire::endTransmission();
+    #elif (I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO)
+        status = Esp8266Wire::stop();
     #endif
     #ifdef I2CDEV_SERIAL_DEBUG
         Serial.println(". Done.");
     #endif
+    recordTransfer(devAddr, us0, status == 0 ? length * 2 : 0, status);
     return status == 0;
 }
 
@@ -704,6 +910,71 @@ bool I2Cdev::writeWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16
  */
 uint16_t I2Cdev::readTimeout = I2CDEV_DEFAULT_READ_TIMEOUT;
 
+#if I2CDEV_STATS
+I2CdevStats I2Cdev::stats[I2CDEV_STATS_DEVICES];
+#endif
+
+/** Account one transfer against its device's counters.
+ * @param devAddr I2C slave device address
+ * @param startMicros micros() when the transfer started
+ * @param bytes Payload bytes moved
+ * @param status Wire endTransmission() style result: 0 ok, 2/3 NACK, 5 timeout, anything else an error
+ * @param transaction False to add only time and bytes (e.g. the address phase of a split-phase read)
+ */
+void I2Cdev::recordTransfer(uint8_t devAddr, uint32_t startMicros, uint16_t bytes, uint8_t status, bool transaction) {
+#if I2CDEV_STATS
+    uint32_t elapsed = micros() - startMicros;
+    I2CdevStats *s = 0;
+    for (uint8_t i = 0; i < I2CDEV_STATS_DEVICES; i++) {
+        if (stats[i].transactions == 0 && stats[i].micros == 0) {
+            // First free slot: this device hasn't been seen yet
+            s = &stats[i];
+            s->devAddr = devAddr;
+            break;
+        }
+        if (stats[i].devAddr == devAddr) {
+            s = &stats[i];
+            break;
+        }
+    }
+    if (!s) return;
+    if (transaction) s->transactions++;
+    if (status == 2 || status == 3) s->nacks++;
+    else if (status == 5) s->timeouts++;
+    else if (status != 0) s->errors++;
+    s->bytes += bytes;
+    s->micros += elapsed;
+#else
+    (void)devAddr; (void)startMicros; (void)bytes; (void)status; (void)transaction;
+#endif
+}
+
+/** Copy the bus counters for one device.
+ * @param devAddr I2C slave device address
+ * @param stats Destination; zeroed if the device hasn't been seen
+ * @return False if nothing has been recorded for devAddr
+ */
+bool I2Cdev::getStats(uint8_t devAddr, I2CdevStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->devAddr = devAddr;
+#if I2CDEV_STATS
+    for (uint8_t i = 0; i < I2CDEV_STATS_DEVICES; i++) {
+        if (I2Cdev::stats[i].devAddr == devAddr && (I2Cdev::stats[i].transactions || I2Cdev::stats[i].micros)) {
+            *stats = I2Cdev::stats[i];
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+/** Clear the counters of every device. */
+void I2Cdev::resetStats() {
+#if I2CDEV_STATS
+    memset(stats, 0, sizeof(stats));
+#endif
+}
+
 #if I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_FASTWIRE
     // I2C library
     //////////////////////
@@ -901,6 +1172,180 @@ uint16_t I2Cdev::readTimeout = I2CDEV_DEFAULT_READ_TIMEOUT;
     }
 #endif
 
+#if I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO
+    // Esp8266Wire: see I2Cdev.h. SCL and SDA are never driven high; their
+    // output latches stay at 0 and the pins toggle between output (low) and
+    // input (released to the pull-ups).
+
+    static uint32_t espWireSda = 0;          // pin masks for GPES/GPEC/GPI
+    static uint32_t espWireScl = 0;
+    static uint32_t espWireHalf = 0;         // CPU cycles per half bit
+    static uint32_t espWireStretch = 0;      // CPU cycles a slave may hold SCL
+    static uint32_t espWireEdge = 0;         // cycle count of the last edge
+    static uint8_t espWireStatus = 0;        // first failure in the open transaction
+
+    static inline void espWireLow(uint32_t mask) { GPES = mask; }
+    static inline void espWireRelease(uint32_t mask) { GPEC = mask; }
+    static inline bool espWireRead(uint32_t mask) { return (GPI & mask) != 0; }
+
+    // Hold the current bus state for half a bit past the previous edge
+    static inline void espWireWait() {
+        uint32_t now;
+        while ((now = ESP.getCycleCount()) - espWireEdge < espWireHalf) {}
+        espWireEdge = now;
+    }
+
+    // Let SCL go high, waiting out a slave stretching it
+    static bool espWireSclHigh() {
+        espWireRelease(espWireScl);
+        uint32_t t0 = ESP.getCycleCount();
+        while (!espWireRead(espWireScl)) {
+            if (ESP.getCycleCount() - t0 > espWireStretch) return false;
+        }
+        espWireEdge = ESP.getCycleCount();
+        return true;
+    }
+
+    // One bit with SCL low on entry and on return; the bit read back is SDA
+    // at the end of the high phase. -1 if SCL never came up.
+    static int8_t espWireBit(bool bit) {
+        if (bit) espWireRelease(espWireSda);
+        else espWireLow(espWireSda);
+        espWireWait();
+        if (!espWireSclHigh()) return -1;
+        espWireWait();
+        bool in = espWireRead(espWireSda);
+        espWireLow(espWireScl);
+        return in;
+    }
+
+    // (Repeated) start; SCL is left low
+    static uint8_t espWireStart() {
+        espWireRelease(espWireSda);
+        espWireWait();
+        if (!espWireSclHigh()) return 5;
+        if (!espWireRead(espWireSda)) return 4;
+        espWireWait();
+        espWireLow(espWireSda);
+        espWireWait();
+        espWireLow(espWireScl);
+        return 0;
+    }
+
+    // A byte out, MSB first; 0 on ACK, 1 on NACK, 5 on a stretch timeout
+    static uint8_t espWireSend(uint8_t value) {
+        for (uint8_t m = 0x80; m; m >>= 1) {
+            if (espWireBit(value & m) < 0) return 5;
+        }
+        int8_t ack = espWireBit(true);
+        if (ack < 0) return 5;
+        return ack ? 1 : 0;
+    }
+
+    /** Take over the pins and set the clock.
+     * @param sda SDA pin (GPIO0..15)
+     * @param scl SCL pin (GPIO0..15)
+     * @param hz SCL frequency; each half bit is at least F_CPU / (2 * hz) cycles
+     * @return False on an unsupported pin, or if the bus stayed held after recover()
+     */
+    bool Esp8266Wire::setup(uint8_t sda, uint8_t scl, uint32_t hz) {
+        if (sda > 15 || scl > 15) return false;
+        espWireSda = 1UL << sda;
+        espWireScl = 1UL << scl;
+        pinMode(sda, INPUT_PULLUP);
+        pinMode(scl, INPUT_PULLUP);
+        GPOC = espWireSda | espWireScl;
+        setClock(hz);
+        espWireEdge = ESP.getCycleCount();
+        return recover() == 0;
+    }
+
+    void Esp8266Wire::setClock(uint32_t hz) {
+        uint32_t cpuHz = (uint32_t)ESP.getCpuFreqMHz() * 1000000UL;
+        espWireHalf = cpuHz / (2 * max(hz, (uint32_t)1000));
+        espWireStretch = (uint32_t)ESP.getCpuFreqMHz() * ESP8266WIRE_STRETCH_US;
+    }
+
+    /** Free a bus a slave is holding (e.g. after a reset mid-read): clock SCL
+     * until it lets go of SDA, at most nine times, then issue a stop.
+     * @return 0, or 4 if SDA or SCL is still held low
+     */
+    uint8_t Esp8266Wire::recover() {
+        espWireRelease(espWireSda | espWireScl);
+        for (uint8_t i = 0; i < 9 && !espWireRead(espWireSda); i++) {
+            espWireWait();
+            espWireLow(espWireScl);
+            espWireWait();
+            if (!espWireSclHigh()) return 4;
+        }
+        if (!espWireRead(espWireSda) || !espWireRead(espWireScl)) return 4;
+        espWireStatus = 0;
+        stop();
+        return espWireRead(espWireSda) && espWireRead(espWireScl) ? 0 : 4;
+    }
+
+    /** Open a write to device; later write()s are skipped if this failed.
+     * @return Same codes as stop()
+     */
+    uint8_t Esp8266Wire::beginTransmission(uint8_t device) {
+        espWireStatus = espWireStart();
+        if (espWireStatus == 0) {
+            uint8_t r = espWireSend(device << 1);
+            if (r) espWireStatus = r == 1 ? 2 : r;
+        }
+        return espWireStatus;
+    }
+
+    uint8_t Esp8266Wire::write(uint8_t value) {
+        if (espWireStatus == 0) {
+            uint8_t r = espWireSend(value);
+            if (r) espWireStatus = r == 1 ? 3 : r;
+        }
+        return espWireStatus;
+    }
+
+    /** Close the transaction with a stop condition.
+     * @return Wire endTransmission() status of the transaction
+     */
+    uint8_t Esp8266Wire::stop() {
+        espWireLow(espWireSda);
+        espWireWait();
+        espWireSclHigh();
+        espWireWait();
+        espWireRelease(espWireSda);
+        espWireWait();
+        return espWireStatus;
+    }
+
+    /** Read num bytes from register address: write the register, repeated
+     * start, read with ACK on all but the last byte, stop.
+     * @return Wire endTransmission() status
+     */
+    uint8_t Esp8266Wire::readBuf(uint8_t device, uint8_t address, uint8_t *data, uint16_t num) {
+        if (beginTransmission(device) == 0 && write(address) == 0) {
+            espWireStatus = espWireStart();
+            if (espWireStatus == 0) {
+                uint8_t r = espWireSend((device << 1) | 1);
+                if (r) espWireStatus = r == 1 ? 2 : r;
+            }
+            for (uint16_t i = 0; i < num && espWireStatus == 0; i++) {
+                uint8_t value = 0;
+                for (uint8_t b = 0; b < 8; b++) {
+                    int8_t in = espWireBit(true);
+                    if (in < 0) {
+                        espWireStatus = 5;
+                        break;
+                    }
+                    value = (value << 1) | in;
+                }
+                data[i] = value;
+                if (espWireStatus == 0 && espWireBit(i + 1 == num) < 0) espWireStatus = 5;
+            }
+        }
+        return stop();
+    }
+#endif
+
 #if I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_NBWIRE
     // NBWire implementation based heavily on code by Gene Knight <Gene@Telobot.com>
     // Originally posted on the Arduino forum at http://arduino.cc/forum/index.php/topic,70705.0.html
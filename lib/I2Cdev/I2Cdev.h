@@ -78,6 +78,7 @@ THE SOFTWARE.
 #define I2CDEV_I2CMASTER_LIBRARY    4 // I2C object from DSSCircuits I2C-Master Library at https://github.com/DSSCircuits/I2C-Master-Library
 #define I2CDEV_BUILTIN_SBWIRE	    5 // I2C object from Shuning (Steve) Bian's SBWire Library at https://github.com/freespace/SBWire 
 #define I2CDEV_TEENSY_3X_WIRE       6 // Teensy 3.x support using i2c_t3 library
+#define I2CDEV_ESP8266_GPIO         7 // ESP8266 register-level master (Esp8266Wire below), no Wire object
 
 // -----------------------------------------------------------------------------
 // Arduino-style "Serial.print" debug constant (uncomment to enable)
@@ -111,7 +112,10 @@ THE SOFTWARE.
 #endif
 
 #ifndef I2CDEVLIB_WIRE_BUFFER_LENGTH
-    #if defined(I2C_BUFFER_LENGTH)
+    #if I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO
+        // No intermediate buffer; readBytes() and friends cap chunks at 127
+        #define I2CDEVLIB_WIRE_BUFFER_LENGTH 128
+    #elif defined(I2C_BUFFER_LENGTH)
         // Arduino ESP32 core Wire uses this
         #define I2CDEVLIB_WIRE_BUFFER_LENGTH I2C_BUFFER_LENGTH
     #elif defined(BUFFER_LENGTH)
@@ -129,6 +133,45 @@ THE SOFTWARE.
 // 1000ms default read timeout (modify with "I2Cdev::readTimeout = [ms];")
 #define I2CDEV_DEFAULT_READ_TIMEOUT     1000
 
+// I2Cdev::readBytesPoll() results; failures use the same -1 as readBytes()
+#define I2CDEV_REQUEST_FAILED           -1
+#define I2CDEV_REQUEST_PENDING          0
+#define I2CDEV_REQUEST_DONE             1
+
+// Per-device bus counters (I2Cdev::getStats()). Set I2CDEV_STATS to 0 to
+// compile the bookkeeping out; devices past the first I2CDEV_STATS_DEVICES
+// seen are not tracked.
+#ifndef I2CDEV_STATS
+#define I2CDEV_STATS                    1
+#endif
+#ifndef I2CDEV_STATS_DEVICES
+#define I2CDEV_STATS_DEVICES            4
+#endif
+
+struct I2CdevStats {
+    uint8_t devAddr;
+    uint32_t transactions;
+    uint32_t timeouts;
+    uint32_t nacks;                     // address or data not acknowledged
+    uint32_t errors;                    // other failures (bus busy, SCL held low, ...)
+    uint32_t bytes;                     // payload bytes moved, both directions
+    uint32_t micros;                    // cumulative time spent in transfers
+};
+
+// State of a split-phase read started with I2Cdev::readBytesBegin(). Treat as
+// opaque; the caller only owns the storage (and the data buffer it points at).
+struct I2CdevRequest {
+    uint8_t devAddr;
+    uint8_t regAddr;
+    uint16_t length;
+    uint16_t count;
+    uint8_t *data;
+    uint16_t timeout;
+    uint32_t t1;
+    void *wireObj;
+    int8_t status;
+};
+
 class I2Cdev {
     public:
         I2Cdev();
@@ -141,6 +184,11 @@ class I2Cdev {
         static int8_t readWord(uint8_t devAddr, uint8_t regAddr, uint16_t *data, uint16_t timeout=I2Cdev::readTimeout, void *wireObj=0);
         static int8_t readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, uint16_t timeout=I2Cdev::readTimeout, void *wireObj=0);
         static int8_t readWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16_t *data, uint16_t timeout=I2Cdev::readTimeout, void *wireObj=0);
+        static int16_t readBytesLong(uint8_t devAddr, uint8_t regAddr, uint16_t length, uint8_t *data, uint16_t timeout=I2Cdev::readTimeout, void *wireObj=0);
+
+        static bool readBytesBegin(I2CdevRequest *req, uint8_t devAddr, uint8_t regAddr, uint16_t length, uint8_t *data, uint16_t timeout=I2Cdev::readTimeout, void *wireObj=0);
+        static int8_t readBytesPoll(I2CdevRequest *req);
+        static int16_t readBytesResult(const I2CdevRequest *req);
 
         static bool writeBit(uint8_t devAddr, uint8_t regAddr, uint8_t bitNum, uint8_t data, void *wireObj=0);
         static bool writeBitW(uint8_t devAddr, uint8_t regAddr, uint8_t bitNum, uint16_t data, void *wireObj=0);
@@ -151,7 +199,16 @@ class I2Cdev {
         static bool writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, void *wireObj=0);
         static bool writeWords(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint16_t *data, void *wireObj=0);
 
+        static bool getStats(uint8_t devAddr, I2CdevStats *stats);
+        static void resetStats();
+
         static uint16_t readTimeout;
+
+    private:
+        static void recordTransfer(uint8_t devAddr, uint32_t startMicros, uint16_t bytes, uint8_t status, bool transaction=true);
+#if I2CDEV_STATS
+        static I2CdevStats stats[I2CDEV_STATS_DEVICES];
+#endif
 };
 
 #if I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_FASTWIRE
@@ -198,6 +255,36 @@ class I2Cdev {
     };
 #endif
 
+#if I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO
+    //////////////////////
+    // Esp8266Wire
+    // Register-level I2C master for the ESP8266, in place of Wire. The pins
+    // are driven open-drain straight through the GPIO registers (pull low by
+    // enabling the output, release by disabling it), and every half bit is
+    // timed off the CPU cycle counter from the previous edge, so SCL runs at
+    // the set clock whatever the CPU frequency and code path. An interrupt
+    // can stretch a bit, never shorten one. Slaves may hold SCL low for up to
+    // ESP8266WIRE_STRETCH_US. GPIO0..15 only (GPIO16 has no open-drain path).
+    // Status codes are Wire's endTransmission() ones: 0 ok, 2 address NACK,
+    // 3 data NACK, 4 bus held (SDA or SCL stuck low), 5 clock stretch timeout.
+    //////////////////////
+
+    #ifndef ESP8266WIRE_STRETCH_US
+    #define ESP8266WIRE_STRETCH_US  1000
+    #endif
+
+    class Esp8266Wire {
+        public:
+            static bool setup(uint8_t sda, uint8_t scl, uint32_t hz);
+            static void setClock(uint32_t hz);
+            static uint8_t recover();
+            static uint8_t beginTransmission(uint8_t device);
+            static uint8_t write(uint8_t value);
+            static uint8_t stop();
+            static uint8_t readBuf(uint8_t device, uint8_t address, uint8_t *data, uint16_t num);
+    };
+#endif
+
 #if I2CDEV_IMPLEMENTATION == I2CDEV_BUILTIN_NBWIRE
     // NBWire implementation based heavily on code by Gene Knight <Gene@Telobot.com>
     // Originally posted on the Arduino forum at http://arduino.cc/forum/index.php/topic,70705.0.html
@@ -163,8 +163,7 @@ bool MPU6050_Base::testConnection() {
  * @return I2C supply voltage level (0=VLOGIC, 1=VDD)
  */
 uint8_t MPU6050_Base::getAuxVDDIOLevel() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_YG_OFFS_TC, MPU6050_TC_PWR_MODE_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_YG_OFFS_TC, MPU6050_TC_PWR_MODE_BIT>>();
 }
 /** Set the auxiliary I2C supply voltage level.
  * When set to 1, the auxiliary I2C bus high logic level is VDD. When cleared to
@@ -173,7 +172,7 @@ uint8_t MPU6050_Base::getAuxVDDIOLevel() {
  * @param level I2C supply voltage level (0=VLOGIC, 1=VDD)
  */
 void MPU6050_Base::setAuxVDDIOLevel(uint8_t level) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_YG_OFFS_TC, MPU6050_TC_PWR_MODE_BIT, level, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_YG_OFFS_TC, MPU6050_TC_PWR_MODE_BIT>>(level);
 }
 
 // SMPLRT_DIV register
@@ -209,7 +208,7 @@ uint8_t MPU6050_Base::getRate() {
  * @see MPU6050_RA_SMPLRT_DIV
  */
 void MPU6050_Base::setRate(uint8_t rate) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_SMPLRT_DIV, rate, wireObj);
+    writeByteReg(MPU6050_RA_SMPLRT_DIV, rate);
 }
 
 // CONFIG register
@@ -242,8 +241,7 @@ void MPU6050_Base::setRate(uint8_t rate) {
  * @return FSYNC configuration value
  */
 uint8_t MPU6050_Base::getExternalFrameSync() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_CONFIG, MPU6050_CFG_EXT_SYNC_SET_BIT, MPU6050_CFG_EXT_SYNC_SET_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_CONFIG, MPU6050_CFG_EXT_SYNC_SET_BIT, MPU6050_CFG_EXT_SYNC_SET_LENGTH>>();
 }
 /** Set external FSYNC configuration.
  * @see getExternalFrameSync()
@@ -251,7 +249,7 @@ uint8_t MPU6050_Base::getExternalFrameSync() {
  * @param sync New FSYNC configuration value
  */
 void MPU6050_Base::setExternalFrameSync(uint8_t sync) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_CONFIG, MPU6050_CFG_EXT_SYNC_SET_BIT, MPU6050_CFG_EXT_SYNC_SET_LENGTH, sync, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_CONFIG, MPU6050_CFG_EXT_SYNC_SET_BIT, MPU6050_CFG_EXT_SYNC_SET_LENGTH>>(sync);
 }
 /** Get digital low-pass filter configuration.
  * The DLPF_CFG parameter sets the digital low pass filter configuration. It
@@ -282,8 +280,7 @@ void MPU6050_Base::setExternalFrameSync(uint8_t sync) {
  * @see MPU6050_CFG_DLPF_CFG_LENGTH
  */
 uint8_t MPU6050_Base::getDLPFMode() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_CONFIG, MPU6050_CFG_DLPF_CFG_BIT, MPU6050_CFG_DLPF_CFG_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_CONFIG, MPU6050_CFG_DLPF_CFG_BIT, MPU6050_CFG_DLPF_CFG_LENGTH>>();
 }
 /** Set digital low-pass filter configuration.
  * @param mode New DLFP configuration setting
@@ -294,7 +291,7 @@ uint8_t MPU6050_Base::getDLPFMode() {
  * @see MPU6050_CFG_DLPF_CFG_LENGTH
  */
 void MPU6050_Base::setDLPFMode(uint8_t mode) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_CONFIG, MPU6050_CFG_DLPF_CFG_BIT, MPU6050_CFG_DLPF_CFG_LENGTH, mode, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_CONFIG, MPU6050_CFG_DLPF_CFG_BIT, MPU6050_CFG_DLPF_CFG_LENGTH>>(mode);
 }
 
 // GYRO_CONFIG register
@@ -317,8 +314,7 @@ void MPU6050_Base::setDLPFMode(uint8_t mode) {
  * @see MPU6050_GCONFIG_FS_SEL_LENGTH
  */
 uint8_t MPU6050_Base::getFullScaleGyroRange() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_GYRO_CONFIG, MPU6050_GCONFIG_FS_SEL_BIT, MPU6050_GCONFIG_FS_SEL_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_GYRO_CONFIG, MPU6050_GCONFIG_FS_SEL_BIT, MPU6050_GCONFIG_FS_SEL_LENGTH>>();
 }
 /** Set full-scale gyroscope range.
  * @param range New full-scale gyroscope range value
@@ -350,7 +346,7 @@ void MPU6050_Base::setFullScaleGyroRange(uint8_t range) {
         break;
     }
     
-    I2Cdev::writeBits(devAddr, MPU6050_RA_GYRO_CONFIG, MPU6050_GCONFIG_FS_SEL_BIT, MPU6050_GCONFIG_FS_SEL_LENGTH, range, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_GYRO_CONFIG, MPU6050_GCONFIG_FS_SEL_BIT, MPU6050_GCONFIG_FS_SEL_LENGTH>>(range);
 }
 
 // SELF TEST FACTORY TRIM VALUES
@@ -418,45 +414,42 @@ uint8_t MPU6050_Base::getGyroZSelfTestFactoryTrim() {
  * @see MPU6050_RA_ACCEL_CONFIG
  */
 bool MPU6050_Base::getAccelXSelfTest() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_XA_ST_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_XA_ST_BIT>>();
 }
 /** Get self-test enabled setting for accelerometer X axis.
  * @param enabled Self-test enabled value
  * @see MPU6050_RA_ACCEL_CONFIG
  */
 void MPU6050_Base::setAccelXSelfTest(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_XA_ST_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_XA_ST_BIT>>(enabled);
 }
 /** Get self-test enabled value for accelerometer Y axis.
  * @return Self-test enabled value
  * @see MPU6050_RA_ACCEL_CONFIG
  */
 bool MPU6050_Base::getAccelYSelfTest() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_YA_ST_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_YA_ST_BIT>>();
 }
 /** Get self-test enabled value for accelerometer Y axis.
  * @param enabled Self-test enabled value
  * @see MPU6050_RA_ACCEL_CONFIG
  */
 void MPU6050_Base::setAccelYSelfTest(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_YA_ST_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_YA_ST_BIT>>(enabled);
 }
 /** Get self-test enabled value for accelerometer Z axis.
  * @return Self-test enabled value
  * @see MPU6050_RA_ACCEL_CONFIG
  */
 bool MPU6050_Base::getAccelZSelfTest() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_ZA_ST_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_ZA_ST_BIT>>();
 }
 /** Set self-test enabled value for accelerometer Z axis.
  * @param enabled Self-test enabled value
  * @see MPU6050_RA_ACCEL_CONFIG
  */
 void MPU6050_Base::setAccelZSelfTest(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_ZA_ST_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_ZA_ST_BIT>>(enabled);
 }
 /** Get full-scale accelerometer range.
  * The FS_SEL parameter allows setting the full-scale range of the accelerometer
@@ -476,8 +469,7 @@ void MPU6050_Base::setAccelZSelfTest(bool enabled) {
  * @see MPU6050_ACONFIG_AFS_SEL_LENGTH
  */
 uint8_t MPU6050_Base::getFullScaleAccelRange() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_AFS_SEL_BIT, MPU6050_ACONFIG_AFS_SEL_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_AFS_SEL_BIT, MPU6050_ACONFIG_AFS_SEL_LENGTH>>();
 }
 /** Set full-scale accelerometer range.
  * @param range New full-scale accelerometer range setting
@@ -505,7 +497,7 @@ void MPU6050_Base::setFullScaleAccelRange(uint8_t range) {
         break;
     }
     
-    I2Cdev::writeBits(devAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_AFS_SEL_BIT, MPU6050_ACONFIG_AFS_SEL_LENGTH, range, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_AFS_SEL_BIT, MPU6050_ACONFIG_AFS_SEL_LENGTH>>(range);
 }
 /** Get the high-pass filter configuration.
  * The DHPF is a filter module in the path leading to motion detectors (Free
@@ -543,8 +535,7 @@ void MPU6050_Base::setFullScaleAccelRange(uint8_t range) {
  * @see MPU6050_RA_ACCEL_CONFIG
  */
 uint8_t MPU6050_Base::getDHPFMode() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_ACCEL_HPF_BIT, MPU6050_ACONFIG_ACCEL_HPF_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_ACCEL_HPF_BIT, MPU6050_ACONFIG_ACCEL_HPF_LENGTH>>();
 }
 /** Set the high-pass filter configuration.
  * @param bandwidth New high-pass filter configuration
@@ -553,7 +544,7 @@ uint8_t MPU6050_Base::getDHPFMode() {
  * @see MPU6050_RA_ACCEL_CONFIG
  */
 void MPU6050_Base::setDHPFMode(uint8_t bandwidth) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_ACCEL_HPF_BIT, MPU6050_ACONFIG_ACCEL_HPF_LENGTH, bandwidth, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_ACCEL_HPF_BIT, MPU6050_ACONFIG_ACCEL_HPF_LENGTH>>(bandwidth);
 }
 
 // FF_THR register
@@ -583,7 +574,7 @@ uint8_t MPU6050_Base::getFreefallDetectionThreshold() {
  * @see MPU6050_RA_FF_THR
  */
 void MPU6050_Base::setFreefallDetectionThreshold(uint8_t threshold) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_FF_THR, threshold, wireObj);
+    writeByteReg(MPU6050_RA_FF_THR, threshold);
 }
 
 // FF_DUR register
@@ -615,7 +606,7 @@ uint8_t MPU6050_Base::getFreefallDetectionDuration() {
  * @see MPU6050_RA_FF_DUR
  */
 void MPU6050_Base::setFreefallDetectionDuration(uint8_t duration) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_FF_DUR, duration, wireObj);
+    writeByteReg(MPU6050_RA_FF_DUR, duration);
 }
 
 // MOT_THR register
@@ -649,7 +640,7 @@ uint8_t MPU6050_Base::getMotionDetectionThreshold() {
  * @see MPU6050_RA_MOT_THR
  */
 void MPU6050_Base::setMotionDetectionThreshold(uint8_t threshold) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_MOT_THR, threshold, wireObj);
+    writeByteReg(MPU6050_RA_MOT_THR, threshold);
 }
 
 // MOT_DUR register
@@ -679,7 +670,7 @@ uint8_t MPU6050_Base::getMotionDetectionDuration() {
  * @see MPU6050_RA_MOT_DUR
  */
 void MPU6050_Base::setMotionDetectionDuration(uint8_t duration) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_MOT_DUR, duration, wireObj);
+    writeByteReg(MPU6050_RA_MOT_DUR, duration);
 }
 
 // ZRMOT_THR register
@@ -719,7 +710,7 @@ uint8_t MPU6050_Base::getZeroMotionDetectionThreshold() {
  * @see MPU6050_RA_ZRMOT_THR
  */
 void MPU6050_Base::setZeroMotionDetectionThreshold(uint8_t threshold) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_ZRMOT_THR, threshold, wireObj);
+    writeByteReg(MPU6050_RA_ZRMOT_THR, threshold);
 }
 
 // ZRMOT_DUR register
@@ -750,7 +741,7 @@ uint8_t MPU6050_Base::getZeroMotionDetectionDuration() {
  * @see MPU6050_RA_ZRMOT_DUR
  */
 void MPU6050_Base::setZeroMotionDetectionDuration(uint8_t duration) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_ZRMOT_DUR, duration, wireObj);
+    writeByteReg(MPU6050_RA_ZRMOT_DUR, duration);
 }
 
 // FIFO_EN register
@@ -762,8 +753,7 @@ void MPU6050_Base::setZeroMotionDetectionDuration(uint8_t duration) {
  * @see MPU6050_RA_FIFO_EN
  */
 bool MPU6050_Base::getTempFIFOEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_TEMP_FIFO_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_TEMP_FIFO_EN_BIT>>();
 }
 /** Set temperature FIFO enabled value.
  * @param enabled New temperature FIFO enabled value
@@ -771,7 +761,7 @@ bool MPU6050_Base::getTempFIFOEnabled() {
  * @see MPU6050_RA_FIFO_EN
  */
 void MPU6050_Base::setTempFIFOEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_TEMP_FIFO_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_TEMP_FIFO_EN_BIT>>(enabled);
 }
 /** Get gyroscope X-axis FIFO enabled value.
  * When set to 1, this bit enables GYRO_XOUT_H and GYRO_XOUT_L (Registers 67 and
@@ -780,8 +770,7 @@ void MPU6050_Base::setTempFIFOEnabled(bool enabled) {
  * @see MPU6050_RA_FIFO_EN
  */
 bool MPU6050_Base::getXGyroFIFOEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_XG_FIFO_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_XG_FIFO_EN_BIT>>();
 }
 /** Set gyroscope X-axis FIFO enabled value.
  * @param enabled New gyroscope X-axis FIFO enabled value
@@ -789,7 +778,7 @@ bool MPU6050_Base::getXGyroFIFOEnabled() {
  * @see MPU6050_RA_FIFO_EN
  */
 void MPU6050_Base::setXGyroFIFOEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_XG_FIFO_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_XG_FIFO_EN_BIT>>(enabled);
 }
 /** Get gyroscope Y-axis FIFO enabled value.
  * When set to 1, this bit enables GYRO_YOUT_H and GYRO_YOUT_L (Registers 69 and
@@ -798,8 +787,7 @@ void MPU6050_Base::setXGyroFIFOEnabled(bool enabled) {
  * @see MPU6050_RA_FIFO_EN
  */
 bool MPU6050_Base::getYGyroFIFOEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_YG_FIFO_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_YG_FIFO_EN_BIT>>();
 }
 /** Set gyroscope Y-axis FIFO enabled value.
  * @param enabled New gyroscope Y-axis FIFO enabled value
@@ -807,7 +795,7 @@ bool MPU6050_Base::getYGyroFIFOEnabled() {
  * @see MPU6050_RA_FIFO_EN
  */
 void MPU6050_Base::setYGyroFIFOEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_YG_FIFO_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_YG_FIFO_EN_BIT>>(enabled);
 }
 /** Get gyroscope Z-axis FIFO enabled value.
  * When set to 1, this bit enables GYRO_ZOUT_H and GYRO_ZOUT_L (Registers 71 and
@@ -816,8 +804,7 @@ void MPU6050_Base::setYGyroFIFOEnabled(bool enabled) {
  * @see MPU6050_RA_FIFO_EN
  */
 bool MPU6050_Base::getZGyroFIFOEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_ZG_FIFO_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_ZG_FIFO_EN_BIT>>();
 }
 /** Set gyroscope Z-axis FIFO enabled value.
  * @param enabled New gyroscope Z-axis FIFO enabled value
@@ -825,7 +812,7 @@ bool MPU6050_Base::getZGyroFIFOEnabled() {
  * @see MPU6050_RA_FIFO_EN
  */
 void MPU6050_Base::setZGyroFIFOEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_ZG_FIFO_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_ZG_FIFO_EN_BIT>>(enabled);
 }
 /** Get accelerometer FIFO enabled value.
  * When set to 1, this bit enables ACCEL_XOUT_H, ACCEL_XOUT_L, ACCEL_YOUT_H,
@@ -835,8 +822,7 @@ void MPU6050_Base::setZGyroFIFOEnabled(bool enabled) {
  * @see MPU6050_RA_FIFO_EN
  */
 bool MPU6050_Base::getAccelFIFOEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_ACCEL_FIFO_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_ACCEL_FIFO_EN_BIT>>();
 }
 /** Set accelerometer FIFO enabled value.
  * @param enabled New accelerometer FIFO enabled value
@@ -844,7 +830,7 @@ bool MPU6050_Base::getAccelFIFOEnabled() {
  * @see MPU6050_RA_FIFO_EN
  */
 void MPU6050_Base::setAccelFIFOEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_ACCEL_FIFO_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_ACCEL_FIFO_EN_BIT>>(enabled);
 }
 /** Get Slave 2 FIFO enabled value.
  * When set to 1, this bit enables EXT_SENS_DATA registers (Registers 73 to 96)
@@ -853,8 +839,7 @@ void MPU6050_Base::setAccelFIFOEnabled(bool enabled) {
  * @see MPU6050_RA_FIFO_EN
  */
 bool MPU6050_Base::getSlave2FIFOEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_SLV2_FIFO_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_SLV2_FIFO_EN_BIT>>();
 }
 /** Set Slave 2 FIFO enabled value.
  * @param enabled New Slave 2 FIFO enabled value
@@ -862,7 +847,7 @@ bool MPU6050_Base::getSlave2FIFOEnabled() {
  * @see MPU6050_RA_FIFO_EN
  */
 void MPU6050_Base::setSlave2FIFOEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_SLV2_FIFO_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_SLV2_FIFO_EN_BIT>>(enabled);
 }
 /** Get Slave 1 FIFO enabled value.
  * When set to 1, this bit enables EXT_SENS_DATA registers (Registers 73 to 96)
@@ -871,8 +856,7 @@ void MPU6050_Base::setSlave2FIFOEnabled(bool enabled) {
  * @see MPU6050_RA_FIFO_EN
  */
 bool MPU6050_Base::getSlave1FIFOEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_SLV1_FIFO_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_SLV1_FIFO_EN_BIT>>();
 }
 /** Set Slave 1 FIFO enabled value.
  * @param enabled New Slave 1 FIFO enabled value
@@ -880,7 +864,7 @@ bool MPU6050_Base::getSlave1FIFOEnabled() {
  * @see MPU6050_RA_FIFO_EN
  */
 void MPU6050_Base::setSlave1FIFOEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_SLV1_FIFO_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_SLV1_FIFO_EN_BIT>>(enabled);
 }
 /** Get Slave 0 FIFO enabled value.
  * When set to 1, this bit enables EXT_SENS_DATA registers (Registers 73 to 96)
@@ -889,8 +873,7 @@ void MPU6050_Base::setSlave1FIFOEnabled(bool enabled) {
  * @see MPU6050_RA_FIFO_EN
  */
 bool MPU6050_Base::getSlave0FIFOEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_SLV0_FIFO_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_SLV0_FIFO_EN_BIT>>();
 }
 /** Set Slave 0 FIFO enabled value.
  * @param enabled New Slave 0 FIFO enabled value
@@ -898,7 +881,7 @@ bool MPU6050_Base::getSlave0FIFOEnabled() {
  * @see MPU6050_RA_FIFO_EN
  */
 void MPU6050_Base::setSlave0FIFOEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_FIFO_EN, MPU6050_SLV0_FIFO_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_SLV0_FIFO_EN_BIT>>(enabled);
 }
 
 // I2C_MST_CTRL register
@@ -919,8 +902,7 @@ void MPU6050_Base::setSlave0FIFOEnabled(bool enabled) {
  * @see MPU6050_RA_I2C_MST_CTRL
  */
 bool MPU6050_Base::getMultiMasterEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_CTRL, MPU6050_MULT_MST_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_CTRL, MPU6050_MULT_MST_EN_BIT>>();
 }
 /** Set multi-master enabled value.
  * @param enabled New multi-master enabled value
@@ -928,7 +910,7 @@ bool MPU6050_Base::getMultiMasterEnabled() {
  * @see MPU6050_RA_I2C_MST_CTRL
  */
 void MPU6050_Base::setMultiMasterEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_MST_CTRL, MPU6050_MULT_MST_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_CTRL, MPU6050_MULT_MST_EN_BIT>>(enabled);
 }
 /** Get wait-for-external-sensor-data enabled value.
  * When the WAIT_FOR_ES bit is set to 1, the Data Ready interrupt will be
@@ -942,8 +924,7 @@ void MPU6050_Base::setMultiMasterEnabled(bool enabled) {
  * @see MPU6050_RA_I2C_MST_CTRL
  */
 bool MPU6050_Base::getWaitForExternalSensorEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_CTRL, MPU6050_WAIT_FOR_ES_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_CTRL, MPU6050_WAIT_FOR_ES_BIT>>();
 }
 /** Set wait-for-external-sensor-data enabled value.
  * @param enabled New wait-for-external-sensor-data enabled value
@@ -951,7 +932,7 @@ bool MPU6050_Base::getWaitForExternalSensorEnabled() {
  * @see MPU6050_RA_I2C_MST_CTRL
  */
 void MPU6050_Base::setWaitForExternalSensorEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_MST_CTRL, MPU6050_WAIT_FOR_ES_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_CTRL, MPU6050_WAIT_FOR_ES_BIT>>(enabled);
 }
 /** Get Slave 3 FIFO enabled value.
  * When set to 1, this bit enables EXT_SENS_DATA registers (Registers 73 to 96)
@@ -960,8 +941,7 @@ void MPU6050_Base::setWaitForExternalSensorEnabled(bool enabled) {
  * @see MPU6050_RA_MST_CTRL
  */
 bool MPU6050_Base::getSlave3FIFOEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_CTRL, MPU6050_SLV_3_FIFO_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_CTRL, MPU6050_SLV_3_FIFO_EN_BIT>>();
 }
 /** Set Slave 3 FIFO enabled value.
  * @param enabled New Slave 3 FIFO enabled value
@@ -969,7 +949,7 @@ bool MPU6050_Base::getSlave3FIFOEnabled() {
  * @see MPU6050_RA_MST_CTRL
  */
 void MPU6050_Base::setSlave3FIFOEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_MST_CTRL, MPU6050_SLV_3_FIFO_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_CTRL, MPU6050_SLV_3_FIFO_EN_BIT>>(enabled);
 }
 /** Get slave read/write transition enabled value.
  * The I2C_MST_P_NSR bit configures the I2C Master's transition from one slave
@@ -982,8 +962,7 @@ void MPU6050_Base::setSlave3FIFOEnabled(bool enabled) {
  * @see MPU6050_RA_I2C_MST_CTRL
  */
 bool MPU6050_Base::getSlaveReadWriteTransitionEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_CTRL, MPU6050_I2C_MST_P_NSR_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_CTRL, MPU6050_I2C_MST_P_NSR_BIT>>();
 }
 /** Set slave read/write transition enabled value.
  * @param enabled New slave read/write transition enabled value
@@ -991,7 +970,7 @@ bool MPU6050_Base::getSlaveReadWriteTransitionEnabled() {
  * @see MPU6050_RA_I2C_MST_CTRL
  */
 void MPU6050_Base::setSlaveReadWriteTransitionEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_MST_CTRL, MPU6050_I2C_MST_P_NSR_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_CTRL, MPU6050_I2C_MST_P_NSR_BIT>>(enabled);
 }
 /** Get I2C master clock speed.
  * I2C_MST_CLK is a 4 bit unsigned value which configures a divider on the
@@ -1023,15 +1002,14 @@ void MPU6050_Base::setSlaveReadWriteTransitionEnabled(bool enabled) {
  * @see MPU6050_RA_I2C_MST_CTRL
  */
 uint8_t MPU6050_Base::getMasterClockSpeed() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_I2C_MST_CTRL, MPU6050_I2C_MST_CLK_BIT, MPU6050_I2C_MST_CLK_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_CTRL, MPU6050_I2C_MST_CLK_BIT, MPU6050_I2C_MST_CLK_LENGTH>>();
 }
 /** Set I2C master clock speed.
  * @reparam speed Current I2C master clock speed
  * @see MPU6050_RA_I2C_MST_CTRL
  */
 void MPU6050_Base::setMasterClockSpeed(uint8_t speed) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_I2C_MST_CTRL, MPU6050_I2C_MST_CLK_BIT, MPU6050_I2C_MST_CLK_LENGTH, speed, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_CTRL, MPU6050_I2C_MST_CLK_BIT, MPU6050_I2C_MST_CLK_LENGTH>>(speed);
 }
 
 // I2C_SLV* registers (Slave 0-3)
@@ -1090,7 +1068,7 @@ uint8_t MPU6050_Base::getSlaveAddress(uint8_t num) {
  */
 void MPU6050_Base::setSlaveAddress(uint8_t num, uint8_t address) {
     if (num > 3) return;
-    I2Cdev::writeByte(devAddr, MPU6050_RA_I2C_SLV0_ADDR + num*3, address, wireObj);
+    writeByteReg(MPU6050_RA_I2C_SLV0_ADDR + num*3, address);
 }
 /** Get the active internal register for the specified slave (0-3).
  * Read/write operations for this slave will be done to whatever internal
@@ -1116,7 +1094,7 @@ uint8_t MPU6050_Base::getSlaveRegister(uint8_t num) {
  */
 void MPU6050_Base::setSlaveRegister(uint8_t num, uint8_t reg) {
     if (num > 3) return;
-    I2Cdev::writeByte(devAddr, MPU6050_RA_I2C_SLV0_REG + num*3, reg, wireObj);
+    writeByteReg(MPU6050_RA_I2C_SLV0_REG + num*3, reg);
 }
 /** Get the enabled value for the specified slave (0-3).
  * When set to 1, this bit enables Slave 0 for data transfer operations. When
@@ -1138,7 +1116,7 @@ bool MPU6050_Base::getSlaveEnabled(uint8_t num) {
  */
 void MPU6050_Base::setSlaveEnabled(uint8_t num, bool enabled) {
     if (num > 3) return;
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_SLV0_CTRL + num*3, MPU6050_I2C_SLV_EN_BIT, enabled, wireObj);
+    writeBitReg(MPU6050_RA_I2C_SLV0_CTRL + num*3, MPU6050_I2C_SLV_EN_BIT, enabled);
 }
 /** Get word pair byte-swapping enabled for the specified slave (0-3).
  * When set to 1, this bit enables byte swapping. When byte swapping is enabled,
@@ -1164,7 +1142,7 @@ bool MPU6050_Base::getSlaveWordByteSwap(uint8_t num) {
  */
 void MPU6050_Base::setSlaveWordByteSwap(uint8_t num, bool enabled) {
     if (num > 3) return;
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_SLV0_CTRL + num*3, MPU6050_I2C_SLV_BYTE_SW_BIT, enabled, wireObj);
+    writeBitReg(MPU6050_RA_I2C_SLV0_CTRL + num*3, MPU6050_I2C_SLV_BYTE_SW_BIT, enabled);
 }
 /** Get write mode for the specified slave (0-3).
  * When set to 1, the transaction will read or write data only. When cleared to
@@ -1189,7 +1167,7 @@ bool MPU6050_Base::getSlaveWriteMode(uint8_t num) {
  */
 void MPU6050_Base::setSlaveWriteMode(uint8_t num, bool mode) {
     if (num > 3) return;
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_SLV0_CTRL + num*3, MPU6050_I2C_SLV_REG_DIS_BIT, mode, wireObj);
+    writeBitReg(MPU6050_RA_I2C_SLV0_CTRL + num*3, MPU6050_I2C_SLV_REG_DIS_BIT, mode);
 }
 /** Get word pair grouping order offset for the specified slave (0-3).
  * This sets specifies the grouping order of word pairs received from registers.
@@ -1215,7 +1193,7 @@ bool MPU6050_Base::getSlaveWordGroupOffset(uint8_t num) {
  */
 void MPU6050_Base::setSlaveWordGroupOffset(uint8_t num, bool enabled) {
     if (num > 3) return;
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_SLV0_CTRL + num*3, MPU6050_I2C_SLV_GRP_BIT, enabled, wireObj);
+    writeBitReg(MPU6050_RA_I2C_SLV0_CTRL + num*3, MPU6050_I2C_SLV_GRP_BIT, enabled);
 }
 /** Get number of bytes to read for the specified slave (0-3).
  * Specifies the number of bytes transferred to and from Slave 0. Clearing this
@@ -1237,7 +1215,7 @@ uint8_t MPU6050_Base::getSlaveDataLength(uint8_t num) {
  */
 void MPU6050_Base::setSlaveDataLength(uint8_t num, uint8_t length) {
     if (num > 3) return;
-    I2Cdev::writeBits(devAddr, MPU6050_RA_I2C_SLV0_CTRL + num*3, MPU6050_I2C_SLV_LEN_BIT, MPU6050_I2C_SLV_LEN_LENGTH, length, wireObj);
+    writeBitsReg(MPU6050_RA_I2C_SLV0_CTRL + num*3, MPU6050_I2C_SLV_LEN_BIT, MPU6050_I2C_SLV_LEN_LENGTH, length);
 }
 
 // I2C_SLV* registers (Slave 4)
@@ -1261,7 +1239,7 @@ uint8_t MPU6050_Base::getSlave4Address() {
  * @see MPU6050_RA_I2C_SLV4_ADDR
  */
 void MPU6050_Base::setSlave4Address(uint8_t address) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_I2C_SLV4_ADDR, address, wireObj);
+    writeByteReg(MPU6050_RA_I2C_SLV4_ADDR, address);
 }
 /** Get the active internal register for the Slave 4.
  * Read/write operations for this slave will be done to whatever internal
@@ -1280,7 +1258,7 @@ uint8_t MPU6050_Base::getSlave4Register() {
  * @see MPU6050_RA_I2C_SLV4_REG
  */
 void MPU6050_Base::setSlave4Register(uint8_t reg) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_I2C_SLV4_REG, reg, wireObj);
+    writeByteReg(MPU6050_RA_I2C_SLV4_REG, reg);
 }
 /** Set new byte to write to Slave 4.
  * This register stores the data to be written into the Slave 4. If I2C_SLV4_RW
@@ -1289,7 +1267,7 @@ void MPU6050_Base::setSlave4Register(uint8_t reg) {
  * @see MPU6050_RA_I2C_SLV4_DO
  */
 void MPU6050_Base::setSlave4OutputByte(uint8_t data) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_I2C_SLV4_DO, data, wireObj);
+    writeByteReg(MPU6050_RA_I2C_SLV4_DO, data);
 }
 /** Get the enabled value for the Slave 4.
  * When set to 1, this bit enables Slave 4 for data transfer operations. When
@@ -1298,8 +1276,7 @@ void MPU6050_Base::setSlave4OutputByte(uint8_t data) {
  * @see MPU6050_RA_I2C_SLV4_CTRL
  */
 bool MPU6050_Base::getSlave4Enabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_EN_BIT>>();
 }
 /** Set the enabled value for Slave 4.
  * @param enabled New enabled value for Slave 4
@@ -1307,7 +1284,7 @@ bool MPU6050_Base::getSlave4Enabled() {
  * @see MPU6050_RA_I2C_SLV4_CTRL
  */
 void MPU6050_Base::setSlave4Enabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_EN_BIT>>(enabled);
 }
 /** Get the enabled value for Slave 4 transaction interrupts.
  * When set to 1, this bit enables the generation of an interrupt signal upon
@@ -1319,8 +1296,7 @@ void MPU6050_Base::setSlave4Enabled(bool enabled) {
  * @see MPU6050_RA_I2C_SLV4_CTRL
  */
 bool MPU6050_Base::getSlave4InterruptEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_INT_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_INT_EN_BIT>>();
 }
 /** Set the enabled value for Slave 4 transaction interrupts.
  * @param enabled New enabled value for Slave 4 transaction interrupts.
@@ -1328,7 +1304,7 @@ bool MPU6050_Base::getSlave4InterruptEnabled() {
  * @see MPU6050_RA_I2C_SLV4_CTRL
  */
 void MPU6050_Base::setSlave4InterruptEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_INT_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_INT_EN_BIT>>(enabled);
 }
 /** Get write mode for Slave 4.
  * When set to 1, the transaction will read or write data only. When cleared to
@@ -1340,8 +1316,7 @@ void MPU6050_Base::setSlave4InterruptEnabled(bool enabled) {
  * @see MPU6050_RA_I2C_SLV4_CTRL
  */
 bool MPU6050_Base::getSlave4WriteMode() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_REG_DIS_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_REG_DIS_BIT>>();
 }
 /** Set write mode for the Slave 4.
  * @param mode New write mode for Slave 4 (0 = register address + data, 1 = data only)
@@ -1349,7 +1324,7 @@ bool MPU6050_Base::getSlave4WriteMode() {
  * @see MPU6050_RA_I2C_SLV4_CTRL
  */
 void MPU6050_Base::setSlave4WriteMode(bool mode) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_REG_DIS_BIT, mode, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_REG_DIS_BIT>>(mode);
 }
 /** Get Slave 4 master delay value.
  * This configures the reduced access rate of I2C slaves relative to the Sample
@@ -1367,8 +1342,7 @@ void MPU6050_Base::setSlave4WriteMode(bool mode) {
  * @see MPU6050_RA_I2C_SLV4_CTRL
  */
 uint8_t MPU6050_Base::getSlave4MasterDelay() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_MST_DLY_BIT, MPU6050_I2C_SLV4_MST_DLY_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_MST_DLY_BIT, MPU6050_I2C_SLV4_MST_DLY_LENGTH>>();
 }
 /** Set Slave 4 master delay value.
  * @param delay New Slave 4 master delay value
@@ -1376,7 +1350,7 @@ uint8_t MPU6050_Base::getSlave4MasterDelay() {
  * @see MPU6050_RA_I2C_SLV4_CTRL
  */
 void MPU6050_Base::setSlave4MasterDelay(uint8_t delay) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_MST_DLY_BIT, MPU6050_I2C_SLV4_MST_DLY_LENGTH, delay, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_I2C_SLV4_CTRL, MPU6050_I2C_SLV4_MST_DLY_BIT, MPU6050_I2C_SLV4_MST_DLY_LENGTH>>(delay);
 }
 /** Get last available byte read from Slave 4.
  * This register stores the data read from Slave 4. This field is populated
@@ -1401,8 +1375,7 @@ uint8_t MPU6050_Base::getSlate4InputByte() {
  * @see MPU6050_RA_I2C_MST_STATUS
  */
 bool MPU6050_Base::getPassthroughStatus() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_PASS_THROUGH_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_PASS_THROUGH_BIT>>();
 }
 /** Get Slave 4 transaction done status.
  * Automatically sets to 1 when a Slave 4 transaction has completed. This
@@ -1413,8 +1386,7 @@ bool MPU6050_Base::getPassthroughStatus() {
  * @see MPU6050_RA_I2C_MST_STATUS
  */
 bool MPU6050_Base::getSlave4IsDone() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV4_DONE_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV4_DONE_BIT>>();
 }
 /** Get master arbitration lost status.
  * This bit automatically sets to 1 when the I2C Master has lost arbitration of
@@ -1424,8 +1396,7 @@ bool MPU6050_Base::getSlave4IsDone() {
  * @see MPU6050_RA_I2C_MST_STATUS
  */
 bool MPU6050_Base::getLostArbitration() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_LOST_ARB_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_LOST_ARB_BIT>>();
 }
 /** Get Slave 4 NACK status.
  * This bit automatically sets to 1 when the I2C Master receives a NACK in a
@@ -1435,8 +1406,7 @@ bool MPU6050_Base::getLostArbitration() {
  * @see MPU6050_RA_I2C_MST_STATUS
  */
 bool MPU6050_Base::getSlave4Nack() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV4_NACK_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV4_NACK_BIT>>();
 }
 /** Get Slave 3 NACK status.
  * This bit automatically sets to 1 when the I2C Master receives a NACK in a
@@ -1446,8 +1416,7 @@ bool MPU6050_Base::getSlave4Nack() {
  * @see MPU6050_RA_I2C_MST_STATUS
  */
 bool MPU6050_Base::getSlave3Nack() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV3_NACK_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV3_NACK_BIT>>();
 }
 /** Get Slave 2 NACK status.
  * This bit automatically sets to 1 when the I2C Master receives a NACK in a
@@ -1457,8 +1426,7 @@ bool MPU6050_Base::getSlave3Nack() {
  * @see MPU6050_RA_I2C_MST_STATUS
  */
 bool MPU6050_Base::getSlave2Nack() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV2_NACK_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV2_NACK_BIT>>();
 }
 /** Get Slave 1 NACK status.
  * This bit automatically sets to 1 when the I2C Master receives a NACK in a
@@ -1468,8 +1436,7 @@ bool MPU6050_Base::getSlave2Nack() {
  * @see MPU6050_RA_I2C_MST_STATUS
  */
 bool MPU6050_Base::getSlave1Nack() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV1_NACK_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV1_NACK_BIT>>();
 }
 /** Get Slave 0 NACK status.
  * This bit automatically sets to 1 when the I2C Master receives a NACK in a
@@ -1479,8 +1446,7 @@ bool MPU6050_Base::getSlave1Nack() {
  * @see MPU6050_RA_I2C_MST_STATUS
  */
 bool MPU6050_Base::getSlave0Nack() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV0_NACK_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_STATUS, MPU6050_MST_I2C_SLV0_NACK_BIT>>();
 }
 
 // INT_PIN_CFG register
@@ -1492,8 +1458,7 @@ bool MPU6050_Base::getSlave0Nack() {
  * @see MPU6050_INTCFG_INT_LEVEL_BIT
  */
 bool MPU6050_Base::getInterruptMode() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_LEVEL_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_LEVEL_BIT>>();
 }
 /** Set interrupt logic level mode.
  * @param mode New interrupt mode (0=active-high, 1=active-low)
@@ -1502,7 +1467,7 @@ bool MPU6050_Base::getInterruptMode() {
  * @see MPU6050_INTCFG_INT_LEVEL_BIT
  */
 void MPU6050_Base::setInterruptMode(bool mode) {
-   I2Cdev::writeBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_LEVEL_BIT, mode, wireObj);
+   writeField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_LEVEL_BIT>>(mode);
 }
 /** Get interrupt drive mode.
  * Will be set 0 for push-pull, 1 for open-drain.
@@ -1511,8 +1476,7 @@ void MPU6050_Base::setInterruptMode(bool mode) {
  * @see MPU6050_INTCFG_INT_OPEN_BIT
  */
 bool MPU6050_Base::getInterruptDrive() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_OPEN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_OPEN_BIT>>();
 }
 /** Set interrupt drive mode.
  * @param drive New interrupt drive mode (0=push-pull, 1=open-drain)
@@ -1521,7 +1485,7 @@ bool MPU6050_Base::getInterruptDrive() {
  * @see MPU6050_INTCFG_INT_OPEN_BIT
  */
 void MPU6050_Base::setInterruptDrive(bool drive) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_OPEN_BIT, drive, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_OPEN_BIT>>(drive);
 }
 /** Get interrupt latch mode.
  * Will be set 0 for 50us-pulse, 1 for latch-until-int-cleared.
@@ -1530,8 +1494,7 @@ void MPU6050_Base::setInterruptDrive(bool drive) {
  * @see MPU6050_INTCFG_LATCH_INT_EN_BIT
  */
 bool MPU6050_Base::getInterruptLatch() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_LATCH_INT_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_LATCH_INT_EN_BIT>>();
 }
 /** Set interrupt latch mode.
  * @param latch New latch mode (0=50us-pulse, 1=latch-until-int-cleared)
@@ -1540,7 +1503,7 @@ bool MPU6050_Base::getInterruptLatch() {
  * @see MPU6050_INTCFG_LATCH_INT_EN_BIT
  */
 void MPU6050_Base::setInterruptLatch(bool latch) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_LATCH_INT_EN_BIT, latch, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_LATCH_INT_EN_BIT>>(latch);
 }
 /** Get interrupt latch clear mode.
  * Will be set 0 for status-read-only, 1 for any-register-read.
@@ -1549,8 +1512,7 @@ void MPU6050_Base::setInterruptLatch(bool latch) {
  * @see MPU6050_INTCFG_INT_RD_CLEAR_BIT
  */
 bool MPU6050_Base::getInterruptLatchClear() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_RD_CLEAR_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_RD_CLEAR_BIT>>();
 }
 /** Set interrupt latch clear mode.
  * @param clear New latch clear mode (0=status-read-only, 1=any-register-read)
@@ -1559,7 +1521,7 @@ bool MPU6050_Base::getInterruptLatchClear() {
  * @see MPU6050_INTCFG_INT_RD_CLEAR_BIT
  */
 void MPU6050_Base::setInterruptLatchClear(bool clear) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_RD_CLEAR_BIT, clear, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_RD_CLEAR_BIT>>(clear);
 }
 /** Get FSYNC interrupt logic level mode.
  * @return Current FSYNC interrupt mode (0=active-high, 1=active-low)
@@ -1568,8 +1530,7 @@ void MPU6050_Base::setInterruptLatchClear(bool clear) {
  * @see MPU6050_INTCFG_FSYNC_INT_LEVEL_BIT
  */
 bool MPU6050_Base::getFSyncInterruptLevel() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_FSYNC_INT_LEVEL_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_FSYNC_INT_LEVEL_BIT>>();
 }
 /** Set FSYNC interrupt logic level mode.
  * @param mode New FSYNC interrupt mode (0=active-high, 1=active-low)
@@ -1578,7 +1539,7 @@ bool MPU6050_Base::getFSyncInterruptLevel() {
  * @see MPU6050_INTCFG_FSYNC_INT_LEVEL_BIT
  */
 void MPU6050_Base::setFSyncInterruptLevel(bool level) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_FSYNC_INT_LEVEL_BIT, level, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_FSYNC_INT_LEVEL_BIT>>(level);
 }
 /** Get FSYNC pin interrupt enabled setting.
  * Will be set 0 for disabled, 1 for enabled.
@@ -1587,8 +1548,7 @@ void MPU6050_Base::setFSyncInterruptLevel(bool level) {
  * @see MPU6050_INTCFG_FSYNC_INT_EN_BIT
  */
 bool MPU6050_Base::getFSyncInterruptEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_FSYNC_INT_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_FSYNC_INT_EN_BIT>>();
 }
 /** Set FSYNC pin interrupt enabled setting.
  * @param enabled New FSYNC pin interrupt enabled setting
@@ -1597,7 +1557,7 @@ bool MPU6050_Base::getFSyncInterruptEnabled() {
  * @see MPU6050_INTCFG_FSYNC_INT_EN_BIT
  */
 void MPU6050_Base::setFSyncInterruptEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_FSYNC_INT_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_FSYNC_INT_EN_BIT>>(enabled);
 }
 /** Get I2C bypass enabled status.
  * When this bit is equal to 1 and I2C_MST_EN (Register 106 bit[5]) is equal to
@@ -1611,8 +1571,7 @@ void MPU6050_Base::setFSyncInterruptEnabled(bool enabled) {
  * @see MPU6050_INTCFG_I2C_BYPASS_EN_BIT
  */
 bool MPU6050_Base::getI2CBypassEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_I2C_BYPASS_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_I2C_BYPASS_EN_BIT>>();
 }
 /** Set I2C bypass enabled status.
  * When this bit is equal to 1 and I2C_MST_EN (Register 106 bit[5]) is equal to
@@ -1626,7 +1585,7 @@ bool MPU6050_Base::getI2CBypassEnabled() {
  * @see MPU6050_INTCFG_I2C_BYPASS_EN_BIT
  */
 void MPU6050_Base::setI2CBypassEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_I2C_BYPASS_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_I2C_BYPASS_EN_BIT>>(enabled);
 }
 /** Get reference clock output enabled status.
  * When this bit is equal to 1, a reference clock output is provided at the
@@ -1638,8 +1597,7 @@ void MPU6050_Base::setI2CBypassEnabled(bool enabled) {
  * @see MPU6050_INTCFG_CLKOUT_EN_BIT
  */
 bool MPU6050_Base::getClockOutputEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_CLKOUT_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_CLKOUT_EN_BIT>>();
 }
 /** Set reference clock output enabled status.
  * When this bit is equal to 1, a reference clock output is provided at the
@@ -1651,7 +1609,7 @@ bool MPU6050_Base::getClockOutputEnabled() {
  * @see MPU6050_INTCFG_CLKOUT_EN_BIT
  */
 void MPU6050_Base::setClockOutputEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_CLKOUT_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_CLKOUT_EN_BIT>>(enabled);
 }
 
 // INT_ENABLE register
@@ -1676,7 +1634,7 @@ uint8_t MPU6050_Base::getIntEnabled() {
  * @see MPU6050_INTERRUPT_FF_BIT
  **/
 void MPU6050_Base::setIntEnabled(uint8_t enabled) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_INT_ENABLE, enabled, wireObj);
+    writeByteReg(MPU6050_RA_INT_ENABLE, enabled);
 }
 /** Get Free Fall interrupt enabled status.
  * Will be set 0 for disabled, 1 for enabled.
@@ -1685,8 +1643,7 @@ void MPU6050_Base::setIntEnabled(uint8_t enabled) {
  * @see MPU6050_INTERRUPT_FF_BIT
  **/
 bool MPU6050_Base::getIntFreefallEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_FF_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_FF_BIT>>();
 }
 /** Set Free Fall interrupt enabled status.
  * @param enabled New interrupt enabled status
@@ -1695,7 +1652,7 @@ bool MPU6050_Base::getIntFreefallEnabled() {
  * @see MPU6050_INTERRUPT_FF_BIT
  **/
 void MPU6050_Base::setIntFreefallEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_FF_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_FF_BIT>>(enabled);
 }
 /** Get Motion Detection interrupt enabled status.
  * Will be set 0 for disabled, 1 for enabled.
@@ -1704,8 +1661,7 @@ void MPU6050_Base::setIntFreefallEnabled(bool enabled) {
  * @see MPU6050_INTERRUPT_MOT_BIT
  **/
 bool MPU6050_Base::getIntMotionEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_MOT_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_MOT_BIT>>();
 }
 /** Set Motion Detection interrupt enabled status.
  * @param enabled New interrupt enabled status
@@ -1714,7 +1670,7 @@ bool MPU6050_Base::getIntMotionEnabled() {
  * @see MPU6050_INTERRUPT_MOT_BIT
  **/
 void MPU6050_Base::setIntMotionEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_MOT_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_MOT_BIT>>(enabled);
 }
 /** Get Zero Motion Detection interrupt enabled status.
  * Will be set 0 for disabled, 1 for enabled.
@@ -1723,8 +1679,7 @@ void MPU6050_Base::setIntMotionEnabled(bool enabled) {
  * @see MPU6050_INTERRUPT_ZMOT_BIT
  **/
 bool MPU6050_Base::getIntZeroMotionEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_ZMOT_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_ZMOT_BIT>>();
 }
 /** Set Zero Motion Detection interrupt enabled status.
  * @param enabled New interrupt enabled status
@@ -1733,7 +1688,7 @@ bool MPU6050_Base::getIntZeroMotionEnabled() {
  * @see MPU6050_INTERRUPT_ZMOT_BIT
  **/
 void MPU6050_Base::setIntZeroMotionEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_ZMOT_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_ZMOT_BIT>>(enabled);
 }
 /** Get FIFO Buffer Overflow interrupt enabled status.
  * Will be set 0 for disabled, 1 for enabled.
@@ -1742,8 +1697,7 @@ void MPU6050_Base::setIntZeroMotionEnabled(bool enabled) {
  * @see MPU6050_INTERRUPT_FIFO_OFLOW_BIT
  **/
 bool MPU6050_Base::getIntFIFOBufferOverflowEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_FIFO_OFLOW_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_FIFO_OFLOW_BIT>>();
 }
 /** Set FIFO Buffer Overflow interrupt enabled status.
  * @param enabled New interrupt enabled status
@@ -1752,7 +1706,7 @@ bool MPU6050_Base::getIntFIFOBufferOverflowEnabled() {
  * @see MPU6050_INTERRUPT_FIFO_OFLOW_BIT
  **/
 void MPU6050_Base::setIntFIFOBufferOverflowEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_FIFO_OFLOW_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_FIFO_OFLOW_BIT>>(enabled);
 }
 /** Get I2C Master interrupt enabled status.
  * This enables any of the I2C Master interrupt sources to generate an
@@ -1762,8 +1716,7 @@ void MPU6050_Base::setIntFIFOBufferOverflowEnabled(bool enabled) {
  * @see MPU6050_INTERRUPT_I2C_MST_INT_BIT
  **/
 bool MPU6050_Base::getIntI2CMasterEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_I2C_MST_INT_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_I2C_MST_INT_BIT>>();
 }
 /** Set I2C Master interrupt enabled status.
  * @param enabled New interrupt enabled status
@@ -1772,7 +1725,7 @@ bool MPU6050_Base::getIntI2CMasterEnabled() {
  * @see MPU6050_INTERRUPT_I2C_MST_INT_BIT
  **/
 void MPU6050_Base::setIntI2CMasterEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_I2C_MST_INT_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_I2C_MST_INT_BIT>>(enabled);
 }
 /** Get Data Ready interrupt enabled setting.
  * This event occurs each time a write operation to all of the sensor registers
@@ -1782,8 +1735,7 @@ void MPU6050_Base::setIntI2CMasterEnabled(bool enabled) {
  * @see MPU6050_INTERRUPT_DATA_RDY_BIT
  */
 bool MPU6050_Base::getIntDataReadyEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_DATA_RDY_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_DATA_RDY_BIT>>();
 }
 /** Set Data Ready interrupt enabled status.
  * @param enabled New interrupt enabled status
@@ -1792,7 +1744,7 @@ bool MPU6050_Base::getIntDataReadyEnabled() {
  * @see MPU6050_INTERRUPT_DATA_RDY_BIT
  */
 void MPU6050_Base::setIntDataReadyEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_DATA_RDY_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_DATA_RDY_BIT>>(enabled);
 }
 
 // INT_STATUS register
@@ -1816,8 +1768,7 @@ uint8_t MPU6050_Base::getIntStatus() {
  * @see MPU6050_INTERRUPT_FF_BIT
  */
 bool MPU6050_Base::getIntFreefallStatus() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_FF_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_FF_BIT>>();
 }
 /** Get Motion Detection interrupt status.
  * This bit automatically sets to 1 when a Motion Detection interrupt has been
@@ -1827,8 +1778,7 @@ bool MPU6050_Base::getIntFreefallStatus() {
  * @see MPU6050_INTERRUPT_MOT_BIT
  */
 bool MPU6050_Base::getIntMotionStatus() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_MOT_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_MOT_BIT>>();
 }
 /** Get Zero Motion Detection interrupt status.
  * This bit automatically sets to 1 when a Zero Motion Detection interrupt has
@@ -1838,8 +1788,7 @@ bool MPU6050_Base::getIntMotionStatus() {
  * @see MPU6050_INTERRUPT_ZMOT_BIT
  */
 bool MPU6050_Base::getIntZeroMotionStatus() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_ZMOT_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_ZMOT_BIT>>();
 }
 /** Get FIFO Buffer Overflow interrupt status.
  * This bit automatically sets to 1 when a Free Fall interrupt has been
@@ -1849,8 +1798,7 @@ bool MPU6050_Base::getIntZeroMotionStatus() {
  * @see MPU6050_INTERRUPT_FIFO_OFLOW_BIT
  */
 bool MPU6050_Base::getIntFIFOBufferOverflowStatus() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_FIFO_OFLOW_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_FIFO_OFLOW_BIT>>();
 }
 /** Get I2C Master interrupt status.
  * This bit automatically sets to 1 when an I2C Master interrupt has been
@@ -1861,8 +1809,7 @@ bool MPU6050_Base::getIntFIFOBufferOverflowStatus() {
  * @see MPU6050_INTERRUPT_I2C_MST_INT_BIT
  */
 bool MPU6050_Base::getIntI2CMasterStatus() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_I2C_MST_INT_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_I2C_MST_INT_BIT>>();
 }
 /** Get Data Ready interrupt status.
  * This bit automatically sets to 1 when a Data Ready interrupt has been
@@ -1872,8 +1819,7 @@ bool MPU6050_Base::getIntI2CMasterStatus() {
  * @see MPU6050_INTERRUPT_DATA_RDY_BIT
  */
 bool MPU6050_Base::getIntDataReadyStatus() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_DATA_RDY_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_DATA_RDY_BIT>>();
 }
 
 // ACCEL_*OUT_* registers
@@ -2004,6 +1950,30 @@ int16_t MPU6050_Base::getTemperature() {
     return (((int16_t)buffer[0]) << 8) | buffer[1];
 }
 
+/** Get acceleration and temperature in one 8-byte burst.
+ * ACCEL_XOUT_H..TEMP_OUT_L are contiguous, so the temperature costs two more
+ * bytes on the bus instead of a second transaction. The registers are read
+ * straight into the struct and byte-swapped in place on little-endian hosts.
+ * data is only meaningful when true is returned.
+ * @param data Struct to fill with the raw accel XYZ and TEMP_OUT values
+ * @return True if all 8 bytes were read
+ * @see getAcceleration()
+ * @see getTemperature()
+ */
+bool MPU6050_Base::getAccelTemp(MPU6050_AccelTemp* data) {
+    static_assert(sizeof(MPU6050_AccelTemp) == 8, "ACCEL_XOUT_H..TEMP_OUT_L is 8 bytes");
+    uint8_t *b = reinterpret_cast<uint8_t *>(data);
+    if (I2Cdev::readBytes(devAddr, MPU6050_RA_ACCEL_XOUT_H, 8, b, I2Cdev::readTimeout, wireObj) != 8) return false;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (uint8_t i = 0; i < 8; i += 2) {
+        uint8_t high = b[i];
+        b[i] = b[i + 1];
+        b[i + 1] = high;
+    }
+#endif
+    return true;
+}
+
 // GYRO_*OUT_* registers
 
 /** Get 3-axis gyroscope readings.
@@ -2187,8 +2157,7 @@ uint8_t MPU6050_Base::getMotionStatus() {
  * @see MPU6050_MOTION_MOT_XNEG_BIT
  */
 bool MPU6050_Base::getXNegMotionDetected() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_XNEG_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_XNEG_BIT>>();
 }
 /** Get X-axis positive motion detection interrupt status.
  * @return Motion detection status
@@ -2196,8 +2165,7 @@ bool MPU6050_Base::getXNegMotionDetected() {
  * @see MPU6050_MOTION_MOT_XPOS_BIT
  */
 bool MPU6050_Base::getXPosMotionDetected() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_XPOS_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_XPOS_BIT>>();
 }
 /** Get Y-axis negative motion detection interrupt status.
  * @return Motion detection status
@@ -2205,8 +2173,7 @@ bool MPU6050_Base::getXPosMotionDetected() {
  * @see MPU6050_MOTION_MOT_YNEG_BIT
  */
 bool MPU6050_Base::getYNegMotionDetected() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_YNEG_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_YNEG_BIT>>();
 }
 /** Get Y-axis positive motion detection interrupt status.
  * @return Motion detection status
@@ -2214,8 +2181,7 @@ bool MPU6050_Base::getYNegMotionDetected() {
  * @see MPU6050_MOTION_MOT_YPOS_BIT
  */
 bool MPU6050_Base::getYPosMotionDetected() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_YPOS_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_YPOS_BIT>>();
 }
 /** Get Z-axis negative motion detection interrupt status.
  * @return Motion detection status
@@ -2223,8 +2189,7 @@ bool MPU6050_Base::getYPosMotionDetected() {
  * @see MPU6050_MOTION_MOT_ZNEG_BIT
  */
 bool MPU6050_Base::getZNegMotionDetected() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_ZNEG_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_ZNEG_BIT>>();
 }
 /** Get Z-axis positive motion detection interrupt status.
  * @return Motion detection status
@@ -2232,8 +2197,7 @@ bool MPU6050_Base::getZNegMotionDetected() {
  * @see MPU6050_MOTION_MOT_ZPOS_BIT
  */
 bool MPU6050_Base::getZPosMotionDetected() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_ZPOS_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_ZPOS_BIT>>();
 }
 /** Get zero motion detection interrupt status.
  * @return Motion detection status
@@ -2241,8 +2205,7 @@ bool MPU6050_Base::getZPosMotionDetected() {
  * @see MPU6050_MOTION_MOT_ZRMOT_BIT
  */
 bool MPU6050_Base::getZeroMotionDetected() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_ZRMOT_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_STATUS, MPU6050_MOTION_MOT_ZRMOT_BIT>>();
 }
 
 // I2C_SLV*_DO register
@@ -2257,7 +2220,7 @@ bool MPU6050_Base::getZeroMotionDetected() {
  */
 void MPU6050_Base::setSlaveOutputByte(uint8_t num, uint8_t data) {
     if (num > 3) return;
-    I2Cdev::writeByte(devAddr, MPU6050_RA_I2C_SLV0_DO + num, data, wireObj);
+    writeByteReg(MPU6050_RA_I2C_SLV0_DO + num, data);
 }
 
 // I2C_MST_DELAY_CTRL register
@@ -2271,8 +2234,7 @@ void MPU6050_Base::setSlaveOutputByte(uint8_t num, uint8_t data) {
  * @see MPU6050_DELAYCTRL_DELAY_ES_SHADOW_BIT
  */
 bool MPU6050_Base::getExternalShadowDelayEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_I2C_MST_DELAY_CTRL, MPU6050_DELAYCTRL_DELAY_ES_SHADOW_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_DELAY_CTRL, MPU6050_DELAYCTRL_DELAY_ES_SHADOW_BIT>>();
 }
 /** Set external data shadow delay enabled status.
  * @param enabled New external data shadow delay enabled status.
@@ -2281,7 +2243,7 @@ bool MPU6050_Base::getExternalShadowDelayEnabled() {
  * @see MPU6050_DELAYCTRL_DELAY_ES_SHADOW_BIT
  */
 void MPU6050_Base::setExternalShadowDelayEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_MST_DELAY_CTRL, MPU6050_DELAYCTRL_DELAY_ES_SHADOW_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_I2C_MST_DELAY_CTRL, MPU6050_DELAYCTRL_DELAY_ES_SHADOW_BIT>>(enabled);
 }
 /** Get slave delay enabled status.
  * When a particular slave delay is enabled, the rate of access for the that
@@ -2314,7 +2276,7 @@ bool MPU6050_Base::getSlaveDelayEnabled(uint8_t num) {
  * @see MPU6050_DELAYCTRL_I2C_SLV0_DLY_EN_BIT
  */
 void MPU6050_Base::setSlaveDelayEnabled(uint8_t num, bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_I2C_MST_DELAY_CTRL, num, enabled, wireObj);
+    writeBitReg(MPU6050_RA_I2C_MST_DELAY_CTRL, num, enabled);
 }
 
 // SIGNAL_PATH_RESET register
@@ -2326,7 +2288,7 @@ void MPU6050_Base::setSlaveDelayEnabled(uint8_t num, bool enabled) {
  * @see MPU6050_PATHRESET_GYRO_RESET_BIT
  */
 void MPU6050_Base::resetGyroscopePath() {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_SIGNAL_PATH_RESET, MPU6050_PATHRESET_GYRO_RESET_BIT, true, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_SIGNAL_PATH_RESET, MPU6050_PATHRESET_GYRO_RESET_BIT>>(true);
 }
 /** Reset accelerometer signal path.
  * The reset will revert the signal path analog to digital converters and
@@ -2335,7 +2297,7 @@ void MPU6050_Base::resetGyroscopePath() {
  * @see MPU6050_PATHRESET_ACCEL_RESET_BIT
  */
 void MPU6050_Base::resetAccelerometerPath() {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_SIGNAL_PATH_RESET, MPU6050_PATHRESET_ACCEL_RESET_BIT, true, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_SIGNAL_PATH_RESET, MPU6050_PATHRESET_ACCEL_RESET_BIT>>(true);
 }
 /** Reset temperature sensor signal path.
  * The reset will revert the signal path analog to digital converters and
@@ -2344,7 +2306,7 @@ void MPU6050_Base::resetAccelerometerPath() {
  * @see MPU6050_PATHRESET_TEMP_RESET_BIT
  */
 void MPU6050_Base::resetTemperaturePath() {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_SIGNAL_PATH_RESET, MPU6050_PATHRESET_TEMP_RESET_BIT, true, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_SIGNAL_PATH_RESET, MPU6050_PATHRESET_TEMP_RESET_BIT>>(true);
 }
 
 // MOT_DETECT_CTRL register
@@ -2364,8 +2326,7 @@ void MPU6050_Base::resetTemperaturePath() {
  * @see MPU6050_DETECT_ACCEL_ON_DELAY_BIT
  */
 uint8_t MPU6050_Base::getAccelerometerPowerOnDelay() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_ACCEL_ON_DELAY_BIT, MPU6050_DETECT_ACCEL_ON_DELAY_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_ACCEL_ON_DELAY_BIT, MPU6050_DETECT_ACCEL_ON_DELAY_LENGTH>>();
 }
 /** Set accelerometer power-on delay.
  * @param delay New accelerometer power-on delay (0-3)
@@ -2374,7 +2335,7 @@ uint8_t MPU6050_Base::getAccelerometerPowerOnDelay() {
  * @see MPU6050_DETECT_ACCEL_ON_DELAY_BIT
  */
 void MPU6050_Base::setAccelerometerPowerOnDelay(uint8_t delay) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_ACCEL_ON_DELAY_BIT, MPU6050_DETECT_ACCEL_ON_DELAY_LENGTH, delay, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_ACCEL_ON_DELAY_BIT, MPU6050_DETECT_ACCEL_ON_DELAY_LENGTH>>(delay);
 }
 /** Get Free Fall detection counter decrement configuration.
  * Detection is registered by the Free Fall detection module after accelerometer
@@ -2403,8 +2364,7 @@ void MPU6050_Base::setAccelerometerPowerOnDelay(uint8_t delay) {
  * @see MPU6050_DETECT_FF_COUNT_BIT
  */
 uint8_t MPU6050_Base::getFreefallDetectionCounterDecrement() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_FF_COUNT_BIT, MPU6050_DETECT_FF_COUNT_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_FF_COUNT_BIT, MPU6050_DETECT_FF_COUNT_LENGTH>>();
 }
 /** Set Free Fall detection counter decrement configuration.
  * @param decrement New decrement configuration value
@@ -2413,7 +2373,7 @@ uint8_t MPU6050_Base::getFreefallDetectionCounterDecrement() {
  * @see MPU6050_DETECT_FF_COUNT_BIT
  */
 void MPU6050_Base::setFreefallDetectionCounterDecrement(uint8_t decrement) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_FF_COUNT_BIT, MPU6050_DETECT_FF_COUNT_LENGTH, decrement, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_FF_COUNT_BIT, MPU6050_DETECT_FF_COUNT_LENGTH>>(decrement);
 }
 /** Get Motion detection counter decrement configuration.
  * Detection is registered by the Motion detection module after accelerometer
@@ -2439,8 +2399,7 @@ void MPU6050_Base::setFreefallDetectionCounterDecrement(uint8_t decrement) {
  *
  */
 uint8_t MPU6050_Base::getMotionDetectionCounterDecrement() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_MOT_COUNT_BIT, MPU6050_DETECT_MOT_COUNT_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_MOT_COUNT_BIT, MPU6050_DETECT_MOT_COUNT_LENGTH>>();
 }
 /** Set Motion detection counter decrement configuration.
  * @param decrement New decrement configuration value
@@ -2449,7 +2408,7 @@ uint8_t MPU6050_Base::getMotionDetectionCounterDecrement() {
  * @see MPU6050_DETECT_MOT_COUNT_BIT
  */
 void MPU6050_Base::setMotionDetectionCounterDecrement(uint8_t decrement) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_MOT_COUNT_BIT, MPU6050_DETECT_MOT_COUNT_LENGTH, decrement, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_MOT_DETECT_CTRL, MPU6050_DETECT_MOT_COUNT_BIT, MPU6050_DETECT_MOT_COUNT_LENGTH>>(decrement);
 }
 
 // USER_CTRL register
@@ -2463,8 +2422,7 @@ void MPU6050_Base::setMotionDetectionCounterDecrement(uint8_t decrement) {
  * @see MPU6050_USERCTRL_FIFO_EN_BIT
  */
 bool MPU6050_Base::getFIFOEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_EN_BIT>>();
 }
 /** Set FIFO enabled status.
  * @param enabled New FIFO enabled status
@@ -2473,7 +2431,7 @@ bool MPU6050_Base::getFIFOEnabled() {
  * @see MPU6050_USERCTRL_FIFO_EN_BIT
  */
 void MPU6050_Base::setFIFOEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_EN_BIT>>(enabled);
 }
 /** Get I2C Master Mode enabled status.
  * When this mode is enabled, the MPU-60X0 acts as the I2C Master to the
@@ -2487,8 +2445,7 @@ void MPU6050_Base::setFIFOEnabled(bool enabled) {
  * @see MPU6050_USERCTRL_I2C_MST_EN_BIT
  */
 bool MPU6050_Base::getI2CMasterModeEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_I2C_MST_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_I2C_MST_EN_BIT>>();
 }
 /** Set I2C Master Mode enabled status.
  * @param enabled New I2C Master Mode enabled status
@@ -2497,14 +2454,14 @@ bool MPU6050_Base::getI2CMasterModeEnabled() {
  * @see MPU6050_USERCTRL_I2C_MST_EN_BIT
  */
 void MPU6050_Base::setI2CMasterModeEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_I2C_MST_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_I2C_MST_EN_BIT>>(enabled);
 }
 /** Switch from I2C to SPI mode (MPU-6000 only)
  * If this is set, the primary SPI interface will be enabled in place of the
  * disabled primary I2C interface.
  */
 void MPU6050_Base::switchSPIEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_I2C_IF_DIS_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_I2C_IF_DIS_BIT>>(enabled);
 }
 /** Reset the FIFO.
  * This bit resets the FIFO buffer when set to 1 while FIFO_EN equals 0. This
@@ -2513,7 +2470,7 @@ void MPU6050_Base::switchSPIEnabled(bool enabled) {
  * @see MPU6050_USERCTRL_FIFO_RESET_BIT
  */
 void MPU6050_Base::resetFIFO() {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_RESET_BIT, true, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_RESET_BIT>>(true);
 }
 /** Reset the I2C Master.
  * This bit resets the I2C Master when set to 1 while I2C_MST_EN equals 0.
@@ -2522,7 +2479,7 @@ void MPU6050_Base::resetFIFO() {
  * @see MPU6050_USERCTRL_I2C_MST_RESET_BIT
  */
 void MPU6050_Base::resetI2CMaster() {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_I2C_MST_RESET_BIT, true, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_I2C_MST_RESET_BIT>>(true);
 }
 /** Reset all sensor registers and signal paths.
  * When set to 1, this bit resets the signal paths for all sensors (gyroscopes,
@@ -2537,7 +2494,7 @@ void MPU6050_Base::resetI2CMaster() {
  * @see MPU6050_USERCTRL_SIG_COND_RESET_BIT
  */
 void MPU6050_Base::resetSensors() {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_SIG_COND_RESET_BIT, true, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_SIG_COND_RESET_BIT>>(true);
 }
 
 // PWR_MGMT_1 register
@@ -2548,7 +2505,7 @@ void MPU6050_Base::resetSensors() {
  * @see MPU6050_PWR1_DEVICE_RESET_BIT
  */
 void MPU6050_Base::reset() {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_DEVICE_RESET_BIT, true, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_DEVICE_RESET_BIT>>(true);
 }
 /** Get sleep mode status.
  * Setting the SLEEP bit in the register puts the device into very low power
@@ -2562,8 +2519,7 @@ void MPU6050_Base::reset() {
  * @see MPU6050_PWR1_SLEEP_BIT
  */
 bool MPU6050_Base::getSleepEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_SLEEP_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_SLEEP_BIT>>();
 }
 /** Set sleep mode status.
  * @param enabled New sleep mode enabled status
@@ -2572,7 +2528,7 @@ bool MPU6050_Base::getSleepEnabled() {
  * @see MPU6050_PWR1_SLEEP_BIT
  */
 void MPU6050_Base::setSleepEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_SLEEP_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_SLEEP_BIT>>(enabled);
 }
 /** Get wake cycle enabled status.
  * When this bit is set to 1 and SLEEP is disabled, the MPU-60X0 will cycle
@@ -2583,8 +2539,7 @@ void MPU6050_Base::setSleepEnabled(bool enabled) {
  * @see MPU6050_PWR1_CYCLE_BIT
  */
 bool MPU6050_Base::getWakeCycleEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_CYCLE_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_CYCLE_BIT>>();
 }
 /** Set wake cycle enabled status.
  * @param enabled New sleep mode enabled status
@@ -2593,7 +2548,7 @@ bool MPU6050_Base::getWakeCycleEnabled() {
  * @see MPU6050_PWR1_CYCLE_BIT
  */
 void MPU6050_Base::setWakeCycleEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_CYCLE_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_CYCLE_BIT>>(enabled);
 }
 /** Get temperature sensor enabled status.
  * Control the usage of the internal temperature sensor.
@@ -2607,8 +2562,7 @@ void MPU6050_Base::setWakeCycleEnabled(bool enabled) {
  * @see MPU6050_PWR1_TEMP_DIS_BIT
  */
 bool MPU6050_Base::getTempSensorEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_TEMP_DIS_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0] == 0; // 1 is actually disabled here
+    return readField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_TEMP_DIS_BIT>>() == 0; // 1 is actually disabled here
 }
 /** Set temperature sensor enabled status.
  * Note: this register stores the *disabled* value, but for consistency with the
@@ -2622,7 +2576,7 @@ bool MPU6050_Base::getTempSensorEnabled() {
  */
 void MPU6050_Base::setTempSensorEnabled(bool enabled) {
     // 1 is actually disabled here
-    I2Cdev::writeBit(devAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_TEMP_DIS_BIT, !enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_TEMP_DIS_BIT>>(!enabled);
 }
 /** Get clock source setting.
  * @return Current clock source setting
@@ -2631,8 +2585,7 @@ void MPU6050_Base::setTempSensorEnabled(bool enabled) {
  * @see MPU6050_PWR1_CLKSEL_LENGTH
  */
 uint8_t MPU6050_Base::getClockSource() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_CLKSEL_BIT, MPU6050_PWR1_CLKSEL_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_CLKSEL_BIT, MPU6050_PWR1_CLKSEL_LENGTH>>();
 }
 /** Set clock source setting.
  * An internal 8MHz oscillator, gyroscope based clock, or external sources can
@@ -2665,7 +2618,7 @@ uint8_t MPU6050_Base::getClockSource() {
  * @see MPU6050_PWR1_CLKSEL_LENGTH
  */
 void MPU6050_Base::setClockSource(uint8_t source) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_CLKSEL_BIT, MPU6050_PWR1_CLKSEL_LENGTH, source, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_CLKSEL_BIT, MPU6050_PWR1_CLKSEL_LENGTH>>(source);
 }
 
 // PWR_MGMT_2 register
@@ -2694,15 +2647,14 @@ void MPU6050_Base::setClockSource(uint8_t source) {
  * @see MPU6050_RA_PWR_MGMT_2
  */
 uint8_t MPU6050_Base::getWakeFrequency() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_LP_WAKE_CTRL_BIT, MPU6050_PWR2_LP_WAKE_CTRL_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_LP_WAKE_CTRL_BIT, MPU6050_PWR2_LP_WAKE_CTRL_LENGTH>>();
 }
 /** Set wake frequency in Accel-Only Low Power Mode.
  * @param frequency New wake frequency
  * @see MPU6050_RA_PWR_MGMT_2
  */
 void MPU6050_Base::setWakeFrequency(uint8_t frequency) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_LP_WAKE_CTRL_BIT, MPU6050_PWR2_LP_WAKE_CTRL_LENGTH, frequency, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_LP_WAKE_CTRL_BIT, MPU6050_PWR2_LP_WAKE_CTRL_LENGTH>>(frequency);
 }
 
 /** Get X-axis accelerometer standby enabled status.
@@ -2712,8 +2664,7 @@ void MPU6050_Base::setWakeFrequency(uint8_t frequency) {
  * @see MPU6050_PWR2_STBY_XA_BIT
  */
 bool MPU6050_Base::getStandbyXAccelEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_XA_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_XA_BIT>>();
 }
 /** Set X-axis accelerometer standby enabled status.
  * @param New X-axis standby enabled status
@@ -2722,7 +2673,7 @@ bool MPU6050_Base::getStandbyXAccelEnabled() {
  * @see MPU6050_PWR2_STBY_XA_BIT
  */
 void MPU6050_Base::setStandbyXAccelEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_XA_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_XA_BIT>>(enabled);
 }
 /** Get Y-axis accelerometer standby enabled status.
  * If enabled, the Y-axis will not gather or report data (or use power).
@@ -2731,8 +2682,7 @@ void MPU6050_Base::setStandbyXAccelEnabled(bool enabled) {
  * @see MPU6050_PWR2_STBY_YA_BIT
  */
 bool MPU6050_Base::getStandbyYAccelEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_YA_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_YA_BIT>>();
 }
 /** Set Y-axis accelerometer standby enabled status.
  * @param New Y-axis standby enabled status
@@ -2741,7 +2691,7 @@ bool MPU6050_Base::getStandbyYAccelEnabled() {
  * @see MPU6050_PWR2_STBY_YA_BIT
  */
 void MPU6050_Base::setStandbyYAccelEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_YA_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_YA_BIT>>(enabled);
 }
 /** Get Z-axis accelerometer standby enabled status.
  * If enabled, the Z-axis will not gather or report data (or use power).
@@ -2750,8 +2700,7 @@ void MPU6050_Base::setStandbyYAccelEnabled(bool enabled) {
  * @see MPU6050_PWR2_STBY_ZA_BIT
  */
 bool MPU6050_Base::getStandbyZAccelEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_ZA_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_ZA_BIT>>();
 }
 /** Set Z-axis accelerometer standby enabled status.
  * @param New Z-axis standby enabled status
@@ -2760,7 +2709,7 @@ bool MPU6050_Base::getStandbyZAccelEnabled() {
  * @see MPU6050_PWR2_STBY_ZA_BIT
  */
 void MPU6050_Base::setStandbyZAccelEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_ZA_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_ZA_BIT>>(enabled);
 }
 /** Get X-axis gyroscope standby enabled status.
  * If enabled, the X-axis will not gather or report data (or use power).
@@ -2769,8 +2718,7 @@ void MPU6050_Base::setStandbyZAccelEnabled(bool enabled) {
  * @see MPU6050_PWR2_STBY_XG_BIT
  */
 bool MPU6050_Base::getStandbyXGyroEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_XG_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_XG_BIT>>();
 }
 /** Set X-axis gyroscope standby enabled status.
  * @param New X-axis standby enabled status
@@ -2779,7 +2727,7 @@ bool MPU6050_Base::getStandbyXGyroEnabled() {
  * @see MPU6050_PWR2_STBY_XG_BIT
  */
 void MPU6050_Base::setStandbyXGyroEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_XG_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_XG_BIT>>(enabled);
 }
 /** Get Y-axis gyroscope standby enabled status.
  * If enabled, the Y-axis will not gather or report data (or use power).
@@ -2788,8 +2736,7 @@ void MPU6050_Base::setStandbyXGyroEnabled(bool enabled) {
  * @see MPU6050_PWR2_STBY_YG_BIT
  */
 bool MPU6050_Base::getStandbyYGyroEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_YG_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_YG_BIT>>();
 }
 /** Set Y-axis gyroscope standby enabled status.
  * @param New Y-axis standby enabled status
@@ -2798,7 +2745,7 @@ bool MPU6050_Base::getStandbyYGyroEnabled() {
  * @see MPU6050_PWR2_STBY_YG_BIT
  */
 void MPU6050_Base::setStandbyYGyroEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_YG_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_YG_BIT>>(enabled);
 }
 /** Get Z-axis gyroscope standby enabled status.
  * If enabled, the Z-axis will not gather or report data (or use power).
@@ -2807,8 +2754,7 @@ void MPU6050_Base::setStandbyYGyroEnabled(bool enabled) {
  * @see MPU6050_PWR2_STBY_ZG_BIT
  */
 bool MPU6050_Base::getStandbyZGyroEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_ZG_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_ZG_BIT>>();
 }
 /** Set Z-axis gyroscope standby enabled status.
  * @param New Z-axis standby enabled status
@@ -2817,7 +2763,7 @@ bool MPU6050_Base::getStandbyZGyroEnabled() {
  * @see MPU6050_PWR2_STBY_ZG_BIT
  */
 void MPU6050_Base::setStandbyZGyroEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_ZG_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_ZG_BIT>>(enabled);
 }
 
 // FIFO_COUNT* registers
@@ -2873,6 +2819,84 @@ void MPU6050_Base::getFIFOBytes(uint8_t *data, uint8_t length) {
     }
 }
 
+/** Read a block of up to a full FIFO (1024 bytes) in one call.
+ * Unlike getFIFOBytes() the length is 16-bit; the read is split into
+ * Wire-buffer sized chunks internally (see I2Cdev::readBytesLong()).
+ * Check FIFO_COUNT first - reading past the end returns stale bytes.
+ * @param data Buffer to store read data in
+ * @param length Number of bytes to read
+ * @return Number of bytes read (-1 indicates failure)
+ */
+int16_t MPU6050_Base::getFIFOBlock(uint8_t *data, uint16_t length) {
+    if (length == 0) return 0;
+    return I2Cdev::readBytesLong(devAddr, MPU6050_RA_FIFO_R_W, length, data, I2Cdev::readTimeout, wireObj);
+}
+
+/** Start a split-phase FIFO block read.
+ * Same transfer as getFIFOBlock(), but driven one chunk at a time with
+ * I2Cdev::readBytesPoll(req) so the caller can do other work in between.
+ * @param req Request state, owned by the caller until the read completes
+ * @param data Buffer to store read data in
+ * @param length Number of bytes to read
+ * @return False if the device didn't acknowledge
+ * @see I2Cdev::readBytesBegin()
+ */
+bool MPU6050_Base::beginFIFOBlock(I2CdevRequest *req, uint8_t *data, uint16_t length) {
+    return I2Cdev::readBytesBegin(req, devAddr, MPU6050_RA_FIFO_R_W, length, data, I2Cdev::readTimeout, wireObj);
+}
+
+/** Read up to maxN accel samples from the FIFO into separate X, Y, Z arrays.
+ * Expects an accel-only FIFO (FIFO_EN = ACCEL_FIFO_EN, 6 bytes per sample,
+ * as accelOnlyProfile() sets). Checks the overflow flag first: after an
+ * overflow the FIFO holds torn samples, so nothing is read and the caller
+ * should resetFIFO(). The bytes are read in chunks of MPU6050_BATCH_CHUNK
+ * samples through a small stack buffer and unpacked with unpackAccelFIFO().
+ * Reading INT_STATUS clears the other interrupt status bits too.
+ * @param x Buffer for at least maxN X-axis samples
+ * @param y Buffer for at least maxN Y-axis samples
+ * @param z Buffer for at least maxN Z-axis samples
+ * @param maxN Most samples to read; the rest stay in the FIFO
+ * @return Samples read, and whether the FIFO needs a reset
+ * @see unpackAccelFIFO()
+ */
+MPU6050_Batch MPU6050_Base::readAccelBatch(int16_t *x, int16_t *y, int16_t *z, uint16_t maxN) {
+    MPU6050_Batch batch = { 0, false, false };
+    if (getIntFIFOBufferOverflowStatus()) {
+        batch.overflow = true;
+        return batch;
+    }
+    uint16_t n = getFIFOCount() / 6;
+    if (n > maxN) n = maxN;
+    uint8_t chunk[MPU6050_BATCH_CHUNK * 6];
+    while (batch.count < n) {
+        uint16_t k = n - batch.count;
+        if (k > MPU6050_BATCH_CHUNK) k = MPU6050_BATCH_CHUNK;
+        if (getFIFOBlock(chunk, k * 6) != (int16_t)(k * 6)) {
+            batch.error = true;
+            break;
+        }
+        unpackAccelFIFO(chunk, k, x + batch.count, y + batch.count, z + batch.count);
+        batch.count += k;
+    }
+    return batch;
+}
+
+/** Split n big-endian accel FIFO samples (XH XL YH YL ZH ZL) into X, Y, Z.
+ * For callers that read the FIFO themselves, e.g. with beginFIFOBlock().
+ * @param fifo 6 * n bytes as read from FIFO_R_W
+ * @param n Number of samples
+ * @param x Buffer for n X-axis samples
+ * @param y Buffer for n Y-axis samples
+ * @param z Buffer for n Z-axis samples
+ */
+void MPU6050_Base::unpackAccelFIFO(const uint8_t *fifo, uint16_t n, int16_t *x, int16_t *y, int16_t *z) {
+    for (uint16_t i = 0; i < n; i++, fifo += 6) {
+        x[i] = (int16_t)((fifo[0] << 8) | fifo[1]);
+        y[i] = (int16_t)((fifo[2] << 8) | fifo[3]);
+        z[i] = (int16_t)((fifo[4] << 8) | fifo[5]);
+    }
+}
+
 /** Get timeout to get a packet from FIFO buffer.
  * @return Current timeout to get a packet from FIFO buffer
  * @see MPU6050_FIFO_DEFAULT_TIMEOUT
@@ -2936,7 +2960,7 @@ void MPU6050_Base::setFIFOTimeout(uint32_t fifoTimeout) {
  * @see MPU6050_RA_FIFO_R_W
  */
 void MPU6050_Base::setFIFOByte(uint8_t data) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_FIFO_R_W, data, wireObj);
+    writeByteReg(MPU6050_RA_FIFO_R_W, data);
 }
 
 // WHO_AM_I register
@@ -2949,8 +2973,7 @@ void MPU6050_Base::setFIFOByte(uint8_t data) {
  * @see MPU6050_WHO_AM_I_LENGTH
  */
 uint8_t MPU6050_Base::getDeviceID() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_WHO_AM_I, MPU6050_WHO_AM_I_BIT, MPU6050_WHO_AM_I_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_WHO_AM_I, MPU6050_WHO_AM_I_BIT, MPU6050_WHO_AM_I_LENGTH>>();
 }
 /** Set Device ID.
  * Write a new ID into the WHO_AM_I register (no idea why this should ever be
@@ -2962,7 +2985,7 @@ uint8_t MPU6050_Base::getDeviceID() {
  * @see MPU6050_WHO_AM_I_LENGTH
  */
 void MPU6050_Base::setDeviceID(uint8_t id) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_WHO_AM_I, MPU6050_WHO_AM_I_BIT, MPU6050_WHO_AM_I_LENGTH, id, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_WHO_AM_I, MPU6050_WHO_AM_I_BIT, MPU6050_WHO_AM_I_LENGTH>>(id);
 }
 
 // ======== UNDOCUMENTED/DMP REGISTERS/METHODS ========
@@ -2970,38 +2993,34 @@ void MPU6050_Base::setDeviceID(uint8_t id) {
 // XG_OFFS_TC register
 
 uint8_t MPU6050_Base::getOTPBankValid() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_XG_OFFS_TC, MPU6050_TC_OTP_BNK_VLD_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_XG_OFFS_TC, MPU6050_TC_OTP_BNK_VLD_BIT>>();
 }
 void MPU6050_Base::setOTPBankValid(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_XG_OFFS_TC, MPU6050_TC_OTP_BNK_VLD_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_XG_OFFS_TC, MPU6050_TC_OTP_BNK_VLD_BIT>>(enabled);
 }
 int8_t MPU6050_Base::getXGyroOffsetTC() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_XG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_XG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH>>();
 }
 void MPU6050_Base::setXGyroOffsetTC(int8_t offset) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_XG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH, offset, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_XG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH>>(offset);
 }
 
 // YG_OFFS_TC register
 
 int8_t MPU6050_Base::getYGyroOffsetTC() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_YG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_YG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH>>();
 }
 void MPU6050_Base::setYGyroOffsetTC(int8_t offset) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_YG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH, offset, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_YG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH>>(offset);
 }
 
 // ZG_OFFS_TC register
 
 int8_t MPU6050_Base::getZGyroOffsetTC() {
-    I2Cdev::readBits(devAddr, MPU6050_RA_ZG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_ZG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH>>();
 }
 void MPU6050_Base::setZGyroOffsetTC(int8_t offset) {
-    I2Cdev::writeBits(devAddr, MPU6050_RA_ZG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH, offset, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_ZG_OFFS_TC, MPU6050_TC_OFFSET_BIT, MPU6050_TC_OFFSET_LENGTH>>(offset);
 }
 
 // X_FINE_GAIN register
@@ -3011,7 +3030,7 @@ int8_t MPU6050_Base::getXFineGain() {
     return buffer[0];
 }
 void MPU6050_Base::setXFineGain(int8_t gain) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_X_FINE_GAIN, gain, wireObj);
+    writeByteReg(MPU6050_RA_X_FINE_GAIN, gain);
 }
 
 // Y_FINE_GAIN register
@@ -3021,7 +3040,7 @@ int8_t MPU6050_Base::getYFineGain() {
     return buffer[0];
 }
 void MPU6050_Base::setYFineGain(int8_t gain) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_Y_FINE_GAIN, gain, wireObj);
+    writeByteReg(MPU6050_RA_Y_FINE_GAIN, gain);
 }
 
 // Z_FINE_GAIN register
@@ -3031,7 +3050,7 @@ int8_t MPU6050_Base::getZFineGain() {
     return buffer[0];
 }
 void MPU6050_Base::setZFineGain(int8_t gain) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_Z_FINE_GAIN, gain, wireObj);
+    writeByteReg(MPU6050_RA_Z_FINE_GAIN, gain);
 }
 
 // XA_OFFS_* registers
@@ -3043,7 +3062,7 @@ int16_t MPU6050_Base::getXAccelOffset() {
 }
 void MPU6050_Base::setXAccelOffset(int16_t offset) {
 	uint8_t SaveAddress = ((getDeviceID() < 0x38 )? MPU6050_RA_XA_OFFS_H:0x77); // MPU6050,MPU9150 Vs MPU6500,MPU9250
-	I2Cdev::writeWord(devAddr, SaveAddress, offset, wireObj);
+	writeWordReg(SaveAddress, offset);
 }
 
 // YA_OFFS_* register
@@ -3055,7 +3074,7 @@ int16_t MPU6050_Base::getYAccelOffset() {
 }
 void MPU6050_Base::setYAccelOffset(int16_t offset) {
 	uint8_t SaveAddress = ((getDeviceID() < 0x38 )? MPU6050_RA_YA_OFFS_H:0x7A); // MPU6050,MPU9150 Vs MPU6500,MPU9250
-	I2Cdev::writeWord(devAddr, SaveAddress, offset, wireObj);
+	writeWordReg(SaveAddress, offset);
 }
 
 // ZA_OFFS_* register
@@ -3067,7 +3086,7 @@ int16_t MPU6050_Base::getZAccelOffset() {
 }
 void MPU6050_Base::setZAccelOffset(int16_t offset) {
 	uint8_t SaveAddress = ((getDeviceID() < 0x38 )? MPU6050_RA_ZA_OFFS_H:0x7D); // MPU6050,MPU9150 Vs MPU6500,MPU9250
-	I2Cdev::writeWord(devAddr, SaveAddress, offset, wireObj);
+	writeWordReg(SaveAddress, offset);
 }
 
 // XG_OFFS_USR* registers
@@ -3077,7 +3096,7 @@ int16_t MPU6050_Base::getXGyroOffset() {
     return (((int16_t)buffer[0]) << 8) | buffer[1];
 }
 void MPU6050_Base::setXGyroOffset(int16_t offset) {
-    I2Cdev::writeWord(devAddr, MPU6050_RA_XG_OFFS_USRH, offset, wireObj);
+    writeWordReg(MPU6050_RA_XG_OFFS_USRH, offset);
 }
 
 // YG_OFFS_USR* register
@@ -3087,7 +3106,7 @@ int16_t MPU6050_Base::getYGyroOffset() {
     return (((int16_t)buffer[0]) << 8) | buffer[1];
 }
 void MPU6050_Base::setYGyroOffset(int16_t offset) {
-    I2Cdev::writeWord(devAddr, MPU6050_RA_YG_OFFS_USRH, offset, wireObj);
+    writeWordReg(MPU6050_RA_YG_OFFS_USRH, offset);
 }
 
 // ZG_OFFS_USR* register
@@ -3097,75 +3116,64 @@ int16_t MPU6050_Base::getZGyroOffset() {
     return (((int16_t)buffer[0]) << 8) | buffer[1];
 }
 void MPU6050_Base::setZGyroOffset(int16_t offset) {
-    I2Cdev::writeWord(devAddr, MPU6050_RA_ZG_OFFS_USRH, offset, wireObj);
+    writeWordReg(MPU6050_RA_ZG_OFFS_USRH, offset);
 }
 
 // INT_ENABLE register (DMP functions)
 
 bool MPU6050_Base::getIntPLLReadyEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_PLL_RDY_INT_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_PLL_RDY_INT_BIT>>();
 }
 void MPU6050_Base::setIntPLLReadyEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_PLL_RDY_INT_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_PLL_RDY_INT_BIT>>(enabled);
 }
 bool MPU6050_Base::getIntDMPEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_DMP_INT_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_DMP_INT_BIT>>();
 }
 void MPU6050_Base::setIntDMPEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_DMP_INT_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_INT_ENABLE, MPU6050_INTERRUPT_DMP_INT_BIT>>(enabled);
 }
 
 // DMP_INT_STATUS
 
 bool MPU6050_Base::getDMPInt5Status() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_5_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_5_BIT>>();
 }
 bool MPU6050_Base::getDMPInt4Status() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_4_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_4_BIT>>();
 }
 bool MPU6050_Base::getDMPInt3Status() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_3_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_3_BIT>>();
 }
 bool MPU6050_Base::getDMPInt2Status() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_2_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_2_BIT>>();
 }
 bool MPU6050_Base::getDMPInt1Status() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_1_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_1_BIT>>();
 }
 bool MPU6050_Base::getDMPInt0Status() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_0_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_DMP_INT_STATUS, MPU6050_DMPINT_0_BIT>>();
 }
 
 // INT_STATUS register (DMP functions)
 
 bool MPU6050_Base::getIntPLLReadyStatus() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_PLL_RDY_INT_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_PLL_RDY_INT_BIT>>();
 }
 bool MPU6050_Base::getIntDMPStatus() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_DMP_INT_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_INT_STATUS, MPU6050_INTERRUPT_DMP_INT_BIT>>();
 }
 
 // USER_CTRL register (DMP functions)
 
 bool MPU6050_Base::getDMPEnabled() {
-    I2Cdev::readBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_DMP_EN_BIT, buffer, I2Cdev::readTimeout, wireObj);
-    return buffer[0];
+    return readField<MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_DMP_EN_BIT>>();
 }
 void MPU6050_Base::setDMPEnabled(bool enabled) {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_DMP_EN_BIT, enabled, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_DMP_EN_BIT>>(enabled);
 }
 void MPU6050_Base::resetDMP() {
-    I2Cdev::writeBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_DMP_RESET_BIT, true, wireObj);
+    writeField<MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_DMP_RESET_BIT>>(true);
 }
 
 // BANK_SEL register
@@ -3174,13 +3182,13 @@ void MPU6050_Base::setMemoryBank(uint8_t bank, bool prefetchEnabled, bool userBa
     bank &= 0x1F;
     if (userBank) bank |= 0x20;
     if (prefetchEnabled) bank |= 0x40;
-    I2Cdev::writeByte(devAddr, MPU6050_RA_BANK_SEL, bank, wireObj);
+    writeByteReg(MPU6050_RA_BANK_SEL, bank);
 }
 
 // MEM_START_ADDR register
 
 void MPU6050_Base::setMemoryStartAddress(uint8_t address) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_MEM_START_ADDR, address, wireObj);
+    writeByteReg(MPU6050_RA_MEM_START_ADDR, address);
 }
 
 // MEM_R_W register
@@ -3190,7 +3198,7 @@ uint8_t MPU6050_Base::readMemoryByte() {
     return buffer[0];
 }
 void MPU6050_Base::writeMemoryByte(uint8_t data) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_MEM_R_W, data, wireObj);
+    writeByteReg(MPU6050_RA_MEM_R_W, data);
 }
 void MPU6050_Base::readMemoryBlock(uint8_t *data, uint16_t dataSize, uint8_t bank, uint8_t address) {
     setMemoryBank(bank);
@@ -3361,7 +3369,7 @@ bool MPU6050_Base::writeDMPConfigurationSet(const uint8_t *data, uint16_t dataSi
                 //setIntZeroMotionEnabled(true);
                 //setIntFIFOBufferOverflowEnabled(true);
                 //setIntDMPEnabled(true);
-                I2Cdev::writeByte(devAddr, MPU6050_RA_INT_ENABLE, 0x32, wireObj);  // single operation
+                writeByteReg(MPU6050_RA_INT_ENABLE, 0x32);  // single operation
 
                 success = true;
             } else {
@@ -3389,7 +3397,7 @@ uint8_t MPU6050_Base::getDMPConfig1() {
     return buffer[0];
 }
 void MPU6050_Base::setDMPConfig1(uint8_t config) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_DMP_CFG_1, config, wireObj);
+    writeByteReg(MPU6050_RA_DMP_CFG_1, config);
 }
 
 // DMP_CFG_2 register
@@ -3399,7 +3407,7 @@ uint8_t MPU6050_Base::getDMPConfig2() {
     return buffer[0];
 }
 void MPU6050_Base::setDMPConfig2(uint8_t config) {
-    I2Cdev::writeByte(devAddr, MPU6050_RA_DMP_CFG_2, config, wireObj);
+    writeByteReg(MPU6050_RA_DMP_CFG_2, config);
 }
 
 
@@ -3473,7 +3481,7 @@ void MPU6050_Base::PID(uint8_t ReadAddress, float kP,float kI, uint8_t Loops){
 					Data = round((PTerm + ITerm[i] ) / 8);		//Compute PID Output
 					Data = ((Data)&0xFFFE) |BitZero[i];			// Insert Bit0 Saved at beginning
 				} else Data = round((PTerm + ITerm[i] ) / 4);	//Compute PID Output
-				I2Cdev::writeWords(devAddr, SaveAddress + (i * shift), 1, (uint16_t *)&Data, wireObj);
+				writeWordReg(SaveAddress + (i * shift), (uint16_t)Data);
 			}
 			if((c == 99) && eSum > 1000){						// Error is still to great to continue 
 				c = 0;
@@ -3491,7 +3499,7 @@ void MPU6050_Base::PID(uint8_t ReadAddress, float kP,float kI, uint8_t Loops){
 				Data = round((ITerm[i] ) / 8);		//Compute PID Output
 				Data = ((Data)&0xFFFE) |BitZero[i];	// Insert Bit0 Saved at beginning
 			} else Data = round((ITerm[i]) / 4);
-			I2Cdev::writeWords(devAddr, SaveAddress + (i * shift), 1, (uint16_t *)&Data, wireObj);
+			writeWordReg(SaveAddress + (i * shift), (uint16_t)Data);
 		}
 	}
 	resetFIFO();
@@ -3522,3 +3530,215 @@ void MPU6050_Base::PrintActiveOffsets() {
     Serial.print((float)offsets[4], 5); Serial.print(",\t");
     Serial.print((float)offsets[5], 5); Serial.print("\n\n");
 }
+
+// ======== SHADOW REGISTER CACHE ========
+
+/** Enable or disable the shadow register cache.
+ * With the cache on, bitfield setters (setDLPFMode(), setSleepEnabled(), ...)
+ * modify a local copy of the register and write it back in one transaction,
+ * instead of I2Cdev's read-modify-write pair. The first write to a register
+ * still reads it once. Only configuration registers are cached; status,
+ * data, FIFO and DMP memory registers always go to the bus. Off by default.
+ *
+ * Writes that bypass MPU6050_Base (e.g. direct I2Cdev calls in the MotionApps
+ * DMP loaders) are not seen - call invalidateShadowCache() after them.
+ * @param enabled New cache state; enabling starts from an empty cache
+ */
+void MPU6050_Base::setShadowCacheEnabled(bool enabled) {
+    shadowEnabled = enabled;
+    invalidateShadowCache();
+}
+
+/** Get the shadow register cache state.
+ * @return True if bitfield writes use the shadow cache
+ * @see setShadowCacheEnabled()
+ */
+bool MPU6050_Base::getShadowCacheEnabled() {
+    return shadowEnabled;
+}
+
+/** Forget every cached register value; the next write to each reads it again. */
+void MPU6050_Base::invalidateShadowCache() {
+    memset(shadowValid, 0, sizeof(shadowValid));
+}
+
+/** Write a whole configuration in five burst transactions.
+ * PWR_MGMT_1/2 go first (wake and clock source), then SMPLRT_DIV through
+ * ACCEL_CONFIG, FIFO_EN, INT_PIN_CFG/INT_ENABLE, and USER_CTRL last so the
+ * FIFO is only enabled once everything feeding it is configured. Reset bits
+ * in the struct are written as given.
+ * @param config Register values to write
+ * @return True if every transaction succeeded
+ * @see readConfig()
+ */
+bool MPU6050_Base::applyConfig(const MPU6050_Config &config) {
+    uint8_t power[2]  = { config.powerManagement1, config.powerManagement2 };
+    uint8_t timing[4] = { config.sampleRateDiv, config.config, config.gyroConfig, config.accelConfig };
+    uint8_t ints[2]   = { config.intPinConfig, config.intEnable };
+    uint8_t fifoEn    = config.fifoEnable;
+    uint8_t userCtrl  = config.userControl;
+    bool ok = writeBytesReg(MPU6050_RA_PWR_MGMT_1, 2, power);
+    ok = writeBytesReg(MPU6050_RA_SMPLRT_DIV, 4, timing) && ok;
+    ok = writeBytesReg(MPU6050_RA_FIFO_EN, 1, &fifoEn) && ok;
+    ok = writeBytesReg(MPU6050_RA_INT_PIN_CFG, 2, ints) && ok;
+    ok = writeBytesReg(MPU6050_RA_USER_CTRL, 1, &userCtrl) && ok;
+    return ok;
+}
+
+/** Read the registers covered by MPU6050_Config in four burst transactions.
+ * Also fills the shadow cache when it is enabled, so a following
+ * modify-and-applyConfig() needs no further reads.
+ * @param config Struct to fill
+ * @return True if every read succeeded
+ */
+bool MPU6050_Base::readConfig(MPU6050_Config &config) {
+    uint8_t timing[4], ints[2], power[3], fifoEn;
+    bool ok = I2Cdev::readBytes(devAddr, MPU6050_RA_SMPLRT_DIV, 4, timing, I2Cdev::readTimeout, wireObj) == 4;
+    ok = I2Cdev::readBytes(devAddr, MPU6050_RA_FIFO_EN, 1, &fifoEn, I2Cdev::readTimeout, wireObj) == 1 && ok;
+    ok = I2Cdev::readBytes(devAddr, MPU6050_RA_INT_PIN_CFG, 2, ints, I2Cdev::readTimeout, wireObj) == 2 && ok;
+    ok = I2Cdev::readBytes(devAddr, MPU6050_RA_USER_CTRL, 3, power, I2Cdev::readTimeout, wireObj) == 3 && ok;
+    if (!ok) return false;
+    config.sampleRateDiv    = timing[0];
+    config.config           = timing[1];
+    config.gyroConfig       = timing[2];
+    config.accelConfig      = timing[3];
+    config.fifoEnable       = fifoEn;
+    config.intPinConfig     = ints[0];
+    config.intEnable        = ints[1];
+    config.userControl      = power[0];
+    config.powerManagement1 = power[1];
+    config.powerManagement2 = power[2];
+    for (uint8_t i = 0; i < 4; i++) shadowStore(MPU6050_RA_SMPLRT_DIV + i, timing[i]);
+    shadowStore(MPU6050_RA_FIFO_EN, fifoEn);
+    for (uint8_t i = 0; i < 2; i++) shadowStore(MPU6050_RA_INT_PIN_CFG + i, ints[i]);
+    for (uint8_t i = 0; i < 3; i++) shadowStore(MPU6050_RA_USER_CTRL + i, power[i]);
+    return true;
+}
+
+/** Register values for an accelerometer-only seismometer.
+ * The three gyros go to standby (STBY_XG/YG/ZG), which takes ~3.6mA and most
+ * of the die's self-heating off the accel offsets, and the clock moves to the
+ * internal 8MHz oscillator since a PLL on a standby gyro has no reference.
+ * That oscillator is looser than the gyro PLL (+/-3% over temperature per the
+ * datasheet), so time samples by data-ready stamps or a host clock rather
+ * than by counting them when that matters. The temperature sensor stays on.
+ *
+ * SMPLRT_DIV is derived from rateHz (1kHz base, 8kHz with the DLPF off, as
+ * rates that don't divide it evenly round up); MPU6050_DLPF_AUTO picks the
+ * widest DLPF whose bandwidth is at most rateHz / 2, so the output isn't
+ * aliased. FIFO_EN carries accel XYZ only (6 bytes per sample); with fifo the
+ * FIFO is also reset and enabled. No interrupts are enabled. Apply it with
+ * applyConfig(), after changing fields if needed, or setAccelOnlyProfile().
+ * @param rateHz Target sample rate, 4 to 1000 (8000 with the DLPF off)
+ * @param dlpfMode MPU6050_DLPF_BW_*, or MPU6050_DLPF_AUTO
+ * @param accelRange MPU6050_ACCEL_FS_*
+ * @param fifo Enable the FIFO as well
+ * @return The register values
+ * @see setAccelOnlyProfile()
+ */
+MPU6050_Config MPU6050_Base::accelOnlyProfile(uint16_t rateHz, uint8_t dlpfMode, uint8_t accelRange, bool fifo) {
+    static const uint16_t BANDWIDTH_HZ[] = { 260, 188, 98, 42, 20, 10, 5 };  // accel, by DLPF_CFG
+    if (rateHz == 0) rateHz = 1;
+    if (dlpfMode == MPU6050_DLPF_AUTO) {
+        dlpfMode = MPU6050_DLPF_BW_188;
+        while (dlpfMode < MPU6050_DLPF_BW_5 && BANDWIDTH_HZ[dlpfMode] * 2 > rateHz) dlpfMode++;
+    }
+    uint16_t outputRate = (dlpfMode == MPU6050_DLPF_BW_256) ? 8000 : 1000;
+    uint16_t div = outputRate / rateHz;
+
+    using namespace MPU6050_Fields;
+    MPU6050_Config config = {};
+    config.sampleRateDiv    = (uint8_t)(div == 0 ? 0 : div > 256 ? 255 : div - 1);
+    config.config           = DLPF_CFG::place(dlpfMode);
+    config.gyroConfig       = FS_SEL::place(MPU6050_GYRO_FS_250);
+    config.accelConfig      = AFS_SEL::place(accelRange);
+    config.fifoEnable       = ACCEL_FIFO::place(1);
+    config.userControl      = FIFO_EN::place(fifo) | FIFO_RESET::place(fifo);
+    config.powerManagement1 = CLKSEL::place(MPU6050_CLOCK_INTERNAL);
+    config.powerManagement2 = STBY_XG::place(1) | STBY_YG::place(1) | STBY_ZG::place(1);
+    return config;
+}
+
+/** Switch to the accel-only profile in applyConfig()'s burst writes.
+ * @return True if every transaction succeeded
+ * @see accelOnlyProfile()
+ */
+bool MPU6050_Base::setAccelOnlyProfile(uint16_t rateHz, uint8_t dlpfMode, uint8_t accelRange, bool fifo) {
+    return applyConfig(accelOnlyProfile(rateHz, dlpfMode, accelRange, fifo));
+}
+
+/** True for registers whose value only changes when we write them. */
+bool MPU6050_Base::shadowable(uint8_t regAddr) {
+    if (regAddr >= 0x80) return false;
+    if (regAddr == MPU6050_RA_I2C_MST_STATUS) return false;
+    if (regAddr >= MPU6050_RA_INT_STATUS && regAddr <= MPU6050_RA_MOT_DETECT_STATUS) return false;  // status, data, ext sensors
+    if (regAddr == MPU6050_RA_SIGNAL_PATH_RESET) return false;  // self-clearing
+    if (regAddr >= MPU6050_RA_BANK_SEL && regAddr <= MPU6050_RA_MEM_R_W) return false;  // DMP memory window
+    if (regAddr >= MPU6050_RA_FIFO_COUNTH) return false;  // FIFO count/data, WHO_AM_I
+    return true;
+}
+
+/** Record a value just written to (or read from) a register. */
+void MPU6050_Base::shadowStore(uint8_t regAddr, uint8_t data) {
+    if (!shadowEnabled || !shadowable(regAddr)) return;
+    if (regAddr == MPU6050_RA_PWR_MGMT_1 && (data & (1 << MPU6050_PWR1_DEVICE_RESET_BIT))) {
+        invalidateShadowCache();  // every register returns to its reset value
+        return;
+    }
+    if (regAddr == MPU6050_RA_USER_CTRL) data &= 0xF0;  // DMP/FIFO/I2C_MST/SIG_COND resets self-clear
+    shadow[regAddr] = data;
+    shadowValid[regAddr >> 3] |= (1 << (regAddr & 7));
+}
+
+/** Current register value, from the cache if known, otherwise from the bus. */
+bool MPU6050_Base::shadowLoad(uint8_t regAddr, uint8_t *data) {
+    if (shadowValid[regAddr >> 3] & (1 << (regAddr & 7))) {
+        *data = shadow[regAddr];
+        return true;
+    }
+    if (I2Cdev::readByte(devAddr, regAddr, data, I2Cdev::readTimeout, wireObj) != 1) return false;
+    shadowStore(regAddr, *data);
+    return true;
+}
+
+bool MPU6050_Base::writeBitReg(uint8_t regAddr, uint8_t bitNum, uint8_t data) {
+    if (!shadowEnabled || !shadowable(regAddr)) return I2Cdev::writeBit(devAddr, regAddr, bitNum, data, wireObj);
+    uint8_t b;
+    if (!shadowLoad(regAddr, &b)) return false;
+    b = (data != 0) ? (b | (1 << bitNum)) : (b & ~(1 << bitNum));
+    return writeByteReg(regAddr, b);
+}
+
+bool MPU6050_Base::writeBitsReg(uint8_t regAddr, uint8_t bitStart, uint8_t length, uint8_t data) {
+    if (!shadowEnabled || !shadowable(regAddr)) return I2Cdev::writeBits(devAddr, regAddr, bitStart, length, data, wireObj);
+    uint8_t b;
+    if (!shadowLoad(regAddr, &b)) return false;
+    uint8_t mask = ((1 << length) - 1) << (bitStart - length + 1);
+    data <<= (bitStart - length + 1);  // shift data into correct position
+    data &= mask;                      // zero all non-important bits in data
+    b &= ~(mask);                      // zero all important bits in existing byte
+    b |= data;                         // combine data with existing byte
+    return writeByteReg(regAddr, b);
+}
+
+bool MPU6050_Base::writeByteReg(uint8_t regAddr, uint8_t data) {
+    bool ok = I2Cdev::writeByte(devAddr, regAddr, data, wireObj);
+    if (ok) shadowStore(regAddr, data);
+    else shadowValid[regAddr >> 3] &= ~(1 << (regAddr & 7));
+    return ok;
+}
+
+bool MPU6050_Base::writeWordReg(uint8_t regAddr, uint16_t data) {
+    uint8_t bytes[2] = { (uint8_t)(data >> 8), (uint8_t)data };
+    return writeBytesReg(regAddr, 2, bytes);
+}
+
+bool MPU6050_Base::writeBytesReg(uint8_t regAddr, uint8_t length, uint8_t *data) {
+    bool ok = I2Cdev::writeBytes(devAddr, regAddr, length, data, wireObj);
+    for (uint8_t i = 0; i < length; i++) {
+        uint8_t r = regAddr + i;
+        if (ok) shadowStore(r, data[i]);
+        else if (r < 0x80) shadowValid[r >> 3] &= ~(1 << (r & 7));
+    }
+    return ok;
+}
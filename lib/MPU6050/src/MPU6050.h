@@ -437,6 +437,59 @@ THE SOFTWARE.
 
 #define MPU6050_FIFO_DEFAULT_TIMEOUT 11000
 
+// readAccelBatch(): samples per FIFO read, through a stack buffer of 6x this
+#ifndef MPU6050_BATCH_CHUNK
+#define MPU6050_BATCH_CHUNK         20
+#endif
+
+// accelOnlyProfile(): pick the widest DLPF below half the sample rate
+#define MPU6050_DLPF_AUTO           0xFF
+
+// A register field known at compile time: its register, lowest bit and
+// width, so the mask and shift are constants wherever it is used (the named
+// setters and getters through MPU6050_Base::writeField() / readField(), and
+// register values built with place()). A width-1 field takes any nonzero
+// value as 1, as I2Cdev::writeBit() does.
+template <uint8_t Reg, uint8_t Offset, uint8_t Width>
+struct MPU6050_Field {
+    static_assert(Width > 0 && Offset + Width <= 8, "a field lies within one register");
+    static constexpr uint8_t reg = Reg;
+    static constexpr uint8_t offset = Offset;
+    static constexpr uint8_t width = Width;
+    static constexpr uint8_t mask = (uint8_t)(((1u << Width) - 1) << Offset);
+
+    // value in its place in the register, the other bits 0
+    static constexpr uint8_t place(uint8_t value) {
+        return Width == 1 ? (value ? mask : 0) : (uint8_t)((value << Offset) & mask);
+    }
+    // The field out of a register value
+    static constexpr uint8_t extract(uint8_t regValue) {
+        return (uint8_t)((regValue & mask) >> Offset);
+    }
+    // regValue with the field replaced by value
+    static constexpr uint8_t merge(uint8_t regValue, uint8_t value) {
+        return (uint8_t)((regValue & ~mask) | place(value));
+    }
+};
+
+// The same in I2Cdev's terms: (register, bitStart, length), bitStart the MSB
+template <uint8_t Reg, uint8_t BitStart, uint8_t Length = 1>
+using MPU6050_FieldAt = MPU6050_Field<Reg, BitStart - Length + 1, Length>;
+
+// The fields MPU6050_Config is built from
+namespace MPU6050_Fields {
+    using DLPF_CFG   = MPU6050_FieldAt<MPU6050_RA_CONFIG, MPU6050_CFG_DLPF_CFG_BIT, MPU6050_CFG_DLPF_CFG_LENGTH>;
+    using FS_SEL     = MPU6050_FieldAt<MPU6050_RA_GYRO_CONFIG, MPU6050_GCONFIG_FS_SEL_BIT, MPU6050_GCONFIG_FS_SEL_LENGTH>;
+    using AFS_SEL    = MPU6050_FieldAt<MPU6050_RA_ACCEL_CONFIG, MPU6050_ACONFIG_AFS_SEL_BIT, MPU6050_ACONFIG_AFS_SEL_LENGTH>;
+    using ACCEL_FIFO = MPU6050_FieldAt<MPU6050_RA_FIFO_EN, MPU6050_ACCEL_FIFO_EN_BIT>;
+    using FIFO_EN    = MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_EN_BIT>;
+    using FIFO_RESET = MPU6050_FieldAt<MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_RESET_BIT>;
+    using CLKSEL     = MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_CLKSEL_BIT, MPU6050_PWR1_CLKSEL_LENGTH>;
+    using STBY_XG    = MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_XG_BIT>;
+    using STBY_YG    = MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_YG_BIT>;
+    using STBY_ZG    = MPU6050_FieldAt<MPU6050_RA_PWR_MGMT_2, MPU6050_PWR2_STBY_ZG_BIT>;
+}
+
 enum class ACCEL_FS {
     A2G,
     A4G,
@@ -451,6 +504,33 @@ enum class GYRO_FS {
     G2000DPS
 };
 
+// Register values pushed by MPU6050_Base::applyConfig() in burst writes
+struct MPU6050_Config {
+    uint8_t sampleRateDiv;     // SMPLRT_DIV   (0x19)
+    uint8_t config;            // CONFIG       (0x1A): EXT_SYNC_SET, DLPF_CFG
+    uint8_t gyroConfig;        // GYRO_CONFIG  (0x1B)
+    uint8_t accelConfig;       // ACCEL_CONFIG (0x1C)
+    uint8_t fifoEnable;        // FIFO_EN      (0x23)
+    uint8_t intPinConfig;      // INT_PIN_CFG  (0x37)
+    uint8_t intEnable;         // INT_ENABLE   (0x38)
+    uint8_t userControl;       // USER_CTRL    (0x6A)
+    uint8_t powerManagement1;  // PWR_MGMT_1   (0x6B)
+    uint8_t powerManagement2;  // PWR_MGMT_2   (0x6C)
+};
+
+// ACCEL_XOUT_H..TEMP_OUT_L as read by MPU6050_Base::getAccelTemp(), raw LSB
+struct MPU6050_AccelTemp {
+    int16_t x, y, z;   // ACCEL_XOUT, ACCEL_YOUT, ACCEL_ZOUT
+    int16_t temp;      // TEMP_OUT
+};
+
+// What MPU6050_Base::readAccelBatch() got out of the FIFO
+struct MPU6050_Batch {
+    uint16_t count;    // samples written to x, y, z
+    bool overflow;     // the FIFO had overflowed, nothing was read: reset it
+    bool error;        // a read came up short, the FIFO may be misaligned: reset it
+};
+
 class MPU6050_Base {
     public:
         MPU6050_Base(uint8_t address=MPU6050_DEFAULT_ADDRESS, void *wireObj=0);
@@ -651,6 +731,7 @@ class MPU6050_Base {
 
         // TEMP_OUT_* registers
         int16_t getTemperature();
+        bool getAccelTemp(MPU6050_AccelTemp* data);
 
         // GYRO_*OUT_* registers
         void getRotation(int16_t* x, int16_t* y, int16_t* z);
@@ -740,6 +821,10 @@ class MPU6050_Base {
 		int8_t GetCurrentFIFOPacket(uint8_t *data, uint8_t length);
         void setFIFOByte(uint8_t data);
         void getFIFOBytes(uint8_t *data, uint8_t length);
+        int16_t getFIFOBlock(uint8_t *data, uint16_t length);
+        bool beginFIFOBlock(I2CdevRequest *req, uint8_t *data, uint16_t length);
+        MPU6050_Batch readAccelBatch(int16_t *x, int16_t *y, int16_t *z, uint16_t maxN);
+        static void unpackAccelFIFO(const uint8_t *fifo, uint16_t n, int16_t *x, int16_t *y, int16_t *z);
         void setFIFOTimeout(uint32_t fifoTimeout);
         uint32_t getFIFOTimeout();
 
@@ -853,10 +938,36 @@ class MPU6050_Base {
 		void PrintActiveOffsets(); // See the results of the Calibration
 		int16_t * GetActiveOffsets();
 
+        // Shadow register cache (one-transaction bitfield writes) and batched config
+        void setShadowCacheEnabled(bool enabled);
+        bool getShadowCacheEnabled();
+        void invalidateShadowCache();
+        bool applyConfig(const MPU6050_Config &config);
+        bool readConfig(MPU6050_Config &config);
+
+        // One field, its mask and shift fixed at compile time; writes go
+        // through the shadow cache when it is enabled
+        template <typename Field> bool writeField(uint8_t value);
+        template <typename Field> uint8_t readField();
+
+        // Accel-only seismometer profile: gyros in standby, internal clock
+        static MPU6050_Config accelOnlyProfile(uint16_t rateHz, uint8_t dlpfMode = MPU6050_DLPF_AUTO,
+                                               uint8_t accelRange = MPU6050_ACCEL_FS_2, bool fifo = true);
+        bool setAccelOnlyProfile(uint16_t rateHz, uint8_t dlpfMode = MPU6050_DLPF_AUTO,
+                                 uint8_t accelRange = MPU6050_ACCEL_FS_2, bool fifo = true);
+
     protected:
         uint8_t devAddr;
         void *wireObj;
         uint8_t buffer[14];
+
+        // Register writes for the setters whose register or bit is only known
+        // at run time, and whole registers; go through the shadow cache when enabled
+        bool writeBitReg(uint8_t regAddr, uint8_t bitNum, uint8_t data);
+        bool writeBitsReg(uint8_t regAddr, uint8_t bitStart, uint8_t length, uint8_t data);
+        bool writeByteReg(uint8_t regAddr, uint8_t data);
+        bool writeWordReg(uint8_t regAddr, uint16_t data);
+        bool writeBytesReg(uint8_t regAddr, uint8_t length, uint8_t *data);
         uint32_t fifoTimeout = MPU6050_FIFO_DEFAULT_TIMEOUT;
 
         float accelerationResolution;
@@ -864,8 +975,42 @@ class MPU6050_Base {
     
     private:
         int16_t offsets[6];
+
+        static bool shadowable(uint8_t regAddr);
+        void shadowStore(uint8_t regAddr, uint8_t data);
+        bool shadowLoad(uint8_t regAddr, uint8_t *data);
+
+        bool shadowEnabled = false;
+        uint8_t shadow[128];
+        uint8_t shadowValid[16] = {};  // one bit per register
 };
 
+/** Write one field, keeping the rest of its register.
+ * A read-modify-write, or with the shadow cache on a write of the cached
+ * byte; unlike I2Cdev::writeBits() the mask and shift are constants.
+ * @param value New field value (any nonzero value sets a width-1 field)
+ * @return True if the transactions succeeded
+ */
+template <typename Field>
+bool MPU6050_Base::writeField(uint8_t value) {
+    uint8_t b;
+    if (shadowEnabled && shadowable(Field::reg)) {
+        if (!shadowLoad(Field::reg, &b)) return false;
+    } else if (I2Cdev::readByte(devAddr, Field::reg, &b, I2Cdev::readTimeout, wireObj) != 1) {
+        return false;
+    }
+    return writeByteReg(Field::reg, Field::merge(b, value));
+}
+
+/** Read one field off the bus.
+ * @return The field value (what buffer[0] held, masked, if the read failed)
+ */
+template <typename Field>
+uint8_t MPU6050_Base::readField() {
+    I2Cdev::readByte(devAddr, Field::reg, buffer, I2Cdev::readTimeout, wireObj);
+    return Field::extract(buffer[0]);
+}
+
 #ifndef I2CDEVLIB_MPU6050_TYPEDEF
 #define I2CDEVLIB_MPU6050_TYPEDEF
 typedef MPU6050_Base MPU6050;
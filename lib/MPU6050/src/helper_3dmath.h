@@ -213,4 +213,210 @@ class VectorFloat {
         }
 };
 
+// ----------------------------------------------------------------------------
+// Fixed-point versions for targets without an FPU (the ESP8266 does software
+// floats, where one sqrt plus a divide costs more than the whole projection).
+// QuaternionQ30 holds the DMP's own format, 1.0 = 1 << 30; VectorQ15 is
+// 1.0 = 1 << 15, kept in int32 so +1.0 is exact and raw accel LSB fit as
+// well. Products go through int64, and normalization uses an integer
+// Newton inverse sqrt instead of sqrt() and a divide.
+// ----------------------------------------------------------------------------
+
+// 1/sqrt(m) in Q30 for m in Q30 from 0.25 to 4 (outside that, normalize()
+// scales by powers of 4 first); saturated below, 0 for m == 0
+static inline int32_t invSqrtQ30(uint64_t m) {
+    if (m == 0) return 0;
+    if (m < (1ULL << 28)) return INT32_MAX;
+    if (m > (1ULL << 32)) m = 1ULL << 32;
+    // Start at 2^(-e/2) for m = 2^e, within sqrt(2) of the answer
+    int bits = 63;
+    while (!(m >> bits)) bits--;
+    int e = bits - 30;
+    int64_t y = e >= 0 ? (1LL << 30) >> ((e + 1) / 2) : (1LL << 30) << ((-e) / 2);
+    // y <- y * (3 - m * y^2) / 2; quadratic, so five steps reach Q30
+    for (int i = 0; i < 5; i++) {
+        int64_t y2 = (y * y) >> 30;
+        int64_t my2 = (int64_t)((m * (uint64_t)y2) >> 30);
+        y = (y * ((3LL << 30) - my2)) >> 31;
+    }
+    return y > INT32_MAX ? INT32_MAX : (int32_t)y;
+}
+
+class QuaternionQ30;
+
+class VectorQ15 {
+    public:
+        int32_t x;
+        int32_t y;
+        int32_t z;
+
+        VectorQ15() {
+            x = 0;
+            y = 0;
+            z = 0;
+        }
+
+        VectorQ15(int32_t nx, int32_t ny, int32_t nz) {
+            x = nx;
+            y = ny;
+            z = nz;
+        }
+
+        explicit VectorQ15(const VectorFloat& v) {
+            x = (int32_t)(v.x * 32768.0f);
+            y = (int32_t)(v.y * 32768.0f);
+            z = (int32_t)(v.z * 32768.0f);
+        }
+
+        VectorFloat toFloat() const {
+            return VectorFloat(x / 32768.0f, y / 32768.0f, z / 32768.0f);
+        }
+
+        // |v|^2 in Q30
+        uint64_t getMagnitudeSquared() const {
+            return (uint64_t)((int64_t)x * x + (int64_t)y * y + (int64_t)z * z);
+        }
+
+        void normalize() {
+            // For inputs far from unit length, move the scale into the Q30 square first
+            uint64_t m = getMagnitudeSquared();
+            if (m == 0) return;
+            int shift = 0;
+            while (m > (1ULL << 32)) { m >>= 2; shift++; }
+            while (m < (1ULL << 28)) { m <<= 2; shift--; }
+            int64_t im = invSqrtQ30(m);
+            x = scale(x, im, shift);
+            y = scale(y, im, shift);
+            z = scale(z, im, shift);
+        }
+
+        VectorQ15 getNormalized() const {
+            VectorQ15 r(x, y, z);
+            r.normalize();
+            return r;
+        }
+
+        // Dot product in Q15
+        int32_t dot(const VectorQ15& v) const {
+            return (int32_t)(((int64_t)x * v.x + (int64_t)y * v.y + (int64_t)z * v.z) >> 15);
+        }
+
+        void rotate(const QuaternionQ30& q);
+        VectorQ15 getRotated(const QuaternionQ30& q) const;
+
+    private:
+        static int32_t scale(int32_t v, int64_t im, int shift) {
+            int64_t r = ((int64_t)v * im) >> 30;
+            return (int32_t)(shift >= 0 ? r >> shift : r << -shift);
+        }
+};
+
+class QuaternionQ30 {
+    public:
+        int32_t w;
+        int32_t x;
+        int32_t y;
+        int32_t z;
+
+        QuaternionQ30() {
+            w = 1L << 30;
+            x = 0;
+            y = 0;
+            z = 0;
+        }
+
+        QuaternionQ30(int32_t nw, int32_t nx, int32_t ny, int32_t nz) {
+            w = nw;
+            x = nx;
+            y = ny;
+            z = nz;
+        }
+
+        // As dmpGetQuaternion(int32_t*) fills it: w, x, y, z
+        explicit QuaternionQ30(const int32_t* q) {
+            w = q[0];
+            x = q[1];
+            y = q[2];
+            z = q[3];
+        }
+
+        explicit QuaternionQ30(const Quaternion& q) {
+            w = (int32_t)(q.w * 1073741824.0f);
+            x = (int32_t)(q.x * 1073741824.0f);
+            y = (int32_t)(q.y * 1073741824.0f);
+            z = (int32_t)(q.z * 1073741824.0f);
+        }
+
+        Quaternion toFloat() const {
+            return Quaternion(w / 1073741824.0f, x / 1073741824.0f, y / 1073741824.0f, z / 1073741824.0f);
+        }
+
+        QuaternionQ30 getProduct(const QuaternionQ30& q) const {
+            // As Quaternion::getProduct(), each term a Q60 product
+            return QuaternionQ30(
+                mul4(w, q.w, -(int64_t)x, q.x, -(int64_t)y, q.y, -(int64_t)z, q.z),
+                mul4(w, q.x, x, q.w, y, q.z, -(int64_t)z, q.y),
+                mul4(w, q.y, -(int64_t)x, q.z, y, q.w, z, q.x),
+                mul4(w, q.z, x, q.y, -(int64_t)y, q.x, z, q.w));
+        }
+
+        QuaternionQ30 getConjugate() const {
+            return QuaternionQ30(w, -x, -y, -z);
+        }
+
+        // |q|^2 in Q30
+        uint64_t getMagnitudeSquared() const {
+            return (uint64_t)((((int64_t)w * w) >> 30) + (((int64_t)x * x) >> 30) +
+                              (((int64_t)y * y) >> 30) + (((int64_t)z * z) >> 30));
+        }
+
+        void normalize() {
+            int64_t im = invSqrtQ30(getMagnitudeSquared());
+            w = (int32_t)(((int64_t)w * im) >> 30);
+            x = (int32_t)(((int64_t)x * im) >> 30);
+            y = (int32_t)(((int64_t)y * im) >> 30);
+            z = (int32_t)(((int64_t)z * im) >> 30);
+        }
+
+        QuaternionQ30 getNormalized() const {
+            QuaternionQ30 r(w, x, y, z);
+            r.normalize();
+            return r;
+        }
+
+        // The world's +Z in sensor axes (what dmpGetGravity() gives), for a unit q
+        VectorQ15 getGravity() const {
+            return VectorQ15(
+                (int32_t)((2 * ((int64_t)x * z - (int64_t)w * y)) >> 45),
+                (int32_t)((2 * ((int64_t)w * x + (int64_t)y * z)) >> 45),
+                (int32_t)(((int64_t)w * w - (int64_t)x * x - (int64_t)y * y + (int64_t)z * z) >> 45));
+        }
+
+    private:
+        static int32_t mul4(int64_t a0, int64_t b0, int64_t a1, int64_t b1,
+                            int64_t a2, int64_t b2, int64_t a3, int64_t b3) {
+            return (int32_t)((a0 * b0 + a1 * b1 + a2 * b2 + a3 * b3) >> 30);
+        }
+};
+
+// v' = v + w t + q x t with t = 2 (q x v): the rotation without building
+// the two quaternion products VectorFloat::rotate() does
+inline void VectorQ15::rotate(const QuaternionQ30& q) {
+    int64_t tx = (2 * ((int64_t)q.y * z - (int64_t)q.z * y)) >> 30;
+    int64_t ty = (2 * ((int64_t)q.z * x - (int64_t)q.x * z)) >> 30;
+    int64_t tz = (2 * ((int64_t)q.x * y - (int64_t)q.y * x)) >> 30;
+    int32_t nx = (int32_t)(x + ((q.w * tx + (int64_t)q.y * tz - (int64_t)q.z * ty) >> 30));
+    int32_t ny = (int32_t)(y + ((q.w * ty + (int64_t)q.z * tx - (int64_t)q.x * tz) >> 30));
+    int32_t nz = (int32_t)(z + ((q.w * tz + (int64_t)q.x * ty - (int64_t)q.y * tx) >> 30));
+    x = nx;
+    y = ny;
+    z = nz;
+}
+
+inline VectorQ15 VectorQ15::getRotated(const QuaternionQ30& q) const {
+    VectorQ15 r(x, y, z);
+    r.rotate(q);
+    return r;
+}
+
 #endif /* _HELPER_3DMATH_H_ */
\ No newline at end of file
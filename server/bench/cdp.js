@@ -0,0 +1,173 @@
+// ── Headless Chrome over the DevTools pipe ───────────────────────
+// Just enough of the Chrome DevTools Protocol for bench/render.js, without a
+// browser-automation dependency: Chrome started with --remote-debugging-pipe
+// reads commands on its fd 3 and writes replies and events on fd 4, each a
+// JSON message ending in a NUL byte. One page target, attached flat, so its
+// commands carry the sessionId.
+//
+//   const browser = await Browser.launch({ executable, width, height });
+//   const page = await browser.newPage();
+//   await page.send('Page.navigate', { url });
+//   const v = await page.evaluate('document.title');
+//   await page.close();
+//   browser.close();
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { spawn, execFileSync } = require('child_process');
+
+const COMMAND_TIMEOUT_MS = 120000;
+
+// Chrome from CHROME_PATH, the PATH, or a puppeteer/playwright download
+function findChrome() {
+  if (process.env.CHROME_PATH) return process.env.CHROME_PATH;
+  for (const name of ['google-chrome', 'google-chrome-stable', 'chromium', 'chromium-browser', 'chrome']) {
+    try {
+      return execFileSync('which', [name], { stdio: ['ignore', 'pipe', 'ignore'] }).toString().trim();
+    } catch {
+      // not on the PATH
+    }
+  }
+  for (const cache of ['.cache/puppeteer/chrome', '.cache/puppeteer/chrome-headless-shell', '.cache/ms-playwright']) {
+    const root = path.join(os.homedir(), cache);
+    if (!fs.existsSync(root)) continue;
+    for (const dir of fs.readdirSync(root).sort().reverse()) {
+      for (const bin of ['chrome-linux64/chrome', 'chrome-linux/chrome', 'chrome-headless-shell-linux64/chrome-headless-shell']) {
+        const p = path.join(root, dir, bin);
+        if (fs.existsSync(p)) return p;
+      }
+    }
+  }
+  throw new Error('no Chrome found; set CHROME_PATH');
+}
+
+class Page {
+  constructor(browser, targetId, sessionId) {
+    this.browser = browser;
+    this.targetId = targetId;
+    this.sessionId = sessionId;
+  }
+
+  send(method, params = {}) {
+    return this.browser.send(method, params, this.sessionId);
+  }
+
+  // Resolves with the first event named method (whose params pass filter)
+  once(method, filter = () => true) {
+    return new Promise((resolve) => {
+      const fn = (msg) => {
+        if (msg.sessionId !== this.sessionId || msg.method !== method || !filter(msg.params)) return;
+        this.browser.listeners.delete(fn);
+        resolve(msg.params);
+      };
+      this.browser.listeners.add(fn);
+    });
+  }
+
+  // An expression (awaited if it is a promise) -> its value
+  async evaluate(expression) {
+    const r = await this.send('Runtime.evaluate', { expression, awaitPromise: true, returnByValue: true });
+    if (r.exceptionDetails) {
+      throw new Error(`${expression.slice(0, 60)}: ${r.exceptionDetails.exception?.description || r.exceptionDetails.text}`);
+    }
+    return r.result.value;
+  }
+
+  // Performance.getMetrics as { name: value }
+  async metrics() {
+    const { metrics } = await this.send('Performance.getMetrics');
+    return Object.fromEntries(metrics.map(m => [m.name, m.value]));
+  }
+
+  close() {
+    return this.browser.send('Target.closeTarget', { targetId: this.targetId });
+  }
+}
+
+class Browser {
+  static async launch({ executable = findChrome(), width = 1600, height = 900, args = [] } = {}) {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'seismo-chrome-'));
+    const child = spawn(executable, [
+      '--headless=new', '--remote-debugging-pipe', '--no-first-run', '--no-default-browser-check',
+      '--disable-background-timer-throttling', '--disable-renderer-backgrounding', '--disable-extensions',
+      '--enable-precise-memory-info', `--window-size=${width},${height}`, `--user-data-dir=${dir}`,
+      ...(process.getuid?.() === 0 ? ['--no-sandbox'] : []), ...args, 'about:blank',
+    ], { stdio: ['ignore', 'ignore', 'pipe', 'pipe', 'pipe'] });
+    const browser = new Browser(child, dir);
+    await browser.send('Browser.getVersion');
+    return browser;
+  }
+
+  constructor(child, dir) {
+    this.child = child;
+    this.dir = dir;
+    this.nextId = 1;
+    this.pending = new Map();     // id -> { resolve, reject, timer }
+    this.listeners = new Set();
+    this.stderr = '';
+    let buffered = Buffer.alloc(0);
+    child.stdio[4].on('data', (chunk) => {
+      buffered = Buffer.concat([buffered, chunk]);
+      for (let end = buffered.indexOf(0); end >= 0; end = buffered.indexOf(0)) {
+        const msg = JSON.parse(buffered.subarray(0, end).toString());
+        buffered = buffered.subarray(end + 1);
+        this.dispatch(msg);
+      }
+    });
+    child.stderr.on('data', (d) => { this.stderr = (this.stderr + d).slice(-4000); });
+    // A Chrome that dies at startup resets the pipes; the exit below reports it
+    child.stdio[3].on('error', () => {});
+    child.stdio[4].on('error', () => {});
+    child.on('error', (e) => { this.stderr += `\n${e.message}`; });
+    child.on('exit', (code) => {
+      for (const p of this.pending.values()) {
+        clearTimeout(p.timer);
+        p.reject(new Error(`Chrome exited (${code}): ${this.stderr.trim().split('\n').pop() || ''}`));
+      }
+      this.pending.clear();
+    });
+  }
+
+  dispatch(msg) {
+    const p = msg.id != null && this.pending.get(msg.id);
+    if (p) {
+      this.pending.delete(msg.id);
+      clearTimeout(p.timer);
+      if (msg.error) p.reject(new Error(`${p.method}: ${msg.error.message}`));
+      else p.resolve(msg.result);
+      return;
+    }
+    for (const fn of [...this.listeners]) fn(msg);
+  }
+
+  send(method, params = {}, sessionId) {
+    const id = this.nextId++;
+    return new Promise((resolve, reject) => {
+      if (this.child.exitCode != null || this.child.signalCode) {
+        return reject(new Error(`${method}: Chrome has exited: ${this.stderr.trim().split('\n').pop() || ''}`));
+      }
+      const timer = setTimeout(() => {
+        this.pending.delete(id);
+        reject(new Error(`${method}: no reply in ${COMMAND_TIMEOUT_MS / 1000}s`));
+      }, COMMAND_TIMEOUT_MS);
+      this.pending.set(id, { resolve, reject, timer, method });
+      this.child.stdio[3].write(JSON.stringify({ id, method, params, ...(sessionId ? { sessionId } : {}) }) + '\0');
+    });
+  }
+
+  async newPage() {
+    const { targetId } = await this.send('Target.createTarget', { url: 'about:blank' });
+    const { sessionId } = await this.send('Target.attachToTarget', { targetId, flatten: true });
+    const page = new Page(this, targetId, sessionId);
+    await Promise.all(['Page.enable', 'Runtime.enable', 'Performance.enable'].map(m => page.send(m)));
+    return page;
+  }
+
+  close() {
+    this.child.kill();
+    fs.rmSync(this.dir, { recursive: true, force: true });
+  }
+}
+
+module.exports = { Browser, findChrome };
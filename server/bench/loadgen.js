@@ -0,0 +1,473 @@
+#!/usr/bin/env node
+// ── Ingest load generator ────────────────────────────────────────
+// Simulates a fleet of devices against server.js the way the firmware
+// talks to it: /api/init once, a heartbeat (GET /?id=) every --heartbeat
+// seconds, and waveform uploads (POST /api/seismic, SWV1 binary or JSON).
+// Each device is one keep-alive connection doing one request at a time,
+// like the ESP8266. On top of sparse background triggers (--noise per
+// device per minute) it plays --quakes earthquakes: every device uploads
+// a capture of the same wavelet, delayed by its distance from the
+// epicentre over --velocity, with the trigger time in X-Event-Time-Us.
+//
+// At the end it prints latency percentiles per endpoint, request and
+// event throughput, and checks the CONFIRMED entries of its group in
+// /api/consensus against the quakes it played: found, missed, and
+// confirmations no quake explains (noise that lined up, or a bug).
+// --readers dashboards poll /api/status every second and the run's
+// /api/events every 5 s alongside. The server's CPU time over the run
+// (from /api/info) is reported per request, the number to compare when
+// changing a hot route.
+//
+// The fleet is registered in the device registry (group 'bench'), so run
+// it against a disposable database only:
+//   node bench/loadgen.js --spawn                 docker run mongo + server.js child
+//   node bench/loadgen.js --spawn --mongo URI     server.js child on an existing (empty) Mongo
+//   node bench/loadgen.js --url http://host:3000 --allow-remote
+// --json prints the report as one JSON object (for CI trend lines).
+
+const http = require('http');
+const path = require('path');
+const os = require('os');
+const fs = require('fs');
+const { spawn, execFileSync } = require('child_process');
+
+const GROUP = 'bench';
+const ORIGIN = { lat: 40.0, lon: -75.0 };   // fleet grid is laid out east/north of here
+const SAMPLE_RATE_HZ = 100;
+const SENSOR_SCALE = 16384;                 // LSB/g, MPU6050 at ±2 g
+
+const DEFAULTS = {
+  url: null, spawn: false, mongo: null, 'allow-remote': false, json: false,
+  devices: 20, duration: 60, heartbeat: 10, noise: 0.5, quakes: 3,
+  velocity: 3000, spacing: 200, samples: 500, format: 'binary', quorum: 0,
+  settle: 5, port: 0, image: 'mongo:7', readers: 0,
+};
+
+function parseArgs(argv) {
+  const opts = { ...DEFAULTS };
+  for (let i = 0; i < argv.length; i++) {
+    const key = argv[i].replace(/^--/, '');
+    if (!(key in DEFAULTS)) throw new Error(`unknown option --${key}`);
+    if (typeof DEFAULTS[key] === 'boolean') opts[key] = true;
+    else opts[key] = typeof DEFAULTS[key] === 'number' ? Number(argv[++i]) : argv[++i];
+  }
+  if (!opts.spawn && !opts.url) throw new Error('give --spawn or --url');
+  if (opts.url && !opts.spawn && !opts['allow-remote']) {
+    throw new Error('--url registers a bench fleet in that server\'s database; add --allow-remote if it is disposable');
+  }
+  if (!['binary', 'json'].includes(opts.format)) throw new Error('--format is binary or json');
+  return opts;
+}
+
+// ── HTTP ─────────────────────────────────────────────────────────
+class Stats {
+  constructor() {
+    this.byRoute = new Map();     // route → { ms: [], errors, bytes }
+  }
+
+  record(route, ms, ok, bytes = 0) {
+    if (!this.byRoute.has(route)) this.byRoute.set(route, { ms: [], errors: 0, bytes: 0 });
+    const r = this.byRoute.get(route);
+    r.ms.push(ms);
+    r.bytes += bytes;
+    if (!ok) r.errors++;
+  }
+
+  // -> { route: { count, errors, p50_ms, p90_ms, p99_ms, max_ms, kib } }
+  summary() {
+    const pct = (sorted, p) => sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+    const round = (v) => Math.round(v * 10) / 10;
+    return Object.fromEntries([...this.byRoute].map(([route, r]) => {
+      const s = [...r.ms].sort((a, b) => a - b);
+      return [route, {
+        count: s.length, errors: r.errors,
+        p50_ms: round(pct(s, 0.5)), p90_ms: round(pct(s, 0.9)), p99_ms: round(pct(s, 0.99)),
+        max_ms: round(s[s.length - 1]), kib: Math.round(r.bytes / 1024),
+      }];
+    }));
+  }
+}
+
+function request(base, agent, method, pathname, { body, headers = {} } = {}) {
+  return new Promise((resolve) => {
+    const url = new URL(pathname, base);
+    const started = process.hrtime.bigint();
+    const req = http.request(url, { method, agent, headers: {
+      ...headers,
+      ...(body ? { 'content-length': body.length } : {}),
+    } }, (res) => {
+      const chunks = [];
+      res.on('data', c => chunks.push(c));
+      res.on('end', () => resolve({
+        status: res.statusCode,
+        ms: Number(process.hrtime.bigint() - started) / 1e6,
+        body: Buffer.concat(chunks).toString(),
+      }));
+    });
+    req.on('error', (e) => resolve({ status: 0, ms: Number(process.hrtime.bigint() - started) / 1e6, error: e.message }));
+    if (body) req.write(body);
+    req.end();
+  });
+}
+
+// ── Waveforms ────────────────────────────────────────────────────
+// Quake: a 3 Hz wavelet under a Gaussian envelope, the same shape at every
+// device so the coherence gate (consensus_coherence) passes it. Noise: just
+// sensor noise and one spike, different every time.
+function synthesize(count, kind, rng) {
+  const wave = [];
+  const peakAt = count * 0.3;
+  for (let i = 0; i < count; i++) {
+    const t = i / SAMPLE_RATE_HZ;
+    const n = () => (rng() - 0.5) * 0.004;
+    let x = n(), y = n(), z = n();
+    if (kind === 'quake') {
+      const env = Math.exp(-(((i - peakAt) / (SAMPLE_RATE_HZ * 0.8)) ** 2));
+      x += 0.08 * env * Math.sin(2 * Math.PI * 3 * t);
+      y += 0.05 * env * Math.cos(2 * Math.PI * 3 * t);
+      z += 0.03 * env * Math.sin(2 * Math.PI * 5 * t);
+    } else if (i === Math.round(peakAt)) {
+      x += 0.03;
+    }
+    wave.push([Math.round(i * 1000 / SAMPLE_RATE_HZ), x, y, 1 + z]);
+  }
+  return wave;
+}
+
+// SWV1 body (src/waveform_stream.h): 44-byte header, then int16 triplets
+function encodeBinary(mac, deltaG, wave) {
+  const buf = Buffer.alloc(44 + wave.length * 6);
+  buf.write('SWV1', 0, 'latin1');
+  mac.split(':').forEach((h, i) => buf.writeUInt8(parseInt(h, 16), 4 + i));
+  buf.writeUInt8(deltaG > 0.05 ? 1 : 0, 10);   // level: minor / moderate
+  buf.writeUInt8(0, 11);                       // trigger: threshold
+  buf.writeFloatLE(deltaG, 12);
+  buf.writeFloatLE(0, 16); buf.writeFloatLE(0, 20); buf.writeFloatLE(0, 24);
+  buf.writeFloatLE(SENSOR_SCALE, 28);
+  buf.writeUInt16LE(SAMPLE_RATE_HZ, 32);
+  buf.writeUInt16LE(wave.length, 34);
+  buf.writeInt32LE(wave[0][0], 36);
+  buf.writeUInt32LE(0, 40);
+  wave.forEach((s, i) => {
+    for (let a = 0; a < 3; a++) {
+      buf.writeInt16LE(Math.max(-32768, Math.min(32767, Math.round(s[a + 1] * SENSOR_SCALE))), 44 + i * 6 + a * 2);
+    }
+  });
+  return buf;
+}
+
+function peakDelta(wave) {
+  return wave.reduce((m, s) => Math.max(m, Math.hypot(s[1], s[2], s[3] - 1)), 0);
+}
+
+// ── Fleet ────────────────────────────────────────────────────────
+// Deterministic PRNG (mulberry32) so two runs with the same options play the
+// same scenario
+function prng(seed) {
+  return () => {
+    seed = (seed + 0x6D2B79F5) | 0;
+    let t = Math.imul(seed ^ (seed >>> 15), 1 | seed);
+    t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function fleet(n, spacing) {
+  const side = Math.ceil(Math.sqrt(n));
+  const k = Math.PI / 180;
+  return Array.from({ length: n }, (_, i) => {
+    const e = (i % side) * spacing, north = Math.floor(i / side) * spacing;
+    const mac = ['BE', 'AC', 0, (i >> 16) & 255, (i >> 8) & 255, i & 255]
+      .map(v => (typeof v === 'string' ? v : v.toString(16).padStart(2, '0').toUpperCase())).join(':');
+    return {
+      id: mac, e, n: north, seq: 0,
+      lat: ORIGIN.lat + north / 6371000 / k,
+      lon: ORIGIN.lon + e / (6371000 * Math.cos(ORIGIN.lat * k)) / k,
+    };
+  });
+}
+
+class Device {
+  constructor(dev, ctx) {
+    Object.assign(this, dev);
+    this.ctx = ctx;
+    this.agent = new http.Agent({ keepAlive: true, maxSockets: 1 });
+    this.queue = Promise.resolve();
+  }
+
+  // One request at a time per device
+  send(route, method, pathname, options) {
+    this.queue = this.queue.then(async () => {
+      const r = await request(this.ctx.base, this.agent, method, pathname, options);
+      this.ctx.stats.record(route, r.ms, r.status >= 200 && r.status < 300, options?.body?.length || 0);
+      if (r.error && !this.ctx.firstError) this.ctx.firstError = `${route}: ${r.error}`;
+      return r;
+    });
+    return this.queue;
+  }
+
+  init() {
+    return this.send('init', 'GET', `/api/init?id=${encodeURIComponent(this.id)}&version=bench`);
+  }
+
+  heartbeat() {
+    const temp = (24 + this.ctx.rng() * 2).toFixed(1);
+    return this.send('heartbeat', 'GET', `/?id=${encodeURIComponent(this.id)}&temp_c=${temp}`);
+  }
+
+  // triggerMs: epoch ms the device's clock says the capture triggered
+  upload(kind, triggerMs) {
+    const { opts, rng } = this.ctx;
+    const wave = synthesize(opts.samples, kind, rng);
+    const deltaG = Math.round(peakDelta(wave) * 10000) / 10000;
+    const headers = {
+      'x-event-seq': String(++this.seq),
+      'x-event-time-us': String(Math.round(triggerMs * 1000)),
+      'x-event-time-source': 'ntp',
+    };
+    let body;
+    if (opts.format === 'binary') {
+      body = encodeBinary(this.id, deltaG, wave);
+      headers['content-type'] = 'application/vnd.seismo.waveform';
+    } else {
+      body = Buffer.from(JSON.stringify({ id: this.id, level: 'minor', deltaG, waveform: wave }));
+      headers['content-type'] = 'application/json';
+    }
+    this.ctx.events++;
+    return this.send(`seismic (${kind})`, 'POST', '/api/seismic', { body, headers });
+  }
+
+  close() {
+    this.agent.destroy();
+  }
+}
+
+// ── Disposable server ────────────────────────────────────────────
+async function waitFor(base, ms) {
+  const until = Date.now() + ms;
+  const agent = new http.Agent();
+  while (Date.now() < until) {
+    const r = await request(base, agent, 'GET', '/api/info');
+    if (r.status === 200) return;
+    await new Promise(res => setTimeout(res, 250));
+  }
+  throw new Error(`server at ${base} did not come up`);
+}
+
+function freePort() {
+  return new Promise((resolve) => {
+    const srv = require('net').createServer().listen(0, '127.0.0.1', () => {
+      const { port } = srv.address();
+      srv.close(() => resolve(port));
+    });
+  });
+}
+
+// --mongo, else a throwaway mongo container -> its URI
+function startMongo(opts, cleanup) {
+  if (opts.mongo) return opts.mongo;
+  const container = execFileSync('docker', ['run', '-d', '--rm', '-p', '127.0.0.1::27017', opts.image]).toString().trim();
+  cleanup.push(() => execFileSync('docker', ['rm', '-f', container], { stdio: 'ignore' }));
+  const mapped = execFileSync('docker', ['port', container, '27017']).toString().split('\n')[0].trim();
+  return `mongodb://${mapped.replace('0.0.0.0', '127.0.0.1')}/seismic_bench`;
+}
+
+async function startServer(opts, cleanup) {
+  const mongo = startMongo(opts, cleanup);
+  const port = opts.port || await freePort();
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'seismo-bench-'));
+  cleanup.push(() => fs.rmSync(dir, { recursive: true, force: true }));
+  const log = fs.openSync(path.join(dir, 'server.log'), 'a');
+  const child = spawn(process.execPath, [path.join(__dirname, '..', 'server.js')], {
+    env: { ...process.env, MONGO_URI: mongo, PORT: String(port), STREAM_PORT: String(await freePort()),
+           INGEST_JOURNAL: path.join(dir, 'ingest.journal'), ...(opts.env || {}) },
+    stdio: ['ignore', log, log],
+  });
+  cleanup.unshift(() => child.kill());
+  const base = `http://127.0.0.1:${port}`;
+  // Mongo in a fresh container takes a few seconds to accept connections
+  await waitFor(base, 60000).catch((e) => {
+    process.stderr.write(fs.readFileSync(path.join(dir, 'server.log'), 'utf8').slice(-2000));
+    throw e;
+  });
+  return { base, mongo };
+}
+
+// ── Scenario ─────────────────────────────────────────────────────
+async function setup(ctx, devices) {
+  const agent = new http.Agent({ keepAlive: true });
+  const put = (p, body) => request(ctx.base, agent, 'PUT', p, {
+    body: Buffer.from(JSON.stringify(body)), headers: { 'content-type': 'application/json' },
+  });
+  const g = await put(`/api/groups/${GROUP}`, { quorum: ctx.opts.quorum });
+  if (g.status !== 200) throw new Error(`PUT /api/groups/${GROUP}: ${g.status} ${g.body || g.error}`);
+  for (const d of devices) {
+    const r = await put(`/api/devices/${encodeURIComponent(d.id)}`,
+      { alias: `bench-${d.id.slice(-5).replace(':', '')}`, group: GROUP, lat: d.lat, lon: d.lon });
+    if (r.status !== 200) throw new Error(`PUT /api/devices/${d.id}: ${r.status} ${r.body || r.error}`);
+  }
+  agent.destroy();
+}
+
+// Quakes evenly spread, none in the first or last tenth of the run; each at
+// a random epicentre within a few grid spacings of the fleet
+function planQuakes(ctx, startMs) {
+  const { opts, rng } = ctx;
+  const span = opts.duration * 1000;
+  return Array.from({ length: opts.quakes }, (_, i) => ({
+    at: startMs + span * (0.1 + 0.8 * (i + 0.5) / opts.quakes),
+    e: (rng() - 0.5) * opts.spacing * 6,
+    n: (rng() - 0.5) * opts.spacing * 6,
+  }));
+}
+
+async function run(ctx, devices) {
+  const { opts, rng } = ctx;
+  await Promise.all(devices.map(d => d.init()));
+  const startMs = Date.now();
+  const endMs = startMs + opts.duration * 1000;
+  const quakes = planQuakes(ctx, startMs);
+  const timers = [];
+  const later = (ms, fn) => timers.push(setTimeout(fn, Math.max(0, ms)));
+  const pending = [];
+
+  // Dashboards, without ETags: every poll is a full body
+  const readers = Array.from({ length: opts.readers }, (_, i) => new Device({ id: `reader${i}` }, ctx));
+  const since = new Date(startMs).toISOString();
+  readers.forEach((r, i) => {
+    for (let t = startMs + i * 1000 / opts.readers; t < endMs; t += 1000) {
+      later(t - Date.now(), () => pending.push(r.send('status', 'GET', '/api/status')));
+    }
+    for (let t = startMs + i * 5000 / opts.readers; t < endMs; t += 5000) {
+      later(t - Date.now(), () => pending.push(r.send('events', 'GET', `/api/events?since=${since}&limit=1000`)));
+    }
+  });
+
+  for (const d of devices) {
+    // Heartbeats, phase-shifted so the fleet doesn't beat in step
+    for (let t = startMs + rng() * opts.heartbeat * 1000; t < endMs; t += opts.heartbeat * 1000) {
+      later(t - Date.now(), () => pending.push(d.heartbeat()));
+    }
+    // Background triggers: a Poisson process at --noise per minute
+    for (let t = startMs; opts.noise > 0;) {
+      t += -Math.log(1 - rng()) * 60000 / opts.noise;
+      if (t >= endMs) break;
+      const at = t;
+      later(at - Date.now(), () => pending.push(d.upload('noise', at)));
+    }
+  }
+  // Quakes: each device triggers when the wave reaches it and uploads once
+  // its capture is complete (here: right away, so bursts hit together)
+  for (const q of quakes) {
+    q.arrivals = devices.map(d => q.at + Math.hypot(d.e - q.e, d.n - q.n) / opts.velocity * 1000);
+    devices.forEach((d, i) => later(q.arrivals[i] - Date.now(), () => pending.push(d.upload('quake', q.arrivals[i]))));
+  }
+
+  await new Promise(res => setTimeout(res, endMs - Date.now()));
+  await Promise.all(pending);
+  timers.forEach(clearTimeout);
+  readers.forEach(r => r.close());
+  return { startMs, endMs: Date.now(), quakes };
+}
+
+// CONFIRMED entries of the bench group against the quakes played
+// -> the server process's CPU time so far in ms, or null (older server)
+async function serverCpuMs(base) {
+  const r = await request(base, new http.Agent(), 'GET', '/api/info');
+  try {
+    const p = JSON.parse(r.body).process;
+    return p ? p.cpu_user_ms + p.cpu_system_ms : null;
+  } catch {
+    return null;
+  }
+}
+
+async function checkConsensus(ctx, { startMs, quakes }) {
+  await new Promise(res => setTimeout(res, ctx.opts.settle * 1000));
+  const r = await request(ctx.base, new http.Agent(), 'GET', '/api/consensus');
+  const entries = r.status === 200 ? JSON.parse(r.body) : [];
+  const ours = entries.filter(e => e.group === GROUP && new Date(e.timestamp).getTime() >= startMs - 1000);
+  const matched = new Set();
+  let found = 0;
+  const offsets = [];
+  for (const q of quakes) {
+    const first = Math.min(...q.arrivals), last = Math.max(...q.arrivals);
+    const hit = ours.find((e, i) => !matched.has(i) &&
+      Math.abs(new Date(e.timestamp).getTime() - first) <= Math.max(1000, last - first) && matched.add(i));
+    if (hit) {
+      found++;
+      offsets.push(Math.abs(new Date(hit.timestamp).getTime() - first));
+    }
+  }
+  return {
+    quakes: quakes.length,
+    found,
+    missed: quakes.length - found,
+    unexplained: ours.length - matched.size,
+    max_time_error_ms: offsets.length ? Math.round(Math.max(...offsets)) : null,
+  };
+}
+
+function printReport(report) {
+  const pad = (v, n) => String(v).padStart(n);
+  console.log(`\n${report.devices} devices, ${report.duration_s}s, ${report.format} uploads of ${report.samples} samples`);
+  console.log(`${'route'.padEnd(18)}${pad('count', 7)}${pad('err', 5)}${pad('p50', 8)}${pad('p90', 8)}${pad('p99', 8)}${pad('max', 8)}${pad('KiB', 8)}`);
+  for (const [route, s] of Object.entries(report.routes)) {
+    console.log(`${route.padEnd(18)}${pad(s.count, 7)}${pad(s.errors, 5)}${pad(s.p50_ms, 8)}${pad(s.p90_ms, 8)}` +
+      `${pad(s.p99_ms, 8)}${pad(s.max_ms, 8)}${pad(s.kib, 8)}`);
+  }
+  console.log(`throughput: ${report.requests_per_s} req/s, ${report.events_per_s} events/s`);
+  if (report.server_cpu_ms != null) {
+    console.log(`server cpu: ${report.server_cpu_ms} ms, ${report.cpu_us_per_request} µs per request`);
+  }
+  const c = report.consensus;
+  console.log(`consensus: ${c.found}/${c.quakes} quakes confirmed, ${c.missed} missed, ${c.unexplained} unexplained` +
+    (c.max_time_error_ms != null ? `, worst onset error ${c.max_time_error_ms}ms` : ''));
+  if (report.first_error) console.log(`first error: ${report.first_error}`);
+}
+
+async function main() {
+  const opts = parseArgs(process.argv.slice(2));
+  const cleanup = [];
+  const stop = () => { for (const fn of cleanup.splice(0)) { try { fn(); } catch { /* already gone */ } } };
+  process.on('SIGINT', () => { stop(); process.exit(130); });
+  try {
+    const base = opts.spawn ? (await startServer(opts, cleanup)).base : opts.url;
+    const ctx = { opts, base, rng: prng(opts.devices * 7919 + opts.quakes), stats: new Stats(), events: 0, firstError: null };
+    const devices = fleet(opts.devices, opts.spacing).map(d => new Device(d, ctx));
+    await setup(ctx, devices);
+    const cpuBefore = await serverCpuMs(base);
+    const played = await run(ctx, devices);
+    const cpuAfter = await serverCpuMs(base);
+    devices.forEach(d => d.close());
+    const seconds = (played.endMs - played.startMs) / 1000;
+    const routes = ctx.stats.summary();
+    const requests = Object.values(routes).reduce((s, r) => s + r.count, 0);
+    const report = {
+      devices: opts.devices, duration_s: opts.duration, format: opts.format, samples: opts.samples,
+      routes,
+      requests_per_s: Math.round(requests / seconds * 10) / 10,
+      events_per_s: Math.round(ctx.events / seconds * 10) / 10,
+      server_cpu_ms: cpuBefore != null && cpuAfter != null ? Math.round(cpuAfter - cpuBefore) : null,
+      consensus: await checkConsensus(ctx, played),
+      first_error: ctx.firstError,
+    };
+    report.cpu_us_per_request = report.server_cpu_ms != null && requests
+      ? Math.round(report.server_cpu_ms * 1000 / requests) : null;
+    if (opts.json) console.log(JSON.stringify(report));
+    else printReport(report);
+    process.exitCode = report.consensus.missed || Object.values(routes).some(r => r.errors) ? 1 : 0;
+  } finally {
+    stop();
+  }
+}
+
+// The disposable server and upload bodies, for bench/render.js
+module.exports = { request, synthesize, encodeBinary, peakDelta, prng, startMongo, startServer, freePort, waitFor };
+
+if (require.main === module) {
+  main().catch((e) => {
+    console.error(`loadgen: ${e.message}`);
+    process.exitCode = 2;
+  });
+}
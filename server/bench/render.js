@@ -0,0 +1,409 @@
+#!/usr/bin/env node
+// ── Dashboard render benchmark ───────────────────────────────────
+// Loads the built dashboard (frontend/dist) in headless Chrome against a
+// server.js child seeded with --sizes synthetic events over the last 24h,
+// and measures, per size, on a fresh page:
+//   first render  navigation to the frame after the Events metric shows
+//                 them all (the scatter canvas draws in the same commit),
+//                 with the /api/events pages' last byte and first paint
+//   memory        JS heap after a forced GC, and DOM nodes
+//   zoom / pan    --steps wheel notches, then a Pan-tool drag back and
+//                 forth: frame intervals (p50 / p95 / max, frames over
+//                 33 ms) and main-thread task and script time
+//   waveform      a Range drag over the newest minutes, where --waveforms
+//                 events carry --samples samples each, then a click on the
+//                 first row: time until the waveform plot is on screen
+//   burst         --burst uploads POSTed at once (SWV1, as loadgen.js):
+//                 time until the dashboard counts them all off the socket,
+//                 with the frames and main-thread time it took
+//
+// Chrome is driven over the DevTools pipe (bench/cdp.js), found on the PATH
+// or in a puppeteer download, or given with --chrome / CHROME_PATH. The
+// database is dropped and reseeded for every size, so give --mongo only a
+// disposable one:
+//   node bench/render.js                      docker run mongo + server.js child
+//   node bench/render.js --mongo URI --sizes 1000,10000
+//   node bench/render.js --record bench/render.ndjson
+// --record appends the run (git commit, Chrome version and results) to an
+// NDJSON file and prints the change against the run before it, so a commit
+// can be compared with its parent on the same machine. --throttle N slows
+// the page's CPU N times, for numbers nearer a small laptop's. --json
+// prints the report as one JSON object.
+
+const fs = require('fs');
+const http = require('http');
+const path = require('path');
+const { execFileSync } = require('child_process');
+const { MongoClient, ObjectId } = require('mongodb');
+const { Browser } = require('./cdp');
+const { request, synthesize, encodeBinary, peakDelta, prng, startMongo, startServer } = require('./loadgen');
+const waveform = require('../lib/waveform');
+const schema = require('../lib/schema');
+
+const DEVICES = [
+  { id: 'BE:4C:00:00:00:01', alias: 'bench-north' },
+  { id: 'BE:4C:00:00:00:02', alias: 'bench-east' },
+  { id: 'BE:4C:00:00:00:03', alias: 'bench-south' },
+];
+const HOUR_MS = 3_600_000;
+const WAVEFORM_SPAN_MS = 10 * 60_000;   // the long captures sit in the newest 10 minutes...
+const QUIET_MS = 30 * 60_000;           // ...and nothing else in the newest 30
+const RANGE_FRACTION = 0.012;           // of the 24h chart, ~17 minutes from its right edge
+const LONG_FRAME_MS = 33.4;
+const WAIT_MS = 120_000;
+
+const DEFAULTS = {
+  mongo: null, image: 'mongo:7', dist: path.join(__dirname, '..', 'frontend', 'dist'), chrome: null,
+  sizes: '1000,10000,100000', waveforms: 3, samples: 30000, steps: 20, burst: 200, throttle: 1,
+  width: 1600, height: 900, record: null, label: '', json: false,
+};
+
+function parseArgs(argv) {
+  const opts = { ...DEFAULTS };
+  for (let i = 0; i < argv.length; i++) {
+    const key = argv[i].replace(/^--/, '');
+    if (!(key in DEFAULTS)) throw new Error(`unknown option --${key}`);
+    if (typeof DEFAULTS[key] === 'boolean') opts[key] = true;
+    else opts[key] = typeof DEFAULTS[key] === 'number' ? Number(argv[++i]) : argv[++i];
+  }
+  opts.sizes = String(opts.sizes).split(',').map(Number);
+  if (!opts.sizes.every(n => Number.isInteger(n) && n > opts.waveforms)) {
+    throw new Error('--sizes is a comma list of event counts, each more than --waveforms');
+  }
+  if (!fs.existsSync(path.join(opts.dist, 'index.html'))) {
+    throw new Error(`no ${path.join(opts.dist, 'index.html')}; run npm run build in frontend/ (or give --dist)`);
+  }
+  return opts;
+}
+
+const sleep = ms => new Promise(res => setTimeout(res, ms));
+const round = (v, d = 1) => (v == null ? null : Math.round(v * 10 ** d) / 10 ** d);
+
+// ── Seeding ──────────────────────────────────────────────────────
+// size events in stored form (lib/schema.js), spread over the 24h view
+// before the quiet stretch, ΔG log-normal around 0.01 g; the newest
+// --waveforms of them carry a long capture in the waveforms collection
+async function seed(db, opts, size, rng) {
+  await db.dropDatabase();
+  const now = Date.now();
+  const gauss = () => Math.sqrt(-2 * Math.log(1 - rng())) * Math.cos(2 * Math.PI * rng());
+  const span = 24 * HOUR_MS - QUIET_MS - 10 * 60_000;
+  const docs = [];
+  const waves = [];
+  for (let i = 0; i < size; i++) {
+    const long = i >= size - opts.waveforms;
+    const t = long
+      ? now - WAVEFORM_SPAN_MS + (i - (size - opts.waveforms) + 0.5) * WAVEFORM_SPAN_MS / opts.waveforms
+      : now - QUIET_MS - rng() * span;
+    const deltaG = Math.round(Math.exp(Math.log(0.01) + 0.8 * gauss()) * 10000) / 10000;
+    const device = DEVICES[i % DEVICES.length];
+    const doc = schema.compact({
+      _id: new ObjectId(), time: new Date(t), modified: new Date(t), time_source: 'ntp',
+      level: deltaG < 0.05 ? 'minor' : deltaG < 0.2 ? 'moderate' : 'severe',
+      trigger: 'threshold', deltaG, id: device.id, latency: null, has_waveform: long,
+    });
+    if (long) {
+      const packed = waveform.packWaveform(synthesize(opts.samples, 'quake', rng));
+      doc.waveform_samples = packed.count;
+      waves.push({ _id: doc._id, id: device.id, ...packed });
+    }
+    docs.push(doc);
+  }
+  for (let i = 0; i < docs.length; i += 10000) {
+    await db.collection('events').insertMany(docs.slice(i, i + 10000), { ordered: false });
+  }
+  if (waves.length) await db.collection('waveforms').insertMany(waves);
+}
+
+// The seeding doesn't go through the server, so it starts afterwards
+// (its 24h window loads from Mongo once, at startup)
+async function serve(opts, mongo) {
+  const cleanup = [];
+  const { base } = await startServer({ ...opts, mongo, port: 0,
+                                       env: { PUBLIC_DIR: opts.dist, STACK_DETECT: 'off', THRESHOLD_TUNING: 'off' } }, cleanup);
+  const agent = new http.Agent({ keepAlive: true });
+  for (const d of DEVICES) {
+    const r = await request(base, agent, 'PUT', `/api/devices/${encodeURIComponent(d.id)}`, {
+      body: Buffer.from(JSON.stringify({ alias: d.alias })), headers: { 'content-type': 'application/json' },
+    });
+    if (r.status !== 200) throw new Error(`PUT /api/devices/${d.id}: ${r.status} ${r.body || r.error}`);
+  }
+  return { base, agent, stop: () => { agent.destroy(); for (const fn of cleanup) { try { fn(); } catch { /* gone */ } } } };
+}
+
+// ── In the page ──────────────────────────────────────────────────
+// Installed before the dashboard's own scripts: every animation frame's
+// timestamp while recording, and the time the Events metric first reads
+// at least window.__bench.expect
+const RECORDER = `(() => {
+  const b = window.__bench = { frames: [], recording: false, expect: Infinity, rendered: null };
+  const count = () => Number((document.querySelector('.metrics-row .metric-value')?.textContent || '').replace(/\\D/g, '')) || 0;
+  const tick = (ts) => {
+    if (b.recording) b.frames.push(ts);
+    if (b.rendered == null && count() >= b.expect) b.rendered = ts;
+    requestAnimationFrame(tick);
+  };
+  requestAnimationFrame(tick);
+  b.until = (test, ms) => new Promise((resolve, reject) => {
+    const t0 = performance.now();
+    const poll = () => {
+      const v = test();
+      if (v) resolve(v);
+      else if (performance.now() - t0 > ms) reject(new Error('timed out'));
+      else requestAnimationFrame(poll);
+    };
+    poll();
+  });
+  b.count = count;
+})()`;
+
+// Frame timestamps -> interval percentiles
+function frameStats(frames) {
+  const dt = frames.slice(1).map((t, i) => t - frames[i]).sort((a, b) => a - b);
+  const at = q => (dt.length ? dt[Math.min(dt.length - 1, Math.floor(q * dt.length))] : null);
+  return { frames: frames.length, p50_ms: round(at(0.5)), p95_ms: round(at(0.95)), max_ms: round(dt[dt.length - 1]),
+           long: dt.filter(d => d > LONG_FRAME_MS).length };
+}
+
+// Runs fn with frames recorded -> frame stats plus the main thread's task
+// and script time over it
+async function measured(page, fn) {
+  const before = await page.metrics();
+  await page.evaluate('window.__bench.frames = []; window.__bench.recording = true');
+  const t0 = Date.now();
+  const extra = await fn();
+  const wall = Date.now() - t0;
+  const frames = await page.evaluate('window.__bench.recording = false; window.__bench.frames');
+  const after = await page.metrics();
+  return { ...extra, wall_ms: wall, ...frameStats(frames),
+           task_ms: round((after.TaskDuration - before.TaskDuration) * 1000),
+           script_ms: round((after.ScriptDuration - before.ScriptDuration) * 1000) };
+}
+
+const mouse = (page, type, x, y, extra = {}) => page.send('Input.dispatchMouseEvent',
+  { type, x, y, button: type === 'mouseMoved' && !extra.buttons ? 'none' : 'left', clickCount: 1, ...extra });
+
+async function overlayRect(page) {
+  return page.evaluate(`(() => { const r = document.querySelector('.main-chart .chart-overlay').getBoundingClientRect();
+    return { left: r.left, top: r.top, width: r.width, height: r.height }; })()`);
+}
+
+const clickTool = (page, label) => page.evaluate(`[...document.querySelectorAll('.period-toggle .period-btn')]
+  .find(b => b.textContent.trim() === ${JSON.stringify(label)}).click()`);
+
+async function drag(page, from, to, y, steps) {
+  await mouse(page, 'mousePressed', from, y);
+  for (let i = 1; i <= steps; i++) {
+    await mouse(page, 'mouseMoved', from + (to - from) * i / steps, y, { buttons: 1 });
+    await sleep(16);
+  }
+  await mouse(page, 'mouseReleased', to, y);
+}
+
+// ── One size ─────────────────────────────────────────────────────
+async function runSize(browser, opts, size, mongo, db, rng) {
+  await seed(db, opts, size, rng);
+  const server = await serve(opts, mongo);
+  const page = await browser.newPage();
+  try {
+    await page.send('Network.enable');
+    await page.send('Network.setCacheDisabled', { cacheDisabled: true });
+    if (opts.throttle > 1) await page.send('Emulation.setCPUThrottlingRate', { rate: opts.throttle });
+    await page.send('Page.addScriptToEvaluateOnNewDocument', { source: `${RECORDER}; window.__bench.expect = ${size};` });
+    const loaded = page.once('Page.loadEventFired');
+    await page.send('Page.navigate', { url: `${server.base}/` });
+    await loaded;
+
+    // First render
+    const rendered = await page.evaluate(`window.__bench.until(() => window.__bench.rendered, ${WAIT_MS})`);
+    const load = await page.evaluate(`(() => {
+      const pages = performance.getEntriesByType('resource').filter(e => e.name.includes('/api/events?'));
+      const fcp = performance.getEntriesByName('first-contentful-paint')[0];
+      return { pages: pages.length, fetched: Math.max(0, ...pages.map(e => e.responseEnd)), fcp: fcp ? fcp.startTime : null };
+    })()`);
+    await sleep(1000);   // the first prefetches and rollup polls
+    await page.send('HeapProfiler.enable');
+    await page.send('HeapProfiler.collectGarbage');
+    const m = await page.metrics();
+    const result = {
+      events: size,
+      first_render_ms: round(rendered), events_fetched_ms: round(load.fetched), fcp_ms: round(load.fcp), pages: load.pages,
+      heap_mb: round(m.JSHeapUsedSize / 1048576), nodes: m.Nodes,
+    };
+
+    // Zoom: wheel in, then back out, on the chart's centre
+    const r = await overlayRect(page);
+    const cx = r.left + r.width / 2, cy = r.top + r.height / 2;
+    await mouse(page, 'mouseMoved', cx, cy);
+    result.zoom = await measured(page, async () => {
+      for (let i = 0; i < opts.steps * 2; i++) {
+        await page.send('Input.dispatchMouseEvent', { type: 'mouseWheel', x: cx, y: cy, deltaX: 0, deltaY: i < opts.steps ? -100 : 100 });
+        await sleep(16);
+      }
+      await sleep(300);
+    });
+
+    // Pan: zoomed in four notches, dragged one way and back
+    for (let i = 0; i < 4; i++) {
+      await page.send('Input.dispatchMouseEvent', { type: 'mouseWheel', x: cx, y: cy, deltaX: 0, deltaY: -100 });
+    }
+    await clickTool(page, 'Pan');
+    result.pan = await measured(page, async () => {
+      await drag(page, cx - r.width / 4, cx + r.width / 4, cy, opts.steps);
+      await drag(page, cx + r.width / 4, cx - r.width / 4, cy, opts.steps);
+      await sleep(300);
+    });
+    await page.evaluate(`[...document.querySelectorAll('.btn')].find(b => b.textContent.trim() === 'Reset Zoom').click()`);
+
+    // Long waveform: Range over the newest minutes, first row with a capture
+    if (opts.waveforms > 0) {
+      await clickTool(page, 'Range');
+      const right = r.left + r.width - 1;
+      await drag(page, right - r.width * RANGE_FRACTION - 16, right, cy, 4);
+      await page.evaluate(`window.__bench.until(() => document.querySelector('.clickable-row'), ${WAIT_MS})`);
+      result.waveform = await measured(page, () => page.evaluate(`(async () => {
+        const t0 = performance.now();
+        document.querySelector('.clickable-row').click();
+        await window.__bench.until(() => document.querySelector('canvas.waveform-plot'), ${WAIT_MS});
+        await new Promise(res => requestAnimationFrame(() => requestAnimationFrame(res)));
+        return { open_ms: Math.round(performance.now() - t0), samples: ${opts.samples} };
+      })()`));
+      await page.send('Input.dispatchKeyEvent', { type: 'keyDown', key: 'Escape', code: 'Escape', windowsVirtualKeyCode: 27 });
+      await page.evaluate(`document.querySelector('.modal-close')?.click()`);
+    }
+
+    // Socket burst: uploads at "now", all at once
+    if (opts.burst > 0) {
+      const bodies = Array.from({ length: opts.burst }, (_, i) => {
+        const wave = synthesize(500, 'quake', rng);
+        return { device: DEVICES[i % DEVICES.length], i,
+                 body: encodeBinary(DEVICES[i % DEVICES.length].id, Math.round(peakDelta(wave) * 10000) / 10000, wave) };
+      });
+      const before = await page.evaluate('window.__bench.count()');
+      result.burst = await measured(page, async () => {
+        const sent = Date.now();
+        const statuses = await Promise.all(bodies.map(({ device, i, body }) => request(server.base, server.agent, 'POST', '/api/seismic', {
+          body, headers: { 'content-type': 'application/vnd.seismo.waveform', 'x-event-seq': String(i + 1),
+                           'x-event-time-us': String((sent - opts.burst + i) * 1000), 'x-event-time-source': 'ntp' },
+        }).then(res => res.status)));
+        const stored = statuses.filter(s => s >= 200 && s < 300).length;
+        await page.evaluate(`window.__bench.until(() => window.__bench.count() >= ${before + stored}, ${WAIT_MS})`);
+        return { events: opts.burst, stored, landed_ms: Date.now() - sent };
+      });
+    }
+    return result;
+  } finally {
+    await page.close().catch(() => {});
+    server.stop();
+  }
+}
+
+// ── Recording ────────────────────────────────────────────────────
+function gitState() {
+  const git = args => execFileSync('git', args, { cwd: __dirname, stdio: ['ignore', 'pipe', 'ignore'] }).toString().trim();
+  try {
+    return { commit: git(['rev-parse', '--short', 'HEAD']), dirty: git(['status', '--porcelain', '--', '..']) !== '' };
+  } catch {
+    return { commit: null, dirty: null };
+  }
+}
+
+// The figures compared between runs, lower is better for all of them
+const HEADLINE = [
+  ['first render', r => r.first_render_ms, 'ms'],
+  ['heap', r => r.heap_mb, 'MB'],
+  ['zoom p95', r => r.zoom?.p95_ms, 'ms'],
+  ['pan p95', r => r.pan?.p95_ms, 'ms'],
+  ['zoom+pan task', r => r.zoom && r.pan && round(r.zoom.task_ms + r.pan.task_ms), 'ms'],
+  ['waveform open', r => r.waveform?.open_ms, 'ms'],
+  ['burst landed', r => r.burst?.landed_ms, 'ms'],
+  ['burst task', r => r.burst?.task_ms, 'ms'],
+];
+
+function lastRecord(file) {
+  if (!fs.existsSync(file)) return null;
+  const lines = fs.readFileSync(file, 'utf8').split('\n').filter(Boolean);
+  for (let i = lines.length - 1; i >= 0; i--) {
+    try { return JSON.parse(lines[i]); } catch { /* a torn line */ }
+  }
+  return null;
+}
+
+function compare(run, previous) {
+  const out = [];
+  for (const r of run.results) {
+    const p = previous.results.find(x => x.events === r.events);
+    if (!p) continue;
+    for (const [name, get, unit] of HEADLINE) {
+      const a = get(p), b = get(r);
+      if (a == null || b == null) continue;
+      out.push({ events: r.events, metric: name, before: a, after: b, unit,
+                 change_pct: a ? round((b - a) / a * 100) : null });
+    }
+  }
+  return out;
+}
+
+// ── Report ───────────────────────────────────────────────────────
+function print(run, changes, previous) {
+  const pad = (s, n) => String(s ?? '—').padStart(n);
+  console.log(`\nDashboard render, ${run.chrome}, ${run.viewport}${run.throttle > 1 ? `, CPU ×${run.throttle}` : ''}` +
+    (run.commit ? `, ${run.commit}${run.dirty ? '+' : ''}` : ''));
+  console.log(`${'events'.padStart(8)} ${'render'.padStart(8)} ${'fetched'.padStart(8)} ${'heap MB'.padStart(8)} ${'nodes'.padStart(7)}` +
+    `  ${'zoom p95/max'.padStart(13)} ${'long'.padStart(4)}  ${'pan p95/max'.padStart(13)} ${'long'.padStart(4)}` +
+    `  ${'wave'.padStart(6)}  ${'burst'.padStart(7)} ${'task'.padStart(7)}`);
+  for (const r of run.results) {
+    console.log(`${pad(r.events, 8)} ${pad(r.first_render_ms, 8)} ${pad(r.events_fetched_ms, 8)} ${pad(r.heap_mb, 8)} ${pad(r.nodes, 7)}` +
+      `  ${pad(`${r.zoom.p95_ms}/${r.zoom.max_ms}`, 13)} ${pad(r.zoom.long, 4)}  ${pad(`${r.pan.p95_ms}/${r.pan.max_ms}`, 13)} ${pad(r.pan.long, 4)}` +
+      `  ${pad(r.waveform?.open_ms, 6)}  ${pad(r.burst?.landed_ms, 7)} ${pad(r.burst?.task_ms, 7)}`);
+  }
+  console.log('  (ms unless noted; long = frames over 33 ms; burst = uploads until all counted, task = main-thread time meanwhile)');
+  if (!changes) return;
+  console.log(`\nAgainst ${previous.commit || 'the previous run'}${previous.dirty ? '+' : ''} (${previous.time}):`);
+  for (const c of changes) {
+    const flag = c.change_pct > 10 ? '  ▲ slower' : c.change_pct < -10 ? '  ▼ faster' : '';
+    console.log(`  ${pad(c.events, 7)} ${c.metric.padEnd(14)} ${pad(c.before, 9)} → ${pad(c.after, 9)} ${c.unit}` +
+      `  ${c.change_pct == null ? '' : `${c.change_pct > 0 ? '+' : ''}${c.change_pct}%`}${flag}`);
+  }
+}
+
+async function main() {
+  const opts = parseArgs(process.argv.slice(2));
+  const cleanup = [];
+  const stop = () => { for (const fn of cleanup.splice(0)) { try { fn(); } catch { /* already gone */ } } };
+  process.on('SIGINT', () => { stop(); process.exit(130); });
+  let client = null;
+  try {
+    const mongo = startMongo(opts, cleanup);
+    client = new MongoClient(mongo);
+    for (let until = Date.now() + 60000; ;) {   // a fresh container takes a few seconds
+      try { await client.connect(); break; } catch (e) { if (Date.now() > until) throw e; await sleep(500); }
+    }
+    const db = client.db();
+    const browser = await Browser.launch({ ...(opts.chrome ? { executable: opts.chrome } : {}), width: opts.width, height: opts.height });
+    cleanup.unshift(() => browser.close());
+    const { product } = await browser.send('Browser.getVersion');
+    const rng = prng(opts.sizes.reduce((s, n) => s + n, 0));
+    const results = [];
+    for (const size of opts.sizes) {
+      if (!opts.json) process.stderr.write(`render: ${size} events...\n`);
+      results.push(await runSize(browser, opts, size, mongo, db, rng));
+    }
+    const run = { time: new Date().toISOString(), ...gitState(), label: opts.label || undefined, chrome: product,
+                  viewport: `${opts.width}x${opts.height}`, throttle: opts.throttle, samples: opts.samples,
+                  waveforms: opts.waveforms, burst: opts.burst, steps: opts.steps, results };
+    const previous = opts.record ? lastRecord(opts.record) : null;
+    const changes = previous ? compare(run, previous) : null;
+    if (opts.record) fs.appendFileSync(opts.record, JSON.stringify(run) + '\n');
+    if (opts.json) console.log(JSON.stringify({ ...run, changes, previous: previous && { commit: previous.commit, time: previous.time } }));
+    else print(run, changes, previous);
+  } finally {
+    await client?.close().catch(() => {});
+    stop();
+  }
+}
+
+main().catch((e) => {
+  console.error(`render: ${e.message}`);
+  process.exitCode = 2;
+});
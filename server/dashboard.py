@@ -5,6 +5,8 @@ import streamlit as st
 import requests
 from streamlit_autorefresh import st_autorefresh
 import math
+import threading
+import time
 
 # Configuration
 # Use localhost for API by default
@@ -77,19 +79,75 @@ def fetch_statuses():
     except:
         return {}
 
-@st.cache_data(ttl=5)
-def fetch_events():
-    try:
-        resp = requests.get(f"{API_URL}/api/events", timeout=5)
-        df = pd.DataFrame(resp.json())
-    except:
-        df = pd.read_json("events.txt", lines=True)
+# The longest period the page offers; server.py reads only this window
+EVENTS_WINDOW = pd.Timedelta(days=30)
+EVENTS_REFRESH_S = 5
+
+
+def parse_events(records):
+    df = pd.DataFrame(records)
+    if df.empty:
+        return pd.DataFrame({"timestamp": pd.Series(dtype="datetime64[ns, UTC]"),
+                             "id": [], "alias": [], "deltaG": [], "level": []})
     # parse timestamps as UTC (tz-aware)
     df["timestamp"] = pd.to_datetime(df["timestamp"], utc=True)
     # keep all events including confirmed entries (no dropna on id/alias)
     # ... raw events already validated upstream
     return df
 
+
+class EventFrame:
+    """The last EVENTS_WINDOW of events, sorted by timestamp, shared by every
+    session. A refresh asks server.py only for events since the newest one
+    held and appends them, so only new rows are parsed; rows that fell out of
+    the window are cut off the front."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.df = parse_events([])
+        self.fetched = 0.0
+
+    def refresh(self):
+        with self.lock:
+            if time.monotonic() - self.fetched < EVENTS_REFRESH_S:
+                return self.df
+            now = pd.Timestamp.now(tz='UTC')
+            last = self.df["timestamp"].iloc[-1] if len(self.df) else now - EVENTS_WINDOW
+            try:
+                resp = requests.get(f"{API_URL}/api/events", params={
+                    "since": last.strftime('%Y-%m-%dT%H:%M:%S.%f')[:-3] + 'Z'}, timeout=5)
+                new = parse_events(resp.json())
+            except:
+                if len(self.df):
+                    return self.df  # keep what is held; try again next refresh
+                new = parse_events(pd.read_json("events.txt", lines=True).to_dict("records"))
+            self.fetched = time.monotonic()
+            if len(new) and len(self.df):
+                # since is inclusive and ms-precise: drop what is held already,
+                # including the rows sharing the last timestamp
+                held = int((self.df["timestamp"] == last).sum())
+                new = new[new["timestamp"] >= last]
+                same = new["timestamp"] == last
+                new = pd.concat([new[same].iloc[held:], new[~same]])
+            if len(new):
+                if not new["timestamp"].is_monotonic_increasing:
+                    new = new.sort_values("timestamp", kind="stable")
+                self.df = pd.concat([self.df, new], ignore_index=True) if len(self.df) else new.reset_index(drop=True)
+            cut = self.df["timestamp"].searchsorted(now - EVENTS_WINDOW)
+            if cut:
+                self.df = self.df.iloc[cut:].reset_index(drop=True)
+            return self.df
+
+
+@st.cache_resource
+def event_frame():
+    return EventFrame()
+
+
+def events_since(df, start):
+    """Rows of the sorted frame from start on, by bisection."""
+    return df.iloc[df["timestamp"].searchsorted(start):]
+
 @st.cache_data(ttl=60)
 def fetch_http_logs():
     try:
@@ -103,7 +161,7 @@ def fetch_http_logs():
 # Auto-refresh every 60s
 st_autorefresh(interval=60_000, key="refresh")
 # Fetch data immediately after refresh
-df = fetch_events()
+df = event_frame().refresh()
 http_df = fetch_http_logs()
 
 # Retrieve or set default history period (default to 7 days)
@@ -118,7 +176,8 @@ start = now - {
     '30 days': pd.Timedelta(days=30)
 }[period]
 # Filter data
-df_window = df[(df['timestamp'] >= start) & df['alias'].notnull()]
+df_window = events_since(df, start)
+df_window = df_window[df_window['alias'].notnull()]
 http_window = http_df[pd.to_datetime(http_df['timestamp']) >= start]
 
 # Placeholders to maintain layout
@@ -160,7 +219,8 @@ start = now - {
     "30 days": pd.Timedelta(days=30)
 }[period]
 # Re-filter data after period change
-df_window = df[(df["timestamp"] >= start) & df["alias"].notnull()]
+df_window = events_since(df, start)
+df_window = df_window[df_window["alias"].notnull()]
 # Also recompute consensus_df and HTTP window
 # Consensus entries are logged with status == 'CONFIRMED' in raw events
 # consensus_df = df[df['status'] == 'CONFIRMED']
@@ -0,0 +1,61 @@
+// ── Dashboard service worker ─────────────────────────────────────
+// Keeps the app shell on the device so a reload starts without the
+// network: navigations get the cached index.html at once and refresh it in
+// the background (a deploy shows on the load after), and the hashed chunks
+// under /assets/ are served from the cache once fetched, as they never
+// change (server/lib/assets.js). The API, the sockets and the firmware
+// pass straight through; the event list is kept by the page itself
+// (src/snapshot.js). Registered from src/main.jsx in production builds.
+
+const CACHE = 'seismo-shell-v1';
+const SHELL = '/index.html';
+const ROUTES = ['/', '/admin'];   // the client-side routes (src/main.jsx); other pages aren't ours
+const MAX_ASSETS = 80;   // old deploys' chunks beyond this go first
+
+self.addEventListener('install', (event) => {
+  event.waitUntil(caches.open(CACHE).then(c => c.add(SHELL)).then(() => self.skipWaiting()));
+});
+
+self.addEventListener('activate', (event) => {
+  event.waitUntil(caches.keys()
+    .then(keys => Promise.all(keys.filter(k => k !== CACHE).map(k => caches.delete(k))))
+    .then(() => self.clients.claim()));
+});
+
+async function trim(cache) {
+  const keys = (await cache.keys()).filter(r => new URL(r.url).pathname.startsWith('/assets/'));
+  for (const r of keys.slice(0, Math.max(0, keys.length - MAX_ASSETS))) await cache.delete(r);
+}
+
+async function shell(request) {
+  const cache = await caches.open(CACHE);
+  const cached = await cache.match(SHELL);
+  const fresh = fetch(request).then((res) => {
+    if (res.ok) cache.put(SHELL, res.clone());
+    return res;
+  });
+  if (!cached) return fresh;
+  fresh.catch(() => {});
+  return cached;
+}
+
+async function asset(request) {
+  const cache = await caches.open(CACHE);
+  const cached = await cache.match(request);
+  if (cached) return cached;
+  const res = await fetch(request);
+  if (res.ok) {
+    await cache.put(request, res.clone());
+    trim(cache);
+  }
+  return res;
+}
+
+self.addEventListener('fetch', (event) => {
+  const { request } = event;
+  if (request.method !== 'GET') return;
+  const url = new URL(request.url);
+  if (url.origin !== self.location.origin) return;
+  if (request.mode === 'navigate' && ROUTES.includes(url.pathname)) event.respondWith(shell(request));
+  else if (url.pathname.startsWith('/assets/')) event.respondWith(asset(request));
+});
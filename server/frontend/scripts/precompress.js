@@ -0,0 +1,34 @@
+// ── Precompress the build ────────────────────────────────────────
+// Writes a .br (brotli, quality 11) and a .gz (gzip -9) beside every text
+// asset in the build output, for server/lib/assets.js to send as is.
+// Files under MIN_BYTES, and variants that come out no smaller, are skipped.
+//
+//   node scripts/precompress.js [dist]
+import fs from 'node:fs';
+import path from 'node:path';
+import zlib from 'node:zlib';
+
+const MIN_BYTES = 1024;
+const TEXT = /\.(js|mjs|css|html|svg|json|txt|map)$/;
+
+function walk(dir) {
+  return fs.readdirSync(dir, { withFileTypes: true }).flatMap(d =>
+    d.isDirectory() ? walk(path.join(dir, d.name)) : [path.join(dir, d.name)]);
+}
+
+const root = process.argv[2] || 'dist';
+let before = 0, after = 0, files = 0;
+for (const file of walk(root).filter(f => TEXT.test(f))) {
+  const body = fs.readFileSync(file);
+  if (body.length < MIN_BYTES) continue;
+  const br = zlib.brotliCompressSync(body, {
+    params: { [zlib.constants.BROTLI_PARAM_QUALITY]: 11, [zlib.constants.BROTLI_PARAM_SIZE_HINT]: body.length },
+  });
+  const gz = zlib.gzipSync(body, { level: 9 });
+  if (br.length < body.length) fs.writeFileSync(`${file}.br`, br);
+  if (gz.length < body.length) fs.writeFileSync(`${file}.gz`, gz);
+  before += body.length;
+  after += Math.min(br.length, body.length);
+  files++;
+}
+console.log(`precompressed ${files} files: ${(before / 1024).toFixed(0)} KB -> ${(after / 1024).toFixed(0)} KB brotli`);
@@ -1,6 +1,70 @@
 import { useState, useEffect, useCallback } from 'react';
 import { useNavigate } from 'react-router-dom';
-import { io } from 'socket.io-client';
+import { connectLive } from './live';
+import SoakPanel from './SoakPanel';
+import DeviceTelemetry from './DeviceTelemetry';
+import { createTelemetry } from './telemetry';
+import './Admin.css';
+
+// MPU6050 digital low-pass filter settings (MPU6050_DLPF_BW_*)
+const DLPF_OPTIONS = [
+  { value: 0, label: '256 Hz' },
+  { value: 1, label: '188 Hz' },
+  { value: 2, label: '98 Hz' },
+  { value: 3, label: '42 Hz' },
+  { value: 4, label: '20 Hz' },
+  { value: 5, label: '10 Hz' },
+  { value: 6, label: '5 Hz' },
+];
+const ACQUISITION_KEYS = ['sample_rate_hz', 'dlpf', 'pre_ms', 'post_ms', 'max_post_ms',
+  'trigger_mode', 'detect_metric', 'sta_ms', 'lta_ms', 'sta_lta_on', 'sta_lta_off',
+  'hp_hz', 'lp_hz', 'bias_track_s', 'ntp_server', 'push_heartbeat_interval',
+  'stream_mode', 'stream_hz', 'spectrum', 'local_http'];
+const PROFILE_PHASES = [
+  { key: 'i2c', label: 'I2C' },
+  { key: 'detect', label: 'Detection' },
+  { key: 'serial', label: 'Serial' },
+  { key: 'http', label: 'HTTP' },
+  { key: 'loop', label: 'Loop pass' },
+];
+const LATENCY_STAGES = [
+  { key: 'capture_ms', label: 'Capture (device)' },
+  { key: 'queue_ms', label: 'Upload queue (device)' },
+  { key: 'network_ms', label: 'Network (SNTP nodes)' },
+  { key: 'notice_ms', label: 'Trigger notice' },
+  { key: 'body_ms', label: 'Request body' },
+  { key: 'journal_ms', label: 'Journal' },
+  { key: 'emit_ms', label: 'Socket emit' },
+  { key: 'commit_ms', label: 'MongoDB commit' },
+  { key: 'total_ms', label: 'Trigger → dashboard' },
+];
+// Boot phases in setup() order (src/boot_timing.h); wifi is only the wait
+// left after calibration, the association runs underneath mpu and calib
+const BOOT_PHASES = [
+  { key: 'mpu', label: 'MPU init', color: '#6c8cff' },
+  { key: 'calib', label: 'Calibration', color: '#00d4aa' },
+  { key: 'wifi', label: 'Wi-Fi wait', color: '#ffaa00' },
+  { key: 'init', label: '/api/init', color: '#ff6b6b' },
+  { key: 'config', label: 'Config + FIFO', color: '#b07cff' },
+];
+// Heartbeats kept per device for the live telemetry: two days at the default 60 s
+const TELEMETRY_CAPACITY = 2880;
+const telemetry = createTelemetry(TELEMETRY_CAPACITY);
+const fmtMs = (ms) => ms == null ? '—' : ms >= 1000 ? `${(ms / 1000).toFixed(2)} s` : `${ms} ms`;
+const fmtUs = (us) => us == null ? '—' : us >= 1000 ? `${(us / 1000).toFixed(1)} ms` : `${us} µs`;
+const TRIGGER_OPTIONS = [
+  { value: 'threshold', label: 'ΔG threshold' },
+  { value: 'sta_lta', label: 'STA/LTA' },
+  { value: 'both', label: 'Either' },
+];
+const METRIC_OPTIONS = [
+  { value: 'max_abs', label: 'Largest axis' },
+  { value: 'horizontal', label: 'Horizontal (X/Y)' },
+  { value: 'vertical', label: 'Vertical (Z)' },
+  { value: 'vector', label: 'Vector magnitude' },
+  { value: 'gravity_vertical', label: 'True vertical (DMP)' },
+  { value: 'gravity_horizontal', label: 'True horizontal (DMP)' },
+];
 
 // ╔══════════════════════════════════════════════════════════════════╗
 // ║  ADMIN / CONFIGURATION PAGE                                      ║
@@ -19,6 +83,8 @@ export default function Admin() {
   const [loading, setLoading] = useState(true);
   const [formDirty, setFormDirty] = useState(false);
   const [reinitDone, setReinitDone] = useState({}); // deviceId -> timestamp
+  const [latency, setLatency] = useState(null);     // /api/latency
+  const [tuning, setTuning] = useState(null);       // /api/tuning: suggested minor per device
 
   // ── Toast helper ───────────────────────────────────────────────
   const addToast = useCallback((message, type = 'info') => {
@@ -28,20 +94,35 @@ export default function Admin() {
   }, []);
 
   // ── Data Fetching ──────────────────────────────────────────────
+  // Status comes once the socket is subscribed, then as devices:status diffs
+  const fetchStatus = useCallback(async () => {
+    try {
+      const res = await fetch('/api/status');
+      if (!res.ok) return;
+      const statuses = await res.json();
+      for (const [id, s] of Object.entries(statuses)) telemetry.feed(id, s);
+      setDeviceStatuses(statuses);
+    } catch (err) {
+      console.error('Admin status fetch error:', err);
+    }
+  }, []);
+
   const fetchAll = useCallback(async () => {
     try {
-      const [cfgRes, statusRes, reinitRes] = await Promise.all([
+      const [cfgRes, reinitRes, latencyRes, tuningRes] = await Promise.all([
         fetch('/api/config'),
-        fetch('/api/status'),
         fetch('/api/config/reinit-status'),
+        fetch('/api/latency'),
+        fetch('/api/tuning'),
       ]);
       if (cfgRes.ok) {
         const cfg = await cfgRes.json();
         // Avoid overwriting in-progress edits
         if (!formDirty) setConfig(cfg);
       }
-      if (statusRes.ok) setDeviceStatuses(await statusRes.json());
       if (reinitRes.ok) setReinitStatus(await reinitRes.json());
+      if (latencyRes.ok) setLatency(await latencyRes.json());
+      if (tuningRes.ok) setTuning(await tuningRes.json());
     } catch (err) {
       console.error('Admin fetch error:', err);
     } finally {
@@ -57,7 +138,13 @@ export default function Admin() {
 
   // ── Socket.IO for real-time reinit updates ─────────────────────
   useEffect(() => {
-    const socket = io(window.location.origin, { transports: ['websocket', 'polling'] });
+    const socket = connectLive({ channels: ['admin'] }, () => { fetchAll(); fetchStatus(); });
+    socket.once('live:resume', fetchStatus);
+
+    // One message for the whole fleet, so other admin tabs mark them in one update
+    socket.on('device:reinit_all_requested', ({ devices }) => {
+      setReinitPending(prev => ({ ...prev, ...Object.fromEntries(devices.map(d => [d.deviceId, true])) }));
+    });
 
     socket.on('device:reinit_sent', ({ id, alias, time }) => {
       addToast(`205 sent to ${alias} — awaiting reboot`, 'warning');
@@ -86,11 +173,13 @@ export default function Admin() {
       fetchAll();
     });
 
-    socket.on('device:heartbeat', ({ id, alias }) => {
-      setDeviceStatuses(prev => ({
-        ...prev,
-        [id]: { ...prev[id], alias, status: 'Online' },
-      }));
+    socket.on('devices:status', ({ devices }) => {
+      for (const [id, diff] of Object.entries(devices)) telemetry.feed(id, diff);
+      setDeviceStatuses(prev => {
+        const next = { ...prev };
+        for (const [id, diff] of Object.entries(devices)) next[id] = { ...prev[id], ...diff };
+        return next;
+      });
     });
 
     socket.on('config:updated', () => {
@@ -99,7 +188,7 @@ export default function Admin() {
     });
 
     return () => socket.disconnect();
-  }, [addToast, fetchAll, formDirty]);
+  }, [addToast, fetchAll, fetchStatus, formDirty]);
 
   // ── Handlers ───────────────────────────────────────────────────
   const updateGlobal = (field, value) => {
@@ -170,12 +259,15 @@ export default function Admin() {
     }
   };
 
-  const requestReinit = async (deviceId) => {
+  // Reinit restores the saved calibration; recalibrate makes the device
+  // re-measure its bias (~4s, sensor must be still)
+  const requestReinit = async (deviceId, recalibrate = false) => {
     setReinitPending(prev => ({ ...prev, [deviceId]: true }));
     try {
-      const res = await fetch(`/api/config/reinit/${encodeURIComponent(deviceId)}`, { method: 'POST' });
+      const query = recalibrate ? '?recalibrate=1' : '';
+      const res = await fetch(`/api/config/reinit/${encodeURIComponent(deviceId)}${query}`, { method: 'POST' });
       if (res.ok) {
-        addToast(`Reinit queued for ${config?.devices?.[deviceId]?.alias || deviceId}`, 'info');
+        addToast(`${recalibrate ? 'Recalibration' : 'Reinit'} queued for ${config?.devices?.[deviceId]?.alias || deviceId}`, 'info');
         fetchAll();
       }
     } catch {
@@ -186,7 +278,7 @@ export default function Admin() {
 
   const requestReinitAll = async () => {
     const ids = Object.keys(config?.devices || {});
-    ids.forEach(id => setReinitPending(prev => ({ ...prev, [id]: true })));
+    setReinitPending(prev => ({ ...prev, ...Object.fromEntries(ids.map(id => [id, true])) }));
     try {
       const res = await fetch('/api/config/reinit-all', { method: 'POST' });
       if (res.ok) {
@@ -255,6 +347,16 @@ export default function Admin() {
               <span className="config-hint">{((config?.heartbeat_interval || 60000) / 1000).toFixed(0)}s between device check-ins</span>
             </div>
 
+            <div className="config-group">
+              <label>Heartbeat Interval with Push (ms)</label>
+              <input
+                type="number"
+                value={config?.push_heartbeat_interval || ''}
+                onChange={e => updateGlobal('push_heartbeat_interval', parseInt(e.target.value) || 120000)}
+              />
+              <span className="config-hint">Used while a device's push channel is up; reinit and config arrive immediately. Over 120s drops trace seconds</span>
+            </div>
+
             <div className="config-group">
               <label>Consensus Window (ms)</label>
               <input
@@ -262,7 +364,55 @@ export default function Admin() {
                 value={config?.consensus_window_ms || ''}
                 onChange={e => updateGlobal('consensus_window_ms', parseInt(e.target.value) || 2000)}
               />
-              <span className="config-hint">Time window for cross-device event confirmation</span>
+              <span className="config-hint">Span of trigger times (device clock) that counts as one event across nodes</span>
+            </div>
+
+            <div className="config-group">
+              <label>Consensus Quorum (nodes)</label>
+              <input
+                type="number"
+                min="0"
+                value={config?.consensus_quorum ?? ''}
+                onChange={e => updateGlobal('consensus_quorum', Math.max(0, parseInt(e.target.value) || 0))}
+              />
+              <span className="config-hint">Distinct registered nodes that must trigger within the window; 0 = all of them</span>
+            </div>
+
+            <div className="config-group">
+              <label>Provisional Alert (nodes)</label>
+              <input
+                type="number"
+                min="0"
+                value={config?.consensus_provisional ?? ''}
+                onChange={e => updateGlobal('consensus_provisional', Math.max(0, parseInt(e.target.value) || 0))}
+              />
+              <span className="config-hint">Nodes for an early seismic:consensus_provisional before the quorum is in, retracted if it never is; 0 = off</span>
+            </div>
+
+            <div className="config-group">
+              <label>Consensus Coherence (r)</label>
+              <input
+                type="number"
+                min="0"
+                max="1"
+                step="0.05"
+                placeholder="off"
+                value={config?.consensus_coherence ?? ''}
+                onChange={e => updateGlobal('consensus_coherence', e.target.value === '' ? null : parseFloat(e.target.value))}
+              />
+              <span className="config-hint">Confirm only when the nodes' waveform envelopes correlate at least this well (e.g. 0.5); blank confirms on timing alone</span>
+            </div>
+
+            <div className="config-group">
+              <label>Locate Velocity (m/s)</label>
+              <input
+                type="number"
+                min="0"
+                placeholder="direction only"
+                value={config?.locate_velocity_m_s ?? ''}
+                onChange={e => updateGlobal('locate_velocity_m_s', e.target.value === '' ? null : parseFloat(e.target.value))}
+              />
+              <span className="config-hint">Wave speed for locating a consensus from 4+ nodes with coordinates; blank gives only its direction (3+ nodes)</span>
             </div>
 
             <div className="config-group">
@@ -307,6 +457,155 @@ export default function Admin() {
                 />
               </div>
             </div>
+
+            <div className="config-divider" />
+            <h3 className="config-section-title">Acquisition</h3>
+            <span className="config-hint">Applied at device boot — reinitialize devices after saving</span>
+
+            <div className="sensitivity-row">
+              <div className="config-group">
+                <label>Sample Rate (Hz)</label>
+                <input
+                  type="number"
+                  value={config?.sample_rate_hz ?? ''}
+                  onChange={e => updateGlobal('sample_rate_hz', parseInt(e.target.value) || 100)}
+                />
+              </div>
+              <div className="config-group">
+                <label>DLPF</label>
+                <select
+                  value={config?.dlpf ?? 1}
+                  onChange={e => updateGlobal('dlpf', parseInt(e.target.value))}
+                >
+                  {DLPF_OPTIONS.map(o => <option key={o.value} value={o.value}>{o.label}</option>)}
+                </select>
+              </div>
+            </div>
+            <div className="sensitivity-row">
+              <div className="config-group">
+                <label>Pre-trigger (ms)</label>
+                <input
+                  type="number"
+                  value={config?.pre_ms ?? ''}
+                  onChange={e => updateGlobal('pre_ms', parseInt(e.target.value) || 0)}
+                />
+              </div>
+              <div className="config-group">
+                <label>Post-trigger (ms)</label>
+                <input
+                  type="number"
+                  value={config?.post_ms ?? ''}
+                  onChange={e => updateGlobal('post_ms', parseInt(e.target.value) || 3000)}
+                />
+              </div>
+              <div className="config-group">
+                <label>Max post, retriggered (ms)</label>
+                <input
+                  type="number"
+                  value={config?.max_post_ms ?? ''}
+                  onChange={e => updateGlobal('max_post_ms', parseInt(e.target.value) || 12000)}
+                />
+              </div>
+              <div className="config-group">
+                <label>NTP server</label>
+                <input
+                  type="text"
+                  value={config?.ntp_server ?? ''}
+                  onChange={e => updateGlobal('ntp_server', e.target.value || 'pool.ntp.org')}
+                />
+              </div>
+            </div>
+            <div className="sensitivity-row">
+              <div className="config-group">
+                <label>Trigger</label>
+                <select
+                  value={config?.trigger_mode ?? 'threshold'}
+                  onChange={e => updateGlobal('trigger_mode', e.target.value)}
+                >
+                  {TRIGGER_OPTIONS.map(o => <option key={o.value} value={o.value}>{o.label}</option>)}
+                </select>
+              </div>
+              <div className="config-group">
+                <label>ΔG metric</label>
+                <select
+                  value={config?.detect_metric ?? 'max_abs'}
+                  onChange={e => updateGlobal('detect_metric', e.target.value)}
+                >
+                  {METRIC_OPTIONS.map(o => <option key={o.value} value={o.value}>{o.label}</option>)}
+                </select>
+              </div>
+              <div className="config-group">
+                <label>STA / LTA (ms)</label>
+                <input
+                  type="number"
+                  value={config?.sta_ms ?? ''}
+                  onChange={e => updateGlobal('sta_ms', parseInt(e.target.value) || 500)}
+                />
+                <input
+                  type="number"
+                  value={config?.lta_ms ?? ''}
+                  onChange={e => updateGlobal('lta_ms', parseInt(e.target.value) || 30000)}
+                />
+              </div>
+              <div className="config-group">
+                <label>On / Off ratio</label>
+                <input
+                  type="number"
+                  step="0.1"
+                  value={config?.sta_lta_on ?? ''}
+                  onChange={e => updateGlobal('sta_lta_on', parseFloat(e.target.value) || 4)}
+                />
+                <input
+                  type="number"
+                  step="0.1"
+                  value={config?.sta_lta_off ?? ''}
+                  onChange={e => updateGlobal('sta_lta_off', parseFloat(e.target.value) || 1.5)}
+                />
+              </div>
+              <div className="config-group">
+                <label>High / Low-pass (Hz, 0 = off)</label>
+                <input
+                  type="number"
+                  step="0.05"
+                  value={config?.hp_hz ?? ''}
+                  onChange={e => updateGlobal('hp_hz', parseFloat(e.target.value) || 0)}
+                />
+                <input
+                  type="number"
+                  step="1"
+                  value={config?.lp_hz ?? ''}
+                  onChange={e => updateGlobal('lp_hz', parseFloat(e.target.value) || 0)}
+                />
+              </div>
+              <div className="config-group">
+                <label>Bias tracking (s, 0 = off)</label>
+                <input
+                  type="number"
+                  value={config?.bias_track_s ?? ''}
+                  onChange={e => updateGlobal('bias_track_s', parseInt(e.target.value) || 0)}
+                />
+              </div>
+              <div className="config-group">
+                <label>Capture spectrum</label>
+                <select
+                  value={config?.spectrum ? 'on' : 'off'}
+                  onChange={e => updateGlobal('spectrum', e.target.value === 'on')}
+                >
+                  <option value="off">Off</option>
+                  <option value="on">Goertzel bands</option>
+                </select>
+              </div>
+              <div className="config-group">
+                <label>Local diagnostics</label>
+                <select
+                  value={config?.local_http ? 'on' : 'off'}
+                  onChange={e => updateGlobal('local_http', e.target.value === 'on')}
+                >
+                  <option value="off">Off</option>
+                  <option value="on">HTTP /status, /live</option>
+                </select>
+              </div>
+            </div>
           </div>
         </div>
 
@@ -352,6 +651,51 @@ export default function Admin() {
           </div>
         </div>
 
+        {/* ─── Detection Latency ───────────────────────────── */}
+        {latency?.count > 0 && (
+          <div className="admin-panel latency-panel">
+            <div className="panel-header">Detection Latency</div>
+            <div className="panel-body">
+              <p className="config-hint" style={{ marginBottom: 12 }}>
+                Where the time goes from a trigger to the dashboard, over the last {latency.count} events.
+                Capture includes the post-trigger window; the bar runs from p50 to p99.
+              </p>
+              <table className="profile-table">
+                <thead>
+                  <tr><th>Stage</th><th>Events</th><th>p50</th><th>p90</th><th>p99</th><th>Max</th><th /></tr>
+                </thead>
+                <tbody>
+                  {(() => {
+                    const scale = Math.max(1, ...Object.values(latency.stages).map(st => st.p99));
+                    return LATENCY_STAGES.filter(st => latency.stages[st.key]).map(st => {
+                      const q = latency.stages[st.key];
+                      return (
+                        <tr key={st.key}>
+                          <td>{st.label}</td>
+                          <td className="mono">{q.n}</td>
+                          <td className="mono">{fmtMs(q.p50)}</td>
+                          <td className="mono">{fmtMs(q.p90)}</td>
+                          <td className="mono">{fmtMs(q.p99)}</td>
+                          <td className="mono">{fmtMs(q.max)}</td>
+                          <td className="latency-bar-cell">
+                            <span className="latency-bar" style={{
+                              marginLeft: `${(q.p50 / scale) * 100}%`,
+                              width: `${Math.max(1, ((q.p99 - q.p50) / scale) * 100)}%`,
+                            }} />
+                          </td>
+                        </tr>
+                      );
+                    });
+                  })()}
+                </tbody>
+              </table>
+            </div>
+          </div>
+        )}
+
+        {/* ─── Soak Tests ──────────────────────────────────── */}
+        <SoakPanel devices={devices} addToast={addToast} />
+
         {/* ─── Per-Device Cards ────────────────────────────── */}
         {Object.entries(devices).map(([id, dev]) => {
           const status = deviceStatuses[id] || {};
@@ -365,7 +709,8 @@ export default function Admin() {
           const doneRecently = (reinitDone[id] && (Date.now() - reinitDone[id] < 90 * 1000)) ||
                                (lastInitMs && (Date.now() - lastInitMs < 90 * 1000));
           const isBlocked = !!reinitPhase; // only block during active phases
-          const hasOverride = dev.heartbeat_interval != null || (dev.sensitivity && Object.values(dev.sensitivity).some(v => v != null));
+          const hasOverride = dev.heartbeat_interval != null || (dev.sensitivity && Object.values(dev.sensitivity).some(v => v != null)) ||
+                              ACQUISITION_KEYS.some(k => dev[k] != null);
 
           return (
             <div key={id} className={`admin-panel device-panel ${isOnline ? 'device-online' : 'device-offline'}`}>
@@ -375,17 +720,28 @@ export default function Admin() {
                   <span className="device-alias">{dev.alias || id}</span>
                   {hasOverride && <span className="override-badge">OVERRIDE</span>}
                 </div>
-                <button
-                  className={`reinit-btn ${doneRecently ? 'done' : isBlocked ? 'pending' : ''}`}
-                  onClick={() => requestReinit(id)}
-                  disabled={isBlocked}
-                >
-                  {doneRecently ? '✓ Reinitialized'
-                    : reinitPhase === 'requesting' ? '⏳ Sending...'
-                    : reinitPhase === 'pending' ? '⏳ Waiting for heartbeat...'
-                    : reinitPhase === 'sent' ? '🔄 Rebooting...'
-                    : '⟳ Reinit'}
-                </button>
+                <div className="device-header-actions">
+                  {!isBlocked && (
+                    <button
+                      className="reinit-btn"
+                      onClick={() => requestReinit(id, true)}
+                      title="Reboot and re-measure the at-rest bias (keep the sensor still)"
+                    >
+                      ⊙ Recalibrate
+                    </button>
+                  )}
+                  <button
+                    className={`reinit-btn ${doneRecently ? 'done' : isBlocked ? 'pending' : ''}`}
+                    onClick={() => requestReinit(id)}
+                    disabled={isBlocked}
+                  >
+                    {doneRecently ? '✓ Reinitialized'
+                      : reinitPhase === 'requesting' ? '⏳ Sending...'
+                      : reinitPhase === 'pending' ? '⏳ Waiting for heartbeat...'
+                      : reinitPhase === 'sent' ? '🔄 Rebooting...'
+                      : '⟳ Reinit'}
+                  </button>
+                </div>
               </div>
               <div className="panel-body">
                 <div className="device-info-row">
@@ -413,6 +769,233 @@ export default function Admin() {
                       </span>
                     </div>
                   )}
+                  {status.ota && (
+                    <div className="device-info">
+                      <span className="info-label">Last OTA</span>
+                      <span className="info-value mono">
+                        {status.ota.result} · {(status.ota.bytes / 1024).toFixed(0)} KB in {(status.ota.ms / 1000).toFixed(1)}s
+                        {status.ota.kbps != null && ` (${status.ota.kbps} kbit/s)`}
+                      </span>
+                    </div>
+                  )}
+                  {status.blackbox?.oldest_ms && (
+                    <div className="device-info">
+                      <span className="info-label">Black Box</span>
+                      <span className="info-value mono">
+                        since {new Date(status.blackbox.oldest_ms).toLocaleString()} ·{' '}
+                        {((status.blackbox.newest_ms - status.blackbox.oldest_ms) / 3600000).toFixed(1)} h
+                        {status.blackbox.dropped_blocks > 0 && ` · ${status.blackbox.dropped_blocks} blocks dropped`}
+                      </span>
+                    </div>
+                  )}
+                  {status.uploads && (
+                    <div className="device-info">
+                      <span className="info-label">Upload Queue</span>
+                      <span className="info-value mono">
+                        {status.uploads.queued} queued ({(status.uploads.queued_bytes / 1024).toFixed(1)} KB, {status.uploads.state})
+                        {status.uploads.spilled > 0 && ` · ${status.uploads.spilled} journaled`}
+                        {status.uploads.streamed > 0 && ` · ${status.uploads.streamed} blocking`}
+                        {status.uploads.dropped > 0 && ` · ${status.uploads.dropped} dropped`}
+                      </span>
+                    </div>
+                  )}
+                  {status.evictions && (
+                    <div className="device-info">
+                      <span className="info-label">Dropped Unsent</span>
+                      <span className="info-value mono">
+                        {status.evictions.total} event{status.evictions.total === 1 ? '' : 's'}
+                        {status.evictions.recent.length > 0 &&
+                          ` · ${status.evictions.recent.slice(0, 4).map(e => `#${e.seq} ${e.level}`).join(', ')}`}
+                      </span>
+                    </div>
+                  )}
+                  {status.mqtt && (
+                    <div className="device-info">
+                      <span className="info-label">MQTT</span>
+                      <span className="info-value mono">
+                        {status.mqtt.connected ? 'connected' : 'down'} · {status.mqtt.acked}/{status.mqtt.published} acked
+                        {status.mqtt.connects > 1 && ` · ${status.mqtt.connects} connects`}
+                        {status.mqtt.failed > 0 && ` · ${status.mqtt.failed} failed`}
+                        {status.mqtt.dropped > 0 && ` · ${status.mqtt.dropped} dropped`}
+                      </span>
+                    </div>
+                  )}
+                  {status.tls && (
+                    <div className="device-info">
+                      <span className="info-label">TLS</span>
+                      <span className="info-value mono">
+                        {status.tls.full} full{status.tls.full_avg_ms != null && ` (${status.tls.full_avg_ms} ms)`} ·{' '}
+                        {status.tls.resumed} resumed{status.tls.resumed_avg_ms != null && ` (${status.tls.resumed_avg_ms} ms)`}
+                        {status.tls.failures > 0 && ` · ${status.tls.failures} failed`}
+                        {!status.tls.fragment_limited && ' · 16KB buffers'}
+                      </span>
+                    </div>
+                  )}
+                </div>
+
+                <DeviceTelemetry id={id} telemetry={telemetry} boots={status.boots} />
+
+                {status.profile && (
+                  <>
+                    <div className="config-divider" />
+                    <h4 className="config-section-title">
+                      Loop Timing <span className="config-hint">(last heartbeat window)</span>
+                    </h4>
+                    <table className="profile-table">
+                      <thead>
+                        <tr><th>Phase</th><th>Count</th><th>Avg</th><th>p95 ≤</th><th>Max</th></tr>
+                      </thead>
+                      <tbody>
+                        {PROFILE_PHASES.filter(p => status.profile.phases?.[p.key]).map(p => {
+                          const ph = status.profile.phases[p.key];
+                          return (
+                            <tr key={p.key}>
+                              <td>{p.label}</td>
+                              <td className="mono">{ph.n}</td>
+                              <td className="mono">{fmtUs(ph.avg_us)}</td>
+                              <td className="mono">{ph.p95_us == null ? '>131 ms' : fmtUs(ph.p95_us)}</td>
+                              <td className="mono">{fmtUs(ph.max_us)}</td>
+                            </tr>
+                          );
+                        })}
+                      </tbody>
+                    </table>
+                    {status.profile.intervals && (
+                      <div className="device-info-row">
+                        <div className="device-info">
+                          <span className="info-label">Sample interval</span>
+                          <span className="info-value mono">
+                            {status.profile.intervals.min_ms}–{status.profile.intervals.max_ms} ms
+                          </span>
+                        </div>
+                        <div className="device-info">
+                          <span className="info-label">Within ±1 ms</span>
+                          <span className="info-value mono">{status.profile.intervals.within_1ms_pct ?? '—'}%</span>
+                        </div>
+                        <div className="device-info">
+                          <span className="info-label">Jitter (ms: count)</span>
+                          <span className="info-value mono">
+                            {status.profile.intervals.buckets
+                              .map((c, k) => c ? `${status.profile.intervals.labels[k]}: ${c}` : null)
+                              .filter(Boolean).join(' · ')}
+                          </span>
+                        </div>
+                      </div>
+                    )}
+                  </>
+                )}
+
+                {status.boots?.length > 0 && (() => {
+                  const boots = [...status.boots].reverse();
+                  const longest = Math.max(...boots.map(b => b.total_ms), 1);
+                  return (
+                    <>
+                      <div className="config-divider" />
+                      <h4 className="config-section-title">
+                        Boot Timing <span className="config-hint">(newest first; {BOOT_PHASES.map(p => (
+                          <span key={p.key} className="boot-legend">
+                            <span className="boot-swatch" style={{ background: p.color }} />{p.label}
+                          </span>
+                        ))})</span>
+                      </h4>
+                      <table className="profile-table">
+                        <thead>
+                          <tr><th>When</th><th>Reset</th><th>Wi-Fi</th><th>Total</th><th /></tr>
+                        </thead>
+                        <tbody>
+                          {boots.map(b => (
+                            <tr key={b.time}>
+                              <td className="mono">{new Date(b.time).toLocaleString()}</td>
+                              <td className="mono">{b.reset ?? '—'}</td>
+                              <td className="mono">
+                                {fmtMs(b.wifi_assoc_ms)}{b.wifi_path && ` (${b.wifi_path})`}
+                              </td>
+                              <td className="mono">{fmtMs(b.total_ms)}</td>
+                              <td className="latency-bar-cell">
+                                <span className="boot-bar" style={{ width: `${100 * b.total_ms / longest}%` }}
+                                  title={BOOT_PHASES.map(p => `${p.label}: ${fmtMs(b.phases[p.key])}`).join('\n')}>
+                                  {BOOT_PHASES.map(p => (
+                                    <span key={p.key} style={{
+                                      background: p.color,
+                                      width: `${100 * (b.phases[p.key] || 0) / Math.max(b.total_ms, 1)}%`,
+                                    }} />
+                                  ))}
+                                </span>
+                              </td>
+                            </tr>
+                          ))}
+                        </tbody>
+                      </table>
+                    </>
+                  );
+                })()}
+
+                {status.tasks && (
+                  <>
+                    <div className="config-divider" />
+                    <h4 className="config-section-title">
+                      Loop Tasks <span className="config-hint">(last heartbeat window)</span>
+                    </h4>
+                    <table className="profile-table">
+                      <thead>
+                        <tr><th>Task</th><th>Runs</th><th>Late</th><th>Over budget</th><th>Max</th></tr>
+                      </thead>
+                      <tbody>
+                        {Object.entries(status.tasks.tasks).map(([name, t]) => (
+                          <tr key={name}>
+                            <td>{name}</td>
+                            <td className="mono">{t.runs}</td>
+                            <td className="mono">{t.late}</td>
+                            <td className="mono">{t.overruns}</td>
+                            <td className="mono">{fmtUs(t.max_us)}</td>
+                          </tr>
+                        ))}
+                      </tbody>
+                    </table>
+                  </>
+                )}
+
+                <div className="config-divider" />
+                <h4 className="config-section-title">
+                  Placement <span className="config-hint">(devices in a group confirm each other)</span>
+                </h4>
+                <div className="sensitivity-row">
+                  <div className="config-group">
+                    <label>Site</label>
+                    <input
+                      type="text"
+                      placeholder="—"
+                      value={dev.site ?? ''}
+                      onChange={e => updateDevice(id, 'site', e.target.value || null)}
+                    />
+                  </div>
+                  <div className="config-group">
+                    <label>Consensus Group</label>
+                    <input
+                      type="text"
+                      placeholder="default"
+                      value={dev.group ?? ''}
+                      onChange={e => updateDevice(id, 'group', e.target.value || null)}
+                    />
+                  </div>
+                  <div className="config-group">
+                    <label>Latitude</label>
+                    <input
+                      type="number"
+                      step="0.00001"
+                      value={dev.lat ?? ''}
+                      onChange={e => updateDevice(id, 'lat', e.target.value === '' ? null : parseFloat(e.target.value))}
+                    />
+                  </div>
+                  <div className="config-group">
+                    <label>Longitude</label>
+                    <input
+                      type="number"
+                      step="0.00001"
+                      value={dev.lon ?? ''}
+                      onChange={e => updateDevice(id, 'lon', e.target.value === '' ? null : parseFloat(e.target.value))}
+                    />
+                  </div>
                 </div>
 
                 <div className="config-divider" />
@@ -438,6 +1021,14 @@ export default function Admin() {
                       value={dev.sensitivity?.minor ?? ''}
                       onChange={e => updateDeviceSensitivity(id, 'minor', e.target.value)}
                     />
+                    {tuning?.devices?.[id]?.proposed != null && tuning.devices[id].proposed !== dev.sensitivity?.minor && (
+                      <span className="config-hint">
+                        Noise p99.9 {tuning.devices[id].noise.p999}g, {tuning.devices[id].lone_per_hour} lone/h → {' '}
+                        <button className="tuning-use" onClick={() => updateDeviceSensitivity(id, 'minor', String(tuning.devices[id].proposed))}>
+                          use {tuning.devices[id].proposed}
+                        </button>
+                      </span>
+                    )}
                   </div>
                   <div className="config-group">
                     <label className="level-moderate">Moderate</label>
@@ -460,6 +1051,100 @@ export default function Admin() {
                     />
                   </div>
                 </div>
+
+                <div className="sensitivity-row">
+                  <div className="config-group">
+                    <label>Rate (Hz)</label>
+                    <input
+                      type="number"
+                      placeholder={`${config?.sample_rate_hz ?? 100}`}
+                      value={dev.sample_rate_hz ?? ''}
+                      onChange={e => updateDevice(id, 'sample_rate_hz', e.target.value === '' ? null : parseInt(e.target.value))}
+                    />
+                  </div>
+                  <div className="config-group">
+                    <label>DLPF</label>
+                    <select
+                      value={dev.dlpf ?? ''}
+                      onChange={e => updateDevice(id, 'dlpf', e.target.value === '' ? null : parseInt(e.target.value))}
+                    >
+                      <option value="">Global</option>
+                      {DLPF_OPTIONS.map(o => <option key={o.value} value={o.value}>{o.label}</option>)}
+                    </select>
+                  </div>
+                  <div className="config-group">
+                    <label>Pre (ms)</label>
+                    <input
+                      type="number"
+                      placeholder={`${config?.pre_ms ?? 3000}`}
+                      value={dev.pre_ms ?? ''}
+                      onChange={e => updateDevice(id, 'pre_ms', e.target.value === '' ? null : parseInt(e.target.value))}
+                    />
+                  </div>
+                  <div className="config-group">
+                    <label>Post (ms)</label>
+                    <input
+                      type="number"
+                      placeholder={`${config?.post_ms ?? 3000}`}
+                      value={dev.post_ms ?? ''}
+                      onChange={e => updateDevice(id, 'post_ms', e.target.value === '' ? null : parseInt(e.target.value))}
+                    />
+                  </div>
+                </div>
+
+                <div className="sensitivity-row">
+                  <div className="config-group">
+                    <label>Stream</label>
+                    <select
+                      value={dev.stream_mode ?? ''}
+                      onChange={e => updateDevice(id, 'stream_mode', e.target.value || null)}
+                    >
+                      <option value="">Global ({config?.stream_mode ?? 'off'})</option>
+                      <option value="off">Off (events only)</option>
+                      <option value="udp">UDP continuous</option>
+                    </select>
+                  </div>
+                  <div className="config-group">
+                    <label>Stream rate (Hz)</label>
+                    <input
+                      type="number"
+                      step="0.1"
+                      placeholder={`${config?.stream_hz ?? 10}`}
+                      value={dev.stream_hz ?? ''}
+                      onChange={e => updateDevice(id, 'stream_hz', e.target.value === '' ? null : parseFloat(e.target.value))}
+                    />
+                  </div>
+                  <div className="config-group">
+                    <label>Spectrum</label>
+                    <select
+                      value={dev.spectrum == null ? '' : dev.spectrum ? 'on' : 'off'}
+                      onChange={e => updateDevice(id, 'spectrum', e.target.value === '' ? null : e.target.value === 'on')}
+                    >
+                      <option value="">Global ({config?.spectrum ? 'on' : 'off'})</option>
+                      <option value="off">Off</option>
+                      <option value="on">On</option>
+                    </select>
+                  </div>
+                  <div className="config-group">
+                    <label>Local HTTP</label>
+                    <select
+                      value={dev.local_http == null ? '' : dev.local_http ? 'on' : 'off'}
+                      onChange={e => updateDevice(id, 'local_http', e.target.value === '' ? null : e.target.value === 'on')}
+                    >
+                      <option value="">Global ({config?.local_http ? 'on' : 'off'})</option>
+                      <option value="off">Off</option>
+                      <option value="on">On</option>
+                    </select>
+                  </div>
+                  {status.stream && (
+                    <div className="device-info">
+                      <span className="info-label">Datagrams</span>
+                      <span className="info-value mono">
+                        {status.stream.received} received · {status.stream.lost} lost
+                      </span>
+                    </div>
+                  )}
+                </div>
               </div>
             </div>
           );
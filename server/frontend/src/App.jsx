@@ -1,16 +1,37 @@
-import { useState, useEffect, useMemo, useCallback, useRef } from 'react';
+import { useState, useEffect, useMemo, useCallback, useRef, Suspense, lazy } from 'react';
 import { useNavigate } from 'react-router-dom';
-import { io } from 'socket.io-client';
 import {
   ResponsiveContainer, ScatterChart, Scatter, XAxis, YAxis,
-  CartesianGrid, Tooltip, Legend, ReferenceLine, ReferenceArea, Customized,
-  LineChart, Line,
+  CartesianGrid, Legend, ReferenceLine, ReferenceArea, Customized,
 } from 'recharts';
+import { EVENTS_CONTENT_TYPE } from './columnar';
+import { connectLive } from './live';
+import ScatterLayer, { webglSupported } from './ScatterLayer';
+import { LEVELS, eventIndex as makeEventIndex, indexColumns } from './eventIndex';
+import { createEventStore } from './eventStore';
+import { createWaveformCache } from './waveformCache';
+import VirtualTable from './VirtualTable';
+import DensityLayer from './DensityLayer';
+
+// Loaded on first use, not with the dashboard: the modal's plot is asked
+// for as soon as a waveform is prefetched, so it is in by the click
+const loadWaveformPlot = () => import('./WaveformPlot');
+const WaveformPlot = lazy(loadWaveformPlot);
+const LiveSeismograph = lazy(() => import('./LiveSeismograph'));
 
 // ╔══════════════════════════════════════════════════════════════════╗
 // ║  CONSTANTS                                                       ║
 // ╚══════════════════════════════════════════════════════════════════╝
 const POLL_FALLBACK_MS = 60_000;
+const EVENTS_PAGE = 5000;   // /api/events page size for the first load
+const WAVEFORM_CACHE_SAMPLES = 1_000_000;   // full captures kept for the modal, 20 bytes a sample
+const HOVER_PREFETCH_MS = 150;   // hover dwell before the point's waveforms are fetched
+// Visible events before the scatter switches to /api/events/downsampled:
+// the WebGL layer redraws 100k points within a frame, the 2D fallback doesn't
+const DOWNSAMPLE_ABOVE = webglSupported ? 100_000 : 4000;
+// Visible span above which density mode draws the rollup heatmap; below it
+// the chart drills down to the events themselves
+const DENSITY_ABOVE_MS = 3 * 86_400_000;
 
 const DEVICE_COLORS = {
   'Ryan Office': '#00ff88',
@@ -30,6 +51,7 @@ const PERIODS = [
   { key: '15d', label: '15D', ms: 1_296_000_000 },
   { key: '30d', label: '30D', ms: 2_592_000_000 },
 ];
+const MAX_PERIOD_MS = Math.max(...PERIODS.map(p => p.ms));
 
 const TIMEZONES = [
   { value: 'UTC',                 label: 'UTC' },
@@ -89,24 +111,51 @@ function deviceColor(alias) {
   return DEVICE_COLORS[alias] || '#888';
 }
 
+const waveforms = createWaveformCache(WAVEFORM_CACHE_SAMPLES);
+
+// What the event store worker posts before it has anything
+const EMPTY_VIEW = (() => {
+  const time = new Float64Array(0), deltaG = new Float64Array(0), level = new Uint8Array(0);
+  return { version: 0, from: 0, time, deltaG, level, trigger: new Uint8Array(0), device: new Uint16Array(0),
+           waveform: new Uint8Array(0), seq: new Uint32Array(0), devices: [], triggers: [],
+           index: indexColumns(deltaG, level, 0), consensus: [] };
+})();
+
+// Whole period, newest first, a keyset page at a time -> { pages, changesCursor }.
+// Pages stay undecoded ({ buffer } or { text }) for the event store worker.
+async function fetchEventPages(sinceIso) {
+  const pages = [];
+  let after = null, changesCursor = null;
+  for (;;) {
+    const q = `since=${encodeURIComponent(sinceIso)}&limit=${EVENTS_PAGE}` +
+      (after ? `&after=${encodeURIComponent(after)}` : '');
+    const res = await fetch(`/api/events?${q}`, { headers: { Accept: `${EVENTS_CONTENT_TYPE}, application/json;q=0.5` } });
+    if (!res.ok) break;
+    changesCursor ??= res.headers.get('X-Changes-Cursor');
+    const columns = (res.headers.get('Content-Type') || '').startsWith(EVENTS_CONTENT_TYPE);
+    pages.push(columns ? { buffer: await res.arrayBuffer() } : { text: await res.text() });
+    after = res.headers.get('X-Next-Cursor');
+    if (!after) break;
+  }
+  return { pages, changesCursor };
+}
+
+// Everything created or updated since cursor -> { events, cursor } (null on failure)
+async function fetchEventChanges(cursor) {
+  const events = [];
+  for (;;) {
+    const res = await fetch(`/api/events/changes?cursor=${encodeURIComponent(cursor)}`);
+    if (!res.ok) return null;
+    const page = await res.json();
+    events.push(...page.events);
+    cursor = page.cursor;
+    if (!page.more) return { events, cursor };
+  }
+}
+
 // ╔══════════════════════════════════════════════════════════════════╗
 // ║  CUSTOM TOOLTIPS                                                 ║
 // ╚══════════════════════════════════════════════════════════════════╝
-function DeltaTooltip({ active, payload, tz }) {
-  if (!active || !payload?.[0]) return null;
-  const d = payload[0].payload;
-  return (
-    <div className="chart-tooltip">
-      <div className="tooltip-title" style={{ color: deviceColor(d.alias) }}>{d.alias}</div>
-      <div className="tooltip-row">
-        Level: <span style={{ color: LEVEL_COLORS[d.level] }}>{d.level}</span>
-      </div>
-      <div className="tooltip-row">ΔG: <strong>{d.deltaG?.toFixed(4)}</strong></div>
-      <div className="tooltip-time">{fmtTs(d._time, tz)}</div>
-    </div>
-  );
-}
-
 function ActivityTooltip({ active, payload, label, tz }) {
   if (!active || !payload?.length) return null;
   return (
@@ -139,19 +188,26 @@ function Panel({ title, children, className = '' }) {
 export default function App() {
   // ── State ──────────────────────────────────────────────────────
   const navigate = useNavigate();
-  const [events, setEvents] = useState([]);
+  const [view, setView] = useState(EMPTY_VIEW);   // events.worker.js output
+  const storeRef = useRef(null);
   const [statuses, setStatuses] = useState({});
-  const [httpLogs, setHttpLogs] = useState([]);
+  const [httpLogs, setHttpLogs] = useState(null); // per-endpoint, per-minute request counts
   const [serverInfo, setServerInfo] = useState(null);
   const [period, setPeriod] = useState('7d');
   const [timezone, setTimezone] = useState('America/New_York');
   const [loading, setLoading] = useState(true);
   const [lastRefresh, setLastRefresh] = useState(null);
   const [wsConnected, setWsConnected] = useState(false);
+  const [rollup, setRollup] = useState(null); // { bucket, as_of, rows } for the multi-day periods
+  const [downsampled, setDownsampled] = useState(null); // scatter points from the server, or null to plot every event
+  const [density, setDensity] = useState(false);          // density mode chosen
+  const [densityGrid, setDensityGrid] = useState(null);   // /api/events/density answer while it is drawn
   // ── Interactivity state ─────────────────────────────────────
   const [deviceFilters, setDeviceFilters] = useState({}); // alias -> bool
   const [levelFilters, setLevelFilters] = useState({ minor: true, moderate: true, severe: true });
   const [showConsensus, setShowConsensus] = useState(true);
+  const [showLive, setShowLive] = useState(false);   // rolling UDP stream panel
+  const [liveSocket, setLiveSocket] = useState(null);
   const [xZoomDomain, setXZoomDomain] = useState(null); // [min, max]
   const [refAreaStart, setRefAreaStart] = useState(null);
   const [refAreaEnd, setRefAreaEnd] = useState(null);
@@ -169,40 +225,87 @@ export default function App() {
   const commitDragRef = useRef(null);
   const [selectionRect, setSelectionRect] = useState(null);
   const [isDragging, setIsDragging] = useState(false);
-  const [waveformData, setWaveformData] = useState(null); // loaded waveform samples
+  const [waveformData, setWaveformData] = useState(null); // waveformCache entry: typed arrays
   const [waveformLoading, setWaveformLoading] = useState(false);
   const [waveformView, setWaveformView] = useState('axes'); // 'axes' | 'deltag'
+  const [waveformOverlay, setWaveformOverlay] = useState(false); // the consensus's other nodes too
+  const [overlaySeries, setOverlaySeries] = useState(null);
 
-  // Auto-fetch waveform when modal opens for an event that has waveform data
+  // Load the waveform when the modal opens for an event that has one;
+  // hovered and freshly pushed events are usually in the cache already
   useEffect(() => {
     if (!modalEvent?.has_waveform || !modalEvent?._id) { setWaveformData(null); return; }
+    const cached = waveforms.peek(modalEvent._id);
+    if (cached) {
+      setWaveformData(cached);
+      setWaveformLoading(false);
+    }
     let cancelled = false;
-    setWaveformLoading(true);
-    fetch(`/api/events/${modalEvent._id}/waveform`)
-      .then(r => r.ok ? r.json() : null)
-      .then(data => {
-        if (cancelled || !data?.waveform) return;
-        setWaveformData(data.waveform.map(s => ({
-          t: s[0], ax: s[1], ay: s[2], az: s[3],
-          dg: Math.max(Math.abs(s[1]), Math.abs(s[2]), Math.abs(s[3])),
-        })));
+    if (!cached) setWaveformLoading(true);
+    waveforms.get(modalEvent._id)
+      .then(entry => {
+        if (cancelled || !entry) return;
+        setWaveformData(entry);
       })
-      .catch(() => {})
       .finally(() => { if (!cancelled) setWaveformLoading(false); });
     return () => { cancelled = true; };
   }, [modalEvent]);
 
   // ── Data Fetching ──────────────────────────────────────────────
+  // The event list lives in a worker; what comes back is the period's view
+  useEffect(() => {
+    const store = createEventStore(setView, MAX_PERIOD_MS);
+    storeRef.current = store;
+    return () => store.close();
+  }, []);
+
+  // First load pages through the longest period; later polls only ask for
+  // what changed since the cursor the server handed back. The very first
+  // starts from the last session's snapshot instead when there is one
+  // (snapshot.js), so a reload draws at once and then only catches up.
+  const changesCursorRef = useRef(null);
+  const restoredRef = useRef(null);
+  const fetchEventsIncremental = useCallback(async () => {
+    restoredRef.current ??= storeRef.current.restore().then((snap) => {
+      if (!snap) return;
+      changesCursorRef.current = snap.cursor;
+      setLastRefresh(snap.savedAt);
+      setLoading(false);
+    });
+    await restoredRef.current;
+    if (changesCursorRef.current) {
+      const changes = await fetchEventChanges(changesCursorRef.current);
+      if (changes) {
+        changesCursorRef.current = changes.cursor;
+        storeRef.current.merge(changes.events);
+        storeRef.current.snapshot(changes.cursor);
+        return;
+      }
+    }
+    const { pages, changesCursor } = await fetchEventPages(new Date(Date.now() - MAX_PERIOD_MS).toISOString());
+    changesCursorRef.current = changesCursor;
+    storeRef.current.load(pages);   // keeps anything a socket pushed meanwhile
+    if (changesCursor) storeRef.current.snapshot(changesCursor);
+  }, []);
+
+  // Device status isn't polled: it's fetched once the socket is subscribed
+  // (or couldn't resume), and devices:status keeps it current from there
+  const fetchStatus = useCallback(async () => {
+    try {
+      const res = await fetch('/api/status');
+      if (res.ok) setStatuses(await res.json());
+    } catch (err) {
+      console.error('Status fetch error:', err);
+    }
+  }, []);
+
   const fetchAll = useCallback(async () => {
     try {
-      const [evRes, statRes, httpRes, infoRes] = await Promise.all([
-        fetch('/api/events'),
-        fetch('/api/status'),
+      const [, httpRes, infoRes] = await Promise.all([
+        fetchEventsIncremental(),
         fetch('/api/http_logs'),
         fetch('/api/info'),
       ]);
-      if (evRes.ok) setEvents(await evRes.json());
-      if (statRes.ok) setStatuses(await statRes.json());
       if (httpRes.ok) setHttpLogs(await httpRes.json());
       if (infoRes.ok) setServerInfo(await infoRes.json());
       setLastRefresh(Date.now());
@@ -211,18 +314,40 @@ export default function App() {
     } finally {
       setLoading(false);
     }
-  }, []);
+  }, [fetchEventsIncremental]);
 
   useEffect(() => {
     fetchAll();
+    fetchStatus();
     // Fallback poll every 60s (real-time handles most updates)
     const id = setInterval(fetchAll, POLL_FALLBACK_MS);
     return () => clearInterval(id);
-  }, [fetchAll]);
+  }, [fetchAll, fetchStatus]);
+
+  // Multi-day periods count from the server's rollups (hourly for 7D, daily
+  // beyond), so totals don't depend on how many events the list holds
+  useEffect(() => {
+    if (period === '24h') { setRollup(null); return; }
+    const p = PERIODS.find(x => x.key === period);
+    let cancelled = false;
+    const load = () => fetch(`/api/rollups?bucket=${period === '7d' ? 'hour' : 'day'}&days=${Math.ceil(p.ms / 86_400_000)}`)
+      .then(r => r.ok ? r.json() : null)
+      .then(data => { if (!cancelled) setRollup(data); })
+      .catch(() => {});
+    load();
+    const id = setInterval(load, POLL_FALLBACK_MS);
+    return () => { cancelled = true; clearInterval(id); };
+  }, [period]);
 
   // ── Socket.IO real-time updates ────────────────────────────────
+  // Reconnects are replayed what they missed; only when the server can't
+  // do that does the dashboard refetch
+  const fetchAllRef = useRef(fetchAll);
+  fetchAllRef.current = fetchAll;
   useEffect(() => {
-    const socket = io(window.location.origin, { transports: ['websocket', 'polling'] });
+    const socket = connectLive({ channels: ['live'] }, () => { fetchAllRef.current(); fetchStatus(); });
+    setLiveSocket(socket);
+    socket.once('live:resume', fetchStatus);   // anything between the first fetch and subscribing
 
     socket.on('connect', () => {
       console.log('[WS] connected:', socket.id);
@@ -234,24 +359,34 @@ export default function App() {
       setWsConnected(false);
     });
 
-    // New seismic event → prepend to events array
+    // New seismic event → into the event store
     socket.on('seismic:event', (entry) => {
-      setEvents(prev => [entry, ...prev]);
+      storeRef.current?.upsert(entry);
+      if (entry.has_waveform) waveforms.prefetch([entry._id]);   // served from the ingest queue if need be
       setLastRefresh(Date.now());
     });
 
-    // Consensus confirmed → prepend to events array
+    // Worker results for an event (analysis) or a consensus (correlation)
+    socket.on('seismic:analysis', ({ _id, ...fields }) => {
+      storeRef.current?.patch(_id, fields);
+      setModalEvent(prev => (prev?._id === _id ? { ...prev, ...fields } : prev));
+    });
+
+    // Consensus confirmed; sent again when a later trigger refines its
+    // location, and the store replaces it by _id
     socket.on('seismic:consensus', (entry) => {
-      setEvents(prev => [entry, ...prev]);
+      storeRef.current?.upsert(entry);
       setLastRefresh(Date.now());
     });
 
-    // Device heartbeat → update that device to Online (preserve firmware_version)
-    socket.on('device:heartbeat', ({ id, alias }) => {
-      setStatuses(prev => ({
-        ...prev,
-        [id]: { ...(prev[id] || {}), alias: alias || id, status: 'Online' },
-      }));
+    // Device status diffs, coalesced by the server: each device's changed
+    // /api/status fields, one state update per message however many devices
+    socket.on('devices:status', ({ devices }) => {
+      setStatuses(prev => {
+        const next = { ...prev };
+        for (const [id, diff] of Object.entries(devices)) next[id] = { ...(prev[id] || {}), ...diff };
+        return next;
+      });
     });
 
     // Device init → update firmware version when device reports on (re)boot
@@ -267,49 +402,58 @@ export default function App() {
       }));
     });
 
-    return () => socket.disconnect();
+    return () => { socket.disconnect(); setLiveSocket(null); };
   }, []);
 
   // ── Computed: Filter by period ─────────────────────────────────
   const periodMs = PERIODS.find(p => p.key === period)?.ms || 604_800_000;
   const cutoff = Date.now() - periodMs;
+  useEffect(() => { storeRef.current.setPeriod(periodMs); }, [periodMs]);
 
-  const { seismicEvents, consensusEvents } = useMemo(() => {
-    const seismic = [];
-    const consensus = [];
-    for (const e of events) {
-      const t = new Date(e.timestamp).getTime();
-      if (t < cutoff) continue;
-      if (e.status === 'CONFIRMED') {
-        consensus.push({ ...e, _time: t });
-      } else if (e.deltaG !== undefined) {
-        seismic.push({ ...e, _time: t });
-      }
-    }
-    return { seismicEvents: seismic, consensusEvents: consensus };
-  }, [events, cutoff]);
+  // The worker keeps seismic events as time-sorted columns (rows from
+  // view.from are in the period) and the period's consensus entries; every
+  // ranged question below is a lookup in the index it keeps instead of
+  // another pass
+  const consensusEvents = view.consensus;
+  const eventIndex = useMemo(() => makeEventIndex(view), [view]);
+
+  // The confirmed consensus the modal's event is a member of, if any, and
+  // with the overlay on, every member's waveform on the event's time:
+  // shifted by the difference in their first triggers (offset_ms)
+  const modalId = modalEvent?._id ?? null;
+  const modalConsensus = useMemo(() => (modalId
+    ? consensusEvents.find(c => Object.values(c.member_events || {}).some(m => m.event_id === modalId)) ?? null
+    : null), [modalId, consensusEvents]);
+  useEffect(() => {
+    if (!waveformOverlay || !modalConsensus) { setOverlaySeries(null); return; }
+    const members = Object.entries(modalConsensus.member_events || {});
+    const self = members.find(([, m]) => m.event_id === modalId)?.[1];
+    let cancelled = false;
+    Promise.all(members.map(([id, m]) => waveforms.get(m.event_id).then((wave) => {
+      const alias = modalConsensus.aliases?.[modalConsensus.devices.indexOf(id)] ?? id;
+      return wave && { key: m.event_id, label: alias, color: deviceColor(alias),
+                       offsetMs: (m.offset_ms ?? 0) - (self?.offset_ms ?? 0), wave };
+    }))).then((series) => {
+      if (cancelled) return;
+      // The modal's own event first: the others are shifted onto its time
+      const shown = series.filter(Boolean).sort((a, b) => (b.key === modalId) - (a.key === modalId));
+      setOverlaySeries(shown.length > 1 ? shown : null);
+    });
+    return () => { cancelled = true; };
+  }, [waveformOverlay, modalConsensus, modalId]);
+  const waveformSeries = useMemo(() => overlaySeries
+    || (waveformData ? [{ key: modalId, label: modalEvent?.alias, color: deviceColor(modalEvent?.alias), offsetMs: 0, wave: waveformData }] : []),
+  [overlaySeries, waveformData, modalId, modalEvent?.alias]);
 
   // Helpers: dataset bounds for zoom/gradient
-  const xDataMin = useMemo(() => (seismicEvents.length ? Math.min(...seismicEvents.map(e => e._time)) : cutoff), [seismicEvents, cutoff]);
-  const xDataMax = useMemo(() => (seismicEvents.length ? Math.max(...seismicEvents.map(e => e._time)) : Date.now()), [seismicEvents]);
+  const xDataMin = eventIndex.first ?? cutoff;
+  const xDataMax = useMemo(() => eventIndex.last ?? Date.now(), [eventIndex]);
 
   // Full-range ΔG bounds (used as fallback)
-  const [dgMin, dgMax] = useMemo(() => {
-    if (!seismicEvents.length) return [0, 1];
-    let mn = Infinity, mx = -Infinity;
-    for (const e of seismicEvents) { if (e.deltaG < mn) mn = e.deltaG; if (e.deltaG > mx) mx = e.deltaG; }
-    return [mn, mx];
-  }, [seismicEvents]);
+  const [dgMin, dgMax] = eventIndex.deltaRange() || [0, 1];
 
   // Visible ΔG bounds — recomputed whenever zoom changes, used by gradient color mode
-  const [visDgMin, visDgMax] = useMemo(() => {
-    const [d0, d1] = xZoomDomain || [xDataMin, xDataMax];
-    const visible = seismicEvents.filter(e => e._time >= d0 && e._time <= d1);
-    if (!visible.length) return [dgMin, dgMax];
-    let mn = Infinity, mx = -Infinity;
-    for (const e of visible) { if (e.deltaG < mn) mn = e.deltaG; if (e.deltaG > mx) mx = e.deltaG; }
-    return [mn, mx];
-  }, [seismicEvents, xZoomDomain, xDataMin, xDataMax, dgMin, dgMax]);
+  const [visDgMin, visDgMax] = (xZoomDomain ? eventIndex.deltaRange(...xZoomDomain) : null) || [dgMin, dgMax];
 
   // Color mapping (hoisted functions so they're available below)
   function rampColor(t) {
@@ -324,36 +468,109 @@ export default function App() {
     return rampColor(t);
   }
 
-  // ── Computed: Device groups for scatter chart ──────────────────
-  const deviceGroups = useMemo(() => {
-    const groups = {};
-    for (const e of seismicEvents) {
-      if (!levelFilters[e.level]) continue;
-      const key = e.alias || e.id || 'Unknown';
-      if (Object.keys(deviceFilters).length && deviceFilters[key] === false) continue;
-      if (!groups[key]) groups[key] = [];
-      groups[key].push({
-        _time: e._time,
-        deltaG: e.deltaG,
-        level: e.level,
-        alias: key,
-        _id: e._id,
-        has_waveform: e.has_waveform,
-        _c: colorForPoint({ ...e, alias: key })
+  // ── Computed: Points for the scatter chart ─────────────────────
+  // Columns of what the chart plots: the view's events through the device
+  // and level filters, or the server's downsampled points. row is the
+  // event's row in the view (-1 for downsampled points, kept whole in
+  // objects). Colours are not baked in: the gradient follows the zoom, and
+  // the scatter layer gets it as two numbers instead of a rebuilt point list
+  const plot = useMemo(() => {
+    const shown = (alias) => !Object.keys(deviceFilters).length || deviceFilters[alias] !== false;
+    if (downsampled) {
+      const pts = downsampled.filter(e => levelFilters[e.level] && shown(e.alias || e.id || 'Unknown'));
+      const devices = [...new Set(pts.map(e => e.alias || e.id || 'Unknown'))];
+      const n = pts.length;
+      const p = { n, time: new Float64Array(n), deltaG: new Float64Array(n), level: new Uint8Array(n),
+                  device: new Uint16Array(n), row: new Int32Array(n).fill(-1), devices, objects: pts };
+      pts.forEach((e, k) => {
+        p.time[k] = e._time;
+        p.deltaG[k] = e.deltaG;
+        p.level[k] = Math.max(0, LEVELS.indexOf(e.level));
+        p.device[k] = devices.indexOf(e.alias || e.id || 'Unknown');
       });
+      return p;
+    }
+    const levelOn = LEVELS.map(l => !!levelFilters[l]);
+    const deviceOn = view.devices.map(shown);
+    const keep = new Int32Array(view.time.length - view.from);
+    let n = 0;
+    for (let i = view.from; i < view.time.length; i++) {
+      if (levelOn[view.level[i]] && deviceOn[view.device[i]]) keep[n++] = i;
+    }
+    const row = keep.slice(0, n);
+    const p = { n, time: new Float64Array(n), deltaG: new Float64Array(n), level: new Uint8Array(n),
+                device: new Uint16Array(n), row, devices: view.devices, objects: null };
+    for (let k = 0; k < n; k++) {
+      const i = row[k];
+      p.time[k] = view.time[i];
+      p.deltaG[k] = view.deltaG[i];
+      p.level[k] = view.level[i];
+      p.device[k] = view.device[i];
+    }
+    return p;
+  }, [view, downsampled, deviceFilters, levelFilters]);
+
+  // Devices with points, for the legend
+  const plotted = useMemo(() => {
+    const seen = new Set();
+    for (let k = 0; k < plot.n; k++) seen.add(plot.device[k]);
+    return [...seen].map(d => plot.devices[d]);
+  }, [plot]);
+
+  // Plotted point k as the object the hover popup and modal show; a view
+  // row also carries what's needed to ask the worker for the whole event
+  const pointAt = (k) => {
+    if (plot.objects) return plot.objects[k];
+    const i = plot.row[k];
+    return {
+      _time: plot.time[k], deltaG: plot.deltaG[k], level: LEVELS[plot.level[k]], alias: plot.devices[plot.device[k]],
+      trigger: view.triggers[view.trigger[i]], has_waveform: view.waveform[i] === 1,
+      _seq: view.seq[i],
+    };
+  };
+  const plotColor = (k) => (colorMode === 'device'
+    ? DEVICE_COLORS[plot.devices[plot.device[k]]] || '#999'
+    : LEVEL_COLORS[LEVELS[plot.level[k]]] || '#999');
+
+  // The modal opens on what the chart has and fills in from the worker
+  const openEvent = (point) => {
+    setModalEvent(point);
+    if (point._seq == null) return;
+    storeRef.current.get(point._seq).then((full) => {
+      if (full) setModalEvent(prev => (prev === point ? full : prev));
+    });
+  };
+
+  // ΔG span the y axis is laid out for: Recharts picks its nice domain from
+  // two invisible points, the layer reads the resulting scale
+  const yBounds = useMemo(() => {
+    let mx = 0;
+    if (densityGrid) {
+      for (const c of densityGrid.cells) mx = Math.max(mx, densityGrid.dg_edges[c.bin + 1]);
+    } else {
+      for (let k = 0; k < plot.n; k++) if (plot.deltaG[k] > mx) mx = plot.deltaG[k];
     }
-    return groups;
-  }, [seismicEvents, deviceFilters, levelFilters, colorMode, visDgMin, visDgMax]);
+    return [{ _time: xDataMin, deltaG: 0 }, { _time: xDataMin, deltaG: mx }];
+  }, [plot, densityGrid, xDataMin]);
 
   // ── Computed: Key metrics ──────────────────────────────────────
   const metrics = useMemo(() => {
-    const total = seismicEvents.length;
+    let total = eventIndex.n;
     let maxDelta = 0;
-    let lastEvent = null;
-    for (const e of seismicEvents) {
-      if (e.deltaG > maxDelta) maxDelta = e.deltaG;
-      if (!lastEvent || e._time > lastEvent) lastEvent = e._time;
+    // With rollups: buckets inside the period, plus live events newer than as_of
+    const asOf = rollup?.as_of ? new Date(rollup.as_of).getTime() : null;
+    if (asOf) {
+      total = 0;
+      for (const row of rollup.rows) {
+        if (new Date(row.start).getTime() < cutoff) continue;
+        total += row.count;
+        if (row.max_deltaG > maxDelta) maxDelta = row.max_deltaG;
+      }
+      total += eventIndex.count(asOf);
     }
+    const live = eventIndex.deltaRange(asOf ?? -Infinity);
+    if (live && live[1] > maxDelta) maxDelta = live[1];
+    const lastEvent = eventIndex.last;
     let lastConsensus = null;
     for (const c of consensusEvents) {
       if (!lastConsensus || c._time > lastConsensus) lastConsensus = c._time;
@@ -365,7 +582,7 @@ export default function App() {
       lastConsensus,
       consensusCount: consensusEvents.length,
     };
-  }, [seismicEvents, consensusEvents]);
+  }, [eventIndex, consensusEvents, rollup, cutoff]);
 
   // ── Thresholds ────────────────────────────────────────────────
   const thresholds = { minor: 0.035, moderate: 0.10, severe: 0.50 };
@@ -373,20 +590,55 @@ export default function App() {
   // Initialize device filters from statuses/events once
   useEffect(() => {
     const aliases = new Set(Object.keys(statuses).map(k => statuses[k]?.alias).filter(Boolean));
-    const fromEvents = new Set(seismicEvents.map(e => e.alias || e.id));
-    const all = new Set([...aliases, ...fromEvents]);
+    const all = new Set([...aliases, ...view.devices]);
     setDeviceFilters(prev => {
       const next = { ...prev };
       for (const a of all) if (!(a in next)) next[a] = true;
       return next;
     });
-  }, [statuses, seismicEvents.length]);
+  }, [statuses, view.devices]);
 
   // Pixel-domain helpers
   const currentDomain = useMemo(() => xZoomDomain || [xDataMin, xDataMax], [xZoomDomain, xDataMin, xDataMax]);
   // Assign directly during render — always synchronous, never stale (no useEffect needed)
   currentDomainRef.current = currentDomain;
 
+  // Too many visible events to draw: plot the server's per-pixel min/max
+  // instead, asked again whenever zoom, pan or the level filters change
+  const [domainStart, domainEnd] = currentDomain;
+  const densityShown = density && domainEnd - domainStart > DENSITY_ABOVE_MS;
+  useEffect(() => {
+    const visible = densityShown ? 0 : eventIndex.count(domainStart, domainEnd, levelFilters);
+    if (visible <= DOWNSAMPLE_ABOVE) { setDownsampled(null); return; }
+    let cancelled = false;
+    const levels = Object.keys(levelFilters).filter(l => levelFilters[l]).join(',');
+    const timer = setTimeout(() => {
+      const px = Math.max(100, Math.round(plotBoundsRef.current.width));
+      fetch(`/api/events/downsampled?from=${Math.floor(domainStart)}&to=${Math.ceil(domainEnd) + 1}&px=${px}&level=${levels}`)
+        .then(r => r.ok ? r.json() : null)
+        .then(data => {
+          if (!cancelled && data) setDownsampled(data.points.map(p => ({ ...p, _time: new Date(p.timestamp).getTime() })));
+        })
+        .catch(() => {});
+    }, 250);
+    return () => { cancelled = true; clearTimeout(timer); };
+  }, [domainStart, domainEnd, eventIndex, levelFilters, densityShown]);
+
+  // Density mode over a long span: the rollup heatmap for the same range,
+  // asked again on zoom, pan and level filter changes
+  useEffect(() => {
+    if (!densityShown) { setDensityGrid(null); return; }
+    let cancelled = false;
+    const levels = Object.keys(levelFilters).filter(l => levelFilters[l]).join(',');
+    const timer = setTimeout(() => {
+      fetch(`/api/events/density?from=${Math.floor(domainStart)}&to=${Math.ceil(domainEnd) + 1}&level=${levels}`)
+        .then(r => r.ok ? r.json() : null)
+        .then(data => { if (!cancelled && data) setDensityGrid(data); })
+        .catch(() => {});
+    }, 250);
+    return () => { cancelled = true; clearTimeout(timer); };
+  }, [densityShown, domainStart, domainEnd, levelFilters]);
+
   // Reads only from refs — never stale regardless of render cycle
   const pxToTime = (px) => {
     const { left, width } = plotBoundsRef.current;
@@ -403,7 +655,7 @@ export default function App() {
   };
 
   // commitDrag is a plain function (re-created each render) so it always closes over
-  // the latest seismicEvents / levelFilters / deviceFilters state.
+  // the latest levelFilters / deviceFilters state.
   // commitDragRef.current is updated every render so the window listener always calls
   // the fresh version.
   const commitDrag = () => {
@@ -417,10 +669,10 @@ export default function App() {
       if (d.mode === 'zoom') {
         setXZoomDomain([t0, t1]);
       } else {
-        const inRange = seismicEvents
-          .filter(e => e._time >= t0 && e._time <= t1)
-          .filter(e => levelFilters[e.level] && (deviceFilters[e.alias || e.id] ?? true));
-        setRangeModal({ start: t0, end: t1, events: inRange });
+        storeRef.current.range(t0, t1).then((rows) => {
+          const inRange = rows.filter(e => levelFilters[e.level] && (deviceFilters[e.alias || e.id] ?? true));
+          setRangeModal({ start: t0, end: t1, events: inRange });
+        });
       }
     }
     cancelDrag();
@@ -438,25 +690,38 @@ export default function App() {
   const findNearestPoint = (px, py) => {
     const THRESHOLD_PX = 20;
     const { x: xScale, y: yScale } = scaleRef.current;
-    if (!xScale || !yScale) return null;
-    let nearest = null;
+    if (!xScale || !yScale || densityGrid) return null;
+    let nearest = -1;
     let nearestDist = Infinity;
-    for (const [, pts] of Object.entries(deviceGroups)) {
-      for (const pt of pts) {
-        const ptPx = xScale(pt._time);
-        const ptPy = yScale(pt.deltaG);
-        const dist = Math.hypot(px - ptPx, py - ptPy);
-        if (dist < nearestDist) { nearestDist = dist; nearest = { ...pt, _px: ptPx, _py: ptPy }; }
-      }
+    for (let k = 0; k < plot.n; k++) {
+      const dist = Math.hypot(px - xScale(plot.time[k]), py - yScale(plot.deltaG[k]));
+      if (dist < nearestDist) { nearestDist = dist; nearest = k; }
     }
-    return nearestDist <= THRESHOLD_PX ? nearest : null;
+    if (nearestDist > THRESHOLD_PX) return null;
+    const pt = pointAt(nearest);
+    return { ...pt, _k: nearest, _px: xScale(pt._time), _py: yScale(pt.deltaG), _c: colorForPoint(pt) };
   };
 
+  // Resting on a point fetches its waveform and its neighbours', the
+  // hovered one first, and the modal's plot chunk with them
+  const hoverK = hoverState?.point?._k;
+  useEffect(() => {
+    if (hoverK == null) return;
+    const timer = setTimeout(() => {
+      const near = [hoverK - 1, hoverK + 1, hoverK]
+        .filter(k => k >= 0 && k < plot.n).map(pointAt).filter(p => p.has_waveform);
+      if (near.length) loadWaveformPlot();
+      Promise.all(near.map(p => (p._id ? p : storeRef.current.get(p._seq))))
+        .then(events => waveforms.prefetch(events.map(e => e?._id)));
+    }, HOVER_PREFETCH_MS);
+    return () => clearTimeout(timer);
+  }, [hoverK, plot]);
+
   const onOverlayDown = (ev) => {
     if (ev.button !== 0) return;
     if (toolMode === 'select') {
       // In inspect mode a click opens the modal for the nearest point
-      if (hoverState?.point) setModalEvent(hoverState.point);
+      if (hoverState?.point) openEvent(hoverState.point);
       return;
     }
     const rect = chartRef.current?.getBoundingClientRect();
@@ -522,7 +787,6 @@ export default function App() {
   useEffect(() => { if (toolMode !== 'select') setHoverState(null); }, [toolMode]);
 
   const resetZoom = () => setXZoomDomain(null);
-  const onPointClick = (data) => { if (data?.payload) setModalEvent(data.payload); };
 
   const onWheel = (ev) => {
     ev.preventDefault();
@@ -543,7 +807,16 @@ export default function App() {
     setXZoomDomain(next);
   };
 
-  // Color mapping moved above deviceGroups
+  // Range table columns; every row of the selection, windowed by VirtualTable
+  const rangeColumns = useMemo(() => [
+    { key: 'time', label: 'Time', className: 'mono', render: e => fmtTs(e._time, timezone), sort: (a, b) => a._time - b._time },
+    { key: 'device', label: 'Device', render: e => <span style={{ color: deviceColor(e.alias) }}>{e.alias}</span>,
+      sort: (a, b) => String(a.alias).localeCompare(String(b.alias)) },
+    { key: 'level', label: 'Level', render: e => <span className={`level-badge ${e.level}`}>{e.level}</span>,
+      sort: (a, b) => LEVELS.indexOf(a.level) - LEVELS.indexOf(b.level) },
+    { key: 'deltaG', label: 'ΔG', className: 'mono', render: e => e.deltaG?.toFixed(5), sort: (a, b) => a.deltaG - b.deltaG },
+    { key: 'waveform', label: '', className: 'waveform-indicator', render: e => (e.has_waveform ? '📊' : '') },
+  ], [timezone]);
 
   const exportCsv = (rows, filename = 'events.csv') => {
     const header = ['time','alias','level','deltaG'];
@@ -574,7 +847,7 @@ export default function App() {
   }
 
   return (
-    <div className="dashboard">
+    <div className={`dashboard ${showLive ? 'with-live' : ''}`}>
       {/* ─── Header ──────────────────────────────────────────── */}
       <header className="header">
         <div className="header-left">
@@ -582,7 +855,7 @@ export default function App() {
           <h1>Seismometer Dashboard</h1>
           {serverInfo && (
             <span className="header-uptime">
-              Uptime: {fmtUptime(serverInfo.uptime_seconds)}
+              Uptime: {fmtUptime(serverInfo.started_at ? (Date.now() - new Date(serverInfo.started_at)) / 1000 : serverInfo.uptime_seconds)}
             </span>
           )}
         </div>
@@ -651,6 +924,10 @@ export default function App() {
             <option value="device">By Device</option>
             <option value="gradient">By ΔG Gradient</option>
           </select>
+          <label className="chk" title={`Heatmap from the rollups while more than ${DENSITY_ABOVE_MS / 86_400_000} days are in view`}>
+            <input type="checkbox" checked={density} onChange={e => setDensity(e.target.checked)} />
+            <span>Density</span>
+          </label>
         </div>
         <div className="filter-group">
           <span className="control-label">Tool:</span>
@@ -666,6 +943,10 @@ export default function App() {
           <input type="checkbox" checked={showConsensus} onChange={e => setShowConsensus(e.target.checked)} />
           <span>Show consensus markers</span>
         </label>
+        <label className="chk">
+          <input type="checkbox" checked={showLive} onChange={e => setShowLive(e.target.checked)} />
+          <span>Live stream</span>
+        </label>
         <button className="btn" onClick={() => {
           const dom = xZoomDomain || [xDataMin, xDataMax];
           const center = (dom[0]+dom[1])/2; const span = (dom[1]-dom[0])*0.8/2; setXZoomDomain([center-span, center+span]);
@@ -717,7 +998,7 @@ export default function App() {
 
       {/* ─── Main Delta-G Chart ──────────────────────────────── */}
       <Panel title="ΔG Over Time" className="main-chart">
-        {seismicEvents.length === 0 ? (
+        {eventIndex.n === 0 ? (
           <div className="empty-state">No seismic events in this period</div>
         ) : (
           <div className="chart-wrapper">
@@ -743,7 +1024,6 @@ export default function App() {
                 allowDataOverflow={true}
                 label={{ value: 'ΔG (g)', angle: -90, position: 'insideLeft', fill: '#555', fontSize: 11 }}
               />
-              <Tooltip content={props => <DeltaTooltip {...props} tz={timezone} />} />
               <Legend
                 iconType="circle"
                 iconSize={8}
@@ -774,24 +1054,26 @@ export default function App() {
               {showConsensus && consensusEvents.map((c, i) => (
                 <ReferenceLine key={`c${i}`} x={c._time} stroke="#ff00ff" strokeDasharray="4 3" strokeWidth={1} opacity={0.5} />
               ))}
-              {/* One Scatter per device */}
-              {Object.entries(deviceGroups).map(([alias, data]) => (
-                <Scatter
-                  key={alias}
-                  name={alias}
-                  data={data}
-                  shape={(p) => (
-                    <g>
-                      {/* thin X mark */}
-                      <line x1={p.cx-3} y1={p.cy-3} x2={p.cx+3} y2={p.cy+3} stroke={p.payload._c} strokeWidth={1} />
-                      <line x1={p.cx-3} y1={p.cy+3} x2={p.cx+3} y2={p.cy-3} stroke={p.payload._c} strokeWidth={1} />
-                    </g>
-                  )}
-                  onClick={onPointClick}
-                />
+              {/* Axis extent only; the points are drawn by ScatterLayer */}
+              <Scatter data={yBounds} legendType="none" shape={() => null} isAnimationActive={false} />
+              {/* One empty Scatter per device, for the legend */}
+              {plotted.map(alias => (
+                <Scatter key={alias} name={alias} data={[]} isAnimationActive={false} />
               ))}
             </ScatterChart>
           </ResponsiveContainer>
+          {densityGrid ? (
+            <DensityLayer grid={densityGrid} scaleRef={scaleRef} plotBoundsRef={plotBoundsRef} />
+          ) : (
+            <ScatterLayer
+              plot={plot}
+              colorOf={plotColor}
+              colorKey={colorMode}
+              gradient={colorMode === 'gradient' ? [visDgMin, visDgMax] : null}
+              scaleRef={scaleRef}
+              plotBoundsRef={plotBoundsRef}
+            />
+          )}
           <div
             ref={chartRef}
             className="chart-overlay"
@@ -848,6 +1130,14 @@ export default function App() {
         )}
       </Panel>
 
+      {showLive && (
+        <Panel title="Live Stream" className="live-panel">
+          <Suspense fallback={null}>
+            <LiveSeismograph socket={liveSocket} aliasOf={id => statuses[id]?.alias} />
+          </Suspense>
+        </Panel>
+      )}
+
       {/* Removed secondary panels: Activity, Consensus table, Recent, API Traffic */}
 
       {/* ─── Event Modal with Waveform ─────────────────────── */}
@@ -863,6 +1153,30 @@ export default function App() {
               <div className="kv"><span>Device</span><span style={{ color: deviceColor(modalEvent.alias) }}>{modalEvent.alias}</span></div>
               <div className="kv"><span>Level</span><span className={`level-badge ${modalEvent.level}`}>{modalEvent.level}</span></div>
               <div className="kv"><span>ΔG</span><span className="mono">{modalEvent.deltaG?.toFixed(5)}</span></div>
+              {modalEvent.trigger && (
+                <div className="kv"><span>Trigger</span><span className="mono">{modalEvent.trigger === 'sta_lta' ? 'STA/LTA' : 'Threshold'}</span></div>
+              )}
+              {modalEvent.gap_samples > 0 && (
+                <div className="kv"><span>Gap</span><span className="mono">{modalEvent.gap_samples} samples lost before #{modalEvent.gap_index}</span></div>
+              )}
+              {modalEvent.time_source && (
+                <div className="kv"><span>Clock</span><span className="mono">{modalEvent.time_source === 'ntp' ? 'Device (SNTP)' : modalEvent.time_source === 'server' ? 'Device (server-synced at boot)' : 'Server receive time'}</span></div>
+              )}
+              {modalEvent.retriggers?.length > 0 && (
+                <div className="kv"><span>Retriggers</span><span className="mono">{modalEvent.retriggers.map(t => `+${(t / 1000).toFixed(1)}s`).join(', ')}</span></div>
+              )}
+              {modalEvent.spectrum?.hz?.length > 0 && (
+                <div className="kv"><span>Spectrum</span><span className="mono">
+                  {modalEvent.spectrum.dominant_hz} Hz dominant · {modalEvent.spectrum.hz.map((f, i) => `${f}Hz ${(modalEvent.spectrum.amp_g[i] * 1000).toFixed(2)}`).join(' ')} mg
+                </span></div>
+              )}
+              {modalEvent.analysis && (
+                <div className="kv"><span>Analysis</span><span className="mono">
+                  PGA {(modalEvent.analysis.pga_g * 1000).toFixed(1)} mg · MMI {modalEvent.analysis.intensity_mmi}
+                  {modalEvent.analysis.dominant_hz != null && ` · ${modalEvent.analysis.dominant_hz} Hz`}
+                  {` · ${(modalEvent.analysis.d5_95_ms / 1000).toFixed(1)}s (5-95%)`}
+                </span></div>
+              )}
               {modalEvent.has_waveform && !waveformData && waveformLoading && (
                 <div className="waveform-loading">Loading waveform...</div>
               )}
@@ -870,41 +1184,26 @@ export default function App() {
                 <div className="waveform-container">
                   <div className="waveform-toolbar">
                     <span className="waveform-title">Seismograph</span>
+                    <span className="waveform-note mono">
+                      {waveformData.tier === 'envelope' ? `${waveformData.count} samples kept (envelope)` : `${waveformData.count} samples`}
+                      {' · drag to zoom, double-click to reset '}
+                      <a href={`/api/events/${modalEvent._id}/waveform?download=1`} download>full data</a>
+                    </span>
                     <div className="waveform-toggle">
+                      {modalConsensus && (
+                        <button className={`btn btn-sm ${waveformOverlay ? 'active' : ''}`}
+                          title="Overlay the other nodes of this consensus"
+                          onClick={() => setWaveformOverlay(v => !v)}>Nodes</button>
+                      )}
                       {[['axes','3-Axis'],['deltag','ΔG']].map(([v,label]) => (
                         <button key={v} className={`btn btn-sm ${waveformView === v ? 'active' : ''}`}
                           onClick={() => setWaveformView(v)}>{label}</button>
                       ))}
                     </div>
                   </div>
-                  <ResponsiveContainer width="100%" height={280}>
-                    <LineChart data={waveformData} margin={{ top: 10, right: 20, bottom: 40, left: 20 }}>
-                      <CartesianGrid strokeDasharray="3 3" stroke="#333" />
-                      <XAxis dataKey="t" type="number" domain={['dataMin','dataMax']}
-                        tickFormatter={v => `${v >= 0 ? '+' : ''}${(v/1000).toFixed(1)}s`}
-                        stroke="#888" fontSize={10} tick={{ dy: 4 }}
-                        label={{ value: 'Time relative to event (s)', position: 'bottom', offset: 20, fill: '#888', fontSize: 10 }} />
-                      <YAxis stroke="#888" fontSize={10}
-                        label={{ value: 'Acceleration (g)', angle: -90, position: 'insideLeft', offset: -5, fill: '#888', fontSize: 10, dy: -10 }} />
-                      <ReferenceLine x={0} stroke="#ff3366" strokeWidth={2} strokeDasharray="4 2"
-                        label={{ value: 'Event', fill: '#ff3366', fontSize: 10, position: 'top' }} />
-                      <Legend verticalAlign="top" align="right" wrapperStyle={{ color: '#ccc', fontSize: 11, paddingBottom: 8 }} />
-                      {waveformView === 'axes' ? (
-                        <>
-                          <Line type="monotone" dataKey="ax" stroke="#ff6644" dot={false} strokeWidth={1.5} name="X" />
-                          <Line type="monotone" dataKey="ay" stroke="#00ff88" dot={false} strokeWidth={1.5} name="Y" />
-                          <Line type="monotone" dataKey="az" stroke="#00aaff" dot={false} strokeWidth={1.5} name="Z" />
-                        </>
-                      ) : (
-                        <Line type="monotone" dataKey="dg" stroke="#ffaa00" dot={false} strokeWidth={2} name="ΔG" />
-                      )}
-                      <Tooltip
-                        contentStyle={{ background: '#1a1a2e', border: '1px solid #333', borderRadius: 6, fontSize: 11 }}
-                        labelFormatter={v => `t = ${v >= 0 ? '+' : ''}${v}ms`}
-                        formatter={(val, name) => [val.toFixed(5) + ' g', name]}
-                      />
-                    </LineChart>
-                  </ResponsiveContainer>
+                  <Suspense fallback={<div className="waveform-loading">Loading waveform...</div>}>
+                    <WaveformPlot series={waveformSeries} view={waveformView} markers={modalEvent.retriggers || []} height={320} />
+                  </Suspense>
                 </div>
               )}
             </div>
@@ -927,31 +1226,15 @@ export default function App() {
               <div className="kv"><span>From</span><span className="mono">{fmtTs(rangeModal.start, timezone)}</span></div>
               <div className="kv"><span>To</span><span className="mono">{fmtTs(rangeModal.end, timezone)}</span></div>
               <div className="kv"><span>Events</span><span className="mono">{rangeModal.events.length}</span></div>
-              <div className="range-table table-scroll">
-                <table className="data-table">
-                  <thead>
-                    <tr>
-                      <th>Time</th>
-                      <th>Device</th>
-                      <th>Level</th>
-                      <th>ΔG</th>
-                    </tr>
-                  </thead>
-                  <tbody>
-                    {rangeModal.events.slice(0, 500).map((e,i) => (
-                      <tr key={i} className={e.has_waveform ? 'clickable-row' : ''}
-                        onClick={() => { if (e.has_waveform || e._id) { setRangeModal(null); setModalEvent(e); } }}
-                        title={e.has_waveform ? 'Click to view waveform' : ''}>
-                        <td className="mono">{fmtTs(e._time, timezone)}</td>
-                        <td style={{ color: deviceColor(e.alias) }}>{e.alias}</td>
-                        <td><span className={`level-badge ${e.level}`}>{e.level}</span></td>
-                        <td className="mono">{e.deltaG?.toFixed(5)}</td>
-                        {e.has_waveform && <td className="waveform-indicator">📊</td>}
-                      </tr>
-                    ))}
-                  </tbody>
-                </table>
-              </div>
+              <VirtualTable
+                className="range-table"
+                rows={rangeModal.events}
+                columns={rangeColumns}
+                rowKey={e => e._id || e._seq}
+                rowClass={e => (e.has_waveform ? 'clickable-row' : '')}
+                rowTitle={e => (e.has_waveform ? 'Click to view waveform' : '')}
+                onRowClick={e => { if (e.has_waveform || e._id) { setRangeModal(null); setModalEvent(e); } }}
+              />
             </div>
             <div className="modal-actions">
               <button className="btn" onClick={() => exportCsv(rangeModal.events, 'range_events.csv')}>Export CSV</button>
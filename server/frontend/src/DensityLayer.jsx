@@ -0,0 +1,56 @@
+// ── Density layer ────────────────────────────────────────────────
+// The ΔG chart as a time × ΔG heatmap for long ranges, drawn on a canvas
+// under the interaction overlay like ScatterLayer. grid is the answer of
+// GET /api/events/density: one cell per rollup bucket and log-spaced ΔG
+// bin, placed with the chart's own scales. Colour follows log(count)
+// against the busiest cell in view, so a single event still shows.
+import { useEffect, useRef } from 'react';
+
+// Dim blue → green → yellow → red, as for t in [0, 1]
+function heat(t) {
+  const hue = 220 - 220 * t;
+  return `hsla(${hue}, 100%, ${35 + 20 * t}%, ${0.35 + 0.65 * t})`;
+}
+
+export default function DensityLayer({ grid, scaleRef, plotBoundsRef }) {
+  const canvasRef = useRef(null);
+
+  useEffect(() => {
+    const canvas = canvasRef.current;
+    if (!canvas) return;
+    const dpr = window.devicePixelRatio || 1;
+    const w = canvas.clientWidth, h = canvas.clientHeight;
+    if (canvas.width !== Math.round(w * dpr) || canvas.height !== Math.round(h * dpr)) {
+      canvas.width = Math.round(w * dpr);
+      canvas.height = Math.round(h * dpr);
+    }
+    const ctx = canvas.getContext('2d');
+    ctx.setTransform(dpr, 0, 0, dpr, 0, 0);
+    ctx.clearRect(0, 0, w, h);
+    const { x, y } = scaleRef.current;
+    const b = plotBoundsRef.current;
+    if (!grid || !x || !y || !(b.width > 1)) return;
+
+    ctx.save();
+    ctx.beginPath();
+    ctx.rect(b.left, b.top, b.width, b.height);
+    ctx.clip();
+    const [d0, d1] = x.domain().map(Number);
+    let peak = 1;
+    for (const c of grid.cells) if (c.start + grid.bucket_ms > d0 && c.start < d1 && c.count > peak) peak = c.count;
+    const norm = Math.log1p(peak);
+    const [yMin, yMax] = y.domain();
+    for (const c of grid.cells) {
+      if (c.start + grid.bucket_ms <= d0 || c.start >= d1) continue;
+      const lo = Math.max(grid.dg_edges[c.bin], yMin), hi = Math.min(grid.dg_edges[c.bin + 1], yMax);
+      if (hi <= lo) continue;
+      const x0 = x(c.start), x1 = x(c.start + grid.bucket_ms);
+      const y0 = y(hi), y1 = y(lo);
+      ctx.fillStyle = heat(Math.log1p(c.count) / norm);
+      ctx.fillRect(x0, y0, Math.max(1, x1 - x0), Math.max(1, y1 - y0));
+    }
+    ctx.restore();
+  });
+
+  return <canvas ref={canvasRef} className="scatter-layer" />;
+}
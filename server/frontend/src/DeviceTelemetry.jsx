@@ -0,0 +1,113 @@
+import { lazy, Suspense, useEffect, useMemo, useReducer, useRef, useState } from 'react';
+import { TELEMETRY_CHANNELS } from './telemetry';
+
+const WaveformPlot = lazy(() => import('./WaveformPlot'));
+
+// A device's telemetry ring (telemetry.js) on the config page: a sparkline
+// per channel with its latest value, and on request all of them as lanes
+// of the waveform plot on wall-clock time, the device's boots marked.
+// Redraws when the ring takes a sample, not on every render of the page.
+const COLORS = {
+  heap_free: '#00d4aa', heap_block: '#6c8cff', heap_frag: '#ffaa00', loop_p95_us: '#ff6b6b',
+  loop_max_us: '#ff3366', jitter_p99_ms: '#b07cff', i2c_busy_pct: '#66ccff', i2c_faults: '#ff8844',
+  upload_queued: '#cccc66', temp_c: '#ff99cc',
+};
+const LANE_PX = 64;
+
+function fmtValue(v, unit) {
+  if (!Number.isFinite(v)) return '—';
+  if (unit === 'B') return v >= 1024 ? `${(v / 1024).toFixed(1)} KB` : `${v} B`;
+  if (unit === 'µs') return v >= 1000 ? `${(v / 1000).toFixed(1)} ms` : `${Math.round(v)} µs`;
+  const s = Number.isInteger(v) ? String(v) : v.toFixed(Math.abs(v) < 10 ? 2 : 1);
+  return unit ? `${s} ${unit}` : s;
+}
+
+// Newest finite value of a channel
+function latest(wave, key) {
+  const v = wave[key];
+  for (let i = wave.count - 1; i >= 0; i--) if (v[i] === v[i]) return v[i];
+  return NaN;
+}
+
+function drawSparkline(canvas, wave, key, color) {
+  const dpr = window.devicePixelRatio || 1;
+  const w = canvas.clientWidth, h = canvas.clientHeight;
+  if (canvas.width !== Math.round(w * dpr) || canvas.height !== Math.round(h * dpr)) {
+    canvas.width = Math.round(w * dpr);
+    canvas.height = Math.round(h * dpr);
+  }
+  const ctx = canvas.getContext('2d');
+  ctx.setTransform(dpr, 0, 0, dpr, 0, 0);
+  ctx.clearRect(0, 0, w, h);
+  const { t, count } = wave;
+  const v = wave[key];
+  let lo = Infinity, hi = -Infinity;
+  for (let i = 0; i < count; i++) {
+    if (v[i] < lo) lo = v[i];
+    if (v[i] > hi) hi = v[i];
+  }
+  if (!(lo <= hi) || count < 2) return;
+  if (hi === lo) { hi += 1; lo -= 1; }
+  const t0 = t[0], span = t[count - 1] - t0 || 1;
+  const xAt = ms => ((ms - t0) / span) * (w - 2) + 1;
+  const yAt = y => h - 2 - ((y - lo) / (hi - lo)) * (h - 4);
+  ctx.strokeStyle = color;
+  ctx.lineWidth = 1.25;
+  ctx.beginPath();
+  let open = false;
+  for (let i = 0; i < count; i++) {
+    if (v[i] !== v[i]) { open = false; continue; }
+    if (open) ctx.lineTo(xAt(t[i]), yAt(v[i])); else ctx.moveTo(xAt(t[i]), yAt(v[i]));
+    open = true;
+  }
+  ctx.stroke();
+}
+
+function Sparkline({ wave, channel }) {
+  const ref = useRef(null);
+  useEffect(() => { if (ref.current) drawSparkline(ref.current, wave, channel.key, COLORS[channel.key]); });
+  return (
+    <div className="telemetry-card" title={`${channel.label}, the last ${wave.count} heartbeats`}>
+      <span className="info-label">{channel.label}</span>
+      <span className="info-value mono">{fmtValue(latest(wave, channel.key), channel.unit)}</span>
+      <canvas ref={ref} className="telemetry-spark" />
+    </div>
+  );
+}
+
+export default function DeviceTelemetry({ id, telemetry, boots }) {
+  const [, redraw] = useReducer(n => n + 1, 0);
+  const [open, setOpen] = useState(false);
+  useEffect(() => telemetry.subscribe(d => { if (d === id) redraw(); }), [telemetry, id]);
+
+  const wave = telemetry.wave(id);
+  // The ring's view object is stable, so the plot keeps its zoom between samples
+  const series = useMemo(() => (wave ? [{ key: id, label: id, wave }] : []), [wave, id]);
+  if (!wave) return null;
+
+  const shown = TELEMETRY_CHANNELS.filter(c => Number.isFinite(latest(wave, c.key)));
+  const lanes = shown.map(c => ({ label: c.label, channel: c.key, color: COLORS[c.key], format: v => fmtValue(v, c.unit) }));
+  const from = wave.t[0];
+  const markers = (boots || []).map(b => new Date(b.time).getTime()).filter(ms => ms >= from);
+
+  return (
+    <>
+      <div className="config-divider" />
+      <h4 className="config-section-title">
+        Live Telemetry <span className="config-hint">(last {wave.count} heartbeats)</span>
+        {wave.count > 1 && (
+          <button className="telemetry-toggle" onClick={() => setOpen(o => !o)}>{open ? '▾ Hide trend' : '▸ Trend'}</button>
+        )}
+      </h4>
+      <div className="telemetry-row">
+        {shown.map(c => <Sparkline key={c.key} wave={wave} channel={c} />)}
+      </div>
+      {open && wave.count > 1 && (
+        <Suspense fallback={<div className="config-hint">Loading plot…</div>}>
+          <WaveformPlot series={series} lanes={lanes} clock="wall" trigger={false} markers={markers}
+                        height={LANE_PX * lanes.length + 28} />
+        </Suspense>
+      )}
+    </>
+  );
+}
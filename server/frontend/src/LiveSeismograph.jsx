@@ -0,0 +1,157 @@
+// ── Live seismograph ─────────────────────────────────────────────
+// Rolling view of the devices streaming over UDP (stream_mode 'udp'), one
+// lane per device. It watches with 'stream:watch', sized to the canvas's
+// CSS width, and the server sends per-pixel min/max columns as binary
+// 'stream:frame's (layout in server/lib/livestream.js). Columns go into a
+// ring per device, one slot per pixel, and a frame only schedules a canvas
+// redraw, so nothing in React updates while the stream runs. Raw samples
+// carry gravity, so each lane removes an axis's mean over the window, then
+// scales all three to the largest remaining swing.
+import { useEffect, useRef } from 'react';
+
+const SECONDS = 60;
+const AXIS_COLORS = ['#ff3366', '#00ff88', '#3b82f6'];   // x, y, z
+const IDLE_MS = 15_000;   // lanes without a frame for this long are dropped
+const EMPTY_COLUMN = [32767, -32768, 32767, -32768, 32767, -32768];
+
+function parseFrame(buf) {
+  const view = new DataView(buf);
+  const n = view.getUint16(16, true);
+  return {
+    from: view.getFloat64(0, true),
+    colMs: view.getFloat64(8, true),
+    rate: view.getUint16(18, true),
+    columns: new Int16Array(buf.slice(20, 20 + n * 12)),
+    n,
+  };
+}
+
+export default function LiveSeismograph({ socket, aliasOf }) {
+  const canvasRef = useRef(null);
+  const lanesRef = useRef(new Map());   // id → { px, colMs, ring: Int16Array(px × 6), last, rate, seen }
+  const frameRef = useRef(0);
+  const aliasRef = useRef(aliasOf);
+  aliasRef.current = aliasOf;
+
+  useEffect(() => {
+    const canvas = canvasRef.current;
+    if (!socket || !canvas) return;
+    let px = 0;
+
+    const watch = () => {
+      px = Math.max(10, Math.round(canvas.clientWidth));
+      socket.emit('stream:watch', { px, seconds: SECONDS });
+    };
+
+    const draw = () => {
+      frameRef.current = 0;
+      const dpr = window.devicePixelRatio || 1;
+      const w = canvas.clientWidth, h = canvas.clientHeight;
+      if (canvas.width !== Math.round(w * dpr) || canvas.height !== Math.round(h * dpr)) {
+        canvas.width = Math.round(w * dpr);
+        canvas.height = Math.round(h * dpr);
+      }
+      const ctx = canvas.getContext('2d');
+      ctx.setTransform(dpr, 0, 0, dpr, 0, 0);
+      ctx.clearRect(0, 0, w, h);
+      const now = Date.now();
+      for (const [id, lane] of lanesRef.current) if (now - lane.seen > IDLE_MS) lanesRef.current.delete(id);
+      const lanes = [...lanesRef.current.entries()];
+      if (!lanes.length) {
+        ctx.fillStyle = '#555';
+        ctx.font = '11px sans-serif';
+        ctx.fillText('No device is streaming (stream_mode "udp")', 8, 16);
+        return;
+      }
+      const laneH = h / lanes.length;
+      lanes.forEach(([id, lane], li) => {
+        const { ring, px: lpx, last } = lane;
+        const top = li * laneH, mid = top + laneH / 2;
+        // Mean and swing per axis over the filled columns
+        const mean = [0, 0, 0], cnt = [0, 0, 0];
+        for (let c = 0; c < lpx; c++) {
+          for (let a = 0; a < 3; a++) {
+            const lo = ring[c * 6 + a * 2], hi = ring[c * 6 + a * 2 + 1];
+            if (lo <= hi) { mean[a] += (lo + hi) / 2; cnt[a]++; }
+          }
+        }
+        for (let a = 0; a < 3; a++) mean[a] = cnt[a] ? mean[a] / cnt[a] : 0;
+        let swing = 1;
+        for (let c = 0; c < lpx; c++) {
+          for (let a = 0; a < 3; a++) {
+            const lo = ring[c * 6 + a * 2], hi = ring[c * 6 + a * 2 + 1];
+            if (lo <= hi) swing = Math.max(swing, Math.abs(lo - mean[a]), Math.abs(hi - mean[a]));
+          }
+        }
+        const k = (laneH / 2 - 4) / swing;
+        const xScale = w / lpx;
+        AXIS_COLORS.forEach((color, a) => {
+          ctx.strokeStyle = color;
+          ctx.globalAlpha = 0.8;
+          ctx.beginPath();
+          // Oldest column at the left: slot (last + 1) % px
+          for (let i = 0; i < lpx; i++) {
+            const c = (last + 1 + i) % lpx;
+            const lo = ring[c * 6 + a * 2], hi = ring[c * 6 + a * 2 + 1];
+            if (lo > hi) continue;
+            const x = i * xScale + 0.5;
+            ctx.moveTo(x, mid - (hi - mean[a]) * k);
+            ctx.lineTo(x, mid - (lo - mean[a]) * k + 1);
+          }
+          ctx.stroke();
+        });
+        ctx.globalAlpha = 1;
+        ctx.fillStyle = '#aaa';
+        ctx.font = '10px sans-serif';
+        ctx.fillText(`${aliasRef.current?.(id) || id} · ${lane.rate} Hz · ±${(swing / 16384 * 1000).toFixed(1)} mg`, 6, top + 12);
+        if (li) {
+          ctx.strokeStyle = 'rgba(255,255,255,0.06)';
+          ctx.beginPath(); ctx.moveTo(0, top); ctx.lineTo(w, top); ctx.stroke();
+        }
+      });
+    };
+    const schedule = () => { if (!frameRef.current) frameRef.current = requestAnimationFrame(draw); };
+
+    const onFrame = (id, data) => {
+      const f = parseFrame(data instanceof ArrayBuffer ? data : data.buffer.slice(data.byteOffset, data.byteOffset + data.byteLength));
+      let lane = lanesRef.current.get(id);
+      if (!lane || lane.colMs !== f.colMs || lane.px !== px) {
+        lane = { px, colMs: f.colMs, ring: new Int16Array(px * 6), last: -1, rate: f.rate, seen: 0 };
+        for (let c = 0; c < px; c++) lane.ring.set(EMPTY_COLUMN, c * 6);
+        lanesRef.current.set(id, lane);
+      }
+      const first = Math.round(f.from / f.colMs);
+      for (let i = 0; i < f.n; i++) {
+        const slot = (first + i) % lane.px;
+        lane.ring.set(f.columns.subarray(i * 6, i * 6 + 6), slot * 6);
+        lane.last = slot;
+      }
+      lane.rate = f.rate;
+      lane.seen = Date.now();
+      schedule();
+    };
+
+    watch();
+    socket.on('connect', watch);
+    socket.on('stream:frame', onFrame);
+    let resizeTimer = 0;
+    const ro = typeof ResizeObserver !== 'undefined' ? new ResizeObserver(() => {
+      clearTimeout(resizeTimer);
+      resizeTimer = setTimeout(() => { if (Math.round(canvas.clientWidth) !== px) watch(); schedule(); }, 200);
+    }) : null;
+    ro?.observe(canvas);
+    const idle = setInterval(schedule, 1000);   // drops idle lanes even when no frame comes
+    return () => {
+      socket.emit('stream:unwatch');
+      socket.off('connect', watch);
+      socket.off('stream:frame', onFrame);
+      ro?.disconnect();
+      clearTimeout(resizeTimer);
+      clearInterval(idle);
+      cancelAnimationFrame(frameRef.current);
+      frameRef.current = 0;
+    };
+  }, [socket]);
+
+  return <canvas ref={canvasRef} className="live-seismograph" />;
+}
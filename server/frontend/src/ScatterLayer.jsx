@@ -0,0 +1,252 @@
+// ── Scatter point layer ──────────────────────────────────────────
+// The ΔG chart's points drawn on one canvas underneath the interaction
+// overlay, instead of one SVG node per event. Recharts still draws the
+// axes, grid, legend and reference lines; its d3 scales (scaleRef, captured
+// by the chart's <Customized>) place the points, so both line up exactly.
+//
+// With WebGL the points are uploaded once per data / filter / colour-mode
+// change. Zoom and pan only change uniforms, and the gradient colour mode
+// is computed in the shader from the visible ΔG range, so a redraw is one
+// draw call whatever the point count. Times go up as two floats (hi + lo,
+// relative to the oldest point) so a zoom down to seconds keeps its
+// precision. Without WebGL the same layer draws with a 2D context.
+import { useEffect, useMemo, useRef } from 'react';
+
+const MARK_PX = 7;   // the thin X mark, ±3 px around the point
+
+export const webglSupported = (() => {
+  try {
+    return !!document.createElement('canvas').getContext('webgl');
+  } catch {
+    return false;
+  }
+})();
+
+const VERTEX = `
+attribute float a_hi;
+attribute float a_lo;
+attribute float a_dg;
+attribute vec3 a_color;
+uniform vec2 u_x0;        // domain start, hi/lo like the points
+uniform vec2 u_x;         // px per ms, range start px
+uniform vec4 u_y;         // domain lo, hi, range lo px, range hi px
+uniform vec2 u_size;      // canvas, CSS px
+uniform vec2 u_grad;      // gradient ΔG range; u_mode 1 = gradient
+uniform float u_mode;
+uniform float u_pt;
+varying vec3 v_color;
+void main() {
+  float dt = (a_hi - u_x0.x) + (a_lo - u_x0.y);
+  float px = u_x.y + dt * u_x.x;
+  float py = u_y.z + (a_dg - u_y.x) / (u_y.y - u_y.x) * (u_y.w - u_y.z);
+  gl_Position = vec4(px / u_size.x * 2.0 - 1.0, 1.0 - py / u_size.y * 2.0, 0.0, 1.0);
+  gl_PointSize = u_pt;
+  if (u_mode > 0.5) {
+    // hsl(120 - 120t, 100%, 50%), as rampColor() in App.jsx
+    float t = clamp((a_dg - u_grad.x) / max(u_grad.y - u_grad.x, 1e-9), 0.0, 1.0);
+    v_color = t < 0.5 ? vec3(2.0 * t, 1.0, 0.0) : vec3(1.0, 2.0 - 2.0 * t, 0.0);
+  } else {
+    v_color = a_color;
+  }
+}`;
+
+const FRAGMENT = `
+precision mediump float;
+uniform float u_pt;
+uniform float u_line;
+varying vec3 v_color;
+void main() {
+  vec2 c = gl_PointCoord * u_pt;
+  float d = min(abs(c.x - c.y), abs(c.x + c.y - u_pt)) * 0.7071;
+  if (d > u_line) discard;
+  gl_FragColor = vec4(v_color, 1.0);
+}`;
+
+function hexRgb(hex) {
+  const v = parseInt((hex || '#999999').slice(1), 16);
+  return [(v >> 16 & 255) / 255, (v >> 8 & 255) / 255, (v & 255) / 255];
+}
+
+// plot: { n, time, deltaG } columns -> typed arrays for the GPU
+function pack(plot, colorOf) {
+  const { n, time, deltaG } = plot;
+  let base = Infinity;
+  for (let k = 0; k < n; k++) if (time[k] < base) base = time[k];
+  const hi = new Float32Array(n), lo = new Float32Array(n), dg = new Float32Array(deltaG.subarray(0, n));
+  const color = new Float32Array(n * 3);
+  const cache = new Map();
+  for (let k = 0; k < n; k++) {
+    const t = time[k] - base;
+    hi[k] = Math.fround(t);
+    lo[k] = t - hi[k];
+    const c = colorOf(k);
+    if (!cache.has(c)) cache.set(c, hexRgb(c));
+    color.set(cache.get(c), k * 3);
+  }
+  return { n, base: Number.isFinite(base) ? base : 0, hi, lo, dg, color, plot };
+}
+
+function setupGl(gl) {
+  const shader = (type, src) => {
+    const s = gl.createShader(type);
+    gl.shaderSource(s, src);
+    gl.compileShader(s);
+    if (!gl.getShaderParameter(s, gl.COMPILE_STATUS)) throw new Error(gl.getShaderInfoLog(s));
+    return s;
+  };
+  const prog = gl.createProgram();
+  gl.attachShader(prog, shader(gl.VERTEX_SHADER, VERTEX));
+  gl.attachShader(prog, shader(gl.FRAGMENT_SHADER, FRAGMENT));
+  gl.linkProgram(prog);
+  if (!gl.getProgramParameter(prog, gl.LINK_STATUS)) throw new Error(gl.getProgramInfoLog(prog));
+  const attrs = {};
+  for (const name of ['a_hi', 'a_lo', 'a_dg', 'a_color']) {
+    attrs[name] = { loc: gl.getAttribLocation(prog, name), buf: gl.createBuffer() };
+  }
+  const uniforms = {};
+  for (const name of ['u_x0', 'u_x', 'u_y', 'u_size', 'u_grad', 'u_mode', 'u_pt', 'u_line']) {
+    uniforms[name] = gl.getUniformLocation(prog, name);
+  }
+  return { prog, attrs, uniforms, count: 0 };
+}
+
+function upload(gl, state, data) {
+  const put = (name, array, size) => {
+    const a = state.attrs[name];
+    gl.bindBuffer(gl.ARRAY_BUFFER, a.buf);
+    gl.bufferData(gl.ARRAY_BUFFER, array, gl.STATIC_DRAW);
+    gl.enableVertexAttribArray(a.loc);
+    gl.vertexAttribPointer(a.loc, size, gl.FLOAT, false, 0, 0);
+  };
+  put('a_hi', data.hi, 1);
+  put('a_lo', data.lo, 1);
+  put('a_dg', data.dg, 1);
+  put('a_color', data.color, 3);
+  state.count = data.n;
+}
+
+// Recharts scales and plot rect, or null before the chart has laid out
+function view(scaleRef, plotBoundsRef) {
+  const { x, y } = scaleRef.current;
+  const b = plotBoundsRef.current;
+  if (!x || !y || !(b.width > 1) || !(b.height > 0)) return null;
+  const [x0, x1] = x.domain().map(Number);
+  const [r0, r1] = x.range();
+  return { x0, pxPerMs: x1 > x0 ? (r1 - r0) / (x1 - x0) : 0, xr0: r0, y: [...y.domain(), ...y.range()], bounds: b };
+}
+
+function draw2d(ctx, data, v, gradient, colorOf, dpr) {
+  const { bounds } = v;
+  ctx.save();
+  ctx.scale(dpr, dpr);
+  ctx.beginPath();
+  ctx.rect(bounds.left, bounds.top, bounds.width, bounds.height);
+  ctx.clip();
+  ctx.lineWidth = 1;
+  const [y0, y1, yr0, yr1] = v.y;
+  const ramp = (dgv) => {
+    const t = gradient[1] > gradient[0] ? Math.min(1, Math.max(0, (dgv - gradient[0]) / (gradient[1] - gradient[0]))) : 0;
+    return `hsl(${120 - 120 * t}, 100%, 50%)`;
+  };
+  // One path per colour
+  const paths = new Map();
+  const { time, deltaG } = data.plot;
+  for (let k = 0; k < data.n; k++) {
+    const px = v.xr0 + (time[k] - v.x0) * v.pxPerMs;
+    if (px < bounds.left - 4 || px > bounds.left + bounds.width + 4) continue;
+    const py = yr0 + (deltaG[k] - y0) / (y1 - y0) * (yr1 - yr0);
+    const c = gradient ? ramp(deltaG[k]) : colorOf(k);
+    let path = paths.get(c);
+    if (!path) paths.set(c, path = new Path2D());
+    path.moveTo(px - 3, py - 3); path.lineTo(px + 3, py + 3);
+    path.moveTo(px - 3, py + 3); path.lineTo(px + 3, py - 3);
+  }
+  for (const [c, path] of paths) {
+    ctx.strokeStyle = c;
+    ctx.stroke(path);
+  }
+  ctx.restore();
+}
+
+// plot: the chart's points as columns; colorOf(k): hex colour of point k.
+// gradient: [visible ΔG min, max] in gradient colour mode, else null.
+// Redraws after every parent render (zoom, pan, resize of the chart).
+export default function ScatterLayer({ plot, colorOf, colorKey, gradient, scaleRef, plotBoundsRef }) {
+  const canvasRef = useRef(null);
+  const glRef = useRef(null);          // { gl, state } or { ctx } once set up
+  const uploadedRef = useRef(null);
+  const drawRef = useRef(null);
+
+  // colorOf is recreated every render; colorKey says when its answers change
+  const data = useMemo(() => pack(plot, colorOf), [plot, colorKey]);
+
+  const draw = () => {
+    const canvas = canvasRef.current;
+    if (!canvas) return;
+    const dpr = window.devicePixelRatio || 1;
+    const w = canvas.clientWidth, h = canvas.clientHeight;
+    if (canvas.width !== Math.round(w * dpr) || canvas.height !== Math.round(h * dpr)) {
+      canvas.width = Math.round(w * dpr);
+      canvas.height = Math.round(h * dpr);
+    }
+    if (!glRef.current) {
+      const gl = webglSupported && canvas.getContext('webgl', { antialias: false, premultipliedAlpha: false });
+      try {
+        glRef.current = gl ? { gl, state: setupGl(gl) } : { ctx: canvas.getContext('2d') };
+      } catch {
+        glRef.current = { ctx: canvas.getContext('2d') };
+      }
+    }
+    const v = view(scaleRef, plotBoundsRef);
+    const { gl, state, ctx } = glRef.current;
+    if (ctx) {
+      ctx.clearRect(0, 0, canvas.width, canvas.height);
+      if (v) draw2d(ctx, data, v, gradient, colorOf, dpr);
+      return;
+    }
+    gl.viewport(0, 0, canvas.width, canvas.height);
+    gl.disable(gl.SCISSOR_TEST);
+    gl.clearColor(0, 0, 0, 0);
+    gl.clear(gl.COLOR_BUFFER_BIT);
+    if (!v || !data.n) return;
+    gl.useProgram(state.prog);
+    if (uploadedRef.current !== data) {
+      upload(gl, state, data);
+      uploadedRef.current = data;
+    }
+    const { bounds } = v;
+    gl.enable(gl.SCISSOR_TEST);
+    gl.scissor(Math.floor(bounds.left * dpr), Math.floor((h - bounds.top - bounds.height) * dpr),
+               Math.ceil(bounds.width * dpr), Math.ceil(bounds.height * dpr));
+    const x0 = v.x0 - data.base;
+    const x0hi = Math.fround(x0);
+    const u = state.uniforms;
+    gl.uniform2f(u.u_x0, x0hi, x0 - x0hi);
+    gl.uniform2f(u.u_x, v.pxPerMs, v.xr0);
+    gl.uniform4f(u.u_y, ...v.y);
+    gl.uniform2f(u.u_size, w, h);
+    gl.uniform2f(u.u_grad, gradient ? gradient[0] : 0, gradient ? gradient[1] : 1);
+    gl.uniform1f(u.u_mode, gradient ? 1 : 0);
+    gl.uniform1f(u.u_pt, MARK_PX * dpr);
+    gl.uniform1f(u.u_line, 0.5 * dpr);
+    gl.drawArrays(gl.POINTS, 0, state.count);
+  };
+  drawRef.current = draw;
+
+  useEffect(() => { draw(); });
+
+  // The chart re-lays out on its own when the container resizes
+  useEffect(() => {
+    const canvas = canvasRef.current;
+    if (!canvas || typeof ResizeObserver === 'undefined') return;
+    let frame = 0;
+    const ro = new ResizeObserver(() => {
+      cancelAnimationFrame(frame);
+      frame = requestAnimationFrame(() => drawRef.current());
+    });
+    ro.observe(canvas);
+    return () => { ro.disconnect(); cancelAnimationFrame(frame); };
+  }, []);
+
+  return <canvas ref={canvasRef} className="scatter-layer" />;
+}
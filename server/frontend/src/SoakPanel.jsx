@@ -0,0 +1,159 @@
+import { useState, useEffect, useCallback } from 'react';
+import { ResponsiveContainer, LineChart, Line, CartesianGrid, XAxis, YAxis, Tooltip, Legend } from 'recharts';
+
+// Soak runs (server/lib/soak.js): heap, jitter and latency trends of
+// WAVEFORM_INJECT builds under scheduled injections, per firmware version
+const SOAK_POLL_MS = 30_000;
+const SOAK_CHART_RUNS = 6;
+const SOAK_METRICS = [
+  { key: 'heap_min', label: 'Lowest free heap (B)' },
+  { key: 'heap_block', label: 'Largest block (B)' },
+  { key: 'jitter_p99_ms', label: 'Sample jitter p99 (ms)' },
+  { key: 'loop_p95_us', label: 'Loop pass p95 (µs)' },
+];
+const RUN_COLORS = ['#00d4aa', '#6c8cff', '#ffaa00', '#ff6b6b', '#b07cff', '#66ccff'];
+const REGRESSION_LABELS = {
+  heap_leak: 'heap leak', block: 'smaller block', jitter: 'more jitter', trigger: 'slower trigger', upload: 'slower upload',
+};
+const fmt = (v, unit = '') => (v == null ? '—' : `${v}${unit}`);
+
+export default function SoakPanel({ devices, addToast }) {
+  const [soak, setSoak] = useState(null);              // /api/soak
+  const [metric, setMetric] = useState('heap_min');
+  const [form, setForm] = useState({ id: '', event_id: '', interval_s: 600, hours: 72 });
+
+  const fetchSoak = useCallback(async () => {
+    try {
+      const res = await fetch('/api/soak');
+      if (res.ok) setSoak(await res.json());
+    } catch (err) {
+      console.error('Soak fetch error:', err);
+    }
+  }, []);
+
+  useEffect(() => {
+    fetchSoak();
+    const interval = setInterval(fetchSoak, SOAK_POLL_MS);
+    return () => clearInterval(interval);
+  }, [fetchSoak]);
+
+  const alias = (id) => devices[id]?.alias || id;
+
+  const startSoak = async () => {
+    try {
+      const res = await fetch(`/api/soak/${encodeURIComponent(form.id)}`, {
+        method: 'POST',
+        headers: { 'Content-Type': 'application/json' },
+        body: JSON.stringify({ event_id: form.event_id, interval_s: Number(form.interval_s), hours: Number(form.hours) }),
+      });
+      const body = await res.json();
+      if (!res.ok) throw new Error(body.error);
+      addToast(`Soak started on ${alias(form.id)} until ${new Date(body.ends).toLocaleString()}`, 'info');
+      fetchSoak();
+    } catch (err) {
+      addToast(`Soak not started: ${err.message}`, 'error');
+    }
+  };
+
+  const stopSoak = async (id) => {
+    try {
+      const res = await fetch(`/api/soak/${encodeURIComponent(id)}`, { method: 'DELETE' });
+      if (res.ok) addToast(`Soak stopped on ${alias(id)}`, 'info');
+      fetchSoak();
+    } catch {
+      addToast('Failed to stop the soak', 'error');
+    }
+  };
+
+  const runs = soak?.runs || [];
+  const charted = runs.slice(0, SOAK_CHART_RUNS);
+  const running = runs.filter(r => r.status === 'running');
+
+  return (
+    <div className="admin-panel soak-panel">
+      <div className="panel-header">Soak Tests</div>
+      <div className="panel-body">
+        <p className="config-hint" style={{ marginBottom: 12 }}>
+          Injects a stored capture on a test build (nodemcuv2_inject) every interval and trends its heap,
+          sample jitter and latency over hours or days. A node updated mid-soak starts a run on the new version.
+        </p>
+        <div className="soak-form">
+          <select value={form.id} onChange={e => setForm({ ...form, id: e.target.value })}>
+            <option value="">Device…</option>
+            {Object.keys(devices).map(id => <option key={id} value={id}>{alias(id)}</option>)}
+          </select>
+          <input placeholder="Event id" value={form.event_id} onChange={e => setForm({ ...form, event_id: e.target.value })} />
+          <label>Every (s)</label>
+          <input type="number" value={form.interval_s} onChange={e => setForm({ ...form, interval_s: e.target.value })} />
+          <label>For (h)</label>
+          <input type="number" value={form.hours} onChange={e => setForm({ ...form, hours: e.target.value })} />
+          <button className="reinit-btn" disabled={!form.id || !form.event_id} onClick={startSoak}>▶ Start</button>
+          {running.map(r => (
+            <button key={r._id} className="reinit-btn" onClick={() => stopSoak(r.id)}>■ Stop {alias(r.id)}</button>
+          ))}
+        </div>
+
+        {soak?.firmware?.length > 0 && (
+          <table className="profile-table">
+            <thead>
+              <tr>
+                <th>Firmware</th><th>Runs</th><th>Hours</th><th>Heap trend</th><th>Lowest heap</th><th>Smallest block</th>
+                <th>Jitter p99</th><th>Loop p95</th><th>Trigger p95</th><th>Upload p95</th><th>Missed</th><th>Against previous</th>
+              </tr>
+            </thead>
+            <tbody>
+              {[...soak.firmware].reverse().map(f => (
+                <tr key={f.firmware}>
+                  <td className="mono">v{f.firmware}</td>
+                  <td className="mono">{f.runs}</td>
+                  <td className="mono">{f.hours}</td>
+                  <td className="mono">{fmt(f.heap_slope_bph, ' B/h')}</td>
+                  <td className="mono">{fmt(f.heap_min)}</td>
+                  <td className="mono">{fmt(f.block_min)}</td>
+                  <td className="mono">{fmt(f.jitter_p99_ms, ' ms')}</td>
+                  <td className="mono">{fmt(f.loop_p95_us, ' µs')}</td>
+                  <td className="mono">{fmt(f.trigger_p95_ms, ' ms')}</td>
+                  <td className="mono">{fmt(f.upload_p95_ms, ' ms')}</td>
+                  <td className="mono">{f.missed}</td>
+                  <td className={f.regressions.length ? 'text-offline' : ''}>
+                    {f.previous == null ? '—'
+                      : f.regressions.length ? f.regressions.map(k => REGRESSION_LABELS[k] || k).join(', ')
+                      : `as v${f.previous}`}
+                  </td>
+                </tr>
+              ))}
+            </tbody>
+          </table>
+        )}
+
+        {charted.some(r => r.trend.length > 1) && (
+          <>
+            <div className="soak-form">
+              <select value={metric} onChange={e => setMetric(e.target.value)}>
+                {SOAK_METRICS.map(m => <option key={m.key} value={m.key}>{m.label}</option>)}
+              </select>
+              <span className="config-hint">the newest {charted.length} runs, from each run's start</span>
+            </div>
+            <div className="soak-chart">
+              <ResponsiveContainer width="100%" height="100%">
+                <LineChart margin={{ top: 8, right: 16, bottom: 4, left: 0 }}>
+                  <CartesianGrid strokeDasharray="3 3" stroke="rgba(255,255,255,0.04)" />
+                  <XAxis dataKey="h" type="number" domain={[0, 'dataMax']} tick={{ fill: '#666', fontSize: 11 }}
+                         tickFormatter={h => `${h}h`} />
+                  <YAxis tick={{ fill: '#666', fontSize: 11 }} domain={['auto', 'auto']} />
+                  <Tooltip contentStyle={{ background: '#111', border: '1px solid #333', fontSize: 11 }}
+                           labelFormatter={h => `${h} h`} />
+                  <Legend iconType="circle" iconSize={8} wrapperStyle={{ fontSize: 11, paddingTop: 4 }} />
+                  {charted.map((r, i) => (
+                    <Line key={r._id} data={r.trend} dataKey={metric} name={`v${r.firmware} ${alias(r.id)}`}
+                          stroke={RUN_COLORS[i % RUN_COLORS.length]} dot={false} isAnimationActive={false} connectNulls />
+                  ))}
+                </LineChart>
+              </ResponsiveContainer>
+            </div>
+          </>
+        )}
+      </div>
+    </div>
+  );
+}
@@ -0,0 +1,70 @@
+// ── Virtual table ────────────────────────────────────────────────
+// A data-table that only puts the rows in view (plus OVERSCAN either side)
+// into the DOM; spacer rows above and below keep the scrollbar true to the
+// full list. Rows have a fixed height (ROW_PX, set in App.css too), so the
+// window is arithmetic on scrollTop, redone on scroll and resize. Clicking
+// a sortable header sorts by that column, again to reverse; the sort runs
+// once per rows / column change, not per scroll step.
+//
+// columns: [{ key, label, render(row), sort?(a, b) }]
+import { useEffect, useMemo, useRef, useState } from 'react';
+
+const ROW_PX = 22;
+const OVERSCAN = 10;
+
+export default function VirtualTable({ rows, columns, rowKey, onRowClick, rowClass, rowTitle, className = '' }) {
+  const scrollRef = useRef(null);
+  const [win, setWin] = useState({ top: 0, height: 600 });
+  const [sort, setSort] = useState(null);   // { key, dir: 1 | -1 }
+
+  useEffect(() => {
+    const el = scrollRef.current;
+    if (!el) return;
+    const update = () => setWin({ top: el.scrollTop, height: el.clientHeight });
+    update();
+    el.addEventListener('scroll', update, { passive: true });
+    const ro = typeof ResizeObserver !== 'undefined' ? new ResizeObserver(update) : null;
+    ro?.observe(el);
+    return () => { el.removeEventListener('scroll', update); ro?.disconnect(); };
+  }, []);
+
+  const sorted = useMemo(() => {
+    const col = sort && columns.find(c => c.key === sort.key);
+    if (!col?.sort) return rows;
+    return [...rows].sort((a, b) => sort.dir * col.sort(a, b));
+  }, [rows, columns, sort]);
+
+  const first = Math.max(0, Math.floor(win.top / ROW_PX) - OVERSCAN);
+  const last = Math.min(sorted.length, Math.ceil((win.top + win.height) / ROW_PX) + OVERSCAN);
+
+  const onHeader = (col) => {
+    if (!col.sort) return;
+    setSort(prev => (prev?.key === col.key ? { key: col.key, dir: -prev.dir } : { key: col.key, dir: 1 }));
+  };
+
+  return (
+    <div ref={scrollRef} className={`table-scroll ${className}`}>
+      <table className="data-table virtual">
+        <thead>
+          <tr>
+            {columns.map(col => (
+              <th key={col.key} className={col.sort ? 'sortable' : ''} onClick={() => onHeader(col)}>
+                {col.label}{sort?.key === col.key ? (sort.dir > 0 ? ' ▲' : ' ▼') : ''}
+              </th>
+            ))}
+          </tr>
+        </thead>
+        <tbody>
+          {first > 0 && <tr className="spacer" style={{ height: first * ROW_PX }} />}
+          {sorted.slice(first, last).map((row, i) => (
+            <tr key={rowKey ? rowKey(row) : first + i} className={rowClass?.(row) || ''}
+              onClick={onRowClick ? () => onRowClick(row) : undefined} title={rowTitle?.(row) || ''}>
+              {columns.map(col => <td key={col.key} className={col.className || ''}>{col.render(row)}</td>)}
+            </tr>
+          ))}
+          {last < sorted.length && <tr className="spacer" style={{ height: (sorted.length - last) * ROW_PX }} />}
+        </tbody>
+      </table>
+    </div>
+  );
+}
@@ -0,0 +1,327 @@
+// ── Waveform plot ────────────────────────────────────────────────
+// The event modal's seismograph, drawn on one canvas from the typed arrays
+// waveformCache.js keeps. Lanes (X, Y, Z, or ΔG alone) are stacked on one
+// time scale, so a zoom in any of them zooms them all: drag across a range
+// to zoom to it, wheel to zoom around the cursor, double-click to go back
+// to the whole capture. Each series is decimated per pixel column to its
+// first, lowest, highest and last sample, which keeps every peak at any
+// zoom and draws a 100k-sample capture as fast as a 1k one. Below two
+// samples per pixel it is a plain line. A column without samples breaks
+// the line, so FIFO gaps show.
+//
+// series: [{ key, label, color, offsetMs, wave }]. One series is drawn in
+// the axis colours; several (a consensus overlay) each in their own colour,
+// shifted by offsetMs onto the first one's time. markers are rel_ms lines.
+// Other time series (the config page's telemetry rings) give their own
+// lanes: [{ label, channel, color, format }], with clock 'wall' for epoch
+// ms and trigger false for no line at 0. NaN samples are skipped.
+import { useEffect, useRef } from 'react';
+
+const AXIS_COLORS = ['#ff6644', '#00ff88', '#00aaff'];   // x, y, z
+const DG_COLOR = '#ffaa00';
+const LANES = {
+  axes: [['X', 'ax'], ['Y', 'ay'], ['Z', 'az']],
+  deltag: [['ΔG', 'dg']],
+};
+const PAD = { left: 58, right: 12, top: 6, bottom: 22 };
+const LANE_GAP = 8;
+const MIN_SPAN_MS = 5;
+const WHEEL_ZOOM = 1.25;
+
+// First index with t[i] >= ms
+function lowerBound(t, ms, n) {
+  let lo = 0, hi = n;
+  while (lo < hi) {
+    const mid = (lo + hi) >> 1;
+    if (t[mid] < ms) lo = mid + 1; else hi = mid;
+  }
+  return lo;
+}
+
+// Tick spacing of about `target` ticks over span, on a 1-2-5 ladder
+function niceStep(span, target) {
+  const raw = span / target;
+  const p = 10 ** Math.floor(Math.log10(raw));
+  return [1, 2, 5, 10].map(k => k * p).find(s => s >= raw);
+}
+
+// The same on clock units, for epoch-ms time
+const CLOCK_STEPS = [1, 2, 5, 10, 15, 30, 60, 120, 300, 600, 900, 1800, 3600, 7200, 10800, 21600, 43200, 86400]
+  .map(s => s * 1000);
+function clockStep(span, target) {
+  const raw = span / target;
+  return CLOCK_STEPS.find(s => s >= raw) || Math.ceil(raw / 86_400_000) * 86_400_000;
+}
+
+const fmtSeconds = (ms, step) => `${ms >= 0 ? '+' : ''}${(ms / 1000).toFixed(step < 100 ? 2 : 1)}s`;
+const fmtClock = (ms, step) => {
+  const d = new Date(ms);
+  const hm = d.toLocaleTimeString([], { hour: '2-digit', minute: '2-digit', ...(step < 60_000 ? { second: '2-digit' } : {}) });
+  return step >= 6 * 3_600_000 ? `${d.toLocaleDateString([], { month: 'short', day: 'numeric' })} ${hm}` : hm;
+};
+const fmtG = (g, span) => g.toFixed(span < 0.01 ? 4 : span < 1 ? 3 : 2);
+
+// One series' channel over [x0, x1) at colMs per column -> per column
+// { first, lo, hi, last } or null, or the samples themselves when sparse
+function decimate(wave, channel, offsetMs, x0, x1, cols) {
+  const { t, count } = wave;
+  const v = wave[channel];
+  const from = Math.max(0, lowerBound(t, x0 - offsetMs, count) - 1);
+  const to = Math.min(count, lowerBound(t, x1 - offsetMs, count) + 1);
+  if (to - from <= cols * 2) {
+    const pts = [];
+    for (let i = from; i < to; i++) if (v[i] === v[i]) pts.push([t[i] + offsetMs, v[i]]);
+    return { pts };
+  }
+  const colMs = (x1 - x0) / cols;
+  const out = new Array(cols).fill(null);
+  for (let i = from; i < to; i++) {
+    const c = Math.floor((t[i] + offsetMs - x0) / colMs);
+    if (c < 0 || c >= cols) continue;
+    const s = v[i];
+    if (s !== s) continue;
+    const o = out[c];
+    if (!o) out[c] = { first: s, lo: s, hi: s, last: s };
+    else {
+      if (s < o.lo) o.lo = s;
+      if (s > o.hi) o.hi = s;
+      o.last = s;
+    }
+  }
+  return { cols: out };
+}
+
+export default function WaveformPlot({ series, view = 'axes', lanes, clock = 'relative', trigger = true, markers = [], height = 280 }) {
+  const canvasRef = useRef(null);
+  const stateRef = useRef({ domain: null, drag: null, hover: null });
+  const frameRef = useRef(0);
+  const propsRef = useRef({ series, view, lanes, clock, trigger, markers });
+  propsRef.current = { series, view, lanes, clock, trigger, markers };
+
+  // The whole capture, all series
+  const extent = () => {
+    let lo = Infinity, hi = -Infinity;
+    for (const s of propsRef.current.series) {
+      if (!s.wave?.count) continue;
+      lo = Math.min(lo, s.wave.t[0] + (s.offsetMs || 0));
+      hi = Math.max(hi, s.wave.t[s.wave.count - 1] + (s.offsetMs || 0));
+    }
+    return lo < hi ? [lo, hi] : [0, 1];
+  };
+
+  // New data starts at the whole capture; any other change only redraws
+  useEffect(() => { stateRef.current.domain = null; }, [series, view]);
+  useEffect(() => schedule());
+
+  const schedule = () => {
+    if (!frameRef.current) frameRef.current = requestAnimationFrame(draw);
+  };
+
+  const draw = () => {
+    frameRef.current = 0;
+    const canvas = canvasRef.current;
+    if (!canvas) return;
+    const { series: list, view: v, lanes: given, clock: clk, trigger: showTrigger, markers: marks } = propsRef.current;
+    const wall = clk === 'wall';
+    const st = stateRef.current;
+    const dpr = window.devicePixelRatio || 1;
+    const w = canvas.clientWidth, h = canvas.clientHeight;
+    if (canvas.width !== Math.round(w * dpr) || canvas.height !== Math.round(h * dpr)) {
+      canvas.width = Math.round(w * dpr);
+      canvas.height = Math.round(h * dpr);
+    }
+    const ctx = canvas.getContext('2d');
+    ctx.setTransform(dpr, 0, 0, dpr, 0, 0);
+    ctx.clearRect(0, 0, w, h);
+
+    const [x0, x1] = st.domain || extent();
+    const plotW = Math.max(10, w - PAD.left - PAD.right);
+    const cols = Math.round(plotW);
+    const xAt = ms => PAD.left + ((ms - x0) / (x1 - x0)) * plotW;
+    const lanes = given || (LANES[v] || LANES.axes).map(([label, channel]) => ({ label, channel }));
+    const laneH = (h - PAD.top - PAD.bottom - LANE_GAP * (lanes.length - 1)) / lanes.length;
+    const overlay = list.length > 1;
+
+    // Time grid, shared by every lane
+    const step = (wall ? clockStep : niceStep)(x1 - x0, Math.max(2, plotW / 90));
+    // Wall-clock ticks on local minutes and hours
+    const tz = wall ? -new Date(x0).getTimezoneOffset() * 60_000 : 0;
+    ctx.font = '10px sans-serif';
+    ctx.textAlign = 'center';
+    for (let ms = Math.ceil((x0 + tz) / step) * step - tz; ms <= x1; ms += step) {
+      const x = xAt(ms);
+      ctx.strokeStyle = '#333';
+      ctx.beginPath(); ctx.moveTo(x, PAD.top); ctx.lineTo(x, h - PAD.bottom); ctx.stroke();
+      ctx.fillStyle = '#888';
+      ctx.fillText(wall ? fmtClock(ms, step) : fmtSeconds(ms, step), x, h - PAD.bottom + 14);
+    }
+
+    lanes.forEach(({ label, channel, color, format }, li) => {
+      const top = PAD.top + li * (laneH + LANE_GAP);
+      const data = list.map(s => (s.wave?.count ? decimate(s.wave, channel, s.offsetMs || 0, x0, x1, cols) : null));
+      let lo = Infinity, hi = -Infinity;
+      for (const d of data) {
+        if (!d) continue;
+        if (d.pts) for (const [, y] of d.pts) { if (y < lo) lo = y; if (y > hi) hi = y; }
+        else for (const c of d.cols) if (c) { if (c.lo < lo) lo = c.lo; if (c.hi > hi) hi = c.hi; }
+      }
+      if (!(lo <= hi)) { lo = -1; hi = 1; }
+      const pad = (hi - lo) * 0.06 || Math.abs(hi) * 0.1 || 0.001;
+      lo -= pad; hi += pad;
+      const yAt = g => top + (1 - (g - lo) / (hi - lo)) * laneH;
+
+      ctx.strokeStyle = '#444';
+      ctx.strokeRect(PAD.left + 0.5, top + 0.5, plotW - 1, laneH - 1);
+      ctx.fillStyle = '#888';
+      ctx.textAlign = 'right';
+      for (const g of [hi - pad, (lo + hi) / 2, lo + pad]) ctx.fillText(format ? format(g) : fmtG(g, hi - lo), PAD.left - 6, yAt(g) + 3);
+      ctx.textAlign = 'left';
+      ctx.fillStyle = '#ccc';
+      ctx.fillText(label, PAD.left + 6, top + 12);
+
+      ctx.save();
+      ctx.beginPath();
+      ctx.rect(PAD.left, top, plotW, laneH);
+      ctx.clip();
+      data.forEach((d, si) => {
+        if (!d) return;
+        ctx.strokeStyle = overlay ? list[si].color : color || (channel === 'dg' ? DG_COLOR : AXIS_COLORS[li]);
+        ctx.lineWidth = overlay ? 1 : 1.25;
+        ctx.globalAlpha = overlay ? 0.85 : 1;
+        ctx.beginPath();
+        if (d.pts) {
+          d.pts.forEach(([ms, g], i) => (i ? ctx.lineTo(xAt(ms), yAt(g)) : ctx.moveTo(xAt(ms), yAt(g))));
+        } else {
+          let open = false;
+          d.cols.forEach((c, i) => {
+            if (!c) { open = false; return; }
+            const x = PAD.left + i + 0.5;
+            if (open) ctx.lineTo(x, yAt(c.first)); else ctx.moveTo(x, yAt(c.first));
+            ctx.lineTo(x, yAt(c.lo));
+            ctx.lineTo(x, yAt(c.hi));
+            ctx.lineTo(x, yAt(c.last));
+            open = true;
+          });
+        }
+        ctx.stroke();
+      });
+      ctx.globalAlpha = 1;
+      ctx.lineWidth = 1;
+
+      // The trigger at 0 and any retriggers
+      (showTrigger ? [0, ...marks] : marks).forEach((ms, i) => {
+        if (ms < x0 || ms > x1) return;
+        const first = showTrigger && !i;
+        ctx.strokeStyle = '#ff3366';
+        ctx.globalAlpha = first ? 1 : 0.6;
+        ctx.setLineDash(first ? [4, 2] : [2, 3]);
+        ctx.lineWidth = first ? 2 : 1;
+        ctx.beginPath(); ctx.moveTo(xAt(ms), top); ctx.lineTo(xAt(ms), top + laneH); ctx.stroke();
+      });
+      ctx.setLineDash([]);
+      ctx.globalAlpha = 1;
+      ctx.lineWidth = 1;
+      ctx.restore();
+    });
+
+    // Overlay legend
+    if (overlay) {
+      ctx.textAlign = 'right';
+      let x = w - PAD.right - 6;
+      for (const s of [...list].reverse()) {
+        ctx.fillStyle = s.color;
+        ctx.fillText(s.label, x, PAD.top + 12);
+        x -= ctx.measureText(s.label).width + 12;
+      }
+    }
+
+    // Drag selection and hover readout, across every lane
+    const plotBottom = h - PAD.bottom;
+    if (st.drag && Math.abs(st.drag.to - st.drag.from) > 1) {
+      ctx.fillStyle = 'rgba(255,255,255,0.08)';
+      const a = Math.min(st.drag.from, st.drag.to), b = Math.max(st.drag.from, st.drag.to);
+      ctx.fillRect(a, PAD.top, b - a, plotBottom - PAD.top);
+    } else if (st.hover != null && st.hover >= PAD.left && st.hover <= PAD.left + plotW) {
+      const ms = x0 + ((st.hover - PAD.left) / plotW) * (x1 - x0);
+      ctx.strokeStyle = 'rgba(255,255,255,0.35)';
+      ctx.beginPath(); ctx.moveTo(st.hover + 0.5, PAD.top); ctx.lineTo(st.hover + 0.5, plotBottom); ctx.stroke();
+      const parts = [];
+      for (const s of list) {
+        if (!s.wave?.count) continue;
+        const i = Math.min(s.wave.count - 1, lowerBound(s.wave.t, ms - (s.offsetMs || 0), s.wave.count));
+        const vals = lanes.map(({ label, channel, format }) => {
+          const y = s.wave[channel][i];
+          return `${label} ${format ? format(y) : y.toFixed(5)}`;
+        }).join(' ');
+        parts.push(overlay ? `${s.label}: ${vals}` : vals);
+      }
+      ctx.textAlign = 'left';
+      ctx.fillStyle = '#ddd';
+      const at = wall ? new Date(ms).toLocaleString() : `t = ${ms >= 0 ? '+' : ''}${Math.round(ms)}ms`;
+      ctx.fillText(`${at}  ${parts.join(' · ')}${given ? '' : ' g'}`, PAD.left + 6, plotBottom - 6);
+    }
+  };
+
+  useEffect(() => {
+    const canvas = canvasRef.current;
+    if (!canvas) return;
+    const st = stateRef.current;
+    const px = e => e.clientX - canvas.getBoundingClientRect().left;
+    const toMs = (x) => {
+      const [x0, x1] = st.domain || extent();
+      const plotW = Math.max(10, canvas.clientWidth - PAD.left - PAD.right);
+      return x0 + ((x - PAD.left) / plotW) * (x1 - x0);
+    };
+    const zoomTo = (a, b) => {
+      const [lo, hi] = extent();
+      a = Math.max(lo, a); b = Math.min(hi, b);
+      if (b - a < MIN_SPAN_MS) return;
+      st.domain = a <= lo && b >= hi ? null : [a, b];
+    };
+
+    const onDown = (e) => { st.drag = { from: px(e), to: px(e) }; };
+    const onMove = (e) => {
+      st.hover = px(e);
+      if (st.drag) st.drag.to = st.hover;
+      schedule();
+    };
+    const onUp = () => {
+      const d = st.drag;
+      st.drag = null;
+      if (d && Math.abs(d.to - d.from) > 4) zoomTo(toMs(Math.min(d.from, d.to)), toMs(Math.max(d.from, d.to)));
+      schedule();
+    };
+    const onLeave = () => { st.hover = null; st.drag = null; schedule(); };
+    const onWheel = (e) => {
+      e.preventDefault();
+      const [x0, x1] = st.domain || extent();
+      const at = toMs(px(e));
+      const k = e.deltaY > 0 ? WHEEL_ZOOM : 1 / WHEEL_ZOOM;
+      zoomTo(at - (at - x0) * k, at + (x1 - at) * k);
+      schedule();
+    };
+    const onDouble = () => { st.domain = null; schedule(); };
+
+    canvas.addEventListener('mousedown', onDown);
+    canvas.addEventListener('mousemove', onMove);
+    window.addEventListener('mouseup', onUp);
+    canvas.addEventListener('mouseleave', onLeave);
+    canvas.addEventListener('wheel', onWheel, { passive: false });
+    canvas.addEventListener('dblclick', onDouble);
+    const ro = typeof ResizeObserver !== 'undefined' ? new ResizeObserver(schedule) : null;
+    ro?.observe(canvas);
+    return () => {
+      canvas.removeEventListener('mousedown', onDown);
+      canvas.removeEventListener('mousemove', onMove);
+      window.removeEventListener('mouseup', onUp);
+      canvas.removeEventListener('mouseleave', onLeave);
+      canvas.removeEventListener('wheel', onWheel);
+      canvas.removeEventListener('dblclick', onDouble);
+      ro?.disconnect();
+      cancelAnimationFrame(frameRef.current);
+      frameRef.current = 0;
+    };
+  }, []);
+
+  return <canvas ref={canvasRef} className="waveform-plot" style={{ height }} />;
+}
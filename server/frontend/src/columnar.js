@@ -0,0 +1,110 @@
+// ── Columnar event lists ─────────────────────────────────────────
+// Decoder for /api/events' `application/vnd.seismo.events` body; layout in
+// server/lib/columnar.js. Returns the same objects the JSON body holds,
+// newest first.
+
+export const EVENTS_CONTENT_TYPE = 'application/vnd.seismo.events';
+
+const HEADER_SIZE = 16;
+
+export function decodeEvents(buffer) {
+  const view = new DataView(buffer);
+  const magic = String.fromCharCode(...new Uint8Array(buffer, 0, 4));
+  if (magic !== 'SEV1') throw new Error('bad columnar events header');
+  const n = view.getUint32(4, true);
+  const trailerBytes = view.getUint32(8, true);
+
+  const offDelta = HEADER_SIZE + n * 8;
+  const offId = offDelta + n * 8;
+  const offDevice = offId + n * 12;
+  const offLevel = offDevice + n * 2;
+  const offTrigger = offLevel + n;
+  const offSource = offTrigger + n;
+  const offFlags = offSource + n;
+  const offTrailer = (offFlags + n + 3) & ~3;
+
+  const time = new Float64Array(buffer, HEADER_SIZE, n);
+  const deltaG = new Float64Array(buffer, offDelta, n);
+  const ids = new Uint8Array(buffer, offId, n * 12);
+  const device = new Uint16Array(buffer, offDevice, n);
+  const bytes = new Uint8Array(buffer);
+  const trailer = JSON.parse(new TextDecoder().decode(new Uint8Array(buffer, offTrailer, trailerBytes)));
+
+  const hex = [];
+  for (let b = 0; b < 256; b++) hex.push(b.toString(16).padStart(2, '0'));
+  const events = new Array(n);
+  for (let i = 0; i < n; i++) {
+    let _id = '';
+    for (let k = i * 12; k < i * 12 + 12; k++) _id += hex[ids[k]];
+    const [id, alias] = trailer.devices[device[i]];
+    const e = {
+      _id,
+      timestamp: new Date(time[i]).toISOString(),
+      deltaG: deltaG[i],
+      id,
+      alias,
+      level: trailer.levels[bytes[offLevel + i]],
+      trigger: trailer.triggers[bytes[offTrigger + i]],
+      has_waveform: (bytes[offFlags + i] & 1) === 1,
+      ...trailer.extras[i],
+    };
+    const source = trailer.time_sources[bytes[offSource + i]];
+    if (source) e.time_source = source;
+    events[i] = e;
+  }
+  if (!trailer.others.length) return events;
+  return [...events, ...trailer.others].sort((a, b) => new Date(b.timestamp) - new Date(a.timestamp));
+}
+
+// ── Aligned waveforms ────────────────────────────────────────────
+// /api/waveforms?format=binary ('SWG1', server/lib/columnar.js): -> { start_ms,
+// step_ms, count, series: [{ ...trailer fields, ax, ay, az }] } with each
+// axis a Float32Array view on the body (NaN outside that capture)
+
+export const WAVEFORMS_CONTENT_TYPE = 'application/vnd.seismo.waveforms';
+
+const WAVEFORMS_HEADER_SIZE = 32;
+
+export function decodeWaveforms(buffer) {
+  const view = new DataView(buffer);
+  const magic = String.fromCharCode(...new Uint8Array(buffer, 0, 4));
+  if (magic !== 'SWG1') throw new Error('bad aligned waveforms header');
+  const n = view.getUint32(4, true);
+  const count = view.getUint32(8, true);
+  const trailerBytes = view.getUint32(12, true);
+  const offTrailer = WAVEFORMS_HEADER_SIZE + n * 3 * count * 4;
+  const trailer = JSON.parse(new TextDecoder().decode(new Uint8Array(buffer, offTrailer, trailerBytes)));
+  const column = (i, axis) => new Float32Array(buffer, WAVEFORMS_HEADER_SIZE + (i * 3 + axis) * count * 4, count);
+  return {
+    start_ms: view.getFloat64(16, true),
+    step_ms: view.getFloat64(24, true),
+    count,
+    series: trailer.series.map((s, i) => ({ ...s, ax: column(i, 0), ay: column(i, 1), az: column(i, 2) })),
+  };
+}
+
+// ── Spectrogram tiles ────────────────────────────────────────────
+// /api/events/:id/spectrogram ('SPG1', server/lib/columnar.js): -> the
+// header fields, with data a Uint8Array view, frame-major frames × bins,
+// 0 = db_min .. 255 = db_max
+
+export const SPECTROGRAM_CONTENT_TYPE = 'application/vnd.seismo.spectrogram';
+
+const SPECTROGRAM_HEADER_SIZE = 40;
+const SPECTROGRAM_FLOATS = ['rate_hz', 't0_ms', 'ms_per_frame', 'hz_per_bin', 'db_min', 'db_max'];
+
+export function decodeSpectrogram(buffer) {
+  const view = new DataView(buffer);
+  const magic = String.fromCharCode(...new Uint8Array(buffer, 0, 4));
+  if (magic !== 'SPG1') throw new Error('bad spectrogram header');
+  const s = {
+    frames: view.getUint16(4, true),
+    bins: view.getUint16(6, true),
+    window: view.getUint16(8, true),
+    hop: view.getUint16(10, true),
+    axis: view.getUint8(12),
+  };
+  SPECTROGRAM_FLOATS.forEach((k, i) => { s[k] = view.getFloat32(16 + i * 4, true); });
+  s.data = new Uint8Array(buffer, SPECTROGRAM_HEADER_SIZE, s.frames * s.bins);
+  return s;
+}
@@ -0,0 +1,92 @@
+// ── Event index ──────────────────────────────────────────────────
+// Lookups over the period's seismic events as time-sorted columns (kept by
+// events.worker.js), so the questions asked on every zoom and pan step are
+// O(log n) instead of a pass over the list: the time bounds, ΔG min/max
+// over a time range (segment tree over the sorted ΔG values), and events
+// per level in a range (prefix counts). Times are epoch ms, ranges
+// inclusive at both ends. indexColumns() runs in the worker and its arrays
+// are transferred; eventIndex() wraps them on the main thread.
+
+export const LEVELS = ['minor', 'moderate', 'severe'];
+
+// deltaG and level (index into LEVELS, 255 = other) of the first n events,
+// time ascending. Given the previous index and the first row that changed
+// since, only the rows from there on (and their tree ancestors) are
+// recomputed, so an append costs O(log n); a fresh index is built when
+// there is none or it has run out of room.
+export function indexColumns(deltaG, level, n, prev = null, from = 0) {
+  let index = prev;
+  if (!index || n > index.size) {
+    let size = 1;
+    while (size < n) size <<= 1;
+    index = { size, n: 0, min: new Float64Array(2 * size).fill(Infinity), max: new Float64Array(2 * size).fill(-Infinity),
+              counts: LEVELS.map(() => new Uint32Array(size + 1)) };   // counts[l][i]: events < i of level l
+    from = 0;
+  }
+  const { size, min, max, counts } = index;
+  const upto = Math.max(n, index.n);
+  for (let i = from; i < upto; i++) {
+    min[size + i] = i < n ? deltaG[i] : Infinity;
+    max[size + i] = i < n ? deltaG[i] : -Infinity;
+  }
+  for (let i = from; i < n; i++) {
+    for (let l = 0; l < LEVELS.length; l++) counts[l][i + 1] = counts[l][i] + (level[i] === l ? 1 : 0);
+  }
+  for (let lo = (size + from) >> 1, hi = (size + Math.max(upto, 1) - 1) >> 1; lo >= 1; lo >>= 1, hi >>= 1) {
+    for (let k = lo; k <= hi; k++) {
+      min[k] = Math.min(min[2 * k], min[2 * k + 1]);
+      max[k] = Math.max(max[2 * k], max[2 * k + 1]);
+    }
+  }
+  index.n = n;
+  return index;
+}
+
+// time: the view's column; rows before from are older than the period
+export function eventIndex({ time, from = 0, index: { size, min, max, counts } }) {
+  const end = time.length;
+  const n = end - from;
+
+  // First index (>= from) whose time is >= t (after: > t)
+  const bisect = (t, after = false) => {
+    let lo = from, hi = end;
+    while (lo < hi) {
+      const mid = (lo + hi) >> 1;
+      if (time[mid] < t || (after && time[mid] === t)) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+  };
+
+  return {
+    n,
+    first: n ? time[from] : null,
+    last: n ? time[end - 1] : null,
+
+    // -> [from, to) positions of the events in [t0, t1]
+    span(t0 = -Infinity, t1 = Infinity) {
+      return [bisect(t0), bisect(t1, true)];
+    },
+
+    // -> [min, max] ΔG of the events in [t0, t1], or null if there are none
+    deltaRange(t0 = -Infinity, t1 = Infinity) {
+      let [lo, hi] = this.span(t0, t1);
+      if (lo >= hi) return null;
+      let mn = Infinity, mx = -Infinity;
+      for (lo += size, hi += size; lo < hi; lo >>= 1, hi >>= 1) {
+        if (lo & 1) { mn = Math.min(mn, min[lo]); mx = Math.max(mx, max[lo]); lo++; }
+        if (hi & 1) { hi--; mn = Math.min(mn, min[hi]); mx = Math.max(mx, max[hi]); }
+      }
+      return [mn, mx];
+    },
+
+    // Events in [t0, t1]; with levels ({ minor: bool, ... }) only those shown
+    count(t0 = -Infinity, t1 = Infinity, levels = null) {
+      const [lo, hi] = this.span(t0, t1);
+      if (lo >= hi) return 0;
+      if (!levels) return hi - lo;
+      let total = 0;
+      LEVELS.forEach((l, k) => { if (levels[l]) total += counts[k][hi] - counts[k][lo]; });
+      return total;
+    },
+  };
+}
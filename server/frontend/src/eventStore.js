@@ -0,0 +1,43 @@
+// ── Event store client ───────────────────────────────────────────
+// Main-thread side of events.worker.js: posts pages, changes and socket
+// pushes to it, and hands each view it sends back to onView. get() and
+// range() answer with whole event objects for one row (by its seq) or a
+// time span. keepMs: how far back the store holds events. restore() and
+// snapshot() keep the list across reloads (snapshot.js).
+
+export function createEventStore(onView, keepMs) {
+  const worker = new Worker(new URL('./events.worker.js', import.meta.url), { type: 'module' });
+  const waiting = new Map();
+  let req = 0;
+  worker.onmessage = ({ data }) => {
+    if (data.type === 'view') onView(data.view);
+    else if (data.type === 'reply') {
+      waiting.get(data.req)?.(data.result);
+      waiting.delete(data.req);
+    }
+  };
+  if (keepMs) worker.postMessage({ type: 'keep', ms: keepMs });
+  const ask = (msg) => new Promise((resolve) => {
+    const id = ++req;
+    waiting.set(id, resolve);
+    worker.postMessage({ ...msg, req: id });
+  });
+
+  return {
+    // pages: [{ buffer: ArrayBuffer } | { text: JSON string }], transferred
+    load(pages) {
+      worker.postMessage({ type: 'load', pages }, pages.map(p => p.buffer).filter(Boolean));
+    },
+    merge(events) { worker.postMessage({ type: 'merge', events }); },
+    upsert(entry) { worker.postMessage({ type: 'upsert', entry }); },
+    patch(_id, fields) { worker.postMessage({ type: 'patch', _id, fields }); },
+    setPeriod(ms) { worker.postMessage({ type: 'period', ms }); },
+    get(seq) { return ask({ type: 'get', seq }); },
+    range(t0, t1) { return ask({ type: 'range', t0, t1 }); },
+    // -> { cursor, savedAt, count } with the snapshot loaded, or null
+    restore() { return ask({ type: 'restore' }); },
+    // The list is current to this changes cursor; saved a little later
+    snapshot(cursor) { worker.postMessage({ type: 'snapshot', cursor }); },
+    close() { worker.terminate(); },
+  };
+}
@@ -0,0 +1,305 @@
+// ── Event store worker ───────────────────────────────────────────
+// Holds the dashboard's event list off the main thread. /api/events pages
+// arrive as transferred columnar buffers (or JSON text) and are decoded
+// here; /api/events/changes and the socket pushes are merged in by _id.
+//
+// Seismic events are kept as time-sorted columns that grow in place: a
+// push is a binary search and a copyWithin (nothing to move for the usual
+// newest-at-the-end event), and only the index rows from the first changed
+// one on are recomputed. A page of changes large enough to make that
+// slower than starting over rebuilds the columns instead. After a change
+// (coalesced, one post per burst) it posts the view App renders, with
+// every array a transferred copy:
+//   the columns: time, deltaG, level / trigger / device codes with their
+//   dictionaries, a waveform flag, seq (a stable row handle), and the
+//   eventIndex.js arrays; rows before from are older than the period
+//   consensus entries of the period as objects (a handful)
+// Whole events are asked for by seq or time span when the dashboard needs
+// one (modal, range table), so the full objects never cross in bulk.
+//
+// Once App has a changes cursor the list is current to, 'snapshot' writes
+// every event with that cursor to IndexedDB (snapshot.js), at most every
+// SNAPSHOT_EVERY_MS; 'restore' loads it back on the next start.
+import { decodeEvents } from './columnar';
+import { indexColumns, LEVELS } from './eventIndex';
+import { readSnapshot, writeSnapshot } from './snapshot';
+
+const BULK_ABOVE = 256;       // changes in one message before the columns are rebuilt instead
+const PRUNE_ABOVE = 4096;     // rows older than keepMs before they are dropped
+const SNAPSHOT_EVERY_MS = 30_000;
+
+let periodMs = 604_800_000;
+let keepMs = Infinity;
+let scheduled = false;
+let version = 0;
+
+const byId = new Map();       // _id → event, wherever it is kept
+const bySeq = new Map();      // seq → seismic event
+let consensus = [];           // newest first
+let loose = [];               // seismic rows without an _id (no merging for those)
+let nextSeq = 1;
+
+// Seismic rows, time ascending; rows[i] is the event of column row i
+let cap = 0;
+let n = 0;
+let rows = [];
+let cols = null;
+cols = alloc(1024);
+const devices = [], deviceCode = new Map();
+const triggers = [], triggerCode = new Map();
+let index = null;
+let dirtyFrom = 0;            // first row whose columns changed since the last index update
+
+function alloc(size) {
+  const next = {
+    time: new Float64Array(size), deltaG: new Float64Array(size), level: new Uint8Array(size),
+    trigger: new Uint8Array(size), device: new Uint16Array(size), waveform: new Uint8Array(size),
+    seq: new Uint32Array(size),
+  };
+  if (cols) for (const k in next) next[k].set(cols[k].subarray(0, n));
+  cap = size;
+  return next;
+}
+
+const timeOf = (e) => new Date(e.timestamp).getTime();
+const kind = (e) => (e.status === 'PULLED' ? null
+  : e.status === 'CONFIRMED' ? 'consensus'
+  : e.deltaG !== undefined ? 'seismic' : null);
+
+function code(dict, codes, key) {
+  if (!codes.has(key)) { codes.set(key, dict.length); dict.push(key); }
+  return codes.get(key);
+}
+
+// First row whose time is >= t (after: > t)
+function bisect(t, after = false) {
+  let lo = 0, hi = n;
+  while (lo < hi) {
+    const mid = (lo + hi) >> 1;
+    if (cols.time[mid] < t || (after && cols.time[mid] === t)) lo = mid + 1; else hi = mid;
+  }
+  return lo;
+}
+
+function writeRow(i, e) {
+  cols.time[i] = e._time;
+  cols.deltaG[i] = e.deltaG;
+  const l = LEVELS.indexOf(e.level);
+  cols.level[i] = l < 0 ? 255 : l;
+  cols.device[i] = code(devices, deviceCode, e.alias || e.id || 'Unknown');
+  cols.trigger[i] = code(triggers, triggerCode, e.trigger ?? null);
+  cols.waveform[i] = e.has_waveform ? 1 : 0;
+  cols.seq[i] = e._seq;
+  rows[i] = e;
+  if (i < dirtyFrom) dirtyFrom = i;
+}
+
+function insertRow(e) {
+  if (n === cap) cols = alloc(cap * 2);
+  const at = bisect(e._time, true);
+  if (at < n) for (const k in cols) cols[k].copyWithin(at + 1, at, n);
+  rows.splice(at, 0, e);
+  n++;
+  e._seq = e._seq || nextSeq++;
+  bySeq.set(e._seq, e);
+  writeRow(at, e);
+}
+
+function removeRow(e) {
+  let at = bisect(e._time);
+  while (at < n && rows[at] !== e) at++;
+  if (at === n) return;
+  for (const k in cols) cols[k].copyWithin(at, at + 1, n);
+  rows.splice(at, 1);
+  n--;
+  bySeq.delete(e._seq);
+  if (at < dirtyFrom) dirtyFrom = at;
+}
+
+function drop(e) {
+  const was = kind(e);
+  if (was === 'seismic') removeRow(e);
+  else if (was === 'consensus') consensus = consensus.filter(x => x !== e);
+}
+
+function keep(e) {
+  const is = kind(e);
+  if (is === 'seismic') insertRow(e);
+  else if (is === 'consensus') {
+    const at = consensus.findIndex(c => c._time < e._time);
+    at < 0 ? consensus.push(e) : consensus.splice(at, 0, e);
+  }
+}
+
+// One event in; prefer: 'new' (a fresher copy) or 'old' (a refetch racing
+// a socket push, which is newer than the page it was fetched with)
+function put(entry, prefer = 'new') {
+  const old = entry._id ? byId.get(entry._id) : null;
+  if (!old) {
+    const e = { ...entry, _time: timeOf(entry) };
+    if (e._id) byId.set(e._id, e);
+    else if (kind(e) === 'seismic') loose.push(e);
+    keep(e);
+    return;
+  }
+  const merged = prefer === 'old' ? { ...entry, ...old } : { ...old, ...entry };
+  merged._time = timeOf(merged);
+  const moved = kind(old) !== kind(merged) || old._time !== merged._time;
+  if (moved) {
+    drop(old);
+    byId.set(merged._id, merged);
+    keep(merged);
+    return;
+  }
+  byId.set(merged._id, merged);
+  if (kind(merged) === 'seismic') {
+    let at = bisect(old._time);
+    while (rows[at] !== old) at++;
+    bySeq.set(merged._seq, merged);
+    writeRow(at, merged);
+  } else if (kind(merged) === 'consensus') {
+    consensus[consensus.indexOf(old)] = merged;
+  }
+}
+
+// Many events in: merge by _id, then lay the columns out again in one sort
+function putAll(entries, prefer) {
+  for (const entry of entries) {
+    const old = entry._id ? byId.get(entry._id) : null;
+    if (!entry._id) {
+      const e = { ...entry, _time: timeOf(entry) };
+      if (kind(e) === 'seismic') loose.push(e);
+      continue;
+    }
+    const e = old ? (prefer === 'old' ? { ...entry, ...old } : { ...old, ...entry }) : { ...entry };
+    e._time = timeOf(e);
+    byId.set(e._id, e);
+  }
+  const seismic = [...loose];
+  consensus = [];
+  for (const e of byId.values()) {
+    const is = kind(e);
+    if (is === 'seismic') seismic.push(e);
+    else if (is === 'consensus') consensus.push(e);
+  }
+  seismic.sort((a, b) => a._time - b._time);
+  consensus.sort((a, b) => b._time - a._time);
+  n = 0;
+  rows = [];
+  bySeq.clear();
+  if (seismic.length > cap) cols = alloc(Math.max(cap * 2, seismic.length));
+  for (const e of seismic) {
+    e._seq = e._seq || nextSeq++;
+    bySeq.set(e._seq, e);
+    writeRow(n++, e);
+  }
+  dirtyFrom = 0;
+}
+
+function apply(entries, prefer) {
+  if (entries.length > BULK_ABOVE) putAll(entries, prefer);
+  else for (const e of entries) put(e, prefer);
+  changed();
+}
+
+// Rows that fell out of the longest period, once there are enough to matter
+function prune() {
+  const cutoff = Date.now() - keepMs;
+  const old = bisect(cutoff);
+  if (old < PRUNE_ABOVE) return;
+  for (const e of rows.slice(0, old)) {
+    if (e._id) byId.delete(e._id);
+    bySeq.delete(e._seq);
+  }
+  if (loose.length) loose = loose.filter(e => e._time >= cutoff);
+  for (const k in cols) cols[k].copyWithin(0, old, n);
+  rows = rows.slice(old);
+  n -= old;
+  dirtyFrom = 0;
+}
+
+// The list as stored events: without the worker's own fields, which a
+// restore assigns afresh
+let snapshotCursor = null;
+let snapshotTimer = 0;
+let snapshotLast = 0;
+
+function saveSnapshot() {
+  snapshotTimer = 0;
+  snapshotLast = Date.now();
+  const events = [...byId.values(), ...loose].map(({ _time, _seq, ...e }) => e);
+  return writeSnapshot({ events, cursor: snapshotCursor, savedAt: snapshotLast });
+}
+
+function scheduleSnapshot(cursor) {
+  snapshotCursor = cursor;
+  if (snapshotTimer) return;
+  snapshotTimer = setTimeout(saveSnapshot, Math.max(0, snapshotLast + SNAPSHOT_EVERY_MS - Date.now()));
+}
+
+function changed() {
+  if (scheduled) return;
+  scheduled = true;
+  setTimeout(() => { scheduled = false; post(); }, 0);
+}
+
+function post() {
+  prune();
+  index = indexColumns(cols.deltaG, cols.level, n, index, dirtyFrom);
+  dirtyFrom = n;
+  const cutoff = Date.now() - periodMs;
+  const copy = {};
+  for (const k in cols) copy[k] = cols[k].slice(0, n);
+  const idx = { size: index.size, min: index.min.slice(), max: index.max.slice(),
+                counts: index.counts.map(c => c.slice(0, n + 1)) };
+  version++;
+  const view = {
+    version, from: bisect(cutoff), ...copy, devices: [...devices], triggers: [...triggers], index: idx,
+    consensus: consensus.filter(e => e._time >= cutoff),
+  };
+  self.postMessage({ type: 'view', view }, [
+    ...Object.values(copy).map(a => a.buffer), idx.min.buffer, idx.max.buffer, ...idx.counts.map(c => c.buffer),
+  ]);
+}
+
+self.onmessage = ({ data: msg }) => {
+  switch (msg.type) {
+    case 'load':       // a full refetch; anything pushed meanwhile is kept
+      apply(msg.pages.flatMap(p => (p.buffer ? decodeEvents(p.buffer) : JSON.parse(p.text))), 'old');
+      break;
+    case 'merge':
+      apply(msg.events, 'new');
+      break;
+    case 'upsert':     // a socket push: a new event, or a newer version of one
+      apply([msg.entry], 'new');
+      break;
+    case 'patch':
+      if (byId.has(msg._id)) apply([{ _id: msg._id, ...msg.fields }], 'new');
+      break;
+    case 'period':
+      periodMs = msg.ms;
+      changed();
+      break;
+    case 'keep':
+      keepMs = msg.ms;
+      break;
+    case 'snapshot':
+      scheduleSnapshot(msg.cursor);
+      break;
+    case 'restore':    // before the first load: a snapshot older than keepMs is of no use
+      readSnapshot().then((snap) => {
+        const usable = snap?.cursor && Date.now() - snap.savedAt < keepMs;
+        if (usable) apply(snap.events, 'old');
+        self.postMessage({ type: 'reply', req: msg.req,
+          result: usable ? { cursor: snap.cursor, savedAt: snap.savedAt, count: snap.events.length } : null });
+      });
+      break;
+    case 'get':
+      self.postMessage({ type: 'reply', req: msg.req, result: bySeq.get(msg.seq) ?? null });
+      break;
+    case 'range':
+      self.postMessage({ type: 'reply', req: msg.req,
+        result: rows.slice(bisect(msg.t0), bisect(msg.t1, true)) });
+      break;
+  }
+};
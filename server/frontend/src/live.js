@@ -0,0 +1,30 @@
+// ── Live channel client ──────────────────────────────────────────
+// Socket.IO connection that subscribes through the handshake (protocol in
+// server/lib/live.js) and remembers the last sequence number seen, so a
+// reconnect is replayed what it missed. onResync runs when it couldn't be
+// (server restarted, or away longer than the replay buffer) and the caller
+// should refetch instead. Packets are msgpack (socketParser.js), which the
+// server requires.
+import { io } from 'socket.io-client';
+import * as parser from './socketParser';
+
+export function connectLive({ channels, types, devices = null }, onResync) {
+  let seq = null;
+  let epoch = null;
+  const socket = io(window.location.origin, {
+    transports: ['websocket', 'polling'],
+    parser,
+    auth: (cb) => cb({ channels, types, devices, since: seq, epoch }),
+  });
+  socket.onAny((event, payload, s) => {
+    if (Number.isFinite(s) && (seq === null || s > seq)) seq = s;
+  });
+  socket.on('live:resume', (ack) => {
+    const reconnect = epoch !== null;
+    epoch = ack.epoch;
+    if (ack.resumed) return;
+    seq = ack.seq;
+    if (reconnect) onResync?.();
+  });
+  return socket;
+}
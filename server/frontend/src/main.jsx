@@ -1,10 +1,12 @@
-import React from 'react';
+import React, { Suspense, lazy } from 'react';
 import ReactDOM from 'react-dom/client';
 import { BrowserRouter, Routes, Route } from 'react-router-dom';
-import App from './App';
-import Admin from './Admin';
 import './App.css';
-import './Admin.css';
+
+// Each route is its own chunk: the dashboard never loads the admin page's
+// code, and the admin page never loads the charts
+const App = lazy(() => import('./App'));
+const Admin = lazy(() => import('./Admin'));
 
 class ErrorBoundary extends React.Component {
   constructor(props){
@@ -31,14 +33,23 @@ class ErrorBoundary extends React.Component {
   }
 }
 
+// The app shell offline (public/sw.js); dev serves from Vite instead
+if (import.meta.env.PROD && 'serviceWorker' in navigator) {
+  window.addEventListener('load', () => {
+    navigator.serviceWorker.register('/sw.js').catch(err => console.warn('Service worker not registered:', err));
+  });
+}
+
 ReactDOM.createRoot(document.getElementById('root')).render(
   <React.StrictMode>
     <ErrorBoundary>
       <BrowserRouter>
-        <Routes>
-          <Route path="/" element={<App />} />
-          <Route path="/admin" element={<Admin />} />
-        </Routes>
+        <Suspense fallback={<div className="route-loading">Loading...</div>}>
+          <Routes>
+            <Route path="/" element={<App />} />
+            <Route path="/admin" element={<Admin />} />
+          </Routes>
+        </Suspense>
       </BrowserRouter>
     </ErrorBoundary>
   </React.StrictMode>
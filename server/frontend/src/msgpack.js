@@ -0,0 +1,161 @@
+// ── MessagePack ──────────────────────────────────────────────────
+// The browser side of server/lib/msgpack.js, for the socket parser
+// (socketParser.js): nil/bool/ints/floats/str/bin/array/map, no ext types.
+// encode() follows JSON.stringify as the server's does; bins decode to
+// Uint8Array views on the message, so a binary frame isn't copied.
+
+const utf8 = new TextEncoder();
+const text = new TextDecoder();
+
+export function decode(bytes) {
+  const buf = bytes instanceof Uint8Array ? bytes : new Uint8Array(bytes);
+  const view = new DataView(buf.buffer, buf.byteOffset, buf.byteLength);
+  let pos = 0;
+
+  const need = (n) => {
+    if (pos + n > buf.length) throw new Error('msgpack: truncated');
+  };
+  const str = (n) => { need(n); const s = text.decode(buf.subarray(pos, pos + n)); pos += n; return s; };
+  const bin = (n) => { need(n); const b = buf.subarray(pos, pos + n); pos += n; return b; };
+  const arr = (n) => { const a = new Array(n); for (let i = 0; i < n; i++) a[i] = value(); return a; };
+  const map = (n) => {
+    const m = {};
+    for (let i = 0; i < n; i++) { const k = value(); m[k] = value(); }
+    return m;
+  };
+  const read = (n, get) => { need(n); const v = get(pos); pos += n; return v; };
+
+  function value() {
+    need(1);
+    const b = buf[pos++];
+    if (b <= 0x7f) return b;
+    if (b >= 0xe0) return b - 0x100;
+    if ((b & 0xf0) === 0x80) return map(b & 0x0f);
+    if ((b & 0xf0) === 0x90) return arr(b & 0x0f);
+    if ((b & 0xe0) === 0xa0) return str(b & 0x1f);
+    switch (b) {
+      case 0xc0: return null;
+      case 0xc2: return false;
+      case 0xc3: return true;
+      case 0xc4: return bin(read(1, p => view.getUint8(p)));
+      case 0xc5: return bin(read(2, p => view.getUint16(p)));
+      case 0xc6: return bin(read(4, p => view.getUint32(p)));
+      case 0xca: return read(4, p => view.getFloat32(p));
+      case 0xcb: return read(8, p => view.getFloat64(p));
+      case 0xcc: return read(1, p => view.getUint8(p));
+      case 0xcd: return read(2, p => view.getUint16(p));
+      case 0xce: return read(4, p => view.getUint32(p));
+      case 0xcf: return read(8, p => Number(view.getBigUint64(p)));
+      case 0xd0: return read(1, p => view.getInt8(p));
+      case 0xd1: return read(2, p => view.getInt16(p));
+      case 0xd2: return read(4, p => view.getInt32(p));
+      case 0xd3: return read(8, p => Number(view.getBigInt64(p)));
+      case 0xd9: return str(read(1, p => view.getUint8(p)));
+      case 0xda: return str(read(2, p => view.getUint16(p)));
+      case 0xdb: return str(read(4, p => view.getUint32(p)));
+      case 0xdc: return arr(read(2, p => view.getUint16(p)));
+      case 0xdd: return arr(read(4, p => view.getUint32(p)));
+      case 0xde: return map(read(2, p => view.getUint16(p)));
+      case 0xdf: return map(read(4, p => view.getUint32(p)));
+      default: throw new Error(`msgpack: unsupported type 0x${b.toString(16)}`);
+    }
+  }
+
+  return value();
+}
+
+// -> Uint8Array
+export function encode(value) {
+  let buf = new Uint8Array(256);
+  let view = new DataView(buf.buffer);
+  let pos = 0;
+
+  const room = (n) => {
+    if (pos + n <= buf.length) return;
+    const next = new Uint8Array(Math.max(buf.length * 2, pos + n));
+    next.set(buf.subarray(0, pos));
+    buf = next;
+    view = new DataView(buf.buffer);
+  };
+  const byte = (b) => { room(1); buf[pos++] = b; };
+  const head = (b, n, width) => {
+    room(1 + width);
+    buf[pos++] = b;
+    if (width === 1) view.setUint8(pos, n);
+    else if (width === 2) view.setUint16(pos, n);
+    else view.setUint32(pos, n);
+    pos += width;
+  };
+  const fixed = (b, n, set) => { room(1 + n); buf[pos] = b; set(pos + 1); pos += 1 + n; };
+
+  const int = (v) => {
+    if (v >= 0) {
+      if (v <= 0x7f) return byte(v);
+      if (v <= 0xff) return head(0xcc, v, 1);
+      if (v <= 0xffff) return head(0xcd, v, 2);
+      if (v <= 0xffffffff) return head(0xce, v, 4);
+      return fixed(0xcf, 8, p => view.setBigUint64(p, BigInt(v)));
+    }
+    if (v >= -32) return byte(v + 0x100);
+    if (v >= -0x80) return fixed(0xd0, 1, p => view.setInt8(p, v));
+    if (v >= -0x8000) return fixed(0xd1, 2, p => view.setInt16(p, v));
+    if (v >= -0x80000000) return fixed(0xd2, 4, p => view.setInt32(p, v));
+    return fixed(0xd3, 8, p => view.setBigInt64(p, BigInt(v)));
+  };
+
+  const put = (v) => {
+    if (v === null || v === undefined) return byte(0xc0);
+    switch (typeof v) {
+      case 'boolean': return byte(v ? 0xc3 : 0xc2);
+      case 'number':
+        if (!Number.isFinite(v)) return byte(0xc0);
+        if (Number.isSafeInteger(v)) return int(v);
+        return fixed(0xcb, 8, p => view.setFloat64(p, v));
+      case 'bigint': return put(Number(v));
+      case 'string': {
+        const bytes = utf8.encode(v);
+        const n = bytes.length;
+        if (n < 32) byte(0xa0 | n);
+        else if (n <= 0xff) head(0xd9, n, 1);
+        else if (n <= 0xffff) head(0xda, n, 2);
+        else head(0xdb, n, 4);
+        room(n);
+        buf.set(bytes, pos);
+        pos += n;
+        return;
+      }
+      case 'function':
+      case 'symbol':
+        return byte(0xc0);
+    }
+    if (ArrayBuffer.isView(v) || v instanceof ArrayBuffer) {
+      const bytes = v instanceof ArrayBuffer ? new Uint8Array(v) : new Uint8Array(v.buffer, v.byteOffset, v.byteLength);
+      if (bytes.length <= 0xff) head(0xc4, bytes.length, 1);
+      else if (bytes.length <= 0xffff) head(0xc5, bytes.length, 2);
+      else head(0xc6, bytes.length, 4);
+      room(bytes.length);
+      buf.set(bytes, pos);
+      pos += bytes.length;
+      return;
+    }
+    if (typeof v.toJSON === 'function') return put(v.toJSON());
+    if (Array.isArray(v)) {
+      if (v.length < 16) byte(0x90 | v.length);
+      else if (v.length <= 0xffff) head(0xdc, v.length, 2);
+      else head(0xdd, v.length, 4);
+      for (const x of v) put(x);
+      return;
+    }
+    const keys = Object.keys(v).filter(k => v[k] !== undefined && typeof v[k] !== 'function');
+    if (keys.length < 16) byte(0x80 | keys.length);
+    else if (keys.length <= 0xffff) head(0xde, keys.length, 2);
+    else head(0xdf, keys.length, 4);
+    for (const k of keys) {
+      put(k);
+      put(v[k]);
+    }
+  };
+
+  put(value);
+  return buf.subarray(0, pos);
+}
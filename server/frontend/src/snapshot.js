@@ -0,0 +1,39 @@
+// ── Event snapshot (IndexedDB) ───────────────────────────────────
+// The event store worker's last event list and the /api/events/changes
+// cursor it was current to, kept across reloads. A reload (a wall tablet
+// after a WiFi drop) starts from it at once and asks only for the changes
+// since: nothing is fetched whole again unless the snapshot is missing or
+// the cursor is refused. One record, overwritten each time.
+
+const DB_NAME = 'seismo-dashboard';
+const STORE = 'snapshot';
+const KEY = 'events';
+
+function open() {
+  return new Promise((resolve, reject) => {
+    const req = indexedDB.open(DB_NAME, 1);
+    req.onupgradeneeded = () => req.result.createObjectStore(STORE);
+    req.onsuccess = () => resolve(req.result);
+    req.onerror = () => reject(req.error);
+  });
+}
+
+function run(mode, fn) {
+  return open().then(db => new Promise((resolve, reject) => {
+    const tx = db.transaction(STORE, mode);
+    const req = fn(tx.objectStore(STORE));
+    tx.oncomplete = () => { db.close(); resolve(req.result); };
+    tx.onerror = tx.onabort = () => { db.close(); reject(tx.error); };
+  }));
+}
+
+// -> { events, cursor, savedAt } or null
+export function readSnapshot() {
+  if (typeof indexedDB === 'undefined') return Promise.resolve(null);
+  return run('readonly', s => s.get(KEY)).then(v => v ?? null).catch(() => null);
+}
+
+export function writeSnapshot(snapshot) {
+  if (typeof indexedDB === 'undefined') return Promise.resolve();
+  return run('readwrite', s => s.put(snapshot, KEY)).catch(() => {});
+}
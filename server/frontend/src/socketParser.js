@@ -0,0 +1,60 @@
+// ── Socket.IO MessagePack parser ─────────────────────────────────
+// The client end of server/lib/socketparser.js: every packet one msgpack
+// message (msgpack.js), binaries inline as Uint8Array. The server only
+// speaks this, so every socket.io client of it passes this as `parser`.
+import { decode, encode } from './msgpack';
+
+export const protocol = 5;
+
+const CONNECT = 0, DISCONNECT = 1, CONNECT_ERROR = 4;
+
+const isObject = (v) => v !== null && typeof v === 'object' && !Array.isArray(v);
+
+function checkPacket(p) {
+  const dataOk = p?.type === CONNECT ? p.data === undefined || isObject(p.data)
+    : p?.type === DISCONNECT ? p.data === undefined
+    : p?.type === CONNECT_ERROR ? typeof p.data === 'string' || isObject(p.data)
+    : Array.isArray(p?.data);
+  if (!isObject(p) || !Number.isInteger(p.type) || p.type < CONNECT || p.type > CONNECT_ERROR
+      || typeof p.nsp !== 'string' || !dataOk || (p.id !== undefined && !Number.isInteger(p.id))) {
+    throw new Error('bad socket packet');
+  }
+}
+
+export class Encoder {
+  encode(packet) {
+    return [encode(packet)];
+  }
+}
+
+export class Decoder {
+  constructor() {
+    this.listeners = {};
+  }
+
+  on(event, fn) {
+    (this.listeners[event] ||= []).push(fn);
+    return this;
+  }
+
+  off(event, fn) {
+    if (!event) this.listeners = {};
+    else if (!fn) delete this.listeners[event];
+    else this.listeners[event] = (this.listeners[event] || []).filter(f => f !== fn);
+    return this;
+  }
+
+  emit(event, ...args) {
+    for (const fn of [...(this.listeners[event] || [])]) fn(...args);
+    return this;
+  }
+
+  add(chunk) {
+    if (typeof chunk === 'string') throw new Error('socket packet: text frame, expected msgpack');
+    const packet = decode(chunk);
+    checkPacket(packet);
+    this.emit('decoded', packet);
+  }
+
+  destroy() {}
+}
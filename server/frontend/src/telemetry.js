@@ -0,0 +1,107 @@
+// ── Device telemetry rings ───────────────────────────────────────
+// The config page's live heap, loop timing, I2C and upload numbers per
+// device, from the heartbeats the status feed reports (devices:status
+// diffs, and /api/status on subscribe). Each device has a fixed-capacity
+// ring: one Float64Array of times and one Float32Array per channel,
+// allocated once, so days open on the page cost no more than the first
+// `capacity` heartbeats. A missing value is NaN.
+//
+// The arrays are twice the capacity and every sample is written at i and
+// i + capacity, so the newest `count` samples are always one contiguous
+// run. wave (the ring's one view object, re-pointed by each push) holds
+// them as subarrays in WaveformPlot.jsx's form { count, t, <channel>... },
+// oldest first, without a copy.
+//
+// feed(id, status) takes a status entry or a diff of one. It keeps the
+// device's latest telemetry fields, and pushes a sample only when one of
+// them changed, so a full /api/status after a reconnect adds nothing new.
+
+export const TELEMETRY_CHANNELS = [
+  { key: 'heap_free', label: 'Free heap', unit: 'B', get: s => s.heap?.free },
+  { key: 'heap_block', label: 'Largest block', unit: 'B', get: s => s.heap?.max_block },
+  { key: 'heap_frag', label: 'Fragmentation', unit: '%', get: s => s.heap?.frag_pct },
+  { key: 'loop_p95_us', label: 'Loop p95', unit: 'µs', get: s => s.profile?.phases?.loop?.p95_us },
+  { key: 'loop_max_us', label: 'Loop max', unit: 'µs', get: s => s.profile?.phases?.loop?.max_us },
+  { key: 'jitter_p99_ms', label: 'Jitter p99', unit: 'ms', get: s => s.profile?.intervals?.p99_ms },
+  { key: 'i2c_busy_pct', label: 'I2C busy', unit: '%', get: s => s.i2c?.delta?.busy_pct },
+  { key: 'i2c_faults', label: 'I2C faults', unit: '',
+    get: s => s.i2c?.delta && s.i2c.delta.timeouts + s.i2c.delta.nacks + s.i2c.delta.errors },
+  { key: 'upload_queued', label: 'Upload queue', unit: '', get: s => s.uploads?.queued },
+  { key: 'temp_c', label: 'Temperature', unit: '°C', get: s => s.temp_c },
+];
+// The status fields the channels read; a change in any is a new sample
+const SOURCE_FIELDS = ['heap', 'profile', 'i2c', 'uploads', 'temp_c'];
+
+function createRing(capacity) {
+  const t = new Float64Array(capacity * 2);
+  const values = Object.fromEntries(TELEMETRY_CHANNELS.map(c => [c.key, new Float32Array(capacity * 2)]));
+  const wave = { count: 0, t: t.subarray(0, 0) };
+  for (const c of TELEMETRY_CHANNELS) wave[c.key] = values[c.key].subarray(0, 0);
+  let written = 0;
+
+  return {
+    wave,
+    push(ms, status) {
+      const i = written % capacity;
+      t[i] = t[i + capacity] = ms;
+      for (const c of TELEMETRY_CHANNELS) {
+        const v = c.get(status);
+        values[c.key][i] = values[c.key][i + capacity] = Number.isFinite(v) ? v : NaN;
+      }
+      written++;
+      const count = Math.min(written, capacity);
+      const end = i + capacity + 1;
+      wave.count = count;
+      wave.t = t.subarray(end - count, end);
+      for (const c of TELEMETRY_CHANNELS) wave[c.key] = values[c.key].subarray(end - count, end);
+    },
+  };
+}
+
+export function createTelemetry(capacity) {
+  const devices = new Map();   // id → { ring, latest, keys: { field: JSON } }
+  const listeners = new Set();
+  let version = 0;
+
+  const entry = (id) => {
+    let d = devices.get(id);
+    if (!d) {
+      d = { ring: createRing(capacity), latest: {}, keys: {} };
+      devices.set(id, d);
+    }
+    return d;
+  };
+
+  return {
+    feed(id, status, now = Date.now()) {
+      const d = entry(id);
+      let changed = false;
+      for (const f of SOURCE_FIELDS) {
+        if (!(f in status)) continue;
+        const key = JSON.stringify(status[f] ?? null);
+        if (key === d.keys[f]) continue;
+        d.keys[f] = key;
+        d.latest[f] = status[f];
+        changed = true;
+      }
+      if (!changed || !TELEMETRY_CHANNELS.some(c => Number.isFinite(c.get(d.latest)))) return;
+      d.ring.push(now, d.latest);
+      version++;
+      for (const fn of listeners) fn(id);
+    },
+
+    // The device's wave (the same object every time), or null before its first sample
+    wave(id) {
+      const d = devices.get(id);
+      return d && d.ring.wave.count ? d.ring.wave : null;
+    },
+
+    // fn(id) after each sample; returns the unsubscribe
+    subscribe(fn) {
+      listeners.add(fn);
+      return () => listeners.delete(fn);
+    },
+
+    get version() { return version; },
+  };
+}
@@ -0,0 +1,108 @@
+// ── Waveform cache ───────────────────────────────────────────────
+// The event modal's seismograph data by event _id: the whole capture as
+// typed arrays, from /api/events/:id/waveform?format=binary, so the plot
+// (WaveformPlot.jsx) decimates per pixel at any zoom. Events that still
+// embed their waveform have no binary form and come from the JSON route.
+// Least recently used entries go first once the total sample count passes
+// maxSamples. get() shares one request per id between the modal and the
+// prefetches. prefetch() runs PREFETCH_CONCURRENCY requests at a time,
+// newest asks first; older ones beyond PREFETCH_QUEUE are dropped.
+// Failures are not cached, so the next open tries again.
+
+const PREFETCH_CONCURRENCY = 2;
+const PREFETCH_QUEUE = 16;
+
+// count samples -> { count, tier, t: rel_ms, ax, ay, az, dg } (g; dg the largest axis)
+function columns(count, tier, at) {
+  const t = new Float64Array(count);
+  const axes = [new Float32Array(count), new Float32Array(count), new Float32Array(count)];
+  const dg = new Float32Array(count);
+  for (let i = 0; i < count; i++) {
+    const [ms, x, y, z] = at(i);
+    t[i] = ms;
+    axes[0][i] = x; axes[1][i] = y; axes[2][i] = z;
+    dg[i] = Math.max(Math.abs(x), Math.abs(y), Math.abs(z));
+  }
+  return { count, tier, t, ax: axes[0], ay: axes[1], az: axes[2], dg };
+}
+
+// Binary body: count × int32 rel_ms, then count × int16 x,y,z in 1/scale g
+function fromBinary(buffer, headers) {
+  const scale = Number(headers.get('X-Waveform-Scale')) || 1;
+  const count = Number(headers.get('X-Waveform-Count')) || 0;
+  const t = new Int32Array(buffer, 0, count);
+  const s = new Int16Array(buffer, count * 4, count * 3);
+  return columns(count, headers.get('X-Waveform-Tier') || 'full',
+    i => [t[i], s[i * 3] / scale, s[i * 3 + 1] / scale, s[i * 3 + 2] / scale]);
+}
+
+export function createWaveformCache(maxSamples) {
+  const entries = new Map();   // id → entry, oldest use first
+  const pending = new Map();   // id → Promise
+  let held = 0;
+  let queue = [];
+  let active = 0;
+
+  const remember = (id, entry) => {
+    entries.delete(id);
+    entries.set(id, entry);
+    held += entry.count;
+    for (const [old, e] of entries) {
+      if (held <= maxSamples || old === id) break;
+      entries.delete(old);
+      held -= e.count;
+    }
+  };
+
+  const load = async (id) => {
+    const r = await fetch(`/api/events/${id}/waveform?format=binary`);
+    if (!r.ok) return null;
+    if (r.headers.get('Content-Type')?.startsWith('application/octet-stream')) {
+      return fromBinary(await r.arrayBuffer(), r.headers);
+    }
+    const data = await r.json();
+    if (!data?.waveform) return null;
+    return columns(data.waveform.length, data.tier || 'full', i => data.waveform[i]);
+  };
+
+  // -> { count, tier, t, ax, ay, az, dg } or null
+  const get = (id) => {
+    const hit = entries.get(id);
+    if (hit) {
+      entries.delete(id);
+      entries.set(id, hit);
+      return Promise.resolve(hit);
+    }
+    if (pending.has(id)) return pending.get(id);
+    const p = load(id)
+      .then((entry) => {
+        if (entry?.count) remember(id, entry);
+        return entry?.count ? entry : null;
+      })
+      .catch(() => null)
+      .finally(() => pending.delete(id));
+    pending.set(id, p);
+    return p;
+  };
+
+  const pump = () => {
+    while (active < PREFETCH_CONCURRENCY && queue.length) {
+      const id = queue.pop();
+      if (entries.has(id) || pending.has(id)) continue;
+      active++;
+      get(id).finally(() => { active--; pump(); });
+    }
+  };
+
+  return {
+    get,
+    // Cached entry without touching the network, or null
+    peek: (id) => entries.get(id) ?? null,
+    prefetch(ids) {
+      const fresh = ids.filter(id => id && !entries.has(id) && !pending.has(id));
+      if (!fresh.length) return;
+      queue = [...queue.filter(id => !fresh.includes(id)), ...fresh].slice(-PREFETCH_QUEUE);
+      pump();
+    },
+  };
+}
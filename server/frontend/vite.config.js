@@ -15,5 +15,16 @@ export default defineConfig({
   },
   build: {
     outDir: 'dist',
+    // Libraries in chunks of their own: they change far less often than the
+    // app, so a deploy leaves them cached (immutable, server/lib/assets.js)
+    rollupOptions: {
+      output: {
+        manualChunks: {
+          react: ['react', 'react-dom', 'react-router-dom'],
+          recharts: ['recharts'],
+          socket: ['socket.io-client'],
+        },
+      },
+    },
   },
 });
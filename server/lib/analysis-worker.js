@@ -0,0 +1,22 @@
+// ── Analysis worker ──────────────────────────────────────────────
+// Entry point of each thread in the WorkerPool (lib/workers.js): one
+// { seq, kind, job } message in, one { seq, result } or { seq, error } out.
+const { parentPort } = require('worker_threads');
+const { analyzeEvent, correlate, spectrogram } = require('./analysis');
+const { stackTraces } = require('./stacking');
+
+const KINDS = {
+  event: (job) => analyzeEvent(job.wave),
+  correlate: (job) => correlate(job.waves, job.max_lag_ms),
+  spectrogram: (job) => spectrogram(job.wave, job.params),
+  stack: (job) => stackTraces(job),
+};
+
+parentPort.on('message', ({ seq, kind, job }) => {
+  try {
+    if (!KINDS[kind]) throw new Error(`unknown job kind ${kind}`);
+    parentPort.postMessage({ seq, result: KINDS[kind](job) });
+  } catch (e) {
+    parentPort.postMessage({ seq, error: e.message });
+  }
+});
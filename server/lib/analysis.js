@@ -0,0 +1,286 @@
+// ── Waveform analysis ────────────────────────────────────────────
+// Derived features of stored waveforms, run off the event loop in the
+// worker pool (lib/analysis-worker.js). Input is the stored form
+// (waveform.packWaveform: int32 ms + int16 triplets at 1/scale g).
+//   analyzeEvent   one waveform -> PGA, RMS, Arias intensity and its 5-95%
+//                  duration, dominant / centroid frequency and band shares
+//                  (Hann-windowed FFT of the strongest axis), and the
+//                  instrumental intensity that PGA corresponds to (Wald et
+//                  al. 1999). That is the shaking at the sensor, not a
+//                  magnitude: that would need the distance to the source.
+//   correlate      the waveforms of one consensus -> each device's lag
+//                  behind the earliest one and the peak of the normalized
+//                  cross-correlation of their envelopes (|a| smoothed over
+//                  ENVELOPE_MS) on a common time grid, every lag at once
+//                  through one FFT product per pair.
+//   spectrogram    one waveform -> a short-time FFT of one axis (Hann
+//                  windows of `window` samples every `hop`), power in dB
+//                  quantized to uint8 between the tile's floor and peak.
+
+const G = 9.80665;
+const FFT_MAX = 4096;
+const BANDS = [[0, 1], [1, 5], [5, 10], [10, Infinity]];   // Hz
+const ENVELOPE_MS = 100;
+
+// Stored form -> { t: ms[], axes: [Float64Array x3] } with the mean removed
+function demeaned({ count, scale, t, samples }) {
+  const n = Math.min(count, t.length / 4, samples.length / 6);
+  const tv = new DataView(t.buffer, t.byteOffset, t.byteLength);
+  const sv = new DataView(samples.buffer, samples.byteOffset, samples.byteLength);
+  const ms = new Float64Array(n);
+  const axes = [new Float64Array(n), new Float64Array(n), new Float64Array(n)];
+  for (let i = 0; i < n; i++) {
+    ms[i] = tv.getInt32(i * 4, true);
+    for (let a = 0; a < 3; a++) axes[a][i] = sv.getInt16(i * 6 + a * 2, true) / scale;
+  }
+  for (const x of axes) {
+    let mean = 0;
+    for (let i = 0; i < n; i++) mean += x[i];
+    mean /= n || 1;
+    for (let i = 0; i < n; i++) x[i] -= mean;
+  }
+  return { ms, axes, n };
+}
+
+// Median sample spacing; robust to the odd gap
+function sampleRate(ms) {
+  if (ms.length < 2) return null;
+  const d = [];
+  for (let i = 1; i < ms.length; i++) if (ms[i] > ms[i - 1]) d.push(ms[i] - ms[i - 1]);
+  if (!d.length) return null;
+  d.sort((a, b) => a - b);
+  return 1000 / d[d.length >> 1];
+}
+
+// In-place radix-2 FFT (re, im of a power-of-two length)
+function fft(re, im) {
+  const n = re.length;
+  for (let i = 1, j = 0; i < n; i++) {
+    let bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) { [re[i], re[j]] = [re[j], re[i]]; [im[i], im[j]] = [im[j], im[i]]; }
+  }
+  for (let len = 2; len <= n; len <<= 1) {
+    const ang = -2 * Math.PI / len;
+    for (let i = 0; i < n; i += len) {
+      for (let k = 0; k < len / 2; k++) {
+        const wr = Math.cos(ang * k), wi = Math.sin(ang * k);
+        const a = i + k, b = a + len / 2;
+        const xr = re[b] * wr - im[b] * wi, xi = re[b] * wi + im[b] * wr;
+        re[b] = re[a] - xr; im[b] = im[a] - xi;
+        re[a] += xr; im[a] += xi;
+      }
+    }
+  }
+}
+
+function spectrum(x, rateHz) {
+  let size = 1;
+  while (size < x.length && size < FFT_MAX) size <<= 1;
+  const m = Math.min(x.length, size);
+  const re = new Float64Array(size), im = new Float64Array(size);
+  for (let i = 0; i < m; i++) re[i] = x[i] * (0.5 - 0.5 * Math.cos(2 * Math.PI * i / Math.max(1, m - 1)));
+  fft(re, im);
+  let peak = 1, total = 0, moment = 0;
+  const bands = BANDS.map(() => 0);
+  for (let k = 1; k <= size / 2; k++) {
+    const p = re[k] * re[k] + im[k] * im[k];
+    const hz = k * rateHz / size;
+    if (p > re[peak] * re[peak] + im[peak] * im[peak]) peak = k;
+    total += p;
+    moment += p * hz;
+    bands[BANDS.findIndex(([lo, hi]) => hz >= lo && hz < hi)] += p;
+  }
+  const share = (v) => (total ? Math.round(v / total * 1000) / 1000 : 0);
+  return {
+    dominant_hz: Math.round(peak * rateHz / size * 100) / 100,
+    centroid_hz: total ? Math.round(moment / total * 100) / 100 : null,
+    bands: Object.fromEntries(BANDS.map(([lo, hi], b) => [hi === Infinity ? `${lo}+` : `${lo}-${hi}`, share(bands[b])])),
+  };
+}
+
+// STFT of axis (0-2, or 'strongest' for the largest peak-to-peak) ->
+// { rate_hz, window, hop, frames, bins, t0_ms, ms_per_frame, hz_per_bin,
+// db_min, db_max, data: Uint8Array(frames × bins) }, frame-major: row f is
+// the window starting at sample f × hop (t0_ms + f × ms_per_frame), column
+// k is k × hz_per_bin, from 0 to Nyquist. 0 is db_min (SPECTROGRAM_RANGE_DB
+// under the peak) or below, 255 the peak. Samples are taken as evenly
+// spaced at the median rate.
+const SPECTROGRAM_RANGE_DB = 80;
+function spectrogram(wave, { axis = 'strongest', window = 128, hop = 0 } = {}) {
+  const { ms, axes, n } = demeaned(wave);
+  const rate = sampleRate(ms);
+  let size = 8;
+  while (size < window && size < FFT_MAX) size <<= 1;
+  hop = hop > 0 ? Math.min(hop, size) : size >> 2;
+  if (!rate || n < size) return null;
+  let a = Number(axis);
+  if (!(a >= 0 && a <= 2)) {
+    const span = axes.map(x => Math.max(...x) - Math.min(...x));
+    a = span.indexOf(Math.max(...span));
+  }
+  const x = axes[a];
+  const frames = Math.floor((n - size) / hop) + 1;
+  const bins = size / 2 + 1;
+  const hann = new Float64Array(size);
+  for (let i = 0; i < size; i++) hann[i] = 0.5 - 0.5 * Math.cos(2 * Math.PI * i / (size - 1));
+  const db = new Float64Array(frames * bins);
+  const re = new Float64Array(size), im = new Float64Array(size);
+  let peak = -Infinity;
+  for (let f = 0; f < frames; f++) {
+    for (let i = 0; i < size; i++) {
+      re[i] = x[f * hop + i] * hann[i];
+      im[i] = 0;
+    }
+    fft(re, im);
+    for (let k = 0; k < bins; k++) {
+      const v = 10 * Math.log10(re[k] * re[k] + im[k] * im[k] + 1e-20);
+      db[f * bins + k] = v;
+      if (v > peak) peak = v;
+    }
+  }
+  const floor = peak - SPECTROGRAM_RANGE_DB;
+  const data = new Uint8Array(frames * bins);
+  for (let i = 0; i < db.length; i++) data[i] = Math.max(0, Math.min(255, Math.round((db[i] - floor) / SPECTROGRAM_RANGE_DB * 255)));
+  return {
+    rate_hz: Math.round(rate * 10) / 10, axis: a, window: size, hop, frames, bins,
+    t0_ms: ms[0], ms_per_frame: hop * 1000 / rate, hz_per_bin: rate / size,
+    db_min: Math.round(floor * 10) / 10, db_max: Math.round(peak * 10) / 10, data,
+  };
+}
+
+// Wald, Quitoriano, Heaton & Kanamori (1999), PGA in cm/s²
+function intensityFromPga(pgaG) {
+  const cms2 = pgaG * G * 100;
+  if (cms2 <= 0) return 1;
+  const mmi = 3.66 * Math.log10(cms2) - 1.66;
+  const low = 1 + 2.2 * Math.log10(cms2);
+  return Math.round(Math.max(1, Math.min(10, mmi >= 5 ? mmi : low)) * 10) / 10;
+}
+
+function analyzeEvent(wave) {
+  const { ms, axes, n } = demeaned(wave);
+  if (n < 8) return null;
+  const rate = sampleRate(ms);
+  const dt = rate ? 1 / rate : 0;
+  let pga = 0, sumSq = 0;
+  const pgaAxis = [0, 0, 0];
+  const arias = new Float64Array(n);       // cumulative, m/s
+  for (let i = 0; i < n; i++) {
+    const v2 = axes[0][i] ** 2 + axes[1][i] ** 2 + axes[2][i] ** 2;
+    pga = Math.max(pga, Math.sqrt(v2));
+    for (let a = 0; a < 3; a++) pgaAxis[a] = Math.max(pgaAxis[a], Math.abs(axes[a][i]));
+    sumSq += v2;
+    arias[i] = (i ? arias[i - 1] : 0) + Math.PI / (2 * G) * v2 * G * G * dt;
+  }
+  const total = arias[n - 1];
+  let i5 = 0, i95 = 0;
+  while (i5 < n - 1 && arias[i5] < 0.05 * total) i5++;
+  while (i95 < n - 1 && arias[i95] < 0.95 * total) i95++;
+  const strongest = pgaAxis.indexOf(Math.max(...pgaAxis));
+  const r4 = (v) => Math.round(v * 10000) / 10000;
+  return {
+    samples: n,
+    sample_rate_hz: rate ? Math.round(rate * 10) / 10 : null,
+    duration_ms: ms[n - 1] - ms[0],
+    pga_g: r4(pga),
+    pga_axis_g: pgaAxis.map(r4),
+    rms_g: r4(Math.sqrt(sumSq / n)),
+    arias_m_s: Math.round(total * 1e6) / 1e6,
+    d5_95_ms: ms[i95] - ms[i5],
+    ...(rate ? spectrum(axes[strongest], rate) : {}),
+    intensity_mmi: intensityFromPga(pga),
+  };
+}
+
+// Envelope of one waveform on the grid start + k*dt (ms, absolute): |a|
+// with linear interpolation, 0 outside the capture, then a moving average
+function onGrid(w, start, dt, len) {
+  const { ms, axes, n } = demeaned(w.wave);
+  const out = new Float64Array(len);
+  let j = 0;
+  for (let k = 0; k < len; k++) {
+    const t = start + k * dt - w.at_ms;
+    while (j < n - 2 && ms[j + 1] < t) j++;
+    if (n < 2 || t < ms[0] || t > ms[n - 1]) continue;
+    const f = ms[j + 1] > ms[j] ? Math.min(1, Math.max(0, (t - ms[j]) / (ms[j + 1] - ms[j]))) : 0;
+    const mag = (i) => Math.hypot(axes[0][i], axes[1][i], axes[2][i]);
+    out[k] = mag(j) * (1 - f) + mag(j + 1) * f;
+  }
+  const half = Math.max(0, Math.round(ENVELOPE_MS / dt / 2));
+  if (!half) return out;
+  const sum = new Float64Array(len + 1);
+  for (let k = 0; k < len; k++) sum[k + 1] = sum[k] + out[k];
+  const env = new Float64Array(len);
+  for (let k = 0; k < len; k++) {
+    const lo = Math.max(0, k - half), hi = Math.min(len, k + half + 1);
+    env[k] = (sum[hi] - sum[lo]) / (hi - lo);
+  }
+  return env;
+}
+
+// c[m] = Σ a[k]·b[k+m] for m in 0..b.length-a.length, all lags in one
+// FFT product (zero-padded, so it's the linear correlation)
+function crossCorrelate(a, b) {
+  let size = 1;
+  while (size < a.length + b.length) size <<= 1;
+  const ar = new Float64Array(size), ai = new Float64Array(size);
+  const br = new Float64Array(size), bi = new Float64Array(size);
+  ar.set(a);
+  br.set(b);
+  fft(ar, ai);
+  fft(br, bi);
+  // conj(A)·B, inverse-transformed as conj(fft(conj(x))) / size
+  for (let k = 0; k < size; k++) {
+    const re = ar[k] * br[k] + ai[k] * bi[k];
+    const im = ar[k] * bi[k] - ai[k] * br[k];
+    ar[k] = re;
+    ai[k] = -im;
+  }
+  fft(ar, ai);
+  const out = new Float64Array(b.length - a.length + 1);
+  for (let m = 0; m < out.length; m++) out[m] = ar[m] / size;
+  return out;
+}
+
+// waves: [{ id, at_ms (trigger, epoch ms), wave }], maxLagMs: search ±
+// -> { reference, lags: { id: { lag_ms, r } } }
+function correlate(waves, maxLagMs) {
+  if (waves.length < 2) return null;
+  const sorted = [...waves].sort((a, b) => a.at_ms - b.at_ms);
+  const ref = sorted[0];
+  const rate = sampleRate(demeaned(ref.wave).ms) || 100;
+  const dt = 1000 / rate;
+  const { ms } = demeaned(ref.wave);
+  const start = ref.at_ms + ms[0];
+  const len = ms.length;
+  const lagSteps = Math.ceil(maxLagMs / dt);
+  // Pearson r per lag: a zero-mean, b's mean and variance per window from
+  // prefix sums, so Σ a·b from the FFT product is the covariance term
+  const a = onGrid(ref, start, dt, len);
+  const meanA = a.reduce((s, v) => s + v, 0) / len;
+  let aa = 0;
+  for (let k = 0; k < len; k++) { a[k] -= meanA; aa += a[k] * a[k]; }
+  const lags = {};
+  for (const w of sorted.slice(1)) {
+    // Grid wide enough for every lag
+    const b = onGrid(w, start - lagSteps * dt, dt, len + 2 * lagSteps);
+    const c = crossCorrelate(a, b);
+    const sum = new Float64Array(b.length + 1), sq = new Float64Array(b.length + 1);
+    for (let k = 0; k < b.length; k++) { sum[k + 1] = sum[k] + b[k]; sq[k + 1] = sq[k] + b[k] * b[k]; }
+    let best = { lag_ms: null, r: 0 };
+    for (let m = 0; m < c.length; m++) {
+      const sb = sum[m + len] - sum[m];
+      const bb = sq[m + len] - sq[m] - sb * sb / len;
+      const r = aa > 0 && bb > 1e-18 ? c[m] / Math.sqrt(aa * bb) : 0;
+      if (best.lag_ms === null || r > best.r) {
+        best = { lag_ms: Math.round((m - lagSteps) * dt * 10) / 10, r: Math.round(r * 1000) / 1000 };
+      }
+    }
+    lags[w.id] = best;
+  }
+  return { reference: ref.id, lags };
+}
+
+module.exports = { analyzeEvent, correlate, crossCorrelate, intensityFromPga, sampleRate, spectrogram, fft };
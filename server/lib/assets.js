@@ -0,0 +1,68 @@
+// ── Dashboard assets ─────────────────────────────────────────────
+// Serves the React build (public/, from the Dockerfile's frontend stage).
+// Vite names every chunk under assets/ by its content hash, so those are
+// sent with a year's max-age and `immutable`: a tablet that has loaded the
+// dashboard once revalidates nothing but index.html, which is no-cache and
+// points at the new names after a deploy.
+//
+// frontend/scripts/precompress.js leaves a .br and a .gz beside each text
+// asset at build time. A request whose Accept-Encoding takes one is sent
+// that file as is (brotli first), so nothing is compressed per request.
+// The variants are found once at startup; a build without them is served
+// plainly.
+
+const fs = require('fs');
+const path = require('path');
+const express = require('express');
+
+const IMMUTABLE = 'public, max-age=31536000, immutable';
+const ENCODINGS = [['br', '.br'], ['gzip', '.gz']];
+
+// url path ('/assets/App-1a2b.js') → [[encoding, file], ...] in preference order
+function findVariants(dir, base = '/', out = new Map()) {
+  let names;
+  try {
+    names = fs.readdirSync(dir, { withFileTypes: true });
+  } catch {
+    return out;
+  }
+  const files = new Set(names.filter(d => d.isFile()).map(d => d.name));
+  for (const d of names) {
+    if (d.isDirectory()) findVariants(path.join(dir, d.name), `${base}${d.name}/`, out);
+    if (!d.isFile() || ENCODINGS.some(([, ext]) => d.name.endsWith(ext))) continue;
+    const variants = ENCODINGS.filter(([, ext]) => files.has(d.name + ext))
+      .map(([enc, ext]) => [enc, path.join(dir, d.name + ext)]);
+    if (variants.length) out.set(base + d.name, variants);
+  }
+  return out;
+}
+
+const cacheControl = (urlPath) => (urlPath.startsWith('/assets/') ? IMMUTABLE : 'no-cache');
+
+// -> [middleware, ...] for app.use()
+function serveAssets(dir) {
+  const variants = findVariants(dir);
+
+  const precompressed = (req, res, next) => {
+    if (req.method !== 'GET' && req.method !== 'HEAD') return next();
+    const urlPath = req.path.endsWith('/') ? `${req.path}index.html` : req.path;
+    const found = variants.get(urlPath);
+    if (!found) return next();
+    res.vary('Accept-Encoding');
+    const [encoding, file] = found.find(([enc]) => req.acceptsEncodings(enc) === enc) || [];
+    if (!file) return next();
+    res.type(path.extname(urlPath));
+    res.set('Content-Encoding', encoding);
+    res.sendFile(file, { headers: { 'Cache-Control': cacheControl(urlPath) }, cacheControl: false },
+      (err) => { if (err && !res.headersSent) next(); });
+  };
+
+  const plain = express.static(dir, {
+    cacheControl: false,
+    setHeaders: (res, file) => res.set('Cache-Control', cacheControl(`/${path.relative(dir, file).split(path.sep).join('/')}`)),
+  });
+
+  return [precompressed, plain];
+}
+
+module.exports = { serveAssets, findVariants };
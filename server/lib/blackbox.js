@@ -0,0 +1,72 @@
+// ── Black box decoder ────────────────────────────────────────────
+// A pull the device answered from its flash black box (src/black_box.h)
+// arrives as the raw blocks, 256 bytes each, back to back:
+//   0 u16 magic 0xB10C, 2 u8 count, 3 u8 flags (bit 0 clipped),
+//   4 u16 rate_hz, 6 u16 reserved, 8 i64 epoch ms of the first sample,
+//   16 count × int16 x,y,z, de-biased ±2g LSB
+// Blocks that follow on one another's grid are joined into runs; runs are
+// trimmed to the pulled window.
+
+const CONTENT_TYPE = 'application/x-seismo-blackbox';
+const BLOCK_BYTES = 256;
+const HEADER_BYTES = 16;
+const MAGIC = 0xB10C;
+const SCALE = 16384;            // LSB per g
+
+// -> { blocks, skipped, runs: [{ start_ms, rate_hz, clipped, x, y, z }] } in g
+function decodeBlackBox(buf, fromMs = -Infinity, toMs = Infinity) {
+  const runs = [];
+  let blocks = 0, skipped = 0, run = null;
+  for (let off = 0; off + BLOCK_BYTES <= buf.length; off += BLOCK_BYTES) {
+    const count = buf.readUInt8(off + 2);
+    const rate = buf.readUInt16LE(off + 4);
+    if (buf.readUInt16LE(off) !== MAGIC || !count || !rate || HEADER_BYTES + count * 6 > BLOCK_BYTES) {
+      skipped++;
+      continue;
+    }
+    blocks++;
+    const start = Number(buf.readBigInt64LE(off + 8));
+    const period = 1000 / rate;
+    const expected = run ? run.start_ms + run.x.length * period : NaN;
+    if (!run || run.rate_hz !== rate || Math.abs(start - expected) >= period / 2) {
+      run = { start_ms: start, rate_hz: rate, clipped: false, x: [], y: [], z: [] };
+      runs.push(run);
+    }
+    run.clipped ||= (buf.readUInt8(off + 3) & 1) === 1;
+    for (let i = 0; i < count; i++) {
+      const p = off + HEADER_BYTES + i * 6;
+      run.x.push(buf.readInt16LE(p) / SCALE);
+      run.y.push(buf.readInt16LE(p + 2) / SCALE);
+      run.z.push(buf.readInt16LE(p + 4) / SCALE);
+    }
+  }
+
+  // Only what falls in [fromMs, toMs)
+  const trimmed = [];
+  for (const r of runs) {
+    const period = 1000 / r.rate_hz;
+    const first = Math.max(0, Math.ceil((fromMs - r.start_ms) / period));
+    const end = Math.min(r.x.length, Math.ceil((toMs - r.start_ms) / period));
+    if (end <= first) continue;
+    trimmed.push({
+      start_ms: r.start_ms + first * period, rate_hz: r.rate_hz, clipped: r.clipped,
+      x: r.x.slice(first, end), y: r.y.slice(first, end), z: r.z.slice(first, end),
+    });
+  }
+  return { blocks, skipped, runs: trimmed };
+}
+
+// "bbox=oldest_s,newest_s,segments,dropped_blocks" off the heartbeat, or null
+function parseBlackBoxQuery(query) {
+  if (typeof query.bbox !== 'string') return null;
+  const [oldest, newest, segments, dropped] = query.bbox.split(',').map(v => parseInt(v, 10));
+  if (![oldest, newest, segments, dropped].every(Number.isFinite)) return null;
+  return {
+    oldest_ms: oldest ? oldest * 1000 : null,
+    newest_ms: newest ? newest * 1000 + 1000 : null,
+    segments,
+    dropped_blocks: dropped,
+  };
+}
+
+module.exports = { CONTENT_TYPE, decodeBlackBox, parseBlackBoxQuery };
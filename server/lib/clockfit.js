@@ -0,0 +1,110 @@
+// ── Device clock fit ─────────────────────────────────────────────
+// Heartbeats carry the device's millis() as it built the request (ms) and
+// its boot count (boot). Against the time each request head arrived here,
+// the last MAX_POINTS of a boot give a least-squares line
+//   server_ms = mean_server + slope * (device_ms - mean_device)
+// whose slope is the crystal's rate against ours (drift = slope - 1) and
+// whose value at a device millis() maps it onto server time. The request
+// latency rides along as a near-constant offset (tens of ms on a LAN).
+// A new boot, or millis() going backwards (its 49-day wrap), starts over;
+// the previous boot's fit is kept for its journal replays.
+//
+// Until MIN_SLOPE_POINTS spanning MIN_SLOPE_SPAN_MS are in, the slope is
+// held at 1 and only the offset is fitted.
+
+const MAX_POINTS = 64;
+const MIN_SLOPE_POINTS = 3;
+const MIN_SLOPE_SPAN_MS = 10 * 60 * 1000;
+
+class BootFit {
+  constructor(boot) {
+    this.boot = boot;
+    this.device = [];
+    this.server = [];
+    this.line = null;
+  }
+
+  add(deviceMs, serverMs) {
+    this.device.push(deviceMs);
+    this.server.push(serverMs);
+    if (this.device.length > MAX_POINTS) {
+      this.device.shift();
+      this.server.shift();
+    }
+    this.line = this.solve();
+  }
+
+  solve() {
+    const n = this.device.length;
+    let md = 0, ms = 0;
+    for (let k = 0; k < n; k++) { md += this.device[k]; ms += this.server[k]; }
+    md /= n;
+    ms /= n;
+    const span = this.device[n - 1] - this.device[0];
+    let slope = 1;
+    if (n >= MIN_SLOPE_POINTS && span >= MIN_SLOPE_SPAN_MS) {
+      let sxy = 0, sxx = 0;
+      for (let k = 0; k < n; k++) {
+        const dx = this.device[k] - md;
+        sxy += dx * (this.server[k] - ms);
+        sxx += dx * dx;
+      }
+      slope = sxy / sxx;
+    }
+    let sq = 0;
+    for (let k = 0; k < n; k++) {
+      const r = this.server[k] - (ms + slope * (this.device[k] - md));
+      sq += r * r;
+    }
+    return { md, ms, slope, n, span, rms: Math.sqrt(sq / n) };
+  }
+
+  map(deviceMs) {
+    const l = this.line;
+    return l ? l.ms + l.slope * (deviceMs - l.md) : null;
+  }
+}
+
+class ClockFit {
+  constructor() {
+    this.current = null;
+    this.previous = null;
+  }
+
+  add(boot, deviceMs, serverMs) {
+    if (!Number.isFinite(boot) || !Number.isFinite(deviceMs) || !Number.isFinite(serverMs)) return;
+    const c = this.current;
+    if (!c || c.boot !== boot || deviceMs < c.device[c.device.length - 1]) {
+      if (c && c.boot !== boot) this.previous = c;
+      this.current = new BootFit(boot);
+    }
+    this.current.add(deviceMs, serverMs);
+  }
+
+  // Server epoch ms of a device millis() in the given boot (null = the
+  // current one), or null without a fit for it
+  map(boot, deviceMs) {
+    if (!Number.isFinite(deviceMs)) return null;
+    for (const f of [this.current, this.previous]) {
+      if (f && (boot == null || f.boot === boot)) return f.map(deviceMs);
+    }
+    return null;
+  }
+
+  // -> { boot, points, span_s, offset_ms (server minus device millis now), drift_ppm, rms_ms } or null
+  summary(now = Date.now()) {
+    const l = this.current?.line;
+    if (!l) return null;
+    const deviceNow = l.md + (now - l.ms) / l.slope;
+    return {
+      boot: this.current.boot,
+      points: l.n,
+      span_s: Math.round(l.span / 1000),
+      offset_ms: Math.round(now - deviceNow),
+      drift_ppm: l.n >= MIN_SLOPE_POINTS && l.span >= MIN_SLOPE_SPAN_MS ? Math.round((l.slope - 1) * 1e7) / 10 : null,
+      rms_ms: Math.round(l.rms * 10) / 10,
+    };
+  }
+}
+
+module.exports = { ClockFit, MAX_POINTS };
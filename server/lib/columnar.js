@@ -0,0 +1,150 @@
+// ── Columnar event lists ─────────────────────────────────────────
+// /api/events answers `Accept: application/vnd.seismo.events` with this
+// instead of JSON: one typed column per list field, so the browser reads
+// them straight into typed arrays rather than parsing n objects. Layout,
+// little-endian, every column aligned to its element size:
+//   'SEV1'  uint32 n  uint32 trailer_bytes  uint32 0
+//   float64[n]  time, epoch ms
+//   float64[n]  deltaG
+//   uint8[n*12] _id
+//   uint16[n]   device, index into trailer.devices
+//   uint8[n]    level, index into trailer.levels
+//   uint8[n]    trigger, index into trailer.triggers
+//   uint8[n]    time_source, index into trailer.time_sources
+//   uint8[n]    flags: bit 0 has_waveform
+//   pad to 4, then trailer_bytes of UTF-8 JSON:
+//   { devices: [[id, alias], ...], levels, triggers, time_sources,
+//     extras: { row: { gap_index, gap_samples, retriggers, spectrum, analysis } },
+//     others: [documents that aren't plain events, e.g. consensus entries] }
+// Decoded by frontend/src/columnar.js.
+
+const CONTENT_TYPE = 'application/vnd.seismo.events';
+const MAGIC = 'SEV1';
+const HEADER_SIZE = 16;
+const LEVELS = ['minor', 'moderate', 'severe'];
+const TRIGGERS = ['threshold', 'sta_lta', 'pull'];
+const TIME_SOURCES = ['', 'ntp', 'offset', 'server'];
+const EXTRA_FIELDS = ['gap_index', 'gap_samples', 'retriggers', 'spectrum', 'analysis'];
+
+// Index of v in list, appending it if new
+function codeOf(list, v) {
+  const i = list.indexOf(v);
+  return i >= 0 ? i : list.push(v) - 1;
+}
+
+// Events as /api/events lists them (_id as ObjectId or hex) → Buffer
+function encodeEvents(docs) {
+  const rows = [], others = [];
+  for (const d of docs) (d.status || typeof d.deltaG !== 'number' ? others : rows).push(d);
+  const n = rows.length;
+  const levels = [...LEVELS], triggers = [...TRIGGERS], timeSources = [...TIME_SOURCES];
+  const devices = [], deviceIndex = new Map();
+  const extras = {};
+
+  const offTime = HEADER_SIZE;
+  const offDelta = offTime + n * 8;
+  const offId = offDelta + n * 8;
+  const offDevice = offId + n * 12;
+  const offLevel = offDevice + n * 2;
+  const offTrigger = offLevel + n;
+  const offSource = offTrigger + n;
+  const offFlags = offSource + n;
+  const offTrailer = (offFlags + n + 3) & ~3;
+  const cols = Buffer.alloc(offTrailer);
+
+  rows.forEach((e, i) => {
+    const time = e.time instanceof Date ? e.time.getTime() : Date.parse(e.timestamp);
+    cols.writeDoubleLE(Number.isFinite(time) ? time : 0, offTime + i * 8);
+    cols.writeDoubleLE(e.deltaG, offDelta + i * 8);
+    Buffer.from(String(e._id), 'hex').copy(cols, offId + i * 12);
+    const key = `${e.id}\u0000${e.alias ?? ''}`;
+    if (!deviceIndex.has(key)) deviceIndex.set(key, devices.push([e.id ?? null, e.alias ?? null]) - 1);
+    cols.writeUInt16LE(deviceIndex.get(key), offDevice + i * 2);
+    cols[offLevel + i] = codeOf(levels, e.level ?? '');
+    cols[offTrigger + i] = codeOf(triggers, e.trigger || 'threshold');
+    cols[offSource + i] = codeOf(timeSources, e.time_source || '');
+    cols[offFlags + i] = e.has_waveform ? 1 : 0;
+    const extra = {};
+    for (const f of EXTRA_FIELDS) if (e[f] !== undefined) extra[f] = e[f];
+    if (Object.keys(extra).length) extras[i] = extra;
+  });
+
+  const trailer = Buffer.from(JSON.stringify({
+    devices, levels, triggers, time_sources: timeSources, extras,
+    others: others.map(d => ({ ...d, _id: d._id?.toString() })),
+  }));
+  cols.write(MAGIC, 0, 'latin1');
+  cols.writeUInt32LE(n, 4);
+  cols.writeUInt32LE(trailer.length, 8);
+  return Buffer.concat([cols, trailer]);
+}
+
+// ── Aligned waveforms ────────────────────────────────────────────
+// /api/waveforms?format=binary (or Accept: application/vnd.seismo.waveforms):
+// waveform.alignWaveforms()'s grid as float32 columns. Little-endian:
+//   'SWG1'  uint32 series  uint32 count  uint32 trailer_bytes
+//   float64 start_ms  float64 step_ms
+//   float32[count] ax, ay, az of series 0, then of series 1, ... (g, NaN
+//                  outside the capture; a series without samples is all NaN)
+//   trailer_bytes of UTF-8 JSON: { series: [{ event_id, id, alias, ... }] }
+const WAVEFORMS_CONTENT_TYPE = 'application/vnd.seismo.waveforms';
+const WAVEFORMS_MAGIC = 'SWG1';
+const WAVEFORMS_HEADER_SIZE = 32;
+
+// grid as alignWaveforms returns it, series: one JSON object per column
+function encodeWaveforms(grid, series) {
+  const count = grid.count;
+  const head = Buffer.alloc(WAVEFORMS_HEADER_SIZE);
+  const cols = Buffer.alloc(series.length * 3 * count * 4);
+  grid.columns.forEach((axes, i) => {
+    for (let axis = 0; axis < 3; axis++) {
+      const at = (i * 3 + axis) * count * 4;
+      for (let k = 0; k < count; k++) cols.writeFloatLE(axes ? axes[axis][k] : NaN, at + k * 4);
+    }
+  });
+  const trailer = Buffer.from(JSON.stringify({ series }));
+  head.write(WAVEFORMS_MAGIC, 0, 'latin1');
+  head.writeUInt32LE(series.length, 4);
+  head.writeUInt32LE(count, 8);
+  head.writeUInt32LE(trailer.length, 12);
+  head.writeDoubleLE(grid.start_ms ?? NaN, 16);
+  head.writeDoubleLE(grid.step_ms ?? NaN, 24);
+  return Buffer.concat([head, cols, trailer]);
+}
+
+// ── Spectrogram tiles ────────────────────────────────────────────
+// /api/events/:id/spectrogram: analysis.spectrogram()'s result as one
+// tile, the form lib/tilecache.js keeps. Little-endian:
+//   'SPG1'  uint16 frames  uint16 bins  uint16 window  uint16 hop
+//   uint8 axis  uint8[3] 0
+//   float32 rate_hz  t0_ms  ms_per_frame  hz_per_bin  db_min  db_max
+//   uint8[frames × bins]  frame-major, 0 = db_min .. 255 = db_max
+const SPECTROGRAM_CONTENT_TYPE = 'application/vnd.seismo.spectrogram';
+const SPECTROGRAM_MAGIC = 'SPG1';
+const SPECTROGRAM_HEADER_SIZE = 40;
+const SPECTROGRAM_FLOATS = ['rate_hz', 't0_ms', 'ms_per_frame', 'hz_per_bin', 'db_min', 'db_max'];
+
+function encodeSpectrogram(s) {
+  const head = Buffer.alloc(SPECTROGRAM_HEADER_SIZE);
+  head.write(SPECTROGRAM_MAGIC, 0, 'latin1');
+  head.writeUInt16LE(s.frames, 4);
+  head.writeUInt16LE(s.bins, 6);
+  head.writeUInt16LE(s.window, 8);
+  head.writeUInt16LE(s.hop, 10);
+  head.writeUInt8(s.axis, 12);
+  SPECTROGRAM_FLOATS.forEach((k, i) => head.writeFloatLE(s[k], 16 + i * 4));
+  return Buffer.concat([head, Buffer.from(s.data.buffer, s.data.byteOffset, s.data.length)]);
+}
+
+// Tile -> the fields, data as a Buffer view
+function decodeSpectrogram(tile) {
+  if (tile.toString('latin1', 0, 4) !== SPECTROGRAM_MAGIC) throw new Error('bad spectrogram tile');
+  const s = { frames: tile.readUInt16LE(4), bins: tile.readUInt16LE(6), window: tile.readUInt16LE(8),
+              hop: tile.readUInt16LE(10), axis: tile.readUInt8(12) };
+  SPECTROGRAM_FLOATS.forEach((k, i) => { s[k] = Math.round(tile.readFloatLE(16 + i * 4) * 1000) / 1000; });
+  s.data = tile.subarray(SPECTROGRAM_HEADER_SIZE, SPECTROGRAM_HEADER_SIZE + s.frames * s.bins);
+  return s;
+}
+
+module.exports = { CONTENT_TYPE, WAVEFORMS_CONTENT_TYPE, SPECTROGRAM_CONTENT_TYPE,
+                   encodeEvents, encodeWaveforms, encodeSpectrogram, decodeSpectrogram };
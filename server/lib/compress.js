@@ -0,0 +1,78 @@
+// ── Response compression ─────────────────────────────────────────
+// Express middleware that compresses res.send() / res.json() bodies of at
+// least `threshold` bytes with brotli or gzip, whichever the client's
+// Accept-Encoding prefers (brotli on a tie). Compression runs on the zlib
+// thread pool, so a 50000-event page doesn't stall the event loop. Bodies a
+// route already encoded (firmware images) and streamed files pass through.
+// Brotli runs at quality 5: close to gzip -9 in time, noticeably smaller.
+// A route that writes its body as it goes (NDJSON) takes compressStream()
+// instead: the same choice of encoding, as a zlib stream in front of res.
+
+const zlib = require('zlib');
+
+const ENCODERS = {
+  br: (buf, done) => zlib.brotliCompress(buf, {
+    params: {
+      [zlib.constants.BROTLI_PARAM_QUALITY]: 5,
+      [zlib.constants.BROTLI_PARAM_SIZE_HINT]: buf.length,
+    },
+  }, done),
+  gzip: (buf, done) => zlib.gzip(buf, { level: 6 }, done),
+};
+
+// Accept-Encoding → 'br' | 'gzip' | null, honouring q-values
+function pickEncoding(header) {
+  if (!header) return null;
+  let best = null, bestQ = 0;
+  for (const part of String(header).split(',')) {
+    const [name, ...params] = part.trim().toLowerCase().split(';');
+    const qParam = params.find(p => p.trim().startsWith('q='));
+    const q = qParam ? parseFloat(qParam.trim().slice(2)) : 1;
+    const enc = name === '*' ? 'br' : name;
+    if (!ENCODERS[enc] || !(q > 0)) continue;
+    if (q > bestQ || (q === bestQ && enc === 'br')) { best = enc; bestQ = q; }
+  }
+  return best;
+}
+
+function compress({ threshold = 1024 } = {}) {
+  return (req, res, next) => {
+    const send = res.send;
+    res.send = function (body) {
+      const enc = pickEncoding(req.headers['accept-encoding']);
+      const buf = typeof body === 'string' ? Buffer.from(body) : Buffer.isBuffer(body) ? body : null;
+      if (!enc || !buf || buf.length < threshold || req.method === 'HEAD' || this.get('Content-Encoding')) {
+        return send.call(this, body);
+      }
+      // res.send would default a string body to text/html
+      if (!this.get('Content-Type')) this.type(typeof body === 'string' ? 'html' : 'bin');
+      this.vary('Accept-Encoding');
+      ENCODERS[enc](buf, (err, out) => {
+        if (err) return send.call(this, body);
+        this.set('Content-Encoding', enc);
+        send.call(this, out);
+      });
+      return this;
+    };
+    next();
+  };
+}
+
+const STREAMS = {
+  br: () => zlib.createBrotliCompress({ params: { [zlib.constants.BROTLI_PARAM_QUALITY]: 5 } }),
+  gzip: () => zlib.createGzip({ level: 6 }),
+};
+
+// -> the writable to send res's body through: a compressor piped into res
+// (Content-Encoding set), or res itself when the client takes neither
+function compressStream(req, res) {
+  res.vary('Accept-Encoding');
+  const enc = pickEncoding(req.headers['accept-encoding']);
+  if (!enc || req.method === 'HEAD') return res;
+  res.set('Content-Encoding', enc);
+  const z = STREAMS[enc]();
+  z.pipe(res);
+  return z;
+}
+
+module.exports = { compress, compressStream, pickEncoding };
@@ -0,0 +1,203 @@
+// ── Cross-node consensus ─────────────────────────────────────────
+// Events are indexed by trigger time (eventTime() in server.js: SNTP or the
+// init-anchored device clock), not by arrival, in one array kept sorted by
+// binary-search insert. A cluster is any span of windowMs holding triggers
+// from `quorum` distinct members (0 = all of them); non-members ride along
+// but don't count. Candidate windows overlap: every event in the last
+// windowMs starts one, so an early false trigger can't claim the window of
+// a real event just after it. Each add() bisects to the new event's
+// neighbourhood and slides over the events within ±windowMs of it - a
+// handful, so O(log n) plus the local burst, with no timers. Once a cluster
+// is confirmed, later triggers inside its window join it instead of
+// starting another. Nothing older than horizonMs behind the newest event is
+// kept (events that late are replays and never reach the engine).
+//
+// With `provisional` set below the quorum, a window that reaches that many
+// members first is returned once as a provisional cluster: an early alert
+// the caller confirms (a full cluster claims it) or retracts when the
+// window is over.
+
+class ConsensusEngine {
+  constructor({ windowMs = 2000, quorum = 0, provisional = 0, members = [], horizonMs = 120000 } = {}) {
+    this.events = [];             // { id, timeMs, cluster } ascending timeMs
+    this.clusters = [];           // confirmed, ascending startMs
+    this.provisionals = [];       // early alerts, ascending startMs
+    this.latestMs = -Infinity;
+    this.horizonMs = horizonMs;
+    this.configure({ windowMs, quorum, provisional, members });
+  }
+
+  configure({ windowMs = this.windowMs, quorum = this.quorum, provisional = this.provisional,
+              members = this.members } = {}) {
+    this.windowMs = Math.max(1, Number(windowMs) || 2000);
+    this.quorum = Math.max(0, parseInt(quorum, 10) || 0);
+    this.provisional = Math.max(0, parseInt(provisional, 10) || 0);
+    this.members = [...members];
+    this.memberSet = new Set(this.members);
+  }
+
+  // Distinct members a cluster needs
+  required() {
+    const m = this.members.length;
+    return this.quorum > 0 ? Math.min(this.quorum, m) : m;
+  }
+
+  // First index whose timeMs is >= t
+  bisect(t) {
+    let lo = 0, hi = this.events.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >> 1;
+      if (this.events[mid].timeMs < t) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+  }
+
+  prune() {
+    const cutoff = this.latestMs - this.horizonMs;
+    const n = this.bisect(cutoff);
+    if (n) this.events.splice(0, n);
+    while (this.clusters.length && this.clusters[0].startMs + this.windowMs < cutoff) this.clusters.shift();
+    while (this.provisionals.length && this.provisionals[0].startMs + this.windowMs < cutoff) this.provisionals.shift();
+  }
+
+  // One trigger. -> { cluster, confirmed } when it confirms a cluster
+  // (confirmed: true) or joins one already confirmed (false), { provisional }
+  // when it starts a provisional one, else null.
+  // cluster: { startMs, endMs, devices: [id, ...], arrivals: { id: first
+  // timeMs }, members, required, provisional (the one it settles, if any) }
+  // provisional: { startMs, endMs, devices, arrivals, members, required, cluster }
+  add(id, timeMs) {
+    if (!Number.isFinite(timeMs)) return null;
+    if (timeMs > this.latestMs) this.latestMs = timeMs;
+    this.prune();
+    if (timeMs < this.latestMs - this.horizonMs) return null;
+
+    const ev = { id, timeMs, cluster: null };
+    this.events.splice(this.bisect(timeMs), 0, ev);
+
+    // Inside a confirmed window: join it
+    for (let k = this.clusters.length - 1; k >= 0; k--) {
+      const c = this.clusters[k];
+      if (timeMs >= c.startMs && timeMs <= c.startMs + this.windowMs) {
+        ev.cluster = c;
+        if (!c.devices.includes(id)) c.devices.push(id);
+        c.arrivals[id] = Math.min(c.arrivals[id] ?? Infinity, timeMs);
+        if (this.memberSet.has(id)) c.members = c.devices.filter(d => this.memberSet.has(d)).length;
+        c.endMs = Math.max(c.endMs, timeMs);
+        return { cluster: c, confirmed: false };
+      }
+      if (c.startMs + this.windowMs < timeMs - this.windowMs) break;
+    }
+
+    const need = this.required();
+    if (need === 0) return null;
+
+    // Slide over the unclaimed events within ±windowMs. Of the windows that
+    // hold this event and reach the quorum, the latest-starting one wins, so
+    // an earlier stray trigger stays out of the cluster
+    const w = this.windowMs;
+    const lo = this.bisect(timeMs - w), hi = this.bisect(timeMs + w + 1);
+    const counts = new Map();
+    let distinct = 0;
+    let j = lo;
+    let best = null;
+    let early = null;
+    const earlyNeed = this.provisional > 0 && this.provisional < need ? this.provisional : Infinity;
+    for (let i = lo; i < hi && this.events[i].timeMs <= timeMs; i++) {
+      const start = this.events[i];
+      if (start.cluster) continue;
+      for (; j < hi && this.events[j].timeMs <= start.timeMs + w; j++) {
+        const e = this.events[j];
+        if (e.cluster || !this.memberSet.has(e.id)) continue;
+        const n = (counts.get(e.id) || 0) + 1;
+        counts.set(e.id, n);
+        if (n === 1) distinct++;
+      }
+      if (distinct >= need) best = [i, j];
+      else if (distinct >= earlyNeed) early = [i, j];
+      // Drop the window's first event before moving its start on
+      if (this.memberSet.has(start.id) && counts.has(start.id)) {
+        const n = counts.get(start.id) - 1;
+        if (n === 0) { counts.delete(start.id); distinct--; } else counts.set(start.id, n);
+      }
+    }
+    if (best) return { cluster: this.confirm(best[0], best[1]), confirmed: true };
+    if (!early) return null;
+    // One alert per window: later triggers near an open one only add to it
+    const open = this.provisionals.find(p => !p.cluster && Math.abs(p.startMs - this.events[early[0]].timeMs) <= w);
+    if (open) {
+      if (!open.devices.includes(id)) open.devices.push(id);
+      open.arrivals[id] ??= timeMs;
+      open.members = open.devices.filter(d => this.memberSet.has(d)).length;
+      open.endMs = Math.max(open.endMs, timeMs);
+      return null;
+    }
+    return { provisional: this.propose(early[0], early[1], need) };
+  }
+
+  // events[from, to) as a provisional cluster; nothing is claimed
+  propose(from, to, need) {
+    const startMs = this.events[from].timeMs;
+    const p = { startMs, endMs: startMs, devices: [], arrivals: {}, members: 0, required: need, cluster: null };
+    for (let k = from; k < to; k++) {
+      const e = this.events[k];
+      if (e.cluster) continue;
+      if (!p.devices.includes(e.id)) p.devices.push(e.id);
+      p.arrivals[e.id] ??= e.timeMs;
+      p.endMs = e.timeMs;
+    }
+    p.members = p.devices.filter(d => this.memberSet.has(d)).length;
+    this.provisionals.push(p);
+    this.provisionals.sort((a, b) => a.startMs - b.startMs);
+    return p;
+  }
+
+  // Forget every event and cluster (a new consensus leader rebuilds from
+  // the shared trigger log, lib/shared.js)
+  clear() {
+    this.events = [];
+    this.clusters = [];
+    this.provisionals = [];
+    this.latestMs = -Infinity;
+  }
+
+  // A cluster confirmed elsewhere (by the previous leader): claim its window
+  // so the same triggers don't confirm it a second time, and let later
+  // ones join it
+  adopt({ startMs, endMs = startMs, devices = [], arrivals = {} }) {
+    const c = { startMs, endMs, devices: [...devices], arrivals: { ...arrivals }, members: 0,
+                required: this.required() };
+    c.members = c.devices.filter(d => this.memberSet.has(d)).length;
+    for (let k = this.bisect(startMs); k < this.events.length && this.events[k].timeMs <= startMs + this.windowMs; k++) {
+      if (!this.events[k].cluster) this.events[k].cluster = c;
+    }
+    let at = this.clusters.length;
+    while (at > 0 && this.clusters[at - 1].startMs > startMs) at--;
+    this.clusters.splice(at, 0, c);
+    if (startMs > this.latestMs) this.latestMs = startMs;
+    return c;
+  }
+
+  // Claim events[from, to) as a new cluster
+  confirm(from, to) {
+    const startMs = this.events[from].timeMs;
+    const c = { startMs, endMs: startMs, devices: [], arrivals: {}, members: 0, required: this.required() };
+    for (let k = from; k < to; k++) {
+      const e = this.events[k];
+      if (e.cluster) continue;
+      e.cluster = c;
+      if (!c.devices.includes(e.id)) c.devices.push(e.id);
+      c.arrivals[e.id] ??= e.timeMs;
+      c.endMs = e.timeMs;
+    }
+    c.members = c.devices.filter(d => this.memberSet.has(d)).length;
+    c.provisional = this.provisionals.find(p => !p.cluster && Math.abs(p.startMs - startMs) <= this.windowMs) ?? null;
+    if (c.provisional) c.provisional.cluster = c;
+    let at = this.clusters.length;
+    while (at > 0 && this.clusters[at - 1].startMs > startMs) at--;
+    this.clusters.splice(at, 0, c);
+    return c;
+  }
+}
+
+module.exports = { ConsensusEngine };
@@ -0,0 +1,88 @@
+// ── Event feed (change stream) ───────────────────────────────────
+// With the roles split (SERVER_ROLE=ingest / dashboard), the process that
+// stores an upload is not the one the browsers are connected to. The
+// dashboard side learns of new events by tailing a change stream on
+// `events` instead: every inserted device event (no consensus entries;
+// those are published by the consensus lease holder) comes to onEvent as
+// the stored document, in insert order, once the ingest batch that holds
+// it is written.
+//
+// The driver resumes by itself across elections and dropped connections.
+// An error it can't resume from closes the stream; it is opened again
+// after RETRY_MS from the last resume token, so nothing in between is
+// missed. When the oplog no longer reaches back that far (history lost)
+// it starts from now and onGap() is called, for the caller to re-read what
+// it holds (RecentEvents.sync).
+//
+// Change streams need a replica set (a single-node one will do).
+
+const RETRY_MS = 2000;
+const HISTORY_LOST = 286;   // ChangeStreamHistoryLost
+
+const PIPELINE = [
+  { $match: { operationType: 'insert', $or: [{ 'fullDocument.status': { $exists: false } }, { 'fullDocument.status': 'PULLED' }] } },
+];
+
+class EventFeed {
+  constructor(col, { onEvent, onGap = () => {}, onError = () => {} }) {
+    this.col = col;
+    this.onEvent = onEvent;
+    this.onGap = onGap;
+    this.onError = onError;
+    this.stream = null;
+    this.token = null;       // resume token of the last change handed on
+    this.timer = null;
+    this.stopped = false;
+    this.stats = { events: 0, errors: 0, reopened: 0, gaps: 0, last_event: null };
+  }
+
+  start() {
+    this.open();
+    return this;
+  }
+
+  open() {
+    if (this.stopped) return;
+    const stream = this.col.watch(PIPELINE, this.token ? { resumeAfter: this.token } : {});
+    this.stream = stream;
+    stream.on('change', (change) => {
+      this.token = change._id;
+      this.stats.events++;
+      this.stats.last_event = new Date();
+      try {
+        this.onEvent(change.fullDocument);
+      } catch (e) {
+        this.onError(e);
+      }
+    });
+    stream.on('error', (e) => {
+      this.stats.errors++;
+      this.onError(e);
+      if (e.code === HISTORY_LOST) {
+        this.stats.gaps++;
+        this.token = null;
+        this.onGap();
+      }
+      stream.close().catch(() => {});
+      if (this.stream !== stream) return;
+      this.stream = null;
+      clearTimeout(this.timer);
+      this.timer = setTimeout(() => {
+        this.stats.reopened++;
+        this.open();
+      }, RETRY_MS);
+    });
+  }
+
+  stop() {
+    this.stopped = true;
+    clearTimeout(this.timer);
+    return this.stream?.close();
+  }
+
+  metrics() {
+    return { open: !!this.stream, ...this.stats };
+  }
+}
+
+module.exports = { EventFeed };
@@ -0,0 +1,147 @@
+// ── Firmware store ───────────────────────────────────────────────
+// firmware/firmware.json (metadata, written by Deploy.ps1) and
+// firmware/firmware.bin, held in memory so /api/init and the OTA route never
+// touch the disk. The directory is watched; a change reloads both (after
+// SETTLE_MS, as a deploy writes the two files one after the other), off the
+// event loop apart from hashing. Until the first load finishes, and when a
+// file is missing or unreadable, info() / image() are null.
+//
+// The image carries the gzip body and both MD5s. ESP8266 core 3.x writes a
+// gzip image as-is and eboot inflates it on the next boot, so the
+// compressed body is all that has to cross the air.
+//
+// byteRange() reads a Range header against a body of size bytes, for the
+// resumable download.
+
+const fs = require('fs');
+const path = require('path');
+const zlib = require('zlib');
+const crypto = require('crypto');
+const { promisify } = require('util');
+
+const gzip = promisify(zlib.gzip);
+const SETTLE_MS = 500;
+const POLL_MS = 5000;   // fs.watchFile, where fs.watch can't be had (no directory yet)
+
+const md5 = (buf) => crypto.createHash('md5').update(buf).digest('hex');
+
+class FirmwareStore {
+  constructor(dir) {
+    this.dir = dir;
+    this.meta = null;
+    this.bin = null;
+    this.binStat = null;
+    this.watcher = null;
+    this.timer = null;
+    this.loading = null;
+    this.stats = { loads: 0, errors: 0 };
+  }
+
+  info() {
+    return this.meta;
+  }
+
+  image() {
+    return this.bin;
+  }
+
+  start() {
+    this.reload();
+    try {
+      this.watcher = fs.watch(this.dir, () => this.changed());
+      this.watcher.on('error', () => this.poll());
+    } catch {
+      this.poll();
+    }
+    return this;
+  }
+
+  // No directory to watch: stat the metadata until one shows up
+  poll() {
+    if (this.watcher) this.watcher.close();
+    this.watcher = null;
+    fs.watchFile(path.join(this.dir, 'firmware.json'), { interval: POLL_MS }, () => this.changed());
+    fs.watchFile(path.join(this.dir, 'firmware.bin'), { interval: POLL_MS }, () => this.changed());
+  }
+
+  changed() {
+    clearTimeout(this.timer);
+    this.timer = setTimeout(() => this.reload(), SETTLE_MS);
+  }
+
+  // One load at a time; a change during one starts another after it
+  reload() {
+    if (this.loading) {
+      this.loading.then(() => this.changed());
+      return this.loading;
+    }
+    this.loading = this.load().finally(() => { this.loading = null; });
+    return this.loading;
+  }
+
+  async load() {
+    this.stats.loads++;
+    try {
+      this.meta = JSON.parse(await fs.promises.readFile(path.join(this.dir, 'firmware.json'), 'utf8'));
+    } catch (e) {
+      if (e.code !== 'ENOENT') {
+        this.stats.errors++;
+        console.error('Firmware metadata error:', e.message);
+      }
+      this.meta = null;
+    }
+
+    const binPath = path.join(this.dir, 'firmware.bin');
+    let stat;
+    try {
+      stat = await fs.promises.stat(binPath);
+    } catch {
+      this.bin = this.binStat = null;
+      return;
+    }
+    if (this.binStat && this.binStat.mtimeMs === stat.mtimeMs && this.binStat.size === stat.size) return;
+    try {
+      const raw = await fs.promises.readFile(binPath);
+      const gz = await gzip(raw, { level: 9 });
+      this.bin = { raw, md5: md5(raw), gz, gzMd5: md5(gz), loadedAt: new Date() };
+      this.binStat = stat;
+      console.log(`[FIRMWARE] firmware.bin ${raw.length} bytes, gzip ${gz.length} (md5 ${this.bin.md5})`);
+    } catch (e) {
+      this.stats.errors++;
+      console.error('Firmware image error:', e.message);
+    }
+  }
+
+  metrics() {
+    return {
+      version: this.meta?.version ?? null,
+      bytes: this.bin?.raw.length ?? null,
+      gzip_bytes: this.bin?.gz.length ?? null,
+      md5: this.bin?.md5 ?? null,
+      loaded_at: this.bin?.loadedAt ?? null,
+      ...this.stats,
+    };
+  }
+}
+
+// 'bytes=a-b' | 'bytes=a-' | 'bytes=-n' against size bytes
+//   -> { start, end } (inclusive), null (no usable Range: send it all),
+//      or false (not satisfiable: 416)
+// Multiple ranges aren't worth a multipart body here and get it all.
+function byteRange(header, size) {
+  const m = /^bytes=(\d*)-(\d*)$/.exec((header || '').trim());
+  if (!m || (!m[1] && !m[2])) return null;
+  let start;
+  let end;
+  if (!m[1]) {
+    start = Math.max(0, size - parseInt(m[2], 10));
+    end = size - 1;
+  } else {
+    start = parseInt(m[1], 10);
+    end = m[2] ? Math.min(parseInt(m[2], 10), size - 1) : size - 1;
+  }
+  if (start >= size || start > end) return false;
+  return { start, end };
+}
+
+module.exports = { FirmwareStore, byteRange };
@@ -0,0 +1,152 @@
+// ── Device ingest gateway ────────────────────────────────────────
+// A bare http.Server that serves only the device routes, on a port of its
+// own (DEVICE_PORT). Heartbeats and uploads then never wait behind the
+// dashboard's Express stack: cors, compression, the body parsers and
+// logging middleware for every request, static files, the SPA fallback,
+// and Socket.IO's upgrade handling.
+//
+// Each request is read here: the route is looked up, the query parsed flat
+// (the devices never repeat a key) and a body of up to BODY_LIMIT buffered,
+// or handed to the route's body reader, which decodes it as it streams in
+// (waveform uploads, whose limit is per device). It then goes on an
+// in-process queue. The core drains the queue on
+// setImmediate, DRAIN_BATCH requests a turn, into the same handler functions
+// Express routes to. A few Express response helpers are added to the plain
+// response for them (status, set, type, json, send). Past MAX_QUEUE waiting
+// requests, new ones are answered 503 with Retry-After straight away. The
+// firmware journals an upload refused that way and retries a heartbeat.
+
+const BODY_LIMIT = 50 * 1024;
+const MAX_QUEUE = 256;
+const DRAIN_BATCH = 32;
+
+// Express's res helpers the device handlers use, on a plain ServerResponse
+function expressish(res) {
+  res.status = (code) => { res.statusCode = code; return res; };
+  res.set = (name, value) => { res.setHeader(name, value); return res; };
+  res.type = (type) => res.set('Content-Type', type);
+  res.json = (obj) => {
+    const body = Buffer.from(JSON.stringify(obj));
+    if (!res.getHeader('Content-Type')) res.setHeader('Content-Type', 'application/json; charset=utf-8');
+    res.setHeader('Content-Length', body.length);
+    res.end(body);
+    return res;
+  };
+  res.send = (body) => {
+    const buf = Buffer.isBuffer(body) ? body : Buffer.from(String(body));
+    res.setHeader('Content-Length', buf.length);
+    res.end(buf);
+    return res;
+  };
+  return res;
+}
+
+class DeviceGateway {
+  // routes: { 'GET /path': handler(req, res, next) }; bodyReaders: { 'POST
+  // /path': (req) => Promise of req.body }, rejecting with err.status;
+  // onDone(route, method, code, receivedAt) once each response has gone
+  constructor(routes, { jsonTypes = ['application/json'], bodyReaders = {}, onDone = null } = {}) {
+    this.routes = routes;
+    this.jsonTypes = jsonTypes;
+    this.bodyReaders = bodyReaders;
+    this.onDone = onDone;
+    this.queue = [];
+    this.draining = false;
+    this.stats = { served: 0, shed: 0, rejected: 0, max_depth: 0 };
+    this.handle = this.handle.bind(this);
+  }
+
+  // Request listener for http(s).createServer
+  handle(req, res) {
+    const receivedAt = Date.now();
+    const q = req.url.indexOf('?');
+    const path = q < 0 ? req.url : req.url.slice(0, q);
+    const route = `${req.method} ${path}`;
+    const handler = this.routes[route];
+    expressish(res);
+    res.on('close', () => this.onDone?.(handler ? route : null, req.method, res.statusCode, receivedAt));
+    if (!handler) {
+      this.stats.rejected++;
+      req.resume();
+      return res.status(404).json({ error: 'Not a device route' });
+    }
+    if (this.queue.length >= MAX_QUEUE) {
+      this.stats.shed++;
+      req.resume();
+      return res.status(503).set('Retry-After', '5').json({ error: 'Gateway queue full' });
+    }
+    req.receivedAt = receivedAt;
+    req.path = path;
+    req.ip = req.socket.remoteAddress;
+    req.query = Object.fromEntries(new URLSearchParams(q < 0 ? '' : req.url.slice(q + 1)));
+    if (req.method !== 'POST') {
+      req.body = undefined;
+      return this.enqueue(handler, req, res);
+    }
+    const reader = this.bodyReaders[route];
+    if (reader) {
+      return reader(req).then((body) => {
+        req.body = body;
+        this.enqueue(handler, req, res);
+      }, (err) => {
+        this.stats.rejected++;
+        res.status(err.status || 400).json({ error: err.message });
+      });
+    }
+    const chunks = [];
+    let length = 0;
+    req.on('data', (chunk) => {
+      length += chunk.length;
+      if (length <= BODY_LIMIT) chunks.push(chunk);
+    });
+    req.on('end', () => {
+      if (length > BODY_LIMIT) {
+        this.stats.rejected++;
+        return res.status(413).json({ error: `Body over ${BODY_LIMIT} bytes` });
+      }
+      const body = Buffer.concat(chunks, length);
+      const type = (req.headers['content-type'] || '').split(';')[0].trim();
+      if (this.jsonTypes.includes(type)) {
+        try {
+          req.body = JSON.parse(body.toString('utf8'));
+        } catch (e) {
+          this.stats.rejected++;
+          return res.status(400).json({ error: `Invalid JSON: ${e.message}` });
+        }
+      } else {
+        req.body = body;
+      }
+      this.enqueue(handler, req, res);
+    });
+  }
+
+  enqueue(handler, req, res) {
+    this.queue.push({ handler, req, res });
+    this.stats.max_depth = Math.max(this.stats.max_depth, this.queue.length);
+    if (!this.draining) {
+      this.draining = true;
+      setImmediate(() => this.drain());
+    }
+  }
+
+  drain() {
+    for (const { handler, req, res } of this.queue.splice(0, DRAIN_BATCH)) {
+      this.stats.served++;
+      const notFound = () => res.status(404).json({ error: 'Not found' });
+      Promise.resolve()
+        .then(() => handler(req, res, notFound))
+        .catch((err) => {
+          console.error(`[GATEWAY] ${req.method} ${req.path}: ${err.message}`);
+          if (!res.headersSent) res.status(500).json({ error: 'Internal server error' });
+        });
+    }
+    if (this.queue.length) return setImmediate(() => this.drain());
+    this.draining = false;
+  }
+
+  metrics() {
+    return { ...this.stats, depth: this.queue.length };
+  }
+}
+
+module.exports = { DeviceGateway, expressish, BODY_LIMIT, MAX_QUEUE };
@@ -0,0 +1,87 @@
+// ── HTTP request log ─────────────────────────────────────────────
+// Every /api request, kept two ways with nothing allocated per request:
+//   - a ring of the last RING_SIZE (time, endpoint) pairs in typed arrays
+//   - per-endpoint, per-minute counters for the last COUNT_MINUTES minutes,
+//     one Uint32Array per endpoint indexed by epoch minute; a slot is zeroed
+//     when a new minute first lands on it
+// Endpoints are route patterns (/api/events/:id/waveform), so the set stays
+// small; past MAX_ENDPOINTS names everything else counts as '(other)'.
+
+const RING_SIZE = 8192;
+const COUNT_MINUTES = 24 * 60;
+const MAX_ENDPOINTS = 256;
+const OTHER = '(other)';
+
+class HttpLog {
+  constructor() {
+    this.times = new Float64Array(RING_SIZE);
+    this.codes = new Uint16Array(RING_SIZE);     // endpoint index
+    this.head = 0;
+    this.filled = 0;
+    this.names = [];
+    this.index = new Map();                      // name → endpoint index
+    this.counts = [];                            // endpoint index → Uint32Array(COUNT_MINUTES)
+    this.minuteOf = new Float64Array(COUNT_MINUTES).fill(-1);   // epoch minute each slot holds
+    this.total = 0;
+  }
+
+  endpointIndex(name) {
+    let i = this.index.get(name);
+    if (i !== undefined) return i;
+    if (this.names.length >= MAX_ENDPOINTS - 1 && name !== OTHER) return this.endpointIndex(OTHER);
+    i = this.names.push(name) - 1;
+    this.index.set(name, i);
+    this.counts.push(new Uint32Array(COUNT_MINUTES));
+    return i;
+  }
+
+  record(endpoint, now = Date.now()) {
+    const e = this.endpointIndex(endpoint);
+    this.times[this.head] = now;
+    this.codes[this.head] = e;
+    this.head = (this.head + 1) % RING_SIZE;
+    if (this.filled < RING_SIZE) this.filled++;
+
+    const minute = Math.floor(now / 60000);
+    const slot = minute % COUNT_MINUTES;
+    if (this.minuteOf[slot] !== minute) {
+      this.minuteOf[slot] = minute;
+      for (const c of this.counts) c[slot] = 0;
+    }
+    this.counts[e][slot]++;
+    this.total++;
+  }
+
+  // Last `minutes` whole and current minute, oldest first ->
+  // { start, minute_ms, total, endpoints: { name: [count, ...] } }
+  histogram(minutes = 60, now = Date.now()) {
+    const n = Math.max(1, Math.min(COUNT_MINUTES, minutes | 0));
+    const last = Math.floor(now / 60000);
+    const endpoints = {};
+    this.names.forEach((name, e) => {
+      const row = new Array(n);
+      let any = false;
+      for (let k = 0; k < n; k++) {
+        const minute = last - n + 1 + k;
+        const slot = minute % COUNT_MINUTES;
+        row[k] = this.minuteOf[slot] === minute ? this.counts[e][slot] : 0;
+        if (row[k]) any = true;
+      }
+      if (any) endpoints[name] = row;
+    });
+    return { start: new Date((last - n + 1) * 60000).toISOString(), minute_ms: 60000, total: this.total, endpoints };
+  }
+
+  // Newest `limit` requests, oldest first -> [{ timestamp, endpoint }]
+  recent(limit = 100) {
+    const n = Math.max(0, Math.min(this.filled, limit | 0));
+    const out = new Array(n);
+    for (let k = 0; k < n; k++) {
+      const i = (this.head - n + k + RING_SIZE) % RING_SIZE;
+      out[k] = { timestamp: new Date(this.times[i]).toISOString(), endpoint: this.names[this.codes[i]] };
+    }
+    return out;
+  }
+}
+
+module.exports = { HttpLog, RING_SIZE, COUNT_MINUTES };
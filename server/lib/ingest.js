@@ -0,0 +1,230 @@
+// ── Write-behind event ingestion ─────────────────────────────────
+// POST /api/seismic answers once an event is in the local journal, not once
+// Mongo has it. enqueue() appends the entry as one JSON line and fsyncs;
+// uploads arriving while a sync is in flight share the next one (group
+// commit). A timer then moves the queue into the collection with
+// insertMany, FLUSH_MAX_BATCH at a time, every FLUSH_INTERVAL_MS or as soon
+// as a full batch is waiting. An event's waveform, in its stored form
+// (waveform.packWaveform()), rides along and goes into its own collection
+// first, under the event's _id. Entries get their _id up front, so a batch
+// retried after a failure, or a journal replayed on startup, only hits
+// duplicate-key errors for what already landed, and those count as stored.
+// The journal is truncated whenever everything in it has been flushed.
+// Queue and journal hold the event as the API shows it; what goes into
+// Mongo is its compact form (lib/schema.js), kept on the item as `stored`.
+
+const fs = require('fs');
+const path = require('path');
+const { ObjectId } = require('mongodb');
+const schema = require('./schema');
+
+const FLUSH_INTERVAL_MS = 250;
+const FLUSH_MAX_BATCH = 50;
+const RETRY_MAX_MS = 30000;
+const RECENT_KEYS = 4096;        // (device, epoch, seq) keys remembered for duplicate answers
+const seqKey = (id, epoch, seq) => `${id}:${epoch || 0}:${seq}`;
+
+class IngestQueue {
+  constructor(collection, waveformCollection, file) {
+    this.col = collection;
+    this.waveCol = waveformCollection;
+    this.file = file;
+    this.fh = null;
+    this.queue = [];             // { event, waveform|null }
+    this.syncingEvents = new Set();   // handed to enqueue(), not yet journaled
+    this.recent = new Map();     // seqKey → true, insertion order (an LRU of one touch)
+    this.syncing = null;         // promise of the fsync in flight
+    this.waiting = [];           // lines for the next fsync
+    this.unflushed = 0;          // journal lines whose entry isn't in Mongo yet
+    this.truncateWanted = false;
+    this.flushing = false;
+    this.timer = null;
+    this.retryMs = FLUSH_INTERVAL_MS;
+    this.onFlushed = null;       // (batch of { event, stored, waveform }) once they're in Mongo
+    this.stats = {
+      enqueued: 0, flushed: 0, batches: 0, errors: 0, replayed: 0,
+      last_flush_ms: null, max_flush_ms: 0, last_sync_ms: null, max_sync_ms: 0,
+      last_error: null,
+    };
+  }
+
+  // Open the journal and queue whatever a previous run left in it
+  async open() {
+    fs.mkdirSync(path.dirname(this.file), { recursive: true });
+    let text = '';
+    try { text = fs.readFileSync(this.file, 'utf8'); } catch {}
+    for (const line of text.split('\n')) {
+      if (!line) continue;
+      try {
+        const { event, waveform } = JSON.parse(line);
+        event._id = new ObjectId(event._id);
+        if (event.time) event.time = new Date(event.time);
+        if (event.modified) event.modified = new Date(event.modified);
+        if (waveform) {
+          waveform._id = event._id;
+          waveform.t = Buffer.from(waveform.t, 'base64');
+          waveform.samples = Buffer.from(waveform.samples, 'base64');
+        }
+        this.queue.push({ event, waveform: waveform || null });
+        this.unflushed++;
+        this.stats.replayed++;
+      } catch {}   // a line cut short by a crash was never acknowledged
+    }
+    this.fh = await fs.promises.open(this.file, 'a');
+    if (this.queue.length) {
+      console.log(`[INGEST] ${this.queue.length} journaled events from the last run`);
+      this.schedule(0);
+    }
+  }
+
+  // True if this device sequence number (in its seq epoch) was taken recently
+  seen(id, seq, epoch) {
+    return Number.isFinite(seq) && this.recent.has(seqKey(id, epoch, seq));
+  }
+
+  // An event still waiting for its flush, by _id hex string -> { event, waveform }
+  pending(hex) {
+    return this.queue.find(item => item.event._id.toHexString() === hex) || null;
+  }
+
+  // Journal one event (assigns its _id) and its stored waveform, if any;
+  // resolves once it's on disk
+  async enqueue(entry, wave = null) {
+    entry._id ??= new ObjectId();
+    if (Number.isFinite(entry.seq)) {
+      this.recent.set(seqKey(entry.id, entry.seq_epoch, entry.seq), true);
+      if (this.recent.size > RECENT_KEYS) this.recent.delete(this.recent.keys().next().value);
+    }
+    const waveform = wave ? { _id: entry._id, ...wave } : null;
+    const line = JSON.stringify({
+      event: { ...entry, _id: entry._id.toHexString() },
+      waveform: waveform && { ...waveform, _id: undefined, t: waveform.t.toString('base64'),
+                              samples: waveform.samples.toString('base64') },
+    }) + '\n';
+    this.syncingEvents.add(entry);
+    try {
+      await this.sync(line);
+    } finally {
+      this.syncingEvents.delete(entry);
+    }
+    this.queue.push({ event: entry, waveform });
+    this.stats.enqueued++;
+    // A full batch goes at once, unless a failed flush is backing off
+    const full = this.queue.length >= FLUSH_MAX_BATCH && this.retryMs === FLUSH_INTERVAL_MS;
+    this.schedule(full ? 0 : FLUSH_INTERVAL_MS);
+    return entry;
+  }
+
+  // Group commit: one write + fdatasync for every line handed in meanwhile
+  sync(line) {
+    return new Promise((resolve, reject) => {
+      this.waiting.push({ line, resolve, reject });
+      if (!this.syncing) this.syncing = this.drainSync();
+    });
+  }
+
+  // All journal I/O runs here, so a truncate never races an append
+  async drainSync() {
+    while (this.waiting.length || this.truncateWanted) {
+      if (this.truncateWanted) {
+        this.truncateWanted = false;
+        if (this.unflushed === 0) await this.truncate();
+        continue;
+      }
+      const group = this.waiting;
+      this.waiting = [];
+      const t0 = Date.now();
+      try {
+        await this.fh.appendFile(group.map(g => g.line).join(''));
+        await this.fh.datasync();
+        this.unflushed += group.length;
+        const ms = Date.now() - t0;
+        this.stats.last_sync_ms = ms;
+        this.stats.max_sync_ms = Math.max(this.stats.max_sync_ms, ms);
+        group.forEach(g => g.resolve());
+      } catch (e) {
+        group.forEach(g => g.reject(e));
+      }
+    }
+    this.syncing = null;
+  }
+
+  schedule(ms) {
+    if (this.flushing) return;            // flush() reschedules itself
+    if (this.timer && ms > 0) return;
+    clearTimeout(this.timer);
+    this.timer = setTimeout(() => this.flush(), ms);
+  }
+
+  async flush() {
+    this.timer = null;
+    if (this.flushing || this.queue.length === 0) return;
+    this.flushing = true;
+    const batch = this.queue.slice(0, FLUSH_MAX_BATCH);
+    const waves = batch.map(item => item.waveform).filter(Boolean);
+    const t0 = Date.now();
+    // Waveforms first: an event is never listed without its samples
+    let ok = !waves.length || await this.insert(this.waveCol, waves);
+    if (ok) ok = await this.insert(this.col, batch.map(item => (item.stored = schema.compact(item.event))), batch);
+    const ms = Date.now() - t0;
+    this.stats.last_flush_ms = ms;
+    this.stats.max_flush_ms = Math.max(this.stats.max_flush_ms, ms);
+    if (ok) {
+      this.queue.splice(0, batch.length);
+      this.stats.flushed += batch.length;
+      this.stats.batches++;
+      this.retryMs = FLUSH_INTERVAL_MS;
+      this.unflushed -= batch.length;
+      try { this.onFlushed?.(batch); } catch (e) { console.error('[INGEST] onFlushed:', e.message); }
+      if (this.unflushed === 0) {
+        this.truncateWanted = true;
+        if (!this.syncing) this.syncing = this.drainSync();
+      }
+    } else {
+      this.retryMs = Math.min(this.retryMs * 2, RETRY_MAX_MS);
+    }
+    this.flushing = false;
+    if (this.queue.length) this.schedule(ok && this.queue.length >= FLUSH_MAX_BATCH ? 0 : this.retryMs);
+  }
+
+  // insertMany that counts duplicate keys (already stored) as success; the
+  // items of those are marked duplicate (a replay whose seq was stored under
+  // another _id, or the same _id flushed before a restart)
+  async insert(col, docs, items = null) {
+    try {
+      await col.insertMany(docs, { ordered: false });
+      return true;
+    } catch (e) {
+      const errors = e.writeErrors ? [].concat(e.writeErrors) : [];
+      if (errors.length > 0 && errors.every(w => w.code === 11000)) {
+        if (items) for (const w of errors) if (items[w.index]) items[w.index].duplicate = true;
+        return true;
+      }
+      this.stats.errors++;
+      this.stats.last_error = e.message;
+      console.error(`[INGEST] insertMany failed, ${this.queue.length} queued: ${e.message}`);
+      return false;
+    }
+  }
+
+  async truncate() {
+    try { await this.fh.truncate(0); } catch (e) { console.error('[INGEST] journal truncate:', e.message); }
+  }
+
+  // Latest `modified` time up to which every event is readable from Mongo:
+  // just before the oldest one still journaling or queued, else now
+  watermark(now = new Date()) {
+    let t = now.getTime();
+    const older = (e) => { if (e.modified && e.modified.getTime() - 1 < t) t = e.modified.getTime() - 1; };
+    if (this.queue.length) older(this.queue[0].event);
+    this.syncingEvents.forEach(older);
+    return new Date(t);
+  }
+
+  metrics() {
+    return { depth: this.queue.length, oldest_ms: this.queue.length ? Date.now() - this.queue[0].event._id.getTimestamp().getTime() : 0,
+             ...this.stats };
+  }
+}
+
+module.exports = { IngestQueue, FLUSH_INTERVAL_MS, FLUSH_MAX_BATCH };
@@ -0,0 +1,117 @@
+// ── Compact /api/init body ───────────────────────────────────────
+// Firmware that sends Accept: application/vnd.seismo.init gets its init
+// config as one fixed-layout binary record instead of JSON, decoded on the
+// device straight into a struct (layout documented in src/init_config.h):
+//   "SIC" version u8, config section length u16, length before the CRC u16,
+//   config section (what a cached copy on the device can stand in for),
+//   boot section (server_time_ms, recalibrate, firmware offer), crc32
+//
+// Enum fields are indexes into the lists below, which follow the firmware's
+// enums. Fields added later go at the end of their section; older firmware
+// skips what its section length says is there. A layout change that can't
+// be read that way bumps VERSION.
+
+const { crc32 } = require('./serialcapture');
+
+const MAGIC = 'SIC';
+const VERSION = 1;
+const CONTENT_TYPE = 'application/vnd.seismo.init';
+const HEADER = 8;
+const MAX_STRING = 127;   // the device's longest string field, less the NUL
+
+const TRIGGER_MODES = ['threshold', 'sta_lta', 'both'];
+const DETECT_METRICS = ['max_abs', 'horizontal', 'vertical', 'vector', 'gravity_vertical', 'gravity_horizontal'];
+const STREAM_MODES = ['off', 'udp'];
+const UPLOAD_FORMATS = ['json', 'binary', 'msgpack', 'delta'];   // UploadFormat order
+const MAX_FORMATS = 4;
+
+const code = (list, value) => Math.max(0, list.indexOf(value));
+
+// Appends fields to a growing list of buffers
+class Writer {
+  constructor() { this.parts = []; }
+  u8(v) { this.parts.push(Buffer.from([v & 0xff])); }
+  u16(v) { const b = Buffer.alloc(2); b.writeUInt16LE(Math.max(0, Math.min(0xffff, Math.round(v || 0)))); this.parts.push(b); }
+  u32(v) { const b = Buffer.alloc(4); b.writeUInt32LE(Math.max(0, Math.min(0xffffffff, Math.round(v || 0)))); this.parts.push(b); }
+  i64(v) { const b = Buffer.alloc(8); b.writeBigInt64LE(BigInt(Math.round(v || 0))); this.parts.push(b); }
+  f32(v) { const b = Buffer.alloc(4); b.writeFloatLE(Number(v) || 0); this.parts.push(b); }
+  str(s) {
+    const bytes = Buffer.from(String(s || ''), 'utf8').subarray(0, MAX_STRING);
+    this.u8(bytes.length);
+    this.parts.push(bytes);
+  }
+  buffer() { return Buffer.concat(this.parts); }
+}
+
+// The settings half of initConfig()'s object; everything the device may keep
+// across a reboot
+function encodeConfigSection(config) {
+  const w = new Writer();
+  const s = config.sensitivity || {};
+  w.u32(config.config_gen);
+  w.u32(config.heartbeat_interval);
+  w.u32(config.push_heartbeat_interval);
+  w.f32(s.minor);
+  w.f32(s.moderate);
+  w.f32(s.severe);
+  w.u16(config.sample_rate_hz);
+  w.u8(config.dlpf);
+  w.u8(code(TRIGGER_MODES, config.trigger_mode));
+  w.u8(code(DETECT_METRICS, config.detect_metric));
+  w.u8(code(STREAM_MODES, config.stream_mode));
+  w.u8((config.spectrum ? 1 : 0) | (config.local_http ? 2 : 0));
+  const formats = (config.upload_formats || []).filter(f => UPLOAD_FORMATS.includes(f)).slice(0, MAX_FORMATS);
+  w.u8(formats.length);
+  for (let i = 0; i < MAX_FORMATS; i++) w.u8(i < formats.length ? UPLOAD_FORMATS.indexOf(formats[i]) : 0);
+  w.u16(config.pre_ms);
+  w.u16(config.post_ms);
+  w.u16(config.max_post_ms);
+  w.u16(config.sta_ms);
+  w.u32(config.lta_ms);
+  w.f32(config.sta_lta_on);
+  w.f32(config.sta_lta_off);
+  w.f32(config.hp_hz);
+  w.f32(config.lp_hz);
+  w.f32(config.stream_hz);
+  w.u16(config.bias_track_s);
+  w.u16(config.stream_port);
+  w.u16(config.mqtt ? config.mqtt.port : 0);
+  w.u16(config.session ? config.session.port : 0);
+  w.str(config.ntp_server);
+  w.str(config.mqtt ? config.mqtt.host : '');
+  return w.buffer();
+}
+
+// CRC-32 of the config section, as the device reports it back (?cfh= on
+// the heartbeat) to say which settings it is running on
+function configCrc(config) {
+  return crc32(encodeConfigSection(config)) >>> 0;
+}
+
+// initConfig()'s object plus the per-boot fields -> the whole body
+function encodeInit(config, { server_time_ms = Date.now(), recalibrate = false } = {}) {
+  const section = encodeConfigSection(config);
+  const boot = new Writer();
+  boot.i64(server_time_ms);
+  boot.u8(recalibrate ? 1 : 0);
+  boot.str(config.firmware_version);
+  boot.str(config.firmware_url);
+  const bootBuf = boot.buffer();
+
+  const header = Buffer.alloc(HEADER);
+  header.write(MAGIC, 0, 'latin1');
+  header[3] = VERSION;
+  header.writeUInt16LE(section.length, 4);
+  header.writeUInt16LE(HEADER + section.length + bootBuf.length, 6);
+  const body = Buffer.concat([header, section, bootBuf]);
+  const crc = Buffer.alloc(4);
+  crc.writeUInt32LE(crc32(body) >>> 0);
+  return Buffer.concat([body, crc]);
+}
+
+// Whether the request's Accept header asks for the binary body
+function wantsBinary(req) {
+  return String(req.headers.accept || '').includes(CONTENT_TYPE);
+}
+
+module.exports = { encodeInit, encodeConfigSection, configCrc, wantsBinary, CONTENT_TYPE, VERSION };
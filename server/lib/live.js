@@ -0,0 +1,110 @@
+// ── Live channel (Socket.IO) ─────────────────────────────────────
+// Server pushes go through publish(type, payload, deviceId) rather than
+// io.emit. Each one takes the next sequence number and goes out as
+// emit(type, payload, seq) only to the sockets subscribed to it. The last
+// REPLAY_MAX (no older than REPLAY_MS) are kept, so a client that
+// reconnects is sent what it missed instead of refetching everything.
+//
+// A client states its subscription in the handshake (auth), which
+// socket.io repeats on every reconnect:
+//   { channels: ['live' | 'admin'], types: [...], devices: [id, ...] | null,
+//     since: last seq seen | null, epoch: from the last 'live:resume' }
+// and is answered, after any replay, with 'live:resume' { epoch, seq,
+// resumed }. resumed is false when `since` is missing, older than the
+// buffer or from another server run; a client that had been connected
+// then refetches. 'subscribe' with the same fields (without since)
+// changes the subscription later. Rooms are 't:<type>' for all devices,
+// 't:<type>:<id>' for one and 't:<type>:*' for messages about no device in
+// particular; sockets that never subscribe join 'all' and get everything,
+// as before.
+//
+// publish(..., { local: true }) skips the adapter: for a message every
+// instance produces itself (the dashboards' change-stream events), which
+// would otherwise reach each socket once per instance.
+//
+// With { replay: false } nothing is buffered and every answer is resumed:
+// false; for several instances sharing rooms through an adapter, whose
+// sequence numbers are each their own.
+
+const CHANNELS = {
+  live: ['seismic:event', 'seismic:trigger', 'seismic:consensus', 'seismic:consensus_provisional',
+         'seismic:consensus_retracted', 'seismic:pulled', 'seismic:analysis', 'devices:status', 'device:init'],
+  admin: ['devices:status', 'device:init', 'device:trace', 'device:storm', 'device:reinit_sent',
+          'device:reinit_completed', 'device:reinit_requested', 'device:reinit_all_requested',
+          'config:updated'],
+};
+const REPLAY_MAX = 2000;
+const REPLAY_MS = 10 * 60 * 1000;
+
+class LiveChannel {
+  constructor(io, { replay = true } = {}) {
+    this.io = io;
+    this.replay = replay;
+    this.epoch = Date.now().toString(36);
+    this.seq = 0;
+    this.recent = [];             // { seq, at, type, payload, device } oldest first
+    io.on('connection', (socket) => this.connect(socket));
+  }
+
+  // { types: Set, devices: Set|null } from a client's request, or null
+  parse(req) {
+    if (!req || typeof req !== 'object') return null;
+    const types = new Set(Array.isArray(req.types) ? req.types.map(String) : []);
+    for (const c of Array.isArray(req.channels) ? req.channels : []) (CHANNELS[c] || []).forEach(t => types.add(t));
+    if (!types.size) return null;
+    const devices = Array.isArray(req.devices) ? new Set(req.devices.map(String)) : null;
+    return { types, devices };
+  }
+
+  subscribe(socket, sub) {
+    for (const room of [...socket.rooms]) if (room !== socket.id) socket.leave(room);
+    socket.data.sub = sub;
+    if (!sub) return socket.join('all');
+    for (const t of sub.types) {
+      if (!sub.devices) socket.join(`t:${t}`);
+      else ['*', ...sub.devices].forEach(id => socket.join(`t:${t}:${id}`));
+    }
+  }
+
+  connect(socket) {
+    const req = socket.handshake.auth || {};
+    const sub = this.parse(req);
+    this.subscribe(socket, sub);
+    socket.on('subscribe', (next) => this.subscribe(socket, this.parse(next)));
+    if (!sub) return;
+
+    this.prune(Date.now());
+    const since = Number.isFinite(req.since) ? req.since : null;
+    const oldest = this.recent.length ? this.recent[0].seq : this.seq + 1;
+    const resumed = this.replay && since !== null && req.epoch === this.epoch && since >= oldest - 1 && since <= this.seq;
+    if (resumed) {
+      for (const m of this.recent) {
+        if (m.seq <= since || !sub.types.has(m.type)) continue;
+        if (sub.devices && m.device && !sub.devices.has(m.device)) continue;
+        socket.emit(m.type, m.payload, m.seq);
+      }
+    }
+    socket.emit('live:resume', { epoch: this.epoch, seq: this.seq, resumed });
+  }
+
+  prune(now) {
+    let n = 0;
+    while (n < this.recent.length && (this.recent.length - n > REPLAY_MAX || now - this.recent[n].at > REPLAY_MS)) n++;
+    if (n) this.recent.splice(0, n);
+  }
+
+  // deviceId narrows a per-device message to that device's subscribers
+  publish(type, payload, deviceId = null, { local = false } = {}) {
+    const seq = ++this.seq;
+    const now = Date.now();
+    if (this.replay) {
+      this.recent.push({ seq, at: now, type, payload, device: deviceId });
+      this.prune(now);
+    }
+    const rooms = ['all', `t:${type}`, `t:${type}:${deviceId || '*'}`];
+    (local ? this.io.local : this.io).to(rooms).emit(type, payload, seq);
+    return seq;
+  }
+}
+
+module.exports = { LiveChannel, CHANNELS };
@@ -0,0 +1,84 @@
+// ── Live stream frames (Socket.IO) ───────────────────────────────
+// Rolling seismograph for the dashboard, fed from the UDP stream buffers
+// (lib/stream.js). A socket asks with
+//   'stream:watch' { px, seconds, devices: [id, ...] | null }
+// and is sent, every FRAME_MS, one binary 'stream:frame' (id, frame) per
+// watched streaming device that has new complete columns. Columns are
+// seconds × 1000 / px ms wide, each client its own, so one column is one
+// pixel of that client's display whatever the device's rate. The first
+// frame backfills the whole window. 'stream:unwatch' or a disconnect
+// stops it. Nothing goes through LiveChannel: frames are per client and
+// not worth replaying.
+//
+// Frame, little-endian:
+//   0  float64  epoch ms of the first column's start (a multiple of the width)
+//   8  float64  column width, ms
+//  16  uint16   column count n
+//  18  uint16   stream rate, Hz (after the device's decimation)
+//  20  n × 6 int16  x min, x max, y min, y max, z min, z max, raw LSB
+//                   (16384 per g); min > max marks a column without samples
+//
+// streams: deviceId → StreamBuffer, as held by server.js. Only datagrams
+// that reached this instance can be shown.
+
+const FRAME_MS = 250;
+const HEADER_SIZE = 20;
+const MAX_PX = 4000;
+const MAX_SECONDS = 600;
+
+function frame(from, colMs, rateHz, columns) {
+  const n = columns.length / 6;
+  const buf = Buffer.alloc(HEADER_SIZE + columns.byteLength);
+  buf.writeDoubleLE(from, 0);
+  buf.writeDoubleLE(colMs, 8);
+  buf.writeUInt16LE(n, 16);
+  buf.writeUInt16LE(Math.round(rateHz) || 0, 18);
+  Buffer.from(columns.buffer, columns.byteOffset, columns.byteLength).copy(buf, HEADER_SIZE);
+  return buf;
+}
+
+class LiveStream {
+  constructor(io, streams, { frameMs = FRAME_MS } = {}) {
+    this.streams = streams;
+    this.watchers = new Map();    // socket → { colMs, px, devices: Set|null, next: { id → epoch ms } }
+    io.on('connection', (socket) => {
+      socket.on('stream:watch', (req) => this.watch(socket, req));
+      socket.on('stream:unwatch', () => this.watchers.delete(socket));
+      socket.on('disconnect', () => this.watchers.delete(socket));
+    });
+    this.timer = setInterval(() => this.tick(), frameMs);
+    this.timer.unref?.();
+  }
+
+  watch(socket, req) {
+    const px = Math.min(MAX_PX, Math.max(10, Math.round(Number(req?.px) || 800)));
+    const seconds = Math.min(MAX_SECONDS, Math.max(1, Number(req?.seconds) || 60));
+    const devices = Array.isArray(req?.devices) ? new Set(req.devices.map(String)) : null;
+    this.watchers.set(socket, { px, colMs: (seconds * 1000) / px, devices, next: {} });
+  }
+
+  tick() {
+    for (const [socket, w] of this.watchers) {
+      for (const [id, buffer] of Object.entries(this.streams)) {
+        if (w.devices && !w.devices.has(id)) continue;
+        const newest = buffer.newestMs();
+        if (newest === null) continue;
+        // Column starts sit on a grid of colMs, so a client's columns never straddle two frames
+        const last = Math.floor(newest / w.colMs) * w.colMs;
+        let from = w.next[id] ?? last - w.px * w.colMs;
+        if (from < last - w.px * w.colMs) from = last - w.px * w.colMs;   // fell behind (or the stream restarted)
+        const count = Math.round((last - from) / w.colMs);
+        if (count <= 0) continue;
+        w.next[id] = last;
+        const rate = buffer.packets[buffer.packets.length - 1].rate_hz;
+        socket.emit('stream:frame', id, frame(from, w.colMs, rate, buffer.columns(from, w.colMs, count)));
+      }
+    }
+  }
+
+  close() {
+    clearInterval(this.timer);
+  }
+}
+
+module.exports = { LiveStream, FRAME_MS };
@@ -0,0 +1,171 @@
+// ── Arrival-time localization ────────────────────────────────────
+// Where a consensus came from, from the first trigger time of each device
+// in the cluster and the device coordinates in the registry. Positions are
+// projected to east/north metres about the first node (equirectangular,
+// fine over a few km). Two least-squares models:
+//   plane wave   (3+ nodes)  t_i = t0 + s·r_i, linear in (t0, s_e, s_n).
+//                PlaneWaveFit keeps the normal equations, so a trigger
+//                joining the cluster is one row added and a 3x3 solve.
+//                -> back azimuth (direction the wave came from, degrees
+//                clockwise from north) and apparent velocity
+//   point source (4+ nodes, velocity given)  t_i = t0 + |p - r_i| / v,
+//                Gauss-Newton on (p_e, p_n, t0) started from the previous
+//                solution, else one aperture out along the back azimuth
+// Times go in as epoch ms and are solved relative to the first arrival.
+
+const EARTH_RADIUS_M = 6371000;
+const GN_MAX_ITER = 20;
+const GN_STEP_M = 0.01;     // stop once a step moves the source less than this
+
+// { lat, lon } → { e, n } metres relative to origin
+function project(origin, p) {
+  const k = Math.PI / 180;
+  return {
+    e: (p.lon - origin.lon) * k * EARTH_RADIUS_M * Math.cos(origin.lat * k),
+    n: (p.lat - origin.lat) * k * EARTH_RADIUS_M,
+  };
+}
+
+function unproject(origin, { e, n }) {
+  const k = Math.PI / 180;
+  return {
+    lat: origin.lat + n / EARTH_RADIUS_M / k,
+    lon: origin.lon + e / (EARTH_RADIUS_M * Math.cos(origin.lat * k)) / k,
+  };
+}
+
+// Solves the 3x3 system m·x = b (partial pivoting); null when singular
+function solve3(m, b) {
+  const a = m.map((row, i) => [...row, b[i]]);
+  for (let c = 0; c < 3; c++) {
+    let p = c;
+    for (let r = c + 1; r < 3; r++) if (Math.abs(a[r][c]) > Math.abs(a[p][c])) p = r;
+    if (Math.abs(a[p][c]) < 1e-12) return null;
+    [a[c], a[p]] = [a[p], a[c]];
+    for (let r = 0; r < 3; r++) {
+      if (r === c) continue;
+      const f = a[r][c] / a[c][c];
+      for (let k = c; k < 4; k++) a[r][k] -= f * a[c][k];
+    }
+  }
+  return [a[0][3] / a[0][0], a[1][3] / a[1][1], a[2][3] / a[2][2]];
+}
+
+// Normal equations of t = t0 + s_e·e + s_n·n, one row per node
+class PlaneWaveFit {
+  constructor() {
+    this.ata = [[0, 0, 0], [0, 0, 0], [0, 0, 0]];
+    this.atb = [0, 0, 0];
+    this.n = 0;
+  }
+
+  add(e, n, t) {
+    const row = [1, e, n];
+    for (let i = 0; i < 3; i++) {
+      for (let j = 0; j < 3; j++) this.ata[i][j] += row[i] * row[j];
+      this.atb[i] += row[i] * t;
+    }
+    this.n++;
+  }
+
+  // -> [t0, s_e, s_n] (s in s/m) or null (under 3 nodes, or all in a line)
+  solve() {
+    return this.n >= 3 ? solve3(this.ata, this.atb) : null;
+  }
+}
+
+// Gauss-Newton for a point source at known velocity; obs [{ e, n, t }]
+function pointSource(obs, velocity, start) {
+  let [pe, pn, t0] = start;
+  for (let iter = 1; iter <= GN_MAX_ITER; iter++) {
+    const ata = [[0, 0, 0], [0, 0, 0], [0, 0, 0]];
+    const atb = [0, 0, 0];
+    for (const o of obs) {
+      const de = pe - o.e, dn = pn - o.n;
+      const d = Math.max(Math.hypot(de, dn), 1e-6);
+      const r = o.t - (t0 + d / velocity);
+      const row = [de / d / velocity, dn / d / velocity, 1];
+      for (let i = 0; i < 3; i++) {
+        for (let j = 0; j < 3; j++) ata[i][j] += row[i] * row[j];
+        atb[i] += row[i] * r;
+      }
+    }
+    const step = solve3(ata, atb);
+    if (!step || !step.every(Number.isFinite)) return null;
+    pe += step[0]; pn += step[1]; t0 += step[2];
+    if (Math.hypot(step[0], step[1]) < GN_STEP_M) return { e: pe, n: pn, t0, iterations: iter };
+  }
+  return null;
+}
+
+const rmsMs = (residuals) => Math.sqrt(residuals.reduce((s, r) => s + r * r, 0) / residuals.length) * 1000;
+
+// Per-cluster state, so later triggers refine the previous solution
+class Locator {
+  constructor({ velocity = null } = {}) {
+    this.velocity = velocity;     // m/s for the point source; null = plane wave only
+    this.origin = null;
+    this.t0ms = null;
+    this.obs = [];                // { id, e, n, t } t in s after the first arrival
+    this.fit = new PlaneWaveFit();
+    this.point = null;
+  }
+
+  // A device's first trigger; devices without coordinates are skipped.
+  // -> true when it was used
+  add(id, timeMs, pos) {
+    if (!pos || !Number.isFinite(pos.lat) || !Number.isFinite(pos.lon)) return false;
+    if (this.obs.some(o => o.id === id)) return false;
+    if (!this.origin) {
+      this.origin = { lat: pos.lat, lon: pos.lon };
+      this.t0ms = timeMs;
+    }
+    const { e, n } = project(this.origin, pos);
+    const t = (timeMs - this.t0ms) / 1000;
+    this.obs.push({ id, e, n, t });
+    this.fit.add(e, n, t);
+    return true;
+  }
+
+  // -> the entry's `location`, or null with under 3 usable nodes
+  solve() {
+    const plane = this.fit.solve();
+    if (!plane) return null;
+    const [t0, se, sn] = plane;
+    const slowness = Math.hypot(se, sn);
+    const result = {
+      method: 'plane_wave',
+      nodes: this.obs.length,
+      back_azimuth_deg: slowness > 0 ? (Math.atan2(-se, -sn) * 180 / Math.PI + 360) % 360 : null,
+      apparent_velocity_m_s: slowness > 0 ? 1 / slowness : null,
+      rms_ms: rmsMs(this.obs.map(o => o.t - (t0 + se * o.e + sn * o.n))),
+    };
+    if (!this.velocity || this.obs.length < 4) return result;
+
+    // Point source, warm-started from the last one
+    let start = this.point && [this.point.e, this.point.n, this.point.t0];
+    if (!start) {
+      const ce = this.obs.reduce((s, o) => s + o.e, 0) / this.obs.length;
+      const cn = this.obs.reduce((s, o) => s + o.n, 0) / this.obs.length;
+      const aperture = Math.max(1, ...this.obs.map(o => Math.hypot(o.e - ce, o.n - cn)));
+      const ue = slowness > 0 ? -se / slowness : 0, un = slowness > 0 ? -sn / slowness : 0;
+      start = [ce + ue * aperture, cn + un * aperture, -aperture / this.velocity];
+    }
+    const p = pointSource(this.obs, this.velocity, start);
+    if (!p) return result;
+    this.point = p;
+    const at = unproject(this.origin, p);
+    return {
+      ...result,
+      method: 'point_source',
+      lat: at.lat,
+      lon: at.lon,
+      origin_ms: this.t0ms + p.t0 * 1000,
+      velocity_m_s: this.velocity,
+      iterations: p.iterations,
+      rms_ms: rmsMs(this.obs.map(o => o.t - (p.t0 + Math.hypot(p.e - o.e, p.n - o.n) / this.velocity))),
+    };
+  }
+}
+
+module.exports = { Locator, PlaneWaveFit, project, unproject };
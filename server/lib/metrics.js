@@ -0,0 +1,139 @@
+// ── Prometheus metrics ───────────────────────────────────────────
+// A small registry rendering the text exposition format (0.0.4) for
+// GET /metrics: counters, gauges and histograms with labels. Series are
+// kept in Maps keyed by their label values; counters and gauges may instead
+// be read at scrape time through a collect() callback returning
+// [[labels, value], ...], for values the server already keeps elsewhere.
+// Histogram.addBuckets() merges counts a device already bucketed (loop
+// profile), as long as its edges are the histogram's.
+
+const CONTENT_TYPE = 'text/plain; version=0.0.4; charset=utf-8';
+
+const escapeLabel = (v) => String(v).replace(/\\/g, '\\\\').replace(/"/g, '\\"').replace(/\n/g, '\\n');
+const formatValue = (v) => (v === Infinity ? '+Inf' : v === -Infinity ? '-Inf' : Number.isNaN(v) ? 'NaN' : String(v));
+
+function labelText(names, values, extra = '') {
+  const parts = names.map((n, i) => `${n}="${escapeLabel(values[i])}"`);
+  if (extra) parts.push(extra);
+  return parts.length ? `{${parts.join(',')}}` : '';
+}
+
+class Metric {
+  constructor(type, name, help, labelNames = []) {
+    this.type = type;
+    this.name = name;
+    this.help = help;
+    this.labelNames = labelNames;
+    this.series = new Map();      // label values joined by \u0001 → state
+  }
+
+  values(labels) {
+    return this.labelNames.map(n => labels[n] ?? '');
+  }
+
+  get(labels, init) {
+    const values = this.values(labels);
+    const key = values.join('\u0001');
+    let s = this.series.get(key);
+    if (!s) this.series.set(key, s = { values, ...init() });
+    return s;
+  }
+
+  header() {
+    return `# HELP ${this.name} ${this.help}\n# TYPE ${this.name} ${this.type}\n`;
+  }
+}
+
+// Counter and gauge: one value per series
+class Scalar extends Metric {
+  constructor(type, name, help, labelNames, collect = null) {
+    super(type, name, help, labelNames);
+    this.collect = collect;
+  }
+
+  inc(labels = {}, by = 1) {
+    this.get(labels, () => ({ value: 0 })).value += by;
+  }
+
+  set(labels, value) {
+    this.get(labels, () => ({ value: 0 })).value = value;
+  }
+
+  render() {
+    let out = this.header();
+    const rows = this.collect ? this.collect() : [...this.series.values()].map(s => [s.values, s.value]);
+    for (const [labels, value] of rows) {
+      if (value == null || !Number.isFinite(Number(value))) continue;
+      const values = Array.isArray(labels) ? labels : this.values(labels);
+      out += `${this.name}${labelText(this.labelNames, values)} ${formatValue(Number(value))}\n`;
+    }
+    return out;
+  }
+}
+
+class Histogram extends Metric {
+  constructor(name, help, labelNames, buckets) {
+    super('histogram', name, help, labelNames);
+    this.buckets = [...buckets].sort((a, b) => a - b);
+  }
+
+  state(labels) {
+    return this.get(labels, () => ({ counts: new Array(this.buckets.length + 1).fill(0), sum: 0, count: 0 }));
+  }
+
+  observe(labels, v) {
+    const s = this.state(labels);
+    let k = 0;
+    while (k < this.buckets.length && v > this.buckets[k]) k++;
+    s.counts[k]++;
+    s.sum += v;
+    s.count++;
+  }
+
+  // counts[k]: observations in bucket k (not cumulative), the last one above
+  // every edge
+  addBuckets(labels, counts, sum) {
+    const s = this.state(labels);
+    for (let k = 0; k < s.counts.length && k < counts.length; k++) {
+      s.counts[k] += counts[k];
+      s.count += counts[k];
+    }
+    s.sum += sum;
+  }
+
+  render() {
+    let out = this.header();
+    for (const s of this.series.values()) {
+      let cumulative = 0;
+      this.buckets.forEach((edge, k) => {
+        cumulative += s.counts[k];
+        out += `${this.name}_bucket${labelText(this.labelNames, s.values, `le="${formatValue(edge)}"`)} ${cumulative}\n`;
+      });
+      out += `${this.name}_bucket${labelText(this.labelNames, s.values, 'le="+Inf"')} ${s.count}\n`;
+      out += `${this.name}_sum${labelText(this.labelNames, s.values)} ${formatValue(s.sum)}\n`;
+      out += `${this.name}_count${labelText(this.labelNames, s.values)} ${s.count}\n`;
+    }
+    return out;
+  }
+}
+
+class Registry {
+  constructor() {
+    this.metrics = [];
+  }
+
+  add(metric) {
+    this.metrics.push(metric);
+    return metric;
+  }
+
+  counter(name, help, labelNames = [], collect = null) { return this.add(new Scalar('counter', name, help, labelNames, collect)); }
+  gauge(name, help, labelNames = [], collect = null) { return this.add(new Scalar('gauge', name, help, labelNames, collect)); }
+  histogram(name, help, labelNames, buckets) { return this.add(new Histogram(name, help, labelNames, buckets)); }
+
+  render() {
+    return this.metrics.map(m => m.render()).join('');
+  }
+}
+
+module.exports = { Registry, CONTENT_TYPE };
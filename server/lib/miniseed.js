@@ -0,0 +1,200 @@
+// ── MiniSEED (SEED 2.4 data records, Steim2) ─────────────────────
+// Stored waveforms as what ObsPy, SeisComP and the like read natively
+// (GET /api/export/miniseed). Each capture becomes, per axis, one channel
+// of 512-byte records: a 48-byte fixed header, blockette 1000 (Steim2,
+// big-endian, 2^9 bytes) and seven 64-byte Steim2 frames.
+//
+// Steim2 stores first differences in 32-bit words of 4×8, 3×10, 2×15 or
+// 1×30 bits, or 7×4, 6×5 and 5×6 bits for quiet stretches; each frame's
+// first word holds a 2-bit code per word. Frame 0 also carries the first
+// (X0) and last (Xn) sample of the record, which decoders check the
+// integration against. A quiet 100 Hz sensor averages 5-7 samples per
+// word, so a record holds several seconds.
+//
+// Samples are sensor counts at 16384 per g (the MPU6050's ±2 g LSB,
+// 61.035 µg), whatever scale the capture was stored at: exact, as stored
+// scales are that halved, and every record of a channel shares one gain.
+// Codes: the network is given, the station is the last five hex digits of
+// the device MAC, location 00 (10 for a second sensor), channel band by
+// sample rate (H ≥ 80 Hz, B ≥ 10 Hz, M below), N for accelerometer, and
+// 1 / 2 / Z for the sensor's x / y / z (x and y are horizontal on a
+// flat-mounted board, at whatever azimuth it was put down).
+//
+// A capture with a FIFO gap is split there: records never span one.
+
+const RECORD_BYTES = 512;
+const RECORD_EXP = 9;
+const DATA_OFFSET = 64;
+const FRAMES = (RECORD_BYTES - DATA_OFFSET) / 64;
+const STEIM2 = 11;
+const COUNTS_PER_G = 16384;
+
+// [count, bits, nibble, dnib] densest first
+const PACKINGS = [
+  [7, 4, 3, 2], [6, 5, 3, 1], [5, 6, 3, 0], [4, 8, 1, null], [3, 10, 2, 3], [2, 15, 2, 2], [1, 30, 2, 1],
+];
+
+function fits(d, from, count, bits) {
+  const max = 2 ** (bits - 1);
+  for (let i = from; i < from + count; i++) if (d[i] < -max || d[i] >= max) return false;
+  return true;
+}
+
+// One data word from count differences at d[from], and its control nibble
+function packWord(d, from, count, bits, dnib) {
+  const mask = 2 ** bits - 1;
+  let word = 0;
+  for (let i = 0; i < count; i++) word = word * 2 ** bits + ((d[from + i] & mask) >>> 0);
+  if (dnib != null) word += dnib * 2 ** 30;
+  return word;
+}
+
+// Steim2 frames of x[from..] into buf at offset; diffs start from prev
+// (the sample before from, or x[from] itself) -> samples packed
+function encodeSteim2(x, from, prev, buf, offset, frames = FRAMES) {
+  const d = new Int32Array(Math.min(x.length - from, frames * 15 * 7));
+  for (let i = 0; i < d.length; i++) d[i] = x[from + i] - (i ? x[from + i - 1] : prev);
+  let n = 0;
+  for (let f = 0; f < frames && n < d.length; f++) {
+    const base = offset + f * 64;
+    let control = 0;
+    for (let w = f === 0 ? 3 : 1; w < 16 && n < d.length; w++) {
+      const [count, bits, nibble, dnib] = PACKINGS.find(([c, b]) => c <= d.length - n && fits(d, n, c, b));
+      buf.writeUInt32BE(packWord(d, n, count, bits, dnib), base + w * 4);
+      control += nibble * 2 ** (30 - 2 * w);
+      n += count;
+    }
+    buf.writeUInt32BE(control, base);
+  }
+  buf.writeInt32BE(x[from], offset + 4);
+  buf.writeInt32BE(x[from + n - 1], offset + 8);
+  return n;
+}
+
+const pad = (s, n) => String(s).slice(0, n).padEnd(n, ' ');
+
+// SEED BTIME, to 0.0001 s
+function writeBtime(buf, offset, ms) {
+  const t = new Date(Math.floor(ms));
+  const doy = Math.floor((t - Date.UTC(t.getUTCFullYear(), 0, 1)) / 86400000) + 1;
+  buf.writeUInt16BE(t.getUTCFullYear(), offset);
+  buf.writeUInt16BE(doy, offset + 2);
+  buf.writeUInt8(t.getUTCHours(), offset + 4);
+  buf.writeUInt8(t.getUTCMinutes(), offset + 5);
+  buf.writeUInt8(t.getUTCSeconds(), offset + 6);
+  buf.writeUInt16BE(Math.min(9999, Math.round((ms - Math.floor(ms / 1000) * 1000) * 10)), offset + 8);
+}
+
+// Sample rate -> SEED factor and multiplier (tenths of a Hz when not whole)
+function rateFactor(hz) {
+  return Number.isInteger(hz) ? [hz, 1] : [Math.round(hz * 10), -10];
+}
+
+// Fixed header and blockette 1000 of a record of n samples (or bytes,
+// for encoding 0: ASCII) from startMs
+function writeHeader(buf, { network, station, location, channel, startMs, rateHz, seq, quality = 'D' }, n, encoding) {
+  const [factor, multiplier] = rateHz ? rateFactor(rateHz) : [0, 0];
+  buf.write(String(seq).padStart(6, '0') + quality + ' ', 0, 'latin1');
+  buf.write(pad(station, 5) + pad(location, 2) + pad(channel, 3) + pad(network, 2), 8, 'latin1');
+  writeBtime(buf, 20, startMs);
+  buf.writeUInt16BE(n, 30);
+  buf.writeInt16BE(factor, 32);
+  buf.writeInt16BE(multiplier, 34);
+  buf.writeUInt8(1, 39);                 // blockettes
+  buf.writeUInt16BE(DATA_OFFSET, 44);
+  buf.writeUInt16BE(48, 46);
+  buf.writeUInt16BE(1000, 48);
+  buf.writeUInt8(encoding, 52);
+  buf.writeUInt8(1, 53);                 // big-endian
+  buf.writeUInt8(RECORD_EXP, 54);
+}
+
+// One record of as many of x[from..] as fit -> { buf, n }; meta.startMs
+// is the time of x[0]
+function encodeRecord(x, from, meta) {
+  const buf = Buffer.alloc(RECORD_BYTES);
+  const n = encodeSteim2(x, from, from ? x[from - 1] : x[0], buf, DATA_OFFSET);
+  writeHeader(buf, { ...meta, startMs: meta.startMs + from * 1000 / meta.rateHz }, n, STEIM2);
+  return { buf, n };
+}
+
+// Text (SeedLink INFO) as ASCII records -> [Buffer]
+function textRecords(text, meta) {
+  const bytes = Buffer.from(text, 'latin1');
+  const per = RECORD_BYTES - DATA_OFFSET;
+  const out = [];
+  for (let from = 0; from < bytes.length || !out.length; from += per) {
+    const buf = Buffer.alloc(RECORD_BYTES);
+    const n = bytes.copy(buf, DATA_OFFSET, from, from + per);
+    writeHeader(buf, { ...meta, rateHz: 0, seq: out.length + 1 }, n, 0);
+    out.push(buf);
+  }
+  return out;
+}
+
+// x: Int32Array of one channel's samples, from startMs at rateHz ->
+// one Buffer per record. seq: the first record's sequence number.
+function* channelRecords(x, meta) {
+  let seq = meta.seq ?? 1;
+  for (let from = 0; from < x.length; seq = seq % 999999 + 1) {
+    const { buf, n } = encodeRecord(x, from, { ...meta, seq });
+    from += n;
+    yield buf;
+  }
+}
+
+// SEED channel of one sensor axis (0..2 for x, y, z) at hz
+function channelCode(hz, axis) {
+  return `${bandCode(hz)}N${'12Z'[axis]}`;
+}
+
+function bandCode(hz) {
+  return hz >= 80 ? 'H' : hz >= 10 ? 'B' : 'M';
+}
+
+function stationCode(id) {
+  return String(id).replace(/[^0-9A-Za-z]/g, '').slice(-5).toUpperCase() || 'XXXXX';
+}
+
+// A stored capture (t: count × int32 rel_ms, samples: count × int16 x,y,z
+// in 1/scale g; lib/waveform.js storedBuffers) starting at eventMs ->
+// { records: generator of Buffers, nextSeq() }. Split at gaps of more than
+// 1.5 periods; the rate comes from the longest stretch.
+function captureRecords({ t, samples, count, scale }, { eventMs, id, network, location = '00', seq = 1 }) {
+  count = Math.min(count, t.length / 4, samples.length / 6);
+  const rel = new Int32Array(count);
+  for (let i = 0; i < count; i++) rel[i] = t.readInt32LE(i * 4);
+  const steps = [];
+  for (let i = 1; i < count; i++) steps.push(rel[i] - rel[i - 1]);
+  const step = steps.length ? [...steps].sort((a, b) => a - b)[steps.length >> 1] : 10;
+  const segments = [];
+  for (let i = 0, start = 0; i < count; i++) {
+    if (i === count - 1 || rel[i + 1] - rel[i] > 1.5 * step) {
+      segments.push([start, i + 1]);
+      start = i + 1;
+    }
+  }
+  const [a, b] = segments.reduce((m, s) => (s[1] - s[0] > m[1] - m[0] ? s : m), [0, 0]);
+  const rateHz = b - a > 1 && rel[b - 1] > rel[a]
+    ? Math.round((b - a - 1) * 1000 / (rel[b - 1] - rel[a]) * 10) / 10 : 1000 / step;
+  const k = COUNTS_PER_G / scale;
+  const state = { seq };
+  function* records() {
+    for (const [s, e] of segments) {
+      for (let axis = 0; axis < 3; axis++) {
+        const x = new Int32Array(e - s);
+        for (let i = s; i < e; i++) x[i - s] = Math.round(samples.readInt16LE(i * 6 + axis * 2) * k);
+        const meta = { network, station: stationCode(id), location, channel: channelCode(rateHz, axis),
+                       startMs: eventMs + rel[s], rateHz, seq: state.seq };
+        for (const rec of channelRecords(x, meta)) {
+          state.seq = state.seq % 999999 + 1;
+          yield rec;
+        }
+      }
+    }
+  }
+  return { rateHz, records, nextSeq: () => state.seq };
+}
+
+module.exports = { captureRecords, channelRecords, encodeRecord, encodeSteim2, textRecords, channelCode, stationCode,
+                   COUNTS_PER_G, RECORD_BYTES, CONTENT_TYPE: 'application/vnd.fdsn.mseed' };
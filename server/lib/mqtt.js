@@ -0,0 +1,302 @@
+// ── MQTT ingestion ───────────────────────────────────────────────
+// Firmware built with -DMQTT_LINK=1 (src/mqtt_link.h) publishes to a broker
+// instead of calling the HTTP routes, under seismo/<MAC>/:
+//   heartbeat  the heartbeat query string                      QoS 1
+//   trigger    the trigger notice datagram (lib/notice.js)     QoS 1
+//   event      upload headers, a blank line, the upload body   QoS 1
+//   status     "online", or the will's "offline"               retained
+// and takes config (the /api/init body, retained) and cmd ("205", "203",
+// "207", "policy <mode>,<hold_ms>") from it. The server is one more client of
+// that broker (MQTT_URL): each message goes through the same handler its HTTP
+// route has, and is acked once that handler has answered.
+//
+// MqttClient is the MQTT 3.1.1 this needs and nothing else: CONNECT with a
+// persistent session (clean session off, so QoS 1 messages published while
+// the server is down wait at the broker), SUBSCRIBE, PUBLISH at QoS 0/1 both
+// ways with PUBACK, PINGREQ. No QoS 2, no will. It reconnects after
+// RECONNECT_MS for as long as it runs.
+
+const net = require('net');
+const tls = require('tls');
+
+const KEEPALIVE_S = 60;
+const RECONNECT_MS = 5000;
+const ACK_TIMEOUT_MS = 10000;
+const MAX_PACKET = 1024 * 1024;
+// Right after a CONNACK the broker hands over what it kept for our session;
+// those messages' arrival times say nothing about when they were sent
+const BACKLOG_MS = 2000;
+
+const CONNACK = 2, PUBLISH = 3, PUBACK = 4, SUBACK = 9, PINGRESP = 13;
+const NO_BYTES = Buffer.alloc(0);
+
+function u16(n) {
+  const b = Buffer.alloc(2);
+  b.writeUInt16BE(n);
+  return b;
+}
+
+function str(s) {
+  const b = Buffer.isBuffer(s) ? s : Buffer.from(String(s));
+  return Buffer.concat([u16(b.length), b]);
+}
+
+function packet(first, ...parts) {
+  const body = Buffer.concat(parts);
+  const length = [];
+  let n = body.length;
+  do {
+    let b = n % 128;
+    n = Math.floor(n / 128);
+    if (n) b |= 0x80;
+    length.push(b);
+  } while (n);
+  return Buffer.concat([Buffer.from([first, ...length]), body]);
+}
+
+// Complete packets off the front of buf -> { packets: [{ first, body }], rest }
+function splitPackets(buf) {
+  const packets = [];
+  let at = 0;
+  for (;;) {
+    if (buf.length - at < 2) break;
+    let length = 0;
+    let i = at + 1;
+    for (let mult = 1; ; mult *= 128, i++) {
+      if (i >= buf.length) return { packets, rest: buf.subarray(at) };
+      if (i - at > 4) throw new Error('Bad remaining length');
+      length += (buf[i] & 0x7f) * mult;
+      if (!(buf[i] & 0x80)) break;
+    }
+    if (length > MAX_PACKET) throw new Error(`Packet of ${length} bytes`);
+    const start = i + 1;
+    if (start + length > buf.length) break;
+    packets.push({ first: buf[at], body: buf.subarray(start, start + length) });
+    at = start + length;
+  }
+  return { packets, rest: buf.subarray(at) };
+}
+
+function decodePublish(first, body) {
+  const qos = (first >> 1) & 3;
+  const topicLength = body.readUInt16BE(0);
+  const topic = body.toString('utf8', 2, 2 + topicLength);
+  let at = 2 + topicLength;
+  let id = 0;
+  if (qos) {
+    id = body.readUInt16BE(at);
+    at += 2;
+  }
+  return { topic, qos, id, dup: !!(first & 8), retain: !!(first & 1), payload: body.subarray(at) };
+}
+
+class MqttClient {
+  // url "mqtt://[user:pass@]host[:1883]" or "mqtts://...:8883";
+  // subscriptions { filter: qos }; onMessage(msg, ack) with msg { topic,
+  // payload, qos, dup, retain, queued } and ack() sending its PUBACK;
+  // onConnect(sessionPresent) after each CONNACK
+  constructor(url, { clientId, subscriptions = {}, onMessage = null, onConnect = null } = {}) {
+    const u = new URL(url);
+    this.secure = u.protocol === 'mqtts:';
+    this.host = u.hostname;
+    this.port = parseInt(u.port, 10) || (this.secure ? 8883 : 1883);
+    this.username = decodeURIComponent(u.username);
+    this.password = decodeURIComponent(u.password);
+    this.clientId = clientId;
+    this.subscriptions = subscriptions;
+    this.onMessage = onMessage;
+    this.onConnect = onConnect;
+    this.socket = null;
+    this.connected = false;
+    this.connectedAt = 0;
+    this.lastHeard = 0;
+    this.nextId = 1;
+    this.pending = new Map();   // packet id → resolve(acked)
+    this.stopped = true;
+    this.stats = { connects: 0, received: 0, published: 0, acked: 0, disconnects: 0 };
+  }
+
+  get url() { return `${this.secure ? 'mqtts' : 'mqtt'}://${this.host}:${this.port}`; }
+
+  start() {
+    this.stopped = false;
+    this.open();
+    return this;
+  }
+
+  stop() {
+    this.stopped = true;
+    this.socket?.destroy();
+  }
+
+  open() {
+    const socket = this.secure
+      ? tls.connect({ host: this.host, port: this.port, servername: this.host })
+      : net.connect(this.port, this.host);
+    this.socket = socket;
+    socket.setNoDelay(true);
+    let buf = NO_BYTES;
+    socket.once(this.secure ? 'secureConnect' : 'connect', () => socket.write(this.connectPacket()));
+    socket.on('data', (chunk) => {
+      buf = buf.length ? Buffer.concat([buf, chunk]) : chunk;
+      let split;
+      try {
+        split = splitPackets(buf);
+      } catch (e) {
+        return socket.destroy(e);
+      }
+      buf = split.rest;
+      for (const p of split.packets) this.onPacket(socket, p);
+    });
+    socket.on('error', (err) => console.error(`[MQTT] ${this.url}: ${err.message}`));
+    socket.on('close', () => {
+      if (this.connected) this.stats.disconnects++;
+      this.connected = false;
+      clearInterval(this.pinger);
+      for (const resolve of this.pending.values()) resolve(false);
+      this.pending.clear();
+      if (this.socket === socket && !this.stopped) setTimeout(() => this.open(), RECONNECT_MS);
+    });
+  }
+
+  connectPacket() {
+    let flags = 0;   // clean session off: the broker keeps our subscriptions and QoS 1 backlog
+    const credentials = [];
+    if (this.username) {
+      flags |= 0x80;
+      credentials.push(str(this.username));
+      if (this.password) {
+        flags |= 0x40;
+        credentials.push(str(this.password));
+      }
+    }
+    return packet(0x10, str('MQTT'), Buffer.from([4, flags]), u16(KEEPALIVE_S), str(this.clientId), ...credentials);
+  }
+
+  takeId() {
+    const id = this.nextId;
+    this.nextId = this.nextId >= 0xffff ? 1 : this.nextId + 1;
+    return id;
+  }
+
+  onPacket(socket, { first, body }) {
+    const now = Date.now();
+    this.lastHeard = now;
+    switch (first >> 4) {
+      case CONNACK:
+        if (body[1] !== 0) {
+          console.error(`[MQTT] ${this.url} refused the connection (${body[1]})`);
+          return socket.destroy();
+        }
+        this.connected = true;
+        this.connectedAt = now;
+        this.stats.connects++;
+        socket.write(packet(0x82, u16(this.takeId()),
+          ...Object.entries(this.subscriptions).map(([filter, qos]) => Buffer.concat([str(filter), Buffer.from([qos])]))));
+        clearInterval(this.pinger);
+        this.pinger = setInterval(() => {
+          if (Date.now() - this.lastHeard > KEEPALIVE_S * 1500) return socket.destroy(new Error('Broker silent'));
+          socket.write(Buffer.from([0xc0, 0]));
+        }, KEEPALIVE_S * 500);
+        this.onConnect?.(!!(body[0] & 1));
+        return;
+      case PUBLISH: {
+        const msg = decodePublish(first, body);
+        msg.queued = msg.dup || now - this.connectedAt < BACKLOG_MS;
+        this.stats.received++;
+        let acked = false;
+        const ack = () => {
+          if (acked || msg.qos !== 1 || socket.destroyed) return;
+          acked = true;
+          socket.write(packet(0x40, u16(msg.id)));
+        };
+        if (!this.onMessage) return ack();
+        return this.onMessage(msg, ack);
+      }
+      case PUBACK: {
+        const resolve = this.pending.get(body.readUInt16BE(0));
+        if (!resolve) return;
+        this.pending.delete(body.readUInt16BE(0));
+        this.stats.acked++;
+        return resolve(true);
+      }
+      case SUBACK:
+      case PINGRESP:
+      default:
+        return;
+    }
+  }
+
+  // -> Promise of true once sent (QoS 0) or acked (QoS 1); false if not
+  // connected, or the connection went or ACK_TIMEOUT_MS passed first
+  publish(topic, payload, { qos = 0, retain = false } = {}) {
+    if (!this.connected) return Promise.resolve(false);
+    const id = qos ? this.takeId() : 0;
+    this.socket.write(packet(0x30 | (qos ? 2 : 0) | (retain ? 1 : 0),
+      str(topic), qos ? u16(id) : NO_BYTES, Buffer.isBuffer(payload) ? payload : Buffer.from(String(payload))));
+    this.stats.published++;
+    if (!qos) return Promise.resolve(true);
+    return new Promise((resolve) => {
+      const timer = setTimeout(() => {
+        this.pending.delete(id);
+        resolve(false);
+      }, ACK_TIMEOUT_MS);
+      this.pending.set(id, (acked) => {
+        clearTimeout(timer);
+        resolve(acked);
+      });
+    });
+  }
+
+  metrics() {
+    return { broker: this.url, connected: this.connected, ...this.stats };
+  }
+}
+
+// Just enough of http.ServerResponse for gateway.js's expressish() and the
+// device handlers: what they answered a broker message with
+class CapturedResponse {
+  constructor() {
+    this.statusCode = 200;
+    this.headers = {};
+    this.headersSent = false;
+    this.body = null;
+  }
+
+  setHeader(name, value) { this.headers[name.toLowerCase()] = value; }
+  getHeader(name) { return this.headers[name.toLowerCase()]; }
+
+  end(body = null) {
+    this.body = body;
+    this.headersSent = true;
+  }
+}
+
+// "seismo/<id>/<leaf>" -> { id, leaf } or null
+function deviceTopic(topic) {
+  const parts = topic.split('/');
+  return parts.length === 3 && parts[0] === 'seismo' && parts[1] ? { id: parts[1], leaf: parts[2] } : null;
+}
+
+// An event topic payload -> { headers (lower-cased names), body } or null
+function parseEventPayload(payload) {
+  const end = payload.indexOf('\r\n\r\n');
+  if (end < 0) return null;
+  const headers = {};
+  for (const line of payload.toString('latin1', 0, end).split('\r\n')) {
+    const colon = line.indexOf(':');
+    if (colon > 0) headers[line.slice(0, colon).trim().toLowerCase()] = line.slice(colon + 1).trim();
+  }
+  return { headers, body: payload.subarray(end + 4) };
+}
+
+// "mqtt=connected,connects,published,acked,failed,dropped" off the heartbeat, or null
+function parseMqttQuery(query) {
+  if (typeof query.mqtt !== 'string') return null;
+  const v = query.mqtt.split(',').map(x => parseInt(x, 10));
+  if (v.length !== 6 || !v.every(Number.isFinite)) return null;
+  const [connected, connects, published, acked, failed, dropped] = v;
+  return { connected: connected === 1, connects, published, acked, failed, dropped };
+}
+
+module.exports = { MqttClient, CapturedResponse, splitPackets, deviceTopic, parseEventPayload, parseMqttQuery, KEEPALIVE_S };
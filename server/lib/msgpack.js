@@ -0,0 +1,179 @@
+// ── Minimal MessagePack ──────────────────────────────────────────
+// Enough of the spec for device uploads (nil/bool/ints/floats/str/bin/
+// array/map); ext types are rejected. Bins decode to Buffer slices.
+// encode() writes the same subset, for the dashboard sockets
+// (lib/socketparser.js), and keeps to what JSON.stringify would send:
+// toJSON() is honoured (Dates become ISO strings, ObjectIds hex), undefined
+// and functions are left out of maps, non-finite numbers are nil. Buffers,
+// typed arrays and ArrayBuffers are bins.
+
+function decode(buf) {
+  let pos = 0;
+
+  const need = (n) => {
+    if (pos + n > buf.length) throw new Error('msgpack: truncated');
+  };
+  const str = (n) => { need(n); const s = buf.toString('utf8', pos, pos + n); pos += n; return s; };
+  const bin = (n) => { need(n); const b = buf.subarray(pos, pos + n); pos += n; return b; };
+  const arr = (n) => { const a = new Array(n); for (let i = 0; i < n; i++) a[i] = value(); return a; };
+  const map = (n) => {
+    const m = {};
+    for (let i = 0; i < n; i++) { const k = value(); m[k] = value(); }
+    return m;
+  };
+
+  function value() {
+    need(1);
+    const b = buf[pos++];
+    if (b <= 0x7f) return b;
+    if (b >= 0xe0) return b - 0x100;
+    if ((b & 0xf0) === 0x80) return map(b & 0x0f);
+    if ((b & 0xf0) === 0x90) return arr(b & 0x0f);
+    if ((b & 0xe0) === 0xa0) return str(b & 0x1f);
+    let v;
+    switch (b) {
+      case 0xc0: return null;
+      case 0xc2: return false;
+      case 0xc3: return true;
+      case 0xc4: need(1); return bin(buf[pos++]);
+      case 0xc5: need(2); v = buf.readUInt16BE(pos); pos += 2; return bin(v);
+      case 0xc6: need(4); v = buf.readUInt32BE(pos); pos += 4; return bin(v);
+      case 0xca: need(4); v = buf.readFloatBE(pos); pos += 4; return v;
+      case 0xcb: need(8); v = buf.readDoubleBE(pos); pos += 8; return v;
+      case 0xcc: need(1); return buf[pos++];
+      case 0xcd: need(2); v = buf.readUInt16BE(pos); pos += 2; return v;
+      case 0xce: need(4); v = buf.readUInt32BE(pos); pos += 4; return v;
+      case 0xcf: need(8); v = Number(buf.readBigUInt64BE(pos)); pos += 8; return v;
+      case 0xd0: need(1); return buf.readInt8(pos++);
+      case 0xd1: need(2); v = buf.readInt16BE(pos); pos += 2; return v;
+      case 0xd2: need(4); v = buf.readInt32BE(pos); pos += 4; return v;
+      case 0xd3: need(8); v = Number(buf.readBigInt64BE(pos)); pos += 8; return v;
+      case 0xd9: need(1); return str(buf[pos++]);
+      case 0xda: need(2); v = buf.readUInt16BE(pos); pos += 2; return str(v);
+      case 0xdb: need(4); v = buf.readUInt32BE(pos); pos += 4; return str(v);
+      case 0xdc: need(2); v = buf.readUInt16BE(pos); pos += 2; return arr(v);
+      case 0xdd: need(4); v = buf.readUInt32BE(pos); pos += 4; return arr(v);
+      case 0xde: need(2); v = buf.readUInt16BE(pos); pos += 2; return map(v);
+      case 0xdf: need(4); v = buf.readUInt32BE(pos); pos += 4; return map(v);
+      default: throw new Error(`msgpack: unsupported type 0x${b.toString(16)}`);
+    }
+  }
+
+  return value();
+}
+
+class Writer {
+  constructor(size = 256) {
+    this.buf = Buffer.allocUnsafe(size);
+    this.pos = 0;
+  }
+
+  room(n) {
+    if (this.pos + n <= this.buf.length) return;
+    const next = Buffer.allocUnsafe(Math.max(this.buf.length * 2, this.pos + n));
+    this.buf.copy(next, 0, 0, this.pos);
+    this.buf = next;
+  }
+
+  byte(b) { this.room(1); this.buf[this.pos++] = b; }
+
+  head(b, n, width) {
+    this.room(1 + width);
+    this.buf[this.pos++] = b;
+    if (width === 1) this.buf[this.pos] = n;
+    else if (width === 2) this.buf.writeUInt16BE(n, this.pos);
+    else this.buf.writeUInt32BE(n, this.pos);
+    this.pos += width;
+  }
+
+  bytes(src) {
+    this.room(src.length);
+    src.copy ? src.copy(this.buf, this.pos) : this.buf.set(src, this.pos);
+    this.pos += src.length;
+  }
+}
+
+function encodeInt(w, v) {
+  if (v >= 0) {
+    if (v <= 0x7f) return w.byte(v);
+    if (v <= 0xff) return w.head(0xcc, v, 1);
+    if (v <= 0xffff) return w.head(0xcd, v, 2);
+    if (v <= 0xffffffff) return w.head(0xce, v, 4);
+    w.room(9);
+    w.buf[w.pos] = 0xcf;
+    w.buf.writeBigUInt64BE(BigInt(v), w.pos + 1);
+    w.pos += 9;
+    return;
+  }
+  if (v >= -32) return w.byte(v + 0x100);
+  w.room(9);
+  if (v >= -0x80) { w.buf[w.pos] = 0xd0; w.buf.writeInt8(v, w.pos + 1); w.pos += 2; return; }
+  if (v >= -0x8000) { w.buf[w.pos] = 0xd1; w.buf.writeInt16BE(v, w.pos + 1); w.pos += 3; return; }
+  if (v >= -0x80000000) { w.buf[w.pos] = 0xd2; w.buf.writeInt32BE(v, w.pos + 1); w.pos += 5; return; }
+  w.buf[w.pos] = 0xd3;
+  w.buf.writeBigInt64BE(BigInt(v), w.pos + 1);
+  w.pos += 9;
+}
+
+function encodeValue(w, v) {
+  if (v === null || v === undefined) return w.byte(0xc0);
+  switch (typeof v) {
+    case 'boolean': return w.byte(v ? 0xc3 : 0xc2);
+    case 'number':
+      if (!Number.isFinite(v)) return w.byte(0xc0);
+      if (Number.isSafeInteger(v)) return encodeInt(w, v);
+      w.room(9);
+      w.buf[w.pos] = 0xcb;
+      w.buf.writeDoubleBE(v, w.pos + 1);
+      w.pos += 9;
+      return;
+    case 'bigint': return encodeValue(w, Number(v));
+    case 'string': {
+      const n = Buffer.byteLength(v);
+      if (n < 32) w.byte(0xa0 | n);
+      else if (n <= 0xff) w.head(0xd9, n, 1);
+      else if (n <= 0xffff) w.head(0xda, n, 2);
+      else w.head(0xdb, n, 4);
+      w.room(n);
+      w.buf.write(v, w.pos, n, 'utf8');
+      w.pos += n;
+      return;
+    }
+    case 'function':
+    case 'symbol':
+      return w.byte(0xc0);
+  }
+  if (Buffer.isBuffer(v) || ArrayBuffer.isView(v) || v instanceof ArrayBuffer) {
+    const bytes = Buffer.isBuffer(v) ? v
+      : v instanceof ArrayBuffer ? Buffer.from(v) : Buffer.from(v.buffer, v.byteOffset, v.byteLength);
+    if (bytes.length <= 0xff) w.head(0xc4, bytes.length, 1);
+    else if (bytes.length <= 0xffff) w.head(0xc5, bytes.length, 2);
+    else w.head(0xc6, bytes.length, 4);
+    return w.bytes(bytes);
+  }
+  if (typeof v.toJSON === 'function') return encodeValue(w, v.toJSON());
+  if (Array.isArray(v)) {
+    if (v.length < 16) w.byte(0x90 | v.length);
+    else if (v.length <= 0xffff) w.head(0xdc, v.length, 2);
+    else w.head(0xdd, v.length, 4);
+    for (const x of v) encodeValue(w, x);
+    return;
+  }
+  const keys = Object.keys(v).filter(k => v[k] !== undefined && typeof v[k] !== 'function');
+  if (keys.length < 16) w.byte(0x80 | keys.length);
+  else if (keys.length <= 0xffff) w.head(0xde, keys.length, 2);
+  else w.head(0xdf, keys.length, 4);
+  for (const k of keys) {
+    encodeValue(w, k);
+    encodeValue(w, v[k]);
+  }
+}
+
+// -> Buffer
+function encode(value) {
+  const w = new Writer();
+  encodeValue(w, value);
+  return w.buf.subarray(0, w.pos);
+}
+
+module.exports = { decode, encode };
@@ -0,0 +1,32 @@
+// ── Trigger notice decoder ───────────────────────────────────────
+// Devices send one 32-byte datagram to the stream port when a capture opens,
+// ahead of its upload (layout documented in src/trigger_notice.h):
+//   "STN1", seq u32, MAC[6], level u8, trigger u8, epoch_us i64 (0 if unknown),
+//   millis u32, peak mg u16, time source u8, pad u8
+
+const MAGIC = 'STN1';
+const SIZE = 32;
+const LEVELS = ['minor', 'moderate', 'severe'];
+const TRIGGERS = ['threshold', 'sta_lta', 'pull'];
+const SOURCES = ['none', 'server', 'ntp'];
+
+// -> { id, seq, level, trigger, deltaG, time_ms (device clock or null), time_source } or null
+function decodeNotice(buf) {
+  if (buf.length < SIZE || buf.toString('latin1', 0, 4) !== MAGIC) return null;
+  const level = LEVELS[buf[14]];
+  if (!level) return null;
+  const id = Array.from(buf.subarray(8, 14), b => b.toString(16).toUpperCase().padStart(2, '0')).join(':');
+  const epochUs = buf.readBigInt64LE(16);
+  const source = SOURCES[buf[30]] || 'none';
+  return {
+    id,
+    seq: buf.readUInt32LE(4),
+    level,
+    trigger: TRIGGERS[buf[15]] || 'threshold',
+    deltaG: buf.readUInt16LE(28) / 1000,
+    time_ms: epochUs > 0n && source !== 'none' ? Number(epochUs / 1000n) : null,
+    time_source: source,
+  };
+}
+
+module.exports = { decodeNotice, MAGIC };
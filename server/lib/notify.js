@@ -0,0 +1,207 @@
+// ── Outbound notifications ───────────────────────────────────────
+// Confirmed consensus entries are POSTed to webhooks (phones via ntfy /
+// Pushover bridges, Home Assistant, ...), but never from the consensus
+// path itself: enqueue() only inserts one outbox document per target and
+// returns. Workers deliver them, so a slow or dead target can only make
+// its own deliveries late.
+//
+//   notifications   { _id: '<key>|<target>', target, url, body, status,
+//                     attempts, created, next_at, last_error, delivered_at }
+// status is 'pending' until delivered ('done') or given up on ('failed').
+// _id is the dedupe key: the same entry enqueued twice (a replica, a
+// re-confirmation) is one delivery per target.
+//
+// A worker claims the oldest due document with one findOneAndUpdate that
+// also pushes its next_at LEASE_MS ahead, so a worker that dies mid-request
+// (or a replica that goes away) leaves it to be claimed again; replicas on
+// one database share the queue. Up to `concurrency` run at once, each until
+// nothing is due. enqueue() wakes them; while the queue is idle a single
+// one looks every POLL_MS for retries that came due.
+//
+// A failure (network, timeout, 408/429/5xx) is retried after an exponential
+// backoff from BACKOFF_MS up to MAX_BACKOFF_MS (or the target's
+// Retry-After), at most MAX_ATTEMPTS times. The backoff holds the whole
+// target, not just the one document: nothing more is sent to it until it's
+// over. Other 4xx fail at once. Each request carries Idempotency-Key (the
+// _id) for targets that can dedupe a retry whose answer was lost.
+//
+// onDelivered(target, seconds from enqueue to delivery) and
+// onAttempt(target, outcome) are for the metrics.
+
+const POLL_MS = 1000;
+const LEASE_MS = 30 * 1000;
+const TIMEOUT_MS = 10 * 1000;
+const BACKOFF_MS = 5 * 1000;
+const MAX_BACKOFF_MS = 10 * 60 * 1000;
+const MAX_ATTEMPTS = 12;          // ~1 h of backoff
+const KEEP_DAYS = 7;              // delivered and failed documents, then TTL
+const COUNT_MS = 5000;            // pending count for metrics()
+
+// 'https://a/x,https://b/y' -> [{ name, url }]; the name is the host (with
+// a count on repeats), the metric label
+function parseTargets(list) {
+  const targets = [];
+  for (const url of String(list || '').split(',').map(s => s.trim()).filter(Boolean)) {
+    let host;
+    try {
+      host = new URL(url).host;
+    } catch {
+      console.error(`Notify target ignored, not a URL: ${url}`);
+      continue;
+    }
+    const n = targets.filter(t => t.host === host).length;
+    targets.push({ name: n ? `${host}#${n + 1}` : host, host, url });
+  }
+  return targets;
+}
+
+const retryable = (status) => status === 408 || status === 429 || status >= 500;
+
+class Notifier {
+  constructor(col, targets, { concurrency = 4, onDelivered = () => {}, onAttempt = () => {}, onError = () => {} } = {}) {
+    this.col = col;
+    this.targets = new Map(targets.map(t => [t.name, { ...t, blockedUntil: 0, failures: 0 }]));
+    this.concurrency = concurrency;
+    this.onDelivered = onDelivered;
+    this.onAttempt = onAttempt;
+    this.onError = onError;
+    this.active = 0;
+    this.idle = false;      // the last claim found nothing due
+    this.timer = null;
+    this.countTimer = null;
+    this.pending = null;    // { n, oldest } as of the last count
+    this.stats = { enqueued: 0, duplicates: 0, delivered: 0, retried: 0, failed: 0 };
+  }
+
+  async start() {
+    await this.col.createIndex({ status: 1, next_at: 1 });
+    await this.col.createIndex({ expire_at: 1 }, { expireAfterSeconds: 0 });
+    this.timer = setInterval(() => this.kick(), POLL_MS);
+    this.countTimer = setInterval(() => this.count().catch(e => this.onError(e)), COUNT_MS);
+    this.kick();
+    return this;
+  }
+
+  stop() {
+    clearInterval(this.timer);
+    clearInterval(this.countTimer);
+  }
+
+  // One delivery of body per target, once per key
+  async enqueue(key, body) {
+    const now = new Date();
+    for (const t of this.targets.values()) {
+      try {
+        await this.col.insertOne({ _id: `${key}|${t.name}`, target: t.name, url: t.url, body, status: 'pending',
+                                   attempts: 0, created: now, next_at: now });
+        this.stats.enqueued++;
+      } catch (e) {
+        if (e.code !== 11000) throw e;
+        this.stats.duplicates++;
+      }
+    }
+    this.idle = false;
+    this.kick();
+  }
+
+  kick() {
+    const want = this.idle ? Math.min(1, this.concurrency - this.active) : this.concurrency - this.active;
+    for (let i = 0; i < want; i++) {
+      this.active++;
+      this.work().catch(e => this.onError(e)).finally(() => { this.active--; });
+    }
+  }
+
+  // Deliver until nothing is due for a target that isn't backing off
+  async work() {
+    for (;;) {
+      const now = Date.now();
+      const blocked = [...this.targets.values()].filter(t => t.blockedUntil > now).map(t => t.name);
+      const doc = await this.col.findOneAndUpdate(
+        { status: 'pending', next_at: { $lte: new Date(now) }, target: { $in: [...this.targets.keys()], $nin: blocked } },
+        { $set: { next_at: new Date(now + LEASE_MS) }, $inc: { attempts: 1 } },
+        { sort: { next_at: 1 }, returnDocument: 'after' });
+      if (!doc) {
+        this.idle = true;
+        return;
+      }
+      if (this.idle) {
+        this.idle = false;
+        this.kick();   // a retry came due: the rest may have too
+      }
+      await this.deliver(doc);
+    }
+  }
+
+  async deliver(doc) {
+    const target = this.targets.get(doc.target);
+    let status = 0;
+    let error = null;
+    let retryAfterMs = 0;
+    try {
+      const res = await fetch(doc.url, {
+        method: 'POST',
+        headers: { 'Content-Type': 'application/json', 'Idempotency-Key': doc._id, 'X-Seismo-Attempt': String(doc.attempts) },
+        body: JSON.stringify(doc.body),
+        signal: AbortSignal.timeout(TIMEOUT_MS),
+      });
+      status = res.status;
+      retryAfterMs = (parseInt(res.headers.get('retry-after'), 10) || 0) * 1000;
+      await res.arrayBuffer().catch(() => {});
+      if (!res.ok) error = `HTTP ${status}`;
+    } catch (e) {
+      error = e.name === 'TimeoutError' ? 'timeout' : e.message;
+    }
+
+    const now = Date.now();
+    const expire = new Date(now + KEEP_DAYS * 86400e3);
+    if (!error) {
+      target.failures = 0;
+      target.blockedUntil = 0;
+      this.stats.delivered++;
+      this.onAttempt(target.name, 'ok');
+      this.onDelivered(target.name, (now - doc.created.getTime()) / 1000);
+      await this.col.updateOne({ _id: doc._id }, { $set: { status: 'done', delivered_at: new Date(now), expire_at: expire },
+                                                   $unset: { next_at: '' } });
+      return;
+    }
+
+    target.failures++;
+    if ((status && !retryable(status)) || doc.attempts >= MAX_ATTEMPTS) {
+      this.stats.failed++;
+      this.onAttempt(target.name, 'failed');
+      console.error(`[NOTIFY] ${doc._id} given up after ${doc.attempts} attempts: ${error}`);
+      await this.col.updateOne({ _id: doc._id }, { $set: { status: 'failed', last_error: error, expire_at: expire },
+                                                   $unset: { next_at: '' } });
+      return;
+    }
+    const backoff = Math.min(MAX_BACKOFF_MS, Math.max(retryAfterMs, BACKOFF_MS * 2 ** (target.failures - 1)));
+    const wait = Math.round(backoff * (0.8 + Math.random() * 0.4));
+    target.blockedUntil = now + wait;
+    this.stats.retried++;
+    this.onAttempt(target.name, 'retry');
+    await this.col.updateOne({ _id: doc._id }, { $set: { next_at: new Date(now + wait), last_error: error } });
+  }
+
+  async count() {
+    const [c] = await this.col.aggregate([
+      { $match: { status: 'pending' } },
+      { $group: { _id: null, n: { $sum: 1 }, oldest: { $min: '$created' } } },
+    ]).toArray();
+    this.pending = { n: c?.n ?? 0, oldest: c?.oldest ?? null };
+  }
+
+  metrics() {
+    const now = Date.now();
+    return {
+      pending: this.pending?.n ?? null,
+      oldest_s: this.pending?.oldest ? Math.round((now - this.pending.oldest.getTime()) / 1000) : null,
+      active: this.active,
+      targets: [...this.targets.values()].map(t => ({ name: t.name, failures: t.failures,
+                                                      backoff_s: Math.max(0, Math.round((t.blockedUntil - now) / 1000)) })),
+      ...this.stats,
+    };
+  }
+}
+
+module.exports = { Notifier, parseTargets };
@@ -0,0 +1,100 @@
+// ── Loop timing profile decoder ──────────────────────────────────
+// Heartbeats carry the device's per-phase loop timing and sample spacing
+// histograms as query params (layout documented in src/loop_profile.h):
+//   prof_<phase>  n,total_us,max_us,b0..b8   bucket k: < 8·4^k µs, last: longer
+//   isi           n,min_ms,max_ms,b0..b6     |interval - period|: 0,1,2-3,4-7,8-15,16-31,32+ ms
+//   isr           n,period_us,late_max_us,early_max_us,gaps,boot_late_max_us
+//                 real-time builds only (src/isr_jitter.h): the data-ready ISR's
+//                 edge intervals against their mean, i.e. its entry jitter
+//   busy          mhz,bursts,upload_us,capture_us,tls_us   CPU-bound bursts
+//                 and the clock they ran at (src/cpu_boost.h)
+//   sleep         sleeps,slept_ms,window_ms,early_wakes,span_ms   modem sleep
+//                 between FIFO drains (src/modem_sleep.h)
+// Each report covers the window since the device's last acknowledged heartbeat.
+
+const PHASES = ['i2c', 'detect', 'serial', 'http', 'loop'];
+const PHASE_BUCKETS = 9;
+const INTERVAL_BUCKETS = 7;
+const PHASE_EDGES_US = Array.from({ length: PHASE_BUCKETS - 1 }, (_, k) => 8 * 4 ** k);
+const BUSY_KINDS = ['upload', 'capture', 'tls'];
+const INTERVAL_LABELS = ['0', '1', '2-3', '4-7', '8-15', '16-31', '32+'];
+const INTERVAL_EDGES_MS = [0, 1, 3, 7, 15, 31];   // largest |interval - period| in each bucket
+
+function parseList(value, buckets) {
+  if (typeof value !== 'string') return null;
+  const parts = value.split(',').map(v => parseInt(v, 10));
+  if (parts.length !== 3 + buckets || parts.some(v => !Number.isFinite(v) || v < 0)) return null;
+  return parts;
+}
+
+// Upper edge of the bucket holding the q-quantile (null if it's the open-ended last one)
+function quantileEdge(buckets, n, q, edges) {
+  let seen = 0;
+  for (let k = 0; k < buckets.length; k++) {
+    seen += buckets[k];
+    if (seen >= q * n) return k < edges.length ? edges[k] : null;
+  }
+  return null;
+}
+
+// -> { phases: { i2c: { n, total_us, avg_us, max_us, p95_us, buckets }, ... },
+//      intervals: { n, min_ms, max_ms, within_1ms_pct, p50_ms, p99_ms, buckets, labels },
+//      isr: { n, period_us, late_max_us, early_max_us, gaps, boot_late_max_us },
+//      busy: { mhz, bursts, upload_us, capture_us, tls_us },
+//      sleep: { sleeps, slept_ms, window_ms, early_wakes, span_ms, awake_pct } } or null
+function decodeProfile(query) {
+  const phases = {};
+  for (const name of PHASES) {
+    const p = parseList(query[`prof_${name}`], PHASE_BUCKETS);
+    if (!p) continue;
+    const [n, total, max, ...buckets] = p;
+    phases[name] = {
+      n, total_us: total, max_us: max,
+      avg_us: n ? Math.round(total / n) : 0,
+      p95_us: quantileEdge(buckets, n, 0.95, PHASE_EDGES_US),
+      buckets,
+    };
+  }
+
+  let intervals = null;
+  const isi = parseList(query.isi, INTERVAL_BUCKETS);
+  if (isi) {
+    const [n, min, max, ...buckets] = isi;
+    intervals = {
+      n, min_ms: min, max_ms: max,
+      within_1ms_pct: n ? Math.round((buckets[0] + buckets[1]) / n * 1000) / 10 : null,
+      p50_ms: n ? quantileEdge(buckets, n, 0.5, INTERVAL_EDGES_MS) : null,
+      p99_ms: n ? quantileEdge(buckets, n, 0.99, INTERVAL_EDGES_MS) : null,
+      buckets, labels: INTERVAL_LABELS,
+    };
+  }
+
+  let isr = null;
+  const edges = typeof query.isr === 'string' ? query.isr.split(',').map(v => parseInt(v, 10)) : [];
+  if (edges.length === 6 && edges.every(v => Number.isFinite(v) && v >= 0)) {
+    const [n, period, late, early, gaps, bootLate] = edges;
+    isr = { n, period_us: period, late_max_us: late, early_max_us: early, gaps, boot_late_max_us: bootLate };
+  }
+
+  let busy = null;
+  const bursts = typeof query.busy === 'string' ? query.busy.split(',').map(v => parseInt(v, 10)) : [];
+  if (bursts.length === 2 + BUSY_KINDS.length && bursts.every(v => Number.isFinite(v) && v >= 0)) {
+    const [mhz, n, ...us] = bursts;
+    busy = { mhz, bursts: n, ...Object.fromEntries(BUSY_KINDS.map((k, i) => [`${k}_us`, us[i]])) };
+  }
+
+  let sleep = null;
+  const naps = typeof query.sleep === 'string' ? query.sleep.split(',').map(v => parseInt(v, 10)) : [];
+  if (naps.length === 5 && naps.every(v => Number.isFinite(v) && v >= 0)) {
+    const [sleeps, slept, window, early, span] = naps;
+    sleep = {
+      sleeps, slept_ms: slept, window_ms: window, early_wakes: early, span_ms: span,
+      awake_pct: window ? Math.round((1 - Math.min(slept, window) / window) * 1000) / 10 : null,
+    };
+  }
+
+  if (!intervals && !isr && !busy && !sleep && Object.keys(phases).length === 0) return null;
+  return { phases, intervals, isr, busy, sleep };
+}
+
+module.exports = { decodeProfile, PHASES, PHASE_EDGES_US, BUSY_KINDS };
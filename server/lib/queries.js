@@ -0,0 +1,86 @@
+// ── Event indexes and query shapes ───────────────────────────────
+// Every index on the events collection is listed here, together with the
+// filters built for it, so server.js and tools/explain.js agree on what each
+// hot query looks like and which index serves it:
+//   { time: -1, _id: -1 }            /api/events keyset pages, the rollups, the recent window
+//   { id: 1, time: -1, _id: -1 }     the same, filtered by device (?device=, /api/latency?id=)
+//   { lv: 1, time: -1, _id: -1 }     the same, filtered by level (?level=, lib/schema.js codes)
+//   { time: -1 } partial on CONFIRMED /api/consensus
+// A device or level list is an $in over the index's first field, and the
+// planner merges one index range per value (SORT_MERGE) into time order, so
+// the pages never go through a blocking sort. A keyset cursor bounds time on
+// the index as well as in the $or that breaks ties on _id.
+
+const schema = require('./schema');
+
+const TIME_INDEX = { time: -1, _id: -1 };
+const DEVICE_INDEX = { id: 1, time: -1, _id: -1 };
+const LEVEL_INDEX = { lv: 1, time: -1, _id: -1 };
+const CONFIRMED_INDEX = 'confirmed_time';   // hinted by name
+const NEWEST_FIRST = { time: -1, _id: -1 };
+
+const EVENT_INDEXES = [
+  { key: TIME_INDEX },
+  { key: DEVICE_INDEX },
+  { key: LEVEL_INDEX },
+  { key: { time: -1 }, options: { name: CONFIRMED_INDEX, partialFilterExpression: { status: 'CONFIRMED' } } },
+  { key: { modified: 1, _id: 1 }, options: { partialFilterExpression: { modified: { $exists: true } } } },
+  { key: { status: 1 } },
+  { key: { id: 1, seq_epoch: 1, seq: 1 }, options: { unique: true, partialFilterExpression: { seq: { $exists: true } } } },
+];
+
+// Indexes earlier versions created, by name
+const RETIRED_INDEXES = [
+  'id_1_seq_1',              // would take a restarted count for duplicates
+  'timestamp_-1',            // the ISO string is no longer stored (lib/schema.js)
+  'level_1_time_-1__id_-1',  // level names, now codes in lv
+];
+
+async function ensureEventIndexes(eventsCol) {
+  for (const { key, options } of EVENT_INDEXES) await eventsCol.createIndex(key, options);
+  for (const name of RETIRED_INDEXES) await eventsCol.dropIndex(name).catch(() => {});
+}
+
+// /api/events (and /downsampled's $match) filters → { filter, hint }. since
+// / until are Dates, devices / levels arrays or null, after { t, id } from
+// parseEventCursor. A device list beats a level list for the index: there
+// are fewer events per device than per level. legacy: schema.migrate() is
+// still running, so a level also matches the old string field, and the
+// level index (codes only) can't serve it.
+function eventsQuery({ since = null, until = null, devices = null, levels = null, after = null, legacy = false } = {}) {
+  const filter = {};
+  if (since) filter.time = { $gte: since };
+  if (until) filter.time = { ...filter.time, $lt: until };
+  if (devices) filter.id = { $in: devices };
+  if (levels) {
+    const f = schema.levelFilter(levels, legacy);
+    if (f.$or) filter.$and = [f];
+    else Object.assign(filter, f);
+  }
+  if (after) {
+    filter.time = { ...filter.time, $lte: after.t };
+    filter.$or = [{ time: { $lt: after.t } }, { time: after.t, _id: { $lt: after.id } }];
+  }
+  const hint = devices ? DEVICE_INDEX : levels && !legacy ? LEVEL_INDEX : TIME_INDEX;
+  return { filter, hint };
+}
+
+// What tools/explain.js checks: each hot query as find() arguments
+function hotQueries(now = new Date(), ids = ['AA:BB:CC:DD:EE:FF', '11:22:33:44:55:66']) {
+  const since = new Date(now.getTime() - 86400 * 1000);
+  const after = { t: new Date(now.getTime() - 3600 * 1000), id: null };
+  const page = (name, q) => ({ name, ...eventsQuery(q), sort: NEWEST_FIRST, limit: 1000 });
+  return [
+    page('events since', { since }),
+    page('events since, device', { since, devices: ids }),
+    page('events since, level', { since, levels: ['moderate', 'severe'] }),
+    page('events since, device and level', { since, devices: ids, levels: ['severe'] }),
+    page('events page after cursor, device', { since, devices: ids.slice(0, 1), after }),
+    { name: 'latency, device', filter: { latency: { $exists: true }, id: ids[0] }, hint: DEVICE_INDEX,
+      sort: NEWEST_FIRST, limit: 500 },
+    { name: 'consensus', filter: { status: 'CONFIRMED' }, hint: CONFIRMED_INDEX, sort: { time: -1 }, limit: 0 },
+  ];
+}
+
+module.exports = { EVENT_INDEXES, TIME_INDEX, DEVICE_INDEX, LEVEL_INDEX, CONFIRMED_INDEX, NEWEST_FIRST,
+                   ensureEventIndexes, eventsQuery, hotQueries };
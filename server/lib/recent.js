@@ -0,0 +1,223 @@
+// ── Recent events ────────────────────────────────────────────────
+// The last WINDOW_MS of event documents (without waveforms) kept in memory
+// for the dashboard's default 24h view, so /api/events, the downsampled
+// scatter and the hourly rollups over that range don't go to Mongo.
+//
+// Events sit in UTC hour buckets, the rollups' own (lib/rollups.js). Each
+// bucket keeps its events in (time, _id) order plus, per device and level,
+// the count and max ΔG of the ones the rollups count (no status, numeric
+// deltaG). Buckets that have fallen out of the window are dropped whole on
+// the next add or query.
+//
+// fill() loads the window from Mongo once. After that server.js add()s every
+// event it stores and patch()es the ones it updates. With SHARED_STATE it
+// also sync()s what other instances wrote. covers(fromMs) says whether a
+// query for fromMs onwards can be answered here. Documents are held as
+// stored (lib/schema.js, either form); callers expand() what they hand out.
+
+const { BUCKET_MS, floorTo } = require('./rollups');
+const { levelOf } = require('./schema');
+
+const HOUR_MS = BUCKET_MS.hour;
+const WINDOW_MS = 25 * HOUR_MS;   // the 24h view plus the partial hour it starts in
+
+// (time, _id) order; _id hex strings compare like the ObjectIds do
+const hexOf = (doc) => String(doc._id);
+function compare(a, b) {
+  const dt = a.time - b.time;
+  if (dt) return dt;
+  const ha = hexOf(a), hb = hexOf(b);
+  return ha < hb ? -1 : ha > hb ? 1 : 0;
+}
+
+const counted = (doc) => !doc.status && typeof doc.deltaG === 'number';
+
+class RecentEvents {
+  constructor({ windowMs = WINDOW_MS } = {}) {
+    this.windowMs = windowMs;
+    this.buckets = new Map();   // start ms → { events: [], agg: Map(`${id}\n${level}` → { count, max_deltaG }) }
+    this.byId = new Map();      // _id hex → doc
+    this.filledFrom = null;     // ms; null until fill() has run
+    this.syncedTo = null;       // Date of the newest `modified` sync() has read
+    this.stats = { hits: 0, misses: 0 };
+  }
+
+  get size() { return this.byId.size; }
+
+  // Oldest bucket start still kept
+  horizon(now = Date.now()) {
+    return floorTo(now - this.windowMs, 'hour');
+  }
+
+  covers(fromMs, now = Date.now()) {
+    return this.filledFrom != null && fromMs >= Math.max(this.filledFrom, this.horizon(now));
+  }
+
+  // Count a lookup as answered here or not, for /api/info
+  hit(covered) {
+    this.stats[covered ? 'hits' : 'misses']++;
+    return covered;
+  }
+
+  async fill(eventsCol, now = Date.now()) {
+    const from = this.horizon(now);
+    this.syncedTo = new Date(now);
+    const docs = await eventsCol.find({ time: { $gte: new Date(from) } }, { projection: { waveform: 0 } }).toArray();
+    for (const doc of docs) this.add(doc, now);
+    this.filledFrom = from;
+    return docs.length;
+  }
+
+  evict(now = Date.now()) {
+    const horizon = this.horizon(now);
+    for (const [start, bucket] of this.buckets) {
+      if (start >= horizon) continue;
+      for (const doc of bucket.events) this.byId.delete(hexOf(doc));
+      this.buckets.delete(start);
+    }
+  }
+
+  // An event as stored; one already held under its _id is replaced
+  add(doc, now = Date.now()) {
+    if (!(doc?.time instanceof Date) || !doc._id) return;
+    this.evict(now);
+    const start = floorTo(doc.time.getTime(), 'hour');
+    if (start < this.horizon(now)) return;
+    const hex = hexOf(doc);
+    const held = this.byId.get(hex);
+    if (held === doc) return;
+    if (held) {
+      const bucket = this.buckets.get(floorTo(held.time.getTime(), 'hour'));
+      bucket.events.splice(bucket.events.indexOf(held), 1);
+      this.aggregate(bucket);
+    }
+    let bucket = this.buckets.get(start);
+    if (!bucket) {
+      bucket = { events: [], agg: new Map() };
+      this.buckets.set(start, bucket);
+    }
+    // Nearly always newer than everything held, so the search is from the end
+    let at = bucket.events.length;
+    while (at > 0 && compare(bucket.events[at - 1], doc) > 0) at--;
+    bucket.events.splice(at, 0, doc);
+    this.byId.set(hex, doc);
+    if (held) this.aggregate(bucket);
+    else this.count(bucket, doc);
+  }
+
+  // The same $set the event got in Mongo
+  patch(id, fields) {
+    const doc = this.byId.get(String(id));
+    if (!doc) return;
+    Object.assign(doc, fields);
+    if ('status' in fields || 'deltaG' in fields) this.aggregate(this.buckets.get(floorTo(doc.time.getTime(), 'hour')));
+  }
+
+  // Events other instances wrote or changed since the last sync (or fill)
+  async sync(eventsCol, now = Date.now()) {
+    if (this.filledFrom == null) return 0;
+    const docs = await eventsCol.find(
+      { modified: { $gt: this.syncedTo }, time: { $gte: new Date(this.horizon(now)) } },
+      { projection: { waveform: 0 } }).toArray();
+    for (const doc of docs) {
+      const held = this.byId.get(hexOf(doc));
+      if (held) this.patch(doc._id, doc);
+      else this.add(doc, now);
+      if (doc.modified > this.syncedTo) this.syncedTo = doc.modified;
+    }
+    return docs.length;
+  }
+
+  count(bucket, doc) {
+    if (!counted(doc)) return;
+    const key = `${doc.id}\n${levelOf(doc)}`;
+    const a = bucket.agg.get(key);
+    if (!a) bucket.agg.set(key, { count: 1, max_deltaG: doc.deltaG });
+    else {
+      a.count++;
+      a.max_deltaG = Math.max(a.max_deltaG, doc.deltaG);
+    }
+  }
+
+  aggregate(bucket) {
+    bucket.agg.clear();
+    for (const doc of bucket.events) this.count(bucket, doc);
+  }
+
+  // Bucket starts overlapping [fromMs, untilMs), newest first
+  starts(fromMs, untilMs) {
+    return [...this.buckets.keys()]
+      .filter(s => s + HOUR_MS > fromMs && (untilMs == null || s < untilMs))
+      .sort((a, b) => b - a);
+  }
+
+  // /api/events over the cache: time in [fromMs, untilMs), id / level in the
+  // lists (null for any), keyset after { t, id } as parseEventCursor gives
+  // it; newest first, at most limit
+  events({ fromMs, untilMs = null, ids = null, levels = null, after = null, limit = Infinity }) {
+    this.evict();
+    const out = [];
+    const afterMs = after ? after.t.getTime() : null;
+    const afterHex = after?.id ? String(after.id) : null;
+    for (const start of this.starts(fromMs, untilMs)) {
+      const events = this.buckets.get(start).events;
+      for (let i = events.length - 1; i >= 0; i--) {
+        const e = events[i];
+        const t = e.time.getTime();
+        if (untilMs != null && t >= untilMs) continue;
+        if (t < fromMs) break;
+        if (after && !(t < afterMs || (t === afterMs && afterHex && hexOf(e) < afterHex))) continue;
+        if (ids && !ids.includes(e.id)) continue;
+        if (levels && !levels.includes(levelOf(e))) continue;
+        out.push(e);
+        if (out.length >= limit) return out;
+      }
+    }
+    return out;
+  }
+
+  // /api/events/downsampled's groups: per device and bucketMs-wide slot from
+  // fromMs, the lowest and highest ΔG event and the count
+  downsample({ fromMs, toMs, bucketMs, ids = null, levels = null }) {
+    this.evict();
+    const groups = new Map();
+    const lower = (a, b) => a.deltaG < b.deltaG || (a.deltaG === b.deltaG && hexOf(a) < hexOf(b));
+    for (const start of this.starts(fromMs, toMs)) {
+      for (const e of this.buckets.get(start).events) {
+        const t = e.time.getTime();
+        if (t < fromMs || t >= toMs || !counted(e)) continue;
+        if (ids && !ids.includes(e.id)) continue;
+        if (levels && !levels.includes(levelOf(e))) continue;
+        const key = `${e.id}\n${Math.floor((t - fromMs) / bucketMs)}`;
+        const g = groups.get(key);
+        if (!g) groups.set(key, { id: e.id, lo: e, hi: e, n: 1 });
+        else {
+          g.n++;
+          if (lower(e, g.lo)) g.lo = e;
+          if (lower(g.hi, e)) g.hi = e;
+        }
+      }
+    }
+    return [...groups.values()];
+  }
+
+  // Hourly rollup rows ({ start, id, level, count, max_deltaG }) from
+  // fromMs's bucket on, oldest first, as current as the cache
+  rollupRows(fromMs) {
+    this.evict();
+    const rows = [];
+    for (const start of this.starts(fromMs, null).reverse()) {
+      for (const [key, a] of this.buckets.get(start).agg) {
+        const [id, level] = key.split('\n');
+        rows.push({ start: new Date(start), id, level, count: a.count, max_deltaG: a.max_deltaG });
+      }
+    }
+    return rows;
+  }
+
+  metrics() {
+    return { events: this.size, buckets: this.buckets.size, filled_from: this.filledFrom, ...this.stats };
+  }
+}
+
+module.exports = { RecentEvents, WINDOW_MS };
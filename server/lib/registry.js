@@ -0,0 +1,141 @@
+// ── Device registry ──────────────────────────────────────────────
+// Which devices exist and where they are, in MongoDB:
+//   devices        { _id: MAC, alias, site, group, lat, lon, added_at }
+//   device_groups  { _id: name, site, quorum, window_ms }
+// A group is the set of nodes that confirm each other's events (one
+// ConsensusEngine each, server.js); quorum / window_ms null fall back to the
+// global consensus_quorum / consensus_window_ms. Devices without a group are
+// in DEFAULT_GROUP.
+//
+// Both collections are small and read whole into Maps by load(); every
+// lookup on the request path is a Map get. Writes go to MongoDB first and
+// then to the Maps, so the cache never holds what the database doesn't.
+
+const DEFAULT_GROUP = 'default';
+
+const str = (v) => (typeof v === 'string' && v.trim() ? v.trim() : null);
+const numOrNull = (v) => (v == null || v === '' || !Number.isFinite(Number(v)) ? null : Number(v));
+const intOrNull = (v) => (v == null || v === '' ? null : Math.max(0, parseInt(v, 10) || 0));
+
+class DeviceRegistry {
+  constructor(devicesCol, groupsCol) {
+    this.devicesCol = devicesCol;
+    this.groupsCol = groupsCol;
+    this.devices = new Map();     // id → device doc
+    this.groups = new Map();      // name → group doc
+    this.byGroup = new Map();     // name → Set of ids
+    this.idList = [];
+  }
+
+  // seed: { id: alias } written when there are no devices yet
+  async load(seed = {}) {
+    await this.devicesCol.createIndex({ group: 1 });
+    if (!(await this.devicesCol.estimatedDocumentCount()) && Object.keys(seed).length) {
+      const now = new Date().toISOString();
+      await this.devicesCol.insertMany(Object.entries(seed).map(([id, alias]) =>
+        ({ _id: id, alias, site: null, group: DEFAULT_GROUP, added_at: now })));
+    }
+    return this.reload();
+  }
+
+  async reload() {
+    const [devices, groups] = await Promise.all([
+      this.devicesCol.find({}).sort({ added_at: 1, _id: 1 }).toArray(),
+      this.groupsCol.find({}).toArray(),
+    ]);
+    this.devices = new Map(devices.map(d => [d._id, d]));
+    this.groups = new Map(groups.map(g => [g._id, g]));
+    this.index();
+    return this;
+  }
+
+  index() {
+    this.byGroup = new Map();
+    for (const d of this.devices.values()) {
+      const g = d.group || DEFAULT_GROUP;
+      if (!this.byGroup.has(g)) this.byGroup.set(g, new Set());
+      this.byGroup.get(g).add(d._id);
+    }
+    this.idList = [...this.devices.keys()];
+  }
+
+  has(id) { return this.devices.has(id); }
+  get(id) { return this.devices.get(id) || null; }
+  ids() { return this.idList; }
+  groupOf(id) { return this.devices.get(id)?.group || DEFAULT_GROUP; }
+  group(name) { return this.groups.get(name) || null; }
+  members(name) { return [...(this.byGroup.get(name) || [])]; }
+
+  // Every group with devices or settings
+  groupNames() {
+    return [...new Set([DEFAULT_GROUP, ...this.byGroup.keys(), ...this.groups.keys()])];
+  }
+
+  // The stored document for id once fields are applied to it
+  merged(id, fields) {
+    const set = {};
+    if ('alias' in fields) set.alias = str(fields.alias);
+    if ('site' in fields) set.site = str(fields.site);
+    if ('group' in fields) set.group = str(fields.group) || DEFAULT_GROUP;
+    if ('lat' in fields) set.lat = numOrNull(fields.lat);   // degrees, for lib/locate.js
+    if ('lon' in fields) set.lon = numOrNull(fields.lon);
+    return { _id: id, alias: null, site: null, group: DEFAULT_GROUP, lat: null, lon: null,
+             added_at: new Date().toISOString(), ...this.devices.get(id), ...set };
+  }
+
+  // Creates or updates; only the fields given change
+  async putDevice(id, fields) {
+    return (await this.putDevices({ [id]: fields }))[0];
+  }
+
+  // { id: fields, ... } in one bulkWrite -> the docs
+  async putDevices(changes) {
+    const docs = Object.entries(changes).map(([id, fields]) => this.merged(id, fields));
+    if (!docs.length) return docs;
+    await this.devicesCol.bulkWrite(docs.map(doc => ({
+      replaceOne: { filter: { _id: doc._id }, replacement: doc, upsert: true },
+    })), { ordered: false });
+    for (const doc of docs) this.devices.set(doc._id, doc);
+    this.index();
+    return docs;
+  }
+
+  async removeDevice(id) {
+    const { deletedCount } = await this.devicesCol.deleteOne({ _id: id });
+    this.devices.delete(id);
+    this.index();
+    return deletedCount > 0;
+  }
+
+  async putGroup(name, fields) {
+    const doc = { _id: name, site: null, quorum: null, window_ms: null, ...this.groups.get(name) };
+    if ('site' in fields) doc.site = str(fields.site);
+    if ('quorum' in fields) doc.quorum = intOrNull(fields.quorum);
+    if ('window_ms' in fields) doc.window_ms = intOrNull(fields.window_ms) || null;
+    await this.groupsCol.replaceOne({ _id: name }, doc, { upsert: true });
+    this.groups.set(name, doc);
+    return doc;
+  }
+
+  // Only when no device is in it; -> false if some are
+  async removeGroup(name) {
+    if (this.byGroup.get(name)?.size) return false;
+    await this.groupsCol.deleteOne({ _id: name });
+    this.groups.delete(name);
+    return true;
+  }
+
+  // -> { devices: [...], groups: [{ name, site, quorum, window_ms, members }] }
+  toJSON() {
+    return {
+      devices: [...this.devices.values()].map(({ _id, ...d }) => ({ id: _id, ...d })),
+      groups: this.groupNames().map(name => {
+        const g = this.groups.get(name) || {};
+        return { name, site: g.site ?? null, quorum: g.quorum ?? null, window_ms: g.window_ms ?? null,
+                 members: this.members(name) };
+      }),
+    };
+  }
+}
+
+module.exports = { DeviceRegistry, DEFAULT_GROUP };
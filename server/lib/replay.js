@@ -0,0 +1,280 @@
+// ── Offline trigger replay ───────────────────────────────────────
+// Stored captures streamed back through a port of the firmware trigger and
+// lib/consensus.js under candidate settings, to see what they would have
+// detected and confirmed before anyone changes DEFAULT_CONFIG.sensitivity
+// on a live fleet. tools/replay.js feeds it from a MongoDB cursor.
+//   detectCapture  one capture through the detection pre-filter
+//                  (src/biquad.*), STA/LTA (src/sta_lta.*) and the ΔG
+//                  threshold of processSample(), same integer math on
+//                  de-biased LSB -> the sample that would trigger, or null
+//   Replay         per candidate: detections into one ConsensusEngine per
+//                  group, the clusters matched against the CONFIRMED
+//                  entries that were stored for the same span
+// Only what was captured can be replayed, so lowering a threshold shows
+// what the lower one keeps, not what it would add. Each capture runs on
+// its own: the filter is primed on its first sample and STA/LTA warms up
+// over its pre-trigger samples instead of a full LTA window. Memory is one
+// capture at a time plus the list of clusters.
+
+const { ConsensusEngine } = require('./consensus');
+const { DEFAULT_GROUP } = require('./registry');
+
+const SCALE = 16384;                  // LSB/g, as src/ESP8266_MPU6050_Seismometer.cpp
+const BIQUAD_Q = 2 ** 28;
+const STA_LTA_ENERGY_MAX = 2 ** 30;
+const LEVELS = ['minor', 'moderate', 'severe'];
+
+// The trigger and consensus keys of DEFAULT_CONFIG (server.js), the base a
+// candidate's overrides apply to when the database has no saved config
+const DETECT_DEFAULTS = {
+  sensitivity: { minor: 0.035, moderate: 0.10, severe: 0.50 },
+  trigger_mode: 'threshold',
+  sta_ms: 500, lta_ms: 30000, sta_lta_on: 4.0, sta_lta_off: 1.5,
+  hp_hz: 0.1, lp_hz: 0,
+  consensus_window_ms: 2000, consensus_quorum: 0,
+};
+
+// Saved config (or none) plus a candidate's overrides
+function candidateParams(saved, overrides = {}) {
+  const pick = (k) => overrides[k] ?? saved?.[k] ?? DETECT_DEFAULTS[k];
+  const p = Object.fromEntries(Object.keys(DETECT_DEFAULTS).map(k => [k, pick(k)]));
+  p.sensitivity = { ...DETECT_DEFAULTS.sensitivity, ...(saved?.sensitivity || {}), ...(overrides.sensitivity || {}) };
+  p.groups = overrides.groups || {};  // name → { quorum, window_ms }, over the registry's
+  p.explicit = new Set(Object.keys(overrides));
+  return p;
+}
+
+// ── Firmware port ────────────────────────────────────────────────
+// Products stay below 2^53 for int16 input, so doubles hold the int64 math
+// of src/biquad.cpp exactly; x >> n there is Math.floor(x / 2^n) here.
+function biquadCoeffs(cornerHz, rateHz, highPass) {
+  const w0 = 2 * Math.PI * Math.fround(cornerHz) / Math.fround(rateHz);
+  const cw = Math.cos(w0);
+  const alpha = Math.sin(w0) / (2 * Math.SQRT1_2);
+  const a0 = 1 + alpha;
+  const b0 = (highPass ? 1 + cw : 1 - cw) / 2;
+  const q = (v) => Math.round(v * BIQUAD_Q);
+  return { b0: q(b0 / a0), b1: q((highPass ? -2 * b0 : 2 * b0) / a0), b2: q(b0 / a0),
+           a1: q(-2 * cw / a0), a2: q((1 - alpha) / a0) };
+}
+
+class Biquad {
+  constructor(c) {
+    this.c = c;
+    this.x1 = this.x2 = this.y1 = this.y2 = 0;
+    this.residual = 0;
+  }
+
+  prime(x, y) {
+    this.x1 = this.x2 = x;
+    this.y1 = this.y2 = y;
+    this.residual = 0;
+  }
+
+  process(x) {
+    const { c } = this;
+    const acc = this.residual + c.b0 * x + c.b1 * this.x1 + c.b2 * this.x2 - c.a1 * this.y1 - c.a2 * this.y2;
+    const y = Math.floor(acc / BIQUAD_Q);
+    this.residual = acc - y * BIQUAD_Q;
+    this.x2 = this.x1; this.x1 = x;
+    this.y2 = this.y1; this.y1 = y;
+    return y;
+  }
+}
+
+class AccelFilter {
+  constructor(rateHz, hpHz, lpHz) {
+    const nyquist = rateHz * 0.45;
+    this.hp = hpHz > 0 && hpHz < nyquist ? [0, 1, 2].map(() => new Biquad(biquadCoeffs(hpHz, rateHz, true))) : null;
+    this.lp = lpHz > 0 && lpHz < nyquist ? [0, 1, 2].map(() => new Biquad(biquadCoeffs(lpHz, rateHz, false))) : null;
+    this.primed = false;
+  }
+
+  // v: [x, y, z] de-biased LSB, filtered in place
+  process(v) {
+    if (!this.hp && !this.lp) return;
+    if (!this.primed) {
+      for (let i = 0; i < 3; i++) {
+        this.hp?.[i].prime(v[i], 0);
+        this.lp?.[i].prime(this.hp ? 0 : v[i], this.hp ? 0 : v[i]);
+      }
+      this.primed = true;
+    }
+    for (let i = 0; i < 3; i++) {
+      if (this.hp) v[i] = this.hp[i].process(v[i]);
+      if (this.lp) v[i] = this.lp[i].process(v[i]);
+    }
+  }
+}
+
+// src/sta_lta.cpp with the warmup given in samples. The Q16 products can
+// pass 2^53, so the last bits of the averages may differ from the device.
+class StaLta {
+  constructor(rateHz, staMs, ltaMs, on, off, warmup) {
+    const alpha = (ms) => Math.max(1, Math.floor(65536 / Math.max(1, Math.floor(ms * rateHz / 1000))));
+    this.staAlpha = alpha(staMs);
+    this.ltaAlpha = alpha(ltaMs);
+    this.on = Math.round(on * 100);
+    this.off = Math.round(off * 100);
+    this.warmup = warmup;
+    this.seen = 0;
+    this.sta = this.lta = 0;
+    this.active = false;
+  }
+
+  update(dx, dy, dz) {
+    const e = Math.min(dx * dx + dy * dy + dz * dz, STA_LTA_ENERGY_MAX) * 65536;
+    if (this.warmup > 0) {
+      const mean = Math.floor(65536 / ++this.seen);
+      this.sta += Math.floor((e - this.sta) * Math.max(this.staAlpha, mean) / 65536);
+      this.lta += Math.floor((e - this.lta) * Math.max(this.ltaAlpha, mean) / 65536);
+      this.warmup--;
+      return false;
+    }
+    this.sta += Math.floor((e - this.sta) * this.staAlpha / 65536);
+    if (!this.active) this.lta += Math.floor((e - this.lta) * this.ltaAlpha / 65536);
+    if (!this.active) {
+      if (this.lta > 0 && this.sta * 100 >= this.lta * this.on) return (this.active = true);
+    } else if (this.sta * 100 < this.lta * this.off) {
+      this.active = false;
+    }
+    return false;
+  }
+}
+
+// wave: [[rel_ms, ax, ay, az], ...] in g, de-biased as uploaded; rateHz its
+// sample rate. -> { rel_ms, trigger, level, peak_g } for the first sample
+// that triggers under p, level from the peak after it, or null
+function detectCapture(wave, rateHz, p) {
+  if (!wave.length || !rateHz) return null;
+  const filter = new AccelFilter(rateHz, p.hp_hz, p.lp_hz);
+  const useThreshold = p.trigger_mode !== 'sta_lta';
+  const useStaLta = p.trigger_mode !== 'threshold';
+  const pre = wave.findIndex(s => s[0] >= 0);
+  const warmup = Math.min(Math.floor(p.lta_ms * rateHz / 1000), pre < 0 ? wave.length : pre);
+  const staLta = useStaLta ? new StaLta(rateHz, p.sta_ms, p.lta_ms, p.sta_lta_on, p.sta_lta_off, warmup) : null;
+  const lsb = LEVELS.map(l => Math.round(Math.fround(p.sensitivity[l]) * SCALE));
+  const v = [0, 0, 0];
+  let hit = null, peak = 0;
+  for (const s of wave) {
+    v[0] = Math.round(s[1] * SCALE); v[1] = Math.round(s[2] * SCALE); v[2] = Math.round(s[3] * SCALE);
+    filter.process(v);
+    const dev = Math.max(Math.abs(v[0]), Math.abs(v[1]), Math.abs(v[2]));
+    const fired = staLta ? staLta.update(v[0], v[1], v[2]) : false;
+    if (hit) {
+      peak = Math.max(peak, dev);
+    } else if (useThreshold && dev >= lsb[0]) {
+      hit = { rel_ms: s[0], trigger: 'threshold' };
+      peak = dev;
+    } else if (fired) {
+      hit = { rel_ms: s[0], trigger: 'sta_lta' };
+      peak = dev;
+    }
+  }
+  if (!hit) return null;
+  const level = peak >= lsb[2] ? 2 : peak >= lsb[1] ? 1 : 0;
+  return { ...hit, level: LEVELS[level], peak_g: Math.round(peak / SCALE * 10000) / 10000 };
+}
+
+// ── Replay ───────────────────────────────────────────────────────
+// registry: { groupOf(id), members(name), group(name) } (lib/registry.js),
+// candidates: [{ name, params: candidateParams(...) }]. Feed in time order:
+// capture() for every stored event with its waveform, stored() for every
+// stored CONFIRMED entry, then report().
+class Replay {
+  constructor(registry, candidates) {
+    this.registry = registry;
+    this.captures = 0;
+    this.skipped = 0;              // no waveform or under 8 samples
+    this.truth = [];               // stored CONFIRMED { group, startMs }
+    this.runs = candidates.map(({ name, params }) => ({
+      name, params,
+      engines: new Map(),
+      detections: 0,
+      byLevel: { minor: 0, moderate: 0, severe: 0 },
+      byTrigger: { threshold: 0, sta_lta: 0 },
+      clusters: [],            // { group, startMs, windowMs, devices }
+    }));
+  }
+
+  engine(run, group) {
+    let e = run.engines.get(group);
+    if (!e) {
+      const g = this.registry.group(group);
+      const over = run.params.groups[group] || {};
+      const p = run.params;
+      e = new ConsensusEngine({
+        windowMs: over.window_ms ?? (p.explicit.has('consensus_window_ms') ? null : g?.window_ms) ?? p.consensus_window_ms,
+        quorum: over.quorum ?? (p.explicit.has('consensus_quorum') ? null : g?.quorum) ?? p.consensus_quorum,
+        members: this.registry.members(group),
+      });
+      run.engines.set(group, e);
+    }
+    return e;
+  }
+
+  // event: the stored document (id, time), wave: [[rel_ms, ax, ay, az], ...]
+  capture(event, wave, rateHz) {
+    if (!wave || wave.length < 8) { this.skipped++; return; }
+    this.captures++;
+    const at = new Date(event.time ?? event.timestamp).getTime();
+    const group = this.registry.groupOf(event.id) || DEFAULT_GROUP;
+    for (const run of this.runs) {
+      const hit = detectCapture(wave, rateHz, run.params);
+      if (!hit) continue;
+      run.detections++;
+      run.byLevel[hit.level]++;
+      run.byTrigger[hit.trigger]++;
+      const engine = this.engine(run, group);
+      const r = engine.add(event.id, at + hit.rel_ms);
+      if (r?.confirmed) run.clusters.push({ group, startMs: r.cluster.startMs, windowMs: engine.windowMs, cluster: r.cluster });
+    }
+  }
+
+  stored(entry) {
+    this.truth.push({ group: entry.group || DEFAULT_GROUP, startMs: new Date(entry.time ?? entry.timestamp).getTime() });
+  }
+
+  // Per candidate: detections, and clusters against the stored CONFIRMED
+  // entries. A cluster matches a stored entry of its group that starts
+  // within its window. Detections inside matched clusters are true
+  // positives, every other detection counts as false.
+  report() {
+    return {
+      captures: this.captures,
+      skipped: this.skipped,
+      stored_confirmed: this.truth.length,
+      candidates: this.runs.map((run) => {
+        const used = new Set();
+        let matched = 0, inMatched = 0;
+        for (const c of run.clusters) {
+          const k = this.truth.findIndex((t, i) => !used.has(i) && t.group === c.group &&
+            Math.abs(t.startMs - c.startMs) <= c.windowMs);
+          if (k < 0) continue;
+          used.add(k);
+          matched++;
+          inMatched += Object.keys(c.cluster.arrivals).length;
+        }
+        const ratio = (a, b) => (b ? Math.round(a / b * 1000) / 1000 : null);
+        return {
+          name: run.name,
+          detections: run.detections,
+          suppressed: this.captures - run.detections,
+          by_level: run.byLevel,
+          by_trigger: run.byTrigger,
+          false_positives: run.detections - inMatched,
+          consensus: {
+            clusters: run.clusters.length,
+            matched,
+            missed: this.truth.length - used.size,
+            new: run.clusters.length - matched,
+            recall: ratio(used.size, this.truth.length),
+            precision: ratio(matched, run.clusters.length),
+          },
+        };
+      }),
+    };
+  }
+}
+
+module.exports = { Replay, detectCapture, candidateParams, biquadCoeffs, DETECT_DEFAULTS };
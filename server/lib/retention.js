@@ -0,0 +1,190 @@
+// ── Waveform retention ───────────────────────────────────────────
+// Stored waveforms (the `waveforms` collection, _id = event _id) go through
+// tiers as they age, so storage and the working set stop growing with every
+// minor event nobody opens again:
+//   full      as uploaded; every waveform starts here
+//   envelope  after envelopeDays, for minor device events that no
+//             CONFIRMED consensus entry counts: min/max envelope decimated
+//             (waveform.envelope) to ENVELOPE_POINTS per ENVELOPE_RUN
+//             samples. Those are real samples, so every peak, and the ΔG,
+//             survive; the rest of the trace does not
+//   archive   after archiveDays, for everything still at full resolution:
+//             t and samples deflated (waveform.archiveWaveform), lossless
+// Moderate and severe events and consensus members are never decimated.
+// A document's `tier` says where it is (none yet means full, still to be
+// looked at). Each run() walks what has aged past a tier in _id order, a
+// batch at a time; an _id carries its upload time, which is within seconds
+// of the event's. Every change is conditional on the tier it read, so
+// several instances running the job only repeat work, never undo it.
+
+const { ObjectId } = require('mongodb');
+const waveform = require('./waveform');
+const { levelOf } = require('./schema');
+
+const DAY_MS = 86400 * 1000;
+const RUN_MS = 60 * 60 * 1000;
+const BATCH = 200;
+const ENVELOPE_RUN = 50;       // samples per run: 0.5s at 100Hz
+const ENVELOPE_POINTS = 6;     // at most, per run: the lowest and highest on each axis
+const MEMBER_SLACK_MS = 60 * 1000;   // consensus windows are seconds; entries this far out are fetched
+
+// Stored byte size of a Buffer or the driver's Binary
+const size = (b) => (!b ? 0 : Buffer.isBuffer(b) ? b.length : b.buffer.length);
+const bytes = (d) => size(d.t) + size(d.t_z) + size(d.samples) + size(d.samples_z) + (d.secondary ? bytes(d.secondary) : 0);
+
+// waveform.envelope() over a stored doc -> the rows' new stored fields,
+// the second sensor (same times) kept on the same rows; null if it wouldn't shrink
+function envelopeStored(doc) {
+  const rows = waveform.unpackWaveform(doc);
+  const runs = Math.ceil(rows.length / ENVELOPE_RUN);
+  const kept = waveform.envelope(rows, { maxPoints: runs * ENVELOPE_POINTS });
+  if (kept.length >= rows.length) return null;
+  const fields = { ...waveform.packWaveform(kept), full_count: rows.length };
+  if (doc.secondary?.samples) {
+    const at = new Map(rows.map((r, i) => [r, i]));
+    const second = waveform.unpackWaveform({ ...doc, ...doc.secondary });
+    const { scale, samples } = waveform.packWaveform(kept.map(r => second[at.get(r)]));
+    fields.secondary = { scale, samples };
+  }
+  return fields;
+}
+
+class Retention {
+  // envelopeDays / archiveDays: 0 leaves that tier out
+  constructor(eventsCol, waveformsCol, { envelopeDays = 7, archiveDays = 90 } = {}) {
+    this.eventsCol = eventsCol;
+    this.waveformsCol = waveformsCol;
+    this.envelopeDays = envelopeDays;
+    this.archiveDays = archiveDays;
+    this.timer = null;
+    this.running = false;
+    this.stats = { runs: 0, enveloped: 0, archived: 0, kept: 0, bytes_before: 0, bytes_after: 0,
+                   last_run: null, last_run_ms: null, last_error: null };
+  }
+
+  async start(onError = () => {}) {
+    await this.waveformsCol.createIndex({ tier: 1, _id: 1 });
+    const run = () => this.run().catch((e) => {
+      this.stats.last_error = e.message;
+      onError(e);
+    });
+    run();
+    this.timer = setInterval(run, RUN_MS);
+    return this;
+  }
+
+  stop() {
+    clearInterval(this.timer);
+  }
+
+  // One pass over both tiers -> { enveloped, archived, kept }
+  async run(now = Date.now()) {
+    if (this.running) return null;
+    this.running = true;
+    const t0 = Date.now();
+    const done = { enveloped: 0, archived: 0, kept: 0 };
+    try {
+      if (this.envelopeDays > 0) await this.sweep(null, now - this.envelopeDays * DAY_MS, (b) => this.decimate(b, now, done));
+      if (this.archiveDays > 0) {
+        const cutoff = now - this.archiveDays * DAY_MS;
+        for (const tier of ['full', null]) await this.sweep(tier, cutoff, (b) => this.archive(b, tier, done));
+      }
+      this.stats.runs++;
+      this.stats.last_run = new Date(now);
+      this.stats.last_run_ms = Date.now() - t0;
+      for (const k of Object.keys(done)) this.stats[k] += done[k];
+    } finally {
+      this.running = false;
+    }
+    return done;
+  }
+
+  // Waveforms at `tier` with _id older than cutoffMs, BATCH at a time in _id order
+  async sweep(tier, cutoffMs, handle) {
+    const before = idBefore(cutoffMs);
+    let last = null;
+    for (;;) {
+      const docs = await this.waveformsCol.find({ tier, _id: last ? { $gt: last, $lt: before } : { $lt: before } })
+        .sort({ _id: 1 }).limit(BATCH).toArray();
+      if (!docs.length) return;
+      await handle(docs);
+      last = docs[docs.length - 1]._id;
+    }
+  }
+
+  // Untiered waveforms past envelopeDays: minor and counted by no consensus
+  // entry -> envelope, the rest -> 'full' (archive() takes them from there)
+  async decimate(docs, now, done) {
+    const events = await this.eventsCol.find({ _id: { $in: docs.map(d => d._id) } },
+      { projection: { id: 1, time: 1, lv: 1, level: 1, status: 1 } }).toArray();
+    const byId = new Map(events.map(e => [String(e._id), e]));
+    const members = await this.consensusMembers(events);
+    const archiveBefore = this.archiveDays > 0 ? now - this.archiveDays * DAY_MS : null;
+    for (const doc of docs) {
+      const e = byId.get(String(doc._id));
+      const minor = e && !e.status && levelOf(e) === 'minor' && !members.has(String(e._id));
+      const fields = minor ? envelopeStored(doc) : null;
+      if (fields) {
+        if (await this.replace(doc, null, { ...fields, tier: 'envelope' })) done.enveloped++;
+      } else if (archiveBefore && doc._id.getTimestamp().getTime() < archiveBefore) {
+        await this.archive([doc], null, done);
+      } else {
+        await this.waveformsCol.updateOne({ _id: doc._id, tier: null }, { $set: { tier: 'full' } });
+        done.kept++;
+      }
+    }
+  }
+
+  async archive(docs, tier, done) {
+    for (const doc of docs) {
+      const { set, unset } = waveform.archiveWaveform(doc);
+      const r = await this.waveformsCol.updateOne({ _id: doc._id, tier }, { $set: { ...set, tier: 'archive' }, $unset: unset });
+      if (r.modifiedCount) {
+        this.count(bytes(doc), Object.values(set).reduce((n, b) => n + size(b), 0));
+        done.archived++;
+      }
+    }
+  }
+
+  async replace(doc, tier, fields) {
+    const r = await this.waveformsCol.updateOne({ _id: doc._id, tier }, { $set: fields });
+    if (r.modifiedCount) this.count(bytes(doc), bytes(fields));
+    return r.modifiedCount > 0;
+  }
+
+  count(before, after) {
+    this.stats.bytes_before += before;
+    this.stats.bytes_after += after;
+  }
+
+  // _id strings of the device events a CONFIRMED entry counts: one of its
+  // devices, from window_ms before its time to 2 × window_ms after, the span
+  // correlateConsensus() in server.js reads
+  async consensusMembers(events) {
+    const members = new Set();
+    if (!events.length) return members;
+    const times = events.map(e => e.time.getTime());
+    const entries = await this.eventsCol.find(
+      { status: 'CONFIRMED', time: { $gte: new Date(Math.min(...times) - MEMBER_SLACK_MS), $lte: new Date(Math.max(...times) + MEMBER_SLACK_MS) } },
+      { projection: { devices: 1, time: 1, window_ms: 1 } }).toArray();
+    for (const e of events) {
+      const t = e.time.getTime();
+      if (entries.some(c => c.devices?.includes(e.id)
+          && t >= c.time.getTime() - c.window_ms && t <= c.time.getTime() + 2 * c.window_ms)) {
+        members.add(String(e._id));
+      }
+    }
+    return members;
+  }
+
+  metrics() {
+    return { envelope_days: this.envelopeDays, archive_days: this.archiveDays, ...this.stats };
+  }
+}
+
+// The smallest ObjectId of cutoffMs's second: every _id below it is older
+function idBefore(cutoffMs) {
+  return ObjectId.createFromTime(Math.floor(cutoffMs / 1000));
+}
+
+module.exports = { Retention, ENVELOPE_RUN, ENVELOPE_POINTS };
@@ -0,0 +1,102 @@
+// ── Event rollups ────────────────────────────────────────────────
+// Hourly and daily per-device, per-level summaries of the events collection
+// for the dashboard's long views, kept in one collection:
+//   { _id: { bucket, start, id, level }, bucket: 'hour'|'day', start: Date,
+//     id, level, count, max_deltaG, dg_hist: [{ bin, n }] }
+// dg_hist is the bucket's ΔG histogram on DG_EDGES (log-spaced, bins with
+// no events left out), which density() sums into a time × ΔG grid.
+// refresh() regroups every bucket from its start onwards with one
+// aggregation per bucket size and $merges the result over what was there,
+// so a bucket still filling is simply replaced each time. Buckets are UTC
+// and built on the Date `time` field (indexed). Consensus and pulled entries
+// carry a status and are left out. The level is the name, whichever form
+// the event is stored in (lib/schema.js).
+
+const { LEVEL_EXPR } = require('./schema');
+
+const BUCKET_MS = { hour: 3600 * 1000, day: 86400 * 1000 };
+const REFRESH_MS = 5 * 60 * 1000;
+const LOOKBACK_MS = 2 * 86400 * 1000;     // late uploads and journal replays land within this
+
+// ΔG bins: DG_BINS_PER_DECADE per decade from DG_MIN; bin 0 also holds
+// everything smaller, the last everything larger
+const DG_MIN = 0.01;
+const DG_BINS_PER_DECADE = 8;
+const DG_BINS = 24;                       // up to 10 g
+const DG_EDGES = Array.from({ length: DG_BINS + 1 }, (_, k) => +(DG_MIN * 10 ** (k / DG_BINS_PER_DECADE)).toPrecision(4));
+const DG_BIN = { $min: [DG_BINS - 1, { $max: [0, { $floor: {
+  $multiply: [{ $log10: { $divide: [{ $max: ['$deltaG', DG_MIN] }, DG_MIN] } }, DG_BINS_PER_DECADE],
+} }] }] };
+
+function floorTo(ms, bucket) {
+  return ms - (ms % BUCKET_MS[bucket]);
+}
+
+// Regroup [fromMs, now) into rollupsCol; fromMs is floored to each bucket
+async function refresh(eventsCol, rollupsCol, fromMs) {
+  for (const bucket of Object.keys(BUCKET_MS)) {
+    const from = new Date(floorTo(fromMs, bucket));
+    await eventsCol.aggregate([
+      { $match: { time: { $gte: from }, status: { $exists: false }, deltaG: { $type: 'number' } } },
+      { $group: {
+        _id: {
+          bucket,
+          start: { $toDate: { $subtract: [{ $toLong: '$time' }, { $mod: [{ $toLong: '$time' }, BUCKET_MS[bucket]] }] } },
+          id: '$id',
+          level: LEVEL_EXPR,
+          bin: DG_BIN,
+        },
+        n: { $sum: 1 },
+        max_deltaG: { $max: '$deltaG' },
+      } },
+      { $sort: { '_id.bin': 1 } },
+      { $group: {
+        _id: { bucket: '$_id.bucket', start: '$_id.start', id: '$_id.id', level: '$_id.level' },
+        count: { $sum: '$n' },
+        max_deltaG: { $max: '$max_deltaG' },
+        dg_hist: { $push: { bin: '$_id.bin', n: '$n' } },
+      } },
+      { $set: { bucket, start: '$_id.start', id: '$_id.id', level: '$_id.level' } },
+      { $merge: { into: rollupsCol.collectionName, on: '_id', whenMatched: 'replace', whenNotMatched: 'insert' } },
+    ]).toArray();
+  }
+}
+
+// -> { bucket, bucket_ms, dg_edges, cells: [{ start, bin, count }] }: events
+// per bucket and ΔG bin over [from, to), summed across the rollup rows that
+// match (levels, ids: arrays, or null for all). The answer grows with the
+// number of buckets, not with the number of events behind them.
+async function density(rollupsCol, { bucket, from, to, levels = null, ids = null }) {
+  const match = { bucket, start: { $gte: new Date(floorTo(from, bucket)), $lt: new Date(to) } };
+  if (levels) match.level = { $in: levels };
+  if (ids) match.id = { $in: ids };
+  const cells = await rollupsCol.aggregate([
+    { $match: match },
+    { $unwind: '$dg_hist' },
+    { $group: { _id: { start: '$start', bin: '$dg_hist.bin' }, count: { $sum: '$dg_hist.n' } } },
+    { $project: { _id: 0, start: { $toLong: '$_id.start' }, bin: '$_id.bin', count: 1 } },
+    { $sort: { start: 1, bin: 1 } },
+  ]).toArray();
+  return { bucket, bucket_ms: BUCKET_MS[bucket], dg_edges: DG_EDGES, cells };
+}
+
+// Full rebuild on an empty rollups collection (or one from before dg_hist),
+// then the recent window every REFRESH_MS. Returns the timer.
+async function start(eventsCol, rollupsCol, onError = () => {}) {
+  await rollupsCol.createIndex({ bucket: 1, start: 1 });
+  const rebuild = (await rollupsCol.estimatedDocumentCount()) === 0
+    || !!(await rollupsCol.findOne({ dg_hist: { $exists: false } }, { projection: { _id: 1 } }));
+  let asOf = null;
+  const run = async (fromMs) => {
+    const now = new Date();
+    try {
+      await refresh(eventsCol, rollupsCol, fromMs);
+      asOf = now;
+    } catch (e) { onError(e); }
+  };
+  await run(rebuild ? 0 : Date.now() - LOOKBACK_MS);
+  const timer = setInterval(() => run(Date.now() - LOOKBACK_MS), REFRESH_MS);
+  return { timer, asOf: () => asOf };
+}
+
+module.exports = { BUCKET_MS, REFRESH_MS, DG_EDGES, floorTo, refresh, density, start };
@@ -0,0 +1,91 @@
+// ── Stored event schema ──────────────────────────────────────────
+// What an event or consensus entry looks like in Mongo, against what the
+// API and the sockets send. Stored:
+//   time      BSON Date, the only timestamp (no ISO `timestamp` string)
+//   lv        level code, an index into LEVELS; a level outside it stays
+//             as the string `level`
+//   id        the device, the registry's key; no `alias`
+//   devices   a consensus entry's members; no `aliases`
+// expand() adds timestamp, level, alias and aliases back from time, lv and
+// the registry's alias at read time, so a renamed device shows its new
+// name on every event it ever sent. Documents written before this still
+// hold the old fields until migrate() has been over them; expand() reads
+// both, and compact() of an already compact document is the same document.
+
+const LEVELS = ['minor', 'moderate', 'severe'];   // as lib/notice.js and lib/waveform.js
+
+const levelCode = (level) => LEVELS.indexOf(level);
+
+// The level name of a stored document in either form
+function levelOf(doc) {
+  return doc.lv != null ? LEVELS[doc.lv] ?? doc.level : doc.level;
+}
+
+// An event as built for the API -> the document to store
+function compact(doc) {
+  const { timestamp, alias, aliases, level, ...stored } = doc;
+  const code = levelCode(level);
+  if (code >= 0) stored.lv = code;
+  else if (level !== undefined) stored.level = level;
+  // Never lose the only time there is
+  if (!(stored.time instanceof Date) && timestamp !== undefined) stored.timestamp = timestamp;
+  return stored;
+}
+
+// A stored document -> a copy in the API's shape; aliasOf(id) from the registry
+function expand(doc, aliasOf) {
+  const { lv, ...e } = doc;
+  if (e.timestamp == null && e.time instanceof Date) e.timestamp = e.time.toISOString();
+  const level = levelOf(doc);
+  if (level !== undefined) e.level = level;
+  if (e.id != null) e.alias = aliasOf(e.id);
+  if (Array.isArray(e.devices)) e.aliases = e.devices.map(aliasOf);
+  return e;
+}
+
+// Query on level names, in stored terms. legacy: documents migrate() hasn't
+// reached yet still match on the string.
+function levelFilter(levels, legacy = false) {
+  const codes = levels.map(levelCode).filter(c => c >= 0);
+  return legacy ? { $or: [{ lv: { $in: codes } }, { level: { $in: levels } }] } : { lv: { $in: codes } };
+}
+
+// The level name as an aggregation expression, for $group keys
+const LEVEL_EXPR = { $ifNull: ['$level', { $arrayElemAt: [LEVELS, '$lv'] }] };
+
+// Documents still in the old form, and the pipeline update that converts
+// them in place: lv from level, the derived strings dropped
+const LEGACY_FILTER = {
+  time: { $type: 'date' },
+  $or: [{ level: { $in: LEVELS } }, { timestamp: { $exists: true } },
+        { alias: { $exists: true } }, { aliases: { $exists: true } }],
+};
+const COMPACT_UPDATE = [
+  { $set: { lv: { $cond: [{ $in: ['$level', LEVELS] }, { $indexOfArray: [LEVELS, '$level'] }, '$lv'] } } },
+  { $set: { level: { $cond: [{ $in: ['$level', LEVELS] }, '$$REMOVE', '$level'] } } },
+  { $unset: ['timestamp', 'alias', 'aliases'] },
+];
+
+// Online migration: BATCH documents at a time in _id order, so each pass
+// resumes on the _id index rather than rescanning what it has been over.
+// Reads and writes carry on meanwhile (expand() takes either form), and
+// `modified` is left alone: the API shape doesn't change, so there is
+// nothing for /api/events/changes to resend. Safe to run on several
+// instances at once. -> number converted
+const BATCH = 1000;
+async function migrate(eventsCol) {
+  let converted = 0;
+  let last = null;
+  for (;;) {
+    const filter = last ? { ...LEGACY_FILTER, _id: { $gt: last } } : LEGACY_FILTER;
+    const ids = (await eventsCol.find(filter, { projection: { _id: 1 } }).sort({ _id: 1 }).limit(BATCH).toArray())
+      .map(d => d._id);
+    if (!ids.length) break;
+    const r = await eventsCol.updateMany({ _id: { $in: ids } }, COMPACT_UPDATE);
+    converted += r.modifiedCount;
+    last = ids[ids.length - 1];
+  }
+  return converted;
+}
+
+module.exports = { LEVELS, LEVEL_EXPR, LEGACY_FILTER, levelOf, levelCode, compact, expand, levelFilter, migrate };
@@ -0,0 +1,399 @@
+// ── SeedLink server ──────────────────────────────────────────────
+// The live UDP streams (lib/stream.js) as SeedLink v3.1 over TCP, for the
+// standard real-time clients: slinktool, SeisComP's slarchive and
+// seedlink plugins, ObsPy's SeedLink client, Swarm.
+//
+// Each device is a station (lib/miniseed.js codes: the network given, the
+// last five MAC hex digits, location 00, HN1 / HN2 / HNZ or the band of its
+// stream rate). add() takes every decoded datagram; its samples are
+// appended per channel and cut into 512-byte Steim2 records as each fills,
+// or after FLUSH_MS if a quiet channel's record hasn't. A seq gap, clock
+// jump, rate change or new session ends the open records early, so none
+// spans a discontinuity; datagrams that arrive after a later one are
+// dropped (the StreamBuffer still has them for /api/stream).
+//
+// Records become packets ("SL", 6 hex digits of a per-station sequence
+// number, the record) in a ring of RING_PACKETS per station. A client that
+// reconnects with DATA <next seq> (what slarchive and libslink do) gets what
+// it missed as long as the ring still holds it, then the live packets;
+// TIME <begin> replays from a time. The ring is in memory only: a restart
+// starts the sequence over, and every client then replays from the oldest
+// packet it's given.
+//
+// Commands: HELLO, CAT, STATION (with ? and * wildcards), SELECT (LLCCC.T,
+// ? wildcards, ! to exclude), DATA, FETCH (dial-up: the ring, then END),
+// TIME, END, BYE and INFO ID / CAPABILITIES / STATIONS / STREAMS. DATA,
+// FETCH or TIME without a STATION first is uni-station mode: every station,
+// starting at once. A client more than MAX_QUEUE packets behind is
+// disconnected; it comes back with its sequence number.
+
+const net = require('net');
+const { encodeRecord, textRecords, channelCode, stationCode } = require('./miniseed');
+
+const RING_PACKETS = 4096;     // per station: ~10 min of a quiet 100 Hz stream
+const FLUSH_MS = 10 * 1000;    // a partial record is sent after this
+const MIN_SAMPLES = 96;        // fewer never fill a record
+const MAX_QUEUE = 8192;        // packets queued to one client
+const MAX_LINE = 256;
+const SEQ_MASK = 0xffffff;
+const SOFTWARE = 'SeedLink v3.1 (2026.287 seismo)';
+const CAPABILITIES = ['dialup', 'multistation', 'window-extraction', 'info:id', 'info:capabilities',
+                      'info:stations', 'info:streams'];
+
+const hex6 = (n) => n.toString(16).toUpperCase().padStart(6, '0');
+const glob = (pattern, s) =>
+  new RegExp(`^${pattern.replace(/[.+^${}()|[\]\\]/g, '\\$&').replace(/\?/g, '.').replace(/\*/g, '.*')}$`, 'i').test(s);
+
+// "YYYY,MM,DD,hh,mm,ss" -> ms, or NaN
+function parseTime(s) {
+  const p = String(s || '').split(',').map(Number);
+  if (p.length < 6 || p.some(v => !Number.isFinite(v))) return NaN;
+  return Date.UTC(p[0], p[1] - 1, p[2], p[3], p[4], p[5]);
+}
+
+// "YYYY/MM/DD hh:mm:ss.ssss", the INFO time format
+function infoTime(ms) {
+  const iso = new Date(ms).toISOString();
+  return `${iso.slice(0, 10).replace(/-/g, '/')} ${iso.slice(11, 23)}0`;
+}
+
+const xmlAttr = (s) => String(s).replace(/&/g, '&amp;').replace(/"/g, '&quot;').replace(/</g, '&lt;');
+
+// SELECT argument -> { neg, location, channel, type } or null
+function parseSelector(s) {
+  const m = /^(!?)((?:[A-Z0-9?-]{2})?)([A-Z0-9?]{3})(?:\.([A-Z?]))?$/i.exec(s);
+  if (!m) return null;
+  return { neg: !!m[1], location: m[2] ? m[2].replace(/-/g, ' ') : null, channel: m[3], type: m[4] || null };
+}
+
+function selected(selectors, location, channel) {
+  const hit = (s) => (s.location == null || glob(s.location, location.padEnd(2))) && glob(s.channel, channel) &&
+                     (s.type == null || glob(s.type, 'D'));
+  const pos = selectors.filter(s => !s.neg);
+  return (!pos.length || pos.some(hit)) && !selectors.some(s => s.neg && hit(s));
+}
+
+// One device's open records, per channel
+class Assembler {
+  constructor(network, station, emit) {
+    this.network = network;
+    this.station = station;
+    this.emit = emit;           // (meta, buf, n)
+    this.session = null;
+    this.seq = null;
+    this.rateHz = 0;
+    this.nextMs = 0;
+    this.channels = [];         // per axis { x: [], startMs, since }
+  }
+
+  add(pkt, now) {
+    const period = 1000 / pkt.rate_hz;
+    if (this.session === pkt.session && this.seq != null && pkt.seq <= this.seq) return false;
+    if (this.session !== pkt.session || this.rateHz !== pkt.rate_hz || pkt.seq !== this.seq + 1 ||
+        Math.abs(pkt.t0_ms - this.nextMs) > 1.5 * period) {
+      this.flush(true);
+      this.session = pkt.session;
+      this.rateHz = pkt.rate_hz;
+      this.channels = [0, 1, 2].map(() => ({ x: [], startMs: pkt.t0_ms, since: now }));
+    }
+    this.seq = pkt.seq;
+    const n = pkt.samples.length / 3;
+    this.nextMs = pkt.t0_ms + n * period;
+    this.channels.forEach((c, axis) => {
+      if (!c.x.length) {
+        c.startMs = pkt.t0_ms;
+        c.since = now;
+      }
+      for (let i = 0; i < n; i++) c.x.push(pkt.samples[i * 3 + axis]);
+    });
+    this.flush(false);
+    return true;
+  }
+
+  // Send the full records, and with partial the rest too
+  flush(partial) {
+    this.channels.forEach((c, axis) => {
+      while (c.x.length && (partial || c.x.length >= MIN_SAMPLES)) {
+        const meta = { network: this.network, station: this.station, location: '00',
+                       channel: channelCode(this.rateHz, axis), startMs: c.startMs, rateHz: this.rateHz, seq: 0 };
+        const { buf, n } = encodeRecord(Int32Array.from(c.x), 0, meta);
+        if (n === c.x.length && !partial) break;   // room left: wait for more
+        this.emit(meta, buf, n);
+        c.x.splice(0, n);
+        c.startMs += n * 1000 / this.rateHz;
+      }
+    });
+  }
+
+  // Flush channels whose oldest sample has waited FLUSH_MS
+  tick(now) {
+    if (this.channels.some(c => c.x.length && now - c.since >= FLUSH_MS)) this.flush(true);
+  }
+}
+
+// Packets of one station, oldest first
+class Ring {
+  constructor(network, station, id) {
+    this.network = network;
+    this.station = station;
+    this.id = id;
+    this.packets = [];    // { seq, location, channel, startMs, endMs, data }
+    this.next = 1;
+  }
+
+  push(meta, record, n) {
+    const seq = this.next;
+    this.next = (this.next + 1) & SEQ_MASK;
+    record.write(String(seq % 1000000).padStart(6, '0'), 0, 'latin1');
+    const data = Buffer.concat([Buffer.from(`SL${hex6(seq)}`, 'latin1'), record]);
+    const p = { seq, location: meta.location, channel: meta.channel, startMs: meta.startMs,
+                endMs: meta.startMs + n * 1000 / meta.rateHz, data };
+    this.packets.push(p);
+    if (this.packets.length > RING_PACKETS) this.packets.shift();
+    return p;
+  }
+
+  // Packets to replay to a subscription
+  backlog(sub) {
+    if (sub.seq != null && sub.seq !== this.next) {
+      const at = this.packets.findIndex(p => p.seq === sub.seq);
+      // Not held (too old, or from before a restart): everything there is
+      return (at < 0 ? this.packets : this.packets.slice(at)).filter(p => !sub.begin || p.endMs > sub.begin);
+    }
+    if (sub.begin) return this.packets.filter(p => p.endMs > sub.begin);
+    return [];
+  }
+}
+
+class SeedLinkServer {
+  constructor({ port, network = 'XX', organization = 'seismo', describe = (id) => id }) {
+    this.port = port;
+    this.network = network;
+    this.organization = organization;
+    this.describe = describe;
+    this.started = Date.now();
+    this.assemblers = new Map();   // device id -> Assembler
+    this.rings = new Map();        // station -> Ring
+    this.clients = new Set();
+    this.server = null;
+    this.timer = null;
+    this.stats = { datagrams: 0, late: 0, records: 0, connections: 0, sent: 0, slow_disconnects: 0 };
+  }
+
+  start() {
+    this.server = net.createServer(sock => this.accept(sock));
+    this.server.on('error', (err) => console.error('SeedLink server error:', err.message));
+    this.server.listen(this.port, '0.0.0.0', () => console.log(`SeedLink on tcp://0.0.0.0:${this.port}`));
+    this.timer = setInterval(() => {
+      const now = Date.now();
+      for (const a of this.assemblers.values()) a.tick(now);
+    }, 1000);
+    return this;
+  }
+
+  stop() {
+    clearInterval(this.timer);
+    for (const c of this.clients) c.sock.destroy();
+    this.server?.close();
+  }
+
+  // A decoded stream datagram
+  add(id, pkt, now = Date.now()) {
+    this.stats.datagrams++;
+    let a = this.assemblers.get(id);
+    if (!a) {
+      const station = stationCode(id);
+      const ring = this.rings.get(station) ?? new Ring(this.network, station, id);
+      this.rings.set(station, ring);
+      a = new Assembler(this.network, station, (meta, buf, n) => this.publish(ring, ring.push(meta, buf, n)));
+      this.assemblers.set(id, a);
+    }
+    if (!a.add(pkt, now)) this.stats.late++;
+  }
+
+  publish(ring, p) {
+    this.stats.records++;
+    for (const c of this.clients) {
+      if (!c.streaming || c.closing) continue;
+      let sub = c.subs.find(s => s.ring === ring);
+      if (!sub && c.uni) c.subs.push(sub = { ring, selectors: c.uni, seq: null, begin: 0, end: 0, done: false });
+      if (!sub || sub.done || !selected(sub.selectors, p.location, p.channel)) continue;
+      if (sub.end && p.startMs >= sub.end) {
+        sub.done = true;
+        if (c.subs.every(s => s.done)) this.finish(c);
+        continue;
+      }
+      this.send(c, p.data);
+    }
+  }
+
+  accept(sock) {
+    this.stats.connections++;
+    const c = { sock, buf: '', subs: [], current: null, pending: [], streaming: false, dialup: false,
+                queue: [], waiting: false, from: `${sock.remoteAddress}:${sock.remotePort}` };
+    this.clients.add(c);
+    sock.setNoDelay(true);
+    sock.setKeepAlive(true, 60 * 1000);
+    sock.on('data', (chunk) => {
+      c.buf += chunk.toString('latin1');
+      let at;
+      while ((at = c.buf.search(/[\r\n]/)) >= 0) {
+        const line = c.buf.slice(0, at).trim();
+        c.buf = c.buf.slice(at + 1);
+        if (line) this.command(c, line);
+      }
+      if (c.buf.length > MAX_LINE) sock.destroy();
+    });
+    sock.on('drain', () => this.pump(c));
+    sock.on('error', () => {});
+    sock.on('close', () => this.clients.delete(c));
+  }
+
+  reply(c, text) {
+    c.sock.write(`${text}\r\n`);
+  }
+
+  stations(pattern, network) {
+    return [...this.rings.values()].filter(r => glob(pattern, r.station) && glob(network || '*', r.network));
+  }
+
+  command(c, line) {
+    const [verb, ...args] = line.split(/\s+/);
+    const cmd = verb.toUpperCase();
+    if (cmd === 'BYE') return c.sock.end();
+    if (cmd === 'INFO') return this.info(c, (args[0] || '').toUpperCase());
+    if (c.streaming) return;   // nothing else once the data has started
+    switch (cmd) {
+      case 'HELLO':
+        return this.reply(c, `${SOFTWARE} :: SLPROTO:3.1 CAP NSWILDCARD BATCH\r\n${this.organization}`);
+      case 'CAT':
+        for (const r of this.rings.values()) this.reply(c, `${r.network} ${r.station.padEnd(5)} ${this.describe(r.id)}`);
+        return this.reply(c, 'END');
+      case 'STATION': {
+        const rings = args[0] ? this.stations(args[0], args[1]) : [];
+        if (!rings.length) return this.reply(c, 'ERROR');
+        c.current = rings.map(ring => ({ ring, selectors: [], seq: null, begin: 0, end: 0, done: false }));
+        c.pending.push(...c.current);
+        return this.reply(c, 'OK');
+      }
+      case 'SELECT': {
+        const sel = args[0] ? parseSelector(args[0]) : null;
+        if (args[0] && !sel) return this.reply(c, 'ERROR');
+        if (!c.current) c.uni = sel ? [...(c.uni ?? []), sel] : [];
+        else for (const s of c.current) s.selectors = sel ? [...s.selectors, sel] : [];
+        return this.reply(c, 'OK');
+      }
+      case 'DATA':
+      case 'FETCH':
+      case 'TIME': {
+        const seq = cmd === 'TIME' ? null : (args[0] ? parseInt(args[0], 16) : null);
+        const [begin, end] = cmd === 'TIME' ? [parseTime(args[0]), args[1] ? parseTime(args[1]) : 0]
+          : [args[1] ? parseTime(args[1]) : 0, 0];
+        if ((seq != null && !Number.isInteger(seq)) || Number.isNaN(begin) || Number.isNaN(end) ||
+            (cmd === 'TIME' && !begin)) return this.reply(c, 'ERROR');
+        if (cmd === 'FETCH') c.dialup = true;
+        if (!c.current) {
+          // Uni-station mode: every station, now and as they appear (sequence
+          // numbers are per station: only a time is taken)
+          c.uni ??= [];
+          c.subs = [...this.rings.values()].map(ring => ({ ring, selectors: c.uni, seq: null, begin, end, done: false }));
+          return this.stream(c);
+        }
+        for (const s of c.current) Object.assign(s, { seq, begin, end });
+        return this.reply(c, 'OK');
+      }
+      case 'END':
+        c.subs = c.pending;
+        return this.stream(c);
+      default:
+        return this.reply(c, 'ERROR');
+    }
+  }
+
+  stream(c) {
+    c.streaming = true;
+    for (const sub of c.subs) {
+      for (const p of sub.ring.backlog(sub)) {
+        if (sub.end && p.startMs >= sub.end) break;
+        if (selected(sub.selectors, p.location, p.channel)) this.send(c, p.data);
+      }
+    }
+    for (const s of c.subs) s.done = !!s.end && s.ring.packets.at(-1)?.startMs >= s.end;
+    if (c.dialup || (c.subs.length && c.subs.every(s => s.done))) {
+      this.finish(c);
+    }
+  }
+
+  // Dial-up done, or every time window closed
+  finish(c) {
+    c.queue.push(Buffer.from('END', 'latin1'));
+    c.closing = true;
+    this.pump(c);
+  }
+
+  send(c, data) {
+    if (c.queue.length >= MAX_QUEUE) {
+      this.stats.slow_disconnects++;
+      console.error(`SeedLink client ${c.from} too far behind, disconnected`);
+      c.queue = [];
+      return c.sock.destroy();
+    }
+    c.queue.push(data);
+    this.pump(c);
+  }
+
+  pump(c) {
+    while (c.queue.length && !c.sock.destroyed) {
+      const data = c.queue.shift();
+      this.stats.sent++;
+      if (!c.sock.write(data)) return;
+    }
+    if (c.closing && !c.queue.length) c.sock.end();
+  }
+
+  info(c, level) {
+    if (!['ID', 'CAPABILITIES', 'STATIONS', 'STREAMS'].includes(level)) return this.reply(c, 'ERROR');
+    const lines = [`<?xml version="1.0"?>`,
+                   `<seedlink software="${xmlAttr(SOFTWARE)}" organization="${xmlAttr(this.organization)}" started="${infoTime(this.started)}">`];
+    if (level === 'CAPABILITIES') for (const name of CAPABILITIES) lines.push(`<capability name="${name}"/>`);
+    if (level === 'STATIONS' || level === 'STREAMS') {
+      for (const r of this.rings.values()) {
+        const first = r.packets[0];
+        const last = r.packets.at(-1);
+        lines.push(`<station name="${r.station}" network="${r.network}" description="${xmlAttr(this.describe(r.id))}" ` +
+                   `begin_seq="${hex6(first?.seq ?? r.next)}" end_seq="${hex6(last?.seq ?? r.next)}" stream_check="enabled"` +
+                   (level === 'STREAMS' ? '>' : '/>'));
+        if (level !== 'STREAMS') continue;
+        const streams = new Map();
+        for (const p of r.packets) {
+          const key = p.location + p.channel;
+          const s = streams.get(key);
+          if (s) s.end = p.endMs;
+          else streams.set(key, { location: p.location, channel: p.channel, begin: p.startMs, end: p.endMs });
+        }
+        for (const s of streams.values()) {
+          lines.push(`<stream location="${s.location}" seedname="${s.channel}" type="D" begin_time="${infoTime(s.begin)}" ` +
+                     `end_time="${infoTime(s.end)}" begin_recno="0" end_recno="0" gap_check="disabled" gap_treshold="0"/>`);
+        }
+        lines.push('</station>');
+      }
+    }
+    lines.push('</seedlink>');
+    const records = textRecords(lines.join('\n'), { network: 'SL', station: 'INFO', location: '', channel: 'INF',
+                                                    startMs: Date.now() });
+    records.forEach((rec, i) => {
+      const last = i === records.length - 1;
+      c.sock.write(Buffer.concat([Buffer.from(last ? 'SLINFO  ' : 'SLINFO *', 'latin1'), rec]));
+    });
+  }
+
+  metrics() {
+    let packets = 0;
+    for (const r of this.rings.values()) packets += r.packets.length;
+    return { port: this.port, clients: this.clients.size,
+             streaming: [...this.clients].filter(c => c.streaming).length,
+             stations: this.rings.size, packets, ...this.stats };
+  }
+}
+
+module.exports = { SeedLinkServer, parseSelector, selected, RING_PACKETS };
@@ -0,0 +1,132 @@
+// ── Binary serial capture ────────────────────────────────────────
+// A SERIAL_CAPTURE build writes every sample to its serial port in blocks
+// (layout documented in src/serial_capture.h), each COBS-encoded between
+// 0x00 delimiters, with the firmware's log lines between them:
+//   "SC", version u8, n u8, seq u32, MAC[6], rate u16, session u16,
+//   epoch_us i64 (0 before SNTP sync), millis u32, n × int16 x,y,z LE, crc32
+// SerialReader splits the byte stream at the delimiters. What decodes to a
+// block with a good CRC is one; anything else is log text.
+
+const zlib = require('zlib');
+
+const MAGIC = 'SC';
+const VERSION = 1;
+const HEADER_SIZE = 30;
+const MAX_FRAME = 1024;          // longer without a delimiter is text, or noise
+
+// CRC-32 (IEEE), as the firmware's
+const CRC_TABLE = new Int32Array(256).map((_, n) => {
+  let c = n;
+  for (let k = 0; k < 8; k++) c = (c >>> 1) ^ (0xEDB88320 & -(c & 1));
+  return c;
+});
+const crc32 = zlib.crc32 || ((buf) => {
+  let c = -1;
+  for (const b of buf) c = (c >>> 8) ^ CRC_TABLE[(c ^ b) & 0xFF];
+  return (c ^ -1) >>> 0;
+});
+
+// -> Buffer, or null if it isn't valid COBS
+function cobsDecode(buf) {
+  const out = Buffer.alloc(buf.length);
+  let o = 0;
+  for (let i = 0; i < buf.length;) {
+    const code = buf[i++];
+    if (!code || i + code - 1 > buf.length) return null;
+    for (let k = 1; k < code; k++) out[o++] = buf[i++];
+    if (code < 0xFF && i < buf.length) out[o++] = 0;
+  }
+  return out.subarray(0, o);
+}
+
+// A decoded frame -> { seq, session, id, rate_hz, epoch_us, millis, samples: Int16Array(3n) } or null
+function decodeBlock(buf) {
+  if (!buf || buf.length < HEADER_SIZE + 4 || buf.toString('latin1', 0, 2) !== MAGIC || buf[2] !== VERSION) return null;
+  const n = buf[3];
+  const size = HEADER_SIZE + n * 6;
+  if (!n || buf.length !== size + 4 || crc32(buf.subarray(0, size)) !== buf.readUInt32LE(size)) return null;
+  const rate = buf.readUInt16LE(14);
+  if (!rate) return null;
+  const samples = new Int16Array(n * 3);
+  for (let k = 0; k < n * 3; k++) samples[k] = buf.readInt16LE(HEADER_SIZE + k * 2);
+  return { seq: buf.readUInt32LE(4), session: buf.readUInt16LE(16),
+           id: Array.from(buf.subarray(8, 14), b => b.toString(16).toUpperCase().padStart(2, '0')).join(':'),
+           rate_hz: rate, epoch_us: buf.readBigInt64LE(18), millis: buf.readUInt32LE(26), samples };
+}
+
+class SerialReader {
+  // onBlock(pkt) gets each block as a stream datagram would decode
+  // (lib/stream.js: seq, session, id, rate_hz, t0_ms, synced, millis,
+  // samples); onText(line) each log line
+  constructor({ onBlock = () => {}, onText = () => {} } = {}) {
+    this.onBlock = onBlock;
+    this.onText = onText;
+    this.frame = [];
+    this.frameBytes = 0;
+    this.anchor = null;          // { session, hostMs, millis }: places blocks before SNTP sync
+    this.last = null;            // { session, seq }
+    this.stats = { blocks: 0, samples: 0, lost: 0, restarts: 0, bad: 0, lines: 0 };
+  }
+
+  feed(chunk, now = Date.now()) {
+    let from = 0;
+    for (let i = chunk.indexOf(0); i >= 0; i = chunk.indexOf(0, from)) {
+      this.take(chunk.subarray(from, i));
+      this.end(now);
+      from = i + 1;
+    }
+    this.take(chunk.subarray(from));
+    if (this.frameBytes > MAX_FRAME) this.end(now);
+  }
+
+  take(part) {
+    if (!part.length) return;
+    this.frame.push(part);
+    this.frameBytes += part.length;
+  }
+
+  // A delimiter: what came since the last one is a block or text
+  end(now) {
+    if (!this.frameBytes) return;
+    const buf = Buffer.concat(this.frame, this.frameBytes);
+    this.frame = [];
+    this.frameBytes = 0;
+    const block = decodeBlock(buf.length <= MAX_FRAME ? cobsDecode(buf) : null);
+    if (block) return this.block(block, now);
+    // Log lines are printable; a block that failed its CRC (a byte lost on
+    // the line) all but certainly has a control character in it
+    if (/[\x01-\x08\x0b\x0c\x0e-\x1f\x7f]/.test(buf.toString('latin1'))) {
+      this.stats.bad++;
+      return;
+    }
+    for (const line of buf.toString('utf8').split(/\r?\n/)) {
+      if (!line) continue;
+      this.stats.lines++;
+      this.onText(line);
+    }
+  }
+
+  block(b, now) {
+    const period = 1000 / b.rate_hz;
+    const n = b.samples.length / 3;
+    if (this.last && this.last.session === b.session) {
+      if (b.seq > this.last.seq + 1) this.stats.lost += b.seq - this.last.seq - 1;
+    } else if (this.last) {
+      this.stats.restarts++;
+    }
+    this.last = { session: b.session, seq: b.seq };
+    // Before sync, on the device's millis() from where the session was first
+    // heard, so the blocks stay contiguous whatever the host's read timing
+    if (!this.anchor || this.anchor.session !== b.session) {
+      this.anchor = { session: b.session, hostMs: now - (n - 1) * period, millis: b.millis };
+    }
+    const synced = b.epoch_us > 0n;
+    const t0 = synced ? Number(b.epoch_us / 1000n) : this.anchor.hostMs + ((b.millis - this.anchor.millis) >>> 0);
+    this.stats.blocks++;
+    this.stats.samples += n;
+    this.onBlock({ seq: b.seq, session: b.session, id: b.id, rate_hz: b.rate_hz, t0_ms: t0, synced,
+                   millis: b.millis, samples: b.samples });
+  }
+}
+
+module.exports = { SerialReader, decodeBlock, cobsDecode, crc32 };
@@ -0,0 +1,271 @@
+// ── Device sessions ──────────────────────────────────────────────
+// Firmware built with -DSESSION_LINK=1 (src/session_link.h) keeps one TCP
+// connection to SESSION_PORT and sends everything over it as frames, in
+// place of the heartbeat GET, the upload POST, the trigger datagram and the
+// push long-poll. Each frame, little-endian:
+//   0  uint8   type
+//   1  uint8   flags: 1 MORE (another frame of this message follows, same
+//              seq), 2 ACK (the sender wants an ACK for seq)
+//   2  uint16  seq, per sender, wrapping
+//   4  uint32  payload length (at most MAX_FRAME)
+//   8  payload
+// Types:
+//   HELLO      device -> server, first: "SSP1", version u8, caps u32, then
+//              the MAC and the firmware version, NUL-terminated
+//   WELCOME    server -> device: version u8, caps u32 (the device's caps
+//              the server also takes), server time epoch ms int64
+//   HEARTBEAT  the heartbeat query string (its telemetry), ACKed with the
+//              status the GET would have got: 200, or 202/203/205/207
+//   TRIGGER    the trigger notice datagram (lib/notice.js), not ACKed
+//   EVENT      upload headers, a blank line, then the body, as MQTT_LINK
+//              publishes it; split over MORE frames, ACKed with the POST's
+//              status and its Retry-After
+//   CONFIG     server -> device: the /api/init body, when it changes
+//   COMMAND    server -> device: "205", "203", "207" or "policy <value>",
+//              as the push poll or X-Upload-Policy would have said
+//   ACK        seq is what it answers: status uint16, retry_after_s uint16
+//   PING       either way, ACKed; the device sends one every KEEPALIVE_S / 2
+// Caps: what each side will put on the link (CAPS); the device uses HTTP
+// and UDP for the rest, and for everything while the session is down.
+//
+// handlers: heartbeat(session, query) -> status, event(session, payload) ->
+// { status, retryAfter }, trigger(session, payload), open(session),
+// close(session). A newer session for a device replaces the old one.
+
+const net = require('net');
+
+const MAGIC = 'SSP1';
+const VERSION = 1;
+const HEADER = 8;
+const MAX_FRAME = 64 * 1024;
+const MAX_MESSAGE = 512 * 1024;     // an EVENT's frames together
+const HELLO_MS = 10 * 1000;
+const KEEPALIVE_S = 60;
+const TYPES = { HELLO: 1, WELCOME: 2, HEARTBEAT: 3, TRIGGER: 4, EVENT: 5, CONFIG: 6, COMMAND: 7, ACK: 8, PING: 9 };
+const NAMES = Object.fromEntries(Object.entries(TYPES).map(([k, v]) => [v, k.toLowerCase()]));
+const MORE = 1;
+const ACK = 2;
+const CAPS = { heartbeat: 1, trigger: 2, event: 4, config: 8, command: 16 };
+const ALL_CAPS = Object.values(CAPS).reduce((a, b) => a | b, 0);
+
+function frame(type, seq, payload = Buffer.alloc(0), flags = 0) {
+  const h = Buffer.alloc(HEADER);
+  h.writeUInt8(type, 0);
+  h.writeUInt8(flags, 1);
+  h.writeUInt16LE(seq & 0xffff, 2);
+  h.writeUInt32LE(payload.length, 4);
+  return Buffer.concat([h, payload]);
+}
+
+function ackPayload(status, retryAfterS = 0) {
+  const b = Buffer.alloc(4);
+  b.writeUInt16LE(status, 0);
+  b.writeUInt16LE(Math.min(0xffff, retryAfterS), 2);
+  return b;
+}
+
+// HELLO payload -> { version, caps, id, firmware } or null
+function parseHello(p) {
+  if (p.length < 9 || p.toString('latin1', 0, 4) !== MAGIC) return null;
+  const [id, firmware = ''] = p.toString('latin1', 9).split('\0');
+  if (!/^[0-9A-F]{2}(:[0-9A-F]{2}){5}$/.test(id)) return null;
+  return { version: p[4], caps: p.readUInt32LE(5), id, firmware };
+}
+
+// "session=connected,connects,sent,acked,failed,dropped" off the heartbeat, or null
+function parseSessionQuery(query) {
+  if (typeof query.session !== 'string') return null;
+  const v = query.session.split(',').map(x => parseInt(x, 10));
+  if (v.length !== 6 || !v.every(Number.isFinite)) return null;
+  const [connected, connects, sent, acked, failed, dropped] = v;
+  return { connected: connected === 1, connects, sent, acked, failed, dropped };
+}
+
+class Session {
+  constructor(server, sock) {
+    this.server = server;
+    this.sock = sock;
+    this.id = null;
+    this.caps = 0;
+    this.firmware = null;
+    this.since = new Date();
+    this.seq = 0;
+    this.buf = Buffer.alloc(0);
+    this.partial = new Map();    // seq -> [Buffer] of an EVENT's frames so far
+    this.heard = Date.now();
+    this.stats = { frames_in: 0, frames_out: 0, bytes_in: 0, bytes_out: 0 };
+  }
+
+  write(type, payload, flags = 0) {
+    if (this.sock.destroyed) return false;
+    const seq = this.seq = (this.seq + 1) & 0xffff;
+    const data = frame(type, seq, payload, flags);
+    this.stats.frames_out++;
+    this.stats.bytes_out += data.length;
+    this.sock.write(data);
+    return true;
+  }
+
+  ack(seq, status, retryAfterS) {
+    if (this.sock.destroyed) return;
+    const data = frame(TYPES.ACK, seq, ackPayload(status, retryAfterS));
+    this.stats.frames_out++;
+    this.stats.bytes_out += data.length;
+    this.sock.write(data);
+  }
+
+  data(chunk) {
+    this.buf = this.buf.length ? Buffer.concat([this.buf, chunk]) : chunk;
+    this.stats.bytes_in += chunk.length;
+    this.heard = Date.now();
+    while (this.buf.length >= HEADER) {
+      const length = this.buf.readUInt32LE(4);
+      if (length > MAX_FRAME) return this.close(`${length}-byte frame`);
+      if (this.buf.length < HEADER + length) return;
+      const type = this.buf[0], flags = this.buf[1], seq = this.buf.readUInt16LE(2);
+      const payload = this.buf.subarray(HEADER, HEADER + length);
+      this.buf = this.buf.subarray(HEADER + length);
+      this.stats.frames_in++;
+      this.frame(type, flags, seq, payload);
+      if (this.sock.destroyed) return;
+    }
+  }
+
+  frame(type, flags, seq, payload) {
+    const server = this.server;
+    if (!this.id) {
+      const hello = type === TYPES.HELLO ? parseHello(payload) : null;
+      if (!hello) return this.close('no HELLO');
+      return server.open(this, hello, seq);
+    }
+    server.stats.received[NAMES[type] ?? 'unknown'] = (server.stats.received[NAMES[type] ?? 'unknown'] || 0) + 1;
+    const receivedAt = Date.now();
+    const reply = (p) => p.then(r => (flags & ACK) && this.ack(seq, r?.status ?? 200, r?.retryAfter ?? 0))
+      .catch((e) => {
+        console.error(`[SESSION] ${this.id} ${NAMES[type]}: ${e.message}`);
+        if (flags & ACK) this.ack(seq, 500, 5);
+      });
+    switch (type) {
+      case TYPES.PING:
+      case TYPES.ACK:
+        if (type === TYPES.PING) this.ack(seq, 200);
+        return;
+      case TYPES.HEARTBEAT:
+        return reply(Promise.resolve(server.handlers.heartbeat(this, payload.toString('latin1'), receivedAt))
+          .then(status => ({ status })));
+      case TYPES.TRIGGER:
+        server.handlers.trigger(this, Buffer.from(payload), receivedAt);
+        return flags & ACK ? this.ack(seq, 200) : undefined;
+      case TYPES.EVENT: {
+        const parts = this.partial.get(seq) ?? [];
+        parts.push(Buffer.from(payload));
+        const size = parts.reduce((n, b) => n + b.length, 0);
+        if (size > MAX_MESSAGE) {
+          this.partial.delete(seq);
+          return (flags & ACK) && this.ack(seq, 413);
+        }
+        if (flags & MORE) return this.partial.set(seq, parts);
+        this.partial.delete(seq);
+        return reply(Promise.resolve(server.handlers.event(this, Buffer.concat(parts), receivedAt)));
+      }
+      default:
+        return (flags & ACK) && this.ack(seq, 400);
+    }
+  }
+
+  close(why) {
+    if (why) console.error(`[SESSION] ${this.id || this.sock.remoteAddress} dropped: ${why}`);
+    this.sock.destroy();
+  }
+}
+
+class SessionServer {
+  constructor({ port, handlers }) {
+    this.port = port;
+    this.handlers = { heartbeat: () => 200, event: () => ({ status: 201 }), trigger: () => {},
+                      open: () => {}, close: () => {}, ...handlers };
+    this.sessions = new Map();   // device id -> Session
+    this.server = null;
+    this.timer = null;
+    this.stats = { connections: 0, sessions: 0, refused: 0, replaced: 0, received: {}, sent: {} };
+  }
+
+  start() {
+    this.server = net.createServer(sock => this.accept(sock));
+    this.server.on('error', (err) => console.error('Session server error:', err.message));
+    this.server.listen(this.port, '0.0.0.0', () => console.log(`Device sessions on tcp://0.0.0.0:${this.port}`));
+    this.timer = setInterval(() => {
+      const now = Date.now();
+      for (const s of this.sessions.values()) if (now - s.heard > KEEPALIVE_S * 1500) s.close('silent past the keepalive');
+    }, 10 * 1000);
+    return this;
+  }
+
+  stop() {
+    clearInterval(this.timer);
+    for (const s of this.sessions.values()) s.sock.destroy();
+    this.server?.close();
+  }
+
+  accept(sock) {
+    this.stats.connections++;
+    const s = new Session(this, sock);
+    sock.setNoDelay(true);
+    sock.setKeepAlive(true, 60 * 1000);
+    const hello = setTimeout(() => { if (!s.id) s.close('no HELLO in time'); }, HELLO_MS);
+    sock.on('data', chunk => s.data(chunk));
+    sock.on('error', () => {});
+    sock.on('close', () => {
+      clearTimeout(hello);
+      if (s.id && this.sessions.get(s.id) === s) {
+        this.sessions.delete(s.id);
+        this.handlers.close(s);
+      }
+    });
+  }
+
+  open(s, hello, seq) {
+    if (hello.version !== VERSION) {
+      this.stats.refused++;
+      s.ack(seq, 426);
+      return s.close(`protocol version ${hello.version}`);
+    }
+    const old = this.sessions.get(hello.id);
+    if (old) {
+      this.stats.replaced++;
+      this.sessions.delete(hello.id);
+      old.close();
+    }
+    Object.assign(s, { id: hello.id, caps: hello.caps & ALL_CAPS, firmware: hello.firmware });
+    this.sessions.set(s.id, s);
+    this.stats.sessions++;
+    const welcome = Buffer.alloc(13);
+    welcome.writeUInt8(VERSION, 0);
+    welcome.writeUInt32LE(s.caps, 1);
+    welcome.writeBigInt64LE(BigInt(Date.now()), 5);
+    s.write(TYPES.WELCOME, welcome);
+    this.handlers.open(s);
+  }
+
+  live(id) {
+    return this.sessions.has(id);
+  }
+
+  // CONFIG (object, sent as JSON) or COMMAND (text) to a device; false if it has no session taking it
+  send(id, type, body) {
+    const s = this.sessions.get(id);
+    const cap = type === TYPES.CONFIG ? CAPS.config : CAPS.command;
+    if (!s || !(s.caps & cap)) return false;
+    this.stats.sent[NAMES[type]] = (this.stats.sent[NAMES[type]] || 0) + 1;
+    return s.write(type, Buffer.from(typeof body === 'string' ? body : JSON.stringify(body)), ACK);
+  }
+
+  metrics() {
+    return {
+      port: this.port, open: this.sessions.size, ...this.stats,
+      devices: [...this.sessions.values()].map(s => ({ id: s.id, caps: s.caps, firmware: s.firmware, since: s.since, ...s.stats })),
+    };
+  }
+}
+
+module.exports = { SessionServer, TYPES, CAPS, frame, parseHello, parseSessionQuery, MAGIC, VERSION };
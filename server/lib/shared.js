@@ -0,0 +1,168 @@
+// ── Shared state for several server instances ────────────────────
+// With SHARED_STATE=1 any number of server.js replicas can sit behind one
+// load balancer. MongoDB, which they already share, is the store; there is
+// no other service to run. Everything here is a poll loop or an atomic
+// single-document update:
+//   device_state        one doc per device: last_seen ($max) plus the
+//                       telemetry of the instance that heard from it last.
+//                       touch() marks a device dirty; flush() writes them
+//                       every FLUSH_MS in one bulkWrite
+//   consensus_triggers  every live trigger, from every instance (TTL). Only
+//                       the lease holder runs the ConsensusEngine on them
+//   leases              { _id: 'consensus', owner, expires }: taken when
+//                       expired, renewed every LEASE_RENEW_MS
+//   pull_requests       pending retroactive pulls, one per device; handed
+//                       out with findOneAndUpdate so exactly one instance
+//                       gives a device its pull
+// refresh() runs every REFRESH_MS and hands server.js what other instances
+// changed (devices, config, reinit flags, pulls, newest event write, plus
+// whatever onRefresh re-reads)
+// through the hooks; the leader additionally reads new triggers every
+// TRIGGER_POLL_MS.
+
+const FLUSH_MS = 1000;
+const REFRESH_MS = 2000;
+const TRIGGER_POLL_MS = 250;
+const LEASE_MS = 6000;
+const LEASE_RENEW_MS = 2000;
+const TRIGGER_TTL_S = 600;
+const TRIGGER_SEEN_MS = 30000;   // re-read overlap: inserts from other instances can land late
+
+class SharedState {
+  constructor(db, instance, hooks) {
+    this.instance = instance;
+    this.hooks = hooks;
+    this.devices = db.collection('device_state');
+    this.triggers = db.collection('consensus_triggers');
+    this.leases = db.collection('leases');
+    this.pulls = db.collection('pull_requests');
+    this.configCol = db.collection('config');
+    this.reinitCol = db.collection('reinit_flags');
+    this.eventsCol = db.collection('events');
+    this.dirty = new Set();
+    this.leader = false;
+    this.seenTriggers = new Map();  // _id hex → its `at` (ms), while inside the re-read window
+    this.triggersFrom = new Date();
+    this.lastEventWrite = null;
+    this.timers = [];
+  }
+
+  async start() {
+    await this.triggers.createIndex({ at: 1 }, { expireAfterSeconds: TRIGGER_TTL_S });
+    const every = (ms, fn) => this.timers.push(setInterval(() => fn().catch(e => this.hooks.onError?.(e)), ms));
+    await this.renewLease();
+    every(FLUSH_MS, () => this.flush());
+    every(REFRESH_MS, () => this.refresh());
+    every(LEASE_RENEW_MS, () => this.renewLease());
+    every(TRIGGER_POLL_MS, () => this.readTriggers());
+  }
+
+  // ── Device state ───────────────────────────────────────────────
+  touch(id) {
+    this.dirty.add(id);
+  }
+
+  async flush() {
+    if (!this.dirty.size) return;
+    const ids = [...this.dirty];
+    this.dirty.clear();
+    const ops = ids.map(id => {
+      const { last_seen, ...fields } = this.hooks.snapshot(id);
+      return { updateOne: {
+        filter: { _id: id },
+        update: { $max: { last_seen }, $set: { ...fields, instance: this.instance, updated: new Date() } },
+        upsert: true,
+      } };
+    });
+    await this.devices.bulkWrite(ops, { ordered: false });
+  }
+
+  async refresh() {
+    const [devices, config, flags, pulls, newest] = await Promise.all([
+      this.devices.find({}).toArray(),
+      this.configCol.findOne({ _id: 'global' }),
+      this.reinitCol.find({ status: { $in: ['pending', 'sent'] } }).sort({ requested_at: 1 }).toArray(),
+      this.pulls.find({}).toArray(),
+      this.eventsCol.find({ modified: { $exists: true } }, { projection: { modified: 1 } })
+        .sort({ modified: -1 }).limit(1).toArray(),
+    ]);
+    for (const doc of devices) if (doc.instance !== this.instance) this.hooks.onDevice(doc);
+    if (config) this.hooks.onConfig(config);
+    this.hooks.onReinitFlags(flags);
+    this.hooks.onPulls(pulls);
+    await this.hooks.onRefresh?.();
+    const t = newest[0]?.modified?.getTime() ?? null;
+    if (t !== this.lastEventWrite) {
+      this.lastEventWrite = t;
+      this.hooks.onEventsChanged();
+    }
+  }
+
+  // ── Consensus ──────────────────────────────────────────────────
+  async renewLease() {
+    const now = new Date();
+    let owner = null;
+    try {
+      const doc = await this.leases.findOneAndUpdate(
+        { _id: 'consensus', $or: [{ owner: this.instance }, { expires: { $lt: now } }] },
+        { $set: { owner: this.instance, expires: new Date(now.getTime() + LEASE_MS) } },
+        { upsert: true, returnDocument: 'after' },
+      );
+      owner = doc?.owner ?? null;
+    } catch (e) {
+      if (e.code !== 11000) throw e;   // someone else holds an unexpired lease
+    }
+    const leader = owner === this.instance;
+    if (leader && !this.leader) {
+      this.leader = true;
+      this.seenTriggers.clear();
+      const horizon = new Date(Date.now() - this.hooks.horizonMs());
+      const recent = await this.triggers.find({ at: { $gte: horizon } }).sort({ time_ms: 1 }).toArray();
+      recent.forEach(t => this.seenTriggers.set(t._id.toHexString(), t.at.getTime()));
+      this.triggersFrom = now;
+      await this.hooks.onLeader(recent);
+    } else if (!leader && this.leader) {
+      this.leader = false;
+      this.hooks.onFollower?.();
+    }
+  }
+
+  // Every instance logs its live triggers; the leader picks them up
+  async trigger(id, timeMs) {
+    await this.triggers.insertOne({ id, time_ms: timeMs, at: new Date(), instance: this.instance });
+  }
+
+  async readTriggers() {
+    if (!this.leader) return;
+    const from = this.triggersFrom.getTime() - TRIGGER_SEEN_MS;
+    const docs = await this.triggers.find({ at: { $gte: new Date(from) } }).sort({ at: 1 }).toArray();
+    for (const [hex, at] of this.seenTriggers) if (at < from) this.seenTriggers.delete(hex);
+    for (const t of docs) {
+      const hex = t._id.toHexString();
+      if (this.seenTriggers.has(hex)) continue;
+      this.seenTriggers.set(hex, t.at.getTime());
+      this.hooks.onTrigger(t.id, t.time_ms);
+    }
+    if (docs.length) this.triggersFrom = docs[docs.length - 1].at;
+  }
+
+  // ── Pulls ──────────────────────────────────────────────────────
+  async putPull(id, pull) {
+    await this.pulls.replaceOne({ _id: id }, { _id: id, pull, sent: false, at: new Date() }, { upsert: true });
+  }
+
+  // The pending pull for id, claimed by this instance; null if none (or taken)
+  async takePull(id) {
+    const doc = await this.pulls.findOneAndUpdate({ _id: id, sent: false }, { $set: { sent: true } },
+      { returnDocument: 'after' });
+    return doc?.pull ?? null;
+  }
+
+  // The pull a device's upload answers; removes it
+  async finishPull(id) {
+    const doc = await this.pulls.findOneAndDelete({ _id: id, sent: true });
+    return doc?.pull ?? null;
+  }
+}
+
+module.exports = { SharedState, REFRESH_MS };
@@ -0,0 +1,97 @@
+// ── Quantile sketch ──────────────────────────────────────────────
+// Log-bucketed (DDSketch): a value v > MIN_VALUE lands in bucket
+// ceil(log_γ v), with γ = (1 + ALPHA) / (1 - ALPHA), so any quantile read
+// back is within ALPHA of the true value however many went in. Values at or
+// below MIN_VALUE are counted as zeros. Two sketches merge by adding bucket
+// counts, which is also how a stored one is updated ($inc per bucket,
+// toInc()), so sketches from different hours, devices or replicas combine
+// exactly. Size is bounded by the range of values, not their number:
+// ~115 buckets per decade at 1%.
+//
+// Values are non-negative (magnitudes, durations).
+
+const ALPHA = 0.01;
+const GAMMA = (1 + ALPHA) / (1 - ALPHA);
+const LOG_GAMMA = Math.log(GAMMA);
+const MIN_VALUE = 1e-6;
+
+const bucketValue = (k) => 2 * GAMMA ** k / (GAMMA + 1);
+
+class QuantileSketch {
+  constructor() {
+    this.bins = new Map();   // bucket → count
+    this.zeros = 0;
+    this.count = 0;
+    this.sum = 0;
+    this.min = Infinity;
+    this.max = -Infinity;
+  }
+
+  add(v, n = 1) {
+    if (!Number.isFinite(v) || n <= 0) return;
+    this.count += n;
+    this.sum += v * n;
+    if (v < this.min) this.min = v;
+    if (v > this.max) this.max = v;
+    if (!(v > MIN_VALUE)) {
+      this.zeros += n;
+      return;
+    }
+    const k = Math.ceil(Math.log(v) / LOG_GAMMA);
+    this.bins.set(k, (this.bins.get(k) || 0) + n);
+  }
+
+  merge(other) {
+    this.count += other.count;
+    this.zeros += other.zeros;
+    this.sum += other.sum;
+    this.min = Math.min(this.min, other.min);
+    this.max = Math.max(this.max, other.max);
+    for (const [k, n] of other.bins) this.bins.set(k, (this.bins.get(k) || 0) + n);
+    return this;
+  }
+
+  quantile(q) {
+    if (!this.count) return null;
+    let rank = q * (this.count - 1);
+    if (rank < this.zeros) return 0;
+    rank -= this.zeros;
+    const keys = [...this.bins.keys()].sort((a, b) => a - b);
+    for (const k of keys) {
+      rank -= this.bins.get(k);
+      if (rank < 0) return Math.min(bucketValue(k), this.max);
+    }
+    return this.max;
+  }
+
+  // The update that adds this sketch to a stored one:
+  //   { $inc: { n, z, sum, 'b.<k>': count, ... }, $min: { min }, $max: { max } }
+  toInc() {
+    const inc = { n: this.count, z: this.zeros, sum: this.sum };
+    for (const [k, n] of this.bins) inc[`b.${k}`] = n;
+    return { $inc: inc, $min: { min: this.min }, $max: { max: this.max } };
+  }
+
+  // A stored one ({ n, z, sum, min, max, b: { k: count } }) back
+  static fromDoc(doc) {
+    const s = new QuantileSketch();
+    s.count = doc.n || 0;
+    s.zeros = doc.z || 0;
+    s.sum = doc.sum || 0;
+    s.min = doc.min ?? Infinity;
+    s.max = doc.max ?? -Infinity;
+    for (const [k, n] of Object.entries(doc.b || {})) s.bins.set(Number(k), n);
+    return s;
+  }
+
+  // -> { count, min, max, mean, p50, ... } for qs
+  summary(qs = [0.5, 0.95, 0.99]) {
+    const r6 = (v) => (v == null ? null : Math.round(v * 1e6) / 1e6);
+    const out = { count: this.count, min: this.count ? r6(this.min) : null, max: this.count ? r6(this.max) : null,
+                  mean: this.count ? r6(this.sum / this.count) : null };
+    for (const q of qs) out[`p${+(q * 100).toFixed(2)}`] = r6(this.quantile(q));
+    return out;
+  }
+}
+
+module.exports = { QuantileSketch, ALPHA };
@@ -0,0 +1,285 @@
+// ── Soak tests ───────────────────────────────────────────────────
+// A leak or a fragmenting heap in the String-heavy paths (heartbeat URL,
+// upload bodies, reconnects) takes days to show. A soak run keeps a
+// WAVEFORM_INJECT build busy for that long: the same stored capture is
+// injected every interval_s (lib/waveform.injectionBody, the /api/inject
+// path), so the node triggers, captures and uploads on a schedule, and each
+// heartbeat of the node becomes a point of the run's trend:
+//   soak_runs { _id, id, firmware, event_id, interval_s, started, ends, ended, status,
+//               points: [{ t, heap_free, heap_min, heap_block, heap_frag,
+//                          jitter_p50_ms, jitter_p99_ms, loop_p95_us, loop_max_us }],
+//               injections: [{ t, run_id, trigger_ms, upload_ms }] }
+// status is running until `ends`, a stop, or the node coming back on other
+// firmware: then a new run of the rest starts on that, so a run is always
+// one firmware version. An injection is recorded once the next is due
+// (its upload can land after the heartbeat that reports it); one with no
+// report within MISSED_INTERVALS is recorded as missed.
+//
+// summarize() reduces a run to what a regression moves: the heap's trend
+// in bytes per hour (least squares past SETTLE_MS, lower is a leak), its
+// lowest largest block, the sample jitter and loop tails, and the
+// detection and upload latency of the injections. byFirmware() puts the
+// versions side by side, each against the one soaked before it.
+
+const { ObjectId } = require('mongodb');
+
+const HOUR_MS = 3600 * 1000;
+const MAX_POINTS = 20000;        // two weeks of 60s heartbeats
+const MAX_INJECTIONS = 20000;
+const SETTLE_MS = 15 * 60 * 1000; // boot and the first captures settle the heap
+const MISSED_INTERVALS = 3;
+const MIN_INTERVAL_S = 30;
+const LEAK_BPH = 32;             // a heap trend below -LEAK_BPH is a leak
+const SLOWER = 1.25;             // latency p95 this much over the previous version's
+const TREND_POINTS = 240;        // per run in list(), for the Admin chart
+
+const round1 = (v) => (v == null ? null : Math.round(v * 10) / 10);
+
+// Value at quantile q of ascending v
+const at = (v, q) => (v.length ? v[Math.min(v.length - 1, Math.ceil(q * v.length) - 1)] : null);
+
+// Least-squares slope of ys over xs, null under 3 points or no spread
+function slope(xs, ys) {
+  const n = xs.length;
+  if (n < 3) return null;
+  const mx = xs.reduce((a, b) => a + b, 0) / n;
+  const my = ys.reduce((a, b) => a + b, 0) / n;
+  let sxx = 0, sxy = 0;
+  for (let i = 0; i < n; i++) {
+    sxx += (xs[i] - mx) ** 2;
+    sxy += (xs[i] - mx) * (ys[i] - my);
+  }
+  return sxx > 0 ? sxy / sxx : null;
+}
+
+// A heartbeat's parseHeapQuery() and decodeProfile() results -> a point, or null
+function soakPoint(t, heap, profile) {
+  if (!heap && !profile) return null;
+  const loop = profile?.phases?.loop;
+  return {
+    t,
+    heap_free: heap?.free ?? null, heap_min: heap?.min_free ?? heap?.free ?? null,
+    heap_block: heap?.max_block ?? null, heap_frag: heap?.max_frag_pct ?? heap?.frag_pct ?? null,
+    jitter_p50_ms: profile?.intervals?.p50_ms ?? null, jitter_p99_ms: profile?.intervals?.p99_ms ?? null,
+    loop_p95_us: loop?.p95_us ?? null, loop_max_us: loop?.max_us ?? null,
+  };
+}
+
+function quantiles(v) {
+  const s = v.filter(Number.isFinite).sort((a, b) => a - b);
+  return s.length ? { n: s.length, p50: at(s, 0.5), p95: at(s, 0.95), max: s[s.length - 1] } : null;
+}
+
+// A run -> its trend and tails
+function summarize(run) {
+  const start = new Date(run.started).getTime();
+  const points = run.points || [];
+  const last = points.length ? new Date(points[points.length - 1].t).getTime() : start;
+  const settled = points.filter(p => new Date(p.t).getTime() - start >= SETTLE_MS);
+  const trend = (key) => {
+    const ps = settled.filter(p => Number.isFinite(p[key]));
+    const s = slope(ps.map(p => (new Date(p.t).getTime() - start) / HOUR_MS), ps.map(p => p[key]));
+    return s == null ? null : Math.round(s);
+  };
+  const values = (key) => points.map(p => p[key]).filter(Number.isFinite);
+  const lowest = (key) => (values(key).length ? Math.min(...values(key)) : null);
+  const highest = (key) => (values(key).length ? Math.max(...values(key)) : null);
+  const injections = run.injections || [];
+  return {
+    hours: round1((last - start) / HOUR_MS),
+    heartbeats: points.length,
+    heap_min: lowest('heap_min'),
+    heap_slope_bph: trend('heap_min'),
+    block_min: lowest('heap_block'),
+    block_slope_bph: trend('heap_block'),
+    frag_max: highest('heap_frag'),
+    jitter_p99_ms: highest('jitter_p99_ms'),
+    loop_p95_us: quantiles(values('loop_p95_us'))?.p95 ?? null,
+    loop_max_us: highest('loop_max_us'),
+    injections: injections.length,
+    triggered: injections.filter(i => i.trigger_ms != null).length,
+    trigger_ms: quantiles(injections.map(i => i.trigger_ms)),
+    upload_ms: quantiles(injections.map(i => i.upload_ms)),
+  };
+}
+
+// A run's points, every k-th to at most TREND_POINTS, at hours since its start
+function trend(run) {
+  const start = new Date(run.started).getTime();
+  const points = run.points || [];
+  const k = Math.max(1, Math.ceil(points.length / TREND_POINTS));
+  return points.filter((_, i) => i % k === 0 || i === points.length - 1).map(p => ({
+    h: Math.round((new Date(p.t).getTime() - start) / HOUR_MS * 100) / 100,
+    heap_min: p.heap_min, heap_block: p.heap_block, jitter_p99_ms: p.jitter_p99_ms, loop_p95_us: p.loop_p95_us,
+  }));
+}
+
+// Summarized runs -> one row per firmware version, oldest soak first, each
+// with what got worse against the one before it
+function byFirmware(runs) {
+  const groups = new Map();
+  for (const r of [...runs].sort((a, b) => new Date(a.started) - new Date(b.started))) {
+    const g = groups.get(r.firmware) ?? { firmware: r.firmware, runs: 0, devices: new Set(), hours: 0, all: [] };
+    groups.set(r.firmware, g);
+    g.runs++;
+    g.devices.add(r.id);
+    g.hours += r.summary.hours || 0;
+    g.all.push(r.summary);
+  }
+  const worst = (all, key, pick) => {
+    const v = all.map(s => s[key]).filter(Number.isFinite);
+    return v.length ? pick(...v) : null;
+  };
+  const p95 = (all, key) => worst(all.map(s => ({ v: s[key]?.p95 })), 'v', Math.max);
+  let prev = null;
+  return [...groups.values()].map(g => {
+    const row = {
+      firmware: g.firmware, runs: g.runs, devices: g.devices.size, hours: round1(g.hours),
+      heap_slope_bph: worst(g.all, 'heap_slope_bph', Math.min),
+      heap_min: worst(g.all, 'heap_min', Math.min),
+      block_min: worst(g.all, 'block_min', Math.min),
+      frag_max: worst(g.all, 'frag_max', Math.max),
+      jitter_p99_ms: worst(g.all, 'jitter_p99_ms', Math.max),
+      loop_p95_us: worst(g.all, 'loop_p95_us', Math.max),
+      trigger_p95_ms: p95(g.all, 'trigger_ms'),
+      upload_p95_ms: p95(g.all, 'upload_ms'),
+      missed: g.all.reduce((n, s) => n + s.injections - s.triggered, 0),
+    };
+    const flags = [];
+    if (row.heap_slope_bph != null && row.heap_slope_bph < -LEAK_BPH) flags.push('heap_leak');
+    if (prev) {
+      if (row.block_min != null && prev.block_min != null && row.block_min < prev.block_min * 0.9) flags.push('block');
+      if (row.jitter_p99_ms != null && prev.jitter_p99_ms != null && row.jitter_p99_ms > prev.jitter_p99_ms) flags.push('jitter');
+      for (const key of ['trigger_p95_ms', 'upload_p95_ms']) {
+        if (row[key] != null && prev[key] != null && row[key] > prev[key] * SLOWER) flags.push(key.replace('_p95_ms', ''));
+      }
+    }
+    row.regressions = flags;
+    row.previous = prev?.firmware ?? null;
+    prev = row;
+    return row;
+  });
+}
+
+class SoakTests {
+  // inject(id, eventId) queues an injection and resolves to its run id
+  constructor(col, { inject, onError = () => {} }) {
+    this.col = col;
+    this.inject = inject;
+    this.onError = onError;
+    this.active = new Map();   // device id -> { run, lastInjectMs, pending: { t, run_id, trigger_ms, upload_ms, done } }
+  }
+
+  async start() {
+    await this.col.createIndex({ id: 1, started: -1 });
+    await this.col.createIndex({ firmware: 1, started: -1 });
+    const running = await this.col.find({ status: 'running' }, { projection: { points: 0, injections: 0 } }).toArray();
+    for (const run of running) this.active.set(run.id, { run, lastInjectMs: 0, pending: null });
+    return this;
+  }
+
+  // { event_id, interval_s, hours } on firmware -> the new run
+  async begin(id, { event_id, interval_s, hours }, firmware, now = Date.now()) {
+    const interval = Math.max(MIN_INTERVAL_S, Math.round(Number(interval_s) || 600));
+    const span = Number(hours) > 0 ? Number(hours) : 72;
+    await this.end(id, 'superseded', now);
+    const run = { id, firmware: firmware || 'unknown', event_id: String(event_id), interval_s: interval,
+                  started: new Date(now), ends: new Date(now + span * HOUR_MS), ended: null, status: 'running',
+                  points: [], injections: [] };
+    const { insertedId } = await this.col.insertOne(run);
+    run._id = insertedId;
+    this.active.set(id, { run, lastInjectMs: 0, pending: null });
+    return run;
+  }
+
+  async end(id, status = 'stopped', now = Date.now()) {
+    const a = this.active.get(id);
+    if (!a) return null;
+    this.active.delete(id);
+    const update = { $set: { status, ended: new Date(now) } };
+    if (a.pending) update.$push = { injections: { $each: [this.record(a.pending)], $slice: -MAX_INJECTIONS } };
+    await this.col.updateOne({ _id: a.run._id }, update);
+    return a.run._id;
+  }
+
+  record(p) {
+    return { t: p.t, run_id: p.run_id, trigger_ms: p.done ? p.trigger_ms : null, upload_ms: p.upload_ms };
+  }
+
+  // Every heartbeat of a soaking node: the point, and the next injection
+  // when it's due. firmware is what the node last reported.
+  async heartbeat(id, heap, profile, firmware, now = Date.now()) {
+    let a = this.active.get(id);
+    if (!a) return;
+    const run = a.run;
+    if (now >= run.ends.getTime()) {
+      await this.end(id, 'done', now);
+      return;
+    }
+    if (firmware && firmware !== run.firmware) {
+      // Rebooted into an update: the rest of the soak is the new version's
+      await this.end(id, 'firmware', now);
+      await this.begin(id, { event_id: run.event_id, interval_s: run.interval_s,
+                             hours: (run.ends.getTime() - now) / HOUR_MS }, firmware, now);
+      a = this.active.get(id);
+    }
+    const update = {};
+    const point = soakPoint(new Date(now), heap, profile);
+    if (point) update.$push = { points: { $each: [point], $slice: -MAX_POINTS } };
+
+    const p = a.pending;
+    const waiting = p && !p.done && now - p.t.getTime() < MISSED_INTERVALS * a.run.interval_s * 1000;
+    if (!waiting && now - a.lastInjectMs >= a.run.interval_s * 1000) {
+      if (p) (update.$push ??= {}).injections = { $each: [this.record(p)], $slice: -MAX_INJECTIONS };
+      a.lastInjectMs = now;
+      a.pending = null;
+      try {
+        a.pending = { t: new Date(now), run_id: await this.inject(id, a.run.event_id), trigger_ms: null, upload_ms: null, done: false };
+      } catch (e) {
+        this.onError(e);
+      }
+    }
+    if (update.$push) await this.col.updateOne({ _id: a.run._id }, update);
+  }
+
+  // The injection run reported (trigger_ms null: it didn't trigger)
+  reported(id, runId, triggerMs) {
+    const p = this.active.get(id)?.pending;
+    if (p?.run_id !== runId) return;
+    p.done = true;
+    p.trigger_ms = triggerMs;
+  }
+
+  // Its event arrived, upload_ms after its trigger
+  uploaded(id, runId, uploadMs) {
+    const p = this.active.get(id)?.pending;
+    if (p?.run_id === runId) p.upload_ms = uploadMs;
+  }
+
+  // -> { runs: [run without points, with summary and trend], firmware: byFirmware() }
+  async list(id) {
+    const docs = await this.col.find(id ? { id } : {}, { projection: { 'points.t': 1, 'points.heap_min': 1,
+      'points.heap_block': 1, 'points.heap_frag': 1, 'points.jitter_p99_ms': 1, 'points.loop_p95_us': 1,
+      'points.loop_max_us': 1, injections: 1, id: 1, firmware: 1, event_id: 1, interval_s: 1, started: 1,
+      ends: 1, ended: 1, status: 1 } }).sort({ started: -1 }).limit(200).toArray();
+    const runs = docs.map(({ points, injections, ...run }) => ({
+      ...run, summary: summarize({ ...run, points, injections }), trend: trend({ ...run, points }),
+    }));
+    return { runs, firmware: byFirmware(runs) };
+  }
+
+  // -> the run with its points, or null
+  async get(runId) {
+    if (!ObjectId.isValid(runId)) return null;
+    const run = await this.col.findOne({ _id: new ObjectId(runId) });
+    return run && { ...run, summary: summarize(run) };
+  }
+
+  status(id) {
+    const a = this.active.get(id);
+    return a && { run_id: a.run._id, firmware: a.run.firmware, started: a.run.started, ends: a.run.ends,
+                  interval_s: a.run.interval_s, next_inject_ms: a.lastInjectMs ? a.lastInjectMs + a.run.interval_s * 1000 : null };
+  }
+}
+
+module.exports = { SoakTests, soakPoint, summarize, trend, byFirmware, LEAK_BPH };
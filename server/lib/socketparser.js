@@ -0,0 +1,52 @@
+// ── Socket.IO MessagePack parser ─────────────────────────────────
+// Replaces socket.io's JSON parser for the dashboard sockets: every packet
+// is one msgpack message (lib/msgpack.js), so a binary like 'stream:frame'
+// goes in the same WebSocket frame as its event instead of as a separate
+// attachment, numbers don't go through decimal text, and a broadcast is
+// still encoded once for every socket it goes to. Same packet shapes as
+// socket.io-parser (protocol 5); frontend/src/socketParser.js is the other
+// end, which every client of this server has to use.
+
+const { EventEmitter } = require('events');
+const msgpack = require('./msgpack');
+
+const PacketType = { CONNECT: 0, DISCONNECT: 1, EVENT: 2, ACK: 3, CONNECT_ERROR: 4 };
+
+const isObject = (v) => v !== null && typeof v === 'object' && !Array.isArray(v);
+
+function validData(p) {
+  switch (p.type) {
+    case PacketType.CONNECT: return p.data === undefined || isObject(p.data);
+    case PacketType.DISCONNECT: return p.data === undefined;
+    case PacketType.CONNECT_ERROR: return typeof p.data === 'string' || isObject(p.data);
+    default: return Array.isArray(p.data);
+  }
+}
+
+function checkPacket(p) {
+  if (!isObject(p) || !Number.isInteger(p.type) || p.type < PacketType.CONNECT || p.type > PacketType.CONNECT_ERROR) {
+    throw new Error('socket packet: bad type');
+  }
+  if (typeof p.nsp !== 'string') throw new Error('socket packet: bad namespace');
+  if (!validData(p)) throw new Error('socket packet: bad payload');
+  if (p.id !== undefined && !Number.isInteger(p.id)) throw new Error('socket packet: bad ack id');
+}
+
+class Encoder {
+  encode(packet) {
+    return [msgpack.encode(packet)];
+  }
+}
+
+class Decoder extends EventEmitter {
+  add(chunk) {
+    if (typeof chunk === 'string') throw new Error('socket packet: text frame, expected msgpack');
+    const packet = msgpack.decode(Buffer.isBuffer(chunk) ? chunk : Buffer.from(chunk));
+    checkPacket(packet);
+    this.emit('decoded', packet);
+  }
+
+  destroy() {}
+}
+
+module.exports = { protocol: 5, PacketType, Encoder, Decoder };
@@ -0,0 +1,202 @@
+// ── Multi-node stacking detector ─────────────────────────────────
+// Events too small for any one node to trigger on can still stand out
+// when the nodes are taken together: the noise at each is its own, the
+// event's energy arrives at all of them. Over the continuous streams
+// (lib/stream.js, or the stored ones for a past range) this forms, per
+// node, an STA/LTA characteristic function on a common CELL_MS grid of
+// clock-corrected time, and stacks them:
+//   energy   per CELL_MS cell, the mean of |a - mean|² over the three axes
+//            (the mean over each contiguous segment: gravity and bias out)
+//   ratio    mean energy over the last sta_ms / mean over the lta_ms before
+//            it; a cell with less than COVERAGE of either window filled has
+//            none
+//   stack    the mean, per cell, of the nodes' ratios, each clipped at
+//            `clip`: a node well over it would have triggered anyway,
+//            and one node's footsteps can only lift the stack so far
+// A detection opens where the stack reaches `on` while at least min_nodes
+// nodes are at `support` or more themselves (one loud node is not an
+// event), and closes where the stack falls below `off`. The stack's noise
+// shrinks with every node added, which is what lets `on` sit below any
+// one node's trigger level. Arrivals across a site are well inside
+// sta_ms apart, so no moveout correction is made.
+//
+// stackTraces() is the pure part, run in the worker pool
+// (lib/analysis-worker.js). Stacker runs it every STEP_MS over what is
+// new since the last run, with sta + lta of lead-in before it so the
+// ratios there come out as they would in one long run. A detection still
+// open at the end of a run is looked at again from its start next time,
+// until it closes or has lasted MAX_EVENT_MS.
+
+const CELL_MS = 50;
+const COVERAGE = 0.8;
+const STEP_MS = 10 * 1000;
+const LATENCY_MS = 3 * 1000;    // datagrams still on their way
+const MAX_EVENT_MS = 60 * 1000;
+const DEFAULTS = { sta_ms: 1000, lta_ms: 30 * 1000, on: 1.6, off: 1.25, support: 1.4, clip: 3.0, min_nodes: 2 };
+
+// One node's segments [{ t0_ms, rate_hz, samples: Int16Array(3n) }] ->
+// Float64Array of cells from startMs (NaN where there's no data)
+function cellEnergy(segments, startMs, cells) {
+  const sum = new Float64Array(cells);
+  const count = new Uint32Array(cells);
+  for (const { t0_ms, rate_hz, samples } of segments) {
+    const n = samples.length / 3;
+    const mean = [0, 0, 0];
+    for (let i = 0; i < n; i++) for (let a = 0; a < 3; a++) mean[a] += samples[i * 3 + a];
+    for (let a = 0; a < 3; a++) mean[a] /= n || 1;
+    const dt = 1000 / rate_hz;
+    for (let i = 0; i < n; i++) {
+      const c = Math.floor((t0_ms + i * dt - startMs) / CELL_MS);
+      if (c < 0 || c >= cells) continue;
+      let e = 0;
+      for (let a = 0; a < 3; a++) {
+        const d = samples[i * 3 + a] - mean[a];
+        e += d * d;
+      }
+      sum[c] += e / 3;
+      count[c]++;
+    }
+  }
+  const out = new Float64Array(cells);
+  for (let c = 0; c < cells; c++) out[c] = count[c] ? sum[c] / count[c] : NaN;
+  return out;
+}
+
+// Cell energies -> STA/LTA ratio per cell (NaN without enough of both windows)
+function ratios(energy, staCells, ltaCells) {
+  const n = energy.length;
+  const out = new Float64Array(n).fill(NaN);
+  // Prefix sums of energy and of filled cells
+  const s = new Float64Array(n + 1);
+  const k = new Uint32Array(n + 1);
+  for (let i = 0; i < n; i++) {
+    const ok = !Number.isNaN(energy[i]);
+    s[i + 1] = s[i] + (ok ? energy[i] : 0);
+    k[i + 1] = k[i] + (ok ? 1 : 0);
+  }
+  for (let i = staCells + ltaCells - 1; i < n; i++) {
+    const staFrom = i + 1 - staCells;
+    const ltaFrom = staFrom - ltaCells;
+    const ks = k[i + 1] - k[staFrom];
+    const kl = k[staFrom] - k[ltaFrom];
+    if (ks < COVERAGE * staCells || kl < COVERAGE * ltaCells) continue;
+    const lta = (s[staFrom] - s[ltaFrom]) / kl;
+    if (lta > 0) out[i] = ((s[i + 1] - s[staFrom]) / ks) / lta;
+  }
+  return out;
+}
+
+// job: { start_ms, report_ms, to_ms, traces: [{ id, segments }], params }
+// -> { detections: [{ start_ms, end_ms (null if still open), peak_ms, peak,
+//      nodes, members: [{ id, peak }] }], cells, traces, max }
+// over the cells from report_ms to to_ms; start_ms is the lead-in
+function stackTraces({ start_ms, report_ms, to_ms, traces, params = {} }) {
+  const p = { ...DEFAULTS, ...params };
+  const cells = Math.max(0, Math.floor((to_ms - start_ms) / CELL_MS));
+  const staCells = Math.max(1, Math.round(p.sta_ms / CELL_MS));
+  const ltaCells = Math.max(1, Math.round(p.lta_ms / CELL_MS));
+  const per = traces.map(t => ({ id: t.id, r: ratios(cellEnergy(t.segments, start_ms, cells), staCells, ltaCells) }));
+  const from = Math.max(0, Math.floor((report_ms - start_ms) / CELL_MS));
+  const detections = [];
+  let open = null;
+  let max = 0;
+  for (let c = from; c < cells; c++) {
+    let sum = 0;
+    let nodes = 0;
+    let support = 0;
+    for (const { r } of per) {
+      if (Number.isNaN(r[c])) continue;
+      sum += Math.min(r[c], p.clip);
+      nodes++;
+      if (r[c] >= p.support) support++;
+    }
+    const stack = nodes >= p.min_nodes ? sum / nodes : NaN;
+    const t = start_ms + (c + 1) * CELL_MS;
+    if (stack > max) max = stack;
+    if (!open && stack >= p.on && support >= p.min_nodes) {
+      open = { start_ms: t, end_ms: null, peak_ms: t, peak: stack, nodes, first: c, members: null };
+      detections.push(open);
+    } else if (open && !(stack >= p.off)) {
+      open.end_ms = t;
+      open = null;
+    }
+    if (open && stack > open.peak) Object.assign(open, { peak_ms: t, peak: stack, nodes });
+  }
+  for (const d of detections) {
+    const last = d.end_ms == null ? cells : d.first + Math.round((d.end_ms - d.start_ms) / CELL_MS);
+    d.members = per.map(({ id, r }) => {
+      let peak = NaN;
+      for (let c = d.first; c < last; c++) if (r[c] > peak || (Number.isNaN(peak) && !Number.isNaN(r[c]))) peak = r[c];
+      return { id, peak: Number.isNaN(peak) ? null : Math.round(peak * 100) / 100 };
+    }).filter(m => m.peak != null);
+    d.peak = Math.round(d.peak * 100) / 100;
+    delete d.first;
+  }
+  return { detections, cells: cells - from, traces: traces.length, max: Math.round(max * 100) / 100 };
+}
+
+class Stacker {
+  // run(job) -> stackTraces' result (the worker pool); source(fromMs, toMs)
+  // -> [{ id, segments }] with data there; onDetection(detection)
+  constructor({ run, source, onDetection, params = {} }) {
+    this.run = run;
+    this.source = source;
+    this.onDetection = onDetection;
+    this.params = { ...DEFAULTS, ...params };
+    this.cursor = null;       // report from here next run
+    this.busy = false;
+    this.timer = null;
+    this.stats = { runs: 0, skipped: 0, detections: 0, errors: 0, last_ms: null, last_max: null, nodes: 0 };
+  }
+
+  start(onError = () => {}) {
+    this.timer = setInterval(() => this.tick().catch((e) => {
+      this.stats.errors++;
+      onError(e);
+    }), STEP_MS);
+    return this;
+  }
+
+  stop() {
+    clearInterval(this.timer);
+  }
+
+  async tick(now = Date.now()) {
+    if (this.busy) return;
+    const to = Math.floor((now - LATENCY_MS) / CELL_MS) * CELL_MS;
+    const report = this.cursor ?? to - STEP_MS;
+    const lead = this.params.sta_ms + this.params.lta_ms;
+    const traces = this.source(report - lead, to);
+    this.stats.nodes = traces.length;
+    if (traces.length < this.params.min_nodes) {
+      this.cursor = to;
+      this.stats.skipped++;
+      return;
+    }
+    this.busy = true;
+    const started = Date.now();
+    try {
+      const result = await this.run({ start_ms: report - lead, report_ms: report, to_ms: to, traces, params: this.params });
+      this.stats.runs++;
+      this.stats.last_ms = Date.now() - started;
+      this.stats.last_max = result.max;
+      this.cursor = to;
+      for (const d of result.detections) {
+        if (d.end_ms == null && to - d.start_ms < MAX_EVENT_MS) {
+          this.cursor = d.start_ms - CELL_MS;   // again next time, with the rest of it
+          break;
+        }
+        this.stats.detections++;
+        this.onDetection({ ...d, end_ms: d.end_ms ?? to });
+      }
+    } finally {
+      this.busy = false;
+    }
+  }
+
+  metrics() {
+    return { ...this.stats, params: this.params, cursor: this.cursor ? new Date(this.cursor) : null };
+  }
+}
+
+module.exports = { stackTraces, Stacker, DEFAULTS, CELL_MS };
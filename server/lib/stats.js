@@ -0,0 +1,121 @@
+// ── Hourly statistics sketches ───────────────────────────────────
+// Distributions the dashboards and tuning ask percentiles of, kept as
+// quantile sketches (lib/sketch.js) per device, metric and UTC hour:
+//   { _id: { start, id, metric }, start: Date, id, metric, n, z, sum, min, max, b: { k: count } }
+// add() is called at ingest and only touches memory. Every FLUSH_MS the
+// sketches gathered since the last flush are added to their stored hour
+// with one bulkWrite of $inc updates, so an hour written by several
+// replicas, or by late uploads, adds up instead of being replaced. A
+// failed flush keeps its deltas for the next.
+//
+// query() merges the stored hours over any range, per device and overall;
+// the answer costs one read per hour and device, never a scan of events.
+
+const { QuantileSketch } = require('./sketch');
+
+const HOUR_MS = 3600 * 1000;
+const FLUSH_MS = 60 * 1000;
+const RETENTION_DAYS = 180;
+
+// metric → what it is and its unit, for /api/stats
+const METRICS = {
+  deltaG: { unit: 'g', about: 'peak ΔG of each device event' },
+  latency_ms: { unit: 'ms', about: 'trigger to dashboard emit (total_ms) of each live upload' },
+  queue_ms: { unit: 'ms', about: 'capture ready to sent, on the device (queue_ms)' },
+  jitter_ms: { unit: 'ms', about: '|sample interval − period| from the heartbeat isi histogram (bucket midpoints)' },
+};
+
+class HourlyStats {
+  constructor(col) {
+    this.col = col;
+    this.pending = new Map();   // `${start}|${id}|${metric}` → QuantileSketch since the last flush
+    this.timer = null;
+    this.flushing = null;
+    this.stats = { added: 0, flushes: 0, writes: 0, errors: 0 };
+  }
+
+  async start(onError = () => {}) {
+    await this.col.createIndex({ metric: 1, start: 1 });
+    await this.col.createIndex({ start: 1 }, { expireAfterSeconds: RETENTION_DAYS * 86400 });
+    this.timer = setInterval(() => this.flush().catch(onError), FLUSH_MS);
+    return this;
+  }
+
+  add(id, metric, value, timeMs = Date.now(), n = 1) {
+    if (!METRICS[metric] || !Number.isFinite(value) || value < 0) return;
+    const key = `${timeMs - (timeMs % HOUR_MS)}|${id}|${metric}`;
+    let s = this.pending.get(key);
+    if (!s) this.pending.set(key, s = new QuantileSketch());
+    s.add(value, n);
+    this.stats.added += n;
+  }
+
+  async flush() {
+    if (this.flushing || !this.pending.size) return this.flushing;
+    const batch = this.pending;
+    this.pending = new Map();
+    const ops = [];
+    for (const [key, s] of batch) {
+      const [start, id, metric] = key.split('|');
+      const startDate = new Date(Number(start));
+      ops.push({ updateOne: {
+        filter: { _id: { start: startDate, id, metric } },
+        update: { ...s.toInc(), $setOnInsert: { start: startDate, id, metric } },
+        upsert: true,
+      } });
+    }
+    this.flushing = this.col.bulkWrite(ops, { ordered: false })
+      .then(() => {
+        this.stats.flushes++;
+        this.stats.writes += ops.length;
+      })
+      .catch((e) => {
+        this.stats.errors++;
+        for (const [key, s] of batch) {
+          const kept = this.pending.get(key);
+          this.pending.set(key, kept ? kept.merge(s) : s);
+        }
+        throw e;
+      })
+      .finally(() => { this.flushing = null; });
+    return this.flushing;
+  }
+
+  // -> { metric, unit, from, to, hours, devices: { id: summary }, all: summary }
+  // over the hours overlapping [from, to); ids: array or null for all. The
+  // current hour's unflushed part is included.
+  async query({ metric, from, to, ids = null, qs }) {
+    const match = { metric, start: { $gte: new Date(from - (from % HOUR_MS)), $lt: new Date(to) } };
+    if (ids) match.id = { $in: ids };
+    const perDevice = new Map();
+    const hours = new Set();
+    const into = (id, s) => {
+      if (!perDevice.has(id)) perDevice.set(id, new QuantileSketch());
+      perDevice.get(id).merge(s);
+    };
+    for await (const doc of this.col.find(match)) {
+      hours.add(+doc.start);
+      into(doc.id, QuantileSketch.fromDoc(doc));
+    }
+    for (const [key, s] of this.pending) {
+      const [start, id, m] = key.split('|');
+      if (m !== metric || (ids && !ids.includes(id)) || +start < +match.start.$gte || +start >= to) continue;
+      hours.add(+start);
+      into(id, s);
+    }
+    const all = new QuantileSketch();
+    const devices = {};
+    for (const [id, s] of perDevice) {
+      devices[id] = s.summary(qs);
+      all.merge(s);
+    }
+    return { metric, unit: METRICS[metric].unit, from: new Date(from), to: new Date(to), hours: hours.size,
+             devices, all: all.summary(qs) };
+  }
+
+  metrics() {
+    return { pending: this.pending.size, ...this.stats };
+  }
+}
+
+module.exports = { HourlyStats, METRICS, HOUR_MS };
@@ -0,0 +1,188 @@
+// ── Device status feed ───────────────────────────────────────────
+// What the dashboards know about devices. The server keeps each device's
+// /api/status entry instead of building it per request: touch(id) says
+// something in it changed, the entry is rebuilt the next time anyone needs
+// it, and GET /api/status is the snapshot of all of them (tagged by
+// version, which moves on every change). The snapshot's JSON is kept too,
+// built from each entry's own JSON, so a change re-serializes only the
+// devices it touched and a request writes bytes already made.
+//
+// Pushes are coalesced: at most every intervalMs one 'devices:status'
+//   { time, devices: { id: { field: value, ... } } }
+// carries, per touched device, only the fields that differ from what was
+// last sent (the first time, all of them). A client merges each device's
+// fields into its copy of /api/status. Going online or offline is sent at
+// once (in the same turn, so a heartbeat's own fields ride along).
+//
+// Going offline is time passing, so each device is also filed in a timer
+// wheel under the moment it would (expiresAt(id); null while a push or
+// MQTT session holds it online). Every TICK_MS the slots that came due are
+// emptied and only their devices looked at; touching a device refiles it.
+//
+// statusOf(id) -> the device's /api/status entry; ids() -> every device;
+// publish(type, payload) sends it (LiveChannel.publish); isOnline(id) and
+// expiresAt(id) -> ms are the cheap parts of statusOf.
+
+const TICK_MS = 1000;
+
+class StatusFeed {
+  constructor(statusOf, ids, publish, { intervalMs = 2000, isOnline, expiresAt = () => null } = {}) {
+    this.statusOf = statusOf;
+    this.ids = ids;
+    this.publish = publish;
+    this.intervalMs = intervalMs;
+    this.isOnline = isOnline || ((id) => statusOf(id).status === 'Online');
+    this.expiresAt = expiresAt;
+    this.version = 0;
+    this.entries = new Map();   // id → its /api/status entry
+    this.stale = new Set();     // ids whose entry is rebuilt before use
+    this.body = null;           // the last /api/status snapshot, until version moves
+    this.json = new Map();      // id → its entry's JSON, until it goes stale
+    this.bytes = null;          // the snapshot's JSON, likewise
+    this.sent = new Map();      // id → { field: JSON of the value last sent }
+    this.online = new Map();    // id → online as last sent
+    this.dirty = new Set();
+    this.timer = null;          // the next coalesced flush
+    this.immediate = null;
+    this.lastFlush = 0;
+    this.wheel = new Map();     // slot → Set of ids going offline in it
+    this.slotOf = new Map();    // id → its slot
+    this.lastSlot = Math.floor(Date.now() / TICK_MS);
+    this.check = null;
+    this.stats = { touches: 0, messages: 0, immediate: 0, devices_sent: 0, expired: 0, rebuilt: 0, serialized: 0 };
+  }
+
+  start() {
+    this.check = setInterval(() => this.tick(), TICK_MS);
+    return this;
+  }
+
+  stop() {
+    clearInterval(this.check);
+    clearTimeout(this.timer);
+    clearImmediate(this.immediate);
+  }
+
+  // Every device changed: a new threshold, registry or config
+  refresh() {
+    for (const id of this.ids()) this.touch(id);
+    this.body = this.bytes = null;
+  }
+
+  touch(id) {
+    this.stats.touches++;
+    this.version++;
+    this.body = this.bytes = null;
+    this.stale.add(id);
+    this.dirty.add(id);
+    this.file(id);
+    if (this.isOnline(id) !== (this.online.get(id) ?? false)) return this.flushSoon();
+    if (this.timer || this.immediate) return;
+    const wait = Math.max(0, this.lastFlush + this.intervalMs - Date.now());
+    this.timer = setTimeout(() => this.flush(), wait);
+  }
+
+  // Into the slot after the one its expiry falls in, so it is due by then
+  file(id) {
+    const old = this.slotOf.get(id);
+    if (old !== undefined) {
+      this.wheel.get(old)?.delete(id);
+      this.slotOf.delete(id);
+    }
+    const at = this.expiresAt(id);
+    if (at == null || at < Date.now()) return;   // held online, or already gone
+    const slot = Math.max(Math.floor(at / TICK_MS) + 1, this.lastSlot + 1);
+    if (!this.wheel.has(slot)) this.wheel.set(slot, new Set());
+    this.wheel.get(slot).add(id);
+    this.slotOf.set(id, slot);
+  }
+
+  flushSoon() {
+    if (this.immediate) return;
+    this.stats.immediate++;
+    this.immediate = setImmediate(() => this.flush());
+  }
+
+  tick(now = Date.now()) {
+    const due = Math.floor(now / TICK_MS);
+    for (let slot = this.lastSlot + 1; slot <= due; slot++) {
+      const ids = this.wheel.get(slot);
+      if (!ids) continue;
+      this.wheel.delete(slot);
+      for (const id of ids) {
+        this.slotOf.delete(id);
+        this.stats.expired++;
+        this.touch(id);
+      }
+    }
+    this.lastSlot = Math.max(this.lastSlot, due);
+  }
+
+  entry(id) {
+    if (this.stale.has(id) || !this.entries.has(id)) {
+      this.entries.set(id, this.statusOf(id));
+      this.json.delete(id);
+      this.stale.delete(id);
+      this.stats.rebuilt++;
+    }
+    return this.entries.get(id);
+  }
+
+  // -> GET /api/status
+  status() {
+    if (!this.body) {
+      this.body = {};
+      for (const id of this.ids()) this.body[id] = this.entry(id);
+    }
+    return this.body;
+  }
+
+  // -> GET /api/status as a Buffer of JSON
+  serialized() {
+    if (!this.bytes) {
+      const parts = [];
+      for (const id of this.ids()) {
+        const entry = this.entry(id);
+        if (!this.json.has(id)) this.json.set(id, JSON.stringify(entry));
+        parts.push(`${JSON.stringify(id)}:${this.json.get(id)}`);
+      }
+      this.bytes = Buffer.from(`{${parts.join(',')}}`);
+      this.stats.serialized++;
+    }
+    return this.bytes;
+  }
+
+  flush() {
+    clearTimeout(this.timer);
+    clearImmediate(this.immediate);
+    this.timer = this.immediate = null;
+    this.lastFlush = Date.now();
+    const devices = {};
+    for (const id of this.dirty) {
+      const status = this.entry(id);
+      const last = this.sent.get(id) || {};
+      const diff = {};
+      for (const [k, v] of Object.entries(status)) {
+        const json = JSON.stringify(v);
+        if (last[k] === json) continue;
+        last[k] = json;
+        diff[k] = v;
+      }
+      this.sent.set(id, last);
+      this.online.set(id, status.status === 'Online');
+      if (Object.keys(diff).length) devices[id] = diff;
+    }
+    this.dirty.clear();
+    const n = Object.keys(devices).length;
+    if (!n) return;
+    this.stats.messages++;
+    this.stats.devices_sent += n;
+    this.publish('devices:status', { time: new Date().toISOString(), devices });
+  }
+
+  metrics() {
+    return { interval_ms: this.intervalMs, version: this.version, timers: this.slotOf.size, ...this.stats };
+  }
+}
+
+module.exports = { StatusFeed };
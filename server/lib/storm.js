@@ -0,0 +1,31 @@
+// ── Storm summary decoder ────────────────────────────────────────
+// Minor captures a device folded instead of uploading during a storm
+// cooldown arrive with the heartbeat as "storm" (layout documented in
+// src/storm_filter.h): per minute, oldest first and ';' separated,
+//   age_s,count,peak_mg[,bin_mg ...]
+// with the bins in the device's SPECTRUM_HZ order (src/spectrum.cpp).
+
+const SPECTRUM_HZ = [1, 2, 3, 5, 8, 12, 20, 30];
+const MAX_MINUTES = 16;
+
+// -> [{ t0: Date (minute start), count, peak_g, spectrum: { hz, amp_g } | null }] or null
+function decodeStorm(query, now = Date.now()) {
+  if (typeof query.storm !== 'string' || !query.storm) return null;
+  const minutes = [];
+  for (const part of query.storm.split(';').slice(0, MAX_MINUTES)) {
+    const [age, count, peak, ...bins] = part.split(',').map(v => parseInt(v, 10));
+    if (!(age >= 0) || !(count > 0) || !(peak >= 0)) continue;
+    const amp = bins.slice(0, SPECTRUM_HZ.length);
+    minutes.push({
+      t0: new Date(now - age * 1000),
+      count,
+      peak_g: peak / 1000,
+      spectrum: amp.length && amp.every(Number.isFinite)
+        ? { hz: SPECTRUM_HZ.slice(0, amp.length), amp_g: amp.map(v => v / 1000) }
+        : null,
+    });
+  }
+  return minutes.length ? minutes : null;
+}
+
+module.exports = { decodeStorm };
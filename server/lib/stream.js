@@ -0,0 +1,159 @@
+// ── Continuous UDP stream reassembly ─────────────────────────────
+// Devices with stream_mode 'udp' send decimated raw samples as datagrams
+// (layout documented in src/udp_stream.h):
+//   "SUS1", seq u32, MAC[6], rate u16, decim u8, n u8, session u16,
+//   epoch_us i64 (0 before SNTP sync), millis u32, then n × int16 x,y,z LE
+// Each device's datagrams are kept in seq order in a rolling in-memory window
+// of BUFFER_SECONDS. Datagrams are never retransmitted; seq gaps are counted
+// as lost and split the window into contiguous segments.
+
+const MAGIC = 'SUS1';
+const HEADER_SIZE = 32;
+const SCALE = 16384;           // LSB per g at +/-2g
+const BUFFER_SECONDS = 600;
+const round6 = (v) => Math.round(v * 1e6) / 1e6;
+const EMPTY_COLUMN = [32767, -32768, 32767, -32768, 32767, -32768];
+const endMs = (p) => p.t0_ms + (p.samples.length / 3) * 1000 / p.rate_hz;   // just after a datagram's last sample
+
+// -> { seq, session, id, rate_hz, decim, t0_ms, synced, millis, samples: Int16Array(3n) } or null
+// (synced: t0_ms is the device's SNTP time, else arrival; millis: the first sample's device millis())
+function decodeDatagram(buf, now = Date.now()) {
+  if (buf.length < HEADER_SIZE || buf.toString('latin1', 0, 4) !== MAGIC) return null;
+  const n = buf[17];
+  if (buf.length < HEADER_SIZE + n * 6) return null;
+  const rate = buf.readUInt16LE(14);
+  const decim = buf[16];
+  if (!rate || !decim || !n) return null;
+  const id = Array.from(buf.subarray(8, 14), b => b.toString(16).toUpperCase().padStart(2, '0')).join(':');
+  const outRate = rate / decim;
+  const epochUs = buf.readBigInt64LE(20);
+  // Before SNTP sync, place the datagram by arrival: it was sent as its last sample came in
+  const t0 = epochUs > 0n ? Number(epochUs / 1000n) : now - ((n - 1) * 1000) / outRate;
+  const samples = new Int16Array(n * 3);
+  for (let k = 0; k < n * 3; k++) samples[k] = buf.readInt16LE(HEADER_SIZE + k * 2);
+  return { seq: buf.readUInt32LE(4), session: buf.readUInt16LE(18), id,
+           rate_hz: outRate, decim, t0_ms: t0, synced: epochUs > 0n, millis: buf.readUInt32LE(28), samples };
+}
+
+class StreamBuffer {
+  constructor() {
+    this.packets = [];          // ascending seq
+    this.received = 0;
+    this.lost = 0;
+    this.duplicates = 0;
+    this.lastSeen = null;
+  }
+
+  add(pkt) {
+    this.lastSeen = new Date();
+    const last = this.packets[this.packets.length - 1];
+    if (last && pkt.session !== last.session) {
+      // Stream restarted (reboot or config reload): start over
+      this.packets = [];
+    } else if (last && pkt.seq <= last.seq) {
+      const at = this.packets.findIndex(p => p.seq >= pkt.seq);
+      if (at >= 0 && this.packets[at].seq === pkt.seq) {
+        this.duplicates++;
+        return;
+      }
+      this.packets.splice(at < 0 ? 0 : at, 0, pkt);
+      this.received++;
+      this.lost = Math.max(0, this.lost - 1);   // counted as lost when the later one came in
+      return;
+    } else if (last) {
+      this.lost += pkt.seq - last.seq - 1;
+    }
+    this.packets.push(pkt);
+    this.received++;
+
+    const keep = Math.ceil(BUFFER_SECONDS * pkt.rate_hz / (pkt.samples.length / 3));
+    if (this.packets.length > keep) this.packets.splice(0, this.packets.length - keep);
+  }
+
+  // -> { rate_hz, received, lost, duplicates, last_seen, segments: [{ t0, samples: [[x,y,z], ...] }] }
+  // in g, covering the newest 'seconds' of the window
+  window(seconds = 60) {
+    const newest = this.packets[this.packets.length - 1];
+    const result = {
+      rate_hz: newest?.rate_hz ?? null,
+      received: this.received, lost: this.lost, duplicates: this.duplicates,
+      last_seen: this.lastSeen, segments: [],
+    };
+    if (!newest) return result;
+    const since = newest.t0_ms - seconds * 1000;
+    let seg = null;
+    let prevSeq = null;
+    for (const p of this.packets) {
+      if (p.t0_ms < since) continue;
+      if (!seg || p.seq !== prevSeq + 1) {
+        seg = { t0: new Date(p.t0_ms), samples: [] };
+        result.segments.push(seg);
+      }
+      for (let k = 0; k < p.samples.length; k += 3) {
+        seg.samples.push([0, 1, 2].map(i => round6(p.samples[k + i] / SCALE)));
+      }
+      prevSeq = p.seq;
+    }
+    return result;
+  }
+
+  // Contiguous runs overlapping [from, to) epoch ms, raw:
+  // [{ t0_ms, rate_hz, samples: Int16Array(3n) }] (lib/stacking.js)
+  segments(from, to) {
+    const out = [];
+    let run = null;
+    let prevSeq = null;
+    for (const p of this.packets) {
+      if (endMs(p) <= from || p.t0_ms >= to) continue;
+      if (!run || p.seq !== prevSeq + 1 || p.rate_hz !== run.rate_hz) {
+        run = { t0_ms: p.t0_ms, rate_hz: p.rate_hz, parts: [] };
+        out.push(run);
+      }
+      run.parts.push(p.samples);
+      prevSeq = p.seq;
+    }
+    return out.map(({ t0_ms, rate_hz, parts }) => {
+      const samples = new Int16Array(parts.reduce((n, s) => n + s.length, 0));
+      let at = 0;
+      for (const s of parts) {
+        samples.set(s, at);
+        at += s.length;
+      }
+      return { t0_ms, rate_hz, samples };
+    });
+  }
+
+  // Epoch ms just after the newest sample, or null with nothing buffered
+  newestMs() {
+    const p = this.packets[this.packets.length - 1];
+    return p ? endMs(p) : null;
+  }
+
+  // Per-axis min/max envelope of count columns of colMs from epoch ms from:
+  // Int16Array of count × [x min, x max, y min, y max, z min, z max] in raw
+  // LSB. A column without samples keeps min > max (32767, -32768).
+  columns(from, colMs, count) {
+    const out = new Int16Array(count * 6);
+    for (let c = 0; c < count; c++) out.set(EMPTY_COLUMN, c * 6);
+    const end = from + colMs * count;
+    let i = this.packets.length;
+    while (i > 0 && endMs(this.packets[i - 1]) > from) i--;
+    for (; i < this.packets.length; i++) {
+      const p = this.packets[i];
+      if (p.t0_ms >= end) break;
+      const dt = 1000 / p.rate_hz;
+      for (let k = 0; k < p.samples.length / 3; k++) {
+        const c = Math.floor((p.t0_ms + k * dt - from) / colMs);
+        if (c < 0 || c >= count) continue;
+        for (let a = 0; a < 3; a++) {
+          const v = p.samples[k * 3 + a];
+          if (v < out[c * 6 + a * 2]) out[c * 6 + a * 2] = v;
+          if (v > out[c * 6 + a * 2 + 1]) out[c * 6 + a * 2 + 1] = v;
+        }
+      }
+    }
+    return out;
+  }
+}
+
+module.exports = { decodeDatagram, StreamBuffer, BUFFER_SECONDS };
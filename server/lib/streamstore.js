@@ -0,0 +1,325 @@
+// ── Stored continuous streams ────────────────────────────────────
+// The UDP streams (lib/stream.js) kept past the in-memory window, without
+// a document per sample or datagram: each device's samples are packed
+// into one chunk per CHUNK_MS of its stream,
+//   stream_chunks   { id, start, end, rate_hz, n, runs: [[offset_ms, n], ...],
+//                     cols, raw_bytes, small }
+// start is the first sample, end just after the last. runs are the
+// contiguous stretches (split at lost datagrams, clock jumps and restarts),
+// offset from start. cols holds the x, y and z columns one after another as
+// int16 steps from the previous sample of that column, raw-deflated: a
+// quiet sensor is mostly small steps, which pack to a fraction of the
+// interleaved values. Lossless, in raw LSB at 16384 per g.
+//
+// add() takes every decoded datagram. A device's open chunk is written
+// when its time slot has passed, or after IDLE_MS with nothing new; the
+// closed chunks go out together every FLUSH_MS. A write that fails keeps
+// them for the next, up to MAX_QUEUE.
+//
+// { id, start } is the time index: no chunk spans more than MAX_SPAN_MS, so
+// read() asks for start in [from - MAX_SPAN_MS, to) and finds exactly the
+// chunks that overlap, plus what hasn't been written yet.
+//
+// A chunk of fewer than SMALL_SAMPLES (a stream that stopped, a low
+// stream_hz, an instance restart) is marked small. compact() merges a
+// device's consecutive small chunks of one rate into one, up to MERGE_SAMPLES
+// and MAX_SPAN_MS. The merged chunk goes in before the originals are
+// deleted, so an interrupted merge, or two instances merging at once, can
+// only leave samples twice: a run that overlaps the one before is trimmed
+// when read or merged again. Chunks expire after `days` (TTL on end).
+
+const zlib = require('zlib');
+
+const CHUNK_MS = 60 * 1000;
+const MAX_SPAN_MS = 60 * 60 * 1000;
+const IDLE_MS = 30 * 1000;
+const FLUSH_MS = 5 * 1000;
+const COMPACT_MS = 5 * 60 * 1000;
+const SETTLE_MS = 2 * 60 * 1000;     // small chunks this recent may still get a neighbour
+const SMALL_SAMPLES = 3000;          // 30 s at 100 Hz
+const MERGE_SAMPLES = 6000;
+const MAX_QUEUE = 5000;
+const COMPACT_BATCH = 2000;
+
+// Interleaved Int16Array of n × x,y,z -> deflated step columns
+function packColumns(samples) {
+  const n = samples.length / 3;
+  const out = Buffer.alloc(samples.length * 2);
+  for (let a = 0; a < 3; a++) {
+    let prev = 0;
+    for (let i = 0; i < n; i++) {
+      const v = samples[i * 3 + a];
+      out.writeInt16LE(((v - prev) << 16) >> 16, (a * n + i) * 2);
+      prev = v;
+    }
+  }
+  return zlib.deflateRawSync(out, { level: 6 });
+}
+
+function unpackColumns(z, n) {
+  const buf = zlib.inflateRawSync(Buffer.isBuffer(z) ? z : z.buffer);
+  const samples = new Int16Array(n * 3);
+  for (let a = 0; a < 3; a++) {
+    let v = 0;
+    for (let i = 0; i < n; i++) {
+      v = (v + buf.readInt16LE((a * n + i) * 2)) << 16 >> 16;
+      samples[i * 3 + a] = v;
+    }
+  }
+  return samples;
+}
+
+// Runs [{ t0_ms, samples }] at periodMs -> the same in time order, each
+// trimmed of what an earlier one already covers
+function mergeRuns(runs, periodMs) {
+  runs.sort((a, b) => a.t0_ms - b.t0_ms);
+  const out = [];
+  let end = -Infinity;
+  for (const r of runs) {
+    const n = r.samples.length / 3;
+    const skip = Math.max(0, Math.ceil((end - r.t0_ms) / periodMs - 0.5));
+    if (skip >= n) continue;
+    const run = skip ? { t0_ms: r.t0_ms + skip * periodMs, samples: r.samples.subarray(skip * 3) } : r;
+    out.push(run);
+    end = run.t0_ms + (run.samples.length / 3) * periodMs;
+  }
+  return out;
+}
+
+// A stored chunk -> [{ t0_ms, samples }]
+function chunkRuns(doc) {
+  const samples = unpackColumns(doc.cols, doc.n);
+  const start = doc.start.getTime();
+  const runs = [];
+  let at = 0;
+  for (const [offset, n] of doc.runs) {
+    runs.push({ t0_ms: start + offset, samples: samples.subarray(at * 3, (at + n) * 3) });
+    at += n;
+  }
+  return runs;
+}
+
+// [{ t0_ms, samples }] at rateHz -> a chunk document
+function chunkDoc(id, rateHz, runs) {
+  const n = runs.reduce((k, r) => k + r.samples.length / 3, 0);
+  const samples = new Int16Array(n * 3);
+  let at = 0;
+  for (const r of runs) {
+    samples.set(r.samples, at);
+    at += r.samples.length;
+  }
+  const start = runs[0].t0_ms;
+  const last = runs[runs.length - 1];
+  const end = last.t0_ms + (last.samples.length / 3) * 1000 / rateHz;
+  return {
+    id, start: new Date(start), end: new Date(end), rate_hz: rateHz, n,
+    runs: runs.map(r => [Math.round((r.t0_ms - start) * 1000) / 1000, r.samples.length / 3]),
+    cols: packColumns(samples), raw_bytes: n * 6,
+    small: n < SMALL_SAMPLES && end - start < MAX_SPAN_MS,
+  };
+}
+
+class StreamStore {
+  constructor(col, { days = 7, onError = () => {} } = {}) {
+    this.col = col;
+    this.days = days;
+    this.onError = onError;
+    this.open = new Map();     // device id -> { slot, rateHz, session, seq, nextMs, arrived, runs: [{ t0_ms, parts, n }] }
+    this.queue = [];           // closed chunk documents to write
+    this.flushing = null;
+    this.compacting = false;
+    this.timers = [];
+    this.stats = { datagrams: 0, late: 0, chunks: 0, samples: 0, raw_bytes: 0, stored_bytes: 0, dropped: 0,
+                   compactions: 0, merged: 0, errors: 0 };
+  }
+
+  async start() {
+    await this.col.createIndex({ id: 1, start: 1 });
+    await this.col.createIndex({ id: 1, start: 1, small: 1 }, { partialFilterExpression: { small: true } });
+    if (this.days > 0) await this.col.createIndex({ end: 1 }, { expireAfterSeconds: Math.round(this.days * 86400) });
+    this.timers.push(setInterval(() => {
+      this.closeIdle(Date.now());
+      this.flush().catch(e => this.onError(e));
+    }, FLUSH_MS));
+    this.timers.push(setInterval(() => this.compact().catch(e => this.onError(e)), COMPACT_MS));
+    return this;
+  }
+
+  stop() {
+    for (const t of this.timers) clearInterval(t);
+    for (const id of [...this.open.keys()]) this.close(id);
+    return this.flush();
+  }
+
+  // A decoded stream datagram
+  add(id, pkt, now = Date.now()) {
+    this.stats.datagrams++;
+    const period = 1000 / pkt.rate_hz;
+    let o = this.open.get(id);
+    if (o && o.session === pkt.session && pkt.seq <= o.seq) {
+      this.stats.late++;   // StreamBuffer slots it in; here its run has moved on
+      return;
+    }
+    if (o && o.rateHz !== pkt.rate_hz) {
+      this.close(id);
+      o = null;
+    }
+    const contiguous = o && o.session === pkt.session && pkt.seq === o.seq + 1 &&
+                       Math.abs(pkt.t0_ms - o.nextMs) <= 1.5 * period;
+    const n = pkt.samples.length / 3;
+    let from = 0;
+    let joined = contiguous;
+    while (from < n) {
+      const t = pkt.t0_ms + from * period;
+      const slot = Math.floor(t / CHUNK_MS);
+      if (o && o.slot !== slot) {
+        this.close(id);
+        o = null;
+      }
+      if (!o) {
+        o = { slot, rateHz: pkt.rate_hz, session: pkt.session, seq: pkt.seq, nextMs: t, arrived: now, runs: [] };
+        this.open.set(id, o);
+        joined = false;
+      }
+      // Samples up to the end of this slot
+      const take = Math.min(n - from, Math.max(1, Math.ceil(((slot + 1) * CHUNK_MS - t) / period)));
+      const part = pkt.samples.subarray(from * 3, (from + take) * 3);
+      const run = o.runs[o.runs.length - 1];
+      if (joined && run) {
+        run.parts.push(part);
+        run.n += take;
+      } else {
+        o.runs.push({ t0_ms: t, parts: [part], n: take });
+      }
+      joined = true;
+      from += take;
+    }
+    o.session = pkt.session;
+    o.seq = pkt.seq;
+    o.nextMs = pkt.t0_ms + n * period;
+    o.arrived = now;
+  }
+
+  // The open chunk of id as a document, on the write queue
+  close(id) {
+    const o = this.open.get(id);
+    this.open.delete(id);
+    if (!o?.runs.length) return;
+    const doc = chunkDoc(id, o.rateHz, o.runs.map(r => ({ t0_ms: r.t0_ms, samples: concat(r.parts, r.n) })));
+    this.stats.chunks++;
+    this.stats.samples += doc.n;
+    this.stats.raw_bytes += doc.raw_bytes;
+    this.stats.stored_bytes += doc.cols.length;
+    this.queue.push(doc);
+    if (this.queue.length > MAX_QUEUE) this.stats.dropped += this.queue.splice(0, this.queue.length - MAX_QUEUE).length;
+  }
+
+  closeIdle(now) {
+    for (const [id, o] of this.open) if (now - o.arrived >= IDLE_MS) this.close(id);
+  }
+
+  async flush() {
+    if (this.flushing || !this.queue.length) return this.flushing;
+    const batch = this.queue;
+    this.queue = [];
+    this.flushing = this.col.insertMany(batch, { ordered: false })
+      .catch((e) => {
+        this.stats.errors++;
+        // Per-document errors: those (not already written) wait; otherwise the
+        // whole batch does, and what did go in is a duplicate _id next time
+        const retry = e.writeErrors ? [].concat(e.writeErrors).filter(w => w.code !== 11000).map(w => batch[w.index]) : batch;
+        this.queue.unshift(...retry);
+        throw e;
+      })
+      .finally(() => { this.flushing = null; });
+    return this.flushing;
+  }
+
+  // -> { rate_hz, chunks, segments: [{ t0_ms, samples: Int16Array(3n) }] } of id over [from, to)
+  async read(id, from, to) {
+    const docs = await this.col.find({ id, start: { $gte: new Date(from - MAX_SPAN_MS), $lt: new Date(to) },
+                                       end: { $gt: new Date(from) } }).sort({ start: 1 }).toArray();
+    for (const d of this.queue) if (d.id === id && d.start < to && d.end > from) docs.push(d);
+    const o = this.open.get(id);
+    if (o?.runs.length) {
+      docs.push(chunkDoc(id, o.rateHz, o.runs.map(r => ({ t0_ms: r.t0_ms, samples: concat(r.parts, r.n) }))));
+    }
+    if (!docs.length) return { rate_hz: null, chunks: 0, segments: [] };
+    // One rate: the newest
+    const rateHz = docs.reduce((m, d) => (d.end > m.end ? d : m)).rate_hz;
+    const period = 1000 / rateHz;
+    const runs = mergeRuns(docs.filter(d => d.rate_hz === rateHz).flatMap(chunkRuns), period);
+    const segments = [];
+    for (const r of runs) {
+      const n = r.samples.length / 3;
+      const a = Math.max(0, Math.ceil((from - r.t0_ms) / period));
+      const b = Math.min(n, Math.ceil((to - r.t0_ms) / period));
+      if (a >= b) continue;
+      const t0 = r.t0_ms + a * period;
+      const part = r.samples.subarray(a * 3, b * 3);
+      const last = segments[segments.length - 1];
+      // Chunk boundaries split runs, not the stream
+      if (last && Math.abs(last.t0_ms + last.n * period - t0) <= period / 2) {
+        last.parts.push(part);
+        last.n += b - a;
+      } else {
+        segments.push({ t0_ms: t0, parts: [part], n: b - a });
+      }
+    }
+    return { rate_hz: rateHz, chunks: docs.length,
+             segments: segments.map(s => ({ t0_ms: s.t0_ms, samples: concat(s.parts, s.n) })) };
+  }
+
+  // Merge each device's consecutive small chunks
+  async compact(now = Date.now()) {
+    if (this.compacting) return;
+    this.compacting = true;
+    try {
+      const small = await this.col.find({ small: true, end: { $lt: new Date(now - SETTLE_MS) } })
+        .sort({ id: 1, start: 1 }).limit(COMPACT_BATCH).toArray();
+      const groups = [];
+      let g = null;
+      for (const d of small) {
+        const fits = g && g.id === d.id && g.rate_hz === d.rate_hz && g.n + d.n <= MERGE_SAMPLES &&
+                     d.end - g.start <= MAX_SPAN_MS;
+        if (!fits) groups.push(g = { id: d.id, rate_hz: d.rate_hz, start: d.start, n: 0, docs: [] });
+        g.n += d.n;
+        g.docs.push(d);
+      }
+      for (const grp of groups) {
+        if (grp.docs.length < 2) {
+          // Nothing left to merge it with
+          const d = grp.docs[0];
+          if (now - d.end > MAX_SPAN_MS) await this.col.updateOne({ _id: d._id }, { $set: { small: false } });
+          continue;
+        }
+        const runs = mergeRuns(grp.docs.flatMap(chunkRuns), 1000 / grp.rate_hz);
+        const merged = chunkDoc(grp.id, grp.rate_hz, runs);
+        await this.col.insertOne(merged);
+        await this.col.deleteMany({ _id: { $in: grp.docs.map(d => d._id) } });
+        this.stats.compactions++;
+        this.stats.merged += grp.docs.length;
+      }
+    } finally {
+      this.compacting = false;
+    }
+  }
+
+  metrics() {
+    return { open: this.open.size, queued: this.queue.length, ...this.stats,
+             ratio: this.stats.stored_bytes ? Math.round(this.stats.raw_bytes / this.stats.stored_bytes * 10) / 10 : null };
+  }
+}
+
+function concat(parts, n) {
+  if (parts.length === 1) return parts[0];
+  const out = new Int16Array(n * 3);
+  let at = 0;
+  for (const p of parts) {
+    out.set(p, at);
+    at += p.length;
+  }
+  return out;
+}
+
+module.exports = { StreamStore, packColumns, unpackColumns, mergeRuns, CHUNK_MS, MAX_SPAN_MS };
@@ -0,0 +1,124 @@
+// ── Tile cache ───────────────────────────────────────────────────
+// Computed tiles (spectrograms, lib/analysis.js) by key: an in-memory LRU
+// capped at maxBytes in front of one file per key under dir, capped at
+// diskBytes. get() tries memory, then disk; put() writes both, the file
+// through a temporary name and a rename, so a crash never leaves half a
+// tile behind. Disk is pruned oldest first (by mtime, touched on each disk
+// hit) once a put takes it over its cap. Keys must be safe file names.
+//
+// A tile is a Buffer. Whatever it depends on belongs in its key (the
+// waveform's tier, the parameters), so nothing is ever invalidated: a
+// changed input only asks for a new key and the old one ages out.
+
+const fs = require('fs');
+const path = require('path');
+
+class TileCache {
+  constructor(dir, { maxBytes = 32 * 1024 * 1024, diskBytes = 512 * 1024 * 1024 } = {}) {
+    this.dir = dir;
+    this.maxBytes = maxBytes;
+    this.diskBytes = diskBytes;
+    this.memory = new Map();   // key → Buffer, least recently used first
+    this.held = 0;
+    this.diskHeld = null;      // bytes under dir; counted on the first put
+    this.pending = new Map();  // key → Promise of the tile being computed
+    this.stats = { memory_hits: 0, disk_hits: 0, misses: 0, computed: 0, pruned: 0 };
+    fs.mkdirSync(dir, { recursive: true });
+  }
+
+  file(key) {
+    return path.join(this.dir, `${key}.bin`);
+  }
+
+  remember(key, tile) {
+    if (this.memory.has(key)) this.held -= this.memory.get(key).length;
+    this.memory.delete(key);
+    this.memory.set(key, tile);
+    this.held += tile.length;
+    for (const [old, t] of this.memory) {
+      if (this.held <= this.maxBytes || old === key) break;
+      this.memory.delete(old);
+      this.held -= t.length;
+    }
+  }
+
+  // -> Buffer or null
+  async get(key) {
+    const hit = this.memory.get(key);
+    if (hit) {
+      this.remember(key, hit);
+      this.stats.memory_hits++;
+      return hit;
+    }
+    try {
+      const tile = await fs.promises.readFile(this.file(key));
+      const now = new Date();
+      fs.promises.utimes(this.file(key), now, now).catch(() => {});
+      this.remember(key, tile);
+      this.stats.disk_hits++;
+      return tile;
+    } catch {
+      this.stats.misses++;
+      return null;
+    }
+  }
+
+  async put(key, tile) {
+    this.remember(key, tile);
+    const tmp = `${this.file(key)}.${process.pid}.tmp`;
+    await fs.promises.writeFile(tmp, tile);
+    await fs.promises.rename(tmp, this.file(key));
+    if (this.diskHeld == null) this.diskHeld = (await this.listing()).reduce((n, f) => n + f.size, 0);
+    else this.diskHeld += tile.length;
+    if (this.diskHeld > this.diskBytes) await this.prune();
+  }
+
+  // The cached tile, or compute() -> Buffer|null stored under key; one
+  // compute per key at a time however many ask
+  async through(key, compute) {
+    const hit = await this.get(key);
+    if (hit) return hit;
+    if (this.pending.has(key)) return this.pending.get(key);
+    const p = (async () => {
+      const tile = await compute();
+      if (tile) {
+        this.stats.computed++;
+        await this.put(key, tile);
+      }
+      return tile;
+    })().finally(() => this.pending.delete(key));
+    this.pending.set(key, p);
+    return p;
+  }
+
+  async listing() {
+    const out = [];
+    for (const name of await fs.promises.readdir(this.dir)) {
+      if (!name.endsWith('.bin')) continue;
+      try {
+        const st = await fs.promises.stat(path.join(this.dir, name));
+        out.push({ name, size: st.size, mtime: st.mtimeMs });
+      } catch {}
+    }
+    return out;
+  }
+
+  // Oldest files first until the directory is back to 90% of its cap
+  async prune() {
+    const files = (await this.listing()).sort((a, b) => a.mtime - b.mtime);
+    let held = files.reduce((n, f) => n + f.size, 0);
+    for (const f of files) {
+      if (held <= this.diskBytes * 0.9) break;
+      await fs.promises.unlink(path.join(this.dir, f.name)).catch(() => {});
+      held -= f.size;
+      this.stats.pruned++;
+    }
+    this.diskHeld = held;
+  }
+
+  metrics() {
+    return { memory_tiles: this.memory.size, memory_bytes: this.held, disk_bytes: this.diskHeld, ...this.stats };
+  }
+}
+
+module.exports = { TileCache };
@@ -0,0 +1,85 @@
+// ── HTTPS for the devices ────────────────────────────────────────
+// With TLS_CERT / TLS_KEY set the API is served over HTTPS instead of HTTP
+// (firmware built with -DSERVER_TLS=1, src/server_tls.h). The ESP8266 can
+// only afford a full handshake now and then, so:
+//  - sessions are resumed by ID. BearSSL offers no tickets, and Node leaves
+//    OpenSSL's own session cache off, so they are kept here: a Map in
+//    insertion order, oldest dropped past SESSION_MAX, expired after
+//    SESSION_TTL_MS. One entry per device is all it holds in practice; the
+//    devices share one session across their sockets.
+//  - the device asks for 512-byte fragments (max_fragment_length), which
+//    OpenSSL 1.1.1+ grants without being told
+// An ECDSA P-256 certificate makes the occasional full handshake several
+// times cheaper on the device than RSA-2048.
+
+const https = require('https');
+const fs = require('fs');
+
+const SESSION_TTL_MS = 24 * 60 * 60 * 1000;
+const SESSION_MAX = 256;
+
+class SessionCache {
+  constructor(max = SESSION_MAX, ttlMs = SESSION_TTL_MS) {
+    this.max = max;
+    this.ttlMs = ttlMs;
+    this.sessions = new Map();   // hex session id → { data, at }
+  }
+
+  set(id, data, now = Date.now()) {
+    const key = id.toString('hex');
+    this.sessions.delete(key);
+    this.sessions.set(key, { data, at: now });
+    while (this.sessions.size > this.max) this.sessions.delete(this.sessions.keys().next().value);
+  }
+
+  get(id, now = Date.now()) {
+    const key = id.toString('hex');
+    const entry = this.sessions.get(key);
+    if (!entry) return null;
+    if (now - entry.at > this.ttlMs) {
+      this.sessions.delete(key);
+      return null;
+    }
+    return entry.data;
+  }
+
+  get size() { return this.sessions.size; }
+}
+
+// -> https.Server for app with the session cache on it, and handshake counts
+// in server.handshakes { full, resumed }
+function createTlsServer(app, certPath, keyPath) {
+  const cache = new SessionCache();
+  const server = https.createServer({
+    cert: fs.readFileSync(certPath),
+    key: fs.readFileSync(keyPath),
+    sessionTimeout: SESSION_TTL_MS / 1000,
+  }, app);
+  server.sessionCache = cache;
+  server.handshakes = { full: 0, resumed: 0 };
+  server.on('newSession', (id, data, done) => {
+    cache.set(id, data);
+    done();
+  });
+  server.on('resumeSession', (id, done) => done(null, cache.get(id)));
+  server.on('secureConnection', (socket) => {
+    server.handshakes[socket.isSessionReused() ? 'resumed' : 'full']++;
+  });
+  return server;
+}
+
+// "tls=full,resumed,failures,full_avg_ms,resumed_avg_ms,mfln" off the heartbeat, or null
+function parseTlsQuery(query) {
+  if (typeof query.tls !== 'string') return null;
+  const v = query.tls.split(',').map(x => parseInt(x, 10));
+  if (v.length !== 6 || !v.every(Number.isFinite)) return null;
+  const [full, resumed, failures, fullMs, resumedMs, mfln] = v;
+  return {
+    full, resumed, failures,
+    full_avg_ms: fullMs || null,
+    resumed_avg_ms: resumedMs || null,
+    fragment_limited: mfln === 1,
+  };
+}
+
+module.exports = { SessionCache, createTlsServer, parseTlsQuery, SESSION_TTL_MS };
@@ -0,0 +1,32 @@
+// ── Helicorder trace decoder ─────────────────────────────────────
+// Heartbeats carry the device's 1Hz min/max/RMS summaries as query params
+// (layout documented in src/helicorder.h):
+//   trace        base64url, per second nine int16 LE: min xyz, max xyz, rms xyz (LSB)
+//   trace_age_ms ms between the first second's start and the request
+// Returned values are in g, the same units as event waveforms (to 1e-6 g, since
+// quiet-background RMS is only a few LSB).
+
+const SUMMARY_BYTES = 18;
+const SCALE = 16384;   // LSB per g at +/-2g
+const round6 = (v) => Math.round(v * 1e6) / 1e6;
+
+// -> { t0: Date, interval_ms, min: [[x,y,z], ...], max: [...], rms: [...] } or null
+function decodeTrace(query, now = Date.now()) {
+  if (typeof query.trace !== 'string' || !query.trace) return null;
+  const buf = Buffer.from(query.trace, 'base64url');
+  const n = Math.floor(buf.length / SUMMARY_BYTES);
+  if (n === 0) return null;
+  const age = Math.max(0, parseInt(query.trace_age_ms, 10) || 0);
+
+  const min = [], max = [], rms = [];
+  for (let k = 0; k < n; k++) {
+    const o = k * SUMMARY_BYTES;
+    const axis = (at) => [0, 1, 2].map(i => round6(buf.readInt16LE(o + at + i * 2) / SCALE));
+    min.push(axis(0));
+    max.push(axis(6));
+    rms.push(axis(12));
+  }
+  return { t0: new Date(now - age), interval_ms: 1000, min, max, rms };
+}
+
+module.exports = { decodeTrace };
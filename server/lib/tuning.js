@@ -0,0 +1,126 @@
+// ── Threshold tuning ─────────────────────────────────────────────
+// Each room has its own noise floor, so one global `minor` is too tight in
+// one and deaf in another. This learns each device's floor from the
+// helicorder seconds its heartbeats carry (lib/trace.js: de-biased, after
+// the detection filter, so what the trigger itself sees). Every second is
+// reduced to the peak the device's detect_metric would read and to its
+// vector RMS, and both go into streaming quantile sketches (lib/sketch.js). Nothing is
+// kept per sample or per second.
+//
+// Triggers are counted too, and those that ended up in a consensus cluster
+// (`corroborated`). A lone trigger is the closest thing to a false one we
+// can tell apart.
+//
+// propose() -> per device: the noise percentiles, the lone-trigger rate,
+// the minor threshold in effect and the one suggested:
+//   margin × p99.9 of the per-second peak, rounded up to 1 mg, kept below
+//   moderate. While lone triggers come faster than maxLonePerHour the
+//   suggestion is never lower than what is in effect, and at least
+//   raiseStep above it.
+// Nothing is suggested before minSeconds of trace. Applying a suggestion
+// is the server's business (devices[id].sensitivity.minor).
+//
+// The window is two halves of halfMs: the older one is dropped as a new
+// one starts, so estimates always cover between one and two halves. After a
+// restart the stored trace can be fed back in time order (addTrace with the
+// doc's t0); triggers then count from the restart.
+
+const { QuantileSketch } = require('./sketch');
+
+const PEAK_Q = 0.999;
+
+// The per-second peak a detect_metric would see, from per-axis min/max (g)
+function secondPeak(min, max, metric) {
+  const axis = (i) => Math.max(Math.abs(min[i]), Math.abs(max[i]));
+  switch (metric) {
+    case 'horizontal': return Math.max(axis(0), axis(1));
+    case 'vertical': return axis(2);
+    case 'vector': return Math.hypot(axis(0), axis(1), axis(2));   // the axes' peaks needn't coincide: an upper bound
+    default: return Math.max(axis(0), axis(1), axis(2));
+  }
+}
+
+const emptyHalf = (start) => ({ start, peak: new QuantileSketch(), rms: new QuantileSketch(), triggers: 0, corroborated: 0 });
+
+const round = (v, step) => Math.round(v / step) * step;
+const round6 = (v) => (v == null ? null : Math.round(v * 1e6) / 1e6);
+
+class ThresholdTuner {
+  constructor({ halfMs = 12 * 3600 * 1000, margin = 1.5, minSeconds = 6 * 3600,
+                maxLonePerHour = 2, raiseStep = 1.25 } = {}) {
+    this.halfMs = halfMs;
+    this.margin = margin;
+    this.minSeconds = minSeconds;
+    this.maxLonePerHour = maxLonePerHour;
+    this.raiseStep = raiseStep;
+    this.devices = new Map();   // id → { since, halves: [older, newer] }
+    this.startedAt = Date.now();   // triggers are only counted from here (seed() is trace only)
+  }
+
+  // A device quiet for a whole window starts over
+  halves(id, now = Date.now()) {
+    let d = this.devices.get(id);
+    if (!d || now - d.halves[1].start >= 2 * this.halfMs) {
+      this.devices.set(id, d = { since: now, halves: [emptyHalf(now - this.halfMs), emptyHalf(now)] });
+    } else if (now - d.halves[1].start >= this.halfMs) {
+      d.halves = [d.halves[1], emptyHalf(d.halves[1].start + this.halfMs)];
+    }
+    return d.halves;
+  }
+
+  // One heartbeat's trace ({ t0, min, max, rms }), read as metric would
+  addTrace(id, trace, metric, now = Date.now()) {
+    const h = this.halves(id, now)[1];
+    for (let k = 0; k < trace.min.length; k++) {
+      h.peak.add(secondPeak(trace.min[k], trace.max[k], metric));
+      h.rms.add(Math.hypot(...trace.rms[k]));
+    }
+  }
+
+  trigger(id, now = Date.now()) {
+    this.halves(id, now)[1].triggers++;
+  }
+
+  corroborated(id, now = Date.now()) {
+    this.halves(id, now)[1].corroborated++;
+  }
+
+  // -> { id: { seconds, noise, rms_p50, triggers, lone, lone_per_hour, minor, proposed } }
+  // sensitivityOf(id) -> the { minor, moderate } in effect for it
+  propose(sensitivityOf, now = Date.now()) {
+    const out = {};
+    for (const id of this.devices.keys()) {
+      const [older, newer] = this.halves(id, now);
+      const peak = new QuantileSketch().merge(older.peak).merge(newer.peak);
+      const rms = new QuantileSketch().merge(older.rms).merge(newer.rms);
+      const triggers = older.triggers + newer.triggers;
+      const lone = Math.max(0, triggers - older.corroborated - newer.corroborated);
+      const from = Math.max(older.start, this.devices.get(id).since, this.startedAt);
+      const hours = Math.max(1 / 60, (now - from) / 3600e3);
+      const lonePerHour = lone / hours;
+      const { minor, moderate } = sensitivityOf(id);
+
+      let proposed = null;
+      if (peak.count >= this.minSeconds) {
+        proposed = Math.ceil(this.margin * peak.quantile(PEAK_Q) * 1000) / 1000;
+        if (lonePerHour > this.maxLonePerHour && minor) proposed = Math.max(proposed, minor * this.raiseStep);
+        if (moderate) proposed = Math.min(proposed, moderate * 0.9);
+        proposed = round6(round(proposed, 0.001) || 0.001);
+      }
+      out[id] = {
+        seconds: peak.count,
+        noise: { p50: round6(peak.quantile(0.5)), p90: round6(peak.quantile(0.9)),
+                 p99: round6(peak.quantile(0.99)), p999: round6(peak.quantile(PEAK_Q)) },
+        rms_p50: round6(rms.quantile(0.5)),
+        triggers,
+        lone,
+        lone_per_hour: Math.round(lonePerHour * 100) / 100,
+        minor: minor ?? null,
+        proposed,
+      };
+    }
+    return out;
+  }
+}
+
+module.exports = { ThresholdTuner, secondPeak };
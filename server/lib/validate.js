@@ -0,0 +1,75 @@
+// ── Compiled validators ──────────────────────────────────────────
+// Device payloads are checked against the same shape thousands of times,
+// so the check is generated once per shape (new Function) instead of the
+// schema being walked per request. Shapes are a JSON Schema subset:
+//   type        'string' | 'number' | 'integer' | 'boolean' | 'object' |
+//               'array' | 'null', or an array of them
+//   required    property names (objects)
+//   properties  name → schema (objects); others are let through
+//   enum        allowed values
+//   minimum / maximum (numbers), maxLength (strings), maxItems / items (arrays)
+//
+// validator(schema) -> (value) => null, or what is wrong with it as a
+// message naming the property ('deltaG' must be number). 'number' means a
+// finite one.
+
+const TYPE_CHECKS = {
+  string: (v) => `typeof ${v} === 'string'`,
+  number: (v) => `(typeof ${v} === 'number' && Number.isFinite(${v}))`,
+  integer: (v) => `Number.isInteger(${v})`,
+  boolean: (v) => `typeof ${v} === 'boolean'`,
+  object: (v) => `(${v} !== null && typeof ${v} === 'object' && !Array.isArray(${v}))`,
+  array: (v) => `Array.isArray(${v})`,
+  null: (v) => `${v} === null`,
+};
+
+const types = (schema) => (schema.type == null ? [] : [].concat(schema.type));
+
+function validator(schema) {
+  const consts = [];
+  const lit = (value) => {
+    consts.push(value);
+    return `c[${consts.length - 1}]`;
+  };
+  let n = 0;
+
+  function emit(s, v, path) {
+    const name = path || 'body';
+    const fail = (why) => `return ${lit(`'${name}' ${why}`)};\n`;
+    let code = '';
+    const ts = types(s);
+    if (ts.length) {
+      for (const t of ts) if (!TYPE_CHECKS[t]) throw new Error(`validate: unknown type ${t}`);
+      code += `if (!(${ts.map(t => TYPE_CHECKS[t](v)).join(' || ')})) ${fail(`must be ${ts.join(' or ')}`)}`;
+    }
+    if (s.enum) code += `if (!${lit(new Set(s.enum))}.has(${v})) ${fail(`must be one of ${s.enum.join(', ')}`)}`;
+    if (s.minimum != null) code += `if (typeof ${v} === 'number' && ${v} < ${lit(s.minimum)}) ${fail(`must be >= ${s.minimum}`)}`;
+    if (s.maximum != null) code += `if (typeof ${v} === 'number' && ${v} > ${lit(s.maximum)}) ${fail(`must be <= ${s.maximum}`)}`;
+    if (s.maxLength != null) code += `if (typeof ${v} === 'string' && ${v}.length > ${lit(s.maxLength)}) ${fail(`longer than ${s.maxLength}`)}`;
+    if (s.maxItems != null) code += `if (Array.isArray(${v}) && ${v}.length > ${lit(s.maxItems)}) ${fail(`has more than ${s.maxItems} items`)}`;
+    if (s.items) {
+      const i = `i${n++}`;
+      const item = `v${n++}`;
+      code += `if (Array.isArray(${v})) for (let ${i} = 0; ${i} < ${v}.length; ${i}++) { const ${item} = ${v}[${i}];\n`
+        + emit(s.items, item, `${path}[]`) + '}\n';
+    }
+    if (s.required || s.properties) {
+      code += `if (${TYPE_CHECKS.object(v)}) {\n`;
+      for (const key of s.required || []) {
+        code += `if (${v}[${JSON.stringify(key)}] === undefined) return ${lit(`'${path ? `${path}.${key}` : key}' required`)};\n`;
+      }
+      for (const [key, sub] of Object.entries(s.properties || {})) {
+        const p = `v${n++}`;
+        code += `{ const ${p} = ${v}[${JSON.stringify(key)}];\nif (${p} !== undefined) {\n`
+          + emit(sub, p, path ? `${path}.${key}` : key) + '}}\n';
+      }
+      code += '}\n';
+    }
+    return code;
+  }
+
+  const body = emit(schema, 'value', '');
+  return new Function('c', `return function validate(value) {\n${body}return null;\n};`)(consts);
+}
+
+module.exports = { validator };
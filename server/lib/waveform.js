@@ -0,0 +1,895 @@
+// ── Waveform body decoders ───────────────────────────────────────
+// Devices POST /api/seismic either as JSON or as one of the compact
+// encodings below. Every decoder returns the same shape the JSON body has,
+// so the route handler and MongoDB documents don't care how it arrived:
+//   { id, level, trigger, deltaG, event_offset_ms, waveform: [[rel_ms, ax, ay, az], ...] }
+// (the binary decoders' waveform is a SampleBuffer of those rows)
+// plus gap_index / gap_samples when a FIFO overflow cut samples out of the
+// capture (rel_ms already jumps over the gap), retriggers: [rel_ms, ...]
+// when later triggers extended the capture, ranges: [[index, scale], ...]
+// when the device raised its accel range mid-capture, spectrum: { hz, amp_g,
+// dominant_hz } when the device ran its Goertzel bank over the capture, and
+// coherence (0..1) from a node with a second sensor. The binary bodies of
+// such a node also carry secondary: that sensor's [[rel_ms, ax, ay, az], ...].
+
+const zlib = require('zlib');
+const msgpack = require('./msgpack');
+
+const BINARY_CONTENT_TYPE = 'application/vnd.seismo.waveform';
+const MSGPACK_CONTENT_TYPE = 'application/msgpack';
+const DELTA_CONTENT_TYPE = 'application/vnd.seismo.waveform-delta';
+const BINARY_MAGIC = 'SWV1';
+const DELTA_MAGIC = 'SWD1';
+const BINARY_GAP_MAGIC = 'SWV2';   // same, with gap_index / gap_samples appended to the header
+const DELTA_GAP_MAGIC = 'SWD2';
+const BINARY_RETRIGGER_MAGIC = 'SWV3';   // gap fields, then uint8 count + int32 ms per retrigger
+const DELTA_RETRIGGER_MAGIC = 'SWD3';
+const BINARY_RANGE_MAGIC = 'SWV4';   // SWV3 fields, then uint8 count + (uint16 index, float32 scale) per block
+const DELTA_RANGE_MAGIC = 'SWD4';
+const BINARY_HEADER_SIZE = 44;
+const BINARY_GAP_HEADER_SIZE = 48;
+const BINARY_RETRIGGER_HEADER_SIZE = 49;   // before the retrigger times
+const SPECTRUM_MAGIC = 'SPC1';             // optional trailer after the samples
+const DUAL_MAGIC = 'DUA1';                 // optional second-sensor trailer, after SPC1 if both
+const LEVELS = ['minor', 'moderate', 'severe'];
+const TRIGGERS = ['threshold', 'sta_lta', 'pull'];   // header byte 11; older firmware sends 0
+
+// Body encodings the server understands, advertised to devices in /api/init
+// in order of preference (devices take the first one they support)
+const UPLOAD_FORMATS = ['delta', 'binary', 'msgpack', 'json'];
+
+const round4 = (v) => Math.round(v * 10000) / 10000;
+
+function formatMac(buf, offset) {
+  const parts = [];
+  for (let i = 0; i < 6; i++) parts.push(buf[offset + i].toString(16).padStart(2, '0').toUpperCase());
+  return parts.join(':');
+}
+
+// Layout documented in src/waveform_stream.h (WaveformBinaryStream).
+// 'SWD1' bodies carry zigzag varint deltas instead of raw int16 triplets;
+// 'SWV2' / 'SWD2' add a FIFO gap marker to the header, 'SWV3' / 'SWD3' the
+// gap marker plus retrigger times, 'SWV4' / 'SWD4' all that plus the accel
+// range blocks.
+function decodeBinary(buf) {
+  const h = binaryHeader(buf);
+  if (!h) throw new Error('truncated binary waveform');
+  let samples = buf.subarray(h.size);
+  let trailer = samples.subarray(h.count * 6);
+  if (h.delta) ({ samples, rest: trailer } = undeltaSamples(samples, h.count));
+  if (samples.length < h.count * 6) throw new Error('truncated binary waveform');
+  return finishBinary(h, samples, trailer);
+}
+
+// A binary body's header fields, size being where its samples start; null
+// while buf doesn't hold all of it yet
+function binaryHeader(buf) {
+  if (buf.length < 4) return null;
+  const magic = buf.toString('latin1', 0, 4);
+  if (![BINARY_MAGIC, DELTA_MAGIC, BINARY_GAP_MAGIC, DELTA_GAP_MAGIC,
+    BINARY_RETRIGGER_MAGIC, DELTA_RETRIGGER_MAGIC, BINARY_RANGE_MAGIC, DELTA_RANGE_MAGIC].includes(magic)) {
+    throw new Error('bad binary waveform header');
+  }
+  const hasRanges = magic === BINARY_RANGE_MAGIC || magic === DELTA_RANGE_MAGIC;
+  const hasRetriggers = hasRanges || magic === BINARY_RETRIGGER_MAGIC || magic === DELTA_RETRIGGER_MAGIC;
+  const hasGap = hasRetriggers || magic === BINARY_GAP_MAGIC || magic === DELTA_GAP_MAGIC;
+  let headerSize = hasRetriggers ? BINARY_RETRIGGER_HEADER_SIZE
+    : hasGap ? BINARY_GAP_HEADER_SIZE : BINARY_HEADER_SIZE;
+  if (buf.length < headerSize) return null;
+  const retriggers = [];
+  if (hasRetriggers) {
+    const n = buf.readUInt8(48);
+    headerSize += n * 4;
+    if (buf.length < headerSize) return null;
+    for (let i = 0; i < n; i++) retriggers.push(buf.readInt32LE(49 + i * 4));
+  }
+  const ranges = [];
+  if (hasRanges) {
+    if (buf.length < headerSize + 1) return null;
+    const k = buf.readUInt8(headerSize);
+    const at = headerSize + 1;
+    headerSize = at + k * 6;
+    if (buf.length < headerSize) return null;
+    for (let b = 0; b < k; b++) ranges.push([buf.readUInt16LE(at + b * 6), buf.readFloatLE(at + b * 6 + 2)]);
+  }
+  const level = LEVELS[buf.readUInt8(10)];
+  if (!level) throw new Error('bad level code');
+  const h = {
+    size: headerSize,
+    delta: magic[2] === 'D',
+    id: formatMac(buf, 4),
+    level,
+    trigger: TRIGGERS[buf.readUInt8(11)] || 'threshold',
+    deltaG: buf.readFloatLE(12),
+    bias: [buf.readFloatLE(16), buf.readFloatLE(20), buf.readFloatLE(24)],
+    scale: buf.readFloatLE(28),
+    sampleRateHz: buf.readUInt16LE(32),
+    count: buf.readUInt16LE(34),
+    t0: buf.readInt32LE(36),
+    eventOffsetMs: buf.readUInt32LE(40),
+    gap: hasGap ? { index: buf.readUInt16LE(44), samples: buf.readUInt16LE(46) } : null,
+    retriggers,
+    ranges,
+  };
+  if (!h.sampleRateHz || !h.scale) throw new Error('bad sample rate or scale');
+  return h;
+}
+
+// Parsed header + its count packed int16 x/y/z samples + whatever followed
+// them (the SPC1 / DUA1 trailers) → the decoded body
+function finishBinary(h, samples, trailer) {
+  const spectrum = decodeSpectrumTrailer(trailer);
+  if (spectrum) trailer = trailer.subarray(6 + spectrum.hz.length * 5);
+  const dual = decodeDualTrailer(trailer, samples, h.count);
+  const result = withExtras({
+    id: h.id,
+    level: h.level,
+    trigger: h.trigger,
+    deltaG: round4(h.deltaG),
+    event_offset_ms: h.eventOffsetMs,
+    sample_rate_hz: h.sampleRateHz,
+    waveform: unpackSamples(samples, h.count, h.t0, h.sampleRateHz, h.bias, h.scale, h.gap, h.ranges),
+  }, h.gap, h.retriggers, spectrum, h.ranges);
+  if (dual) {
+    result.coherence = dual.coherence;
+    result.secondary = unpackSamples(dual.samples, h.count, h.t0, h.sampleRateHz, dual.bias, h.scale, h.gap, h.ranges);
+  }
+  return result;
+}
+
+// "SPC1" trailer (src/waveform_stream.h) → { hz, amp_g, dominant_hz } or null
+function decodeSpectrumTrailer(buf) {
+  if (buf.length < 6 || buf.toString('latin1', 0, 4) !== SPECTRUM_MAGIC) return null;
+  const n = buf.readUInt8(4);
+  if (buf.length < 6 + n * 5) return null;
+  const hz = [...buf.subarray(6, 6 + n)];
+  const amp = [];
+  for (let b = 0; b < n; b++) amp.push(buf.readFloatLE(6 + n + b * 4));
+  return { hz, amp_g: amp, dominant_hz: hz[buf.readUInt8(5)] };
+}
+
+// "DUA1" trailer → { coherence, bias, samples } with the second sensor's
+// packed int16 x/y/z rebuilt from the first's; null if absent or cut short
+function decodeDualTrailer(buf, primary, count) {
+  if (buf.length < 20 || buf.toString('latin1', 0, 4) !== DUAL_MAGIC) return null;
+  let diffs;
+  try {
+    ({ values: diffs } = undeltaValues(buf.subarray(20), count));
+  } catch {
+    return null;
+  }
+  const samples = Buffer.alloc(count * 6);
+  for (let i = 0; i < count * 3; i++) {
+    const v = primary.readInt16LE(i * 2) + diffs[i];
+    samples.writeInt16LE(Math.max(-32768, Math.min(32767, v)), i * 2);
+  }
+  return {
+    coherence: Math.round(Math.max(0, Math.min(1, buf.readFloatLE(4))) * 1000) / 1000,
+    bias: [buf.readFloatLE(8), buf.readFloatLE(12), buf.readFloatLE(16)],
+    samples,
+  };
+}
+
+// Bins with finite numbers only, amplitudes to 1e-6 g
+function cleanSpectrum(sp) {
+  if (!sp || !Array.isArray(sp.hz) || !Array.isArray(sp.amp_g) || sp.hz.length !== sp.amp_g.length) return null;
+  const hz = sp.hz.map(Number), amp = sp.amp_g.map(Number);
+  if (!hz.length || ![...hz, ...amp].every(Number.isFinite)) return null;
+  const dominant = Number(sp.dominant_hz);
+  return {
+    hz,
+    amp_g: amp.map(v => Math.round(v * 1e6) / 1e6),
+    dominant_hz: Number.isFinite(dominant) ? dominant : hz[amp.indexOf(Math.max(...amp))],
+  };
+}
+
+// [[index, scale], ...] with valid numbers, in index order; null if none
+function cleanRanges(ranges) {
+  if (!Array.isArray(ranges)) return null;
+  const out = ranges
+    .filter(r => Array.isArray(r) && r.length === 2 && Number.isFinite(Number(r[0])) && Number(r[1]) > 0)
+    .map(r => [Number(r[0]), Number(r[1])])
+    .sort((a, b) => a[0] - b[0]);
+  return out.length ? out : null;
+}
+
+function withExtras(result, gap, retriggers, spectrum, ranges) {
+  if (gap && gap.samples > 0) {
+    result.gap_index = gap.index;
+    result.gap_samples = gap.samples;
+  }
+  if (Array.isArray(retriggers) && retriggers.length) result.retriggers = retriggers;
+  const rg = cleanRanges(ranges);
+  if (rg) result.ranges = rg;
+  const sp = cleanSpectrum(spectrum);
+  if (sp) result.spectrum = sp;
+  return result;
+}
+
+// Zigzag LEB128 varint deltas → packed little-endian int16 x/y/z, plus
+// whatever follows the last sample
+function undeltaSamples(buf, count) {
+  const { values, rest } = undeltaValues(buf, count);
+  const out = Buffer.alloc(count * 6);
+  for (let i = 0; i < count * 3; i++) out.writeInt16LE(values[i], i * 2);
+  return { samples: out, rest };
+}
+
+// The same deltas summed into count × x, y, z int32, which the DUA1
+// differences need (they span 17 bits)
+function undeltaValues(buf, count) {
+  const out = new Int32Array(count * 3);
+  let pos = 0;
+  const prev = [0, 0, 0];
+  const varint = () => {
+    let v = 0, shift = 0, b;
+    do {
+      if (pos >= buf.length) throw new Error('truncated delta waveform');
+      b = buf[pos++];
+      v |= (b & 0x7f) << shift;
+      shift += 7;
+    } while (b & 0x80 && shift < 35);
+    return (v >>> 1) ^ -(v & 1);
+  };
+  for (let i = 0; i < count; i++) {
+    for (let axis = 0; axis < 3; axis++) {
+      prev[axis] += varint();
+      out[i * 3 + axis] = prev[axis];
+    }
+  }
+  return { values: out, rest: buf.subarray(pos) };
+}
+
+// [[rel_ms, ax, ay, az], ...] rows held as count × int32 rel_ms and count ×
+// 3 float64 g rather than an array per sample. length and row(i) stand in
+// for the array's; toJSON() gives the array back.
+class SampleBuffer {
+  constructor(count, t = new Int32Array(count), g = new Float64Array(count * 3)) {
+    this.t = t;
+    this.g = g;
+  }
+
+  get length() { return this.t.length; }
+
+  row(i) { return [this.t[i], this.g[i * 3], this.g[i * 3 + 1], this.g[i * 3 + 2]]; }
+
+  toJSON() { return Array.from({ length: this.length }, (_, i) => this.row(i)); }
+}
+
+// A body's waveform (or secondary) holding at least one sample, in either form
+function hasSamples(wave) {
+  return (Array.isArray(wave) || wave instanceof SampleBuffer) && wave.length > 0;
+}
+
+// Packed little-endian int16 x/y/z triplets → SampleBuffer of [rel_ms, ax, ay, az]
+// Samples from gap.index on are gap.samples periods later than their index says.
+// Each [index, scale] range block's samples, up to the next block, are raw
+// LSB at that scale; the bias is always in header-scale LSB.
+function unpackSamples(buf, count, t0, sampleRateHz, bias, scale, gap = null, ranges = null) {
+  const blocks = cleanRanges(ranges) || [];
+  const out = new SampleBuffer(count);
+  let block = -1, k = 1;
+  for (let i = 0, off = 0; i < count; i++, off += 6) {
+    while (block + 1 < blocks.length && blocks[block + 1][0] <= i) k = scale / blocks[++block][1];
+    const slot = gap && i >= gap.index ? i + gap.samples : i;
+    out.t[i] = t0 + Math.round(slot * 1000 / sampleRateHz);
+    out.g[i * 3] = round4((buf.readInt16LE(off) * k - bias[0]) / scale);
+    out.g[i * 3 + 1] = round4((buf.readInt16LE(off + 2) * k - bias[1]) / scale);
+    out.g[i * 3 + 2] = round4((buf.readInt16LE(off + 4) * k - bias[2]) / scale);
+  }
+  return out;
+}
+
+// MessagePack map from WaveformMsgPackStream (src/waveform_stream.h)
+function decodeMsgPack(buf) {
+  const m = msgpack.decode(buf);
+  if (!m || typeof m !== 'object' || !Buffer.isBuffer(m.samples)) throw new Error('bad msgpack waveform');
+  const bias = Array.isArray(m.bias) && m.bias.length === 3 ? m.bias : [0, 0, 0];
+  if (!m.sample_rate_hz || !m.scale) throw new Error('bad sample rate or scale');
+  const count = Math.floor(m.samples.length / 6);
+  const gap = m.gap_samples > 0 ? { index: m.gap_index || 0, samples: m.gap_samples } : null;
+  const result = withExtras({
+    id: m.id,
+    level: m.level,
+    trigger: m.trigger || 'threshold',
+    deltaG: round4(m.deltaG),
+    event_offset_ms: m.event_offset_ms,
+    sample_rate_hz: m.sample_rate_hz,
+    waveform: unpackSamples(m.samples, count, m.t0_ms || 0, m.sample_rate_hz, bias, m.scale, gap, m.ranges),
+  }, gap, m.retriggers, m.spectrum, m.ranges);
+  if (Number.isFinite(m.coherence)) result.coherence = m.coherence;
+  return result;
+}
+
+// Decode a raw request body by content type; JSON bodies are already parsed
+function decodeWaveformBody(contentType, body) {
+  if (!Buffer.isBuffer(body)) return body;
+  if ((contentType || '').startsWith(BINARY_CONTENT_TYPE)) return decodeBinary(body);  // incl. -delta
+  if ((contentType || '').startsWith(MSGPACK_CONTENT_TYPE)) return decodeMsgPack(body);
+  throw new Error(`unsupported content type ${contentType}`);
+}
+
+// ── Streamed bodies ──────────────────────────────────────────────
+// POST /api/seismic bodies are decoded as they arrive instead of being
+// buffered whole first. A binary body's header is held until it's complete,
+// then its samples go straight into the packed int16 buffer finishBinary
+// takes (undeltaed on the way for SWD*); a JSON body's top-level waveform and
+// secondary rows go straight into SampleBuffers. The rest of a body (the
+// trailers, the JSON fields around the rows, a whole msgpack body, which has
+// no incremental decoder) is small and is kept as it comes.
+//
+// A body may take bodyBudget() bytes for its device's capture window, rather
+// than one limit for every device: a 500 Hz node with a 60 s max_post_ms
+// sends far more than a 100 Hz one.
+
+const JSON_CONTENT_TYPE = 'application/json';
+const ROW_KEYS = ['waveform', 'secondary'];
+const BODY_FLOOR = 50 * 1024;     // what every body used to be held to
+const BODY_SLACK = 16 * 1024;     // headers, trailers, spectrum, JSON fields
+// Worst case per sample, both sensors: int16 x/y/z or three varints of up to
+// 3 bytes, plus the DUA1 varint differences; a JSON row is ~36 characters
+const BYTES_PER_SAMPLE = { delta: 18, binary: 15, msgpack: 12, json: 80 };
+
+// 'delta' / 'binary' / 'msgpack' / 'json' for a Content-Type, else null
+function bodyEncoding(contentType) {
+  const type = (contentType || '').split(';')[0].trim();
+  if (type === DELTA_CONTENT_TYPE) return 'delta';
+  if (type === BINARY_CONTENT_TYPE) return 'binary';
+  if (type === MSGPACK_CONTENT_TYPE) return 'msgpack';
+  if (type === JSON_CONTENT_TYPE) return 'json';
+  return null;
+}
+
+// Byte limit for a body of that encoding carrying captureMs at sampleRateHz
+function bodyBudget(encoding, sampleRateHz, captureMs) {
+  const samples = Math.ceil(sampleRateHz * captureMs / 1000) + 1;
+  return Math.max(BODY_FLOOR, BODY_SLACK + samples * (BYTES_PER_SAMPLE[encoding] || BYTES_PER_SAMPLE.json));
+}
+
+const isSpace = (b) => b === 0x20 || b === 0x0a || b === 0x0d || b === 0x09;
+// What a number, true, false or null is spelled with
+const isScalar = (b) => (b >= 0x30 && b <= 0x39) || (b >= 0x61 && b <= 0x7a) || b === 0x2d || b === 0x2b
+  || b === 0x2e || b === 0x45;
+
+// rows of [rel_ms, ax, ay, az] appended one at a time, grown by doubling
+class RowCollector {
+  constructor() {
+    this.n = 0;
+    this.t = new Int32Array(256);
+    this.g = new Float64Array(256 * 3);
+  }
+
+  push(row) {
+    if (this.n === this.t.length) {
+      const t = new Int32Array(this.n * 2), g = new Float64Array(this.n * 6);
+      t.set(this.t);
+      g.set(this.g);
+      this.t = t;
+      this.g = g;
+    }
+    this.t[this.n] = Math.round(row[0]);
+    this.g.set([row[1], row[2], row[3]], this.n * 3);
+    this.n++;
+  }
+
+  finish() {
+    return new SampleBuffer(this.n, this.t.subarray(0, this.n), this.g.subarray(0, this.n * 3));
+  }
+}
+
+// Incremental JSON.parse of a body. Strings and scalars are cut out as raw
+// bytes (across chunks if need be) and handed to JSON.parse, so escapes and
+// number syntax are its; the structure is checked here frame by frame. id is
+// the top-level "id" as soon as it's been read.
+class JsonBodyParser {
+  constructor() {
+    this.stack = [];       // { kind: 'object' | 'array' | 'rows' | 'row', value, key, want }
+    this.root = undefined;
+    this.done = false;
+    this.id = null;
+    this.parts = null;     // raw bytes of the string or scalar being read
+    this.inString = false;
+    this.escape = false;
+  }
+
+  write(chunk) {
+    let i = 0;
+    while (i < chunk.length) {
+      if (this.inString) {
+        let j = i;
+        for (; j < chunk.length; j++) {
+          const b = chunk[j];
+          if (this.escape) this.escape = false;
+          else if (b === 0x5c) this.escape = true;
+          else if (b === 0x22) break;
+        }
+        if (j === chunk.length) {
+          this.parts.push(chunk.subarray(i));
+          return;
+        }
+        this.parts.push(chunk.subarray(i, j + 1));
+        this.inString = false;
+        this.take(true);
+        i = j + 1;
+      } else if (this.parts) {
+        let j = i;
+        while (j < chunk.length && isScalar(chunk[j])) j++;
+        this.parts.push(chunk.subarray(i, j));
+        if (j === chunk.length) return;
+        this.take(false);
+        i = j;
+      } else {
+        const b = chunk[i];
+        if (b === 0x22) {
+          this.parts = [chunk.subarray(i, i + 1)];
+          this.inString = true;
+          i++;
+        } else if (isScalar(b)) {
+          this.parts = [];
+        } else {
+          if (!isSpace(b)) this.punct(b);
+          i++;
+        }
+      }
+    }
+  }
+
+  end() {
+    if (this.inString) throw new Error('Unterminated string in JSON');
+    if (this.parts) this.take(false);
+    if (!this.done) throw new Error('Unexpected end of JSON input');
+    return this.root;
+  }
+
+  take(isString) {
+    const text = Buffer.concat(this.parts).toString('utf8');
+    this.parts = null;
+    let v;
+    try {
+      v = JSON.parse(text);
+    } catch {
+      throw new Error(`Unexpected token ${text.slice(0, 16)} in JSON`);
+    }
+    const top = this.stack[this.stack.length - 1];
+    if (isString && top?.kind === 'object' && (top.want === 'first' || top.want === 'key')) {
+      top.key = v;
+      top.want = 'colon';
+      return;
+    }
+    this.value(v);
+  }
+
+  // Whether the frame on top (or the empty stack) takes a value now
+  expectValue() {
+    if (this.done) throw new Error('Unexpected data after JSON');
+    const top = this.stack[this.stack.length - 1];
+    if (!top) return null;
+    if (top.want === 'value' || (top.want === 'first' && top.kind !== 'object')) return top;
+    throw new Error('Unexpected value in JSON');
+  }
+
+  value(v) {
+    const top = this.expectValue();
+    if (!top) {
+      this.root = v;
+      this.done = true;
+      return;
+    }
+    if (top.kind === 'rows') throw new Error('waveform rows must be [rel_ms, ax, ay, az]');
+    if (top.kind === 'row' && typeof v !== 'number') throw new Error('waveform values must be numbers');
+    if (top.kind === 'object') {
+      top.value[top.key] = v;
+      if (this.stack.length === 1 && top.key === 'id' && typeof v === 'string') this.id = v;
+    } else {
+      top.value.push(v);
+    }
+    top.want = 'next';
+  }
+
+  punct(b) {
+    const top = this.stack[this.stack.length - 1];
+    if (b === 0x7b || b === 0x5b) {   // { [
+      this.expectValue();
+      let kind = b === 0x7b ? 'object' : 'array';
+      if (kind === 'array' && this.stack.length === 1 && ROW_KEYS.includes(top.key)) kind = 'rows';
+      else if (kind === 'array' && top?.kind === 'rows') kind = 'row';
+      else if (top?.kind === 'rows' || top?.kind === 'row') throw new Error('waveform rows must be [rel_ms, ax, ay, az]');
+      const value = kind === 'object' ? {} : kind === 'rows' ? new RowCollector() : [];
+      this.stack.push({ kind, value, key: null, want: 'first' });
+    } else if (b === 0x7d || b === 0x5d) {   // } ]
+      const closes = b === 0x7d ? top?.kind === 'object' : top && top.kind !== 'object';
+      if (!closes || (top.want !== 'first' && top.want !== 'next')) throw new Error('Unexpected close in JSON');
+      this.stack.pop();
+      if (top.kind === 'row') {
+        if (top.value.length !== 4) throw new Error('waveform rows must be [rel_ms, ax, ay, az]');
+        const rows = this.stack[this.stack.length - 1];
+        rows.value.push(top.value);
+        rows.want = 'next';
+      } else {
+        this.value(top.kind === 'rows' ? top.value.finish() : top.value);
+      }
+    } else if (b === 0x3a && top?.kind === 'object' && top.want === 'colon') {   // :
+      top.want = 'value';
+    } else if (b === 0x2c && top?.want === 'next') {   // ,
+      top.want = top.kind === 'object' ? 'key' : 'value';
+    } else {
+      throw new Error(`Unexpected ${String.fromCharCode(b)} in JSON`);
+    }
+  }
+}
+
+// One body, written chunk by chunk; end() → what decodeWaveformBody would
+// have returned for the whole of it. id is the device's once it's known.
+class WaveformDecoder {
+  constructor(contentType) {
+    this.encoding = bodyEncoding(contentType);
+    if (!this.encoding) throw new Error(`unsupported content type ${contentType}`);
+    this.id = null;
+    this.json = this.encoding === 'json' ? new JsonBodyParser() : null;
+    this.chunks = [];        // msgpack body, the binary header so far, then the trailer
+    this.header = null;
+    this.samples = null;
+    this.filled = 0;         // sample bytes (raw) or values (delta) so far
+    this.varint = 0;
+    this.shift = 0;
+    this.prev = [0, 0, 0];
+  }
+
+  write(chunk) {
+    if (this.json) {
+      this.json.write(chunk);
+      this.id = this.json.id;
+      return;
+    }
+    if (this.encoding === 'msgpack' || this.samples && this.sampled()) {
+      this.chunks.push(chunk);
+      return;
+    }
+    if (!this.header) {
+      this.chunks.push(chunk);
+      const head = Buffer.concat(this.chunks);
+      this.chunks = [head];
+      this.header = binaryHeader(head);
+      if (!this.header) return;
+      this.id = this.header.id;
+      this.samples = Buffer.alloc(this.header.count * 6);
+      this.chunks = [];
+      chunk = head.subarray(this.header.size);
+    }
+    const used = this.header.delta ? this.undelta(chunk) : this.copy(chunk);
+    if (used < chunk.length) this.chunks.push(chunk.subarray(used));
+  }
+
+  sampled() {
+    return this.filled >= (this.header.delta ? this.header.count * 3 : this.samples.length);
+  }
+
+  copy(chunk) {
+    const n = Math.min(chunk.length, this.samples.length - this.filled);
+    chunk.copy(this.samples, this.filled, 0, n);
+    this.filled += n;
+    return n;
+  }
+
+  // The same zigzag LEB128 deltas undeltaValues reads, a byte at a time
+  undelta(chunk) {
+    const total = this.header.count * 3;
+    let pos = 0;
+    while (pos < chunk.length && this.filled < total) {
+      const b = chunk[pos++];
+      this.varint |= (b & 0x7f) << this.shift;
+      this.shift += 7;
+      if (b & 0x80 && this.shift < 35) continue;
+      const axis = this.filled % 3;
+      this.prev[axis] += (this.varint >>> 1) ^ -(this.varint & 1);
+      this.samples.writeInt16LE(this.prev[axis], this.filled * 2);
+      this.filled++;
+      this.varint = 0;
+      this.shift = 0;
+    }
+    return pos;
+  }
+
+  end() {
+    if (this.json) return this.json.end();
+    const rest = Buffer.concat(this.chunks);
+    if (this.encoding === 'msgpack') return decodeMsgPack(rest);
+    if (!this.header) throw new Error('truncated binary waveform');
+    if (!this.sampled()) throw new Error(this.header.delta ? 'truncated delta waveform' : 'truncated binary waveform');
+    return finishBinary(this.header, this.samples, rest);
+  }
+}
+
+// Read and decode req's body as it streams in → Promise of the decoded body.
+// budget(id) is the byte limit for device id, or for one not known yet (null).
+// Rejects with err.status 413 past the limit, 400 for a body that doesn't
+// decode; either way only once the rest of the body has been read and
+// dropped, since the device only looks for an answer after it's sent it all.
+function readWaveformBody(req, budget) {
+  const fail = (status, message) => Object.assign(new Error(message), { status });
+  return new Promise((resolve, reject) => {
+    let decoder = null, failure = null, bytes = 0;
+    try {
+      decoder = new WaveformDecoder(req.headers['content-type']);
+    } catch (e) {
+      failure = fail(400, e.message);
+    }
+    const declared = Number(req.headers['content-length']);
+    if (!failure && declared > budget(null)) failure = fail(413, `Body over ${budget(null)} bytes`);
+    req.on('data', (chunk) => {
+      if (failure) return;
+      bytes += chunk.length;
+      const limit = budget(decoder.id);
+      if (bytes > limit) {
+        failure = fail(413, `Body over ${limit} bytes`);
+        return;
+      }
+      try {
+        decoder.write(chunk);
+      } catch (e) {
+        failure = fail(400, e.message);
+      }
+    });
+    req.on('end', () => {
+      if (failure) return reject(failure);
+      try {
+        resolve(decoder.end());
+      } catch (e) {
+        reject(fail(400, e.message));
+      }
+    });
+    req.on('error', reject);
+  });
+}
+
+// ── Stored form ──────────────────────────────────────────────────
+// Waveforms live in their own collection, not in the event documents the
+// dashboard lists: { _id: event _id, id, count, scale, t, samples }, where
+// t is count × int32 LE rel_ms and samples count × int16 LE x,y,z in units
+// of 1/scale g. scale starts at the sensor's 16384 LSB/g (so nothing below
+// the rounding the decoders already apply is lost) and halves until the
+// largest |value| fits int16. 10 bytes a sample instead of a BSON array of
+// four doubles.
+const STORE_SCALE = 16384;
+
+// [[rel_ms, ax, ay, az], ...] or a SampleBuffer → { count, scale, t, samples }
+function packWaveform(wave) {
+  if (wave instanceof SampleBuffer) return packSampleBuffer(wave);
+  const count = wave.length;
+  let peak = 0;
+  for (const s of wave) peak = Math.max(peak, Math.abs(s[1]), Math.abs(s[2]), Math.abs(s[3]));
+  let scale = STORE_SCALE;
+  while (scale > 1 && peak * scale > 32767) scale /= 2;
+  const t = Buffer.alloc(count * 4);
+  const samples = Buffer.alloc(count * 6);
+  for (let i = 0; i < count; i++) {
+    const s = wave[i];
+    t.writeInt32LE(Math.round(s[0]), i * 4);
+    for (let axis = 0; axis < 3; axis++) {
+      const v = Math.max(-32768, Math.min(32767, Math.round(s[axis + 1] * scale)));
+      samples.writeInt16LE(v, i * 6 + axis * 2);
+    }
+  }
+  return { count, scale, t, samples };
+}
+
+function packSampleBuffer(wave) {
+  const count = wave.length;
+  let peak = 0;
+  for (let i = 0; i < wave.g.length; i++) peak = Math.max(peak, Math.abs(wave.g[i]));
+  let scale = STORE_SCALE;
+  while (scale > 1 && peak * scale > 32767) scale /= 2;
+  const t = Buffer.alloc(count * 4);
+  const samples = Buffer.alloc(count * 6);
+  for (let i = 0; i < count; i++) t.writeInt32LE(wave.t[i], i * 4);
+  for (let i = 0; i < count * 3; i++) {
+    samples.writeInt16LE(Math.max(-32768, Math.min(32767, Math.round(wave.g[i] * scale))), i * 2);
+  }
+  return { count, scale, t, samples };
+}
+
+// t and samples of a stored waveform as Buffers, whether they're plain
+// Buffers, the Binary the driver hands back or archived (t_z / samples_z)
+const asBuffer = (b) => Buffer.isBuffer(b) ? b : Buffer.from(b.buffer);
+function storedBuffers(doc) {
+  return {
+    t: doc.t_z ? unarchiveSteps(asBuffer(doc.t_z), 4) : asBuffer(doc.t),
+    samples: doc.samples_z ? unarchiveSteps(asBuffer(doc.samples_z), 2, 3) : asBuffer(doc.samples),
+  };
+}
+
+// Archived waveforms (lib/retention.js) hold t and samples raw-deflated as
+// steps from the previous value (per axis for samples): a steady sample
+// rate is one repeated int32 and a quiet sensor mostly small int16s, which
+// deflate packs far tighter than the values. Lossless; int16 steps wrap.
+function archiveSteps(buf, width, stride = 1) {
+  const out = Buffer.alloc(buf.length);
+  const read = width === 4 ? 'readInt32LE' : 'readInt16LE';
+  const write = width === 4 ? 'writeInt32LE' : 'writeInt16LE';
+  const wrap = width === 4 ? (v) => v | 0 : (v) => (v << 16) >> 16;
+  const prev = new Array(stride).fill(0);
+  for (let i = 0, n = buf.length / width; i < n; i++) {
+    const v = buf[read](i * width);
+    out[write](wrap(v - prev[i % stride]), i * width);
+    prev[i % stride] = v;
+  }
+  return zlib.deflateRawSync(out, { level: 9 });
+}
+
+function unarchiveSteps(z, width, stride = 1) {
+  const buf = zlib.inflateRawSync(z);
+  const read = width === 4 ? 'readInt32LE' : 'readInt16LE';
+  const write = width === 4 ? 'writeInt32LE' : 'writeInt16LE';
+  const wrap = width === 4 ? (v) => v | 0 : (v) => (v << 16) >> 16;
+  const prev = new Array(stride).fill(0);
+  for (let i = 0, n = buf.length / width; i < n; i++) {
+    const v = wrap(prev[i % stride] + buf[read](i * width));
+    buf[write](v, i * width);
+    prev[i % stride] = v;
+  }
+  return buf;
+}
+
+// Stored form → the $set / $unset that archive it in place, secondary too
+function archiveWaveform(doc) {
+  const set = {
+    t_z: archiveSteps(asBuffer(doc.t), 4),
+    samples_z: archiveSteps(asBuffer(doc.samples), 2, 3),
+  };
+  const unset = { t: '', samples: '' };
+  if (doc.secondary?.samples) {
+    set['secondary.samples_z'] = archiveSteps(asBuffer(doc.secondary.samples), 2, 3);
+    unset['secondary.samples'] = '';
+  }
+  return { set, unset };
+}
+
+// Stored form → [[rel_ms, ax, ay, az], ...]
+function unpackWaveform(doc) {
+  const { t, samples } = storedBuffers(doc);
+  const count = Math.min(doc.count, t.length / 4, samples.length / 6);
+  const out = new Array(count);
+  for (let i = 0; i < count; i++) {
+    out[i] = [
+      t.readInt32LE(i * 4),
+      round4(samples.readInt16LE(i * 6) / doc.scale),
+      round4(samples.readInt16LE(i * 6 + 2) / doc.scale),
+      round4(samples.readInt16LE(i * 6 + 4) / doc.scale),
+    ];
+  }
+  return out;
+}
+
+// Stored form → an 'SWV1' body for a WAVEFORM_INJECT build to play in place
+// of its sensor (GET /api/inject, src/waveform_inject.h). The samples stay
+// in 1/scale g with zero bias. The rate is the stored spacing's median, and
+// event_offset_ms (bytes 40..43) carries runId. A FIFO gap is not rebuilt:
+// the samples after it just follow on.
+function injectionBody(doc, runId) {
+  const { t, samples } = storedBuffers(doc);
+  const count = Math.min(doc.count, t.length / 4, samples.length / 6, 0xFFFF);
+  const steps = [];
+  for (let i = 1; i < Math.min(count, 64); i++) steps.push(t.readInt32LE(i * 4) - t.readInt32LE((i - 1) * 4));
+  steps.sort((a, b) => a - b);
+  const stepMs = steps.length ? steps[steps.length >> 1] : 0;
+  if (!count || stepMs <= 0) throw new Error('no samples to inject');
+  const head = Buffer.alloc(BINARY_HEADER_SIZE);
+  head.write(BINARY_MAGIC, 0, 'latin1');
+  head.writeFloatLE(doc.scale, 28);
+  head.writeUInt16LE(Math.round(1000 / stepMs), 32);
+  head.writeUInt16LE(count, 34);
+  head.writeInt32LE(t.readInt32LE(0), 36);
+  head.writeUInt32LE(runId >>> 0, 40);
+  return Buffer.concat([head, samples.subarray(0, count * 6)]);
+}
+
+// ── Reduced views ────────────────────────────────────────────────
+// [[rel_ms, ax, ay, az], ...] cut to fromMs..toMs (inclusive, either may be
+// null) and, past maxPoints, min/max envelope decimated: the samples go into
+// floor(maxPoints / 6) equal runs and each run keeps the samples holding its
+// lowest and highest value on each axis, in their original order. Those are
+// real samples, so the peaks (and the ΔG computed from them) survive exactly.
+function envelope(wave, { fromMs = null, toMs = null, maxPoints = 0 } = {}) {
+  let lo = 0, hi = wave.length;
+  if (fromMs != null) while (lo < hi && wave[lo][0] < fromMs) lo++;
+  if (toMs != null) while (hi > lo && wave[hi - 1][0] > toMs) hi--;
+  const n = hi - lo;
+  if (!maxPoints || n <= maxPoints) return wave.slice(lo, hi);
+  const runs = Math.max(1, Math.floor(maxPoints / 6));
+  const out = [];
+  for (let r = 0; r < runs; r++) {
+    const a = lo + Math.floor(r * n / runs), b = lo + Math.floor((r + 1) * n / runs);
+    if (a >= b) continue;
+    const keep = new Set();
+    for (let axis = 1; axis <= 3; axis++) {
+      let min = a, max = a;
+      for (let i = a + 1; i < b; i++) {
+        if (wave[i][axis] < wave[min][axis]) min = i;
+        if (wave[i][axis] > wave[max][axis]) max = i;
+      }
+      keep.add(min).add(max);
+    }
+    for (const i of [...keep].sort((x, y) => x - y)) out.push(wave[i]);
+  }
+  return out;
+}
+
+// Several waveforms on one absolute grid for an overlay: waves [{ at_ms
+// (the event time, epoch ms), rows: [[rel_ms, ax, ay, az], ...] }] ->
+// { start_ms, step_ms, count, columns: [[ax, ay, az] Float32Array each, per
+// wave] }. Sample i of every column is at start_ms + i × step_ms. The grid
+// spans every capture (cut to fromMs..toMs, epoch ms, if given) at the
+// finest native spacing among them unless stepMs is given, made coarser
+// until it fits maxPoints. Values are linear between the two samples
+// around each point, and NaN outside a capture or across a FIFO gap (two
+// samples more than GAP_STEPS native spacings apart).
+const GAP_STEPS = 3;
+
+function medianStep(rows) {
+  const steps = [];
+  for (let i = 1; i < Math.min(rows.length, 64); i++) steps.push(rows[i][0] - rows[i - 1][0]);
+  steps.sort((a, b) => a - b);
+  return steps.length ? steps[steps.length >> 1] : 0;
+}
+
+function alignWaveforms(waves, { fromMs = null, toMs = null, stepMs = null, maxPoints = 0 } = {}) {
+  const live = waves.filter(w => w.rows.length);
+  let start = Infinity, end = -Infinity, native = Infinity;
+  for (const w of live) {
+    start = Math.min(start, w.at_ms + w.rows[0][0]);
+    end = Math.max(end, w.at_ms + w.rows[w.rows.length - 1][0]);
+    const step = medianStep(w.rows);
+    if (step > 0) native = Math.min(native, step);
+  }
+  if (fromMs != null) start = Math.max(start, fromMs);
+  if (toMs != null) end = Math.min(end, toMs);
+  if (!(end >= start)) return { start_ms: null, step_ms: null, count: 0, columns: waves.map(() => null) };
+  let step = stepMs > 0 ? stepMs : Number.isFinite(native) ? native : 1;
+  if (maxPoints && (end - start) / step + 1 > maxPoints) step = (end - start) / Math.max(1, maxPoints - 1);
+  const count = Math.floor((end - start) / step) + 1;
+
+  const columns = waves.map((w) => {
+    if (!w.rows.length) return null;
+    const axes = [new Float32Array(count), new Float32Array(count), new Float32Array(count)];
+    const gap = GAP_STEPS * (medianStep(w.rows) || step);
+    const rows = w.rows;
+    let j = 0;
+    for (let k = 0; k < count; k++) {
+      const t = start + k * step - w.at_ms;
+      while (j < rows.length - 2 && rows[j + 1][0] <= t) j++;
+      const a = rows[j], b = rows[Math.min(j + 1, rows.length - 1)];
+      const inside = t >= rows[0][0] && t <= rows[rows.length - 1][0] && (t === a[0] || b[0] - a[0] <= gap);
+      const f = inside && b[0] > a[0] ? (t - a[0]) / (b[0] - a[0]) : 0;
+      for (let axis = 0; axis < 3; axis++) {
+        axes[axis][k] = inside ? a[axis + 1] + (b[axis + 1] - a[axis + 1]) * f : NaN;
+      }
+    }
+    return axes;
+  });
+  return { start_ms: start, step_ms: step, count, columns };
+}
+
+module.exports = {
+  BINARY_CONTENT_TYPE,
+  DELTA_CONTENT_TYPE,
+  MSGPACK_CONTENT_TYPE,
+  UPLOAD_FORMATS,
+  SampleBuffer,
+  alignWaveforms,
+  archiveWaveform,
+  WaveformDecoder,
+  bodyBudget,
+  bodyEncoding,
+  cleanRanges,
+  cleanSpectrum,
+  decodeBinary,
+  decodeMsgPack,
+  decodeWaveformBody,
+  envelope,
+  hasSamples,
+  injectionBody,
+  packWaveform,
+  readWaveformBody,
+  storedBuffers,
+  unpackWaveform,
+};
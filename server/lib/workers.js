@@ -0,0 +1,94 @@
+// ── Worker pool ──────────────────────────────────────────────────
+// A fixed set of worker_threads running one script, fed from a FIFO job
+// queue: run(kind, job) resolves with the worker's result. Each worker has
+// one job at a time, so a slow one never delays the others, and nothing
+// here touches the event loop beyond posting messages. A worker that dies
+// fails its job and is replaced. Past MAX_QUEUE waiting jobs run() rejects
+// at once instead of queueing without bound.
+
+const { Worker } = require('worker_threads');
+
+const MAX_QUEUE = 1000;
+
+class WorkerPool {
+  constructor(script, size) {
+    this.script = script;
+    this.size = Math.max(1, size);
+    this.idle = [];
+    this.busy = new Map();        // worker → { seq, resolve, reject, started }
+    this.queue = [];              // { kind, job, resolve, reject }
+    this.seq = 0;
+    this.stats = { done: 0, failed: 0, rejected: 0, last_ms: null, max_ms: 0 };
+    this.closed = false;
+    for (let i = 0; i < this.size; i++) this.spawn();
+  }
+
+  spawn() {
+    const w = new Worker(this.script);
+    w.on('message', (msg) => this.finish(w, msg));
+    w.on('error', (e) => {
+      w.dead = true;              // 'exit' follows and replaces it
+      this.finish(w, { error: e.message });
+    });
+    w.on('exit', () => {
+      this.idle = this.idle.filter(x => x !== w);
+      if (this.busy.has(w)) this.finish(w, { error: 'worker exited' });
+      this.busy.delete(w);
+      if (!this.closed) this.spawn();
+    });
+    w.unref();                    // never keeps the process alive
+    this.idle.push(w);
+    this.next();
+  }
+
+  run(kind, job) {
+    if (this.queue.length >= MAX_QUEUE) {
+      this.stats.rejected++;
+      return Promise.reject(new Error('analysis queue full'));
+    }
+    return new Promise((resolve, reject) => {
+      this.queue.push({ kind, job, resolve, reject });
+      this.next();
+    });
+  }
+
+  next() {
+    while (this.idle.length && this.queue.length) {
+      const w = this.idle.pop();
+      const { kind, job, resolve, reject } = this.queue.shift();
+      const seq = ++this.seq;
+      this.busy.set(w, { seq, resolve, reject, started: Date.now() });
+      w.postMessage({ seq, kind, job });
+    }
+  }
+
+  finish(w, msg) {
+    const task = this.busy.get(w);
+    if (!task || (msg.seq != null && msg.seq !== task.seq)) return;
+    this.busy.delete(w);
+    const ms = Date.now() - task.started;
+    this.stats.last_ms = ms;
+    this.stats.max_ms = Math.max(this.stats.max_ms, ms);
+    if (msg.error) {
+      this.stats.failed++;
+      task.reject(new Error(msg.error));
+    } else {
+      this.stats.done++;
+      task.resolve(msg.result);
+    }
+    if (!w.dead && !this.idle.includes(w)) this.idle.push(w);
+    this.next();
+  }
+
+  // Queue depth and jobs running, plus the counters
+  metrics() {
+    return { queued: this.queue.length, running: this.busy.size, workers: this.size, ...this.stats };
+  }
+
+  close() {
+    this.closed = true;
+    return Promise.all([...this.idle, ...this.busy.keys()].map(w => w.terminate()));
+  }
+}
+
+module.exports = { WorkerPool, MAX_QUEUE };
@@ -9,61 +9,667 @@ const fs = require('fs');
 const path = require('path');
 const os = require('os');
 const http = require('http');
+const dgram = require('dgram');
+const crypto = require('crypto');
 const { MongoClient, ObjectId } = require('mongodb');
 const { Server: SocketIO } = require('socket.io');
+const { createAdapter } = require('@socket.io/mongo-adapter');
+const waveform = require('./lib/waveform');
+const { decodeTrace } = require('./lib/trace');
+const { decodeStorm } = require('./lib/storm');
+const blackbox = require('./lib/blackbox');
+const { createTlsServer, parseTlsQuery } = require('./lib/tls');
+const { DeviceGateway, expressish } = require('./lib/gateway');
+const { MqttClient, CapturedResponse, deviceTopic, parseEventPayload, parseMqttQuery } = require('./lib/mqtt');
+const { decodeProfile, PHASE_EDGES_US, BUSY_KINDS } = require('./lib/profile');
+const { decodeDatagram, StreamBuffer, BUFFER_SECONDS: STREAM_BUFFER_SECONDS } = require('./lib/stream');
+const { decodeNotice } = require('./lib/notice');
+const { ClockFit } = require('./lib/clockfit');
+const { ConsensusEngine } = require('./lib/consensus');
+const { IngestQueue } = require('./lib/ingest');
+const { RecentEvents } = require('./lib/recent');
+const { Retention } = require('./lib/retention');
+const { TileCache } = require('./lib/tilecache');
+const { FirmwareStore, byteRange } = require('./lib/firmware');
+const { ThresholdTuner } = require('./lib/tuning');
+const { HourlyStats, METRICS: STATS_METRICS } = require('./lib/stats');
+const { serveAssets } = require('./lib/assets');
+const socketParser = require('./lib/socketparser');
+const { StatusFeed } = require('./lib/statusfeed');
+const { EventFeed } = require('./lib/eventfeed');
+const { Notifier, parseTargets } = require('./lib/notify');
+const { LiveChannel } = require('./lib/live');
+const { LiveStream } = require('./lib/livestream');
+const { HttpLog } = require('./lib/httplog');
+const { SharedState } = require('./lib/shared');
+const { DeviceRegistry, DEFAULT_GROUP } = require('./lib/registry');
+const { Locator } = require('./lib/locate');
+const { WorkerPool } = require('./lib/workers');
+const { Registry, CONTENT_TYPE: METRICS_CONTENT_TYPE } = require('./lib/metrics');
+const rollups = require('./lib/rollups');
+const queries = require('./lib/queries');
+const schema = require('./lib/schema');
+const { compress, compressStream } = require('./lib/compress');
+const { validator } = require('./lib/validate');
+const columnar = require('./lib/columnar');
+const miniseed = require('./lib/miniseed');
+const { SeedLinkServer } = require('./lib/seedlink');
+const { StreamStore } = require('./lib/streamstore');
+const { SoakTests } = require('./lib/soak');
+const { Stacker } = require('./lib/stacking');
+const { SessionServer, TYPES: SESSION_FRAMES, parseSessionQuery } = require('./lib/session');
+const initbin = require('./lib/initbin');
 
 // ── Configuration ────────────────────────────────────────────────
 const PORT = parseInt(process.env.PORT || '3000', 10);
 const MONGO_URI = process.env.MONGO_URI || 'mongodb://localhost:27017/seismic';
+const STREAM_PORT = parseInt(process.env.STREAM_PORT || '3001', 10);   // UDP, stream_mode 'udp'
+// Stored UDP streams (lib/streamstore.js): 60 s chunks kept this many days; 0 keeps none
+const STREAM_STORE_DAYS = parseFloat(process.env.STREAM_STORE_DAYS ?? '7');
+// SEEDLINK_PORT: the UDP streams also as a SeedLink server (lib/seedlink.js;
+// 18000 is the usual port). Off (0) by default.
+const SEEDLINK_PORT = parseInt(process.env.SEEDLINK_PORT || '0', 10);
+// SHARED_STATE=1: one of several replicas sharing MongoDB (lib/shared.js);
+// INSTANCE_ID must then be stable per replica across restarts
+const SHARED_STATE = process.env.SHARED_STATE === '1';
+const INSTANCE_ID = process.env.INSTANCE_ID || os.hostname();
+// SERVER_ROLE (with SHARED_STATE): 'ingest' takes device traffic and accepts
+// no dashboard sockets; 'dashboard' serves the sockets and publishes new
+// events from a change stream on `events` (lib/eventfeed.js). 'all' (the
+// default) is both in one process, publishing each upload as it's journaled.
+const SERVER_ROLE = ['all', 'ingest', 'dashboard'].includes(process.env.SERVER_ROLE)
+  ? process.env.SERVER_ROLE : 'all';
+// DEVICE_PORT: the device routes also on their own bare listener (lib/gateway.js);
+// point ROOT_URL/URL at it. Off (0) by default.
+const DEVICE_PORT = parseInt(process.env.DEVICE_PORT || '0', 10);
+// TLS_CERT + TLS_KEY (PEM paths): serve HTTPS on PORT (and DEVICE_PORT) instead (lib/tls.js)
+const TLS_CERT = process.env.TLS_CERT || '';
+const TLS_KEY = process.env.TLS_KEY || '';
+// MQTT_URL (mqtt://[user:pass@]host[:port]): take device traffic from this
+// broker too (lib/mqtt.js), and name it to MQTT_LINK firmware in /api/init.
+// MQTT_DEVICE_URL is the same broker as the devices reach it, if that differs.
+const MQTT_URL = process.env.MQTT_URL || '';
+const MQTT_DEVICE_URL = process.env.MQTT_DEVICE_URL || MQTT_URL;
+// SESSION_PORT: TCP port for SESSION_LINK firmware's framed device sessions
+// (lib/session.js), named to it in /api/init. Off (0) by default.
+const SESSION_PORT = parseInt(process.env.SESSION_PORT || '0', 10);
+// Threads for waveform analysis (lib/analysis.js); 0 turns it off
+const ANALYSIS_WORKERS = parseInt(process.env.ANALYSIS_WORKERS ?? String(Math.min(4, Math.max(1, os.cpus().length - 1))), 10);
+// Multi-node stacking over the UDP streams (lib/stacking.js), in the
+// analysis workers; 'off' turns it off
+const STACK_DETECT = process.env.STACK_DETECT !== 'off';
+// Waveform tiers (lib/retention.js): minor events' waveforms are envelope
+// decimated after RETENTION_ENVELOPE_DAYS, the rest deflated after
+// RETENTION_ARCHIVE_DAYS; 0 turns a tier off
+const RETENTION_ENVELOPE_DAYS = parseFloat(process.env.RETENTION_ENVELOPE_DAYS ?? '7');
+const RETENTION_ARCHIVE_DAYS = parseFloat(process.env.RETENTION_ARCHIVE_DAYS ?? '90');
+// Device status changes go to the dashboards as one devices:status diff at
+// most this often (lib/statusfeed.js); online/offline goes at once
+const DEVICE_STATUS_MS = parseInt(process.env.DEVICE_STATUS_MS || '2000', 10);
+// Per-device minor thresholds from each one's noise floor (lib/tuning.js):
+// 'off', 'propose' (GET /api/tuning, applied from the admin page) or 'apply'
+const THRESHOLD_TUNING = ['off', 'propose', 'apply'].includes(process.env.THRESHOLD_TUNING)
+  ? process.env.THRESHOLD_TUNING : 'propose';
+const TUNING_MARGIN = parseFloat(process.env.TUNING_MARGIN || '1.5');   // × the p99.9 per-second noise peak
+// NOTIFY_URLS (comma list): webhooks each CONFIRMED consensus entry is POSTed to,
+// through the outbox in lib/notify.js; NOTIFY_CONCURRENCY deliveries at once
+const NOTIFY_URLS = process.env.NOTIFY_URLS || '';
+const NOTIFY_CONCURRENCY = Math.max(1, parseInt(process.env.NOTIFY_CONCURRENCY || '4', 10));
+// The dashboard build served at /; PUBLIC_DIR points a checkout at frontend/dist
+const PUBLIC_DIR = process.env.PUBLIC_DIR || path.join(__dirname, 'public');
 
-// Device translation dictionary (MAC → human name)
+// Device translation dictionary (MAC → human name). The literal is the
+// registry's seed on first start (lib/registry.js); afterwards syncRegistry()
+// fills it from there, and devices not registered appear under their MAC.
 const translationDict = {
   '48:55:19:ED:D8:9A': 'Ryan Office',
   '48:55:19:ED:9B:A9': 'Bonus Room',
   'C8:2B:96:23:21:BC': 'Kitchen',
 };
-const DEVICE_IDS = Object.keys(translationDict);
+const DEVICE_IDS = Object.keys(translationDict);   // registered devices, kept by syncRegistry()
 
 // In-memory state
 const lastEventTimes = {};          // deviceId → Date
 const lastInitTimes  = {};          // deviceId → ISO string (last init call)
+const lastTemps      = {};          // deviceId → MPU6050 die temperature (°C, from heartbeat)
+const lastBusStats   = {};          // deviceId → I2C counters (cumulative since boot, from heartbeat)
+const lastProfiles   = {};          // deviceId → loop timing histograms (last heartbeat window)
+const lastHeap       = {};          // deviceId → heap telemetry (heartbeat or X-Heap on an upload)
+const lastOta        = {};          // deviceId → last OTA attempt { result, bytes, ms, kbps, time }
+const lastTasks      = {};          // deviceId → loop scheduler stats (last heartbeat window)
+const lastTaps       = {};          // deviceId → captures a dual-sensor node dropped as local (since boot)
+const lastBoots      = {};          // deviceId → latest BOOT_HISTORY boot-phase reports, oldest first
+const lastBlackBox   = {};          // deviceId → what its flash black box holds { oldest_ms, newest_ms, ... }
+const lastTls        = {};          // deviceId → TLS handshake counts since boot { full, resumed, ... }
+const lastUploads    = {};          // deviceId → upload slots now + capture overflow counts since boot
+const lastEvictions  = {};          // deviceId → events its journal dropped unsent { total, recent, time }
+const lastMqtt       = {};          // deviceId → its broker link: up now + publish counts since boot
+const lastSession    = {};          // deviceId → its device session: up now + frame counts since boot
 const startTime = new Date();
-let httpLogs = [];                  // { timestamp, endpoint }
-let windowTimer = null;
-let windowDevices = new Set();
+const httpLog = new HttpLog();      // /api requests: recent ring + per-minute counts
+const lastHeartbeatMs = {};         // deviceId → Date.now() of its last heartbeat
+const clockFits = {};               // deviceId → ClockFit of its millis() against our clock
+// Live triggers by event time, one engine per device group; configured from
+// the group's quorum / window_ms, else consensus_quorum / _window_ms
+const CONSENSUS_HORIZON_MS = 120000;
+const consensusGroups = new Map();    // group name → ConsensusEngine
+const consensusEntries = new Map();   // cluster → its stored CONFIRMED entry
+const consensusLocators = new Map();  // cluster → its Locator (lib/locate.js), same lifetime
+let registry = null;                  // DeviceRegistry, loaded in main()
+
+// Dashboard polls revalidate with If-None-Match. Each polled resource has a
+// counter bumped wherever its data changes, so an unchanged one is answered
+// 304 before any query runs or any body is built. BOOT_TAG keeps a restarted
+// server from matching tags handed out by the last one.
+const BOOT_TAG = Date.now().toString(36);
+const dataVersions = { events: 0 };
+
+function bumpVersion(name) {
+  dataVersions[name]++;
+}
+
+// Tag the response; true (and a 304 sent) when the client already has it
+function notModified(req, res, tag) {
+  const etag = `W/"${tag}.${BOOT_TAG}"`;
+  res.set('ETag', etag);
+  res.set('Cache-Control', 'no-cache');
+  const match = (req.get('If-None-Match') || '').split(',').some(t => t.trim() === etag);
+  if (match) res.status(304).end();
+  return match;
+}
+
+// ── Prometheus metrics (GET /metrics) ────────────────────────────
+// Latency histograms are filled as things happen; device telemetry and
+// queue state are read from what the server already keeps at scrape time.
+const metrics = new Registry();
+const LATENCY_BUCKETS_S = [0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 120, 300];
+const metricHttp = metrics.histogram('seismo_http_request_duration_seconds',
+  'Request latency by route (push long-polls sit in the top buckets)', ['method', 'route', 'code'], LATENCY_BUCKETS_S);
+const metricMongo = metrics.histogram('seismo_mongo_command_duration_seconds',
+  'MongoDB command latency', ['command', 'outcome'], LATENCY_BUCKETS_S);
+const metricEvents = metrics.counter('seismo_events_total', 'Seismic events accepted', ['device', 'level']);
+const metricStormFolded = metrics.counter('seismo_storm_folded_total',
+  'Minor captures summarized on the heartbeat instead of uploaded', ['device']);
+const metricEventLatency = metrics.histogram('seismo_event_latency_seconds',
+  'Trigger to dashboard, per stage (see eventLatency)', ['stage'], LATENCY_BUCKETS_S);
+const metricHeartbeatGap = metrics.histogram('seismo_heartbeat_interval_seconds',
+  'Time between consecutive heartbeats', ['device'], [1, 5, 15, 30, 45, 60, 90, 120, 180, 300, 600]);
+const metricLoopPhase = metrics.histogram('seismo_device_loop_phase_seconds',
+  'Device loop phase durations, from the firmware loop profile', ['device', 'phase'], PHASE_EDGES_US.map(us => us / 1e6));
+const ingestMetric = (key) => () => (ingest ? [[{}, ingest.metrics()[key]]] : []);
+metrics.gauge('seismo_ingest_queue_depth', 'Events journaled but not yet in MongoDB', [], ingestMetric('depth'));
+metrics.gauge('seismo_upload_policy_step', 'Backpressure asked of devices: 0 full .. 4 retry', [],
+  () => (ingest ? [[{}, uploadPolicy().step]] : []));
+metrics.gauge('seismo_ingest_oldest_seconds', 'Age of the oldest queued event', [],
+  () => (ingest ? [[{}, ingest.metrics().oldest_ms / 1000]] : []));
+metrics.counter('seismo_ingest_flushed_total', 'Events moved from the journal into MongoDB', [], ingestMetric('flushed'));
+metrics.counter('seismo_ingest_errors_total', 'Failed insertMany batches', [], ingestMetric('errors'));
+const analysisMetric = (key) => () => (analysis ? [[{}, analysis.metrics()[key]]] : []);
+metrics.gauge('seismo_analysis_queue_depth', 'Waveform analysis jobs waiting for a worker', [], analysisMetric('queued'));
+metrics.counter('seismo_analysis_jobs_total', 'Waveform analysis jobs finished', [], analysisMetric('done'));
+metrics.counter('seismo_analysis_failures_total', 'Waveform analysis jobs that failed or were refused', [],
+  () => (analysis ? [[{}, analysis.metrics().failed + analysis.metrics().rejected]] : []));
+const metricNotifyDelivery = metrics.histogram('seismo_notify_delivery_seconds',
+  'Consensus confirmed to webhook delivered, per target', ['target'], LATENCY_BUCKETS_S);
+const metricNotifyAttempts = metrics.counter('seismo_notify_attempts_total',
+  'Webhook delivery attempts by outcome (ok, retry, failed)', ['target', 'outcome']);
+metrics.gauge('seismo_notify_queue_depth', 'Webhook deliveries waiting (as of the last count)', [],
+  () => (notifier?.metrics().pending != null ? [[{}, notifier.metrics().pending]] : []));
+const perDevice = (source, pick) => () => Object.entries(source).map(([id, v]) => [{ device: id }, v == null ? null : pick(v)]);
+metrics.gauge('seismo_device_last_seen_seconds', 'Seconds since the device last contacted the server', ['device'],
+  perDevice(lastEventTimes, t => (Date.now() - t.getTime()) / 1000));
+metrics.gauge('seismo_device_temperature_celsius', 'MPU6050 die temperature', ['device'], perDevice(lastTemps, v => v));
+metrics.gauge('seismo_device_heap_free_bytes', 'Free heap', ['device'], perDevice(lastHeap, h => h.free));
+metrics.gauge('seismo_device_heap_max_block_bytes', 'Largest free heap block', ['device'], perDevice(lastHeap, h => h.max_block));
+metrics.gauge('seismo_device_heap_min_free_bytes', 'Lowest free heap since boot', ['device'], perDevice(lastHeap, h => h.min_free));
+metrics.gauge('seismo_device_heap_fragmentation_ratio', 'Heap fragmentation', ['device'],
+  perDevice(lastHeap, h => (h.frag_pct == null ? null : h.frag_pct / 100)));
+const perTask = (pick) => () => Object.entries(lastTasks).flatMap(([id, t]) =>
+  Object.entries(t.tasks).map(([task, v]) => [{ device: id, task }, pick(v)]));
+metrics.gauge('seismo_device_task_max_seconds', 'Longest run of each loop task, last heartbeat window', ['device', 'task'],
+  perTask(v => v.max_us / 1e6));
+metrics.gauge('seismo_device_task_overruns', 'Runs over budget, last heartbeat window', ['device', 'task'], perTask(v => v.overruns));
+metrics.gauge('seismo_device_task_late', 'Runs started late, last heartbeat window', ['device', 'task'], perTask(v => v.late));
+metrics.gauge('seismo_device_isr_jitter_seconds', 'Worst data-ready ISR entry jitter, last heartbeat window (real-time builds)',
+  ['device'], perDevice(lastProfiles, p => (p.isr ? p.isr.late_max_us / 1e6 : null)));
+metrics.gauge('seismo_device_busy_seconds', 'CPU-bound bursts by kind, last heartbeat window (see mhz)', ['device', 'kind', 'mhz'],
+  () => Object.entries(lastProfiles).flatMap(([id, p]) => (p.busy
+    ? BUSY_KINDS.map(k => [{ device: id, kind: k, mhz: String(p.busy.mhz) }, p.busy[`${k}_us`] / 1e6]) : [])));
+metrics.gauge('seismo_device_awake_ratio', 'Share of the last heartbeat window not in modem sleep (sleep builds)', ['device'],
+  perDevice(lastProfiles, p => (p.sleep?.awake_pct == null ? null : p.sleep.awake_pct / 100)));
+metrics.gauge('seismo_device_local_taps', 'Captures a dual-sensor node dropped as local since boot', ['device'],
+  perDevice(lastTaps, v => v));
+metrics.gauge('seismo_device_boot_seconds', 'How long the latest boot took, reset to sampling', ['device'],
+  perDevice(lastBoots, b => (b.length ? b[b.length - 1].total_ms / 1000 : null)));
+metrics.gauge('seismo_device_blackbox_seconds', 'Span the flash black box holds', ['device'],
+  perDevice(lastBlackBox, b => (b.oldest_ms ? (b.newest_ms - b.oldest_ms) / 1000 : null)));
+metrics.gauge('seismo_device_upload_queue_bytes', 'Event bodies waiting in the upload slots', ['device'],
+  perDevice(lastUploads, u => u.queued_bytes));
+metrics.gauge('seismo_device_captures_overflowed', 'Captures the upload queue had no slot for, since boot', ['device', 'outcome'],
+  () => Object.entries(lastUploads).flatMap(([id, u]) =>
+    ['spilled', 'streamed', 'dropped'].map(k => [{ device: id, outcome: k }, u[k]])));
+metrics.counter('seismo_device_journal_evictions_total', 'Events a device journal dropped unsent', ['device'],
+  perDevice(lastEvictions, e => e.total));
+metrics.gauge('seismo_device_tls_full_handshakes', 'Full TLS handshakes since boot (the rest resumed)', ['device'],
+  perDevice(lastTls, t => t.full));
+metrics.counter('seismo_device_mqtt_failed_total', 'Publishes the broker never acked, since boot', ['device'],
+  perDevice(lastMqtt, m => m.failed));
+metrics.counter('seismo_device_session_failed_total', 'Session frames the server never acked, since boot', ['device'],
+  perDevice(lastSession, m => m.failed));
+metrics.gauge('seismo_sessions_open', 'Device sessions open on SESSION_PORT', [],
+  () => (sessions ? [[{}, sessions.sessions.size]] : []));
+metrics.gauge('seismo_mqtt_connected', 'Whether the server has its broker session (MQTT_URL)', [],
+  () => (mqtt ? [[{}, mqtt.connected ? 1 : 0]] : []));
+metrics.counter('seismo_tls_handshakes_total', 'TLS handshakes served, full or resumed', ['kind'],
+  () => (server.handshakes ? Object.entries(server.handshakes).map(([kind, n]) => [{ kind }, n]) : []));
+
+// A device request marks it seen; /api/status changes with it
+function markSeen(id) {
+  if (!translationDict[id]) translationDict[id] = id;
+  lastEventTimes[id] = new Date();
+  shared?.touch(id);
+  statusChanged(id);
+}
+
+// Something in /api/status changed, for one device or (no id) all of them
+function statusChanged(id) {
+  if (id) statusFeed.touch(id);
+  else statusFeed.refresh();
+}
 
 // Default configuration
 const DEFAULT_CONFIG = {
   heartbeat_interval: 60000,
+  push_heartbeat_interval: 120000,  // used instead while a device's push channel is up
   sensitivity: { minor: 0.035, moderate: 0.10, severe: 0.50 },
   consensus_window_ms: 2000,
+  consensus_quorum: 0,   // distinct members of a group a consensus needs, 0 = all of them
+  consensus_provisional: 2,   // members for an early provisional alert, below the quorum; 0 = off
+  locate_velocity_m_s: null,   // wave speed for a point-source fit; null = direction only
+  consensus_coherence: null,   // envelope correlation a cluster needs to be CONFIRMED; null = not checked
   status_threshold_seconds: 120,
+  // Acquisition (sent to devices in /api/init, applied at boot)
+  sample_rate_hz: 100,   // MPU6050 sample clock, 5-500, snapped to one its divider hits
+  dlpf: 1,               // MPU6050_DLPF_BW_* (0=256Hz … 6=5Hz), 1 = 188Hz
+  pre_ms: 3000,          // pre-trigger history
+  post_ms: 3000,         // post-trigger capture
+  ntp_server: 'pool.ntp.org',  // devices tag events with SNTP time from here
+  max_post_ms: 12000,    // retriggers extend the capture up to this
+  // Trigger engine: 'threshold' (ΔG vs sensitivity), 'sta_lta', or 'both'
+  trigger_mode: 'threshold',
+  // ΔG the thresholds apply to: 'max_abs' (largest axis), 'horizontal' (X/Y),
+  // 'vertical' (Z), 'vector' (magnitude, the same in every direction), or
+  // 'gravity_vertical' / 'gravity_horizontal' (split along the DMP's gravity)
+  detect_metric: 'max_abs',
+  sta_ms: 500,           // STA/LTA short window
+  lta_ms: 30000,         // STA/LTA long window
+  sta_lta_on: 4.0,       // trigger when STA/LTA reaches this
+  sta_lta_off: 1.5,      // re-arm once it falls below this
+  // Detection pre-filter (Butterworth biquads, 0 = stage off). Uploads stay raw.
+  hp_hz: 0.1,            // high-pass corner, removes drift and tilt
+  lp_hz: 0,              // low-pass corner, above the band of interest
+  bias_track_s: 300,     // idle bias tracking time constant, 0 = calibrated bias only
+  // Continuous stream: 'off' (events only) or 'udp' (decimated samples to STREAM_PORT)
+  stream_mode: 'off',
+  stream_hz: 10,         // stream output rate; the device averages down to it
+  spectrum: false,       // Goertzel band amplitudes with each capture
+  local_http: false,     // on-node /status and /live diagnostics server (src/local_http.h)
 };
+const ACQUISITION_KEYS = ['sample_rate_hz', 'dlpf', 'pre_ms', 'post_ms', 'max_post_ms',
+  'trigger_mode', 'detect_metric', 'sta_ms', 'lta_ms', 'sta_lta_on', 'sta_lta_off',
+  'hp_hz', 'lp_hz', 'bias_track_s', 'ntp_server', 'push_heartbeat_interval',
+  'stream_mode', 'stream_hz', 'spectrum', 'local_http'];
+const TRIGGER_MODES = ['threshold', 'sta_lta', 'both'];
+const DETECT_METRICS = ['max_abs', 'horizontal', 'vertical', 'vector', 'gravity_vertical', 'gravity_horizontal'];
+const STREAM_MODES = ['off', 'udp'];
+
+function clamp(v, lo, hi) {
+  return Math.min(hi, Math.max(lo, Number(v)));
+}
+
+// The 5-500Hz rate nearest hz that the MPU6050 produces exactly: its 8kHz
+// (dlpf 0) or 1kHz output rate over 1 + SMPLRT_DIV (0-255). A tie goes to
+// the faster rate. snapSampleRate() in src/init_config.cpp is the same.
+function snapSampleRate(hz, dlpf) {
+  const output = Number(dlpf) === 0 ? 8000 : 1000;
+  const want = Number(hz) || 0;
+  let best = 0;
+  for (let div = 1; div <= 256; div++) {
+    const rate = output / div;
+    if (output % div || rate < 5 || rate > 500) continue;
+    if (!best || Math.abs(rate - want) < Math.abs(best - want)) best = rate;
+  }
+  return best;
+}
+
+// Effective config for one device: defaults, then the saved global config,
+// then that device's overrides
+function deviceConfig(saved, id) {
+  const cfg = { ...DEFAULT_CONFIG };
+  if (!saved) return cfg;
+  cfg.heartbeat_interval = saved.heartbeat_interval ?? cfg.heartbeat_interval;
+  cfg.sensitivity = { ...cfg.sensitivity, ...(saved.sensitivity || {}) };
+  cfg.consensus_window_ms = saved.consensus_window_ms ?? cfg.consensus_window_ms;
+  cfg.consensus_quorum = saved.consensus_quorum ?? cfg.consensus_quorum;
+  cfg.consensus_provisional = saved.consensus_provisional ?? cfg.consensus_provisional;
+  cfg.locate_velocity_m_s = saved.locate_velocity_m_s ?? cfg.locate_velocity_m_s;
+  cfg.consensus_coherence = saved.consensus_coherence ?? cfg.consensus_coherence;
+  cfg.status_threshold_seconds = saved.status_threshold_seconds ?? cfg.status_threshold_seconds;
+  for (const key of ACQUISITION_KEYS) cfg[key] = saved[key] ?? cfg[key];
+
+  const devCfg = saved.devices?.[id];
+  if (devCfg) {
+    if (devCfg.heartbeat_interval != null) cfg.heartbeat_interval = devCfg.heartbeat_interval;
+    if (devCfg.sensitivity) cfg.sensitivity = { ...cfg.sensitivity, ...devCfg.sensitivity };
+    for (const key of ACQUISITION_KEYS) if (devCfg[key] != null) cfg[key] = devCfg[key];
+  }
+  return cfg;
+}
+
+// The part of a device's config it actually receives, for change detection
+function deviceView(cfg) {
+  const { minor, moderate, severe } = cfg.sensitivity;
+  return JSON.stringify([cfg.heartbeat_interval, minor, moderate, severe,
+    ...ACQUISITION_KEYS.map(key => cfg[key])]);
+}
+
+// Per-device config generation (deviceId → n), bumped whenever a config save
+// changes what that device would get from /api/init. Devices echo the one
+// they applied as ?cfg= on each heartbeat; a stale one gets a 202 and the
+// device re-fetches /api/init without rebooting. Persisted as config_gen.
+const configGens = {};
+
+// Devices long-polling GET /api/push (deviceId → { res, gen, timer }). The
+// server answers as soon as there's a reinit or config change for the device,
+// else with 204 after PUSH_HOLD_MS (under keepAliveTimeout; a reverse proxy
+// in front needs a longer read timeout than this).
+const PUSH_HOLD_MS = 4 * 60 * 1000;
+const pushWaiters = {};
+
+const streams = {};   // deviceId → StreamBuffer of its UDP stream (in memory only)
+
+// Retroactive pulls: after a consensus, nodes that didn't report the event
+// are asked for that window of their sample ring (src: servePull()). A 203 on
+// the push channel or heartbeat tells a device to GET /api/pull, which hands
+// over the request; its upload comes back to /api/seismic as trigger 'pull'.
+const PULL_PRE_MS = 10000;      // before the first event of the window
+const PULL_POST_MS = 15000;     // after it; the pull is sent once that has passed
+const pendingPulls = {};        // deviceId → { pull_id, from_ms, to_ms, center_ms }
+const sentPulls = {};           // deviceId → the one handed over, until its upload arrives
+
+function requestPull(id, pull) {
+  pendingPulls[id] = pull;
+  shared?.putPull(id, pull).catch(e => console.error('Pull share error:', e.message));
+  console.log(`[PULL] ${translationDict[id] || id}: ${new Date(pull.from_ms).toISOString()} +${pull.to_ms - pull.from_ms}ms`);
+  notifyPush(id);
+}
+
+// Hardware-in-the-loop injection: a stored capture played through a test
+// build's pipeline in place of its sensor (src/waveform_inject.h). POST
+// /api/inject/:deviceId queues it, a 207 on the heartbeat of a device that
+// sends 'inject' tells it to GET /api/inject, and the heartbeat after the run
+// reports when it triggered. The event it uploads meanwhile is tagged with
+// the run, which then holds both latencies: detection (trigger_ms, from the
+// source capture's trigger) and upload (event arrival after its trigger time).
+const pendingInjects = {};      // deviceId → { run_id, event_id, body, requested_at }
+const injections = {};          // deviceId → the latest run, without its body
+let nextInjectRun = 1;
+
+// "run,played,count[,trigger_ms]" from the heartbeat onto the run it reports
+function parseInjectQuery(id, value) {
+  const run = injections[id];
+  const [runId, played, count, triggerMs] = String(value).split(',').map(Number);
+  if (!run || !runId || runId !== run.run_id) return;
+  run.status = 'done';
+  run.played = played;
+  run.samples = count;
+  run.trigger_ms = Number.isFinite(triggerMs) ? triggerMs : null;
+  run.done_at = new Date().toISOString();
+  soakTests?.reported(id, runId, run.trigger_ms);
+  console.log(`[INJECT] ${translationDict[id] || id}: run ${runId} done, ${run.trigger_ms == null ? 'no trigger' : `triggered at ${run.trigger_ms}ms`}`);
+}
+
+// Events older than this on arrival were replayed from a device's offline
+// journal (live ones are at most max_post_ms plus upload time old, max_post_ms <= 60s)
+const REPLAY_STALE_MS = 90 * 1000;
+
+// ── Upload backpressure ─────────────────────────────────────────
+// The write-behind queue's depth sets how much devices should send, on every
+// /api/seismic response as X-Upload-Policy: <mode>,<hold_ms> (src/upload_policy.h).
+// Each doubling past INGEST_DEGRADE_DEPTH steps it up: decimate, waveform_off,
+// summary, then retry, a 503 that takes nothing. Devices fall back to full
+// once hold_ms passes without a response renewing it.
+const INGEST_DEGRADE_DEPTH = Math.max(1, parseInt(process.env.INGEST_DEGRADE_DEPTH || '500', 10));
+const UPLOAD_MODES = ['full', 'decimate', 'waveform_off', 'summary', 'retry'];
+const UPLOAD_HOLD_MS = 30 * 1000;
+const UPLOAD_RETRY_MS = 15 * 1000;
+let lastUploadMode = 'full';
+
+function uploadPolicy(depth = ingest?.metrics().depth ?? 0) {
+  const step = depth < INGEST_DEGRADE_DEPTH ? 0
+    : Math.min(UPLOAD_MODES.length - 1, 1 + Math.floor(Math.log2(depth / INGEST_DEGRADE_DEPTH)));
+  const mode = UPLOAD_MODES[step];
+  if (mode !== lastUploadMode) {
+    console.log(`[INGEST] Upload policy ${lastUploadMode} -> ${mode} (queue depth ${depth})`);
+    lastUploadMode = mode;
+  }
+  return { mode, step, hold_ms: mode === 'retry' ? UPLOAD_RETRY_MS : step ? UPLOAD_HOLD_MS : 0 };
+}
 
 // ── Firmware OTA ────────────────────────────────────────────────
 const FIRMWARE_DIR = path.join(__dirname, 'firmware');
 const deviceFirmwareVersions = {};   // deviceId → version string reported at last init
 
-// Read firmware.json metadata from disk (written by Deploy.ps1)
-function getFirmwareInfo() {
-  try {
-    const jsonPath = path.join(FIRMWARE_DIR, 'firmware.json');
-    if (fs.existsSync(jsonPath)) return JSON.parse(fs.readFileSync(jsonPath, 'utf8'));
-  } catch (e) { /* no firmware deployed yet */ }
-  return null;
+// Staggered rollout: /api/init only offers firmware_url to OTA_MAX_CONCURRENT
+// devices at a time, so a deploy never takes the whole array down at once.
+// A slot is freed when its device inits on the new version (or after
+// OTA_SLOT_TIMEOUT_MS, e.g. a failed download; it then rejoins the back of the
+// queue). The next waiting device is woken with a config generation bump: its
+// reload sees firmware_version and reboots into the update.
+const OTA_MAX_CONCURRENT = Math.max(1, parseInt(process.env.OTA_MAX_CONCURRENT || '1', 10));
+const OTA_SLOT_TIMEOUT_MS = 10 * 60 * 1000;
+let rollout = { version: null, updating: new Map(), waiting: [], done: new Set() };
+
+// firmware.json and firmware.bin, in memory and reloaded when firmware/ changes
+const firmware = new FirmwareStore(FIRMWARE_DIR).start();
+
+// Whether id, reporting version 'reported', may download firmware 'version' now
+function rolloutGrant(id, reported, version) {
+  if (rollout.version !== version) startRollout(version);
+  if (reported === version) {
+    rollout.done.add(id);
+    rollout.waiting = rollout.waiting.filter(w => w !== id);
+    if (rollout.updating.delete(id)) {
+      console.log(`[ROLLOUT] ${translationDict[id] || id} is on v${version}`);
+      releaseRollout();
+    }
+    return false;
+  }
+  if (rollout.done.has(id)) return false;      // already runs this image (OTA said 'current')
+  if (rollout.updating.has(id)) return true;   // rebooted mid-update; let it retry
+  if (rollout.updating.size < OTA_MAX_CONCURRENT) {
+    rollout.waiting = rollout.waiting.filter(w => w !== id);
+    rollout.updating.set(id, Date.now());
+    console.log(`[ROLLOUT] v${version} to ${translationDict[id] || id} (${rollout.updating.size}/${OTA_MAX_CONCURRENT})`);
+    return true;
+  }
+  if (!rollout.waiting.includes(id)) rollout.waiting.push(id);
+  return false;
+}
+
+// Where a boot spent its time (src/boot_timing.h), sent once with the first
+// heartbeat after it: boot_ms=total,mpu,calib,wifi,init,config,
+// boot_wifi=assoc_ms,path (1 cached AP, 0 scan), reset=<rst_info reason>
+const BOOT_PHASES = ['mpu', 'calib', 'wifi', 'init', 'config'];
+const RESET_REASONS = ['power_on', 'hw_wdt', 'exception', 'soft_wdt', 'soft_restart', 'deep_sleep', 'ext_reset'];
+const BOOT_HISTORY = 20;
+function parseBootQuery(id, query) {
+  if (typeof query.boot_ms !== 'string') return null;
+  const ms = query.boot_ms.split(',').map(v => parseInt(v, 10));
+  if (ms.length !== BOOT_PHASES.length + 1 || ms.some(v => !Number.isFinite(v) || v < 0)) return null;
+  const [assoc, path] = String(query.boot_wifi ?? '').split(',').map(v => parseInt(v, 10));
+  const reason = parseInt(query.reset, 10);
+  const boot = {
+    time: new Date().toISOString(),
+    total_ms: ms[0],
+    phases: Object.fromEntries(BOOT_PHASES.map((p, k) => [p, ms[k + 1]])),
+    wifi_assoc_ms: Number.isFinite(assoc) ? assoc : null,
+    wifi_path: path === 1 ? 'cached' : path === 0 ? 'scan' : null,
+    reset: Number.isFinite(reason) ? (RESET_REASONS[reason] ?? `reason_${reason}`) : null,
+    firmware_version: deviceFirmwareVersions[id] || null,
+  };
+  lastBoots[id] = [...(lastBoots[id] || []), boot].slice(-BOOT_HISTORY);
+  console.log(`[BOOT] ${translationDict[id] || id} ${boot.reset ?? '?'}: ${boot.total_ms}ms (` +
+    BOOT_PHASES.map(p => `${p} ${boot.phases[p]}`).join(', ') + ')');
+  bootCol?.insertOne({ id, alias: translationDict[id], ...boot, time: new Date(boot.time) })
+    .catch(e => console.error('Boot write error:', e.message));
+  return boot;
+}
+
+// Outcome of a device's deferred OTA (src/ota_update.h), sent once with the
+// next heartbeat: ota=ok|failed|current, ota_bytes, ota_ms. A failed or
+// no-op attempt frees its rollout slot now rather than at the timeout.
+function parseOtaQuery(id, query) {
+  if (!['ok', 'failed', 'current'].includes(query.ota)) return null;
+  const bytes = parseInt(query.ota_bytes, 10) || 0;
+  const ms = parseInt(query.ota_ms, 10) || 0;
+  const ota = {
+    result: query.ota, bytes, ms,
+    kbps: ms > 0 ? Math.round(bytes * 8 / ms * 10) / 10 : null,
+    time: new Date().toISOString(),
+  };
+  lastOta[id] = ota;
+  console.log(`[FIRMWARE] ${translationDict[id] || id} OTA ${ota.result}: ${bytes} bytes in ${ms}ms` +
+    (ota.kbps != null ? ` (${ota.kbps} kbit/s)` : ''));
+  if (query.ota !== 'ok' && rollout.updating.delete(id)) {
+    if (query.ota === 'failed') rollout.waiting.push(id);
+    else rollout.done.add(id);
+    releaseRollout();
+  }
+  return ota;
+}
+
+// New firmware.json: queue every device known to run something else
+function startRollout(version) {
+  const known = Object.keys(deviceFirmwareVersions);
+  rollout = {
+    version,
+    updating: new Map(),
+    waiting: known.filter(id => deviceFirmwareVersions[id] !== version),
+    done: new Set(known.filter(id => deviceFirmwareVersions[id] === version)),
+  };
+  if (rollout.waiting.length) console.log(`[ROLLOUT] v${version}: ${rollout.waiting.length} devices queued`);
+}
+
+// Once a minute: pick up a new deploy, expire stuck slots, start the next devices
+function syncRollout() {
+  const info = firmware.info();
+  if (!info?.version) return;
+  if (rollout.version !== info.version) startRollout(info.version);
+  releaseRollout();
+}
+
+// Expire stuck slots and hand free ones to waiting devices
+function releaseRollout() {
+  const now = Date.now();
+  for (const [id, since] of rollout.updating) {
+    if (now - since < OTA_SLOT_TIMEOUT_MS) continue;
+    console.log(`[ROLLOUT] ${translationDict[id] || id} didn't come back on v${rollout.version}, requeued`);
+    rollout.updating.delete(id);
+    rollout.waiting.push(id);
+  }
+  while (rollout.updating.size < OTA_MAX_CONCURRENT && rollout.waiting.length) {
+    const id = rollout.waiting.shift();
+    if (rollout.updating.has(id)) continue;
+    rollout.updating.set(id, now);
+    configGens[id] = (configGens[id] || 0) + 1;
+    console.log(`[ROLLOUT] Waking ${translationDict[id] || id} for v${rollout.version}`);
+    notifyPush(id);
+  }
 }
 
 // ── MongoDB collections (set after connect) ─────────────────────
 let eventsCol = null;   // seismic events + consensus entries
+let waveformsCol = null;   // event waveforms in stored form (waveform.packWaveform), _id = event _id
+let rollupsCol = null;     // hourly / daily event counts and max ΔG (lib/rollups.js)
+let rollupState = null;
+let hourlyStats = null;    // per-hour quantile sketches of ΔG, latency and jitter (lib/stats.js)
+let retention = null;      // waveform tiers (lib/retention.js), started in main()
+let ingest = null;      // write-behind queue in front of eventsCol for device uploads
+const recent = new RecentEvents();   // the last 25h of eventsCol in memory, filled in main()
+let schemaLegacy = true;   // until schema.migrate() has converted every stored event
+// Stored event or consensus entry -> the API's shape, aliases as registered now
+const expandEvent = (doc) => schema.expand(doc, id => translationDict[id] || id);
+// Spectrogram tiles (lib/tilecache.js): in memory, and on disk under SPECTROGRAM_CACHE
+const spectrograms = new TileCache(process.env.SPECTROGRAM_CACHE || path.join(__dirname, 'data', 'spectrograms'));
+const INGEST_JOURNAL = process.env.INGEST_JOURNAL ||
+  path.join(__dirname, 'data', SHARED_STATE ? `ingest-${INSTANCE_ID}.journal` : 'ingest.journal');
 let configCol = null;   // global + per-device configuration
 let reinitCol = null;   // reinit request tracking
 
+// Heartbeats and /api/init are answered from memory. This process is the only
+// writer of both collections, so the caches are loaded once at startup and
+// kept current by the admin write paths (PUT /api/config, the reinit posts);
+// with SHARED_STATE=1 also by lib/shared.js picking up the other instances' writes.
+let savedConfig = null;    // the global config document
+const reinitFlags = {};    // deviceId → { pending, sent } active reinit_flags docs
+
+function flagsOf(id) {
+  return reinitFlags[id] ??= { pending: null, sent: null };
+}
+let traceCol = null;    // 1Hz helicorder summaries, one doc per heartbeat
+let stormCol = null;    // per-minute summaries of minor captures folded in a storm cooldown
+let bootCol = null;     // boot-phase reports, one doc per boot
+let blackboxCol = null; // pulls answered from a device's flash black box, one doc per pull
+let shared = null;      // SharedState when SHARED_STATE=1
+let eventFeed = null;   // EventFeed when SERVER_ROLE=dashboard
+let notifier = null;    // Notifier when NOTIFY_URLS is set
+let seedlink = null;    // SeedLinkServer when SEEDLINK_PORT is set
+let streamStore = null; // StreamStore unless STREAM_STORE_DAYS=0
+let soakTests = null;   // SoakTests over soak_runs
+let stacker = null;     // Stacker over the UDP streams unless STACK_DETECT=off
+let sessions = null;    // SessionServer when SESSION_PORT is set
+let stackCol = null;    // its detections
+let analysis = null;    // WorkerPool running lib/analysis-worker.js
+
 // ── Express + Socket.IO setup ────────────────────────────────────
 const app = express();
-const server = http.createServer(app);
-const io = new SocketIO(server, { cors: { origin: '*' } });
+const server = TLS_CERT && TLS_KEY ? createTlsServer(app, TLS_CERT, TLS_KEY) : http.createServer(app);
+// Devices hold one keep-alive socket open between heartbeats (up to ~60s
+// apart); Node's 5s default would close it before every heartbeat (and over
+// TLS, make each one a handshake)
+server.keepAliveTimeout = 5 * 60 * 1000;
+server.headersTimeout = server.keepAliveTimeout + 5000;
+// Sockets speak msgpack (lib/socketparser.js): binary frames inline, no JSON text
+const io = new SocketIO(server, { cors: { origin: '*' }, parser: socketParser });
+// All pushes to the dashboards go through here. Replicas share one room set
+// (Mongo adapter, see main()) but each only buffers its own messages, so a
+// reconnect there is always a refetch
+const live = new LiveChannel(io, { replay: !SHARED_STATE });
+new LiveStream(io, streams);   // 'stream:watch' → per-client binary 'stream:frame's of the UDP streams
+const statusFeed = new StatusFeed(deviceStatus, () => DEVICE_IDS, (type, payload) => live.publish(type, payload),
+  { intervalMs: DEVICE_STATUS_MS, isOnline: (id) => deviceOnline(id), expiresAt: deviceExpiry }).start();
+const tuner = THRESHOLD_TUNING === 'off' ? null : new ThresholdTuner({ margin: TUNING_MARGIN });
+// When the request head arrived, before its body is read (eventLatency)
+app.use((req, res, next) => { req.receivedAt = Date.now(); next(); });
 app.use(cors());
-app.use(express.json({ limit: '50kb' }));  // increased for waveform payloads
+app.use(compress());   // brotli/gzip for bodies of 1KB or more
+// Waveform uploads are decoded as they stream in, to their device's budget
+// (readSeismicBody); the parsers below then leave them be
+app.use('/api/seismic', (req, res, next) => {
+  if (req.method !== 'POST') return next();
+  readSeismicBody(req).then((body) => {
+    req.body = body;
+    req._body = true;
+    next();
+  }, (err) => res.status(err.status || 400).json({ error: err.message }));
+});
+app.use(express.json({ limit: '50kb' }));
+app.use(express.raw({ type: [blackbox.CONTENT_TYPE], limit: '50kb' }));
+
+// Browsers belong on the dashboard instances; an ingest one only relays
+// its own pushes to them through the adapter
+if (SERVER_ROLE === 'ingest') io.use((socket, next) => next(new Error('ingest instance: connect to a dashboard one')));
 
 // Socket.IO connection logging
 io.on('connection', (socket) => {
@@ -71,254 +677,2124 @@ io.on('connection', (socket) => {
   socket.on('disconnect', () => console.log(`[WS] client disconnected: ${socket.id}`));
 });
 
-// HTTP traffic logging middleware
+// HTTP traffic logging middleware. Counted once the response is done, by
+// route pattern (known only after routing), at the time it arrived. Routed
+// requests also go into the latency histogram; static files don't.
 app.use((req, res, next) => {
-  if (req.path.startsWith('/api')) {
-    httpLogs.push({ timestamp: new Date().toISOString(), endpoint: req.path });
-    if (httpLogs.length > 10000) httpLogs = httpLogs.slice(-5000);
-  }
+  const api = req.path.startsWith('/api');
+  const at = Date.now();
+  res.on('close', () => {
+    const route = req.route ? req.baseUrl + req.route.path : null;
+    if (api) httpLog.record(route || req.path, at);
+    if (route || api) {
+      metricHttp.observe({ method: req.method, route: route || '(unmatched)', code: res.statusCode }, (Date.now() - at) / 1000);
+    }
+  });
   next();
 });
 
+// Heartbeat i2c_* params are cumulative since boot; keep the latest plus the
+// change since the previous heartbeat (a reboot resets the baseline).
+function parseBusStats(id, query, now) {
+  const fields = { transactions: 'i2c_tx', timeouts: 'i2c_to', nacks: 'i2c_nack',
+                   errors: 'i2c_err', bytes: 'i2c_bytes', micros: 'i2c_us' };
+  const cur = {};
+  for (const [k, q] of Object.entries(fields)) {
+    const v = parseInt(query[q], 10);
+    if (!Number.isFinite(v) || v < 0) return null;
+    cur[k] = v;
+  }
+  const prev = lastBusStats[id];
+  let delta = null;
+  if (prev && cur.transactions >= prev.transactions) {
+    const dt = now - prev.at;
+    delta = {};
+    for (const k of Object.keys(fields)) delta[k] = cur[k] - prev[k];
+    delta.busy_pct = dt > 0 ? Math.round(delta.micros / (dt * 10) * 100) / 100 : null;
+  }
+  lastBusStats[id] = { ...cur, at: now, delta };
+  return lastBusStats[id];
+}
+
+// Heartbeat heap_* params: latest sample plus the window's worst values
+function parseHeapQuery(query) {
+  const num = (k) => { const v = parseInt(query[k], 10); return Number.isFinite(v) && v >= 0 ? v : null; };
+  const free = num('heap_free');
+  if (free == null) return null;
+  return {
+    free, max_block: num('heap_block'), frag_pct: num('heap_frag'),
+    min_free: num('heap_min'), max_frag_pct: num('heap_frag_max'),
+    time: new Date().toISOString(),
+  };
+}
+
+// Upload queue on the heartbeat (src/async_upload.h):
+// upq=queued,queued_bytes,state,refused and capq=spilled,streamed,dropped
+const UPLOAD_STATES = ['idle', 'sending', 'await_status', 'await_headers', 'drain_body', 'mqtt'];
+function parseUploadQuery(query) {
+  if (typeof query.upq !== 'string') return null;
+  const [queued, bytes, state, refused] = query.upq.split(',').map(v => parseInt(v, 10));
+  if (![queued, bytes, state, refused].every(Number.isFinite)) return null;
+  const [spilled, streamed, dropped] = String(query.capq ?? '').split(',').map(v => parseInt(v, 10));
+  return {
+    queued, queued_bytes: bytes, state: UPLOAD_STATES[state] ?? `state_${state}`, refused,
+    spilled: Number.isFinite(spilled) ? spilled : null,
+    streamed: Number.isFinite(streamed) ? streamed : null,
+    dropped: Number.isFinite(dropped) ? dropped : null,
+  };
+}
+
+// Events the device's journal dropped before they reached us
+// (src/event_journal.h): evict=unreported,seq:level,... newest first. Sent
+// until a heartbeat gets through, so each report is new drops.
+const EVENT_LEVELS = ['minor', 'moderate', 'severe'];
+function parseEvictQuery(id, query) {
+  if (typeof query.evict !== 'string') return null;
+  const [count, ...listed] = query.evict.split(',');
+  const n = parseInt(count, 10);
+  if (!Number.isFinite(n) || n <= 0) return null;
+  const recent = listed.map(e => e.split(':').map(v => parseInt(v, 10)))
+    .filter(([seq, level]) => Number.isFinite(seq) && Number.isFinite(level))
+    .map(([seq, level]) => ({ seq, level: EVENT_LEVELS[level] ?? `level_${level}` }));
+  const prev = lastEvictions[id];
+  lastEvictions[id] = {
+    total: (prev?.total ?? 0) + n,
+    recent: [...recent, ...(prev?.recent ?? [])].slice(0, 20),
+    time: new Date().toISOString(),
+  };
+  console.warn(`[JOURNAL] ${translationDict[id] || id} dropped ${n} unsent event(s): ` +
+    recent.map(e => `#${e.seq} ${e.level}`).join(', '));
+  return lastEvictions[id];
+}
+
+// Heartbeat task_<name>=runs,late,overruns,max_us (src/task_scheduler.h)
+function parseTaskQuery(query) {
+  const tasks = {};
+  for (const [k, v] of Object.entries(query)) {
+    if (!k.startsWith('task_') || typeof v !== 'string') continue;
+    const [runs, late, overruns, maxUs] = v.split(',').map(n => parseInt(n, 10));
+    if (![runs, late, overruns, maxUs].every(Number.isFinite)) continue;
+    tasks[k.slice(5)] = { runs, late, overruns, max_us: maxUs };
+  }
+  if (Object.keys(tasks).length === 0) return null;
+  return { tasks, time: new Date().toISOString() };
+}
+
+// X-Heap: "<free>,<max block>,<frag %>" read when an upload was sent
+function parseHeapHeader(value) {
+  if (typeof value !== 'string') return null;
+  const [free, maxBlock, frag] = value.split(',').map(v => parseInt(v, 10));
+  if (![free, maxBlock, frag].every(Number.isFinite)) return null;
+  return { free, max_block: maxBlock, frag_pct: frag };
+}
+
+// Mark a pending reinit flag as sent; true if there was one (answer 205)
+async function takeReinit(id) {
+  const flags = flagsOf(id);
+  const flag = flags.pending;
+  if (!flag) return false;
+  try {
+    const sentAt = new Date().toISOString();
+    // Only if still pending: with several instances, one of them sends the 205
+    const r = await reinitCol.updateOne(
+      { _id: flag._id, status: 'pending' },
+      { $set: { status: 'sent', sent_at: sentAt } }
+    );
+    if (r.matchedCount === 0) {
+      flags.pending = null;
+      return false;
+    }
+    flags.sent = { ...flag, status: 'sent', sent_at: sentAt };
+    flags.pending = null;
+    live.publish('device:reinit_sent', { id, alias: translationDict[id], time: new Date().toISOString() }, id);
+    console.log(`[REINIT] Sending 205 to ${translationDict[id]} (${id})`);
+    return true;
+  } catch (e) {
+    console.error('Reinit check error:', e.message);
+    return false;
+  }
+}
+
+// What a push poll should answer now: 205 reinit, 202 stale config, 203 pull, 0 nothing yet
+async function pushPending(id, gen) {
+  if (await takeReinit(id)) return 205;
+  if (Number.isFinite(gen) && gen !== (configGens[id] || 0)) return 202;
+  if (pendingPulls[id]) return 203;
+  return 0;
+}
+
+function answerPush(res, id, code) {
+  if (code === 205) return res.status(205).json({ status: 'reinit' });
+  if (code === 202) return res.status(202).json({ status: 'config_changed', config_gen: configGens[id] || 0 });
+  if (code === 203) return res.status(203).json({ status: 'pull' });
+  return res.status(204).end();
+}
+
+// Answer a held push poll if there's now something for it
+async function notifyPush(id) {
+  if (sessions?.live(id) && !pushWaiters[id]) return notifySession(id);
+  if (mqttLive[id]) return notifyMqtt(id);
+  const waiter = pushWaiters[id];
+  if (!waiter) return;
+  const code = await pushPending(id, waiter.gen);
+  if (!code || pushWaiters[id] !== waiter) return;
+  clearTimeout(waiter.timer);
+  delete pushWaiters[id];
+  statusChanged(id);
+  console.log(`[PUSH] ${code} to ${translationDict[id]} (${id})`);
+  answerPush(waiter.res, id, code);
+}
+
+// ── GET /api/push (device long-poll, see src/push_channel.h) ─────
+async function onPush(req, res) {
+  const { id } = req.query;
+  if (!id) return res.status(400).json({ error: 'Missing id parameter' });
+  markSeen(id);
+  const gen = parseInt(req.query.cfg, 10);
+
+  // A device holds one poll at a time; a new one means the old socket is gone
+  const old = pushWaiters[id];
+  if (old) {
+    clearTimeout(old.timer);
+    delete pushWaiters[id];
+  }
+
+  const code = await pushPending(id, gen);
+  if (code) return answerPush(res, id, code);
+
+  const waiter = { res, gen };
+  waiter.timer = setTimeout(() => {
+    if (pushWaiters[id] === waiter) delete pushWaiters[id];
+    markSeen(id);
+    answerPush(res, id, 0);
+  }, PUSH_HOLD_MS);
+  pushWaiters[id] = waiter;
+  statusChanged(id);
+  req.on('close', () => {
+    if (pushWaiters[id] !== waiter) return;
+    clearTimeout(waiter.timer);
+    delete pushWaiters[id];
+    statusChanged(id);
+  });
+}
+app.get('/api/push', onPush);
+
 // ── ESP8266 heartbeat (must come before static middleware) ───────
-app.get('/', async (req, res, next) => {
+async function onHeartbeat(req, res, next) {
   if (req.query.id) {
     const id = req.query.id;
-    if (!translationDict[id]) translationDict[id] = id;
-    lastEventTimes[id] = new Date();
+    markSeen(id);
+    const nowMs = Date.now();
+    if (lastHeartbeatMs[id]) metricHeartbeatGap.observe({ device: id }, (nowMs - lastHeartbeatMs[id]) / 1000);
+    lastHeartbeatMs[id] = nowMs;
+    // One the broker held for us arrived late by an unknown amount
+    if (!req.queued) (clockFits[id] ??= new ClockFit()).add(parseInt(req.query.boot, 10), parseInt(req.query.ms, 10), req.receivedAt);
     // Notify dashboard of heartbeat
-    io.emit('device:heartbeat', { id, alias: translationDict[id], time: new Date().toISOString() });
+    const tempC = parseFloat(req.query.temp_c);
+    if (Number.isFinite(tempC)) lastTemps[id] = tempC;
+    const bus = parseBusStats(id, req.query, Date.now());
+    const profile = decodeProfile(req.query);
+    if (profile) {
+      lastProfiles[id] = { ...profile, time: new Date().toISOString() };
+      for (const [phase, p] of Object.entries(profile.phases)) {
+        metricLoopPhase.addBuckets({ device: id, phase }, p.buckets, p.total_us / 1e6);
+      }
+      profile.intervals?.buckets.forEach((n, k) => hourlyStats?.add(id, 'jitter_ms', ISI_BUCKET_MS[k], Date.now(), n));
+    }
+    const heap = parseHeapQuery(req.query);
+    if (heap) lastHeap[id] = heap;
+    soakTests?.heartbeat(id, heap, profile, deviceFirmwareVersions[id])
+      .catch(e => console.error('Soak write error:', e.message));
+    const ota = parseOtaQuery(id, req.query);
+    const boot = parseBootQuery(id, req.query);
+    const tasks = parseTaskQuery(req.query);
+    if (tasks) lastTasks[id] = tasks;
+    if (req.query.inject && req.query.inject !== '0') parseInjectQuery(id, req.query.inject);
+    const taps = parseInt(req.query.taps, 10);
+    if (Number.isFinite(taps)) lastTaps[id] = taps;
+    const bbox = blackbox.parseBlackBoxQuery(req.query);
+    if (bbox) lastBlackBox[id] = bbox;
+    const tls = parseTlsQuery(req.query);
+    if (tls) lastTls[id] = tls;
+    const uploads = parseUploadQuery(req.query);
+    if (uploads) lastUploads[id] = uploads;
+    const mqttStats = parseMqttQuery(req.query);
+    if (mqttStats) lastMqtt[id] = mqttStats;
+    const sessionStats = parseSessionQuery(req.query);
+    if (sessionStats) lastSession[id] = sessionStats;
+    parseEvictQuery(id, req.query);
+    statusFeed.touch(id);   // its fields go out in the next devices:status
+
+    // Store the helicorder seconds piggybacked on this heartbeat; the answer
+    // doesn't wait for the write
+    const trace = decodeTrace(req.query);
+    if (trace) {
+      if (tuner) tuner.addTrace(id, trace, deviceConfig(savedConfig, id).detect_metric);
+      const doc = { id, alias: translationDict[id], ...trace };
+      traceCol.insertOne(doc)
+        .then(() => live.publish('device:trace', doc, id))
+        .catch(e => console.error('Trace write error:', e.message));
+    }
+
+    // Minor captures folded on the device, one doc per minute per heartbeat
+    // (a minute still open when a heartbeat went out continues in the next)
+    const storm = decodeStorm(req.query);
+    if (storm) {
+      for (const m of storm) metricStormFolded.inc({ device: id }, m.count);
+      live.publish('device:storm', { id, alias: translationDict[id], minutes: storm }, id);
+      stormCol.insertMany(storm.map(m => ({ id, alias: translationDict[id], ...m })))
+        .catch(e => console.error('Storm write error:', e.message));
+    }
 
     // Check for pending reinit flag
-    try {
-      const flag = await reinitCol.findOne({ deviceId: id, status: 'pending' });
-      if (flag) {
-        await reinitCol.updateOne(
-          { _id: flag._id },
-          { $set: { status: 'sent', sent_at: new Date().toISOString() } }
-        );
-        io.emit('device:reinit_sent', { id, alias: translationDict[id], time: new Date().toISOString() });
-        console.log(`[REINIT] Sending 205 to ${translationDict[id]} (${id})`);
-        return res.status(205).json({ status: 'reinit' });
-      }
-    } catch (e) { console.error('Reinit check error:', e.message); }
+    if (await takeReinit(id)) return res.status(205).json({ status: 'reinit' });
 
     // Auto-complete any stale 'sent' reinit flags (fallback if /api/init wasn't called)
-    try {
-      const cutoff = new Date(Date.now() - 60 * 1000).toISOString(); // 60s timeout
-      const nowIso = new Date().toISOString();
-      const result = await reinitCol.updateMany(
-        { deviceId: id, status: 'sent', sent_at: { $lte: cutoff } },
-        { $set: { status: 'completed', completed_at: nowIso } }
-      );
-      if (result && result.modifiedCount > 0) {
-        io.emit('device:reinit_completed', { id, alias: translationDict[id], time: nowIso });
+    const cutoff = new Date(Date.now() - 60 * 1000).toISOString(); // 60s timeout
+    if (reinitFlags[id]?.sent && reinitFlags[id].sent.sent_at <= cutoff) {
+      try {
+        const nowIso = new Date().toISOString();
+        await reinitCol.updateMany(
+          { deviceId: id, status: 'sent', sent_at: { $lte: cutoff } },
+          { $set: { status: 'completed', completed_at: nowIso } }
+        );
+        reinitFlags[id].sent = null;
+        live.publish('device:reinit_completed', { id, alias: translationDict[id], time: nowIso }, id);
         console.log(`[REINIT] Auto-completed for ${translationDict[id]} (${id})`);
-      }
-    } catch (e) { console.error('Reinit auto-complete error:', e.message); }
+      } catch (e) { console.error('Reinit auto-complete error:', e.message); }
+    }
+
+    // Config saved since this device's last /api/init: have it reload in place.
+    // Firmware that doesn't send cfg only picks changes up on a reinit.
+    const gen = parseInt(req.query.cfg, 10);
+    const currentGen = configGens[id] || 0;
+    if (Number.isFinite(gen) && gen !== currentGen) {
+      console.log(`[CONFIG] ${translationDict[id]} (${id}) on generation ${gen}, sending 202 for ${currentGen}`);
+      return res.status(202).json({ status: 'config_changed', config_gen: currentGen });
+    }
+    // Binary-init firmware also sends the CRC of the settings it runs on,
+    // which after a warm reboot are its RTC copy: a change no generation
+    // counts (a new broker or session port) has it reload as well
+    const cfh = parseInt(req.query.cfh, 16);
+    if (Number.isFinite(gen) && Number.isFinite(cfh) && cfh !== initConfigCrc(id)) {
+      console.log(`[CONFIG] ${translationDict[id]} (${id}) settings differ from generation ${currentGen}, sending 202`);
+      return res.status(202).json({ status: 'config_changed', config_gen: currentGen });
+    }
+    // Firmware without cfg predates pulls too
+    if (Number.isFinite(gen) && pendingPulls[id]) return res.status(203).json({ status: 'pull' });
+    // Only test builds send inject
+    if (req.query.inject !== undefined && pendingInjects[id]) return res.status(207).json({ status: 'inject' });
 
     return res.json({ status: 'ok', time: new Date().toISOString() });
   }
   next();
-});
+}
+app.get('/', onHeartbeat);
 
-// ── Consensus window logic ──────────────────────────────────────
-async function onWindowEnd() {
-  console.log('----- window end');
-  if (DEVICE_IDS.every(id => windowDevices.has(id))) {
-    console.log('\x1b[92mConfirmed!!!\x1b[0m');
-    const entry = {
-      timestamp: new Date().toISOString(),
-      status: 'CONFIRMED',
-      devices: DEVICE_IDS,
-      aliases: DEVICE_IDS.map(d => translationDict[d] || d),
-    };
+// Events stored before waveforms had their own collection: move each
+// embedded array over in the stored form, 100 at a time, in the background
+async function migrateEmbeddedWaveforms() {
+  let moved = 0;
+  for (;;) {
+    const docs = await eventsCol.find({ waveform: { $type: 'array' } },
+      { projection: { id: 1, waveform: 1 } }).limit(100).toArray();
+    if (!docs.length) break;
+    const waves = docs.map(d => ({ _id: d._id, id: d.id, ...waveform.packWaveform(d.waveform) }));
+    try {
+      await waveformsCol.insertMany(waves, { ordered: false });
+    } catch (e) {
+      if (!e.writeErrors || ![].concat(e.writeErrors).every(w => w.code === 11000)) throw e;
+    }
+    await eventsCol.bulkWrite(waves.map(w => ({
+      updateOne: { filter: { _id: w._id }, update: { $unset: { waveform: '' }, $set: { waveform_samples: w.count } } },
+    })));
+    for (const w of waves) recent.patch(w._id, { waveform_samples: w.count });
+    moved += docs.length;
+    bumpVersion('events');
+  }
+  if (moved) console.log(`[WAVEFORM] Moved ${moved} embedded waveforms to the waveforms collection`);
+}
+
+// ── Consensus ───────────────────────────────────────────────────
+// Devices not in the registry ride along in the default group as non-members
+function consensusFor(id) {
+  return consensusGroups.get(registry?.groupOf(id) ?? DEFAULT_GROUP) || consensusGroups.get(DEFAULT_GROUP);
+}
+
+// One engine per registry group, members and settings as they are now
+function configureConsensus() {
+  const saved = deviceConfig(savedConfig, null);
+  const names = registry ? registry.groupNames() : [DEFAULT_GROUP];
+  for (const name of consensusGroups.keys()) if (!names.includes(name)) consensusGroups.delete(name);
+  for (const name of names) {
+    let engine = consensusGroups.get(name);
+    if (!engine) {
+      consensusGroups.set(name, engine = new ConsensusEngine({ horizonMs: CONSENSUS_HORIZON_MS }));
+      engine.group = name;
+    }
+    const g = registry?.group(name);
+    engine.configure({
+      windowMs: g?.window_ms ?? saved.consensus_window_ms,
+      quorum: g?.quorum ?? saved.consensus_quorum,
+      provisional: saved.consensus_provisional,
+      members: registry ? registry.members(name) : DEVICE_IDS,
+    });
+  }
+}
+
+// Registered devices into DEVICE_IDS, translationDict and the engines
+function syncRegistry() {
+  DEVICE_IDS.splice(0, DEVICE_IDS.length, ...registry.ids());
+  for (const id of DEVICE_IDS) translationDict[id] = registry.get(id).alias || translationDict[id] || id;
+  configureConsensus();
+  statusChanged();
+}
+
+// Source direction / location from the cluster's arrival times and the
+// registry's coordinates. The Locator is kept per cluster, so each joining
+// device is one more row; -> the new location, or undefined if nothing was added
+function locateCluster(cluster) {
+  let loc = consensusLocators.get(cluster);
+  if (!loc) {
+    const velocity = deviceConfig(savedConfig, null).locate_velocity_m_s;
+    consensusLocators.set(cluster, loc = new Locator({ velocity: velocity > 0 ? velocity : null }));
+  }
+  let added = false;
+  for (const [id, timeMs] of Object.entries(cluster.arrivals)) added = loc.add(id, timeMs, registry?.get(id)) || added;
+  return added ? loc.solve() : undefined;
+}
+
+function dropCluster(cluster) {
+  consensusEntries.delete(cluster);
+  consensusLocators.delete(cluster);
+}
+
+// One live trigger into its group's engine: here for a single instance, on
+// the lease holder (from the shared trigger log) with SHARED_STATE=1
+// Through the shared trigger log when replicas share state
+function triggerConsensus(id, timeMs) {
+  tuner?.trigger(id);
+  if (shared) shared.trigger(id, timeMs).catch(e => console.error('Trigger share error:', e.message));
+  else placeTrigger(id, timeMs);
+}
+
+function placeTrigger(id, timeMs) {
+  const engine = consensusFor(id);
+  const placed = engine.add(id, timeMs);
+  if (placed?.provisional) onProvisional(engine, placed.provisional);
+  else if (placed) onConsensus(engine, placed.cluster, placed.confirmed, id);
+}
+
+// consensus_provisional members are in before the quorum: say so now, and
+// retract it if no cluster has claimed it once the window plus the time
+// for the rest to report is over. Not stored; the confirmation, if it
+// comes, is the usual seismic:consensus with this provisional_id.
+const PROVISIONAL_SETTLE_MS = 5000;
+const provisionalId = (engine, p) => `${engine.group}:${p.startMs}`;
+
+function onProvisional(engine, p) {
+  const payload = () => ({
+    provisional_id: provisionalId(engine, p),
+    timestamp: new Date(p.startMs).toISOString(),
+    devices: [...p.devices],
+    aliases: p.devices.map(d => translationDict[d] || d),
+    members: p.members,
+    quorum: p.required,
+    window_ms: engine.windowMs,
+    group: engine.group,
+    arrivals: { ...p.arrivals },
+  });
+  console.log(`\x1b[93mProvisional\x1b[0m ${p.members}/${p.required} nodes of ${engine.group} ` +
+    `within ${p.endMs - p.startMs}ms`);
+  live.publish('seismic:consensus_provisional', payload());
+  setTimeout(() => {
+    if (p.cluster) return;
+    console.log(`[CONSENSUS] provisional ${provisionalId(engine, p)} retracted: ${p.members}/${p.required} nodes`);
+    live.publish('seismic:consensus_retracted', payload());
+  }, Math.max(0, p.startMs + engine.windowMs + PROVISIONAL_SETTLE_MS - Date.now()));
+}
+
+// Called for every live trigger an engine places in a cluster: the one
+// that reaches the quorum stores the CONFIRMED entry, later ones join it.
+async function onConsensus(engine, cluster, confirmed, id) {
+  if (!confirmed) {
+    const entry = consensusEntries.get(cluster);
+    if (!entry) return;
+    if (entry.devices.includes(id)) return;
+    tuner?.corroborated(id);
+    console.log(`[CONSENSUS] ${translationDict[id] || id} joined ${entry.timestamp}`);
+    entry.devices.push(id);
+    entry.aliases.push(translationDict[id] || id);
+    coherenceChecks.get(entry._id?.toString())?.waiting.add(id);
+    entry.members = cluster.members;
+    entry.arrivals = { ...cluster.arrivals };
+    linkMembers(entry);
+    const location = locateCluster(cluster);
+    if (location !== undefined) entry.location = location;
+    try {
+      if (entry._id) {
+        const set = { devices: entry.devices, members: entry.members, arrivals: entry.arrivals,
+                      member_events: entry.member_events, location: entry.location ?? null, modified: new Date() };
+        await eventsCol.updateOne({ _id: entry._id }, { $set: set });
+        recent.patch(entry._id, set);
+        bumpVersion('events');
+        // Dashboards replace the entry by _id
+        if (location && entry.status === 'CONFIRMED') live.publish('seismic:consensus', { ...entry, _id: entry._id.toString() });
+      }
+    } catch (e) { console.error('Consensus write error:', e.message); }
+    return;
+  }
+
+  // With consensus_coherence set the entry is a CANDIDATE until its
+  // waveforms have been correlated (checkCoherence)
+  const threshold = analysis ? deviceConfig(savedConfig, null).consensus_coherence : null;
+  const gated = threshold > 0;
+  console.log(`\x1b[92m${gated ? 'Candidate' : 'Confirmed!!!'}\x1b[0m ${cluster.members}/${engine.members.length} nodes ` +
+    `of ${engine.group} within ${cluster.endMs - cluster.startMs}ms`);
+  const entry = {
+    timestamp: new Date(cluster.startMs).toISOString(),   // first trigger in the window
+    time: new Date(cluster.startMs),
+    modified: new Date(),
+    confirmed_at: gated ? null : new Date().toISOString(),
+    status: gated ? 'CANDIDATE' : 'CONFIRMED',
+    devices: [...cluster.devices],
+    aliases: cluster.devices.map(d => translationDict[d] || d),
+    members: cluster.members,
+    quorum: cluster.required,
+    window_ms: engine.windowMs,
+    group: engine.group,
+    site: registry?.group(engine.group)?.site ?? null,
+    arrivals: { ...cluster.arrivals },   // deviceId → first trigger (epoch ms)
+    location: locateCluster(cluster) ?? null,
+    provisional_id: cluster.provisional ? provisionalId(engine, cluster.provisional) : null,
+  };
+  for (const d of cluster.devices) tuner?.corroborated(d);
+  linkMembers(entry);
+  if (entry.location) {
+    const l = entry.location;
+    console.log(`[LOCATE] ${l.method}, ${l.nodes} nodes: back azimuth ${l.back_azimuth_deg?.toFixed(0)}°` +
+      (l.lat != null ? `, ${l.lat.toFixed(5)},${l.lon.toFixed(5)}` : '') + ` (rms ${l.rms_ms.toFixed(1)}ms)`);
+  }
+  consensusEntries.set(cluster, entry);
+  setTimeout(() => dropCluster(cluster), CONSENSUS_HORIZON_MS);
+  try {
+    const stored = schema.compact(entry);
+    await eventsCol.insertOne(stored);
+    entry._id = stored._id;
+    recent.add(stored);
+    bumpVersion('events');
+    if (gated) {
+      scheduleCoherence(entry, threshold);
+    } else {
+      live.publish('seismic:consensus', { ...entry, _id: entry._id?.toString() });
+      notifyConsensus(entry);
+      setTimeout(() => correlateConsensus(entry),
+        Math.max(0, cluster.startMs + REPLAY_STALE_MS - Date.now()));
+    }
+  } catch (e) { console.error('Consensus write error:', e.message); }
+
+  // Everything else in the group seen recently (e.g. a node outside the
+  // quorum) that hasn't reported by the time the span is over: ask for its
+  // ring around the event
+  const pull = {
+    pull_id: entry._id?.toString() || null,
+    from_ms: cluster.startMs - PULL_PRE_MS,
+    to_ms: cluster.startMs + PULL_POST_MS,
+    center_ms: cluster.startMs,
+  };
+  setTimeout(() => {
+    const quiet = Object.keys(lastEventTimes).filter(d => !cluster.devices.includes(d) &&
+      consensusFor(d) === engine && Date.now() - lastEventTimes[d] < 5 * 60 * 1000);
+    quiet.forEach(d => requestPull(d, pull));
+  }, Math.max(0, pull.to_ms + 1000 - Date.now()));
+}
+
+// ── Waveform analysis ───────────────────────────────────────────
+// Each waveform is analysed in the worker pool once ingest has it in
+// Mongo, so uploads are answered exactly as fast as before. Results land on
+// the event as `analysis` (a `modified` bump, so /api/events/changes picks
+// it up) and go out as seismic:analysis.
+function analyzeFlushed(batch) {
+  if (!analysis) return;
+  for (const { event, waveform: wave } of batch) {
+    if (!wave) continue;
+    if (!event.status) waveformArrived(event);
+    analysis.run('event', { wave }).then(async (result) => {
+      if (!result) return;
+      const set = { analysis: result, modified: new Date() };
+      await eventsCol.updateOne({ _id: event._id }, { $set: set });
+      recent.patch(event._id, set);
+      bumpVersion('events');
+      live.publish('seismic:analysis', { _id: event._id.toString(), id: event.id, analysis: result }, event.id);
+    }).catch(e => console.error('Analysis error:', e.message));
+  }
+}
+
+// ── Consensus members ───────────────────────────────────────────
+// Each entry links the device events it was built from, as `member_events`
+// { deviceId: { event_id, deltaG, level, offset_ms } }, where offset_ms is
+// the device's first trigger after the entry's time. An event counts if it
+// is the device's from window_ms before the entry's time to 2 × window_ms
+// after (its capture can start before the first trigger in the cluster).
+// Links are made at the quorum and at each join from the uploads already
+// in (still queued, or in the recent window), and by each upload that
+// comes in while its cluster is live.
+const inMemberWindow = (entry, timeMs) =>
+  timeMs >= entry.time.getTime() - entry.window_ms && timeMs <= entry.time.getTime() + 2 * entry.window_ms;
+
+function memberLink(entry, event) {
+  return { event_id: event._id.toString(), deltaG: event.deltaG ?? null, level: schema.levelOf(event) ?? null,
+           offset_ms: (entry.arrivals?.[event.id] ?? event.time.getTime()) - entry.time.getTime() };
+}
+
+// Link every device of entry that has no event yet; -> true if any was added
+function linkMembers(entry) {
+  entry.member_events ??= {};
+  const from = entry.time.getTime() - entry.window_ms;
+  const candidates = [...ingest.queue.map(item => item.event),
+                      ...recent.events({ fromMs: from, untilMs: entry.time.getTime() + 2 * entry.window_ms + 1, ids: entry.devices })];
+  let added = false;
+  for (const event of candidates.sort((a, b) => a.time - b.time)) {
+    if (event.status || entry.member_events[event.id] || !entry.devices.includes(event.id)) continue;
+    if (!inMemberWindow(entry, event.time.getTime())) continue;
+    entry.member_events[event.id] = memberLink(entry, event);
+    added = true;
+  }
+  return added;
+}
+
+// A device upload just journaled: into every live entry it belongs to
+async function linkUpload(event) {
+  for (const entry of consensusEntries.values()) {
+    if (!entry.devices.includes(event.id) || entry.member_events?.[event.id]) continue;
+    if (!inMemberWindow(entry, event.time.getTime())) continue;
+    (entry.member_events ??= {})[event.id] = memberLink(entry, event);
+    if (!entry._id) continue;   // the insert in flight carries it
     try {
-      await eventsCol.insertOne(entry);
-      io.emit('seismic:consensus', entry);
+      const set = { member_events: entry.member_events, modified: new Date() };
+      await eventsCol.updateOne({ _id: entry._id }, { $set: set });
+      recent.patch(entry._id, set);
+      bumpVersion('events');
     } catch (e) { console.error('Consensus write error:', e.message); }
   }
-  windowDevices.clear();
-  windowTimer = null;
+}
+
+// deviceId -> the member event (id, time, deltaG, level; stored or still
+// queued): the linked ones by _id, and for devices without a link (an
+// upload another instance took, an entry from before links) the first
+// event in the window
+const MEMBER_PROJECTION = { id: 1, time: 1, deltaG: 1, lv: 1, level: 1 };
+async function memberEvents(entry) {
+  const members = new Map();
+  const linked = Object.values(entry.member_events || {}).map(m => m.event_id).filter(h => ObjectId.isValid(h));
+  const stored = linked.length
+    ? await eventsCol.find({ _id: { $in: linked.map(h => new ObjectId(h)) } }, { projection: MEMBER_PROJECTION }).toArray() : [];
+  for (const e of stored) members.set(e.id, e);
+  for (const hex of linked) {
+    const queued = ingest.pending(hex)?.event;
+    if (queued && !members.has(queued.id)) members.set(queued.id, queued);
+  }
+  const missing = entry.devices.filter(id => !members.has(id));
+  if (!missing.length) return members;
+  const t = entry.time.getTime();
+  const found = await eventsCol.find(
+    { id: { $in: missing }, status: { $exists: false },
+      time: { $gte: new Date(t - entry.window_ms), $lte: new Date(t + 2 * entry.window_ms) } },
+    { projection: MEMBER_PROJECTION }).sort(queries.NEWEST_FIRST).hint(queries.DEVICE_INDEX).toArray();
+  for (const e of found.reverse()) if (!members.has(e.id)) members.set(e.id, e);
+  return members;
+}
+
+// Once a consensus' captures are in (uploads trail the trigger by up to
+// max_post_ms plus upload time), line its devices' waveforms up against
+// each other: `correlation` { reference, lags: { id: { lag_ms, r } } }
+async function correlateConsensus(entry) {
+  if (!analysis || !entry._id) return null;
+  const windowMs = entry.window_ms;
+  try {
+    const first = await memberEvents(entry);
+    if (first.size < 2) return null;
+    const stored = await waveformsCol.find({ _id: { $in: [...first.values()].map(e => e._id) } }).toArray();
+    const waves = stored.map(w => {
+      const e = [...first.values()].find(ev => ev._id.equals(w._id));
+      return { id: e.id, at_ms: e.time.getTime(), wave: { count: w.count, scale: w.scale, ...waveform.storedBuffers(w) } };
+    });
+    const correlation = await analysis.run('correlate', { waves, max_lag_ms: windowMs });
+    if (!correlation) return null;
+    entry.correlation = correlation;
+    const set = { correlation, modified: new Date() };
+    await eventsCol.updateOne({ _id: entry._id }, { $set: set });
+    recent.patch(entry._id, set);
+    bumpVersion('events');
+    if (entry.status === 'CONFIRMED') live.publish('seismic:analysis', { _id: entry._id.toString(), correlation });
+    return correlation;
+  } catch (e) {
+    console.error('Correlation error:', e.message);
+    return null;
+  }
+}
+
+// ── Coherence gate (consensus_coherence) ────────────────────────
+// Footsteps in three rooms can trigger three nodes within the window; a
+// real event shakes them all alike. A CANDIDATE waits for its devices'
+// waveforms (or REPLAY_STALE_MS) and is then CONFIRMED if at least `quorum`
+// of the waveforms, the earliest included, correlate with the earliest at
+// r >= threshold, else marked INCOHERENT. With fewer than two waveforms
+// there is nothing to compare and it is confirmed as before.
+const coherenceChecks = new Map();   // entry _id hex → { entry, threshold, waiting: Set, timer }
+
+function scheduleCoherence(entry, threshold) {
+  const key = entry._id.toString();
+  const timer = setTimeout(() => checkCoherence(key),
+    Math.max(0, entry.time.getTime() + REPLAY_STALE_MS - Date.now()));
+  coherenceChecks.set(key, { entry, threshold, waiting: new Set(entry.devices), timer });
+}
+
+// A flushed capture: the last one a candidate waited for runs its check
+function waveformArrived(event) {
+  const t = event.time?.getTime();
+  for (const [key, check] of coherenceChecks) {
+    const start = check.entry.time.getTime();
+    if (!check.waiting.has(event.id) || t < start - check.entry.window_ms || t > start + 2 * check.entry.window_ms) continue;
+    check.waiting.delete(event.id);
+    if (!check.waiting.size) checkCoherence(key);
+  }
+}
+
+async function checkCoherence(key) {
+  const check = coherenceChecks.get(key);
+  if (!check) return;
+  coherenceChecks.delete(key);
+  clearTimeout(check.timer);
+  const { entry, threshold } = check;
+  const correlation = await correlateConsensus(entry);
+  const rs = correlation ? Object.values(correlation.lags).map(l => l.r) : [];
+  const checked = correlation ? rs.length + 1 : 0;
+  const coherent = correlation ? 1 + rs.filter(r => r >= threshold).length : 0;
+  const pass = checked < 2 || coherent >= Math.min(entry.quorum, checked);
+  entry.status = pass ? 'CONFIRMED' : 'INCOHERENT';
+  entry.coherence = { threshold, checked, coherent, r_min: rs.length ? Math.min(...rs) : null };
+  if (pass) entry.confirmed_at = new Date().toISOString();
+  try {
+    const set = { status: entry.status, coherence: entry.coherence, confirmed_at: entry.confirmed_at, modified: new Date() };
+    await eventsCol.updateOne({ _id: entry._id }, { $set: set });
+    recent.patch(entry._id, set);
+    bumpVersion('events');
+  } catch (e) { console.error('Consensus write error:', e.message); }
+  if (pass) {
+    console.log(`\x1b[92mConfirmed!!!\x1b[0m ${entry.timestamp}: ${coherent}/${checked} waveforms coherent`);
+    live.publish('seismic:consensus', { ...entry, _id: entry._id.toString() });
+    notifyConsensus(entry);
+  } else {
+    console.log(`[CONSENSUS] ${entry.timestamp} rejected: ${coherent}/${checked} waveforms at r >= ${threshold}`);
+  }
+}
+
+// A CONFIRMED entry into the webhook outbox; delivery is the workers'
+// business, so this is one insert per target and never waits on them
+function notifyConsensus(entry) {
+  if (!notifier || !entry._id) return;
+  const body = {
+    type: 'seismic:consensus',
+    _id: entry._id.toString(),
+    timestamp: entry.timestamp,
+    confirmed_at: entry.confirmed_at,
+    group: entry.group,
+    site: entry.site,
+    devices: entry.devices,
+    aliases: entry.aliases,
+    members: entry.members,
+    quorum: entry.quorum,
+    location: entry.location ?? null,
+  };
+  notifier.enqueue(`consensus:${body._id}`, body).catch(e => console.error('Notify enqueue error:', e.message));
+}
+
+// Event trigger time, best source first:
+//   X-Event-Time-Us, source "ntp"     device clock disciplined by SNTP (µs)
+//   X-Event-Millis + X-Boot, "fit"    trigger millis() through the heartbeat clock fit
+//   X-Event-Offset-Ms                 age at transmit time, so latency counts against it
+//   X-Event-Time-Us/-Ms, "server"     our clock at device init plus its millis();
+//                                     only age-free source for journal replays
+//   event_offset_ms                   age baked into the body when it was rendered
+// -> { eventTimeMs, timeUs (device µs or null), timeSource, fitMs (the fit's
+// time when there was one, to check an SNTP time against) }
+function eventTime(headers, data, now = Date.now(), fit = null) {
+  const us = Number(headers['x-event-time-us']);
+  const source = headers['x-event-time-source'] || 'server';
+  const legacyMs = parseInt(headers['x-event-time-ms'], 10);
+  const deviceMs = Number.isFinite(us) && us > 0 ? us / 1000
+    : Number.isFinite(legacyMs) && legacyMs > 0 ? legacyMs : null;
+  const fitMs = fit?.map(parseInt(headers['x-boot'], 10), parseInt(headers['x-event-millis'], 10)) ?? null;
+  if (deviceMs && source === 'ntp') {
+    return { eventTimeMs: deviceMs, timeUs: Math.round(us), timeSource: 'ntp', fitMs };
+  }
+  if (fitMs != null) return { eventTimeMs: fitMs, timeUs: null, timeSource: 'fit', fitMs };
+  const headerOffset = parseInt(headers['x-event-offset-ms'], 10);
+  if (Number.isFinite(headerOffset)) {
+    return { eventTimeMs: now - headerOffset, timeUs: null, timeSource: 'offset' };
+  }
+  if (deviceMs) return { eventTimeMs: deviceMs, timeUs: null, timeSource: 'server' };
+  return { eventTimeMs: now - (data.event_offset_ms || 0), timeUs: null, timeSource: 'offset' };
+}
+
+// ── Trigger notices (UDP, see lib/notice.js) ────────────────────
+// A notice places the trigger in consensus as the capture opens, at its
+// SNTP time or else its arrival (it is sent at the trigger). The upload with
+// the same seq then takes it from here instead of placing the trigger again.
+const NOTICES_MAX = 256;
+const notices = new Map();   // `${id}:${seq}` → { received_ms }
+const seqEpochs = {};        // deviceId → seq epoch of its last upload (notices don't carry one)
+
+function onTriggerNotice(n, now = Date.now()) {
+  const key = `${n.id}:${n.seq}`;
+  if (notices.has(key) || ingest?.seen(n.id, n.seq, seqEpochs[n.id])) return;
+  notices.set(key, { received_ms: now });
+  if (notices.size > NOTICES_MAX) notices.delete(notices.keys().next().value);
+  markSeen(n.id);
+  const ntp = n.time_source === 'ntp' && n.time_ms;
+  const timeMs = ntp ? n.time_ms : now;
+  console.log(`[NOTICE] ${translationDict[n.id]}: #${n.seq} ${n.level} ${n.deltaG}g (${ntp ? 'ntp' : 'arrival'} time)`);
+  live.publish('seismic:trigger', { id: n.id, alias: translationDict[n.id], seq: n.seq, level: n.level,
+    trigger: n.trigger, deltaG: n.deltaG, timestamp: new Date(timeMs).toISOString() }, n.id);
+  triggerConsensus(n.id, timeMs);
+}
+
+function takeNotice(id, seq) {
+  const key = `${id}:${seq}`;
+  const notice = notices.get(key);
+  notices.delete(key);
+  return notice ?? null;
+}
+
+// Where an upload's time went, trigger to dashboard, in ms per stage:
+//   capture_ms   trigger to body queued on the device (includes the post window)
+//   queue_ms     queued to sent, behind other uploads or a reconnect   } X-Event-Trace,
+//   network_ms   sent to request head here; needs an SNTP trigger time  } same boot only
+//   notice_ms    trigger to its trigger notice arriving, when one did
+//   body_ms      head to parsed body
+//   journal_ms   parsed to journaled (the ack point)
+//   emit_ms      journaled to the socket emit
+//   commit_ms    journaled to in MongoDB (set once ingest flushes it)
+//   total_ms     trigger to the socket emit, left out for stale replays
+// Device stages go in as the request arrives; the rest are added as they happen.
+const latencyJournaled = new WeakMap();   // entry → when it was journaled, for commit_ms
+function eventLatency(req, timeSource, eventTimeMs, parsedAt) {
+  const latency = { body_ms: parsedAt - req.receivedAt };
+  const [ready, wait] = String(req.headers['x-event-trace'] || '').split(',').map(v => parseInt(v, 10));
+  if (Number.isFinite(ready) && Number.isFinite(wait)) {
+    latency.capture_ms = ready;
+    latency.queue_ms = wait;
+    if (timeSource === 'ntp') latency.network_ms = Math.max(0, req.receivedAt - eventTimeMs - ready - wait);
+  }
+  return latency;
+}
+
+function observeLatency(latency, keys) {
+  for (const key of keys) {
+    if (latency[key] != null) metricEventLatency.observe({ stage: key.replace(/_ms$/, '') }, latency[key] / 1000);
+  }
+}
+
+// A live upload into the hourly sketches, in its event's hour
+function observeStats(id, entry, eventTimeMs) {
+  if (!hourlyStats) return;
+  if (!entry.status && Number.isFinite(entry.deltaG)) hourlyStats.add(id, 'deltaG', entry.deltaG, eventTimeMs);
+  if (entry.latency.total_ms != null) hourlyStats.add(id, 'latency_ms', entry.latency.total_ms, eventTimeMs);
+  if (entry.latency.queue_ms != null) hourlyStats.add(id, 'queue_ms', entry.latency.queue_ms, eventTimeMs);
+}
+
+// |interval − period| buckets of a heartbeat's isi report (lib/profile.js),
+// each counted at its midpoint; the open-ended last one at its lower edge
+const ISI_BUCKET_MS = [0, 1, 2.5, 5.5, 11.5, 23.5, 32];
+
+// onFlushed: the batch is in Mongo, so its events' commit_ms are known
+function recordCommits(batch, now = Date.now()) {
+  const ops = [];
+  for (const { event } of batch) {
+    const journaledAt = latencyJournaled.get(event);
+    if (journaledAt === undefined) continue;   // replayed from the journal after a restart
+    latencyJournaled.delete(event);
+    event.latency.commit_ms = now - journaledAt;
+    observeLatency(event.latency, ['commit_ms']);
+    ops.push({ updateOne: { filter: { _id: event._id }, update: { $set: { 'latency.commit_ms': event.latency.commit_ms } } } });
+  }
+  if (ops.length) eventsCol.bulkWrite(ops, { ordered: false }).catch(e => console.error('Latency write error:', e.message));
 }
 
 // ── POST /api/seismic ───────────────────────────────────────────
-app.post('/api/seismic', async (req, res) => {
+// Bytes an upload from id may take: its capture window (pre_ms plus the
+// longest retriggered post window) at its sample rate, in the body's
+// encoding; for a device not known yet, the most any configured one may
+function seismicBudget(encoding, id) {
+  const budget = (cfg) => waveform.bodyBudget(encoding, cfg.sample_rate_hz, cfg.pre_ms + cfg.max_post_ms);
+  if (id) return budget(deviceConfig(savedConfig, id));
+  const ids = [null, ...Object.keys(savedConfig?.devices || {})];
+  return Math.max(...ids.map(d => budget(deviceConfig(savedConfig, d))));
+}
+
+// req's body decoded as it arrives (lib/waveform.js readWaveformBody). While
+// the policy is 'retry' it's only drained: onSeismic answers 503 regardless.
+function readSeismicBody(req) {
+  if (uploadPolicy().mode === 'retry') {
+    return new Promise((resolve) => req.on('end', () => resolve(undefined)).resume());
+  }
+  const encoding = waveform.bodyEncoding(req.headers['content-type']);
+  return waveform.readWaveformBody(req, (id) => seismicBudget(encoding, id)).catch((err) => {
+    if (err.status === 400) err.message = `Invalid waveform body: ${err.message}`;
+    throw err;
+  });
+}
+
+// What an upload's metadata must look like, binary or JSON body alike
+// (lib/validate.js, compiled once). The samples, spectrum and ranges are
+// checked by their own decoders.
+const validateUpload = validator({
+  type: 'object',
+  required: ['level', 'deltaG'],
+  properties: {
+    id: { type: 'string', maxLength: 64 },
+    level: { type: 'string', maxLength: 16 },
+    trigger: { type: 'string', maxLength: 16 },
+    deltaG: { type: 'number', minimum: 0 },
+    event_offset_ms: { type: 'number' },
+    gap_index: { type: 'integer', minimum: 0 },
+    gap_samples: { type: 'integer', minimum: 0 },
+    retriggers: { type: 'array', maxItems: 256 },
+  },
+});
+
+async function onSeismic(req, res) {
+  const parsedAt = Date.now();
+  const policy = uploadPolicy();
+  res.set('X-Upload-Policy', `${policy.mode},${policy.hold_ms}`);
+  if (policy.mode === 'retry') {
+    res.set('Retry-After', String(Math.ceil(policy.hold_ms / 1000)));
+    return res.status(503).json({ error: 'Ingest queue backed up', retry_after_ms: policy.hold_ms });
+  }
+  const logged = () => res.status(201).json(policy.step
+    ? { status: 'logged', degrade: policy.mode, hold_ms: policy.hold_ms }
+    : { status: 'logged' });
   try {
-    const data = req.body;
-    if (!data || data.level === undefined || data.deltaG === undefined) {
-      return res.status(400).json({ error: "Invalid payload: 'level' and 'deltaG' required" });
+    let data;
+    try {
+      data = waveform.decodeWaveformBody(req.headers['content-type'], req.body);
+    } catch (e) {
+      return res.status(400).json({ error: `Invalid waveform body: ${e.message}` });
     }
+    const invalid = validateUpload(data);
+    if (invalid) return res.status(400).json({ error: `Invalid payload: ${invalid}` });
     const id = data.id || 'unknown';
     if (!translationDict[id]) translationDict[id] = id;
 
-    // If device sent event_offset_ms, compute actual event time
-    const eventOffsetMs = data.event_offset_ms || 0;
-    const eventTimestamp = new Date(Date.now() - eventOffsetMs).toISOString();
+    const { eventTimeMs, timeUs, timeSource, fitMs } = eventTime(req.headers, data, Date.now(), clockFits[id]);
+    const eventOffsetMs = Math.max(0, Date.now() - eventTimeMs);
+    const eventTimestamp = new Date(eventTimeMs).toISOString();
 
     const entry = {
       timestamp: eventTimestamp,
+      time: new Date(eventTimeMs),       // the indexed one; timestamp stays for clients
+      modified: new Date(),              // for /api/events/changes
+      time_source: timeSource,
       level: data.level,
+      trigger: data.trigger || 'threshold',
       deltaG: data.deltaG,
       id,
       alias: translationDict[id],
+      latency: eventLatency(req, timeSource, eventTimeMs, parsedAt),
     };
 
-    // Store waveform if present (array of [relative_ms, ax, ay, az])
-    if (data.waveform && Array.isArray(data.waveform)) {
-      entry.waveform = data.waveform;
+    // Microsecond trigger time for cross-node arrival comparisons
+    if (timeUs) entry.time_us = timeUs;
+    // SNTP against the heartbeat clock fit: the fit's share of any disagreement
+    // is the request latency it absorbed
+    if (timeSource === 'ntp' && fitMs != null) entry.clock_check_ms = Math.round(eventTimeMs - fitMs);
+
+    // Per-device sequence number; a replay the device didn't see acknowledged
+    // is answered 200 instead of being stored twice (unique index on
+    // id+seq_epoch+seq). The epoch changes whenever the device's count starts
+    // over; firmware from before it sends none and keeps the plain id+seq key.
+    const seq = parseInt(req.headers['x-event-seq'], 10);
+    if (Number.isFinite(seq)) entry.seq = seq;
+    const seqEpoch = parseInt(req.headers['x-seq-epoch'], 16);
+    if (seqEpoch > 0) entry.seq_epoch = seqEpoch;
+    seqEpochs[id] = entry.seq_epoch;
+    const boot = parseInt(req.headers['x-boot'], 10);
+    if (Number.isFinite(boot)) entry.boot = boot;
+
+    // ESP-NOW peers the device heard trigger with it (locally confirmed)
+    const localPeers = parseInt(req.headers['x-event-local'], 10);
+    if (localPeers > 0) entry.local_peers = localPeers;
+
+    // Sent thinned or without samples because we asked for it
+    if (UPLOAD_MODES.includes(req.headers['x-upload-mode'])) entry.upload_mode = req.headers['x-upload-mode'];
+
+    // Already in consensus if its trigger notice got here
+    const notice = Number.isFinite(entry.seq) ? takeNotice(id, entry.seq) : null;
+    if (notice) entry.latency.notice_ms = Math.max(0, notice.received_ms - eventTimeMs);
+
+    // Heap as the device sent the upload; also the freshest reading we have
+    const heap = parseHeapHeader(req.headers['x-heap']);
+    if (heap) {
+      entry.heap = heap;
+      lastHeap[id] = { ...(lastHeap[id] || {}), ...heap, time: new Date().toISOString() };
+    }
+
+    // A FIFO overflow on the device cut samples out of this capture
+    if (data.gap_samples > 0) {
+      entry.gap_index = data.gap_index;
+      entry.gap_samples = data.gap_samples;
+      console.log(`[WAVEFORM] ${translationDict[id]}: ${data.gap_samples} samples lost before sample ${data.gap_index}`);
+    }
+
+    // Later triggers that extended this capture, ms from the first one
+    if (Array.isArray(data.retriggers) && data.retriggers.length) {
+      entry.retriggers = data.retriggers.map(Number).filter(Number.isFinite);
+    }
+
+    // The device raised its accel range mid-capture: [[sample index, LSB per g], ...]
+    const ranges = waveform.cleanRanges(data.ranges);
+    if (ranges) entry.ranges = ranges;
+
+    // Band amplitudes from the device's Goertzel bank (spectrum: true)
+    const spectrum = waveform.cleanSpectrum(data.spectrum);
+    if (spectrum) entry.spectrum = spectrum;
+
+    // A node with a second sensor: how well the two agreed over the capture
+    // (it already dropped the ones that didn't, unless severe)
+    const coherence = Number(data.coherence);
+    if (data.coherence != null && Number.isFinite(coherence)) entry.coherence = coherence;
+
+    // A window the server pulled from the ring, not an event: keep it with
+    // the consensus it was pulled for, out of the event stream and consensus
+    if (entry.trigger === 'pull') {
+      entry.status = 'PULLED';
+      const sharedPull = shared ? await shared.finishPull(id).catch(() => null) : null;
+      entry.pull_id = (sentPulls[id] ?? sharedPull)?.pull_id ?? null;
+      delete sentPulls[id];
+    }
+
+    // The first event while an injection plays is that injection's
+    const run = injections[id];
+    if (run?.status === 'playing' && !run.event) {
+      entry.inject_run = run.run_id;
+      run.event = { timestamp: eventTimestamp, level: entry.level, deltaG: entry.deltaG, upload_ms: eventOffsetMs };
+      soakTests?.uploaded(id, run.run_id, eventOffsetMs);
+    }
+
+    // Waveform (array of [relative_ms, ax, ay, az]) goes to its own collection
+    // as packed int16; the event only records that it has one
+    let wave = null;
+    if (waveform.hasSamples(data.waveform)) {
+      wave = { id, ...waveform.packWaveform(data.waveform) };
+      // The second sensor on the same times: only its scale and samples
+      if (waveform.hasSamples(data.secondary) && data.secondary.length === data.waveform.length) {
+        const { scale, samples } = waveform.packWaveform(data.secondary);
+        wave.secondary = { scale, samples };
+        entry.has_secondary = true;
+      }
       entry.has_waveform = true;
-      console.log(`[WAVEFORM] ${translationDict[id]}: ${data.waveform.length} samples, peak=${data.deltaG}`);
+      entry.waveform_samples = wave.count;
+      const encoding = waveform.bodyEncoding(req.headers['content-type']) || 'json';
+      const bytes = Number(req.headers['content-length']) || 0;
+      // Compression ratio against plain int16 triplets (6 bytes/sample)
+      const ratio = bytes ? (data.waveform.length * 6 / bytes).toFixed(2) : '?';
+      console.log(`[WAVEFORM] ${translationDict[id]}: ${data.waveform.length} samples, peak=${data.deltaG}, ${encoding} ${bytes}B, ratio=${ratio}x vs int16`);
+    }
+
+    console.log(JSON.stringify(entry));
+
+    // Acknowledged once journaled; Mongo gets it with the next batch. A seq
+    // already flushed before a restart is dropped there by the unique index.
+    if (ingest.seen(id, entry.seq, entry.seq_epoch)) {
+      console.log(`[SEISMIC] ${translationDict[id]}: duplicate seq ${entry.seq} ignored`);
+      return res.status(200).json({ status: 'duplicate', seq: entry.seq });
+    }
+    await ingest.enqueue(entry, wave);
+    if (!entry.status) linkUpload(entry);
+    // Still ahead of the flush: enqueue schedules it on a timer
+    const journaledAt = Date.now();
+    entry.latency.journal_ms = journaledAt - parsedAt;
+    latencyJournaled.set(entry, journaledAt);
+    markSeen(id);
+    metricEvents.inc({ device: id, level: entry.level });
+
+    // Push real-time to dashboard (without waveform data for bandwidth).
+    // Split roles: the dashboards publish it off the change stream instead.
+    if (SERVER_ROLE === 'all') {
+      const emitEntry = { ...entry, _id: entry._id?.toString() };
+      live.publish(entry.status === 'PULLED' ? 'seismic:pulled' : 'seismic:event', emitEntry, id);
     }
+    const emittedAt = Date.now();
+    entry.latency.emit_ms = emittedAt - journaledAt;
+    if (eventOffsetMs <= REPLAY_STALE_MS) entry.latency.total_ms = emittedAt - eventTimeMs;
+    observeLatency(entry.latency, ['capture_ms', 'queue_ms', 'network_ms', 'notice_ms', 'body_ms', 'journal_ms', 'emit_ms', 'total_ms']);
+    observeStats(id, entry, eventTimeMs);
+    if (entry.status === 'PULLED') return logged();
 
-    console.log(JSON.stringify({ ...entry, waveform: undefined }));
+    // Consensus window (uses actual event time for accuracy). Events replayed
+    // after an outage are long over and must not confirm a live one.
+    if (eventOffsetMs > REPLAY_STALE_MS) {
+      console.log(`[SEISMIC] ${translationDict[id]}: replayed event from ${eventTimestamp}, skipping consensus`);
+      return logged();
+    }
+    if (!notice) triggerConsensus(id, eventTimeMs);
+    return logged();
+  } catch (err) {
+    return res.status(500).json({ error: 'Internal server error', details: err.stack });
+  }
+}
+app.post('/api/seismic', onSeismic);
+
+// The /api/init body bar what only that request can say (server_time_ms,
+// recalibrate); also what goes retained onto a device's MQTT config topic.
+// Without fwInfo the OTA fields are left out.
+function initConfig(id, cfg, fwInfo, firmwareUrl, reportedVersion) {
+  const config = {
+    heartbeat_interval: cfg.heartbeat_interval,
+    push_heartbeat_interval: clamp(cfg.push_heartbeat_interval, 10000, 600000),
+    sensitivity: cfg.sensitivity,
+    sample_rate_hz: snapSampleRate(cfg.sample_rate_hz, clamp(cfg.dlpf, 0, 6)),
+    dlpf: clamp(cfg.dlpf, 0, 6),
+    pre_ms: clamp(cfg.pre_ms, 0, 30000),
+    post_ms: clamp(cfg.post_ms, 100, 30000),
+    max_post_ms: clamp(cfg.max_post_ms, clamp(cfg.post_ms, 100, 30000), 60000),
+    trigger_mode: TRIGGER_MODES.includes(cfg.trigger_mode) ? cfg.trigger_mode : 'threshold',
+    detect_metric: DETECT_METRICS.includes(cfg.detect_metric) ? cfg.detect_metric : 'max_abs',
+    sta_ms: clamp(cfg.sta_ms, 50, 10000),
+    lta_ms: clamp(cfg.lta_ms, 1000, 300000),
+    sta_lta_on: clamp(cfg.sta_lta_on, 1, 100),
+    sta_lta_off: clamp(cfg.sta_lta_off, 0.5, 100),
+    hp_hz: clamp(cfg.hp_hz, 0, 10),
+    lp_hz: clamp(cfg.lp_hz, 0, 200),
+    bias_track_s: clamp(cfg.bias_track_s, 0, 3600),
+    ntp_server: cfg.ntp_server || DEFAULT_CONFIG.ntp_server,
+    stream_mode: STREAM_MODES.includes(cfg.stream_mode) ? cfg.stream_mode : 'off',
+    stream_hz: clamp(cfg.stream_hz, 0.1, 100),
+    stream_port: STREAM_PORT,
+    spectrum: cfg.spectrum === true,
+    local_http: cfg.local_http === true,
+    upload_formats: waveform.UPLOAD_FORMATS,
+    config_gen: configGens[id] || 0,
+  };
+  const broker = mqttDeviceBroker();
+  if (broker) config.mqtt = broker;
+  if (SESSION_PORT) config.session = { port: SESSION_PORT };
+  if (fwInfo && rolloutGrant(id, reportedVersion, fwInfo.version)) {
+    config.firmware_version = fwInfo.version;
+    config.firmware_url = firmwareUrl;
+  }
+  return config;
+}
+
+// CRC of the settings /api/init would send the device now (lib/initbin.js),
+// without the firmware offer, so a heartbeat doesn't take a rollout slot
+function initConfigCrc(id) {
+  return initbin.configCrc(initConfig(id, deviceConfig(savedConfig, id), null));
+}
+
+// ── GET /api/init ───────────────────────────────────────────────
+async function onInit(req, res) {
+  const { id } = req.query;
+  if (!id) return res.status(400).json({ error: 'Missing id parameter' });
+  markSeen(id);
+  const now = new Date().toISOString();
+  lastInitTimes[id] = now;
 
-    await eventsCol.insertOne(entry);
-    lastEventTimes[id] = new Date();
+  // Global config + per-device override
+  const cfg = deviceConfig(savedConfig, id);
+
+  // Track firmware version reported by this device
+  const reportedVersion = req.query.version || null;
+  if (reportedVersion) {
+    deviceFirmwareVersions[id] = reportedVersion;
+    console.log(`[FIRMWARE] ${translationDict[id]} (${id}) running v${reportedVersion}`);
+  }
+
+  // A reinit requested with ?recalibrate=1 makes the device re-measure its
+  // bias instead of restoring the saved one
+  const sentFlag = reinitFlags[id]?.sent;
+  const recalibrate = !!sentFlag?.recalibrate;
+
+  // Mark any "sent" reinit flags as completed
+  if (sentFlag) {
+    try {
+      await reinitCol.updateMany(
+        { deviceId: id, status: 'sent' },
+        { $set: { status: 'completed', completed_at: now } }
+      );
+      reinitFlags[id].sent = null;
+    } catch {}
+  }
+
+  // Build firmware OTA fields if firmware.json is present on disk
+  const fwInfo = firmware.info();
+  const protocol = req.headers['x-forwarded-proto'] || (req.socket.encrypted ? 'https' : 'http');
+  const host = req.headers['host'] || `${getLocalIp()}:${PORT}`;
+  const firmwareUrl = `${protocol}://${host}/api/firmware/latest.bin`;
+
+  live.publish('device:init', {
+    id, alias: translationDict[id], time: now, config: cfg,
+    firmware_version: reportedVersion,
+    server_firmware_version: fwInfo?.version || null,
+  }, id);
+  console.log(`[INIT] ${translationDict[id]} (${id}) initialized`);
+
+  const config = initConfig(id, cfg, fwInfo, firmwareUrl, reportedVersion);
+  // Firmware that asks for it gets the compact body; older firmware keeps JSON
+  if (initbin.wantsBinary(req)) {
+    return res.type(initbin.CONTENT_TYPE).send(initbin.encodeInit(config, { server_time_ms: Date.now(), recalibrate }));
+  }
+  res.json({ ...config, server_time_ms: Date.now(), recalibrate });
+}
+app.get('/api/init', onInit);
+
+// ── Device status ───────────────────────────────────────────────
+// A held push poll, a broker session or a device session means the device
+// is up between stretched heartbeats
+function deviceOnline(id, now = new Date()) {
+  return !!(pushHeld(id) || (lastEventTimes[id] && now <= deviceExpiry(id)));
+}
+
+function pushHeld(id) {
+  return !!(pushWaiters[id] || mqttLive[id] || sessions?.live(id));
+}
 
-    // Push real-time to dashboard (without waveform data for bandwidth)
-    const emitEntry = { ...entry, _id: entry._id?.toString() };
-    delete emitEntry.waveform;
-    io.emit('seismic:event', emitEntry);
+// When a device seen only by its requests goes offline (ms), or null while
+// its push, MQTT or device session holds it online
+function deviceExpiry(id) {
+  if (pushHeld(id) || !lastEventTimes[id]) return null;
+  return +lastEventTimes[id] + (savedConfig?.status_threshold_seconds || DEFAULT_CONFIG.status_threshold_seconds) * 1000;
+}
+
+// One device's entry in /api/status, kept by statusFeed between changes
+function deviceStatus(id, now = new Date()) {
+  return {
+    alias: translationDict[id] || '',
+    site: registry?.get(id)?.site ?? null,
+    group: registry?.groupOf(id) ?? DEFAULT_GROUP,
+    status: deviceOnline(id, now) ? 'Online' : 'Offline',
+    last_seen: lastEventTimes[id] || null,
+    push: pushHeld(id),
+    stream: streams[id] ? { received: streams[id].received, lost: streams[id].lost,
+                            last_seen: streams[id].lastSeen } : null,
+    last_init: lastInitTimes[id] || null,
+    firmware_version: deviceFirmwareVersions[id] || null,
+    temp_c: lastTemps[id] ?? null,
+    i2c: lastBusStats[id] ?? null,
+    profile: lastProfiles[id] ?? null,
+    heap: lastHeap[id] ?? null,
+    ota: lastOta[id] ?? null,
+    tasks: lastTasks[id] ?? null,
+    local_taps: lastTaps[id] ?? null,
+    boots: lastBoots[id] ?? null,
+    blackbox: lastBlackBox[id] ?? null,
+    tls: lastTls[id] ?? null,
+    uploads: lastUploads[id] ?? null,
+    evictions: lastEvictions[id] ?? null,
+    mqtt: lastMqtt[id] ?? null,
+    session: lastSession[id] ?? null,
+    clock: clockFits[id]?.summary(now) ?? null,
+  };
+}
+
+// ── GET /api/status ─────────────────────────────────────────────
+// The feed's snapshot; its version also moves when a device times out.
+// Sent as the feed serialized it, once per version.
+app.get('/api/status', (req, res) => {
+  if (notModified(req, res, `s${statusFeed.version}`)) return;
+  res.type('json').send(statusFeed.serialized());
+});
+
+// ── GET /api/events ─────────────────────────────────────────────
+const EVENTS_MAX_PAGE = 50000;
+const EVENTS_CHANGES_PAGE = 1000;
+const EVENTS_CHANGES_SETTLE_MS = 2000;   // covers the direct (non-queued) consensus writes
+
+// Keyset cursors are "<ISO time>,<_id hex>"; the _id part is optional
+function eventCursor(time, id) {
+  return id ? `${new Date(time).toISOString()},${id}` : new Date(time).toISOString();
+}
+
+function parseEventCursor(value) {
+  if (typeof value !== 'string' || !value) return null;
+  const [iso, hex] = value.split(',');
+  const t = new Date(iso);
+  if (isNaN(t)) return null;
+  if (hex && !ObjectId.isValid(hex)) return null;
+  return { t, id: hex ? new ObjectId(hex) : null };
+}
+
+// ?format=ndjson (or Accept: application/x-ndjson): the same page, one
+// event per line as the cursor yields it, instead of one array built in
+// memory. The next-page cursor can't be a header once the body has
+// started, so a full page ends with a { next_cursor } line (the only line
+// without an _id). ?fields=a,b narrows the projection to those fields plus
+// what the API shape is built from.
+const NDJSON_TYPE = 'application/x-ndjson';
+const NDJSON_BATCH = 500;              // docs per cursor round trip
+const NDJSON_CHUNK_BYTES = 64 * 1024;  // bytes of lines per write
+const EVENT_KEY_FIELDS = ['_id', 'time', 'timestamp', 'lv', 'level', 'id', 'devices', 'status'];
+
+function eventsProjection(fields) {
+  if (!fields) return { waveform: 0 };
+  const wanted = String(fields).split(',').filter(f => /^[A-Za-z_][\w.]*$/.test(f) && f !== 'waveform');
+  return Object.fromEntries([...EVENT_KEY_FIELDS, ...wanted].map(f => [f, 1]));
+}
+
+// events: a Mongo cursor or an array; the client going away closes the cursor
+async function streamEvents(req, res, events, limit) {
+  res.type(NDJSON_TYPE);
+  const out = compressStream(req, res);
+  let closed = false;
+  res.on('close', () => {
+    closed = true;
+    if (typeof events.close === 'function') events.close().catch(() => {});
+  });
+  let chunk = '';
+  let count = 0;
+  let last = null;
+  const write = (text) => (out.write(text) || closed ? null : new Promise((resolve) => {
+    const done = () => {
+      out.off('drain', done);
+      res.off('close', done);
+      resolve();
+    };
+    out.on('drain', done);
+    res.on('close', done);
+  }));
+  try {
+    for await (const doc of events) {
+      if (closed) return;
+      last = doc;
+      count++;
+      const e = expandEvent(doc);
+      if (e._id) e._id = e._id.toString();
+      chunk += `${JSON.stringify(e)}\n`;
+      if (chunk.length >= NDJSON_CHUNK_BYTES) {
+        await write(chunk);
+        chunk = '';
+      }
+    }
+    if (count === limit && last) chunk += `${JSON.stringify({ next_cursor: eventCursor(last.time, last._id) })}\n`;
+    out.end(chunk);
+  } catch (err) {
+    // Too late for a status; a cut-off body is what the client sees
+    console.error('Events stream error:', err.message);
+    if (!closed) res.destroy(err);
+  }
+}
+
+app.get('/api/events', async (req, res) => {
+  try {
+    // Filters: since / until (ISO, on the time index), device and level
+    // (comma lists). Newest first, keyset-paged: a full page sets
+    // X-Next-Cursor, passed back as ?after= for the next one. X-Changes-Cursor
+    // is where /api/events/changes should pick up from.
+    // The filter and the index it's meant for come from lib/queries.js
+    const since = req.query.since ? new Date(req.query.since) : null;
+    const until = req.query.until ? new Date(req.query.until) : null;
+    const devices = req.query.device ? String(req.query.device).split(',') : null;
+    const levels = req.query.level ? String(req.query.level).split(',') : null;
+    // Same query, same Accept, nothing stored since: 304 without reading Mongo
+    const variant = crypto.createHash('md5').update(`${req.originalUrl}\n${req.get('Accept') || ''}`).digest('hex').slice(0, 12);
+    if (notModified(req, res, `e${dataVersions.events}.${ingest.stats.flushed}.${variant}`)) return;
+    const after = parseEventCursor(req.query.after);
+    const { filter, hint } = queries.eventsQuery({ since: since && !isNaN(since) ? since : null,
+                                                   until: until && !isNaN(until) ? until : null,
+                                                   devices, levels, after, legacy: schemaLegacy });
+    const limit = clamp(parseInt(req.query.limit, 10) || EVENTS_MAX_PAGE, 1, EVENTS_MAX_PAGE);
+    const changesCursor = eventCursor(ingest.watermark(new Date(Date.now() - EVENTS_CHANGES_SETTLE_MS)), null);
+    // Since a time the recent window covers (the 24h view): from memory.
+    // Else exclude waveform arrays of not-yet-migrated events (fetched
+    // per-event via /api/events/:id/waveform).
+    const cached = filter.time?.$gte && recent.hit(recent.covers(since.getTime()));
+    if (req.query.format === 'ndjson' || (req.get('Accept') || '').includes(NDJSON_TYPE)) {
+      res.set('X-Changes-Cursor', changesCursor);
+      return streamEvents(req, res, cached
+        ? recent.events({ fromMs: since.getTime(), untilMs: filter.time.$lt?.getTime() ?? null,
+                          ids: devices, levels, after, limit })
+        : eventsCol.find(filter, { projection: eventsProjection(req.query.fields) })
+          .sort(queries.NEWEST_FIRST)
+          .hint(hint)
+          .limit(limit)
+          .batchSize(NDJSON_BATCH), limit);
+    }
+    const events = cached
+      ? recent.events({ fromMs: since.getTime(), untilMs: filter.time.$lt?.getTime() ?? null,
+                        ids: devices, levels, after, limit })
+      : await eventsCol.find(filter, { projection: { waveform: 0 } })
+        .sort(queries.NEWEST_FIRST)
+        .hint(hint)
+        .limit(limit)
+        .toArray();
+    if (events.length === limit) {
+      const last = events[events.length - 1];
+      res.set('X-Next-Cursor', eventCursor(last.time, last._id));
+    }
+    res.set('X-Changes-Cursor', changesCursor);
+    // Copies in the API's shape; the cached ones stay as stored
+    const shown = events.map(expandEvent);
+    // Accept: application/vnd.seismo.events → typed columns (lib/columnar.js)
+    if ((req.get('Accept') || '').includes(columnar.CONTENT_TYPE)) {
+      res.vary('Accept');
+      return res.type(columnar.CONTENT_TYPE).send(columnar.encodeEvents(shown));
+    }
+    // Convert _id to string for frontend use
+    shown.forEach(e => { if (e._id) e._id = e._id.toString(); });
+    res.json(shown);
+  } catch (err) {
+    console.error('Events read error:', err.message);
+    res.json([]);
+  }
+});
+
+// ── GET /api/events/changes ─────────────────────────────────────
+// ?cursor=<ISO,_id> from X-Changes-Cursor or the last call: events created or
+// updated (consensus joins) since, oldest first. Stops 2s short of now and
+// before anything still queued for Mongo, so the cursor never steps over a
+// write in flight; sockets carry the last seconds. -> { events, cursor, more }
+app.get('/api/events/changes', async (req, res) => {
+  const from = parseEventCursor(req.query.cursor);
+  if (!from) return res.status(400).json({ error: 'cursor required' });
+  try {
+    const upTo = ingest.watermark(new Date(Date.now() - EVENTS_CHANGES_SETTLE_MS));
+    const filter = {
+      modified: { $lte: upTo },
+      $or: [{ modified: { $gt: from.t } }, ...(from.id ? [{ modified: from.t, _id: { $gt: from.id } }] : [])],
+    };
+    const events = await eventsCol.find(filter, { projection: { waveform: 0 } })
+      .sort({ modified: 1, _id: 1 })
+      .limit(EVENTS_CHANGES_PAGE)
+      .toArray();
+    const more = events.length === EVENTS_CHANGES_PAGE;
+    const last = events[events.length - 1];
+    const cursor = more ? eventCursor(last.modified, last._id)
+      : eventCursor(new Date(Math.max(upTo.getTime(), from.t.getTime())), null);
+    res.json({ events: events.map(e => ({ ...expandEvent(e), _id: e._id?.toString() })), cursor, more });
+  } catch (err) {
+    console.error('Event changes read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /api/events/downsampled ─────────────────────────────────
+// ?from&to (ISO or epoch ms) &px=N, optional device / level like /api/events:
+// for the scatter chart when a range holds more events than it can draw.
+// The range is cut into px time buckets and each device keeps only its
+// lowest and highest ΔG event per bucket (per-pixel min/max), which keeps
+// every spike and the band's outline. Points are real events, so clicking
+// one still opens it. -> { from, to, px, bucket_ms, total, points }
+const DOWNSAMPLE_MAX_PX = 4000;
+
+function parseTimeParam(value) {
+  if (value == null || value === '') return null;
+  const t = /^\d+$/.test(String(value)) ? new Date(Number(value)) : new Date(value);
+  return isNaN(t) ? null : t;
+}
+
+app.get('/api/events/downsampled', async (req, res) => {
+  const from = parseTimeParam(req.query.from);
+  const to = parseTimeParam(req.query.to) || new Date();
+  if (!from || to <= from) return res.status(400).json({ error: 'from and to required' });
+  const px = clamp(parseInt(req.query.px, 10) || 1000, 1, DOWNSAMPLE_MAX_PX);
+  const bucketMs = Math.max(1, Math.ceil((to - from) / px));
+  const { filter, hint } = queries.eventsQuery({ since: from, until: to,
+    devices: req.query.device ? String(req.query.device).split(',') : null,
+    levels: req.query.level ? String(req.query.level).split(',') : null, legacy: schemaLegacy });
+  const match = { ...filter, status: { $exists: false }, deltaG: { $type: 'number' } };
+  // $min/$max on a document compare its first field, deltaG; the rest is
+  // what expandEvent() needs for the point
+  const point = { d: '$deltaG', _id: '$_id', time: '$time', lv: '$lv', level: '$level',
+                  trigger: '$trigger', has_waveform: '$has_waveform' };
+  try {
+    let groups;
+    if (recent.hit(recent.covers(from.getTime()))) {
+      // Inside the recent window: the same groups, from memory
+      const pick = (e) => ({ d: e.deltaG, _id: e._id, time: e.time, lv: e.lv, level: e.level,
+                             trigger: e.trigger, has_waveform: e.has_waveform });
+      groups = recent.downsample({ fromMs: from.getTime(), toMs: to.getTime(), bucketMs,
+                                   ids: match.id?.$in ?? null,
+                                   levels: req.query.level ? String(req.query.level).split(',') : null })
+        .map(g => ({ _id: { id: g.id }, lo: pick(g.lo), hi: pick(g.hi), n: g.n }));
+    } else {
+      groups = await eventsCol.aggregate([
+        { $match: match },
+        { $group: {
+          _id: { id: '$id', b: { $floor: { $divide: [{ $subtract: ['$time', from] }, bucketMs] } } },
+          lo: { $min: point },
+          hi: { $max: point },
+          n: { $sum: 1 },
+        } },
+      ], { allowDiskUse: true, hint }).toArray();
+    }
+    let total = 0;
+    const points = [];
+    for (const g of groups) {
+      total += g.n;
+      for (const p of g.lo._id.equals(g.hi._id) ? [g.hi] : [g.lo, g.hi]) {
+        const { timestamp, level, alias } = expandEvent({ ...p, id: g._id.id });
+        points.push({ _id: p._id.toString(), id: g._id.id, deltaG: p.d, timestamp, level,
+                      trigger: p.trigger, alias, has_waveform: p.has_waveform });
+      }
+    }
+    res.json({ from, to, px, bucket_ms: bucketMs, total, points });
+  } catch (err) {
+    console.error('Downsampled events read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /api/events/density ─────────────────────────────────────
+// ?from&to (as for /downsampled), optional device / level: events per
+// time bucket × ΔG bin, summed from the rollups (lib/rollups.js density()),
+// for the chart's density mode over long ranges. Hourly buckets while the
+// range holds at most DENSITY_MAX_BUCKETS of them, daily beyond. The cost
+// follows the bucket count, whatever the number of events.
+// -> { bucket, bucket_ms, dg_edges, cells: [{ start, bin, count }], as_of }
+const DENSITY_MAX_BUCKETS = 1000;
+
+app.get('/api/events/density', async (req, res) => {
+  const from = parseTimeParam(req.query.from);
+  const to = parseTimeParam(req.query.to) || new Date();
+  if (!from || to <= from) return res.status(400).json({ error: 'from and to required' });
+  const bucket = (to - from) / rollups.BUCKET_MS.hour <= DENSITY_MAX_BUCKETS ? 'hour' : 'day';
+  try {
+    const grid = await rollups.density(rollupsCol, {
+      bucket, from: from.getTime(), to: to.getTime(),
+      levels: req.query.level ? String(req.query.level).split(',') : null,
+      ids: req.query.device ? String(req.query.device).split(',') : null,
+    });
+    res.json({ ...grid, as_of: rollupState?.asOf() ?? null });
+  } catch (err) {
+    console.error('Density read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /api/stats ──────────────────────────────────────────────
+// ?metric (lib/stats.js METRICS) &from&to (default the last 24 h), optional
+// device=a,b and q=0.5,0.95,0.99: percentiles per device and overall,
+// merged from the hourly sketches of the range. Without ?metric, the list.
+app.get('/api/stats', async (req, res) => {
+  if (!req.query.metric) return res.json({ metrics: STATS_METRICS });
+  const metric = String(req.query.metric);
+  if (!STATS_METRICS[metric]) return res.status(400).json({ error: `metric must be one of ${Object.keys(STATS_METRICS).join(', ')}` });
+  if (!hourlyStats) return res.status(503).json({ error: 'Database not ready' });
+  const to = parseTimeParam(req.query.to) || new Date();
+  const from = parseTimeParam(req.query.from) || new Date(to - 86400 * 1000);
+  if (to <= from) return res.status(400).json({ error: 'from must be before to' });
+  const qs = req.query.q ? String(req.query.q).split(',').map(Number).filter(q => q >= 0 && q <= 1) : undefined;
+  try {
+    res.json(await hourlyStats.query({
+      metric, from: from.getTime(), to: to.getTime(), qs: qs?.length ? qs : undefined,
+      ids: req.query.device ? String(req.query.device).split(',') : null,
+    }));
+  } catch (err) {
+    console.error('Stats read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /api/rollups ────────────────────────────────────────────
+// ?bucket=hour|day (default day), ?days=N (default 30): per-device, per-level
+// counts and max ΔG; as_of is when the newest bucket was last regrouped.
+// Hourly buckets inside the recent window come from memory, current to now.
+app.get('/api/rollups', async (req, res) => {
+  const bucket = rollups.BUCKET_MS[req.query.bucket] ? req.query.bucket : 'day';
+  const days = clamp(parseInt(req.query.days, 10) || 30, 1, 366);
+  const from = new Date(rollups.floorTo(Date.now() - days * rollups.BUCKET_MS.day, bucket));
+  const now = Date.now();
+  const split = bucket === 'hour' && recent.covers(recent.horizon(now), now) ? Math.max(from.getTime(), recent.horizon(now)) : null;
+  try {
+    const stored = split === from.getTime() ? []
+      : await rollupsCol.find({ bucket, start: split ? { $gte: from, $lt: new Date(split) } : { $gte: from } },
+        { projection: { _id: 0, bucket: 0, dg_hist: 0 } }).sort({ start: 1 }).toArray();
+    if (split == null) return res.json({ bucket, as_of: rollupState?.asOf() ?? null, rows: stored });
+    res.json({ bucket, as_of: new Date(now), rows: [...stored, ...recent.rollupRows(split)] });
+  } catch (err) {
+    console.error('Rollups read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /api/events/:id/waveform ────────────────────────────────
+const WAVEFORM_MAX_POINTS = 20000;
+
+app.get('/api/events/:id/waveform', async (req, res) => {
+  try {
+    // Just uploaded and not flushed yet: serve it from the ingest queue
+    const queued = ingest.pending(req.params.id);
+    const found = queued ? null : await eventsCol.findOne(
+      { _id: new ObjectId(req.params.id) },
+      { projection: { waveform: 1, id: 1, time: 1, timestamp: 1, lv: 1, level: 1, deltaG: 1 } }
+    );
+    const event = queued?.event || (found && expandEvent(found));
+    if (!event) return res.status(404).json({ error: 'Event not found' });
+    let stored = queued ? queued.waveform : await waveformsCol.findOne({ _id: event._id });
+
+    // ?channel=secondary: a dual-sensor node's second sensor instead, on
+    // the same times; everything below serves it the same way
+    if (req.query.channel === 'secondary') {
+      if (!stored?.secondary) return res.status(404).json({ error: 'No second sensor for this event' });
+      stored = { ...stored, ...stored.secondary };
+    }
+
+    // ?format=binary: the stored form as is, count × int32 rel_ms then
+    // count × int16 x,y,z; divide by X-Waveform-Scale for g
+    if (stored && req.query.format === 'binary') {
+      const { t, samples } = waveform.storedBuffers(stored);
+      res.set('X-Waveform-Count', String(stored.count));
+      res.set('X-Waveform-Scale', String(stored.scale));
+      res.set('X-Waveform-Tier', stored.tier || 'full');
+      return res.type('application/octet-stream').send(Buffer.concat([t, samples]));
+    }
+
+    // Events from before the waveforms collection still embed theirs until migrated
+    const wave = stored ? waveform.unpackWaveform(stored) : event.waveform;
+    if (!wave) return res.status(404).json({ error: 'No waveform data for this event' });
+
+    // ?download=1: every sample, as an attachment. Otherwise ?from_ms / ?to_ms
+    // (rel_ms, inclusive) cut the capture and ?max_points (capped) bounds it
+    // with min/max envelope decimation; sample_count is the full capture's
+    const download = req.query.download === '1';
+    const num = (v) => (v == null || v === '' || !Number.isFinite(Number(v)) ? null : Number(v));
+    const maxPoints = download ? 0 : clamp(parseInt(req.query.max_points, 10) || 0, 0, WAVEFORM_MAX_POINTS);
+    const range = download ? wave
+      : waveform.envelope(wave, { fromMs: num(req.query.from_ms), toMs: num(req.query.to_ms) });
+    const view = waveform.envelope(range, { maxPoints });
+    if (download) res.attachment(`waveform-${event._id}${req.query.channel === 'secondary' ? '-secondary' : ''}.json`);
+    res.json({
+      _id: event._id.toString(),
+      timestamp: event.timestamp,
+      level: event.level,
+      deltaG: event.deltaG,
+      alias: event.alias,
+      sample_count: wave.length,
+      // 'envelope': only the samples retention kept of full_count
+      tier: stored?.tier || 'full',
+      full_count: stored?.full_count ?? wave.length,
+      decimated: view.length < range.length,
+      waveform: view,
+    });
+  } catch (err) {
+    console.error('Waveform read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /api/events/:id/spectrogram ─────────────────────────────
+// ?axis=0|1|2 (default the one that moved most), ?window=<samples> (16..1024,
+// rounded up to a power of two, default 128), ?hop=<samples> (default a
+// quarter window), ?channel=secondary: the STFT of the stored waveform as
+// one uint8 tile (lib/columnar.js encodeSpectrogram), computed on the worker
+// pool once per event, channel, tier and parameters and then served from
+// the tile cache. ?format=json gives the same fields with data in base64.
+// 409 for an envelope (lib/retention.js): its samples aren't evenly spaced.
+app.get('/api/events/:id/spectrogram', async (req, res) => {
+  if (!ObjectId.isValid(req.params.id)) return res.status(400).json({ error: 'Invalid event id' });
+  if (!analysis) return res.status(503).json({ error: 'Waveform analysis is off (ANALYSIS_WORKERS=0)' });
+  const hex = new ObjectId(req.params.id).toHexString();
+  const secondary = req.query.channel === 'secondary';
+  const axis = ['0', '1', '2'].includes(req.query.axis) ? Number(req.query.axis) : 'strongest';
+  const window = clamp(parseInt(req.query.window, 10) || 128, 16, 1024);
+  const hop = clamp(parseInt(req.query.hop, 10) || 0, 0, 1024);
+  try {
+    let stored = ingest.pending(hex)?.waveform || await waveformsCol.findOne({ _id: new ObjectId(hex) });
+    if (!stored) return res.status(404).json({ error: 'No waveform data for this event' });
+    if (secondary) {
+      if (!stored.secondary) return res.status(404).json({ error: 'No second sensor for this event' });
+      stored = { ...stored, ...stored.secondary };
+    }
+    const tier = stored.tier || 'full';
+    if (tier === 'envelope') return res.status(409).json({ error: 'Waveform is envelope decimated', tier });
+    const key = `${hex}-${secondary ? 's' : 'p'}-${tier}-${axis}-${window}-${hop}`;
+    if (notModified(req, res, key)) return;
+    const tile = await spectrograms.through(key, async () => {
+      const params = { axis, window, hop };
+      const result = await analysis.run('spectrogram', { wave: { count: stored.count, scale: stored.scale, ...waveform.storedBuffers(stored) }, params });
+      return result && columnar.encodeSpectrogram(result);
+    });
+    if (!tile) return res.status(404).json({ error: 'Waveform too short for that window' });
+    if (req.query.format === 'json') {
+      const { data, ...fields } = columnar.decodeSpectrogram(tile);
+      return res.json({ _id: hex, tier, ...fields, data: data.toString('base64') });
+    }
+    res.type(columnar.SPECTROGRAM_CONTENT_TYPE).send(tile);
+  } catch (err) {
+    console.error('Spectrogram error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /api/waveforms ──────────────────────────────────────────
+// ?ids=<_id>,<_id>,... (or ?consensus=<_id> for that entry's members): the
+// waveforms on one absolute timebase for an overlay, in one response
+// (waveform.alignWaveforms). ?from / ?to (ISO or epoch ms) cut the span,
+// ?step_ms sets the spacing (default the finest capture's), ?max_points
+// (capped) bounds the grid, ?channel=secondary as for one waveform.
+// -> { start_ms, step_ms, count, series: [{ event_id, id, alias, at_ms,
+// level, deltaG, tier, ax, ay, az }] }, null where a capture has no sample.
+// ?format=binary or Accept: application/vnd.seismo.waveforms gives the
+// same as float32 columns (lib/columnar.js encodeWaveforms).
+const WAVEFORMS_MAX_IDS = 32;
+
+app.get('/api/waveforms', async (req, res) => {
+  try {
+    let ids = String(req.query.ids || '').split(',').filter(Boolean);
+    if (req.query.consensus) {
+      if (!ObjectId.isValid(req.query.consensus)) return res.status(400).json({ error: 'Invalid consensus id' });
+      const stored = await eventsCol.findOne({ _id: new ObjectId(req.query.consensus), devices: { $exists: true } });
+      if (!stored) return res.status(404).json({ error: 'Consensus not found' });
+      ids = [...(await memberEvents(stored)).values()].map(e => e._id.toString());
+    }
+    if (!ids.length || ids.length > WAVEFORMS_MAX_IDS || !ids.every(id => ObjectId.isValid(id))) {
+      return res.status(400).json({ error: `ids: 1 to ${WAVEFORMS_MAX_IDS} event ids` });
+    }
+    const oids = ids.map(id => new ObjectId(id));
+    const [events, stored] = await Promise.all([
+      eventsCol.find({ _id: { $in: oids } }, { projection: MEMBER_PROJECTION }).toArray(),
+      waveformsCol.find({ _id: { $in: oids } }).toArray(),
+    ]);
+    const eventOf = new Map(events.map(e => [e._id.toString(), e]));
+    const waveOf = new Map(stored.map(w => [w._id.toString(), w]));
+    const secondary = req.query.channel === 'secondary';
+    const series = [], waves = [];
+    for (const hex of ids) {
+      const queued = ingest.pending(hex);
+      const event = eventOf.get(hex) || queued?.event;
+      let w = waveOf.get(hex) || queued?.waveform;
+      if (!event?.time || !w || (secondary && !w.secondary)) continue;
+      if (secondary) w = { ...w, ...w.secondary };
+      const shown = expandEvent(event);
+      series.push({ event_id: hex, id: shown.id, alias: shown.alias, at_ms: event.time.getTime(),
+                    level: shown.level, deltaG: shown.deltaG, tier: w.tier || 'full' });
+      waves.push({ at_ms: event.time.getTime(), rows: waveform.unpackWaveform(w) });
+    }
+    if (!series.length) return res.status(404).json({ error: 'No waveform data for those events' });
+    const grid = waveform.alignWaveforms(waves, {
+      fromMs: parseTimeParam(req.query.from)?.getTime() ?? null,
+      toMs: parseTimeParam(req.query.to)?.getTime() ?? null,
+      stepMs: parseFloat(req.query.step_ms) || null,
+      maxPoints: clamp(parseInt(req.query.max_points, 10) || WAVEFORM_MAX_POINTS, 1, WAVEFORM_MAX_POINTS),
+    });
+    if (req.query.format === 'binary' || (req.get('Accept') || '').includes(columnar.WAVEFORMS_CONTENT_TYPE)) {
+      res.vary('Accept');
+      return res.type(columnar.WAVEFORMS_CONTENT_TYPE).send(columnar.encodeWaveforms(grid, series));
+    }
+    const column = (c) => Array.from(c, v => (Number.isNaN(v) ? null : Math.round(v * 10000) / 10000));
+    res.json({
+      start_ms: grid.start_ms, step_ms: grid.step_ms, count: grid.count,
+      series: series.map((s, i) => {
+        const axes = grid.columns[i];
+        return { ...s, ax: axes && column(axes[0]), ay: axes && column(axes[1]), az: axes && column(axes[2]) };
+      }),
+    });
+  } catch (err) {
+    console.error('Waveforms read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /api/export/miniseed ────────────────────────────────────
+// ?from & ?to (ISO or epoch ms; to defaults to now), ?device=a,b and
+// ?channel=secondary: the stored captures in the range as MiniSEED,
+// Steim2-compressed (lib/miniseed.js), oldest first. Streamed: one batch
+// of waveforms read and one capture encoded at a time, written as the
+// client takes it. Captures retention has cut to an envelope aren't
+// samples any more and are left out, as are ones not yet flushed.
+const MSEED_NETWORK = (process.env.MSEED_NETWORK || 'XX').slice(0, 2);
+const EXPORT_MAX_DAYS = 31;
+const EXPORT_BATCH = 50;
+
+app.get('/api/export/miniseed', async (req, res) => {
+  const from = parseTimeParam(req.query.from);
+  const to = parseTimeParam(req.query.to) || new Date();
+  if (!from || to <= from) return res.status(400).json({ error: 'from and to required' });
+  if (to - from > EXPORT_MAX_DAYS * 86400e3) return res.status(400).json({ error: `at most ${EXPORT_MAX_DAYS} days` });
+  const devices = req.query.device ? String(req.query.device).split(',') : null;
+  const secondary = req.query.channel === 'secondary';
+  const { filter, hint } = queries.eventsQuery({ since: from, until: to, devices, legacy: schemaLegacy });
+  filter.status = { $exists: false };
+  const events = eventsCol.find(filter, { projection: { _id: 1, id: 1, time: 1 } })
+    .sort({ time: 1, _id: 1 })
+    .hint(hint)
+    .batchSize(EXPORT_BATCH);
+  let closed = false;
+  res.on('close', () => {
+    closed = true;
+    events.close().catch(() => {});
+  });
+  const write = (buf) => (res.write(buf) || closed ? null : new Promise((resolve) => {
+    const done = () => {
+      res.off('drain', done);
+      res.off('close', done);
+      resolve();
+    };
+    res.on('drain', done);
+    res.on('close', done);
+  }));
+  let seq = 1;
+  const encode = async (batch) => {
+    const stored = await waveformsCol.find({ _id: { $in: batch.map(e => e._id) } }).toArray();
+    const waves = new Map(stored.map(w => [w._id.toString(), w]));
+    for (const event of batch) {
+      let w = waves.get(event._id.toString());
+      if (!w || (w.tier && w.tier !== 'full') || (secondary && !w.secondary)) continue;
+      if (secondary) w = { ...w, ...w.secondary };
+      const { t, samples } = waveform.storedBuffers(w);
+      const capture = miniseed.captureRecords({ t, samples, count: w.count, scale: w.scale },
+        { eventMs: event.time.getTime(), id: event.id, network: MSEED_NETWORK, location: secondary ? '10' : '00', seq });
+      const records = [...capture.records()];
+      seq = capture.nextSeq();
+      await write(Buffer.concat(records));
+      if (closed) return;
+    }
+  };
+  try {
+    res.type(miniseed.CONTENT_TYPE);
+    res.attachment(`seismo-${from.toISOString().replace(/[:.]/g, '')}-${to.toISOString().replace(/[:.]/g, '')}.mseed`);
+    let batch = [];
+    for await (const event of events) {
+      if (closed) return;
+      batch.push(event);
+      if (batch.length < EXPORT_BATCH) continue;
+      await encode(batch);
+      batch = [];
+    }
+    if (batch.length && !closed) await encode(batch);
+    res.end();
+  } catch (err) {
+    console.error('MiniSEED export error:', err.message);
+    if (!res.headersSent) return res.status(500).json({ error: err.message });
+    if (!closed) res.destroy(err);
+  }
+});
+
+// ── GET /api/trace/:deviceId ────────────────────────────────────
+// Helicorder summaries for a device, oldest first. ?since=<ISO time>, default last hour.
+app.get('/api/trace/:deviceId', async (req, res) => {
+  try {
+    const since = req.query.since ? new Date(req.query.since) : new Date(Date.now() - 3600 * 1000);
+    const docs = await traceCol.find(
+      { id: req.params.deviceId, t0: { $gte: since } },
+      { projection: { _id: 0 } }
+    ).sort({ t0: 1 }).limit(1000).toArray();
+    res.json(docs);
+  } catch (err) {
+    console.error('Trace read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /api/storm/:deviceId ────────────────────────────────────
+// Per-minute summaries of the minor captures a device folded, oldest first.
+// ?since=<ISO time>, default last day.
+app.get('/api/storm/:deviceId', async (req, res) => {
+  try {
+    const since = req.query.since ? new Date(req.query.since) : new Date(Date.now() - 86400 * 1000);
+    const docs = await stormCol.find(
+      { id: req.params.deviceId, t0: { $gte: since } },
+      { projection: { _id: 0 } }
+    ).sort({ t0: 1 }).limit(1440).toArray();
+    res.json(docs);
+  } catch (err) {
+    console.error('Storm read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /api/boots/:deviceId ────────────────────────────────────
+// Boot-phase reports of a device, oldest first. ?since=<ISO time>, default
+// last 30 days.
+app.get('/api/boots/:deviceId', async (req, res) => {
+  try {
+    const since = req.query.since ? new Date(req.query.since) : new Date(Date.now() - 30 * 86400 * 1000);
+    const docs = await bootCol.find(
+      { id: req.params.deviceId, time: { $gte: since } },
+      { projection: { _id: 0 } }
+    ).sort({ time: 1 }).limit(500).toArray();
+    res.json(docs);
+  } catch (err) {
+    console.error('Boot read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /api/stream/:deviceId ───────────────────────────────────
+// The newest ?seconds= (default 60, at most the rolling window) of a device's
+// UDP stream, in g, as contiguous segments split at lost datagrams. With
+// ?from (and ?to, default now) the stored stream instead, at most
+// STREAM_BUFFER_SECONDS of it.
+app.get('/api/stream/:deviceId', async (req, res) => {
+  if (req.query.from) return onStoredStream(req, res);
+  const buffer = streams[req.params.deviceId];
+  if (!buffer) return res.status(404).json({ error: 'No stream from this device' });
+  const seconds = clamp(parseFloat(req.query.seconds) || 60, 1, STREAM_BUFFER_SECONDS);
+  res.json({ id: req.params.deviceId, alias: translationDict[req.params.deviceId], ...buffer.window(seconds) });
+});
+
+async function onStoredStream(req, res) {
+  if (!streamStore) return res.status(404).json({ error: 'Streams are not stored (STREAM_STORE_DAYS=0)' });
+  const from = parseTimeParam(req.query.from)?.getTime();
+  const to = req.query.to ? parseTimeParam(req.query.to)?.getTime() : Date.now();
+  if (from == null || to == null || to <= from) return res.status(400).json({ error: 'from < to required' });
+  if (to - from > STREAM_BUFFER_SECONDS * 1000) {
+    return res.status(400).json({ error: `at most ${STREAM_BUFFER_SECONDS} s` });
+  }
+  try {
+    const { rate_hz, chunks, segments } = await streamStore.read(req.params.deviceId, from, to);
+    res.json({
+      id: req.params.deviceId, alias: translationDict[req.params.deviceId], rate_hz, chunks,
+      from: new Date(from), to: new Date(to),
+      segments: segments.map(s => ({ t0: new Date(s.t0_ms), samples: Array.from({ length: s.samples.length / 3 },
+        (_, i) => [0, 1, 2].map(a => Math.round(s.samples[i * 3 + a] / miniseed.COUNTS_PER_G * 1e6) / 1e6)) })),
+    });
+  } catch (err) {
+    console.error('Stored stream read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+}
+
+// ── Stacked detections (lib/stacking.js) ────────────────────────
+// An event the nodes' streams show together, whether or not any of them
+// triggered on it: `triggered` lists the ones with an event of their own
+// within STACK_MATCH_MS of it.
+const STACK_MATCH_MS = 5000;
+
+function stackDoc(d, source) {
+  const triggered = [...new Set(recent.events({ fromMs: d.start_ms - STACK_MATCH_MS, untilMs: d.end_ms + STACK_MATCH_MS })
+    .filter(e => !e.status).map(e => e.id))];
+  return {
+    start: new Date(d.start_ms), end: new Date(d.end_ms), peak_time: new Date(d.peak_ms), peak: d.peak,
+    nodes: d.nodes, members: d.members, triggered, source,
+  };
+}
+
+async function onStackDetection(d) {
+  const doc = stackDoc(d, 'live');
+  const names = d.members.map(m => `${translationDict[m.id] || m.id} ${m.peak}`).join(', ');
+  console.log(`[STACK] ${doc.start.toISOString()} stack ${d.peak} over ${d.nodes} nodes (${names})` +
+              (triggered.length ? `; ${triggered.length} triggered` : '; no node triggered'));
+  const { insertedId } = await stackCol.insertOne(doc);
+  live.publish('seismic:stacked', { ...doc, _id: insertedId.toString(),
+                                    members: doc.members.map(m => ({ ...m, alias: translationDict[m.id] })) });
+}
+
+// ── GET /api/stacking ───────────────────────────────────────────
+// Stored stacked detections between ?from and ?to (default the last day),
+// newest first, and the detector's state.
+app.get('/api/stacking', async (req, res) => {
+  if (!stacker) return res.status(404).json({ error: 'Stacking is off (STACK_DETECT=off or no analysis workers)' });
+  const to = parseTimeParam(req.query.to) || new Date();
+  const from = parseTimeParam(req.query.from) || new Date(to - 86400e3);
+  try {
+    const detections = await stackCol.find({ start: { $gte: from, $lt: to } }).sort({ start: -1 }).limit(500).toArray();
+    res.json({ from, to, detector: stacker.metrics(), detections });
+  } catch (err) {
+    console.error('Stacking read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
 
-    // Consensus window (uses actual event time for accuracy)
-    windowDevices.add(id);
-    if (!windowTimer) {
-      console.log('----- window start');
-      windowTimer = setTimeout(onWindowEnd, 2000);
+// ── GET /api/stacking/scan ──────────────────────────────────────
+// The detector over the stored streams of ?from..?to (at most
+// STREAM_BUFFER_SECONDS; ?devices=a,b, default every device), after the
+// fact: what a live run would have found there. Nothing is stored.
+app.get('/api/stacking/scan', async (req, res) => {
+  if (!stacker || !streamStore) return res.status(404).json({ error: 'Needs stacking and stored streams' });
+  const from = parseTimeParam(req.query.from)?.getTime();
+  const to = req.query.to ? parseTimeParam(req.query.to)?.getTime() : Date.now();
+  if (from == null || to == null || to <= from) return res.status(400).json({ error: 'from < to required' });
+  if (to - from > STREAM_BUFFER_SECONDS * 1000) return res.status(400).json({ error: `at most ${STREAM_BUFFER_SECONDS} s` });
+  const ids = req.query.devices ? String(req.query.devices).split(',') : Object.keys(translationDict);
+  const { params } = stacker;
+  const lead = params.sta_ms + params.lta_ms;
+  try {
+    const traces = [];
+    for (const id of ids) {
+      const { rate_hz, segments } = await streamStore.read(id, from - lead, to);
+      if (segments.length) traces.push({ id, segments: segments.map(s => ({ ...s, rate_hz })) });
     }
-    return res.status(201).json({ status: 'logged' });
+    if (traces.length < params.min_nodes) {
+      return res.json({ from: new Date(from), to: new Date(to), traces: traces.length, detections: [] });
+    }
+    const result = await analysis.run('stack', { start_ms: from - lead, report_ms: from, to_ms: to, traces, params });
+    const detections = result.detections.map(d => stackDoc({ ...d, end_ms: d.end_ms ?? to }, 'scan'));
+    res.json({ from: new Date(from), to: new Date(to), traces: traces.length, max: result.max, detections });
   } catch (err) {
-    return res.status(500).json({ error: 'Internal server error', details: err.stack });
+    console.error('Stacking scan error:', err.message);
+    res.status(500).json({ error: err.message });
   }
 });
 
-// ── GET /api/init ───────────────────────────────────────────────
-app.get('/api/init', async (req, res) => {
-  const { id } = req.query;
-  if (!id) return res.status(400).json({ error: 'Missing id parameter' });
-  if (!translationDict[id]) translationDict[id] = id;
-  lastEventTimes[id] = new Date();
-  const now = new Date().toISOString();
-  lastInitTimes[id] = now;
+// ── GET /api/pull (device, after a 203) ─────────────────────────
+// Hands over the pending pull for ?id=; 204 if there is none any more
+async function onPullPoll(req, res) {
+  // Shared: whichever instance claims it first hands it over
+  const pull = shared ? await shared.takePull(req.query.id).catch(() => null) : pendingPulls[req.query.id];
+  delete pendingPulls[req.query.id];
+  if (!pull) return res.status(204).end();
+  sentPulls[req.query.id] = pull;
+  res.json({ ...pull, now_ms: Date.now() });
+}
+app.get('/api/pull', onPullPoll);
 
-  // Load config from MongoDB (global + per-device override)
-  let cfg = { ...DEFAULT_CONFIG };
-  try {
-    const saved = await configCol.findOne({ _id: 'global' });
-    if (saved) {
-      cfg.heartbeat_interval = saved.heartbeat_interval ?? cfg.heartbeat_interval;
-      cfg.sensitivity = { ...cfg.sensitivity, ...(saved.sensitivity || {}) };
-      cfg.consensus_window_ms = saved.consensus_window_ms ?? cfg.consensus_window_ms;
-      cfg.status_threshold_seconds = saved.status_threshold_seconds ?? cfg.status_threshold_seconds;
-
-      // Per-device overrides
-      const devCfg = saved.devices?.[id];
-      if (devCfg) {
-        if (devCfg.heartbeat_interval != null) cfg.heartbeat_interval = devCfg.heartbeat_interval;
-        if (devCfg.sensitivity) cfg.sensitivity = { ...cfg.sensitivity, ...devCfg.sensitivity };
-      }
+// ── POST /api/blackbox (device, a pull its ring had rolled past) ─
+// The device's flash black box blocks (lib/blackbox.js) around the pull it
+// was handed. Stored decoded, trimmed to the window, one doc per pull.
+async function onBlackBox(req, res) {
+  const id = String(req.query.id || '');
+  if (!id || !Buffer.isBuffer(req.body) || !req.body.length) return res.status(400).json({ error: 'blocks required' });
+  markSeen(id);
+  const sharedPull = shared ? await shared.finishPull(id).catch(() => null) : null;
+  const pull = sentPulls[id] ?? sharedPull ?? null;
+  delete sentPulls[id];
+  const decoded = blackbox.decodeBlackBox(req.body, pull?.from_ms, pull?.to_ms);
+  const samples = decoded.runs.reduce((n, r) => n + r.x.length, 0);
+  const doc = {
+    id, alias: translationDict[id], pull_id: pull?.pull_id ?? null,
+    from_ms: pull?.from_ms ?? decoded.runs[0]?.start_ms ?? null, to_ms: pull?.to_ms ?? null,
+    received: new Date(), blocks: decoded.blocks, skipped: decoded.skipped, samples, runs: decoded.runs,
+  };
+  console.log(`[PULL] ${translationDict[id] || id}: ${samples} samples in ${decoded.runs.length} runs from the black box`);
+  try {
+    const { insertedId } = await blackboxCol.insertOne(doc);
+    live.publish('blackbox:pulled', { ...doc, _id: insertedId, runs: undefined }, id);
+    res.json({ status: 'stored', samples });
+  } catch (err) {
+    console.error('Black box write error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+}
+app.post('/api/blackbox', onBlackBox);
+
+// ── GET /api/blackbox/:deviceId[/:recordId] ─────────────────────
+// Black box pulls of a device, newest first, without their samples; with a
+// record id, that one pull with its runs (x/y/z in g).
+app.get('/api/blackbox/:deviceId/:recordId?', async (req, res) => {
+  try {
+    if (req.params.recordId) {
+      if (!ObjectId.isValid(req.params.recordId)) return res.status(400).json({ error: 'Invalid id' });
+      const doc = await blackboxCol.findOne({ _id: new ObjectId(req.params.recordId), id: req.params.deviceId });
+      return doc ? res.json(doc) : res.status(404).json({ error: 'No such pull' });
     }
-  } catch (e) { console.error('Config load error:', e.message); }
+    const docs = await blackboxCol.find({ id: req.params.deviceId }, { projection: { runs: 0 } })
+      .sort({ from_ms: -1 }).limit(100).toArray();
+    res.json({ holds: lastBlackBox[req.params.deviceId] ?? null, pulls: docs });
+  } catch (err) {
+    console.error('Black box read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
 
-  // Track firmware version reported by this device
-  const reportedVersion = req.query.version || null;
-  if (reportedVersion) {
-    deviceFirmwareVersions[id] = reportedVersion;
-    console.log(`[FIRMWARE] ${translationDict[id]} (${id}) running v${reportedVersion}`);
+// ── POST /api/pull/:deviceId ────────────────────────────────────
+// Ask a device for a window of its ring by hand: { from_ms, to_ms, center_ms? }
+// in epoch ms. The upload shows up as a PULLED event with pull_id 'manual';
+// a window the ring has rolled past comes from the black box instead.
+app.post('/api/pull/:deviceId', (req, res) => {
+  const from = Number(req.body?.from_ms), to = Number(req.body?.to_ms);
+  if (!Number.isFinite(from) || !Number.isFinite(to) || to <= from) {
+    return res.status(400).json({ error: 'from_ms < to_ms required' });
   }
+  const center = Number.isFinite(Number(req.body.center_ms)) ? Number(req.body.center_ms) : (from + to) / 2;
+  requestPull(req.params.deviceId, { pull_id: 'manual', from_ms: from, to_ms: to, center_ms: center });
+  res.json({ status: 'queued', deviceId: req.params.deviceId });
+});
 
-  // Mark any "sent" reinit flags as completed
+// ── Waveform injection (WAVEFORM_INJECT builds only) ────────────
+// POST /api/inject/:deviceId { event_id }: play that stored capture on the
+// device at its next heartbeat. GET /api/inject/:deviceId: the latest run.
+// Queue a stored capture for id's next heartbeat -> its run id (null: no
+// such waveform)
+async function queueInjection(id, eventId) {
+  const queued = ingest.pending(eventId);
+  const stored = queued ? queued.waveform
+    : ObjectId.isValid(eventId) ? await waveformsCol.findOne({ _id: new ObjectId(eventId) }) : null;
+  if (!stored) return null;
+  const runId = nextInjectRun++;
+  const body = waveform.injectionBody(stored, runId);
+  pendingInjects[id] = { run_id: runId, event_id: eventId, body, requested_at: new Date().toISOString() };
+  injections[id] = { run_id: runId, event_id: eventId, status: 'queued', requested_at: pendingInjects[id].requested_at };
+  console.log(`[INJECT] ${translationDict[id] || id}: run ${runId} of event ${eventId}, ${stored.count} samples`);
+  return runId;
+}
+
+app.post('/api/inject/:deviceId', async (req, res) => {
   try {
-    await reinitCol.updateMany(
-      { deviceId: id, status: 'sent' },
-      { $set: { status: 'completed', completed_at: now } }
-    );
-  } catch {}
+    const id = req.params.deviceId;
+    const runId = await queueInjection(id, String(req.body?.event_id || ''));
+    if (runId == null) return res.status(404).json({ error: 'No stored waveform for that event' });
+    res.json({ status: 'queued', deviceId: id, run_id: runId });
+  } catch (err) {
+    res.status(400).json({ error: err.message });
+  }
+});
 
-  // Build firmware OTA fields if firmware.json is present on disk
-  const fwInfo = getFirmwareInfo();
-  const protocol = req.headers['x-forwarded-proto'] || 'http';
-  const host = req.headers['host'] || `${getLocalIp()}:${PORT}`;
-  const firmwareUrl = `${protocol}://${host}/api/firmware/latest.bin`;
+// The device fetches the body it was told about with a 207
+function onInjectPoll(req, res) {
+  const id = req.query.id;
+  const pending = pendingInjects[id];
+  delete pendingInjects[id];
+  if (!pending) return res.status(204).end();
+  if (injections[id]?.run_id === pending.run_id) {
+    injections[id].status = 'playing';
+    injections[id].served_at = new Date().toISOString();
+  }
+  res.type(waveform.BINARY_CONTENT_TYPE).send(pending.body);
+}
+app.get('/api/inject', onInjectPoll);
 
-  io.emit('device:init', {
-    id, alias: translationDict[id], time: now, config: cfg,
-    firmware_version: reportedVersion,
-    server_firmware_version: fwInfo?.version || null,
-  });
-  console.log(`[INIT] ${translationDict[id]} (${id}) initialized`);
+app.get('/api/inject/:deviceId', (req, res) => {
+  const run = injections[req.params.deviceId];
+  if (!run) return res.status(404).json({ error: 'No injection for that device' });
+  res.json(run);
+});
 
-  const response = {
-    heartbeat_interval: cfg.heartbeat_interval,
-    sensitivity: cfg.sensitivity,
-  };
-  if (fwInfo) {
-    response.firmware_version = fwInfo.version;
-    response.firmware_url = firmwareUrl;
+// ── Soak tests (WAVEFORM_INJECT builds, lib/soak.js) ─────────────
+// POST /api/soak/:deviceId { event_id, interval_s, hours }: inject that
+// stored capture every interval_s (default 600) for hours (default 72) and
+// trend the node's heap, jitter and latency. DELETE stops it. GET /api/soak
+// (?id=): the runs with their summaries and the per-firmware comparison;
+// GET /api/soak/runs/:runId: one run with its points.
+app.post('/api/soak/:deviceId', async (req, res) => {
+  try {
+    const id = req.params.deviceId;
+    const eventId = String(req.body?.event_id || '');
+    const stored = ingest.pending(eventId) ||
+      (ObjectId.isValid(eventId) && await waveformsCol.findOne({ _id: new ObjectId(eventId) }, { projection: { _id: 1 } }));
+    if (!stored) return res.status(404).json({ error: 'No stored waveform for that event' });
+    const run = await soakTests.begin(id, { ...req.body, event_id: eventId }, deviceFirmwareVersions[id]);
+    console.log(`[SOAK] ${translationDict[id] || id}: ${run.firmware}, event ${eventId} every ${run.interval_s}s until ${run.ends.toISOString()}`);
+    res.json({ status: 'running', deviceId: id, run_id: run._id, ends: run.ends });
+  } catch (err) {
+    res.status(500).json({ error: err.message });
   }
-  res.json(response);
 });
 
-// ── GET /api/status ─────────────────────────────────────────────
-app.get('/api/status', async (req, res) => {
-  const now = new Date();
-  // Load threshold from config
-  let threshold = DEFAULT_CONFIG.status_threshold_seconds * 1000;
+app.delete('/api/soak/:deviceId', async (req, res) => {
   try {
-    const saved = await configCol.findOne({ _id: 'global' });
-    if (saved?.status_threshold_seconds) threshold = saved.status_threshold_seconds * 1000;
-  } catch {}
-
-  const result = {};
-  for (const id of DEVICE_IDS) {
-    const last = lastEventTimes[id];
-    result[id] = {
-      alias: translationDict[id] || '',
-      status: last && (now - last) <= threshold ? 'Online' : 'Offline',
-      last_init: lastInitTimes[id] || null,
-      firmware_version: deviceFirmwareVersions[id] || null,
-    };
+    const runId = await soakTests.end(req.params.deviceId);
+    if (!runId) return res.status(404).json({ error: 'No soak running on that device' });
+    res.json({ status: 'stopped', run_id: runId });
+  } catch (err) {
+    res.status(500).json({ error: err.message });
   }
-  res.json(result);
 });
 
-// ── GET /api/events ─────────────────────────────────────────────
-app.get('/api/events', async (req, res) => {
+app.get('/api/soak', async (req, res) => {
   try {
-    // Exclude waveform arrays from bulk listing (fetched per-event via /api/events/:id/waveform)
-    const events = await eventsCol.find({}, { projection: { waveform: 0 } })
-      .sort({ timestamp: -1 })
-      .limit(50000)
-      .toArray();
-    // Convert _id to string for frontend use
-    events.forEach(e => { if (e._id) e._id = e._id.toString(); });
-    res.json(events);
+    res.json(await soakTests.list(req.query.id));
   } catch (err) {
-    console.error('Events read error:', err.message);
-    res.json([]);
+    res.status(500).json({ error: err.message });
   }
 });
 
-// ── GET /api/events/:id/waveform ────────────────────────────────
-app.get('/api/events/:id/waveform', async (req, res) => {
+app.get('/api/soak/runs/:runId', async (req, res) => {
   try {
-    const event = await eventsCol.findOne(
-      { _id: new ObjectId(req.params.id) },
-      { projection: { waveform: 1, timestamp: 1, level: 1, deltaG: 1, alias: 1 } }
-    );
-    if (!event) return res.status(404).json({ error: 'Event not found' });
-    if (!event.waveform) return res.status(404).json({ error: 'No waveform data for this event' });
-    res.json({
-      _id: event._id.toString(),
-      timestamp: event.timestamp,
-      level: event.level,
-      deltaG: event.deltaG,
-      alias: event.alias,
-      waveform: event.waveform,
-    });
+    const run = await soakTests.get(req.params.runId);
+    return run ? res.json(run) : res.status(404).json({ error: 'No such soak run' });
   } catch (err) {
-    console.error('Waveform read error:', err.message);
     res.status(500).json({ error: err.message });
   }
 });
@@ -326,17 +2802,53 @@ app.get('/api/events/:id/waveform', async (req, res) => {
 // ── GET /api/consensus ──────────────────────────────────────────
 app.get('/api/consensus', async (req, res) => {
   try {
-    const events = await eventsCol.find(
-      { status: 'CONFIRMED' },
-      { projection: { _id: 0 } }
-    ).sort({ timestamp: -1 }).toArray();
-    res.json(events);
+    const events = await eventsCol.find({ status: 'CONFIRMED' })
+      .sort({ time: -1 }).hint(queries.CONFIRMED_INDEX).toArray();
+    // _id for /api/consensus/:id/waveforms
+    res.json(events.map(e => ({ ...expandEvent(e), _id: e._id.toString() })));
   } catch (err) {
     console.error('Consensus read error:', err.message);
     res.json([]);
   }
 });
 
+// ── GET /api/consensus/:id/waveforms ────────────────────────────
+// Every member's event and waveform in one response, in the entry's device
+// order, with its peak and arrival offset: { _id, timestamp, members: [{ id,
+// alias, event_id, deltaG, level, offset_ms, tier, sample_count, waveform }] }.
+// ?max_points bounds each waveform as for /api/events/:id/waveform; a member
+// without a stored waveform has waveform null.
+app.get('/api/consensus/:id/waveforms', async (req, res) => {
+  if (!ObjectId.isValid(req.params.id)) return res.status(400).json({ error: 'Invalid consensus id' });
+  try {
+    const stored = await eventsCol.findOne({ _id: new ObjectId(req.params.id), devices: { $exists: true } });
+    if (!stored) return res.status(404).json({ error: 'Consensus not found' });
+    const entry = expandEvent(stored);
+    const events = await memberEvents(entry);
+    const ids = [...events.values()].map(e => e._id);
+    const waves = new Map((await waveformsCol.find({ _id: { $in: ids } }).toArray()).map(w => [w._id.toString(), w]));
+    const maxPoints = clamp(parseInt(req.query.max_points, 10) || 0, 0, WAVEFORM_MAX_POINTS);
+    const members = entry.devices.map((id) => {
+      const e = events.get(id);
+      if (!e) return { id, alias: translationDict[id] || id, event_id: null, waveform: null };
+      const hex = e._id.toString();
+      const w = waves.get(hex) || ingest.pending(hex)?.waveform || null;
+      const wave = w ? waveform.unpackWaveform(w) : null;
+      const link = entry.member_events?.[id] || memberLink(entry, e);
+      return {
+        id, alias: translationDict[id] || id, ...link,
+        tier: w?.tier || (w ? 'full' : null),
+        sample_count: wave?.length ?? 0,
+        waveform: wave && waveform.envelope(wave, { maxPoints }),
+      };
+    });
+    res.json({ _id: stored._id.toString(), timestamp: entry.timestamp, status: entry.status, group: entry.group, members });
+  } catch (err) {
+    console.error('Consensus waveforms read error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
 // ── GET /api/config ──────────────────────────────────────────────
 app.get('/api/config', async (req, res) => {
   try {
@@ -346,10 +2858,14 @@ app.get('/api/config', async (req, res) => {
     if (!cfg.devices) cfg.devices = {};
     for (const id of DEVICE_IDS) {
       if (!cfg.devices[id]) {
-        cfg.devices[id] = { alias: translationDict[id], heartbeat_interval: null, sensitivity: null };
+        cfg.devices[id] = { alias: translationDict[id], heartbeat_interval: null, sensitivity: null, sample_rate_hz: null };
       } else {
         cfg.devices[id].alias = translationDict[id];
       }
+      cfg.devices[id].site = registry.get(id)?.site ?? null;
+      cfg.devices[id].group = registry.groupOf(id);
+      cfg.devices[id].lat = registry.get(id)?.lat ?? null;
+      cfg.devices[id].lon = registry.get(id)?.lon ?? null;
     }
     res.json(cfg);
   } catch (err) {
@@ -363,26 +2879,80 @@ app.put('/api/config', async (req, res) => {
     const body = req.body;
     const update = {
       heartbeat_interval: body.heartbeat_interval ?? DEFAULT_CONFIG.heartbeat_interval,
+      push_heartbeat_interval: body.push_heartbeat_interval ?? DEFAULT_CONFIG.push_heartbeat_interval,
       sensitivity: {
         minor:    body.sensitivity?.minor    ?? DEFAULT_CONFIG.sensitivity.minor,
         moderate: body.sensitivity?.moderate ?? DEFAULT_CONFIG.sensitivity.moderate,
         severe:   body.sensitivity?.severe   ?? DEFAULT_CONFIG.sensitivity.severe,
       },
       consensus_window_ms: body.consensus_window_ms ?? DEFAULT_CONFIG.consensus_window_ms,
+      consensus_quorum: body.consensus_quorum ?? DEFAULT_CONFIG.consensus_quorum,
+      consensus_provisional: body.consensus_provisional ?? DEFAULT_CONFIG.consensus_provisional,
+      locate_velocity_m_s: body.locate_velocity_m_s ?? DEFAULT_CONFIG.locate_velocity_m_s,
+      consensus_coherence: body.consensus_coherence ?? DEFAULT_CONFIG.consensus_coherence,
       status_threshold_seconds: body.status_threshold_seconds ?? DEFAULT_CONFIG.status_threshold_seconds,
-      devices: body.devices || {},
+      sample_rate_hz: body.sample_rate_hz ?? DEFAULT_CONFIG.sample_rate_hz,
+      dlpf: body.dlpf ?? DEFAULT_CONFIG.dlpf,
+      pre_ms: body.pre_ms ?? DEFAULT_CONFIG.pre_ms,
+      post_ms: body.post_ms ?? DEFAULT_CONFIG.post_ms,
+      max_post_ms: body.max_post_ms ?? DEFAULT_CONFIG.max_post_ms,
+      ntp_server: body.ntp_server ?? DEFAULT_CONFIG.ntp_server,
+      trigger_mode: body.trigger_mode ?? DEFAULT_CONFIG.trigger_mode,
+      detect_metric: body.detect_metric ?? DEFAULT_CONFIG.detect_metric,
+      sta_ms: body.sta_ms ?? DEFAULT_CONFIG.sta_ms,
+      lta_ms: body.lta_ms ?? DEFAULT_CONFIG.lta_ms,
+      sta_lta_on: body.sta_lta_on ?? DEFAULT_CONFIG.sta_lta_on,
+      sta_lta_off: body.sta_lta_off ?? DEFAULT_CONFIG.sta_lta_off,
+      hp_hz: body.hp_hz ?? DEFAULT_CONFIG.hp_hz,
+      lp_hz: body.lp_hz ?? DEFAULT_CONFIG.lp_hz,
+      bias_track_s: body.bias_track_s ?? DEFAULT_CONFIG.bias_track_s,
+      stream_mode: body.stream_mode ?? DEFAULT_CONFIG.stream_mode,
+      stream_hz: body.stream_hz ?? DEFAULT_CONFIG.stream_hz,
+      spectrum: body.spectrum ?? DEFAULT_CONFIG.spectrum,
+      local_http: body.local_http ?? DEFAULT_CONFIG.local_http,
+      devices: {},
       updated_at: new Date().toISOString(),
     };
+    // Site, group and coordinates belong to the registry, not the config document
+    const placement = {};
+    for (const [id, dev] of Object.entries(body.devices || {})) {
+      const { site, group, lat, lon, ...rest } = dev || {};
+      update.devices[id] = rest;
+      const reg = registry.get(id);
+      const fields = {};
+      if (site !== undefined && (site || null) !== (reg?.site ?? null)) fields.site = site;
+      if (lat !== undefined && (lat ?? null) !== (reg?.lat ?? null)) fields.lat = lat;
+      if (lon !== undefined && (lon ?? null) !== (reg?.lon ?? null)) fields.lon = lon;
+      if (group !== undefined && (group || DEFAULT_GROUP) !== registry.groupOf(id)) fields.group = group;
+      if (rest.alias && reg && rest.alias !== reg.alias) fields.alias = rest.alias;
+      if (Object.keys(fields).length) placement[id] = fields;
+    }
+    // Bump the generation of every device whose effective config changed
+    const prev = savedConfig;
+    const changed = [];
+    const ids = new Set([...DEVICE_IDS, ...Object.keys(prev?.devices || {}),
+      ...Object.keys(update.devices), ...Object.keys(lastEventTimes)]);
+    for (const id of ids) {
+      if (deviceView(deviceConfig(prev, id)) !== deviceView(deviceConfig(update, id))) {
+        configGens[id] = (configGens[id] || 0) + 1;
+        changed.push(id);
+      }
+    }
+    update.config_gen = { ...configGens };
     await configCol.updateOne(
       { _id: 'global' },
       { $set: update },
       { upsert: true }
     );
+    savedConfig = { _id: 'global', ...(prev || {}), ...update };
     // Update translation dict from device aliases
     for (const [id, dev] of Object.entries(update.devices)) {
       if (dev.alias) translationDict[id] = dev.alias;
     }
-    io.emit('config:updated', update);
+    await registry.putDevices(placement);
+    syncRegistry();          // consensus settings and groups; bumps status (aliases, online threshold)
+    live.publish('config:updated', update);
+    for (const id of changed) notifyPush(id);
     console.log('[CONFIG] Configuration saved');
     res.json({ status: 'saved', config: update });
   } catch (err) {
@@ -390,10 +2960,102 @@ app.put('/api/config', async (req, res) => {
   }
 });
 
+// ── Threshold tuning ─────────────────────────────────────────────
+// Hourly: each device's suggested minor (lib/tuning.js). With
+// THRESHOLD_TUNING=apply one that differs from the minor in effect by more
+// than TUNING_MIN_CHANGE is written as that device's sensitivity override,
+// as a save from the admin page would; 'propose' leaves that to POST
+// /api/tuning/apply.
+const TUNING_INTERVAL_MS = 60 * 60 * 1000;
+const TUNING_MIN_CHANGE = 0.1;
+const tuningApplied = {};   // deviceId → { minor, from, at, auto }
+
+const sensitivityOf = (id) => deviceConfig(savedConfig, id).sensitivity;
+
+// { id: minor } into devices[id].sensitivity.minor: one write, one
+// config:updated, and the devices whose config moved are woken
+async function applySensitivity(minors, auto) {
+  const prev = savedConfig;
+  const devices = { ...(prev?.devices || {}) };
+  for (const [id, minor] of Object.entries(minors)) {
+    devices[id] = { ...(devices[id] || { alias: translationDict[id] }), sensitivity: { ...(devices[id]?.sensitivity || {}), minor } };
+  }
+  const next = { _id: 'global', ...(prev || {}), devices, updated_at: new Date().toISOString() };
+  const changed = Object.keys(minors).filter(id => deviceView(deviceConfig(prev, id)) !== deviceView(deviceConfig(next, id)));
+  if (!changed.length) return [];
+  for (const id of changed) configGens[id] = (configGens[id] || 0) + 1;
+  next.config_gen = { ...configGens };
+  await configCol.updateOne(
+    { _id: 'global' },
+    { $set: { devices, config_gen: next.config_gen, updated_at: next.updated_at } },
+    { upsert: true }
+  );
+  const at = next.updated_at;
+  for (const id of changed) tuningApplied[id] = { minor: minors[id], from: sensitivityOf(id).minor, at, auto };
+  savedConfig = next;
+  live.publish('config:updated', next);
+  for (const id of changed) notifyPush(id);
+  console.log(`[TUNING] minor ${auto ? 'auto-applied' : 'applied'}: ` +
+    changed.map(id => `${translationDict[id] || id} ${minors[id]}g`).join(', '));
+  return changed;
+}
+
+async function tuneThresholds() {
+  if (THRESHOLD_TUNING !== 'apply') return;
+  const minors = {};
+  for (const [id, p] of Object.entries(tuner.propose(sensitivityOf))) {
+    if (p.proposed != null && p.minor && Math.abs(p.proposed - p.minor) / p.minor > TUNING_MIN_CHANGE) minors[id] = p.proposed;
+  }
+  await applySensitivity(minors, true);
+}
+
+// Noise sketches from the stored trace after a restart, oldest first
+async function seedTuner() {
+  const since = new Date(Date.now() - 2 * tuner.halfMs);
+  let seconds = 0;
+  for await (const doc of traceCol.find({ t0: { $gte: since } }, { projection: { id: 1, t0: 1, min: 1, max: 1, rms: 1 } })
+    .sort({ t0: 1 })) {
+    tuner.addTrace(doc.id, doc, deviceConfig(savedConfig, doc.id).detect_metric, +doc.t0);
+    seconds += doc.min.length;
+  }
+  console.log(`[TUNING] noise floors seeded from ${seconds} stored seconds`);
+}
+
+// ── GET /api/tuning ─────────────────────────────────────────────
+app.get('/api/tuning', (req, res) => {
+  if (!tuner) return res.json({ mode: 'off', devices: {} });
+  res.json({
+    mode: THRESHOLD_TUNING,
+    margin: TUNING_MARGIN,
+    min_seconds: tuner.minSeconds,
+    devices: tuner.propose(sensitivityOf),
+    applied: tuningApplied,
+  });
+});
+
+// ── POST /api/tuning/apply ──────────────────────────────────────
+// { devices: [id, ...] } (all with a suggestion if absent) takes the
+// current suggestions as their minor override
+app.post('/api/tuning/apply', async (req, res) => {
+  if (!tuner) return res.status(409).json({ error: 'THRESHOLD_TUNING is off' });
+  try {
+    const proposals = tuner.propose(sensitivityOf);
+    const wanted = Array.isArray(req.body?.devices) ? req.body.devices : Object.keys(proposals);
+    const minors = {};
+    for (const id of wanted) if (proposals[id]?.proposed != null) minors[id] = proposals[id].proposed;
+    const changed = await applySensitivity(minors, false);
+    res.json({ applied: Object.fromEntries(changed.map(id => [id, minors[id]])) });
+  } catch (err) {
+    console.error('Tuning apply error:', err.message);
+    res.status(500).json({ error: err.message });
+  }
+});
+
 // ── POST /api/config/reinit/:deviceId ───────────────────────────
 app.post('/api/config/reinit/:deviceId', async (req, res) => {
   try {
     const { deviceId } = req.params;
+    const recalibrate = req.query.recalibrate === '1' || req.query.recalibrate === 'true';
     if (!DEVICE_IDS.includes(deviceId) && !translationDict[deviceId]) {
       return res.status(404).json({ error: 'Unknown device' });
     }
@@ -408,12 +3070,15 @@ app.post('/api/config/reinit/:deviceId', async (req, res) => {
       alias: translationDict[deviceId] || deviceId,
       requested_at: new Date().toISOString(),
       status: 'pending',       // pending → sent (205 sent) → completed (device called /init)
+      recalibrate,             // device re-measures bias rather than restoring it
       sent_at: null,
       completed_at: null,
     };
     await reinitCol.insertOne(doc);
-    io.emit('device:reinit_requested', { id: deviceId, alias: translationDict[deviceId], time: doc.requested_at });
-    console.log(`[REINIT] Requested for ${translationDict[deviceId]} (${deviceId})`);
+    flagsOf(deviceId).pending = doc;
+    live.publish('device:reinit_requested', { id: deviceId, alias: translationDict[deviceId], time: doc.requested_at }, deviceId);
+    notifyPush(deviceId);
+    console.log(`[REINIT] Requested for ${translationDict[deviceId]} (${deviceId})${recalibrate ? ' with recalibration' : ''}`);
     res.json({ status: 'queued', deviceId, alias: translationDict[deviceId] });
   } catch (err) {
     res.status(500).json({ error: err.message });
@@ -421,26 +3086,32 @@ app.post('/api/config/reinit/:deviceId', async (req, res) => {
 });
 
 // ── POST /api/config/reinit-all ─────────────────────────────────
+// Two round trips for the whole fleet: one cancel, one insertMany
 app.post('/api/config/reinit-all', async (req, res) => {
   try {
-    const results = [];
-    for (const deviceId of DEVICE_IDS) {
+    const recalibrate = req.query.recalibrate === '1' || req.query.recalibrate === 'true';
+    const ids = [...DEVICE_IDS];
+    const now = new Date().toISOString();
+    const docs = ids.map(deviceId => ({
+      deviceId,
+      alias: translationDict[deviceId] || deviceId,
+      requested_at: now,
+      status: 'pending',
+      recalibrate,
+      sent_at: null,
+      completed_at: null,
+    }));
+    if (docs.length) {
       await reinitCol.updateMany(
-        { deviceId, status: 'pending' },
-        { $set: { status: 'cancelled', cancelled_at: new Date().toISOString() } }
+        { deviceId: { $in: ids }, status: 'pending' },
+        { $set: { status: 'cancelled', cancelled_at: now } }
       );
-      const doc = {
-        deviceId,
-        alias: translationDict[deviceId] || deviceId,
-        requested_at: new Date().toISOString(),
-        status: 'pending',
-        sent_at: null,
-        completed_at: null,
-      };
-      await reinitCol.insertOne(doc);
-      results.push({ deviceId, alias: translationDict[deviceId] });
+      await reinitCol.insertMany(docs);
     }
-    io.emit('device:reinit_all_requested', { devices: results, time: new Date().toISOString() });
+    for (const doc of docs) flagsOf(doc.deviceId).pending = doc;
+    const results = ids.map(deviceId => ({ deviceId, alias: translationDict[deviceId] }));
+    live.publish('device:reinit_all_requested', { devices: results, time: new Date().toISOString() });
+    for (const { deviceId } of results) notifyPush(deviceId);
     console.log('[REINIT] Requested for ALL devices');
     res.json({ status: 'queued', devices: results });
   } catch (err) {
@@ -463,20 +3134,134 @@ app.get('/api/config/reinit-status', async (req, res) => {
   }
 });
 
+// ── Device registry ─────────────────────────────────────────────
+// GET lists devices and groups; PUT creates or updates (only the fields
+// sent); a group can only be deleted once no device is in it
+app.get('/api/devices', (req, res) => res.json(registry.toJSON()));
+
+app.put('/api/devices/:deviceId', async (req, res) => {
+  try {
+    const { alias, site, group, lat, lon } = req.body || {};
+    const doc = await registry.putDevice(req.params.deviceId,
+      Object.fromEntries(Object.entries({ alias, site, group, lat, lon }).filter(([, v]) => v !== undefined)));
+    syncRegistry();
+    console.log(`[REGISTRY] ${doc._id}: ${doc.alias || '-'} in ${doc.group}${doc.site ? ` @ ${doc.site}` : ''}`);
+    res.json({ status: 'saved', device: doc });
+  } catch (err) {
+    res.status(500).json({ error: err.message });
+  }
+});
+
+app.delete('/api/devices/:deviceId', async (req, res) => {
+  try {
+    if (!(await registry.removeDevice(req.params.deviceId))) return res.status(404).json({ error: 'Unknown device' });
+    syncRegistry();
+    res.json({ status: 'removed' });
+  } catch (err) {
+    res.status(500).json({ error: err.message });
+  }
+});
+
+app.put('/api/groups/:name', async (req, res) => {
+  try {
+    const { site, quorum, window_ms } = req.body || {};
+    const doc = await registry.putGroup(req.params.name,
+      Object.fromEntries(Object.entries({ site, quorum, window_ms }).filter(([, v]) => v !== undefined)));
+    syncRegistry();
+    res.json({ status: 'saved', group: doc });
+  } catch (err) {
+    res.status(500).json({ error: err.message });
+  }
+});
+
+app.delete('/api/groups/:name', async (req, res) => {
+  try {
+    if (!(await registry.removeGroup(req.params.name))) return res.status(409).json({ error: 'Group has devices' });
+    syncRegistry();
+    res.json({ status: 'removed' });
+  } catch (err) {
+    res.status(500).json({ error: err.message });
+  }
+});
+
 // ── GET /api/http_logs ──────────────────────────────────────────
-app.get('/api/http_logs', (req, res) => res.json(httpLogs));
+// Per-endpoint request counts per minute: ?minutes=N (default 60, up to a
+// day) -> { start, minute_ms, total, endpoints: { '/api/events': [n, ...] } }.
+// ?recent=N instead lists the newest N requests as { timestamp, endpoint }.
+app.get('/api/http_logs', (req, res) => {
+  const recent = parseInt(req.query.recent, 10);
+  if (recent > 0) return res.json(httpLog.recent(recent));
+  res.json(httpLog.histogram(parseInt(req.query.minutes, 10) || 60));
+});
+
+// ── GET /api/latency ────────────────────────────────────────────
+// Distribution of the eventLatency stages over the newest ?limit= events
+// (default 500): { count, stages: { capture_ms: { n, p50, p90, p99, max }, ... } }
+const LATENCY_STAGES = ['capture_ms', 'queue_ms', 'network_ms', 'notice_ms', 'body_ms', 'journal_ms', 'emit_ms', 'commit_ms', 'total_ms'];
+app.get('/api/latency', async (req, res) => {
+  try {
+    const limit = Math.max(1, Math.min(5000, parseInt(req.query.limit, 10) || 500));
+    const filter = { latency: { $exists: true } };
+    if (req.query.id) filter.id = req.query.id;
+    const docs = await eventsCol.find(filter, { projection: { latency: 1 } })
+      .sort(queries.NEWEST_FIRST).hint(filter.id ? queries.DEVICE_INDEX : queries.TIME_INDEX).limit(limit).toArray();
+    const stages = {};
+    for (const key of LATENCY_STAGES) {
+      const v = docs.map(d => d.latency[key]).filter(Number.isFinite).sort((a, b) => a - b);
+      if (!v.length) continue;
+      const at = (q) => v[Math.min(v.length - 1, Math.ceil(q * v.length) - 1)];
+      stages[key] = { n: v.length, p50: at(0.5), p90: at(0.9), p99: at(0.99), max: v[v.length - 1] };
+    }
+    res.json({ count: docs.length, stages });
+  } catch (err) {
+    res.status(500).json({ error: err.message });
+  }
+});
+
+// ── GET /metrics ────────────────────────────────────────────────
+// Prometheus text format; see the metrics block near the top
+app.get('/metrics', (req, res) => res.type(METRICS_CONTENT_TYPE).send(metrics.render()));
 
 // ── GET /api/info ───────────────────────────────────────────────
+// Tagged on the ingest counters; clients revalidating get uptime from started_at
 app.get('/api/info', (req, res) => {
+  const m = ingest?.metrics();
+  if (m && notModified(req, res, `i${m.depth}.${m.enqueued}.${m.flushed}.${m.errors}.${m.replayed}`)) return;
   const localIp = getLocalIp();
   res.json({
     host_url: `http://${localIp}:${PORT}/`,
     api_port: PORT,
     local_ip: localIp,
+    started_at: startTime.toISOString(),
     uptime_seconds: (Date.now() - startTime.getTime()) / 1000,
+    ingest: ingest?.metrics() ?? null,
+    device_port: DEVICE_PORT || null,
+    gateway: DEVICE_PORT ? gateway.metrics() : null,
+    mqtt: mqtt?.metrics() ?? null,
+    recent: recent.metrics(),
+    retention: retention?.metrics() ?? null,
+    device_status: statusFeed.metrics(),
+    spectrograms: spectrograms.metrics(),
+    firmware: firmware.metrics(),
+    stats: hourlyStats?.metrics() ?? null,
+    notify: notifier?.metrics() ?? null,
+    role: SERVER_ROLE,
+    event_feed: eventFeed?.metrics() ?? null,
+    seedlink: seedlink?.metrics() ?? null,
+    session: sessions?.metrics() ?? null,
+    stream_store: streamStore?.metrics() ?? null,
+    stacking: stacker?.metrics() ?? null,
+    process: processMetrics(),
   });
 });
 
+// CPU time so far (bench/loadgen.js diffs it over a run) and memory
+function processMetrics() {
+  const cpu = process.cpuUsage();
+  return { cpu_user_ms: Math.round(cpu.user / 1000), cpu_system_ms: Math.round(cpu.system / 1000),
+           rss_bytes: process.memoryUsage.rss() };
+}
+
 function getLocalIp() {
   for (const ifaces of Object.values(os.networkInterfaces())) {
     for (const i of ifaces) {
@@ -488,64 +3273,656 @@ function getLocalIp() {
 
 // ── GET /api/firmware/version ──────────────────────────────────
 app.get('/api/firmware/version', (req, res) => {
-  const info = getFirmwareInfo();
+  const info = firmware.info();
   if (!info) return res.status(404).json({ error: 'No firmware deployed yet' });
-  res.json({ ...info, devices: deviceFirmwareVersions });
+  const rolling = rollout.version === info.version;
+  res.json({
+    ...info,
+    devices: deviceFirmwareVersions,
+    rollout: {
+      max_concurrent: OTA_MAX_CONCURRENT,
+      updating: rolling ? [...rollout.updating.keys()] : [],
+      waiting: rolling ? rollout.waiting : [],
+      done: rolling ? [...rollout.done] : [],
+    },
+  });
 });
 
 // ── GET /api/firmware/latest.bin ───────────────────────────────
-app.get('/api/firmware/latest.bin', (req, res) => {
-  const binPath = path.join(FIRMWARE_DIR, 'firmware.bin');
-  if (!fs.existsSync(binPath)) {
+// ?gz=1 (firmware that knows eboot inflates) gets the gzip image. The ETag is
+// the MD5 of the uncompressed image, which is also what ESPhttpUpdate sends
+// as x-ESP8266-sketch-md5, so a device already running this build gets a 304
+// even if the version string was bumped without a rebuild. x-MD5 is the MD5
+// of the body actually sent, which the updater checks before it commits.
+// Both bodies come from memory and take a Range (bytes=a-b, one range), so a
+// download that dropped can ask for the rest; If-Range with a stale ETag
+// gets the whole new image instead.
+function onFirmwareImage(req, res) {
+  const image = firmware.image();
+  if (!image) {
     return res.status(404).json({ error: 'firmware.bin not found on server' });
   }
-  const fwInfo = getFirmwareInfo();
+  const fwInfo = firmware.info();
   const version = fwInfo?.version || 'unknown';
-  console.log(`[FIRMWARE] Serving firmware.bin v${version} to ${req.ip}`);
+  const etag = `"${image.md5}"`;
+  res.setHeader('ETag', etag);
+  const running = (req.headers['x-esp8266-sketch-md5'] || '').toLowerCase();
+  const cached = (req.headers['if-none-match'] || '').split(',').map(t => t.trim().replace(/^W\//, ''));
+  if (running === image.md5 || cached.includes(etag)) {
+    console.log(`[FIRMWARE] ${req.ip} already has v${version} (304)`);
+    return res.status(304).end();
+  }
+  const gzip = req.query.gz === '1';
+  const body = gzip ? image.gz : image.raw;
+  const ifRange = req.headers['if-range'];
+  const range = !ifRange || ifRange.trim() === etag ? byteRange(req.headers.range, body.length) : null;
   res.setHeader('Content-Type', 'application/octet-stream');
-  res.setHeader('Content-Disposition', 'attachment; filename="firmware.bin"');
-  res.sendFile(binPath);
+  res.setHeader('Content-Disposition', `attachment; filename="firmware.bin${gzip ? '.gz' : ''}"`);
+  res.setHeader('Accept-Ranges', 'bytes');
+  res.setHeader('x-MD5', gzip ? image.gzMd5 : image.md5);   // of the whole body, ranged or not
+  if (range === false) {
+    res.setHeader('Content-Range', `bytes */${body.length}`);
+    return res.status(416).end();
+  }
+  if (range) {
+    const part = body.subarray(range.start, range.end + 1);
+    console.log(`[FIRMWARE] Resuming firmware.bin${gzip ? '.gz' : ''} v${version} at ${range.start}/${body.length} for ${req.ip}`);
+    res.status(206);
+    res.setHeader('Content-Range', `bytes ${range.start}-${range.end}/${body.length}`);
+    res.setHeader('Content-Length', part.length);
+    return res.end(part);
+  }
+  console.log(`[FIRMWARE] Serving firmware.bin${gzip ? '.gz' : ''} v${version} (${body.length} bytes) to ${req.ip}`);
+  res.setHeader('Content-Length', body.length);
+  res.end(body);
+}
+app.get('/api/firmware/latest.bin', onFirmwareImage);
+
+// ── Device gateway (DEVICE_PORT) ─────────────────────────────────
+// The routes the firmware calls, without the Express stack in front of them.
+// Counted in the same HTTP log and latency histogram as on PORT.
+const gateway = new DeviceGateway({
+  'GET /': onHeartbeat,
+  'GET /api/init': onInit,
+  'POST /api/seismic': onSeismic,
+  'GET /api/push': onPush,
+  'GET /api/pull': onPullPoll,
+  'POST /api/blackbox': onBlackBox,
+  'GET /api/inject': onInjectPoll,
+  'GET /api/firmware/latest.bin': onFirmwareImage,
+}, {
+  bodyReaders: { 'POST /api/seismic': readSeismicBody },
+  onDone: (route, method, code, at) => {
+    const r = route ? route.slice(method.length + 1) : '(unmatched)';
+    if (r.startsWith('/api')) httpLog.record(r, at);
+    metricHttp.observe({ method, route: r, code }, (Date.now() - at) / 1000);
+  },
 });
+const gatewayMetric = (key) => () => (DEVICE_PORT ? [[{}, gateway.metrics()[key]]] : []);
+metrics.gauge('seismo_gateway_queue_depth', 'Device requests read but not yet handled', [], gatewayMetric('depth'));
+metrics.counter('seismo_gateway_shed_total', 'Device requests answered 503 with the queue full', [], gatewayMetric('shed'));
+
+// ── MQTT ingestion (MQTT_URL, lib/mqtt.js) ───────────────────────
+// MQTT_LINK devices publish to the broker. Each message is run through the
+// handler of the route it stands in for, on a request built from it, and
+// acked once that has answered. What a heartbeat or push poll would have
+// answered goes back on seismo/<id>/cmd, a stale config as a fresh retained
+// seismo/<id>/config. With SHARED_STATE the device topics are subscribed as
+// a shared group, so each message reaches one replica.
+const mqttLive = {};       // deviceId → its broker session is up (retained status topic)
+const mqttGens = {};       // deviceId → config generation on its last MQTT heartbeat
+const mqttPolicies = {};   // deviceId → X-Upload-Policy last sent on its cmd topic
+const mqttReceived = {};   // topic leaf → messages handled
+const MQTT_COMMANDS = [205, 203, 207];
+let mqtt = null;           // MqttClient, started in main()
+metrics.counter('seismo_mqtt_messages_total', 'Device messages taken off the broker', ['topic'],
+  () => Object.entries(mqttReceived).map(([topic, n]) => [{ topic }, n]));
+
+// Where MQTT_LINK firmware finds the broker, for /api/init; the device side
+// is plain TCP only
+function mqttDeviceBroker() {
+  if (!MQTT_DEVICE_URL) return null;
+  const u = new URL(MQTT_DEVICE_URL);
+  if (u.protocol !== 'mqtt:') return null;
+  return { host: u.hostname, port: parseInt(u.port, 10) || 1883 };
+}
+
+// A broker message or session frame through a device route's handler -> the
+// response it got
+async function runDeviceRoute(handler, req, via = 'MQTT') {
+  const res = expressish(new CapturedResponse());
+  try {
+    await handler(req, res, () => res.status(404).json({ error: 'Not found' }));
+  } catch (err) {
+    console.error(`[${via}] ${req.path}: ${err.message}`);
+    if (!res.headersSent) res.status(500).json({ error: 'Internal server error' });
+  }
+  return res;
+}
+
+// The device's /api/init body, for pushing; OTA fields only for a device
+// whose running version we know
+function pushedConfig(id) {
+  const version = deviceFirmwareVersions[id] || null;
+  const scheme = TLS_CERT && TLS_KEY ? 'https' : 'http';
+  const firmwareUrl = `${scheme}://${getLocalIp()}:${DEVICE_PORT || PORT}/api/firmware/latest.bin`;
+  return initConfig(id, deviceConfig(savedConfig, id), version ? firmware.info() : null, firmwareUrl, version);
+}
+
+// Retained on its config topic
+function publishConfig(id) {
+  if (!mqtt?.connected) return;
+  mqtt.publish(`seismo/${id}/config`, JSON.stringify(pushedConfig(id)), { qos: 1, retain: true });
+}
+
+function publishCommand(id, text) {
+  mqtt?.publish(`seismo/${id}/cmd`, text, { qos: 1 });
+}
+
+// notifyPush() for a device on the broker
+async function notifyMqtt(id) {
+  const code = await pushPending(id, mqttGens[id]);
+  if (!code) return;
+  console.log(`[MQTT] ${code} to ${translationDict[id]} (${id})`);
+  if (code === 202) publishConfig(id);
+  else publishCommand(id, String(code));
+}
+
+async function onMqttMessage(msg, ack) {
+  const topic = deviceTopic(msg.topic);
+  if (!topic) return ack();
+  const { id, leaf } = topic;
+  const receivedAt = Date.now();
+  mqttReceived[leaf] = (mqttReceived[leaf] || 0) + 1;
+  if (leaf === 'status') {
+    mqttLive[id] = msg.payload.toString() === 'online';
+    statusChanged(id);
+    return ack();
+  }
+  if (leaf === 'trigger') {
+    const notice = decodeNotice(msg.payload);
+    if (notice) onTriggerNotice(notice, receivedAt);
+    return ack();
+  }
+  if (leaf === 'event') return ingestMqttEvent(id, msg, ack, receivedAt);
+  if (leaf !== 'heartbeat') return ack();
+
+  const query = Object.fromEntries(new URLSearchParams(msg.payload.toString('latin1')));
+  if (query.id !== id) return ack();
+  const res = await runDeviceRoute(onHeartbeat, { method: 'GET', path: '/', query, headers: {}, receivedAt, queued: msg.queued });
+  ack();
+  mqttGens[id] = parseInt(query.cfg, 10);
+  if (res.statusCode === 202) publishConfig(id);
+  else if (MQTT_COMMANDS.includes(res.statusCode)) publishCommand(id, String(res.statusCode));
+}
+
+// An upload off the broker. The device let its copy go on the broker's
+// PUBACK, so a 5xx (ingest backed up) isn't acked but retried here after
+// Retry-After; the broker still holds it should we stop meanwhile.
+async function ingestMqttEvent(id, msg, ack, receivedAt) {
+  const event = parseEventPayload(msg.payload);
+  if (!event) return ack();
+  let body = event.body;
+  if ((event.headers['content-type'] || '').split(';')[0].trim() === 'application/json') {
+    try {
+      body = JSON.parse(body.toString('utf8'));
+    } catch (e) {
+      console.error(`[MQTT] ${translationDict[id] || id}: invalid JSON upload: ${e.message}`);
+      return ack();
+    }
+  }
+  const res = await runDeviceRoute(onSeismic, { method: 'POST', path: '/api/seismic', query: {},
+                                                 headers: event.headers, body, receivedAt });
+  const policy = res.getHeader('X-Upload-Policy');
+  if (policy && policy !== mqttPolicies[id]) {
+    mqttPolicies[id] = policy;
+    publishCommand(id, `policy ${policy}`);
+  }
+  if (res.statusCode >= 500) {
+    const waitMs = (parseInt(res.getHeader('Retry-After'), 10) || 5) * 1000;
+    return setTimeout(() => ingestMqttEvent(id, msg, ack, receivedAt), waitMs);
+  }
+  ack();
+}
+
+// ── Device sessions (SESSION_PORT, lib/session.js) ───────────────
+// SESSION_LINK devices frame their heartbeats, trigger notices and uploads
+// onto one TCP connection. Each goes through the handler of the route it
+// stands in for, as a broker message does, and the frame's ACK carries the
+// status that route answered, so the device acts on it as it would on the
+// HTTP response: a 5xx upload is journaled and replayed by the device, not
+// retried here. The current config goes out when a session opens; a saved
+// change, a pull or a reinit as soon as there is one.
+const sessionGens = {};      // deviceId → config generation on its last session heartbeat
+const sessionPolicies = {};  // deviceId → X-Upload-Policy last sent on its session
+
+async function onSessionHeartbeat(s, text, receivedAt) {
+  const query = Object.fromEntries(new URLSearchParams(text));
+  if (query.id !== s.id) return 400;
+  const res = await runDeviceRoute(onHeartbeat, { method: 'GET', path: '/', query, headers: {}, receivedAt }, 'SESSION');
+  sessionGens[s.id] = parseInt(query.cfg, 10);
+  return res.statusCode;
+}
+
+async function onSessionEvent(s, payload, receivedAt) {
+  const event = parseEventPayload(payload);
+  if (!event) return { status: 400 };
+  let body = event.body;
+  if ((event.headers['content-type'] || '').split(';')[0].trim() === 'application/json') {
+    try {
+      body = JSON.parse(body.toString('utf8'));
+    } catch (e) {
+      console.error(`[SESSION] ${translationDict[s.id] || s.id}: invalid JSON upload: ${e.message}`);
+      return { status: 400 };
+    }
+  }
+  const res = await runDeviceRoute(onSeismic, { method: 'POST', path: '/api/seismic', query: {},
+                                                 headers: event.headers, body, receivedAt }, 'SESSION');
+  const policy = res.getHeader('X-Upload-Policy');
+  if (policy && policy !== sessionPolicies[s.id]) {
+    sessionPolicies[s.id] = policy;
+    sessions.send(s.id, SESSION_FRAMES.COMMAND, `policy ${policy}`);
+  }
+  return { status: res.statusCode, retryAfter: parseInt(res.getHeader('Retry-After'), 10) || 0 };
+}
+
+// notifyPush() for a device on a session
+async function notifySession(id) {
+  const code = await pushPending(id, sessionGens[id]);
+  if (!code) return;
+  console.log(`[SESSION] ${code} to ${translationDict[id]} (${id})`);
+  if (code === 202) sessions.send(id, SESSION_FRAMES.CONFIG, pushedConfig(id));
+  else sessions.send(id, SESSION_FRAMES.COMMAND, String(code));
+}
+
+function startSessions() {
+  sessions = new SessionServer({
+    port: SESSION_PORT,
+    handlers: {
+      heartbeat: onSessionHeartbeat,
+      event: onSessionEvent,
+      trigger: (s, payload, receivedAt) => {
+        const notice = decodeNotice(payload);
+        if (notice) onTriggerNotice(notice, receivedAt);
+      },
+      open: (s) => {
+        console.log(`[SESSION] ${translationDict[s.id] || s.id} open (${s.firmware || 'unknown firmware'})`);
+        delete sessionPolicies[s.id];
+        sessions.send(s.id, SESSION_FRAMES.CONFIG, pushedConfig(s.id));
+        statusChanged(s.id);
+      },
+      close: (s) => statusChanged(s.id),
+    },
+  }).start();
+}
 
 // ── Serve React build ───────────────────────────────────────────
-app.use(express.static(path.join(__dirname, 'public')));
+// Hashed chunks immutable, precompressed variants where built (lib/assets.js)
+app.use(serveAssets(PUBLIC_DIR));
 
 // SPA catch-all (client-side routing)
 app.get('*', (req, res) => {
-  const index = path.join(__dirname, 'public', 'index.html');
-  if (fs.existsSync(index)) return res.sendFile(index);
+  const index = path.join(PUBLIC_DIR, 'index.html');
+  if (fs.existsSync(index)) return res.set('Cache-Control', 'no-cache').sendFile(index);
   res.status(404).json({ error: 'Not found' });
 });
 
 // ── Connect to MongoDB then start ───────────────────────────────
+// ── Shared state (SHARED_STATE=1) ───────────────────────────────
+// What this instance knows about a device, for the others (lib/shared.js)
+function deviceSnapshot(id) {
+  return {
+    last_seen: lastEventTimes[id] || null,
+    alias: translationDict[id] || id,
+    last_init: lastInitTimes[id] || null,
+    firmware_version: deviceFirmwareVersions[id] || null,
+    temp_c: lastTemps[id] ?? null,
+    i2c: lastBusStats[id] ?? null,
+    profile: lastProfiles[id] ?? null,
+    heap: lastHeap[id] ?? null,
+    ota: lastOta[id] ?? null,
+    tasks: lastTasks[id] ?? null,
+    local_taps: lastTaps[id] ?? null,
+    boots: lastBoots[id] ?? null,
+    blackbox: lastBlackBox[id] ?? null,
+    tls: lastTls[id] ?? null,
+    uploads: lastUploads[id] ?? null,
+    evictions: lastEvictions[id] ?? null,
+    mqtt: lastMqtt[id] ?? null,
+    session: lastSession[id] ?? null,
+  };
+}
+
+// A device another instance heard from more recently than this one
+function adoptDevice(doc) {
+  const id = doc._id;
+  if (!doc.last_seen || (lastEventTimes[id] && lastEventTimes[id] >= doc.last_seen)) return;
+  if (!translationDict[id]) translationDict[id] = doc.alias || id;
+  lastEventTimes[id] = doc.last_seen;
+  if (doc.last_init) lastInitTimes[id] = doc.last_init;
+  if (doc.firmware_version) deviceFirmwareVersions[id] = doc.firmware_version;
+  const fields = [[lastTemps, 'temp_c'], [lastBusStats, 'i2c'], [lastProfiles, 'profile'],
+                  [lastHeap, 'heap'], [lastOta, 'ota'], [lastTasks, 'tasks'], [lastTaps, 'local_taps'],
+                  [lastBoots, 'boots'], [lastBlackBox, 'blackbox'], [lastTls, 'tls'],
+                  [lastUploads, 'uploads'], [lastEvictions, 'evictions'], [lastMqtt, 'mqtt'],
+                  [lastSession, 'session']];
+  for (const [map, key] of fields) if (doc[key] != null) map[id] = doc[key];
+  statusChanged(id);
+}
+
+// A config saved through another instance: it already bumped and stored the
+// generations, so take them and wake the devices whose one moved
+function adoptConfig(config) {
+  if (config.updated_at === savedConfig?.updated_at) return;
+  savedConfig = config;
+  const changed = Object.entries(config.config_gen || {})
+    .filter(([id, gen]) => gen !== (configGens[id] || 0)).map(([id]) => id);
+  Object.assign(configGens, config.config_gen || {});
+  for (const [id, dev] of Object.entries(config.devices || {})) {
+    if (dev.alias) translationDict[id] = dev.alias;
+  }
+  configureConsensus();
+  statusChanged();   // a new status_threshold_seconds moves every expiry
+  for (const id of changed) notifyPush(id);
+}
+
+function adoptReinitFlags(flags) {
+  const next = {};
+  for (const flag of flags) (next[flag.deviceId] ??= { pending: null, sent: null })[flag.status] = flag;
+  for (const id of new Set([...Object.keys(reinitFlags), ...Object.keys(next)])) {
+    const was = reinitFlags[id]?.pending?._id?.toString();
+    reinitFlags[id] = next[id] || { pending: null, sent: null };
+    const now = reinitFlags[id].pending?._id?.toString();
+    if (now && now !== was) notifyPush(id);
+  }
+}
+
+function adoptPulls(docs) {
+  const open = new Map(docs.filter(d => !d.sent).map(d => [d._id, d.pull]));
+  for (const id of Object.keys(pendingPulls)) if (!open.has(id)) delete pendingPulls[id];
+  for (const [id, pull] of open) {
+    if (pendingPulls[id]?.pull_id === pull.pull_id) continue;
+    pendingPulls[id] = pull;
+    notifyPush(id);
+  }
+}
+
+// This instance now runs consensus: rebuild the engine from the clusters
+// already confirmed and the triggers logged within its horizon
+async function takeConsensus(recent) {
+  clearConsensus();
+  const since = new Date(Date.now() - CONSENSUS_HORIZON_MS);
+  for (const stored of await eventsCol.find({ status: { $in: ['CONFIRMED', 'CANDIDATE'] }, time: { $gte: since } }).sort({ time: 1 }).toArray()) {
+    const entry = expandEvent(stored);
+    const engine = consensusGroups.get(entry.group || DEFAULT_GROUP);
+    if (!engine) continue;
+    const cluster = engine.adopt({ startMs: entry.time.getTime(), devices: entry.devices || [],
+                                   arrivals: entry.arrivals || {} });
+    consensusEntries.set(cluster, entry);
+    setTimeout(() => dropCluster(cluster), CONSENSUS_HORIZON_MS);
+    if (entry.status === 'CANDIDATE') scheduleCoherence(entry, entry.coherence?.threshold ?? deviceConfig(savedConfig, null).consensus_coherence);
+  }
+  for (const t of recent) placeTrigger(t.id, t.time_ms);
+  console.log(`[SHARED] ${INSTANCE_ID} runs consensus (${recent.length} recent triggers)`);
+}
+
+function clearConsensus() {
+  for (const engine of consensusGroups.values()) engine.clear();
+  consensusEntries.clear();
+  consensusLocators.clear();
+  for (const check of coherenceChecks.values()) clearTimeout(check.timer);
+  coherenceChecks.clear();
+}
+
+// Devices and groups edited through another instance
+async function reloadRegistry() {
+  const before = JSON.stringify(registry.toJSON());
+  await registry.reload();
+  if (JSON.stringify(registry.toJSON()) !== before) syncRegistry();
+}
+
+function startShared(db) {
+  shared = new SharedState(db, INSTANCE_ID, {
+    snapshot: deviceSnapshot,
+    onDevice: adoptDevice,
+    onConfig: adoptConfig,
+    onReinitFlags: adoptReinitFlags,
+    onPulls: adoptPulls,
+    // Other instances' writes into the recent window first, so a client
+    // revalidating on the new tag sees them
+    onEventsChanged: () => recent.sync(eventsCol)
+      .catch(e => console.error('Recent events sync error:', e.message))
+      .finally(() => bumpVersion('events')),
+    onTrigger: placeTrigger,
+    onLeader: takeConsensus,
+    onRefresh: reloadRegistry,
+    onFollower: () => {
+      clearConsensus();
+      console.log(`[SHARED] ${INSTANCE_ID} no longer runs consensus`);
+    },
+    horizonMs: () => CONSENSUS_HORIZON_MS,
+    onError: (e) => console.error('Shared state error:', e.message),
+  });
+  return shared.start();
+}
+
+// SERVER_ROLE=dashboard: new device events as the ingest instances store
+// them. Into the recent window first, so a client revalidating on the new
+// tag sees them; each instance sends its own sockets their copy.
+function startEventFeed() {
+  eventFeed = new EventFeed(eventsCol, {
+    onEvent: (doc) => {
+      recent.add(doc);
+      bumpVersion('events');
+      const e = expandEvent(doc);
+      e._id = e._id.toString();
+      live.publish(doc.status === 'PULLED' ? 'seismic:pulled' : 'seismic:event', e, doc.id, { local: true });
+    },
+    onGap: () => recent.sync(eventsCol)
+      .catch(e => console.error('Recent events sync error:', e.message))
+      .finally(() => bumpVersion('events')),
+    onError: (e) => console.error('Event feed error:', e.message),
+  });
+  return eventFeed.start();
+}
+
 async function main() {
-  const client = new MongoClient(MONGO_URI);
+  if (SERVER_ROLE !== 'all' && !SHARED_STATE) throw new Error(`SERVER_ROLE=${SERVER_ROLE} needs SHARED_STATE=1`);
+  const client = new MongoClient(MONGO_URI, { monitorCommands: true });
+  client.on('commandSucceeded', e => metricMongo.observe({ command: e.commandName, outcome: 'ok' }, e.duration / 1000));
+  client.on('commandFailed', e => metricMongo.observe({ command: e.commandName, outcome: 'error' }, e.duration / 1000));
   await client.connect();
   console.log('Connected to MongoDB');
 
   const db = client.db();          // uses database name from URI
   eventsCol = db.collection('events');
+  waveformsCol = db.collection('waveforms');
+  rollupsCol = db.collection('event_rollups');
+  hourlyStats = await new HourlyStats(db.collection('stats_hourly'))
+    .start(e => console.error('Stats flush error:', e.message));
   configCol = db.collection('config');
   reinitCol = db.collection('reinit_flags');
+  traceCol = db.collection('trace');
+  stormCol = db.collection('storm');
+  bootCol = db.collection('boots');
+  blackboxCol = db.collection('blackbox');
+  soakTests = await new SoakTests(db.collection('soak_runs'), {
+    inject: (id, eventId) => queueInjection(id, eventId),
+  }).start();
+  if (SHARED_STATE) {
+    // Socket.IO broadcasts reach the dashboards connected to every instance
+    const adapterCol = 'socket.io-adapter-events';
+    if (!(await db.listCollections({ name: adapterCol }).toArray()).length) {
+      await db.createCollection(adapterCol, { capped: true, size: 1e6 }).catch(e => {
+        if (e.code !== 48) throw e;   // another instance created it first
+      });
+    }
+    io.adapter(createAdapter(db.collection(adapterCol)));
+  }
 
-  // Create indexes for common queries
-  await eventsCol.createIndex({ timestamp: -1 });
-  await eventsCol.createIndex({ status: 1 });
+  // Events from before the Date field: derive it from the ISO string once
+  const backfilled = await eventsCol.updateMany(
+    { time: { $exists: false }, timestamp: { $type: 'string' } },
+    [{ $set: { time: { $toDate: '$timestamp' } } }]
+  );
+  if (backfilled.modifiedCount) console.log(`Backfilled time on ${backfilled.modifiedCount} events`);
+  // Indexes for the hot queries (lib/queries.js; npm run explain checks them)
+  await queries.ensureEventIndexes(eventsCol);
   await reinitCol.createIndex({ deviceId: 1, status: 1 });
+  await traceCol.createIndex({ id: 1, t0: 1 });
+  await traceCol.createIndex({ t0: 1 }, { expireAfterSeconds: 7 * 86400 });   // keep a week
+  await stormCol.createIndex({ id: 1, t0: 1 });
+  await stormCol.createIndex({ t0: 1 }, { expireAfterSeconds: 7 * 86400 });
+  await bootCol.createIndex({ id: 1, time: 1 });
+  await bootCol.createIndex({ time: 1 }, { expireAfterSeconds: 90 * 86400 });
+  await blackboxCol.createIndex({ id: 1, from_ms: -1 });
+  await blackboxCol.createIndex({ received: 1 }, { expireAfterSeconds: 90 * 86400 });
+  // The Admin boot chart picks up where the last run left it
+  for (const id of DEVICE_IDS) {
+    const docs = await bootCol.find({ id }, { projection: { _id: 0, id: 0, alias: 0 } })
+      .sort({ time: -1 }).limit(BOOT_HISTORY).toArray();
+    if (docs.length) lastBoots[id] = docs.reverse().map(d => ({ ...d, time: d.time.toISOString() }));
+  }
+
+  // Device uploads go through the write-behind queue; replay what the last run left
+  ingest = new IngestQueue(eventsCol, waveformsCol, INGEST_JOURNAL);
+  if (ANALYSIS_WORKERS > 0) {
+    analysis = new WorkerPool(path.join(__dirname, 'lib', 'analysis-worker.js'), ANALYSIS_WORKERS);
+  }
+  if (analysis && STACK_DETECT) {
+    stackCol = db.collection('stack_detections');
+    await stackCol.createIndex({ start: -1 });
+    stacker = new Stacker({
+      run: (job) => analysis.run('stack', job),
+      source: (from, to) => Object.entries(streams)
+        .map(([id, buffer]) => ({ id, segments: buffer.segments(from, to) }))
+        .filter(t => t.segments.length),
+      onDetection: (d) => onStackDetection(d).catch(e => console.error('Stack detection error:', e.message)),
+    }).start(e => console.error('Stacking error:', e.message));
+  }
+  ingest.onFlushed = (batch) => {
+    for (const { stored, duplicate } of batch) if (!duplicate) recent.add(stored);
+    recordCommits(batch);
+    analyzeFlushed(batch);
+  };
+  await ingest.open();
+  recent.fill(eventsCol)
+    .then(n => console.log(`[RECENT] ${n} events from the last ${recent.windowMs / 3600000}h in memory`))
+    .catch(e => console.error('Recent events fill error:', e.message));
+  migrateEmbeddedWaveforms().catch(e => console.error('Waveform migration error:', e.message));
+  schema.migrate(eventsCol)
+    .then(n => {
+      schemaLegacy = false;
+      if (n) console.log(`[SCHEMA] Compacted ${n} events (lv codes, no timestamp / alias strings)`);
+    })
+    .catch(e => console.error('Event schema migration error:', e.message));
+  rollups.start(eventsCol, rollupsCol, e => console.error('Rollup refresh error:', e.message))
+    .then(state => { rollupState = state; })
+    .catch(e => console.error('Rollup start error:', e.message));
+  retention = new Retention(eventsCol, waveformsCol,
+    { envelopeDays: RETENTION_ENVELOPE_DAYS, archiveDays: RETENTION_ARCHIVE_DAYS });
+  retention.start(e => console.error('Waveform retention error:', e.message))
+    .catch(e => console.error('Waveform retention start error:', e.message));
+  if (STREAM_STORE_DAYS > 0) {
+    streamStore = new StreamStore(db.collection('stream_chunks'),
+      { days: STREAM_STORE_DAYS, onError: e => console.error('Stream store error:', e.message) });
+    await streamStore.start();
+  }
 
   // Seed default config if none exists
   const existing = await configCol.findOne({ _id: 'global' });
+  Object.assign(configGens, existing?.config_gen || {});
   if (!existing) {
     const seed = { _id: 'global', ...DEFAULT_CONFIG, devices: {} };
     for (const id of DEVICE_IDS) {
-      seed.devices[id] = { alias: translationDict[id], heartbeat_interval: null, sensitivity: null };
+      seed.devices[id] = { alias: translationDict[id], heartbeat_interval: null, sensitivity: null, sample_rate_hz: null };
     }
     await configCol.insertOne(seed);
     console.log('Seeded default config');
   }
+  savedConfig = await configCol.findOne({ _id: 'global' });
+  registry = await new DeviceRegistry(db.collection('devices'), db.collection('device_groups')).load(translationDict);
+  syncRegistry();
+  for (const flag of await reinitCol.find({ status: { $in: ['pending', 'sent'] } }).sort({ requested_at: 1 }).toArray()) {
+    flagsOf(flag.deviceId)[flag.status] = flag;
+  }
+  if (SHARED_STATE) {
+    await startShared(db);
+    console.log(`Shared state on as ${INSTANCE_ID}${SERVER_ROLE === 'all' ? '' : ` (${SERVER_ROLE})`}`);
+  }
+  if (SERVER_ROLE === 'dashboard') startEventFeed();
+  const targets = parseTargets(NOTIFY_URLS);
+  if (targets.length) {
+    notifier = await new Notifier(db.collection('notifications'), targets, {
+      concurrency: NOTIFY_CONCURRENCY,
+      onDelivered: (target, seconds) => metricNotifyDelivery.observe({ target }, seconds),
+      onAttempt: (target, outcome) => metricNotifyAttempts.inc({ target, outcome }),
+      onError: (e) => console.error('Notify error:', e.message),
+    }).start();
+    console.log(`[NOTIFY] ${targets.length} webhook target(s): ${targets.map(t => t.name).join(', ')}`);
+  }
 
+  const scheme = TLS_CERT && TLS_KEY ? 'https' : 'http';
   server.listen(PORT, '0.0.0.0', () => {
-    console.log(`Seismometer API listening on http://0.0.0.0:${PORT}`);
+    console.log(`Seismometer API listening on ${scheme}://0.0.0.0:${PORT}`);
+  });
+  if (DEVICE_PORT) {
+    const deviceServer = TLS_CERT && TLS_KEY ? createTlsServer(gateway.handle, TLS_CERT, TLS_KEY)
+                                             : http.createServer(gateway.handle);
+    deviceServer.keepAliveTimeout = server.keepAliveTimeout;
+    deviceServer.headersTimeout = server.headersTimeout;
+    deviceServer.listen(DEVICE_PORT, '0.0.0.0', () => {
+      console.log(`Device gateway listening on ${scheme}://0.0.0.0:${DEVICE_PORT}`);
+    });
+  }
+  if (SESSION_PORT) startSessions();
+  if (MQTT_URL) {
+    const share = (filter) => (SHARED_STATE ? `$share/seismo-server/${filter}` : filter);
+    mqtt = new MqttClient(MQTT_URL, {
+      clientId: `seismo-server-${INSTANCE_ID}`,
+      subscriptions: {
+        [share('seismo/+/heartbeat')]: 1,
+        [share('seismo/+/trigger')]: 1,
+        [share('seismo/+/event')]: 1,
+        'seismo/+/status': 1,   // every replica keeps liveness
+      },
+      onMessage: (msg, ack) => onMqttMessage(msg, ack).catch(e => console.error('MQTT message error:', e.message)),
+      onConnect: () => {
+        console.log(`MQTT ingestion from ${mqtt.url}`);
+        // Whatever was saved while we were away; a device skips a generation it has
+        for (const id of Object.keys(translationDict)) publishConfig(id);
+      },
+    }).start();
+  }
+  setInterval(syncRollout, 60 * 1000);
+  if (tuner) {
+    seedTuner().catch(e => console.error('Tuning seed error:', e.message));
+    setInterval(() => tuneThresholds().catch(e => console.error('Tuning error:', e.message)), TUNING_INTERVAL_MS);
+  }
+
+  // Continuous streams from devices with stream_mode 'udp', and every
+  // device's trigger notices
+  if (SEEDLINK_PORT) {
+    seedlink = new SeedLinkServer({ port: SEEDLINK_PORT, network: MSEED_NETWORK, organization: 'ESP8266 MPU6050 Seismometer',
+                                    describe: (id) => translationDict[id] || id }).start();
+  }
+  const udp = dgram.createSocket('udp4');
+  udp.on('message', (msg) => {
+    const notice = decodeNotice(msg);
+    if (notice) return onTriggerNotice(notice);
+    const pkt = decodeDatagram(msg);
+    if (!pkt) return;
+    // Before SNTP, the clock fit places it better than its arrival
+    if (!pkt.synced) pkt.t0_ms = clockFits[pkt.id]?.map(null, pkt.millis) ?? pkt.t0_ms;
+    if (!translationDict[pkt.id]) translationDict[pkt.id] = pkt.id;
+    (streams[pkt.id] ??= new StreamBuffer()).add(pkt);
+    seedlink?.add(pkt.id, pkt);
+    streamStore?.add(pkt.id, pkt);
+    statusFeed.touch(pkt.id);   // its stream counters, in the next devices:status
+  });
+  udp.on('error', (err) => console.error('Stream socket error:', err.message));
+  udp.bind(STREAM_PORT, '0.0.0.0', () => {
+    console.log(`Stream listener on udp://0.0.0.0:${STREAM_PORT}`);
   });
 }
 
@@ -3,8 +3,10 @@
 
 import os
 import json
+import struct
+import bisect
 import threading
-from datetime import datetime
+from datetime import datetime, timezone
 from flask import Flask, request, jsonify
 from flask_cors import CORS
 import traceback
@@ -19,7 +21,8 @@ LOG_FILE = os.getenv(
     "LOG_FILE",
     os.path.join(os.path.dirname(__file__), "events.txt")
 )
-MAX_LOG_BYTES = int(os.getenv("MAX_LOG_BYTES", 20 * 1024 * 1024))  # 20 MB
+MAX_LOG_BYTES = int(os.getenv("MAX_LOG_BYTES", 20 * 1024 * 1024))  # 20 MB, then rotate
+LOG_KEEP = int(os.getenv("LOG_KEEP", 5))  # rotated files kept (events.txt.1 .. .N)
 
 translation_dict = {
     "48:55:19:ED:D8:9A": "Ryan Office",
@@ -27,6 +30,13 @@ translation_dict = {
     "C8:2B:96:23:21:BC": "Kitchen",
 }
 
+# Optional device list ({"MAC": "alias", ...}) replacing the built-in one;
+# the Node server keeps its devices in a MongoDB registry instead
+DEVICES_FILE = os.getenv("DEVICES_FILE")
+if DEVICES_FILE and os.path.exists(DEVICES_FILE):
+    with open(DEVICES_FILE, encoding="utf-8") as f:
+        translation_dict = json.load(f)
+
 # Derive the list of devices to monitor
 DEVICE_IDS = list(translation_dict.keys())
 
@@ -40,11 +50,165 @@ window_devices = set()
 # Record server start time
 start_time = datetime.utcnow()
 
-# Ensure log directory and file exist
+# Ensure log directory exists
 log_dir = os.path.dirname(LOG_FILE)
 if log_dir and not os.path.exists(log_dir):
     os.makedirs(log_dir, exist_ok=True)
-open(LOG_FILE, "a", encoding="utf-8").close()
+
+
+# -- Event log ----------------------------------------------------------------
+# events.txt stays one JSON object per line in time order. Next to each log
+# file an append-only index (<log>.idx) holds one record per INDEX_EVERY
+# lines: <int64 epoch ms of the line's timestamp, int64 byte offset>. A
+# window read bisects it and seeks to the block before `since` instead of
+# parsing the whole file. At MAX_LOG_BYTES the file and its index rotate to
+# <log>.1 (older ones shift up, LOG_KEEP kept) and a new file starts, so
+# events are no longer dropped once the size is reached. A missing or short
+# index is rebuilt from its log at startup.
+INDEX_EVERY = 256
+INDEX_RECORD = struct.Struct("<qq")
+
+
+def timestamp_ms(ts):
+    """Epoch ms of an ISO timestamp as written here ('...Z', UTC)."""
+    dt = datetime.fromisoformat(ts.rstrip("Z"))
+    if dt.tzinfo is None:
+        dt = dt.replace(tzinfo=timezone.utc)
+    return int(dt.timestamp() * 1000)
+
+
+class EventLog:
+    def __init__(self, path, max_bytes, keep):
+        self.path = path
+        self.max_bytes = max_bytes
+        self.keep = keep
+        self.lock = threading.Lock()
+        self.index = {}  # log path -> [(ms, offset)], for the bisect
+        open(path, "ab").close()
+        for log in self.logs():  # the live log last: its tail is what since_record counts
+            self.index[log], self.since_record = self.load_index(log)
+        self.size = os.path.getsize(path)
+
+    def logs(self):
+        """Log files oldest first: <log>.N .. <log>.1, then the live one."""
+        rotated = [f"{self.path}.{n}" for n in range(self.keep, 0, -1)]
+        return [p for p in rotated if os.path.exists(p)] + [self.path]
+
+    def load_index(self, log):
+        """-> (records, lines after the last one); records the index is
+        missing (a crash between the two writes, no index yet) are added."""
+        idx = log + ".idx"
+        data = b""
+        if os.path.exists(idx):
+            with open(idx, "rb") as f:
+                data = f.read()
+        records = list(INDEX_RECORD.iter_unpack(data[:len(data) - len(data) % INDEX_RECORD.size]))
+        size = os.path.getsize(log)
+        records = [r for r in records if r[1] < size]
+        kept = len(records)
+        start = records[-1][1] if records else 0
+        tail = 0
+        with open(log, "rb") as f:
+            f.seek(start)
+            offset = start
+            for n, raw in enumerate(f):
+                if n % INDEX_EVERY == 0 and (n or not records):
+                    entry = self.parse(raw)
+                    if entry:
+                        records.append((timestamp_ms(entry["timestamp"]), offset))
+                        tail = 0
+                tail += 1
+                offset += len(raw)
+        if len(records) != kept or kept * INDEX_RECORD.size != len(data):
+            with open(idx, "wb") as f:
+                f.write(b"".join(INDEX_RECORD.pack(*r) for r in records))
+        return records, tail
+
+    @staticmethod
+    def parse(raw):
+        """The line's entry, or None for a torn or foreign line."""
+        try:
+            entry = json.loads(raw)
+            timestamp_ms(entry["timestamp"])
+            return entry
+        except (ValueError, KeyError, TypeError, AttributeError):
+            return None
+
+    def rotate(self):
+        for n in range(self.keep, 0, -1):
+            for suffix in ("", ".idx"):
+                src = f"{self.path}.{n}{suffix}"
+                if not os.path.exists(src):
+                    continue
+                if n == self.keep:
+                    os.remove(src)
+                else:
+                    os.replace(src, f"{self.path}.{n + 1}{suffix}")
+        for suffix in ("", ".idx"):
+            if not os.path.exists(self.path + suffix):
+                continue
+            if self.keep:
+                os.replace(self.path + suffix, f"{self.path}.1{suffix}")
+            else:
+                os.remove(self.path + suffix)
+        open(self.path, "wb").close()
+        self.index = {log: self.load_index(log)[0] for log in self.logs()}
+        self.size = 0
+        self.since_record = 0
+
+    def append(self, entry):
+        raw = (json.dumps(entry) + "\n").encode("utf-8")
+        with self.lock:
+            if self.size and self.size + len(raw) > self.max_bytes:
+                self.rotate()
+            if not self.index[self.path] or self.since_record >= INDEX_EVERY:
+                record = (timestamp_ms(entry["timestamp"]), self.size)
+                with open(self.path + ".idx", "ab") as f:
+                    f.write(INDEX_RECORD.pack(*record))
+                self.index[self.path].append(record)
+                self.since_record = 0
+            with open(self.path, "ab") as f:
+                f.write(raw)
+            self.size += len(raw)
+            self.since_record += 1
+
+    def read(self, since_ms=None, until_ms=None):
+        """Events with since_ms <= timestamp <= until_ms (either open), oldest first."""
+        with self.lock:
+            logs = self.logs()
+            index = {log: list(self.index.get(log, [])) for log in logs}
+            size = self.size
+        events = []
+        for i, log in enumerate(logs):
+            later = index[logs[i + 1]] if i + 1 < len(logs) else None
+            # Every line of a file is older than the next file's first one
+            if since_ms is not None and later and later[0][0] < since_ms:
+                continue
+            records = index[log]
+            start = 0
+            if since_ms is not None and records:
+                k = bisect.bisect_left([r[0] for r in records], since_ms) - 1
+                start = records[k][1] if k >= 0 else 0
+            with open(log, "rb") as f:
+                f.seek(start)
+                offset = start
+                for raw in f:
+                    offset += len(raw)
+                    if log == self.path and offset > size:
+                        break  # appended after the snapshot above
+                    entry = self.parse(raw)
+                    if not entry:
+                        continue
+                    ms = timestamp_ms(entry["timestamp"])
+                    if since_ms is not None and ms < since_ms:
+                        continue
+                    if until_ms is not None and ms > until_ms:
+                        return events
+                    events.append(entry)
+        return events
+
+
+event_log = EventLog(LOG_FILE, MAX_LOG_BYTES, LOG_KEEP)
 
 app = Flask(__name__)
 CORS(app)
@@ -78,8 +242,7 @@ def on_window_end():
             "devices": DEVICE_IDS,
             "aliases": [translation_dict[d] for d in DEVICE_IDS]
         }
-        with open(LOG_FILE, "a", encoding="utf-8") as f:
-            f.write(json.dumps(confirm_entry) + "\n")
+        event_log.append(confirm_entry)
 
     # Reset for the next window
     window_devices.clear()
@@ -121,13 +284,8 @@ def log_seismic():
         line = json.dumps(log_entry) + "\n"
         print(line.strip())
 
-        # Rotate by size
-        if os.path.getsize(LOG_FILE) >= MAX_LOG_BYTES:
-            return jsonify({"status": "skipped", "reason": "max size reached"}), 200
-
-        # Append raw event to log
-        with open(LOG_FILE, "a", encoding="utf-8") as f:
-            f.write(line)
+        # Append raw event to log (rotates by size)
+        event_log.append(log_entry)
 
         # Update last-seen timestamp (for any other use)
         last_event_times[device_id] = now_dt
@@ -206,15 +364,14 @@ def api_http_logs():
 
 @app.route("/api/events", methods=["GET"])
 def api_events():
-    """Return all logged events from the log file."""
-    events = []
-    with open(LOG_FILE, "r", encoding="utf-8") as f:
-        for line in f:
-            try:
-                events.append(json.loads(line))
-            except:
-                continue
-    return jsonify(events), 200
+    """Return logged events, oldest first; ?since= / ?until= (ISO) read only
+    that window through the index, across rotated files too."""
+    try:
+        since = timestamp_ms(request.args["since"]) if request.args.get("since") else None
+        until = timestamp_ms(request.args["until"]) if request.args.get("until") else None
+    except ValueError:
+        return jsonify({"error": "since / until must be ISO timestamps"}), 400
+    return jsonify(event_log.read(since, until)), 200
 
 # Helper to determine local LAN IP
 def get_local_ip():
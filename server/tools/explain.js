@@ -0,0 +1,92 @@
+#!/usr/bin/env node
+// ── Query plan check ─────────────────────────────────────────────
+// Runs explain() on every hot events query (lib/queries.js hotQueries())
+// against a live database and fails unless each plan is covered by an
+// index: no COLLSCAN, and no blocking SORT stage in front of the newest
+// first pages. Indexes are created first, as server.js does at startup, so
+// an empty database gives the same plans a full one would.
+//
+//   npm run explain                      # MONGO_URI as for server.js
+//   node tools/explain.js --mongo mongodb://db:27017/seismic --stats
+//
+// --stats explains with executionStats and also prints keys and documents
+// examined against documents returned. --json prints one object. Exit
+// status 1 when any query isn't covered.
+
+const { MongoClient } = require('mongodb');
+const queries = require('../lib/queries');
+
+function parseArgs(argv) {
+  const opts = { mongo: process.env.MONGO_URI || 'mongodb://localhost:27017/seismic', stats: false, json: false };
+  for (let i = 0; i < argv.length; i++) {
+    const a = argv[i];
+    if (a === '--mongo') opts.mongo = argv[++i];
+    else if (a === '--stats') opts.stats = true;
+    else if (a === '--json') opts.json = true;
+    else throw new Error(`unknown argument ${a}`);
+  }
+  return opts;
+}
+
+// Every stage of a plan tree, depth first
+function stages(plan, out = []) {
+  if (!plan) return out;
+  out.push(plan);
+  if (plan.inputStage) stages(plan.inputStage, out);
+  for (const s of plan.inputStages || []) stages(s, out);
+  if (plan.queryPlan) stages(plan.queryPlan, out);   // SBE plans
+  return out;
+}
+
+// explain() output → { indexes, problems }
+function review(explained) {
+  const planner = explained.queryPlanner;
+  const all = stages(planner.winningPlan);
+  const indexes = [...new Set(all.filter(s => s.indexName).map(s => s.indexName))];
+  const problems = [];
+  if (all.some(s => s.stage === 'COLLSCAN')) problems.push('collection scan');
+  if (all.some(s => s.stage === 'SORT')) problems.push('blocking sort');
+  if (!indexes.length) problems.push('no index');
+  return { indexes, problems };
+}
+
+async function main() {
+  const opts = parseArgs(process.argv.slice(2));
+  const client = new MongoClient(opts.mongo);
+  await client.connect();
+  const eventsCol = client.db().collection('events');
+  await queries.ensureEventIndexes(eventsCol);
+  const results = [];
+  try {
+    for (const q of queries.hotQueries()) {
+      let cursor = eventsCol.find(q.filter).sort(q.sort);
+      if (q.hint) cursor = cursor.hint(q.hint);
+      if (q.limit) cursor = cursor.limit(q.limit);
+      const explained = await cursor.explain(opts.stats ? 'executionStats' : 'queryPlanner');
+      const result = { name: q.name, ...review(explained) };
+      const ex = explained.executionStats;
+      if (ex) Object.assign(result, { returned: ex.nReturned, keys: ex.totalKeysExamined, docs: ex.totalDocsExamined });
+      results.push(result);
+    }
+  } finally {
+    await client.close();
+  }
+
+  const failed = results.filter(r => r.problems.length);
+  if (opts.json) {
+    console.log(JSON.stringify({ ok: !failed.length, queries: results }, null, 2));
+  } else {
+    for (const r of results) {
+      const stats = r.returned != null ? `  ${r.returned} returned, ${r.keys} keys, ${r.docs} docs examined` : '';
+      console.log(`${r.problems.length ? 'FAIL' : 'ok  '}  ${r.name.padEnd(36)} ${r.indexes.join(', ') || '-'}` +
+        (r.problems.length ? `  (${r.problems.join(', ')})` : '') + stats);
+    }
+    console.log(failed.length ? `${failed.length} of ${results.length} queries not covered` : `all ${results.length} queries covered`);
+  }
+  process.exit(failed.length ? 1 : 0);
+}
+
+main().catch((e) => {
+  console.error(e.message);
+  process.exit(2);
+});
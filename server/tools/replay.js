@@ -0,0 +1,122 @@
+#!/usr/bin/env node
+// ── Trigger replay ───────────────────────────────────────────────
+// Replays stored captures through the firmware trigger and the consensus
+// engine under candidate settings (lib/replay.js) and prints, for each,
+// detections, false positives and consensus recall against the CONFIRMED
+// entries actually stored. The current saved config always runs first as
+// the baseline. Events and their waveforms come from one aggregation
+// cursor in time order, so a span of months streams through in a single
+// pass with one capture in memory at a time.
+//
+//   node tools/replay.js --from 2026-01-01 --to 2026-04-01 \
+//     --candidate '{"name":"minor 0.05","sensitivity":{"minor":0.05}}' \
+//     --candidate '{"name":"sta/lta","trigger_mode":"both","sta_lta_on":5}'
+//
+// A candidate is a PUT /api/config body limited to the trigger and
+// consensus keys (sensitivity, trigger_mode, sta_ms, lta_ms, sta_lta_on,
+// sta_lta_off, hp_hz, lp_hz, consensus_window_ms, consensus_quorum), plus
+// "groups": { name: { quorum, window_ms } }; @file.json reads one from a
+// file. MONGO_URI as for server.js, or --mongo. --json prints one object.
+
+const fs = require('fs');
+const { MongoClient } = require('mongodb');
+const { Replay, candidateParams } = require('../lib/replay');
+const { DeviceRegistry, DEFAULT_GROUP } = require('../lib/registry');
+const { sampleRate } = require('../lib/analysis');
+const waveform = require('../lib/waveform');
+
+const PROGRESS_EVERY = 10000;
+
+function parseArgs(argv) {
+  const opts = { mongo: process.env.MONGO_URI || 'mongodb://localhost:27017/seismic', from: null, to: null,
+                 candidates: [], json: false };
+  for (let i = 0; i < argv.length; i++) {
+    const a = argv[i];
+    if (a === '--json') opts.json = true;
+    else if (a === '--mongo') opts.mongo = argv[++i];
+    else if (a === '--from') opts.from = new Date(argv[++i]);
+    else if (a === '--to') opts.to = new Date(argv[++i]);
+    else if (a === '--candidate') {
+      const v = argv[++i];
+      opts.candidates.push(JSON.parse(v.startsWith('@') ? fs.readFileSync(v.slice(1), 'utf8') : v));
+    } else throw new Error(`unknown option ${a}`);
+  }
+  for (const k of ['from', 'to']) if (opts[k] && isNaN(opts[k])) throw new Error(`--${k} is not a date`);
+  return opts;
+}
+
+// Registry from the devices collection; without one, every device that
+// has events is a member of the default group
+async function loadRegistry(db, range) {
+  const registry = await new DeviceRegistry(db.collection('devices'), db.collection('device_groups')).reload();
+  if (registry.ids().length) return registry;
+  const ids = await db.collection('events').distinct('id', { time: range });
+  return {
+    groupOf: () => DEFAULT_GROUP,
+    members: (name) => (name === DEFAULT_GROUP ? ids : []),
+    group: () => null,
+  };
+}
+
+function printReport(report, seconds) {
+  console.log(`\n${report.captures} captures replayed (${report.skipped} without a waveform) in ${seconds.toFixed(1)}s, ` +
+    `${report.stored_confirmed} stored consensus entries`);
+  const cols = ['detections', 'suppressed', 'false pos', 'clusters', 'matched', 'missed', 'new', 'recall', 'precision'];
+  console.log(`${'candidate'.padEnd(24)}${cols.map(c => c.padStart(11)).join('')}`);
+  for (const c of report.candidates) {
+    const row = [c.detections, c.suppressed, c.false_positives, c.consensus.clusters, c.consensus.matched,
+                 c.consensus.missed, c.consensus.new, c.consensus.recall ?? '-', c.consensus.precision ?? '-'];
+    console.log(`${c.name.slice(0, 23).padEnd(24)}${row.map(v => String(v).padStart(11)).join('')}`);
+  }
+}
+
+async function main() {
+  const opts = parseArgs(process.argv.slice(2));
+  const client = await MongoClient.connect(opts.mongo);
+  try {
+    const db = client.db();
+    const range = {
+      ...(opts.from ? { $gte: opts.from } : { $gte: new Date(0) }),
+      ...(opts.to ? { $lt: opts.to } : {}),
+    };
+    const saved = await db.collection('config').findOne({ _id: 'global' });
+    const candidates = [{ name: 'current', params: candidateParams(saved) },
+      ...opts.candidates.map(({ name, ...overrides }, i) => ({ name: name || `candidate ${i + 1}`, params: candidateParams(saved, overrides) }))];
+    const replay = new Replay(await loadRegistry(db, range), candidates);
+
+    // Device events (no status) and stored consensus entries, oldest first,
+    // each event with its waveform; older events still embed theirs
+    const cursor = db.collection('events').aggregate([
+      { $match: { time: range, $or: [{ status: { $exists: false } }, { status: 'CONFIRMED' }] } },
+      { $sort: { time: 1, _id: 1 } },
+      { $project: { id: 1, time: 1, status: 1, group: 1, waveform: 1, has_waveform: 1 } },
+      { $lookup: { from: 'waveforms', localField: '_id', foreignField: '_id', as: 'stored' } },
+    ], { batchSize: 500 });
+
+    const started = Date.now();
+    let n = 0;
+    for await (const doc of cursor) {
+      if (doc.status === 'CONFIRMED') replay.stored(doc);
+      else {
+        // An envelope (lib/retention.js) has lost the spacing the triggers need
+        const stored = doc.stored[0]?.tier === 'envelope' ? null : doc.stored[0];
+        const wave = stored ? waveform.unpackWaveform(stored) : doc.waveform;
+        replay.capture(doc, Array.isArray(wave) ? wave : null, wave?.length ? sampleRate(wave.map(s => s[0])) : null);
+      }
+      if (++n % PROGRESS_EVERY === 0 && !opts.json) {
+        process.stderr.write(`\r${n} documents, ${doc.time.toISOString()}`);
+      }
+    }
+    if (n >= PROGRESS_EVERY && !opts.json) process.stderr.write('\n');
+    const report = replay.report();
+    if (opts.json) console.log(JSON.stringify(report));
+    else printReport(report, (Date.now() - started) / 1000);
+  } finally {
+    await client.close();
+  }
+}
+
+main().catch((e) => {
+  console.error(`replay: ${e.message}`);
+  process.exitCode = 1;
+});
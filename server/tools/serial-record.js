@@ -0,0 +1,138 @@
+#!/usr/bin/env node
+// ── Serial capture recorder ──────────────────────────────────────
+// Records a SERIAL_CAPTURE build's binary sample blocks (lib/serialcapture.js,
+// src/serial_capture.h) off its serial port into stream chunks, the format
+// the UDP streams are kept in (lib/streamstore.js), so the dashboard's stream
+// view and the tools that read stream_chunks see a bench run like a stream.
+// Every sample at the sensor rate, x, y and z; lost blocks split the runs.
+// The firmware's log lines go to stderr as they arrive.
+//
+//   node tools/serial-record.js --device /dev/ttyUSB0
+//   node tools/serial-record.js --device /dev/ttyUSB0 --out run.ndjson
+//   cat capture.bin | node tools/serial-record.js --out run.ndjson
+//
+// --device is put in raw mode at --baud (921600) with stty, unless
+// --no-stty; without it the bytes come from stdin. Chunks go to the
+// stream_chunks collection (MONGO_URI as for server.js, or --mongo), or
+// with --out to a file, one JSON document a line with cols in base64.
+// --id stores under that id rather than the MAC in the blocks. Stops at
+// the end of the input or on Ctrl-C; --json prints the totals as one object.
+
+const fs = require('fs');
+const { execFileSync } = require('child_process');
+const { SerialReader } = require('../lib/serialcapture');
+const { StreamStore } = require('../lib/streamstore');
+
+const FLUSH_MS = 5000;
+const STATUS_MS = 10000;
+
+function parseArgs(argv) {
+  const opts = { mongo: process.env.MONGO_URI || 'mongodb://localhost:27017/seismic', device: null,
+                 baud: 921600, stty: true, out: null, id: null, json: false };
+  for (let i = 0; i < argv.length; i++) {
+    const a = argv[i];
+    if (a === '--json') opts.json = true;
+    else if (a === '--mongo') opts.mongo = argv[++i];
+    else if (a === '--device') opts.device = argv[++i];
+    else if (a === '--baud') opts.baud = parseInt(argv[++i], 10);
+    else if (a === '--no-stty') opts.stty = false;
+    else if (a === '--out') opts.out = argv[++i];
+    else if (a === '--id') opts.id = argv[++i];
+    else throw new Error(`unknown option ${a}`);
+  }
+  if (!(opts.baud > 0)) throw new Error('--baud is not a number');
+  return opts;
+}
+
+// insertMany() appending to an NDJSON file, for a StreamStore without a database
+function fileCollection(path) {
+  const out = fs.createWriteStream(path, { flags: 'a' });
+  return {
+    async insertMany(docs) {
+      const text = docs.map(d => JSON.stringify({ ...d, cols: d.cols.toString('base64') }) + '\n').join('');
+      await new Promise((resolve, reject) => out.write(text, e => (e ? reject(e) : resolve())));
+    },
+    close: () => new Promise(resolve => out.end(resolve)),
+  };
+}
+
+function openInput(opts) {
+  if (!opts.device) return process.stdin;
+  if (opts.stty) {
+    // -F on Linux, -f on macOS and the BSDs
+    const flag = process.platform === 'linux' ? '-F' : '-f';
+    execFileSync('stty', [flag, opts.device, String(opts.baud), 'raw', '-echo', '-hupcl'], { stdio: 'inherit' });
+  }
+  return fs.createReadStream(opts.device, { highWaterMark: 4096 });
+}
+
+function summary(reader, store) {
+  const s = reader.stats;
+  const m = store.metrics();
+  return { blocks: s.blocks, samples: s.samples, lost_blocks: s.lost, restarts: s.restarts, bad_frames: s.bad,
+           log_lines: s.lines, chunks: m.chunks, raw_bytes: m.raw_bytes, stored_bytes: m.stored_bytes,
+           write_errors: m.errors };
+}
+
+async function main() {
+  const opts = parseArgs(process.argv.slice(2));
+  let client = null;
+  let col;
+  if (opts.out) {
+    col = fileCollection(opts.out);
+  } else {
+    const { MongoClient } = require('mongodb');
+    client = new MongoClient(opts.mongo);
+    await client.connect();
+    col = client.db().collection('stream_chunks');
+  }
+  // Driven from here rather than start(): the server owns the indexes and compaction
+  const store = new StreamStore(col, { onError: e => console.error(`serial-record: ${e.message}`) });
+  const reader = new SerialReader({
+    onBlock: pkt => store.add(opts.id || pkt.id, pkt),
+    onText: line => { if (!opts.json) process.stderr.write(`| ${line}\n`); },
+  });
+  const flushTimer = setInterval(() => {
+    store.closeIdle(Date.now());
+    store.flush().catch(() => {});
+  }, FLUSH_MS);
+  const statusTimer = setInterval(() => {
+    if (opts.json || !reader.stats.blocks) return;
+    const s = reader.stats;
+    process.stderr.write(`recording: ${s.samples} samples in ${s.blocks} blocks, ${s.lost} lost, ` +
+                         `${store.metrics().chunks} chunks\n`);
+  }, STATUS_MS);
+
+  const input = openInput(opts);
+  await new Promise((resolve, reject) => {
+    input.on('data', chunk => reader.feed(chunk));
+    input.on('end', resolve);
+    input.on('error', reject);
+    process.once('SIGINT', () => {
+      input.destroy();
+      resolve();
+    });
+  });
+
+  clearInterval(flushTimer);
+  clearInterval(statusTimer);
+  // stop() closes the open chunks; a flush already in flight leaves them queued.
+  // A failed write is counted in write_errors
+  await store.stop().catch(() => {});
+  for (let tries = 0; (store.flushing || store.queue.length) && tries < 3; tries++) await store.flush().catch(() => {});
+  if (opts.out) await col.close();
+  if (client) await client.close();
+  const totals = summary(reader, store);
+  if (opts.json) console.log(JSON.stringify(totals));
+  else {
+    console.log(`${totals.samples} samples in ${totals.blocks} blocks (${totals.lost_blocks} lost, ` +
+                `${totals.bad_frames} corrupt, ${totals.restarts} restarts) -> ${totals.chunks} chunks, ` +
+                `${totals.raw_bytes} bytes as ${totals.stored_bytes}`);
+  }
+  if (totals.write_errors) process.exitCode = 1;
+}
+
+main().catch((e) => {
+  console.error(`serial-record: ${e.message}`);
+  process.exitCode = 1;
+});
@@ -1,11 +1,69 @@
 ﻿#include <ESP8266WiFi.h>
 #include <ESP8266HTTPClient.h>
-#include <ESP8266httpUpdate.h>
 #include <Wire.h>
+#include <assert.h>
 #include "I2Cdev.h"
 #include "MPU6050.h"
 #include "arduino_secrets.h"     // must define SECRET_SSID, SECRET_PASS, URL, ROOT_URL
 #include <ArduinoJson.h>
+#include "capture_arena.h"
+#include "waveform_stream.h"
+#include "server_tls.h"
+#include "server_link.h"
+#include "async_upload.h"
+#include "event_journal.h"
+#include "calibration_store.h"
+#include "init_store.h"
+#include "detector.h"
+#include "bias_estimator.h"
+#include "bias_tracker.h"
+#include "thermal_bias.h"
+#include "helicorder.h"
+#include "loop_profile.h"
+#include "heap_monitor.h"
+#include "sntp_clock.h"
+#include "wifi_link.h"
+#include "push_channel.h"
+#include "mqtt_link.h"
+#include "session_link.h"
+#include "udp_stream.h"
+#include "trigger_notice.h"
+#include "peer_link.h"
+#include "storm_filter.h"
+#include "spectrum.h"
+#include "ota_update.h"
+#include "boot_timing.h"
+#include "black_box.h"
+#include "local_http.h"
+#include "task_scheduler.h"
+#include "waveform_inject.h"
+#include "dmp_gravity.h"
+#include "dual_sensor.h"
+#include "realtime.h"
+#include "isr_jitter.h"
+#include "cpu_boost.h"
+#include "modem_sleep.h"
+#include "serial_capture.h"
+#include "ready_ring.h"
+
+// HTTPS to the server (-DSERVER_TLS=1, see src/server_tls.h): URL and
+// ROOT_URL start with https:// and arduino_secrets.h pins the certificate
+#if SERVER_TLS && !defined(SECRET_SERVER_FINGERPRINT)
+    #error "SERVER_TLS needs SECRET_SERVER_FINGERPRINT in arduino_secrets.h"
+#endif
+#ifndef SECRET_SERVER_FINGERPRINT
+    #define SECRET_SERVER_FINGERPRINT ""
+#endif
+// MQTT to a broker (-DMQTT_LINK=1, see src/mqtt_link.h) is plain TCP, with
+// nothing pinned; a TLS build keeps to HTTPS
+#if MQTT_LINK && SERVER_TLS
+    #error "MQTT_LINK runs over plain TCP; build it without SERVER_TLS"
+#endif
+// So is a device session (-DSESSION_LINK=1, see src/session_link.h), which
+// takes the place MQTT_LINK would; build one or the other
+#if SESSION_LINK && (SERVER_TLS || MQTT_LINK)
+    #error "SESSION_LINK runs over plain TCP in place of MQTT_LINK; build it without SERVER_TLS or MQTT_LINK"
+#endif
 
 // OTA firmware version - bump this string whenever new firmware is deployed
 #define FIRMWARE_VERSION "1.2.0"
@@ -14,350 +72,2598 @@
 #define SDA_PIN D2  // GPIO4
 #define SCL_PIN D1  // GPIO5
 
+// I2C bus clock (override with -DI2C_CLOCK_HZ=... in build_flags). Fast mode
+// cuts each 6-byte sample read from ~0.7ms to ~0.2ms; drop to 100000 for long
+// or weakly pulled-up wiring. With -DI2CDEV_IMPLEMENTATION=I2CDEV_ESP8266_GPIO
+// (the nodemcuv2_fasti2c env) I2Cdev drives the pins itself instead of Wire,
+// on cycle-counted timing, which holds up to 800000 with stiff pull-ups.
+#ifndef I2C_CLOCK_HZ
+    #define I2C_CLOCK_HZ 400000
+#endif
+
+// Serial logging (override with -DLOG_LEVEL=... in build_flags)
+//   LOG_LEVEL_INFO  : boot, heartbeat, upload and error lines only; nothing
+//                     is printed per sample (production, nobody is listening)
+//   LOG_LEVEL_DEBUG : as INFO, plus the "y,z" Serial Plotter line per sample
+//                     (binary x,y,z blocks in its place with SERIAL_CAPTURE)
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_DEBUG 2
+#ifndef LOG_LEVEL
+    #define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// Debug aid (-DHEAP_CHECK=1, on in the nodemcuv2_debug env): assert that the
+// steady-state sections - per-sample processing and building the heartbeat
+// URL - leave the free heap exactly as they found it
+#ifndef HEAP_CHECK
+    #define HEAP_CHECK 0
+#endif
+#if HEAP_CHECK
+    #define HEAP_CHECK_BEGIN()              uint32_t heapCheckFree = ESP.getFreeHeap()
+    #define HEAP_CHECK_END(what)            checkHeapUnchanged(heapCheckFree, what)
+    #define HEAP_CHECK_END_UNLESS(c, what)  do { if (!(c)) checkHeapUnchanged(heapCheckFree, what); } while (0)
+#else
+    #define HEAP_CHECK_BEGIN()              do { } while (0)
+    #define HEAP_CHECK_END(what)            do { } while (0)
+    #define HEAP_CHECK_END_UNLESS(c, what)  do { (void)(c); } while (0)
+#endif
+
+// Test build (-DWAVEFORM_INJECT=1, the nodemcuv2_inject env): samples come
+// from a stored capture the server hands over (POST /api/inject/:deviceId)
+// or /inject.swv on LittleFS instead of the sensor, see waveform_inject.h.
+// Never in production firmware: while one plays the node reports a fake event.
+#ifndef WAVEFORM_INJECT
+    #define WAVEFORM_INJECT 0
+#endif
+#if WAVEFORM_INJECT
+    #include <LittleFS.h>
+    #define INJECT_FILE           "/inject.swv"
+    #define INJECT_FILE_DELAY_MS  60000UL   // after boot, once STA/LTA has an LTA
+#endif
+
+// Heartbeat URL capacity, reserved once at boot so the per-heartbeat build
+// never reallocates; the helicorder trace gets whatever room is left
+#define HEARTBEAT_URL_SIZE 3072
+
+// Per-task time budgets for the loop scheduler; a run past its budget counts
+// as an overrun in the heartbeat's task_* stats (see task_scheduler.h)
+#define TASK_ACQUIRE_BUDGET_US     5000UL
+#define TASK_WIFI_BUDGET_US        1000UL
+#define TASK_PUSH_BUDGET_US        2000UL
+#define TASK_MQTT_BUDGET_US        2000UL     // a segment of an upload, or a config message
+#define TASK_SESSION_BUDGET_US     2000UL     // likewise, over the device session
+#define TASK_HEARTBEAT_BUDGET_US   500000UL   // one HTTP round trip
+#define TASK_UPLOAD_BUDGET_US      5000UL
+#define TASK_TELEMETRY_BUDGET_US   500UL
+#define TASK_THERMAL_BUDGET_US     2000UL     // a TEMP_OUT read, sometimes an EEPROM commit
+#define TASK_BLACKBOX_BUDGET_US    20000UL    // a 256-byte append and its LittleFS commit
+#define TASK_LOCAL_BUDGET_US       2000UL     // a /status reply or a /live chunk
+
 // Onboard blue LED is GPIO2 (D4), active LOW
 #define LED_PIN LED_BUILTIN
 
+// ESP-NOW peer triggers (-DPEER_LINK=0 to leave the radio to Wi-Fi alone):
+// a capture with PEER_QUORUM other nodes heard within PEER_WINDOW_MS of its
+// trigger is locally confirmed - the upload says so, and the LED flashes for
+// LOCAL_ALARM_MS whether or not the server is reachable
+#ifndef PEER_LINK
+    #define PEER_LINK 1
+#endif
+#define PEER_WINDOW_MS   2000UL   // the server's default consensus_window_ms
+#define PEER_QUORUM      1
+#define LOCAL_ALARM_MS   30000UL
+#define TASK_PEERS_BUDGET_US 500UL
+
+// True vertical for the gravity_* detect metrics (dmp_gravity.h): the DMP's
+// gravity direction, read once sampling is up and again every
+// DMP_GRAVITY_REFRESH_MS while idle at +/-2g. Each read holds sampling for
+// ~1.3s, logged as a FIFO gap. -DDMP_GRAVITY=0 keeps the DMP out and the
+// metrics on the calibration bias's direction instead.
+#ifndef DMP_GRAVITY
+    #define DMP_GRAVITY 1
+#endif
+#define DMP_GRAVITY_REFRESH_MS (6 * 3600UL * 1000UL)
+
+// Storm suppression (storm_filter.h): minor captures within this long of the
+// last minor upload go into the heartbeat's per-minute summary; 0 uploads all
+#ifndef STORM_COOLDOWN_MS
+    #define STORM_COOLDOWN_MS 60000UL
+#endif
+
+// Accelerometer acquisition mode (override with -DACQ_MODE=... in build_flags)
+//   ACQ_MODE_POLL : one accel+temp burst read per sample period, paced by the
+//                   loop scheduler at sampleRateHz
+//   ACQ_MODE_FIFO : MPU6050 FIFO at sampleRateHz, drained in bursts each loop
+//   ACQ_MODE_DRDY : as FIFO, but the INT pin's data-ready pulse timestamps
+//                   each sample from an ISR and loop() never delay()s
+//   ACQ_MODE_MOTION : as FIFO, but at rest the chip clocks a low-rate ring
+//                   that is drained about once a second, and its motion
+//                   interrupt on the INT pin brings back the full rate
+#define ACQ_MODE_POLL   1
+#define ACQ_MODE_FIFO   2
+#define ACQ_MODE_DRDY   3
+#define ACQ_MODE_MOTION 4
+#ifndef ACQ_MODE
+    #define ACQ_MODE ACQ_MODE_FIFO
+#endif
+
+#if ACQ_MODE == ACQ_MODE_DRDY || ACQ_MODE == ACQ_MODE_MOTION
+    #define INT_PIN D5  // GPIO14, wired to MPU6050 INT
+#endif
+
+#if ACQ_MODE == ACQ_MODE_MOTION
+// At rest the chip runs at sampleRateHz / MOTION_IDLE_DIVISOR (25Hz at the
+// default 100Hz, ~6.8s of FIFO), so it is only read every MOTION_IDLE_DRAIN_MS.
+// A motion interrupt or a capture switches to the full rate, kept until
+// MOTION_HOLD_MS after the last of either.
+#define MOTION_IDLE_DIVISOR   4
+#define MOTION_IDLE_DRAIN_MS  1000UL
+#define MOTION_HOLD_MS        10000UL
+// Wake threshold as a share of the minor threshold, so the full rate is back
+// before a software trigger; MOT_THR is 2mg/LSB and MOT_DUR 1ms/LSB
+#define MOTION_WAKE_FRACTION  0.5f
+#define MOTION_DURATION_MS    2
+#endif
+
+#if ACQ_MODE != ACQ_MODE_POLL
+    #ifndef SAMPLE_RATE_HZ
+        #define SAMPLE_RATE_HZ 100     // default when /api/init omits sample_rate_hz
+    #endif
+#else
+    #define SAMPLE_RATE_HZ 20          // nominal, loop paced by delay(1000/rate)
+#endif
+
+// Second MPU6050 at 0x69 with AD0 high (dual_sensor.h). It is drained with
+// the first in every FIFO pass and has to agree with it before a capture
+// counts. The binary uploads carry it. Mount the two a short way apart,
+// e.g. in separate enclosures on the same slab, so a knock reaches only one.
+// FIFO modes only: polling and motion wake pace a single chip.
+#ifndef DUAL_SENSOR
+    #define DUAL_SENSOR 0
+#endif
+#if DUAL_SENSOR && (ACQ_MODE == ACQ_MODE_POLL || ACQ_MODE == ACQ_MODE_MOTION)
+    #error "DUAL_SENSOR needs ACQ_MODE_FIFO or ACQ_MODE_DRDY"
+#endif
+#define DUAL_CALIB_SAMPLES  500         // boot average for its bias, ~1s
+#define DUAL_BIAS_TRACK_MS  300000UL    // it has no stored calibration, so it always tracks
+
+// Bias correction (override with -DCALIB_MODE=... in build_flags)
+//   CALIB_MODE_SOFTWARE : average reads at rest until the mean settles
+//                         (bias_estimator.h) and subtract the float mean
+//                         from every sample
+//   CALIB_MODE_HARDWARE : CalibrateAccel() programs the chip's XA/YA/ZA_OFFS
+//                         registers so it reads (0, 0, +1g) at rest; the
+//                         trigger is then an integer compare on raw LSB
+#define CALIB_MODE_SOFTWARE 1
+#define CALIB_MODE_HARDWARE 2
+#ifndef CALIB_MODE
+    #define CALIB_MODE CALIB_MODE_SOFTWARE
+#endif
+#define ACCEL_1G_LSB 16384   // +/-2g range
+
+// Upper bound on pre + post samples held in RAM. Each sample costs 6 bytes
+// in the capture arena; the upload body is streamed, so 2400 (12s at 200Hz)
+// keeps the arena at ~14KB of the ~40KB free heap.
+#define MAX_CAPTURE_SAMPLES 2400
+
+// Heap left over after that lengthens the same ring, so the server can pull
+// the data around a confirmed event this node didn't trigger on (servePull()).
+// ARENA_HEAP_RESERVE stays free for the upload queue plus lwIP, and in a TLS
+// MQTT or session build the sockets that aren't open yet.
+#define ARENA_MAX_SAMPLES   6000
+#define ARENA_HEAP_RESERVE  (ASYNC_UPLOAD_MAX_BYTES + 8192 + TLS_HEAP_RESERVE + MQTT_HEAP_RESERVE + \
+                             SESSION_HEAP_RESERVE)
+
+// A detection during a capture keeps it open for another postMs, up to
+// maxPostMs. It is logged as a separate trigger only after this long below
+// the thresholds (an oscillating signal crosses them twice per cycle).
+#define RETRIGGER_QUIET_MS    1000
+
+// A severe detection moves the accelerometer to this range for the rest of
+// the capture, so the peak isn't clipped at 2g; it drops back to +/-2g after
+// AUTO_RANGE_IDLE_MS below the minor threshold with no capture running.
+// MPU6050_ACCEL_FS_2 turns auto-ranging off.
+#ifndef AUTO_RANGE_FS
+    #define AUTO_RANGE_FS     MPU6050_ACCEL_FS_8
+#endif
+#define AUTO_RANGE_IDLE_MS    10000UL
+
+// Journal replay backoff while the server is unreachable (doubles per failure)
+#define REPLAY_BACKOFF_MIN_MS 2000UL
+#define REPLAY_BACKOFF_MAX_MS (5 * 60 * 1000UL)
+
+// Boot gives up and reboots if Wi-Fi isn't up by then; later drops are
+// reconnected in place (events are journaled meanwhile)
+#define WIFI_CONNECT_TIMEOUT_MS (30 * 1000UL)
+
+// Heartbeat answer meaning "your config is stale": re-fetch /api/init and
+// apply it in place (205 still means reboot)
+#define HTTP_CODE_CONFIG_CHANGED 202
+// ... and "fetch /api/pull and upload that window of the ring"
+#define HTTP_CODE_PULL_PENDING   203
+// ... and "fetch /api/inject and play it" (only to WAVEFORM_INJECT builds)
+#define HTTP_CODE_INJECT_PENDING 207
+
 // Seismic thresholds (in g)
 unsigned long heartbeatInterval = 60000;  // ms
+unsigned long pushHeartbeatInterval = 60000;  // ms, used instead while the push channel is live
 float sensMinor = 0.035;
 float sensModerate = 0.10;
 float sensSevere = 0.50;
+int32_t sensMinorLsb, sensModerateLsb, sensSevereLsb;  // the above in raw LSB, set at init
+
+// Acquisition config (pushed from /api/init, defaults used if absent)
+int           sampleRateHz = SAMPLE_RATE_HZ;
+uint8_t       dlpfMode     = MPU6050_DLPF_BW_188;
+unsigned long preMs        = 3000;  // ms of history kept before a trigger
+unsigned long postMs       = 3000;  // ms captured after a trigger
+unsigned long maxPostMs    = 12000; // retriggers extend the capture up to this
+uint32_t      configGen    = 0;     // server's config generation we last applied
+uint32_t      configCrc    = 0;     // CRC of its binary config section (&cfh=), 0 if it came as JSON
+
+EventDetector detector;      // pre-filter, triggers and the capture state machine
+Helicorder    helicorder;    // 1Hz min/max/RMS trace, sent with each heartbeat
+LoopProfile   profile;       // per-phase loop timing + sample spacing, ditto
+CpuBoost      cpuBoost;      // 160MHz for upload, capture and TLS bursts, their busy time ditto
+#if MODEM_SLEEP
+ModemSleep    modemSleep;    // radio and CPU asleep between idle FIFO drains, duty cycle ditto
+#endif
+HeapMonitor   heapMonitor;   // free heap / largest block / fragmentation, ditto
+SntpClock     sntpClock;     // SNTP-disciplined wall clock for event times
+WifiLink      wifiLink;      // cached-AP fast connect + in-place reconnect
+PushChannel   pushChannel;   // long-poll: reinit / config changes without waiting for a heartbeat
+MqttLink      mqttLink;      // broker in place of the HTTP routes, when /api/init names one
+SessionLink   sessionLink;   // device session in their place, likewise
+#if SESSION_LINK
+MessageLink*  messageLink = &sessionLink;   // what uploads and trigger notices go over first
+#else
+MessageLink*  messageLink = &mqttLink;
+#endif
+UdpStream     udpStream;     // optional continuous decimated stream (stream_mode "udp")
+#if SERIAL_CAPTURE
+SerialCapture serialCapture; // every sample in binary blocks on the serial port
+#endif
+TriggerNotice triggerNotice; // datagram ahead of the upload when a capture opens
+PeerLink      peerLink;      // ESP-NOW trigger frames to and from the other nodes
+StormFilter   storm;         // minor captures in a cooldown, folded into heartbeat summaries
+unsigned long localAlarmUntil = 0;   // millis() the LED alarm ends, 0 = off
+OtaUpdater    otaUpdater;    // firmware update, run from loop() once sampling is up
+BootTiming    bootTiming;    // where setup() spent its time, for the first heartbeat
+BlackBox      blackBox;      // the last few hours at 10Hz on flash, pulled by time range
+LocalHttp     localHttp;     // on-node /status and /live for installation, config "local_http"
+TaskScheduler scheduler;     // loop() tasks, acquisition first (see startScheduler())
+GoertzelBank  spectrum;      // band amplitudes of each capture, when spectrumEnabled
+bool          spectrumEnabled = false;
+SpectrumSummary capturedSpectrum;
+#if WAVEFORM_INJECT
+WaveformInjector injector;   // stands in for the sensor while a stored capture plays
+unsigned long    injectFileAt = 0;   // when to play INJECT_FILE, 0 = not pending
+#endif
+
+// Upload body encoding, picked from the server's upload_formats at init
+enum UploadFormat { UPLOAD_JSON, UPLOAD_BINARY, UPLOAD_MSGPACK, UPLOAD_DELTA, UPLOAD_FORMAT_COUNT };
+const char* const UPLOAD_FORMAT_NAMES[UPLOAD_FORMAT_COUNT] = { "json", "binary", "msgpack", "delta" };
+UploadFormat uploadFormat = UPLOAD_JSON;
+
+// A capture in each upload encoding; pick() returns the one uploadFormat names
+struct UploadBodies {
+  WaveformJsonStream    json;
+  WaveformBinaryStream  binary;
+  WaveformMsgPackStream msgpack;
+  WaveformBinaryStream  delta;
+
+  explicit UploadBodies(const CaptureView& cap) : json(cap), binary(cap), msgpack(cap), delta(cap, true) {}
+
+  PieceStream* pick(const char*& contentType) {
+    switch (uploadFormat) {
+      case UPLOAD_BINARY:  contentType = WAVEFORM_BINARY_CONTENT_TYPE;  return &binary;
+      case UPLOAD_MSGPACK: contentType = WAVEFORM_MSGPACK_CONTENT_TYPE; return &msgpack;
+      case UPLOAD_DELTA:   contentType = WAVEFORM_DELTA_CONTENT_TYPE;   return &delta;
+      default:             contentType = "application/json";            return &json;
+    }
+  }
+};
 
-// How many samples to "sit still" for software calibration
-const int   CALIB_SAMPLES = 2000;
 const float SCALE = 16384.0;  // LSB per g at +/-2g range
 
 MPU6050 mpu;
+#if DUAL_SENSOR
+MPU6050 mpu2(MPU6050_ADDRESS_AD0_HIGH);
+bool dualSensor = false;      // second sensor found at boot, with an arena
+BiasTracker secondaryBias;    // its bias, from the boot average on
+int16_t lastSecondary[3] = {0, 0, 0};  // repeated when a drain had none of its samples
+uint32_t localTaps = 0;       // captures dropped as local since boot ("&taps=")
+#endif
+ServerTls  serverTls;         // plain TCP, or TLS resuming one shared session
+ServerLink serverLink;        // keep-alive connection shared by all API calls
+AsyncUploader uploader;       // event POSTs, sent from loop() while sampling continues
+UploadPolicy  uploadPolicy;  // how much the server wants right now (X-Upload-Policy)
+EventJournal journal;         // events the server couldn't take, replayed later
+// Captures the upload queue couldn't take, since boot ("&capq="): journaled
+// while both slots were busy, streamed with sampling paused, or lost
+struct CaptureOverflow {
+  uint32_t spilled;
+  uint32_t streamed;
+  uint32_t dropped;
+} captureOverflow = {};
 float meanX, meanY, meanZ;    // raw-LSB bias measured at rest
-String deviceId;
+int32_t biasLsbX, biasLsbY, biasLsbZ;  // the same, rounded for the integer hot path
+int16_t lastTempRaw = 0;      // MPU6050 die temperature, raw TEMP_OUT
+BiasTracker biasTracker;      // follows slow drift of the above while idle
+ThermalBias thermalBias;      // bias-vs-temperature slope, added on top of either
+CalibrationBias calibration;  // as stored, rewritten when the fitted slopes move
+unsigned long thermalSavedAt = 0;
+const unsigned long THERMAL_SAVE_MS = 6 * 3600UL * 1000UL;  // EEPROM wear: at most 4 writes a day
+const float THERMAL_SAVE_DELTA = 0.5f;                      // LSB/degC change worth a write
+unsigned long biasTrackMs = 0;          // tracker time constant from /api/init, 0 = off
+const int32_t BIAS_TRACK_STEP_LSB  = 16;   // per-sample error clamp (~1mg)
+const int32_t BIAS_TRACK_DRIFT_LSB = 820;  // max excursion from calibration (~0.05g)
+char deviceId[18];            // "AA:BB:CC:DD:EE:FF"
+
+// URLs fixed at boot; only the heartbeat query changes per call
+char initUrl[160];
+char heartbeatBase[96];
+String heartbeatUrl;          // reserved to HEARTBEAT_URL_SIZE in setup()
 
 // Interval for connectivity check (ms)
 const unsigned long CONNECTIVITY_INTERVAL = 60UL * 1000UL;  // 1 minute
 unsigned long lastConnectivityCheck = 0;
+unsigned long wifiLostAt = 0;             // 0 while connected
+
+// Server clock at init minus millis(), so events get a wall-clock time that
+// survives the journal and a reboot. 0 if the server didn't send one. Only
+// used until SNTP has synced (it includes the init request's latency).
+int64_t clockOffsetMs = 0;
+
+unsigned long replayAt = 0;               // next journal replay attempt
+unsigned long replayBackoffMs = REPLAY_BACKOFF_MIN_MS;
 
-// -- Waveform ring buffer ---------------------------------------------------
-// Pre-event: circular buffer holding last ~3 seconds at ~20Hz
-// Post-event: linear buffer capturing ~3 seconds after trigger
-const int PRE_SAMPLES  = 60;   // 3 seconds at ~20Hz (delay 50ms)
-const int POST_SAMPLES = 60;   // 3 seconds after event
+#if ACQ_MODE != ACQ_MODE_POLL
+// -- FIFO acquisition state -------------------------------------------------
+// Only accel XYZ goes into the FIFO: 6 bytes per sample, big-endian int16.
+// The 1024-byte FIFO holds ~1.7s at 100Hz, so a slow heartbeat or upload
+// no longer drops samples. Timestamps come from the sample counter, not
+// from when loop() got around to reading them.
+const int FIFO_SAMPLE_BYTES = 6;
+// Everything the 1024-byte FIFO can hold, read with one getFIFOBlock() call
+// (split into Wire-buffer chunks inside I2Cdev)
+const int FIFO_BURST_SAMPLES = 1024 / FIFO_SAMPLE_BYTES;
+uint8_t fifoBurst[FIFO_BURST_SAMPLES * FIFO_SAMPLE_BYTES];
+#if DUAL_SENSOR
+uint8_t fifoBurst2[FIFO_BURST_SAMPLES * FIFO_SAMPLE_BYTES];   // the second sensor's
+#endif
+// Samples split into per-axis stack arrays at a time (3 * 64 bytes)
+const int FIFO_UNPACK_SAMPLES = 32;
+unsigned long fifoBaseMs = 0;       // millis() at last FIFO reset
+unsigned long fifoSampleIndex = 0;  // samples drained since fifoBaseMs
+// The chip's clock isn't millis() (the internal oscillator is good to a few
+// percent), so the counter is pulled back in whenever the newest drained
+// sample is stamped in the future or more than this far in the past
+const unsigned long FIFO_CLOCK_SLACK_MS = 50;
+int fifoRateHz = SAMPLE_RATE_HZ;    // chip sample clock: sampleRateHz, less at rest in ACQ_MODE_MOTION
 
-struct WaveSample {
-  unsigned long ms;    // millis() timestamp
-  float ax, ay, az;    // bias-corrected acceleration in g
+// Samples lost to FIFO overflows, so captures spanning one can say so. The
+// reset discards the FIFO, so everything clocked since the last drained
+// sample is gone; the count comes from elapsed time at the configured rate.
+struct FifoGap {
+  uint32_t firstSeq;       // arena sequence number of the first sample after the gap
+  uint16_t lost;
 };
+const int FIFO_GAP_LOG = 4;          // a capture spanning more is reported as one gap
+FifoGap fifoGaps[FIFO_GAP_LOG];
+int fifoGapCount = 0;                // total logged, newest at (count - 1) % FIFO_GAP_LOG
+unsigned long fifoLostTotal = 0;
+#endif
 
-WaveSample preBuffer[PRE_SAMPLES];
-int preHead  = 0;
-int preCount = 0;
+#if ACQ_MODE == ACQ_MODE_DRDY
+// -- Data-ready timestamp ring (src/ready_ring.h) ---------------------------
+ReadyRing readyRing;
 
-// Post-event capture state
-bool waveCapturing = false;
-WaveSample postBuffer[POST_SAMPLES];
-int postCount = 0;
-String capturedLevel;
-float  capturedDeltaG;
+// Real-time profile (src/realtime.h): the sample path in IRAM, and the
+// ISR's entry jitter on the heartbeat
+#if REALTIME_PROFILE
+IsrJitter isrJitter;
+#endif
+#endif
+#if MODEM_SLEEP && (ACQ_MODE == ACQ_MODE_POLL || ACQ_MODE == ACQ_MODE_DRDY)
+    #error "MODEM_SLEEP needs ACQ_MODE_FIFO or ACQ_MODE_MOTION: the others wake every sample"
+#endif
+#if REALTIME_PROFILE && ACQ_MODE != ACQ_MODE_DRDY
+    #error "REALTIME_PROFILE needs ACQ_MODE_DRDY: the jitter is the data-ready ISR's"
+#endif
+
+#if ACQ_MODE == ACQ_MODE_MOTION
+// -- Motion wake --------------------------------------------------------------
+// The ISR only stamps the interrupt; loop() reclocks the chip (I2C can't run
+// from an ISR). Idle samples are ramped up to sampleRateHz, so the arena,
+// triggers and helicorder stay on one grid and a wake already has its
+// pre-event history.
+volatile unsigned long motionAt = 0;  // millis() | 1 of the last motion interrupt, 0 once seen
+bool motionIdle = false;              // chip at the idle rate
+int  idleDivisor = 1;                 // full-rate samples per idle sample
+unsigned long fullRateUntil = 0;      // back to idle after this
+unsigned long idleDrainAt = 0;        // last idle-rate drain
+unsigned long motionWakes = 0;        // idle -> full-rate switches by the interrupt
+int16_t lastRaw[3] = {0, 0, 0};       // newest sample, the ramp's start
+#endif
+
+// -- Waveform capture -------------------------------------------------------
+// One arena ring of preMs + maxPostMs of samples, heap-allocated once at boot
+// from the /api/init config. A capture is the preSamples up to the trigger
+// plus at least postSamples after it, read in place at upload time.
+int preSamples     = 0;
+int postSamples    = 0;
+int maxPostSamples = 0;
+CaptureArena arena;
+#if DUAL_SENSOR
+CaptureArena arena2;               // second sensor, same capacity and sequence numbers
+#endif
+unsigned long newestSampleMs = 0;  // millis() of the latest arena.push()
+
+// Capture state beyond detector.capture()
+const char* const LEVEL_NAMES[] = { "minor", "moderate", "severe" };
 unsigned long capturedEventTime;  // millis() when event first triggered
+int64_t capturedEpochUs;          // the same on the SNTP clock, 0 if not synced yet
+uint32_t capturedSeq;             // seq finishCapture() will take, sent in the trigger notice
+bool capturedFoldable;            // minor in a storm cooldown: summarized unless it grows
+#if DUAL_SENSOR
+bool capturedDual;                // both sensors were read through (not injected)
+#endif
+
+// -- Accel auto-ranging -------------------------------------------------------
+// The arena keeps every sample at the range it was read at, where one LSB is
+// 2^shift +/-2g LSB (shift = the MPU6050_ACCEL_FS_* code); detection, bias
+// and thresholds stay in +/-2g LSB. Switches are logged against sequence
+// numbers, like FIFO gaps, so an upload can give each block its scale.
+struct RangeSwitch {
+  uint32_t firstSeq;   // arena sequence number of the first sample at 'to'
+  uint8_t  from, to;
+};
+const int RANGE_LOG = 4;
+RangeSwitch rangeLog[RANGE_LOG];
+int rangeSwitchCount = 0;            // total logged, newest at (count - 1) % RANGE_LOG
+uint8_t rangeShift = 0;              // range the chip is set to
+uint8_t wantRangeShift = 0;          // range processSample() asks for
+unsigned long rangeQuietSamples = 0; // raised, idle and below minor for this long
+CaptureRange captureRanges[RANGE_LOG + 1];  // range blocks of the capture being uploaded
 
 // Function declarations
 void setup();
 void loop();
-void startCapture(const char* level, float dev, unsigned long eventTime);
-void uploadWaveformEvent();
+void startScheduler();
+#if MODEM_SLEEP
+bool sleepBetweenDrains();
+#endif
+void taskAcquire(unsigned long now);
+void taskPeers(unsigned long now);
+void taskWifi(unsigned long now);
+void taskPush(unsigned long now);
+void taskMqtt(unsigned long now);
+void taskSession(unsigned long now);
+void taskOta(unsigned long now);
+void taskHeartbeat(unsigned long now);
+void taskUpload(unsigned long now);
+void taskTelemetry(unsigned long now);
+void taskThermal(unsigned long now);
+void taskBlackBox(unsigned long now);
+void taskLocalHttp(unsigned long now);
+void writeLocalStatus(Print& out);
+#if DMP_GRAVITY
+void taskGravity(unsigned long now);
+void refreshGravity();
+#endif
+void gravityFromBias();
+void restoreSensorProfile();
+void applyBias();
+float biasInUse(int axis);
+bool calibrateBias(CalibrationBias& bias, bool recalibrate);
+void allocateCaptureBuffers();
+InitConfig serverDefaults();
+void applyConfig(const InitConfig& c);
+const JsonDocument& initFilter();
+bool reloadConfig();
+void applyReload(const InitConfig& cfg, const InitBoot& boot);
+void handleServerCode(int code);
+void handleLinkMessage(bool isConfig, const char* text, unsigned long now);
+bool servePull();
+bool serveBlackBoxPull(int64_t fromMs, int64_t toMs);
+#if WAVEFORM_INJECT
+bool serveInject();
+void taskInject(unsigned long now);
+#endif
+void processSample(unsigned long ms, int16_t rawX, int16_t rawY, int16_t rawZ);
+float tempCelsius(int16_t raw);
+void appendBusStats(String& url);
+uint32_t busMicros();
+void endLoopProfile(uint32_t loopStartUs, uint32_t busStartUs);
+uint8_t rangeShiftAt(uint32_t seq);
+void applyAutoRange();
+void findCaptureRanges(CaptureView& cap);
+void startCapture(unsigned long eventTime);
+bool foldable(EventLevel level, unsigned long at);
+void buildHeartbeatUrl(unsigned long now, int& traceSeconds, int& stormMinutes, uint32_t& evictions);
+#if HEAP_CHECK
+void checkHeapUnchanged(uint32_t before, const char* what);
+#endif
+void finishCapture();
+void handleUploadResult(int code);
+void replayJournal();
+#if ACQ_MODE != ACQ_MODE_POLL
+void startFifo();
+void drainFifo();
+void restartFifoAfterLoss(const char* why);
+void findCaptureGap(CaptureView& cap);
+#endif
+#if DUAL_SENSOR
+void calibrateSecondary();
+int  readSecondaryFifo();
+void feedSecondary(int index, int count);
+void attachSecondary(CaptureView& cap);
+#endif
+#if ACQ_MODE == ACQ_MODE_DRDY
+void IRAM_ATTR onDataReady();
+#endif
+#if ACQ_MODE == ACQ_MODE_MOTION
+void IRAM_ATTR onMotion();
+void applyMotionThreshold();
+void setMotionIdle(bool idle);
+void feedSample(unsigned long ms, int16_t rawX, int16_t rawY, int16_t rawZ);
+#endif
 
 void setup() {
+#if SERIAL_CAPTURE
+  Serial.begin(SERIAL_CAPTURE_BAUD);
+#else
   Serial.begin(115200);
+#endif
   while (!Serial) { }
+  bootTiming.begin();
 
   // Initialize LED pin
   pinMode(LED_PIN, OUTPUT);
   digitalWrite(LED_PIN, HIGH);  // LED off until we're fully up
 
-  // --- Connect to Wi-Fi ---
-  Serial.print("Connecting to Wi-Fi");
-  WiFi.begin(SECRET_SSID, SECRET_PASS);
-  int tries = 0;
-  while (WiFi.status() != WL_CONNECTED) {
-    Serial.print('.');
-    delay(300);
-    if (++tries > 100) {
-      Serial.println("\nWi-Fi failed, rebooting...");
-      digitalWrite(LED_PIN, HIGH);
-      ESP.restart();
-    }
+  // --- Wi-Fi associates in the background while the sensor comes up ---
+  Serial.println("Connecting to Wi-Fi");
+  wifiLink.begin(SECRET_SSID, SECRET_PASS);
+  delay(500);
+
+  // --- Setup MPU6050, on the compiled-in rate until /api/init has answered ---
+#if I2CDEV_IMPLEMENTATION == I2CDEV_ESP8266_GPIO
+  if (!Esp8266Wire::setup(SDA_PIN, SCL_PIN, I2C_CLOCK_HZ)) Serial.println("I2C bus held low, recovery failed.");
+#else
+  Wire.begin(SDA_PIN, SCL_PIN);
+  Wire.setClock(I2C_CLOCK_HZ);
+#endif
+  // Config setters are read-modify-write; serve the read half from RAM
+  mpu.setShadowCacheEnabled(true);
+  // Accel only: gyros in standby on the internal clock, +/-2g, accel-only
+  // FIFO clocked at sampleRateHz, in one batch of burst writes (the FIFO
+  // itself is switched on by startFifo())
+  mpu.setAccelOnlyProfile(sampleRateHz, dlpfMode, MPU6050_ACCEL_FS_2, false);
+  if (!mpu.testConnection()) {
+    Serial.println("MPU6050 not found! Check wiring.");
+    digitalWrite(LED_PIN, HIGH);
+    while (1) delay(500);
   }
-  Serial.println();
-  Serial.printf("Wi-Fi connected, IP=%s\n", WiFi.localIP().toString().c_str());
+  Serial.printf("MPU6050 initialized, I2C at %lukHz.\n", (unsigned long)I2C_CLOCK_HZ / 1000UL);
+#if DUAL_SENSOR
+  mpu2.setShadowCacheEnabled(true);
+  mpu2.setAccelOnlyProfile(sampleRateHz, dlpfMode, MPU6050_ACCEL_FS_2, false);
+  dualSensor = mpu2.testConnection();
+  Serial.println(dualSensor ? "Second MPU6050 initialized at 0x69."
+                            : "! Second MPU6050 not found at 0x69, single sensor");
+#endif
+
+  bootTiming.mark(BOOT_MPU);
+
+  // --- Bias: restored or measured before the network is needed ---
+  CalibrationBias bias;
+  bool biasRestored = calibrateBias(bias, false);
+  unsigned long sensorReadyAt = millis();
+  bootTiming.mark(BOOT_CALIB);
+
+  if (!wifiLink.wait(WIFI_CONNECT_TIMEOUT_MS)) {
+    Serial.println("Wi-Fi failed, rebooting...");
+    digitalWrite(LED_PIN, HIGH);
+    ESP.restart();
+  }
+  bootTiming.mark(BOOT_WIFI);
+  bootTiming.wifi(wifiLink.lastConnectMs(), wifiLink.usedFastPath());
+#if MODEM_SLEEP
+  modemSleep.begin(millis());
+#endif
+  Serial.printf("IP=%s, %lums after the sensor was ready\n", WiFi.localIP().toString().c_str(),
+                millis() - sensorReadyAt);
   digitalWrite(LED_PIN, LOW);  // LED on: we're connected
+  storm.begin(STORM_COOLDOWN_MS);
+#if PEER_LINK
+  if (peerLink.begin()) Serial.printf("ESP-NOW peers on channel %d\n", WiFi.channel());
+  else Serial.println("! ESP-NOW unavailable, no local coincidence");
+#endif
 
   // --- Grab and log our MAC for use as "self-ID" ---
-  deviceId = WiFi.macAddress();
-  Serial.printf("Device MAC (self-ID): %s\n", deviceId.c_str());
+  snprintf(deviceId, sizeof(deviceId), "%s", WiFi.macAddress().c_str());
+  Serial.printf("Device MAC (self-ID): %s\n", deviceId);
+  snprintf(initUrl, sizeof(initUrl), "%sapi/init?id=%s&version=%s", ROOT_URL, deviceId, FIRMWARE_VERSION);
+  snprintf(heartbeatBase, sizeof(heartbeatBase), "%s?id=%s", ROOT_URL, deviceId);
+  heartbeatUrl.reserve(HEARTBEAT_URL_SIZE);
 
   // --- Initialization API call ---
-  HTTPClient initHttp;
-  WiFiClient initClient;
-  // Include current firmware version so server can track what each device is running
-  String initUrl = String(ROOT_URL) + "api/init?id=" + deviceId + "&version=" + FIRMWARE_VERSION;
-  Serial.printf("Fetching init config from %s ... ", initUrl.c_str());
-  initHttp.begin(initClient, initUrl);
-  int initCode = initHttp.GET();
-  if (initCode != HTTP_CODE_OK) {
-    Serial.printf("Failed HTTP %d, rebooting...\n", initCode);
-    digitalWrite(LED_PIN, HIGH);
-    ESP.restart();
+  journal.begin();
+  serverTls.begin(ROOT_URL, SECRET_SERVER_FINGERPRINT);
+  otaUpdater.begin(&serverTls);
+  serverLink.begin(ROOT_URL, &serverTls);
+  pushChannel.begin(ROOT_URL, deviceId, &serverTls);
+  uploader.begin(URL, &serverTls, &journal, &uploadPolicy, messageLink);
+  triggerNotice.attach(messageLink);
+  // initUrl carries the firmware version so server can track what each device is running.
+  // A warm reset comes back on the settings it had (init_store.h)
+  InitConfig initCfg = serverDefaults();
+  InitBoot   initBoot = {};
+  bool initCached = loadInitCache(initCfg, FIRMWARE_VERSION);
+  if (initCached) {
+    Serial.printf("Init config generation %lu from RTC memory, fetch skipped\n", (unsigned long)initCfg.gen);
+  } else {
+    Serial.printf("Fetching init config from %s ... ", initUrl);
+    bool decoded = false;
+    int initCode = fetchInit(serverLink, initUrl, initFilter(), initCfg, initBoot, &decoded);
+    if (initCode != HTTP_CODE_OK) {
+      Serial.printf("Failed HTTP %d, rebooting...\n", initCode);
+      digitalWrite(LED_PIN, HIGH);
+      ESP.restart();
+    }
+    if (!decoded) {
+      Serial.println("Init body didn't decode, rebooting...");
+      ESP.restart();
+    }
+    Serial.printf("%s\n", initCfg.crc ? "binary" : "JSON");
+    saveInitCache(initCfg, FIRMWARE_VERSION);
   }
-  String payload = initHttp.getString();
-  initHttp.end();
-  StaticJsonDocument<512> doc;
-  DeserializationError err = deserializeJson(doc, payload);
-  if (err) {
-    Serial.println("JSON parse error, rebooting...");
-    ESP.restart();
+  bootTiming.mark(BOOT_INIT);
+  if (initBoot.serverTimeMs > 0) clockOffsetMs = initBoot.serverTimeMs - (int64_t)millis();
+  sntpClock.begin(initCfg.ntpServer[0] ? initCfg.ntpServer : SNTP_DEFAULT_SERVER);
+
+  // Acquisition config; older servers omit these, so keep the defaults
+  sampleRateHz = initCfg.sampleRateHz;
+  dlpfMode     = initCfg.dlpf;
+  preMs        = initCfg.preMs;
+  postMs       = initCfg.postMs;
+  maxPostMs    = initCfg.maxPostMs;
+  Serial.printf("Acquisition: rate=%dHz, dlpf=%u, pre=%lums, post=%lums (max %lums)\n",
+                sampleRateHz, dlpfMode, preMs, postMs, maxPostMs);
+#if WAVEFORM_INJECT
+  // Before the arena, which grows into whatever heap is left
+  if (!injector.begin(INJECT_MAX_SAMPLES)) Serial.println("! Injection buffer allocation failed");
+#endif
+  allocateCaptureBuffers();
+  helicorder.begin(sampleRateHz);
+  if (blackBox.begin(sampleRateHz)) {
+    Serial.printf("Black box: %lu..%lu held\n", (unsigned long)blackBox.oldestSecond(),
+                  (unsigned long)blackBox.newestSecond());
   }
-  heartbeatInterval = doc["heartbeat_interval"];
-  sensMinor = doc["sensitivity"]["minor"];
-  sensModerate = doc["sensitivity"]["moderate"];
-  sensSevere = doc["sensitivity"]["severe"];
-  Serial.printf("Config: heartbeatInterval=%lu, sensMinor=%.3f, sensModerate=%.3f, sensSevere=%.3f\n",
-                heartbeatInterval, sensMinor, sensModerate, sensSevere);
+  spectrum.begin(sampleRateHz);
+  profile.begin(sampleRateHz);
+  cpuBoost.begin();
+#if SERIAL_CAPTURE
+  serialCapture.begin(sampleRateHz, &sntpClock);
+#endif
+#if REALTIME_PROFILE
+  isrJitter.begin(sampleRateHz);
+#endif
+  applyConfig(initCfg);
 
-  // --- OTA Update Check ---
-  const char* serverFwVersion = doc["firmware_version"] | "";
-  const char* firmwareUrl     = doc["firmware_url"]     | "";
-  if (strlen(serverFwVersion) > 0 && strlen(firmwareUrl) > 0 &&
-      strcmp(serverFwVersion, FIRMWARE_VERSION) != 0) {
-    Serial.printf("OTA update available: %s -> %s\n", FIRMWARE_VERSION, serverFwVersion);
-    Serial.printf("Downloading from: %s\n", firmwareUrl);
-    WiFiClient otaClient;
-    t_httpUpdate_return ret = ESPhttpUpdate.update(otaClient, firmwareUrl);
-    switch (ret) {
-      case HTTP_UPDATE_FAILED:
-        Serial.printf("OTA FAILED (%d): %s\n",
-          ESPhttpUpdate.getLastError(),
-          ESPhttpUpdate.getLastErrorString().c_str());
-        break;
-      case HTTP_UPDATE_NO_UPDATES:
-        Serial.println("OTA: Server says no update.");
-        break;
-      default:
-        break;
-    }
-    Serial.println("Continuing with current firmware after OTA attempt.");
-  } else {
+  // --- OTA Update Check: only scheduled here, loop() runs it once sampling is up ---
+  if (initBoot.firmwareVersion[0] && initBoot.firmwareUrl[0] &&
+      strcmp(initBoot.firmwareVersion, FIRMWARE_VERSION) != 0) {
+    Serial.printf("OTA update available: %s -> %s\n", FIRMWARE_VERSION, initBoot.firmwareVersion);
+    otaUpdater.schedule(initBoot.firmwareUrl, initBoot.firmwareVersion, millis());
+  } else if (!initCached) {
     Serial.printf("Firmware up to date: %s\n", FIRMWARE_VERSION);
   }
-  delay(500);
 
-  // --- Setup MPU6050 ---
-  Wire.begin(SDA_PIN, SCL_PIN);
-  mpu.initialize();
-  mpu.setClockSource(MPU6050_CLOCK_PLL_XGYRO);
-  mpu.setFullScaleAccelRange(MPU6050_ACCEL_FS_2);
-  mpu.setDLPFMode(MPU6050_DLPF_BW_188);
-  if (!mpu.testConnection()) {
-    Serial.println("MPU6050 not found! Check wiring.");
-    digitalWrite(LED_PIN, HIGH);
-    while (1) delay(500);
+  // The server's rate and DLPF replace the boot ones; the bias doesn't
+  // depend on either
+  if (sampleRateHz != SAMPLE_RATE_HZ || dlpfMode != MPU6050_DLPF_BW_188) {
+    mpu.setAccelOnlyProfile(sampleRateHz, dlpfMode, MPU6050_ACCEL_FS_2, false);
+#if DUAL_SENSOR
+    mpu2.setAccelOnlyProfile(sampleRateHz, dlpfMode, MPU6050_ACCEL_FS_2, false);
+#endif
+  }
+  if (initBoot.recalibrate && biasRestored) {
+    bootTiming.mark(BOOT_CONFIG);
+    calibrateBias(bias, true);
+    bootTiming.mark(BOOT_CALIB);
+  }
+#if DUAL_SENSOR
+  if (dualSensor && !arena2.capacity()) {
+    dualSensor = false;
+    Serial.println("! No ring for the second MPU6050, single sensor");
   }
-  Serial.println("MPU6050 initialized.");
+#endif
+  calibration = bias;
+  thermalSavedAt = millis();
+  biasTracker.begin(sampleRateHz, biasTrackMs, BIAS_TRACK_STEP_LSB, BIAS_TRACK_DRIFT_LSB,
+                    meanX, meanY, meanZ);
+  if (biasTracker.enabled()) Serial.printf("Bias tracking: tau=%lus\n", biasTrackMs / 1000UL);
+  thermalBias.begin(bias.tempRaw, bias.slopes);
+  Serial.printf("Bias temperature slopes: (%+.2f, %+.2f, %+.2f) LSB/degC from %.1fC\n",
+                bias.slopes[0], bias.slopes[1], bias.slopes[2], tempCelsius(bias.tempRaw));
+  lastTempRaw = mpu.getTemperature();
+  applyBias();
+  gravityFromBias();
+#if DUAL_SENSOR
+  if (dualSensor) calibrateSecondary();
+#endif
 
-  // --- Software-Calibrate Bias ---
-  Serial.println("Keep sensor perfectly still - calibrating...");
-  double sumX=0, sumY=0, sumZ=0;
-  for (int i = 0; i < CALIB_SAMPLES; i++) {
+#if ACQ_MODE != ACQ_MODE_POLL
+  startFifo();
+#endif
+
+#if WAVEFORM_INJECT
+  File file = LittleFS.open(INJECT_FILE, "r");
+  if (file) {
+    if (injector.load(file, (int)file.size(), sampleRateHz)) {
+      injectFileAt = millis() + INJECT_FILE_DELAY_MS;
+      Serial.printf("Injection: %s loaded, plays in %lus\n", INJECT_FILE, INJECT_FILE_DELAY_MS / 1000UL);
+    } else {
+      Serial.printf("! Injection: %s is not an SWV1 body\n", INJECT_FILE);
+    }
+    file.close();
+  }
+#endif
+
+  // A cached config is confirmed by the first heartbeat, sent right away
+  lastConnectivityCheck = initCached ? millis() - pushHeartbeatInterval : millis();
+  startScheduler();
+  bootTiming.mark(BOOT_CONFIG);
+  bootTiming.done();
+  Serial.printf("Boot took %lums\n", millis());
+}
+
+// Bias restored from the store on a warm boot (see calibration_store.h), else
+// measured now. True if it was restored, so a server request to recalibrate
+// that only /api/init can bring still gets a fresh one.
+bool calibrateBias(CalibrationBias& bias, bool recalibrate) {
+  const char* biasSource = "";
+  if (!isColdBoot() && !recalibrate && loadCalibration(bias, FIRMWARE_VERSION, biasSource) &&
+      bias.mode == CALIB_MODE) {
+    meanX = bias.x;
+    meanY = bias.y;
+    meanZ = bias.z;
+#if CALIB_MODE == CALIB_MODE_HARDWARE
+    // The registers usually survive an ESP reset, but not an MPU brown-out
+    mpu.setXAccelOffset(bias.offsets[0]);
+    mpu.setYAccelOffset(bias.offsets[1]);
+    mpu.setZAccelOffset(bias.offsets[2]);
+    Serial.printf("Calibration restored from %s: accel offsets = (%d, %d, %d)\n",
+                  biasSource, bias.offsets[0], bias.offsets[1], bias.offsets[2]);
+#else
+    Serial.printf("Calibration restored from %s: mean raw = (%.1f, %.1f, %.1f)\n",
+                  biasSource, meanX, meanY, meanZ);
+#endif
+    return true;
+  }
+
+#if CALIB_MODE == CALIB_MODE_HARDWARE
+  Serial.println("Keep sensor perfectly still - programming accel offsets...");
+  CalibrationBias previous;
+  bool havePrevious = loadStoredCalibration(previous) && previous.mode == CALIB_MODE;
+  mpu.CalibrateAccel(6);   // ~600-700 PI iterations, converges from zero
+  Serial.println();
+  bias = {};
+  bias.offsets[0] = mpu.getXAccelOffset();
+  bias.offsets[1] = mpu.getYAccelOffset();
+  bias.offsets[2] = mpu.getZAccelOffset();
+  bias.mode = CALIB_MODE;
+  bias.tempRaw = mpu.getTemperature();
+  if (havePrevious) memcpy(bias.slopes, previous.slopes, sizeof(bias.slopes));
+  meanX = bias.x = 0;
+  meanY = bias.y = 0;
+  meanZ = bias.z = ACCEL_1G_LSB;
+  Serial.printf("Calibration complete: accel offsets = (%d, %d, %d)\n",
+                bias.offsets[0], bias.offsets[1], bias.offsets[2]);
+  if (havePrevious) {
+    Serial.printf("Drift since last calibration: (%+d, %+d, %+d) offset LSB\n",
+                  bias.offsets[0] - previous.offsets[0], bias.offsets[1] - previous.offsets[1],
+                  bias.offsets[2] - previous.offsets[2]);
+  }
+  saveCalibration(bias, FIRMWARE_VERSION);
+#else
+  Serial.println(recalibrate ? "Server requested recalibration - keep sensor perfectly still..."
+                             : "Keep sensor perfectly still - calibrating...");
+  // Until the mean is steady, with moving blocks thrown out (bias_estimator.h)
+  BiasEstimator estimator;
+  estimator.begin();
+  unsigned long calibStart = millis();
+  CalibState done;
+  do {
     int16_t rx, ry, rz;
     mpu.getAcceleration(&rx, &ry, &rz);
-    sumX += rx; sumY += ry; sumZ += rz;
+    done = estimator.add(rx, ry, rz);
+    // Keep the Wi-Fi fallback moving: a stale cached AP is only given up in poll()
+    if (estimator.reads() % CALIB_BLOCK_SAMPLES == 0) wifiLink.poll(millis());
     delay(2);
+  } while (done == CALIB_RUNNING);
+  meanX = estimator.mean(0);
+  meanY = estimator.mean(1);
+  meanZ = estimator.mean(2);
+  Serial.printf("Calibration %s: mean raw = (%.1f, %.1f, %.1f), +/-%.1f LSB from %d of %d reads in %lums\n",
+                done == CALIB_CONVERGED ? "complete" : "capped", meanX, meanY, meanZ,
+                estimator.standardError(), estimator.accepted(), estimator.reads(), millis() - calibStart);
+  if (estimator.rejected()) {
+    Serial.printf("! Calibration: %d moving blocks rejected, %d restarts\n",
+                  estimator.rejected(), estimator.restarts());
+  }
+  CalibrationBias previous;
+  bool havePrevious = loadStoredCalibration(previous) && previous.mode == CALIB_MODE;
+  if (havePrevious) {
+    Serial.printf("Drift since last calibration: (%+.1f, %+.1f, %+.1f) LSB\n",
+                  meanX - previous.x, meanY - previous.y, meanZ - previous.z);
   }
-  meanX = sumX / CALIB_SAMPLES;
-  meanY = sumY / CALIB_SAMPLES;
-  meanZ = sumZ / CALIB_SAMPLES;
-  Serial.printf("Calibration complete: mean raw = (%.1f, %.1f, %.1f)\n",
-                meanX, meanY, meanZ);
+  bias = {};
+  bias.x = meanX;
+  bias.y = meanY;
+  bias.z = meanZ;
+  bias.mode = CALIB_MODE;
+  bias.tempRaw = mpu.getTemperature();
+  // The slopes belong to the chip, not to this calibration
+  if (havePrevious) memcpy(bias.slopes, previous.slopes, sizeof(bias.slopes));
+  saveCalibration(bias, FIRMWARE_VERSION);
+#endif
   delay(500);
-
-  lastConnectivityCheck = millis();
+  return false;
 }
 
 void loop() {
+  uint32_t loopStartUs = micros();
+  uint32_t busStartUs = busMicros();
+  scheduler.run(millis());
+  endLoopProfile(loopStartUs, busStartUs);
+#if MODEM_SLEEP
+  if (sleepBetweenDrains()) return;
+#endif
+#if ACQ_MODE == ACQ_MODE_FIFO
+  delay(5);
+#elif ACQ_MODE == ACQ_MODE_MOTION
+  delay(motionIdle ? 20 : 5);   // at rest the core is free for WiFi or modem-sleep
+#elif ACQ_MODE == ACQ_MODE_POLL
+  delay(1);   // taskAcquire() is paced by its period
+#endif
+}
+
+#if MODEM_SLEEP
+// An idle node sleeps until the FIFO needs draining or a timed task is due
+bool sleepBetweenDrains() {
   unsigned long now = millis();
+  bool idle = !detector.capturing() && !uploader.busy() && !wifiLostAt;
+#if ACQ_MODE == ACQ_MODE_MOTION
+  idle = idle && motionIdle;
+#endif
+  uint32_t ms = modemSleep.span(fifoRateHz, idle, scheduler.untilDue(now, MODEM_SLEEP_LISTEN * MODEM_SLEEP_DTIM_MS));
+  if (ms == 0) return false;
+  modemSleep.sleep(ms);
+  return true;
+}
+#endif
+
+// Register the loop's tasks, acquisition first (it also runs between the others)
+void startScheduler() {
+#if ACQ_MODE == ACQ_MODE_POLL
+  scheduler.add("acquire", taskAcquire, max(1, 1000 / sampleRateHz), TASK_ACQUIRE_BUDGET_US);
+#else
+  scheduler.add("acquire", taskAcquire, 0, TASK_ACQUIRE_BUDGET_US);
+#endif
+  scheduler.add("wifi",      taskWifi,      0,              TASK_WIFI_BUDGET_US);
+  scheduler.add("push",      taskPush,      0,              TASK_PUSH_BUDGET_US);
+#if MQTT_LINK
+  scheduler.add("mqtt",      taskMqtt,      0,              TASK_MQTT_BUDGET_US);
+#endif
+#if SESSION_LINK
+  scheduler.add("session",   taskSession,   0,              TASK_SESSION_BUDGET_US);
+#endif
+  scheduler.add("ota",       taskOta,       1000,           0);   // blocks by design
+  scheduler.add("heartbeat", taskHeartbeat, 1000,           TASK_HEARTBEAT_BUDGET_US);
+  scheduler.add("upload",    taskUpload,    0,              TASK_UPLOAD_BUDGET_US);
+  scheduler.add("telemetry", taskTelemetry, HEAP_SAMPLE_MS, TASK_TELEMETRY_BUDGET_US);
+  scheduler.add("thermal",   taskThermal,   THERMAL_WINDOW_MS, TASK_THERMAL_BUDGET_US);
+  if (blackBox.enabled()) scheduler.add("blackbox", taskBlackBox, 1000, TASK_BLACKBOX_BUDGET_US);
+#if PEER_LINK
+  scheduler.add("peers",     taskPeers,     100,            TASK_PEERS_BUDGET_US);
+#endif
+#if DMP_GRAVITY
+  scheduler.add("gravity",   taskGravity,   1000,           0);   // blocks by design
+#endif
+#if WAVEFORM_INJECT
+  scheduler.add("inject",    taskInject,    1000,           0);
+#endif
+  scheduler.add("local",     taskLocalHttp, 0,              TASK_LOCAL_BUDGET_US);   // last: spare time only
+}
+
+void taskAcquire(unsigned long now) {
+#if ACQ_MODE == ACQ_MODE_DRDY
+  // --- Consume only when the ISR has flagged new samples; otherwise return
+  //     straight to the core so WiFi gets the CPU between samples ---
+  if (readyRing.pending()) drainFifo();
+#elif ACQ_MODE == ACQ_MODE_FIFO
+  // --- Drain every sample the sensor clocked out since last pass ---
+  drainFifo();
+#elif ACQ_MODE == ACQ_MODE_MOTION
+  // --- Full rate on a motion interrupt or while capturing; otherwise the
+  //     idle-rate ring is read once per MOTION_IDLE_DRAIN_MS ---
+  unsigned long at = motionAt;
+  if (at) {
+    motionAt = 0;
+    if (motionIdle) {
+      motionWakes++;
+      Serial.printf("Motion wake #%lu\n", motionWakes);
+    }
+    fullRateUntil = now + MOTION_HOLD_MS;
+    setMotionIdle(false);
+  }
+  if (detector.capturing()) fullRateUntil = now + MOTION_HOLD_MS;
+  if (!motionIdle) {
+    drainFifo();
+    if ((long)(now - fullRateUntil) >= 0) setMotionIdle(true);
+  } else if (now - idleDrainAt >= MOTION_IDLE_DRAIN_MS) {
+    idleDrainAt = now;
+    drainFifo();
+  }
+#else
+  // --- Read one sample per period; the die temperature rides along in the
+  //     same 8-byte burst (a failed read is counted in the I2C stats) ---
+  MPU6050_AccelTemp s;
+  if (!mpu.getAccelTemp(&s)) return;
+  lastTempRaw = s.temp;
+  processSample(now, s.x, s.y, s.z);
+#endif
+  applyAutoRange();
+}
+
+void taskTelemetry(unsigned long now) {
+  heapMonitor.poll(now);
+}
+
+// --- Local diagnostics: spare time only, held while capturing or uploading ---
+void taskLocalHttp(unsigned long now) {
+  localHttp.poll(now, detector.capturing() || uploader.busy());
+}
+
+// GET /status on the local server, printed straight onto the socket
+void writeLocalStatus(Print& out) {
+  out.printf("{\"id\":\"%s\",\"firmware\":\"%s\",\"uptime_ms\":%lu,\"sample_rate_hz\":%d,\"capturing\":%s,",
+             deviceId, FIRMWARE_VERSION, millis(), sampleRateHz, detector.capturing() ? "true" : "false");
+  out.printf("\"bias_lsb\":[%.1f,%.1f,%.1f],\"scale\":%d,", biasInUse(0), biasInUse(1), biasInUse(2), ACCEL_1G_LSB);
+  out.printf("\"thresholds_g\":{\"minor\":%.4f,\"moderate\":%.4f,\"severe\":%.4f},",
+             sensMinor, sensModerate, sensSevere);
+  out.printf("\"thresholds_lsb\":[%ld,%ld,%ld],", (long)sensMinorLsb, (long)sensModerateLsb, (long)sensSevereLsb);
+  out.printf("\"heap\":{\"free\":%lu,\"max_block\":%lu,\"frag_pct\":%u,\"min_free\":%lu},",
+             (unsigned long)heapMonitor.freeHeap(), (unsigned long)heapMonitor.maxBlock(),
+             heapMonitor.fragmentation(), (unsigned long)heapMonitor.minFree());
+  out.printf("\"wifi\":{\"rssi\":%d,\"ip\":\"%s\"},\"journal\":%d,\"live_dropped\":%lu,",
+             (int)WiFi.RSSI(), WiFi.localIP().toString().c_str(), journal.count(),
+             (unsigned long)localHttp.dropped());
+  // Buckets as in the heartbeat's prof_<phase>, see loop_profile.h
+  out.print("\"profile\":{");
+  for (int p = 0; p < PHASE_COUNT; p++) {
+    const PhaseStats& ph = profile.phase((ProfilePhase)p);
+    out.printf("%s\"%s\":{\"n\":%lu,\"total_us\":%lu,\"max_us\":%lu,\"buckets\":[", p ? "," : "",
+               LoopProfile::phaseName((ProfilePhase)p), (unsigned long)ph.n, (unsigned long)ph.totalUs,
+               (unsigned long)ph.maxUs);
+    for (int b = 0; b < PROFILE_BUCKETS; b++) out.printf("%s%u", b ? "," : "", ph.buckets[b]);
+    out.print("]}");
+  }
+  out.print("}}\n");
+}
+
+// --- Black box: follow the wall clock, write the block waiting for flash ---
+void taskBlackBox(unsigned long now) {
+  if (sntpClock.synced()) blackBox.setClock(sntpClock.epochUs(now) / 1000 - (int64_t)now);
+  else blackBox.setClock(clockOffsetMs);
+  blackBox.flush();
+}
+
+// --- Die temperature: close a thermal-fit window and move the bias to the
+//     new temperature's table entry (held still while capturing) ---
+void taskThermal(unsigned long now) {
+#if ACQ_MODE != ACQ_MODE_POLL
+  lastTempRaw = mpu.getTemperature();   // not in the FIFO; poll mode reads it per sample
+#endif
+  if (thermalBias.closeWindow(lastTempRaw, THERMAL_WINDOW_MS * sampleRateHz / 1000UL)) {
+    bool moved = false;
+    for (int i = 0; i < 3; i++) moved |= fabsf(thermalBias.slope(i) - calibration.slopes[i]) >= THERMAL_SAVE_DELTA;
+    if (moved && now - thermalSavedAt >= THERMAL_SAVE_MS) {
+      for (int i = 0; i < 3; i++) calibration.slopes[i] = thermalBias.slope(i);
+      saveCalibration(calibration, FIRMWARE_VERSION);
+      thermalSavedAt = now;
+      Serial.printf("Bias temperature slopes saved: (%+.2f, %+.2f, %+.2f) LSB/degC\n",
+                    calibration.slopes[0], calibration.slopes[1], calibration.slopes[2]);
+    }
+  }
+  if (!detector.capturing()) applyBias();
+}
+
+#if DMP_GRAVITY
+// --- True vertical: one DMP gravity read once the node is up and one per
+//     DMP_GRAVITY_REFRESH_MS, only for the gravity metrics and only while
+//     nothing would notice the pause ---
+void taskGravity(unsigned long now) {
+  static unsigned long readAt = 0;   // 0 = not read yet
+  if (!detector.usesGravity() || detector.capturing() || rangeShift || wantRangeShift) return;
+  if (readAt && now - readAt < DMP_GRAVITY_REFRESH_MS) return;
+#if WAVEFORM_INJECT
+  if (injector.active()) return;
+#endif
+  refreshGravity();
+  readAt = millis();
+}
 
-  // --- Wi-Fi watchdog ---
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("Wi-Fi lost - rebooting...");
+// Load the DMP, take its gravity, and put the chip back as setup() left it.
+// The FIFO is drained first and the pause is logged as a gap.
+void refreshGravity() {
+#if ACQ_MODE != ACQ_MODE_POLL
+  drainFifo();
+  unsigned long nextMs = fifoBaseMs + (fifoSampleIndex * 1000UL) / fifoRateHz;
+#if ACQ_MODE == ACQ_MODE_DRDY || ACQ_MODE == ACQ_MODE_MOTION
+  detachInterrupt(digitalPinToInterrupt(INT_PIN));   // the DMP drives INT too
+#endif
+#endif
+  int16_t up[3];
+  bool ok = readDmpGravity(up);
+  restoreSensorProfile();
+#if ACQ_MODE != ACQ_MODE_POLL
+  startFifo();
+  // Back on the old sample grid, so the pause counts as lost samples
+  fifoBaseMs = nextMs;
+  fifoSampleIndex = 0;
+  restartFifoAfterLoss("held by DMP gravity");
+#endif
+  if (!ok) {
+    Serial.println("! DMP gravity read failed, keeping the previous vertical");
+    return;
+  }
+  detector.setGravity(up);
+  Serial.printf("DMP gravity: (%+.3f, %+.3f, %+.3f)\n", up[0] / 16384.0f, up[1] / 16384.0f, up[2] / 16384.0f);
+}
+#endif
+
+// The calibrated bias is the at-rest reading, so it points up too; it is
+// the vertical until (or without) a DMP read. Hardware offsets null it to
+// (0, 0, 1g), which leaves the sensor's Z.
+void gravityFromBias() {
+  float norm = sqrtf(meanX * meanX + meanY * meanY + meanZ * meanZ);
+  if (norm < ACCEL_1G_LSB / 2) return;
+  const int16_t up[3] = { (int16_t)lroundf(meanX / norm * 16384.0f), (int16_t)lroundf(meanY / norm * 16384.0f),
+                          (int16_t)lroundf(meanZ / norm * 16384.0f) };
+  detector.setGravity(up);
+}
+
+// The chip as setup() configured it, after something reset it; the FIFO
+// and interrupts are startFifo()'s
+void restoreSensorProfile() {
+  mpu.invalidateShadowCache();
+  mpu.setAccelOnlyProfile(sampleRateHz, dlpfMode, MPU6050_ACCEL_FS_2, false);
+#if CALIB_MODE == CALIB_MODE_HARDWARE
+  mpu.setXAccelOffset(calibration.offsets[0]);
+  mpu.setYAccelOffset(calibration.offsets[1]);
+  mpu.setZAccelOffset(calibration.offsets[2]);
+#endif
+}
+
+// --- Local coincidence: once PEER_QUORUM peers have triggered with the
+//     running capture, flash the LED for LOCAL_ALARM_MS, then put it back ---
+void taskPeers(unsigned long now) {
+  static uint8_t ledBefore = HIGH;
+  if (!localAlarmUntil && detector.capturing() &&
+      peerLink.peersNear(capturedEventTime, PEER_WINDOW_MS) >= PEER_QUORUM) {
+    Serial.println("!! Local alarm: peers triggered too");
+    ledBefore = digitalRead(LED_PIN);
+    localAlarmUntil = (now + LOCAL_ALARM_MS) | 1;
+  }
+  if (!localAlarmUntil) return;
+  if ((long)(now - localAlarmUntil) >= 0) {
+    localAlarmUntil = 0;
+    digitalWrite(LED_PIN, ledBefore);
+    return;
+  }
+  digitalWrite(LED_PIN, !digitalRead(LED_PIN));
+}
+
+// --- Wi-Fi watchdog: WifiLink reconnects in place (cached AP first, then
+//     scans); events captured meanwhile go to the journal ---
+void taskWifi(unsigned long now) {
+  if (!wifiLink.poll(now)) {
+    if (!wifiLostAt) {
+      wifiLostAt = now | 1;
+      Serial.println("! Wi-Fi lost, journaling events until it's back");
+      digitalWrite(LED_PIN, HIGH);
+    }
+  }
+  else if (wifiLostAt) {
+    Serial.printf("Wi-Fi back after %lums\n", now - wifiLostAt);
+    digitalWrite(LED_PIN, LOW);
+    pushChannel.stop();   // its socket died with the link; re-poll right away
+    mqttLink.stop();      // likewise, reconnect right away
+    sessionLink.stop();
+    wifiLostAt = 0;
+    replayAt = now;
+    replayBackoffMs = REPLAY_BACKOFF_MIN_MS;
+  }
+}
+
+// --- Server push: a reinit or config change as soon as it's saved ---
+void taskPush(unsigned long now) {
+  if (detector.capturing() || wifiLostAt) return;
+  if (mqttLink.connected() || sessionLink.carries(SESSION_CAP_COMMAND)) {
+    // The broker's cmd and config topics carry the same, as does the session
+    if (pushChannel.live()) pushChannel.stop();
+    return;
+  }
+  handleServerCode(pushChannel.poll(now, configGen));
+}
+
+// A reinit, stale config, pull or injection the push channel, the broker or
+// the session brought (the codes a heartbeat answers with)
+void handleServerCode(int code) {
+  if (code == 205) {
+    Serial.println("Reinit pushed - rebooting...");
+    clearInitCache();
     digitalWrite(LED_PIN, HIGH);
     ESP.restart();
   }
+  else if (code == HTTP_CODE_CONFIG_CHANGED) {
+    Serial.println("Config change pushed - reloading");
+    reloadConfig();
+  }
+  else if (code == HTTP_CODE_PULL_PENDING) {
+    servePull();
+  }
+#if WAVEFORM_INJECT
+  else if (code == HTTP_CODE_INJECT_PENDING) {
+    serveInject();
+  }
+#endif
+}
+
+// --- MQTT: keep the broker link going; act on a retained config or a
+//     command from it between captures ---
+void taskMqtt(unsigned long now) {
+  if (wifiLostAt) return;
+  mqttLink.poll(now);
+  MqttInbound got = mqttLink.pending();
+  if (got == MQTT_NOTHING || detector.capturing()) return;
+  handleLinkMessage(got == MQTT_CONFIG, mqttLink.text(), now);
+  mqttLink.consume();
+}
 
-  // --- Connectivity check (skip during waveform capture for smooth sampling) ---
-  if (!waveCapturing && now - lastConnectivityCheck >= heartbeatInterval) {
-    lastConnectivityCheck = now;
-    HTTPClient http;
-    WiFiClient client;
+// --- Device session: likewise, for its CONFIG and COMMAND frames ---
+void taskSession(unsigned long now) {
+  if (wifiLostAt) return;
+  sessionLink.poll(now);
+  SessionInbound got = sessionLink.pending();
+  if (got == SESSION_NOTHING || detector.capturing()) return;
+  handleLinkMessage(got == SESSION_IN_CONFIG, sessionLink.text(), now);
+  sessionLink.consume();
+}
+
+// An /api/init body, or a command ("205", "policy <value>", ...), off the
+// broker or the session
+void handleLinkMessage(bool isConfig, const char* text, unsigned long now) {
+  if (isConfig) {
+    StaticJsonDocument<512> doc;
+    DeserializationError err = deserializeJson(doc, text, DeserializationOption::Filter(initFilter()));
+    if (err) {
+      Serial.printf("! Pushed config: %s\n", err.c_str());
+    } else if ((doc["config_gen"] | 0UL) != configGen) {
+      // Each connect brings the current one back; only a new generation counts
+      InitConfig cfg = serverDefaults();
+      InitBoot boot;
+      initFromJson(doc, cfg, boot);
+      Serial.printf("Config generation %lu published - applying\n", (unsigned long)cfg.gen);
+      applyReload(cfg, boot);
+    }
+  }
+  else if (strncmp(text, "policy ", 7) == 0) {
+    uploadPolicy.update(text + 7, now);
+  }
+  else {
+    handleServerCode(atoi(text));
+  }
+}
 
-    String healthUrl = String(ROOT_URL) + "?id=" + deviceId;
-    Serial.printf("Checking server connectivity to %s ... ", healthUrl.c_str());
+// --- Deferred OTA: between captures, once queued uploads are out ---
+void taskOta(unsigned long now) {
+  if (!otaUpdater.due(now) || detector.capturing() || wifiLostAt || uploader.busy()) return;
+  serverLink.stop();
+  pushChannel.stop();
+  mqttLink.stop();
+  sessionLink.stop();
+  otaUpdater.run(FIRMWARE_VERSION);   // only returns if nothing was flashed
+#if ACQ_MODE != ACQ_MODE_POLL
+  restartFifoAfterLoss("held by OTA");
+#endif
+  lastConnectivityCheck = 0;          // report the outcome right away
+}
 
-    http.begin(client, healthUrl);
-    int code = http.GET();
-    http.end();
+// --- Connectivity check (skip during waveform capture for smooth sampling);
+//     stretched while the push channel or the broker carries reinit and
+//     config ---
+void taskHeartbeat(unsigned long now) {
+  bool pushed = pushChannel.live() || mqttLink.connected() || sessionLink.carries(SESSION_CAP_COMMAND);
+  unsigned long interval = pushed ? pushHeartbeatInterval : heartbeatInterval;
+  if (detector.capturing() || wifiLostAt || now - lastConnectivityCheck < interval) return;
+  lastConnectivityCheck = now;
 
-    if (code == HTTP_CODE_OK) {
-      Serial.println("OK");
-      digitalWrite(LED_PIN, LOW);
+  Serial.printf("Checking server connectivity to %s ... ", ROOT_URL);
+  int traceSeconds, stormMinutes;
+  uint32_t evictions;
+  buildHeartbeatUrl(now, traceSeconds, stormMinutes, evictions);
+
+  uint32_t httpStartUs = micros();
+  int code;
+  if (sessionLink.writable() && sessionLink.carries(SESSION_CAP_HEARTBEAT)) {
+    // The server answers on the session with what it would have over HTTP
+    const char* query = strchr(heartbeatUrl.c_str(), '?') + 1;
+    code = sessionLink.heartbeat(query, strlen(query));
+  } else if (mqttLink.writable()) {
+    // The broker has it once it acks; what the server makes of it comes
+    // back on cmd and config
+    const char* query = strchr(heartbeatUrl.c_str(), '?') + 1;
+    code = mqttLink.publishWait("heartbeat", (const uint8_t*)query, strlen(query))
+               ? HTTP_CODE_OK : HTTPC_ERROR_CONNECTION_LOST;
+  } else {
+    code = serverLink.getStatus(heartbeatUrl.c_str());
+  }
+  profile.record(PHASE_HTTP, httpStartUs);
+
+  if (code == HTTP_CODE_OK || code == HTTP_CODE_CONFIG_CHANGED || code == HTTP_CODE_PULL_PENDING ||
+      code == HTTP_CODE_INJECT_PENDING) {
+    Serial.printf("OK (%ds trace)\n", traceSeconds);
+#if WAVEFORM_INJECT
+    injector.reported();
+#endif
+    helicorder.consume(traceSeconds);
+    storm.consume(stormMinutes);
+    journal.evictionsReported(evictions);
+    otaUpdater.reported();
+    bootTiming.reported();
+    profile.reset();
+    cpuBoost.reset();
+#if MODEM_SLEEP
+    modemSleep.reset(millis());
+#endif
+#if REALTIME_PROFILE
+    isrJitter.reset();
+#endif
+    scheduler.resetStats();
+    serverLink.printStats(Serial);
+    Serial.printf("Heap: %u free (low %u), largest block %u, %u%% fragmented\n",
+                  (unsigned)heapMonitor.freeHeap(), (unsigned)heapMonitor.minFree(),
+                  (unsigned)heapMonitor.maxBlock(), (unsigned)heapMonitor.fragmentation());
+    heapMonitor.resetWindow();
+    if (biasTracker.atLimit()) {
+      Serial.println("! Bias drift hit the tracking limit - sensor moved? Recalibrate from Admin");
     }
-    else if (code == 205) {
-      Serial.println("Received 205 - rebooting...");
-      digitalWrite(LED_PIN, HIGH);
-      ESP.restart();
+    digitalWrite(LED_PIN, LOW);
+    if (journal.count() > 0) {
+      // Server is back; don't sit out the rest of the backoff
+      replayAt = now;
+      replayBackoffMs = REPLAY_BACKOFF_MIN_MS;
     }
-    else {
-      Serial.printf("FAILED (HTTP %d) - rebooting...\n", code);
-      digitalWrite(LED_PIN, HIGH);
-      ESP.restart();
+    if (code == HTTP_CODE_CONFIG_CHANGED) {
+      Serial.println("Config changed - reloading");
+      reloadConfig();
+    }
+    else if (code == HTTP_CODE_PULL_PENDING) {
+      servePull();
+    }
+#if WAVEFORM_INJECT
+    else if (code == HTTP_CODE_INJECT_PENDING) {
+      serveInject();
+    }
+#endif
+  }
+  else if (code == 205) {
+    Serial.println("Received 205 - rebooting...");
+    clearInitCache();
+    digitalWrite(LED_PIN, HIGH);
+    ESP.restart();
+  }
+  else {
+    // Keep sampling; events are journaled until the server answers again
+    Serial.printf("FAILED (HTTP %d), %d events journaled\n", code, journal.count());
+    digitalWrite(LED_PIN, HIGH);
+  }
+}
+
+void taskUpload(unsigned long now) {
+  // --- Push any queued event upload forward by one TCP segment ---
+  if (uploader.busy()) {
+    uint32_t httpStartUs = micros();
+    int uploadCode;
+    bool done;
+    {
+      CpuBoostScope boost(BOOST_UPLOAD);
+      done = uploader.poll(uploadCode);
+    }
+    if (done) handleUploadResult(uploadCode);
+    profile.record(PHASE_HTTP, httpStartUs);
+  }
+
+  // --- Replay journaled events one at a time, behind any live upload ---
+  if (!detector.capturing() && !wifiLostAt && !uploader.busy() && journal.count() > 0 &&
+      (long)(now - replayAt) >= 0) {
+    uint32_t httpStartUs = micros();
+    replayJournal();
+    profile.record(PHASE_HTTP, httpStartUs);
+  }
+}
+
+// Close one loop() pass: total time so far, and the bus share of it
+void endLoopProfile(uint32_t loopStartUs, uint32_t busStartUs) {
+  uint32_t busUs = busMicros() - busStartUs;
+  if (busUs) profile.recordUs(PHASE_I2C, busUs);
+  profile.record(PHASE_LOOP, loopStartUs);
+}
+
+RT_IRAM void processSample(unsigned long now, int16_t rawX, int16_t rawY, int16_t rawZ) {
+  HEAP_CHECK_BEGIN();
+  bool finished = false;   // finishCapture() queues the upload body, legitimately
+  bool noticed = false;    // so does startCapture() with the trigger notice
+  // --- To +/-2g LSB if auto-ranging raised the range (the arena keeps the
+  //     sample as read), then de-bias (integer LSB; no software float on the hot path) ---
+  uint8_t shift = rangeSwitchCount ? rangeShiftAt(arena.written()) : 0;
+#if WAVEFORM_INJECT
+  // --- Injection: the sensor's sample is dropped for the next stored one,
+  //     put on the live bias and read at the current range ---
+  if (injector.active()) injector.next(shift, biasLsbX, biasLsbY, biasLsbZ, rawX, rawY, rawZ);
+#endif
+  int32_t ax = (int32_t)rawX * (1 << shift);
+  int32_t ay = (int32_t)rawY * (1 << shift);
+  int32_t az = (int32_t)rawZ * (1 << shift);
+  int32_t dx = ax - biasLsbX;
+  int32_t dy = ay - biasLsbY;
+  int32_t dz = az - biasLsbZ;
+
+  profile.sample(now);
+
+#if SERIAL_CAPTURE
+  // --- Binary capture: every sample, +/-2g LSB not de-biased (as stream chunks keep them) ---
+  uint32_t serialStartUs = micros();
+  serialCapture.add(now, (int16_t)constrain(ax, -32768, 32767), (int16_t)constrain(ay, -32768, 32767),
+                    (int16_t)constrain(az, -32768, 32767));
+  uint32_t detectStartUs = micros();
+  profile.recordUs(PHASE_SERIAL, detectStartUs - serialStartUs);
+#elif LOG_LEVEL >= LOG_LEVEL_DEBUG
+  // --- Serial plotter output (de-biased LSB, 16384 = 1g) ---
+  uint32_t serialStartUs = micros();
+  Serial.print(dy); Serial.print(','); Serial.println(dz);
+  uint32_t detectStartUs = micros();
+  profile.recordUs(PHASE_SERIAL, detectStartUs - serialStartUs);
+#else
+  uint32_t detectStartUs = micros();
+#endif
+
+  // --- Follow slow drift while idle and well below the minor threshold; the
+  //     tracker sees the signal with the temperature correction taken out.
+  //     Not on a raised range: its LSB are too coarse for either ---
+  if (!detector.capturing() && !shift && max(abs(dx), max(abs(dy), abs(dz))) < sensMinorLsb / 2) {
+    thermalBias.addQuiet(rawX, rawY, rawZ);
+    if (biasTracker.enabled()) {
+      int32_t cx = thermalBias.correction(0), cy = thermalBias.correction(1), cz = thermalBias.correction(2);
+      biasTracker.update(rawX - cx, rawY - cy, rawZ - cz);
+      biasLsbX = biasTracker.lsb(0) + cx;
+      biasLsbY = biasTracker.lsb(1) + cy;
+      biasLsbZ = biasTracker.lsb(2) + cz;
+    }
+  }
+
+  // --- The arena takes every sample, raw; the detector sees it de-biased
+  //     and hands it back band-limited for the helicorder ---
+  arena.push(rawX, rawY, rawZ);
+  DetectResult detected = detector.process(arena.written() - 1, arena.count(), dx, dy, dz);
+  helicorder.add(now, dx, dy, dz);
+  // Unfiltered, like the spectrum sees them
+  int32_t ux = ax - biasLsbX, uy = ay - biasLsbY, uz = az - biasLsbZ;
+  blackBox.add(now, ux, uy, uz);
+  localHttp.add(now, ux, uy, uz);
+  newestSampleMs = now;
+  // The live datagram keeps it, until sent, in +/-2g LSB clipped to int16
+  bool streamed = udpStream.add(now, (int16_t)constrain(ax, -32768, 32767),
+                                (int16_t)constrain(ay, -32768, 32767),
+                                (int16_t)constrain(az, -32768, 32767));
+  if (detected == DETECT_STARTED) {
+    startCapture(now);
+    noticed = triggerNotice.enabled();
+#if WAVEFORM_INJECT
+    injector.triggered();
+#endif
+  } else if (detected >= DETECT_CAPTURING) {
+    // Post-event samples: the spectrum takes them unfiltered
+    if (spectrumEnabled) spectrum.add(ax - biasLsbX, ay - biasLsbY, az - biasLsbZ);
+    if (detected == DETECT_RETRIGGERED) {
+      const DetectedCapture& c = detector.capture();
+      Serial.printf(">> Retrigger #%d at +%lums\n", c.retriggerCount,
+                    (unsigned long)c.postCount * 1000UL / sampleRateHz);
+    }
+    if (detected == DETECT_FINISHED) {
+      // Done capturing - hand off for upload; the detector is already idle
+      finishCapture();
+      finished = true;
     }
   }
 
-  // --- Read & de-bias raw accel ---
-  int16_t rawX, rawY, rawZ;
-  mpu.getAcceleration(&rawX, &rawY, &rawZ);
-  float ax = (rawX - meanX) / SCALE;
-  float ay = (rawY - meanY) / SCALE;
-  float az = (rawZ - meanZ) / SCALE;
+  // --- Auto-range: up on a severe detection inside a capture, down again
+  //     after a quiet spell outside one; taskAcquire() does the switch ---
+  if (AUTO_RANGE_FS != MPU6050_ACCEL_FS_2) {
+    if (detector.capturing()) {
+      if (detector.reached(LEVEL_SEVERE)) wantRangeShift = AUTO_RANGE_FS;
+      rangeQuietSamples = 0;
+    } else if (wantRangeShift) {
+      rangeQuietSamples = !detector.reached(LEVEL_MINOR) ? rangeQuietSamples + 1 : 0;
+      if (rangeQuietSamples >= AUTO_RANGE_IDLE_MS * sampleRateHz / 1000UL) wantRangeShift = 0;
+    }
+  }
+  profile.record(PHASE_DETECT, detectStartUs);
+  HEAP_CHECK_END_UNLESS(finished || streamed || noticed, "processSample");
+}
 
-  // --- Serial plotter output ---
-  Serial.print(ay, 3); Serial.print(','); Serial.println(az, 3);
+void allocateCaptureBuffers() {
+  preSamples  = (int)(preMs  * sampleRateHz / 1000UL);
+  postSamples = (int)(postMs * sampleRateHz / 1000UL);
+  if (postSamples < 1) postSamples = 1;
+  maxPostSamples = max(postSamples, (int)(maxPostMs * sampleRateHz / 1000UL));
+  if (preSamples + maxPostSamples > MAX_CAPTURE_SAMPLES) {
+    // Keep the requested ratios, shrink all three to fit the heap budget
+    float k = (float)MAX_CAPTURE_SAMPLES / (preSamples + maxPostSamples);
+    preSamples     = (int)(preSamples  * k);
+    postSamples    = max(1, (int)(postSamples * k));
+    maxPostSamples = max(postSamples, (int)(maxPostSamples * k));
+    Serial.printf("! Capture window clamped to %d pre + %d..%d post samples\n",
+                  preSamples, postSamples, maxPostSamples);
+  }
+  detector.setWindow(preSamples, postSamples, maxPostSamples, RETRIGGER_QUIET_MS * sampleRateHz / 1000);
+  // Longest ring the spare heap allows, never shorter than the capture window
+  int window = preSamples + maxPostSamples;
+  uint32_t freeHeap = ESP.getFreeHeap();
+  uint32_t spare = min(freeHeap > ARENA_HEAP_RESERVE ? freeHeap - ARENA_HEAP_RESERVE : 0U,
+                       ESP.getMaxFreeBlockSize());
+#if DUAL_SENSOR
+  spare /= 2;   // one ring per sensor
+#endif
+  int ring = constrain((int)(spare / sizeof(WaveSample)), window, max(window, ARENA_MAX_SAMPLES));
+  if (!arena.begin(ring) && !arena.begin(window)) {
+    Serial.println("Capture buffer allocation failed, rebooting...");
+    ESP.restart();
+  }
+#if DUAL_SENSOR
+  // Without its ring the second sensor stays off (setup() checks)
+  if (!arena2.begin(arena.capacity())) Serial.println("! Second sensor arena allocation failed");
+#endif
+  Serial.printf("Capture arena: %d pre + %d..%d post samples, %.1fs ring (%u bytes), free heap %u\n",
+                preSamples, postSamples, maxPostSamples, (float)arena.capacity() / sampleRateHz,
+                (unsigned)arena.bytes(), ESP.getFreeHeap());
+}
 
-  // --- Compute delta-g ---
-  float dev = max(fabs(ax), max(fabs(ay), fabs(az)));
+// The JSON /api/init keys initFromJson() reads (older servers, MQTT pushes); the
+// parse drops everything else, so new server fields cost old firmware no RAM.
+// Objects and arrays listed here are kept whole.
+static const char* const INIT_KEYS[] = {
+  "recalibrate", "server_time_ms", "ntp_server", "sample_rate_hz", "dlpf",
+  "pre_ms", "post_ms", "max_post_ms", "firmware_version", "firmware_url",
+  "heartbeat_interval", "push_heartbeat_interval", "config_gen", "sensitivity",
+  "trigger_mode", "sta_ms", "lta_ms", "sta_lta_on", "sta_lta_off", "bias_track_s",
+  "hp_hz", "lp_hz", "upload_formats", "spectrum", "stream_mode", "stream_port",
+  "stream_hz", "detect_metric", "local_http", "mqtt", "session",
+};
 
-  // --- Waveform capture state machine ---
-  if (!waveCapturing) {
-    // IDLE: write to pre-event ring buffer
-    preBuffer[preHead] = { now, ax, ay, az };
-    preHead = (preHead + 1) % PRE_SAMPLES;
-    if (preCount < PRE_SAMPLES) preCount++;
+// Built once on first use and kept for config reloads
+const JsonDocument& initFilter() {
+  static JsonDocument filter;
+  if (filter.isNull()) {
+    for (const char* key : INIT_KEYS) filter[key] = true;
+  }
+  return filter;
+}
 
-    // Check thresholds - start capture on event
-    if      (dev >= sensSevere)   startCapture("severe",   dev, now);
-    else if (dev >= sensModerate) startCapture("moderate", dev, now);
-    else if (dev >= sensMinor)    startCapture("minor",    dev, now);
+// What the settings an older server doesn't send fall back to
+InitConfig serverDefaults() {
+  return initDefaults(SAMPLE_RATE_HZ, MPU6050_DLPF_BW_188, MQTT_PORT_DEFAULT);
+}
+
+// The /api/init settings that can change without touching the arena or the
+// sensor: heartbeat, thresholds, trigger engine, detection filter, bias
+// tracking and upload format. Used at boot and by reloadConfig().
+void applyConfig(const InitConfig& c) {
+  heartbeatInterval = c.heartbeatMs;
+  // Older servers have no push channel, so keep the heartbeat as is
+  pushHeartbeatInterval = max(heartbeatInterval, (unsigned long)c.pushHeartbeatMs);
+  configGen = c.gen;
+  configCrc = c.crc;
+  sensMinor = c.sensitivity[0];
+  sensModerate = c.sensitivity[1];
+  sensSevere = c.sensitivity[2];
+  Serial.printf("Config: heartbeatInterval=%lu, sensMinor=%.3f, sensModerate=%.3f, sensSevere=%.3f\n",
+                heartbeatInterval, sensMinor, sensModerate, sensSevere);
+  // Thresholds in raw LSB so detection never touches (software) float
+  sensMinorLsb    = lroundf(sensMinor    * SCALE);
+  sensModerateLsb = lroundf(sensModerate * SCALE);
+  sensSevereLsb   = lroundf(sensSevere   * SCALE);
+  detector.setThresholds(sensMinorLsb, sensModerateLsb, sensSevereLsb);
+
+  TriggerMode triggerMode = (TriggerMode)c.triggerMode;
+  detector.setTriggerMode(triggerMode);
+  // What ΔG is compared against the thresholds; an older server keeps max-abs
+  detector.setMetric((DetectMetric)c.detectMetric);
+  Serial.printf("Detect metric: %s\n", INIT_METRIC_NAMES[c.detectMetric]);
+  if (triggerMode != TRIGGER_MODE_THRESHOLD) {
+    detector.staLta().begin(sampleRateHz, c.staMs, c.ltaMs, c.staLtaOn, c.staLtaOff);
+    Serial.printf("Trigger: %s, STA=%ums LTA=%lums on=%.2f off=%.2f\n", INIT_TRIGGER_MODE_NAMES[triggerMode],
+                  c.staMs, (unsigned long)c.ltaMs, c.staLtaOn, c.staLtaOff);
   } else {
-    // CAPTURING: accumulate post-event samples
-    // Track peak during capture window
-    if (dev > capturedDeltaG) {
-      capturedDeltaG = dev;
-      if      (dev >= sensSevere)   capturedLevel = "severe";
-      else if (dev >= sensModerate) capturedLevel = "moderate";
+    Serial.println("Trigger: threshold");
+  }
+
+  // Background bias tracking time constant; 0 (or an older server) keeps the calibrated bias
+  biasTrackMs = (unsigned long)c.biasTrackS * 1000UL;
+
+  // Detection pre-filter; a corner of 0 (or an older server) leaves it off
+  detector.setFilter(sampleRateHz, c.hpHz, c.lpHz);
+  const AccelFilter& detectFilter = detector.filter();
+  if (detectFilter.enabled()) {
+    Serial.printf("Detect filter: hp=%.2fHz lp=%.2fHz\n",
+                  detectFilter.highPassHz(), detectFilter.lowPassHz());
+  }
+  Serial.printf("Detect pipeline: %s\n", detector.specialized() ? "specialized" : "per-metric");
+
+  // upload_formats is in the server's order of preference; take the first we support
+  for (int i = 0; i < c.formatCount; i++) {
+    if (c.formats[i] < UPLOAD_FORMAT_COUNT) {
+      uploadFormat = (UploadFormat)c.formats[i];
+      break;
     }
-    postBuffer[postCount] = { now, ax, ay, az };
-    postCount++;
-    if (postCount >= POST_SAMPLES) {
-      // Done capturing - upload full waveform
-      uploadWaveformEvent();
-      waveCapturing = false;
-      postCount = 0;
-      // Reset ring buffer so stale data isn't reused
-      preCount = 0;
-      preHead = 0;
+  }
+  Serial.printf("Upload format: %s\n", UPLOAD_FORMAT_NAMES[uploadFormat]);
+
+  // Per-capture spectrum; off (or an older server) saves the per-sample work
+  spectrumEnabled = c.flags & INIT_SPECTRUM;
+  if (spectrumEnabled) Serial.println("Capture spectrum: on");
+
+  // Trigger notices go to the server's UDP port whatever the stream mode;
+  // an older server doesn't send one and gets only the uploads
+  uint16_t streamPort = c.streamPort;
+  String host, path;
+  uint16_t httpPort;
+  splitUrl(ROOT_URL, host, httpPort, path);
+  if (!streamPort) {
+    triggerNotice.stop();
+  } else if (!triggerNotice.begin(host.c_str(), streamPort)) {
+    Serial.printf("! Trigger notice: can't resolve %s\n", host.c_str());
+  }
+
+  // Continuous stream to the same port; "off" (or an older server) keeps
+  // the node event-only
+  float streamHz = constrain(c.streamHz, 0.1f, (float)sampleRateHz);
+  if (c.streamMode == INIT_STREAM_UDP && streamPort) {
+    int decim = max(1L, lroundf(sampleRateHz / streamHz));
+    if (udpStream.begin(host.c_str(), streamPort, sampleRateHz, decim, &sntpClock)) {
+      Serial.printf("UDP stream: %s:%u at %.2fHz (1/%d)\n", host.c_str(), streamPort,
+                    (float)sampleRateHz / min(decim, STREAM_MAX_DECIM), decim);
+    } else {
+      Serial.printf("! UDP stream: can't resolve %s\n", host.c_str());
     }
+  } else {
+    udpStream.stop();
   }
 
-  delay(50);
+  // Broker in place of the HTTP routes; none (or an older server) keeps to HTTP
+  mqttLink.begin(c.mqttHost, c.mqttPort ? c.mqttPort : MQTT_PORT_DEFAULT, deviceId);
+  // Likewise a session with the server itself
+  sessionLink.begin(host.c_str(), c.sessionPort, FIRMWARE_VERSION);
+
+  // On-node diagnostics server, off unless the server says otherwise
+  if (c.flags & INIT_LOCAL_HTTP) {
+    if (!localHttp.enabled()) {
+      Serial.printf("Local HTTP: http://%s/status\n", WiFi.localIP().toString().c_str());
+    }
+    localHttp.begin(sampleRateHz, writeLocalStatus);
+  } else {
+    localHttp.stop();
+  }
 }
 
-void startCapture(const char* level, float dev, unsigned long eventTime) {
-  waveCapturing = true;
-  capturedLevel = level;
-  capturedDeltaG = dev;
-  capturedEventTime = eventTime;
-  postCount = 0;
-  Serial.printf(">> Event detected: %s (%.4fg) - capturing waveform for 3s...\n", level, dev);
+// Heartbeat said our config generation is stale. Re-fetch /api/init and apply
+// it with applyReload().
+bool reloadConfig() {
+  InitConfig cfg = serverDefaults();
+  InitBoot boot;
+  bool decoded = false;
+  int code = fetchInit(serverLink, initUrl, initFilter(), cfg, boot, &decoded);
+  if (code != HTTP_CODE_OK) {
+    Serial.printf("Config reload failed (HTTP %d), retrying next heartbeat\n", code);
+    return false;
+  }
+  if (!decoded) {
+    Serial.println("Config reload: body didn't decode");
+    return false;
+  }
+  applyReload(cfg, boot);
+  return true;
 }
 
-void uploadWaveformEvent() {
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("Wi-Fi lost during waveform upload - rebooting...");
+// A new /api/init body, fetched or published retained on the broker, applied
+// in place; only a change that resizes the arena or reprograms the sensor
+// (rate, DLPF, window lengths) still takes the reboot path, and a new
+// firmware waits its turn in loop(). Called between captures, so the STA/LTA
+// and filter restart from rest.
+void applyReload(const InitConfig& cfg, const InitBoot& boot) {
+  bool reboot = cfg.sampleRateHz != sampleRateHz || cfg.dlpf != dlpfMode || cfg.preMs != preMs ||
+                cfg.postMs != postMs || cfg.maxPostMs != maxPostMs || boot.recalibrate;
+  if (reboot) {
+    Serial.println("Config change needs a restart - rebooting...");
+    clearInitCache();
     digitalWrite(LED_PIN, HIGH);
     ESP.restart();
   }
 
-  // How many ms ago the event was detected (server uses this to compute real timestamp)
-  unsigned long offsetMs = millis() - capturedEventTime;
-
-  // Build JSON with waveform array: [[relative_ms, ax, ay, az], ...]
-  // Pre-allocate String to avoid fragmentation (~12KB max)
-  String body;
-  body.reserve(12000);
-
-  body += "{\"id\":\"";
-  body += deviceId;
-  body += "\",\"level\":\"";
-  body += capturedLevel;
-  body += "\",\"deltaG\":";
-  body += String(capturedDeltaG, 4);
-  body += ",\"event_offset_ms\":";
-  body += String(offsetMs);
-  body += ",\"waveform\":[";
-
-  // Pre-event samples from ring buffer (oldest first)
-  int start = (preHead - preCount + PRE_SAMPLES) % PRE_SAMPLES;
-  for (int i = 0; i < preCount; i++) {
-    int idx = (start + i) % PRE_SAMPLES;
-    WaveSample& s = preBuffer[idx];
-    int relTime = (int)((long)s.ms - (long)capturedEventTime);
-    if (i > 0) body += ",";
-    body += "[";
-    body += String(relTime);
-    body += ",";
-    body += String(s.ax, 4);
-    body += ",";
-    body += String(s.ay, 4);
-    body += ",";
-    body += String(s.az, 4);
-    body += "]";
-  }
-
-  // Post-event samples (the event trigger is at t=0 boundary)
-  for (int i = 0; i < postCount; i++) {
-    WaveSample& s = postBuffer[i];
-    int relTime = (int)((long)s.ms - (long)capturedEventTime);
-    if (preCount > 0 || i > 0) body += ",";
-    body += "[";
-    body += String(relTime);
-    body += ",";
-    body += String(s.ax, 4);
-    body += ",";
-    body += String(s.ay, 4);
-    body += ",";
-    body += String(s.az, 4);
-    body += "]";
-  }
-
-  body += "]}";
-
-  Serial.printf(">> Uploading waveform: %s, peak=%.4fg, %d pre + %d post samples, %d bytes\n",
-                capturedLevel.c_str(), capturedDeltaG, preCount, postCount, body.length());
-
-  WiFiClient client;
-  HTTPClient http;
-  http.begin(client, URL);
-  http.addHeader("Content-Type", "application/json");
-
-  int code = http.POST(body);
-  http.end();
-
-  if (code < 0) {
-    Serial.printf("! POST error (%d) - rebooting...\n", code);
+  if (boot.firmwareVersion[0] && boot.firmwareUrl[0] && strcmp(boot.firmwareVersion, FIRMWARE_VERSION) != 0) {
+    otaUpdater.schedule(boot.firmwareUrl, boot.firmwareVersion, millis());
+  }
+
+  unsigned long oldBiasTrackMs = biasTrackMs;
+  applyConfig(cfg);
+  saveInitCache(cfg, FIRMWARE_VERSION);
+#if ACQ_MODE == ACQ_MODE_MOTION
+  applyMotionThreshold();
+#endif
+  if (biasTrackMs != oldBiasTrackMs) {
+    // Restart from the bias in use, so switching tracking on or off doesn't step it
+    float x = biasTracker.enabled() ? biasTracker.value(0) : meanX;
+    float y = biasTracker.enabled() ? biasTracker.value(1) : meanY;
+    float z = biasTracker.enabled() ? biasTracker.value(2) : meanZ;
+    meanX = x;
+    meanY = y;
+    meanZ = z;
+    biasTracker.begin(sampleRateHz, biasTrackMs, BIAS_TRACK_STEP_LSB, BIAS_TRACK_DRIFT_LSB, x, y, z);
+    Serial.printf("Bias tracking: tau=%lus\n", biasTrackMs / 1000UL);
+    if (!detector.capturing()) applyBias();
+  }
+  Serial.printf("Config generation %lu applied\n", (unsigned long)configGen);
+}
+
+// The server wants a window of the ring it asked for by epoch time (ms):
+// from_ms..to_ms around center_ms. Epoch maps to millis() through SNTP when
+// synced, else through the server's now_ms (off by the request latency), and
+// millis() to ring samples by counting periods back from newestSampleMs.
+// Whatever part is still in the ring goes out as a "pull" upload, trimmed
+// around the center to fit the upload queue; it never blocks sampling.
+bool servePull() {
+  char url[128];
+  snprintf(url, sizeof(url), "%sapi/pull?id=%s", ROOT_URL, deviceId);
+  String payload;
+  int code = serverLink.get(url, &payload);
+  if (code != HTTP_CODE_OK) {
+    if (code != 204) Serial.printf("Pull: fetch failed (HTTP %d)\n", code);
+    return false;
+  }
+  StaticJsonDocument<256> doc;
+  if (deserializeJson(doc, payload)) {
+    Serial.println("Pull: JSON parse error");
+    return false;
+  }
+  unsigned long now = millis();
+  int64_t nowEpochMs = sntpClock.synced() ? sntpClock.epochUs(now) / 1000 : (doc["now_ms"] | (int64_t)0);
+  int64_t fromMs   = doc["from_ms"]   | (int64_t)0;
+  int64_t toMs     = doc["to_ms"]     | (int64_t)0;
+  int64_t centerMs = doc["center_ms"] | (fromMs + toMs) / 2;
+  if (!nowEpochMs || toMs <= fromMs) return false;
+
+  // Samples before the newest one, for an epoch time
+  int newest = arena.count() - 1;
+  auto back = [&](int64_t epochMs) -> int64_t {
+    int64_t ageMs = nowEpochMs - epochMs - (int64_t)(now - newestSampleMs);
+    return ageMs * sampleRateHz / 1000;
+  };
+  int64_t backFrom = back(fromMs), backTo = back(toMs);
+  if (backTo > newest && blackBox.enabled()) return serveBlackBoxPull(fromMs, toMs);
+  if (backTo > newest || backFrom < 0) {
+    Serial.println("Pull: range not in the ring");
+    return false;
+  }
+  backFrom = min(backFrom, (int64_t)newest);
+  backTo   = max(backTo, (int64_t)0);
+  int64_t backCenter = constrain(back(centerMs), backTo, backFrom);
+  unsigned long centerAt = newestSampleMs - (unsigned long)(backCenter * 1000 / sampleRateHz);
+
+  CaptureView cap = {};
+  cap.deviceId     = deviceId;
+  cap.trigger      = TRIGGER_PULL;
+  cap.arena        = &arena;
+#if DUAL_SENSOR
+  if (dualSensor) attachSecondary(cap);
+#endif
+  cap.biasX        = biasInUse(0);   // the bias actually being subtracted
+  cap.biasY        = biasInUse(1);
+  cap.biasZ        = biasInUse(2);
+  cap.scale        = SCALE;
+  cap.sampleRateHz = sampleRateHz;
+  int pre  = (int)(backFrom - backCenter + 1);   // center sample included, as a trigger
+  int post = (int)(backCenter - backTo);
+  const char* contentType = "";
+  size_t bodyLen = 0;
+  for (int attempt = 0; attempt < 2; attempt++) {
+    uint32_t newestSeq = arena.written() - 1;
+    cap.firstSeq  = newestSeq - (uint32_t)(backCenter + pre - 1);
+    cap.preCount  = pre;
+    cap.postCount = post;
+    int32_t peak = 0;
+    findCaptureRanges(cap);
+    for (int i = 0; i < cap.count(); i++) {
+      WaveSample w = cap.at(i);
+      int32_t k = 1 << cap.shiftAt(i);
+      peak = max(peak, max(abs(w.x * k - biasLsbX), max(abs(w.y * k - biasLsbY), abs(w.z * k - biasLsbZ))));
+    }
+    cap.level    = LEVEL_NAMES[detector.levelFor(peak)];
+    cap.deltaG   = peak / SCALE;
+    cap.offsetMs = millis() - centerAt;
+    cap.gapIndex = cap.gapSamples = 0;
+#if ACQ_MODE != ACQ_MODE_POLL
+    findCaptureGap(cap);
+#endif
+    UploadBodies bodies(cap);
+    PieceStream* body = bodies.pick(contentType);
+    bodyLen = body->measure();
+    if (bodyLen > ASYNC_UPLOAD_MAX_BYTES - uploader.bytesQueued()) {
+      // Keep the same share either side of the center, scaled to fit
+      float k = 0.95f * (ASYNC_UPLOAD_MAX_BYTES - uploader.bytesQueued()) / bodyLen;
+      pre  = max(1, (int)(pre * k));
+      post = (int)(post * k);
+      continue;
+    }
+
+    EventMeta meta = {};
+    meta.seq       = journal.nextSeq();
+    meta.eventTime = centerAt;
+    meta.bootCount = journal.bootCount();
+    meta.epochUs   = sntpClock.epochUs(meta.eventTime);
+    meta.timeSource = meta.epochUs ? EVENT_TIME_NTP : EVENT_TIME_NONE;
+    if (!meta.epochUs && clockOffsetMs) {
+      meta.epochUs    = (clockOffsetMs + (int64_t)meta.eventTime) * 1000LL;
+      meta.timeSource = EVENT_TIME_SERVER;
+    }
+    if (!uploader.enqueue(*body, contentType, meta)) break;
+    Serial.printf(">> Queued pull #%lu: %d pre + %d post samples, peak=%.4fg, %u bytes %s\n",
+                  (unsigned long)meta.seq, pre, post, cap.deltaG, (unsigned)bodyLen,
+                  UPLOAD_FORMAT_NAMES[uploadFormat]);
+    return true;
+  }
+  Serial.printf("! Pull: no room in the upload queue (%u bytes)\n", (unsigned)bodyLen);
+  return false;
+}
+
+// A window the ring has rolled past, from the black box instead: its blocks
+// go to POST /api/blackbox as they are on flash, and the server matches them
+// to the pull it handed out. Blocking, like a heartbeat; a long window can
+// cost a FIFO gap.
+bool serveBlackBoxPull(int64_t fromMs, int64_t toMs) {
+  BlackBoxSpan spans[BLACKBOX_MAX_SPANS];
+  int n = blackBox.find(fromMs, toMs, spans, BLACKBOX_MAX_SPANS);
+  BlackBoxStream body(blackBox, spans, n);
+  if (!body.blocks()) {
+    Serial.println("Pull: range not in the ring or the black box");
+    return false;
+  }
+  char url[128];
+  snprintf(url, sizeof(url), "%sapi/blackbox?id=%s", ROOT_URL, deviceId);
+  int code = serverLink.post(url, BLACKBOX_CONTENT_TYPE, body, body.length());
+  Serial.printf(">> Pull from the black box: %d blocks, %u bytes, HTTP %d\n", body.blocks(),
+                (unsigned)body.length(), code);
+  return code == HTTP_CODE_OK;
+}
+
+#if WAVEFORM_INJECT
+// Body of GET /api/inject straight into the injector
+class InjectSink : public BodySink {
+  public:
+    bool read(Stream& body, int length) override { return injector.load(body, length, sampleRateHz); }
+};
+
+// Fetch the capture the server queued for this node and start playing it
+// on the next sample; the result goes out with the next heartbeat
+bool serveInject() {
+  if (injector.active() || detector.capturing()) return false;
+  char url[128];
+  snprintf(url, sizeof(url), "%sapi/inject?id=%s", ROOT_URL, deviceId);
+  bool ok = false;
+  InjectSink sink;
+  int code = serverLink.getBody(url, sink, &ok);
+  if (code != HTTP_CODE_OK || !ok) {
+    Serial.printf("Injection: fetch failed (HTTP %d)\n", code);
+    return false;
+  }
+  injectFileAt = 0;
+  injector.start();
+  Serial.println("Injection: playing the server's capture");
+  return true;
+}
+
+// Play INJECT_FILE once its boot delay has passed
+void taskInject(unsigned long now) {
+  if (!injectFileAt || (long)(now - injectFileAt) < 0 || detector.capturing()) return;
+  injectFileAt = 0;
+  injector.start();
+  Serial.printf("Injection: playing %s\n", INJECT_FILE);
+}
+#endif
+
+#if ACQ_MODE != ACQ_MODE_POLL
+void startFifo() {
+  // Gyro output rate is 8kHz with DLPF off (256Hz), 1kHz otherwise;
+  // sample clock = output rate / (1 + SMPLRT_DIV)
+  int outputRate = (dlpfMode == MPU6050_DLPF_BW_256) ? 8000 : 1000;
+  mpu.setRate(constrain(outputRate / sampleRateHz - 1, 0, 255));
+  fifoRateHz = sampleRateHz;
+  mpu.setAccelFIFOEnabled(true);
+  mpu.setFIFOEnabled(true);
+#if DUAL_SENSOR
+  if (dualSensor) {
+    mpu2.setRate(constrain(outputRate / sampleRateHz - 1, 0, 255));
+    mpu2.setAccelFIFOEnabled(true);
+    mpu2.setFIFOEnabled(true);
+  }
+#endif
+  mpu.resetFIFO();
+  mpu.getIntFIFOBufferOverflowStatus();  // clear any stale overflow flag
+#if DUAL_SENSOR
+  if (dualSensor) {
+    mpu2.resetFIFO();                    // right after the first, so they start together
+    mpu2.getIntFIFOBufferOverflowStatus();
+  }
+#endif
+  fifoBaseMs = millis();
+  fifoSampleIndex = 0;
+#if ACQ_MODE == ACQ_MODE_DRDY
+  // 50us active-high pulse per sample; the FIFO still carries the data
+  mpu.setInterruptMode(MPU6050_INTMODE_ACTIVEHIGH);
+  mpu.setInterruptDrive(MPU6050_INTDRV_PUSHPULL);
+  mpu.setInterruptLatch(MPU6050_INTLATCH_50USPULSE);
+  mpu.setIntDataReadyEnabled(true);
+  pinMode(INT_PIN, INPUT);
+  readyRing.restart();
+#if REALTIME_PROFILE
+  isrJitter.restart();
+#endif
+  attachInterrupt(digitalPinToInterrupt(INT_PIN), onDataReady, RISING);
+  Serial.printf("Data-ready acquisition at %dHz on INT pin %d\n", sampleRateHz, INT_PIN);
+#elif ACQ_MODE == ACQ_MODE_MOTION
+  // Largest divisor up to MOTION_IDLE_DIVISOR that keeps the idle rate whole
+  // and one the 1kHz clock of the narrowed idle DLPF produces exactly
+  for (idleDivisor = MOTION_IDLE_DIVISOR;
+       idleDivisor > 1 && (sampleRateHz % idleDivisor || 1000 % (sampleRateHz / idleDivisor));
+       idleDivisor--) { }
+  // 50us pulse per motion interrupt, which only looks at the high-passed
+  // accel (the DHPF doesn't touch the data registers or the FIFO)
+  mpu.setInterruptMode(MPU6050_INTMODE_ACTIVEHIGH);
+  mpu.setInterruptDrive(MPU6050_INTDRV_PUSHPULL);
+  mpu.setInterruptLatch(MPU6050_INTLATCH_50USPULSE);
+  mpu.setDHPFMode(MPU6050_DHPF_5);
+  applyMotionThreshold();
+  mpu.setMotionDetectionDuration(MOTION_DURATION_MS);
+  mpu.setIntMotionEnabled(true);
+  pinMode(INT_PIN, INPUT);
+  motionIdle = false;
+  fullRateUntil = millis() + MOTION_HOLD_MS;
+  attachInterrupt(digitalPinToInterrupt(INT_PIN), onMotion, RISING);
+  Serial.printf("Motion-wake acquisition at %dHz, %dHz at rest, INT pin %d\n",
+                sampleRateHz, sampleRateHz / idleDivisor, INT_PIN);
+#else
+  Serial.printf("FIFO acquisition at %dHz\n", sampleRateHz);
+#endif
+}
+
+// The FIFO contents can't be trusted (overflow drops whole bytes, not
+// samples); reset it and log the gap so captures spanning it are marked
+void restartFifoAfterLoss(const char* why) {
+  mpu.resetFIFO();
+#if DUAL_SENSOR
+  if (dualSensor) mpu2.resetFIFO();
+#endif
+  unsigned long now = millis();
+  unsigned long nextMs = fifoBaseMs + (fifoSampleIndex * 1000UL) / fifoRateHz;
+  unsigned long lost = (long)(now - nextMs) > 0 ? (now - nextMs) * fifoRateHz / 1000UL : 0;
+  // Keep the timestamps on the sample grid: the next sample lands 'lost' periods on
+  fifoBaseMs = nextMs + (lost * 1000UL) / fifoRateHz;
+  fifoSampleIndex = 0;
+  lost *= sampleRateHz / fifoRateHz;   // in full-rate samples, as the arena counts
+#if ACQ_MODE == ACQ_MODE_DRDY
+  readyRing.restart();
+#endif
+  FifoGap& g = fifoGaps[fifoGapCount % FIFO_GAP_LOG];
+  g.firstSeq = arena.written();
+  g.lost = (uint16_t)min(lost, 65535UL);
+  fifoGapCount++;
+  fifoLostTotal += lost;
+  Serial.printf("! FIFO %s - reset, %lu samples lost (%lu total)\n", why, lost, fifoLostTotal);
+}
+
+// Mark the first logged gap inside the capture and the total lost in it
+void findCaptureGap(CaptureView& cap) {
+  uint32_t n = (uint32_t)cap.count();
+  for (int k = max(0, fifoGapCount - FIFO_GAP_LOG); k < fifoGapCount; k++) {
+    const FifoGap& g = fifoGaps[k % FIFO_GAP_LOG];
+    uint32_t at = g.firstSeq - cap.firstSeq;
+    if (at == 0 || at >= n) continue;
+    if (!cap.gapSamples) cap.gapIndex = (int)at;
+    cap.gapSamples += g.lost;
+  }
+}
+
+void drainFifo() {
+  if (mpu.getIntFIFOBufferOverflowStatus()) {
+    restartFifoAfterLoss("overflow");
+    return;
+  }
+
+  uint16_t available = mpu.getFIFOCount() / FIFO_SAMPLE_BYTES;
+#if ACQ_MODE == ACQ_MODE_DRDY
+  readyRing.begin(available);   // before anything else can let more edges in
+#endif
+  bool drained = available > 0;
+  unsigned long newestMs = 0;   // on the sample counter
+#if DUAL_SENSOR
+  // Counted right after the first sensor's, so the newest of both line up
+  int secondaryCount = dualSensor && available ? readSecondaryFifo() : 0;
+  int paired = 0, pairTotal = available;
+#endif
+  while (available > 0) {
+    int n = min((int)available, FIFO_BURST_SAMPLES);
+    // One Wire-buffer chunk per poll (~3ms at 400kHz); yield() between them
+    // lets the WiFi stack run during a long drain instead of after it
+    I2CdevRequest req;
+    mpu.beginFIFOBlock(&req, fifoBurst, n * FIFO_SAMPLE_BYTES);
+    while (I2Cdev::readBytesPoll(&req) == I2CDEV_REQUEST_PENDING) yield();
+    if (I2Cdev::readBytesResult(&req) != n * FIFO_SAMPLE_BYTES) {
+      // A short read leaves the FIFO misaligned on the 6-byte sample boundary
+      restartFifoAfterLoss("read failed");
+      return;
+    }
+    // Byte-swap a block of samples into per-axis arrays in one tight loop,
+    // then run the filters over them
+    int16_t bx[FIFO_UNPACK_SAMPLES], by[FIFO_UNPACK_SAMPLES], bz[FIFO_UNPACK_SAMPLES];
+    for (int i = 0; i < n; i++) {
+      int j = i % FIFO_UNPACK_SAMPLES;
+      if (j == 0) {
+        int k = min(n - i, FIFO_UNPACK_SAMPLES);
+        MPU6050_Base::unpackAccelFIFO(fifoBurst + i * FIFO_SAMPLE_BYTES, k, bx, by, bz);
+      }
+      int16_t rawX = bx[j], rawY = by[j], rawZ = bz[j];
+      unsigned long ms = fifoBaseMs + (fifoSampleIndex * 1000UL) / fifoRateHz;
+      newestMs = ms;
+#if ACQ_MODE == ACQ_MODE_DRDY
+      // Prefer the ISR's capture time; fall back to the counter if the
+      // stamp raced the FIFO write and isn't published yet
+      readyRing.take(ms);
+#endif
+      // Re-anchor once per second so the index * 1000 product never wraps
+      if (++fifoSampleIndex >= (unsigned long)fifoRateHz) {
+        fifoBaseMs += 1000;
+        fifoSampleIndex = 0;
+      }
+#if ACQ_MODE == ACQ_MODE_MOTION
+      feedSample(ms, rawX, rawY, rawZ);
+#else
+#if DUAL_SENSOR
+      if (dualSensor) feedSecondary(pairedIndex(paired++, pairTotal, secondaryCount), secondaryCount);
+#endif
+      processSample(ms, rawX, rawY, rawZ);
+#endif
+    }
+    available -= n;
+  }
+
+  // The FIFO was just emptied, so its newest sample was clocked just now
+  if (drained) {
+    long behind = (long)(millis() - newestMs);
+    long slack = (long)(FIFO_CLOCK_SLACK_MS + 1000UL / fifoRateHz);
+    if (behind < 0) fifoBaseMs -= (unsigned long)-behind;
+    else if (behind > slack) fifoBaseMs += (unsigned long)(behind - slack);
+  }
+}
+#endif
+
+#if DUAL_SENSOR
+// The second sensor's bias: it has no stored calibration, so a short
+// average at boot, then tracked while idle
+void calibrateSecondary() {
+  int32_t sum[3] = {0, 0, 0};
+  for (int i = 0; i < DUAL_CALIB_SAMPLES; i++) {
+    int16_t rx, ry, rz;
+    mpu2.getAcceleration(&rx, &ry, &rz);
+    sum[0] += rx; sum[1] += ry; sum[2] += rz;
+    delay(2);
+  }
+  float x = (float)sum[0] / DUAL_CALIB_SAMPLES;
+  float y = (float)sum[1] / DUAL_CALIB_SAMPLES;
+  float z = (float)sum[2] / DUAL_CALIB_SAMPLES;
+  secondaryBias.begin(sampleRateHz, DUAL_BIAS_TRACK_MS, BIAS_TRACK_STEP_LSB, BIAS_TRACK_DRIFT_LSB, x, y, z);
+  Serial.printf("Second sensor bias: mean raw = (%.1f, %.1f, %.1f)\n", x, y, z);
+}
+
+// The second sensor's FIFO into fifoBurst2; its sample count, 0 if it had
+// to be reset (the drain then repeats its last sample)
+int readSecondaryFifo() {
+  if (mpu2.getIntFIFOBufferOverflowStatus()) {
+    mpu2.resetFIFO();
+    Serial.println("! Second sensor FIFO overflow - reset");
+    return 0;
+  }
+  int n = min((int)(mpu2.getFIFOCount() / FIFO_SAMPLE_BYTES), FIFO_BURST_SAMPLES);
+  if (!n) return 0;
+  I2CdevRequest req;
+  mpu2.beginFIFOBlock(&req, fifoBurst2, n * FIFO_SAMPLE_BYTES);
+  while (I2Cdev::readBytesPoll(&req) == I2CDEV_REQUEST_PENDING) yield();
+  if (I2Cdev::readBytesResult(&req) != n * FIFO_SAMPLE_BYTES) {
+    mpu2.resetFIFO();
+    Serial.println("! Second sensor FIFO read failed - reset");
+    return 0;
+  }
+  return n;
+}
+
+// Sample 'index' of the 'count' readSecondaryFifo() got into arena2, ahead
+// of the first sensor's processSample() so both arenas are on one sequence
+// number. The bias follows it under the same conditions as the first's.
+void feedSecondary(int index, int count) {
+  if (count > 0) {
+    MPU6050_Base::unpackAccelFIFO(fifoBurst2 + index * FIFO_SAMPLE_BYTES, 1,
+                                  &lastSecondary[0], &lastSecondary[1], &lastSecondary[2]);
+  }
+  arena2.push(lastSecondary[0], lastSecondary[1], lastSecondary[2]);
+  if (detector.capturing() || (rangeSwitchCount && rangeShiftAt(arena2.written() - 1))) return;
+  int32_t dev = 0;
+  for (int a = 0; a < 3; a++) dev = max(dev, abs(lastSecondary[a] - secondaryBias.lsb(a)));
+  if (dev < sensMinorLsb / 2) secondaryBias.update(lastSecondary[0], lastSecondary[1], lastSecondary[2]);
+}
+
+// The second sensor's window and bias, for the same samples as cap
+void attachSecondary(CaptureView& cap) {
+  cap.secondary = &arena2;
+  for (int a = 0; a < 3; a++) cap.secondaryBias[a] = secondaryBias.value(a);
+}
+#endif
+
+#if ACQ_MODE == ACQ_MODE_DRDY
+void IRAM_ATTR onDataReady() {
+#if REALTIME_PROFILE
+  isrJitter.edge(ESP.getCycleCount());
+#endif
+  readyRing.edge(millis());
+}
+#endif
+
+#if ACQ_MODE == ACQ_MODE_MOTION
+void IRAM_ATTR onMotion() {
+  motionAt = millis() | 1;
+#if MODEM_SLEEP
+  modemSleep.wake();
+#endif
+}
+
+// MOT_THR from the minor threshold, 2mg per LSB
+void applyMotionThreshold() {
+  long thr = lroundf(sensMinor * MOTION_WAKE_FRACTION * 500.0f);
+  mpu.setMotionDetectionThreshold((uint8_t)constrain(thr, 1L, 255L));
+}
+
+// Reclock the chip between the idle and full rates. The FIFO is drained at
+// the old rate first, and the periods the switch takes are held at the
+// newest sample, so the arena stays on the sampleRateHz grid.
+void setMotionIdle(bool idle) {
+  if (idle == motionIdle) return;
+  drainFifo();
+  int rate = idle ? sampleRateHz / idleDivisor : sampleRateHz;
+  // At rest the DLPF is narrowed below the idle Nyquist rate, never widened
+  uint8_t dlpf = dlpfMode;
+  if (idle) {
+    static const uint16_t DLPF_BW_HZ[] = { 256, 188, 98, 42, 20, 10, 5 };
+    uint8_t m = MPU6050_DLPF_BW_188;
+    while (m < MPU6050_DLPF_BW_5 && DLPF_BW_HZ[m] * 2 > rate) m++;
+    dlpf = max(dlpf, m);
+  }
+  int outputRate = (dlpf == MPU6050_DLPF_BW_256) ? 8000 : 1000;
+  mpu.setDLPFMode(dlpf);
+  mpu.setRate(constrain(outputRate / rate - 1, 0, 255));
+  mpu.resetFIFO();
+  mpu.getIntFIFOBufferOverflowStatus();
+  motionIdle = idle;
+  fifoRateHz = rate;
+  idleDrainAt = millis();
+
+  unsigned long periodMs = 1000UL / sampleRateHz;
+  for (int held = 0; held < sampleRateHz && (long)(millis() - (newestSampleMs + periodMs)) > 0; held++) {
+    processSample(newestSampleMs + periodMs, lastRaw[0], lastRaw[1], lastRaw[2]);
+  }
+  // The first sample on the new clock; an idle one is ramped back to here
+  fifoBaseMs = newestSampleMs + (idle ? idleDivisor : 1) * periodMs;
+  fifoSampleIndex = 0;
+}
+
+// A full-rate sample goes straight through; an idle one becomes idleDivisor
+// samples ramped from the previous one, the last of them at ms
+void feedSample(unsigned long ms, int16_t rawX, int16_t rawY, int16_t rawZ) {
+  if (motionIdle) {
+    unsigned long periodMs = 1000UL / sampleRateHz;
+    for (int j = 1; j < idleDivisor; j++) {
+      processSample(ms - (idleDivisor - j) * periodMs,
+                    lastRaw[0] + (rawX - lastRaw[0]) * j / idleDivisor,
+                    lastRaw[1] + (rawY - lastRaw[1]) * j / idleDivisor,
+                    lastRaw[2] + (rawZ - lastRaw[2]) * j / idleDivisor);
+    }
+  }
+  processSample(ms, rawX, rawY, rawZ);
+  lastRaw[0] = rawX;
+  lastRaw[1] = rawY;
+  lastRaw[2] = rawZ;
+}
+#endif
+
+// Integer bias for the hot path: the calibrated (or tracked) bias at the
+// calibration temperature plus the table entry for lastTempRaw
+void applyBias() {
+  thermalBias.setTemperature(lastTempRaw);
+  biasLsbX = (biasTracker.enabled() ? biasTracker.lsb(0) : lroundf(meanX)) + thermalBias.correction(0);
+  biasLsbY = (biasTracker.enabled() ? biasTracker.lsb(1) : lroundf(meanY)) + thermalBias.correction(1);
+  biasLsbZ = (biasTracker.enabled() ? biasTracker.lsb(2) : lroundf(meanZ)) + thermalBias.correction(2);
+}
+
+// The same in float LSB, for the upload header
+float biasInUse(int axis) {
+  float base = biasTracker.enabled() ? biasTracker.value(axis) : (axis == 0 ? meanX : axis == 1 ? meanY : meanZ);
+  return base + thermalBias.correction(axis);
+}
+
+// MPU6050 datasheet: T = raw / 340 + 36.53
+float tempCelsius(int16_t raw) {
+  return raw / 340.0f + 36.53f;
+}
+
+// Microseconds the MPU6050 has held the bus since boot (0 with I2CDEV_STATS off)
+uint32_t busMicros() {
+  I2CdevStats bus;
+  I2Cdev::getStats(MPU6050_DEFAULT_ADDRESS, &bus);
+  return bus.micros;
+}
+
+// Cumulative I2C counters for the MPU6050 since boot; the server diffs them.
+// A healthy bus shows zero timeouts/NACKs/errors and i2c_us growing with
+// the sample rate only.
+void appendBusStats(String& url) {
+  I2CdevStats bus;
+  I2Cdev::getStats(MPU6050_DEFAULT_ADDRESS, &bus);
+  url += "&i2c_tx=";    url += (unsigned long)bus.transactions;
+  url += "&i2c_to=";    url += (unsigned long)bus.timeouts;
+  url += "&i2c_nack=";  url += (unsigned long)bus.nacks;
+  url += "&i2c_err=";   url += (unsigned long)bus.errors;
+  url += "&i2c_bytes="; url += (unsigned long)bus.bytes;
+  url += "&i2c_us=";    url += (unsigned long)bus.micros;
+  if (bus.timeouts || bus.nacks || bus.errors) {
+    Serial.printf("! I2C: %u timeouts, %u NACKs, %u errors in %u transactions\n",
+                  (unsigned)bus.timeouts, (unsigned)bus.nacks, (unsigned)bus.errors,
+                  (unsigned)bus.transactions);
+  }
+}
+
+// Heartbeat query into the preallocated heartbeatUrl. Fixed-size fields go
+// first; the trace is capped to the room left, so the String never grows.
+void buildHeartbeatUrl(unsigned long now, int& traceSeconds, int& stormMinutes, uint32_t& evictions) {
+  HEAP_CHECK_BEGIN();
+  heartbeatUrl = heartbeatBase;
+  heartbeatUrl += "&cfg=";
+  heartbeatUrl += (unsigned long)configGen;
+  if (configCrc) {
+    char crc[9];
+    snprintf(crc, sizeof(crc), "%08lx", (unsigned long)configCrc);
+    heartbeatUrl += "&cfh=";
+    heartbeatUrl += crc;
+  }
+  // millis() and boot for the server's fit of our clock (lib/clockfit.js)
+  heartbeatUrl += "&ms=";
+  heartbeatUrl += millis();
+  heartbeatUrl += "&boot=";
+  heartbeatUrl += (unsigned long)journal.bootCount();
+  int tenths = (int)lroundf(tempCelsius(lastTempRaw) * 10.0f);
+  heartbeatUrl += "&temp_c=";
+  if (tenths < 0) {
+    heartbeatUrl += '-';
+    tenths = -tenths;
+  }
+  heartbeatUrl += tenths / 10;
+  heartbeatUrl += '.';
+  heartbeatUrl += tenths % 10;
+  appendBusStats(heartbeatUrl);
+  profile.appendQuery(heartbeatUrl);
+  cpuBoost.appendQuery(heartbeatUrl);
+#if MODEM_SLEEP
+  modemSleep.appendQuery(heartbeatUrl, millis());
+#endif
+#if REALTIME_PROFILE
+  isrJitter.appendQuery(heartbeatUrl);
+#endif
+  heapMonitor.appendQuery(heartbeatUrl);
+  otaUpdater.appendQuery(heartbeatUrl);
+  bootTiming.appendQuery(heartbeatUrl);
+  blackBox.appendQuery(heartbeatUrl);
+  serverTls.appendQuery(heartbeatUrl);
+  mqttLink.appendQuery(heartbeatUrl);
+  sessionLink.appendQuery(heartbeatUrl);
+  scheduler.appendQuery(heartbeatUrl);
+  uploader.appendQuery(heartbeatUrl);
+  heartbeatUrl += "&capq=";
+  heartbeatUrl += (unsigned long)captureOverflow.spilled;   heartbeatUrl += ',';
+  heartbeatUrl += (unsigned long)captureOverflow.streamed;  heartbeatUrl += ',';
+  heartbeatUrl += (unsigned long)captureOverflow.dropped;
+  evictions = journal.appendQuery(heartbeatUrl);
+#if DUAL_SENSOR
+  if (dualSensor) {
+    heartbeatUrl += "&taps=";
+    heartbeatUrl += (unsigned long)localTaps;
+  }
+#endif
+#if WAVEFORM_INJECT
+  injector.appendQuery(heartbeatUrl);
+#endif
+  stormMinutes = storm.appendQuery(heartbeatUrl, now);
+  // "&trace=" + 24 chars per second + "&trace_age_ms=" + up to 10 digits
+  int room = HEARTBEAT_URL_SIZE - 1 - (int)heartbeatUrl.length() - 48;
+  traceSeconds = helicorder.appendQuery(heartbeatUrl, now, max(0, room) * 3 / (4 * HELI_SUMMARY_BYTES));
+  HEAP_CHECK_END("buildHeartbeatUrl");
+}
+
+#if HEAP_CHECK
+void checkHeapUnchanged(uint32_t before, const char* what) {
+  int32_t delta = (int32_t)(before - ESP.getFreeHeap());
+  if (delta == 0) return;
+  Serial.printf("! HEAP_CHECK: %s allocated %ld bytes\n", what, (long)delta);
+  assert(delta == 0);
+}
+#endif
+
+// Range code of the sample with sequence number seq. The newest switch can
+// be logged ahead of samples still queued in the FIFO from before it.
+uint8_t rangeShiftAt(uint32_t seq) {
+  uint8_t shift = rangeShift;
+  for (int k = rangeSwitchCount - 1; k >= max(0, rangeSwitchCount - RANGE_LOG); k--) {
+    const RangeSwitch& r = rangeLog[k % RANGE_LOG];
+    if ((int32_t)(seq - r.firstSeq) >= 0) return r.to;
+    shift = r.from;
+  }
+  return shift;
+}
+
+// Put the chip on wantRangeShift's range. Whatever is still in the FIFO was
+// sampled at the old one, so the switch is logged after it (a sample clocked
+// between the count and the register write can land on the wrong side).
+void applyAutoRange() {
+  if (wantRangeShift == rangeShift) return;
+  uint32_t pending = 0;
+#if ACQ_MODE != ACQ_MODE_POLL
+  pending = (uint32_t)(mpu.getFIFOCount() / FIFO_SAMPLE_BYTES) * (sampleRateHz / fifoRateHz);
+#endif
+  mpu.setFullScaleAccelRange(wantRangeShift);
+#if DUAL_SENSOR
+  if (dualSensor) mpu2.setFullScaleAccelRange(wantRangeShift);
+#endif
+  RangeSwitch& r = rangeLog[rangeSwitchCount % RANGE_LOG];
+  r.firstSeq = arena.written() + pending;
+  r.from = rangeShift;
+  r.to = wantRangeShift;
+  rangeSwitchCount++;
+  rangeShift = wantRangeShift;
+  rangeQuietSamples = 0;
+  Serial.printf("Accel range +/-%dg\n", 2 << rangeShift);
+}
+
+// Range blocks of the capture window into captureRanges; none if every
+// sample in it was read at +/-2g
+void findCaptureRanges(CaptureView& cap) {
+  cap.ranges = captureRanges;
+  cap.rangeCount = 0;
+  uint8_t first = rangeShiftAt(cap.firstSeq);
+  captureRanges[cap.rangeCount++] = { 0, first };
+  uint32_t n = (uint32_t)cap.count();
+  for (int k = max(0, rangeSwitchCount - RANGE_LOG); k < rangeSwitchCount; k++) {
+    const RangeSwitch& r = rangeLog[k % RANGE_LOG];
+    uint32_t at = r.firstSeq - cap.firstSeq;
+    if (at == 0 || at >= n) continue;
+    captureRanges[cap.rangeCount++] = { (uint16_t)at, r.to };
+  }
+  if (cap.rangeCount == 1 && first == 0) cap.rangeCount = 0;
+}
+
+// The detector just opened a capture on this sample
+void startCapture(unsigned long eventTime) {
+  const DetectedCapture& c = detector.capture();
+  capturedEventTime = eventTime;
+  capturedEpochUs = sntpClock.epochUs(eventTime);
+  // Nothing else takes a seq while the capture runs (pulls wait for it)
+  capturedSeq = journal.peekSeq();
+  // A capture that may be folded isn't announced; if it grows past minor
+  // the server places it when the upload comes in
+  capturedFoldable = foldable(c.level, eventTime);
+#if DUAL_SENSOR
+  capturedDual = dualSensor;
+#if WAVEFORM_INJECT
+  // An injected capture only played into the first sensor's path
+  if (injector.active()) capturedDual = false;
+#endif
+#endif
+  if (!capturedFoldable) {
+    if (capturedEpochUs) {
+      triggerNotice.send(capturedSeq, c.level, c.trigger, capturedEpochUs, EVENT_TIME_NTP, eventTime, c.peakLsb / SCALE);
+    } else if (clockOffsetMs) {
+      triggerNotice.send(capturedSeq, c.level, c.trigger, (clockOffsetMs + (int64_t)eventTime) * 1000LL,
+                         EVENT_TIME_SERVER, eventTime, c.peakLsb / SCALE);
+    } else {
+      triggerNotice.send(capturedSeq, c.level, c.trigger, 0, EVENT_TIME_NONE, eventTime, c.peakLsb / SCALE);
+    }
+  }
+  peerLink.broadcast(capturedSeq, c.level, c.trigger);
+  spectrum.reset();
+  if (c.trigger == TRIGGER_STA_LTA) {
+    Serial.printf(">> Event detected: %s (%.4fg, STA/LTA %.2f) - capturing waveform for %lums...\n",
+                  LEVEL_NAMES[c.level], c.peakLsb / SCALE, detector.staLta().ratioX100() / 100.0f, postMs);
+  } else {
+    Serial.printf(">> Event detected: %s (%.4fg) - capturing waveform for %lums...\n",
+                  LEVEL_NAMES[c.level], c.peakLsb / SCALE, postMs);
+  }
+}
+
+// Move the upload waiting behind the one in flight to the journal if it
+// ranks below level, freeing its slot; false if there was none
+bool displaceQueued(uint8_t level) {
+  EventMeta meta;
+  char contentType[JOURNAL_CONTENT_TYPE_SIZE];
+  uint8_t* data;
+  size_t length;
+  if (!uploader.takeQueued(level, meta, contentType, data, length)) return false;
+  // A replay is still in the journal; anything else is written there now
+  bool kept = meta.journaled || journal.append(meta, contentType, data, length);
+  free(data);
+  if (kept) {
+    captureOverflow.spilled++;
+    Serial.printf(">> Event #%lu (%s) moved to the journal for a more severe one\n",
+                  (unsigned long)meta.seq, LEVEL_NAMES[min(meta.level, (uint8_t)LEVEL_SEVERE)]);
+  } else {
+    captureOverflow.dropped++;
+    Serial.printf("! Event #%lu (%s) dropped for a more severe one\n",
+                  (unsigned long)meta.seq, LEVEL_NAMES[min(meta.level, (uint8_t)LEVEL_SEVERE)]);
+  }
+  return true;
+}
+
+// Summarized in the heartbeat rather than uploaded: minor captures in a
+// storm cooldown, and all but severe ones while the server asks for summaries
+bool foldable(EventLevel level, unsigned long at) {
+  if (level == LEVEL_SEVERE) return false;
+  if (uploadPolicy.mode(millis()) == UPLOAD_SUMMARY) return true;
+  return level == LEVEL_MINOR && storm.cooling(at);
+}
+
+void finishCapture() {
+  CpuBoostScope boost(BOOST_CAPTURE);
+  const DetectedCapture& c = detector.capture();
+  float capturedDeltaG = c.peakLsb / SCALE;
+  if (capturedFoldable && foldable(c.level, capturedEventTime)) {
+    bool sp = spectrumEnabled && spectrum.summarize(capturedSpectrum, SCALE);
+    storm.fold(capturedEventTime, capturedDeltaG, sp ? &capturedSpectrum : nullptr);
+    Serial.printf(">> %s capture folded into the storm summary (%.4fg, %lu so far)\n",
+                  LEVEL_NAMES[c.level], capturedDeltaG, (unsigned long)storm.folded());
+    return;
+  }
+  CaptureView cap;
+  cap.deviceId   = deviceId;
+  cap.level      = LEVEL_NAMES[c.level];
+  cap.trigger    = c.trigger;
+  cap.deltaG     = capturedDeltaG;
+  cap.offsetMs   = millis() - capturedEventTime;  // server uses this to compute real timestamp
+  cap.arena      = &arena;
+  cap.firstSeq   = c.firstSeq;
+  cap.preCount   = c.preCount;
+  cap.postCount  = c.postCount;
+  cap.retriggers     = c.retriggers;
+  cap.retriggerCount = min(c.retriggerCount, CAPTURE_MAX_TRIGGERS);
+  cap.biasX        = biasInUse(0);   // the bias actually being subtracted
+  cap.biasY        = biasInUse(1);
+  cap.biasZ        = biasInUse(2);
+  cap.scale        = SCALE;
+  cap.sampleRateHz = sampleRateHz;
+  cap.gapIndex     = 0;
+  cap.gapSamples   = 0;
+  findCaptureRanges(cap);
+  if (cap.rangeCount) Serial.printf("   Accel range changed inside the capture (%d blocks)\n", cap.rangeCount);
+  cap.spectrum     = spectrumEnabled && spectrum.summarize(capturedSpectrum, SCALE) ? &capturedSpectrum : nullptr;
+#if ACQ_MODE != ACQ_MODE_POLL
+  findCaptureGap(cap);
+  if (cap.gapSamples) {
+    Serial.printf("! Capture has a %d-sample FIFO gap before sample %d\n", cap.gapSamples, cap.gapIndex);
+  }
+#endif
+#if DUAL_SENSOR
+  // Local tap: one sensor moved and the other didn't. A trigger notice may
+  // already have gone out; consensus still needs other nodes to agree.
+  if (capturedDual) {
+    attachSecondary(cap);
+    cap.coherence = captureCoherence(cap);
+    if (cap.coherence < DUAL_COHERENCE_MIN && c.level < LEVEL_SEVERE) {
+      localTaps++;
+      Serial.printf(">> %s capture dropped as local (sensor coherence %.2f, %lu so far)\n",
+                    LEVEL_NAMES[c.level], cap.coherence, (unsigned long)localTaps);
+      return;
+    }
+    Serial.printf("   Sensor coherence %.2f\n", cap.coherence);
+  }
+#endif
+  if (c.level == LEVEL_MINOR) storm.uploaded(capturedEventTime);
+
+  // Backpressure: thin the samples, or leave them out, while the server asks
+  UploadMode mode = uploadPolicy.mode(millis());
+  uint16_t thinnedRetriggers[CAPTURE_MAX_TRIGGERS];
+  CaptureRange thinnedRanges[RANGE_LOG + 1];
+  if (mode == UPLOAD_DECIMATE &&
+      !decimateCapture(cap, UPLOAD_DECIMATE_FACTOR, thinnedRetriggers, thinnedRanges) &&
+      !decimateCapture(cap, 2, thinnedRetriggers, thinnedRanges)) {
+    mode = UPLOAD_FULL;   // a rate neither divides
+  } else if (mode == UPLOAD_WAVEFORM_OFF || mode == UPLOAD_SUMMARY) {
+    cap.preCount = cap.postCount = 0;
+    cap.retriggerCount = cap.rangeCount = cap.gapSamples = 0;
+  }
+  if (mode != UPLOAD_FULL && mode != UPLOAD_RETRY) {
+    Serial.printf("   Server asked for %s: %d samples at %dHz\n", uploadModeName(mode), cap.count(), cap.sampleRateHz);
+  }
+
+  UploadBodies bodies(cap);
+  const char* contentType;
+  PieceStream* body = bodies.pick(contentType);
+  size_t bodyLen = body->measure();
+
+  EventMeta meta = {};
+  meta.seq       = journal.nextSeq();
+  meta.eventTime = capturedEventTime;
+  meta.bootCount = journal.bootCount();
+  meta.uploadMode = mode == UPLOAD_RETRY ? UPLOAD_FULL : mode;
+  meta.level     = c.level;
+  if (capturedEpochUs) {
+    meta.epochUs    = capturedEpochUs;
+    meta.timeSource = EVENT_TIME_NTP;
+  } else if (clockOffsetMs) {
+    meta.epochUs    = (clockOffsetMs + (int64_t)capturedEventTime) * 1000LL;
+    meta.timeSource = EVENT_TIME_SERVER;
+  }
+
+  // Local coincidence: by now the post window has covered PEER_WINDOW_MS
+  meta.localPeers = (uint8_t)min(255, peerLink.peersNear(capturedEventTime, PEER_WINDOW_MS));
+  if (meta.localPeers >= PEER_QUORUM) {
+    Serial.printf(">> Locally confirmed by %u peer(s)\n", (unsigned)meta.localPeers);
+  }
+
+  // The server said it can't take anything for now: straight to the journal,
+  // which waits out its retry time
+  if (mode == UPLOAD_RETRY && bodyLen <= ASYNC_UPLOAD_MAX_BYTES &&
+      journal.append(meta, contentType, *body, bodyLen)) {
+    Serial.printf(">> Event #%lu journaled, server busy for %lus\n", (unsigned long)meta.seq,
+                  uploadPolicy.retryIn(millis()) / 1000);
+    replayAt = millis() + uploadPolicy.retryIn(millis());
+    return;
+  }
+
+  // Normal path: render into the upload queue and keep sampling. A more
+  // severe event takes the slot of a lesser one still waiting, which goes
+  // to the journal instead.
+  if (uploader.enqueue(*body, contentType, meta) ||
+      (displaceQueued(meta.level) && uploader.enqueue(*body, contentType, meta))) {
+    Serial.printf(">> Queued waveform #%lu: %s, peak=%.4fg, %d pre + %d post samples, %u bytes %s\n",
+                  (unsigned long)meta.seq, LEVEL_NAMES[c.level], capturedDeltaG, c.preCount, c.postCount,
+                  (unsigned)bodyLen, UPLOAD_FORMAT_NAMES[uploadFormat]);
+    if (cap.spectrum) {
+      Serial.printf("   Dominant %uHz (%.5fg)\n", capturedSpectrum.hz[capturedSpectrum.dominant],
+                    capturedSpectrum.ampG[capturedSpectrum.dominant]);
+    }
+    return;
+  }
+
+  // Slots or heap budget taken by earlier events still uploading: the
+  // journal is the next slot. Writing it costs a few ms of flash, which the
+  // FIFO covers, so one more event in a row is still captured whole; it goes
+  // out once the queue has drained.
+  if (uploader.busy() && bodyLen <= ASYNC_UPLOAD_MAX_BYTES) {
+    body->rewind();
+    if (journal.append(meta, contentType, *body, bodyLen)) {
+      captureOverflow.spilled++;
+      Serial.printf(">> Event #%lu journaled, upload queue full (%u bytes queued)\n",
+                    (unsigned long)meta.seq, (unsigned)uploader.bytesQueued());
+      return;
+    }
+  }
+
+  // Body too large for the heap budget (e.g. long JSON captures), or no
+  // journal to spill to: stream it synchronously, sampling pauses until it's sent
+  int code = HTTPC_ERROR_CONNECTION_FAILED;
+  captureOverflow.streamed++;
+  if (!wifiLostAt) {
+    Serial.printf(">> Uploading waveform #%lu: %s, peak=%.4fg, %d pre + %d post samples, %u bytes %s\n",
+                  (unsigned long)meta.seq, LEVEL_NAMES[c.level], capturedDeltaG, c.preCount, c.postCount,
+                  (unsigned)bodyLen, UPLOAD_FORMAT_NAMES[uploadFormat]);
+    serverLink.addHeader("X-Event-Seq", String((unsigned long)meta.seq));
+    char epoch[9];
+    snprintf(epoch, sizeof(epoch), "%08lx", (unsigned long)journal.seqEpoch());
+    serverLink.addHeader("X-Seq-Epoch", epoch);
+    serverLink.addHeader("X-Event-Millis", String(meta.eventTime));
+    serverLink.addHeader("X-Boot", String((unsigned long)meta.bootCount));
+    if (meta.epochUs > 0) {
+      serverLink.addHeader("X-Event-Time-Us", String((long long)meta.epochUs));
+      serverLink.addHeader("X-Event-Time-Source", timeSourceName(meta.timeSource));
+    }
+    char heapNow[32];
+    HeapMonitor::formatNow(heapNow, sizeof(heapNow));
+    serverLink.addHeader("X-Heap", heapNow);
+    if (meta.localPeers) serverLink.addHeader("X-Event-Local", String((unsigned)meta.localPeers));
+    if (meta.uploadMode) serverLink.addHeader("X-Upload-Mode", uploadModeName((UploadMode)meta.uploadMode));
+    serverLink.collectHeader("X-Upload-Policy");
+    code = serverLink.post(URL, contentType, *body, bodyLen);
+    if (code > 0) uploadPolicy.update(serverLink.collected().c_str(), millis());
+  }
+  if (code < 0 || code >= 500) {
+    // Replays go through the upload queue, so only journal what fits in it
+    body->rewind();
+    if (bodyLen <= ASYNC_UPLOAD_MAX_BYTES && journal.append(meta, contentType, *body, bodyLen)) {
+      Serial.printf(">> Event #%lu journaled for replay\n", (unsigned long)meta.seq);
+    } else {
+      captureOverflow.dropped++;
+      Serial.printf("! Event #%lu (%u bytes) could not be journaled, dropped\n",
+                    (unsigned long)meta.seq, (unsigned)bodyLen);
+    }
+  }
+  handleUploadResult(code);
+}
+
+void replayJournal() {
+  EventMeta meta;
+  char contentType[JOURNAL_CONTENT_TYPE_SIZE];
+  uint8_t* data;
+  size_t length;
+  if (!journal.loadNext(meta, contentType, data, length)) {
+    replayAt = millis() + replayBackoffMs;
+    return;
+  }
+  if (!uploader.enqueue(data, length, contentType, meta)) {
+    // Only possible with too little heap; try again later
+    replayAt = millis() + replayBackoffMs;
+    return;
+  }
+  Serial.printf(">> Replaying journaled event #%lu (%u bytes), %d in journal\n",
+                (unsigned long)meta.seq, (unsigned)length, journal.count());
+}
+
+void handleUploadResult(int code) {
+  if (code < 0 || code >= 500) {
+    // Server unreachable or failing; the event is in the journal, back off
+    // before replaying it
+    // A busy server (503 + X-Upload-Policy: retry) says how long to wait
+    unsigned long wait = max(replayBackoffMs, uploadPolicy.retryIn(millis()));
+    Serial.printf("! POST error (%d), %d events journaled, retry in %lus\n",
+                  code, journal.count(), wait / 1000);
     digitalWrite(LED_PIN, HIGH);
-    ESP.restart();
+    replayAt = millis() + wait;
+    replayBackoffMs = min(replayBackoffMs * 2, REPLAY_BACKOFF_MAX_MS);
   }
-  else if (code != 201) {
+  else if (code != 201 && code != 200) {
     Serial.printf("! POST returned %d\n", code);
     digitalWrite(LED_PIN, HIGH);
   }
   else {
-    Serial.println(">> Waveform event sent successfully");
+    // 200 is the server acknowledging a seq it already has (replayed event)
+    Serial.println(code == 201 ? ">> Waveform event sent successfully" : ">> Waveform event already on server");
+    replayAt = millis();
+    replayBackoffMs = REPLAY_BACKOFF_MIN_MS;
   }
-}
\ No newline at end of file
+}
@@ -3,3 +3,6 @@
 #define URL ""
 #define ROOT_URL ""
 
+// -DSERVER_TLS=1 builds only: SHA-1 of the server certificate, as
+// openssl x509 -noout -fingerprint -sha1 -in cert.pem prints it
+// #define SECRET_SERVER_FINGERPRINT "AA:BB:CC:DD:EE:FF:00:11:22:33:44:55:66:77:88:99:AA:BB:CC:DD"
@@ -0,0 +1,283 @@
+#include "async_upload.h"
+#include <ESP8266HTTPClient.h>
+#include "server_link.h"
+#include "heap_monitor.h"
+
+namespace {
+
+// Print sink over a caller-owned buffer sized by PieceStream::measure()
+class HeapPrint : public Print {
+  public:
+    HeapPrint(uint8_t* data, size_t capacity) : data(data), capacity(capacity) {}
+    size_t length = 0;
+    using Print::write;
+    size_t write(uint8_t c) override {
+      if (length >= capacity) return 0;
+      data[length++] = c;
+      return 1;
+    }
+  private:
+    uint8_t* data;
+    size_t   capacity;
+};
+
+}  // namespace
+
+void AsyncUploader::begin(const char* url, ServerTls* serverTls, EventJournal* eventJournal,
+                          UploadPolicy* uploadPolicy, MessageLink* messageLink) {
+  splitUrl(url, host, port, path);
+  tls = serverTls;
+  tls->configure(client);
+  journal = eventJournal;
+  policy = uploadPolicy;
+  link = messageLink;
+}
+
+bool AsyncUploader::enqueue(PieceStream& body, const char* contentType, const EventMeta& meta) {
+  if (queued >= ASYNC_UPLOAD_SLOTS) return refuse();
+  size_t length = body.measure();
+  if (queuedBytes + length > ASYNC_UPLOAD_MAX_BYTES) return refuse();
+  uint8_t* data = (uint8_t*)malloc(length);
+  if (!data) return refuse();
+
+  HeapPrint out(data, length);
+  body.rewind();
+  char chunk[64];
+  size_t n;
+  while ((n = body.readBytes(chunk, sizeof(chunk))) > 0) out.write((const uint8_t*)chunk, n);
+
+  return enqueue(data, length, contentType, meta);
+}
+
+bool AsyncUploader::enqueue(uint8_t* data, size_t length, const char* contentType, const EventMeta& meta) {
+  if (queued >= ASYNC_UPLOAD_SLOTS || queuedBytes + length > ASYNC_UPLOAD_MAX_BYTES) {
+    free(data);
+    return refuse();
+  }
+  Slot& s = slots[(head + queued) % ASYNC_UPLOAD_SLOTS];
+  s.data   = data;
+  s.length = length;
+  strncpy(s.contentType, contentType, sizeof(s.contentType) - 1);
+  s.contentType[sizeof(s.contentType) - 1] = '\0';
+  s.meta   = meta;
+  s.queuedAt = millis();
+  queued++;
+  queuedBytes += length;
+  return true;
+}
+
+// The slot's Content-Type and X-* header lines, as both transports send them
+int AsyncUploader::formatMeta(char* out, size_t size, const Slot& s) const {
+  int n = snprintf(out, size,
+                   "Content-Type: %s\r\n"
+                   "X-Event-Seq: %lu\r\n"
+                   "X-Seq-Epoch: %08lx\r\n"
+                   "X-Event-Millis: %lu\r\n"
+                   "X-Boot: %lu\r\n",
+                   s.contentType, (unsigned long)s.meta.seq,
+                   (unsigned long)(journal ? journal->seqEpoch() : 0),
+                   s.meta.eventTime, (unsigned long)s.meta.bootCount);
+  if (s.meta.epochUs > 0) {
+    n += snprintf(out + n, size - n, "X-Event-Time-Us: %lld\r\n"
+                  "X-Event-Time-Source: %s\r\n",
+                  (long long)s.meta.epochUs, timeSourceName(s.meta.timeSource));
+  }
+  // millis() from an earlier boot says nothing about the event's age
+  if (!journal || s.meta.bootCount == journal->bootCount()) {
+    unsigned long now = millis();
+    n += snprintf(out + n, size - n, "X-Event-Offset-Ms: %lu\r\n"
+                  "X-Event-Trace: %lu,%lu\r\n",
+                  now - s.meta.eventTime, s.queuedAt - s.meta.eventTime, now - s.queuedAt);
+  }
+  if (s.meta.localPeers) {
+    n += snprintf(out + n, size - n, "X-Event-Local: %u\r\n", (unsigned)s.meta.localPeers);
+  }
+  if (s.meta.uploadMode) {
+    n += snprintf(out + n, size - n, "X-Upload-Mode: %s\r\n",
+                  uploadModeName((UploadMode)s.meta.uploadMode));
+  }
+  n += snprintf(out + n, size - n, "X-Heap: ");
+  n += HeapMonitor::formatNow(out + n, size - n);
+  n += snprintf(out + n, size - n, "\r\n");
+  return n;
+}
+
+bool AsyncUploader::startHead() {
+  Slot& s = slots[head];
+  if (!client.connected()) {
+    client.stop();
+    if (!tls->connect(client, host.c_str(), port)) return false;
+    client.setNoDelay(true);
+  }
+  char header[512];
+  int n = snprintf(header, sizeof(header),
+                   "POST %s HTTP/1.1\r\n"
+                   "Host: %s:%u\r\n"
+                   "Content-Length: %u\r\n",
+                   path.c_str(), host.c_str(), port, (unsigned)s.length);
+  n += formatMeta(header + n, sizeof(header) - n, s);
+  n += snprintf(header + n, sizeof(header) - n, "Connection: keep-alive\r\n\r\n");
+  return client.write((const uint8_t*)header, n) == (size_t)n;
+}
+
+// The head slot onto the MQTT link or session instead, if it can take it now
+bool AsyncUploader::startPublish() {
+#if MQTT_LINK || SESSION_LINK
+  if (!link || !link->writable()) return false;
+  const Slot& s = slots[head];
+  int n = formatMeta(linkHead, sizeof(linkHead) - 2, s);
+  n += snprintf(linkHead + n, sizeof(linkHead) - n, "\r\n");
+  return link->startPublish("event", (const uint8_t*)linkHead, n, s.data, s.length);
+#else
+  return false;
+#endif
+}
+
+// Accumulate one CRLF-terminated response line; true once complete
+bool AsyncUploader::readLine() {
+  while (client.available()) {
+    char c = client.read();
+    if (c == '\n') {
+      line[lineLen] = '\0';
+      lineLen = 0;
+      return true;
+    }
+    if (c != '\r' && lineLen < sizeof(line) - 1) line[lineLen++] = c;
+  }
+  return false;
+}
+
+void AsyncUploader::finishHead(int code) {
+  Slot& s = slots[head];
+  if (journal) {
+    bool retry = code < 0 || code >= 500;
+    if (retry && !s.meta.journaled) {
+      if (journal->append(s.meta, s.contentType, s.data, s.length)) {
+        Serial.printf(">> Event #%lu journaled for replay\n", (unsigned long)s.meta.seq);
+      }
+    } else if (!retry && s.meta.journaled) {
+      // Accepted, duplicate or rejected outright; none will change on retry
+      journal->remove(s.meta.seq);
+    }
+  }
+  free(s.data);
+  queuedBytes -= slots[head].length;
+  slots[head] = {};
+  head = (head + 1) % ASYNC_UPLOAD_SLOTS;
+  queued--;
+  state = IDLE;
+#if SERVER_TLS
+  // An idle TLS socket holds TLS_CLIENT_HEAP; the next upload resumes
+  if (!queued) client.stop();
+#endif
+}
+
+bool AsyncUploader::takeQueued(uint8_t level, EventMeta& meta, char* contentType, uint8_t*& data,
+                               size_t& length) {
+  if (queued < 2) return false;   // the head may already be on the wire
+  Slot& s = slots[(head + queued - 1) % ASYNC_UPLOAD_SLOTS];
+  if (s.meta.level >= level) return false;
+  meta   = s.meta;
+  data   = s.data;
+  length = s.length;
+  memcpy(contentType, s.contentType, JOURNAL_CONTENT_TYPE_SIZE);
+  queuedBytes -= s.length;
+  s = {};
+  queued--;
+  return true;
+}
+
+void AsyncUploader::appendQuery(String& url) const {
+  url += "&upq=";
+  url += queued;                      url += ',';
+  url += (unsigned long)queuedBytes;  url += ',';
+  url += (int)state;                  url += ',';
+  url += (unsigned long)refused;
+}
+
+bool AsyncUploader::poll(int& code) {
+  if (state == IDLE) {
+    if (!queued) return false;
+    startedAt = millis();
+    sent = 0;
+    status = 0;
+    contentLength = -1;
+    policySeen = false;
+    lineLen = 0;
+    if (startPublish()) {
+      state = MQTT_PUBLISH;
+      return false;
+    }
+    if (!startHead()) {
+      client.stop();
+      code = HTTPC_ERROR_CONNECTION_FAILED;
+      finishHead(code);
+      return true;
+    }
+    state = SENDING;
+  }
+
+  if (state == MQTT_PUBLISH) {
+    // The link times out the PUBACK itself
+    int result = link->publishResult();
+    if (!result) return false;
+    code = result > 0 ? result : HTTPC_ERROR_CONNECTION_LOST;
+    finishHead(code);
+    return true;
+  }
+
+  if (millis() - startedAt > ASYNC_UPLOAD_TIMEOUT_MS || (!client.connected() && state != DRAIN_BODY)) {
+    client.stop();
+    code = status > 0 ? status : HTTPC_ERROR_READ_TIMEOUT;
+    finishHead(code);
+    return true;
+  }
+
+  const Slot& s = slots[head];
+  switch (state) {
+    case SENDING: {
+      size_t room = client.availableForWrite();
+      size_t n = min(min(room, (size_t)ASYNC_UPLOAD_CHUNK), s.length - sent);
+      if (n > 0) sent += client.write(s.data + sent, n);
+      if (sent >= s.length) state = AWAIT_STATUS;
+      return false;
+    }
+    case AWAIT_STATUS:
+      // "HTTP/1.1 201 Created"
+      if (!readLine()) return false;
+      status = (strncmp(line, "HTTP/", 5) == 0 && strchr(line, ' ')) ? atoi(strchr(line, ' ') + 1) : 0;
+      state = AWAIT_HEADERS;
+      return false;
+    case AWAIT_HEADERS:
+      while (readLine()) {
+        if (line[0] == '\0') {
+          // End of headers; without a length we can't find the end of the
+          // body, so give up on reusing the socket
+          if (contentLength < 0) client.stop();
+          if (policy && !policySeen) policy->update(nullptr, millis());
+          state = DRAIN_BODY;
+          break;
+        }
+        if (strncasecmp(line, "Content-Length:", 15) == 0) contentLength = atol(line + 15);
+        if (policy && strncasecmp(line, "X-Upload-Policy:", 16) == 0) {
+          const char* v = line + 16;
+          while (*v == ' ') v++;
+          policy->update(v, millis());
+          policySeen = true;
+        }
+      }
+      if (state != DRAIN_BODY) return false;
+      // fall through
+    case DRAIN_BODY:
+      while (contentLength > 0 && client.available()) {
+        client.read();
+        contentLength--;
+      }
+      if (contentLength > 0) return false;
+      code = status;
+      finishHead(code);
+      return true;
+    default:
+      return false;
+  }
+}
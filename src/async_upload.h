@@ -0,0 +1,120 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+#include "waveform_stream.h"
+#include "event_journal.h"
+#include "upload_policy.h"
+#include "server_tls.h"
+#include "mqtt_link.h"
+#include "session_link.h"
+
+// -- Non-blocking event upload ------------------------------------------------
+// A finished capture is rendered once into a heap buffer (fast, CPU only) and
+// handed to AsyncUploader, which writes it to its own keep-alive socket a TCP
+// segment at a time from loop(). Acquisition keeps running the whole time,
+// so a second trigger during an upload is captured and queued behind it.
+//
+// The only blocking step left is the TCP connect when the socket has dropped
+// (a few hundred ms at most, covered by the sensor FIFO; in a TLS build a
+// resumed handshake adds a round trip).
+//
+// With a journal attached, a body that fails with a connection error or 5xx
+// is written to it for replay, and a replayed body is removed from it once
+// the server has accepted it. With a policy attached, each response's
+// X-Upload-Policy updates it.
+//
+// With an MQTT link attached and connected, each upload is published to its
+// event topic instead (request headers, a blank line, the body) and the
+// broker's PUBACK counts as a 201; a lost link counts as a connection error.
+// A device session (session_link.h) takes the same bytes as EVENT frames,
+// and its ACK carries the POST's own status.
+#define ASYNC_UPLOAD_SLOTS      2        // bodies queued or in flight
+#define ASYNC_UPLOAD_MAX_BYTES  16384    // heap budget across all slots
+#define ASYNC_UPLOAD_CHUNK      536      // bytes written per poll (one MSS)
+#define ASYNC_UPLOAD_TIMEOUT_MS 10000    // whole request, connect to response
+
+class AsyncUploader {
+  public:
+    void begin(const char* url, ServerTls* tls,   // e.g. URL from arduino_secrets.h
+               EventJournal* journal = nullptr, UploadPolicy* policy = nullptr,
+               MessageLink* link = nullptr);
+
+    // Render body into a queued buffer. The event's seq and time go out as
+    // X-Event-Seq / X-Event-Time-Us (+ -Source), its trigger millis() as
+    // X-Event-Millis with X-Boot, and its age as X-Event-Offset-Ms (plus
+    // an X-Heap reading) when the request is actually sent. Same-boot events also carry
+    // X-Event-Trace: "<trigger to queued ms>,<queued to sent ms>", and a locally
+    // confirmed one X-Event-Local: <peers>, a degraded one X-Upload-Mode. Returns
+    // false if the queue is full or there isn't heap for it.
+    bool enqueue(PieceStream& body, const char* contentType, const EventMeta& meta);
+
+    // Queue an already rendered malloc'd body (e.g. from the journal); the
+    // uploader takes ownership of data in either case.
+    bool enqueue(uint8_t* data, size_t length, const char* contentType, const EventMeta& meta);
+
+    // Advance the current upload. Returns true when one has finished, with
+    // its HTTP status (or a negative HTTPC_ERROR_* code) in 'code'.
+    bool poll(int& code);
+
+    // Hand back the body queued behind the one in flight if it ranks below
+    // level (EventMeta::level), freeing its slot for a more severe event.
+    // The caller owns data then; false if there is no such body.
+    bool takeQueued(uint8_t level, EventMeta& meta, char* contentType, uint8_t*& data, size_t& length);
+
+    bool   busy() const { return queued > 0; }
+    size_t bytesQueued() const { return queuedBytes; }
+    uint32_t refusedCount() const { return refused; }   // enqueue() returned false
+
+    // "&upq=queued,queued_bytes,state,refused": the slots now (state of the
+    // one in flight, 0 idle .. 4 draining the response, 5 on MQTT or the session) and refusals
+    // since boot
+    void appendQuery(String& url) const;
+
+  private:
+    enum State { IDLE, SENDING, AWAIT_STATUS, AWAIT_HEADERS, DRAIN_BODY, MQTT_PUBLISH };
+
+    struct Slot {
+      uint8_t*  data;
+      size_t    length;
+      char      contentType[JOURNAL_CONTENT_TYPE_SIZE];
+      EventMeta meta;
+      unsigned long queuedAt;   // millis() the body was queued
+    };
+
+    bool refuse() {
+      refused++;
+      return false;
+    }
+    int  formatMeta(char* out, size_t size, const Slot& s) const;
+    bool startHead();
+    bool startPublish();
+    bool readLine();
+    void finishHead(int code);
+
+    EventJournal* journal = nullptr;
+    UploadPolicy* policy = nullptr;
+    bool          policySeen = false;   // this response had X-Upload-Policy
+    ServerTls*    tls = nullptr;
+    MessageLink*  link = nullptr;
+#if MQTT_LINK || SESSION_LINK
+    char          linkHead[384];        // the published headers, until the link has them
+#endif
+    ServerClient client;
+    String     host;
+    String     path;
+    uint16_t   port = 80;
+
+    Slot   slots[ASYNC_UPLOAD_SLOTS] = {};
+    int    head = 0;            // slot being uploaded
+    int    queued = 0;
+    size_t queuedBytes = 0;
+    uint32_t refused = 0;
+
+    State         state = IDLE;
+    size_t        sent = 0;
+    unsigned long startedAt = 0;
+    int           status = 0;
+    long          contentLength = -1;
+    char          line[96];
+    size_t        lineLen = 0;
+};
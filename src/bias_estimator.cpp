@@ -0,0 +1,79 @@
+#include "bias_estimator.h"
+
+void BiasEstimator::begin() {
+  *this = BiasEstimator();
+}
+
+CalibState BiasEstimator::add(int16_t x, int16_t y, int16_t z) {
+  if (state != CALIB_RUNNING) return state;
+  const int16_t v[3] = { x, y, z };
+  for (int a = 0; a < 3; a++) {
+    if (!inBlock || v[a] < lo[a]) lo[a] = v[a];
+    if (!inBlock || v[a] > hi[a]) hi[a] = v[a];
+    sum[a] += v[a];
+    total[a] += v[a];
+  }
+  readCount++;
+  if (++inBlock == CALIB_BLOCK_SAMPLES) closeBlock();
+
+  float se = standardError();
+  if (blocks >= CALIB_MIN_BLOCKS && se >= 0 && se < CALIB_SEM_LSB) state = CALIB_CONVERGED;
+  else if (blocks >= CALIB_MAX_BLOCKS || readCount >= CALIB_MAX_READS) state = CALIB_CAPPED;
+  return state;
+}
+
+void BiasEstimator::closeBlock() {
+  float m[3];
+  bool moved = false, stepped = false;
+  for (int a = 0; a < 3; a++) {
+    m[a] = (float)sum[a] / CALIB_BLOCK_SAMPLES;
+    moved |= hi[a] - lo[a] > CALIB_MOTION_LSB;
+    stepped |= blocks && fabsf(m[a] - (float)avg[a]) > CALIB_STEP_LSB;
+    sum[a] = 0;
+  }
+  inBlock = 0;
+
+  if (moved) {
+    rejectedBlocks++;
+    return;
+  }
+  if (!stepped) {
+    stepRun = 0;
+    accept(m);
+    return;
+  }
+  rejectedBlocks++;
+  if (stepRun++ == 0) memcpy(stepMean, m, sizeof(stepMean));
+  if (stepRun < CALIB_STEP_RETRY) return;
+  // Settled somewhere else: start over from the first block there
+  restartCount++;
+  blocks = 0;
+  stepRun = 0;
+  accept(stepMean);
+}
+
+void BiasEstimator::accept(const float m[3]) {
+  blocks++;
+  for (int a = 0; a < 3; a++) {
+    if (blocks == 1) {
+      avg[a] = m[a];
+      m2[a] = 0;
+      continue;
+    }
+    double d = m[a] - avg[a];
+    avg[a] += d / blocks;
+    m2[a] += d * (m[a] - avg[a]);
+  }
+}
+
+float BiasEstimator::mean(int axis) const {
+  if (blocks) return (float)avg[axis];
+  return readCount ? (float)(total[axis] / readCount) : 0.0f;
+}
+
+float BiasEstimator::standardError() const {
+  if (blocks < 2) return -1;
+  double worst = 0;
+  for (int a = 0; a < 3; a++) worst = max(worst, m2[a] / (blocks - 1));
+  return (float)sqrt(worst / blocks);
+}
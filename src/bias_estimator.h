@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Calibration convergence --------------------------------------------------
+// The at-rest bias as an online mean that stops as soon as it is good enough,
+// instead of a fixed 2000 reads. Reads come in blocks of CALIB_BLOCK_SAMPLES;
+// each closed block either joins the estimate or is thrown away:
+//   - peak-to-peak above CALIB_MOTION_LSB on any axis: a tap or a footstep
+//   - block mean more than CALIB_STEP_LSB from the estimate: the sensor moved
+//     or is still settling. After CALIB_STEP_RETRY of those in a row the
+//     estimate starts over from that block (it was the old position that was
+//     wrong).
+// The accepted block means feed a Welford mean/variance, and the standard
+// error is their spread over sqrt(blocks) (batch means, so the correlation
+// the DLPF puts between neighbouring reads doesn't make it look better than
+// it is). Done once at least CALIB_MIN_BLOCKS are in and the worst axis is
+// under CALIB_SEM_LSB; capped at CALIB_MAX_BLOCKS accepted or
+// CALIB_MAX_READS reads, whichever comes first.
+#define CALIB_BLOCK_SAMPLES 100
+#define CALIB_MIN_BLOCKS    5       // ~1.2s at the calibration read rate
+#define CALIB_MAX_BLOCKS    40      // ~10s
+#define CALIB_MAX_READS     8000    // ~20s, motion included
+#define CALIB_SEM_LSB       3.0f    // ~0.2mg, far below any trigger threshold
+#define CALIB_MOTION_LSB    1600    // ~0.1g; rest noise is ~700 LSB p-p at DLPF 188Hz
+#define CALIB_STEP_LSB      100
+#define CALIB_STEP_RETRY    3
+
+enum CalibState : uint8_t {
+  CALIB_RUNNING,
+  CALIB_CONVERGED,    // standard error under target
+  CALIB_CAPPED,       // ran out of blocks or reads; the mean is what there is
+};
+
+class BiasEstimator {
+  public:
+    void begin();
+
+    // One raw read; CALIB_RUNNING until the estimate is done
+    CalibState add(int16_t x, int16_t y, int16_t z);
+
+    // Mean of the accepted blocks, or of every read if none was accepted
+    float mean(int axis) const;
+    // Standard error of the mean, worst axis (LSB); -1 below two blocks
+    float standardError() const;
+
+    int reads() const { return readCount; }
+    int accepted() const { return blocks * CALIB_BLOCK_SAMPLES; }
+    int rejected() const { return rejectedBlocks; }
+    int restarts() const { return restartCount; }
+
+  private:
+    void closeBlock();
+    void accept(const float m[3]);
+
+    // Open block
+    int32_t    sum[3] = {};
+    int16_t    lo[3] = {}, hi[3] = {};
+    int        inBlock = 0;
+    // Accepted block means (Welford)
+    int        blocks = 0;
+    double     avg[3] = {};
+    double     m2[3] = {};
+    // Every read, for the no-accepted-block fallback
+    double     total[3] = {};
+    int        readCount = 0;
+    int        stepRun = 0;           // consecutive blocks off by a step
+    float      stepMean[3] = {};      // the first of them
+    int        rejectedBlocks = 0;
+    int        restartCount = 0;
+    CalibState state = CALIB_RUNNING;
+};
@@ -0,0 +1,34 @@
+#include "bias_tracker.h"
+
+void BiasTracker::begin(int sampleRateHz, unsigned long tauMs, int32_t maxStepLsb,
+                        int32_t maxDriftLsb, float x, float y, float z) {
+  float v[3] = { x, y, z };
+  for (int i = 0; i < 3; i++) {
+    origin[i] = mean[i] = (int64_t)llroundf(v[i] * 65536.0f);
+  }
+  maxStep  = (int64_t)maxStepLsb  << 16;
+  maxDrift = (int64_t)maxDriftLsb << 16;
+  limited  = false;
+  if (tauMs == 0) {
+    alpha = 0;
+    return;
+  }
+  uint32_t samples = max(1UL, tauMs * (unsigned long)sampleRateHz / 1000UL);
+  alpha = max(1UL, 65536UL / samples);
+}
+
+void BiasTracker::update(int16_t x, int16_t y, int16_t z) {
+  if (!alpha) return;
+  int16_t v[3] = { x, y, z };
+  for (int i = 0; i < 3; i++) {
+    int64_t err = ((int64_t)v[i] << 16) - mean[i];
+    err = constrain(err, -maxStep, maxStep);
+    int64_t m = mean[i] + ((err * alpha) >> 16);
+    int64_t lo = origin[i] - maxDrift, hi = origin[i] + maxDrift;
+    if (m < lo || m > hi) {
+      m = constrain(m, lo, hi);
+      limited = true;
+    }
+    mean[i] = m;
+  }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Background bias tracking -------------------------------------------------
+// Slow exponential mean of the at-rest signal per axis, so thermal drift is
+// re-zeroed in place instead of by a 205 reinit (reboot + 4s calibration).
+// Same Q16 recursive average as the STA/LTA detector, with time constant
+// tauMs. Three clamps keep a real event from dragging it:
+//   - the caller only feeds samples while idle and quiet (see update())
+//   - each sample moves the mean by at most maxStepLsb worth of error
+//   - the mean never leaves +/-maxDriftLsb of the calibrated bias; past that
+//     the sensor has probably been moved and wants a real recalibration
+class BiasTracker {
+  public:
+    void begin(int sampleRateHz, unsigned long tauMs, int32_t maxStepLsb, int32_t maxDriftLsb,
+               float x, float y, float z);
+
+    bool enabled() const { return alpha > 0; }
+
+    // Feed one raw sample. Call only when not capturing and the signal is well
+    // below the trigger threshold.
+    void update(int16_t x, int16_t y, int16_t z);
+
+    // Current bias, rounded for the integer hot path or as float LSB
+    int32_t lsb(int axis) const { return (int32_t)((mean[axis] + 0x8000) >> 16); }
+    float   value(int axis) const { return mean[axis] / 65536.0f; }
+
+    // True once the mean has hit the drift limit on any axis
+    bool    atLimit() const { return limited; }
+
+  private:
+    int64_t  mean[3] = {};       // Q16 LSB
+    int64_t  origin[3] = {};     // calibrated bias, Q16
+    int64_t  maxStep = 0;        // Q16
+    int64_t  maxDrift = 0;       // Q16
+    uint32_t alpha = 0;          // Q16 smoothing factor, 0 = disabled
+    bool     limited = false;
+};
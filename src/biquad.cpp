@@ -0,0 +1,105 @@
+#include "biquad.h"
+#include "realtime.h"
+
+namespace {
+
+int32_t toQ(double v) {
+  return (int32_t)lround(v * (double)(1L << BIQUAD_Q));
+}
+
+BiquadCoeffs design(float cornerHz, float sampleRateHz, bool highPass) {
+  double w0 = 2.0 * M_PI * cornerHz / sampleRateHz;
+  double cw = cos(w0);
+  double alpha = sin(w0) / (2.0 * M_SQRT1_2);   // sin(w0) / (2Q)
+  double a0 = 1.0 + alpha;
+  double b0 = (highPass ? (1.0 + cw) : (1.0 - cw)) / 2.0;
+  BiquadCoeffs c;
+  c.b0 = toQ(b0 / a0);
+  c.b1 = toQ((highPass ? -2.0 * b0 : 2.0 * b0) / a0);
+  c.b2 = c.b0;
+  c.a1 = toQ(-2.0 * cw / a0);
+  c.a2 = toQ((1.0 - alpha) / a0);
+  return c;
+}
+
+}  // namespace
+
+BiquadCoeffs biquadHighPass(float cornerHz, float sampleRateHz) {
+  return design(cornerHz, sampleRateHz, true);
+}
+
+BiquadCoeffs biquadLowPass(float cornerHz, float sampleRateHz) {
+  return design(cornerHz, sampleRateHz, false);
+}
+
+void Biquad::prime(int32_t x, int32_t y) {
+  x1 = x2 = x;
+  y1 = y2 = y;
+  residual = 0;
+}
+
+RT_IRAM int32_t Biquad::process(int32_t x) {
+  int64_t acc = residual;
+  acc += (int64_t)c.b0 * x + (int64_t)c.b1 * x1 + (int64_t)c.b2 * x2;
+  acc -= (int64_t)c.a1 * y1 + (int64_t)c.a2 * y2;
+  int32_t y = (int32_t)(acc >> BIQUAD_Q);
+  residual = acc - ((int64_t)y << BIQUAD_Q);
+  x2 = x1;
+  x1 = x;
+  y2 = y1;
+  y1 = y;
+  return y;
+}
+
+void AccelFilter::begin(int sampleRateHz, float highPassHz, float lowPassHz) {
+  // Corners at or past ~Nyquist make no sense for a biquad; drop the stage
+  float nyquist = sampleRateHz * 0.45f;
+  hpHz = (highPassHz > 0 && highPassHz < nyquist) ? highPassHz : 0;
+  lpHz = (lowPassHz  > 0 && lowPassHz  < nyquist) ? lowPassHz  : 0;
+  useHighPass = hpHz > 0;
+  useLowPass  = lpHz > 0;
+  for (int i = 0; i < 3; i++) {
+    if (useHighPass) highPass[i].setup(biquadHighPass(hpHz, sampleRateHz));
+    if (useLowPass)  lowPass[i].setup(biquadLowPass(lpHz, sampleRateHz));
+  }
+  primed = false;
+}
+
+RT_IRAM int32_t AccelFilter::run(int axis, int32_t v) {
+  if (useHighPass) v = highPass[axis].process(v);
+  if (useLowPass)  v = lowPass[axis].process(v);
+  return v;
+}
+
+// Start from steady state on the first sample so the residual bias
+// doesn't ring through the high-pass and fire a trigger at boot
+void AccelFilter::prime(int32_t x, int32_t y, int32_t z) {
+  int32_t v[3] = { x, y, z };
+  for (int i = 0; i < 3; i++) {
+    highPass[i].prime(v[i], 0);
+    lowPass[i].prime(useHighPass ? 0 : v[i], useHighPass ? 0 : v[i]);
+  }
+  primed = true;
+}
+
+RT_IRAM void AccelFilter::process(int32_t& x, int32_t& y, int32_t& z) {
+  if (!enabled()) return;
+  if (!primed) prime(x, y, z);
+  x = run(0, x);
+  y = run(1, y);
+  z = run(2, z);
+}
+
+RT_IRAM void AccelFilter::processHighPass(int32_t& x, int32_t& y, int32_t& z) {
+  if (!primed) prime(x, y, z);
+  x = highPass[0].process(x);
+  y = highPass[1].process(y);
+  z = highPass[2].process(z);
+}
+
+RT_IRAM void AccelFilter::processBandPass(int32_t& x, int32_t& y, int32_t& z) {
+  if (!primed) prime(x, y, z);
+  x = lowPass[0].process(highPass[0].process(x));
+  y = lowPass[1].process(highPass[1].process(y));
+  z = lowPass[2].process(highPass[2].process(z));
+}
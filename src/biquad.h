@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Fixed-point biquad filters ----------------------------------------------
+// Direct form I with Q28 coefficients and a 64-bit accumulator. The rounding
+// residual is fed back into the next output (first-order error shaping), so a
+// high-pass with its corner close to DC settles to exactly zero instead of
+// dithering around a truncation offset. Coefficients are designed once, in
+// float, from the RBJ cookbook Butterworth (Q = 1/sqrt(2)) formulas.
+#define BIQUAD_Q 28
+
+struct BiquadCoeffs {
+  int32_t b0, b1, b2, a1, a2;   // Q28, normalised so a0 = 1
+};
+
+BiquadCoeffs biquadHighPass(float cornerHz, float sampleRateHz);
+BiquadCoeffs biquadLowPass(float cornerHz, float sampleRateHz);
+
+class Biquad {
+  public:
+    void    setup(const BiquadCoeffs& coeffs) { c = coeffs; }
+    void    prime(int32_t x, int32_t y);   // steady state for constant input x -> output y
+    int32_t process(int32_t x);
+
+  private:
+    BiquadCoeffs c = {};
+    int32_t x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    int64_t residual = 0;
+};
+
+// -- Detector pre-filter ------------------------------------------------------
+// Optional high-pass (drift and tilt) and low-pass (above the band of
+// interest) per axis, in that order. A corner of 0 disables that stage; with
+// both disabled process() is a no-op. The filters see de-biased LSB and only
+// feed detection - captured and uploaded samples stay raw.
+class AccelFilter {
+  public:
+    void begin(int sampleRateHz, float highPassHz, float lowPassHz);
+    void process(int32_t& x, int32_t& y, int32_t& z);
+    // process() for a filter known to have only the high-pass, or both
+    // stages, testing neither
+    void processHighPass(int32_t& x, int32_t& y, int32_t& z);
+    void processBandPass(int32_t& x, int32_t& y, int32_t& z);
+
+    bool  enabled() const { return useHighPass || useLowPass; }
+    bool  highPassOnly() const { return useHighPass && !useLowPass; }
+    bool  bandPass() const { return useHighPass && useLowPass; }
+    float highPassHz() const { return hpHz; }
+    float lowPassHz() const { return lpHz; }
+
+  private:
+    int32_t run(int axis, int32_t v);
+    void    prime(int32_t x, int32_t y, int32_t z);
+
+    Biquad highPass[3];
+    Biquad lowPass[3];
+    bool   useHighPass = false;
+    bool   useLowPass = false;
+    bool   primed = false;
+    float  hpHz = 0, lpHz = 0;
+};
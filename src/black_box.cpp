@@ -0,0 +1,295 @@
+#include "black_box.h"
+
+namespace {
+
+const uint16_t BLOCK_MAGIC   = 0xB10C;
+const char     SEGMENT_MAGIC[4] = { 'B', 'B', 'S', '1' };
+const size_t   SEGMENT_BYTES = BLACKBOX_HEADER_BYTES + (size_t)BLACKBOX_SEGMENT_BLOCKS * BLACKBOX_BLOCK_BYTES;
+const int      HALF_BLOCK    = BLACKBOX_BLOCK_BYTES / 2;
+
+static_assert(sizeof(BlackBoxBlock) == BLACKBOX_BLOCK_BYTES, "block layout");
+static_assert(HALF_BLOCK <= PIECE_BUFFER_SIZE, "a half block is one piece");
+
+struct SegmentHeader {
+  char     magic[4];
+  uint32_t generation;
+  uint16_t rateHz;
+  uint16_t blockBytes;
+  uint32_t reserved;
+};
+
+// Epoch second of the block's last sample
+uint32_t lastSecond(const BlackBoxBlock& b) {
+  return (uint32_t)((b.epochMs + (int64_t)(b.count - 1) * 1000 / b.rateHz) / 1000);
+}
+
+}  // namespace
+
+bool BlackBox::begin(int sampleRateHz) {
+  segments = 0;
+  if (BLACKBOX_SEGMENTS <= 0 || sampleRateHz % BLACKBOX_RATE_HZ) return false;
+  FSInfo info;
+  if (!LittleFS.info(info)) return false;
+  LittleFS.mkdir(BLACKBOX_DIR);
+
+  // What the old segments take is ours to reuse
+  size_t ours = 0;
+  char name[24];
+  for (int i = 0; i < BLACKBOX_SEGMENTS; i++) {
+    path(i, name);
+    File f = LittleFS.open(name, "r");
+    if (f) ours += f.size();
+  }
+  size_t room = info.totalBytes - info.usedBytes + ours;
+  int fit = room > BLACKBOX_RESERVE_BYTES ? (int)((room - BLACKBOX_RESERVE_BYTES) / SEGMENT_BYTES) : 0;
+  segments = min(fit, BLACKBOX_SEGMENTS);
+  if (segments < 2) {
+    segments = 0;
+    return false;
+  }
+
+  // The index, from each segment's header and its first and last block
+  for (int i = 0; i < BLACKBOX_SEGMENTS; i++) {
+    path(i, name);
+    if (i >= segments) {
+      LittleFS.remove(name);   // the FS shrank under a previous ring
+      continue;
+    }
+    index[i] = {};
+    File f = LittleFS.open(name, "r");
+    SegmentHeader h;
+    if (!f || f.read((uint8_t*)&h, sizeof(h)) != sizeof(h) || memcmp(h.magic, SEGMENT_MAGIC, 4) != 0 ||
+        h.blockBytes != BLACKBOX_BLOCK_BYTES) continue;
+    int blocks = (int)min((f.size() - BLACKBOX_HEADER_BYTES) / BLACKBOX_BLOCK_BYTES, (size_t)BLACKBOX_SEGMENT_BLOCKS);
+    BlackBoxBlock first, last;
+    index[i].generation = h.generation;
+    if (blocks > 0 && blockAt(f, 0, first) && blockAt(f, blocks - 1, last)) {
+      index[i].blocks = blocks;
+      index[i].firstS = (uint32_t)(first.epochMs / 1000);
+      index[i].lastS  = lastSecond(last);
+    }
+  }
+
+  decimation = sampleRateHz / BLACKBOX_RATE_HZ;
+  BiquadCoeffs c = biquadLowPass(0.4f * BLACKBOX_RATE_HZ, sampleRateHz);
+  for (int a = 0; a < 3; a++) lowPass[a].setup(c);
+  primed = false;
+  current = -1;
+  return true;
+}
+
+void BlackBox::add(unsigned long ms, int32_t x, int32_t y, int32_t z) {
+  if (!segments) return;
+  if (!clockOffsetMs) {
+    closeBlock();
+    primed = false;
+    return;
+  }
+  int32_t v[3] = { x, y, z };
+  if (!primed) {
+    for (int a = 0; a < 3; a++) lowPass[a].prime(v[a], v[a]);
+    phase = 0;
+    primed = true;
+  }
+  for (int a = 0; a < 3; a++) v[a] = lowPass[a].process(v[a]);
+  if (++phase < decimation) return;
+  phase = 0;
+  int64_t epochMs = clockOffsetMs + (int64_t)ms;
+
+  // Off the block's grid by half a period or more: a gap, or the clock stepped
+  const int64_t periodMs = 1000 / BLACKBOX_RATE_HZ;
+  if (filling.count && llabs(epochMs - nextMs) >= periodMs / 2) closeBlock();
+  if (!filling.count) {
+    filling.magic   = BLOCK_MAGIC;
+    filling.flags   = 0;
+    filling.rateHz  = BLACKBOX_RATE_HZ;
+    filling.epochMs = epochMs;
+  }
+  int16_t* s = filling.xyz + filling.count * 3;
+  for (int a = 0; a < 3; a++) {
+    if (v[a] > 32767 || v[a] < -32768) filling.flags |= 1;
+    s[a] = (int16_t)constrain(v[a], -32768L, 32767L);
+  }
+  filling.count++;
+  nextMs = filling.epochMs + (int64_t)filling.count * 1000 / BLACKBOX_RATE_HZ;
+  if (filling.count == BLACKBOX_BLOCK_SAMPLES) closeBlock();
+}
+
+void BlackBox::closeBlock() {
+  if (!filling.count) return;
+  if (hasWaiting) {
+    dropped++;   // flush() hasn't kept up
+  } else {
+    waiting = filling;
+    hasWaiting = true;
+  }
+  memset(&filling, 0, sizeof(filling));
+}
+
+void BlackBox::flush() {
+  if (!hasWaiting) return;
+  hasWaiting = false;
+  if ((current < 0 || index[current].blocks >= BLACKBOX_SEGMENT_BLOCKS) && !openNext()) {
+    dropped++;
+    return;
+  }
+  if (file.write((const uint8_t*)&waiting, BLACKBOX_BLOCK_BYTES) != BLACKBOX_BLOCK_BYTES) {
+    dropped++;
+    file.close();
+    current = -1;
+    return;
+  }
+  file.flush();   // commit now: a reset loses at most the blocks in RAM
+  Segment& s = index[current];
+  if (!s.blocks) s.firstS = (uint32_t)(waiting.epochMs / 1000);
+  s.lastS = lastSecond(waiting);
+  s.blocks++;
+}
+
+bool BlackBox::openNext() {
+  if (file) file.close();
+  int newest = -1, oldest = 0;
+  for (int i = 0; i < segments; i++) {
+    if (newest < 0 || index[i].generation > index[newest].generation) newest = i;
+    if (index[i].generation < index[oldest].generation) oldest = i;
+  }
+  char name[24];
+  // After a reboot, carry on in the newest segment while it has room
+  if (current < 0 && index[newest].generation && index[newest].blocks < BLACKBOX_SEGMENT_BLOCKS) {
+    path(newest, name);
+    file = LittleFS.open(name, "a");
+    current = newest;
+    return (bool)file;
+  }
+  // Else the oldest one goes, header first
+  uint32_t generation = index[newest].generation + 1;
+  index[oldest] = {};
+  path(oldest, name);
+  file = LittleFS.open(name, "w");
+  current = -1;
+  if (!file) return false;
+  SegmentHeader h = {};
+  memcpy(h.magic, SEGMENT_MAGIC, 4);
+  h.generation = generation;
+  h.rateHz     = BLACKBOX_RATE_HZ;
+  h.blockBytes = BLACKBOX_BLOCK_BYTES;
+  if (file.write((const uint8_t*)&h, sizeof(h)) != sizeof(h)) {
+    file.close();
+    return false;
+  }
+  index[oldest].generation = generation;
+  current = oldest;
+  return true;
+}
+
+uint32_t BlackBox::oldestSecond() const {
+  uint32_t s = 0;
+  for (int i = 0; i < segments; i++) {
+    if (index[i].blocks && (!s || index[i].firstS < s)) s = index[i].firstS;
+  }
+  return s;
+}
+
+uint32_t BlackBox::newestSecond() const {
+  uint32_t s = 0;
+  for (int i = 0; i < segments; i++) {
+    if (index[i].blocks) s = max(s, index[i].lastS);
+  }
+  return s;
+}
+
+int BlackBox::find(int64_t fromMs, int64_t toMs, BlackBoxSpan* spans, int maxSpans) {
+  // Segments oldest first
+  int order[BLACKBOX_MAX_SPANS];
+  int n = 0;
+  for (int i = 0; i < segments; i++) {
+    if (!index[i].blocks) continue;
+    int k = n++;
+    while (k > 0 && index[order[k - 1]].generation > index[i].generation) {
+      order[k] = order[k - 1];
+      k--;
+    }
+    order[k] = i;
+  }
+
+  int spanCount = 0, taken = 0;
+  char name[24];
+  for (int k = 0; k < n && spanCount < maxSpans && taken < BLACKBOX_PULL_MAX_BLOCKS; k++) {
+    const Segment& s = index[order[k]];
+    if ((int64_t)s.lastS * 1000 + 1000 <= fromMs || (int64_t)s.firstS * 1000 >= toMs) continue;
+    path(order[k], name);
+    File f = LittleFS.open(name, "r");
+    if (!f) continue;
+    // The block before the first one starting in range may run into it
+    int first = max(0, lowerBound(f, s.blocks, fromMs) - 1);
+    int end   = lowerBound(f, s.blocks, toMs);
+    int count = min(end - first, BLACKBOX_PULL_MAX_BLOCKS - taken);
+    if (count <= 0) continue;
+    spans[spanCount++] = { (uint8_t)order[k], (uint16_t)first, (uint16_t)count };
+    taken += count;
+  }
+  return spanCount;
+}
+
+bool BlackBox::read(int segment, int block, BlackBoxBlock& out) {
+  if (segment < 0 || segment >= segments || block >= index[segment].blocks) return false;
+  char name[24];
+  path(segment, name);
+  File f = LittleFS.open(name, "r");
+  return f && blockAt(f, block, out);
+}
+
+void BlackBox::appendQuery(String& url) const {
+  if (!segments) return;
+  url += "&bbox=";
+  url += (unsigned long)oldestSecond();
+  url += ',';
+  url += (unsigned long)newestSecond();
+  url += ',';
+  url += segments;
+  url += ',';
+  url += (unsigned long)dropped;
+}
+
+void BlackBox::path(int segment, char* out) const {
+  snprintf(out, 24, BLACKBOX_DIR "/%02d", segment);
+}
+
+bool BlackBox::blockAt(File& f, int block, BlackBoxBlock& out, size_t bytes) {
+  if (!f.seek(BLACKBOX_HEADER_BYTES + (size_t)block * BLACKBOX_BLOCK_BYTES)) return false;
+  return f.read((uint8_t*)&out, bytes) == bytes && out.magic == BLOCK_MAGIC && out.count > 0 &&
+         out.count <= BLACKBOX_BLOCK_SAMPLES && out.rateHz > 0;
+}
+
+// First block starting at or after ms; block times only go forwards within
+// a segment, short of a clock step back
+int BlackBox::lowerBound(File& f, int blocks, int64_t ms) {
+  int lo = 0, hi = blocks;
+  BlackBoxBlock head;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (blockAt(f, mid, head, BLACKBOX_HEADER_BYTES) && head.epochMs < ms) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+BlackBoxStream::BlackBoxStream(BlackBox& b, const BlackBoxSpan* s, int n)
+    : PieceStream(CaptureView()), box(b), spans(s), spanCount(n) {
+  for (int i = 0; i < n; i++) total += s[i].count;
+}
+
+bool BlackBoxStream::writePiece(Print& out, int index) {
+  int wanted = index / 2;
+  if (wanted >= total) return false;
+  if (loaded != wanted) {
+    int k = 0, rest = wanted;
+    while (rest >= spans[k].count) rest -= spans[k++].count;
+    // A block that no longer reads back still takes its bytes; the server
+    // skips it on the magic
+    if (!box.read(spans[k].segment, spans[k].first + rest, block)) memset(&block, 0, sizeof(block));
+    loaded = wanted;
+  }
+  out.write((const uint8_t*)&block + (index % 2) * HALF_BLOCK, HALF_BLOCK);
+  return true;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "biquad.h"
+#include "waveform_stream.h"
+
+// -- Flash black box ----------------------------------------------------------
+// A continuous low-rate record of the last few hours on LittleFS, so the
+// server can ask for a window long after the sample ring has rolled past it
+// (around a quake catalogued elsewhere that didn't trigger here, say) with
+// nothing streamed in the meantime. De-biased samples are low-passed at 0.4x
+// BLACKBOX_RATE_HZ, decimated to it and packed into fixed-size blocks, which
+// are appended to one of a ring of segment files. A full segment hands over
+// to the oldest, which is truncated and rewritten: every segment takes the
+// same share of the writes, and LittleFS puts each rewrite on fresh erase
+// blocks, so the wear spreads over the whole free area.
+//
+// Block (BLACKBOX_BLOCK_BYTES, little-endian):
+//   0  u16  magic 0xB10C
+//   2  u8   samples used
+//   3  u8   flags, bit 0: a sample clipped at +/-2g
+//   4  u16  rate_hz
+//   6  u16  reserved
+//   8  i64  epoch ms of the first sample; sample i is i * 1000 / rate_hz later
+//   16      x,y,z int16 per sample, de-biased +/-2g LSB
+// A block is one continuous run: a gap or clock step closes it early. A
+// segment is a 16-byte header ("BBS1", u32 generation, u16 rate_hz, u16
+// block bytes, 4 reserved) followed by its blocks. The RAM index is each
+// segment's generation and first/last second; a window is found inside a
+// segment by bisecting its block headers on flash.
+//
+// The block filling and one waiting for flash are the only RAM buffers;
+// flush() writes the waiting one from a task, off the sample path.
+#ifndef BLACKBOX_SEGMENTS
+    #define BLACKBOX_SEGMENTS     16     // 0 = no black box
+#endif
+#define BLACKBOX_MAX_SPANS        (BLACKBOX_SEGMENTS > 0 ? BLACKBOX_SEGMENTS : 1)   // one per segment
+#define BLACKBOX_RATE_HZ          10
+#define BLACKBOX_BLOCK_BYTES      256
+#define BLACKBOX_BLOCK_SAMPLES    40     // (256 - 16) / 6: 4s at 10Hz
+#define BLACKBOX_SEGMENT_BLOCKS   256    // 64KB, ~17 minutes per segment
+#define BLACKBOX_HEADER_BYTES     16
+#define BLACKBOX_RESERVE_BYTES    (96 * 1024UL)   // FS left for the journal and its metadata
+#define BLACKBOX_PULL_MAX_BLOCKS  150    // 10 minutes, ~38KB per pull
+#define BLACKBOX_DIR              "/bbox"
+#define BLACKBOX_CONTENT_TYPE     "application/x-seismo-blackbox"
+
+struct BlackBoxBlock {
+  uint16_t magic;
+  uint8_t  count;
+  uint8_t  flags;
+  uint16_t rateHz;
+  uint16_t reserved;
+  int64_t  epochMs;
+  int16_t  xyz[BLACKBOX_BLOCK_SAMPLES * 3];
+};
+
+// Blocks of one segment inside a pull
+struct BlackBoxSpan {
+  uint8_t  segment;
+  uint16_t first;
+  uint16_t count;
+};
+
+class BlackBox {
+  public:
+    // With LittleFS already mounted (EventJournal::begin()): size the ring to
+    // the free space and read the index back from the segment headers. The
+    // rate must divide by BLACKBOX_RATE_HZ. False leaves it disabled.
+    bool begin(int sampleRateHz);
+    bool enabled() const { return segments > 0; }
+
+    // Wall clock as epoch ms minus millis(), kept current from a task; 0
+    // (not known yet) records nothing. A step shows up as a gap.
+    void setClock(int64_t offsetMs) { clockOffsetMs = offsetMs; }
+
+    // Every de-biased sample, at its millis() timestamp
+    void add(unsigned long ms, int32_t x, int32_t y, int32_t z);
+
+    // Write the block waiting for flash, if any
+    void flush();
+
+    // Whole seconds held, 0 if nothing yet
+    uint32_t oldestSecond() const;
+    uint32_t newestSecond() const;
+
+    // Blocks overlapping [fromMs, toMs), oldest first, up to
+    // BLACKBOX_PULL_MAX_BLOCKS; returns how many spans were filled
+    int find(int64_t fromMs, int64_t toMs, BlackBoxSpan* spans, int maxSpans);
+
+    // Read block 'block' of a segment; false if it doesn't hold one
+    bool read(int segment, int block, BlackBoxBlock& out);
+
+    // "&bbox=oldest_s,newest_s,segments,dropped_blocks" in epoch seconds
+    void appendQuery(String& url) const;
+
+  private:
+    struct Segment {
+      uint32_t generation;     // 0 = never written
+      uint32_t firstS, lastS;  // epoch seconds of the first and last block
+      uint16_t blocks;
+    };
+
+    void   closeBlock();
+    bool   openNext();
+    void   path(int segment, char* out) const;
+    bool   blockAt(File& f, int block, BlackBoxBlock& out, size_t bytes = BLACKBOX_BLOCK_BYTES);
+    int    lowerBound(File& f, int blocks, int64_t ms);
+
+    Segment  index[BLACKBOX_MAX_SPANS] = {};
+    int      segments = 0;
+    int      current = -1;     // segment being appended to
+    File     file;
+    int      decimation = 1;
+    int      phase = 0;
+    Biquad   lowPass[3];
+    bool     primed = false;
+
+    BlackBoxBlock filling = {};
+    BlackBoxBlock waiting = {};
+    bool     hasWaiting = false;
+    int64_t  clockOffsetMs = 0;
+    int64_t  nextMs = 0;       // expected epoch ms of the next decimated sample
+    uint32_t dropped = 0;      // blocks lost to a write that didn't keep up or failed
+};
+
+// POST /api/blackbox body: the found blocks back to back, read off flash a
+// half block at a time
+class BlackBoxStream : public PieceStream {
+  public:
+    BlackBoxStream(BlackBox& box, const BlackBoxSpan* spans, int spanCount);
+    size_t length() const { return (size_t)total * BLACKBOX_BLOCK_BYTES; }
+    int    blocks() const { return total; }
+
+  protected:
+    bool writePiece(Print& out, int index) override;
+
+  private:
+    BlackBox&          box;
+    const BlackBoxSpan* spans;
+    int                spanCount;
+    int                total = 0;
+    BlackBoxBlock      block;
+    int                loaded = -1;   // block held in 'block'
+};
@@ -0,0 +1,29 @@
+#include "boot_timing.h"
+
+void BootTiming::begin() {
+  lastMark = millis();
+  resetReason = ESP.getResetInfoPtr()->reason;
+  pending = true;
+}
+
+void BootTiming::mark(BootPhase phase) {
+  unsigned long now = millis();
+  phaseMs[phase] += now - lastMark;   // a phase can come back (a late recalibration)
+  lastMark = now;
+}
+
+void BootTiming::appendQuery(String& url) const {
+  if (!pending) return;
+  url += "&boot_ms=";
+  url += totalMs;
+  for (int p = 0; p < BOOT_PHASES; p++) {
+    url += ',';
+    url += phaseMs[p];
+  }
+  url += "&boot_wifi=";
+  url += wifiMs;
+  url += ',';
+  url += wifiFast ? '1' : '0';
+  url += "&reset=";
+  url += (unsigned long)resetReason;
+}
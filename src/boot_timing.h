@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Boot timing --------------------------------------------------------------
+// setup() marks the end of each phase; the first heartbeat that gets through
+// carries the breakdown, since /api/init is itself one of the phases:
+//   &boot_ms=total,mpu,calib,wifi,init,config&boot_wifi=assoc_ms,path&reset=N
+// total is millis() when setup() returned (SDK start-up included). wifi is
+// only what setup() still waited for the link after calibration, as the
+// association runs underneath mpu and calib; assoc_ms is the whole of it
+// (WiFi.begin() to an IP, DHCP included), path 1 for the cached AP, 0 for a
+// scan. reset is the SDK's rst_info reason (REASON_DEFAULT_RST = 0, power-on).
+enum BootPhase : uint8_t {
+  BOOT_MPU,       // sensor init and the pre-init settle delay
+  BOOT_CALIB,     // bias restored or measured
+  BOOT_WIFI,      // left-over wait for the link
+  BOOT_INIT,      // GET /api/init
+  BOOT_CONFIG,    // config, buffers, FIFO start
+  BOOT_PHASES
+};
+
+class BootTiming {
+  public:
+    void begin();
+    void mark(BootPhase phase);
+    void wifi(unsigned long assocMs, bool fastPath) {
+      wifiMs = assocMs;
+      wifiFast = fastPath;
+    }
+    void done() { totalMs = millis(); }
+
+    void appendQuery(String& url) const;
+    void reported() { pending = false; }
+
+  private:
+    unsigned long phaseMs[BOOT_PHASES] = {};
+    unsigned long lastMark = 0;
+    unsigned long totalMs = 0;
+    unsigned long wifiMs = 0;
+    bool          wifiFast = false;
+    uint32_t      resetReason = 0;
+    bool          pending = false;
+};
@@ -0,0 +1,89 @@
+#include "calibration_store.h"
+#include <EEPROM.h>
+
+namespace {
+
+const uint32_t CALIB_MAGIC = 0x324C4143;  // "CAL2": with the temperature model
+
+// Word-aligned for rtcUserMemoryRead/Write
+struct CalibrationRecord {
+  uint32_t        magic;
+  char            version[16];
+  CalibrationBias bias;
+  uint32_t        crc;
+};
+
+uint32_t crc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  while (length--) {
+    crc ^= *data++;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+uint32_t recordCrc(const CalibrationRecord& r) {
+  return crc32((const uint8_t*)&r, offsetof(CalibrationRecord, crc));
+}
+
+// version == nullptr accepts a record from any firmware
+bool isValid(const CalibrationRecord& r, const char* version) {
+  if (r.magic != CALIB_MAGIC || r.crc != recordCrc(r)) return false;
+  return !version || strncmp(r.version, version, sizeof(r.version)) == 0;
+}
+
+CalibrationRecord makeRecord(const CalibrationBias& bias, const char* version) {
+  CalibrationRecord r = {};
+  r.magic = CALIB_MAGIC;
+  strncpy(r.version, version, sizeof(r.version) - 1);
+  r.bias = bias;
+  r.crc  = recordCrc(r);
+  return r;
+}
+
+void readEeprom(CalibrationRecord& r) {
+  EEPROM.begin(CALIB_EEPROM_SIZE);
+  EEPROM.get(CALIB_EEPROM_ADDR, r);
+  EEPROM.end();
+}
+
+}  // namespace
+
+static_assert(sizeof(CalibrationRecord) % 4 == 0, "RTC memory is accessed in words");
+static_assert(sizeof(CalibrationRecord) <= CALIB_EEPROM_SIZE, "EEPROM area too small");
+
+bool isColdBoot() {
+  return ESP.getResetInfoPtr()->reason == REASON_DEFAULT_RST;
+}
+
+bool loadCalibration(CalibrationBias& bias, const char* version, const char*& source) {
+  CalibrationRecord r;
+  if (ESP.rtcUserMemoryRead(CALIB_RTC_OFFSET, (uint32_t*)&r, sizeof(r)) && isValid(r, version)) {
+    bias = r.bias;
+    source = "RTC";
+    return true;
+  }
+  readEeprom(r);
+  if (isValid(r, version)) {
+    bias = r.bias;
+    source = "EEPROM";
+    return true;
+  }
+  return false;
+}
+
+bool loadStoredCalibration(CalibrationBias& bias) {
+  CalibrationRecord r;
+  readEeprom(r);
+  if (!isValid(r, nullptr)) return false;
+  bias = r.bias;
+  return true;
+}
+
+void saveCalibration(const CalibrationBias& bias, const char* version) {
+  CalibrationRecord r = makeRecord(bias, version);
+  ESP.rtcUserMemoryWrite(CALIB_RTC_OFFSET, (uint32_t*)&r, sizeof(r));
+  EEPROM.begin(CALIB_EEPROM_SIZE);
+  EEPROM.put(CALIB_EEPROM_ADDR, r);
+  EEPROM.end();  // commits only if the record changed
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Persisted calibration ----------------------------------------------------
+// The at-rest bias takes ~4s of sampling to measure, so it is kept in two
+// places: RTC user memory, which survives every reset except a power cycle,
+// and an EEPROM sector, which survives that too. Each copy carries the
+// firmware version and a CRC; either mismatch invalidates it.
+//
+// Only a power-on boot (or the server's "recalibrate" flag) measures again -
+// the sensor may have been moved or warmed up since. A 205 reinit, OTA or
+// crash reboot restores the bias and goes straight back to sampling.
+#define CALIB_RTC_OFFSET   32   // words; the first 128 bytes belong to OTA (eboot)
+#define CALIB_EEPROM_ADDR  0
+#define CALIB_EEPROM_SIZE  64
+
+struct CalibrationBias {
+  float    x, y, z;       // raw LSB at rest, after any chip offsets
+  float    slopes[3];     // bias drift, LSB per degC (thermal_bias.h); 0 until fitted
+  int16_t  offsets[3];    // XA/YA/ZA_OFFS register values (hardware mode)
+  uint16_t mode;          // CALIB_MODE the bias was measured in
+  int16_t  tempRaw;       // TEMP_OUT when x, y, z were measured
+};
+
+// True when the chip was powered up rather than reset
+bool isColdBoot();
+
+// Restore a bias saved by firmware 'version' from RTC memory, falling back
+// to EEPROM. 'source' is set to "RTC" or "EEPROM" on success.
+bool loadCalibration(CalibrationBias& bias, const char* version, const char*& source);
+
+// Last bias stored in EEPROM regardless of boot type (for drift logging and
+// to carry the fitted temperature slopes over a recalibration)
+bool loadStoredCalibration(CalibrationBias& bias);
+
+// Store to both RTC memory and EEPROM
+void saveCalibration(const CalibrationBias& bias, const char* version);
@@ -0,0 +1,14 @@
+#include "capture_arena.h"
+
+bool CaptureArena::begin(int capacity) {
+  cap = max(1, capacity);
+  head = 0;
+  total = 0;
+  // One block for all three axes, so the arena is a single heap hole
+  int16_t* block = new int16_t[(size_t)cap * 3];
+  if (!block) return false;
+  xs = block;
+  ys = block + cap;
+  zs = block + 2 * cap;
+  return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Capture arena ------------------------------------------------------------
+// One ring of raw samples shared by the pre- and post-event windows, kept as
+// three int16 arrays (struct-of-arrays, 6 bytes per sample) in a single block
+// allocated once at boot. Every sample is pushed, capturing or not, so a
+// trigger right after a capture still has continuous history and nothing is
+// copied between buffers.
+//
+// No timestamps are stored: the sample rate is fixed, so a sample's time is
+// its distance in periods from the trigger. Samples are addressed by sequence
+// number (samples pushed since boot); FIFO gaps are logged against the same
+// numbers. Only the newest capacity() sequence numbers are readable.
+struct WaveSample {
+  int16_t x, y, z;     // raw accelerometer LSB, bias not removed
+};
+
+class CaptureArena {
+  public:
+    // Allocate room for capacity samples; false if the heap can't hold it
+    bool begin(int capacity);
+
+    void push(int16_t x, int16_t y, int16_t z) {
+      xs[head] = x;
+      ys[head] = y;
+      zs[head] = z;
+      if (++head == cap) head = 0;
+      total++;
+    }
+
+    int      capacity() const { return cap; }
+    size_t   bytes() const { return (size_t)cap * 3 * sizeof(int16_t); }
+    uint32_t written() const { return total; }   // sequence number of the next push
+    int      count() const { return total < (uint32_t)cap ? (int)total : cap; }
+
+    // Sample with sequence number seq, one of the last count() pushed
+    WaveSample at(uint32_t seq) const {
+      int back = (int)(total - seq);   // 1 = newest; wraps cleanly past 2^32
+      int i = head - back;
+      if (i < 0) i += cap;
+      return { xs[i], ys[i], zs[i] };
+    }
+
+  private:
+    int16_t* xs = nullptr;
+    int16_t* ys = nullptr;
+    int16_t* zs = nullptr;
+    int      cap = 0;
+    int      head = 0;      // next slot to write
+    uint32_t total = 0;
+};
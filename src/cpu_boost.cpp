@@ -0,0 +1,51 @@
+#include "cpu_boost.h"
+
+extern "C" {
+#include <user_interface.h>
+}
+
+CpuBoost* CpuBoost::instance = nullptr;
+
+void CpuBoost::begin() {
+  baseMhz = ESP.getCpuFreqMHz();
+  depth = 0;
+  reset();
+  instance = this;
+}
+
+void CpuBoost::enter(BoostKind k) {
+  if (depth++ > 0) return;   // the outermost scope's kind gets the time
+  kind = k;
+#if CPU_BOOST
+  if (baseMhz < CPU_BOOST_MHZ) system_update_cpu_freq(SYS_CPU_160MHZ);
+#endif
+  startUs = micros();
+}
+
+void CpuBoost::leave() {
+  if (depth == 0 || --depth > 0) return;
+  uint32_t us = micros() - startUs;
+#if CPU_BOOST
+  if (baseMhz < CPU_BOOST_MHZ) system_update_cpu_freq(SYS_CPU_80MHZ);
+#endif
+  // Saturate rather than wrap if heartbeats fail for over an hour
+  busy[kind] = busy[kind] + us < busy[kind] ? UINT32_MAX : busy[kind] + us;
+  bursts++;
+}
+
+void CpuBoost::appendQuery(String& url) const {
+  if (bursts == 0) return;
+  url += "&busy=";
+  url += (unsigned long)(CPU_BOOST ? max((int)baseMhz, CPU_BOOST_MHZ) : baseMhz);
+  url += ',';
+  url += (unsigned long)bursts;
+  for (int k = 0; k < BOOST_KIND_COUNT; k++) {
+    url += ',';
+    url += (unsigned long)busy[k];
+  }
+}
+
+void CpuBoost::reset() {
+  bursts = 0;
+  memset(busy, 0, sizeof(busy));
+}
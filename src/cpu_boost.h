@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Arduino.h>
+#include "realtime.h"
+
+// -- CPU boost ----------------------------------------------------------------
+// The node idles at 80MHz, which keeps the die (and with it the MPU6050 next
+// to it on the board) cooler and the accel offsets steadier. A CpuBoostScope
+// runs its burst at 160MHz and drops back when the outermost one closes:
+// pushing an upload body through the serializers, closing a capture
+// (spectrum, coherence) and a TLS handshake. None of them touch I2C, whose
+// bit timing (Wire, and Esp8266Wire's cycle counts) is set for 80MHz; the
+// scopes close before the acquire task runs again.
+//
+// Busy time is counted per burst kind whether or not it is boosted, so a
+// -DCPU_BOOST=0 build shows the same figures at 80MHz to compare against.
+// The real-time profile keeps a fixed clock: its ISR jitter is in cycles.
+//
+// Wire format (heartbeat query), comma-separated decimal:
+//   busy = mhz, bursts, upload_us, capture_us, tls_us
+// mhz is what the bursts ran at. The window restarts after a heartbeat gets
+// a 200, as LoopProfile's does.
+#ifndef CPU_BOOST
+    #define CPU_BOOST (!REALTIME_PROFILE)
+#endif
+#if CPU_BOOST && REALTIME_PROFILE
+    #error "REALTIME_PROFILE keeps a fixed CPU clock; build it with CPU_BOOST=0"
+#endif
+#define CPU_BOOST_MHZ 160
+
+enum BoostKind : uint8_t {
+  BOOST_UPLOAD,     // AsyncUploader::poll(): serializers and the socket
+  BOOST_CAPTURE,    // finishCapture(): spectrum, coherence, the upload slot
+  BOOST_TLS,        // ServerTls::connect(): the handshake
+  BOOST_KIND_COUNT
+};
+
+class CpuBoost {
+  public:
+    // Takes the clock setup() left as the idle one
+    void begin();
+
+    void enter(BoostKind kind);
+    void leave();
+
+    uint8_t  idleMhz() const { return baseMhz; }
+    uint32_t busyUs(BoostKind kind) const { return busy[kind]; }
+
+    void appendQuery(String& url) const;
+
+    // Start a new window
+    void reset();
+
+    static CpuBoost* instance;   // what CpuBoostScope reaches, once begin() ran
+
+  private:
+    uint8_t  baseMhz = 80;
+    uint8_t  depth = 0;
+    BoostKind kind = BOOST_UPLOAD;
+    uint32_t startUs = 0;
+    uint32_t bursts = 0;
+    uint32_t busy[BOOST_KIND_COUNT] = {};
+};
+
+// Boosted from here to the end of the block; scopes nest
+class CpuBoostScope {
+  public:
+    explicit CpuBoostScope(BoostKind kind) {
+      if (CpuBoost::instance) CpuBoost::instance->enter(kind);
+    }
+    ~CpuBoostScope() {
+      if (CpuBoost::instance) CpuBoost::instance->leave();
+    }
+
+    CpuBoostScope(const CpuBoostScope&) = delete;
+    CpuBoostScope& operator=(const CpuBoostScope&) = delete;
+};
@@ -0,0 +1,245 @@
+#include "detector.h"
+#include "realtime.h"
+
+namespace {
+
+constexpr bool squared(DetectMetric m) {
+  return m == METRIC_VECTOR || m == METRIC_GRAVITY_HORIZONTAL;
+}
+
+// ΔG of a filtered sample on metric M, squared for the vector ones; g is
+// the Q14 gravity direction
+template <DetectMetric M>
+inline int64_t deviation(int32_t dx, int32_t dy, int32_t dz, const int32_t* g) {
+  if constexpr (M == METRIC_HORIZONTAL) {
+    return max(abs(dx), abs(dy));
+  } else if constexpr (M == METRIC_VERTICAL) {
+    return abs(dz);
+  } else if constexpr (M == METRIC_VECTOR) {
+    return (int64_t)dx * dx + (int64_t)dy * dy + (int64_t)dz * dz;
+  } else if constexpr (M == METRIC_GRAVITY_VERTICAL || M == METRIC_GRAVITY_HORIZONTAL) {
+    int64_t v = ((int64_t)g[0] * dx + (int64_t)g[1] * dy + (int64_t)g[2] * dz) >> 14;
+    if constexpr (M == METRIC_GRAVITY_VERTICAL) return v < 0 ? -v : v;
+    int64_t h = (int64_t)dx * dx + (int64_t)dy * dy + (int64_t)dz * dz - v * v;
+    return h > 0 ? h : 0;
+  } else {
+    return max(abs(dx), max(abs(dy), abs(dz)));
+  }
+}
+
+RT_IRAM int32_t isqrt(int64_t v) {
+  uint64_t r = 0, bit = 1ULL << 62;
+  while (bit > (uint64_t)v) bit >>= 2;
+  while (bit) {
+    if ((uint64_t)v >= r + bit) {
+      v -= r + bit;
+      r = (r >> 1) + bit;
+    } else {
+      r >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (int32_t)r;
+}
+
+// The metric's ΔG back in LSB, for the capture's peak
+template <DetectMetric M>
+inline int32_t linear(int64_t dev) {
+  if constexpr (squared(M)) return isqrt(dev);
+  else return (int32_t)dev;
+}
+
+}  // namespace
+
+EventDetector::EventDetector() : stepFn(&EventDetector::step<METRIC_MAX_ABS>) {
+  select();
+}
+
+void EventDetector::setTriggerMode(TriggerMode m) {
+  mode = m;
+  select();
+}
+
+void EventDetector::setFilter(int sampleRateHz, float highPassHz, float lowPassHz) {
+  pre.begin(sampleRateHz, highPassHz, lowPassHz);
+  select();
+}
+
+void EventDetector::setSpecialized(bool on) {
+  specialize = on;
+  select();
+}
+
+void EventDetector::setThresholds(int32_t minorLsb, int32_t moderateLsb, int32_t severeLsb) {
+  thresholdLsb[LEVEL_MINOR]    = minorLsb;
+  thresholdLsb[LEVEL_MODERATE] = moderateLsb;
+  thresholdLsb[LEVEL_SEVERE]   = severeLsb;
+  setMetric(metricKind);
+}
+
+void EventDetector::setMetric(DetectMetric m) {
+  metricKind = m;
+  switch (m) {
+    case METRIC_HORIZONTAL:
+    case METRIC_VERTICAL:
+    case METRIC_VECTOR:
+    case METRIC_GRAVITY_VERTICAL:
+    case METRIC_GRAVITY_HORIZONTAL:
+      break;
+    default:
+      metricKind = METRIC_MAX_ABS;
+  }
+  for (int l = 0; l < 3; l++) {
+    limit[l] = squared(metricKind) ? (int64_t)thresholdLsb[l] * thresholdLsb[l] : thresholdLsb[l];
+  }
+  select();
+}
+
+// The configurations that get a step() of their own: the /api/init
+// defaults (max-abs, threshold, the 0.1Hz high-pass) and their common
+// variations. Each costs its flash, so the rest share the per-metric ones.
+void EventDetector::select() {
+  static const struct {
+    DetectMetric metric;
+    TriggerMode  mode;
+    Prefilter    filter;
+    Step         step;
+  } PIPELINES[] = {
+    { METRIC_MAX_ABS, TRIGGER_MODE_THRESHOLD, PREFILTER_HIGH_PASS,
+      &EventDetector::step<METRIC_MAX_ABS, TRIGGER_MODE_THRESHOLD, PREFILTER_HIGH_PASS> },
+    { METRIC_MAX_ABS, TRIGGER_MODE_THRESHOLD, PREFILTER_NONE,
+      &EventDetector::step<METRIC_MAX_ABS, TRIGGER_MODE_THRESHOLD, PREFILTER_NONE> },
+    { METRIC_VECTOR, TRIGGER_MODE_THRESHOLD, PREFILTER_HIGH_PASS,
+      &EventDetector::step<METRIC_VECTOR, TRIGGER_MODE_THRESHOLD, PREFILTER_HIGH_PASS> },
+    { METRIC_GRAVITY_VERTICAL, TRIGGER_MODE_THRESHOLD, PREFILTER_HIGH_PASS,
+      &EventDetector::step<METRIC_GRAVITY_VERTICAL, TRIGGER_MODE_THRESHOLD, PREFILTER_HIGH_PASS> },
+    { METRIC_MAX_ABS, TRIGGER_MODE_STA_LTA, PREFILTER_HIGH_PASS,
+      &EventDetector::step<METRIC_MAX_ABS, TRIGGER_MODE_STA_LTA, PREFILTER_HIGH_PASS> },
+    { METRIC_MAX_ABS, TRIGGER_MODE_BOTH, PREFILTER_BAND_PASS,
+      &EventDetector::step<METRIC_MAX_ABS, TRIGGER_MODE_BOTH, PREFILTER_BAND_PASS> },
+  };
+  Prefilter filter = !pre.enabled()      ? PREFILTER_NONE
+                   : pre.highPassOnly() ? PREFILTER_HIGH_PASS
+                   : pre.bandPass()     ? PREFILTER_BAND_PASS
+                   :                      PREFILTER_AT_RUN_TIME;
+  for (const auto& p : PIPELINES) {
+    if (specialize && p.metric == metricKind && p.mode == mode && p.filter == filter) {
+      stepFn = p.step;
+      isSpecialized = true;
+      return;
+    }
+  }
+  isSpecialized = false;
+  switch (metricKind) {
+    case METRIC_HORIZONTAL: stepFn = &EventDetector::step<METRIC_HORIZONTAL>; break;
+    case METRIC_VERTICAL:   stepFn = &EventDetector::step<METRIC_VERTICAL>;   break;
+    case METRIC_VECTOR:     stepFn = &EventDetector::step<METRIC_VECTOR>;     break;
+    case METRIC_GRAVITY_VERTICAL:
+      stepFn = &EventDetector::step<METRIC_GRAVITY_VERTICAL>;
+      break;
+    case METRIC_GRAVITY_HORIZONTAL:
+      stepFn = &EventDetector::step<METRIC_GRAVITY_HORIZONTAL>;
+      break;
+    default:
+      stepFn = &EventDetector::step<METRIC_MAX_ABS>;
+  }
+}
+
+void EventDetector::setGravity(const int16_t unitQ14[3]) {
+  for (int a = 0; a < 3; a++) gravity[a] = unitQ14[a];
+}
+
+void EventDetector::setWindow(int pre, int post, int maxPost, int quiet) {
+  preSamples     = max(0, pre);
+  postSamples    = max(1, post);
+  maxPostSamples = max(postSamples, maxPost);
+  retriggerQuiet = quiet;
+}
+
+EventLevel EventDetector::levelFor(int32_t devLsb) const {
+  if (devLsb >= thresholdLsb[LEVEL_SEVERE])   return LEVEL_SEVERE;
+  if (devLsb >= thresholdLsb[LEVEL_MODERATE]) return LEVEL_MODERATE;
+  return LEVEL_MINOR;
+}
+
+RT_IRAM EventLevel EventDetector::levelAt(int64_t dev) const {
+  if (dev >= limit[LEVEL_SEVERE])   return LEVEL_SEVERE;
+  if (dev >= limit[LEVEL_MODERATE]) return LEVEL_MODERATE;
+  return LEVEL_MINOR;
+}
+
+RT_IRAM void EventDetector::start(uint32_t seq, int history, TriggerMethod trigger, int32_t peakLsb) {
+  active = true;
+  cap.level = levelAt(lastDev);
+  peakDev = lastDev;
+  cap.peakLsb = peakLsb;
+  cap.trigger = trigger;
+  // The trigger sample closes the pre-event window
+  cap.preCount = min(preSamples, history);
+  cap.firstSeq = seq + 1 - (uint32_t)cap.preCount;
+  cap.postCount = 0;
+  cap.retriggerCount = 0;
+  postTarget = postSamples;
+  quietSamples = 0;
+}
+
+RT_IRAM DetectResult EventDetector::process(uint32_t seq, int history, int32_t& dx, int32_t& dy, int32_t& dz) {
+  return (this->*stepFn)(seq, history, dx, dy, dz);
+}
+
+// Mode and Filter fixed at compile time fold the tests on them away
+template <DetectMetric M, uint8_t Mode, uint8_t Filter>
+RT_IRAM DetectResult EventDetector::step(uint32_t seq, int history, int32_t& dx, int32_t& dy, int32_t& dz) {
+  const TriggerMode mode = Mode == AT_RUN_TIME ? this->mode : (TriggerMode)Mode;
+
+  // --- Band-limit for detection only; the arena keeps the raw sample ---
+  if constexpr (Filter == AT_RUN_TIME) pre.process(dx, dy, dz);
+  else if constexpr (Filter == PREFILTER_HIGH_PASS) pre.processHighPass(dx, dy, dz);
+  else if constexpr (Filter == PREFILTER_BAND_PASS) pre.processBandPass(dx, dy, dz);
+  int64_t dev = deviation<M>(dx, dy, dz, gravity);
+  lastDev = dev;
+
+  // --- STA/LTA sees every sample, capturing or not, to keep its averages current ---
+  bool staLtaFired = mode != TRIGGER_MODE_THRESHOLD && sta.update(dx, dy, dz);
+  bool overMinor = mode != TRIGGER_MODE_STA_LTA && dev >= limit[LEVEL_MINOR];
+
+  if (!active) {
+    // STA/LTA can fire below the minor threshold; the level still comes
+    // from the ΔG thresholds
+    if (overMinor) start(seq, history, TRIGGER_THRESHOLD, linear<M>(dev));
+    else if (staLtaFired) start(seq, history, TRIGGER_STA_LTA, linear<M>(dev));
+    else return DETECT_IDLE;
+    return DETECT_STARTED;
+  }
+
+  // --- Capturing: track the peak, keep the window open while detecting ---
+  if (dev > peakDev) {
+    peakDev = dev;
+    cap.peakLsb = linear<M>(dev);
+    if (levelAt(dev) > cap.level) cap.level = levelAt(dev);
+  }
+  cap.postCount++;
+  DetectResult result = DETECT_CAPTURING;
+  bool detecting = overMinor || staLtaFired || (mode != TRIGGER_MODE_THRESHOLD && sta.triggered());
+  if (detecting) {
+    // Another postSamples (capped at maxPostSamples); after a quiet spell
+    // it is also logged as a retrigger
+    if (staLtaFired || quietSamples >= retriggerQuiet) {
+      if (cap.retriggerCount < CAPTURE_MAX_TRIGGERS) {
+        cap.retriggers[cap.retriggerCount] = (uint16_t)(cap.preCount - 1 + cap.postCount);
+      }
+      cap.retriggerCount++;
+      result = DETECT_RETRIGGERED;
+    }
+    postTarget = max(postTarget, min(maxPostSamples, cap.postCount + postSamples));
+    quietSamples = 0;
+  } else {
+    quietSamples++;
+  }
+  if (cap.postCount >= postTarget) {
+    // The samples stay in the arena as history for the next trigger
+    active = false;
+    return DETECT_FINISHED;
+  }
+  return result;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <Arduino.h>
+#include "biquad.h"
+#include "sta_lta.h"
+
+// -- Event detector -----------------------------------------------------------
+// The acquisition-independent part of processSample(): the detection
+// pre-filter, the ΔG-threshold and STA/LTA triggers, and the capture state
+// machine (pre-event window, extension on later detections, retriggers, peak
+// and level). It only sees de-biased +/-2g LSB and arena sequence numbers;
+// the arena, uploads and all logging stay with the caller, so the same code
+// runs on the host (pio test -e native).
+
+// What started a capture (binary header byte 11, "trigger" in JSON/MessagePack).
+// TRIGGER_PULL is a window the server asked for after the fact, not an event.
+enum TriggerMethod : uint8_t { TRIGGER_THRESHOLD = 0, TRIGGER_STA_LTA = 1, TRIGGER_PULL = 2 };
+
+// Trigger engine (from /api/init): absolute ΔG thresholds, STA/LTA, or either
+enum TriggerMode : uint8_t { TRIGGER_MODE_THRESHOLD, TRIGGER_MODE_STA_LTA, TRIGGER_MODE_BOTH };
+
+enum EventLevel : uint8_t { LEVEL_MINOR, LEVEL_MODERATE, LEVEL_SEVERE };
+
+// What a sample's ΔG is (from /api/init "detect_metric"); Z is the vertical axis.
+// METRIC_VECTOR compares x²+y²+z² against the squared thresholds, so it needs
+// no sqrt and is the same in every direction; max-abs reads up to sqrt(3)
+// less on a diagonal than along an axis. The gravity metrics split the
+// vector along setGravity()'s direction instead of the sensor's Z, for a
+// node mounted at any angle.
+enum DetectMetric : uint8_t {
+  METRIC_MAX_ABS,      // max(|x|, |y|, |z|)
+  METRIC_HORIZONTAL,   // max(|x|, |y|)
+  METRIC_VERTICAL,     // |z|
+  METRIC_VECTOR,       // |(x, y, z)|
+  METRIC_GRAVITY_VERTICAL,     // |v|, v = (x, y, z) . g
+  METRIC_GRAVITY_HORIZONTAL,   // |(x, y, z) - v g|, squared like METRIC_VECTOR
+};
+
+// What one sample did to the capture
+enum DetectResult : uint8_t {
+  DETECT_IDLE,         // no capture running
+  DETECT_STARTED,      // triggered; this sample closes the pre-event window
+  DETECT_CAPTURING,    // a post-trigger sample, the window stays open
+  DETECT_RETRIGGERED,  // the same, and a detection logged as a retrigger
+  DETECT_FINISHED,     // the post-trigger sample that closed the window
+};
+
+#define CAPTURE_MAX_TRIGGERS  8     // retrigger offsets kept per capture
+
+// The running capture, or the last one once it has finished. The window is
+// preCount + postCount consecutive samples from sequence number firstSeq.
+struct DetectedCapture {
+  uint32_t      firstSeq;       // oldest sample of the window
+  int           preCount;       // pre-event samples, trigger included
+  int           postCount;
+  EventLevel    level;          // highest reached
+  int32_t       peakLsb;        // peak ΔG (after the filter, on the metric); g only at upload
+  TriggerMethod trigger;
+  uint16_t      retriggers[CAPTURE_MAX_TRIGGERS];  // window index of each later trigger
+  int           retriggerCount; // all of them, including ones past the array
+};
+
+class EventDetector {
+  public:
+    EventDetector();
+
+    // ΔG thresholds in +/-2g LSB; minor also starts captures
+    void setThresholds(int32_t minorLsb, int32_t moderateLsb, int32_t severeLsb);
+    void setTriggerMode(TriggerMode m);
+    // Picks the compiled process() for the metric; nothing per sample tests it
+    void setMetric(DetectMetric m);
+    // The detection pre-filter (AccelFilter::begin())
+    void setFilter(int sampleRateHz, float highPassHz, float lowPassHz);
+    // "Up" in sensor axes as a Q14 unit vector, for the gravity metrics;
+    // (0, 0, 16384) until set
+    void setGravity(const int16_t unitQ14[3]);
+    bool usesGravity() const {
+      return metricKind == METRIC_GRAVITY_VERTICAL || metricKind == METRIC_GRAVITY_HORIZONTAL;
+    }
+    // Window lengths in samples. A detection after retriggerQuiet samples
+    // below the thresholds (or a fresh STA/LTA trigger) is logged as a retrigger.
+    void setWindow(int preSamples, int postSamples, int maxPostSamples, int retriggerQuiet);
+
+    StaLtaDetector&    staLta() { return sta; }    // begin() it for the STA/LTA modes
+    const AccelFilter& filter() const { return pre; }
+
+    // Whether process() is one of the pipelines compiled for a whole
+    // configuration (metric, trigger mode and pre-filter), which test none
+    // of them per sample, or the per-metric one that tests the mode and the
+    // filter's stages. setSpecialized(false) keeps the latter, to compare.
+    bool specialized() const { return isSpecialized; }
+    void setSpecialized(bool on);
+
+    // Feed the de-biased sample with sequence number seq; 'history' samples
+    // up to and including it can go into the pre-event window. dx, dy, dz
+    // come back band-limited, as the triggers saw them.
+    DetectResult process(uint32_t seq, int history, int32_t& dx, int32_t& dy, int32_t& dz);
+
+    EventLevel levelFor(int32_t devLsb) const;   // of a ΔG in LSB
+    TriggerMode  triggerMode() const { return mode; }
+    DetectMetric metric() const { return metricKind; }
+    bool    capturing() const { return active; }
+    // The latest sample's ΔG reached this level's threshold
+    bool    reached(EventLevel level) const { return lastDev >= limit[level]; }
+    const DetectedCapture& capture() const { return cap; }
+
+  private:
+    typedef DetectResult (EventDetector::*Step)(uint32_t, int, int32_t&, int32_t&, int32_t&);
+    // A step() template argument left to the member at run time
+    static constexpr uint8_t AT_RUN_TIME = 0xFF;
+    enum Prefilter : uint8_t {
+      PREFILTER_NONE, PREFILTER_HIGH_PASS, PREFILTER_BAND_PASS, PREFILTER_AT_RUN_TIME = AT_RUN_TIME
+    };
+    template <DetectMetric M, uint8_t Mode = AT_RUN_TIME, uint8_t Filter = AT_RUN_TIME>
+    DetectResult step(uint32_t seq, int history, int32_t& dx, int32_t& dy, int32_t& dz);
+    void select();
+    void start(uint32_t seq, int history, TriggerMethod trigger, int32_t peakLsb);
+    EventLevel levelAt(int64_t dev) const;
+
+    AccelFilter    pre;
+    StaLtaDetector sta;
+    TriggerMode    mode = TRIGGER_MODE_THRESHOLD;
+    DetectMetric   metricKind = METRIC_MAX_ABS;
+    Step           stepFn;
+    bool           specialize = true;
+    bool           isSpecialized = false;
+    int32_t        thresholdLsb[3] = {};   // by EventLevel
+    int64_t        limit[3] = {};          // the same on the metric (squared for the vector ones)
+    int32_t        gravity[3] = { 0, 0, 16384 };   // Q14 projection coefficients
+    int            preSamples = 0, postSamples = 1, maxPostSamples = 1;
+    int            retriggerQuiet = 0;
+
+    bool            active = false;
+    int             postTarget = 0;      // postCount that ends the capture
+    int             quietSamples = 0;    // samples since the last detection
+    int64_t         lastDev = 0;         // the latest sample on the metric
+    int64_t         peakDev = 0;
+    DetectedCapture cap = {};
+};
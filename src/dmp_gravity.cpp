@@ -0,0 +1,41 @@
+#include "dmp_gravity.h"
+
+// Only this file sees the DMP class; the firmware's MPU6050 stays MPU6050_Base
+#include "MPU6050_6Axis_MotionApps612.h"
+
+bool readDmpGravity(int16_t unitQ14[3]) {
+  MPU6050_6Axis_MotionApps612 dmp;
+  if (dmp.dmpInitialize() != 0) return false;
+  dmp.setDMPEnabled(true);
+  dmp.resetFIFO();
+
+  uint8_t packet[32];   // 28-byte packets with this image
+  int32_t sum[3] = {};
+  int n = 0;
+  unsigned long start = millis();
+  while (millis() - start < DMP_GRAVITY_SETTLE_MS) {
+    if (dmp.dmpGetCurrentFIFOPacket(packet) && millis() - start >= DMP_GRAVITY_SETTLE_MS / 2) {
+      int32_t q[4];
+      if (dmp.dmpGetQuaternion(q, packet) == 0) {
+        VectorQ15 g = QuaternionQ30(q).getNormalized().getGravity();
+        sum[0] += g.x;
+        sum[1] += g.y;
+        sum[2] += g.z;
+        n++;
+      }
+    }
+    delay(5);
+  }
+  dmp.setDMPEnabled(false);
+  dmp.reset();
+  delay(100);   // PWR_MGMT_1 reset, as dmpInitialize() waits for it
+
+  if (!n) return false;
+  VectorQ15 up(sum[0] / n, sum[1] / n, sum[2] / n);
+  if (up.getMagnitudeSquared() < (1ULL << 28)) return false;   // under 0.5: it never settled
+  up.normalize();
+  unitQ14[0] = (int16_t)(up.x >> 1);
+  unitQ14[1] = (int16_t)(up.y >> 1);
+  unitQ14[2] = (int16_t)(up.z >> 1);
+  return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- DMP gravity (the gravity_* detect metrics) -------------------------------
+// The nodes are wall-mounted at any angle, so no sensor axis is vertical.
+// The MPU6050's DMP (the vendored MotionApps 6.12 image) fuses accel and
+// gyro into an orientation quaternion on the chip. readDmpGravity() loads
+// it, lets the quaternion settle and returns the mean gravity direction as a
+// Q14 unit vector in sensor axes, pointing the way the accel reads +1g at
+// rest. The quaternion math is the Q30/Q15 fixed-point kind in
+// helper_3dmath.h, and the detector keeps the result as integer projection
+// coefficients (EventDetector::setGravity()), so none of it touches floats.
+//
+// Loading the DMP resets the chip: the caller puts its profile, offsets
+// and FIFO back afterwards. Sampling stops for DMP_GRAVITY_SETTLE_MS plus
+// ~0.3s of reset and image upload.
+#define DMP_GRAVITY_SETTLE_MS 1000UL   // only the second half is averaged
+
+bool readDmpGravity(int16_t unitQ14[3]);
@@ -0,0 +1,42 @@
+#include "dual_sensor.h"
+
+namespace {
+
+// max(|dx|, |dy|, |dz|) of one sample at range 'shift', in +/-2g LSB
+int32_t envelopeLsb(WaveSample s, int shift, const int32_t bias[3]) {
+  int32_t dx = ((int32_t)s.x << shift) - bias[0];
+  int32_t dy = ((int32_t)s.y << shift) - bias[1];
+  int32_t dz = ((int32_t)s.z << shift) - bias[2];
+  return max(abs(dx), max(abs(dy), abs(dz)));
+}
+
+}  // namespace
+
+float captureCoherence(const CaptureView& cap) {
+  int n = cap.count();
+  if (!cap.secondary || n < 2) return 0;
+  const float bias[3] = { cap.biasX, cap.biasY, cap.biasZ };
+  int32_t b1[3], b2[3];
+  for (int a = 0; a < 3; a++) {
+    b1[a] = (int32_t)lroundf(bias[a]);
+    b2[a] = (int32_t)lroundf(cap.secondaryBias[a]);
+  }
+  // Envelopes stay under 2^19 at +/-16g, so the sums fit int64 for any window
+  int64_t s1 = 0, s2 = 0, s11 = 0, s22 = 0, s12 = 0;
+  for (int i = 0; i < n; i++) {
+    int shift = cap.shiftAt(i);
+    int64_t e1 = envelopeLsb(cap.at(i), shift, b1);
+    int64_t e2 = envelopeLsb(cap.secondaryAt(i), shift, b2);
+    s1 += e1;
+    s2 += e2;
+    s11 += e1 * e1;
+    s22 += e2 * e2;
+    s12 += e1 * e2;
+  }
+  // The products of sums can pass 2^63, so finish in double
+  double v1 = (double)n * s11 - (double)s1 * s1;
+  double v2 = (double)n * s22 - (double)s2 * s2;
+  if (v1 <= 0 || v2 <= 0) return 0;
+  double r = ((double)n * s12 - (double)s1 * s2) / sqrt(v1 * v2);
+  return (float)constrain(r, 0.0, 1.0);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Arduino.h>
+#include "waveform_stream.h"
+
+// -- Second sensor (-DDUAL_SENSOR=1) ------------------------------------------
+// A second MPU6050 at 0x69 (AD0 high) on the same bus, configured like the
+// first. Both FIFO counts are read back to back and both FIFOs are drained
+// in the same pass, so the newest sample in each was clocked at about the
+// same moment. The second sensor's samples are matched to the first's by
+// position within that drain, which absorbs the few percent the two
+// internal oscillators differ by one drain at a time. Its arena is then
+// paired with the first's by sequence number.
+//
+// Ground motion moves both sensors alike. A tap, a knock on the case or a
+// tug on the cable mostly moves the one it hits. When a capture closes, the
+// two de-biased max-abs |dG| envelopes are correlated over the window. A
+// minor or moderate capture below DUAL_COHERENCE_MIN is dropped as local and
+// counted in the heartbeat's "taps". Severe captures always go up.
+#ifndef DUAL_COHERENCE_MIN
+  #define DUAL_COHERENCE_MIN 0.5f
+#endif
+
+// Index of the second sensor's sample that goes with sample i of the n the
+// first sensor gave in a drain, when the second gave m: the newest of both
+// line up, and the rest are spread by position
+inline int pairedIndex(int i, int n, int m) {
+  return m - 1 - (int)((int32_t)(n - 1 - i) * m / n);
+}
+
+// Pearson correlation of the two sensors' |dG| envelopes over cap's window,
+// each on its own bias, clamped to 0..1 (0 if either is flat)
+float captureCoherence(const CaptureView& cap);
@@ -0,0 +1,354 @@
+#include "event_journal.h"
+
+namespace {
+
+#define JOURNAL_STATE_PATH JOURNAL_DIR "/state"
+#define JOURNAL_EVICT_PATH JOURNAL_DIR "/evicted"
+
+const uint32_t JOURNAL_MAGIC    = 0x324A4553;  // "SEJ2"
+const uint32_t JOURNAL_MAGIC_V1 = 0x314A4553;  // "SEJ1", epoch in ms and no time source
+const uint32_t STATE_MAGIC      = 0x31534553;  // "SES1", no seq epoch
+const uint32_t STATE_MAGIC_V2   = 0x32534553;  // "SES2"
+const uint32_t EVICT_MAGIC      = 0x31564553;  // "SEV1"
+
+// On-flash record header, followed by 'length' body bytes
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t eventTime;
+  uint32_t bootCount;
+  int64_t  epochUs;
+  uint32_t length;
+  uint8_t  timeSource;
+  char     contentType[JOURNAL_CONTENT_TYPE_SIZE];
+  uint8_t  localPeers;   // was tail padding (written zeroed), so older SEJ2 records read 0
+  uint8_t  uploadMode;   // likewise
+  uint8_t  level;        // likewise; older records replay as minor
+};
+static_assert(sizeof(RecordHeader) == 72, "SEJ2 records on flash keep their layout");
+
+// Layout written by older firmware; still replayed after an OTA update
+struct RecordHeaderV1 {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t eventTime;
+  uint32_t bootCount;
+  int64_t  epochMs;
+  uint32_t length;
+  char     contentType[JOURNAL_CONTENT_TYPE_SIZE];
+};
+
+// Read either header version into h; false on a short read or bad magic.
+// Leaves f positioned at the body.
+bool readHeader(File& f, RecordHeader& h) {
+  if (f.read((uint8_t*)&h, sizeof(h)) != sizeof(h)) return false;
+  if (h.magic == JOURNAL_MAGIC) return true;
+  if (h.magic != JOURNAL_MAGIC_V1) return false;
+  RecordHeaderV1 v1;
+  f.seek(0);
+  if (f.read((uint8_t*)&v1, sizeof(v1)) != sizeof(v1)) return false;
+  h.seq        = v1.seq;
+  h.eventTime  = v1.eventTime;
+  h.bootCount  = v1.bootCount;
+  h.epochUs    = v1.epochMs * 1000;
+  h.length     = v1.length;
+  h.timeSource = v1.epochMs ? EVENT_TIME_SERVER : EVENT_TIME_NONE;
+  h.localPeers = 0;
+  h.uploadMode = 0;
+  h.level      = 0;
+  memcpy(h.contentType, v1.contentType, sizeof(h.contentType));
+  return true;
+}
+
+struct StateRecord {
+  uint32_t magic;
+  uint32_t nextSeq;
+  uint32_t bootCount;
+  uint32_t seqEpoch;          // SES2 only
+};
+
+// Never 0, which stands for a count that predates epochs
+uint32_t freshEpoch() {
+  uint32_t e;
+  do e = ESP.random(); while (!e);   // hardware RNG
+  return e;
+}
+
+String recordPath(uint32_t seq) {
+  char path[32];
+  snprintf(path, sizeof(path), JOURNAL_DIR "/%08lx.evt", (unsigned long)seq);
+  return String(path);
+}
+
+// "0000002a.evt" -> 42; false for anything else in the directory
+bool parseRecordName(const String& name, uint32_t& seq) {
+  const char* s = name.c_str();
+  const char* slash = strrchr(s, '/');
+  if (slash) s = slash + 1;
+  char* end;
+  unsigned long v = strtoul(s, &end, 16);
+  if (end == s || strcmp(end, ".evt") != 0) return false;
+  seq = (uint32_t)v;
+  return true;
+}
+
+}  // namespace
+
+const char* timeSourceName(EventTimeSource source) {
+  switch (source) {
+    case EVENT_TIME_NTP:    return "ntp";
+    case EVENT_TIME_SERVER: return "server";
+    default:                return "none";
+  }
+}
+
+bool EventJournal::begin() {
+  if (!LittleFS.begin()) {
+    Serial.println("! LittleFS mount failed, formatting...");
+    if (!LittleFS.format() || !LittleFS.begin()) {
+      Serial.println("! LittleFS unavailable, offline journal disabled");
+      epoch = freshEpoch();   // seq restarts at 1 every boot
+      return false;
+    }
+  }
+  mounted = true;
+  LittleFS.mkdir(JOURNAL_DIR);
+
+  File f = LittleFS.open(JOURNAL_STATE_PATH, "r");
+  StateRecord st = {};
+  size_t got = f ? f.read((uint8_t*)&st, sizeof(st)) : 0;
+  f.close();
+  if ((got == sizeof(st) && st.magic == STATE_MAGIC_V2) ||
+      (got == offsetof(StateRecord, seqEpoch) && st.magic == STATE_MAGIC)) {
+    seq   = st.nextSeq;
+    boot  = st.bootCount;
+    epoch = st.magic == STATE_MAGIC_V2 ? st.seqEpoch : 0;   // an SES1 count carries on as it was
+  } else {
+    epoch = freshEpoch();
+  }
+
+  f = LittleFS.open(JOURNAL_EVICT_PATH, "r");
+  if (!f || f.read((uint8_t*)&evictions, sizeof(evictions)) != sizeof(evictions) ||
+      evictions.magic != EVICT_MAGIC) {
+    evictions = {};
+  }
+  f.close();
+
+  events = 0;
+  totalBytes = 0;
+  Dir dir = LittleFS.openDir(JOURNAL_DIR);
+  while (dir.next()) {
+    uint32_t s;
+    if (!parseRecordName(dir.fileName(), s)) continue;
+    if (s >= seq) seq = s + 1;  // state write was lost after the record landed
+    if (events >= JOURNAL_MAX_EVENTS) continue;   // not indexed, replaced as others go
+    File r = dir.openFile("r");
+    RecordHeader h;
+    index[events].seq   = s;
+    index[events].size  = dir.fileSize();
+    index[events].level = r && readHeader(r, h) ? h.level : 0;
+    r.close();
+    events++;
+    totalBytes += dir.fileSize();
+  }
+
+  boot++;
+  saveState();
+  Serial.printf("Journal: %d events (%u bytes) pending, next seq %lu, boot %lu, epoch %08lx\n",
+                events, (unsigned)totalBytes, (unsigned long)seq, (unsigned long)boot,
+                (unsigned long)epoch);
+  return true;
+}
+
+void EventJournal::saveState() {
+  if (!mounted) return;
+  StateRecord st = { STATE_MAGIC_V2, seq, boot, epoch };
+  File f = LittleFS.open(JOURNAL_STATE_PATH, "w");
+  if (f) f.write((const uint8_t*)&st, sizeof(st));
+  f.close();
+}
+
+uint32_t EventJournal::nextSeq() {
+  uint32_t s = seq++;
+  saveState();
+  return s;
+}
+
+// Most severe, then oldest (lowest seq), for replay; with 'lowest' the
+// least severe, then oldest, for eviction
+int EventJournal::pick(bool lowest) const {
+  int best = -1;
+  for (int i = 0; i < events; i++) {
+    const Entry& e = index[i];
+    if (best < 0) {
+      best = i;
+      continue;
+    }
+    const Entry& b = index[best];
+    bool outranks = lowest ? e.level < b.level : e.level > b.level;
+    if (outranks || (e.level == b.level && e.seq < b.seq)) best = i;
+  }
+  return best;
+}
+
+int EventJournal::find(uint32_t s) const {
+  for (int i = 0; i < events; i++) {
+    if (index[i].seq == s) return i;
+  }
+  return -1;
+}
+
+bool EventJournal::makeRoom(size_t length, uint8_t level, uint32_t s) {
+  size_t need = sizeof(RecordHeader) + length;
+  if (!mounted || need > JOURNAL_MAX_BYTES) return false;
+  while (events >= JOURNAL_MAX_EVENTS || totalBytes + need > JOURNAL_MAX_BYTES) {
+    int victim = pick(true);
+    if (victim < 0) break;
+    if (index[victim].level > level) {
+      // Everything left outranks the new one: it is the one that goes
+      Serial.printf("! Journal full of more severe events, dropping new event #%lu\n", (unsigned long)s);
+      evicted(s, level);
+      return false;
+    }
+    Serial.printf("! Journal full, dropping event #%lu\n", (unsigned long)index[victim].seq);
+    evicted(index[victim].seq, index[victim].level);
+    remove(index[victim].seq);
+  }
+  return true;
+}
+
+void EventJournal::evicted(uint32_t s, uint8_t level) {
+  evictions.magic = EVICT_MAGIC;
+  evictions.recent[evictions.next] = { s, level };
+  evictions.next = (evictions.next + 1) % JOURNAL_EVICT_LOG;
+  evictions.unreported++;
+  saveEvictions();
+}
+
+void EventJournal::saveEvictions() {
+  if (!mounted) return;
+  if (!evictions.unreported) {
+    LittleFS.remove(JOURNAL_EVICT_PATH);
+    return;
+  }
+  File f = LittleFS.open(JOURNAL_EVICT_PATH, "w");
+  if (f) f.write((const uint8_t*)&evictions, sizeof(evictions));
+  f.close();
+}
+
+uint32_t EventJournal::appendQuery(String& url) const {
+  if (!evictions.unreported) return 0;
+  url += "&evict=";
+  url += (unsigned long)evictions.unreported;
+  uint32_t listed = min(evictions.unreported, (uint32_t)JOURNAL_EVICT_LOG);
+  for (uint32_t i = 1; i <= listed; i++) {
+    const JournalEviction& e = evictions.recent[(evictions.next + JOURNAL_EVICT_LOG - i) % JOURNAL_EVICT_LOG];
+    url += ',';
+    url += (unsigned long)e.seq;
+    url += ':';
+    url += e.level;
+  }
+  return evictions.unreported;
+}
+
+void EventJournal::evictionsReported(uint32_t n) {
+  if (!n) return;
+  evictions.unreported -= min(n, evictions.unreported);
+  saveEvictions();
+}
+
+File EventJournal::create(const EventMeta& meta, const char* contentType, size_t length) {
+  if (!makeRoom(length, meta.level, meta.seq)) return File();
+  File f = LittleFS.open(recordPath(meta.seq), "w");
+  if (!f) return f;
+  RecordHeader h = {};
+  h.magic     = JOURNAL_MAGIC;
+  h.seq       = meta.seq;
+  h.eventTime = meta.eventTime;
+  h.bootCount = meta.bootCount;
+  h.epochUs   = meta.epochUs;
+  h.length    = length;
+  h.timeSource = meta.timeSource;
+  h.localPeers = meta.localPeers;
+  h.uploadMode = meta.uploadMode;
+  h.level      = meta.level;
+  strncpy(h.contentType, contentType, sizeof(h.contentType) - 1);
+  f.write((const uint8_t*)&h, sizeof(h));
+  return f;
+}
+
+bool EventJournal::finish(File& f, const EventMeta& meta, size_t length, size_t written) {
+  f.close();
+  if (written != length) {
+    // Flash full or worn out; don't leave a truncated record to replay
+    LittleFS.remove(recordPath(meta.seq));
+    return false;
+  }
+  index[events++] = { meta.seq, (uint32_t)(sizeof(RecordHeader) + length), meta.level };
+  totalBytes += sizeof(RecordHeader) + length;
+  return true;
+}
+
+bool EventJournal::append(const EventMeta& meta, const char* contentType, const uint8_t* data, size_t length) {
+  File f = create(meta, contentType, length);
+  if (!f) return false;
+  return finish(f, meta, length, f.write(data, length));
+}
+
+bool EventJournal::append(const EventMeta& meta, const char* contentType, Stream& body, size_t length) {
+  File f = create(meta, contentType, length);
+  if (!f) return false;
+  uint8_t chunk[64];
+  size_t written = 0, n;
+  while (written < length && (n = body.readBytes((char*)chunk, sizeof(chunk))) > 0) {
+    written += f.write(chunk, n);
+  }
+  return finish(f, meta, length, written);
+}
+
+bool EventJournal::loadNext(EventMeta& meta, char* contentType, uint8_t*& data, size_t& length) {
+  int next = mounted ? pick(false) : -1;
+  if (next < 0) return false;
+  uint32_t s = index[next].seq;
+  size_t size = index[next].size;
+
+  File f = LittleFS.open(recordPath(s), "r");
+  if (!f) return false;
+  RecordHeader h;
+  bool valid = readHeader(f, h) && h.seq == s && f.position() + h.length <= size;
+  data = valid ? (uint8_t*)malloc(h.length) : nullptr;
+  bool ok = data && f.read(data, h.length) == h.length;
+  f.close();
+  if (!ok) {
+    free(data);
+    data = nullptr;
+    // A bad header (power cut mid-write) will never replay; a failed
+    // allocation may succeed next time, so only the former is removed
+    if (!valid) {
+      Serial.printf("! Journal record #%lu unreadable, removing\n", (unsigned long)s);
+      remove(s);
+    }
+    return false;
+  }
+
+  meta.seq       = h.seq;
+  meta.eventTime = h.eventTime;
+  meta.bootCount = h.bootCount;
+  meta.epochUs   = h.epochUs;
+  meta.timeSource = (EventTimeSource)h.timeSource;
+  meta.journaled = true;
+  meta.localPeers = h.localPeers;
+  meta.uploadMode = h.uploadMode;
+  meta.level     = h.level;
+  memcpy(contentType, h.contentType, JOURNAL_CONTENT_TYPE_SIZE);
+  contentType[JOURNAL_CONTENT_TYPE_SIZE - 1] = '\0';
+  length = h.length;
+  return true;
+}
+
+void EventJournal::remove(uint32_t s) {
+  int i = mounted ? find(s) : -1;
+  if (i < 0 || !LittleFS.remove(recordPath(s))) return;
+  totalBytes -= min(totalBytes, (size_t)index[i].size);
+  index[i] = index[--events];
+}
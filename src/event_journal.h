@@ -0,0 +1,117 @@
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// -- Offline event journal ----------------------------------------------------
+// Events the server couldn't take (connection failure or 5xx) are written to
+// LittleFS, one file per event, and replayed once it's back: most severe first,
+// oldest first within a level (an index in RAM keeps seq, size and level). Each
+// event carries a per-device sequence number that survives reboots; the server
+// ignores a seq it has already stored, so a replay whose response was lost is
+// harmless. The counter starts over only with the state file (a reformat, or
+// every boot without LittleFS), and each start draws a new random seq epoch:
+// the server keys events on (id, epoch, seq), so a restarted count can't be
+// taken for replays of the old one. The journal is bounded - when full, the
+// oldest event of the lowest level stored is dropped, so a backlog of minor
+// ones never pushes out a severe one; a new event that ranks below all of
+// them is refused instead. Each drop is logged (JOURNAL_DIR/evicted, so it
+// survives a reboot) until a heartbeat has reported it.
+#define JOURNAL_DIR          "/journal"
+#define JOURNAL_MAX_EVENTS   16
+#define JOURNAL_MAX_BYTES    (64 * 1024UL)
+#define JOURNAL_CONTENT_TYPE_SIZE 40
+#define JOURNAL_EVICT_LOG    8        // most recent drops listed in the report
+
+// Where EventMeta::epochUs came from
+enum EventTimeSource : uint8_t {
+  EVENT_TIME_NONE   = 0,
+  EVENT_TIME_SERVER = 1,      // server_time_ms at init plus millis(): drifts, includes init latency
+  EVENT_TIME_NTP    = 2,      // SNTP-disciplined system clock
+};
+
+const char* timeSourceName(EventTimeSource source);   // "none" / "server" / "ntp"
+
+struct EventMeta {
+  uint32_t      seq;          // per-device event number, 0 = unassigned
+  unsigned long eventTime;    // trigger millis(), only valid in bootCount
+  uint32_t      bootCount;    // boot the event was captured in
+  int64_t       epochUs;      // trigger wall-clock time, epoch microseconds, 0 if unknown
+  EventTimeSource timeSource;
+  bool          journaled;    // body also lives in the journal
+  uint8_t       localPeers;   // ESP-NOW peers that triggered with it (peer_link.h)
+  uint8_t       uploadMode;   // UploadMode the body was rendered under (upload_policy.h)
+  uint8_t       level;        // EventLevel (detector.h): replay and eviction priority
+};
+
+struct JournalEviction {
+  uint32_t seq;
+  uint8_t  level;
+};
+
+class EventJournal {
+  public:
+    // Mount LittleFS (formatting it if unreadable), load the seq/boot
+    // counters and index the stored events. False if the FS is unusable;
+    // the journal then stays empty and appends fail.
+    bool begin();
+
+    uint32_t nextSeq();                   // allocate and persist the next seq
+    uint32_t peekSeq() const { return seq; }   // the one nextSeq() hands out next
+    uint32_t bootCount() const { return boot; }
+    uint32_t seqEpoch() const { return epoch; }   // 0 for a count from before epochs
+
+    // Store an event body. Drops lower-ranked events to make room; false if
+    // the body alone exceeds the journal, everything stored outranks it, or
+    // the write failed.
+    bool append(const EventMeta& meta, const char* contentType, const uint8_t* data, size_t length);
+    bool append(const EventMeta& meta, const char* contentType, Stream& body, size_t length);
+
+    // Load the next event to replay (most severe, then oldest) into a
+    // malloc'd buffer the caller frees. contentType must hold
+    // JOURNAL_CONTENT_TYPE_SIZE bytes.
+    bool loadNext(EventMeta& meta, char* contentType, uint8_t*& data, size_t& length);
+
+    void remove(uint32_t seq);
+
+    int    count() const { return events; }
+    size_t bytes() const { return totalBytes; }
+
+    // "&evict=unreported,seq:level,..." (newest first, up to JOURNAL_EVICT_LOG)
+    // while there are drops the server hasn't heard of; returns how many it
+    // covers, for evictionsReported() once the heartbeat got through
+    uint32_t appendQuery(String& url) const;
+    void     evictionsReported(uint32_t n);
+
+  private:
+    struct Entry {
+      uint32_t seq;
+      uint32_t size;          // file size, header included
+      uint8_t  level;
+    };
+
+    struct EvictionLog {
+      uint32_t magic;
+      uint32_t unreported;    // drops since the last report
+      uint32_t next;          // slot in recent[] for the next one
+      JournalEviction recent[JOURNAL_EVICT_LOG];
+    };
+
+    File   create(const EventMeta& meta, const char* contentType, size_t length);
+    bool   finish(File& f, const EventMeta& meta, size_t length, size_t written);
+    bool   makeRoom(size_t length, uint8_t level, uint32_t seq);
+    int    pick(bool lowest) const;   // index entry to replay next, or to drop
+    int    find(uint32_t seq) const;
+    void   evicted(uint32_t seq, uint8_t level);
+    void   saveState();
+    void   saveEvictions();
+
+    bool     mounted = false;
+    uint32_t seq = 1;
+    uint32_t boot = 0;
+    uint32_t epoch = 0;
+    int      events = 0;
+    size_t   totalBytes = 0;
+    Entry    index[JOURNAL_MAX_EVENTS];
+    EvictionLog evictions = {};
+};
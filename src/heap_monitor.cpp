@@ -0,0 +1,35 @@
+#include "heap_monitor.h"
+
+void HeapMonitor::poll(unsigned long now) {
+  if (sampled && now - lastSampleMs < HEAP_SAMPLE_MS) return;
+  lastSampleMs = now;
+  sample();
+}
+
+void HeapMonitor::sample() {
+  lastFree  = ESP.getFreeHeap();
+  lastBlock = ESP.getMaxFreeBlockSize();
+  lastFrag  = ESP.getHeapFragmentation();
+  if (!sampled || lastFree < windowMinFree) windowMinFree = lastFree;
+  if (!sampled || lastFrag > windowMaxFrag) windowMaxFrag = lastFrag;
+  sampled = true;
+}
+
+void HeapMonitor::appendQuery(String& url) const {
+  if (!sampled) return;
+  url += "&heap_free=";     url += (unsigned long)lastFree;
+  url += "&heap_block=";    url += (unsigned long)lastBlock;
+  url += "&heap_frag=";     url += (unsigned long)lastFrag;
+  url += "&heap_min=";      url += (unsigned long)windowMinFree;
+  url += "&heap_frag_max="; url += (unsigned long)windowMaxFrag;
+}
+
+void HeapMonitor::resetWindow() {
+  windowMinFree = lastFree;
+  windowMaxFrag = lastFrag;
+}
+
+int HeapMonitor::formatNow(char* buf, size_t size) {
+  return snprintf(buf, size, "%lu,%lu,%u", (unsigned long)ESP.getFreeHeap(),
+                  (unsigned long)ESP.getMaxFreeBlockSize(), (unsigned)ESP.getHeapFragmentation());
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Heap telemetry -----------------------------------------------------------
+// Samples ESP.getFreeHeap() / getMaxFreeBlockSize() / getHeapFragmentation()
+// once per HEAP_SAMPLE_MS from loop() and keeps the worst values of the
+// current heartbeat window next to the latest, so a leak or a fragmenting
+// heap shows up long before an allocation fails. getHeapFragmentation()
+// walks the free list, hence the rate limit rather than once per loop.
+//
+// Heartbeat query: heap_free, heap_block, heap_frag (latest sample),
+// heap_min (lowest free heap in the window) and heap_frag_max. Event uploads
+// carry one on-the-spot reading as "X-Heap: <free>,<max block>,<frag %>".
+#define HEAP_SAMPLE_MS  1000
+
+class HeapMonitor {
+  public:
+    // Rate-limited; call every loop
+    void poll(unsigned long now);
+    void sample();
+
+    uint32_t freeHeap() const { return lastFree; }
+    uint32_t maxBlock() const { return lastBlock; }
+    uint8_t  fragmentation() const { return lastFrag; }
+    uint32_t minFree() const { return windowMinFree; }
+
+    void appendQuery(String& url) const;
+
+    // Start a new worst-case window from the latest sample
+    void resetWindow();
+
+    // "<free>,<max block>,<frag>" read now, for the X-Heap header
+    static int formatNow(char* buf, size_t size);
+
+  private:
+    unsigned long lastSampleMs = 0;
+    bool     sampled = false;
+    uint32_t lastFree = 0;
+    uint32_t lastBlock = 0;
+    uint8_t  lastFrag = 0;
+    uint32_t windowMinFree = 0;
+    uint8_t  windowMaxFrag = 0;
+};
@@ -0,0 +1,101 @@
+#include "helicorder.h"
+
+namespace {
+
+const char BASE64URL[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+int16_t clamp16(int32_t v) {
+  return (int16_t)constrain(v, (int32_t)INT16_MIN, (int32_t)INT16_MAX);
+}
+
+// Streams bytes out as base64url without padding
+struct Base64Writer {
+  String&  out;
+  uint32_t bits = 0;
+  int      n = 0;
+
+  explicit Base64Writer(String& o) : out(o) {}
+
+  void put(uint8_t b) {
+    bits = (bits << 8) | b;
+    if (++n == 3) {
+      for (int s = 18; s >= 0; s -= 6) out += BASE64URL[(bits >> s) & 0x3F];
+      bits = 0;
+      n = 0;
+    }
+  }
+
+  void put16(int16_t v) {
+    put((uint8_t)(v & 0xFF));
+    put((uint8_t)((uint16_t)v >> 8));
+  }
+
+  void flush() {
+    if (n == 0) return;
+    bits <<= 8 * (3 - n);
+    for (int i = 0, s = 18; i <= n; i++, s -= 6) out += BASE64URL[(bits >> s) & 0x3F];
+    bits = 0;
+    n = 0;
+  }
+};
+
+}  // namespace
+
+void Helicorder::begin(int sampleRateHz) {
+  perSecond = max(1, sampleRateHz);
+  head = filled = 0;
+  curCount = 0;
+}
+
+void Helicorder::add(unsigned long ms, int32_t x, int32_t y, int32_t z) {
+  int32_t v[3] = { x, y, z };
+  if (curCount == 0) {
+    curStart = ms;
+    for (int i = 0; i < 3; i++) {
+      curMin[i] = curMax[i] = v[i];
+      curSq[i] = 0;
+    }
+  }
+  for (int i = 0; i < 3; i++) {
+    if (v[i] < curMin[i]) curMin[i] = v[i];
+    if (v[i] > curMax[i]) curMax[i] = v[i];
+    curSq[i] += (uint64_t)((int64_t)v[i] * v[i]);
+  }
+  if (++curCount < perSecond) return;
+
+  // Close the second; one sqrt per axis per second is all the float we do
+  HeliSummary& s = ring[head];
+  s.startMs = curStart;
+  for (int i = 0; i < 3; i++) {
+    s.min[i] = clamp16(curMin[i]);
+    s.max[i] = clamp16(curMax[i]);
+    s.rms[i] = (uint16_t)min(65535.0f, sqrtf((float)(curSq[i] / (uint64_t)curCount)));
+  }
+  head = (head + 1) % HELI_RING_SECONDS;
+  if (filled < HELI_RING_SECONDS) filled++;
+  curCount = 0;
+}
+
+int Helicorder::appendQuery(String& url, unsigned long now, int maxSeconds) {
+  int n = min(filled, maxSeconds);
+  if (n <= 0) return 0;
+  int first = (head - filled + HELI_RING_SECONDS) % HELI_RING_SECONDS;
+
+  url.reserve(url.length() + (n * HELI_SUMMARY_BYTES * 4) / 3 + 40);
+  url += "&trace=";
+  Base64Writer w(url);
+  for (int k = 0; k < n; k++) {
+    const HeliSummary& s = ring[(first + k) % HELI_RING_SECONDS];
+    for (int i = 0; i < 3; i++) w.put16(s.min[i]);
+    for (int i = 0; i < 3; i++) w.put16(s.max[i]);
+    for (int i = 0; i < 3; i++) w.put16((int16_t)min((uint16_t)INT16_MAX, s.rms[i]));
+  }
+  w.flush();
+  url += "&trace_age_ms=";
+  url += now - ring[first].startMs;
+  return n;
+}
+
+void Helicorder::consume(int n) {
+  filled -= constrain(n, 0, filled);
+}
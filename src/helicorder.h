@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Helicorder trace ---------------------------------------------------------
+// Low-rate context alongside the event waveforms: every second of detection
+// samples (de-biased, after any detection filter) is reduced to per-axis
+// min / max / RMS and kept in a small ring. The heartbeat GET carries the
+// pending seconds as query parameters, so the server gets a continuous trace
+// with no extra connections. A failed heartbeat keeps them for the next one;
+// once the ring is full the oldest second is dropped.
+//
+// Wire format (query "trace", base64url, no padding): per second, nine
+// little-endian int16 - min x,y,z, max x,y,z, rms x,y,z - in LSB. "trace_age_ms"
+// is how long before the request the first second started.
+#define HELI_RING_SECONDS     120   // two default heartbeats
+#define HELI_SUMMARY_BYTES    18
+
+struct HeliSummary {
+  unsigned long startMs;
+  int16_t       min[3];
+  int16_t       max[3];
+  uint16_t      rms[3];
+};
+
+class Helicorder {
+  public:
+    void begin(int sampleRateHz);
+
+    // Feed every sample; closes a summary each sampleRateHz samples
+    void add(unsigned long ms, int32_t x, int32_t y, int32_t z);
+
+    int count() const { return filled; }
+
+    // Append "&trace=...&trace_age_ms=..." for up to maxSeconds pending
+    // summaries to url. Returns how many were encoded (0 appends nothing).
+    int appendQuery(String& url, unsigned long now, int maxSeconds = HELI_RING_SECONDS);
+
+    // Drop the n oldest summaries once the server has them
+    void consume(int n);
+
+  private:
+    HeliSummary ring[HELI_RING_SECONDS];
+    int      head = 0;          // next slot to write
+    int      filled = 0;
+    int      perSecond = 0;
+
+    // Summary being accumulated
+    unsigned long curStart = 0;
+    int      curCount = 0;
+    int32_t  curMin[3], curMax[3];
+    uint64_t curSq[3];
+};
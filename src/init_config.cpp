@@ -0,0 +1,186 @@
+#include "init_config.h"
+
+namespace {
+
+static_assert(offsetof(InitConfig, ntpServer) == INIT_FIXED_BYTES, "wire layout is the struct's");
+static_assert(sizeof(InitConfig) % 4 == 0, "RTC memory is accessed in words");
+
+const size_t HEADER_BYTES = 8;
+const size_t BOOT_FIXED_BYTES = 9;   // server_time_ms, flags
+
+uint32_t crc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  while (length--) {
+    crc ^= *data++;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+uint16_t get16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+uint32_t get32(const uint8_t* p) { return get16(p) | ((uint32_t)get16(p + 2) << 16); }
+
+// A length-prefixed string at p[pos] within end, cut to fit dst
+bool getString(const uint8_t* p, size_t& pos, size_t end, char* dst, size_t size) {
+  if (pos >= end || pos + 1 + p[pos] > end) return false;
+  size_t n = p[pos++];
+  size_t keep = min(n, size - 1);
+  memcpy(dst, p + pos, keep);
+  dst[keep] = '\0';
+  pos += n;
+  return true;
+}
+
+void copyString(char* dst, size_t size, const char* src) {
+  snprintf(dst, size, "%s", src ? src : "");
+}
+
+// The ranges setup() has always held the server's values to, and enum
+// codes this firmware doesn't know back to the defaults
+void normalize(InitConfig& c) {
+  c.dlpf         = constrain(c.dlpf, 0, 6);
+  c.sampleRateHz = snapSampleRate(c.sampleRateHz, c.dlpf);
+  c.preMs        = constrain(c.preMs, 0, 30000);
+  c.postMs       = constrain(c.postMs, 100, 30000);
+  c.maxPostMs    = constrain(c.maxPostMs, c.postMs, 60000);
+  c.biasTrackS   = constrain(c.biasTrackS, 0, 3600);
+  if (c.triggerMode > TRIGGER_MODE_BOTH) c.triggerMode = TRIGGER_MODE_THRESHOLD;
+  if (c.detectMetric > METRIC_GRAVITY_HORIZONTAL) c.detectMetric = METRIC_MAX_ABS;
+  if (c.streamMode > INIT_STREAM_UDP) c.streamMode = INIT_STREAM_OFF;
+  c.formatCount  = min(c.formatCount, (uint8_t)INIT_MAX_FORMATS);
+}
+
+// Index of name in names, or fallback
+template <size_t N>
+uint8_t lookup(const char* name, const char* const (&names)[N], uint8_t fallback) {
+  for (size_t i = 0; name && i < N; i++) {
+    if (strcmp(name, names[i]) == 0) return i;
+  }
+  return fallback;
+}
+
+const char* const STREAM_MODE_NAMES[] = { "off", "udp" };
+const char* const FORMAT_NAMES[] = { "json", "binary", "msgpack", "delta" };   // UploadFormat order
+
+}  // namespace
+
+const char* const INIT_TRIGGER_MODE_NAMES[3] = { "threshold", "sta_lta", "both" };
+const char* const INIT_METRIC_NAMES[6] = {
+  "max_abs", "horizontal", "vertical", "vector", "gravity_vertical", "gravity_horizontal",
+};
+
+uint16_t snapSampleRate(uint16_t hz, uint8_t dlpf) {
+  uint16_t output = dlpf == 0 ? 8000 : 1000;   // MPU6050_DLPF_BW_256 runs the gyro at 8kHz
+  uint16_t best = 0;
+  for (uint16_t div = 1; div <= 256; div++) {
+    uint16_t rate = output / div;
+    if (output % div || rate < 5 || rate > 500) continue;
+    if (!best || abs((int)rate - (int)hz) < abs((int)best - (int)hz)) best = rate;
+  }
+  return best;
+}
+
+InitConfig initDefaults(uint16_t sampleRateHz, uint8_t dlpf, uint16_t mqttPort) {
+  InitConfig c = {};
+  c.sampleRateHz = sampleRateHz;
+  c.dlpf         = dlpf;
+  c.triggerMode  = TRIGGER_MODE_THRESHOLD;
+  c.detectMetric = METRIC_MAX_ABS;
+  c.streamMode   = INIT_STREAM_OFF;
+  c.preMs        = 3000;
+  c.postMs       = 3000;
+  c.maxPostMs    = 12000;
+  c.staMs        = 500;
+  c.ltaMs        = 30000;
+  c.staLtaOn     = 4.0f;
+  c.staLtaOff    = 1.5f;
+  c.streamHz     = 10.0f;
+  c.mqttPort     = mqttPort;
+  return c;
+}
+
+bool decodeInitBinary(const uint8_t* body, size_t n, InitConfig& cfg, InitBoot& boot) {
+  if (n < HEADER_BYTES + 4 || memcmp(body, "SIC", 3) != 0 || body[3] != INIT_BINARY_VERSION) return false;
+  size_t sectionLen = get16(body + 4);
+  size_t length = get16(body + 6);
+  if (length + 4 != n || crc32(body, length) != get32(body + length)) return false;
+  size_t sectionEnd = HEADER_BYTES + sectionLen;
+  if (sectionLen < INIT_FIXED_BYTES + 2 || sectionEnd + BOOT_FIXED_BYTES + 2 > length) return false;
+
+  InitConfig c = {};
+  memcpy(&c, body + HEADER_BYTES, INIT_FIXED_BYTES);
+  size_t pos = HEADER_BYTES + INIT_FIXED_BYTES;
+  if (!getString(body, pos, sectionEnd, c.ntpServer, sizeof(c.ntpServer)) ||
+      !getString(body, pos, sectionEnd, c.mqttHost, sizeof(c.mqttHost))) {
+    return false;
+  }
+  c.crc = crc32(body + HEADER_BYTES, sectionLen);
+
+  InitBoot b = {};
+  const uint8_t* p = body + sectionEnd;
+  b.serverTimeMs = (int64_t)((uint64_t)get32(p) | ((uint64_t)get32(p + 4) << 32));
+  b.recalibrate  = p[8] & 0x01;
+  pos = sectionEnd + BOOT_FIXED_BYTES;
+  if (!getString(body, pos, length, b.firmwareVersion, sizeof(b.firmwareVersion)) ||
+      !getString(body, pos, length, b.firmwareUrl, sizeof(b.firmwareUrl))) {
+    return false;
+  }
+
+  normalize(c);
+  cfg = c;
+  boot = b;
+  return true;
+}
+
+void initFromJson(JsonDocument& doc, InitConfig& cfg, InitBoot& boot) {
+  InitConfig& c = cfg;
+  c.gen             = doc["config_gen"] | c.gen;
+  c.heartbeatMs     = doc["heartbeat_interval"] | c.heartbeatMs;
+  c.pushHeartbeatMs = doc["push_heartbeat_interval"] | c.pushHeartbeatMs;
+  c.sensitivity[0]  = doc["sensitivity"]["minor"] | c.sensitivity[0];
+  c.sensitivity[1]  = doc["sensitivity"]["moderate"] | c.sensitivity[1];
+  c.sensitivity[2]  = doc["sensitivity"]["severe"] | c.sensitivity[2];
+  c.sampleRateHz    = doc["sample_rate_hz"] | c.sampleRateHz;
+  c.dlpf            = doc["dlpf"] | c.dlpf;
+  c.preMs           = doc["pre_ms"] | c.preMs;
+  c.postMs          = doc["post_ms"] | c.postMs;
+  c.maxPostMs       = doc["max_post_ms"] | c.maxPostMs;
+  c.triggerMode     = lookup(doc["trigger_mode"] | (const char*)nullptr, INIT_TRIGGER_MODE_NAMES, c.triggerMode);
+  c.detectMetric    = lookup(doc["detect_metric"] | (const char*)nullptr, INIT_METRIC_NAMES, c.detectMetric);
+  c.staMs           = doc["sta_ms"] | c.staMs;
+  c.ltaMs           = doc["lta_ms"] | c.ltaMs;
+  c.staLtaOn        = doc["sta_lta_on"] | c.staLtaOn;
+  c.staLtaOff       = doc["sta_lta_off"] | c.staLtaOff;
+  c.biasTrackS      = doc["bias_track_s"] | c.biasTrackS;
+  c.hpHz            = doc["hp_hz"] | c.hpHz;
+  c.lpHz            = doc["lp_hz"] | c.lpHz;
+
+  JsonArray formats = doc["upload_formats"].as<JsonArray>();
+  if (!formats.isNull()) {
+    c.formatCount = 0;
+    for (JsonVariant f : formats) {
+      uint8_t code = lookup(f.as<const char*>(), FORMAT_NAMES, 0xFF);
+      if (code != 0xFF && c.formatCount < INIT_MAX_FORMATS) c.formats[c.formatCount++] = code;
+    }
+  }
+
+  if (doc["spectrum"].is<bool>())   c.flags = (c.flags & ~INIT_SPECTRUM)   | (doc["spectrum"]   ? INIT_SPECTRUM : 0);
+  if (doc["local_http"].is<bool>()) c.flags = (c.flags & ~INIT_LOCAL_HTTP) | (doc["local_http"] ? INIT_LOCAL_HTTP : 0);
+  c.streamMode      = lookup(doc["stream_mode"] | (const char*)nullptr, STREAM_MODE_NAMES, c.streamMode);
+  c.streamPort      = doc["stream_port"] | c.streamPort;
+  c.streamHz        = doc["stream_hz"] | c.streamHz;
+  if (doc["ntp_server"].is<const char*>()) copyString(c.ntpServer, sizeof(c.ntpServer), doc["ntp_server"]);
+  if (doc["mqtt"]["host"].is<const char*>()) {
+    copyString(c.mqttHost, sizeof(c.mqttHost), doc["mqtt"]["host"]);
+    c.mqttPort = doc["mqtt"]["port"] | c.mqttPort;
+  }
+  c.sessionPort     = doc["session"]["port"] | c.sessionPort;
+  c.crc             = 0;
+  normalize(c);
+
+  boot = {};
+  boot.serverTimeMs = doc["server_time_ms"] | (int64_t)0;
+  boot.recalibrate  = doc["recalibrate"] | false;
+  copyString(boot.firmwareVersion, sizeof(boot.firmwareVersion), doc["firmware_version"] | "");
+  copyString(boot.firmwareUrl, sizeof(boot.firmwareUrl), doc["firmware_url"] | "");
+}
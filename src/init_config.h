@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "detector.h"
+
+// -- Init config --------------------------------------------------------------
+// Everything /api/init configures, in one fixed-size struct, whichever way
+// it arrived: the compact binary body below (asked for with
+// Accept: INIT_BINARY_TYPE), the JSON an older server sends, or a config
+// pushed over MQTT or the device session. setup(), config reloads and the
+// RTC copy (init_store.h) all work from it, and the same code runs on the
+// host (pio test -e native).
+//
+// Binary body, little-endian:
+//   0  "SIC"  uint8 version (INIT_BINARY_VERSION)
+//   4  uint16 config section length C
+//   6  uint16 length L of everything before the CRC
+//   8  config section; its first INIT_FIXED_BYTES are InitConfig's, field
+//      for field, then ntp_server and mqtt_host (uint8 length + bytes each,
+//      cut to fit). A newer server's extra fields follow and are skipped.
+//  8+C boot section: int64 server_time_ms, uint8 flags (1 recalibrate),
+//      firmware_version, firmware_url (as above; empty = no update offered),
+//      any newer fields, skipped
+//   L  uint32 CRC-32 of bytes 0..L-1
+//
+// Enum bytes are the firmware's enums: TriggerMode, DetectMetric,
+// InitStreamMode, and the upload formats in UploadFormat order (json,
+// binary, msgpack, delta). server/lib/initbin.js writes it.
+#define INIT_BINARY_TYPE    "application/vnd.seismo.init"
+#define INIT_BINARY_VERSION 1
+#define INIT_BINARY_MAX     512   // a body with the longest strings is ~420 bytes
+#define INIT_MAX_FORMATS    4
+
+enum InitStreamMode : uint8_t { INIT_STREAM_OFF, INIT_STREAM_UDP };
+
+// InitConfig::flags
+#define INIT_SPECTRUM    0x01
+#define INIT_LOCAL_HTTP  0x02
+
+// Word-aligned with no padding, so the wire's fixed part copies straight in
+// and the whole struct goes to RTC memory as is
+struct InitConfig {
+  uint32_t gen;                // config_gen, echoed as &cfg= on the heartbeat
+  uint32_t heartbeatMs;
+  uint32_t pushHeartbeatMs;    // 0 from a server without the push channel
+  float    sensitivity[3];     // minor, moderate, severe thresholds, g
+  uint16_t sampleRateHz;
+  uint8_t  dlpf;
+  uint8_t  triggerMode;        // TriggerMode
+  uint8_t  detectMetric;       // DetectMetric
+  uint8_t  streamMode;         // InitStreamMode
+  uint8_t  flags;              // INIT_SPECTRUM | INIT_LOCAL_HTTP
+  uint8_t  formatCount;
+  uint8_t  formats[INIT_MAX_FORMATS];   // upload formats, server's preference first
+  uint16_t preMs, postMs, maxPostMs;
+  uint16_t staMs;
+  uint32_t ltaMs;
+  float    staLtaOn, staLtaOff;
+  float    hpHz, lpHz;         // detection pre-filter corners, 0 = off
+  float    streamHz;
+  uint16_t biasTrackS;         // 0 = keep the calibrated bias
+  uint16_t streamPort;         // 0 = no trigger notices or stream
+  uint16_t mqttPort;
+  uint16_t sessionPort;        // 0 = no device session
+  char     ntpServer[48];      // "" = SNTP_DEFAULT_SERVER
+  char     mqttHost[64];       // "" = no broker
+  uint32_t crc;                // CRC-32 of the binary config section, 0 from JSON
+};
+
+// What applies to this boot only and is never cached
+struct InitBoot {
+  int64_t  serverTimeMs;       // 0 if not sent
+  bool     recalibrate;
+  char     firmwareVersion[16];
+  char     firmwareUrl[128];
+};
+
+#define INIT_FIXED_BYTES 76    // offsetof(InitConfig, ntpServer)
+
+// /api/init's names for TriggerMode and DetectMetric, by value
+extern const char* const INIT_TRIGGER_MODE_NAMES[3];
+extern const char* const INIT_METRIC_NAMES[6];
+
+// The rate in 5-500Hz nearest hz that the chip's sample clock, output rate
+// (8kHz at dlpf 0, else 1kHz) / (1 + SMPLRT_DIV), hits exactly; a tie goes
+// to the faster one. server.js snapSampleRate() is the same.
+uint16_t snapSampleRate(uint16_t hz, uint8_t dlpf);
+
+// The settings a server too old to send a field leaves in place
+InitConfig initDefaults(uint16_t sampleRateHz, uint8_t dlpf, uint16_t mqttPort);
+
+// Decode a binary body of n bytes. False (cfg and boot untouched) unless its
+// magic, version, lengths and CRC all check out.
+bool decodeInitBinary(const uint8_t* body, size_t n, InitConfig& cfg, InitBoot& boot);
+
+// Map a parsed JSON body onto cfg and boot; fields it lacks keep cfg's
+// current values, so pass initDefaults() for the old-server behaviour
+void initFromJson(JsonDocument& doc, InitConfig& cfg, InitBoot& boot);
@@ -0,0 +1,88 @@
+#include "init_store.h"
+
+namespace {
+
+const uint32_t INIT_RTC_MAGIC = 0x31494E49;  // "INI1"
+
+// Word-aligned for rtcUserMemoryRead/Write
+struct InitRecord {
+  uint32_t   magic;
+  char       version[16];
+  InitConfig cfg;
+  uint32_t   crc;
+};
+
+static_assert(sizeof(InitRecord) % 4 == 0, "RTC memory is accessed in words");
+static_assert(INIT_RTC_OFFSET * 4 + sizeof(InitRecord) <= 512, "past the end of RTC user memory");
+
+uint32_t crc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  while (length--) {
+    crc ^= *data++;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+uint32_t recordCrc(const InitRecord& r) {
+  return crc32((const uint8_t*)&r, offsetof(InitRecord, crc));
+}
+
+// The body by its Content-Type: binary into a fixed buffer, JSON through
+// the filter
+class InitSink : public BodySink {
+  public:
+    InitSink(ServerLink& link, const JsonDocument& filter, InitConfig& cfg, InitBoot& boot)
+      : link(link), filter(filter), cfg(cfg), boot(boot) {}
+
+    bool read(Stream& body, int length) override {
+      if (link.collected().startsWith(INIT_BINARY_TYPE)) {
+        uint8_t buf[INIT_BINARY_MAX];
+        if (length > (int)sizeof(buf) || (int)body.readBytes(buf, length) != length) return false;
+        return decodeInitBinary(buf, length, cfg, boot);
+      }
+      StaticJsonDocument<512> doc;
+      if (deserializeJson(doc, body, DeserializationOption::Filter(filter))) return false;
+      initFromJson(doc, cfg, boot);
+      return true;
+    }
+
+  private:
+    ServerLink& link;
+    const JsonDocument& filter;
+    InitConfig& cfg;
+    InitBoot& boot;
+};
+
+}  // namespace
+
+int fetchInit(ServerLink& link, const char* url, const JsonDocument& filter,
+              InitConfig& cfg, InitBoot& boot, bool* ok) {
+  InitSink sink(link, filter, cfg, boot);
+  link.addHeader("Accept", INIT_BINARY_TYPE ", application/json");
+  link.collectHeader("Content-Type");
+  return link.getBody(url, sink, ok);
+}
+
+bool loadInitCache(InitConfig& cfg, const char* version) {
+  InitRecord r;
+  if (!ESP.rtcUserMemoryRead(INIT_RTC_OFFSET, (uint32_t*)&r, sizeof(r))) return false;
+  if (r.magic != INIT_RTC_MAGIC || r.crc != recordCrc(r)) return false;
+  if (strncmp(r.version, version, sizeof(r.version)) != 0) return false;
+  cfg = r.cfg;
+  return true;
+}
+
+void saveInitCache(const InitConfig& cfg, const char* version) {
+  InitRecord r = {};
+  r.magic = INIT_RTC_MAGIC;
+  strncpy(r.version, version, sizeof(r.version) - 1);
+  r.cfg = cfg;
+  r.crc = recordCrc(r);
+  ESP.rtcUserMemoryWrite(INIT_RTC_OFFSET, (uint32_t*)&r, sizeof(r));
+}
+
+void clearInitCache() {
+  uint32_t magic = 0;
+  ESP.rtcUserMemoryWrite(INIT_RTC_OFFSET, &magic, sizeof(magic));
+}
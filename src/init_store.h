@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Arduino.h>
+#include "init_config.h"
+#include "server_link.h"
+
+// -- Init fetch and RTC cache -------------------------------------------------
+// fetchInit() asks /api/init for the binary body (init_config.h) and falls
+// back to parsing JSON when the server is one that only sends that.
+//
+// The settings it returns are also kept in RTC user memory, tagged with the
+// firmware version and a CRC. A warm reset (crash, watchdog, the reset pin)
+// that finds them skips the init fetch; the first heartbeat goes out at once
+// with their generation and CRC (&cfg=, &cfh=), and a server that has moved
+// on answers 202, so the node reloads in place within one round trip. The
+// per-boot fields (server time, recalibrate, a firmware offer) are never
+// cached: the server clock comes from SNTP or the next fetch, and an offer
+// or recalibration is sent together with a generation bump or a reinit.
+//
+// A power-on boot wipes RTC memory, and every restart the server asked for
+// (205, a reload that resizes the arena) clears the copy first, so those
+// boots always fetch.
+#define INIT_RTC_OFFSET  60      // words, after the OTA result
+
+// GET url into cfg and boot; cfg comes in holding the defaults a JSON body
+// leaves in place. Returns the HTTP status; *ok says the body decoded.
+int fetchInit(ServerLink& link, const char* url, const JsonDocument& filter,
+              InitConfig& cfg, InitBoot& boot, bool* ok);
+
+// Settings saved by firmware 'version', if this reset kept RTC memory
+bool loadInitCache(InitConfig& cfg, const char* version);
+void saveInitCache(const InitConfig& cfg, const char* version);
+void clearInitCache();
@@ -0,0 +1,36 @@
+#include "isr_jitter.h"
+
+void IsrJitter::begin(int sampleRateHz) {
+  periodCycles = ESP.getCpuFreqMHz() * 1000000UL / (uint32_t)max(1, sampleRateHz);
+  haveLast = false;
+  reset();
+}
+
+void IsrJitter::appendQuery(String& url) {
+  // One consistent window: the ISR writes all of these
+  noInterrupts();
+  uint32_t count = n, lo = minCycles, hi = maxCycles, gapCount = gaps;
+  uint64_t sum = sumCycles;
+  interrupts();
+  if (count == 0 && gapCount == 0) return;
+
+  uint32_t mean = count ? (uint32_t)(sum / count) : 0;
+  uint32_t late = count ? hi - mean : 0;
+  uint32_t early = count ? mean - lo : 0;
+  if (late > bootLateCycles) bootLateCycles = late;
+  uint32_t mhz = ESP.getCpuFreqMHz();
+  url += "&isr=";
+  url += (unsigned long)count;                 url += ',';
+  url += (unsigned long)(mean / mhz);          url += ',';
+  url += (unsigned long)(late / mhz);          url += ',';
+  url += (unsigned long)(early / mhz);         url += ',';
+  url += (unsigned long)gapCount;              url += ',';
+  url += (unsigned long)(bootLateCycles / mhz);
+}
+
+void IsrJitter::reset() {
+  noInterrupts();
+  n = minCycles = maxCycles = gaps = 0;
+  sumCycles = 0;
+  interrupts();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- ISR jitter ----------------------------------------------------------------
+// The MPU6050 clocks data-ready on its own steady oscillator, so how far each
+// edge-to-edge interval of the ISR's cycle counter strays from their mean is
+// how much the ISR's entry latency varied: flash waits, WiFi and the SDK
+// holding interrupts off. An interval past 1.5 periods (a missed edge, the
+// DMP or a FIFO restart holding INT) counts as a gap instead.
+//
+// Wire format (heartbeat query, real-time builds), comma-separated decimal:
+//   isr = n, period_us, late_max_us, early_max_us, gaps, boot_late_max_us
+// late/early: the longest and shortest interval of the window against its
+// mean; boot_late_max_us the worst late one since boot. The window restarts
+// after a heartbeat gets a 200, as LoopProfile's does.
+class IsrJitter {
+  public:
+    // Nominal period in CPU cycles; restarts the interval chain
+    void begin(int sampleRateHz);
+
+    // In the ISR, with ESP.getCycleCount() at entry
+    inline void edge(uint32_t cycles) __attribute__((always_inline)) {
+      uint32_t interval = cycles - lastCycles;
+      lastCycles = cycles;
+      if (!haveLast) {
+        haveLast = true;
+        return;
+      }
+      if (interval > periodCycles + periodCycles / 2 || interval < periodCycles / 2) {
+        gaps++;
+        return;
+      }
+      if (n == 0 || interval < minCycles) minCycles = interval;
+      if (interval > maxCycles) maxCycles = interval;
+      sumCycles += interval;
+      n++;
+    }
+
+    // Restart the chain after the INT pin was detached
+    void restart() { haveLast = false; }
+
+    void appendQuery(String& url);
+
+    // Start a new window; the chain carries over
+    void reset();
+
+  private:
+    volatile uint32_t lastCycles = 0;
+    volatile bool     haveLast = false;
+    uint32_t periodCycles = 0;
+    volatile uint32_t n = 0;
+    volatile uint32_t minCycles = 0;
+    volatile uint32_t maxCycles = 0;
+    volatile uint64_t sumCycles = 0;   // an hour of 100Hz periods overflows 32 bits
+    volatile uint32_t gaps = 0;
+    uint32_t bootLateCycles = 0;
+};
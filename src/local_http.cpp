@@ -0,0 +1,128 @@
+#include "local_http.h"
+
+namespace {
+
+const char INDEX_BODY[] =
+    "GET /status  bias, thresholds, loop timing, heap (JSON)\n"
+    "GET /live    decimated de-biased samples (text/event-stream)\n";
+
+void writeHead(WiFiClient& c, int code, const char* reason, const char* contentType) {
+  c.printf("HTTP/1.1 %d %s\r\nContent-Type: %s\r\nCache-Control: no-cache\r\n"
+           "Access-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n", code, reason, contentType);
+}
+
+}  // namespace
+
+void LocalHttp::begin(int sampleRateHz, LocalStatusFn status) {
+  statusFn = status;
+  decimation = max(1, sampleRateHz / LOCAL_HTTP_LIVE_HZ);
+  if (running) return;
+  server.begin();
+  server.setNoDelay(true);
+  running = true;
+}
+
+void LocalHttp::stop() {
+  if (!running) return;
+  pending.stop();
+  live.stop();
+  streaming = false;
+  server.stop();
+  running = false;
+}
+
+void LocalHttp::closeSample(unsigned long ms) {
+  LiveSample& s = ring[head];
+  s.ms = ms;
+  s.x = (int16_t)constrain(sum[0] / summed, -32768L, 32767L);
+  s.y = (int16_t)constrain(sum[1] / summed, -32768L, 32767L);
+  s.z = (int16_t)constrain(sum[2] / summed, -32768L, 32767L);
+  sum[0] = sum[1] = sum[2] = 0;
+  summed = 0;
+  head = (head + 1) % LOCAL_HTTP_LIVE_RING;
+  if (filled < LOCAL_HTTP_LIVE_RING) filled++;
+  else droppedSamples++;   // the oldest went
+}
+
+void LocalHttp::poll(unsigned long now, bool busy) {
+  if (!running) return;
+  if (streaming && !live.connected()) {
+    live.stop();
+    streaming = false;
+  }
+  if (busy) return;
+  if (streaming) writeLive();
+  if (pending) {
+    if (readLine()) respond();
+    else if (now - pendingAt > LOCAL_HTTP_REQUEST_MS || !pending.connected()) pending.stop();
+    return;
+  }
+  accept(now);
+}
+
+void LocalHttp::accept(unsigned long now) {
+  if (now - lastAcceptAt < LOCAL_HTTP_MIN_GAP_MS || !server.hasClient()) return;
+  lastAcceptAt = now;
+  pending = server.accept();
+  pendingAt = now;
+  lineLen = 0;
+}
+
+// Whatever of the request line has arrived; true once it's complete
+bool LocalHttp::readLine() {
+  while (pending.available()) {
+    int ch = pending.read();
+    if (ch == '\n') return true;
+    if (ch != '\r' && lineLen < sizeof(line) - 1) line[lineLen++] = (char)ch;
+  }
+  return false;
+}
+
+void LocalHttp::respond() {
+  line[lineLen] = '\0';
+  requests++;
+  // "GET /path HTTP/1.1"; the headers that follow are never read
+  char* path = strchr(line, ' ');
+  char* end = path ? strchr(path + 1, ' ') : nullptr;
+  if (end) *end = '\0';
+  if (strncmp(line, "GET ", 4) != 0 || !path) {
+    writeHead(pending, 405, "Method Not Allowed", "text/plain");
+  } else if (strcmp(path + 1, "/status") == 0 && statusFn) {
+    writeHead(pending, 200, "OK", "application/json");
+    statusFn(pending);
+  } else if (strcmp(path + 1, "/live") == 0) {
+    if (streaming) {
+      writeHead(pending, 409, "Conflict", "text/plain");
+      pending.print("one /live client at a time\n");
+    } else {
+      writeHead(pending, 200, "OK", "text/event-stream");
+      live = pending;
+      pending = WiFiClient();
+      filled = 0;
+      summed = 0;
+      sum[0] = sum[1] = sum[2] = 0;
+      streaming = true;
+      return;
+    }
+  } else if (strcmp(path + 1, "/") == 0) {
+    writeHead(pending, 200, "OK", "text/plain");
+    pending.print(INDEX_BODY);
+  } else {
+    writeHead(pending, 404, "Not Found", "text/plain");
+  }
+  pending.stop();
+}
+
+void LocalHttp::writeLive() {
+  size_t budget = LOCAL_HTTP_CHUNK;
+  char event[48];
+  while (filled > 0) {
+    const LiveSample& s = ring[(head - filled + LOCAL_HTTP_LIVE_RING) % LOCAL_HTTP_LIVE_RING];
+    int n = snprintf(event, sizeof(event), "data: %lu,%d,%d,%d\n\n", s.ms, s.x, s.y, s.z);
+    // Only what goes into the socket's buffer now; the rest waits
+    if ((size_t)n > budget || live.availableForWrite() < n) return;
+    live.write((const uint8_t*)event, n);
+    budget -= n;
+    filled--;
+  }
+}
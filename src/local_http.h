@@ -0,0 +1,82 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+
+// -- Local diagnostics server -------------------------------------------------
+// Plain HTTP on the node itself, for installation and debugging without a
+// serial cable (config "local_http", off by default):
+//   GET /status  JSON: bias, thresholds, loop-timing histograms, heap, link
+//   GET /live    text/event-stream, one "data: ms,x,y,z" event per sample at
+//                LOCAL_HTTP_LIVE_HZ (de-biased LSB, boxcar averaged), for a
+//                browser's EventSource
+// It runs from the last loop task and only ever takes what is spare: one
+// request is read per LOCAL_HTTP_MIN_GAP_MS and /status is a single reply of
+// under 1KB. There is one /live client at a time, and a pass writes it at
+// most LOCAL_HTTP_CHUNK bytes, only what the socket takes without waiting.
+// While a capture or upload is running nothing is served at all. /live keeps
+// its connection then, and samples that don't fit its ring are dropped and
+// counted.
+#define LOCAL_HTTP_PORT        80
+#define LOCAL_HTTP_LIVE_HZ     10
+#define LOCAL_HTTP_LIVE_RING   64       // decimated samples held for the /live client
+#define LOCAL_HTTP_MIN_GAP_MS  250      // between accepted requests
+#define LOCAL_HTTP_CHUNK       512      // bytes written per pass
+#define LOCAL_HTTP_REQUEST_MS  1000     // for the request line to arrive
+#define LOCAL_HTTP_LINE_SIZE   64
+
+typedef void (*LocalStatusFn)(Print& out);   // writes the /status JSON
+
+class LocalHttp {
+  public:
+    void begin(int sampleRateHz, LocalStatusFn status);
+    void stop();
+    bool enabled() const { return running; }
+
+    // Every de-biased sample; only averaged and kept while /live is open
+    void add(unsigned long ms, int32_t x, int32_t y, int32_t z) {
+      if (!streaming) return;
+      sum[0] += x;
+      sum[1] += y;
+      sum[2] += z;
+      if (++summed >= decimation) closeSample(ms);
+    }
+
+    // From a task; with 'busy' (capturing or uploading) only the samples move
+    void poll(unsigned long now, bool busy);
+
+    uint32_t served() const { return requests; }
+    uint32_t dropped() const { return droppedSamples; }
+
+  private:
+    struct LiveSample {
+      unsigned long ms;
+      int16_t       x, y, z;
+    };
+
+    void closeSample(unsigned long ms);
+    void accept(unsigned long now);
+    bool readLine();
+    void respond();
+    void writeLive();
+
+    WiFiServer    server{LOCAL_HTTP_PORT};
+    bool          running = false;
+    LocalStatusFn statusFn = nullptr;
+    int           decimation = 1;
+
+    WiFiClient    pending;              // accepted, request line not complete yet
+    unsigned long pendingAt = 0;
+    unsigned long lastAcceptAt = 0;
+    char          line[LOCAL_HTTP_LINE_SIZE];
+    size_t        lineLen = 0;
+    uint32_t      requests = 0;
+
+    WiFiClient    live;
+    bool          streaming = false;
+    int32_t       sum[3] = {};
+    int           summed = 0;
+    LiveSample    ring[LOCAL_HTTP_LIVE_RING];
+    int           head = 0;             // next slot to fill
+    int           filled = 0;
+    uint32_t      droppedSamples = 0;
+};
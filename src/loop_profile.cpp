@@ -0,0 +1,80 @@
+#include "loop_profile.h"
+
+namespace {
+
+const char* const PHASE_NAMES[PHASE_COUNT] = { "i2c", "detect", "serial", "http", "loop" };
+
+template <typename T>
+void saturatingInc(T& v) {
+  if (v < (T)~(T)0) v++;
+}
+
+}  // namespace
+
+const char* LoopProfile::phaseName(ProfilePhase p) {
+  return PHASE_NAMES[p];
+}
+
+void LoopProfile::begin(int sampleRateHz) {
+  periodMs = 1000UL / (uint32_t)max(1, sampleRateHz);
+  haveLast = false;
+  reset();
+}
+
+void LoopProfile::recordUs(ProfilePhase phase, uint32_t us) {
+  PhaseStats& s = phases[phase];
+  s.n++;
+  // Saturate rather than wrap if heartbeats fail for over an hour
+  s.totalUs = s.totalUs + us < s.totalUs ? UINT32_MAX : s.totalUs + us;
+  if (us > s.maxUs) s.maxUs = us;
+  int k = 0;
+  for (uint32_t edge = 8; k < PROFILE_BUCKETS - 1 && us >= edge; edge <<= 2) k++;
+  saturatingInc(s.buckets[k]);
+}
+
+void LoopProfile::sample(unsigned long ms) {
+  if (haveLast) {
+    uint32_t interval = ms - lastSampleMs;
+    if (isiN == 0 || interval < isiMin) isiMin = interval;
+    if (interval > isiMax) isiMax = interval;
+    isiN++;
+    uint32_t dev = interval > periodMs ? interval - periodMs : periodMs - interval;
+    int k = 0;
+    while (k < INTERVAL_BUCKETS - 1 && dev >= (1UL << k)) k++;
+    saturatingInc(isiBuckets[k]);
+  }
+  lastSampleMs = ms;
+  haveLast = true;
+}
+
+void LoopProfile::appendQuery(String& url) const {
+  for (int p = 0; p < PHASE_COUNT; p++) {
+    const PhaseStats& s = phases[p];
+    if (s.n == 0) continue;
+    url += "&prof_";
+    url += PHASE_NAMES[p];
+    url += '=';
+    url += (unsigned long)s.n;       url += ',';
+    url += (unsigned long)s.totalUs; url += ',';
+    url += (unsigned long)s.maxUs;
+    for (int k = 0; k < PROFILE_BUCKETS; k++) {
+      url += ',';
+      url += (unsigned long)s.buckets[k];
+    }
+  }
+  if (isiN == 0) return;
+  url += "&isi=";
+  url += (unsigned long)isiN;   url += ',';
+  url += (unsigned long)isiMin; url += ',';
+  url += (unsigned long)isiMax;
+  for (int k = 0; k < INTERVAL_BUCKETS; k++) {
+    url += ',';
+    url += (unsigned long)isiBuckets[k];
+  }
+}
+
+void LoopProfile::reset() {
+  memset(phases, 0, sizeof(phases));
+  memset(isiBuckets, 0, sizeof(isiBuckets));
+  isiN = isiMin = isiMax = 0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Loop timing profile ------------------------------------------------------
+// micros() cost of each loop phase plus the spacing of the samples themselves,
+// kept as fixed-bucket histograms (no allocation, a few hundred bytes) and
+// reported with each heartbeat. The window restarts after a heartbeat gets
+// a 200, so each report covers one heartbeat interval.
+//
+// Phase histograms: PROFILE_BUCKETS buckets, x4 apart. Bucket k counts
+// durations below 8 << (2k) us (8us, 32us, 128us ... 131ms); the last bucket
+// counts everything longer.
+// Interval histogram: |interval - nominal period| in ms per sample, buckets
+// 0, 1, 2-3, 4-7, 8-15, 16-31, 32+.
+//
+// Wire format (heartbeat query), comma-separated decimal:
+//   prof_<phase> = n, total_us, max_us, b0..b8    (phase: i2c detect serial http loop)
+//   isi          = n, min_ms, max_ms, b0..b6
+#define PROFILE_BUCKETS     9
+#define INTERVAL_BUCKETS    7
+
+enum ProfilePhase : uint8_t {
+  PHASE_I2C,       // bus time, from the I2Cdev counters
+  PHASE_DETECT,    // processSample() minus the plotter print
+  PHASE_SERIAL,    // plotter print
+  PHASE_HTTP,      // heartbeat, upload poll, journal replay
+  PHASE_LOOP,      // one loop() pass, up to its pacing delay
+  PHASE_COUNT
+};
+
+struct PhaseStats {
+  uint32_t n;
+  uint32_t totalUs;
+  uint32_t maxUs;
+  uint16_t buckets[PROFILE_BUCKETS];
+};
+
+class LoopProfile {
+  public:
+    void begin(int sampleRateHz);
+
+    // Add micros() - startUs (or a measured duration) to a phase
+    void record(ProfilePhase phase, uint32_t startUs) { recordUs(phase, micros() - startUs); }
+    void recordUs(ProfilePhase phase, uint32_t us);
+
+    // Feed every sample timestamp (ms) in order
+    void sample(unsigned long ms);
+
+    const PhaseStats& phase(ProfilePhase p) const { return phases[p]; }
+    static const char* phaseName(ProfilePhase p);   // as in the prof_<phase> parameters
+
+    // Append the prof_* and isi parameters for the current window
+    void appendQuery(String& url) const;
+
+    // Start a new window; the interval chain carries over
+    void reset();
+
+  private:
+    PhaseStats phases[PHASE_COUNT];
+    uint32_t   isiN = 0;
+    uint32_t   isiMin = 0, isiMax = 0;
+    uint16_t   isiBuckets[INTERVAL_BUCKETS];
+    unsigned long lastSampleMs = 0;
+    bool       haveLast = false;
+    uint32_t   periodMs = 10;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// -- A message link to the server ---------------------------------------------
+// What AsyncUploader and TriggerNotice need of a link that stands in for the
+// HTTP POST and the trigger datagram: the MQTT broker (mqtt_link.h) or a
+// device session (session_link.h). leaf names the message as the MQTT topics
+// do: "trigger" or "event".
+class MessageLink {
+  public:
+    virtual bool connected() const = 0;
+    // Connected and able to take publish() or startPublish() now
+    virtual bool writable() const = 0;
+
+    // Sent now, not waited for and not resent
+    virtual bool publish(const char* leaf, const uint8_t* payload, size_t length) = 0;
+
+    // head then body, streamed from the link's poll(); both must stay put
+    // until publishResult() is nonzero
+    virtual bool startPublish(const char* leaf, const uint8_t* head, size_t headLength,
+                              const uint8_t* body, size_t bodyLength) = 0;
+    // 0 while in flight, the HTTP status the upload got (a broker's PUBACK
+    // counts as 201), or negative once the link lost it
+    virtual int  publishResult() const = 0;
+
+  protected:
+    ~MessageLink() = default;
+};
@@ -0,0 +1,41 @@
+#include "modem_sleep.h"
+#include <ESP8266WiFi.h>
+
+void ModemSleep::begin(unsigned long now) {
+  WiFi.setSleepMode(WIFI_MODEM_SLEEP, MODEM_SLEEP_LISTEN);
+  reset(now);
+  Serial.printf("Modem sleep: up to %d x %dms between drains\n", MODEM_SLEEP_LISTEN, MODEM_SLEEP_DTIM_MS);
+}
+
+uint32_t ModemSleep::span(int fifoRateHz, bool idle, unsigned long untilDue) const {
+  if (!idle) return 0;
+  uint32_t fill = MODEM_SLEEP_FIFO_SAMPLES * MODEM_SLEEP_FIFO_PCT * 10UL / (uint32_t)max(1, fifoRateHz);
+  uint32_t ms = min(min(fill, (uint32_t)(MODEM_SLEEP_LISTEN * MODEM_SLEEP_DTIM_MS)), (uint32_t)untilDue);
+  // Whole DTIM intervals, so the wake lands where the radio is up anyway
+  return ms / MODEM_SLEEP_DTIM_MS * MODEM_SLEEP_DTIM_MS;
+}
+
+void ModemSleep::sleep(uint32_t ms) {
+  woken = false;
+  unsigned long t0 = millis();
+  esp_delay(ms, [this]() { return !woken; });
+  uint32_t took = millis() - t0;
+  sleeps++;
+  sleptMs += took;
+  lastSpan = ms;
+  if (woken && took < ms) early++;
+}
+
+void ModemSleep::appendQuery(String& url, unsigned long now) const {
+  url += "&sleep=";
+  url += (unsigned long)sleeps;              url += ',';
+  url += (unsigned long)sleptMs;             url += ',';
+  url += (unsigned long)(now - windowStart); url += ',';
+  url += (unsigned long)early;               url += ',';
+  url += (unsigned long)lastSpan;
+}
+
+void ModemSleep::reset(unsigned long now) {
+  windowStart = now;
+  sleeps = sleptMs = early = 0;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+#include <coredecls.h>   // esp_schedule, esp_delay
+
+#ifndef MODEM_SLEEP
+    #define MODEM_SLEEP 0
+#endif
+
+// -- Modem-sleep scheduling (-DMODEM_SLEEP=1, env nodemcuv2_sleep) -------------
+// In the FIFO modes the sensor buffers its own samples, so an idle node
+// only has to wake often enough to drain them. Between passes loop() sleeps
+// for span(): a whole number of DTIM intervals, at most MODEM_SLEEP_LISTEN of
+// them (the listen interval the station asks the AP for, so the radio sleeps
+// across the same beacons), no longer than fills MODEM_SLEEP_FIFO_PCT of the
+// FIFO at its current rate, and never past the next timed task. The radio is
+// off and the CPU idle for most of it, so the board runs cooler and quieter
+// next to the sensor. A capture, an upload in flight, a dropped link or the
+// motion mode's full rate keep the usual short delay. In ACQ_MODE_MOTION the
+// motion ISR's wake() ends a sleep at once.
+//
+// Wire format (heartbeat query), comma-separated decimal:
+//   sleep = sleeps, slept_ms, window_ms, early_wakes, span_ms
+// The awake duty cycle is 1 - slept_ms / window_ms. The window restarts after
+// a heartbeat gets a 200.
+#ifndef MODEM_SLEEP_DTIM_MS
+    #define MODEM_SLEEP_DTIM_MS  102     // beacon interval x DTIM period of the AP (102.4ms x 1)
+#endif
+#ifndef MODEM_SLEEP_LISTEN
+    #define MODEM_SLEEP_LISTEN   3       // DTIMs per sleep, at most
+#endif
+#define MODEM_SLEEP_FIFO_PCT     50
+#define MODEM_SLEEP_FIFO_SAMPLES 170     // the 1024-byte FIFO, in 6-byte samples
+
+class ModemSleep {
+  public:
+    // WIFI_MODEM_SLEEP with the listen interval; once connected
+    void begin(unsigned long now);
+
+    // ms loop() may sleep now: 0 unless idle, at most untilDue
+    uint32_t span(int fifoRateHz, bool idle, unsigned long untilDue) const;
+
+    // Sleep ms, or until wake()
+    void sleep(uint32_t ms);
+
+    // From an ISR: end the sleep in progress
+    inline void wake() __attribute__((always_inline)) {
+      woken = true;
+      esp_schedule();
+    }
+
+    void appendQuery(String& url, unsigned long now) const;
+
+    // Start a new window at now
+    void reset(unsigned long now);
+
+  private:
+    volatile bool woken = false;
+    unsigned long windowStart = 0;
+    uint32_t sleeps = 0;
+    uint32_t sleptMs = 0;
+    uint32_t early = 0;
+    uint32_t lastSpan = 0;
+};
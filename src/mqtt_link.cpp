@@ -0,0 +1,370 @@
+#include "mqtt_link.h"
+
+#if MQTT_LINK
+
+namespace {
+
+const uint8_t MQTT_CONNECT   = 0x10;
+const uint8_t MQTT_PUBLISH   = 0x30;
+const uint8_t MQTT_PUBACK    = 0x40;
+const uint8_t MQTT_SUBSCRIBE = 0x82;
+const uint8_t MQTT_PINGREQ   = 0xC0;
+
+const uint8_t QOS1   = 0x02;   // PUBLISH flags
+const uint8_t RETAIN = 0x01;
+
+const char OFFLINE[] = "offline";
+const char ONLINE[]  = "online";
+
+}  // namespace
+
+void MqttLink::begin(const char* host, uint16_t port, const char* deviceId) {
+  if (strcmp(host, brokerHost) == 0 && port == brokerPort) return;
+  stop();
+  snprintf(brokerHost, sizeof(brokerHost), "%s", host);
+  brokerPort = port;
+  snprintf(prefix, sizeof(prefix), "seismo/%s/", deviceId);
+  retryAt = millis();
+  if (enabled()) Serial.printf("MQTT: broker %s:%u\n", brokerHost, (unsigned)brokerPort);
+}
+
+void MqttLink::stop() {
+  fail();
+  retryAt = millis();
+}
+
+// Drop the socket; an upload in flight has failed, and HTTP takes over
+// until the retry
+void MqttLink::fail() {
+  if (isConnected) Serial.println("! MQTT: broker lost, back to HTTP");
+  client.stop();
+  isConnected = false;
+  rxStage = 0;
+  retryAt = millis() + MQTT_RETRY_MS;
+  if (streamId && result == 0) {
+    result = -1;
+    failed++;
+  }
+  streamId = 0;
+  streamSent = streamLength = 0;
+}
+
+bool MqttLink::writeHeader(uint8_t type, size_t remaining) {
+  uint8_t header[5];
+  size_t n = 0;
+  header[n++] = type;
+  do {
+    uint8_t b = remaining & 0x7F;
+    remaining >>= 7;
+    header[n++] = remaining ? (b | 0x80) : b;
+  } while (remaining && n < sizeof(header));
+  lastSent = millis();
+  return client.write(header, n) == n;
+}
+
+bool MqttLink::writeString(const char* s) {
+  size_t n = strlen(s);
+  uint8_t length[2] = { (uint8_t)(n >> 8), (uint8_t)n };
+  return client.write(length, 2) == 2 && client.write((const uint8_t*)s, n) == n;
+}
+
+size_t MqttLink::topicLength(const char* leaf) const {
+  return strlen(prefix) + strlen(leaf);
+}
+
+bool MqttLink::writeTopic(const char* leaf) {
+  size_t n = topicLength(leaf);
+  uint8_t length[2] = { (uint8_t)(n >> 8), (uint8_t)n };
+  return client.write(length, 2) == 2 &&
+         client.write((const uint8_t*)prefix, strlen(prefix)) == strlen(prefix) &&
+         client.write((const uint8_t*)leaf, strlen(leaf)) == strlen(leaf);
+}
+
+// Fixed header, topic and (QoS 1) packet id of a PUBLISH; the payload follows
+bool MqttLink::beginPublish(const char* leaf, size_t payloadLength, uint8_t flags, uint16_t& id) {
+  bool qos1 = flags & QOS1;
+  if (!writeHeader(MQTT_PUBLISH | flags, 2 + topicLength(leaf) + (qos1 ? 2 : 0) + payloadLength) ||
+      !writeTopic(leaf)) {
+    return false;
+  }
+  if (!qos1) return true;
+  id = nextId++;
+  if (!nextId) nextId = 1;
+  uint8_t packetId[2] = { (uint8_t)(id >> 8), (uint8_t)id };
+  return client.write(packetId, 2) == 2;
+}
+
+bool MqttLink::connect(unsigned long now) {
+  client.stop();
+  rxStage = 0;
+  if (!client.connect(brokerHost, brokerPort)) return false;
+  client.setNoDelay(true);
+  lastHeard = now;
+
+  // Clean session, with a retained QoS 1 will of "offline" on status
+  char clientId[32];
+  snprintf(clientId, sizeof(clientId), "%.*s", (int)strlen(prefix) - 1, prefix);
+  char willTopic[40];
+  snprintf(willTopic, sizeof(willTopic), "%sstatus", prefix);
+  static const uint8_t variable[10] = { 0, 4, 'M', 'Q', 'T', 'T', 4, 0x2E,
+                                        0, MQTT_KEEPALIVE_S };
+  size_t remaining = sizeof(variable) + 2 + strlen(clientId) + 2 + strlen(willTopic) +
+                     2 + strlen(OFFLINE);
+  if (!writeHeader(MQTT_CONNECT, remaining) || client.write(variable, sizeof(variable)) != sizeof(variable) ||
+      !writeString(clientId) || !writeString(willTopic) || !writeString(OFFLINE)) {
+    return false;
+  }
+
+  unsigned long t0 = millis();
+  bool accepted = false;
+  while (!accepted && millis() - t0 < MQTT_ACK_TIMEOUT_MS && client.connected()) {
+    if (!readPacket()) {
+      delay(1);
+      continue;
+    }
+    if ((rxType >> 4) != 2) continue;   // nothing else comes before CONNACK
+    if (ctl[1] != 0) {
+      Serial.printf("! MQTT: broker refused the connection (%u)\n", (unsigned)ctl[1]);
+      return false;
+    }
+    accepted = true;
+  }
+  if (!accepted) return false;
+
+  // config and cmd at QoS 1; the retained config follows the SUBACK
+  char config[40], cmd[40];
+  snprintf(config, sizeof(config), "%sconfig", prefix);
+  snprintf(cmd, sizeof(cmd), "%scmd", prefix);
+  uint16_t id = nextId++;
+  if (!nextId) nextId = 1;
+  uint8_t packetId[2] = { (uint8_t)(id >> 8), (uint8_t)id };
+  uint8_t qos = 1;
+  if (!writeHeader(MQTT_SUBSCRIBE, 2 + 2 + strlen(config) + 1 + 2 + strlen(cmd) + 1) ||
+      client.write(packetId, 2) != 2 ||
+      !writeString(config) || client.write(&qos, 1) != 1 ||
+      !writeString(cmd) || client.write(&qos, 1) != 1) {
+    return false;
+  }
+  uint16_t onlineId;
+  if (!beginPublish("status", strlen(ONLINE), QOS1 | RETAIN, onlineId) ||
+      client.write((const uint8_t*)ONLINE, strlen(ONLINE)) != strlen(ONLINE)) {
+    return false;
+  }
+  isConnected = true;
+  connects++;
+  return true;
+}
+
+// Read what has arrived of the current packet; true once it is complete.
+// A PUBLISH goes into rx unless a message is already held there; every
+// packet's first bytes go into ctl.
+bool MqttLink::readPacket() {
+  while (client.available()) {
+    uint8_t c = client.read();
+    if (rxStage == 0) {
+      rxType = c;
+      rxLength = 0;
+      rxShift = 0;
+      rxStage = 1;
+      continue;
+    }
+    if (rxStage == 1) {
+      rxLength |= (uint32_t)(c & 0x7F) << rxShift;
+      rxShift += 7;
+      if (c & 0x80) continue;
+      rxGot = 0;
+      rxKeep = (rxType >> 4) == 3 && held == MQTT_NOTHING;
+      rxStage = 2;
+      if (rxLength > 0) continue;
+      rxStage = 0;
+      lastHeard = millis();
+      return true;
+    }
+    if (rxKeep && rxGot < MQTT_RX_SIZE - 1) rx[rxGot] = c;
+    if (rxGot < sizeof(ctl)) ctl[rxGot] = c;
+    if (++rxGot == rxLength) {
+      rxStage = 0;
+      lastHeard = millis();
+      return true;
+    }
+  }
+  return false;
+}
+
+void MqttLink::dispatch() {
+  uint8_t type = rxType >> 4;
+  if (type == 4) {   // PUBACK
+    ackedId = (uint16_t)ctl[0] << 8 | ctl[1];
+    if (streamId && ackedId == streamId && !streaming()) {
+      result = 201;   // as the POST would have
+      acked++;
+      streamId = 0;
+    }
+    return;
+  }
+  if (type != 3) return;   // SUBACK, PINGRESP
+
+  if (!rxKeep) {
+    // Unacked, so a retained config comes again on the next connect
+    dropped++;
+    return;
+  }
+  size_t topicLen = (size_t)rx[0] << 8 | rx[1];
+  size_t at = 2 + topicLen;
+  uint8_t qos = (rxType >> 1) & 3;
+  if (qos) {
+    if (at + 2 > MQTT_RX_SIZE - 1 || at + 2 > rxLength) return;
+    uint8_t puback[4] = { MQTT_PUBACK, 2, rx[at], rx[at + 1] };
+    client.write(puback, sizeof(puback));
+    at += 2;
+  }
+  if (rxLength > MQTT_RX_SIZE - 1) {
+    Serial.printf("! MQTT: %lu-byte message dropped, %u fit\n", (unsigned long)rxLength, (unsigned)MQTT_RX_SIZE - 1);
+    dropped++;
+    return;
+  }
+  rx[rxLength] = '\0';
+
+  size_t prefixLen = strlen(prefix);
+  if (topicLen <= prefixLen || memcmp(rx + 2, prefix, prefixLen) != 0) return;
+  const char* leaf = (const char*)rx + 2 + prefixLen;
+  size_t leafLen = topicLen - prefixLen;
+  if (leafLen == 6 && memcmp(leaf, "config", 6) == 0) held = MQTT_CONFIG;
+  else if (leafLen == 3 && memcmp(leaf, "cmd", 3) == 0) held = MQTT_COMMAND;
+  heldOffset = at;
+}
+
+void MqttLink::poll(unsigned long now) {
+  if (!enabled()) return;
+  if (!isConnected) {
+    if ((long)(now - retryAt) < 0) return;
+    if (!connect(now)) {
+      client.stop();
+      retryAt = now + MQTT_RETRY_MS;
+      Serial.printf("! MQTT: no session with %s:%u, retrying in %lus\n", brokerHost,
+                    (unsigned)brokerPort, MQTT_RETRY_MS / 1000UL);
+      return;
+    }
+    Serial.printf("MQTT: connected to %s:%u\n", brokerHost, (unsigned)brokerPort);
+  }
+  if (!client.connected()) return fail();
+
+  if (streaming()) {
+    size_t room = client.availableForWrite();
+    const uint8_t* from;
+    size_t left;
+    if (streamSent < streamHeadLength) {
+      from = streamHead + streamSent;
+      left = streamHeadLength - streamSent;
+    } else {
+      from = streamBody + (streamSent - streamHeadLength);
+      left = streamLength - streamSent;
+    }
+    size_t n = min(min(room, (size_t)MQTT_CHUNK), left);
+    if (n > 0) {
+      streamSent += client.write(from, n);
+      lastSent = now;
+      if (!streaming()) streamDoneAt = now;
+    }
+  } else if (streamId && result == 0 && now - streamDoneAt > MQTT_ACK_TIMEOUT_MS) {
+    Serial.println("! MQTT: upload not acked");
+    return fail();
+  }
+
+  if (!streaming() && now - lastSent >= MQTT_KEEPALIVE_S * 500UL) {
+    uint8_t ping[2] = { MQTT_PINGREQ, 0 };
+    client.write(ping, sizeof(ping));
+    lastSent = now;
+  }
+  if (now - lastHeard > MQTT_KEEPALIVE_S * 1500UL) {
+    Serial.println("! MQTT: broker silent past the keepalive");
+    return fail();
+  }
+
+  while (readPacket()) dispatch();
+}
+
+bool MqttLink::publishWait(const char* leaf, const uint8_t* payload, size_t length) {
+  if (!writable()) return false;
+  uint16_t id;
+  if (!beginPublish(leaf, length, QOS1, id) || client.write(payload, length) != length) {
+    fail();
+    return false;
+  }
+  published++;
+  unsigned long t0 = millis();
+  while (millis() - t0 < MQTT_ACK_TIMEOUT_MS && client.connected()) {
+    if (!readPacket()) {
+      delay(1);
+      continue;
+    }
+    dispatch();
+    if ((rxType >> 4) == 4 && ackedId == id) {
+      acked++;
+      return true;
+    }
+  }
+  Serial.printf("! MQTT: %s not acked\n", leaf);
+  failed++;
+  fail();
+  return false;
+}
+
+bool MqttLink::publish(const char* leaf, const uint8_t* payload, size_t length) {
+  if (!writable()) return false;
+  uint16_t id;
+  if (!beginPublish(leaf, length, QOS1, id) || client.write(payload, length) != length) {
+    fail();
+    return false;
+  }
+  published++;
+  return true;
+}
+
+bool MqttLink::startPublish(const char* leaf, const uint8_t* head, size_t headLength,
+                            const uint8_t* body, size_t bodyLength) {
+  if (!writable() || (streamId && result == 0)) return false;
+  uint16_t id;
+  if (!beginPublish(leaf, headLength + bodyLength, QOS1, id)) {
+    fail();
+    return false;
+  }
+  published++;
+  streamHead = head;
+  streamBody = body;
+  streamHeadLength = headLength;
+  streamLength = headLength + bodyLength;
+  streamSent = 0;
+  streamId = id;
+  result = 0;
+  return true;
+}
+
+void MqttLink::appendQuery(String& url) const {
+  if (!enabled()) return;
+  url += "&mqtt=";
+  url += isConnected ? '1' : '0';     url += ',';
+  url += (unsigned long)connects;   url += ',';
+  url += (unsigned long)published;  url += ',';
+  url += (unsigned long)acked;      url += ',';
+  url += (unsigned long)failed;     url += ',';
+  url += (unsigned long)dropped;
+}
+
+#else
+
+void MqttLink::begin(const char*, uint16_t, const char*) {}
+
+void MqttLink::stop() {}
+
+void MqttLink::poll(unsigned long) {}
+
+bool MqttLink::publishWait(const char*, const uint8_t*, size_t) { return false; }
+
+bool MqttLink::publish(const char*, const uint8_t*, size_t) { return false; }
+
+bool MqttLink::startPublish(const char*, const uint8_t*, size_t, const uint8_t*, size_t) { return false; }
+
+void MqttLink::appendQuery(String&) const {}
+
+#endif
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+#include "message_link.h"
+
+#ifndef MQTT_LINK
+    #define MQTT_LINK 0
+#endif
+
+// -- MQTT to a broker (-DMQTT_LINK=1, env nodemcuv2_mqtt) ----------------------
+// With /api/init naming a broker ("mqtt": {"host", "port"}) the node talks to
+// it rather than to the server's HTTP routes, under seismo/<MAC>/:
+//   heartbeat  publish, QoS 1: the heartbeat query (what follows '?')
+//   trigger    publish, QoS 1: the trigger notice datagram (trigger_notice.h)
+//   event      publish, QoS 1: an upload's X-* request headers, a blank line,
+//              then the body, as AsyncUploader would POST it
+//   status     will and retained publish: "offline" / "online"
+//   config     subscribed: the /api/init body, retained, so a saved change
+//              arrives on its own and the current one on every (re)connect;
+//              it replaces reloading /api/init
+//   cmd        subscribed: what a heartbeat or push poll would have answered,
+//              "205", "203", "207", or "policy <X-Upload-Policy value>"
+// The server is another client of the same broker (server/lib/mqtt.js) and
+// feeds these into its HTTP handlers. The broker's PUBACK stands in for the
+// server's 2xx; it keeps QoS 1 messages for the server's session while the
+// server is down.
+//
+// Only what that takes of MQTT 3.1.1 is here: CONNECT (clean session, will),
+// PUBLISH at QoS 0/1 both ways, PUBACK, SUBSCRIBE and PINGREQ, over a plain
+// WiFiClient. A heartbeat is written whole and its PUBACK waited for, like the
+// HTTP GET it replaces; an upload is streamed a segment per poll(), as
+// AsyncUploader does. Whatever can't go right now (the socket is mid-upload
+// or down) goes over HTTP or UDP as before. A lost broker is retried every
+// MQTT_RETRY_MS.
+#define MQTT_PORT_DEFAULT    1883
+#define MQTT_KEEPALIVE_S     60
+#define MQTT_RETRY_MS        (60 * 1000UL)
+#define MQTT_ACK_TIMEOUT_MS  5000      // CONNACK, or a PUBACK
+#define MQTT_CHUNK           536       // upload bytes written per poll (one MSS)
+#define MQTT_RX_SIZE         1024      // largest message taken in: the retained config
+#if MQTT_LINK
+    // The broker socket opens after the arena is sized
+    #define MQTT_HEAP_RESERVE 2048
+#else
+    #define MQTT_HEAP_RESERVE 0
+#endif
+
+enum MqttInbound : uint8_t { MQTT_NOTHING, MQTT_CONFIG, MQTT_COMMAND };
+
+class MqttLink : public MessageLink {
+  public:
+    // Broker host:port, or "" to stop using one; same broker again keeps
+    // the connection. deviceId is copied into the topics.
+    void begin(const char* host, uint16_t port, const char* deviceId);
+    void stop();
+
+    bool enabled() const { return brokerHost[0] != '\0'; }
+    bool connected() const override { return isConnected; }
+    // Connected and not part way through streaming an upload
+    bool writable() const override { return isConnected && !streaming(); }
+
+    // Connect when due (blocking for the TCP connect and CONNACK, like the
+    // push channel's connect), keep alive, stream the upload in flight and
+    // take in what the broker sent
+    void poll(unsigned long now);
+
+    // A config or command that arrived, NUL-terminated in text(), held until
+    // consume(). A second one arriving meanwhile is dropped unacked.
+    MqttInbound pending() const { return held; }
+    const char* text() const { return (const char*)rx + heldOffset; }
+    void consume() { held = MQTT_NOTHING; }
+
+    // QoS 1 publish to seismo/<MAC>/<leaf>, waiting for the PUBACK; a missing
+    // one drops the connection, so the next heartbeat goes over HTTP
+    bool publishWait(const char* leaf, const uint8_t* payload, size_t length);
+
+    // QoS 1 publish, not waited for and not resent
+    bool publish(const char* leaf, const uint8_t* payload, size_t length) override;
+
+    // QoS 1 publish of head then body, streamed from poll(); both must stay
+    // put until publishResult() is nonzero: 201 acked, -1 connection lost or
+    // no PUBACK within MQTT_ACK_TIMEOUT_MS of the last byte
+    bool startPublish(const char* leaf, const uint8_t* head, size_t headLength,
+                      const uint8_t* body, size_t bodyLength) override;
+    int  publishResult() const override { return result; }
+
+    // "&mqtt=connected,connects,published,acked,failed,dropped": the link now,
+    // and counts since boot (MQTT builds with a broker)
+    void appendQuery(String& url) const;
+
+  private:
+    bool connect(unsigned long now);
+    bool streaming() const { return streamSent < streamLength; }
+    bool writeHeader(uint8_t type, size_t remaining);
+    bool writeString(const char* s);
+    bool writeTopic(const char* leaf);
+    size_t topicLength(const char* leaf) const;
+    bool beginPublish(const char* leaf, size_t payloadLength, uint8_t flags, uint16_t& id);
+    bool readPacket();
+    void dispatch();
+    void fail();
+
+#if MQTT_LINK
+    WiFiClient client;
+    uint8_t    rx[MQTT_RX_SIZE];
+#else
+    uint8_t    rx[1];
+#endif
+    char       brokerHost[64] = "";
+    uint16_t   brokerPort = MQTT_PORT_DEFAULT;
+    char       prefix[32];           // "seismo/AA:BB:CC:DD:EE:FF/"
+
+    bool          isConnected = false;
+    unsigned long retryAt = 0;
+    unsigned long lastSent = 0;      // for the keepalive
+    unsigned long lastHeard = 0;
+    uint16_t      nextId = 1;
+
+    // The packet being read: type byte, remaining length, bytes so far
+    uint8_t  rxStage = 0;
+    uint8_t  rxType = 0;
+    uint32_t rxLength = 0;
+    uint8_t  rxShift = 0;
+    uint32_t rxGot = 0;
+    bool     rxKeep = false;         // stored in rx, else only its first bytes
+    uint8_t  ctl[4];                 // those first bytes (acks and skipped publishes)
+
+    MqttInbound held = MQTT_NOTHING;
+    uint16_t    heldOffset = 0;
+    uint16_t    ackedId = 0;         // last PUBACK read
+
+    // The upload streamed from poll()
+    const uint8_t* streamHead = nullptr;
+    const uint8_t* streamBody = nullptr;
+    size_t         streamHeadLength = 0;
+    size_t         streamLength = 0;   // head + body
+    size_t         streamSent = 0;
+    uint16_t       streamId = 0;
+    unsigned long  streamDoneAt = 0;
+    int            result = 0;
+
+    uint32_t connects = 0;
+    uint32_t published = 0;
+    uint32_t acked = 0;
+    uint32_t failed = 0;
+    uint32_t dropped = 0;            // inbound messages dropped
+};
@@ -0,0 +1,96 @@
+#include "ota_update.h"
+#include <ESP8266httpUpdate.h>
+
+namespace {
+
+const uint32_t OTA_RTC_MAGIC = 0x3141544F;  // "OTA1"
+
+// Word-aligned for rtcUserMemoryRead/Write
+struct OtaRecord {
+  uint32_t magic;
+  uint32_t bytes;
+  uint32_t ms;
+  uint32_t check;   // ~(magic ^ bytes ^ ms)
+};
+
+static_assert(sizeof(OtaRecord) % 4 == 0, "RTC memory is accessed in words");
+
+// Progress callbacks are plain function pointers
+unsigned long startedAt = 0;
+uint32_t progressBytes = 0;
+
+}  // namespace
+
+void OtaUpdater::begin(ServerTls* serverTls) {
+  tls = serverTls;
+  OtaRecord r;
+  if (!ESP.rtcUserMemoryRead(OTA_RTC_OFFSET, (uint32_t*)&r, sizeof(r))) return;
+  if (r.magic != OTA_RTC_MAGIC || r.check != ~(r.magic ^ r.bytes ^ r.ms)) return;
+  haveResult = true;
+  outcome = OTA_OK;
+  bytes = r.bytes;
+  ms = r.ms;
+  r.magic = 0;   // report it once
+  ESP.rtcUserMemoryWrite(OTA_RTC_OFFSET, (uint32_t*)&r, sizeof(r));
+  Serial.printf("Updated over the air: %u bytes in %ums\n", (unsigned)bytes, (unsigned)ms);
+}
+
+void OtaUpdater::schedule(const char* firmwareUrl, const char* target, unsigned long now) {
+  if (scheduled) return;
+  // gz=1: take the gzip image, eboot inflates it in place on the reboot
+  url = firmwareUrl;
+  url += strchr(firmwareUrl, '?') ? "&gz=1" : "?gz=1";
+  strncpy(version, target, sizeof(version) - 1);
+  scheduledAt = now;
+  scheduled = true;
+  Serial.printf("OTA update to %s scheduled in %lus\n", version, (unsigned long)OTA_DEFER_MS / 1000UL);
+}
+
+void OtaUpdater::run(const char* currentVersion) {
+  scheduled = false;
+  Serial.printf("OTA: downloading %s from %s\n", version, url.c_str());
+  startedAt = millis();
+  progressBytes = 0;
+  ESPhttpUpdate.onStart([]() { startedAt = millis(); });
+  ESPhttpUpdate.onProgress([](int done, int) { progressBytes = (uint32_t)done; });
+  ESPhttpUpdate.rebootOnUpdate(false);   // save the numbers first
+
+  // ESPhttpUpdate sends our sketch MD5, so a server whose image we already
+  // run answers 304 (NO_UPDATES) instead of resending it
+  ServerClient client;
+  tls->configure(client);
+  t_httpUpdate_return ret = ESPhttpUpdate.update(client, url, currentVersion);
+  bytes = progressBytes;
+  ms = millis() - startedAt;
+  haveResult = true;
+  switch (ret) {
+    case HTTP_UPDATE_OK: {
+      outcome = OTA_OK;
+      OtaRecord r = { OTA_RTC_MAGIC, bytes, ms, 0 };
+      r.check = ~(r.magic ^ r.bytes ^ r.ms);
+      ESP.rtcUserMemoryWrite(OTA_RTC_OFFSET, (uint32_t*)&r, sizeof(r));
+      Serial.printf("OTA: %u bytes in %ums, rebooting into %s\n", (unsigned)bytes, (unsigned)ms, version);
+      ESP.restart();
+      break;
+    }
+    case HTTP_UPDATE_NO_UPDATES:
+      outcome = OTA_CURRENT;
+      Serial.println("OTA: Server says no update (already running this image).");
+      break;
+    default:
+      outcome = OTA_FAILED;
+      Serial.printf("OTA FAILED (%d): %s after %u bytes\n", ESPhttpUpdate.getLastError(),
+                    ESPhttpUpdate.getLastErrorString().c_str(), (unsigned)bytes);
+      break;
+  }
+}
+
+void OtaUpdater::appendQuery(String& out) const {
+  if (!haveResult) return;
+  out += "&ota=";
+  out += outcome == OTA_OK ? "ok" : outcome == OTA_CURRENT ? "current" : "failed";
+  out += "&ota_bytes=";
+  out += (unsigned long)bytes;
+  out += "&ota_ms=";
+  out += (unsigned long)ms;
+}
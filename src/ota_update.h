@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+#include "server_tls.h"
+
+// -- Deferred OTA -------------------------------------------------------------
+// /api/init (or a config reload) only schedules the update. It runs from
+// loop() once sampling has been up for OTA_DEFER_MS and nothing is being
+// captured or uploaded, so a slow download never holds back a node coming
+// online. The download itself still blocks (ESPhttpUpdate writes flash as it
+// reads); the FIFO overflows meanwhile and is restarted like any other loss.
+//
+// The outcome - bytes, ms, ok / failed / current (304) - goes out with the next
+// heartbeat as &ota=..&ota_bytes=..&ota_ms=.. . A successful update reboots
+// before it can send one, so it is left in RTC user memory for the new
+// firmware to report.
+#define OTA_DEFER_MS     30000
+#define OTA_RTC_OFFSET   56      // words, after the Wi-Fi cache
+
+class OtaUpdater {
+  public:
+    // Pick up the result an update left behind before its reboot; tls sets
+    // up the download's client
+    void begin(ServerTls* tls);
+
+    void schedule(const char* url, const char* version, unsigned long now);
+    bool pending() const { return scheduled; }
+    bool due(unsigned long now) const { return scheduled && now - scheduledAt >= OTA_DEFER_MS; }
+
+    // Download and flash; reboots on success, returns otherwise
+    void run(const char* currentVersion);
+
+    // Append "&ota=..&ota_bytes=..&ota_ms=.." if there is a result to report
+    void appendQuery(String& url) const;
+
+    // The server has the result
+    void reported() { haveResult = false; }
+
+  private:
+    enum Outcome : uint8_t { OTA_OK, OTA_FAILED, OTA_CURRENT };
+
+    ServerTls* tls = nullptr;
+    String   url;
+    char     version[16] = "";
+    unsigned long scheduledAt = 0;
+    bool     scheduled = false;
+
+    bool     haveResult = false;
+    Outcome  outcome = OTA_OK;
+    uint32_t bytes = 0;
+    uint32_t ms = 0;
+};
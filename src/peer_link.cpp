@@ -0,0 +1,63 @@
+#include "peer_link.h"
+
+extern "C" {
+#include <espnow.h>
+}
+
+PeerLink* PeerLink::instance = nullptr;
+
+namespace {
+
+uint8_t BROADCAST[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+}  // namespace
+
+bool PeerLink::begin() {
+  if (up) return true;
+  if (esp_now_init() != 0) return false;
+  esp_now_set_self_role(ESP_NOW_ROLE_COMBO);
+  instance = this;
+  esp_now_register_recv_cb(onReceive);
+  if (esp_now_add_peer(BROADCAST, ESP_NOW_ROLE_COMBO, WiFi.channel(), nullptr, 0) != 0) {
+    esp_now_deinit();
+    return false;
+  }
+  up = true;
+  return true;
+}
+
+void PeerLink::broadcast(uint32_t seq, EventLevel level, TriggerMethod trigger) {
+  if (!up) return;
+  uint8_t frame[PEER_FRAME_SIZE];
+  memcpy(frame, "SPN1", 4);
+  memcpy(frame + 4, &seq, 4);   // little-endian core
+  frame[8] = level;
+  frame[9] = trigger;
+  if (esp_now_send(BROADCAST, frame, sizeof(frame)) != 0) sendFailures++;
+}
+
+void PeerLink::onReceive(uint8_t* mac, uint8_t* data, uint8_t len) {
+  if (!instance || len < PEER_FRAME_SIZE || memcmp(data, "SPN1", 4) != 0) return;
+  PeerLink& self = *instance;
+  Notice& n = self.notices[self.next];
+  memcpy(n.mac, mac, 6);
+  n.at = millis();
+  self.next = (self.next + 1) % PEER_NOTICE_SLOTS;
+  if (self.stored < PEER_NOTICE_SLOTS) self.stored++;
+  self.received++;
+}
+
+int PeerLink::peersNear(unsigned long at, unsigned long windowMs) const {
+  const uint8_t* seen[PEER_NOTICE_SLOTS];
+  int distinct = 0;
+  for (int k = 0; k < stored; k++) {
+    const Notice& n = notices[k];
+    // Signed difference, so it holds across the millis() wrap
+    long d = (long)(n.at - at);
+    if (d < -(long)windowMs || d > (long)windowMs) continue;
+    bool dup = false;
+    for (int i = 0; i < distinct && !dup; i++) dup = memcmp(seen[i], n.mac, 6) == 0;
+    if (!dup) seen[distinct++] = n.mac;
+  }
+  return distinct;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+#include "detector.h"
+
+// -- ESP-NOW peer triggers ----------------------------------------------------
+// Nodes on the same Wi-Fi channel broadcast a tiny frame to each other when a
+// capture opens, over ESP-NOW (no AP or server in the path, a few ms on the
+// air). Each node keeps the last PEER_NOTICE_SLOTS frames it heard with their
+// arrival millis(), so "did anyone else trigger near my trigger" is answered
+// locally: the local coincidence that backs the upload's X-Event-Local and
+// the LED alarm, with or without the server.
+//
+// Arrival time stands in for the peer's trigger time; at ESP-NOW latency that
+// is well inside a consensus window. Frames carry no group, so every node on
+// the channel counts as a peer.
+//
+// Frame, little-endian:
+//   0  "SPN1"
+//   4  uint32  event seq (the sender's)
+//   8  uint8   level (EventLevel)
+//   9  uint8   trigger (TriggerMethod)
+#define PEER_FRAME_SIZE   10
+#define PEER_NOTICE_SLOTS 8
+
+class PeerLink {
+  public:
+    // ESP-NOW on the station's current channel; call once Wi-Fi is up.
+    // False if the SDK refuses it (the node then only ever counts itself).
+    bool begin();
+    bool enabled() const { return up; }
+
+    void broadcast(uint32_t seq, EventLevel level, TriggerMethod trigger);
+
+    // Distinct peers heard within windowMs either side of 'at' (millis)
+    int peersNear(unsigned long at, unsigned long windowMs) const;
+
+    uint32_t heard() const { return received; }
+    uint32_t failed() const { return sendFailures; }
+
+  private:
+    static void onReceive(uint8_t* mac, uint8_t* data, uint8_t len);
+    static PeerLink* instance;   // the one begin() hooked up to the callback
+
+    struct Notice {
+      uint8_t       mac[6];
+      unsigned long at;
+    };
+
+    // Filled from the SDK's receive callback, which runs between loop()
+    // passes on this single-core chip, never inside one
+    Notice   notices[PEER_NOTICE_SLOTS] = {};
+    int      next = 0;
+    int      stored = 0;
+    uint32_t received = 0;
+    uint32_t sendFailures = 0;
+    bool     up = false;
+};
@@ -0,0 +1,109 @@
+#include "push_channel.h"
+#include <ESP8266HTTPClient.h>
+#include "server_link.h"
+
+void PushChannel::begin(const char* rootUrl, const char* deviceId, ServerTls* serverTls) {
+  String rootPath;
+  splitUrl(rootUrl, host, port, rootPath);
+  tls = serverTls;
+  tls->configure(client);
+  snprintf(path, sizeof(path), "%sapi/push?id=%s", rootPath.c_str(), deviceId);
+}
+
+bool PushChannel::send(uint32_t configGen) {
+  if (!client.connected()) {
+    client.stop();
+    if (!tls->connect(client, host.c_str(), port)) return false;
+    client.setNoDelay(true);
+  }
+  char header[192];
+  int n = snprintf(header, sizeof(header),
+                   "GET %s&cfg=%lu HTTP/1.1\r\n"
+                   "Host: %s:%u\r\n"
+                   "Connection: keep-alive\r\n\r\n",
+                   path, (unsigned long)configGen, host.c_str(), port);
+  return n < (int)sizeof(header) && client.write((const uint8_t*)header, n) == (size_t)n;
+}
+
+// Accumulate one CRLF-terminated response line; true once complete
+bool PushChannel::readLine() {
+  while (client.available()) {
+    char c = client.read();
+    if (c == '\n') {
+      line[lineLen] = '\0';
+      lineLen = 0;
+      return true;
+    }
+    if (c != '\r' && lineLen < sizeof(line) - 1) line[lineLen++] = c;
+  }
+  return false;
+}
+
+int PushChannel::finish(unsigned long now, int code) {
+  state = PUSH_IDLE;
+  isLive = code == 202 || code == 204 || code == 205;
+  if (!isLive) {
+    client.stop();
+    retryAt = now + PUSH_RETRY_MS;
+    Serial.printf("Push channel down (HTTP %d), retrying in %lus\n", code, PUSH_RETRY_MS / 1000UL);
+    return 0;
+  }
+  retryAt = now;
+  return code == 204 ? 0 : code;
+}
+
+int PushChannel::poll(unsigned long now, uint32_t configGen) {
+  if (state == PUSH_IDLE) {
+    if ((long)(now - retryAt) < 0) return 0;
+    status = 0;
+    contentLength = -1;
+    lineLen = 0;
+    sentAt = now;
+    if (!send(configGen)) return finish(now, HTTPC_ERROR_CONNECTION_FAILED);
+    state = PUSH_AWAIT_STATUS;
+    return 0;
+  }
+
+  if (now - sentAt > PUSH_TIMEOUT_MS) return finish(now, HTTPC_ERROR_READ_TIMEOUT);
+  if (!client.connected() && !client.available()) {
+    return finish(now, state == PUSH_AWAIT_STATUS ? HTTPC_ERROR_CONNECTION_LOST : status);
+  }
+
+  switch (state) {
+    case PUSH_AWAIT_STATUS:
+      // "HTTP/1.1 204 No Content"
+      if (!readLine()) return 0;
+      status = (strncmp(line, "HTTP/", 5) == 0 && strchr(line, ' ')) ? atoi(strchr(line, ' ') + 1) : 0;
+      state = PUSH_AWAIT_HEADERS;
+      // fall through
+    case PUSH_AWAIT_HEADERS:
+      while (readLine()) {
+        if (line[0] == '\0') {
+          // A 204 has no body; otherwise without a length we can't find the
+          // end of it, so don't reuse the socket
+          if (status == 204) contentLength = 0;
+          if (contentLength < 0) client.stop();
+          state = PUSH_DRAIN_BODY;
+          break;
+        }
+        if (strncasecmp(line, "Content-Length:", 15) == 0) contentLength = atol(line + 15);
+      }
+      if (state != PUSH_DRAIN_BODY) return 0;
+      // fall through
+    case PUSH_DRAIN_BODY:
+      while (contentLength > 0 && client.available()) {
+        client.read();
+        contentLength--;
+      }
+      if (contentLength > 0) return 0;
+      return finish(now, status);
+    default:
+      return 0;
+  }
+}
+
+void PushChannel::stop() {
+  client.stop();
+  state = PUSH_IDLE;
+  isLive = false;
+}
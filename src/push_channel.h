@@ -0,0 +1,57 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+#include "server_tls.h"
+
+// -- Server push channel --------------------------------------------------------
+// HTTP long-poll on its own socket: "GET /api/push?id=MAC&cfg=N" sits at the
+// server until it has something for this device, so a reinit or a config
+// save reaches it in well under a second instead of at the next heartbeat.
+// The answer is a status code with the heartbeat's meaning:
+//   205  reinit (reboot)
+//   202  config generation N is stale, reload /api/init
+//   204  nothing within the server's hold time, poll again
+// poll() only reads what has arrived, never blocks except for the TCP
+// connect when a new poll is sent (covered by the sensor FIFO, as for
+// uploads). A server without /api/push, or a dropped socket, is retried
+// after PUSH_RETRY_MS; until then the heartbeat alone carries both.
+#define PUSH_TIMEOUT_MS  (5 * 60 * 1000UL)   // longer than the server's hold
+#define PUSH_RETRY_MS    (60 * 1000UL)
+
+class PushChannel {
+  public:
+    // rootUrl like ROOT_URL; deviceId is copied into the request path
+    void begin(const char* rootUrl, const char* deviceId, ServerTls* tls);
+
+    // Advance the long-poll; issues the next one when idle. Returns the
+    // status of a finished poll that needs acting on (202 or 205), else 0.
+    int poll(unsigned long now, uint32_t configGen);
+
+    // True while polls are being answered, i.e. the server can reach us
+    // without waiting for a heartbeat
+    bool live() const { return isLive; }
+
+    void stop();   // drop the socket (e.g. before OTA or reboot)
+
+  private:
+    enum State : uint8_t { PUSH_IDLE, PUSH_AWAIT_STATUS, PUSH_AWAIT_HEADERS, PUSH_DRAIN_BODY };
+
+    bool send(uint32_t configGen);
+    bool readLine();
+    int  finish(unsigned long now, int code);
+
+    ServerTls*    tls = nullptr;
+    ServerClient client;
+    String     host;
+    uint16_t   port = 80;
+    char       path[64];       // "/api/push?id=AA:BB:CC:DD:EE:FF"
+
+    State         state = PUSH_IDLE;
+    bool          isLive = false;
+    unsigned long sentAt = 0;
+    unsigned long retryAt = 0;
+    int           status = 0;
+    long          contentLength = -1;
+    char          line[96];
+    size_t        lineLen = 0;
+};
@@ -0,0 +1,30 @@
+#include "ready_ring.h"
+
+void ReadyRing::restart() {
+  seq = head;
+  driftSign = 0;
+  driftDrains = 0;
+}
+
+void ReadyRing::begin(uint16_t count) {
+  if (!count) return;
+  int16_t lag = (int16_t)(head - (uint16_t)(seq + count));
+  int8_t sign = lag < 0 ? -1 : lag > 0 ? 1 : 0;
+  if (!sign || sign != driftSign) {
+    driftSign = sign;
+    driftDrains = sign ? 1 : 0;
+    return;
+  }
+  if (++driftDrains < READY_RESYNC_DRAINS) return;
+  seq = head - count;   // the newest counted sample is the newest edge
+  driftSign = 0;
+  driftDrains = 0;
+}
+
+RT_IRAM bool ReadyRing::take(unsigned long& ms) {
+  uint16_t q = seq++;
+  uint16_t age = head - q;   // 1 = the newest edge; a q not reached yet wraps high
+  if (age == 0 || age >= READY_RING_SIZE) return false;
+  ms = stamps[q & (READY_RING_SIZE - 1)];
+  return true;
+}
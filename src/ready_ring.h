@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+#include "realtime.h"
+
+// -- Data-ready stamp ring ----------------------------------------------------
+// The data-ready ISR's millis() for each FIFO sample, which drainFifo()
+// prefers over the sample counter. Single producer (ISR) / single consumer
+// (loop): the ISR only ever writes head and the loop only its sequence;
+// 16-bit stores are atomic on the ESP8266, so no interrupt masking is needed.
+// Sized to outlast the 1KB FIFO (~1.7s at 100Hz), so a stamp is only ever
+// overwritten once its sample is lost to an overflow anyway.
+//
+// Stamps are kept by edge number rather than popped: the loop's sequence is
+// the edge of the next sample it reads, and moves on whether or not that
+// edge's stamp was there. A stamp that lands after its sample was read on
+// the counter is skipped instead of going to the sample after it.
+//
+// Each drain also checks the edges published against the FIFO count. In
+// step they match: every counted sample's edge is in (the ISR runs within
+// µs, inside the count's I2C read), and now and then there is one more, a
+// sample clocked after the count was latched. Fewer is a stamp held up by
+// masked interrupts, more a doubled edge. A mismatch with the same sign for
+// READY_RESYNC_DRAINS drains running is no race (edges merged while
+// interrupts were off, the ISR racing a FIFO reset), and puts the sequence
+// back on the newest sample.
+#define READY_RING_SIZE      256    // power of two
+#define READY_RESYNC_DRAINS  4
+
+class ReadyRing {
+  public:
+    // In the ISR, with millis()
+    inline void edge(unsigned long ms) __attribute__((always_inline)) {
+      stamps[head & (READY_RING_SIZE - 1)] = ms;
+      head = head + 1;   // publish after the slot is written
+    }
+
+    // After a FIFO reset: the next sample is the next edge
+    void restart();
+
+    // An edge came after the last sample read
+    bool pending() const { return (int16_t)(head - seq) > 0; }
+
+    // Start of a drain of 'count' samples, right after reading the FIFO count
+    void begin(uint16_t count);
+
+    // The next sample's stamp into ms; false (ms untouched) if its edge
+    // isn't published yet or was overwritten
+    bool take(unsigned long& ms);
+
+  private:
+    volatile unsigned long stamps[READY_RING_SIZE];
+    volatile uint16_t head = 0;
+    uint16_t seq = 0;
+    int8_t   driftSign = 0;        // of the last drain's mismatch
+    uint8_t  driftDrains = 0;      // in a row with that sign
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef REALTIME_PROFILE
+    #define REALTIME_PROFILE 0
+#endif
+
+// -- Real-time profile (-DREALTIME_PROFILE=1, env nodemcuv2_realtime) ----------
+// A flash-cache miss costs tens of µs on the ESP8266, and code runs from
+// flash unless it is in IRAM. The profile puts the sample path there: the
+// data-ready ISR (always IRAM_ATTR) and its stamp ring, processSample(), the
+// detector's step() pipelines, the biquads and STA/LTA. Their data (arena,
+// filter state, coefficients, thresholds) is already in DRAM; nothing on the
+// path reads PROGMEM. IRAM is ~32KB shared with the core and SDK, so the
+// default build keeps it for them. RT_IRAM marks a function for the profile.
+#if REALTIME_PROFILE && defined(ARDUINO_ARCH_ESP8266)
+    #define RT_IRAM IRAM_ATTR
+#else
+    #define RT_IRAM
+#endif
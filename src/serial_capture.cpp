@@ -0,0 +1,93 @@
+#include "serial_capture.h"
+#include <ESP8266WiFi.h>
+
+namespace {
+
+void put16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+void put32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+uint32_t crc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  while (length--) {
+    crc ^= *data++;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+// COBS: each run of non-zero bytes is led by its length + 1 (at most 254
+// bytes a run); the zeros themselves are dropped. -> encoded length
+size_t cobsEncode(const uint8_t* in, size_t length, uint8_t* out) {
+  size_t code = 0, o = 1;
+  for (size_t i = 0; i < length; i++) {
+    if (in[i]) out[o++] = in[i];
+    if (!in[i] || o - code == 0xFF) {
+      out[code] = (uint8_t)(o - code);
+      code = o++;
+    }
+  }
+  out[code] = (uint8_t)(o - code);
+  return o;
+}
+
+}  // namespace
+
+void SerialCapture::begin(int sampleRateHz, const SntpClock* sntpClock) {
+  WiFi.macAddress(mac);
+  rateHz  = (uint16_t)sampleRateHz;
+  clock   = sntpClock;
+  seq     = 0;
+  session = (uint16_t)ESP.random();   // hardware RNG
+  count   = 0;
+  wireLength = 0;
+}
+
+void SerialCapture::add(unsigned long ms, int16_t x, int16_t y, int16_t z) {
+  if (!rateHz) return;
+  if (count == 0) firstMs = ms;
+  uint8_t* p = block + SERIAL_CAPTURE_HEADER_SIZE + count * 6;
+  put16(p, (uint16_t)x);
+  put16(p + 2, (uint16_t)y);
+  put16(p + 4, (uint16_t)z);
+  if (++count == SERIAL_CAPTURE_SAMPLES) {
+    if (wireLength) blocksDropped++;   // the FIFO never had room for it
+    seal();
+  }
+  if (wireLength) send();
+}
+
+// The full block, headed, checked and encoded into wire
+void SerialCapture::seal() {
+  memcpy(block, "SC", 2);
+  block[2] = 1;
+  block[3] = count;
+  put32(block + 4, seq++);
+  memcpy(block + 8, mac, 6);
+  put16(block + 14, rateHz);
+  put16(block + 16, session);
+  uint64_t epochUs = (clock && clock->synced()) ? (uint64_t)clock->epochUs(firstMs) : 0;
+  put32(block + 18, (uint32_t)epochUs);
+  put32(block + 22, (uint32_t)(epochUs >> 32));
+  put32(block + 26, firstMs);
+  size_t n = SERIAL_CAPTURE_HEADER_SIZE + count * 6;
+  put32(block + n, crc32(block, n));
+
+  wire[0] = 0;
+  wireLength = (uint8_t)(1 + cobsEncode(block, n + 4, wire + 1));
+  wire[wireLength++] = 0;
+  count = 0;
+}
+
+// Whole into the TX FIFO, or left for the next sample
+void SerialCapture::send() {
+  if (Serial.availableForWrite() < (int)wireLength) return;
+  Serial.write(wire, wireLength);
+  wireLength = 0;
+  blocksSent++;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Arduino.h>
+#include "sntp_clock.h"
+
+#ifndef SERIAL_CAPTURE
+    #define SERIAL_CAPTURE 0
+#endif
+#ifndef SERIAL_CAPTURE_BAUD
+    #define SERIAL_CAPTURE_BAUD 921600
+#endif
+
+// -- Binary serial capture (-DSERIAL_CAPTURE=1, env nodemcuv2_serial) ---------
+// In place of the "y,z" plotter line, every sample goes out on the serial
+// port at full rate, x, y and z, in sequence-numbered binary blocks that
+// server/tools/serial-record.js turns into stream chunks. For bench and
+// shake-table runs on a cable, where Wi-Fi and the heartbeat cadence don't
+// matter: nothing is decimated and a lost block shows as a seq gap.
+//
+// A block is COBS-encoded with a 0x00 on each side, so it carries no zero
+// byte and the log lines around it (still printed, at SERIAL_CAPTURE_BAUD)
+// fall between delimiters, where the CRC sets them apart. The encoded
+// block, delimiters included, fits the UART's 128-byte TX FIFO: it is
+// written whole or not yet, never blocking processSample() and never split
+// by a log line. A block that can't go before the next one is full is
+// dropped (a seq gap, counted in dropped()).
+//
+// Block before encoding, little-endian:
+//   0  "SC"
+//   2  uint8   version (1)
+//   3  uint8   sample count n
+//   4  uint32  seq, from 0 at begin()
+//   8  uint8   MAC[6]
+//  14  uint16  sample rate (Hz)
+//  16  uint16  session, random per begin(); a new one restarts seq
+//  18  int64   epoch us of the first sample, 0 until SNTP has synced
+//  26  uint32  millis() of the first sample
+//  30  n x int16 x, y, z   +/-2g LSB, not de-biased (as the UDP stream)
+//  30 + 6n  uint32  CRC-32 of the bytes before it
+#define SERIAL_CAPTURE_HEADER_SIZE 30
+#define SERIAL_CAPTURE_SAMPLES     15     // 124 bytes, 127 on the wire
+
+class SerialCapture {
+  public:
+    void begin(int sampleRateHz, const SntpClock* clock);
+
+    // Every sample, from processSample(); sends what is ready when the
+    // FIFO has room
+    void add(unsigned long ms, int16_t x, int16_t y, int16_t z);
+
+    uint32_t sent() const { return blocksSent; }
+    uint32_t dropped() const { return blocksDropped; }
+
+  private:
+    void seal();
+    void send();
+
+    static const size_t BLOCK_SIZE = SERIAL_CAPTURE_HEADER_SIZE + SERIAL_CAPTURE_SAMPLES * 6 + 4;
+
+    const SntpClock* clock = nullptr;
+    uint8_t  mac[6] = {};
+    uint16_t rateHz = 0;
+    uint16_t session = 0;
+    uint32_t seq = 0;
+
+    uint8_t  block[BLOCK_SIZE];    // being filled
+    uint8_t  count = 0;
+    unsigned long firstMs = 0;
+    uint8_t  wire[BLOCK_SIZE + 3]; // sealed and encoded, waiting for the FIFO
+    uint8_t  wireLength = 0;
+
+    uint32_t blocksSent = 0;
+    uint32_t blocksDropped = 0;
+};
@@ -0,0 +1,272 @@
+#include "server_link.h"
+
+void splitUrl(const char* url, String& host, uint16_t& port, String& path) {
+  String s(url);
+  int start = s.indexOf("://");
+  start = (start < 0) ? 0 : start + 3;
+  String rest = s.substring(start);
+  int slash = rest.indexOf('/');
+  path = (slash >= 0) ? rest.substring(slash) : String("/");
+  if (slash >= 0) rest = rest.substring(0, slash);
+  int colon = rest.indexOf(':');
+  if (colon >= 0) {
+    host = rest.substring(0, colon);
+    port = (uint16_t)rest.substring(colon + 1).toInt();
+  } else {
+    host = rest;
+    port = s.startsWith("https:") ? 443 : 80;
+  }
+}
+
+const char* urlPath(const char* url) {
+  const char* p = strstr(url, "://");
+  p = p ? p + 3 : url;
+  const char* slash = strchr(p, '/');
+  return slash ? slash : "/";
+}
+
+void ServerLink::begin(const char* rootUrl, ServerTls* serverTls) {
+  String path;
+  splitUrl(rootUrl, host, port, path);
+  tls = serverTls;
+  tls->configure(client);
+  http.setReuse(true);
+}
+
+bool ServerLink::ensureConnected(bool& reused) {
+  reused = client.connected();
+  if (reused) {
+    linkStats.reuses++;
+    return true;
+  }
+  if (!armed) {
+    // HTTPClient only treats an open socket as reusable after its first
+    // keep-alive response; until then let it connect on its own rather
+    // than have it tear down ours and connect twice
+    linkStats.connects++;
+    return true;
+  }
+  unsigned long t0 = millis();
+  bool ok = tls->connect(client, host.c_str(), port);
+  linkStats.connectMs += millis() - t0;
+  if (ok) {
+    client.setNoDelay(true);
+    linkStats.connects++;
+  }
+  return ok;
+}
+
+int ServerLink::request(const char* method, const String& url, const char* contentType,
+                        PieceStream* body, size_t length, String* response,
+                        JsonResponse* json, SinkResponse* sink) {
+  linkStats.requests++;
+  int code = HTTPC_ERROR_CONNECTION_FAILED;
+  collectedValue = "";
+  for (int attempt = 0; attempt < 2; attempt++) {
+    bool reused = false;
+    if (!ensureConnected(reused)) {
+      code = HTTPC_ERROR_CONNECTION_FAILED;
+      break;
+    }
+
+    // HTTPClient sees the socket already open and skips its own connect
+    // (except before armed, when the connect is its own)
+    bool ownConnect = !armed && !reused;
+    unsigned long t0 = millis();
+    http.begin(client, url);
+    if (contentType) http.addHeader("Content-Type", contentType);
+    for (int i = 0; i < headerCount; i++) http.addHeader(headerNames[i], headerValues[i]);
+    const char* keys[] = { collectName };
+    http.collectHeaders(keys, collectName ? 1 : 0);
+    if (body) {
+      body->rewind();
+      code = http.sendRequest(method, body, length);
+    } else {
+      code = http.sendRequest(method, (const uint8_t*)nullptr, 0);
+    }
+    if (code > 0 && collectName) collectedValue = http.header(collectName);
+    if (code > 0 && response) *response = http.getString();
+    if (code == HTTP_CODE_OK && json) {
+      DeserializationOption::Filter filter(json->filter);
+      if (http.getSize() >= 0) {
+        // end() drains whatever follows the closing brace, so the socket stays reusable
+        json->error = deserializeJson(json->doc, http.getStream(), filter);
+      } else {
+        // A chunked body has chunk sizes between the bytes; let HTTPClient decode it
+        json->error = deserializeJson(json->doc, http.getString(), filter);
+      }
+      // Part of the body may still be unread; don't reuse a socket in that state
+      if (json->error) client.stop();
+    }
+    if (code == HTTP_CODE_OK && sink) {
+      int size = http.getSize();
+      sink->ok = size >= 0 && sink->sink.read(http.getStream(), size);
+      // As above: a body the sink didn't finish leaves the socket mid-response
+      if (!sink->ok) client.stop();
+    }
+    if (ownConnect) tls->settle(code != HTTPC_ERROR_CONNECTION_FAILED);
+    if (code > 0) armed = true;
+    http.end();  // keeps the socket open when the server allowed keep-alive
+    linkStats.requestMs += millis() - t0;
+
+    // A reused socket the server already closed fails before any response;
+    // reconnect once and resend
+    if (code < 0 && reused) {
+      client.stop();
+      linkStats.retries++;
+      continue;
+    }
+    break;
+  }
+  headerCount = 0;
+  collectName = nullptr;
+  return code;
+}
+
+int ServerLink::get(const String& url, String* response) {
+  return request("GET", url, nullptr, nullptr, 0, response);
+}
+
+int ServerLink::getJson(const String& url, JsonDocument& doc, const JsonDocument& filter,
+                        DeserializationError* error) {
+  JsonResponse json = {doc, filter, DeserializationError::Ok};
+  int code = request("GET", url, nullptr, nullptr, 0, nullptr, &json);
+  if (error) *error = json.error;
+  return code;
+}
+
+int ServerLink::getBody(const String& url, BodySink& sink, bool* ok) {
+  SinkResponse response = {sink, false};
+  int code = request("GET", url, nullptr, nullptr, 0, nullptr, nullptr, &response);
+  if (ok) *ok = response.ok;
+  return code;
+}
+
+int ServerLink::getStatus(const char* url) {
+  linkStats.requests++;
+  const char* path = urlPath(url);
+  int code = HTTPC_ERROR_CONNECTION_FAILED;
+  for (int attempt = 0; attempt < 2; attempt++) {
+    bool reused = client.connected();
+    if (reused) {
+      linkStats.reuses++;
+    } else {
+      unsigned long t0 = millis();
+      bool ok = tls->connect(client, host.c_str(), port);
+      linkStats.connectMs += millis() - t0;
+      if (!ok) break;
+      client.setNoDelay(true);
+      linkStats.connects++;
+    }
+
+    unsigned long t0 = millis();
+    char head[96];
+    int n = snprintf(head, sizeof(head), " HTTP/1.1\r\nHost: %s:%u\r\n", host.c_str(), port);
+    size_t pathLen = strlen(path);
+    bool sent = client.write((const uint8_t*)"GET ", 4) == 4 &&
+                client.write((const uint8_t*)path, pathLen) == pathLen &&
+                client.write((const uint8_t*)head, n) == (size_t)n;
+    for (int i = 0; sent && i < headerCount; i++) {
+      client.write((const uint8_t*)headerNames[i], strlen(headerNames[i]));
+      client.write((const uint8_t*)": ", 2);
+      client.write((const uint8_t*)headerValues[i].c_str(), headerValues[i].length());
+      client.write((const uint8_t*)"\r\n", 2);
+    }
+    sent = sent && client.write((const uint8_t*)"Connection: keep-alive\r\n\r\n", 26) == 26;
+    code = sent ? readStatus() : HTTPC_ERROR_SEND_HEADER_FAILED;
+    linkStats.requestMs += millis() - t0;
+
+    if (code < 0 && reused) {
+      client.stop();
+      linkStats.retries++;
+      continue;
+    }
+    break;
+  }
+  headerCount = 0;
+  return code;
+}
+
+// Accumulate one CRLF-terminated response line; false on timeout or close
+bool ServerLink::readLine(unsigned long deadline) {
+  while ((long)(millis() - deadline) < 0) {
+    if (!client.available()) {
+      if (!client.connected()) return false;
+      yield();
+      continue;
+    }
+    char c = client.read();
+    if (c == '\n') {
+      line[lineLen] = '\0';
+      lineLen = 0;
+      return true;
+    }
+    if (c != '\r' && lineLen < sizeof(line) - 1) line[lineLen++] = c;
+  }
+  return false;
+}
+
+// Status line, headers, then drain the body so the socket can be reused
+int ServerLink::readStatus() {
+  unsigned long deadline = millis() + SERVER_LINK_TIMEOUT_MS;
+  lineLen = 0;
+  if (!readLine(deadline)) {
+    client.stop();
+    return HTTPC_ERROR_READ_TIMEOUT;
+  }
+  // "HTTP/1.1 200 OK"
+  int status = (strncmp(line, "HTTP/", 5) == 0 && strchr(line, ' ')) ? atoi(strchr(line, ' ') + 1) : 0;
+  if (status <= 0) {
+    client.stop();
+    return HTTPC_ERROR_NO_HTTP_SERVER;
+  }
+
+  long contentLength = -1;
+  bool keepAlive = true;
+  for (;;) {
+    if (!readLine(deadline)) {
+      client.stop();
+      return status;
+    }
+    if (line[0] == '\0') break;
+    if (strncasecmp(line, "Content-Length:", 15) == 0) contentLength = atol(line + 15);
+    if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line + 11, "close")) keepAlive = false;
+  }
+  // Without a length the body only ends when the server closes
+  if (contentLength < 0) keepAlive = false;
+  while (contentLength > 0 && (long)(millis() - deadline) < 0) {
+    if (client.available()) {
+      client.read();
+      contentLength--;
+    } else if (!client.connected()) {
+      break;
+    } else {
+      yield();
+    }
+  }
+  if (!keepAlive || contentLength > 0) client.stop();
+  return status;
+}
+
+int ServerLink::post(const String& url, const char* contentType, PieceStream& body, size_t length) {
+  return request("POST", url, contentType, &body, length, nullptr);
+}
+
+void ServerLink::addHeader(const char* name, const String& value) {
+  if (headerCount >= SERVER_LINK_MAX_HEADERS) return;
+  headerNames[headerCount] = name;
+  headerValues[headerCount] = value;
+  headerCount++;
+}
+
+void ServerLink::stop() {
+  client.stop();
+}
+
+void ServerLink::printStats(Print& out) const {
+  const LinkStats& s = linkStats;
+  out.printf("Link: %u requests, %u connects (%ums total, %ums avg), %u reused, %u retried, %ums in requests\n",
+             (unsigned)s.requests, (unsigned)s.connects, (unsigned)s.connectMs,
+             (unsigned)(s.connects ? s.connectMs / s.connects : 0),
+             (unsigned)s.reuses, (unsigned)s.retries, (unsigned)s.requestMs);
+}
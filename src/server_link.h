@@ -0,0 +1,118 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+#include <ESP8266HTTPClient.h>
+#include <ArduinoJson.h>
+#include "waveform_stream.h"
+#include "server_tls.h"
+
+// Split "http[s]://host[:port][/path]" into its parts (path defaults to "/",
+// port to 80, or 443 for https)
+void splitUrl(const char* url, String& host, uint16_t& port, String& path);
+
+// Pointer to the "/path?query" part of url, without copying
+const char* urlPath(const char* url);
+
+#define SERVER_LINK_TIMEOUT_MS  5000   // getStatus(): whole response, as HTTPClient's default
+#define SERVER_LINK_MAX_HEADERS 10     // addHeader() per request (an upload sends up to 10)
+
+// -- Persistent HTTP connection to the server ---------------------------------
+// One ServerClient/HTTPClient pair shared by /api/init, heartbeats and uploads
+// (heartbeats bypass HTTPClient via getStatus(), on the same socket).
+// The socket is kept alive between requests (HTTPClient::setReuse) and only
+// reconnected when the server or network has dropped it, so the 50-300ms TCP
+// handshake isn't paid on every call (nor, in a TLS build, the full TLS one;
+// see src/server_tls.h). All URLs must be on ROOT_URL's host.
+struct LinkStats {
+  uint32_t requests;    // requests attempted
+  uint32_t connects;    // fresh TCP connections opened
+  uint32_t reuses;      // requests sent on an already-open socket
+  uint32_t retries;     // reused socket turned out stale, reconnected
+  uint32_t connectMs;   // total time spent in TCP connect
+  uint32_t requestMs;   // total time spent sending + awaiting responses
+};
+
+// Consumer for ServerLink::getBody(): reads a 200's body straight off the
+// socket. 'length' is the Content-Length; a chunked body is never handed over.
+class BodySink {
+  public:
+    virtual ~BodySink() {}
+    virtual bool read(Stream& body, int length) = 0;
+};
+
+class ServerLink {
+  public:
+    // rootUrl like "http://192.168.86.48:3000/" (host and port are parsed
+    // once); tls sets up and counts the connects
+    void begin(const char* rootUrl, ServerTls* tls);
+
+    // GET url; if response is non-null the body is read into it.
+    // Returns the HTTP status, or a negative HTTPC_ERROR_* code.
+    int get(const String& url, String* response = nullptr);
+
+    // GET url and parse the body straight off the socket into doc, keeping
+    // only what filter selects, so neither a String copy of the body nor
+    // unknown fields take any RAM. *error is set on a 200 that didn't parse.
+    int getJson(const String& url, JsonDocument& doc, const JsonDocument& filter,
+                DeserializationError* error);
+
+    // GET url and hand a 200's body to sink without buffering it. Returns
+    // the HTTP status; *ok says whether the sink took the body.
+    int getBody(const String& url, BodySink& sink, bool* ok);
+
+    // GET url for its status only, written straight onto the keep-alive
+    // socket and parsed with a fixed line buffer (no HTTPClient, no String
+    // churn, so the steady-state heartbeat doesn't touch the heap). The
+    // response body is discarded.
+    int getStatus(const char* url);
+
+    // POST a streamed body of known length
+    int post(const String& url, const char* contentType, PieceStream& body, size_t length);
+
+    // Extra header for the next request only (e.g. X-Event-Seq on an upload)
+    void addHeader(const char* name, const String& value);
+
+    // Keep this response header of the next request (not getStatus()), read
+    // back with collected(); "" if the response didn't have it
+    void collectHeader(const char* name) { collectName = name; }
+    const String& collected() const { return collectedValue; }
+
+    void stop();  // drop the socket (e.g. before OTA or reboot)
+
+    const LinkStats& stats() const { return linkStats; }
+    void printStats(Print& out) const;
+
+  private:
+    struct JsonResponse {
+      JsonDocument& doc;
+      const JsonDocument& filter;
+      DeserializationError error;
+    };
+
+    struct SinkResponse {
+      BodySink& sink;
+      bool      ok;
+    };
+
+    bool ensureConnected(bool& reused);
+    int  readStatus();
+    bool readLine(unsigned long deadline);
+    int  request(const char* method, const String& url, const char* contentType,
+                 PieceStream* body, size_t length, String* response,
+                 JsonResponse* json = nullptr, SinkResponse* sink = nullptr);
+
+    ServerClient client;
+    ServerTls* tls = nullptr;
+    HTTPClient http;
+    String     host;
+    uint16_t   port = 80;
+    bool       armed = false;  // HTTPClient has seen a keep-alive response
+    const char* headerNames[SERVER_LINK_MAX_HEADERS];
+    String     headerValues[SERVER_LINK_MAX_HEADERS];
+    int        headerCount = 0;
+    const char* collectName = nullptr;
+    String     collectedValue;
+    char       line[96];       // getStatus() response line
+    size_t     lineLen = 0;
+    LinkStats  linkStats = {};
+};
@@ -0,0 +1,79 @@
+#include "server_tls.h"
+#include "server_link.h"
+#include "cpu_boost.h"
+
+#if SERVER_TLS
+
+void ServerTls::begin(const char* rootUrl, const char* pin) {
+  fingerprint = pin;
+  String host, path;
+  uint16_t port;
+  splitUrl(rootUrl, host, port, path);
+  // A ClientHello on a plain TCP connect, no handshake
+  mfln = BearSSL::WiFiClientSecure::probeMaxFragmentLength(host.c_str(), port, TLS_RX_BYTES);
+  if (mfln) Serial.printf("TLS: %s takes %u-byte fragments\n", host.c_str(), (unsigned)TLS_RX_BYTES);
+  else Serial.printf("! TLS: %s won't limit fragments, 16KB receive buffers\n", host.c_str());
+}
+
+void ServerTls::configure(ServerClient& client) {
+  client.setFingerprint(fingerprint);
+  if (mfln) client.setBufferSizes(TLS_RX_BYTES, TLS_TX_BYTES);
+  client.setSession(&session);
+}
+
+bool ServerTls::connect(ServerClient& client, const char* host, uint16_t port) {
+  CpuBoostScope boost(BOOST_TLS);
+  unsigned long t0 = millis();
+  bool ok = client.connect(host, port);
+  count(ok, millis() - t0, true);
+  return ok;
+}
+
+void ServerTls::count(bool ok, uint32_t ms, bool timed) {
+  if (!ok) {
+    tlsStats.failures++;
+    return;
+  }
+  // A full handshake leaves new session parameters behind; a resumed one
+  // the same ones it offered
+  if (memcmp(&seen, &session, sizeof(session)) == 0) {
+    tlsStats.resumed++;
+    if (timed) {
+      tlsStats.resumedMs += ms;
+      tlsStats.resumedTimed++;
+    }
+  } else {
+    tlsStats.full++;
+    if (timed) {
+      tlsStats.fullMs += ms;
+      tlsStats.fullTimed++;
+    }
+    seen = session;
+  }
+}
+
+void ServerTls::appendQuery(String& url) const {
+  url += "&tls=";
+  url += (unsigned long)tlsStats.full;      url += ',';
+  url += (unsigned long)tlsStats.resumed;   url += ',';
+  url += (unsigned long)tlsStats.failures;  url += ',';
+  url += (unsigned long)(tlsStats.fullTimed ? tlsStats.fullMs / tlsStats.fullTimed : 0);          url += ',';
+  url += (unsigned long)(tlsStats.resumedTimed ? tlsStats.resumedMs / tlsStats.resumedTimed : 0); url += ',';
+  url += mfln ? '1' : '0';
+}
+
+#else
+
+void ServerTls::begin(const char*, const char*) {}
+
+void ServerTls::configure(ServerClient&) {}
+
+bool ServerTls::connect(ServerClient& client, const char* host, uint16_t port) {
+  return client.connect(host, port);
+}
+
+void ServerTls::count(bool, uint32_t, bool) {}
+
+void ServerTls::appendQuery(String&) const {}
+
+#endif
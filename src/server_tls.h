@@ -0,0 +1,82 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+
+#ifndef SERVER_TLS
+    #define SERVER_TLS 0
+#endif
+#if SERVER_TLS
+#include <WiFiClientSecure.h>
+#endif
+
+// -- HTTPS to the server (-DSERVER_TLS=1, env nodemcuv2_tls) ------------------
+// ServerLink, AsyncUploader, PushChannel and OTA connect through a
+// ServerClient: a plain WiFiClient, or in a TLS build a BearSSL
+// WiFiClientSecure that ServerTls has set up. A full handshake costs the
+// ESP8266 1-2s of ECDHE and ~20KB of buffers, so:
+//  - every client offers the one shared BearSSL::Session, and after the first
+//    full handshake (ServerLink's /api/init) the rest resume it: no key
+//    exchange and no certificate, a round trip and a few ms of hashing
+//  - the server is probed once for max fragment length; if it takes 512,
+//    each socket needs TLS_RX_BYTES + TLS_TX_BYTES of record buffers instead
+//    of 16KB + 512
+//  - the certificate is pinned by SHA-1 fingerprint (SECRET_SERVER_FINGERPRINT)
+//    rather than chain-checked, so there is no X.509 validation or clock to set
+// Sockets are still kept alive as before; the uploader only closes its own
+// once the queue is empty, since resuming costs little and an idle TLS
+// socket holds TLS_CLIENT_HEAP.
+#define TLS_RX_BYTES      512
+#define TLS_TX_BYTES      512
+#define TLS_CLIENT_HEAP   5600    // one connected socket: BearSSL context + MFLN buffers
+#if SERVER_TLS
+    // The push channel and an upload socket open after the arena is sized
+    #define TLS_HEAP_RESERVE (2 * TLS_CLIENT_HEAP)
+    typedef BearSSL::WiFiClientSecure ServerClient;
+#else
+    #define TLS_HEAP_RESERVE 0
+    typedef WiFiClient ServerClient;
+#endif
+
+struct TlsStats {
+  uint32_t full;        // handshakes with a key exchange
+  uint32_t resumed;     // handshakes that resumed the shared session
+  uint32_t failures;    // connects that didn't complete a handshake
+  uint32_t fullMs;      // total time in the full handshakes connect() made (TCP included)
+  uint32_t resumedMs;   // total time in the resumed ones
+  uint32_t fullTimed;   // how many of each connect() made
+  uint32_t resumedTimed;
+};
+
+class ServerTls {
+  public:
+    // Once, with Wi-Fi up and before any client's begin(): keep the
+    // fingerprint and probe rootUrl's server for max fragment length
+    void begin(const char* rootUrl, const char* fingerprint);
+
+    // Trust, buffer sizes and the shared session onto a client (from its
+    // begin(); they hold across reconnects)
+    void configure(ServerClient& client);
+
+    // client.connect() timed and counted as a full or resumed handshake
+    bool connect(ServerClient& client, const char* host, uint16_t port);
+
+    // Count a connect someone else made (HTTPClient's own), untimed
+    void settle(bool ok) { count(ok, 0, false); }
+
+    bool fragmentLimited() const { return mfln; }
+    const TlsStats& stats() const { return tlsStats; }
+
+    // "&tls=full,resumed,failures,full_avg_ms,resumed_avg_ms,mfln" (TLS builds)
+    void appendQuery(String& url) const;
+
+  private:
+    void count(bool ok, uint32_t ms, bool timed);
+
+#if SERVER_TLS
+    BearSSL::Session session;
+    BearSSL::Session seen;              // as of the last handshake we counted
+#endif
+    const char* fingerprint = "";
+    bool        mfln = false;
+    TlsStats    tlsStats = {};
+};
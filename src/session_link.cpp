@@ -0,0 +1,303 @@
+#include "session_link.h"
+#include <ESP8266HTTPClient.h>
+
+#if SESSION_LINK
+
+namespace {
+
+const uint8_t FLAG_MORE = 0x01;
+const uint8_t FLAG_ACK  = 0x02;
+
+void put16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+void put32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+}  // namespace
+
+void SessionLink::begin(const char* host, uint16_t port, const char* firmwareVersion) {
+  if (strcmp(host, serverHost) == 0 && port == serverPort) return;
+  stop();
+  snprintf(serverHost, sizeof(serverHost), "%s", host);
+  snprintf(firmware, sizeof(firmware), "%s", firmwareVersion);
+  serverPort = port;
+  retryAt = millis();
+  if (enabled()) Serial.printf("Session: %s:%u\n", serverHost, (unsigned)serverPort);
+}
+
+void SessionLink::stop() {
+  fail();
+  retryAt = millis();
+}
+
+// Drop the socket; an upload in flight has failed, and HTTP takes over
+// until the retry
+void SessionLink::fail() {
+  if (isConnected) Serial.println("! Session lost, back to HTTP");
+  client.stop();
+  isConnected = false;
+  caps = 0;
+  hdrGot = 0;
+  rxGot = rxLength = 0;
+  retryAt = millis() + SESSION_RETRY_MS;
+  if (streamSeq && result == 0) {
+    result = -1;
+    failed++;
+  }
+  streamSeq = 0;
+  streamSent = streamLength = 0;
+}
+
+uint16_t SessionLink::takeSeq() {
+  uint16_t seq = nextSeq++;
+  if (!nextSeq) nextSeq = 1;   // 0 is "none" in streamSeq
+  return seq;
+}
+
+bool SessionLink::writeHeader(uint8_t type, uint8_t flags, uint16_t seq, size_t length) {
+  uint8_t header[8] = { type, flags };
+  put16(header + 2, seq);
+  put32(header + 4, length);
+  lastSent = millis();
+  return client.write(header, sizeof(header)) == sizeof(header);
+}
+
+bool SessionLink::writeFrame(uint8_t type, uint8_t flags, uint16_t seq, const uint8_t* payload,
+                             size_t length) {
+  return writeHeader(type, flags, seq, length) && (!length || client.write(payload, length) == length);
+}
+
+bool SessionLink::connect(unsigned long now) {
+  client.stop();
+  hdrGot = 0;
+  rxGot = rxLength = 0;
+  if (!client.connect(serverHost, serverPort)) return false;
+  client.setNoDelay(true);
+  lastHeard = now;
+
+  // "SSP1", version, caps, then the MAC and firmware version NUL-terminated
+  uint8_t hello[64] = { 'S', 'S', 'P', '1', SESSION_VERSION };
+  put32(hello + 5, SESSION_CAPS_ALL);
+  int n = 9 + snprintf((char*)hello + 9, sizeof(hello) - 9, "%s", WiFi.macAddress().c_str()) + 1;
+  n += snprintf((char*)hello + n, sizeof(hello) - n, "%s", firmware);
+  if (!writeFrame(SESSION_HELLO, FLAG_ACK, takeSeq(), hello, n)) return false;
+
+  unsigned long t0 = millis();
+  while (millis() - t0 < SESSION_ACK_TIMEOUT_MS && client.connected()) {
+    if (!readFrame()) {
+      delay(1);
+      continue;
+    }
+    if (hdr[0] == SESSION_ACK) {
+      // Only a refusal is ACKed
+      Serial.printf("! Session refused (%u)\n", (unsigned)(ctl[0] | ctl[1] << 8));
+      return false;
+    }
+    if (hdr[0] != SESSION_WELCOME || rxLength < 5) continue;
+    caps = ctl[1] & SESSION_CAPS_ALL;   // the low byte of the u32 after the version
+    isConnected = true;
+    connects++;
+    return true;
+  }
+  return false;
+}
+
+// Read what has arrived of the current frame; true once it is complete.
+// A config or command goes into rx unless one is already held there;
+// every frame's first bytes go into ctl.
+bool SessionLink::readFrame() {
+  while (client.available()) {
+    uint8_t c = client.read();
+    if (hdrGot < sizeof(hdr)) {
+      hdr[hdrGot++] = c;
+      if (hdrGot < sizeof(hdr)) continue;
+      rxLength = (uint32_t)hdr[4] | (uint32_t)hdr[5] << 8 | (uint32_t)hdr[6] << 16 | (uint32_t)hdr[7] << 24;
+      rxGot = 0;
+      rxKeep = (hdr[0] == SESSION_CONFIG || hdr[0] == SESSION_COMMAND) && held == SESSION_NOTHING &&
+               rxLength < SESSION_RX_SIZE;
+      if (rxLength > 0) continue;
+      hdrGot = 0;
+      lastHeard = millis();
+      return true;
+    }
+    if (rxKeep) rx[rxGot] = c;
+    if (rxGot < sizeof(ctl)) ctl[rxGot] = c;
+    if (++rxGot == rxLength) {
+      hdrGot = 0;
+      lastHeard = millis();
+      return true;
+    }
+  }
+  return false;
+}
+
+void SessionLink::dispatch() {
+  uint8_t type = hdr[0];
+  uint16_t seq = (uint16_t)hdr[2] | (uint16_t)hdr[3] << 8;
+  if (type == SESSION_ACK) {
+    ackedSeq = seq;
+    ackedStatus = rxLength >= 2 ? (uint16_t)ctl[0] | (uint16_t)ctl[1] << 8 : 0;
+    if (streamSeq && ackedSeq == streamSeq && !streaming()) {
+      result = ackedStatus ? ackedStatus : -1;
+      acked++;
+      streamSeq = 0;
+    }
+    return;
+  }
+  uint8_t ack[4] = {};
+  put16(ack, 200);
+  if (type == SESSION_CONFIG || type == SESSION_COMMAND) {
+    if (!rxKeep) {
+      // A stale generation shows on the next heartbeat's ACK, a command
+      // comes again on it
+      Serial.printf("! Session: %lu-byte message dropped\n", (unsigned long)rxLength);
+      dropped++;
+      put16(ack, 503);
+    } else {
+      rx[rxLength] = '\0';
+      held = type == SESSION_CONFIG ? SESSION_IN_CONFIG : SESSION_IN_COMMAND;
+    }
+  } else if (type != SESSION_PING) {
+    return;
+  }
+  if (hdr[1] & FLAG_ACK) writeFrame(SESSION_ACK, 0, seq, ack, sizeof(ack));
+}
+
+void SessionLink::poll(unsigned long now) {
+  if (!enabled()) return;
+  if (!isConnected) {
+    if ((long)(now - retryAt) < 0) return;
+    if (!connect(now)) {
+      client.stop();
+      retryAt = now + SESSION_RETRY_MS;
+      Serial.printf("! Session: none with %s:%u, retrying in %lus\n", serverHost,
+                    (unsigned)serverPort, SESSION_RETRY_MS / 1000UL);
+      return;
+    }
+    Serial.printf("Session: connected to %s:%u (caps 0x%02x)\n", serverHost, (unsigned)serverPort,
+                  (unsigned)caps);
+  }
+  if (!client.connected()) return fail();
+
+  if (streaming()) {
+    // One frame per poll, as much of the rest as fits the socket
+    size_t room = client.availableForWrite();
+    size_t left = streamLength - streamSent;
+    size_t n = min(min(room > 8 ? room - 8 : 0, (size_t)SESSION_CHUNK), left);
+    if (n > 0) {
+      uint8_t flags = FLAG_ACK | (n < left ? FLAG_MORE : 0);
+      if (!writeHeader(SESSION_EVENT, flags, streamSeq, n)) return fail();
+      size_t end = streamSent + n;
+      if (streamSent < streamHeadLength) {
+        size_t h = min(end, streamHeadLength) - streamSent;
+        if (client.write(streamHead + streamSent, h) != h) return fail();
+        streamSent += h;
+      }
+      if (end > streamSent) {
+        size_t b = end - streamSent;
+        if (client.write(streamBody + (streamSent - streamHeadLength), b) != b) return fail();
+        streamSent += b;
+      }
+      if (!streaming()) streamDoneAt = now;
+    }
+  } else if (streamSeq && result == 0 && now - streamDoneAt > SESSION_ACK_TIMEOUT_MS) {
+    Serial.println("! Session: upload not acked");
+    return fail();
+  }
+
+  if (!streaming() && now - lastSent >= SESSION_KEEPALIVE_S * 500UL) {
+    writeFrame(SESSION_PING, FLAG_ACK, takeSeq(), nullptr, 0);
+  }
+  if (now - lastHeard > SESSION_KEEPALIVE_S * 1500UL) {
+    Serial.println("! Session: server silent past the keepalive");
+    return fail();
+  }
+
+  while (readFrame()) dispatch();
+}
+
+int SessionLink::heartbeat(const char* query, size_t length) {
+  if (!writable() || !(caps & SESSION_CAP_HEARTBEAT)) return HTTPC_ERROR_CONNECTION_LOST;
+  uint16_t seq = takeSeq();
+  if (!writeFrame(SESSION_HEARTBEAT, FLAG_ACK, seq, (const uint8_t*)query, length)) {
+    fail();
+    return HTTPC_ERROR_CONNECTION_LOST;
+  }
+  sent++;
+  unsigned long t0 = millis();
+  while (millis() - t0 < SESSION_ACK_TIMEOUT_MS && client.connected()) {
+    if (!readFrame()) {
+      delay(1);
+      continue;
+    }
+    dispatch();
+    if (hdr[0] == SESSION_ACK && ackedSeq == seq) {
+      acked++;
+      return ackedStatus;
+    }
+  }
+  Serial.println("! Session: heartbeat not acked");
+  failed++;
+  fail();
+  return HTTPC_ERROR_CONNECTION_LOST;
+}
+
+bool SessionLink::publish(const char* leaf, const uint8_t* payload, size_t length) {
+  if (!writable() || !(caps & SESSION_CAP_TRIGGER) || strcmp(leaf, "trigger") != 0) return false;
+  if (!writeFrame(SESSION_TRIGGER, 0, takeSeq(), payload, length)) {
+    fail();
+    return false;
+  }
+  sent++;
+  return true;
+}
+
+bool SessionLink::startPublish(const char* leaf, const uint8_t* head, size_t headLength,
+                               const uint8_t* body, size_t bodyLength) {
+  if (!writable() || !(caps & SESSION_CAP_EVENT) || strcmp(leaf, "event") != 0 ||
+      (streamSeq && result == 0)) {
+    return false;
+  }
+  sent++;
+  streamHead = head;
+  streamBody = body;
+  streamHeadLength = headLength;
+  streamLength = headLength + bodyLength;
+  streamSent = 0;
+  streamSeq = takeSeq();
+  result = 0;
+  return true;
+}
+
+void SessionLink::appendQuery(String& url) const {
+  if (!enabled()) return;
+  url += "&session=";
+  url += isConnected ? '1' : '0';     url += ',';
+  url += (unsigned long)connects;   url += ',';
+  url += (unsigned long)sent;       url += ',';
+  url += (unsigned long)acked;      url += ',';
+  url += (unsigned long)failed;     url += ',';
+  url += (unsigned long)dropped;
+}
+
+#else
+
+void SessionLink::begin(const char*, uint16_t, const char*) {}
+
+void SessionLink::stop() {}
+
+void SessionLink::poll(unsigned long) {}
+
+int SessionLink::heartbeat(const char*, size_t) { return HTTPC_ERROR_CONNECTION_LOST; }
+
+bool SessionLink::publish(const char*, const uint8_t*, size_t) { return false; }
+
+bool SessionLink::startPublish(const char*, const uint8_t*, size_t, const uint8_t*, size_t) { return false; }
+
+void SessionLink::appendQuery(String&) const {}
+
+#endif
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+#include "message_link.h"
+
+#ifndef SESSION_LINK
+    #define SESSION_LINK 0
+#endif
+
+// -- Device session (-DSESSION_LINK=1, env nodemcuv2_session) -----------------
+// With /api/init naming a session port ("session": {"port"}) the node keeps
+// one TCP connection to the server's host there and sends over it, as
+// framed messages, what otherwise takes a request each: the heartbeat, the
+// trigger notice and the upload; the server sends config changes and
+// commands back the moment they're saved, in place of the push long-poll.
+// Frames are an 8-byte little-endian header, then the payload:
+//   0  uint8   type (SESSION_* below)
+//   1  uint8   flags: 1 more frames of this message follow, 2 ack wanted
+//   2  uint16  seq, per sender
+//   4  uint32  payload length
+// The session opens with HELLO ("SSP1", version, the caps the node will use
+// it for, MAC and firmware version) and the server's WELCOME (the caps it
+// takes of those). A heartbeat frame is ACKed with the status the GET would
+// have got, an upload with the POST's; an upload goes out as frames of at
+// most SESSION_CHUNK, one per poll(). server/lib/session.js has the rest.
+//
+// Whatever can't go right now (the socket is mid-upload or down) goes over
+// HTTP or UDP as before. A lost session is retried every SESSION_RETRY_MS.
+#define SESSION_VERSION         1
+#define SESSION_KEEPALIVE_S     60
+#define SESSION_RETRY_MS        (60 * 1000UL)
+#define SESSION_ACK_TIMEOUT_MS  5000      // WELCOME, or an ACK
+#define SESSION_CHUNK           528       // upload bytes per frame (one MSS with its header)
+#define SESSION_RX_SIZE         1024      // largest config or command taken in
+#if SESSION_LINK
+    // The session socket opens after the arena is sized
+    #define SESSION_HEAP_RESERVE 2048
+#else
+    #define SESSION_HEAP_RESERVE 0
+#endif
+
+enum SessionFrame : uint8_t {
+  SESSION_HELLO = 1, SESSION_WELCOME, SESSION_HEARTBEAT, SESSION_TRIGGER, SESSION_EVENT,
+  SESSION_CONFIG, SESSION_COMMAND, SESSION_ACK, SESSION_PING,
+};
+
+// Caps: what the session carries
+#define SESSION_CAP_HEARTBEAT 0x01
+#define SESSION_CAP_TRIGGER   0x02
+#define SESSION_CAP_EVENT     0x04
+#define SESSION_CAP_CONFIG    0x08
+#define SESSION_CAP_COMMAND   0x10
+#define SESSION_CAPS_ALL      0x1F
+
+enum SessionInbound : uint8_t { SESSION_NOTHING, SESSION_IN_CONFIG, SESSION_IN_COMMAND };
+
+class SessionLink : public MessageLink {
+  public:
+    // The server's host and session port, or port 0 to stop using one; the
+    // same again keeps the connection. Both strings are copied.
+    void begin(const char* host, uint16_t port, const char* firmwareVersion);
+    void stop();
+
+    bool enabled() const { return serverPort != 0; }
+    bool connected() const override { return isConnected; }
+    bool writable() const override { return isConnected && !streaming(); }
+    // Connected, and the server took cap in its WELCOME
+    bool carries(uint8_t cap) const { return isConnected && (caps & cap); }
+
+    // Connect when due (blocking for the TCP connect and WELCOME), keep
+    // alive, write the next frame of the upload in flight and take in what
+    // the server sent
+    void poll(unsigned long now);
+
+    // A config or command that arrived, NUL-terminated in text(), held until
+    // consume(); one arriving meanwhile is ACKed 503 and dropped
+    SessionInbound pending() const { return held; }
+    const char* text() const { return (const char*)rx; }
+    void consume() { held = SESSION_NOTHING; }
+
+    // The heartbeat query, waiting for its ACK: the status the GET would
+    // have got, or HTTPC_ERROR_CONNECTION_LOST (the session is dropped)
+    int heartbeat(const char* query, size_t length);
+
+    // "trigger": one TRIGGER frame
+    bool publish(const char* leaf, const uint8_t* payload, size_t length) override;
+    // "event": EVENT frames from poll(); publishResult() is the ACK's status,
+    // -1 if the session was lost or no ACK came within SESSION_ACK_TIMEOUT_MS
+    // of the last frame
+    bool startPublish(const char* leaf, const uint8_t* head, size_t headLength,
+                      const uint8_t* body, size_t bodyLength) override;
+    int  publishResult() const override { return result; }
+
+    // "&session=connected,connects,sent,acked,failed,dropped": the session
+    // now, and counts since boot (session builds with a port)
+    void appendQuery(String& url) const;
+
+  private:
+    bool connect(unsigned long now);
+    bool streaming() const { return streamSent < streamLength; }
+    bool writeHeader(uint8_t type, uint8_t flags, uint16_t seq, size_t length);
+    bool writeFrame(uint8_t type, uint8_t flags, uint16_t seq, const uint8_t* payload, size_t length);
+    uint16_t takeSeq();
+    bool readFrame();
+    void dispatch();
+    void fail();
+
+#if SESSION_LINK
+    WiFiClient client;
+    uint8_t    rx[SESSION_RX_SIZE];
+#else
+    uint8_t    rx[1];
+#endif
+    char       serverHost[64] = "";
+    uint16_t   serverPort = 0;
+    char       firmware[16] = "";
+    uint8_t    caps = 0;
+
+    bool          isConnected = false;
+    unsigned long retryAt = 0;
+    unsigned long lastSent = 0;      // for the keepalive
+    unsigned long lastHeard = 0;
+    uint16_t      nextSeq = 1;
+
+    // The frame being read: its header, then payload bytes so far
+    uint8_t  hdr[8];
+    uint8_t  hdrGot = 0;
+    uint32_t rxLength = 0;
+    uint32_t rxGot = 0;
+    bool     rxKeep = false;         // stored in rx, else only its first bytes
+    uint8_t  ctl[16];                // those first bytes (ACK, WELCOME)
+
+    SessionInbound held = SESSION_NOTHING;
+    uint16_t       ackedSeq = 0;     // last ACK read, and its status
+    uint16_t       ackedStatus = 0;
+
+    // The upload streamed from poll()
+    const uint8_t* streamHead = nullptr;
+    const uint8_t* streamBody = nullptr;
+    size_t         streamHeadLength = 0;
+    size_t         streamLength = 0;   // head + body
+    size_t         streamSent = 0;
+    uint16_t       streamSeq = 0;
+    unsigned long  streamDoneAt = 0;
+    int            result = 0;
+
+    uint32_t connects = 0;
+    uint32_t sent = 0;
+    uint32_t acked = 0;
+    uint32_t failed = 0;
+    uint32_t dropped = 0;            // inbound messages dropped
+};
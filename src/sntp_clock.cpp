@@ -0,0 +1,42 @@
+#include "sntp_clock.h"
+#include <coredecls.h>   // settimeofday_cb
+#include <sys/time.h>
+#include <time.h>
+
+SntpClock* SntpClock::instance = nullptr;
+
+// Weak hook in the ESP8266 core's SNTP client: poll interval after the first sync
+uint32_t sntp_update_delay_MS_rfc_not_less_than_15000() {
+  return SNTP_RESYNC_MS;
+}
+
+void SntpClock::begin(const char* host) {
+  snprintf(server, sizeof(server), "%s", host);
+  instance = this;
+  settimeofday_cb(onTimeSet);
+  configTime(0, 0, server);
+  Serial.printf("SNTP: polling %s every %lus\n", server, SNTP_RESYNC_MS / 1000UL);
+}
+
+int64_t SntpClock::nowUs() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+void SntpClock::onTimeSet(bool fromSntp) {
+  if (!fromSntp || !instance) return;
+  SntpClock& c = *instance;
+  int64_t offset = nowUs() - (int64_t)micros64();
+  // How far the clock had drifted from the server since the previous sync
+  c.stepUs = c.syncs ? offset - c.offsetUs : 0;
+  c.offsetUs = offset;
+  c.syncedAt = millis();
+  c.syncs++;
+  Serial.printf("SNTP: sync #%lu, step %lldus\n", (unsigned long)c.syncs, (long long)c.stepUs);
+}
+
+int64_t SntpClock::epochUs(unsigned long ms) const {
+  if (!synced()) return 0;
+  return nowUs() - (int64_t)(unsigned long)(millis() - ms) * 1000LL;
+}
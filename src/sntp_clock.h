@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- SNTP wall clock ----------------------------------------------------------
+// Disciplines the ESP8266 system clock with the core's SNTP client, so every
+// node tags events with the same absolute time and arrival times can be
+// compared across nodes (the server's receive time jitters by tens to
+// hundreds of ms with WiFi and HTTP latency). The core re-polls every
+// SNTP_RESYNC_MS; each sync logs how far the local clock was corrected.
+//
+// Sample timestamps stay on millis(); epochUs() maps one to wall-clock time,
+// so resolution is the sample clock's (1ms), not the radio's.
+#define SNTP_DEFAULT_SERVER "pool.ntp.org"   // /api/init "ntp_server" overrides it
+#define SNTP_RESYNC_MS   (15 * 60 * 1000UL)
+#define SNTP_SERVER_SIZE 64
+
+class SntpClock {
+  public:
+    // Start polling 'server' (UTC); returns immediately, syncs in the background
+    void begin(const char* server);
+
+    bool synced() const { return syncs > 0; }
+
+    // Epoch microseconds of the millis() timestamp ms (in the past); 0 until synced
+    int64_t epochUs(unsigned long ms) const;
+
+    uint32_t      syncCount() const { return syncs; }
+    unsigned long lastSyncMs() const { return syncedAt; }
+    int64_t       lastStepUs() const { return stepUs; }   // correction at the latest sync
+
+  private:
+    static void onTimeSet(bool fromSntp);
+    static int64_t nowUs();
+    static SntpClock* instance;     // the core's callback takes no context
+
+    char          server[SNTP_SERVER_SIZE] = "";   // the core keeps a pointer to it
+    uint32_t      syncs = 0;
+    unsigned long syncedAt = 0;
+    int64_t       stepUs = 0;
+    int64_t       offsetUs = 0;     // epoch minus micros64() as of the latest sync
+};
@@ -0,0 +1,63 @@
+#include "spectrum.h"
+
+const uint8_t SPECTRUM_HZ[SPECTRUM_BINS] = { 1, 2, 3, 5, 8, 12, 20, 30 };
+
+void GoertzelBank::begin(int sampleRateHz) {
+  blockLen = max(1, sampleRateHz);
+  bins = 0;
+  for (int b = 0; b < SPECTRUM_BINS; b++) {
+    if (SPECTRUM_HZ[b] * 2 >= sampleRateHz) break;
+    coeff[b] = (int32_t)lround(2.0 * cos(2.0 * M_PI * SPECTRUM_HZ[b] / sampleRateHz) * 16384.0);
+    bins = b + 1;
+  }
+  reset();
+}
+
+void GoertzelBank::reset() {
+  memset(s1, 0, sizeof(s1));
+  memset(s2, 0, sizeof(s2));
+  memset(sumAmp2, 0, sizeof(sumAmp2));
+  inBlock = blocks = 0;
+}
+
+void GoertzelBank::add(int32_t dx, int32_t dy, int32_t dz) {
+  int32_t v[3] = { dx, dy, dz };
+  for (int b = 0; b < bins; b++) {
+    for (int i = 0; i < 3; i++) {
+      int64_t s = v[i] + ((coeff[b] * s1[b][i]) >> 14) - s2[b][i];
+      s2[b][i] = s1[b][i];
+      s1[b][i] = s;
+    }
+  }
+  if (++inBlock >= blockLen) closeBlock();
+}
+
+void GoertzelBank::closeBlock() {
+  // |X|^2 = s1^2 + s2^2 - coeff*s1*s2; a sinusoid of amplitude A gives A*N/2
+  float n2 = (float)inBlock * inBlock;
+  for (int b = 0; b < bins; b++) {
+    for (int i = 0; i < 3; i++) {
+      float a = (float)s1[b][i], c = (float)s2[b][i];
+      float power = a * a + c * c - (coeff[b] / 16384.0f) * a * c;
+      sumAmp2[b] += 4.0f * max(0.0f, power) / n2;
+      s1[b][i] = s2[b][i] = 0;
+    }
+  }
+  blocks++;
+  inBlock = 0;
+}
+
+bool GoertzelBank::summarize(SpectrumSummary& out, float scale) {
+  // Half a block still resolves the bins well enough; less is left out
+  // unless it's all there is
+  if (inBlock * 2 >= blockLen || (blocks == 0 && inBlock > 0)) closeBlock();
+  if (blocks == 0 || bins == 0) return false;
+  out.bins = bins;
+  out.dominant = 0;
+  for (int b = 0; b < bins; b++) {
+    out.hz[b] = SPECTRUM_HZ[b];
+    out.ampG[b] = sqrtf(sumAmp2[b] / blocks) / scale;
+    if (out.ampG[b] > out.ampG[out.dominant]) out.dominant = b;
+  }
+  return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Capture spectrum ---------------------------------------------------------
+// A small Goertzel bank run over a capture's post-trigger samples, so the
+// server can tell footsteps, HVAC hum or a slammed door from ground motion
+// without fetching and transforming every waveform. Each bin is one cycle-
+// exact Goertzel resonator per axis over 1 s blocks (block = sampleRateHz
+// samples, so every bin frequency lands on an integer DFT index and the DC
+// bias leaks into none of them). Per sample that is one Q14 multiply-add per
+// bin and axis in int64; the block's power is read out once a second. Nothing
+// is left to do when the capture finishes but a sqrt per bin.
+//
+// Bins above Nyquist are dropped. The amplitude per bin is the RMS over blocks
+// of the peak sinusoid amplitude, summed in quadrature across x/y/z.
+#define SPECTRUM_BINS 8
+
+// Bin centres, Hz: footsteps and sway low, doors mid, fans and pumps high
+extern const uint8_t SPECTRUM_HZ[SPECTRUM_BINS];
+
+struct SpectrumSummary {
+  uint8_t bins;               // valid entries, lowest first
+  uint8_t dominant;           // index of the strongest bin
+  uint8_t hz[SPECTRUM_BINS];
+  float   ampG[SPECTRUM_BINS];
+};
+
+class GoertzelBank {
+  public:
+    void begin(int sampleRateHz);
+
+    // Start a new capture
+    void reset();
+
+    // Feed one de-biased raw sample (LSB)
+    void add(int32_t dx, int32_t dy, int32_t dz);
+
+    // Fold in any usable partial block and fill out (amplitudes in g at
+    // 'scale' LSB per g). False if there wasn't enough data.
+    bool summarize(SpectrumSummary& out, float scale);
+
+  private:
+    void closeBlock();
+
+    int      blockLen = 0;
+    int      bins = 0;
+    int32_t  coeff[SPECTRUM_BINS] = {};        // Q14 2cos(2*pi*f/fs)
+    int64_t  s1[SPECTRUM_BINS][3] = {};
+    int64_t  s2[SPECTRUM_BINS][3] = {};
+    int      inBlock = 0;
+    int      blocks = 0;
+    float    sumAmp2[SPECTRUM_BINS] = {};      // LSB^2, summed over blocks and axes
+};
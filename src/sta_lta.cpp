@@ -0,0 +1,59 @@
+#include "sta_lta.h"
+#include "realtime.h"
+
+namespace {
+
+uint32_t alphaFor(int sampleRateHz, unsigned long windowMs) {
+  uint32_t samples = max(1UL, windowMs * (unsigned long)sampleRateHz / 1000UL);
+  return max(1UL, 65536UL / samples);
+}
+
+}  // namespace
+
+void StaLtaDetector::begin(int sampleRateHz, unsigned long staMs, unsigned long ltaMs,
+                           float onRatio, float offRatio) {
+  staAlpha = alphaFor(sampleRateHz, staMs);
+  ltaAlpha = alphaFor(sampleRateHz, ltaMs);
+  onX100   = lroundf(onRatio  * 100);
+  offX100  = lroundf(offRatio * 100);
+  warmup   = ltaMs * (unsigned long)sampleRateHz / 1000UL;
+  sta = lta = 0;
+  seen = 0;
+  active = false;
+}
+
+RT_IRAM bool StaLtaDetector::update(int32_t dx, int32_t dy, int32_t dz) {
+  int64_t energy = (int64_t)dx * dx + (int64_t)dy * dy + (int64_t)dz * dz;
+  if (energy > STA_LTA_ENERGY_MAX) energy = STA_LTA_ENERGY_MAX;
+  int64_t e = energy << 16;
+
+  if (warmup > 0) {
+    // Running mean until the window has filled, so the averages start at the
+    // background level instead of creeping up from zero
+    seen++;
+    uint32_t mean = 65536UL / seen;
+    sta += ((e - sta) * max(staAlpha, mean)) >> 16;
+    lta += ((e - lta) * max(ltaAlpha, mean)) >> 16;
+    warmup--;
+    return false;
+  }
+
+  sta += ((e - sta) * staAlpha) >> 16;
+  if (!active) lta += ((e - lta) * ltaAlpha) >> 16;
+
+  // Compare sta/lta against the ratio without dividing: sta*100 >= lta*on
+  if (!active) {
+    if (lta > 0 && sta * 100 >= lta * onX100) {
+      active = true;
+      return true;
+    }
+  } else if (sta * 100 < lta * offX100) {
+    active = false;
+  }
+  return false;
+}
+
+int32_t StaLtaDetector::ratioX100() const {
+  if (lta <= 0) return 0;
+  return (int32_t)min((int64_t)INT32_MAX, sta * 100 / lta);
+}
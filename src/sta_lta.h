@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- STA/LTA trigger ----------------------------------------------------------
+// Classic short-term / long-term average detector on the sample energy
+// dx^2 + dy^2 + dz^2 (de-biased LSB). Both averages are recursive
+// (exponential, time constant = window length), so each update is O(1) with
+// no sample history: a multiply and shift per window in 64-bit fixed point.
+//
+// Triggers when STA >= on_ratio * LTA and re-arms once STA < off_ratio * LTA.
+// The LTA is held while triggered so the event doesn't raise its own
+// background, and nothing fires until one LTA window has passed after begin().
+#define STA_LTA_ENERGY_MAX (1L << 30)  // energy is clamped here to keep the math in int64
+
+class StaLtaDetector {
+  public:
+    void begin(int sampleRateHz, unsigned long staMs, unsigned long ltaMs,
+               float onRatio, float offRatio);
+
+    // Feed one de-biased sample. True only on the sample that triggers.
+    bool update(int32_t dx, int32_t dy, int32_t dz);
+
+    bool triggered() const { return active; }
+
+    // STA/LTA x100 of the latest sample, for logging and the event payload
+    int32_t ratioX100() const;
+
+  private:
+    int64_t  sta = 0;           // Q16 averages of the energy
+    int64_t  lta = 0;
+    uint32_t staAlpha = 0;      // Q16 smoothing factors, 65536 / window samples
+    uint32_t ltaAlpha = 0;
+    int32_t  onX100 = 0;
+    int32_t  offX100 = 0;
+    uint32_t warmup = 0;        // samples left before the LTA is trusted
+    uint32_t seen = 0;          // samples averaged during warmup
+    bool     active = false;
+};
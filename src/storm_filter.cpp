@@ -0,0 +1,58 @@
+#include "storm_filter.h"
+
+namespace {
+
+const unsigned long MINUTE_MS = 60000UL;
+
+uint16_t toMg(float g) {
+  return (uint16_t)constrain(lroundf(g * 1000.0f), 0L, 65535L);
+}
+
+}  // namespace
+
+void StormFilter::fold(unsigned long at, float peakG, const SpectrumSummary* spectrum) {
+  foldedCount++;
+  unsigned long minute = at - at % MINUTE_MS;
+  StormMinute* m = filled ? &ring[(head - 1 + STORM_MINUTES) % STORM_MINUTES] : nullptr;
+  if (!m || m->startMs != minute) {
+    if (filled == STORM_MINUTES) {
+      filled--;
+      droppedMinutes++;
+    }
+    m = &ring[head];
+    *m = {};
+    m->startMs = minute;
+    head = (head + 1) % STORM_MINUTES;
+    filled++;
+  }
+  if (m->count < UINT16_MAX) m->count++;
+  m->peakMg = max(m->peakMg, toMg(peakG));
+  if (spectrum) {
+    m->bins = max(m->bins, spectrum->bins);
+    for (int b = 0; b < spectrum->bins; b++) m->binMg[b] = max(m->binMg[b], toMg(spectrum->ampG[b]));
+  }
+}
+
+int StormFilter::appendQuery(String& url, unsigned long now) const {
+  if (!filled) return 0;
+  url += "&storm=";
+  int first = (head - filled + STORM_MINUTES) % STORM_MINUTES;
+  for (int k = 0; k < filled; k++) {
+    const StormMinute& m = ring[(first + k) % STORM_MINUTES];
+    if (k) url += ';';
+    url += (now - m.startMs) / 1000UL;
+    url += ',';
+    url += m.count;
+    url += ',';
+    url += m.peakMg;
+    for (int b = 0; b < m.bins; b++) {
+      url += ',';
+      url += m.binMg[b];
+    }
+  }
+  return filled;
+}
+
+void StormFilter::consume(int minutes) {
+  filled -= constrain(minutes, 0, filled);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include "spectrum.h"
+
+// -- Storm suppression --------------------------------------------------------
+// In a noisy room minor triggers can come dozens a minute, and each one costs
+// a full capture upload. Once a minor capture has gone up, further minor ones
+// in the next cooldown are folded into a per-minute summary instead: count,
+// peak and the highest amplitude per spectrum bin. The heartbeat carries the
+// summaries, and a failed heartbeat keeps them for the next one. Moderate and
+// severe captures always upload in full, and so does a folded one that grew
+// past minor before it closed.
+//
+// Wire format (query "storm"), oldest minute first, ';' between minutes:
+//   age_s,count,peak_mg[,bin_mg ...]
+// age_s is how long before the request the minute started; the bins follow
+// SPECTRUM_HZ and are only there if a folded capture had a spectrum.
+#define STORM_MINUTES 5   // pending summaries; beyond that the oldest is dropped
+
+struct StormMinute {
+  unsigned long startMs;
+  uint16_t      count;
+  uint16_t      peakMg;
+  uint8_t       bins;                    // valid binMg entries
+  uint16_t      binMg[SPECTRUM_BINS];
+};
+
+class StormFilter {
+  public:
+    void begin(unsigned long cooldownMs) { cooldown = cooldownMs; }
+    bool enabled() const { return cooldown > 0; }
+
+    // Would a minor capture triggering at 'now' be folded
+    bool cooling(unsigned long now) const {
+      return cooldown && armed && now - lastUpload < cooldown;
+    }
+    // A minor capture triggering at 'at' went up in full: the cooldown starts over
+    void uploaded(unsigned long at) {
+      lastUpload = at;
+      armed = true;
+    }
+    void fold(unsigned long at, float peakG, const SpectrumSummary* spectrum);
+
+    // Appended minutes; consume() them once the heartbeat got through
+    int  appendQuery(String& url, unsigned long now) const;
+    void consume(int minutes);
+
+    uint32_t folded() const { return foldedCount; }
+    uint32_t dropped() const { return droppedMinutes; }
+
+  private:
+    unsigned long cooldown = 0;
+    unsigned long lastUpload = 0;
+    bool          armed = false;
+    StormMinute   ring[STORM_MINUTES] = {};
+    int           head = 0;              // next slot to open
+    int           filled = 0;
+    uint32_t      foldedCount = 0;
+    uint32_t      droppedMinutes = 0;
+};
@@ -0,0 +1,73 @@
+#include "task_scheduler.h"
+
+int TaskScheduler::add(const char* name, TaskFn fn, unsigned long periodMs, uint32_t budgetUs) {
+  if (count >= SCHED_MAX_TASKS) return -1;
+  tasks[count] = { name, fn, periodMs, budgetUs, millis(), 0, 0, 0, 0 };
+  return count++;
+}
+
+void TaskScheduler::setPeriod(int id, unsigned long periodMs) {
+  if (id >= 0 && id < count) tasks[id].periodMs = periodMs;
+}
+
+bool TaskScheduler::due(const Task& t, unsigned long now) const {
+  return t.periodMs == 0 || (long)(now - t.dueMs) >= 0;
+}
+
+void TaskScheduler::runTask(Task& t, unsigned long now) {
+  if (t.periodMs) {
+    if (now - t.dueMs > t.periodMs) t.late++;
+    // Stay on the period grid unless we fell a whole period behind
+    t.dueMs = now - t.dueMs > t.periodMs ? now + t.periodMs : t.dueMs + t.periodMs;
+  }
+  uint32_t startUs = micros();
+  t.fn(now);
+  uint32_t us = micros() - startUs;
+  t.runs++;
+  if (us > t.maxUs) t.maxUs = us;
+  if (t.budgetUs && us > t.budgetUs) t.overruns++;
+}
+
+void TaskScheduler::run(unsigned long now) {
+  if (count == 0) return;
+  Task& acquire = tasks[0];
+  if (due(acquire, now)) runTask(acquire, now);
+  for (int i = 1; i < count; i++) {
+    if (!due(tasks[i], now)) continue;
+    runTask(tasks[i], now);
+    now = millis();
+    if (due(acquire, now)) runTask(acquire, now);
+  }
+}
+
+unsigned long TaskScheduler::untilDue(unsigned long now, unsigned long limitMs) const {
+  unsigned long until = limitMs;
+  for (int i = 1; i < count; i++) {
+    const Task& t = tasks[i];
+    if (t.periodMs == 0) continue;
+    long left = (long)(t.dueMs - now);
+    if (left <= 0) return 0;
+    if ((unsigned long)left < until) until = left;
+  }
+  return until;
+}
+
+void TaskScheduler::appendQuery(String& url) const {
+  for (int i = 0; i < count; i++) {
+    const Task& t = tasks[i];
+    if (t.runs == 0) continue;
+    url += "&task_";
+    url += t.name;
+    url += '=';
+    url += (unsigned long)t.runs;     url += ',';
+    url += (unsigned long)t.late;     url += ',';
+    url += (unsigned long)t.overruns; url += ',';
+    url += (unsigned long)t.maxUs;
+  }
+}
+
+void TaskScheduler::resetStats() {
+  for (int i = 0; i < count; i++) {
+    tasks[i].runs = tasks[i].late = tasks[i].overruns = tasks[i].maxUs = 0;
+  }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Cooperative task scheduler -----------------------------------------------
+// loop() is one run() pass over a small fixed table of tasks, each a plain
+// function with a period (0 = every pass) and a time budget. Task 0 is
+// acquisition: it runs first and again after every other task that ran, so a
+// slow heartbeat or upload step delays the FIFO/DRDY drain by one task at
+// most, never the whole pass. Nothing is preempted - a task that blocks
+// (an HTTP round trip, the OTA download) still blocks - but each one's cost
+// is now visible:
+//   runs      times it ran
+//   late      started more than one period past its deadline
+//   overruns  took longer than its budget (budget 0 = unbudgeted)
+//   max_us    longest run
+// per heartbeat window, as "&task_<name>=runs,late,overruns,max_us".
+#define SCHED_MAX_TASKS 14
+
+typedef void (*TaskFn)(unsigned long now);
+
+class TaskScheduler {
+  public:
+    // Register in priority order; the first task added is acquisition.
+    // Returns the task id, or -1 if the table is full.
+    int add(const char* name, TaskFn fn, unsigned long periodMs, uint32_t budgetUs);
+
+    void setPeriod(int id, unsigned long periodMs);
+
+    // One loop() pass
+    void run(unsigned long now);
+
+    // ms until the next task with a period (acquisition aside) is due, 0 if
+    // one is; at most limitMs. Every-pass tasks don't count.
+    unsigned long untilDue(unsigned long now, unsigned long limitMs) const;
+
+    void appendQuery(String& url) const;
+
+    // Start a new stats window (after an acknowledged heartbeat)
+    void resetStats();
+
+  private:
+    struct Task {
+      const char*   name;
+      TaskFn        fn;
+      unsigned long periodMs;
+      uint32_t      budgetUs;
+      unsigned long dueMs;
+      uint32_t      runs, late, overruns, maxUs;
+    };
+
+    bool due(const Task& t, unsigned long now) const;
+    void runTask(Task& t, unsigned long now);
+
+    Task tasks[SCHED_MAX_TASKS];
+    int  count = 0;
+};
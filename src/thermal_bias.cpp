@@ -0,0 +1,63 @@
+#include "thermal_bias.h"
+
+void ThermalBias::begin(int16_t t0Raw, const float restored[3]) {
+  t0 = t0Raw;
+  for (int i = 0; i < 3; i++) {
+    slopes[i] = constrain(restored[i], -THERMAL_MAX_SLOPE, THERMAL_MAX_SLOPE);
+    sum[i] = 0;
+    sb[i] = stb[i] = 0;
+  }
+  count = 0;
+  w = st = stt = 0;
+  fitUsed = false;
+  buildTable();
+  setTemperature(t0Raw);
+}
+
+bool ThermalBias::closeWindow(int16_t tempRaw, uint32_t expectedSamples) {
+  uint32_t n = count;
+  double mean[3];
+  for (int i = 0; i < 3; i++) {
+    mean[i] = n ? (double)sum[i] / n : 0;
+    sum[i] = 0;
+  }
+  count = 0;
+  if (n == 0 || n < expectedSamples * 3 / 4) return false;
+
+  const double keep = 1.0 - 1.0 / THERMAL_FORGET;
+  double t = (tempRaw - t0) / 340.0;
+  w   = w   * keep + 1;
+  st  = st  * keep + t;
+  stt = stt * keep + t * t;
+  for (int i = 0; i < 3; i++) {
+    sb[i]  = sb[i]  * keep + mean[i];
+    stb[i] = stb[i] * keep + t * mean[i];
+  }
+
+  double var = stt / w - (st / w) * (st / w);
+  if (w < THERMAL_MIN_WINDOWS || var < THERMAL_MIN_SPREAD_C * THERMAL_MIN_SPREAD_C) return false;
+  // The bias tracker and calibration own the level; only the slope is fitted
+  double den = w * stt - st * st;
+  for (int i = 0; i < 3; i++) {
+    double s = (w * stb[i] - st * sb[i]) / den;
+    slopes[i] = constrain((float)s, -THERMAL_MAX_SLOPE, THERMAL_MAX_SLOPE);
+  }
+  fitUsed = true;
+  buildTable();
+  return true;
+}
+
+void ThermalBias::setTemperature(int16_t tempRaw) {
+  int32_t d = (int32_t)tempRaw - t0;
+  // Nearest step, rounding away from zero on both sides of T0
+  int step = (int)((d + (d >= 0 ? THERMAL_STEP_RAW / 2 : -THERMAL_STEP_RAW / 2)) / THERMAL_STEP_RAW);
+  int k = constrain(step + THERMAL_TABLE_SIZE / 2, 0, THERMAL_TABLE_SIZE - 1);
+  for (int i = 0; i < 3; i++) current[i] = table[k][i];
+}
+
+void ThermalBias::buildTable() {
+  for (int k = 0; k < THERMAL_TABLE_SIZE; k++) {
+    float c = (k - THERMAL_TABLE_SIZE / 2) * (THERMAL_STEP_RAW / 340.0f);
+    for (int i = 0; i < 3; i++) table[k][i] = (int16_t)lroundf(slopes[i] * c);
+  }
+}
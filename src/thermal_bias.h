@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Temperature-compensated bias ---------------------------------------------
+// The accel zero-g level drifts with die temperature, enough over a day to
+// creep toward the minor threshold. Each axis gets a bias-vs-temperature
+// slope from a least-squares line through at-rest means and TEMP_OUT reads,
+// and the correction slope * (T - T0), T0 being the calibration temperature,
+// is precomputed as an integer LSB table in 0.5 degC steps. The hot path
+// only ever adds the current entry to the bias it subtracts.
+//
+// Observations are windows of quiet samples (the ones the bias tracker
+// takes), each closed by a temperature read. Old windows fade out with a
+// time constant of THERMAL_FORGET windows, so the fit keeps following the
+// sensor in the field. A fit replaces the slopes restored with the
+// calibration once its windows span enough temperature; until then those
+// (zero on a new device) apply.
+#define THERMAL_WINDOW_MS      10000UL  // one observation, and one TEMP_OUT read
+#define THERMAL_FORGET         8640     // windows, ~1 day at 10s
+#define THERMAL_MIN_WINDOWS    30       // weight before a fit is trusted
+#define THERMAL_MIN_SPREAD_C   0.5f     // std deviation of the windows' temperature
+#define THERMAL_MAX_SLOPE      82.0f    // LSB/degC (5mg/degC); past that it's not drift
+#define THERMAL_TABLE_SIZE     64       // T0 +/- 16 degC
+#define THERMAL_STEP_RAW       170      // TEMP_OUT LSB per table step (340 per degC)
+
+class ThermalBias {
+  public:
+    // t0Raw: TEMP_OUT at calibration; slopes in LSB per degC (0 if unknown)
+    void begin(int16_t t0Raw, const float slopes[3]);
+
+    // One raw sample taken while idle and quiet
+    void addQuiet(int16_t x, int16_t y, int16_t z) {
+      sum[0] += x;
+      sum[1] += y;
+      sum[2] += z;
+      count++;
+    }
+
+    // End the current window at temperature tempRaw. It only counts if at
+    // least 3/4 of its expected samples were quiet. True if the slopes (and
+    // table) changed.
+    bool closeWindow(int16_t tempRaw, uint32_t expectedSamples);
+
+    // Look up the correction for tempRaw
+    void setTemperature(int16_t tempRaw);
+
+    // Correction at the last setTemperature(), LSB to add to the T0 bias
+    int32_t correction(int axis) const { return current[axis]; }
+
+    float   slope(int axis) const { return slopes[axis]; }
+    int16_t reference() const { return t0; }
+    bool    fitted() const { return fitUsed; }
+
+  private:
+    void buildTable();
+
+    int16_t t0 = 0;
+    float   slopes[3] = {};
+    int16_t table[THERMAL_TABLE_SIZE][3] = {};
+    int32_t current[3] = {};
+    bool    fitUsed = false;
+
+    // Current window
+    int64_t  sum[3] = {};
+    uint32_t count = 0;
+
+    // Exponentially weighted sums of the windows, temperature in degC from T0
+    double w = 0, st = 0, stt = 0;
+    double sb[3] = {}, stb[3] = {};
+};
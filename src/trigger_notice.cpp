@@ -0,0 +1,57 @@
+#include "trigger_notice.h"
+
+namespace {
+
+void put16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+void put32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+}  // namespace
+
+bool TriggerNotice::begin(const char* host, uint16_t destPort) {
+  stop();
+  if (!destPort || !WiFi.hostByName(host, address)) return false;
+  WiFi.macAddress(mac);
+  port = destPort;
+  return true;
+}
+
+void TriggerNotice::attach(MessageLink* messageLink) {
+  link = messageLink;
+  WiFi.macAddress(mac);
+}
+
+bool TriggerNotice::send(uint32_t seq, EventLevel level, TriggerMethod trigger, int64_t epochUs,
+                         EventTimeSource source, unsigned long ms, float peakG) {
+  if (!enabled()) return false;
+  uint8_t pkt[TRIGGER_NOTICE_SIZE] = {};
+  memcpy(pkt, "STN1", 4);
+  put32(pkt + 4, seq);
+  memcpy(pkt + 8, mac, 6);
+  pkt[14] = level;
+  pkt[15] = trigger;
+  put32(pkt + 16, (uint32_t)(uint64_t)epochUs);
+  put32(pkt + 20, (uint32_t)((uint64_t)epochUs >> 32));
+  put32(pkt + 24, ms);
+  put16(pkt + 28, (uint16_t)constrain(lroundf(peakG * 1000.0f), 0L, 65535L));
+  pkt[30] = source;
+  if (link && link->publish("trigger", pkt, sizeof(pkt))) {
+    sentCount++;
+    return true;
+  }
+  if (!port) {
+    sendFailures++;
+    return false;
+  }
+  bool ok = udp.beginPacket(address, port) &&
+            udp.write(pkt, sizeof(pkt)) == sizeof(pkt) &&
+            udp.endPacket();
+  if (ok) sentCount++;
+  else sendFailures++;
+  return ok;
+}
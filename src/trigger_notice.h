@@ -0,0 +1,55 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#include "detector.h"
+#include "event_journal.h"
+#include "message_link.h"
+
+// -- Trigger notice -----------------------------------------------------------
+// One datagram to the server's stream port the moment a capture opens, so
+// consensus doesn't wait out the post-trigger window and the upload. The
+// waveform follows as usual and carries the same seq (X-Event-Seq), which is
+// how the server ties the two together. No ack or retransmit: a lost notice
+// only means the event is placed when its upload arrives, as before.
+// With an MQTT link (or a device session) attached, the same bytes are
+// published to its trigger topic (a TRIGGER frame) while it is connected,
+// and the datagram is the fallback.
+//
+// Datagram, little-endian:
+//   0  "STN1"
+//   4  uint32  event seq
+//   8  uint8   MAC[6]
+//  14  uint8   level (EventLevel)
+//  15  uint8   trigger (TriggerMethod)
+//  16  int64   trigger time, epoch us, 0 if unknown
+//  24  uint32  trigger millis()
+//  28  uint16  peak, mg (saturates)
+//  30  uint8   time source of the epoch (EventTimeSource)
+//  31  uint8   0
+#define TRIGGER_NOTICE_SIZE 32
+
+class TriggerNotice {
+  public:
+    // Send to host:port (resolved once here); false if it doesn't resolve
+    bool begin(const char* host, uint16_t port);
+    void stop() { port = 0; }
+    // Publish on link while it can take it (set once, before begin())
+    void attach(MessageLink* link);
+    bool enabled() const { return port != 0 || (link && link->connected()); }
+
+    bool send(uint32_t seq, EventLevel level, TriggerMethod trigger, int64_t epochUs,
+              EventTimeSource source, unsigned long ms, float peakG);
+
+    uint32_t sent() const { return sentCount; }
+    uint32_t failed() const { return sendFailures; }
+
+  private:
+    WiFiUDP   udp;
+    MessageLink* link = nullptr;
+    IPAddress address;
+    uint16_t  port = 0;
+    uint8_t   mac[6] = {};
+    uint32_t  sentCount = 0;
+    uint32_t  sendFailures = 0;
+};
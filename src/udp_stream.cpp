@@ -0,0 +1,77 @@
+#include "udp_stream.h"
+
+namespace {
+
+void put16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+void put32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+}  // namespace
+
+bool UdpStream::begin(const char* host, uint16_t destPort, int sampleRateHz, int decimation,
+                      const SntpClock* sntpClock) {
+  stop();
+  if (!destPort || !WiFi.hostByName(host, address)) return false;
+  WiFi.macAddress(mac);
+  rateHz = (uint16_t)sampleRateHz;
+  decim  = (uint8_t)constrain(decimation, 1, STREAM_MAX_DECIM);
+  clock  = sntpClock;
+  seq = sendFailures = 0;
+  session = (uint16_t)ESP.random();   // hardware RNG
+  summed = count = 0;
+  port = destPort;
+  return true;
+}
+
+void UdpStream::stop() {
+  port = 0;
+  summed = count = 0;
+}
+
+bool UdpStream::add(unsigned long ms, int16_t x, int16_t y, int16_t z) {
+  if (!port) return false;
+  if (summed == 0) {
+    boxStartMs = ms;
+    sum[0] = sum[1] = sum[2] = 0;
+  }
+  sum[0] += x;
+  sum[1] += y;
+  sum[2] += z;
+  if (++summed < decim) return false;
+
+  if (count == 0) packetStartMs = boxStartMs;
+  for (int i = 0; i < 3; i++) samples[count][i] = (int16_t)(sum[i] / summed);
+  summed = 0;
+  if (++count < STREAM_SAMPLES_PER_PACKET) return false;
+  send();
+  return true;
+}
+
+void UdpStream::send() {
+  uint8_t header[STREAM_HEADER_SIZE];
+  memcpy(header, "SUS1", 4);
+  put32(header + 4, seq);
+  memcpy(header + 8, mac, 6);
+  put16(header + 14, rateHz);
+  header[16] = decim;
+  header[17] = (uint8_t)count;
+  put16(header + 18, session);
+  uint64_t epochUs = (clock && clock->synced()) ? (uint64_t)clock->epochUs(packetStartMs) : 0;
+  put32(header + 20, (uint32_t)epochUs);
+  put32(header + 24, (uint32_t)(epochUs >> 32));
+  put32(header + 28, packetStartMs);
+
+  // int16 LE on a little-endian core, so the sample block goes out as is
+  bool ok = udp.beginPacket(address, port) &&
+            udp.write(header, sizeof(header)) == sizeof(header) &&
+            udp.write((const uint8_t*)samples, count * sizeof(samples[0])) == count * sizeof(samples[0]) &&
+            udp.endPacket();
+  if (!ok) sendFailures++;
+  seq++;
+  count = 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#include "sntp_clock.h"
+
+// -- Continuous UDP stream ----------------------------------------------------
+// Optional per-device mode for noise-floor work: every raw sample goes into a
+// boxcar average of 'decim' samples (a crude anti-alias ahead of the rate
+// drop), and each STREAM_SAMPLES_PER_PACKET averages go out as one datagram.
+// There is no ack or retransmit; the sequence number lets the server count
+// lost and reordered datagrams, and each one carries its own start time.
+//
+// Datagram, little-endian:
+//   0  "SUS1"
+//   4  uint32  seq, from 0 at begin()
+//   8  uint8   MAC[6]
+//  14  uint16  sensor sample rate (Hz)
+//  16  uint8   decim (output rate = sensor rate / decim)
+//  17  uint8   sample count n
+//  18  uint16  session, random per begin(); a new one restarts seq
+//  20  int64   epoch us of the first sample, 0 until SNTP has synced
+//  28  uint32  millis() of the first sample
+//  32  n x int16 x, y, z   raw LSB (not de-biased, like event uploads)
+#define STREAM_HEADER_SIZE        32
+#define STREAM_SAMPLES_PER_PACKET 40     // 272-byte datagrams
+#define STREAM_MAX_DECIM          255
+
+class UdpStream {
+  public:
+    // Stream to host:port (resolved once here). decim is clamped to
+    // 1..STREAM_MAX_DECIM. Returns false if the host doesn't resolve.
+    bool begin(const char* host, uint16_t port, int sampleRateHz, int decim, const SntpClock* clock);
+    void stop();
+
+    bool enabled() const { return port != 0; }
+
+    // Feed every sample (raw LSB); sends a datagram when one is full and
+    // returns true then (lwIP holds its buffer until it's on the air)
+    bool add(unsigned long ms, int16_t x, int16_t y, int16_t z);
+
+    uint32_t sent() const { return seq; }
+    uint32_t failed() const { return sendFailures; }
+
+  private:
+    void send();
+
+    WiFiUDP   udp;
+    IPAddress address;
+    uint16_t  port = 0;
+    uint16_t  rateHz = 0;
+    uint8_t   decim = 1;
+    uint8_t   mac[6] = {};
+    const SntpClock* clock = nullptr;
+
+    uint32_t seq = 0;
+    uint16_t session = 0;
+    uint32_t sendFailures = 0;
+
+    // Boxcar being accumulated
+    int32_t  sum[3] = {};
+    int      summed = 0;
+    unsigned long boxStartMs = 0;
+
+    // Datagram being filled
+    int16_t  samples[STREAM_SAMPLES_PER_PACKET][3];
+    int      count = 0;
+    unsigned long packetStartMs = 0;
+};
@@ -0,0 +1,29 @@
+#include "upload_policy.h"
+
+namespace {
+
+const char* const MODE_NAMES[] = { "full", "decimate", "waveform_off", "summary", "retry" };
+const unsigned long MAX_HOLD_MS = 600000UL;
+
+}  // namespace
+
+const char* uploadModeName(UploadMode mode) {
+  return mode <= UPLOAD_RETRY ? MODE_NAMES[mode] : "full";
+}
+
+void UploadPolicy::update(const char* header, unsigned long now) {
+  UploadMode next = UPLOAD_FULL;
+  unsigned long ms = 0;
+  if (header && *header) {
+    const char* comma = strchr(header, ',');
+    size_t len = comma ? (size_t)(comma - header) : strlen(header);
+    for (int m = UPLOAD_DECIMATE; m <= UPLOAD_RETRY; m++) {
+      if (strlen(MODE_NAMES[m]) == len && strncmp(header, MODE_NAMES[m], len) == 0) next = (UploadMode)m;
+    }
+    if (comma) ms = min(strtoul(comma + 1, nullptr, 10), MAX_HOLD_MS);
+  }
+  if (next != current) Serial.printf(">> Server upload policy: %s for %lums\n", uploadModeName(next), ms);
+  current = next;
+  since = now;
+  hold = ms;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Server backpressure ------------------------------------------------------
+// A server whose ingest queue is backing up says so on every upload response,
+// as "X-Upload-Policy: <mode>,<hold_ms>", and the node sends less until it
+// clears:
+//   full          normal uploads
+//   decimate      waveforms at a quarter of the sample rate
+//   waveform_off  events without their samples
+//   summary       minor and moderate captures folded into the storm summary
+//                 (storm_filter.h), severe events without their samples
+//   retry         (with a 503) nothing taken: the upload is journaled and the
+//                 journal waits out hold_ms before replaying
+// A mode lapses back to full after hold_ms unless a later response renews
+// it, so a server that goes away doesn't leave the node degraded. A response
+// without the header (older servers) means full.
+enum UploadMode : uint8_t {
+  UPLOAD_FULL = 0,
+  UPLOAD_DECIMATE,
+  UPLOAD_WAVEFORM_OFF,
+  UPLOAD_SUMMARY,
+  UPLOAD_RETRY,
+};
+
+const char* uploadModeName(UploadMode mode);   // "full" / "decimate" / ...
+
+#define UPLOAD_DECIMATE_FACTOR 4
+
+class UploadPolicy {
+  public:
+    // A response's X-Upload-Policy value; nullptr or "" for none
+    void update(const char* header, unsigned long now);
+
+    UploadMode mode(unsigned long now) const {
+      return current != UPLOAD_FULL && now - since < hold ? current : UPLOAD_FULL;
+    }
+    // ms left to wait before a retry, 0 if none was asked for
+    unsigned long retryIn(unsigned long now) const {
+      return mode(now) == UPLOAD_RETRY ? hold - (now - since) : 0;
+    }
+
+  private:
+    UploadMode    current = UPLOAD_FULL;
+    unsigned long since = 0;
+    unsigned long hold = 0;
+};
@@ -0,0 +1,95 @@
+#include "waveform_inject.h"
+
+namespace {
+
+const int   HEADER_SIZE = 44;       // WAVEFORM_BINARY_HEADER_SIZE
+const float ACCEL_1G_LSB = 16384.0f; // +/-2g
+
+bool readFully(Stream& in, uint8_t* buf, size_t n) {
+  return in.readBytes((char*)buf, n) == n;
+}
+
+template <typename T>
+T field(const uint8_t* head, int offset) {
+  T v;
+  memcpy(&v, head + offset, sizeof(v));
+  return v;
+}
+
+}  // namespace
+
+bool WaveformInjector::begin(int cap) {
+  samples = new int16_t[(size_t)max(1, cap) * 3];
+  if (!samples) return false;
+  capacity = max(1, cap);
+  return true;
+}
+
+bool WaveformInjector::load(Stream& in, int length, int sampleRateHz) {
+  playing = false;
+  done = false;
+  count = 0;
+  uint8_t head[HEADER_SIZE];
+  if (!samples || !readFully(in, head, sizeof(head)) || memcmp(head, "SWV1", 4) != 0) return false;
+  float bias[3] = { field<float>(head, 16), field<float>(head, 20), field<float>(head, 24) };
+  float scale   = field<float>(head, 28);
+  int sourceHz  = field<uint16_t>(head, 32);
+  int n         = field<uint16_t>(head, 34);
+  int32_t t0Ms  = field<int32_t>(head, 36);
+  if (scale <= 0 || sourceHz == 0 || sampleRateHz <= 0) return false;
+  if (length >= 0 && length < HEADER_SIZE + n * 6) return false;
+
+  // Output sample j is source sample j * sourceHz / sampleRateHz
+  float k = ACCEL_1G_LSB / scale;
+  int j = 0;
+  for (int i = 0; i < n && j < capacity; i++) {
+    int16_t raw[3];
+    if (!readFully(in, (uint8_t*)raw, sizeof(raw))) return false;
+    int16_t v[3];
+    for (int a = 0; a < 3; a++) {
+      v[a] = (int16_t)constrain(lroundf((raw[a] - bias[a]) * k), -32768L, 32767L);
+    }
+    while (j < capacity && (int)((int64_t)j * sourceHz / sampleRateHz) == i) {
+      memcpy(samples + j * 3, v, sizeof(v));
+      j++;
+    }
+  }
+  count = j;
+  rateHz = sampleRateHz;
+  sourceTrigger = (int)((int64_t)-t0Ms * sampleRateHz / 1000);
+  runId = field<uint32_t>(head, 40);
+  return count > 0;
+}
+
+void WaveformInjector::start() {
+  if (!count) return;
+  pos = 0;
+  triggerAt = -1;
+  done = false;
+  playing = true;
+}
+
+void WaveformInjector::triggered() {
+  if (playing && triggerAt < 0) triggerAt = pos - 1;
+}
+
+void WaveformInjector::appendQuery(String& url) const {
+  url += "&inject=";
+  if (!done) {
+    url += '0';
+    return;
+  }
+  url += (unsigned long)runId;
+  url += ',';
+  url += pos;
+  url += ',';
+  url += count;
+  if (triggerAt >= 0) {
+    url += ',';
+    url += (long)(triggerAt - sourceTrigger) * 1000L / rateHz;
+  }
+}
+
+void WaveformInjector::reported() {
+  done = false;
+}
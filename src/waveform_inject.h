@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+
+// -- Waveform injection (-DWAVEFORM_INJECT=1, the nodemcuv2_inject env) -------
+// Hardware-in-the-loop source: a stored capture, as an "SWV1" body (the
+// upload format, see waveform_stream.h) from GET /api/inject or from
+// /inject.swv on LittleFS, is played into processSample() in place of the
+// sensor. One injected sample replaces each sensor sample, so the sensor
+// clock still paces acquisition and everything downstream (triggers, arena,
+// upload, consensus) runs as it would on a real event.
+//
+// Samples are de-biased g (the header bias is taken out at load) held as
+// +/-2g LSB, and go back onto the device's live bias as they are played;
+// beyond 32767 LSB of that they clip. A source at another sample rate is
+// resampled to the device's by nearest sample. The header's event_offset_ms
+// field (bytes 40..43) carries the server's run id instead.
+#define INJECT_MAX_SAMPLES 1500   // 15s at 100Hz, 9KB taken at boot
+
+class WaveformInjector {
+  public:
+    bool begin(int capacity);
+
+    // Read an SWV1 body ('length' bytes, -1 if unknown) for sampleRateHz.
+    // Nothing plays until start().
+    bool load(Stream& body, int length, int sampleRateHz);
+    void start();
+    bool loaded() const { return count > 0; }
+    bool active() const { return playing; }
+
+    // The sensor sample, as processSample() got it at range 'shift', swapped
+    // for the next injected one on the given bias
+    void next(uint8_t shift, int32_t biasX, int32_t biasY, int32_t biasZ,
+              int16_t& x, int16_t& y, int16_t& z) {
+      const int16_t* s = samples + pos * 3;
+      x = toRaw(s[0] + biasX, shift);
+      y = toRaw(s[1] + biasY, shift);
+      z = toRaw(s[2] + biasZ, shift);
+      if (++pos >= count) {
+        playing = false;
+        done = true;
+      }
+    }
+
+    // A capture started on the sample just played
+    void triggered();
+
+    // "&inject=0" when ready, "&inject=id,played,count[,trigger_ms]" once a
+    // run is over: trigger_ms is when the first capture started relative to
+    // the source's own trigger, so it is the detection latency on this node
+    void appendQuery(String& url) const;
+    void reported();   // the heartbeat with the result got through
+
+  private:
+    static int16_t toRaw(int32_t v, uint8_t shift) {
+      return (int16_t)constrain(v / (1 << shift), -32768L, 32767L);
+    }
+
+    int16_t* samples = nullptr;
+    int      capacity = 0;
+    int      count = 0;
+    int      pos = 0;
+    int      rateHz = 0;
+    int      sourceTrigger = 0;   // sample the source capture triggered on
+    int      triggerAt = -1;      // first capture start, -1 if none
+    uint32_t runId = 0;
+    bool     playing = false;
+    bool     done = false;
+};
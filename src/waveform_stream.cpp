@@ -0,0 +1,512 @@
+#include "waveform_stream.h"
+#include <ArduinoJson.h>
+
+namespace {
+
+// Every MessagePack piece builds its metadata in a document over this one
+// block, reset before each use (pieces never nest), so uploads don't churn the
+// heap. One 32-bit ESP8266 pool (1KB) plus the copied strings; a 64-bit
+// host build (pio test -e native) has 4KB pools.
+#if UINTPTR_MAX > 0xFFFFFFFFu
+#define PIECE_ARENA_SIZE 4608
+#else
+#define PIECE_ARENA_SIZE 1536
+#endif
+StaticArenaAllocator<PIECE_ARENA_SIZE> pieceArena;
+
+// Print sink that only counts bytes (used for Content-Length)
+class CountingPrint : public Print {
+  public:
+    size_t count = 0;
+    size_t write(uint8_t) override { count++; return 1; }
+    size_t write(const uint8_t*, size_t size) override { count += size; return size; }
+};
+
+// Print sink over a fixed buffer; silently truncates past capacity
+class BufferPrint : public Print {
+  public:
+    BufferPrint(uint8_t* data, size_t capacity) : data(data), capacity(capacity) {}
+    size_t length = 0;
+    size_t write(uint8_t c) override {
+      if (length >= capacity) return 0;
+      data[length++] = c;
+      return 1;
+    }
+  private:
+    uint8_t* data;
+    size_t   capacity;
+};
+
+}  // namespace
+
+PieceStream::PieceStream(const CaptureView& capture) : cap(capture) {
+  rewind();
+}
+
+void PieceStream::rewind() {
+  bufLen = bufPos = 0;
+  nextPiece = 0;
+  finished = false;
+}
+
+size_t PieceStream::measure() {
+  CountingPrint counter;
+  for (int i = 0; writePiece(counter, i); i++) { }
+  rewind();
+  return counter.count;
+}
+
+bool PieceStream::refill() {
+  if (finished) return false;
+  BufferPrint out(buf, sizeof(buf));
+  if (!writePiece(out, nextPiece++)) {
+    finished = true;
+    return false;
+  }
+  bufLen = out.length;
+  bufPos = 0;
+  return true;
+}
+
+int PieceStream::available() {
+  while (bufPos >= bufLen) {
+    if (!refill()) return 0;
+  }
+  return (int)(bufLen - bufPos);
+}
+
+int PieceStream::read() {
+  if (!available()) return -1;
+  return buf[bufPos++];
+}
+
+int PieceStream::peek() {
+  if (!available()) return -1;
+  return buf[bufPos];
+}
+
+size_t PieceStream::readBytes(char* buffer, size_t length) {
+  size_t n = 0;
+  while (n < length && available()) {
+    size_t chunk = min(length - n, bufLen - bufPos);
+    memcpy(buffer + n, buf + bufPos, chunk);
+    bufPos += chunk;
+    n += chunk;
+  }
+  return n;
+}
+
+int PieceStream::read(uint8_t* buffer, size_t length) {
+  return (int)readBytes((char*)buffer, length);
+}
+
+long CaptureView::relMs(int i) const {
+  auto periods = [this](int k) { return (long)k + (gapSamples > 0 && k >= gapIndex ? gapSamples : 0); };
+  return (periods(i) - periods(preCount - 1)) * 1000L / sampleRateHz;
+}
+
+int CaptureView::shiftAt(int i) const {
+  int shift = 0;
+  for (int k = 0; k < rangeCount && ranges[k].index <= i; k++) shift = ranges[k].shift;
+  return shift;
+}
+
+bool decimateCapture(CaptureView& cap, int factor, uint16_t* retriggers, CaptureRange* ranges) {
+  if (factor <= 1 || cap.stride != 1 || cap.sampleRateHz % factor || cap.preCount < 1) return false;
+  // Raw window index r goes to (r - skip) / factor, which the trigger hits exactly
+  int trigger = cap.preCount - 1;
+  int skip = trigger % factor;
+  int last = cap.count() - 1;
+  auto at    = [&](int r) { return (r - skip) / factor; };                              // at or before r
+  auto after = [&](int r) { return (max(r, skip) - skip + factor - 1) / factor; };   // at or after r
+
+  for (int i = 0; i < cap.retriggerCount; i++) retriggers[i] = (uint16_t)at(cap.retriggers[i]);
+  cap.retriggers = retriggers;
+  for (int k = 0; k < cap.rangeCount; k++) ranges[k] = { (uint16_t)(k ? after(cap.ranges[k].index) : 0), cap.ranges[k].shift };
+  cap.ranges = ranges;
+  if (cap.gapSamples > 0) {
+    cap.gapIndex   = after(cap.gapIndex);
+    cap.gapSamples = max(1, (cap.gapSamples + factor / 2) / factor);
+  }
+  cap.firstSeq    += (uint32_t)skip;
+  cap.preCount     = at(trigger) + 1;
+  cap.postCount    = at(last) - at(trigger);
+  cap.sampleRateHz /= factor;
+  cap.stride       = factor;
+  return true;
+}
+
+const char* triggerName(TriggerMethod trigger) {
+  return trigger == TRIGGER_STA_LTA ? "sta_lta"
+       : trigger == TRIGGER_PULL    ? "pull"
+       :                              "threshold";
+}
+
+bool WaveformJsonStream::writePiece(Print& out, int index) {
+  int n = cap.count();
+  if (index == 0) {
+    out.print("{\"id\":\"");
+    out.print(cap.deviceId);
+    out.print("\",\"level\":\"");
+    out.print(cap.level);
+    out.print("\",\"trigger\":\"");
+    out.print(triggerName(cap.trigger));
+    out.print("\",\"deltaG\":");
+    out.print(cap.deltaG, 4);
+    out.print(",\"event_offset_ms\":");
+    out.print(cap.offsetMs);
+    if (cap.coherence >= 0) {
+      out.print(",\"coherence\":");
+      out.print(cap.coherence, 3);
+    }
+    if (cap.gapSamples > 0) {
+      out.print(",\"gap_index\":");
+      out.print(cap.gapIndex);
+      out.print(",\"gap_samples\":");
+      out.print(cap.gapSamples);
+    }
+    return true;
+  }
+  if (index == 1) {
+    // Own piece: eight retriggers would overflow the header's
+    if (cap.retriggerCount > 0) {
+      out.print(",\"retriggers\":[");
+      for (int i = 0; i < cap.retriggerCount; i++) {
+        if (i) out.print(',');
+        out.print(cap.relMs(cap.retriggers[i]));
+      }
+      out.print(']');
+    }
+    if (cap.rangeCount > 0) {
+      out.print(",\"ranges\":[");
+      for (int k = 0; k < cap.rangeCount; k++) {
+        if (k) out.print(',');
+        out.print('[');
+        out.print(cap.ranges[k].index);
+        out.print(',');
+        out.print(cap.scale / (1 << cap.ranges[k].shift), 0);
+        out.print(']');
+      }
+      out.print(']');
+    }
+    out.print(",\"waveform\":[");
+    return true;
+  }
+  if (index <= n + 1) {
+    // Waveform samples oldest first; the trigger is at the t=0 boundary
+    WaveSample s = cap.at(index - 2);
+    float k = (float)(1 << cap.shiftAt(index - 2));   // to LSB at cap.scale
+    if (index > 2) out.print(',');
+    out.print('[');
+    out.print(cap.relMs(index - 2));
+    out.print(',');
+    out.print((s.x * k - cap.biasX) / cap.scale, 4);
+    out.print(',');
+    out.print((s.y * k - cap.biasY) / cap.scale, 4);
+    out.print(',');
+    out.print((s.z * k - cap.biasZ) / cap.scale, 4);
+    out.print(']');
+    return true;
+  }
+  if (index == n + 2) {
+    out.print(']');
+    if (cap.spectrum) {
+      const SpectrumSummary& sp = *cap.spectrum;
+      out.print(",\"spectrum\":{\"hz\":[");
+      for (int b = 0; b < sp.bins; b++) {
+        if (b) out.print(',');
+        out.print(sp.hz[b]);
+      }
+      out.print("],\"amp_g\":[");
+      for (int b = 0; b < sp.bins; b++) {
+        if (b) out.print(',');
+        out.print(sp.ampG[b], 6);
+      }
+      out.print("],\"dominant_hz\":");
+      out.print(sp.hz[sp.dominant]);
+      out.print('}');
+    }
+    out.print('}');
+    return true;
+  }
+  return false;
+}
+
+namespace {
+
+template <typename T>
+void writeLE(Print& out, T value) {
+  // ESP8266 is little-endian, so the in-memory layout is the wire layout
+  out.write((const uint8_t*)&value, sizeof(value));
+}
+
+uint8_t hexNibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return 0;
+}
+
+uint8_t levelCode(const char* level) {
+  if (strcmp(level, "severe") == 0)   return 2;
+  if (strcmp(level, "moderate") == 0) return 1;
+  return 0;
+}
+
+const int BINARY_SAMPLES_PER_PIECE = 16;  // 96 bytes per piece
+
+// Sample pieces in a capture; the spectrum, if any, is the piece after them
+int samplePieces(const CaptureView& cap) {
+  return (cap.count() + BINARY_SAMPLES_PER_PIECE - 1) / BINARY_SAMPLES_PER_PIECE;
+}
+
+// First piece of the dual-sensor trailer, its samples in the ones after it
+int dualPiece(const CaptureView& cap) {
+  return samplePieces(cap) + 1 + (cap.spectrum != nullptr);
+}
+
+// Binary trailer, layout in waveform_stream.h
+void writeSpectrumTrailer(Print& out, const SpectrumSummary& sp) {
+  out.write((const uint8_t*)WAVEFORM_SPECTRUM_MAGIC, 4);
+  writeLE<uint8_t>(out, sp.bins);
+  writeLE<uint8_t>(out, sp.dominant);
+  out.write(sp.hz, sp.bins);
+  for (int b = 0; b < sp.bins; b++) writeLE<float>(out, sp.ampG[b]);
+}
+
+// Zigzag so small negative deltas stay small, then LEB128 (7 bits per byte)
+void writeVarint(Print& out, int32_t value) {
+  uint32_t v = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+  while (v >= 0x80) {
+    out.write((uint8_t)(v | 0x80));
+    v >>= 7;
+  }
+  out.write((uint8_t)v);
+}
+
+// Zigzag varint deltas for sample piece 'index' (1-based); false past the end
+bool writeDeltaRun(Print& out, const CaptureView& cap, int index) {
+  int n = cap.count();
+  int first = (index - 1) * BINARY_SAMPLES_PER_PIECE;
+  if (first >= n) return false;
+  int last = min(first + BINARY_SAMPLES_PER_PIECE, n);
+  int32_t px = 0, py = 0, pz = 0;
+  if (first > 0) {
+    WaveSample p = cap.at(first - 1);
+    px = p.x; py = p.y; pz = p.z;
+  }
+  for (int i = first; i < last; i++) {
+    WaveSample s = cap.at(i);
+    writeVarint(out, s.x - px);
+    writeVarint(out, s.y - py);
+    writeVarint(out, s.z - pz);
+    px = s.x; py = s.y; pz = s.z;
+  }
+  return true;
+}
+
+// Dual-sensor trailer header, layout in waveform_stream.h
+void writeDualHeader(Print& out, const CaptureView& cap) {
+  out.write((const uint8_t*)WAVEFORM_DUAL_MAGIC, 4);
+  writeLE<float>(out, cap.coherence);
+  for (int a = 0; a < 3; a++) writeLE<float>(out, cap.secondaryBias[a]);
+}
+
+// Second sensor minus first, raw LSB; both read at the same range
+void sensorDifference(const CaptureView& cap, int i, int32_t d[3]) {
+  WaveSample p = cap.at(i), s = cap.secondaryAt(i);
+  d[0] = s.x - p.x;
+  d[1] = s.y - p.y;
+  d[2] = s.z - p.z;
+}
+
+// Varint changes of that difference for dual piece 'index' (1-based); at
+// most 3 bytes a value, so 144 a piece. False past the end.
+bool writeDualRun(Print& out, const CaptureView& cap, int index) {
+  int n = cap.count();
+  int first = (index - 1) * BINARY_SAMPLES_PER_PIECE;
+  if (first >= n) return false;
+  int last = min(first + BINARY_SAMPLES_PER_PIECE, n);
+  int32_t prev[3] = { 0, 0, 0 };
+  if (first > 0) sensorDifference(cap, first - 1, prev);
+  for (int i = first; i < last; i++) {
+    int32_t d[3];
+    sensorDifference(cap, i, d);
+    for (int a = 0; a < 3; a++) writeVarint(out, d[a] - prev[a]);
+    memcpy(prev, d, sizeof(prev));
+  }
+  return true;
+}
+
+int32_t firstSampleOffset(const CaptureView& cap) {
+  return cap.count() > 0 ? (int32_t)cap.relMs(0) : 0;
+}
+
+// Packed int16 x/y/z for sample piece 'index' (1-based); false past the end
+bool writeSampleRun(Print& out, const CaptureView& cap, int index) {
+  int n = cap.count();
+  int first = (index - 1) * BINARY_SAMPLES_PER_PIECE;
+  if (first >= n) return false;
+  int last = min(first + BINARY_SAMPLES_PER_PIECE, n);
+  for (int i = first; i < last; i++) {
+    WaveSample s = cap.at(i);
+    writeLE<int16_t>(out, s.x);
+    writeLE<int16_t>(out, s.y);
+    writeLE<int16_t>(out, s.z);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool WaveformBinaryStream::writePiece(Print& out, int index) {
+  int n = cap.count();
+  if (index == 0) {
+    // "AA:BB:CC:DD:EE:FF" -> 6 bytes
+    uint8_t mac[6] = { 0 };
+    const char* p = cap.deviceId;
+    for (int i = 0; i < 6 && p[0] && p[1]; i++, p += 3) {
+      mac[i] = (hexNibble(p[0]) << 4) | hexNibble(p[1]);
+      if (!p[2]) break;
+    }
+    int32_t t0 = firstSampleOffset(cap);
+
+    bool gap = cap.gapSamples > 0;
+    bool retrig = cap.retriggerCount > 0;
+    bool ranged = cap.rangeCount > 0;
+    char magic[5] = { 'S', 'W', delta ? 'D' : 'V', ranged ? '4' : retrig ? '3' : gap ? '2' : '1', 0 };
+    out.write((const uint8_t*)magic, 4);
+    out.write(mac, sizeof(mac));
+    writeLE<uint8_t>(out, levelCode(cap.level));
+    writeLE<uint8_t>(out, cap.trigger);
+    writeLE<float>(out, cap.deltaG);
+    writeLE<float>(out, cap.biasX);
+    writeLE<float>(out, cap.biasY);
+    writeLE<float>(out, cap.biasZ);
+    writeLE<float>(out, cap.scale);
+    writeLE<uint16_t>(out, (uint16_t)cap.sampleRateHz);
+    writeLE<uint16_t>(out, (uint16_t)n);
+    writeLE<int32_t>(out, t0);
+    writeLE<uint32_t>(out, (uint32_t)cap.offsetMs);
+    if (gap || retrig || ranged) {
+      writeLE<uint16_t>(out, (uint16_t)cap.gapIndex);
+      writeLE<uint16_t>(out, (uint16_t)min(cap.gapSamples, 65535));
+    }
+    if (retrig || ranged) {
+      writeLE<uint8_t>(out, (uint8_t)cap.retriggerCount);
+      for (int i = 0; i < cap.retriggerCount; i++) writeLE<int32_t>(out, (int32_t)cap.relMs(cap.retriggers[i]));
+    }
+    if (ranged) {
+      writeLE<uint8_t>(out, (uint8_t)cap.rangeCount);
+      for (int k = 0; k < cap.rangeCount; k++) {
+        writeLE<uint16_t>(out, cap.ranges[k].index);
+        writeLE<float>(out, cap.scale / (1 << cap.ranges[k].shift));
+      }
+    }
+    return true;
+  }
+  if (delta ? writeDeltaRun(out, cap, index) : writeSampleRun(out, cap, index)) return true;
+  if (cap.spectrum && index == samplePieces(cap) + 1) {
+    writeSpectrumTrailer(out, *cap.spectrum);
+    return true;
+  }
+  if (!cap.secondary || index < dualPiece(cap)) return false;
+  if (index == dualPiece(cap)) {
+    writeDualHeader(out, cap);
+    return true;
+  }
+  return writeDualRun(out, cap, index - dualPiece(cap));
+}
+
+bool WaveformMsgPackStream::writePiece(Print& out, int index) {
+  if (index > 1) {
+    if (writeSampleRun(out, cap, index - 1)) return true;
+    if (!cap.spectrum || index - 1 != samplePieces(cap) + 1) return false;
+    // Trails the samples blob as the map's last entry
+    const SpectrumSummary& sp = *cap.spectrum;
+    pieceArena.reset();
+    JsonDocument extra(&pieceArena);
+    JsonObject spectrum = extra["spectrum"].to<JsonObject>();
+    JsonArray hz = spectrum["hz"].to<JsonArray>();
+    JsonArray amp = spectrum["amp_g"].to<JsonArray>();
+    for (int b = 0; b < sp.bins; b++) {
+      hz.add(sp.hz[b]);
+      amp.add(sp.ampG[b]);
+    }
+    spectrum["dominant_hz"] = sp.hz[sp.dominant];
+    uint8_t pair[PIECE_BUFFER_SIZE];
+    size_t len = serializeMsgPack(extra, pair, sizeof(pair));
+    if (len < 2 || extra.overflowed()) return false;
+    out.write(pair + 1, len - 1);
+    return true;
+  }
+  if (index == 1) {
+    if (cap.retriggerCount > 0 || cap.rangeCount > 0) {
+      // { retriggers: [...], ranges: [...] } minus its map byte is the bare key/value pairs
+      pieceArena.reset();
+      JsonDocument extra(&pieceArena);
+      if (cap.retriggerCount > 0) {
+        JsonArray retriggers = extra["retriggers"].to<JsonArray>();
+        for (int i = 0; i < cap.retriggerCount; i++) retriggers.add(cap.relMs(cap.retriggers[i]));
+      }
+      if (cap.rangeCount > 0) {
+        JsonArray ranges = extra["ranges"].to<JsonArray>();
+        for (int k = 0; k < cap.rangeCount; k++) {
+          JsonArray block = ranges.add<JsonArray>();
+          block.add(cap.ranges[k].index);
+          block.add(cap.scale / (1 << cap.ranges[k].shift));
+        }
+      }
+      uint8_t pair[PIECE_BUFFER_SIZE - 16];
+      size_t len = serializeMsgPack(extra, pair, sizeof(pair));
+      if (len < 2 || extra.overflowed()) return false;
+      out.write(pair + 1, len - 1);
+    }
+    uint32_t blobLen = (uint32_t)cap.count() * 6;
+    const uint8_t key[] = { 0xA7, 's', 'a', 'm', 'p', 'l', 'e', 's' };
+    out.write(key, sizeof(key));
+    const uint8_t bin32[] = { 0xC6, (uint8_t)(blobLen >> 24), (uint8_t)(blobLen >> 16),
+                              (uint8_t)(blobLen >> 8), (uint8_t)blobLen };
+    out.write(bin32, sizeof(bin32));
+    return true;
+  }
+
+  pieceArena.reset();
+  JsonDocument doc(&pieceArena);
+  doc["id"]              = cap.deviceId;
+  doc["level"]           = cap.level;
+  doc["trigger"]         = triggerName(cap.trigger);
+  doc["deltaG"]          = cap.deltaG;
+  doc["event_offset_ms"] = cap.offsetMs;
+  doc["sample_rate_hz"]  = cap.sampleRateHz;
+  doc["t0_ms"]           = firstSampleOffset(cap);
+  JsonArray bias = doc["bias"].to<JsonArray>();
+  bias.add(cap.biasX);
+  bias.add(cap.biasY);
+  bias.add(cap.biasZ);
+  doc["scale"]           = cap.scale;
+  if (cap.coherence >= 0) doc["coherence"] = cap.coherence;
+  if (cap.gapSamples > 0) {
+    doc["gap_index"]     = cap.gapIndex;
+    doc["gap_samples"]   = cap.gapSamples;
+  }
+
+  // Serialize the metadata map, then rewrite its header with room for the
+  // entries appended after it (retriggers, ranges, the streamed 'samples',
+  // spectrum). Past 15 entries a fixmap can't hold the count, so the pairs
+  // go out under a map16 header instead
+  uint8_t head[PIECE_BUFFER_SIZE];
+  size_t len = serializeMsgPack(doc, head, sizeof(head));
+  if (len == 0 || doc.overflowed() || (head[0] & 0xF0) != 0x80) return false;
+  unsigned entries = (head[0] & 0x0F) + 1 + (cap.retriggerCount > 0) + (cap.rangeCount > 0) +
+                     (cap.spectrum != nullptr);
+  if (entries <= 15) {
+    head[0] = 0x80 | entries;
+    out.write(head, len);
+  } else {
+    const uint8_t map16[] = { 0xDE, (uint8_t)(entries >> 8), (uint8_t)entries };
+    out.write(map16, sizeof(map16));
+    out.write(head + 1, len - 1);
+  }
+  return true;
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <Arduino.h>
+#include "capture_arena.h"
+#include "detector.h"
+#include "spectrum.h"
+
+const char* triggerName(TriggerMethod trigger);   // "threshold" / "sta_lta" / "pull"
+
+// Accel range block of a capture: samples from window index 'index' on are
+// raw LSB at +/-(2 << shift) g, i.e. scale / 2^shift LSB per g
+struct CaptureRange {
+  uint16_t index;
+  uint8_t  shift;   // MPU6050_ACCEL_FS_* code
+};
+
+// Read-only view of a finished capture, handed to the upload serializers.
+// The window is preCount + postCount samples in the arena, every stride-th
+// from sequence number firstSeq; the trigger is the last pre-event sample.
+struct CaptureView {
+  const char*   deviceId;
+  const char*   level;
+  TriggerMethod trigger;
+  float         deltaG;
+  unsigned long offsetMs;    // ms between trigger and upload start
+
+  const CaptureArena* arena;
+  uint32_t firstSeq;         // sequence number of the oldest sample
+  int preCount;              // up to and including the trigger sample
+  int postCount;
+
+  float biasX, biasY, biasZ;  // raw-LSB bias measured at rest (at scale)
+  float scale;                // LSB per g at +/-2g
+  int   sampleRateHz;
+
+  // FIFO overflow inside the window: samples lost just before sample
+  // gapIndex (summed if there were several). 0 = continuous.
+  int   gapIndex;
+  int   gapSamples;
+
+  // Later triggers inside the window (window sample indices, first trigger
+  // excluded); the capture was extended for each. 0 = single trigger.
+  const uint16_t* retriggers;
+  int   retriggerCount;
+
+  // Range blocks in index order, the first at 0, when auto-ranging raised
+  // the range inside the window. 0 = every sample at scale.
+  const CaptureRange* ranges;
+  int   rangeCount;
+
+  // Goertzel band amplitudes of the post-trigger samples; nullptr = not computed
+  const SpectrumSummary* spectrum;
+
+  int stride = 1;             // arena samples per window sample (decimateCapture())
+
+  // Second sensor (DUAL_SENSOR): its arena, on the same sequence numbers,
+  // and raw-LSB bias; coherence is its |dG| envelope's correlation with
+  // this one's over the window, 0..1. nullptr / -1 = single sensor.
+  const CaptureArena* secondary = nullptr;
+  float secondaryBias[3] = {};
+  float coherence = -1;
+
+  int count() const { return preCount + postCount; }
+  WaveSample at(int i) const { return arena->at(firstSeq + (uint32_t)(i * stride)); }
+  WaveSample secondaryAt(int i) const { return secondary->at(firstSeq + (uint32_t)(i * stride)); }
+
+  // ms from the trigger to sample i, derived from the sample rate; samples
+  // from gapIndex on are gapSamples periods later
+  long relMs(int i) const;
+
+  // Range code of sample i; its LSB are 2^shift ones at scale
+  int shiftAt(int i) const;
+};
+
+// Thin cap to every factor-th sample, keeping the trigger sample. The rate
+// and every window index (gap, retriggers, range blocks) come down by the
+// factor; retriggers and ranges are rewritten into the caller's arrays
+// (CAPTURE_MAX_TRIGGERS and cap.rangeCount entries). There's no anti-alias
+// filter, so content above the new Nyquist folds back. False, with cap left
+// as it was, unless the rate divides by factor.
+bool decimateCapture(CaptureView& cap, int factor, uint16_t* retriggers, CaptureRange* ranges);
+
+// -- Streaming upload body ----------------------------------------------------
+// A Stream that renders the request body a small piece at a time, so
+// HTTPClient::sendRequest() can pull it straight into the socket. Peak RAM
+// is one piece buffer regardless of how many samples were captured.
+// measure() runs the same renderer into a byte counter for Content-Length.
+#define PIECE_BUFFER_SIZE 192
+
+class PieceStream : public Stream {
+  public:
+    explicit PieceStream(const CaptureView& capture);
+    virtual ~PieceStream() {}
+
+    size_t measure();   // total body length in bytes; leaves stream rewound
+    void rewind();
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char* buffer, size_t length) override;
+    int read(uint8_t* buffer, size_t length);
+    size_t write(uint8_t) override { return 0; }
+
+  protected:
+    // Render piece number 'index' into out. Return false once index is past
+    // the last piece. A single piece must fit in PIECE_BUFFER_SIZE bytes.
+    virtual bool writePiece(Print& out, int index) = 0;
+
+    CaptureView cap;
+
+  private:
+    bool refill();
+
+    uint8_t buf[PIECE_BUFFER_SIZE];
+    size_t  bufLen;
+    size_t  bufPos;
+    int     nextPiece;
+    bool    finished;
+};
+
+// {"id":..,"level":..,"trigger":..,"deltaG":..,"event_offset_ms":..,["gap_index":..,"gap_samples":..,]
+//  ["coherence":..,]["retriggers":[rel_ms,...],]["ranges":[[index,scale],...],]"waveform":[[rel_ms,ax,ay,az],...]
+//  [,"spectrum":{"hz":[..],"amp_g":[..],"dominant_hz":..}]} - rel_ms already skips any gap;
+// a dual-sensor capture only says its coherence, the second sensor's samples
+// go in the binary formats
+class WaveformJsonStream : public PieceStream {
+  public:
+    explicit WaveformJsonStream(const CaptureView& capture) : PieceStream(capture) {}
+
+  protected:
+    bool writePiece(Print& out, int index) override;
+};
+
+// Compact binary body: fixed little-endian header, then packed raw int16
+// x/y/z triplets. Sample i is at t0_ms + i * 1000 / sample_rate_hz.
+//
+//   off  size  field
+//     0     4  magic "SWV1"
+//     4     6  device MAC
+//    10     1  level (0 = minor, 1 = moderate, 2 = severe)
+//    11     1  trigger (0 = threshold, 1 = STA/LTA)
+//    12     4  float32 deltaG
+//    16    12  float32 biasX, biasY, biasZ (raw LSB)
+//    28     4  float32 scale (LSB per g)
+//    32     2  uint16 sample_rate_hz
+//    34     2  uint16 sample count
+//    36     4  int32 t0_ms (first sample relative to trigger)
+//    40     4  uint32 event_offset_ms
+//    44  6*N  int16 x, y, z per sample
+//
+// A capture with a FIFO gap uses magic "SWV2" and a 48-byte header instead,
+// with two more fields before the samples; from sample gap_index on, add
+// gap_samples periods to the time above. Gap-free bodies stay "SWV1".
+//    44     2  uint16 gap_index
+//    46     2  uint16 gap_samples
+//
+// A retriggered capture uses magic "SWV3": the gap fields (zero if there is
+// no gap), then the retrigger times, so the header is 49 + 4*R bytes.
+//    48     1  uint8 retrigger count R
+//    49   4*R  int32 ms from the first trigger, per retrigger
+//
+// A capture whose accel range changed (auto-ranging on a severe event) uses
+// magic "SWV4": the SWV3 fields, then the range blocks, so the header is
+// 50 + 4*R + 6*K bytes. Block k's samples, from its index to the next
+// block's, are raw LSB at its scale; the bias stays in header-scale LSB,
+// so g = raw / block scale - bias / scale.
+//  49+4R     1  uint8 block count K
+//  50+4R   6*K  uint16 first sample, float32 scale (LSB per g), per block
+//
+// A capture with a spectrum appends a trailer after the last sample, which
+// older servers ignore (they stop reading at the sample count):
+//     0     4  magic "SPC1"
+//     4     1  uint8 bin count B
+//     5     1  uint8 dominant bin index
+//     6     B  uint8 bin centre Hz
+//   6+B   4*B  float32 amplitude per bin (g)
+//
+// A dual-sensor capture appends a second trailer after that (or after the
+// last sample if there is no spectrum). The second sensor's samples go as
+// its difference from the first, raw LSB at the same range, sample by
+// sample; per sample the x, y, z change of that difference from the
+// previous sample's (the first sample's from 0), zigzag LEB128 varints as
+// in the delta format. Two sensors on one board mostly differ by bias, so
+// at rest that is a byte per axis; the bias is in the trailer.
+//     0     4  magic "DUA1"
+//     4     4  float32 coherence (|dG| envelope correlation, 0..1)
+//     8    12  float32 second sensor biasX, biasY, biasZ (raw LSB)
+//    20     -  varint x, y, z per sample
+#define WAVEFORM_BINARY_CONTENT_TYPE "application/vnd.seismo.waveform"
+#define WAVEFORM_BINARY_HEADER_SIZE  44
+#define WAVEFORM_BINARY_GAP_HEADER_SIZE 48
+#define WAVEFORM_BINARY_RETRIGGER_HEADER_SIZE 49
+#define WAVEFORM_BINARY_RANGE_HEADER_SIZE 50
+#define WAVEFORM_SPECTRUM_MAGIC "SPC1"
+#define WAVEFORM_DUAL_MAGIC "DUA1"
+
+class WaveformBinaryStream : public PieceStream {
+  public:
+    explicit WaveformBinaryStream(const CaptureView& capture, bool delta = false)
+      : PieceStream(capture), delta(delta) {}
+
+  protected:
+    bool writePiece(Print& out, int index) override;
+
+  private:
+    bool delta;
+};
+
+// Delta-coded variant of the binary format: same header with magic "SWD1"
+// ("SWD2" with a gap, "SWD3" retriggered, "SWD4" range-switched), then per sample the x, y, z differences from the previous sample
+// (the first sample's from 0), each zigzag-mapped and written as a LEB128
+// varint. At rest most deltas are a few LSB, i.e. 1 byte instead of 2.
+#define WAVEFORM_DELTA_CONTENT_TYPE "application/vnd.seismo.waveform-delta"
+
+// MessagePack map, metadata serialized with ArduinoJson's serializeMsgPack():
+//   { id, level, trigger, deltaG, event_offset_ms, sample_rate_hz, t0_ms,
+//     bias: [x, y, z], scale, [gap_index, gap_samples,] [coherence,] [retriggers: [ms, ...],]
+//     [ranges: [[index, scale], ...],] samples: bin, [spectrum: { hz: [..], amp_g: [..], dominant_hz }] }
+// 'samples' is the same packed little-endian int16 x/y/z run as the binary
+// format. It is appended after the metadata and streamed from the capture
+// buffers instead of going through a MsgPackBinary, which would need the
+// whole blob contiguous in RAM. Only the spectrum comes after it. 'ranges'
+// is the binary format's range blocks. The map header is a fixmap up to 15
+// entries and a map16 past that (a capture with every optional key has 16).
+#define WAVEFORM_MSGPACK_CONTENT_TYPE "application/msgpack"
+
+class WaveformMsgPackStream : public PieceStream {
+  public:
+    explicit WaveformMsgPackStream(const CaptureView& capture) : PieceStream(capture) {}
+
+  protected:
+    bool writePiece(Print& out, int index) override;
+};
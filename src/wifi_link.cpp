@@ -0,0 +1,131 @@
+#include "wifi_link.h"
+
+namespace {
+
+const uint32_t WIFI_CACHE_MAGIC = 0x31465743;  // "CWF1"
+
+// Word-aligned for rtcUserMemoryRead/Write
+struct WifiCache {
+  uint32_t magic;
+  uint8_t  bssid[6];
+  uint8_t  channel;
+  uint8_t  reserved;
+  uint32_t ip, gateway, netmask, dns;
+  uint32_t crc;
+};
+
+static_assert(sizeof(WifiCache) % 4 == 0, "RTC memory is accessed in words");
+
+// FNV-1a is plenty to reject garbage after a power cycle
+uint32_t cacheCrc(const WifiCache& c) {
+  uint32_t h = 2166136261UL;
+  const uint8_t* p = (const uint8_t*)&c;
+  for (size_t i = 0; i < offsetof(WifiCache, crc); i++) h = (h ^ p[i]) * 16777619UL;
+  return h;
+}
+
+bool loadCache(WifiCache& c) {
+  return ESP.rtcUserMemoryRead(WIFI_RTC_OFFSET, (uint32_t*)&c, sizeof(c)) &&
+         c.magic == WIFI_CACHE_MAGIC && c.crc == cacheCrc(c) && c.channel >= 1 && c.channel <= 14;
+}
+
+void clearCache() {
+  WifiCache c = {};
+  ESP.rtcUserMemoryWrite(WIFI_RTC_OFFSET, (uint32_t*)&c, sizeof(c));
+}
+
+}  // namespace
+
+bool WifiLink::beginFast() {
+  WifiCache c;
+  if (!loadCache(c)) return false;
+  WiFi.config(IPAddress(c.ip), IPAddress(c.gateway), IPAddress(c.netmask), IPAddress(c.dns));
+  WiFi.begin(ssid, pass, c.channel, c.bssid, true);
+  state = LINK_FAST;
+  return true;
+}
+
+void WifiLink::beginScan() {
+  WiFi.disconnect();
+  WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));  // back to DHCP
+  WiFi.begin(ssid, pass);
+  scanAt = millis();
+  state = LINK_SCAN;
+}
+
+void WifiLink::connected(unsigned long now) {
+  fastConnected = state == LINK_FAST;
+  connectMs = now - attemptAt;
+  state = LINK_UP;
+
+  WifiCache c = {};
+  c.magic = WIFI_CACHE_MAGIC;
+  memcpy(c.bssid, WiFi.BSSID(), sizeof(c.bssid));
+  c.channel = (uint8_t)WiFi.channel();
+  c.ip      = (uint32_t)WiFi.localIP();
+  c.gateway = (uint32_t)WiFi.gatewayIP();
+  c.netmask = (uint32_t)WiFi.subnetMask();
+  c.dns     = (uint32_t)WiFi.dnsIP();
+  c.crc     = cacheCrc(c);
+  ESP.rtcUserMemoryWrite(WIFI_RTC_OFFSET, (uint32_t*)&c, sizeof(c));
+  Serial.printf("Wi-Fi connected in %lums (%s), channel %u\n",
+                connectMs, fastConnected ? "cached AP" : "scan", c.channel);
+}
+
+void WifiLink::begin(const char* ssidArg, const char* passArg) {
+  ssid = ssidArg;
+  pass = passArg;
+  // The cache replaces the SDK's own flash copy of the credentials, and the
+  // core's auto-reconnect would race poll()
+  WiFi.persistent(false);
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(false);
+
+  attemptAt = millis();
+  if (!beginFast()) beginScan();
+}
+
+bool WifiLink::wait(unsigned long timeoutMs) {
+  while (millis() - attemptAt < timeoutMs) {
+    if (poll(millis())) return true;
+    delay(50);
+  }
+  return false;
+}
+
+bool WifiLink::connect(const char* ssidArg, const char* passArg, unsigned long timeoutMs) {
+  begin(ssidArg, passArg);
+  return wait(timeoutMs);
+}
+
+bool WifiLink::poll(unsigned long now) {
+  bool up = WiFi.status() == WL_CONNECTED;
+  switch (state) {
+    case LINK_UP:
+      if (up) return true;
+      // Dropped: try the same AP and lease right away
+      attemptAt = now;
+      if (!beginFast()) beginScan();
+      return false;
+    case LINK_FAST:
+      if (up) {
+        connected(now);
+        return true;
+      }
+      if (now - attemptAt >= WIFI_FAST_TIMEOUT_MS) {
+        // AP moved channel, lease went elsewhere, or the AP is gone
+        Serial.println("! Cached Wi-Fi AP didn't answer, scanning");
+        clearCache();
+        beginScan();
+      }
+      return false;
+    case LINK_SCAN:
+      if (up) {
+        connected(now);
+        return true;
+      }
+      if (now - scanAt >= WIFI_SCAN_RETRY_MS) beginScan();
+      return false;
+  }
+  return up;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+// -- Wi-Fi link ---------------------------------------------------------------
+// A plain WiFi.begin(ssid, pass) scans every channel before associating, which
+// costs several seconds per connect. After each successful connect the AP's
+// BSSID and channel and our DHCP lease are cached in RTC user memory
+// (survives every reset except a power cycle, like the calibration), and the
+// next connect goes straight to that AP with the lease as a static IP -
+// typically a few hundred ms. If the fast path hasn't connected within
+// WIFI_FAST_TIMEOUT_MS the cache is dropped and it falls back to a full scan
+// with DHCP.
+//
+// poll() does the same in place when the link drops: sampling and the
+// journal carry on, and it keeps retrying (fast path once, then scans every
+// WIFI_SCAN_RETRY_MS) instead of rebooting.
+#define WIFI_RTC_OFFSET       48     // words, after the calibration record
+#define WIFI_FAST_TIMEOUT_MS  1500
+#define WIFI_SCAN_RETRY_MS    20000
+
+class WifiLink {
+  public:
+    // Start associating and return at once; the SDK carries on whenever the
+    // caller yields (delay(), I2C waits), so setup() brings the sensor up
+    // meanwhile and then wait()s for the link.
+    void begin(const char* ssid, const char* pass);
+    // Block until connected. False if nothing connected within timeoutMs of begin().
+    bool wait(unsigned long timeoutMs);
+    // begin() and wait() back to back
+    bool connect(const char* ssid, const char* pass, unsigned long timeoutMs);
+
+    // Call every loop pass; true while connected. Never blocks.
+    bool poll(unsigned long now);
+
+    bool usedFastPath() const { return fastConnected; }
+    unsigned long lastConnectMs() const { return connectMs; }   // begin() to connected
+
+  private:
+    enum State : uint8_t { LINK_UP, LINK_FAST, LINK_SCAN };
+
+    bool beginFast();       // false if there is no valid cache
+    void beginScan();
+    void connected(unsigned long now);   // refresh the cache, log the timing
+
+    const char*   ssid = nullptr;
+    const char*   pass = nullptr;
+    State         state = LINK_SCAN;
+    unsigned long attemptAt = 0;        // link lost / connect() called
+    unsigned long scanAt = 0;           // latest full scan started
+    unsigned long connectMs = 0;
+    bool          fastConnected = false;
+};
@@ -0,0 +1,36 @@
+// ArduinoJson benchmark on the device: pio test -e nodemcuv2_bench
+// Same fixtures and figures as lib/ArduinoJson/extras/benchmark on the host,
+// including writes per document straight to a socket and through a
+// BufferedWriter (one lwIP call, and a segment, each).
+// The waveforms stop at 300 samples: a 1200-sample document alone (~48KB of
+// slots) is more than the ESP8266 heap.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "Benchmark.hpp"
+
+static void print(const benchmark::Result& r) {
+  Serial.printf("%-9s %5u  %-18s %6u B %9.1f op/s %6.3f MB/s %4u allocs %6u peak %6u doc",
+                r.fixture, (unsigned)r.samples, r.operation, (unsigned)r.bytes,
+                r.opsPerSecond(), r.megabytesPerSecond(), (unsigned)r.allocations,
+                (unsigned)r.peakBytes, (unsigned)r.documentBytes);
+  // "json to socket" / "json buffered": TCP segments per document, Nagle off
+  if (r.writes) Serial.printf(" %4u writes", (unsigned)r.writes);
+  Serial.println();
+}
+
+static void test_benchmark() {
+  const size_t waveformSizes[] = {120, 300};
+  Serial.printf("Free heap %u\n", ESP.getFreeHeap());
+  TEST_ASSERT_TRUE(benchmark::runAll(waveformSizes, 2, 200000UL, print));
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(2000);  // let the test runner open the port
+  UNITY_BEGIN();
+  RUN_TEST(test_benchmark);
+  UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,206 @@
+// Per-stage cycle counts on the board: pio test -e nodemcuv2_pipeline_bench -v
+// Each stage runs over the same canned capture (test/host/waveforms.h) and
+// reports ESP.getCycleCount() per sample, one table row per stage, so two
+// builds compare line by line. The I2C rows need the MPU6050 wired as in the
+// firmware (SDA D2, SCL D1) and are skipped without it.
+#include <Arduino.h>
+#include <Wire.h>
+#include <unity.h>
+
+#include "MPU6050.h"
+#include "capture_arena.h"
+#include "detector.h"
+#include "waveform_stream.h"
+#include "../host/waveforms.h"
+
+#ifndef I2C_CLOCK_HZ
+    #define I2C_CLOCK_HZ 400000
+#endif
+
+namespace {
+
+const int SAMPLES    = 600;     // 6s at 100Hz; the arena and FIFO image fit the free heap
+const int I2C_READS  = 200;
+const int ROUNDS     = 5;
+
+CaptureArena arena;
+uint8_t*     fifoImage;          // the capture as the FIFO hands it out, big-endian
+MPU6050      mpu;
+volatile int32_t sink;          // keeps the de-bias loops from being optimized out
+
+void row(const char* stage, uint32_t cycles, uint32_t samples) {
+  float perSample = (float)cycles / samples;
+  Serial.printf("| %-22s | %9.1f | %8.2f |\n", stage, perSample, perSample / ESP.getCpuFreqMHz());
+}
+
+void skipped(const char* stage, const char* why) {
+  Serial.printf("| %-22s | %9s | %8s | %s\n", stage, "-", "-", why);
+}
+
+// The detection pre-filter of a stage: none, the /api/init 0.1Hz high-pass, or a band-pass
+enum StageFilter { RAW, HIGH_PASS, BAND_PASS };
+
+void detectStage(const char* stage, TriggerMode mode, StageFilter filter, DetectMetric metric = METRIC_MAX_ABS,
+                 bool specialized = true) {
+  EventDetector detector;
+  detector.setThresholds(573, 1638, 8192);
+  detector.setMetric(metric);
+  detector.setTriggerMode(mode);
+  detector.setWindow(300, 300, 1200, 100);
+  if (mode != TRIGGER_MODE_THRESHOLD) detector.staLta().begin(WAVEFORM_RATE_HZ, 500, 30000, 4.0f, 1.5f);
+  if (filter == HIGH_PASS) detector.setFilter(WAVEFORM_RATE_HZ, 0.1f, 0);
+  if (filter == BAND_PASS) detector.setFilter(WAVEFORM_RATE_HZ, 0.5f, 20.0f);
+  detector.setSpecialized(specialized);
+  uint32_t total = 0;
+  for (int r = 0; r < ROUNDS; r++) {
+    uint32_t seq0 = arena.written() - SAMPLES;
+    uint32_t t0 = ESP.getCycleCount();
+    for (int i = 0; i < SAMPLES; i++) {
+      WaveSample s = arena.at(seq0 + i);
+      int32_t dx = s.x, dy = s.y, dz = s.z - WAVEFORM_1G_LSB;
+      detector.process(seq0 + i, i + 1, dx, dy, dz);
+    }
+    total += ESP.getCycleCount() - t0;
+    yield();
+  }
+  row(stage, total, ROUNDS * SAMPLES);
+}
+
+void bodyStage(const char* stage, PieceStream& body) {
+  static char chunk[PIECE_BUFFER_SIZE];
+  uint32_t total = 0;
+  size_t bytes = 0;
+  for (int r = 0; r < ROUNDS; r++) {
+    body.rewind();
+    uint32_t t0 = ESP.getCycleCount();
+    size_t n;
+    while ((n = body.readBytes(chunk, sizeof(chunk))) > 0) bytes += n;
+    total += ESP.getCycleCount() - t0;
+    yield();
+  }
+  row(stage, total, ROUNDS * SAMPLES);
+  TEST_ASSERT_TRUE(bytes > 0);
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+static void test_acquisition_stages() {
+  // --- I2C: three single-register reads against one 6-byte burst ---
+  if (!mpu.testConnection()) {
+    skipped("i2c axis reads", "no MPU6050");
+    skipped("i2c burst", "no MPU6050");
+  } else {
+    int16_t x, y, z;
+    uint32_t t0 = ESP.getCycleCount();
+    for (int i = 0; i < I2C_READS; i++) {
+      x = mpu.getAccelerationX();
+      y = mpu.getAccelerationY();
+      z = mpu.getAccelerationZ();
+    }
+    row("i2c axis reads", ESP.getCycleCount() - t0, I2C_READS);
+    t0 = ESP.getCycleCount();
+    for (int i = 0; i < I2C_READS; i++) mpu.getAcceleration(&x, &y, &z);
+    row("i2c burst", ESP.getCycleCount() - t0, I2C_READS);
+    sink = x + y + z;
+  }
+
+  // --- Unpacking a FIFO block that was already read ---
+  static int16_t bx[SAMPLES], by[SAMPLES], bz[SAMPLES];
+  uint32_t t0 = ESP.getCycleCount();
+  for (int r = 0; r < ROUNDS; r++) MPU6050_Base::unpackAccelFIFO(fifoImage, SAMPLES, bx, by, bz);
+  row("fifo unpack", ESP.getCycleCount() - t0, ROUNDS * SAMPLES);
+
+  // --- De-bias: the float form, and the int32 one processSample() uses ---
+  const float biasF[3] = { 12.4f, -31.7f, 16391.2f };
+  const int32_t biasL[3] = { 12, -32, 16391 };
+  t0 = ESP.getCycleCount();
+  for (int i = 0; i < SAMPLES; i++) {
+    float dx = bx[i] - biasF[0], dy = by[i] - biasF[1], dz = bz[i] - biasF[2];
+    sink = (int32_t)fmaxf(fabsf(dx), fmaxf(fabsf(dy), fabsf(dz)));
+  }
+  row("de-bias float", ESP.getCycleCount() - t0, SAMPLES);
+  t0 = ESP.getCycleCount();
+  for (int i = 0; i < SAMPLES; i++) {
+    int32_t dx = bx[i] - biasL[0], dy = by[i] - biasL[1], dz = bz[i] - biasL[2];
+    sink = max(abs(dx), max(abs(dy), abs(dz)));
+  }
+  row("de-bias fixed", ESP.getCycleCount() - t0, SAMPLES);
+}
+
+// Each specialized pipeline (EventDetector::select()), then the per-metric
+// step the same configuration would otherwise run
+static void test_detection_stages() {
+  detectStage("trigger threshold", TRIGGER_MODE_THRESHOLD, RAW);
+  detectStage("trigger threshold, hp", TRIGGER_MODE_THRESHOLD, HIGH_PASS);
+  detectStage("trigger vector, hp", TRIGGER_MODE_THRESHOLD, HIGH_PASS, METRIC_VECTOR);
+  detectStage("trigger gravity v, hp", TRIGGER_MODE_THRESHOLD, HIGH_PASS, METRIC_GRAVITY_VERTICAL);
+  detectStage("trigger sta/lta, hp", TRIGGER_MODE_STA_LTA, HIGH_PASS);
+  detectStage("trigger both, bp", TRIGGER_MODE_BOTH, BAND_PASS);
+  detectStage("per-metric threshold", TRIGGER_MODE_THRESHOLD, RAW, METRIC_MAX_ABS, false);
+  detectStage("per-metric thresh, hp", TRIGGER_MODE_THRESHOLD, HIGH_PASS, METRIC_MAX_ABS, false);
+  detectStage("per-metric vector, hp", TRIGGER_MODE_THRESHOLD, HIGH_PASS, METRIC_VECTOR, false);
+  detectStage("per-metric grav v, hp", TRIGGER_MODE_THRESHOLD, HIGH_PASS, METRIC_GRAVITY_VERTICAL, false);
+  detectStage("per-metric sta/lta, hp", TRIGGER_MODE_STA_LTA, HIGH_PASS, METRIC_MAX_ABS, false);
+  detectStage("per-metric both, bp", TRIGGER_MODE_BOTH, BAND_PASS, METRIC_MAX_ABS, false);
+}
+
+static void test_upload_stages() {
+  CaptureView cap = {};
+  cap.deviceId     = "AA:BB:CC:DD:EE:FF";
+  cap.level        = "moderate";
+  cap.arena        = &arena;
+  cap.firstSeq     = arena.written() - SAMPLES;
+  cap.preCount     = 100;
+  cap.postCount    = SAMPLES - 100;
+  cap.biasZ        = WAVEFORM_1G_LSB;
+  cap.scale        = WAVEFORM_1G_LSB;
+  cap.sampleRateHz = WAVEFORM_RATE_HZ;
+  WaveformBinaryStream binary(cap);
+  WaveformBinaryStream delta(cap, true);
+  WaveformJsonStream json(cap);
+  WaveformMsgPackStream msgpack(cap);
+  bodyStage("serialize binary", binary);
+  bodyStage("serialize delta", delta);
+  bodyStage("serialize json", json);
+  bodyStage("msgpack encode", msgpack);
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(2000);  // let the test runner open the port
+
+  Wire.begin(D2, D1);
+  Wire.setClock(I2C_CLOCK_HZ);
+  mpu.setAccelOnlyProfile(WAVEFORM_RATE_HZ, MPU6050_DLPF_BW_42, MPU6050_ACCEL_FS_2, false);
+
+  // The canned capture: 1s at rest, then the event
+  WaveformRecorder rec;
+  arena.begin(SAMPLES);
+  fifoImage = new uint8_t[SAMPLES * 6];
+  for (int i = 0; i < SAMPLES; i++) {
+    RecordedSample s = i < WAVEFORM_RATE_HZ ? rec.quiet() : rec.quake(i - WAVEFORM_RATE_HZ, 3000);
+    arena.push(s.x, s.y, s.z);
+    const int16_t v[3] = { s.x, s.y, s.z };
+    for (int a = 0; a < 3; a++) {
+      fifoImage[i * 6 + a * 2]     = (uint8_t)(v[a] >> 8);
+      fifoImage[i * 6 + a * 2 + 1] = (uint8_t)v[a];
+    }
+  }
+
+  Serial.printf("\n%s, SDK %s, %u MHz, I2C %lukHz, free heap %u\n", __DATE__ " " __TIME__,
+                ESP.getSdkVersion(), ESP.getCpuFreqMHz(), (unsigned long)I2C_CLOCK_HZ / 1000UL,
+                ESP.getFreeHeap());
+  Serial.printf("| %-22s | %9s | %8s |\n", "stage", "cyc/smp", "us/smp");
+  Serial.println("|------------------------|-----------|----------|");
+
+  UNITY_BEGIN();
+  RUN_TEST(test_acquisition_stages);
+  RUN_TEST(test_detection_stages);
+  RUN_TEST(test_upload_stages);
+  UNITY_END();
+}
+
+void loop() {}
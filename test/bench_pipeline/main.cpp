@@ -0,0 +1,119 @@
+// Detection pipeline and upload serializer timings on the host:
+// pio test -e native -f bench_pipeline -v
+// Figures are ns per sample on the build machine; they rank changes to the
+// per-sample path, they are not what the ESP8266 takes.
+#include <unity.h>
+
+#include <vector>
+
+#include "capture_arena.h"
+#include "detector.h"
+#include "waveform_stream.h"
+#include "waveforms.h"
+
+namespace {
+
+const int SAMPLES = 1000000;
+const int CAPTURE = 1500;       // 3s + 12s at 100Hz, the longest window
+const int ROUNDS  = 200;
+
+// A minute at rest, then a 20s event, over and over: mostly the idle path,
+// with enough captures to time the capturing one too
+std::vector<RecordedSample> record() {
+  WaveformRecorder rec;
+  std::vector<RecordedSample> out;
+  out.reserve(SAMPLES);
+  while ((int)out.size() < SAMPLES) {
+    for (int i = 0; i < 60 * WAVEFORM_RATE_HZ; i++) out.push_back(rec.quiet());
+    for (int i = 0; i < 20 * WAVEFORM_RATE_HZ; i++) out.push_back(rec.quake(i, 3000));
+  }
+  out.resize(SAMPLES);
+  return out;
+}
+
+void benchDetector(const char* name, TriggerMode mode, const std::vector<RecordedSample>& samples,
+                   bool specialized = true) {
+  EventDetector detector;
+  detector.setThresholds(573, 1638, 8192);
+  detector.setTriggerMode(mode);
+  detector.setWindow(300, 300, 1200, 100);
+  if (mode != TRIGGER_MODE_THRESHOLD) detector.staLta().begin(WAVEFORM_RATE_HZ, 500, 30000, 4.0f, 1.5f);
+  if (mode == TRIGGER_MODE_BOTH) detector.setFilter(WAVEFORM_RATE_HZ, 0.5f, 20.0f);
+  detector.setSpecialized(specialized);
+
+  int captures = 0;
+  unsigned long t0 = micros();
+  for (int i = 0; i < SAMPLES; i++) {
+    int32_t dx = samples[i].x, dy = samples[i].y, dz = samples[i].z - WAVEFORM_1G_LSB;
+    if (detector.process((uint32_t)i, min(i + 1, 300), dx, dy, dz) == DETECT_FINISHED) captures++;
+  }
+  unsigned long us = micros() - t0;
+  printf("detect %-22s %8.1f ns/sample  %d captures\n", name, us * 1000.0 / SAMPLES, captures);
+  TEST_ASSERT_TRUE(captures > 0);
+}
+
+void benchBody(const char* name, PieceStream& body) {
+  static char sink[PIECE_BUFFER_SIZE * 4];
+  size_t bytes = 0;
+  unsigned long t0 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    body.rewind();
+    size_t n;
+    while ((n = body.readBytes(sink, sizeof(sink))) > 0) bytes += n;
+  }
+  unsigned long us = micros() - t0;
+  printf("upload %-22s %8.1f ns/sample  %zu B\n", name, us * 1000.0 / ((double)ROUNDS * CAPTURE),
+         bytes / ROUNDS);
+  TEST_ASSERT_TRUE(bytes > 0);
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+static void test_detector() {
+  std::vector<RecordedSample> samples = record();
+  benchDetector("threshold", TRIGGER_MODE_THRESHOLD, samples);
+  benchDetector("sta/lta", TRIGGER_MODE_STA_LTA, samples);
+  benchDetector("both, band-pass", TRIGGER_MODE_BOTH, samples);
+  benchDetector("threshold, per-metric", TRIGGER_MODE_THRESHOLD, samples, false);
+  benchDetector("sta/lta, per-metric", TRIGGER_MODE_STA_LTA, samples, false);
+  benchDetector("both, bp, per-metric", TRIGGER_MODE_BOTH, samples, false);
+}
+
+static void test_serializers() {
+  CaptureArena arena;
+  arena.begin(CAPTURE);
+  WaveformRecorder rec;
+  for (int i = 0; i < CAPTURE; i++) {
+    RecordedSample s = i < 300 ? rec.quiet() : rec.quake(i - 300, 3000);
+    arena.push(s.x, s.y, s.z);
+  }
+  CaptureView cap = {};
+  cap.deviceId     = "AA:BB:CC:DD:EE:FF";
+  cap.level        = "moderate";
+  cap.arena        = &arena;
+  cap.firstSeq     = arena.written() - CAPTURE;
+  cap.preCount     = 300;
+  cap.postCount    = CAPTURE - 300;
+  cap.biasZ        = WAVEFORM_1G_LSB;
+  cap.scale        = WAVEFORM_1G_LSB;
+  cap.sampleRateHz = WAVEFORM_RATE_HZ;
+
+  WaveformBinaryStream binary(cap);
+  WaveformBinaryStream delta(cap, true);
+  WaveformJsonStream json(cap);
+  WaveformMsgPackStream msgpack(cap);
+  benchBody("binary", binary);
+  benchBody("delta", delta);
+  benchBody("json", json);
+  benchBody("msgpack", msgpack);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_detector);
+  RUN_TEST(test_serializers);
+  return UNITY_END();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+// Host stand-in for the few Arduino core pieces the portable modules use
+// (detector, biquad, sta_lta, spectrum, capture_arena, waveform_stream), so
+// they build unchanged in [env:native]. Not a core: anything the firmware
+// proper needs (WiFi, Serial, ESP) is deliberately missing.
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <type_traits>
+
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type min(A a, B b) { return a < b ? a : b; }
+
+template <typename A, typename B>
+inline typename std::common_type<A, B>::type max(A a, B b) { return a > b ? a : b; }
+
+template <typename T, typename L, typename H>
+inline T constrain(T v, L lo, H hi) { return v < lo ? (T)lo : v > hi ? (T)hi : v; }
+
+inline unsigned long micros() {
+  using namespace std::chrono;
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline unsigned long millis() { return micros() / 1000; }
+
+// Print with the number formatting of the ESP8266 core: integers in decimal,
+// floats in fixed notation with 'digits' decimals
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+      size_t n = 0;
+      while (size--) n += write(*buffer++);
+      return n;
+    }
+
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int n) { return format("%d", n); }
+    size_t print(unsigned n) { return format("%u", n); }
+    size_t print(long n) { return format("%ld", n); }
+    size_t print(unsigned long n) { return format("%lu", n); }
+    size_t print(double x, int digits = 2) { return format("%.*f", digits, x); }
+
+  private:
+    template <typename... T>
+    size_t format(const char* fmt, T... args) {
+      char buf[32];
+      int n = snprintf(buf, sizeof(buf), fmt, args...);
+      return n > 0 ? write((const uint8_t*)buf, (size_t)min(n, (int)sizeof(buf) - 1)) : 0;
+    }
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual size_t readBytes(char* buffer, size_t length) = 0;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+// Deterministic waveforms for the native tests and benchmarks, in raw +/-2g
+// LSB on a 100Hz grid, shaped like what the sensor records: the noise floor
+// of a board at rest (~4 LSB RMS per axis, 1g on Z), and an event of a P
+// arrival followed by a larger, longer S train. Same seed, same samples.
+#include <Arduino.h>
+#include <math.h>
+
+#define WAVEFORM_RATE_HZ 100
+#define WAVEFORM_1G_LSB  16384
+
+struct RecordedSample {
+  int16_t x, y, z;
+};
+
+class WaveformRecorder {
+  public:
+    explicit WaveformRecorder(uint32_t seed = 1) : seed(seed) {}
+
+    // Noise floor only
+    RecordedSample quiet() { return at(0, 0, 0); }
+
+    // Sample i of an event starting at sample 0, peak amplitude peakLsb on
+    // the horizontals: a 0.5s P pulse at 8Hz, then from 1s an S train at
+    // 3Hz decaying over ~4s
+    RecordedSample quake(int i, float peakLsb) {
+      float t = (float)i / WAVEFORM_RATE_HZ;
+      float p = t < 0.5f ? 0.3f * sinf(2 * (float)M_PI * 8 * t) * sinf((float)M_PI * t / 0.5f) : 0;
+      float s = t >= 1 ? sinf(2 * (float)M_PI * 3 * (t - 1)) * expf(-(t - 1) / 4) * fminf(1, (t - 1) * 4) : 0;
+      return at(peakLsb * (s + 0.2f * p), peakLsb * (0.7f * s), peakLsb * (0.3f * s + p));
+    }
+
+  private:
+    // Sum of four uniforms, roughly gaussian, ~4 LSB RMS
+    float noise() {
+      float sum = 0;
+      for (int k = 0; k < 4; k++) {
+        seed = seed * 1664525u + 1013904223u;
+        sum += (float)(seed >> 16) / 65536.0f - 0.5f;
+      }
+      return sum * 7;
+    }
+
+    RecordedSample at(float x, float y, float z) {
+      return { clip(x + noise()), clip(y + noise()), clip(WAVEFORM_1G_LSB + z + noise()) };
+    }
+
+    static int16_t clip(float v) {
+      return (int16_t)constrain(lroundf(v), -32768L, 32767L);
+    }
+
+    uint32_t seed;
+};
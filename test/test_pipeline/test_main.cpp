@@ -0,0 +1,728 @@
+// Detection pipeline and upload serializers on the host: pio test -e native
+#include <unity.h>
+
+#include "bias_estimator.h"
+#include "capture_arena.h"
+#include "detector.h"
+#include "dual_sensor.h"
+#include "init_config.h"
+#include "ready_ring.h"
+#include "waveform_stream.h"
+#include "waveforms.h"
+
+namespace {
+
+// The firmware defaults (/api/init): 0.035 / 0.1 / 0.5 g, 3s + 3..12s
+const int32_t MINOR_LSB    = 573;
+const int32_t MODERATE_LSB = 1638;
+const int32_t SEVERE_LSB   = 8192;
+const int PRE = 300, POST = 300, MAX_POST = 1200, QUIET = 100;
+
+EventDetector detector;
+CaptureArena arena;
+
+void setUpDetector(TriggerMode mode) {
+  detector = EventDetector();
+  detector.setThresholds(MINOR_LSB, MODERATE_LSB, SEVERE_LSB);
+  detector.setTriggerMode(mode);
+  detector.setWindow(PRE, POST, MAX_POST, QUIET);
+  if (mode != TRIGGER_MODE_THRESHOLD) detector.staLta().begin(WAVEFORM_RATE_HZ, 500, 30000, 4.0f, 1.5f);
+  arena.begin(PRE + MAX_POST);
+}
+
+// processSample() minus the side effects: push, de-bias, detect
+DetectResult feed(RecordedSample s) {
+  arena.push(s.x, s.y, s.z);
+  int32_t dx = s.x, dy = s.y, dz = s.z - WAVEFORM_1G_LSB;
+  return detector.process(arena.written() - 1, arena.count(), dx, dy, dz);
+}
+
+// Every sample of a body, as the socket would get it
+class BodyReader {
+  public:
+    explicit BodyReader(PieceStream& body) {
+      size_t n = body.measure();
+      data = new uint8_t[n + 1];
+      length = body.readBytes((char*)data, n);
+      data[length] = 0;
+      TEST_ASSERT_EQUAL_UINT32(n, length);
+    }
+    ~BodyReader() { delete[] data; }
+
+    template <typename T>
+    T at(size_t offset) const {
+      T v;
+      memcpy(&v, data + offset, sizeof(v));
+      return v;
+    }
+
+    uint8_t* data;
+    size_t   length;
+};
+
+CaptureView viewOf(const CaptureArena& a, int count) {
+  CaptureView cap = {};
+  cap.deviceId     = "AA:BB:CC:DD:EE:FF";
+  cap.level        = "minor";
+  cap.arena        = &a;
+  cap.firstSeq     = a.written() - (uint32_t)count;
+  cap.preCount     = count / 2;
+  cap.postCount    = count - count / 2;
+  cap.biasZ        = WAVEFORM_1G_LSB;
+  cap.scale        = WAVEFORM_1G_LSB;
+  cap.sampleRateHz = WAVEFORM_RATE_HZ;
+  return cap;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+static void test_quiet_never_triggers() {
+  setUpDetector(TRIGGER_MODE_BOTH);
+  WaveformRecorder rec;
+  for (int i = 0; i < 60 * WAVEFORM_RATE_HZ; i++) TEST_ASSERT_EQUAL(DETECT_IDLE, feed(rec.quiet()));
+  TEST_ASSERT_FALSE(detector.capturing());
+}
+
+static void test_threshold_capture_window() {
+  setUpDetector(TRIGGER_MODE_THRESHOLD);
+  WaveformRecorder rec;
+  for (int i = 0; i < 100; i++) feed(rec.quiet());   // less history than PRE
+  int started = -1, finished = -1;
+  for (int i = 0; i < 2000 && finished < 0; i++) {
+    DetectResult r = feed(rec.quake(i, 4000));
+    if (r == DETECT_STARTED) started = i;
+    if (r == DETECT_FINISHED) finished = i;
+  }
+  TEST_ASSERT_TRUE(started >= 0);
+  TEST_ASSERT_TRUE(finished > started);
+  const DetectedCapture& c = detector.capture();
+  TEST_ASSERT_EQUAL(TRIGGER_THRESHOLD, c.trigger);
+  TEST_ASSERT_EQUAL(100 + started + 1, c.preCount);    // everything up to the trigger
+  TEST_ASSERT_EQUAL_UINT32(0, c.firstSeq);
+  TEST_ASSERT_EQUAL(finished - started, c.postCount);
+  TEST_ASSERT_TRUE(c.postCount >= POST && c.postCount <= MAX_POST);
+  TEST_ASSERT_EQUAL(LEVEL_MODERATE, c.level);
+  TEST_ASSERT_TRUE(c.peakLsb > 3000);
+  TEST_ASSERT_FALSE(detector.capturing());
+}
+
+static void test_retrigger_extends_up_to_max() {
+  setUpDetector(TRIGGER_MODE_THRESHOLD);
+  WaveformRecorder rec;
+  for (int i = 0; i < PRE; i++) feed(rec.quiet());
+  // A burst every 2.5s keeps the window open until MAX_POST
+  int retriggers = 0, post = 0;
+  DetectResult r = DETECT_IDLE;
+  for (int i = 0; i < 10000 && r != DETECT_FINISHED; i++) {
+    RecordedSample s = rec.quiet();
+    if (i % 250 < 3) s.x += 2000;
+    r = feed(s);
+    if (r == DETECT_RETRIGGERED) retriggers++;
+    if (r >= DETECT_CAPTURING) post++;
+  }
+  const DetectedCapture& c = detector.capture();
+  TEST_ASSERT_EQUAL(DETECT_FINISHED, r);
+  TEST_ASSERT_EQUAL(MAX_POST, c.postCount);
+  TEST_ASSERT_EQUAL(post, c.postCount);
+  TEST_ASSERT_EQUAL(retriggers, c.retriggerCount);
+  TEST_ASSERT_EQUAL(4, c.retriggerCount);               // at 2.5, 5, 7.5 and 10s
+  TEST_ASSERT_EQUAL(c.preCount - 1 + 250, c.retriggers[0]);
+}
+
+static void test_sta_lta_fires_below_minor() {
+  setUpDetector(TRIGGER_MODE_STA_LTA);
+  WaveformRecorder rec;
+  for (int i = 0; i < 40 * WAVEFORM_RATE_HZ; i++) TEST_ASSERT_EQUAL(DETECT_IDLE, feed(rec.quiet()));
+  bool started = false;
+  for (int i = 0; i < 500 && !started; i++) started = feed(rec.quake(i, 300)) == DETECT_STARTED;
+  TEST_ASSERT_TRUE(started);
+  TEST_ASSERT_EQUAL(TRIGGER_STA_LTA, detector.capture().trigger);
+  TEST_ASSERT_TRUE(detector.capture().peakLsb < MINOR_LSB);
+}
+
+// 400 LSB on every axis: 400 on max-abs, 693 as a vector, only the latter over minor
+static void test_vector_metric_sees_a_diagonal() {
+  const DetectMetric metrics[] = { METRIC_MAX_ABS, METRIC_VECTOR, METRIC_HORIZONTAL, METRIC_VERTICAL };
+  for (DetectMetric m : metrics) {
+    setUpDetector(TRIGGER_MODE_THRESHOLD);
+    detector.setMetric(m);
+    WaveformRecorder rec;
+    for (int i = 0; i < PRE; i++) TEST_ASSERT_EQUAL(DETECT_IDLE, feed(rec.quiet()));
+    RecordedSample s = rec.quiet();
+    s.x += 400;
+    s.y += 400;
+    s.z += 400;
+    TEST_ASSERT_EQUAL(m == METRIC_VECTOR ? DETECT_STARTED : DETECT_IDLE, feed(s));
+    TEST_ASSERT_EQUAL(m == METRIC_VECTOR, detector.reached(LEVEL_MINOR));
+  }
+  // The peak is back in linear LSB, and Z alone counts for vertical
+  setUpDetector(TRIGGER_MODE_THRESHOLD);
+  detector.setMetric(METRIC_VECTOR);
+  WaveformRecorder rec;
+  RecordedSample s = rec.quiet();
+  s.x += 400;
+  s.y += 400;
+  s.z += 400;
+  feed(s);
+  TEST_ASSERT_INT_WITHIN(20, 693, detector.capture().peakLsb);
+  TEST_ASSERT_EQUAL(LEVEL_MINOR, detector.capture().level);
+  setUpDetector(TRIGGER_MODE_THRESHOLD);
+  detector.setMetric(METRIC_VERTICAL);
+  s = rec.quiet();
+  s.x += 2000;
+  TEST_ASSERT_EQUAL(DETECT_IDLE, feed(s));
+  s = rec.quiet();
+  s.z += 2000;
+  TEST_ASSERT_EQUAL(DETECT_STARTED, feed(s));
+  TEST_ASSERT_EQUAL(LEVEL_MODERATE, detector.capture().level);
+}
+
+// Mounted at 45 degrees in X/Z: motion along "up" is vertical, not Z
+static void test_gravity_metrics_follow_the_mount() {
+  const int16_t up[3] = { 11585, 0, 11585 };
+  const DetectMetric metrics[] = { METRIC_VERTICAL, METRIC_GRAVITY_VERTICAL, METRIC_GRAVITY_HORIZONTAL };
+  for (DetectMetric m : metrics) {
+    setUpDetector(TRIGGER_MODE_THRESHOLD);
+    detector.setMetric(m);
+    detector.setGravity(up);
+    WaveformRecorder rec;
+    RecordedSample s = rec.quiet();
+    s.x += 500;
+    s.z += 500;
+    TEST_ASSERT_EQUAL(m == METRIC_GRAVITY_VERTICAL ? DETECT_STARTED : DETECT_IDLE, feed(s));
+    if (m == METRIC_GRAVITY_VERTICAL) TEST_ASSERT_INT_WITHIN(20, 707, detector.capture().peakLsb);
+  }
+  // Across it: all horizontal
+  setUpDetector(TRIGGER_MODE_THRESHOLD);
+  detector.setMetric(METRIC_GRAVITY_HORIZONTAL);
+  detector.setGravity(up);
+  WaveformRecorder rec;
+  RecordedSample s = rec.quiet();
+  s.x += 500;
+  s.z -= 500;
+  TEST_ASSERT_EQUAL(DETECT_STARTED, feed(s));
+  TEST_ASSERT_INT_WITHIN(20, 707, detector.capture().peakLsb);
+}
+
+// A specialized pipeline decides sample for sample what the per-metric step does
+static void test_specialized_pipeline_matches_per_metric() {
+  const struct { DetectMetric metric; TriggerMode mode; float lpHz; } configs[] = {
+    { METRIC_MAX_ABS, TRIGGER_MODE_BOTH, 20.0f },
+    { METRIC_VECTOR, TRIGGER_MODE_THRESHOLD, 0 },
+    { METRIC_MAX_ABS, TRIGGER_MODE_STA_LTA, 0 },
+  };
+  for (const auto& c : configs) {
+    EventDetector fast, slow;
+    EventDetector* both[2] = { &fast, &slow };
+    for (EventDetector* d : both) {
+      d->setThresholds(MINOR_LSB, MODERATE_LSB, SEVERE_LSB);
+      d->setTriggerMode(c.mode);
+      d->setMetric(c.metric);
+      d->setWindow(PRE, POST, MAX_POST, QUIET);
+      d->staLta().begin(WAVEFORM_RATE_HZ, 500, 30000, 4.0f, 1.5f);
+      d->setFilter(WAVEFORM_RATE_HZ, 0.5f, c.lpHz);
+    }
+    slow.setSpecialized(false);
+    TEST_ASSERT_TRUE(fast.specialized());
+    TEST_ASSERT_FALSE(slow.specialized());
+
+    WaveformRecorder rec;
+    int captures = 0;
+    for (int i = 0; i < 60 * WAVEFORM_RATE_HZ; i++) {
+      RecordedSample s = i < 40 * WAVEFORM_RATE_HZ ? rec.quiet() : rec.quake(i - 40 * WAVEFORM_RATE_HZ, 3000);
+      int32_t fx = s.x, fy = s.y, fz = s.z - WAVEFORM_1G_LSB;
+      int32_t sx = fx, sy = fy, sz = fz;
+      DetectResult r = fast.process((uint32_t)i, min(i + 1, PRE), fx, fy, fz);
+      TEST_ASSERT_EQUAL(slow.process((uint32_t)i, min(i + 1, PRE), sx, sy, sz), r);
+      TEST_ASSERT_EQUAL(sx, fx);
+      TEST_ASSERT_EQUAL(sz, fz);
+      if (r == DETECT_FINISHED) captures++;
+    }
+    TEST_ASSERT_TRUE(captures > 0);
+    TEST_ASSERT_EQUAL(slow.capture().peakLsb, fast.capture().peakLsb);
+    TEST_ASSERT_EQUAL(slow.capture().retriggerCount, fast.capture().retriggerCount);
+  }
+  // The /api/init defaults have one, a low-pass alone doesn't
+  EventDetector d;
+  d.setFilter(WAVEFORM_RATE_HZ, 0.1f, 0);
+  TEST_ASSERT_TRUE(d.specialized());
+  d.setFilter(WAVEFORM_RATE_HZ, 0, 20.0f);
+  TEST_ASSERT_FALSE(d.specialized());
+}
+
+static void test_binary_body_carries_raw_samples() {
+  arena.begin(64);
+  WaveformRecorder rec;
+  for (int i = 0; i < 40; i++) {
+    RecordedSample s = rec.quake(i, 1000);
+    arena.push(s.x, s.y, s.z);
+  }
+  CaptureView cap = viewOf(arena, 40);
+  WaveformBinaryStream stream(cap);
+  BodyReader body(stream);
+  TEST_ASSERT_EQUAL_MEMORY("SWV1", body.data, 4);
+  TEST_ASSERT_EQUAL_UINT32(WAVEFORM_BINARY_HEADER_SIZE + 40 * 6, body.length);
+  TEST_ASSERT_EQUAL_UINT8(0xAA, body.data[4]);
+  TEST_ASSERT_EQUAL_UINT16(40, body.at<uint16_t>(34));
+  for (int i = 0; i < 40; i++) {
+    WaveSample s = cap.at(i);
+    TEST_ASSERT_EQUAL_INT16(s.x, body.at<int16_t>(WAVEFORM_BINARY_HEADER_SIZE + i * 6));
+    TEST_ASSERT_EQUAL_INT16(s.z, body.at<int16_t>(WAVEFORM_BINARY_HEADER_SIZE + i * 6 + 4));
+  }
+}
+
+static void test_delta_body_decodes_to_the_samples() {
+  arena.begin(64);
+  WaveformRecorder rec;
+  for (int i = 0; i < 50; i++) {
+    RecordedSample s = rec.quake(i + 100, 8000);
+    arena.push(s.x, s.y, s.z);
+  }
+  CaptureView cap = viewOf(arena, 50);
+  WaveformBinaryStream stream(cap, true);
+  BodyReader body(stream);
+  TEST_ASSERT_EQUAL_MEMORY("SWD1", body.data, 4);
+  size_t pos = WAVEFORM_BINARY_HEADER_SIZE;
+  int32_t prev[3] = {0, 0, 0};
+  for (int i = 0; i < 50; i++) {
+    WaveSample s = cap.at(i);
+    const int16_t expected[3] = {s.x, s.y, s.z};
+    for (int axis = 0; axis < 3; axis++) {
+      uint32_t v = 0;
+      int shift = 0;
+      uint8_t b;
+      do {
+        b = body.data[pos++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        shift += 7;
+      } while (b & 0x80);
+      prev[axis] += (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+      TEST_ASSERT_EQUAL_INT32(expected[axis], prev[axis]);
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(body.length, pos);
+}
+
+static void test_msgpack_body_ends_with_the_samples() {
+  arena.begin(64);
+  WaveformRecorder rec;
+  for (int i = 0; i < 40; i++) arena.push(rec.quiet().x, 0, WAVEFORM_1G_LSB);
+  CaptureView cap = viewOf(arena, 40);
+  WaveformMsgPackStream stream(cap);
+  BodyReader body(stream);
+  TEST_ASSERT_EQUAL_UINT8(0x80, body.data[0] & 0xF0);  // fixmap
+  // ... "samples": bin32 of 40 * 6 bytes, last in the map
+  size_t blob = body.length - 40 * 6;
+  TEST_ASSERT_EQUAL_MEMORY("\xA7samples\xC6", body.data + blob - 13, 9);
+  TEST_ASSERT_EQUAL_UINT8(240, body.data[blob - 1]);
+  TEST_ASSERT_EQUAL_INT16(cap.at(39).x, body.at<int16_t>(body.length - 6));
+}
+
+static void test_msgpack_map16_past_fifteen_entries() {
+  // Coherence, a gap, retriggers, ranges and a spectrum together: 9 base
+  // keys + 7 is one more than a fixmap holds
+  arena.begin(64);
+  for (int i = 0; i < 40; i++) arena.push(100, 0, WAVEFORM_1G_LSB);
+  CaptureView cap = viewOf(arena, 40);
+  cap.coherence = 0.5f;
+  cap.gapIndex = 10;
+  cap.gapSamples = 3;
+  const uint16_t retriggers[] = { 25 };
+  cap.retriggers = retriggers;
+  cap.retriggerCount = 1;
+  const CaptureRange ranges[] = { {0, 0}, {20, 1} };
+  cap.ranges = ranges;
+  cap.rangeCount = 2;
+  SpectrumSummary sp = {};
+  sp.bins = 2;
+  sp.hz[0] = 1;
+  sp.hz[1] = 5;
+  sp.ampG[1] = 0.01f;
+  sp.dominant = 1;
+  cap.spectrum = &sp;
+
+  WaveformMsgPackStream stream(cap);
+  BodyReader body(stream);
+  TEST_ASSERT_EQUAL_UINT8(0xDE, body.data[0]);          // map16, 16 entries
+  TEST_ASSERT_EQUAL_UINT8(0, body.data[1]);
+  TEST_ASSERT_EQUAL_UINT8(16, body.data[2]);
+  TEST_ASSERT_EQUAL_MEMORY("\xA2id", body.data + 3, 3);
+  // The spectrum still trails the blob as the last entry
+  const uint8_t* key = (const uint8_t*)memmem(body.data, body.length, "\xA7samples\xC6", 9);
+  TEST_ASSERT_NOT_NULL(key);
+  const uint8_t* spectrum = key + 9 + 4 + 40 * 6;
+  TEST_ASSERT_EQUAL_MEMORY("\xA8spectrum", spectrum, 9);
+}
+
+static void test_range_blocks_in_the_header() {
+  arena.begin(64);
+  for (int i = 0; i < 20; i++) arena.push(100, 0, (int16_t)(i < 10 ? 16384 : 12288));
+  CaptureView cap = viewOf(arena, 20);
+  const CaptureRange ranges[] = { {0, 0}, {10, 2} };   // +/-2g, then +/-8g
+  cap.ranges = ranges;
+  cap.rangeCount = 2;
+  TEST_ASSERT_EQUAL(0, cap.shiftAt(9));
+  TEST_ASSERT_EQUAL(2, cap.shiftAt(10));
+
+  WaveformBinaryStream binary(cap);
+  BodyReader body(binary);
+  TEST_ASSERT_EQUAL_MEMORY("SWV4", body.data, 4);
+  TEST_ASSERT_EQUAL_UINT8(0, body.data[48]);           // no retriggers
+  TEST_ASSERT_EQUAL_UINT8(2, body.data[49]);
+  TEST_ASSERT_EQUAL_UINT16(10, body.at<uint16_t>(50 + 6));
+  TEST_ASSERT_EQUAL_FLOAT(4096.0f, body.at<float>(50 + 6 + 2));
+  TEST_ASSERT_EQUAL_UINT32(WAVEFORM_BINARY_RANGE_HEADER_SIZE + 2 * 6 + 20 * 6, body.length);
+
+  // JSON is in g: 3g on Z after the switch is 12288 LSB at +/-8g
+  WaveformJsonStream json(cap);
+  BodyReader text(json);
+  TEST_ASSERT_NOT_NULL(strstr((const char*)text.data, "\"ranges\":[[0,16384],[10,4096]]"));
+  TEST_ASSERT_NOT_NULL(strstr((const char*)text.data, "[-90,0.0061,0.0000,0.0000]"));
+  TEST_ASSERT_NOT_NULL(strstr((const char*)text.data, "[10,0.0244,0.0000,2.0000]"));
+}
+
+static void test_decimated_view_keeps_the_trigger() {
+  arena.begin(64);
+  for (int i = 0; i < 42; i++) arena.push((int16_t)i, 0, WAVEFORM_1G_LSB);
+  CaptureView cap = viewOf(arena, 42);                 // trigger at 20, sample value 20
+  const uint16_t retriggers[] = { 29 };
+  cap.retriggers = retriggers;
+  cap.retriggerCount = 1;
+  uint16_t thinned[CAPTURE_MAX_TRIGGERS];
+  CaptureRange ranges[1];
+  TEST_ASSERT_FALSE(decimateCapture(cap, 3, thinned, ranges));   // 100Hz doesn't divide by 3
+  TEST_ASSERT_TRUE(decimateCapture(cap, 4, thinned, ranges));
+  TEST_ASSERT_EQUAL(WAVEFORM_RATE_HZ / 4, cap.sampleRateHz);
+  TEST_ASSERT_EQUAL(6, cap.preCount);                  // 0, 4 .. 20
+  TEST_ASSERT_EQUAL(5, cap.postCount);                 // 24 .. 40
+  TEST_ASSERT_EQUAL_INT16(20, cap.at(cap.preCount - 1).x);
+  TEST_ASSERT_EQUAL_INT16(40, cap.at(cap.count() - 1).x);
+  TEST_ASSERT_EQUAL(0, cap.relMs(cap.preCount - 1));
+  TEST_ASSERT_EQUAL(80, cap.relMs(cap.retriggers[0]));    // 28, the grid sample at or before 29
+
+  WaveformBinaryStream stream(cap);
+  BodyReader body(stream);
+  TEST_ASSERT_EQUAL_UINT16(25, body.at<uint16_t>(32));
+  TEST_ASSERT_EQUAL_UINT16(11, body.at<uint16_t>(34));
+  TEST_ASSERT_EQUAL_INT32(-200, body.at<int32_t>(36));
+}
+
+static void test_dual_sensor_coherence_and_trailer() {
+  // Ground motion reaches both sensors; a tap only the first
+  CaptureArena second;
+  arena.begin(200);
+  second.begin(200);
+  WaveformRecorder rec(1), rec2(7);
+  for (int i = 0; i < 150; i++) {
+    RecordedSample s = rec.quake(i + 100, 3000);
+    RecordedSample t = rec2.quake(i + 100, 2800);
+    arena.push(s.x, s.y, s.z);
+    second.push((int16_t)(t.x + 40), t.y, (int16_t)(t.z - 25));
+  }
+  CaptureView cap = viewOf(arena, 150);
+  cap.secondary = &second;
+  cap.secondaryBias[0] = 40;
+  cap.secondaryBias[2] = WAVEFORM_1G_LSB - 25;
+  cap.coherence = captureCoherence(cap);
+  TEST_ASSERT_TRUE(cap.coherence > 0.9f);
+
+  // The "DUA1" trailer gives the second sensor back exactly
+  WaveformBinaryStream stream(cap, true);
+  BodyReader body(stream);
+  size_t pos = WAVEFORM_BINARY_HEADER_SIZE;
+  auto varint = [&]() {
+    uint32_t v = 0;
+    int shift = 0;
+    uint8_t b;
+    do {
+      b = body.data[pos++];
+      v |= (uint32_t)(b & 0x7F) << shift;
+      shift += 7;
+    } while (b & 0x80);
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+  };
+  for (int i = 0; i < 150 * 3; i++) varint();
+  TEST_ASSERT_EQUAL_MEMORY(WAVEFORM_DUAL_MAGIC, body.data + pos, 4);
+  TEST_ASSERT_EQUAL_FLOAT(cap.coherence, body.at<float>(pos + 4));
+  TEST_ASSERT_EQUAL_FLOAT(40.0f, body.at<float>(pos + 8));
+  pos += 20;
+  int32_t diff[3] = {0, 0, 0};
+  for (int i = 0; i < 150; i++) {
+    WaveSample p = cap.at(i), q = cap.secondaryAt(i);
+    for (int a = 0; a < 3; a++) diff[a] += varint();
+    TEST_ASSERT_EQUAL_INT32(q.x, p.x + diff[0]);
+    TEST_ASSERT_EQUAL_INT32(q.z, p.z + diff[2]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(body.length, pos);
+
+  second.begin(200);
+  for (int i = 0; i < 150; i++) {
+    RecordedSample t = rec2.quiet();
+    second.push((int16_t)(t.x + 40), t.y, (int16_t)(t.z - 25));
+  }
+  TEST_ASSERT_TRUE(captureCoherence(cap) < DUAL_COHERENCE_MIN);
+
+  // The drain pairing: newest with newest, the rest spread over the other count
+  TEST_ASSERT_EQUAL(9, pairedIndex(9, 10, 10));
+  TEST_ASSERT_EQUAL(8, pairedIndex(9, 10, 9));
+  TEST_ASSERT_EQUAL(0, pairedIndex(0, 10, 9));
+  TEST_ASSERT_EQUAL(10, pairedIndex(9, 10, 11));
+}
+
+static void test_calibration_stops_early_and_rejects_motion() {
+  // A quiet bench converges at the minimum
+  BiasEstimator est;
+  est.begin();
+  WaveformRecorder rec;
+  CalibState state;
+  do {
+    RecordedSample s = rec.quiet();
+    state = est.add(s.x, s.y, s.z);
+  } while (state == CALIB_RUNNING);
+  TEST_ASSERT_EQUAL(CALIB_CONVERGED, state);
+  TEST_ASSERT_EQUAL(CALIB_MIN_BLOCKS * CALIB_BLOCK_SAMPLES, est.reads());
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, WAVEFORM_1G_LSB, est.mean(2));
+  TEST_ASSERT_TRUE(est.standardError() < CALIB_SEM_LSB);
+
+  // A tap in the second block costs that block, not the mean
+  est.begin();
+  for (int i = 0; est.reads() < CALIB_MAX_READS; i++) {
+    RecordedSample s = rec.quiet();
+    if (i == CALIB_BLOCK_SAMPLES + 40) s.x += 3000;
+    if (est.add(s.x, s.y, s.z) != CALIB_RUNNING) break;
+  }
+  TEST_ASSERT_EQUAL(1, est.rejected());
+  TEST_ASSERT_EQUAL((CALIB_MIN_BLOCKS + 1) * CALIB_BLOCK_SAMPLES, est.reads());
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, 0.0f, est.mean(0));
+
+  // Moved for good after two blocks: starts over at the new rest
+  est.begin();
+  for (int i = 0; est.reads() < CALIB_MAX_READS; i++) {
+    RecordedSample s = rec.quiet();
+    if (i >= 2 * CALIB_BLOCK_SAMPLES) s.x += 500;
+    if (est.add(s.x, s.y, s.z) != CALIB_RUNNING) break;
+  }
+  TEST_ASSERT_EQUAL(1, est.restarts());
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, 500.0f, est.mean(0));
+}
+
+static uint32_t testCrc32(const uint8_t* p, size_t n) {
+  uint32_t crc = 0xFFFFFFFF;
+  while (n--) {
+    crc ^= *p++;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+template <typename T>
+static void put(uint8_t* body, size_t offset, T v) { memcpy(body + offset, &v, sizeof(v)); }
+
+static size_t putString(uint8_t* body, size_t offset, const char* s) {
+  body[offset] = strlen(s);
+  memcpy(body + offset + 1, s, strlen(s));
+  return offset + 1 + strlen(s);
+}
+
+static void test_init_binary_decodes_and_json_keeps_defaults() {
+  // A body as server/lib/initbin.js writes it, with two bytes of a newer
+  // server's config fields the decoder has to skip
+  uint8_t body[256] = {};
+  memcpy(body, "SIC", 3);
+  body[3] = INIT_BINARY_VERSION;
+  const size_t S = 8;
+  put<uint32_t>(body, S + 0, 9);
+  put<uint32_t>(body, S + 4, 60000);
+  put<float>(body, S + 16, 0.1f);
+  put<uint16_t>(body, S + 24, 1000);          // held to 500
+  body[S + 27] = TRIGGER_MODE_BOTH;
+  body[S + 28] = 42;                          // a metric from the future: max-abs
+  body[S + 30] = INIT_SPECTRUM;
+  body[S + 31] = 2;
+  body[S + 32] = 3;                           // delta, then json
+  body[S + 33] = 0;
+  put<uint16_t>(body, S + 38, 4000);
+  put<uint16_t>(body, S + 40, 2000);          // below post_ms: raised to it
+  put<float>(body, S + 56, 1.5f);
+  put<uint16_t>(body, S + 74, 5006);
+  size_t end = putString(body, S + INIT_FIXED_BYTES, "time.example.org");
+  end = putString(body, end, "");
+  end += 2;
+  const size_t section = end - S;
+  put<uint16_t>(body, 4, section);
+  put<int64_t>(body, end, 1760000000123LL);
+  body[end + 8] = 1;
+  end = putString(body, end + 9, "1.3.0");
+  end = putString(body, end, "http://example.org/fw.bin");
+  put<uint16_t>(body, 6, end);
+  put<uint32_t>(body, end, testCrc32(body, end));
+  size_t n = end + 4;
+
+  InitConfig cfg = initDefaults(100, 1, 1883);
+  InitBoot boot;
+  TEST_ASSERT_TRUE(decodeInitBinary(body, n, cfg, boot));
+  TEST_ASSERT_EQUAL_UINT32(9, cfg.gen);
+  TEST_ASSERT_EQUAL_UINT32(60000, cfg.heartbeatMs);
+  TEST_ASSERT_EQUAL_FLOAT(0.1f, cfg.sensitivity[1]);
+  TEST_ASSERT_EQUAL_UINT16(500, cfg.sampleRateHz);
+  TEST_ASSERT_EQUAL(TRIGGER_MODE_BOTH, cfg.triggerMode);
+  TEST_ASSERT_EQUAL(METRIC_MAX_ABS, cfg.detectMetric);
+  TEST_ASSERT_EQUAL(2, cfg.formatCount);
+  TEST_ASSERT_EQUAL(3, cfg.formats[0]);
+  TEST_ASSERT_EQUAL_UINT16(4000, cfg.maxPostMs);
+  TEST_ASSERT_EQUAL_FLOAT(1.5f, cfg.hpHz);
+  TEST_ASSERT_EQUAL_UINT16(5006, cfg.sessionPort);
+  TEST_ASSERT_EQUAL_STRING("time.example.org", cfg.ntpServer);
+  TEST_ASSERT_EQUAL_STRING("", cfg.mqttHost);
+  TEST_ASSERT_EQUAL_HEX32(testCrc32(body + S, section), cfg.crc);
+  TEST_ASSERT_TRUE(boot.serverTimeMs == 1760000000123LL);
+  TEST_ASSERT_TRUE(boot.recalibrate);
+  TEST_ASSERT_EQUAL_STRING("http://example.org/fw.bin", boot.firmwareUrl);
+
+  // Any damaged or cut body is refused and leaves cfg alone
+  body[S + 1] ^= 1;
+  TEST_ASSERT_FALSE(decodeInitBinary(body, n, cfg, boot));
+  body[S + 1] ^= 1;
+  TEST_ASSERT_FALSE(decodeInitBinary(body, n - 1, cfg, boot));
+  TEST_ASSERT_EQUAL_UINT32(9, cfg.gen);
+
+  // JSON from an older server: what it leaves out keeps the defaults
+  JsonDocument doc;
+  deserializeJson(doc, "{\"config_gen\":4,\"trigger_mode\":\"sta_lta\",\"upload_formats\":[\"zstd\",\"binary\"],"
+                       "\"mqtt\":{\"host\":\"broker\"},\"post_ms\":50,\"firmware_version\":\"1.3.0\"}");
+  InitConfig json = initDefaults(100, 1, 1883);
+  initFromJson(doc, json, boot);
+  TEST_ASSERT_EQUAL_UINT32(4, json.gen);
+  TEST_ASSERT_EQUAL(TRIGGER_MODE_STA_LTA, json.triggerMode);
+  TEST_ASSERT_EQUAL(1, json.formatCount);
+  TEST_ASSERT_EQUAL(1, json.formats[0]);
+  TEST_ASSERT_EQUAL_UINT16(100, json.postMs);
+  TEST_ASSERT_EQUAL_UINT16(500, json.staMs);
+  TEST_ASSERT_EQUAL_STRING("broker", json.mqttHost);
+  TEST_ASSERT_EQUAL_UINT16(1883, json.mqttPort);
+  TEST_ASSERT_EQUAL_UINT32(0, json.crc);
+  TEST_ASSERT_FALSE(boot.recalibrate);
+  TEST_ASSERT_EQUAL_STRING("1.3.0", boot.firmwareVersion);
+}
+
+static void test_sample_rate_snaps_to_the_divider() {
+  // 1kHz / (1 + SMPLRT_DIV): 300 would run at 333Hz, 150 at 166.7Hz
+  TEST_ASSERT_EQUAL_UINT16(250, snapSampleRate(300, 1));
+  TEST_ASSERT_EQUAL_UINT16(125, snapSampleRate(150, 1));
+  TEST_ASSERT_EQUAL_UINT16(100, snapSampleRate(100, 1));
+  TEST_ASSERT_EQUAL_UINT16(20, snapSampleRate(15, 1));      // a tie: the faster
+  TEST_ASSERT_EQUAL_UINT16(5, snapSampleRate(1, 6));
+  // 8kHz at dlpf 0: 400 is exact, and nothing slower than 32Hz is
+  TEST_ASSERT_EQUAL_UINT16(400, snapSampleRate(400, 0));
+  TEST_ASSERT_EQUAL_UINT16(32, snapSampleRate(5, 0));
+  TEST_ASSERT_EQUAL_UINT16(500, snapSampleRate(1000, 0));
+
+  // Whichever way the rate arrives
+  JsonDocument doc;
+  deserializeJson(doc, "{\"sample_rate_hz\":400,\"dlpf\":2}");
+  InitConfig cfg = initDefaults(100, 1, 1883);
+  InitBoot boot;
+  initFromJson(doc, cfg, boot);
+  TEST_ASSERT_EQUAL_UINT16(500, cfg.sampleRateHz);
+}
+
+// One drain of count FIFO samples: the stamps take() gave, 0 for the counter
+static void drainStamps(ReadyRing& ring, uint16_t count, unsigned long* ms) {
+  ring.begin(count);
+  for (uint16_t i = 0; i < count; i++) {
+    ms[i] = 0;
+    ring.take(ms[i]);
+  }
+}
+
+static void test_ready_ring_skips_a_late_stamp() {
+  static ReadyRing ring;
+  ring.restart();
+  unsigned long ms[8];
+  // Sample 2 is in the FIFO before its ISR has run: it goes on the counter
+  ring.edge(10);
+  ring.edge(20);
+  drainStamps(ring, 3, ms);
+  TEST_ASSERT_EQUAL_UINT32(10, ms[0]);
+  TEST_ASSERT_EQUAL_UINT32(20, ms[1]);
+  TEST_ASSERT_EQUAL_UINT32(0, ms[2]);
+  TEST_ASSERT_FALSE(ring.pending());
+  // Its stamp lands late and belongs to nobody; sample 3 gets its own
+  ring.edge(30);
+  TEST_ASSERT_FALSE(ring.pending());
+  ring.edge(40);
+  TEST_ASSERT_TRUE(ring.pending());
+  drainStamps(ring, 1, ms);
+  TEST_ASSERT_EQUAL_UINT32(40, ms[0]);
+  for (int k = 0; k < 100; k++) {
+    ring.edge(50 + k * 10);
+    drainStamps(ring, 1, ms);
+    TEST_ASSERT_EQUAL_UINT32(50 + k * 10, ms[0]);
+  }
+}
+
+static void test_ready_ring_realigns_after_a_lost_edge() {
+  static ReadyRing ring;
+  ring.restart();
+  unsigned long ms[8];
+  unsigned long t = 0;
+  // Two edges merged into one while interrupts were off
+  ring.edge(t += 10);
+  drainStamps(ring, 2, ms);
+  TEST_ASSERT_EQUAL_UINT32(10, ms[0]);
+  TEST_ASSERT_EQUAL_UINT32(0, ms[1]);
+  t += 10;
+  // Off by one for a few drains, then back on the newest sample
+  for (int k = 1; k < READY_RESYNC_DRAINS; k++) {
+    ring.edge(t += 10);
+    ring.edge(t += 10);
+    drainStamps(ring, 2, ms);
+  }
+  ring.edge(t += 10);
+  ring.edge(t += 10);
+  drainStamps(ring, 2, ms);
+  TEST_ASSERT_EQUAL_UINT32(t - 10, ms[0]);
+  TEST_ASSERT_EQUAL_UINT32(t, ms[1]);
+  // A doubled edge the other way
+  ring.edge(t += 10);
+  ring.edge(t + 1);
+  drainStamps(ring, 1, ms);
+  for (int k = 0; k <= READY_RESYNC_DRAINS; k++) {
+    ring.edge(t += 10);
+    drainStamps(ring, 1, ms);
+  }
+  TEST_ASSERT_EQUAL_UINT32(t, ms[0]);
+  // A stall long enough to overwrite the ring leaves the oldest on the counter
+  for (int k = 0; k < READY_RING_SIZE; k++) ring.edge(t += 10);
+  drainStamps(ring, 3, ms);
+  TEST_ASSERT_EQUAL_UINT32(0, ms[0]);
+  TEST_ASSERT_EQUAL_UINT32(t - (READY_RING_SIZE - 2) * 10, ms[1]);
+  TEST_ASSERT_EQUAL_UINT32(t - (READY_RING_SIZE - 3) * 10, ms[2]);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_quiet_never_triggers);
+  RUN_TEST(test_threshold_capture_window);
+  RUN_TEST(test_retrigger_extends_up_to_max);
+  RUN_TEST(test_sta_lta_fires_below_minor);
+  RUN_TEST(test_vector_metric_sees_a_diagonal);
+  RUN_TEST(test_gravity_metrics_follow_the_mount);
+  RUN_TEST(test_specialized_pipeline_matches_per_metric);
+  RUN_TEST(test_binary_body_carries_raw_samples);
+  RUN_TEST(test_delta_body_decodes_to_the_samples);
+  RUN_TEST(test_msgpack_body_ends_with_the_samples);
+  RUN_TEST(test_msgpack_map16_past_fifteen_entries);
+  RUN_TEST(test_range_blocks_in_the_header);
+  RUN_TEST(test_decimated_view_keeps_the_trigger);
+  RUN_TEST(test_dual_sensor_coherence_and_trailer);
+  RUN_TEST(test_calibration_stops_early_and_rejects_motion);
+  RUN_TEST(test_init_binary_decodes_and_json_keeps_defaults);
+  RUN_TEST(test_sample_rate_snaps_to_the_divider);
+  RUN_TEST(test_ready_ring_skips_a_late_stamp);
+  RUN_TEST(test_ready_ring_realigns_after_a_lost_edge);
+  return UNITY_END();
+}